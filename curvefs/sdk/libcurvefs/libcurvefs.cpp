@@ -186,6 +186,72 @@ ssize_t curvefs_write(uintptr_t instance_ptr,
     return nwritten;
 }
 
+ssize_t curvefs_pread(uintptr_t instance_ptr,
+                      int fd,
+                      char* buffer,
+                      size_t count,
+                      uint64_t offset) {
+    size_t nread = 0;
+    auto mount = get_instance(instance_ptr);
+    auto rc = mount->vfs->PRead(fd, buffer, count, offset, &nread);
+    if (rc != CURVEFS_ERROR::OK) {
+        return SysErr(rc);
+    }
+    return nread;
+}
+
+ssize_t curvefs_pwrite(uintptr_t instance_ptr,
+                       int fd,
+                       char* buffer,
+                       size_t count,
+                       uint64_t offset) {
+    size_t nwritten = 0;
+    auto mount = get_instance(instance_ptr);
+    auto rc = mount->vfs->PWrite(fd, buffer, count, offset, &nwritten);
+    if (rc != CURVEFS_ERROR::OK) {
+        return SysErr(rc);
+    }
+    return nwritten;
+}
+
+int curvefs_aio_read(uintptr_t instance_ptr,
+                     int fd,
+                     char* buffer,
+                     size_t count,
+                     uint64_t offset,
+                     curvefs_aio_cb cb,
+                     void* arg) {
+    auto mount = get_instance(instance_ptr);
+    auto rc = mount->vfs->AsyncRead(fd, buffer, count, offset,
+        [cb, arg](CURVEFS_ERROR code, size_t nread) {
+            if (code != CURVEFS_ERROR::OK) {
+                cb(SysErr(code), arg);
+            } else {
+                cb(static_cast<ssize_t>(nread), arg);
+            }
+        });
+    return SysErr(rc);
+}
+
+int curvefs_aio_write(uintptr_t instance_ptr,
+                      int fd,
+                      char* buffer,
+                      size_t count,
+                      uint64_t offset,
+                      curvefs_aio_cb cb,
+                      void* arg) {
+    auto mount = get_instance(instance_ptr);
+    auto rc = mount->vfs->AsyncWrite(fd, buffer, count, offset,
+        [cb, arg](CURVEFS_ERROR code, size_t nwritten) {
+            if (code != CURVEFS_ERROR::OK) {
+                cb(SysErr(code), arg);
+            } else {
+                cb(static_cast<ssize_t>(nwritten), arg);
+            }
+        });
+    return SysErr(rc);
+}
+
 int curvefs_fsync(uintptr_t instance_ptr, int fd) {
     auto mount = get_instance(instance_ptr);
     auto rc = mount->vfs->FSync(fd);
@@ -58,6 +58,10 @@ typedef struct {
     char name[256];
 } dirent_t;
 
+// callback of async read/write, |ret| is the bytes read/written
+// or the negative error code
+typedef void (*curvefs_aio_cb)(ssize_t ret, void* arg);
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -117,6 +121,35 @@ ssize_t curvefs_write(uintptr_t instance_ptr,
                       char* buffer,
                       size_t count);
 
+ssize_t curvefs_pread(uintptr_t instance_ptr,
+                      int fd,
+                      char* buffer,
+                      size_t count,
+                      uint64_t offset);
+
+ssize_t curvefs_pwrite(uintptr_t instance_ptr,
+                       int fd,
+                       char* buffer,
+                       size_t count,
+                       uint64_t offset);
+
+// NOTE: keep |buffer| valid until |cb| is called
+int curvefs_aio_read(uintptr_t instance_ptr,
+                     int fd,
+                     char* buffer,
+                     size_t count,
+                     uint64_t offset,
+                     curvefs_aio_cb cb,
+                     void* arg);
+
+int curvefs_aio_write(uintptr_t instance_ptr,
+                      int fd,
+                      char* buffer,
+                      size_t count,
+                      uint64_t offset,
+                      curvefs_aio_cb cb,
+                      void* arg);
+
 int curvefs_fsync(uintptr_t instance_ptr, int fd);
 
 int curvefs_close(uintptr_t instance_ptr, int fd);
@@ -60,6 +60,7 @@ RenameOperator::RenameOperator(uint32_t fsId,
       dstTxId_(0),
       oldInodeId_(0),
       oldInodeSize_(-1),
+      committed_(false),
       dentryManager_(dentryManager),
       inodeManager_(inodeManager),
       metaClient_(metaClient),
@@ -82,6 +83,7 @@ std::string RenameOperator::DebugString() {
        << ", dstDentry = [" << dstDentry_.ShortDebugString() << "]"
        << ", prepare dentry = [" << dentry_.ShortDebugString() << "]"
        << ", prepare new dentry = [" << newDentry_.ShortDebugString() << "]"
+       << ", committed = " << committed_
        << ", enableParallel = " << enableParallel_
        << ", uuid = " << uuid_
        << ", sequence = " << sequence_ << ")";
@@ -208,6 +210,16 @@ CURVEFS_ERROR RenameOperator::PrepareRenameTx(
     return ToFSError(rc);
 }
 
+CURVEFS_ERROR RenameOperator::PrepareRenameTx(
+    const std::vector<Dentry>& dentrys, bool* committed) {
+    auto rc = metaClient_->PrepareRenameTx(dentrys, committed);
+    if (rc != MetaStatusCode::OK) {
+        LOG_ERROR("PrepareRenameTx", rc);
+    }
+
+    return ToFSError(rc);
+}
+
 CURVEFS_ERROR RenameOperator::PrepareTx() {
     dentry_ = Dentry(srcDentry_);
     dentry_.set_txid(srcTxId_ + 1);
@@ -230,7 +242,13 @@ CURVEFS_ERROR RenameOperator::PrepareTx() {
     std::vector<Dentry> dentrys{ dentry_ };
     if (srcPartitionId_ == dstPartitionId_) {
         dentrys.push_back(newDentry_);
-        rc = PrepareRenameTx(dentrys);
+        // the tx in one partition is committed by metaserver in the same
+        // raft entry, unless it must hold the lock of mds
+        if (enableParallel_) {
+            rc = PrepareRenameTx(dentrys);
+        } else {
+            rc = PrepareRenameTx(dentrys, &committed_);
+        }
     } else {
         rc = PrepareRenameTx(dentrys);
         if (rc == CURVEFS_ERROR::OK) {
@@ -246,6 +264,10 @@ CURVEFS_ERROR RenameOperator::PrepareTx() {
 }
 
 CURVEFS_ERROR RenameOperator::CommitTx() {
+    if (committed_) {
+        return CURVEFS_ERROR::OK;
+    }
+
     PartitionTxId partitionTxId;
     std::vector<PartitionTxId> txIds;
 
@@ -419,6 +441,10 @@ CURVEFS_ERROR RenameOperator::UpdateInodeCtime() {
 }
 
 void RenameOperator::UpdateCache() {
+    // the tx committed by metaserver is visible with the current txid
+    if (committed_) {
+        return;
+    }
     SetTxId(srcPartitionId_, srcTxId_ + 1);
     SetTxId(dstPartitionId_, dstTxId_ + 1);
 }
@@ -85,6 +85,9 @@ class RenameOperator {
 
     CURVEFS_ERROR PrepareRenameTx(const std::vector<Dentry>& dentrys);
 
+    CURVEFS_ERROR PrepareRenameTx(const std::vector<Dentry>& dentrys,
+                                  bool* committed);
+
     CURVEFS_ERROR LinkInode(uint64_t inodeId, uint64_t parent = 0);
 
     CURVEFS_ERROR UnLinkInode(uint64_t inodeId, uint64_t parent = 0);
@@ -111,6 +114,8 @@ class RenameOperator {
     Dentry dstDentry_;
     Dentry dentry_;
     Dentry newDentry_;
+    // whether metaserver committed the tx, it needs no commit to mds then
+    bool committed_;
 
     std::shared_ptr<DentryCacheManager> dentryManager_;
     std::shared_ptr<InodeCacheManager> inodeManager_;
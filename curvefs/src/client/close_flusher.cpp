@@ -0,0 +1,146 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "curvefs/src/client/close_flusher.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace curvefs {
+namespace client {
+
+CloseFlusher::CloseFlusher(uint32_t threads, uint32_t maxPending,
+                           FlushFunc flush)
+    : threads_(std::max(threads, 1u)),
+      maxPending_(std::max(maxPending, 1u)),
+      flush_(std::move(flush)) {}
+
+CloseFlusher::~CloseFlusher() {
+    Stop();
+}
+
+void CloseFlusher::Start() {
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    for (uint32_t i = 0; i < threads_; ++i) {
+        workers_.emplace_back(&CloseFlusher::Run, this);
+    }
+    LOG(INFO) << "close flusher started, threads: " << threads_
+              << ", max pending: " << maxPending_;
+}
+
+void CloseFlusher::Stop() {
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+        workers.swap(workers_);
+        cond_.notify_all();
+    }
+    // the workers exit after the queue is drained
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    LOG(INFO) << "close flusher stopped";
+}
+
+bool CloseFlusher::Submit(uint64_t ino) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (!running_) {
+        return false;
+    }
+    if (queued_.count(ino) != 0) {
+        // the queued flush isn't started, it covers this close too
+        return true;
+    }
+    if (queued_.size() + flushing_.size() >= maxPending_) {
+        return false;
+    }
+    queued_.insert(ino);
+    queue_.push_back(ino);
+    cond_.notify_one();
+    return true;
+}
+
+bool CloseFlusher::PendingLocked(uint64_t ino) const {
+    return queued_.count(ino) != 0 || flushing_.count(ino) != 0;
+}
+
+CURVEFS_ERROR CloseFlusher::Wait(uint64_t ino) {
+    std::unique_lock<std::mutex> lk(mtx_);
+    doneCond_.wait(lk, [&]() { return !PendingLocked(ino); });
+    auto iter = errors_.find(ino);
+    if (iter == errors_.end()) {
+        return CURVEFS_ERROR::OK;
+    }
+    CURVEFS_ERROR ret = iter->second;
+    errors_.erase(iter);
+    return ret;
+}
+
+CURVEFS_ERROR CloseFlusher::WaitAll() {
+    std::unique_lock<std::mutex> lk(mtx_);
+    doneCond_.wait(lk, [&]() {
+        return queued_.empty() && flushing_.empty();
+    });
+    CURVEFS_ERROR ret = CURVEFS_ERROR::OK;
+    if (!errors_.empty()) {
+        ret = errors_.begin()->second;
+        errors_.clear();
+    }
+    return ret;
+}
+
+void CloseFlusher::Run() {
+    std::unique_lock<std::mutex> lk(mtx_);
+    while (true) {
+        cond_.wait(lk, [&]() { return !running_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            return;
+        }
+        uint64_t ino = queue_.front();
+        queue_.pop_front();
+        queued_.erase(ino);
+        flushing_[ino]++;
+        lk.unlock();
+
+        CURVEFS_ERROR ret = flush_(ino);
+        if (ret != CURVEFS_ERROR::OK) {
+            LOG(ERROR) << "flush closed file failed, ino: " << ino
+                       << ", ret: " << ret << ", deferred to fsync";
+        }
+
+        lk.lock();
+        if (ret != CURVEFS_ERROR::OK) {
+            errors_.emplace(ino, ret);
+        }
+        if (--flushing_[ino] == 0) {
+            flushing_.erase(ino);
+        }
+        doneCond_.notify_all();
+    }
+}
+
+}  // namespace client
+}  // namespace curvefs
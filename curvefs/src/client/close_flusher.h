@@ -0,0 +1,96 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef CURVEFS_SRC_CLIENT_CLOSE_FLUSHER_H_
+#define CURVEFS_SRC_CLIENT_CLOSE_FLUSHER_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "curvefs/src/client/filesystem/error.h"
+
+namespace curvefs {
+namespace client {
+
+using ::curvefs::client::filesystem::CURVEFS_ERROR;
+
+/**
+ * Flush the files closed in background, so close returns without waiting
+ * for the data to be flushed. Only fsync waits for the flush of the file,
+ * and gets the error of the background flush deferred to it.
+ *
+ * At most maxPending files are waiting or being flushed, a close beyond it
+ * is refused and the caller should flush in place, which bounds the dirty
+ * data held by the closed files.
+ */
+class CloseFlusher {
+ public:
+    using FlushFunc = std::function<CURVEFS_ERROR(uint64_t ino)>;
+
+ public:
+    CloseFlusher(uint32_t threads, uint32_t maxPending, FlushFunc flush);
+
+    ~CloseFlusher();
+
+    void Start();
+
+    // flush the pending files then stop the threads
+    void Stop();
+
+    // hand the file to background, return false if too many pending
+    bool Submit(uint64_t ino);
+
+    // wait the pending flush of the file, and take the error of the
+    // background flushes of it since last wait
+    CURVEFS_ERROR Wait(uint64_t ino);
+
+    // wait the pending flushes of all files, and take their first error
+    CURVEFS_ERROR WaitAll();
+
+ private:
+    void Run();
+
+    bool PendingLocked(uint64_t ino) const;
+
+ private:
+    const uint32_t threads_;
+    const uint32_t maxPending_;
+    FlushFunc flush_;
+
+    std::mutex mtx_;
+    std::condition_variable cond_;
+    std::condition_variable doneCond_;
+    bool running_ = false;
+    std::deque<uint64_t> queue_;
+    // files in queue_, a file is queued once however many times closed
+    std::unordered_set<uint64_t> queued_;
+    // files being flushed and the number of flushes running
+    std::unordered_map<uint64_t, uint32_t> flushing_;
+    std::unordered_map<uint64_t, CURVEFS_ERROR> errors_;
+    std::vector<std::thread> workers_;
+};
+
+}  // namespace client
+}  // namespace curvefs
+
+#endif  // CURVEFS_SRC_CLIENT_CLOSE_FLUSHER_H_
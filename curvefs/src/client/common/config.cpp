@@ -161,6 +161,11 @@ void InitExcutorOption(Configuration *conf, ExcutorOpt *opts, bool internal) {
                               &opts->maxRetryTimesBeforeConsiderSuspend);
     conf->GetValueFatalIfFail("executorOpt.batchInodeAttrLimit",
                               &opts->batchInodeAttrLimit);
+    LOG_IF(WARNING, !conf->GetBoolValue("executorOpt.multiplexGetInodeAttr",
+                                        &opts->multiplexGetInodeAttr))
+        << "Not found `executorOpt.multiplexGetInodeAttr` in conf, use "
+           "default value `"
+        << std::boolalpha << opts->multiplexGetInodeAttr << '`';
     conf->GetValueFatalIfFail("fuseClient.enableMultiMountPointRename",
                               &opts->enableRenameParallel);
 }
@@ -209,6 +214,14 @@ void InitDiskCacheOption(Configuration *conf,
                               &diskCacheOption->avgReadFileBytes);
     conf->GetValueFatalIfFail("diskCache.avgReadFileIops",
                               &diskCacheOption->avgReadFileIops);
+    LOG_IF(WARNING, !conf->GetStringValue("diskCache.readCacheLayout",
+                                          &diskCacheOption->readCacheLayout))
+        << "Not found `diskCache.readCacheLayout` in conf, use default value `"
+        << diskCacheOption->readCacheLayout << '`';
+    LOG_IF(WARNING, !conf->GetBoolValue("diskCache.slabDirectIO",
+                                        &diskCacheOption->slabDirectIO))
+        << "Not found `diskCache.slabDirectIO` in conf, use default value `"
+        << std::boolalpha << diskCacheOption->slabDirectIO << '`';
 }
 
 void InitS3Option(Configuration *conf, S3Option *s3Opt) {
@@ -250,6 +263,47 @@ void InitS3Option(Configuration *conf, S3Option *s3Opt) {
         &s3Opt->s3ClientAdaptorOpt.maxReadRetryIntervalMs);
     conf->GetValueFatalIfFail("s3.readRetryIntervalMs",
                               &s3Opt->s3ClientAdaptorOpt.readRetryIntervalMs);
+    LOG_IF(WARNING, !conf->GetUInt32Value(
+                        "s3.chunkIdLease.min",
+                        &s3Opt->s3ClientAdaptorOpt.chunkIdLeaseMin))
+        << "Not found `s3.chunkIdLease.min` in conf, use default value `"
+        << s3Opt->s3ClientAdaptorOpt.chunkIdLeaseMin << '`';
+    LOG_IF(WARNING, !conf->GetUInt32Value(
+                        "s3.chunkIdLease.max",
+                        &s3Opt->s3ClientAdaptorOpt.chunkIdLeaseMax))
+        << "Not found `s3.chunkIdLease.max` in conf, use default value `"
+        << s3Opt->s3ClientAdaptorOpt.chunkIdLeaseMax << '`';
+    LOG_IF(WARNING, !conf->GetUInt32Value(
+                        "s3.chunkIdLease.targetSec",
+                        &s3Opt->s3ClientAdaptorOpt.chunkIdLeaseTargetSec))
+        << "Not found `s3.chunkIdLease.targetSec` in conf, use default "
+           "value `"
+        << s3Opt->s3ClientAdaptorOpt.chunkIdLeaseTargetSec << '`';
+    LOG_IF(WARNING, !conf->GetUInt32Value(
+                        "s3.inlineDataMaxSize",
+                        &s3Opt->s3ClientAdaptorOpt.inlineDataMaxSize))
+        << "Not found `s3.inlineDataMaxSize` in conf, use default value `"
+        << s3Opt->s3ClientAdaptorOpt.inlineDataMaxSize << '`';
+    LOG_IF(WARNING, !conf->GetUInt32Value(
+                        "s3.pack.maxSliceSize",
+                        &s3Opt->s3ClientAdaptorOpt.packMaxSliceSize))
+        << "Not found `s3.pack.maxSliceSize` in conf, use default value `"
+        << s3Opt->s3ClientAdaptorOpt.packMaxSliceSize << '`';
+    LOG_IF(WARNING, !conf->GetUInt32Value(
+                        "s3.pack.maxSize",
+                        &s3Opt->s3ClientAdaptorOpt.packMaxSize))
+        << "Not found `s3.pack.maxSize` in conf, use default value `"
+        << s3Opt->s3ClientAdaptorOpt.packMaxSize << '`';
+    LOG_IF(WARNING, !conf->GetUInt32Value(
+                        "s3.pack.maxSlices",
+                        &s3Opt->s3ClientAdaptorOpt.packMaxSlices))
+        << "Not found `s3.pack.maxSlices` in conf, use default value `"
+        << s3Opt->s3ClientAdaptorOpt.packMaxSlices << '`';
+    LOG_IF(WARNING, !conf->GetUInt32Value(
+                        "s3.pack.maxDelayMs",
+                        &s3Opt->s3ClientAdaptorOpt.packMaxDelayMs))
+        << "Not found `s3.pack.maxDelayMs` in conf, use default value `"
+        << s3Opt->s3ClientAdaptorOpt.packMaxDelayMs << '`';
     ::curve::common::InitS3AdaptorOptionExceptS3InfoOption(conf,
                                                            &s3Opt->s3AdaptrOpt);
 
@@ -266,10 +320,31 @@ void InitVolumeOption(Configuration *conf, VolumeOption *volumeOpt) {
                               &volumeOpt->threshold);
     conf->GetValueFatalIfFail("volume.space.releaseInterSec",
                               &volumeOpt->releaseInterSec);
+    LOG_IF(WARNING, !conf->GetUInt64Value("volume.space.reserveSize",
+                                          &volumeOpt->reserveSize))
+        << "Not found `volume.space.reserveSize` in conf, use default value `"
+        << volumeOpt->reserveSize << '`';
+    LOG_IF(WARNING, !conf->GetUInt32Value("volume.space.reserveShards",
+                                          &volumeOpt->reserveShards))
+        << "Not found `volume.space.reserveShards` in conf, use default "
+           "value `"
+        << volumeOpt->reserveShards << '`';
+    LOG_IF(WARNING, !conf->GetUInt32Value("volume.space.allocateAheadSec",
+                                          &volumeOpt->allocateAheadSec))
+        << "Not found `volume.space.allocateAheadSec` in conf, use default "
+           "value `"
+        << volumeOpt->allocateAheadSec << '`';
 
     conf->GetValueFatalIfFail(
         "volume.blockGroup.allocateOnce",
         &volumeOpt->allocatorOption.blockGroupOption.allocateOnce);
+    LOG_IF(WARNING,
+           !conf->GetUInt32Value(
+               "volume.blockGroup.maxAllocateOnce",
+               &volumeOpt->allocatorOption.blockGroupOption.maxAllocateOnce))
+        << "Not found `volume.blockGroup.maxAllocateOnce` in conf, use "
+           "default value `"
+        << volumeOpt->allocatorOption.blockGroupOption.maxAllocateOnce << '`';
 
     if (volumeOpt->allocatorOption.type == "bitmap") {
         conf->GetValueFatalIfFail(
@@ -312,6 +387,10 @@ void InitKVClientManagerOpt(Configuration *conf,
                               &config->setThreadPooln);
     conf->GetValueFatalIfFail("fuseClient.getThreadPool",
                               &config->getThreadPooln);
+    LOG_IF(WARNING, !conf->GetUInt32Value("fuseClient.getBatchSize",
+                                          &config->getBatchSize))
+        << "Not found `fuseClient.getBatchSize` in conf, use default value `"
+        << config->getBatchSize << '`';
 }
 
 void GetGids(
@@ -346,6 +425,10 @@ void InitVFSOption(Configuration* c, VFSOption* option) {
         GetGids(c, "vfs.userPermission.gids", &o->gids);
         GetUmask(c, "vfs.userPermission.umask", &o->umask);
     }
+    LOG_IF(WARNING, !c->GetUInt32Value("vfs.asyncIOThreads",
+                                       &option->asyncIOThreads))
+        << "Not found `vfs.asyncIOThreads` in conf, use default value `"
+        << option->asyncIOThreads << '`';
 }
 
 void InitFileSystemOption(Configuration* c, FileSystemOption* option) {
@@ -394,6 +477,11 @@ void InitFileSystemOption(Configuration* c, FileSystemOption* option) {
         auto o = &option->deferSyncOption;
         c->GetValueFatalIfFail("fs.deferSync.delay", &o->delay);
         c->GetValueFatalIfFail("fs.deferSync.deferDirMtime", &o->deferDirMtime);
+        LOG_IF(WARNING, !c->GetUInt32Value("fs.deferSync.maxPending",
+                                           &o->maxPending))
+            << "Not found `fs.deferSync.maxPending` in conf, use default "
+               "value `"
+            << o->maxPending << '`';
     }
 }
 
@@ -424,6 +512,13 @@ void InitFuseClientOption(Configuration *conf, FuseClientOption *clientOption) {
                               &clientOption->listDentryLimit);
     conf->GetValueFatalIfFail("fuseClient.listDentryThreads",
                               &clientOption->listDentryThreads);
+    LOG_IF(WARNING,
+           !conf->GetUInt32Value(
+               "fuseClient.dirSummaryPropagateIntervalMs",
+               &clientOption->dirSummaryPropagateIntervalMs))
+        << "Not found `fuseClient.dirSummaryPropagateIntervalMs` in conf, "
+           "use default value `"
+        << clientOption->dirSummaryPropagateIntervalMs << '`';
     conf->GetValueFatalIfFail("client.dummyServer.startPort",
                               &clientOption->dummyServerStartPort);
     conf->GetValueFatalIfFail("fuseClient.enableMultiMountPointRename",
@@ -436,6 +531,50 @@ void InitFuseClientOption(Configuration *conf, FuseClientOption *clientOption) {
                                        &clientOption->enableFuseSplice))
         << "Not found `fuseClient.enableSplice` in conf, use default value `"
         << std::boolalpha << clientOption->enableFuseSplice << '`';
+    LOG_IF(WARNING,
+           !conf->GetBoolValue("fuseClient.enableWritebackCache",
+                               &clientOption->enableFuseWritebackCache))
+        << "Not found `fuseClient.enableWritebackCache` in conf, use default "
+           "value `"
+        << std::boolalpha << clientOption->enableFuseWritebackCache << '`';
+    LOG_IF(WARNING, !conf->GetUInt32Value("fuseClient.maxWriteBytes",
+                                          &clientOption->fuseMaxWriteBytes))
+        << "Not found `fuseClient.maxWriteBytes` in conf, use default value `"
+        << clientOption->fuseMaxWriteBytes << '`';
+    LOG_IF(WARNING, !conf->GetBoolValue("fuseClient.enableCompoundCreate",
+                                        &clientOption->enableCompoundCreate))
+        << "Not found `fuseClient.enableCompoundCreate` in conf, use default "
+           "value `"
+        << std::boolalpha << clientOption->enableCompoundCreate << '`';
+    LOG_IF(WARNING, !conf->GetBoolValue("fuseClient.enableExclusiveLease",
+                                        &clientOption->enableExclusiveLease))
+        << "Not found `fuseClient.enableExclusiveLease` in conf, use default "
+           "value `"
+        << std::boolalpha << clientOption->enableExclusiveLease << '`';
+    LOG_IF(WARNING, !conf->GetBoolValue("fuseClient.enableAsyncClose",
+                                        &clientOption->enableAsyncClose))
+        << "Not found `fuseClient.enableAsyncClose` in conf, use default "
+           "value `"
+        << std::boolalpha << clientOption->enableAsyncClose << '`';
+    LOG_IF(WARNING, !conf->GetUInt32Value("fuseClient.asyncCloseThreads",
+                                          &clientOption->asyncCloseThreads))
+        << "Not found `fuseClient.asyncCloseThreads` in conf, use default "
+           "value `"
+        << clientOption->asyncCloseThreads << '`';
+    LOG_IF(WARNING,
+           !conf->GetUInt32Value("fuseClient.asyncCloseMaxPendingFiles",
+                                 &clientOption->asyncCloseMaxPendingFiles))
+        << "Not found `fuseClient.asyncCloseMaxPendingFiles` in conf, use "
+           "default value `"
+        << clientOption->asyncCloseMaxPendingFiles << '`';
+    LOG_IF(WARNING, !conf->GetBoolValue("fuseClient.cloneFd",
+                                        &clientOption->fuseCloneFd))
+        << "Not found `fuseClient.cloneFd` in conf, use default value `"
+        << std::boolalpha << clientOption->fuseCloneFd << '`';
+    LOG_IF(WARNING, !conf->GetUInt32Value("fuseClient.maxIdleThreads",
+                                          &clientOption->fuseMaxIdleThreads))
+        << "Not found `fuseClient.maxIdleThreads` in conf, use default value `"
+        << clientOption->fuseMaxIdleThreads << '`';
 
     conf->GetValueFatalIfFail("fuseClient.throttle.avgWriteBytes",
                               &FLAGS_fuseClientAvgWriteBytes);
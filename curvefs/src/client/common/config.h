@@ -65,6 +65,8 @@ struct ExcutorOpt {
     uint64_t minRetryTimesForceTimeoutBackoff = 5;
     uint64_t maxRetryTimesBeforeConsiderSuspend = 20;
     uint32_t batchInodeAttrLimit = 10000;
+    // send the concurrent inode attribute gets of one partition by one rpc
+    bool multiplexGetInodeAttr = true;
     bool enableRenameParallel = false;
 };
 
@@ -77,6 +79,8 @@ struct LeaseOpt {
 struct KVClientManagerOpt {
     int setThreadPooln = 4;
     int getThreadPooln = 4;
+    // max gets sent by one multi-get
+    uint32_t getBatchSize = 64;
 };
 
 struct DiskCacheOption {
@@ -115,6 +119,11 @@ struct DiskCacheOption {
     uint64_t avgFlushIops;
     // the read throttle iops of disk cache
     uint64_t avgReadFileIops;
+    // layout of the read cache, "file": one file per object,
+    // "slab": all objects in one slab file
+    std::string readCacheLayout = "file";
+    // read and write the slab file with O_DIRECT
+    bool slabDirectIO = true;
 };
 
 struct S3ClientAdaptorOption {
@@ -139,6 +148,23 @@ struct S3ClientAdaptorOption {
     uint32_t maxReadRetryIntervalMs;
     uint32_t readRetryIntervalMs;
     uint32_t objectPrefix;
+    // lease chunk ids from mds in ranges and serve the flushes locally,
+    // the lease size adapts to keep one lease lasting about
+    // chunkIdLeaseTargetSec, |0| chunkIdLeaseMin means disabled
+    uint32_t chunkIdLeaseMin{0};
+    uint32_t chunkIdLeaseMax{0};
+    uint32_t chunkIdLeaseTargetSec{0};
+    // the files no larger than it keep their data in the inodes instead
+    // of s3, |0| means disabled
+    uint32_t inlineDataMaxSize{0};
+    // the flushes of a single block no larger than packMaxSliceSize are
+    // packed into shared objects of packMaxSize bytes or packMaxSlices
+    // slices at most, waiting packMaxDelayMs at most for others to join,
+    // |0| packMaxSliceSize means disabled
+    uint32_t packMaxSliceSize{0};
+    uint32_t packMaxSize{0};
+    uint32_t packMaxSlices{0};
+    uint32_t packMaxDelayMs{0};
     DiskCacheOption diskCacheOpt;
 };
 
@@ -149,6 +175,7 @@ struct S3Option {
 
 struct BlockGroupOption {
     uint32_t allocateOnce;
+    uint32_t maxAllocateOnce{0};
 };
 
 struct BitmapAllocatorOption {
@@ -170,6 +197,11 @@ struct VolumeOption {
 
     double threshold{1.0};
     uint64_t releaseInterSec{300};
+
+    uint64_t reserveSize{0};
+    uint32_t reserveShards{0};
+
+    uint32_t allocateAheadSec{0};
 };
 
 struct ExtentManagerOption {
@@ -196,6 +228,8 @@ struct VFSCacheOption {
 struct VFSOption {
     VFSCacheOption vfsCacheOption;
     UserPermissionOption userPermissionOption;
+    // threads to run the async read/write
+    uint32_t asyncIOThreads = 8;
 };
 // }
 
@@ -234,6 +268,8 @@ struct RPCOption {
 struct DeferSyncOption {
     uint32_t delay;
     bool deferDirMtime;
+    // sync ahead of the delay once so many inodes are pending
+    uint32_t maxPending = 4096;
 };
 
 struct FileSystemOption {
@@ -268,9 +304,33 @@ struct FuseClientOption {
 
     uint32_t listDentryLimit;
     uint32_t listDentryThreads;
+    // the interval of propagating the recursive summaries of directories
+    // one level up, |0| means not maintaining them
+    uint32_t dirSummaryPropagateIntervalMs = 0;
     uint32_t dummyServerStartPort;
     bool enableMultiMountPointRename = false;
     bool enableFuseSplice = false;
+    // let kernel cache the writes in page cache and write them back in
+    // big requests, the dirty pages are written back before flush
+    bool enableFuseWritebackCache = false;
+    // the max bytes of one write request, kernel sends a write with
+    // max_pages = maxWriteBytes / pagesize pages at most
+    uint32_t fuseMaxWriteBytes = 1048576;
+    // create inode and dentry by one rpc when possible
+    bool enableCompoundCreate = true;
+    // defer the close-to-open flush while the only mountpoint of fs
+    bool enableExclusiveLease = false;
+    // close returns without waiting for the flush of the file, which is
+    // flushed in background, fsync waits for it and gets its error
+    bool enableAsyncClose = false;
+    uint32_t asyncCloseThreads = 4;
+    // the closed files waiting for the background flush at most, the
+    // close beyond it flushes in place
+    uint32_t asyncCloseMaxPendingFiles = 1024;
+    // every fuse worker thread reads requests from its own cloned /dev/fuse
+    bool fuseCloneFd = true;
+    // keep so many idle fuse worker threads to avoid creating them again
+    uint32_t fuseMaxIdleThreads = 64;
     uint32_t downloadMaxRetryTimes;
     uint32_t warmupThreadsNum = 10;
 };
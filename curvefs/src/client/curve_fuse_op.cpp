@@ -23,6 +23,7 @@
 
 #include "curvefs/src/client/curve_fuse_op.h"
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
 #include <string>
@@ -109,6 +110,28 @@ void EnableSplice(struct fuse_conn_info* conn) {
     }
 }
 
+void EnableWritebackCache(struct fuse_conn_info* conn) {
+    if (!g_fuseClientOption->enableFuseWritebackCache) {
+        LOG(INFO) << "Fuse writeback cache is disabled";
+        return;
+    }
+
+    if (conn->capable & FUSE_CAP_WRITEBACK_CACHE) {
+        conn->want |= FUSE_CAP_WRITEBACK_CACHE;
+        LOG(INFO) << "FUSE_CAP_WRITEBACK_CACHE enabled";
+    }
+}
+
+// NOTE: libfuse negotiates the FUSE_MAX_PAGES with kernel by max_write,
+// and it will be limited to the receive buffer size of libfuse.
+void SetMaxWrite(struct fuse_conn_info* conn) {
+    uint32_t maxWrite = g_fuseClientOption->fuseMaxWriteBytes;
+    if (maxWrite > conn->max_write) {
+        conn->max_write = maxWrite;
+    }
+    LOG(INFO) << "Fuse max write = " << conn->max_write;
+}
+
 int GetFsInfo(const char* fsName, FsInfo* fsInfo) {
     MdsClientImpl mdsClient;
     MDSBaseClient mdsBase;
@@ -234,6 +257,18 @@ void UnInitFuseClient() {
     delete g_clientOpMetric;
 }
 
+void UpdateFuseLoopConfig(struct fuse_loop_config *config) {
+    if (g_fuseClientOption == nullptr) {
+        return;
+    }
+
+    if (g_fuseClientOption->fuseCloneFd) {
+        config->clone_fd = 1;
+    }
+    config->max_idle_threads = std::max(
+        config->max_idle_threads, g_fuseClientOption->fuseMaxIdleThreads);
+}
+
 int AddWarmupTask(curvefs::client::common::WarmupType type, fuse_ino_t key,
                   const std::string& path,
                   curvefs::client::common::WarmupStorageType storageType,
@@ -479,6 +514,8 @@ void FuseOpInit(void *userdata, struct fuse_conn_info *conn) {
         LOG(FATAL) << "FuseOpInit() failed, retCode = " << rc;
     } else {
         EnableSplice(conn);
+        EnableWritebackCache(conn);
+        SetMaxWrite(conn);
         LOG(INFO) << "FuseOpInit() success, retCode = " << rc;
     }
 }
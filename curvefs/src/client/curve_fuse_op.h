@@ -43,6 +43,12 @@ int InitFuseClient(const struct MountOption *mountOption);
 
 void UnInitFuseClient();
 
+/**
+ * Merge the fuse loop options in client config into the options
+ * parsed from the command line, only valid after InitFuseClient()
+ */
+void UpdateFuseLoopConfig(struct fuse_loop_config *config);
+
 /**
  * Initialize filesystem
  *
@@ -156,5 +156,35 @@ CURVEFS_ERROR DentryCacheManagerImpl::ListDentry(uint64_t parent,
     return CURVEFS_ERROR::OK;
 }
 
+CURVEFS_ERROR DentryCacheManagerImpl::ListDentryPages(
+    uint64_t parent, uint32_t limit, const ListDentryHandler &handler) {
+    std::string last = "";
+    bool perceed = true;
+    do {
+        std::list<Dentry> part;
+        MetaStatusCode ret = metaClient_->ListDentry(fsId_, parent, last,
+                                                     limit, false, &part);
+        VLOG(6) << "ListDentryPages fsId = " << fsId_
+                << ", parent = " << parent << ", last = " << last
+                << ", count = " << limit << ", ret = " << ret
+                << ", part.size() = " << part.size();
+        if (ret != MetaStatusCode::OK) {
+            LOG(ERROR) << "metaClient_ ListDentry failed"
+                       << ", MetaStatusCode_Name = " << MetaStatusCode_Name(ret)
+                       << ", parent = " << parent << ", last = " << last
+                       << ", count = " << limit;
+            return ToFSError(ret);
+        }
+
+        perceed = part.size() >= limit && !part.empty();
+        if (!part.empty()) {
+            last = part.back().name();
+        }
+        handler(&part, !perceed);
+    } while (perceed);
+
+    return CURVEFS_ERROR::OK;
+}
+
 }  // namespace client
 }  // namespace curvefs
@@ -25,6 +25,7 @@
 #define CURVEFS_SRC_CLIENT_DENTRY_CACHE_MANAGER_H_
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <list>
@@ -49,6 +50,11 @@ using ::curvefs::client::filesystem::CURVEFS_ERROR;
 static const char* kDentryKeyDelimiter = ":";
 
 class DentryCacheManager {
+ public:
+    // invoked with every page of dentries, |last| means no more pages
+    using ListDentryHandler =
+        std::function<void(std::list<Dentry> *dentryList, bool last)>;
+
  public:
     DentryCacheManager() : fsId_(0) {}
     virtual ~DentryCacheManager() {}
@@ -70,6 +76,19 @@ class DentryCacheManager {
         std::list<Dentry> *dentryList, uint32_t limit,
         bool onlyDir = false, uint32_t nlink = 0) = 0;
 
+    // list dentries page by page, the handler is invoked with every page
+    // before the next page is requested, so the caller can process one page
+    // while listing the next. The default lists all the dentries as one page.
+    virtual CURVEFS_ERROR ListDentryPages(uint64_t parent, uint32_t limit,
+                                          const ListDentryHandler &handler) {
+        std::list<Dentry> dentryList;
+        CURVEFS_ERROR rc = ListDentry(parent, &dentryList, limit);
+        if (rc == CURVEFS_ERROR::OK) {
+            handler(&dentryList, true);
+        }
+        return rc;
+    }
+
  protected:
     uint32_t fsId_;
 };
@@ -96,6 +115,9 @@ class DentryCacheManagerImpl : public DentryCacheManager {
         std::list<Dentry> *dentryList, uint32_t limit,
         bool dirOnly = false, uint32_t nlink = 0) override;
 
+    CURVEFS_ERROR ListDentryPages(uint64_t parent, uint32_t limit,
+                                  const ListDentryHandler &handler) override;
+
     std::string GetDentryCacheKey(uint64_t parent, const std::string &name) {
         return std::to_string(parent) + kDentryKeyDelimiter + name;
     }
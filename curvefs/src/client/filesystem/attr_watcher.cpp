@@ -35,12 +35,10 @@ AttrWatcher::AttrWatcher(AttrWatcherOption option,
       dirCache_(dirCache) {}
 
 void AttrWatcher::RemeberMtime(const InodeAttr& attr) {
-    WriteLockGuard lk(rwlock_);
     modifiedAt_->Put(attr.inodeid(), AttrMtime(attr));
 }
 
 bool AttrWatcher::GetMtime(Ino ino, TimeSpec* time) {
-    ReadLockGuard lk(rwlock_);
     return modifiedAt_->Get(ino, time);
 }
 
@@ -34,7 +34,7 @@ namespace curvefs {
 namespace client {
 namespace filesystem {
 
-using ::curve::common::LRUCache;
+using ::curve::common::ClockCache;
 using ::curve::common::RWLock;
 using ::curve::common::ReadLockGuard;
 using ::curve::common::WriteLockGuard;
@@ -42,7 +42,7 @@ using ::curvefs::client::common::AttrWatcherOption;
 
 class AttrWatcher {
  public:
-    using LRUType = LRUCache<Ino, struct TimeSpec>;
+    using LRUType = ClockCache<Ino, struct TimeSpec>;
 
  public:
     AttrWatcher(AttrWatcherOption option,
@@ -61,7 +61,6 @@ class AttrWatcher {
     friend class AttrWatcherGuard;
 
  private:
-    RWLock rwlock_;
     std::shared_ptr<LRUType> modifiedAt_;
     std::shared_ptr<OpenFiles> openFiles_;
     std::shared_ptr<DirCache> dirCache_;
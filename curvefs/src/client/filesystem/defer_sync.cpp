@@ -20,6 +20,7 @@
  * Author: Jingli Chen (Wine93)
  */
 
+#include <algorithm>
 #include <vector>
 #include <memory>
 
@@ -115,7 +116,7 @@ DeferSync::DeferSync(bool cto, DeferSyncOption option)
       mutex_(),
       running_(false),
       thread_(),
-      sleeper_(),
+      cond_(),
       pending_(),
       inodes_(std::make_shared<DeferInodes>(cto)) {}
 
@@ -129,7 +130,10 @@ void DeferSync::Start() {
 void DeferSync::Stop() {
     if (running_.exchange(false)) {
         LOG(INFO) << "Stop defer sync thread...";
-        sleeper_.interrupt();
+        {
+            LockGuard lk(mutex_);
+            cond_.notify_all();
+        }
         thread_.join();
         LOG(INFO) << "Defer sync thread stopped";
     }
@@ -146,20 +150,33 @@ SyncInodeClosure* DeferSync::NewSyncInodeClosure(
     return new SyncInodeClosure(inodes_, inode);
 }
 
+void DeferSync::SyncInodes(
+    const absl::btree_map<Ino, std::vector<std::shared_ptr<InodeWrapper>>>&
+        syncing) {
+    for (const auto& item : syncing) {
+        for (const auto& inode : item.second) {
+            auto closure = NewSyncInodeClosure(inode);
+            UniqueLock lk(inode->GetUniqueLock());
+            inode->Async(closure, true);
+        }
+    }
+}
+
 void DeferSync::SyncTask() {
-    std::vector<std::shared_ptr<InodeWrapper>> syncing;
+    absl::btree_map<Ino, std::vector<std::shared_ptr<InodeWrapper>>> syncing;
     for ( ;; ) {
-        bool running = sleeper_.wait_for(std::chrono::seconds(option_.delay));
-
+        bool running;
         {
-            LockGuard lk(mutex_);
+            UniqueLock lk(mutex_);
+            cond_.wait_for(lk, std::chrono::seconds(option_.delay), [&]() {
+                return !running_.load() ||
+                       pending_.size() >= option_.maxPending;
+            });
+            running = running_.load();
             syncing.swap(pending_);
         }
-        for (const auto& inode : syncing) {
-            auto closure = NewSyncInodeClosure(inode);
-            UniqueLock lk(inode->GetUniqueLock());
-            inode->Async(closure, true);
-        }
+
+        SyncInodes(syncing);
         syncing.clear();
 
         if (!running) {
@@ -170,8 +187,14 @@ void DeferSync::SyncTask() {
 
 void DeferSync::Push(const std::shared_ptr<InodeWrapper>& inode) {
     LockGuard lk(mutex_);
-    pending_.emplace_back(inode);
+    auto& inodes = pending_[inode->GetInodeId()];
+    if (std::find(inodes.begin(), inodes.end(), inode) == inodes.end()) {
+        inodes.emplace_back(inode);
+    }
     inodes_->Add(inode);
+    if (pending_.size() >= option_.maxPending) {
+        cond_.notify_one();
+    }
 }
 
 bool DeferSync::IsDefered(Ino ino, std::shared_ptr<InodeWrapper>* inode) {
@@ -28,7 +28,7 @@
 #include <memory>
 
 #include "absl/container/btree_map.h"
-#include "src/common/interruptible_sleeper.h"
+#include "src/common/concurrent/concurrent.h"
 #include "curvefs/src/client/common/config.h"
 #include "curvefs/src/client/rpcclient/task_excutor.h"
 #include "curvefs/src/client/filesystem/meta.h"
@@ -39,7 +39,7 @@ namespace filesystem {
 
 using ::curve::common::RWLock;
 using ::curve::common::Mutex;
-using ::curve::common::InterruptibleSleeper;
+using ::curve::common::ConditionVariable;
 using ::curvefs::client::common::DeferSyncOption;
 using ::curvefs::client::rpcclient::MetaServerClientDone;
 
@@ -74,6 +74,12 @@ class SyncInodeClosure : public MetaServerClientDone {
     std::shared_ptr<InodeWrapper> inode_;
 };
 
+// DeferSync writes the inode attributes back in the background:
+//   (1) the same inode pushed many times within one delay is synced once,
+//       so a stream of small writes costs one metaserver update per delay;
+//   (2) all pending inodes are dispatched together in inode id order;
+//   (3) the staleness is bounded by the delay, and the sync starts ahead of
+//       it once the pending inodes reach |maxPending|.
 class DeferSync {
  public:
     explicit DeferSync(bool cto, DeferSyncOption option);
@@ -92,6 +98,10 @@ class DeferSync {
 
     void SyncTask();
 
+    void SyncInodes(
+        const absl::btree_map<Ino, std::vector<std::shared_ptr<InodeWrapper>>>&
+            syncing);
+
  private:
     friend class SyncInodeClosure;
 
@@ -101,8 +111,10 @@ class DeferSync {
     Mutex mutex_;
     std::atomic<bool> running_;
     std::thread thread_;
-    InterruptibleSleeper sleeper_;
-    std::vector<std::shared_ptr<InodeWrapper>> pending_;
+    ConditionVariable cond_;
+    // NOTE: the inode wrapper is the unit of coalescing, it's rare but
+    // possible that there are different wrappers for one inode.
+    absl::btree_map<Ino, std::vector<std::shared_ptr<InodeWrapper>>> pending_;
     std::shared_ptr<DeferInodes> inodes_;
 };
 
@@ -58,7 +58,6 @@ std::string LookupCache::CacheKey(Ino parent, const std::string& name) {
 
 bool LookupCache::Get(Ino parent, const std::string& name) {
     RETURN_FALSE_IF_DISABLED();
-    ReadLockGuard lk(rwlock_);
     CacheEntry entry;
     auto key = CacheKey(parent, name);
     bool yes = lru_->Get(key, &entry);
@@ -34,7 +34,7 @@ namespace curvefs {
 namespace client {
 namespace filesystem {
 
-using ::curve::common::LRUCache;
+using ::curve::common::ClockCache;
 using ::curve::common::RWLock;
 using ::curve::common::ReadLockGuard;
 using ::curve::common::WriteLockGuard;
@@ -49,7 +49,7 @@ class LookupCache {
         TimeSpec expireTime;
     };
 
-    using LRUType = LRUCache<std::string, CacheEntry>;
+    using LRUType = ClockCache<std::string, CacheEntry>;
 
  public:
     explicit LookupCache(LookupCacheOption option);
@@ -65,6 +65,8 @@ class LookupCache {
 
  private:
     bool enable_;
+    // NOTE: the cache itself is thread-safe, the lock only serializes
+    // the read-modify-write of Put() and Delete(), the Get() is lock-free.
     RWLock rwlock_;
     LookupCacheOption option_;
     std::shared_ptr<LRUType> lru_;
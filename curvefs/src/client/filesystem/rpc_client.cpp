@@ -26,6 +26,8 @@
 #include <string>
 #include <memory>
 #include <utility>
+#include <vector>
+#include <future>
 
 #include "curvefs/src/client/filesystem/rpc_client.h"
 
@@ -70,50 +72,83 @@ CURVEFS_ERROR RPCClient::Lookup(Ino parent,
     return rc;
 }
 
+CURVEFS_ERROR RPCClient::GetPageAttrs(Ino ino, DirPage* page) {
+    std::set<uint64_t> inos;
+    std::for_each(page->dentries.begin(), page->dentries.end(),
+                  [&](Dentry& dentry) { inos.emplace(dentry.inodeid()); });
+    CURVEFS_ERROR rc =
+        inodeManager_->BatchGetInodeAttrAsync(ino, &inos, &page->attrs);
+    if (rc != CURVEFS_ERROR::OK) {
+        LOG(ERROR) << "rpc(readdir::BatchGetInodeAttrAsync) failed"
+                   << ", retCode = " << rc << ", ino = " << ino;
+    }
+    return rc;
+}
+
 CURVEFS_ERROR RPCClient::ReadDir(Ino ino,
                                  std::shared_ptr<DirEntryList>* entries) {
     uint32_t limit = option_.listDentryLimit;
 
-    std::list<Dentry> dentries;
-    CURVEFS_ERROR rc = dentryManager_->ListDentry(ino, &dentries, limit);
+    // the attributes of one page are fetched in background while listing
+    // the next page, the last page (also the only page of a small
+    // directory) is fetched in the current thread.
+    std::vector<std::shared_ptr<DirPage>> pages;
+    auto handler = [&](std::list<Dentry>* dentries, bool last) {
+        if (dentries->empty()) {
+            return;
+        }
+        auto page = std::make_shared<DirPage>();
+        page->dentries.swap(*dentries);
+        if (last) {
+            page->rc = GetPageAttrs(ino, page.get());
+        } else {
+            page->future = std::async(std::launch::async, [this, ino, page]() {
+                page->rc = GetPageAttrs(ino, page.get());
+            });
+        }
+        pages.push_back(page);
+    };
+
+    CURVEFS_ERROR rc = dentryManager_->ListDentryPages(ino, limit, handler);
+    for (const auto& page : pages) {
+        if (page->future.valid()) {
+            page->future.wait();
+        }
+    }
+
     if (rc != CURVEFS_ERROR::OK) {
         LOG(ERROR) << "rpc(readdir::ListDentry) failed, retCode = " << rc
                    << ", ino = " << ino;
         return rc;
-    } else if (dentries.size() == 0) {
+    } else if (pages.empty()) {
         VLOG(3) << "rpc(readdir::ListDentry) success and directory is empty"
                 << ", ino = " << ino;
         return rc;
     }
 
-    std::set<uint64_t> inos;
-    std::map<uint64_t, InodeAttr> attrs;
-    std::for_each(dentries.begin(), dentries.end(), [&](Dentry& dentry){
-        inos.emplace(dentry.inodeid());
-    });
-    rc = inodeManager_->BatchGetInodeAttrAsync(ino, &inos, &attrs);
-    if (rc != CURVEFS_ERROR::OK) {
-        LOG(ERROR) << "rpc(readdir::BatchGetInodeAttrAsync) failed"
-                   << ", retCode = " << rc << ", ino = " << ino;
-        return rc;
-    }
-
     DirEntry dirEntry;
-    for (const auto& dentry : dentries) {
-        Ino ino = dentry.inodeid();
-        auto iter = attrs.find(ino);
-        if (iter == attrs.end()) {
-            LOG(WARNING) << "rpc(readdir::BatchGetInodeAttrAsync) "
-                         << "missing attribute, ino = " << ino;
-            continue;
+    for (const auto& page : pages) {
+        if (page->rc != CURVEFS_ERROR::OK) {
+            return page->rc;
         }
 
-        // NOTE: we can't use std::move() for attribute for hard link
-        // which will sharing inode attribute.
-        dirEntry.ino = ino;
-        dirEntry.name = std::move(dentry.name());
-        dirEntry.attr = iter->second;
-        (*entries)->Add(dirEntry);
+        const auto& attrs = page->attrs;
+        for (const auto& dentry : page->dentries) {
+            Ino ino = dentry.inodeid();
+            auto iter = attrs.find(ino);
+            if (iter == attrs.end()) {
+                LOG(WARNING) << "rpc(readdir::BatchGetInodeAttrAsync) "
+                             << "missing attribute, ino = " << ino;
+                continue;
+            }
+
+            // NOTE: we can't use std::move() for attribute for hard link
+            // which will sharing inode attribute.
+            dirEntry.ino = ino;
+            dirEntry.name = dentry.name();
+            dirEntry.attr = iter->second;
+            (*entries)->Add(dirEntry);
+        }
     }
     return CURVEFS_ERROR::OK;
 }
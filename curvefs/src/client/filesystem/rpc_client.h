@@ -23,6 +23,9 @@
 #ifndef CURVEFS_SRC_CLIENT_FILESYSTEM_RPC_CLIENT_H_
 #define CURVEFS_SRC_CLIENT_FILESYSTEM_RPC_CLIENT_H_
 
+#include <map>
+#include <list>
+#include <future>
 #include <memory>
 #include <string>
 
@@ -52,6 +55,17 @@ class RPCClient {
 
     CURVEFS_ERROR Open(Ino ino, std::shared_ptr<InodeWrapper>* inode);
 
+ private:
+    // one page of dentries and their attributes
+    struct DirPage {
+        std::list<Dentry> dentries;
+        std::map<uint64_t, InodeAttr> attrs;
+        CURVEFS_ERROR rc = CURVEFS_ERROR::OK;
+        std::future<void> future;
+    };
+
+    CURVEFS_ERROR GetPageAttrs(Ino ino, DirPage* page);
+
  private:
     RPCOption option_;
     std::shared_ptr<InodeCacheManager> inodeManager_;
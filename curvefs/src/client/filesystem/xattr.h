@@ -42,6 +42,12 @@ const char XATTR_DIR_RFILES[] = "curve.dir.rfiles";
 const char XATTR_DIR_RSUBDIRS[] = "curve.dir.rsubdirs";
 const char XATTR_DIR_RENTRIES[] = "curve.dir.rentries";
 const char XATTR_DIR_RFBYTES[] = "curve.dir.rfbytes";
+// the recursive summary kept in the directory and updated incrementally,
+// rsum.fbytes excludes the length of the directory itself
+const char XATTR_DIR_RSUM_FILES[] = "curve.dir.rsum.files";
+const char XATTR_DIR_RSUM_SUBDIRS[] = "curve.dir.rsum.subdirs";
+const char XATTR_DIR_RSUM_ENTRIES[] = "curve.dir.rsum.entries";
+const char XATTR_DIR_RSUM_FBYTES[] = "curve.dir.rsum.fbytes";
 const char XATTR_DIR_PREFIX[] = "curve.dir";
 const char XATTR_WARMUP_OP[] = "curvefs.warmup.op";
 const char XATTR_WARMUP_OP_LIST[] = "curvefs.warmup.op.list";
@@ -56,6 +62,10 @@ inline bool IsSpecialXAttr(const std::string& key) {
         { XATTR_DIR_RSUBDIRS, true },
         { XATTR_DIR_RENTRIES, true },
         { XATTR_DIR_RFBYTES, true },
+        { XATTR_DIR_RSUM_FILES, true },
+        { XATTR_DIR_RSUM_SUBDIRS, true },
+        { XATTR_DIR_RSUM_ENTRIES, true },
+        { XATTR_DIR_RSUM_FBYTES, true },
         { XATTR_DIR_PREFIX, true },
     };
     return xattrs.find(key) != xattrs.end();
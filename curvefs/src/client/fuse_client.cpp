@@ -24,11 +24,13 @@
 #include "curvefs/src/client/fuse_client.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <list>
 #include <memory>
 #include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -159,7 +161,9 @@ CURVEFS_ERROR FuseClient::Init(const FuseClientOption &option) {
                                                       &enableSumInDir_);
 
     xattrManager_ = std::make_shared<XattrManager>(inodeManager_,
-        dentryManager_, option_.listDentryLimit, option_.listDentryThreads);
+        dentryManager_, option_.listDentryLimit, option_.listDentryThreads,
+        option_.dirSummaryPropagateIntervalMs);
+    xattrManager_->Start();
 
     uint32_t listenPort = 0;
     if (!curve::common::StartBrpcDummyserver(option.dummyServerStartPort,
@@ -409,7 +413,23 @@ CURVEFS_ERROR FuseClient::MakeNode(
     param.rdev = rdev;
     param.parent = parent;
 
-    CURVEFS_ERROR ret = inodeManager_->CreateInode(param, inodeWrapper);
+    Dentry dentry;
+    dentry.set_fsid(fsInfo_->fsid());
+    dentry.set_parentinodeid(parent);
+    dentry.set_name(name);
+    dentry.set_type(type);
+    if (type == FsFileType::TYPE_FILE || type == FsFileType::TYPE_S3) {
+        dentry.set_flag(DentryFlag::TYPE_FILE_FLAG);
+    }
+
+    CURVEFS_ERROR ret;
+    bool dentryCreated = false;
+    if (option_.enableCompoundCreate) {
+        ret = inodeManager_->CreateInodeWithDentry(param, dentry, inodeWrapper,
+                                                   &dentryCreated);
+    } else {
+        ret = inodeManager_->CreateInode(param, inodeWrapper);
+    }
     if (ret != CURVEFS_ERROR::OK) {
         LOG(ERROR) << "inodeManager CreateInode fail, ret = " << ret
                    << ", parent = " << parent << ", name = " << name
@@ -420,18 +440,13 @@ CURVEFS_ERROR FuseClient::MakeNode(
     VLOG(6) << "inodeManager CreateInode success"
             << ", parent = " << parent << ", name = " << name
             << ", mode = " << mode
-            << ", inode id = " << inodeWrapper->GetInodeId();
+            << ", inode id = " << inodeWrapper->GetInodeId()
+            << ", dentry created = " << dentryCreated;
 
-    Dentry dentry;
-    dentry.set_fsid(fsInfo_->fsid());
     dentry.set_inodeid(inodeWrapper->GetInodeId());
-    dentry.set_parentinodeid(parent);
-    dentry.set_name(name);
     dentry.set_type(inodeWrapper->GetType());
-    if (type == FsFileType::TYPE_FILE || type == FsFileType::TYPE_S3) {
-        dentry.set_flag(DentryFlag::TYPE_FILE_FLAG);
-    }
-    ret = dentryManager_->CreateDentry(dentry);
+    ret = dentryCreated ? CURVEFS_ERROR::OK
+                        : dentryManager_->CreateDentry(dentry);
     if (ret != CURVEFS_ERROR::OK) {
         LOG(ERROR) << "dentryManager_ CreateDentry fail, ret = " << ret
                    << ", parent = " << parent << ", name = " << name
@@ -1330,6 +1345,20 @@ FuseClient::SetMountStatus(const struct MountOption *mountOption) {
     }
 
     auto ret = mdsClient_->MountFs(fsName, mountpoint_, fsInfo_.get());
+    // another client holding the exclusive lease is flushing what it
+    // deferred, wait it done or timeout (mds umount it if it's dead)
+    const LeaseOpt& leaseOpt = option_.leaseOpt;
+    uint64_t intervalUs = leaseOpt.leaseTimeUs /
+                          std::max(leaseOpt.refreshTimesPerLease, 1u);
+    uint64_t waitUs = 0;
+    while (ret == FSStatusCode::EXCLUSIVE_LEASE_RECALLING &&
+           waitUs < 3ull * leaseOpt.leaseTimeUs) {
+        LOG(INFO) << "MountFs wait exclusive lease recalled, fsName = "
+                  << fsName << ", waited = " << waitUs << "us";
+        std::this_thread::sleep_for(std::chrono::microseconds(intervalUs));
+        waitUs += intervalUs;
+        ret = mdsClient_->MountFs(fsName, mountpoint_, fsInfo_.get());
+    }
     if (ret != FSStatusCode::OK && ret != FSStatusCode::MOUNT_POINT_EXIST) {
         LOG(ERROR) << "MountFs failed, FSStatusCode = " << ret
                    << ", FSStatusCode_Name = " << FSStatusCode_Name(ret)
@@ -28,6 +28,7 @@
 
 #include "curvefs/src/client/filesystem/xattr.h"
 #include "curvefs/src/client/kvclient/memcache_client.h"
+#include "curvefs/src/client/rpcclient/exclusive_lease.h"
 #include "curvefs/src/client/rpcclient/fsdelta_updater.h"
 #include "curvefs/src/client/rpcclient/fsquota_checker.h"
 
@@ -107,6 +108,23 @@ CURVEFS_ERROR FuseS3Client::Init(const FuseClientOption &option) {
     }
     ioLatencyMetric_ = absl::make_unique<metric::FuseS3ClientIOLatencyMetric>(
         fsInfo_->fsname());
+
+    // the close-to-open flush is deferred while holding the exclusive lease,
+    // and done when the lease is recalled
+    ExclusiveLease::GetInstance().Init(
+        FLAGS_enableCto && option.enableExclusiveLease,
+        [this](const std::set<uint64_t>& inos) {
+            for (const auto& ino : inos) {
+                FlushAllAndSync(ino);
+            }
+        });
+
+    if (option.enableAsyncClose) {
+        closeFlusher_.reset(new CloseFlusher(
+            option.asyncCloseThreads, option.asyncCloseMaxPendingFiles,
+            [this](uint64_t ino) { return FlushOnClose(ino); }));
+        closeFlusher_->Start();
+    }
     return ret;
 }
 
@@ -144,6 +162,10 @@ bool FuseS3Client::InitKVCache(const KVClientManagerOpt &opt) {
 }
 
 void FuseS3Client::UnInit() {
+    if (closeFlusher_ != nullptr) {
+        closeFlusher_->Stop();
+    }
+    ExclusiveLease::GetInstance().Init(false, nullptr);
     FuseClient::UnInit();
     s3Adaptor_->Stop();
     curve::common::S3Adapter::Shutdown();
@@ -365,12 +387,23 @@ CURVEFS_ERROR FuseS3Client::FuseOpFsync(fuse_req_t req, fuse_ino_t ino,
     (void)fi;
     VLOG(1) << "FuseOpFsync, ino: " << ino << ", datasync: " << datasync;
 
+    // the error of the background flush after close is reported here
+    CURVEFS_ERROR deferred = CURVEFS_ERROR::OK;
+    if (closeFlusher_ != nullptr) {
+        deferred = closeFlusher_->Wait(ino);
+    }
+
     CURVEFS_ERROR ret = s3Adaptor_->Flush(ino);
     if (ret != CURVEFS_ERROR::OK) {
         LOG(ERROR) << "s3Adaptor_ flush failed, ret = " << ret
                    << ", inodeid = " << ino;
         return ret;
     }
+    if (deferred != CURVEFS_ERROR::OK) {
+        LOG(ERROR) << "FuseOpFsync, flush after close failed, ret = "
+                   << deferred << ", inodeid = " << ino;
+        return deferred;
+    }
     if (datasync != 0) {
         return CURVEFS_ERROR::OK;
     }
@@ -394,34 +427,24 @@ CURVEFS_ERROR FuseS3Client::FuseOpFlush(fuse_req_t req, fuse_ino_t ino,
     (void)req;
     (void)fi;
     VLOG(1) << "FuseOpFlush, ino: " << ino;
-    CURVEFS_ERROR ret = CURVEFS_ERROR::OK;
-
-    // if enableCto, flush all write cache both in memory cache and disk cache
-    if (FLAGS_enableCto) {
-        ret = s3Adaptor_->FlushAllCache(ino);
-        if (ret != CURVEFS_ERROR::OK) {
-            LOG(ERROR) << "FuseOpFlush, flush all cache fail, ret = " << ret
-                       << ", ino: " << ino;
-            return ret;
-        }
-        VLOG(3) << "FuseOpFlush, flush to s3 ok";
+    if (closeFlusher_ != nullptr && closeFlusher_->Submit(ino)) {
+        VLOG(1) << "FuseOpFlush, ino: " << ino << " flush in background";
+        return CURVEFS_ERROR::OK;
+    }
+    return FlushOnClose(ino);
+}
 
-        std::shared_ptr<InodeWrapper> inodeWrapper;
-        ret = inodeManager_->GetInode(ino, inodeWrapper);
-        if (ret != CURVEFS_ERROR::OK) {
-            LOG(ERROR) << "FuseOpFlush, inodeManager get inode fail, ret = "
-                       << ret << ", ino: " << ino;
-            return ret;
-        }
+CURVEFS_ERROR FuseS3Client::FlushOnClose(fuse_ino_t ino) {
+    CURVEFS_ERROR ret = CURVEFS_ERROR::OK;
 
-        ::curve::common::UniqueLock lgGuard = inodeWrapper->GetUniqueLock();
-        ret = inodeWrapper->Sync();
+    // if enableCto, flush all write cache both in memory cache and disk cache,
+    // unless nobody else can open it with the exclusive lease held
+    if (FLAGS_enableCto && !ExclusiveLease::GetInstance().Defer(ino)) {
+        ret = FlushAllAndSync(ino);
         if (ret != CURVEFS_ERROR::OK) {
-            LOG(ERROR) << "FuseOpFlush, inode sync s3 chunk info fail, ret = "
-                       << ret << ", ino: " << ino;
             return ret;
         }
-    // if disableCto, flush just flush data in memory
+    // if disableCto or deferred, flush just flush data in memory
     } else {
         ret = s3Adaptor_->Flush(ino);
         if (ret != CURVEFS_ERROR::OK) {
@@ -435,7 +458,43 @@ CURVEFS_ERROR FuseS3Client::FuseOpFlush(fuse_req_t req, fuse_ino_t ino,
     return CURVEFS_ERROR::OK;
 }
 
+CURVEFS_ERROR FuseS3Client::FlushAllAndSync(fuse_ino_t ino) {
+    CURVEFS_ERROR ret = s3Adaptor_->FlushAllCache(ino);
+    if (ret != CURVEFS_ERROR::OK) {
+        LOG(ERROR) << "FuseOpFlush, flush all cache fail, ret = " << ret
+                   << ", ino: " << ino;
+        return ret;
+    }
+    VLOG(3) << "FuseOpFlush, flush to s3 ok";
+
+    std::shared_ptr<InodeWrapper> inodeWrapper;
+    ret = inodeManager_->GetInode(ino, inodeWrapper);
+    if (ret != CURVEFS_ERROR::OK) {
+        LOG(ERROR) << "FuseOpFlush, inodeManager get inode fail, ret = "
+                   << ret << ", ino: " << ino;
+        return ret;
+    }
+
+    ::curve::common::UniqueLock lgGuard = inodeWrapper->GetUniqueLock();
+    ret = inodeWrapper->Sync();
+    if (ret != CURVEFS_ERROR::OK) {
+        LOG(ERROR) << "FuseOpFlush, inode sync s3 chunk info fail, ret = "
+                   << ret << ", ino: " << ino;
+    }
+    return ret;
+}
+
 void FuseS3Client::FlushData() {
+    // flush what deferred by the exclusive lease before umount
+    auto& exclusiveLease = ExclusiveLease::GetInstance();
+    exclusiveLease.Update(false);
+    exclusiveLease.HandleRecall();
+
+    // the closed files are flushed again by FsSync if failed in background
+    if (closeFlusher_ != nullptr) {
+        closeFlusher_->WaitAll();
+    }
+
     CURVEFS_ERROR ret = CURVEFS_ERROR::UNKNOWN;
     do {
         ret = s3Adaptor_->FsSync();
@@ -30,6 +30,7 @@
 #include <utility>
 #include <vector>
 
+#include "curvefs/src/client/close_flusher.h"
 #include "curvefs/src/client/fuse_client.h"
 #include "curvefs/src/client/metric/client_metric.h"
 #include "curvefs/src/client/s3/client_s3_cache_manager.h"
@@ -128,6 +129,13 @@ class FuseS3Client : public FuseClient {
  private:
     bool InitKVCache(const KVClientManagerOpt &opt);
 
+    // flush all write cache both in memory cache and disk cache to s3,
+    // and sync the inode
+    CURVEFS_ERROR FlushAllAndSync(fuse_ino_t ino);
+
+    // the flush of close, in place or by closeFlusher_
+    CURVEFS_ERROR FlushOnClose(fuse_ino_t ino);
+
     void FlushData() override;
 
  private:
@@ -135,6 +143,8 @@ class FuseS3Client : public FuseClient {
     std::shared_ptr<S3ClientAdaptor> s3Adaptor_;
     std::shared_ptr<KVClientManager> kvClientManager_;
     std::unique_ptr<metric::FuseS3ClientIOLatencyMetric> ioLatencyMetric_;
+    // nullptr unless enableAsyncClose
+    std::unique_ptr<CloseFlusher> closeFlusher_;
 
     static constexpr auto MIN_WRITE_CACHE_SIZE = 8 * kMiB;
 };
@@ -106,6 +106,8 @@ CURVEFS_ERROR FuseVolumeClient::FuseOpInit(void *userdata,
                                            ":" + mountpoint_.path();
     option.blockGroupManagerOption.blockGroupAllocateOnce =
         volOpts_.allocatorOption.blockGroupOption.allocateOnce;
+    option.blockGroupManagerOption.blockGroupMaxAllocateOnce =
+        volOpts_.allocatorOption.blockGroupOption.maxAllocateOnce;
     option.blockGroupManagerOption.blockGroupSize =
         fsInfo_->detail().volume().blockgroupsize();
     option.blockGroupManagerOption.blockSize =
@@ -118,6 +120,9 @@ CURVEFS_ERROR FuseVolumeClient::FuseOpInit(void *userdata,
         volOpts_.allocatorOption.bitmapAllocatorOption.smallAllocProportion;
     option.threshold = volOpts_.threshold;
     option.releaseInterSec = volOpts_.releaseInterSec;
+    option.reserveSize = volOpts_.reserveSize;
+    option.reserveShards = volOpts_.reserveShards;
+    option.allocateAheadSec = volOpts_.allocateAheadSec;
 
     spaceManager_ = absl::make_unique<SpaceManagerImpl>(option, mdsClient_,
                                                         blockDeviceClient_);
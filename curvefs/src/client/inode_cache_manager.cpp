@@ -289,6 +289,34 @@ CURVEFS_ERROR InodeCacheManagerImpl::CreateInode(
     return CURVEFS_ERROR::OK;
 }
 
+CURVEFS_ERROR InodeCacheManagerImpl::CreateInodeWithDentry(
+    const InodeParam &param, const Dentry &dentry,
+    std::shared_ptr<InodeWrapper> &out, bool *dentryCreated) {
+    Inode inode;
+    MetaStatusCode ret = metaClient_->CreateInodeWithDentry(param, dentry,
+                                                            &inode,
+                                                            dentryCreated);
+    if (ret == MetaStatusCode::PARTITION_ALLOC_ID_FAIL) {
+        // the partition of parent is full, create inode in another one
+        VLOG(3) << "partition of parent " << dentry.parentinodeid()
+                << " can't allocate inode, create inode only";
+        *dentryCreated = false;
+        return CreateInode(param, out);
+    }
+    if (ret != MetaStatusCode::OK) {
+        LOG(ERROR) << "metaClient_ CreateInodeWithDentry failed,"
+                   << " MetaStatusCode = " << ret
+                   << ", MetaStatusCode_Name = " << MetaStatusCode_Name(ret)
+                   << ", parent = " << dentry.parentinodeid()
+                   << ", name = " << dentry.name();
+        return ToFSError(ret);
+    }
+    out = std::make_shared<InodeWrapper>(std::move(inode), metaClient_,
+        s3ChunkInfoMetric_, option_.maxDataSize,
+        option_.refreshDataIntervalSec);
+    return CURVEFS_ERROR::OK;
+}
+
 CURVEFS_ERROR InodeCacheManagerImpl::CreateManageInode(
     const InodeParam &param,
     std::shared_ptr<InodeWrapper> &out) {
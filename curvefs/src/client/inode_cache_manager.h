@@ -50,6 +50,7 @@
 
 using ::curve::common::LRUCache;
 using ::curve::common::CacheMetrics;
+using ::curvefs::metaserver::Dentry;
 using ::curvefs::metaserver::InodeAttr;
 using ::curvefs::metaserver::XAttr;
 using ::curve::common::Atomic;
@@ -106,6 +107,12 @@ class InodeCacheManager {
     virtual CURVEFS_ERROR CreateInode(const InodeParam &param,
         std::shared_ptr<InodeWrapper> &out) = 0;   // NOLINT
 
+    // create the inode and its dentry by one rpc if possible, otherwise
+    // only create the inode and leave dentryCreated false
+    virtual CURVEFS_ERROR CreateInodeWithDentry(const InodeParam &param,
+        const Dentry &dentry, std::shared_ptr<InodeWrapper> &out,   // NOLINT
+        bool *dentryCreated) = 0;
+
     virtual CURVEFS_ERROR CreateManageInode(const InodeParam &param,
         std::shared_ptr<InodeWrapper> &out) = 0;   // NOLINT
 
@@ -175,6 +182,10 @@ class InodeCacheManagerImpl : public InodeCacheManager,
     CURVEFS_ERROR CreateInode(const InodeParam &param,
         std::shared_ptr<InodeWrapper> &out) override;
 
+    CURVEFS_ERROR CreateInodeWithDentry(const InodeParam &param,
+        const Dentry &dentry, std::shared_ptr<InodeWrapper> &out,   // NOLINT
+        bool *dentryCreated) override;
+
     CURVEFS_ERROR CreateManageInode(const InodeParam &param,
         std::shared_ptr<InodeWrapper> &out) override;
 
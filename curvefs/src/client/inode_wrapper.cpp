@@ -24,8 +24,11 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <ctime>
+#include <iterator>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <sstream>
@@ -91,6 +94,47 @@ void AppendS3ChunkInfoToMap(uint64_t chunkIndex, const S3ChunkInfo &info,
     }
 }
 
+int CompactS3ChunkInfoList(S3ChunkInfoList *s3ChunkInfoList) {
+    auto *chunks = s3ChunkInfoList->mutable_s3chunks();
+    const int size = chunks->size();
+    // the ranges covered by the infos visited, begin -> end, disjoint
+    std::map<uint64_t, uint64_t> covered;
+    std::vector<bool> keep(size, true);
+    for (int i = size - 1; i >= 0; i--) {
+        uint64_t begin = chunks->Get(i).offset();
+        uint64_t end = begin + chunks->Get(i).len();
+        auto it = covered.upper_bound(begin);
+        if (it != covered.begin()) {
+            auto prev = std::prev(it);
+            if (prev->second >= end) {
+                keep[i] = false;
+                continue;
+            }
+            if (prev->second >= begin) {
+                begin = prev->first;
+                it = covered.erase(prev);
+            }
+        }
+        while (it != covered.end() && it->first <= end) {
+            end = std::max(end, it->second);
+            it = covered.erase(it);
+        }
+        covered.emplace(begin, end);
+    }
+
+    int kept = 0;
+    for (int i = 0; i < size; i++) {
+        if (keep[i]) {
+            if (i != kept) {
+                chunks->SwapElements(i, kept);
+            }
+            kept++;
+        }
+    }
+    chunks->DeleteSubrange(kept, size - kept);
+    return size - kept;
+}
+
 class UpdateInodeAsyncDone : public MetaServerClientDone {
  public:
     UpdateInodeAsyncDone(const std::shared_ptr<InodeWrapper>& inodeWrapper,
@@ -284,6 +328,39 @@ void InodeWrapper::FlushVolumeExtentAsync() {
                                          dirtyExtents, closure);
 }
 
+namespace {
+
+// the lists shorter than it are not compacted
+constexpr int kMinS3ChunkInfoCompactSize = 64;
+
+bool ShouldCompact(int size) {
+    return size >= kMinS3ChunkInfoCompactSize && (size & (size - 1)) == 0;
+}
+
+}  // namespace
+
+void InodeWrapper::MaybeCompactS3ChunkInfoLocked(uint64_t chunkIndex) {
+    auto it = inode_.mutable_s3chunkinfomap()->find(chunkIndex);
+    if (it == inode_.mutable_s3chunkinfomap()->end() ||
+        !ShouldCompact(it->second.s3chunks_size())) {
+        return;
+    }
+    int removed = CompactS3ChunkInfoList(&it->second);
+    VLOG(6) << "compact s3chunkinfo of inode = " << inode_.inodeid()
+            << ", chunkIndex = " << chunkIndex << ", removed = " << removed
+            << ", left = " << it->second.s3chunks_size();
+    s3ChunkInfoSize_ -= removed;
+    UpdateS3ChunkInfoMetric(-removed);
+}
+
+void InodeWrapper::CompactS3ChunkInfoMap() {
+    for (auto &item : *inode_.mutable_s3chunkinfomap()) {
+        if (item.second.s3chunks_size() >= kMinS3ChunkInfoCompactSize) {
+            CompactS3ChunkInfoList(&item.second);
+        }
+    }
+}
+
 CURVEFS_ERROR InodeWrapper::RefreshS3ChunkInfo() {
     curve::common::UniqueLock lock = GetSyncingS3ChunkInfoUniqueLock();
     google::protobuf::Map<
@@ -300,6 +377,7 @@ CURVEFS_ERROR InodeWrapper::RefreshS3ChunkInfo() {
     }
     auto before = s3ChunkInfoSize_;
     inode_.mutable_s3chunkinfomap()->swap(s3ChunkInfoMap);
+    CompactS3ChunkInfoMap();
     UpdateS3ChunkInfoMetric(CalS3ChunkInfoSize() - before);
     ClearS3ChunkInfoAdd();
     UpdateMaxS3ChunkInfoSize();
@@ -72,6 +72,10 @@ std::ostream &operator<<(std::ostream &os, const struct stat &attr);
 void AppendS3ChunkInfoToMap(uint64_t chunkIndex, const S3ChunkInfo &info,
     google::protobuf::Map<uint64_t, S3ChunkInfoList> *s3ChunkInfoMap);
 
+// drop the infos fully covered by the ones after them in the list, they are
+// never read, the others keep their order. return the number dropped
+int CompactS3ChunkInfoList(S3ChunkInfoList *s3ChunkInfoList);
+
 extern bvar::Adder<int64_t> g_alive_inode_count;
 
 class InodeWrapper : public std::enable_shared_from_this<InodeWrapper> {
@@ -92,6 +96,7 @@ class InodeWrapper : public std::enable_shared_from_this<InodeWrapper> {
           s3ChunkInfoMetric_(std::move(s3ChunkInfoMetric)),
           dirty_(false),
           time_(TimeUtility::GetTimeofDaySec()) {
+        CompactS3ChunkInfoMap();
         UpdateS3ChunkInfoMetric(CalS3ChunkInfoSize());
         g_alive_inode_count << 1;
     }
@@ -139,6 +144,21 @@ class InodeWrapper : public std::enable_shared_from_this<InodeWrapper> {
         return inode_.length();
     }
 
+    // the content of a small file kept with the inode, empty if none
+    const std::string& GetInlineDataLocked() const {
+        return inode_.inlinedata();
+    }
+
+    void SetInlineDataLocked(const std::string& data) {
+        if (data.empty()) {
+            inode_.clear_inlinedata();
+        } else {
+            inode_.set_inlinedata(data);
+        }
+        dirtyAttr_.set_inlinedata(data);
+        dirty_ = true;
+    }
+
     uint64_t GetLength() const {
         curve::common::UniqueLock lg(mtx_);
         return inode_.length();
@@ -282,6 +302,7 @@ class InodeWrapper : public std::enable_shared_from_this<InodeWrapper> {
         s3ChunkInfoAddSize_++;
         s3ChunkInfoSize_++;
         UpdateS3ChunkInfoMetric(2);
+        MaybeCompactS3ChunkInfoLocked(chunkIndex);
     }
 
     google::protobuf::Map<uint64_t, S3ChunkInfoList>* GetChunkInfoMap() {
@@ -356,6 +377,15 @@ class InodeWrapper : public std::enable_shared_from_this<InodeWrapper> {
         return s3ChunkInfoSize_;
     }
 
+    // compact the list of chunkIndex in memory each time its size doubles,
+    // the lists of the files overwritten a lot keep staying small and the
+    // cost of compacting is amortized
+    void MaybeCompactS3ChunkInfoLocked(uint64_t chunkIndex);
+
+    // compact the lists loaded from metaserver, s3ChunkInfoSize_ is not
+    // updated
+    void CompactS3ChunkInfoMap();
+
     void UpdateS3ChunkInfoMetric(int64_t count) {
         if (nullptr != s3ChunkInfoMetric_) {
             s3ChunkInfoMetric_->s3ChunkInfoSize << count;
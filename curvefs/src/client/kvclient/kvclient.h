@@ -24,12 +24,37 @@
 
 #include <libmemcached-1.0/types/return.h>
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace curvefs {
 
 namespace client {
 
+/**
+ * A get of a batch, [offset, offset + length) of the value is copied
+ * into value.
+ */
+struct KVGetRequest {
+    std::string key;
+    char* value;
+    uint64_t offset;
+    uint64_t length;
+    uint64_t actLength;  // actual length of the value
+    memcached_return_t retCode;
+    bool res;
+
+    KVGetRequest(const std::string& k, char* v, uint64_t off, uint64_t len)
+        : key(k),
+          value(v),
+          offset(off),
+          length(len),
+          actLength(0),
+          retCode(MEMCACHED_NOTFOUND),
+          res(false) {}
+};
+
 /**
  * Single client to kv interface.
  */
@@ -54,6 +79,18 @@ class KVClient {
     virtual bool Get(const std::string& key, char* value, uint64_t offset,
                      uint64_t length, std::string* errorlog,
                      uint64_t* actLength, memcached_return_t* retCod) = 0;
+
+    /**
+     * @brief get a batch of keys, the result of each key is set in
+     *        its request. Clients without multi-get get them one by one.
+     */
+    virtual void MGet(std::vector<KVGetRequest>* requests) {
+        std::string errorlog;
+        for (auto& req : *requests) {
+            req.res = Get(req.key, req.value, req.offset, req.length,
+                          &errorlog, &req.actLength, &req.retCode);
+        }
+    }
 };
 
 }  // namespace client
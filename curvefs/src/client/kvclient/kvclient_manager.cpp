@@ -22,7 +22,9 @@
 
 #include "curvefs/src/client/kvclient/kvclient_manager.h"
 
+#include <algorithm>
 #include <memory>
+#include <mutex>
 
 #include "absl/memory/memory.h"
 #include "curvefs/src/client/metric/client_metric.h"
@@ -53,10 +55,14 @@ bool KVClientManager::Init(const KVClientManagerOpt& config,
                            const std::string& fsName) {
     client_ = kvclient;
     kvClientManagerMetric_ = absl::make_unique<KVClientManagerMetric>(fsName);
-    return threadPool_.Start(config.setThreadPooln) == 0;
+    getThreadNum_ = std::max(1, config.getThreadPooln);
+    getBatchSize_ = std::max(1u, config.getBatchSize);
+    return threadPool_.Start(config.setThreadPooln) == 0 &&
+           getThreadPool_.Start(getThreadNum_) == 0;
 }
 
 void KVClientManager::Uninit() {
+    getThreadPool_.Stop();
     client_->UnInit();
     threadPool_.Stop();
 }
@@ -96,36 +102,75 @@ void UpdateHitMissMetric(memcached_return_t retCode,
 }
 
 void KVClientManager::Get(std::shared_ptr<GetKVCacheTask> task) {
-    threadPool_.Enqueue([task, this]() {
-        std::string error_log;
-        memcached_return_t retCode;
-        task->res = client_->Get(task->key, task->value, task->offset,
-                                 task->valueLength, &error_log, &task->length,
-                                 &retCode);
-        UpdateHitMissMetric(retCode, kvClientManagerMetric_.get());
+    KVGetRequest request(task->key, task->value, task->offset,
+                         task->valueLength);
+    EnqueueGet(std::move(request), [task, this](const KVGetRequest& req) {
+        task->res = req.res;
+        task->length = req.actLength;
+        UpdateHitMissMetric(req.retCode, kvClientManagerMetric_.get());
         OnReturn(&kvClientManagerMetric_->get, task);
     });
 }
 
 void KVClientManager::Enqueue(std::shared_ptr<GetObjectAsyncContext> context) {
-    auto task = [this, context]() { this->GetKvCache(context); };
-    threadPool_.Enqueue(task);
+    VLOG(9) << "GetKvCache start: " << context->key;
+    KVGetRequest request(context->key, context->buf, context->offset,
+                         context->len);
+    EnqueueGet(std::move(request), [context](const KVGetRequest& req) {
+        context->retCode = !req.res;
+        context->actualLen = req.actLength;
+        context->cb(nullptr, context);
+        VLOG(9) << "GetKvCache end: " << context->key << ", "
+                << context->retCode << ", " << context->actualLen;
+    });
 }
 
-int KVClientManager::GetKvCache(
-    std::shared_ptr<GetObjectAsyncContext> context) {
-    VLOG(9) << "GetKvCache start: " << context->key;
-    std::string error_log;
-    memcached_return_t retCode;
-    uint64_t actLength = 0;
-    context->retCode =
-        !client_->Get(context->key, context->buf, context->offset, context->len,
-                      &error_log, &actLength, &retCode);
-    context->actualLen = actLength;
-    context->cb(nullptr, context);
-    VLOG(9) << "GetKvCache end: " << context->key << ", " << context->retCode
-            << ", " << context->actualLen;
-    return 0;
+void KVClientManager::EnqueueGet(KVGetRequest request, GetDone done) {
+    {
+        std::lock_guard<bthread::Mutex> lk(getMtx_);
+        pendingGets_.emplace_back(std::move(request), std::move(done));
+        if (runningGetThreads_ >= getThreadNum_) {
+            // all get threads are busy, it's sent by the next batch
+            return;
+        }
+        runningGetThreads_++;
+    }
+    getThreadPool_.Enqueue([this]() { ProcessGets(); });
+}
+
+void KVClientManager::ProcessGets() {
+    std::vector<KVGetRequest> requests;
+    std::vector<GetDone> dones;
+    while (true) {
+        requests.clear();
+        dones.clear();
+        {
+            std::lock_guard<bthread::Mutex> lk(getMtx_);
+            if (pendingGets_.empty()) {
+                runningGetThreads_--;
+                return;
+            }
+            while (!pendingGets_.empty() && requests.size() < getBatchSize_) {
+                requests.emplace_back(std::move(pendingGets_.front().first));
+                dones.emplace_back(std::move(pendingGets_.front().second));
+                pendingGets_.pop_front();
+            }
+        }
+
+        if (requests.size() == 1) {
+            auto& req = requests[0];
+            std::string error_log;
+            req.res = client_->Get(req.key, req.value, req.offset, req.length,
+                                   &error_log, &req.actLength, &req.retCode);
+        } else {
+            client_->MGet(&requests);
+        }
+        kvClientManagerMetric_->getBatchSize
+            << static_cast<int64_t>(requests.size());
+        for (size_t i = 0; i < requests.size(); i++) {
+            dones[i](requests[i]);
+        }
+    }
 }
 
 }  // namespace client
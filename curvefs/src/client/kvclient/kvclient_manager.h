@@ -24,12 +24,16 @@
 #define CURVEFS_SRC_CLIENT_KVCLIENT_KVCLIENT_MANAGER_H_
 
 #include <bthread/condition_variable.h>
+#include <bthread/mutex.h>
 
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "curvefs/src/client/common/config.h"
@@ -153,11 +157,29 @@ class KVClientManager {
     void Enqueue(std::shared_ptr<GetObjectAsyncContext> context);
 
  private:
+    using GetDone = std::function<void(const KVGetRequest&)>;
+
     void Uninit();
-    int GetKvCache(std::shared_ptr<GetObjectAsyncContext> context);
+
+    /**
+     * Queue a get, it's sent with the other queued gets by one multi-get
+     * of a get thread. A get thread is woken up only when all the running
+     * ones are busy, so the gets are batched under load and sent at once
+     * when idle.
+     */
+    void EnqueueGet(KVGetRequest request, GetDone done);
+
+    // send the queued gets by batch until the queue is empty
+    void ProcessGets();
 
  private:
     TaskThreadPool<bthread::Mutex, bthread::ConditionVariable> threadPool_;
+    TaskThreadPool<bthread::Mutex, bthread::ConditionVariable> getThreadPool_;
+    bthread::Mutex getMtx_;
+    std::deque<std::pair<KVGetRequest, GetDone>> pendingGets_;
+    uint32_t runningGetThreads_ = 0;
+    uint32_t getThreadNum_ = 0;
+    uint32_t getBatchSize_ = 1;
     std::shared_ptr<KVClient> client_;
     std::unique_ptr<KVClientManagerMetric> kvClientManagerMetric_;
 };
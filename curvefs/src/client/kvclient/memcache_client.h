@@ -30,6 +30,8 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "curvefs/proto/topology.pb.h"
@@ -101,6 +103,9 @@ class MemCachedClient : public KVClient {
         memcached_behavior_set(client_, MEMCACHED_BEHAVIOR_DISTRIBUTION,
                                MEMCACHED_DISTRIBUTION_CONSISTENT);
         memcached_behavior_set(client_, MEMCACHED_BEHAVIOR_RETRY_TIMEOUT, 5);
+        // a multi-get is pipelined as one getkq per key and a noop
+        memcached_behavior_set(client_, MEMCACHED_BEHAVIOR_BINARY_PROTOCOL, 1);
+        memcached_behavior_set(client_, MEMCACHED_BEHAVIOR_TCP_NODELAY, 1);
 
         return PushServer();
     }
@@ -178,6 +183,83 @@ class MemCachedClient : public KVClient {
         return false;
     }
 
+    /**
+     * @brief get a batch of keys by one multi-get, the keys of each server
+     *        are sent on its connection of this thread at once, and the
+     *        values are fetched as they come back.
+     */
+    void MGet(std::vector<KVGetRequest>* requests) override {
+        uint64_t start = butil::cpuwide_time_us();
+        if (nullptr == tcli) {
+            tcli = memcached_clone(nullptr, client_);
+        }
+
+        std::vector<const char*> keys;
+        std::vector<size_t> keyLengths;
+        std::unordered_multimap<std::string, size_t> index;
+        for (size_t i = 0; i < requests->size(); i++) {
+            const std::string& key = (*requests)[i].key;
+            if (index.find(key) == index.end()) {
+                keys.push_back(key.c_str());
+                keyLengths.push_back(key.length());
+            }
+            index.emplace(key, i);
+        }
+
+        memcached_return_t ue = memcached_mget(tcli, keys.data(),
+                                               keyLengths.data(), keys.size());
+        if (MEMCACHED_SUCCESS != ue) {
+            LOG_EVERY_N(WARNING, 1000) << "MGet " << keys.size()
+                                       << " keys error = " << ResError(ue);
+            for (auto& req : *requests) {
+                req.retCode = ue;
+            }
+            memcached_free(tcli);
+            tcli = nullptr;
+            metric_->get.eps.count << 1;
+            return;
+        }
+
+        uint64_t bytes = 0;
+        memcached_result_st result;
+        memcached_result_create(tcli, &result);
+        while (memcached_fetch_result(tcli, &result, &ue) != nullptr) {
+            std::string key(memcached_result_key_value(&result),
+                            memcached_result_key_length(&result));
+            const char* value = memcached_result_value(&result);
+            size_t valueLength = memcached_result_length(&result);
+            bytes += valueLength;
+            auto range = index.equal_range(key);
+            for (auto it = range.first; it != range.second; ++it) {
+                auto& req = (*requests)[it->second];
+                req.actLength = valueLength;
+                req.retCode = MEMCACHED_SUCCESS;
+                if (req.value && valueLength >= req.offset + req.length) {
+                    memcpy(req.value, value + req.offset, req.length);
+                    req.res = true;
+                }
+            }
+        }
+        memcached_result_free(&result);
+
+        if (MEMCACHED_END != ue && MEMCACHED_SUCCESS != ue &&
+            MEMCACHED_NOTFOUND != ue) {
+            LOG_EVERY_N(WARNING, 1000) << "MGet " << keys.size()
+                                       << " keys error = " << ResError(ue);
+            for (auto& req : *requests) {
+                if (req.retCode != MEMCACHED_SUCCESS) {
+                    req.retCode = ue;
+                }
+            }
+            memcached_free(tcli);
+            tcli = nullptr;
+            metric_->get.eps.count << 1;
+            return;
+        }
+        curve::client::CollectMetrics(&metric_->get, bytes,
+                                      butil::cpuwide_time_us() - start);
+    }
+
     // transform the res to a error string
     const std::string ResError(const memcached_return_t res) {
         return memcached_strerror(nullptr, res);
@@ -25,6 +25,7 @@
 #include <vector>
 
 #include "curvefs/src/client/lease/lease_excutor.h"
+#include "curvefs/src/client/rpcclient/exclusive_lease.h"
 
 using curvefs::mds::topology::PartitionTxId;
 
@@ -91,6 +92,16 @@ bool LeaseExecutor::RefreshLease() {
                   [&](const PartitionTxId &item) {
                       metaCache_->SetTxId(item.partitionid(), item.txid());
                   });
+
+    // flush what deferred by the exclusive lease if it's recalled,
+    // and release the lease at once
+    if (ExclusiveLease::GetInstance().HandleRecall()) {
+        ret = mdsCli_->RefreshSession(txIds, &latestTxIdList, fsName_,
+                                      mountpoint_, enableSumInDir_);
+        LOG_IF(WARNING, ret != FSStatusCode::OK)
+            << "LeaseExecutor release exclusive lease fail, ret = " << ret
+            << ", errorName = " << FSStatusCode_Name(ret);
+    }
     return true;
 }
 
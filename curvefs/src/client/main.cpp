@@ -239,6 +239,9 @@ int main(int argc, char *argv[]) {
     } else {
         config.clone_fd = opts.clone_fd;
         config.max_idle_threads = opts.max_idle_threads;
+        UpdateFuseLoopConfig(&config);
+        LOG(INFO) << "fuse multi-threaded loop, clone_fd = " << config.clone_fd
+                  << ", max_idle_threads = " << config.max_idle_threads;
         ret = fuse_session_loop_mt(se, &config);
     }
 
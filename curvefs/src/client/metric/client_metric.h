@@ -233,6 +233,33 @@ struct FSMetric {
           userReadIoSize(prefix, fsName + "_userReadIoSize", 0) {}
 };
 
+// hit and miss of a tier of the read cache
+struct CacheTierMetric {
+    bvar::Adder<uint64_t> hit;
+    bvar::Adder<uint64_t> miss;
+    bvar::PassiveStatus<double> hitRatio;
+
+    CacheTierMetric(const std::string& prefix, const std::string& name)
+        : hit(prefix, name + "_hit"),
+          miss(prefix, name + "_miss"),
+          hitRatio(prefix, name + "_hit_ratio", GetHitRatio, this) {}
+
+    void Count(bool isHit) {
+        if (isHit) {
+            hit << 1;
+        } else {
+            miss << 1;
+        }
+    }
+
+    static double GetHitRatio(void* arg) {
+        auto* metric = reinterpret_cast<CacheTierMetric*>(arg);
+        uint64_t hit = metric->hit.get_value();
+        uint64_t total = hit + metric->miss.get_value();
+        return total == 0 ? 0 : static_cast<double>(hit) / total;
+    }
+};
+
 struct S3Metric {
     static const std::string prefix;
 
@@ -257,6 +284,12 @@ struct S3Metric {
     InterfaceMetric readFromKVCache;
     bvar::Status<uint32_t> readSize;
     bvar::Status<uint32_t> writeSize;
+    // read cache tiers: memory -> disk cache -> kv cache -> s3
+    CacheTierMetric memCache;
+    CacheTierMetric diskCache;
+    CacheTierMetric kvCache;
+    // data read from lower tiers not admitted into memory
+    bvar::Adder<uint64_t> memCacheAdmissionReject;
 
     explicit S3Metric(const std::string& name = "")
         : fsName(!name.empty() ? name
@@ -274,7 +307,12 @@ struct S3Metric {
           writeToKVCache(prefix, fsName + "_write_to_kv_cache"),
           readFromKVCache(prefix, fsName + "_read_from_kv_cache"),
           readSize(prefix, fsName + "_adaptor_read_size", 0),
-          writeSize(prefix, fsName + "_adaptor_write_size", 0) {}
+          writeSize(prefix, fsName + "_adaptor_write_size", 0),
+          memCache(prefix, fsName + "_memory_cache"),
+          diskCache(prefix, fsName + "_disk_cache"),
+          kvCache(prefix, fsName + "_kv_cache"),
+          memCacheAdmissionReject(prefix,
+                                  fsName + "_memory_cache_admission_reject") {}
 };
 
 template <typename Tp>
@@ -317,6 +355,8 @@ struct KVClientManagerMetric {
     bvar::Adder<uint64_t> hit;
     // kvcache miss
     bvar::Adder<uint64_t> miss;
+    // gets sent by one multi-get
+    bvar::IntRecorder getBatchSize;
 
     explicit KVClientManagerMetric(const std::string& name = "")
         : fsName(!name.empty() ? name
@@ -325,7 +365,8 @@ struct KVClientManagerMetric {
           set(prefix, fsName + "_set"),
           count(prefix, fsName + "_count"),
           hit(prefix, fsName + "_hit"),
-          miss(prefix, fsName + "_miss") {}
+          miss(prefix, fsName + "_miss"),
+          getBatchSize(prefix, fsName + "_get_batch_size") {}
 };
 
 struct MemcacheClientMetric {
@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "curvefs/src/client/rpcclient/exclusive_lease.h"
+
+#include <glog/logging.h>
+
+#include <utility>
+
+namespace curvefs {
+namespace client {
+
+void ExclusiveLease::Init(bool enable, RecallHandler handler) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    enable_ = enable;
+    held_ = false;
+    recalling_ = false;
+    deferred_.clear();
+    handler_ = std::move(handler);
+}
+
+bool ExclusiveLease::Want() {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return enable_;
+}
+
+bool ExclusiveLease::Hold() {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return held_ || recalling_;
+}
+
+void ExclusiveLease::Update(bool granted) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (held_ && !granted) {
+        held_ = false;
+        recalling_ = true;
+        LOG(INFO) << "Exclusive lease recalled, deferred inodes = "
+                  << deferred_.size();
+    } else if (!held_ && !recalling_ && granted) {
+        held_ = true;
+        LOG(INFO) << "Exclusive lease granted";
+    }
+}
+
+bool ExclusiveLease::Defer(uint64_t ino) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (!held_) {
+        return false;
+    }
+    deferred_.emplace(ino);
+    return true;
+}
+
+bool ExclusiveLease::HandleRecall() {
+    std::set<uint64_t> inos;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (!recalling_) {
+            return false;
+        }
+        inos.swap(deferred_);
+    }
+
+    if (handler_ && !inos.empty()) {
+        handler_(inos);
+    }
+
+    std::lock_guard<std::mutex> lk(mtx_);
+    recalling_ = false;
+    LOG(INFO) << "Exclusive lease recall done, flushed inodes = "
+              << inos.size();
+    return true;
+}
+
+}  // namespace client
+}  // namespace curvefs
@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef CURVEFS_SRC_CLIENT_RPCCLIENT_EXCLUSIVE_LEASE_H_
+#define CURVEFS_SRC_CLIENT_RPCCLIENT_EXCLUSIVE_LEASE_H_
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+
+namespace curvefs {
+namespace client {
+
+/**
+ * The exclusive lease of the fs, granted by mds with refresh session when
+ * this client is the only mountpoint of the fs, and recalled when another
+ * client mounts the fs.
+ *
+ * While holding the lease nobody else can open a file, so the close-to-open
+ * flush can be deferred, the deferred inodes are flushed when the lease is
+ * recalled, and the lease is released (the other client can mount) after.
+ */
+class ExclusiveLease {
+ public:
+    using RecallHandler = std::function<void(const std::set<uint64_t>& inos)>;
+
+ public:
+    static ExclusiveLease& GetInstance() {
+        static ExclusiveLease instance_;
+        return instance_;
+    }
+
+    void Init(bool enable, RecallHandler handler);
+
+    bool Want();
+
+    // hold or under recalling
+    bool Hold();
+
+    // update with the result of refresh session
+    void Update(bool granted);
+
+    // defer the close-to-open flush of the inode,
+    // return false if not holding the lease
+    bool Defer(uint64_t ino);
+
+    // flush the deferred inodes if the lease is recalled,
+    // return true if flushed and the lease should be released
+    bool HandleRecall();
+
+ private:
+    std::mutex mtx_;
+    bool enable_ = false;
+    bool held_ = false;
+    bool recalling_ = false;
+    std::set<uint64_t> deferred_;
+    RecallHandler handler_;
+};
+
+}  // namespace client
+}  // namespace curvefs
+
+#endif  // CURVEFS_SRC_CLIENT_RPCCLIENT_EXCLUSIVE_LEASE_H_
@@ -0,0 +1,125 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "curvefs/src/client/rpcclient/inode_attr_multiplexer.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace curvefs {
+namespace client {
+namespace rpcclient {
+
+using ::curve::common::UniqueLock;
+
+InodeAttrMultiplexer::InodeAttrMultiplexer(uint32_t batchLimit,
+                                           BatchGetFunc batchGet)
+    : batchLimit_(std::max(batchLimit, 1u)),
+      batchGet_(std::move(batchGet)),
+      mutex_(),
+      cond_(),
+      queues_() {}
+
+MetaStatusCode InodeAttrMultiplexer::Get(uint32_t fsId,
+                                         uint32_t partitionId,
+                                         uint64_t inodeId,
+                                         InodeAttr* attr) {
+    Waiter waiter{fsId, inodeId, attr, MetaStatusCode::UNKNOWN_ERROR, false};
+    UniqueLock lk(mutex_);
+    // NOTE: the reference keeps valid even if the map rehashed
+    auto& queue = queues_[partitionId];
+    queue.waiters.push_back(&waiter);
+    while (!waiter.done) {
+        if (queue.busy) {
+            cond_.wait(lk);
+            continue;
+        }
+
+        // we are the leader, send the queued gets (include ours)
+        queue.busy = true;
+        std::vector<Waiter*> batch;
+        if (queue.waiters.size() <= batchLimit_) {
+            batch.swap(queue.waiters);
+        } else {
+            batch.assign(queue.waiters.begin(),
+                         queue.waiters.begin() + batchLimit_);
+            queue.waiters.erase(queue.waiters.begin(),
+                                queue.waiters.begin() + batchLimit_);
+        }
+
+        lk.unlock();
+        Send(batch);
+        lk.lock();
+
+        for (auto w : batch) {
+            w->done = true;
+        }
+        queue.busy = false;
+        cond_.notify_all();
+    }
+    return waiter.rc;
+}
+
+void InodeAttrMultiplexer::Send(const std::vector<Waiter*>& batch) {
+    std::set<uint64_t> inodeIds;
+    for (const auto w : batch) {
+        inodeIds.emplace(w->inodeId);
+    }
+
+    // all gets in one partition belong to the same fs
+    uint32_t fsId = batch.front()->fsId;
+    std::list<InodeAttr> attrs;
+    MetaStatusCode rc = batchGet_(fsId, inodeIds, &attrs);
+    if (rc != MetaStatusCode::OK && inodeIds.size() > 1) {
+        VLOG(3) << "Multiplexed get " << inodeIds.size()
+                << " inode attributes failed, retry one by one, rc = "
+                << MetaStatusCode_Name(rc);
+        for (auto w : batch) {
+            attrs.clear();
+            w->rc = batchGet_(fsId, {w->inodeId}, &attrs);
+            if (w->rc == MetaStatusCode::OK && attrs.size() == 1) {
+                *w->attr = std::move(attrs.front());
+            } else if (w->rc == MetaStatusCode::OK) {
+                w->rc = MetaStatusCode::UNKNOWN_ERROR;
+            }
+        }
+        return;
+    }
+
+    std::unordered_map<uint64_t, InodeAttr*> found;
+    for (auto& attr : attrs) {
+        found.emplace(attr.inodeid(), &attr);
+    }
+    for (auto w : batch) {
+        auto iter = found.find(w->inodeId);
+        if (rc != MetaStatusCode::OK) {
+            w->rc = rc;
+        } else if (iter == found.end()) {
+            LOG(ERROR) << "Multiplexed get inode attribute miss inode "
+                       << w->inodeId;
+            w->rc = MetaStatusCode::UNKNOWN_ERROR;
+        } else {
+            *w->attr = *iter->second;
+            w->rc = MetaStatusCode::OK;
+        }
+    }
+}
+
+}  // namespace rpcclient
+}  // namespace client
+}  // namespace curvefs
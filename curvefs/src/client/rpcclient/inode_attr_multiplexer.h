@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef CURVEFS_SRC_CLIENT_RPCCLIENT_INODE_ATTR_MULTIPLEXER_H_
+#define CURVEFS_SRC_CLIENT_RPCCLIENT_INODE_ATTR_MULTIPLEXER_H_
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "curvefs/proto/metaserver.pb.h"
+#include "src/common/concurrent/concurrent.h"
+
+namespace curvefs {
+namespace client {
+namespace rpcclient {
+
+using ::curvefs::metaserver::InodeAttr;
+using ::curvefs::metaserver::MetaStatusCode;
+
+/**
+ * Multiplex the concurrent single inode attribute gets of one partition
+ * into one BatchGetInodeAttr rpc, like a group commit:
+ *
+ *  - the get which finds no rpc in flight for its partition sends the rpc
+ *    right away, so there is no extra latency under low load;
+ *  - the gets which arrive during the rpc are queued, and the first of
+ *    them sends all of the queued ones by one rpc after it returns.
+ *
+ * Since the metaserver fails the whole batch if any inode in it fails,
+ * the gets of a failed batch are retried one by one.
+ */
+class InodeAttrMultiplexer {
+ public:
+    using BatchGetFunc = std::function<MetaStatusCode(
+        uint32_t fsId, const std::set<uint64_t>& inodeIds,
+        std::list<InodeAttr>* attrs)>;
+
+ public:
+    InodeAttrMultiplexer(uint32_t batchLimit, BatchGetFunc batchGet);
+
+    MetaStatusCode Get(uint32_t fsId, uint32_t partitionId, uint64_t inodeId,
+                       InodeAttr* attr);
+
+ private:
+    struct Waiter {
+        uint32_t fsId;
+        uint64_t inodeId;
+        InodeAttr* attr;
+        MetaStatusCode rc;
+        bool done;
+    };
+
+    struct Queue {
+        bool busy = false;
+        std::vector<Waiter*> waiters;
+    };
+
+    void Send(const std::vector<Waiter*>& batch);
+
+ private:
+    uint32_t batchLimit_;
+    BatchGetFunc batchGet_;
+    ::curve::common::Mutex mutex_;
+    ::curve::common::ConditionVariable cond_;
+    std::unordered_map<uint32_t, Queue> queues_;
+};
+
+}  // namespace rpcclient
+}  // namespace client
+}  // namespace curvefs
+
+#endif  // CURVEFS_SRC_CLIENT_RPCCLIENT_INODE_ATTR_MULTIPLEXER_H_
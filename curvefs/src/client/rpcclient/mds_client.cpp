@@ -27,6 +27,7 @@
 #include <vector>
 
 #include "curvefs/proto/space.pb.h"
+#include "curvefs/src/client/rpcclient/exclusive_lease.h"
 #include "curvefs/src/client/rpcclient/fsdelta_updater.h"
 #include "curvefs/src/client/rpcclient/fsquota_checker.h"
 #include "curvefs/src/common/metric_utils.h"
@@ -520,6 +521,11 @@ MdsClientImpl::RefreshSession(const std::vector<PartitionTxId> &txIds,
         fsDelta.set_bytes(
             FsDeltaUpdater::GetInstance().GetDeltaBytesAndReset());
         *request.mutable_fsdelta() = std::move(fsDelta);
+        auto& exclusiveLease = ExclusiveLease::GetInstance();
+        if (exclusiveLease.Want()) {
+            request.set_wantexclusive(true);
+            request.set_holdexclusive(exclusiveLease.Hold());
+        }
 
         mdsbasecli_->RefreshSession(request, &response, cntl, channel);
         if (cntl->Failed()) {
@@ -550,6 +556,9 @@ MdsClientImpl::RefreshSession(const std::vector<PartitionTxId> &txIds,
             FsQuotaChecker::GetInstance().UpdateQuotaCache(
                 response.fscapacity(), response.fsusedbytes());
         }
+        if (ret == FSStatusCode::OK && request.wantexclusive()) {
+            exclusiveLease.Update(response.exclusive());
+        }
 
         return ret;
     };
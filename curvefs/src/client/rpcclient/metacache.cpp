@@ -52,16 +52,14 @@ void MetaCache::GetTxId(uint32_t partitionId, uint64_t *txId) {
 
 bool MetaCache::GetTxId(uint32_t fsId, uint64_t inodeId, uint32_t *partitionId,
                         uint64_t *txId) {
-    for (const auto &partition : partitionInfos_) {
-        if (fsId == partition.fsid() && inodeId >= partition.start() &&
-            inodeId <= partition.end()) {
-            *partitionId = partition.partitionid();
-            *txId = partition.txid();
-            GetTxId(*partitionId, txId);
-            return true;
-        }
+    PartitionRoute route;
+    if (!FindRoute(inodeId, &route) || route.fsID != fsId) {
+        return false;
     }
-    return false;
+    *partitionId = route.partitionID;
+    *txId = route.txId;
+    GetTxId(*partitionId, txId);
+    return true;
 }
 
 void MetaCache::GetAllTxIds(std::vector<PartitionTxId> *txIds) {
@@ -95,7 +93,7 @@ bool MetaCache::GetTarget(uint32_t fsID, uint64_t inodeID,
     if (!GetCopysetIDwithInodeID(inodeID, &target->groupID,
                                  &target->partitionID, &target->txId)) {
         // list infos from mds
-        if (!ListPartitions(fsID)) {
+        if (!RefreshRoutes(fsID, inodeID)) {
             LOG(ERROR) << "get target for {fsid:" << fsID
                        << "} fail, partition list not exist";
             return false;
@@ -229,6 +227,58 @@ bool MetaCache::ListPartitions(uint32_t fsID) {
     return true;
 }
 
+bool MetaCache::RefreshRoutes(uint32_t fsID, uint64_t inodeID) {
+    std::lock_guard<Mutex> lg(refreshMutex_);
+    // refreshed by others while waiting
+    PartitionRoute route;
+    if (FindRoute(inodeID, &route)) {
+        return true;
+    }
+    return ListPartitions(fsID);
+}
+
+void MetaCache::PublishRoutes() {
+    auto routes = std::make_shared<PartitionRoutes>();
+    routes->reserve(partitionInfos_.size());
+    for (const auto &info : partitionInfos_) {
+        PartitionRoute route;
+        route.start = info.start();
+        route.end = info.end();
+        route.fsID = info.fsid();
+        route.partitionID = info.partitionid();
+        route.groupID = CopysetGroupID(info.poolid(), info.copysetid());
+        route.txId = info.txid();
+        routes->push_back(route);
+    }
+    // the first partition wins if ranges overlap, same as a linear search
+    std::stable_sort(routes->begin(), routes->end(),
+                     [](const PartitionRoute &a, const PartitionRoute &b) {
+                         return a.start < b.start;
+                     });
+    std::atomic_store(&routes_,
+                      std::shared_ptr<const PartitionRoutes>(routes));
+}
+
+bool MetaCache::FindRoute(uint64_t inodeID, PartitionRoute *route) const {
+    std::shared_ptr<const PartitionRoutes> routes = std::atomic_load(&routes_);
+    if (routes == nullptr) {
+        return false;
+    }
+    // the last route starts not after inode
+    auto iter = std::upper_bound(
+        routes->begin(), routes->end(), inodeID,
+        [](uint64_t id, const PartitionRoute &r) { return id < r.start; });
+    if (iter == routes->begin()) {
+        return false;
+    }
+    --iter;
+    if (iter->end < inodeID) {
+        return false;
+    }
+    *route = *iter;
+    return true;
+}
+
 bool MetaCache::CreatePartitions(int currentNum,
                                  PartitionInfoList *newPartitions) {
     std::lock_guard<Mutex> lg(createMutex_);
@@ -366,6 +416,7 @@ void MetaCache::DoAddOrResetPartitionAndCopyset(
     // add copysetInfo
     copysetInfoMap_.insert(std::make_move_iterator(copysetMap.begin()),
                            std::make_move_iterator(copysetMap.end()));
+    PublishRoutes();
 }
 
 bool MetaCache::UpdateCopysetInfoFromMDS(
@@ -435,6 +486,16 @@ bool MetaCache::MarkPartitionUnavailable(PartitionID pid) {
     return true;
 }
 
+bool MetaCache::IsPartitionReadWrite(PartitionID pid) {
+    ReadLockGuard rl(rwlock4Partitions_);
+    for (const auto &partition : partitionInfos_) {
+        if (partition.partitionid() == pid) {
+            return partition.status() == PartitionStatus::READWRITE;
+        }
+    }
+    return false;
+}
+
 void MetaCache::UpdateCopysetInfoIfMatchCurrentLeader(
     const CopysetGroupID &groupID, const PeerAddr &leaderAddr) {
     std::vector<CopysetInfo<MetaserverID>> metaServerInfos;
@@ -499,18 +560,15 @@ bool MetaCache::GetCopysetIDwithInodeID(uint64_t inodeID,
                                         CopysetGroupID *groupID,
                                         PartitionID *partitionID,
                                         uint64_t *txId) {
-    ReadLockGuard rl(rwlock4Partitions_);
-    for (auto iter = partitionInfos_.begin(); iter != partitionInfos_.end();
-         ++iter) {
-        if (iter->start() <= inodeID && iter->end() >= inodeID) {
-            *groupID = CopysetGroupID(iter->poolid(), iter->copysetid());
-            *partitionID = iter->partitionid();
-            *txId = iter->txid();
-            GetTxId(*partitionID, txId);
-            return true;
-        }
+    PartitionRoute route;
+    if (!FindRoute(inodeID, &route)) {
+        return false;
     }
-    return false;
+    *groupID = route.groupID;
+    *partitionID = route.partitionID;
+    *txId = route.txId;
+    GetTxId(*partitionID, txId);
+    return true;
 }
 
 bool MetaCache::GetCopysetInfowithCopySetID(
@@ -526,32 +584,21 @@ bool MetaCache::GetCopysetInfowithCopySetID(
     return true;
 }
 
-bool TryGetPartitionIdByInodeId(const std::vector<PartitionInfo> &plist,
-                                RWLock *lock, uint64_t inodeID,
-                                PartitionID *pid) {
-    ReadLockGuard rl(*lock);
-    for (const auto &it : plist) {
-        if (it.start() <= inodeID && it.end() >= inodeID) {
-            *pid = it.partitionid();
-            return true;
-        }
-    }
-    return false;
-}
-
 bool MetaCache::GetPartitionIdByInodeId(uint32_t fsID, uint64_t inodeID,
                                         PartitionID *pid) {
-    if (!TryGetPartitionIdByInodeId(partitionInfos_, &rwlock4Partitions_,
-                                    inodeID, pid)) {
+    PartitionRoute route;
+    if (!FindRoute(inodeID, &route)) {
         // list form mds
-        if (!ListPartitions(fsID)) {
+        if (!RefreshRoutes(fsID, inodeID)) {
             LOG(ERROR) << "ListPartitions for {fsid:" << fsID
                        << "} fail, partition list not exist";
             return false;
         }
-        return TryGetPartitionIdByInodeId(partitionInfos_, &rwlock4Partitions_,
-                                          inodeID, pid);
+        if (!FindRoute(inodeID, &route)) {
+            return false;
+        }
     }
+    *pid = route.partitionID;
     return true;
 }
 
@@ -108,6 +108,16 @@ inline std::ostream &operator<<(std::ostream &os, const CopysetTarget &t) {
     return os;
 }
 
+// inode range of a partition, for routing an inode to its partition
+struct PartitionRoute {
+    uint64_t start = 0;
+    uint64_t end = 0;
+    uint32_t fsID = 0;
+    PartitionID partitionID = 0;
+    CopysetGroupID groupID;
+    uint64_t txId = 0;
+};
+
 class MetaCache {
  public:
     void Init(MetaCacheOpt opt, std::shared_ptr<Cli2Client> cli2Client,
@@ -122,6 +132,8 @@ class MetaCache {
     using PartitionInfoList = std::vector<PartitionInfo>;
     using CopysetInfoMap =
         std::unordered_map<PoolIDCopysetID, CopysetInfo<MetaserverID>>;
+    // sorted by start, never modified once published
+    using PartitionRoutes = std::vector<PartitionRoute>;
 
     virtual void SetTxId(uint32_t partitionId, uint64_t txId);
 
@@ -139,6 +151,9 @@ class MetaCache {
 
     virtual bool MarkPartitionUnavailable(PartitionID pid);
 
+    // whether the partition can allocate inode ids, as far as known
+    virtual bool IsPartitionReadWrite(PartitionID pid);
+
     virtual void UpdateCopysetInfo(const CopysetGroupID &groupID,
                                    const CopysetInfo<MetaserverID> &csinfo);
 
@@ -178,6 +193,17 @@ class MetaCache {
     // more policies
     bool SelectPartition(CopysetTarget *target);
 
+    // rebuild the routes from partitionInfos_ and publish them, should be
+    // called with the write lock of partitions
+    void PublishRoutes();
+
+    // find the route of inode from the published routes, lock free
+    bool FindRoute(uint64_t inodeID, PartitionRoute *route) const;
+
+    // list all the partitions of fs if the inode is still not routed, the
+    // concurrent misses share one refresh
+    bool RefreshRoutes(uint32_t fsID, uint64_t inodeID);
+
     // get info from partitionMap or copysetMap
     bool GetCopysetIDwithInodeID(uint64_t inodeID, CopysetGroupID *groupID,
                                  PartitionID *patitionID, uint64_t *txId);
@@ -199,6 +225,10 @@ class MetaCache {
 
     RWLock rwlock4Partitions_;
     PartitionInfoList partitionInfos_;
+    // routes of partitionInfos_, read by std::atomic_load and replaced
+    // as a whole by std::atomic_store, so lookups take no lock
+    std::shared_ptr<const PartitionRoutes> routes_;
+    Mutex refreshMutex_;
     RWLock rwlock4copysetInfoMap_;
     CopysetInfoMap copysetInfoMap_;
 
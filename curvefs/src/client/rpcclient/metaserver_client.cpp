@@ -80,6 +80,14 @@ MetaStatusCode MetaServerClientImpl::Init(
     optInternal_ = excutorInternalOpt;
     metaCache_ = metaCache;
     channelManager_ = channelManager;
+    if (opt_.multiplexGetInodeAttr) {
+        attrMultiplexer_.reset(new InodeAttrMultiplexer(
+            opt_.batchInodeAttrLimit,
+            [this](uint32_t fsId, const std::set<uint64_t> &inodeIds,
+                   std::list<InodeAttr> *attrs) {
+                return DoBatchGetInodeAttr(fsId, inodeIds, attrs);
+            }));
+    }
     return MetaStatusCode::OK;
 }
 
@@ -351,6 +359,15 @@ MetaStatusCode MetaServerClientImpl::DeleteDentry(uint32_t fsId,
 
 MetaStatusCode
 MetaServerClientImpl::PrepareRenameTx(const std::vector<Dentry> &dentrys) {
+    return PrepareRenameTx(dentrys, nullptr);
+}
+
+MetaStatusCode
+MetaServerClientImpl::PrepareRenameTx(const std::vector<Dentry> &dentrys,
+                                      bool *committed) {
+    if (committed != nullptr) {
+        *committed = false;
+    }
     auto task = RPCTask {
         (void)txId;
         (void)taskExecutorDone;
@@ -362,6 +379,9 @@ MetaServerClientImpl::PrepareRenameTx(const std::vector<Dentry> &dentrys) {
         request.set_copysetid(copysetID);
         request.set_partitionid(partitionID);
         *request.mutable_dentrys() = {dentrys.begin(), dentrys.end()};
+        if (committed != nullptr) {
+            request.set_commit(true);
+        }
 
         curvefs::metaserver::MetaServerService_Stub stub(channel);
         stub.PrepareRenameTx(cntl, &request, &response, nullptr);
@@ -379,6 +399,9 @@ MetaServerClientImpl::PrepareRenameTx(const std::vector<Dentry> &dentrys) {
         if (rc != MetaStatusCode::OK) {
             LOG(WARNING) << "PrepareRenameTx: retCode = " << rc
                          << ", message = " << MetaStatusCode_Name(rc);
+        } else if (committed != nullptr) {
+            // an old metaserver ignores the commit in request
+            *committed = response.committed();
         }
 
         VLOG(6) << "PrepareRenameTx done, request: " << request.DebugString()
@@ -542,6 +565,32 @@ MetaStatusCode
 MetaServerClientImpl::BatchGetInodeAttr(uint32_t fsId,
                                         const std::set<uint64_t> &inodeIds,
                                         std::list<InodeAttr> *attr) {
+    if (attrMultiplexer_ == nullptr || inodeIds.size() != 1) {
+        return DoBatchGetInodeAttr(fsId, inodeIds, attr);
+    }
+
+    // the concurrent single gets of one partition are sent by one rpc
+    uint32_t partitionId = 0;
+    uint64_t inodeId = *inodeIds.begin();
+    if (!metaCache_->GetPartitionIdByInodeId(fsId, inodeId, &partitionId)) {
+        LOG(ERROR) << "Get partitionId by inodeId failed, fsId = " << fsId
+                   << ", inodeId = " << inodeId;
+        return MetaStatusCode::NOT_FOUND;
+    }
+
+    InodeAttr out;
+    MetaStatusCode ret =
+        attrMultiplexer_->Get(fsId, partitionId, inodeId, &out);
+    if (ret == MetaStatusCode::OK) {
+        attr->emplace_back(std::move(out));
+    }
+    return ret;
+}
+
+MetaStatusCode
+MetaServerClientImpl::DoBatchGetInodeAttr(uint32_t fsId,
+                                          const std::set<uint64_t> &inodeIds,
+                                          std::list<InodeAttr> *attr) {
     // group inodeid by partition and batchlimit
     std::vector<std::vector<uint64_t>> inodeGroups;
     if (!SplitRequestInodes(fsId, inodeIds, &inodeGroups)) {
@@ -794,6 +843,7 @@ void FillInodeAttr(uint32_t fsId, uint64_t inodeId, const InodeAttr &attr,
     SET_REQUEST_FIELD_IF_HAS(request, attr, uid);
     SET_REQUEST_FIELD_IF_HAS(request, attr, gid);
     SET_REQUEST_FIELD_IF_HAS(request, attr, mode);
+    SET_REQUEST_FIELD_IF_HAS(request, attr, inlinedata);
 
     *request->mutable_parent() = attr.parent();
     if (attr.xattr_size() > 0) {
@@ -1185,6 +1235,89 @@ MetaStatusCode MetaServerClientImpl::CreateInode(const InodeParam &param,
     return ConvertToMetaStatusCode(excutor.DoRPCTask());
 }
 
+MetaStatusCode MetaServerClientImpl::CreateInodeWithDentry(
+    const InodeParam &param, const Dentry &dentry, Inode *out,
+    bool *dentryCreated) {
+    *dentryCreated = false;
+    PartitionID pid = 0;
+    if (metaCache_->GetPartitionIdByInodeId(param.fsId,
+                                            dentry.parentinodeid(), &pid) &&
+        !metaCache_->IsPartitionReadWrite(pid)) {
+        return MetaStatusCode::PARTITION_ALLOC_ID_FAIL;
+    }
+
+    auto task = RPCTask {
+        (void)taskExecutorDone;
+        metric_.createInode.qps.count << 1;
+        LatencyUpdater updater(&metric_.createInode.latency);
+        CreateInodeResponse response;
+        CreateInodeRequest request;
+        request.set_poolid(poolID);
+        request.set_copysetid(copysetID);
+        request.set_partitionid(partitionID);
+        request.set_fsid(param.fsId);
+        request.set_length(param.length);
+        request.set_uid(param.uid);
+        request.set_gid(param.gid);
+        request.set_mode(param.mode);
+        request.set_type(param.type);
+        request.set_rdev(param.rdev);
+        request.set_symlink(param.symlink);
+        request.set_parent(param.parent);
+        SetCreateTime(request.mutable_create());
+        Dentry *d = request.mutable_dentry();
+        d->set_fsid(dentry.fsid());
+        d->set_inodeid(0);
+        d->set_parentinodeid(dentry.parentinodeid());
+        d->set_name(dentry.name());
+        d->set_txid(txId);
+        d->set_type(dentry.type());
+        curvefs::metaserver::MetaServerService_Stub stub(channel);
+        stub.CreateInode(cntl, &request, &response, nullptr);
+
+        if (cntl->Failed()) {
+            metric_.createInode.eps.count << 1;
+            LOG(WARNING) << "CreateInodeWithDentry Failed, errorcode = "
+                         << cntl->ErrorCode()
+                         << ", error content:" << cntl->ErrorText()
+                         << ", log id = " << cntl->log_id();
+            return -cntl->ErrorCode();
+        }
+
+        MetaStatusCode ret = response.statuscode();
+        if (ret != MetaStatusCode::OK) {
+            LOG_IF(WARNING, ret != MetaStatusCode::PARTITION_ALLOC_ID_FAIL)
+                << "CreateInodeWithDentry:  param = " << param
+                << ", dentry = " << dentry.ShortDebugString()
+                << ", errcode = " << ret
+                << ", errmsg = " << MetaStatusCode_Name(ret)
+                << ", pool: " << poolID << ", copyset: " << copysetID
+                << ", partition: " << partitionID;
+        } else if (response.has_inode()) {
+            *out = response.inode();
+            // an old metaserver ignores the dentry in request
+            *dentryCreated = response.dentrycreated();
+        } else {
+            LOG(WARNING) << "CreateInodeWithDentry:  param = " << param
+                         << " ok, but inode not set in response:"
+                         << response.DebugString();
+            return -1;
+        }
+
+        VLOG(6) << "CreateInodeWithDentry done, request: "
+                << request.DebugString()
+                << "response: " << response.DebugString();
+        return ret;
+    };
+
+    auto taskCtx = std::make_shared<TaskContext>(
+        MetaServerOpType::CreateInode, task, param.fsId,
+        dentry.parentinodeid(), false, opt_.enableRenameParallel);
+    CreateInodeWithDentryExcutor excutor(opt_, metaCache_, channelManager_,
+                                         std::move(taskCtx));
+    return ConvertToMetaStatusCode(excutor.DoRPCTask());
+}
+
 MetaStatusCode MetaServerClientImpl::CreateManageInode(const InodeParam &param,
                                                        Inode *out) {
     auto task = RPCTask {
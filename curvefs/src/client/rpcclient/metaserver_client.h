@@ -39,6 +39,7 @@
 #include "curvefs/proto/space.pb.h"
 #include "curvefs/src/client/common/config.h"
 #include "curvefs/src/client/rpcclient/base_client.h"
+#include "curvefs/src/client/rpcclient/inode_attr_multiplexer.h"
 #include "curvefs/src/client/rpcclient/task_excutor.h"
 #include "curvefs/src/client/metric/client_metric.h"
 #include "curvefs/src/common/rpc_stream.h"
@@ -110,6 +111,12 @@ class MetaServerClient {
     virtual MetaStatusCode
     PrepareRenameTx(const std::vector<Dentry> &dentrys) = 0;
 
+    // prepare the tx and ask metaserver to commit it in the same raft entry,
+    // committed is false if the tx is only prepared, it should be committed
+    // to mds as usual then
+    virtual MetaStatusCode
+    PrepareRenameTx(const std::vector<Dentry> &dentrys, bool *committed) = 0;
+
     virtual MetaStatusCode GetInode(uint32_t fsId, uint64_t inodeid,
                                     Inode *out, bool* streaming) = 0;
 
@@ -163,6 +170,20 @@ class MetaServerClient {
 
     virtual MetaStatusCode CreateInode(const InodeParam &param, Inode *out) = 0;
 
+    /**
+     * @brief create the inode and its dentry by one rpc in the partition of
+     *        the parent, the inodeid of dentry is ignored.
+     *
+     * @param[out] dentryCreated false if the metaserver only created the
+     *             inode, then the dentry needs to be created by CreateDentry
+     * @return PARTITION_ALLOC_ID_FAIL if the partition of the parent can't
+     *         allocate inode id
+     */
+    virtual MetaStatusCode CreateInodeWithDentry(const InodeParam &param,
+                                                 const Dentry &dentry,
+                                                 Inode *out,
+                                                 bool *dentryCreated) = 0;
+
     virtual MetaStatusCode CreateManageInode(const InodeParam &param,
                                              Inode *out) = 0;
 
@@ -217,6 +238,9 @@ class MetaServerClientImpl : public MetaServerClient {
 
     MetaStatusCode PrepareRenameTx(const std::vector<Dentry> &dentrys) override;
 
+    MetaStatusCode PrepareRenameTx(const std::vector<Dentry> &dentrys,
+                                   bool *committed) override;
+
     MetaStatusCode GetInode(uint32_t fsId, uint64_t inodeid,
                             Inode *out, bool* streaming) override;
 
@@ -271,6 +295,10 @@ class MetaServerClientImpl : public MetaServerClient {
 
     MetaStatusCode CreateInode(const InodeParam &param, Inode *out) override;
 
+    MetaStatusCode CreateInodeWithDentry(const InodeParam &param,
+                                         const Dentry &dentry, Inode *out,
+                                         bool *dentryCreated) override;
+
     MetaStatusCode CreateManageInode(const InodeParam &param,
                                      Inode *out) override;
 
@@ -298,6 +326,10 @@ class MetaServerClientImpl : public MetaServerClient {
     MetaStatusCode UpdateInode(const UpdateInodeRequest &request,
                                bool internal = false);
 
+    MetaStatusCode DoBatchGetInodeAttr(uint32_t fsId,
+                                       const std::set<uint64_t> &inodeIds,
+                                       std::list<InodeAttr> *attr);
+
     void UpdateInodeAsync(const UpdateInodeRequest &request,
                           MetaServerClientDone *done);
 
@@ -316,6 +348,9 @@ class MetaServerClientImpl : public MetaServerClient {
 
     StreamClient streamClient_;
     MetaServerClientMetric metric_;
+
+    // multiplex the single inode attribute gets, nullptr if disabled
+    std::unique_ptr<InodeAttrMultiplexer> attrMultiplexer_;
 };
 }  // namespace rpcclient
 }  // namespace client
@@ -339,6 +339,14 @@ bool CreateInodeExcutor::GetTarget() {
     return true;
 }
 
+bool CreateInodeWithDentryExcutor::OnReturn(int retCode) {
+    if (retCode == MetaStatusCode::PARTITION_ALLOC_ID_FAIL) {
+        metaCache_->MarkPartitionUnavailable(task_->target.partitionID);
+        return false;
+    }
+    return TaskExecutor::OnReturn(retCode);
+}
+
 bool CreateManagerInodeExcutor::GetTarget() {
     if (!metaCache_->GetTarget(task_->fsID, RECYCLEINODEID, &task_->target)) {
         LOG(ERROR) << "CreateManagerInodeExcutor select target for task fail, "
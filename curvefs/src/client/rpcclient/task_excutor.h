@@ -130,7 +130,7 @@ class TaskExecutor {
     void DoAsyncRPCTask(TaskExecutorDone *done);
     int DoRPCTaskInner(TaskExecutorDone *done);
 
-    bool OnReturn(int retCode);
+    virtual bool OnReturn(int retCode);
     void PreProcessBeforeRetry(int retCode);
 
     std::shared_ptr<TaskContext> GetTaskCxt() const {
@@ -272,6 +272,19 @@ class CreateInodeExcutor : public TaskExecutor {
     bool GetTarget() override;
 };
 
+// create inode and dentry in the partition of the parent, no retry in other
+// partitions if the partition has no inode id to allocate
+class CreateInodeWithDentryExcutor : public TaskExecutor {
+ public:
+    explicit CreateInodeWithDentryExcutor(
+        const ExcutorOpt &opt, const std::shared_ptr<MetaCache> &metaCache,
+        const std::shared_ptr<ChannelManager<MetaserverID>> &channelManager,
+        const std::shared_ptr<TaskContext> &task)
+        : TaskExecutor(opt, metaCache, channelManager, task) {}
+
+    bool OnReturn(int retCode) override;
+};
+
 class CreateManagerInodeExcutor : public TaskExecutor {
  public:
     explicit CreateManagerInodeExcutor(
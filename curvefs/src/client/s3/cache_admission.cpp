@@ -0,0 +1,111 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "curvefs/src/client/s3/cache_admission.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace curvefs {
+namespace client {
+
+namespace {
+
+const uint64_t kSeeds[] = {0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL,
+                           0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL};
+
+uint64_t Mix(uint64_t hash, uint64_t seed) {
+    uint64_t h = (hash + seed) * 0x9e3779b97f4a7c15ULL;
+    h ^= h >> 32;
+    return h;
+}
+
+}  // namespace
+
+TinyLfuAdmission::TinyLfuAdmission(uint32_t width, uint32_t admitFrequency)
+    : width_(1),
+      admitFrequency_(std::max(1u, admitFrequency)),
+      additions_(0) {
+    while (width_ < width) {
+        width_ <<= 1;
+    }
+    sampleSize_ = 10ULL * width_;
+    counters_.resize(static_cast<size_t>(width_) * kRowNum, 0);
+}
+
+bool TinyLfuAdmission::Admit(const std::string &key) {
+    uint64_t hash = std::hash<std::string>()(key);
+    std::lock_guard<std::mutex> lk(mtx_);
+    Increment(hash);
+    return Estimate(hash) >= admitFrequency_;
+}
+
+uint32_t TinyLfuAdmission::Frequency(const std::string &key) {
+    uint64_t hash = std::hash<std::string>()(key);
+    std::lock_guard<std::mutex> lk(mtx_);
+    return Estimate(hash);
+}
+
+uint32_t TinyLfuAdmission::Estimate(uint64_t hash) const {
+    uint8_t count = kMaxCount;
+    for (int row = 0; row < kRowNum; ++row) {
+        count = std::min(count, counters_[Index(hash, row)]);
+    }
+    return count;
+}
+
+void TinyLfuAdmission::Increment(uint64_t hash) {
+    // conservative update: only raise the smallest counters
+    uint8_t count = static_cast<uint8_t>(Estimate(hash));
+    if (count < kMaxCount) {
+        for (int row = 0; row < kRowNum; ++row) {
+            uint8_t &counter = counters_[Index(hash, row)];
+            if (counter == count) {
+                counter++;
+            }
+        }
+    }
+
+    if (++additions_ >= sampleSize_) {
+        Reset();
+    }
+}
+
+void TinyLfuAdmission::Reset() {
+    for (auto &counter : counters_) {
+        counter >>= 1;
+    }
+    additions_ /= 2;
+}
+
+size_t TinyLfuAdmission::Index(uint64_t hash, int row) const {
+    return static_cast<size_t>(row) * width_ +
+           (Mix(hash, kSeeds[row]) & (width_ - 1));
+}
+
+std::shared_ptr<CacheAdmission> NewCacheAdmission(const std::string &policy,
+                                                  uint32_t width,
+                                                  uint32_t admitFrequency) {
+    if (policy == "always") {
+        return std::make_shared<AlwaysAdmission>();
+    } else if (policy == "tinylfu") {
+        return std::make_shared<TinyLfuAdmission>(width, admitFrequency);
+    }
+    return nullptr;
+}
+
+}  // namespace client
+}  // namespace curvefs
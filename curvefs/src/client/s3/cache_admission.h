@@ -0,0 +1,102 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef CURVEFS_SRC_CLIENT_S3_CACHE_ADMISSION_H_
+#define CURVEFS_SRC_CLIENT_S3_CACHE_ADMISSION_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace curvefs {
+namespace client {
+
+/**
+ * Decide whether the data read from a lower cache tier is promoted into
+ * an upper one.
+ */
+class CacheAdmission {
+ public:
+    virtual ~CacheAdmission() = default;
+
+    // record an access of key, return whether it's admitted
+    virtual bool Admit(const std::string &key) = 0;
+};
+
+// admit everything, as the cache did before
+class AlwaysAdmission : public CacheAdmission {
+ public:
+    bool Admit(const std::string &) override { return true; }
+};
+
+/**
+ * TinyLFU: the recent access frequency of keys is kept in a count-min
+ * sketch, a key is admitted once it has been accessed admitFrequency
+ * times. The counters are halved after every 10 * width accesses, so the
+ * frequency follows recent accesses. Data read once by a scan is not
+ * admitted and does not push the hot data out of the cache.
+ */
+class TinyLfuAdmission : public CacheAdmission {
+ public:
+    /**
+     * @param width counters of each row of the sketch, rounded up to a
+     *        power of 2, it should be around the number of cached entries
+     * @param admitFrequency accesses needed to be admitted
+     */
+    TinyLfuAdmission(uint32_t width, uint32_t admitFrequency);
+
+    bool Admit(const std::string &key) override;
+
+    // estimated recent accesses of key
+    uint32_t Frequency(const std::string &key);
+
+ private:
+    uint32_t Estimate(uint64_t hash) const;
+
+    void Increment(uint64_t hash);
+
+    // halve all counters
+    void Reset();
+
+    size_t Index(uint64_t hash, int row) const;
+
+ private:
+    static constexpr int kRowNum = 4;
+    static constexpr uint8_t kMaxCount = 15;
+
+    std::mutex mtx_;
+    uint32_t width_;
+    const uint32_t admitFrequency_;
+    uint64_t sampleSize_;
+    uint64_t additions_;
+    std::vector<uint8_t> counters_;
+};
+
+/**
+ * @brief create the admission policy by name, "always" or "tinylfu"
+ *
+ * @return nullptr if the name is unknown
+ */
+std::shared_ptr<CacheAdmission> NewCacheAdmission(const std::string &policy,
+                                                  uint32_t width,
+                                                  uint32_t admitFrequency);
+
+}  // namespace client
+}  // namespace curvefs
+
+#endif  // CURVEFS_SRC_CLIENT_S3_CACHE_ADMISSION_H_
@@ -33,6 +33,7 @@
 #include "curvefs/src/client/rpcclient/fsdelta_updater.h"
 #include "curvefs/src/client/rpcclient/fsquota_checker.h"
 #include "curvefs/src/common/s3util.h"
+#include "src/common/timeutility.h"
 
 namespace curvefs {
 namespace client {
@@ -57,6 +58,34 @@ DEFINE_validator(bigIoRetryTimes, &pass_uint32);
 DEFINE_uint32(bigIoRetryIntervalUs, 100,
               "retry interval when read big io failed");
 DEFINE_validator(bigIoRetryIntervalUs, &pass_uint32);
+DEFINE_uint32(s3PrefetchMaxBlocks, 64,
+              "max blocks prefetched ahead of a sequential reader, "
+              "the first read of a file prefetches s3.prefetchBlocks");
+DEFINE_validator(s3PrefetchMaxBlocks, &pass_uint32);
+DEFINE_uint32(s3PrefetchMaxInflightBlocks, 256,
+              "max blocks being prefetched of all files, 0 means no limit");
+DEFINE_validator(s3PrefetchMaxInflightBlocks, &pass_uint32);
+DEFINE_uint32(s3UploadMaxConcurrency, 256,
+              "max concurrent object uploads of flushing of a filesystem, "
+              "0 means no limit, take effect when mount");
+DEFINE_validator(s3UploadMaxConcurrency, &pass_uint32);
+DEFINE_uint32(s3UploadMinConcurrency, 8,
+              "min concurrent object uploads of flushing of a filesystem, "
+              "take effect when mount");
+DEFINE_validator(s3UploadMinConcurrency, &pass_uint32);
+DEFINE_double(s3UploadLatencyTolerance, 2.0,
+              "reduce the concurrent uploads when the upload latency per MiB "
+              "exceeds the lowest one by this ratio, take effect when mount");
+DEFINE_string(s3ReadCacheAdmission, "always",
+              "admission policy of the data read from disk cache, kv cache "
+              "or s3 into the memory read cache, always or tinylfu, "
+              "take effect when mount");
+DEFINE_uint32(s3ReadCacheAdmissionWidth, 65536,
+              "counters of each row of the tinylfu sketch, around the number "
+              "of the cached blocks, take effect when mount");
+DEFINE_uint32(s3ReadCacheAdmissionFrequency, 2,
+              "recent reads of a block needed to be admitted by tinylfu, "
+              "take effect when mount");
 
 CURVEFS_ERROR
 S3ClientAdaptorImpl::Init(
@@ -91,10 +120,45 @@ S3ClientAdaptorImpl::Init(
     maxReadRetryIntervalMs_ = option.maxReadRetryIntervalMs;
     readRetryIntervalMs_ = option.readRetryIntervalMs;
     objectPrefix_ = option.objectPrefix;
+    chunkIdLeaseMin_ = option.chunkIdLeaseMin;
+    chunkIdLeaseMax_ = std::max(option.chunkIdLeaseMax, chunkIdLeaseMin_);
+    chunkIdLeaseTargetSec_ = option.chunkIdLeaseTargetSec;
+    chunkIdLease_.size = chunkIdLeaseMin_;
+    inlineDataMaxSize_ = option.inlineDataMaxSize;
+    packMaxSliceSize_ = option.packMaxSliceSize;
     client_ = client;
     inodeManager_ = inodeManager;
     mdsClient_ = mdsClient;
     fsCacheManager_ = fsCacheManager;
+    if (fsCacheManager_ != nullptr && pageSize_ > 0) {
+        fsCacheManager_->InitPagePool(pageSize_);
+    }
+    if (FLAGS_s3UploadMaxConcurrency > 0) {
+        uploadLimiter_ = std::make_shared<UploadLimiter>(
+            FLAGS_s3UploadMinConcurrency, FLAGS_s3UploadMaxConcurrency,
+            FLAGS_s3UploadLatencyTolerance);
+    }
+    if (packMaxSliceSize_ > 0) {
+        objectPacker_ = std::make_shared<ObjectPacker>(
+            option.packMaxSize, option.packMaxSlices, option.packMaxDelayMs,
+            option.readRetryIntervalMs,
+            [this](uint64_t *packId) {
+                return AllocS3ChunkId(fsId_, 1, packId) == FSStatusCode::OK;
+            },
+            [this](uint64_t packId, const char *buf, uint64_t len) {
+                std::string name = curvefs::common::s3util::GenPackObjName(
+                    packId, fsId_, objectPrefix_);
+                return client_->Upload(name, buf, len) < 0 ? -1 : 0;
+            });
+    }
+    readCacheAdmission_ = NewCacheAdmission(FLAGS_s3ReadCacheAdmission,
+                                            FLAGS_s3ReadCacheAdmissionWidth,
+                                            FLAGS_s3ReadCacheAdmissionFrequency);
+    if (readCacheAdmission_ == nullptr) {
+        LOG(ERROR) << "unknown read cache admission policy: "
+                   << FLAGS_s3ReadCacheAdmission;
+        return CURVEFS_ERROR::INVALID_PARAM;
+    }
     waitInterval_.Init(option.intervalSec * 1000);
     diskCacheManagerImpl_ = diskCacheManagerImpl;
     kvClientManager_ = std::move(kvClientManager);
@@ -135,7 +199,15 @@ S3ClientAdaptorImpl::Init(
               << ", s3ToLocal: " << FLAGS_s3ToLocal
               << ", bigIoSize: " << FLAGS_bigIoSize
               << ", bigIoRetryTimes: " << FLAGS_bigIoRetryTimes
-              << ", bigIoRetryIntervalUs: " << FLAGS_bigIoRetryIntervalUs;
+              << ", bigIoRetryIntervalUs: " << FLAGS_bigIoRetryIntervalUs
+              << ", chunkIdLeaseMin: " << chunkIdLeaseMin_
+              << ", chunkIdLeaseMax: " << chunkIdLeaseMax_
+              << ", chunkIdLeaseTargetSec: " << chunkIdLeaseTargetSec_
+              << ", inlineDataMaxSize: " << inlineDataMaxSize_
+              << ", packMaxSliceSize: " << packMaxSliceSize_
+              << ", packMaxSize: " << option.packMaxSize
+              << ", packMaxSlices: " << option.packMaxSlices
+              << ", packMaxDelayMs: " << option.packMaxDelayMs;
 
     // start chunk flush threads
     taskPool_.Start(chunkFlushThreads_);
@@ -217,6 +289,27 @@ CURVEFS_ERROR S3ClientAdaptorImpl::Truncate(InodeWrapper *inodeWrapper,
     const auto *inode = inodeWrapper->GetInodeLocked();
     uint64_t fileSize = inode->length();
 
+    if (!inode->inlinedata().empty()) {
+        if (size <= inlineDataMaxSize_) {
+            if (size > fileSize &&
+                !FsQuotaChecker::GetInstance().QuotaBytesCheck(size -
+                                                               fileSize)) {
+                return CURVEFS_ERROR::NO_SPACE;
+            }
+            std::string data = inode->inlinedata();
+            data.resize(size, '\0');
+            inodeWrapper->SetInlineDataLocked(data);
+            FsDeltaUpdater::GetInstance().UpdateDeltaBytes(
+                static_cast<int64_t>(size) - static_cast<int64_t>(fileSize));
+            return CURVEFS_ERROR::OK;
+        }
+        // grows too large to stay inline
+        FileCacheManagerPtr fileCacheManager =
+            fsCacheManager_->FindOrCreateFileCacheManager(fsId_,
+                                                          inode->inodeid());
+        fileCacheManager->MoveInlineDataLocked(inodeWrapper);
+    }
+
     int64_t deltaBytes = 0;
     if (size < fileSize) {
         VLOG(6) << "Truncate size:" << size
@@ -317,7 +410,94 @@ CURVEFS_ERROR S3ClientAdaptorImpl::FsSync() {
 FSStatusCode S3ClientAdaptorImpl::AllocS3ChunkId(uint32_t fsId,
                                                  uint32_t idNum,
                                                  uint64_t *chunkId) {
-    return mdsClient_->AllocS3ChunkId(fsId, idNum, chunkId);
+    // the big requests like truncate are rare, let them go to mds directly
+    if (chunkIdLeaseMin_ == 0 || idNum >= chunkIdLeaseMin_) {
+        return mdsClient_->AllocS3ChunkId(fsId, idNum, chunkId);
+    }
+
+    std::unique_lock<std::mutex> lk(chunkIdMtx_);
+    auto &lease = chunkIdLease_;
+    if (lease.next + idNum > lease.end &&
+        lease.prefetchNext + idNum <= lease.prefetchEnd) {
+        // the ids left in the serving range are dropped, only the ids of
+        // one request need to be contiguous
+        AdjustChunkIdLeaseSize();
+        lease.next = lease.prefetchNext;
+        lease.end = lease.prefetchEnd;
+        lease.prefetchNext = lease.prefetchEnd = 0;
+        lease.startUs = ::curve::common::TimeUtility::GetTimeofDayUs();
+    }
+
+    if (lease.next + idNum <= lease.end) {
+        *chunkId = lease.next;
+        lease.next += idNum;
+        if (lease.end - lease.next <= lease.size / 2 && !lease.prefetching &&
+            lease.prefetchNext == lease.prefetchEnd) {
+            // the last prefetch thread has finished as it is not prefetching
+            lease.prefetching = true;
+            if (chunkIdPrefetchThread_.joinable()) {
+                chunkIdPrefetchThread_.join();
+            }
+            chunkIdPrefetchThread_ =
+                Thread(&S3ClientAdaptorImpl::PrefetchS3ChunkId, this, fsId);
+        }
+        return FSStatusCode::OK;
+    }
+
+    // neither the serving nor the prefetched range is available
+    AdjustChunkIdLeaseSize();
+    uint64_t size = lease.size;
+    lk.unlock();
+    uint64_t begin = 0;
+    FSStatusCode ret = mdsClient_->AllocS3ChunkId(fsId, size, &begin);
+    if (ret != FSStatusCode::OK) {
+        return ret;
+    }
+    *chunkId = begin;
+
+    lk.lock();
+    if (lease.next + idNum > lease.end) {
+        lease.next = begin + idNum;
+        lease.end = begin + size;
+        lease.startUs = ::curve::common::TimeUtility::GetTimeofDayUs();
+    }
+    return FSStatusCode::OK;
+}
+
+void S3ClientAdaptorImpl::AdjustChunkIdLeaseSize() {
+    auto &lease = chunkIdLease_;
+    if (lease.startUs == 0 || chunkIdLeaseTargetSec_ == 0) {
+        return;
+    }
+    uint64_t elapsedUs =
+        ::curve::common::TimeUtility::GetTimeofDayUs() - lease.startUs;
+    uint64_t targetUs = chunkIdLeaseTargetSec_ * 1000000ull;
+    if (elapsedUs < targetUs / 2) {
+        lease.size = std::min<uint64_t>(lease.size * 2, chunkIdLeaseMax_);
+    } else if (elapsedUs > targetUs * 2) {
+        lease.size = std::max<uint64_t>(lease.size / 2, chunkIdLeaseMin_);
+    }
+}
+
+void S3ClientAdaptorImpl::PrefetchS3ChunkId(uint32_t fsId) {
+    uint64_t size = 0;
+    {
+        std::lock_guard<std::mutex> lk(chunkIdMtx_);
+        size = chunkIdLease_.size;
+    }
+    uint64_t begin = 0;
+    FSStatusCode ret = mdsClient_->AllocS3ChunkId(fsId, size, &begin);
+
+    std::lock_guard<std::mutex> lk(chunkIdMtx_);
+    chunkIdLease_.prefetching = false;
+    if (ret != FSStatusCode::OK) {
+        LOG(WARNING) << "prefetch s3 chunk id fail, ret: " << ret;
+        return;
+    }
+    chunkIdLease_.prefetchNext = begin;
+    chunkIdLease_.prefetchEnd = begin + size;
+    VLOG(6) << "prefetch s3 chunk id [" << begin << ", " << begin + size
+            << ")";
 }
 
 void S3ClientAdaptorImpl::BackGroundFlush() {
@@ -363,6 +543,14 @@ int S3ClientAdaptorImpl::Stop() {
         diskCacheManagerImpl_->UmountDiskCache();
     }
     taskPool_.Stop();
+    Thread prefetchThread;
+    {
+        std::lock_guard<std::mutex> lk(chunkIdMtx_);
+        prefetchThread = std::move(chunkIdPrefetchThread_);
+    }
+    if (prefetchThread.joinable()) {
+        prefetchThread.join();
+    }
     client_->Deinit();
     return 0;
 }
@@ -395,18 +583,19 @@ CURVEFS_ERROR S3ClientAdaptorImpl::FlushAllCache(uint64_t inodeId) {
     VLOG(6) << "FlushAllCache, inodeId:" << inodeId;
     FileCacheManagerPtr fileCacheManager =
         fsCacheManager_->FindFileCacheManager(inodeId);
-    if (!fileCacheManager) {
-        return CURVEFS_ERROR::OK;
-    }
 
     // force flush data in memory to s3
-    VLOG(6) << "FlushAllCache, flush memory data of inodeId:" << inodeId;
-    CURVEFS_ERROR ret = fileCacheManager->Flush(true, false);
-    if (ret != CURVEFS_ERROR::OK) {
-        return ret;
+    CURVEFS_ERROR ret = CURVEFS_ERROR::OK;
+    if (fileCacheManager) {
+        VLOG(6) << "FlushAllCache, flush memory data of inodeId:" << inodeId;
+        ret = fileCacheManager->Flush(true, false);
+        if (ret != CURVEFS_ERROR::OK) {
+            return ret;
+        }
     }
 
-    // force flush data in diskcache to s3
+    // force flush data in diskcache to s3, the write cache left by the
+    // last mount has no file cache manager but still needs to be uploaded
     if (!kvClientManager_ && HasDiskCache()) {
         VLOG(6) << "FlushAllCache, wait inodeId:" << inodeId
                 << "related chunk upload to s3";
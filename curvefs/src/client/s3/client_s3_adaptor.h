@@ -36,9 +36,12 @@
 #include "curvefs/src/client/filesystem/error.h"
 #include "curvefs/src/client/inode_cache_manager.h"
 #include "curvefs/src/client/rpcclient/mds_client.h"
+#include "curvefs/src/client/s3/cache_admission.h"
 #include "curvefs/src/client/s3/client_s3.h"
 #include "curvefs/src/client/s3/client_s3_cache_manager.h"
 #include "curvefs/src/client/s3/disk_cache_manager_impl.h"
+#include "curvefs/src/client/s3/object_packer.h"
+#include "curvefs/src/client/s3/upload_limiter.h"
 #include "src/common/wait_interval.h"
 namespace curvefs {
 namespace client {
@@ -160,6 +163,25 @@ class S3ClientAdaptorImpl : public S3ClientAdaptor {
         return fsCacheManager_;
     }
 
+    // nullptr if the flush uploads are not limited
+    std::shared_ptr<UploadLimiter> GetUploadLimiter() {
+        return uploadLimiter_;
+    }
+
+    // nullptr if packing is disabled
+    std::shared_ptr<ObjectPacker> GetObjectPacker() {
+        return objectPacker_;
+    }
+
+    uint32_t GetPackMaxSliceSize() const {
+        return packMaxSliceSize_;
+    }
+
+    // nullptr before init, which admits everything
+    std::shared_ptr<CacheAdmission> GetReadCacheAdmission() {
+        return readCacheAdmission_;
+    }
+
     uint32_t GetFlushInterval() { return flushIntervalSec_; }
 
     std::shared_ptr<S3Client> GetS3Client() { return client_; }
@@ -168,6 +190,14 @@ class S3ClientAdaptorImpl : public S3ClientAdaptor {
         return prefetchBlocks_;
     }
 
+    uint32_t GetInlineDataMaxSize() const {
+        return inlineDataMaxSize_;
+    }
+
+    PrefetchBudget *GetPrefetchBudget() {
+        return &prefetchBudget_;
+    }
+
     uint32_t GetDiskCacheType() {
         return diskCacheType_;
     }
@@ -246,6 +276,11 @@ class S3ClientAdaptorImpl : public S3ClientAdaptor {
 
     int ClearDiskCache(int64_t inodeId);
 
+    // lease the next range of chunk ids from mds in background
+    void PrefetchS3ChunkId(uint32_t fsId);
+    // grow or shrink the lease size by how fast the last lease was used up
+    void AdjustChunkIdLeaseSize();
+
  public:
     void PushAsyncTask(const AsyncDownloadTask& task) {
         static thread_local unsigned int seed = time(nullptr);
@@ -267,6 +302,7 @@ class S3ClientAdaptorImpl : public S3ClientAdaptor {
     uint64_t blockSize_;
     uint64_t chunkSize_;
     uint32_t prefetchBlocks_;
+    PrefetchBudget prefetchBudget_;
     uint32_t prefetchExecQueueNum_;
     std::string allocateServerEps_;
     uint32_t flushIntervalSec_;
@@ -288,6 +324,9 @@ class S3ClientAdaptorImpl : public S3ClientAdaptor {
     std::condition_variable cond_;
     curve::common::WaitInterval waitInterval_;
     std::shared_ptr<FsCacheManager> fsCacheManager_;
+    std::shared_ptr<UploadLimiter> uploadLimiter_;
+    std::shared_ptr<ObjectPacker> objectPacker_;
+    std::shared_ptr<CacheAdmission> readCacheAdmission_;
     std::shared_ptr<InodeCacheManager> inodeManager_;
     std::shared_ptr<DiskCacheManagerImpl> diskCacheManagerImpl_;
     DiskCacheType diskCacheType_;
@@ -304,6 +343,28 @@ class S3ClientAdaptorImpl : public S3ClientAdaptor {
         taskPool_;
 
     std::shared_ptr<KVClientManager> kvClientManager_ = nullptr;
+
+    // chunk ids leased from mds, [next, end) is serving and
+    // [prefetchNext, prefetchEnd) is prefetched to serve next
+    struct ChunkIdLease {
+        uint64_t next = 0;
+        uint64_t end = 0;
+        uint64_t prefetchNext = 0;
+        uint64_t prefetchEnd = 0;
+        bool prefetching = false;
+        // ids to lease next time
+        uint64_t size = 0;
+        // when the serving range was taken
+        uint64_t startUs = 0;
+    };
+    uint32_t chunkIdLeaseMin_ = 0;
+    uint32_t chunkIdLeaseMax_ = 0;
+    uint32_t chunkIdLeaseTargetSec_ = 0;
+    uint32_t inlineDataMaxSize_ = 0;
+    uint32_t packMaxSliceSize_ = 0;
+    std::mutex chunkIdMtx_;
+    ChunkIdLease chunkIdLease_;
+    Thread chunkIdPrefetchThread_;
 };
 
 }  // namespace client
@@ -25,6 +25,8 @@
 #include <bvar/bvar.h>
 #include <sys/types.h>
 
+#include <algorithm>
+#include <string>
 #include <utility>
 
 #include "absl/cleanup/cleanup.h"
@@ -45,6 +47,8 @@ DECLARE_bool(s3ToLocal);
 DECLARE_uint32(bigIoSize);
 DECLARE_uint32(bigIoRetryTimes);
 DECLARE_uint32(bigIoRetryIntervalUs);
+DECLARE_uint32(s3PrefetchMaxBlocks);
+DECLARE_uint32(s3PrefetchMaxInflightBlocks);
 
 namespace common {
 DECLARE_bool(enableCto);
@@ -59,6 +63,9 @@ static S3MultiManagerMetric *g_s3MultiManagerMetric =
 namespace curvefs {
 namespace client {
 
+// at most 1/kPagePoolFreeRatio of the write cache is kept as free pages
+static const uint64_t kPagePoolFreeRatio = 8;
+
 void FsCacheManager::DataCacheNumInc() {
     g_s3MultiManagerMetric->writeDataCacheNum << 1;
     VLOG(9) << "DataCacheNumInc() v: 1,wDataCacheNum:"
@@ -89,11 +96,19 @@ void FsCacheManager::DataCacheByteDec(uint64_t v) {
     wDataCacheByte_.fetch_sub(v, std::memory_order_relaxed);
 }
 
+void FsCacheManager::InitPagePool(uint32_t pageSize) {
+    // free pages kept for reuse are bounded by a fraction of the write
+    // cache, the rest of the released pages go back to the system
+    pagePool_ = std::make_shared<PagePool>(
+        pageSize, writeCacheMaxByte_ / kPagePoolFreeRatio);
+}
+
 FileCacheManagerPtr FsCacheManager::FindFileCacheManager(uint64_t inodeId) {
-    ReadLockGuard readLockGuard(rwLock_);
+    FileCacheManagerShard &shard = GetFileCacheManagerShard(inodeId);
+    ReadLockGuard readLockGuard(shard.rwLock);
 
-    auto it = fileCacheManagerMap_.find(inodeId);
-    if (it != fileCacheManagerMap_.end()) {
+    auto it = shard.fileCacheManagerMap.find(inodeId);
+    if (it != shard.fileCacheManagerMap.end()) {
         return it->second;
     }
 
@@ -102,16 +117,17 @@ FileCacheManagerPtr FsCacheManager::FindFileCacheManager(uint64_t inodeId) {
 
 FileCacheManagerPtr
 FsCacheManager::FindOrCreateFileCacheManager(uint64_t fsId, uint64_t inodeId) {
-    WriteLockGuard writeLockGuard(rwLock_);
+    FileCacheManagerShard &shard = GetFileCacheManagerShard(inodeId);
+    WriteLockGuard writeLockGuard(shard.rwLock);
 
-    auto it = fileCacheManagerMap_.find(inodeId);
-    if (it != fileCacheManagerMap_.end()) {
+    auto it = shard.fileCacheManagerMap.find(inodeId);
+    if (it != shard.fileCacheManagerMap.end()) {
         return it->second;
     }
 
     FileCacheManagerPtr fileCacheManager = std::make_shared<FileCacheManager>(
         fsId, inodeId, s3ClientAdaptor_, kvClientManager_, readTaskPool_);
-    auto ret = fileCacheManagerMap_.emplace(inodeId, fileCacheManager);
+    auto ret = shard.fileCacheManagerMap.emplace(inodeId, fileCacheManager);
     g_s3MultiManagerMetric->fileManagerNum << 1;
     assert(ret.second);
     (void)ret;
@@ -119,47 +135,53 @@ FsCacheManager::FindOrCreateFileCacheManager(uint64_t fsId, uint64_t inodeId) {
 }
 
 void FsCacheManager::ReleaseFileCacheManager(uint64_t inodeId) {
-    WriteLockGuard writeLockGuard(rwLock_);
+    FileCacheManagerShard &shard = GetFileCacheManagerShard(inodeId);
+    WriteLockGuard writeLockGuard(shard.rwLock);
 
-    auto iter = fileCacheManagerMap_.find(inodeId);
-    if (iter == fileCacheManagerMap_.end()) {
+    auto iter = shard.fileCacheManagerMap.find(inodeId);
+    if (iter == shard.fileCacheManagerMap.end()) {
         VLOG(1) << "ReleaseFileCacheManager, do not find file cache manager of "
                    "inode: "
                 << inodeId;
         return;
     }
 
-    fileCacheManagerMap_.erase(iter);
+    shard.fileCacheManagerMap.erase(iter);
     g_s3MultiManagerMetric->fileManagerNum << -1;
     return;
 }
 
 bool FsCacheManager::Set(DataCachePtr dataCache,
                          std::list<DataCachePtr>::iterator *outIter) {
-    std::lock_guard<std::mutex> lk(lruMtx_);
-    VLOG(3) << "lru current byte: " << lruByte_
+    VLOG(3) << "lru current byte: " << GetLruByte()
             << ", lru max byte: " << readCacheMaxByte_
             << ", dataCache len: " << dataCache->GetLen();
     if (readCacheMaxByte_ == 0) {
         return false;
     }
+
+    LruShard &shard = GetLruShard(dataCache);
+    std::lock_guard<std::mutex> lk(shard.mtx);
     // trim cache without consider dataCache's size, because its size is
     // expected to be very smaller than `readCacheMaxByte_`
-    if (lruByte_ >= readCacheMaxByte_) {
+    uint64_t lruByte = GetLruByte();
+    if (lruByte >= readCacheMaxByte_) {
         uint64_t retiredBytes = 0;
-        auto iter = lruReadDataCacheList_.end();
+        auto iter = shard.lruReadDataCacheList.end();
 
-        while (lruByte_ >= readCacheMaxByte_) {
+        while (lruByte >= readCacheMaxByte_ &&
+               iter != shard.lruReadDataCacheList.begin()) {
             --iter;
             auto &trim = *iter;
             trim->SetReadCacheState(false);
-            lruByte_ -= trim->GetActualLen();
+            lruByte -= trim->GetActualLen();
             retiredBytes += trim->GetActualLen();
         }
+        lruByte_.fetch_sub(retiredBytes, std::memory_order_relaxed);
 
         std::list<DataCachePtr> retired;
-        retired.splice(retired.end(), lruReadDataCacheList_, iter,
-                       lruReadDataCacheList_.end());
+        retired.splice(retired.end(), shard.lruReadDataCacheList, iter,
+                       shard.lruReadDataCacheList.end());
 
         VLOG(3) << "lru release " << retiredBytes << " bytes, retired "
                 << retired.size() << " data cache";
@@ -167,52 +189,56 @@ bool FsCacheManager::Set(DataCachePtr dataCache,
         releaseReadCache_.Release(&retired);
     }
 
-    lruByte_ += dataCache->GetActualLen();
+    lruByte_.fetch_add(dataCache->GetActualLen(), std::memory_order_relaxed);
     dataCache->SetReadCacheState(true);
-    lruReadDataCacheList_.push_front(std::move(dataCache));
-    *outIter = lruReadDataCacheList_.begin();
+    shard.lruReadDataCacheList.push_front(std::move(dataCache));
+    *outIter = shard.lruReadDataCacheList.begin();
     return true;
 }
 
 void FsCacheManager::Get(std::list<DataCachePtr>::iterator iter) {
-    std::lock_guard<std::mutex> lk(lruMtx_);
+    LruShard &shard = GetLruShard(*iter);
+    std::lock_guard<std::mutex> lk(shard.mtx);
 
     if (!(*iter)->InReadCache()) {
         return;
     }
 
-    lruReadDataCacheList_.splice(lruReadDataCacheList_.begin(),
-                                 lruReadDataCacheList_, iter);
+    shard.lruReadDataCacheList.splice(shard.lruReadDataCacheList.begin(),
+                                      shard.lruReadDataCacheList, iter);
 }
 
 bool FsCacheManager::Delete(std::list<DataCachePtr>::iterator iter) {
-    std::lock_guard<std::mutex> lk(lruMtx_);
+    LruShard &shard = GetLruShard(*iter);
+    std::lock_guard<std::mutex> lk(shard.mtx);
 
     if (!(*iter)->InReadCache()) {
         return false;
     }
 
     (*iter)->SetReadCacheState(false);
-    lruByte_ -= (*iter)->GetActualLen();
-    lruReadDataCacheList_.erase(iter);
+    lruByte_.fetch_sub((*iter)->GetActualLen(), std::memory_order_relaxed);
+    shard.lruReadDataCacheList.erase(iter);
     return true;
 }
 
 CURVEFS_ERROR FsCacheManager::FsSync(bool force) {
     CURVEFS_ERROR ret;
     std::unordered_map<uint64_t, FileCacheManagerPtr> tmp;
-    {
-        WriteLockGuard writeLockGuard(rwLock_);
-        tmp = fileCacheManagerMap_;
+    for (auto &shard : fileCacheManagerShards_) {
+        ReadLockGuard readLockGuard(shard.rwLock);
+        tmp.insert(shard.fileCacheManagerMap.begin(),
+                   shard.fileCacheManagerMap.end());
     }
 
     auto iter = tmp.begin();
     for (; iter != tmp.end(); iter++) {
+        FileCacheManagerShard &shard = GetFileCacheManagerShard(iter->first);
         ret = iter->second->Flush(force);
         if (ret == CURVEFS_ERROR::OK) {
-            WriteLockGuard writeLockGuard(rwLock_);
-            auto iter1 = fileCacheManagerMap_.find(iter->first);
-            if (iter1 == fileCacheManagerMap_.end()) {
+            WriteLockGuard writeLockGuard(shard.rwLock);
+            auto iter1 = shard.fileCacheManagerMap.find(iter->first);
+            if (iter1 == shard.fileCacheManagerMap.end()) {
                 VLOG(1) << "FsSync, chunk cache for inodeid: " << iter->first
                         << " is removed";
                 continue;
@@ -220,7 +246,7 @@ CURVEFS_ERROR FsCacheManager::FsSync(bool force) {
                 VLOG(9) << "FileCacheManagerPtr count:"
                         << iter1->second.use_count()
                         << ", inodeId:" << iter1->first;
-                // tmp and fileCacheManagerMap_ has this FileCacheManagerPtr, so
+                // tmp and the shard map has this FileCacheManagerPtr, so
                 // count is 2 if count more than 2, this mean someone thread has
                 // this FileCacheManagerPtr
                 // TODO(@huyao) https://github.com/opencurve/curve/issues/1473
@@ -228,18 +254,18 @@ CURVEFS_ERROR FsCacheManager::FsSync(bool force) {
                     (iter1->second.use_count() <= 2)) {
                     VLOG(9) << "Release FileCacheManager, inode id: "
                             << iter1->second->GetInodeId();
-                    fileCacheManagerMap_.erase(iter1);
+                    shard.fileCacheManagerMap.erase(iter1);
                     g_s3MultiManagerMetric->fileManagerNum << -1;
                 }
             }
         } else if (ret == CURVEFS_ERROR::NOT_EXIST) {
             iter->second->ReleaseCache();
-            WriteLockGuard writeLockGuard(rwLock_);
-            auto iter1 = fileCacheManagerMap_.find(iter->first);
-            if (iter1 != fileCacheManagerMap_.end()) {
+            WriteLockGuard writeLockGuard(shard.rwLock);
+            auto iter1 = shard.fileCacheManagerMap.find(iter->first);
+            if (iter1 != shard.fileCacheManagerMap.end()) {
                 VLOG(9) << "Release FileCacheManager, inode id: "
                         << iter1->second->GetInodeId();
-                fileCacheManagerMap_.erase(iter1);
+                shard.fileCacheManagerMap.erase(iter1);
                 g_s3MultiManagerMetric->fileManagerNum << -1;
             }
         } else {
@@ -248,11 +274,78 @@ CURVEFS_ERROR FsCacheManager::FsSync(bool force) {
         }
     }
 
+    // all dirty data has been flushed, give the free pages back
+    if (force && pagePool_ != nullptr) {
+        pagePool_->Trim();
+    }
     return CURVEFS_ERROR::OK;
 }
 
 int FileCacheManager::Write(uint64_t offset, uint64_t length,
                             const char *dataBuf) {
+    ChunkCacheManagerPtr chunkCacheManager;
+    if (s3ClientAdaptor_->GetInlineDataMaxSize() > 0) {
+        int ret = WriteInline(offset, length, dataBuf, &chunkCacheManager);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+    return WriteCache(offset, length, dataBuf);
+}
+
+int FileCacheManager::WriteInline(uint64_t offset, uint64_t length,
+                                  const char *dataBuf,
+                                  ChunkCacheManagerPtr *chunkCacheManager) {
+    std::shared_ptr<InodeWrapper> inodeWrapper;
+    auto inodeManager = s3ClientAdaptor_->GetInodeCacheManager();
+    if (CURVEFS_ERROR::OK != inodeManager->GetInode(inode_, inodeWrapper)) {
+        LOG(ERROR) << "get inode = " << inode_ << " fail";
+        return -1;
+    }
+
+    curve::common::UniqueLock lgGuard = inodeWrapper->GetUniqueLock();
+    const Inode *inode = inodeWrapper->GetInodeLocked();
+    bool isInline = !inode->inlinedata().empty();
+    if (!isInline && inode->length() == 0 &&
+        inode->s3chunkinfomap().empty()) {
+        ReadLockGuard readLockGuard(rwLock_);
+        isInline = chunkCacheMap_.empty();
+    }
+
+    if (isInline &&
+        offset + length <= s3ClientAdaptor_->GetInlineDataMaxSize()) {
+        std::string data = inode->inlinedata();
+        if (data.size() < offset + length) {
+            data.resize(offset + length, '\0');
+        }
+        data.replace(offset, length, dataBuf, length);
+        inodeWrapper->SetInlineDataLocked(data);
+        VLOG(9) << "write inline data, inodeId: " << inode_
+                << ", offset: " << offset << ", len: " << length;
+        return length;
+    }
+
+    if (!inode->inlinedata().empty()) {
+        MoveInlineDataLocked(inodeWrapper.get());
+    }
+    uint64_t index = offset / s3ClientAdaptor_->GetChunkSize();
+    *chunkCacheManager = FindOrCreateChunkCacheManager(index);
+    return 0;
+}
+
+void FileCacheManager::MoveInlineDataLocked(InodeWrapper *inodeWrapper) {
+    const std::string data = inodeWrapper->GetInlineDataLocked();
+    if (data.empty()) {
+        return;
+    }
+    VLOG(6) << "move inline data to write cache, inodeId: " << inode_
+            << ", len: " << data.size();
+    WriteCache(0, data.size(), data.data());
+    inodeWrapper->SetInlineDataLocked(std::string());
+}
+
+int FileCacheManager::WriteCache(uint64_t offset, uint64_t length,
+                                 const char *dataBuf) {
     uint64_t chunkSize = s3ClientAdaptor_->GetChunkSize();
     uint64_t index = offset / chunkSize;
     uint64_t chunkPos = offset % chunkSize;
@@ -438,11 +531,19 @@ int FileCacheManager::HandleReadS3NotExist(
 
 int FileCacheManager::Read(uint64_t inodeId, uint64_t offset, uint64_t length,
                            char *dataBuf) {
+    prefetchWindow_.OnRead(offset, length,
+                           s3ClientAdaptor_->GetPrefetchBlocks(),
+                           FLAGS_s3PrefetchMaxBlocks);
+
     // 1. read from memory cache
     uint64_t actualReadLen = 0;
     std::vector<ReadRequest> memCacheMissRequest;
     ReadFromMemCache(offset, length, dataBuf, &actualReadLen,
                      &memCacheMissRequest);
+    if (s3ClientAdaptor_->s3Metric_) {
+        s3ClientAdaptor_->s3Metric_->memCache.Count(
+            memCacheMissRequest.empty());
+    }
     if (memCacheMissRequest.empty()) {
         return actualReadLen;
     }
@@ -456,6 +557,13 @@ int FileCacheManager::Read(uint64_t inodeId, uint64_t offset, uint64_t length,
         return -1;
     }
 
+    // the inline data is read even if inlining is disabled, the file may
+    // be written by other clients. an inline file has no data cached
+    uint64_t inlineReadLen = 0;
+    if (ReadInline(inodeWrapper, offset, length, dataBuf, &inlineReadLen)) {
+        return inlineReadLen;
+    }
+
     uint32_t retry = 0;
     do {
         // generate kv request
@@ -486,6 +594,30 @@ int FileCacheManager::Read(uint64_t inodeId, uint64_t offset, uint64_t length,
     return actualReadLen;
 }
 
+bool FileCacheManager::ReadInline(
+    const std::shared_ptr<InodeWrapper> &inodeWrapper, uint64_t offset,
+    uint64_t length, char *dataBuf, uint64_t *readLen) {
+    curve::common::UniqueLock lgGuard = inodeWrapper->GetUniqueLock();
+    const std::string &data = inodeWrapper->GetInlineDataLocked();
+    if (data.empty()) {
+        return false;
+    }
+
+    *readLen = 0;
+    if (offset < data.size()) {
+        *readLen = std::min<uint64_t>(length, data.size() - offset);
+        memcpy(dataBuf, data.data() + offset, *readLen);
+    }
+    VLOG(9) << "read inline data, inodeId: " << inode_
+            << ", offset: " << offset << ", len: " << *readLen;
+    return true;
+}
+
+bool FileCacheManager::IsDownloading(const std::string &name) {
+    curve::common::LockGuard lg(downloadMtx_);
+    return downloadingObj_.find(name) != downloadingObj_.end();
+}
+
 bool FileCacheManager::ReadKVRequestFromLocalCache(const std::string& name,
                                                    char* databuf,
                                                    uint64_t offset,
@@ -495,7 +627,7 @@ bool FileCacheManager::ReadKVRequestFromLocalCache(const std::string& name,
         return false;
     }
     if (!IsCachedInLocal(name) && len >= FLAGS_bigIoSize &&
-        s3ClientAdaptor_->GetPrefetchBlocks()) {
+        IsDownloading(name)) {
         int retry = 0;
         do {
             VLOG(6) << "wait for download object: " << name;
@@ -509,16 +641,23 @@ bool FileCacheManager::ReadKVRequestFromLocalCache(const std::string& name,
 
     if (!IsCachedInLocal(name)) {
         VLOG(9) << "not cachd in disk, " << name;
+        if (s3ClientAdaptor_->s3Metric_) {
+            s3ClientAdaptor_->s3Metric_->diskCache.Count(false);
+        }
         return false;
     }
 
     if (0 > s3ClientAdaptor_->GetDiskCacheManager()->Read(name, databuf, offset,
                                                           len)) {
         LOG(WARNING) << "object " << name << " not cached in disk";
+        if (s3ClientAdaptor_->s3Metric_) {
+            s3ClientAdaptor_->s3Metric_->diskCache.Count(false);
+        }
         return false;
     }
 
     if (s3ClientAdaptor_->s3Metric_) {
+        s3ClientAdaptor_->s3Metric_->diskCache.Count(true);
         curve::client::CollectMetrics(
             &s3ClientAdaptor_->s3Metric_->adaptorReadS3, len,
             butil::cpuwide_time_us() - start);
@@ -539,6 +678,9 @@ bool FileCacheManager::ReadKVRequestFromRemoteCache(const std::string &name,
 
     CountDownEvent event(1);
     GetKVCacheDone cb = [&](const std::shared_ptr<GetKVCacheTask>& task) {
+        if (s3ClientAdaptor_->s3Metric_ != nullptr) {
+            s3ClientAdaptor_->s3Metric_->kvCache.Count(task->res);
+        }
         if (task->res && s3ClientAdaptor_->s3Metric_ != nullptr) {
             curve::client::CollectMetrics(
                 &s3ClientAdaptor_->s3Metric_->readFromKVCache, task->length,
@@ -560,14 +702,23 @@ bool FileCacheManager::ReadKVRequestFromS3(const std::string &name,
                                            char *databuf, uint64_t offset,
                                            uint64_t length, int *ret) {
     uint64_t start = butil::cpuwide_time_us();
-    *ret = s3ClientAdaptor_->GetS3Client()->Download(name, databuf, offset,
-                                                     length);
+    bool shared = false;
+    *ret = inflightReads_.Read(
+        name, offset, length, databuf,
+        [&](char *buf, uint64_t off, uint64_t len) {
+            return s3ClientAdaptor_->GetS3Client()->Download(name, buf, off,
+                                                             len);
+        },
+        &shared);
     if (*ret < 0) {
         LOG(ERROR) << "object " << name << " read from s3 fail, ret = " << *ret;
         return false;
     }
 
-    if (s3ClientAdaptor_->s3Metric_) {
+    if (shared) {
+        VLOG(9) << "object " << name << " shares the read in flight, offset "
+                << offset << ", length " << length;
+    } else if (s3ClientAdaptor_->s3Metric_) {
         curve::client::CollectMetrics(
             &s3ClientAdaptor_->s3Metric_->adaptorReadS3, length,
             butil::cpuwide_time_us() - start);
@@ -617,9 +768,13 @@ void FileCacheManager::ProcessKVRequest(const S3ReadRequest &req, char *dataBuf,
     const uint32_t objectPrefix = s3ClientAdaptor_->GetObjectPrefix();
     GetBlockLoc(req.offset, &chunkIndex, &chunkPos, &blockIndex, &blockPos);
 
-    std::string prefetchName = curvefs::common::s3util::GenObjName(
-        req.chunkId, blockIndex, req.compaction, req.fsId, req.inodeId,
-        objectPrefix);
+    const bool packed = req.packId != 0;
+    std::string prefetchName =
+        packed ? curvefs::common::s3util::GenPackObjName(req.packId, req.fsId,
+                                                         objectPrefix)
+               : curvefs::common::s3util::GenObjName(
+                     req.chunkId, blockIndex, req.compaction, req.fsId,
+                     req.inodeId, objectPrefix);
     bool waitDownloading = false;
     // if obj is in downloading, wait for it.
     while (true) {
@@ -642,8 +797,8 @@ void FileCacheManager::ProcessKVRequest(const S3ReadRequest &req, char *dataBuf,
         }
     }
 
-    // prefetch
-    if (s3ClientAdaptor_->HasDiskCache() && !waitDownloading &&
+    // prefetch, the blocks after a slice are not in its pack
+    if (!packed && s3ClientAdaptor_->HasDiskCache() && !waitDownloading &&
         !IsCachedInLocal(prefetchName)) {
         PrefetchForBlock(req, fileLen, blockSize, chunkSize, blockIndex);
     }
@@ -664,29 +819,35 @@ void FileCacheManager::ProcessKVRequest(const S3ReadRequest &req, char *dataBuf,
         currentReadLen =
             length + blockPos > blockSize ? blockSize - blockPos : length;
         assert(blockPos >= objectOffset);
-        std::string name = curvefs::common::s3util::GenObjName(
-            req.chunkId, blockIndex, req.compaction, req.fsId, req.inodeId,
-            objectPrefix);
+        std::string name = packed ? prefetchName
+                                  : curvefs::common::s3util::GenObjName(
+                                        req.chunkId, blockIndex,
+                                        req.compaction, req.fsId,
+                                        req.inodeId, objectPrefix);
         char *currentBuf = dataBuf + req.readOffset + readBufOffset;
+        // a slice lies in one block, at packOffset of the pack
+        uint64_t objectPos = blockPos - objectOffset;
+        if (packed) {
+            assert(currentReadLen == length);
+            objectPos += req.packOffset;
+        }
 
         // read from localcache -> remotecache -> s3
         do {
-            if (ReadKVRequestFromLocalCache(name, currentBuf,
-                                            blockPos - objectOffset,
+            if (ReadKVRequestFromLocalCache(name, currentBuf, objectPos,
                                             currentReadLen)) {
                 VLOG(9) << "read " << name << " from local cache ok";
                 break;
             }
 
-            if (ReadKVRequestFromRemoteCache(name, currentBuf,
-                                             blockPos - objectOffset,
+            if (ReadKVRequestFromRemoteCache(name, currentBuf, objectPos,
                                              currentReadLen)) {
                 VLOG(9) << "read " << name << " from remote cache ok";
                 break;
             }
 
             int ret = 0;
-            if (ReadKVRequestFromS3(name, currentBuf, blockPos - objectOffset,
+            if (ReadKVRequestFromS3(name, currentBuf, objectPos,
                                     currentReadLen, &ret)) {
                 VLOG(9) << "read " << name << " from s3 ok";
                 break;
@@ -711,8 +872,17 @@ void FileCacheManager::ProcessKVRequest(const S3ReadRequest &req, char *dataBuf,
         }
     }
 
-    // add data to memory read cache
+    // add data to memory read cache if admitted, data read only once
+    // (e.g. by a scan) is kept in the lower tiers and not promoted
     if (!curvefs::client::common::FLAGS_enableCto) {
+        auto admission = s3ClientAdaptor_->GetReadCacheAdmission();
+        if (admission != nullptr && !admission->Admit(prefetchName)) {
+            VLOG(9) << "not admitted into memory read cache: " << prefetchName;
+            if (s3ClientAdaptor_->s3Metric_) {
+                s3ClientAdaptor_->s3Metric_->memCacheAdmissionReject << 1;
+            }
+            return;
+        }
         auto chunkCacheManager = FindOrCreateChunkCacheManager(chunkIndex);
         WriteLockGuard writeLockGuard(chunkCacheManager->rwLockChunk_);
         DataCachePtr dataCache = std::make_shared<DataCache>(
@@ -726,7 +896,7 @@ void FileCacheManager::PrefetchForBlock(const S3ReadRequest& req,
                                         uint64_t fileLen, uint64_t blockSize,
                                         uint64_t chunkSize,
                                         uint64_t startBlockIndex) {
-    uint32_t prefetchBlocks = s3ClientAdaptor_->GetPrefetchBlocks();
+    uint32_t prefetchBlocks = prefetchWindow_.GetWindow();
     if (prefetchBlocks == 0) {
         return;
     }
@@ -770,6 +940,7 @@ class AsyncPrefetchCallback {
         VLOG(9) << "prefetch end: " << context->key << ", len " << context->len
                 << "actual len: " << context->actualLen << ", " << fromS3_;
         std::unique_ptr<char[]> guard(context->buf);
+        s3Client_->GetPrefetchBudget()->Release();
         auto fileCache =
             s3Client_->GetFsCacheManager()->FindFileCacheManager(inode_);
 
@@ -782,11 +953,13 @@ class AsyncPrefetchCallback {
 
         if (context->retCode != 0 && !fromS3_) {
             VLOG(6) << "failed and then get from s3, key: " << context->key;
+            {
+                curve::common::LockGuard lg(fileCache->downloadMtx_);
+                fileCache->downloadingObj_.erase(context->key);
+            }
             std::vector<std::pair<std::string, uint64_t>> prefetchObjs;
             prefetchObjs.push_back(std::make_pair(context->key, context->len));
             fileCache->PrefetchS3Objs(prefetchObjs);
-            curve::common::LockGuard lg(fileCache->downloadMtx_);
-            fileCache->downloadingObj_.erase(context->key);
             return;
         } else if (context->retCode != 0 && fromS3_) {
             curve::common::LockGuard lg(fileCache->downloadMtx_);
@@ -842,6 +1015,11 @@ void FileCacheManager::PrefetchS3Objs(
                     << ", size: " << downloadingObj_.size();
             continue;
         }
+        if (!s3ClientAdaptor_->GetPrefetchBudget()->TryAcquire(
+                FLAGS_s3PrefetchMaxInflightBlocks)) {
+            VLOG(6) << "prefetch budget is used up, skip: " << name;
+            break;
+        }
         VLOG(9) << "download start: " << name
                 << ", size: " << downloadingObj_.size()
                 << ", from s3: " << fromS3;
@@ -875,6 +1053,8 @@ void FileCacheManager::HandleReadRequest(
     uint64_t blockSize = s3ClientAdaptor_->GetBlockSize();
     uint64_t chunkSize = s3ClientAdaptor_->GetChunkSize();
     S3ReadRequest s3Request;
+    s3Request.packId = s3ChunkInfo.packid();
+    s3Request.packOffset = s3ChunkInfo.packoffset();
     uint64_t s3ChunkInfoOffset = s3ChunkInfo.offset();
     uint64_t s3ChunkInfoLen = s3ChunkInfo.len();
     uint64_t fileOffset = request.index * chunkSize + request.chunkPos;
@@ -1874,7 +2054,9 @@ DataCache::DataCache(S3ClientAdaptorImpl *s3ClientAdaptor,
                      std::shared_ptr<KVClientManager> kvClientManager)
     : s3ClientAdaptor_(std::move(s3ClientAdaptor)),
       chunkCacheManager_(chunkCacheManager), status_(DataCacheStatus::Dirty),
-      inReadCache_(false) {
+      inReadCache_(false),
+      pagePool_(s3ClientAdaptor->GetFsCacheManager()->GetPagePool()) {
+    assert(pagePool_ != nullptr);
     uint64_t blockSize = s3ClientAdaptor->GetBlockSize();
     uint32_t pageSize = s3ClientAdaptor->GetPageSize();
     chunkPos_ = chunkPos;
@@ -1906,14 +2088,11 @@ DataCache::DataCache(S3ClientAdaptorImpl *s3ClientAdaptor,
                 m = blockLen;
             }
 
-            PageData *pageData = new PageData();
-            pageData->data = new char[pageSize];
-            memset(pageData->data, 0, pageSize);
+            PageData *pageData = NewPage(pageIndex);
             memcpy(pageData->data + pagePos, data + dataOffset, m);
             if (pagePos + m < pageSize) {
                 tailZeroLen = pageSize - pagePos - m;
             }
-            pageData->index = pageIndex;
             assert(pdMap.count(pageIndex) == 0);
             pdMap.emplace(pageIndex, pageData);
             pageIndex++;
@@ -1934,6 +2113,19 @@ DataCache::DataCache(S3ClientAdaptorImpl *s3ClientAdaptor,
     kvClientManager_ = std::move(kvClientManager);
 }
 
+PageData *DataCache::NewPage(uint64_t pageIndex) {
+    PageData *pageData = new PageData();
+    pageData->data = pagePool_->Allocate();
+    memset(pageData->data, 0, pagePool_->GetPageSize());
+    pageData->index = pageIndex;
+    return pageData;
+}
+
+void DataCache::FreePage(PageData *pageData) {
+    pagePool_->Release(pageData->data);
+    delete pageData;
+}
+
 void DataCache::CopyBufToDataCache(uint64_t dataCachePos, uint64_t len,
                                    const char *data) {
     uint64_t blockSize = s3ClientAdaptor_->GetBlockSize();
@@ -1972,10 +2164,7 @@ void DataCache::CopyBufToDataCache(uint64_t dataCachePos, uint64_t len,
             if (pdMap.count(pageIndex)) {
                 pageData = pdMap[pageIndex];
             } else {
-                pageData = new PageData();
-                pageData->data = new char[pageSize];
-                memset(pageData->data, 0, pageSize);
-                pageData->index = pageIndex;
+                pageData = NewPage(pageIndex);
                 pdMap.emplace(pageIndex, pageData);
                 addLen += pageSize;
             }
@@ -2032,10 +2221,7 @@ void DataCache::AddDataBefore(uint64_t len, const char *data) {
             if (pdMap.count(pageIndex)) {
                 pageData = pdMap[pageIndex];
             } else {
-                pageData = new PageData();
-                pageData->data = new char[pageSize];
-                memset(pageData->data, 0, pageSize);
-                pageData->index = pageIndex;
+                pageData = NewPage(pageIndex);
                 pdMap.emplace(pageIndex, pageData);
             }
             memcpy(pageData->data + pagePos, data + dataOffset, m);
@@ -2279,8 +2465,7 @@ void DataCache::Truncate(uint64_t size) {
 
             if (pagePos == 0) {
                 if (pdMap.count(pageIndex)) {
-                    pageData = pdMap[pageIndex];
-                    delete pageData->data;
+                    FreePage(pdMap[pageIndex]);
                     pdMap.erase(pageIndex);
                     actualLen_ -= pageSize;
                 }
@@ -2382,6 +2567,11 @@ CURVEFS_ERROR DataCache::Flush(uint64_t inodeId, bool toS3) {
         return CURVEFS_ERROR::INTERNAL;
     }
     CopyDataCacheToBuf(0, len_, data);
+    if (ShouldPack(toS3)) {
+        CURVEFS_ERROR ret = FlushToPack(inodeId, data);
+        delete[] data;
+        return ret;
+    }
     uint64_t writeOffset = 0;
     uint64_t chunkId = 0;
     CURVEFS_ERROR ret = PrepareFlushTasks(
@@ -2415,6 +2605,51 @@ CURVEFS_ERROR DataCache::Flush(uint64_t inodeId, bool toS3) {
     return CURVEFS_ERROR::OK;
 }
 
+bool DataCache::ShouldPack(bool toS3) {
+    if (s3ClientAdaptor_->GetObjectPacker() == nullptr ||
+        len_ > s3ClientAdaptor_->GetPackMaxSliceSize()) {
+        return false;
+    }
+    // a slice lies in one block, so that it's read as one object, and the
+    // writes are not packed if they go to the disk cache first
+    uint64_t blockSize = s3ClientAdaptor_->GetBlockSize();
+    return chunkPos_ % blockSize + len_ <= blockSize &&
+           GetCachePolicy(toS3) != CachePolicy::WRCache;
+}
+
+CURVEFS_ERROR DataCache::FlushToPack(uint64_t inodeId, const char *data) {
+    // get the inode first, a slice uploaded and not recorded in the inode
+    // would keep its pack forever
+    std::shared_ptr<InodeWrapper> inodeWrapper;
+    CURVEFS_ERROR ret = s3ClientAdaptor_->GetInodeCacheManager()->GetInode(
+        inodeId, inodeWrapper);
+    if (ret != CURVEFS_ERROR::OK) {
+        LOG(WARNING) << "get inode fail, ret:" << ret;
+        status_.store(DataCacheStatus::Dirty, std::memory_order_release);
+        return ret;
+    }
+
+    ObjectPacker::Slice slice;
+    if (!s3ClientAdaptor_->GetObjectPacker()->Pack(data, len_, &slice)) {
+        LOG(ERROR) << "pack slice failed, inodeId: " << inodeId
+                   << ", len: " << len_;
+        return CURVEFS_ERROR::INTERNAL;
+    }
+
+    S3ChunkInfo info;
+    uint64_t chunkIndex = chunkCacheManager_->GetIndex();
+    uint64_t chunkSize = s3ClientAdaptor_->GetChunkSize();
+    int64_t offset = chunkIndex * chunkSize + chunkPos_;
+    PrepareS3ChunkInfo(slice.packId, offset, len_, &info);
+    info.set_packid(slice.packId);
+    info.set_packoffset(slice.offset);
+    info.set_packindex(slice.index);
+    info.set_packcount(slice.count);
+    inodeWrapper->AppendS3ChunkInfo(chunkIndex, info);
+    s3ClientAdaptor_->GetInodeCacheManager()->ShipToFlush(inodeWrapper);
+    return CURVEFS_ERROR::OK;
+}
+
 CURVEFS_ERROR DataCache::PrepareFlushTasks(
     uint64_t inodeId, char *data,
     std::vector<std::shared_ptr<PutObjectAsyncContext>> *s3Tasks,
@@ -2500,10 +2735,20 @@ void DataCache::FlushTaskExecute(
     std::atomic<uint64_t> kvPendingTaskCal(kvCacheTasks.size());
     CountDownEvent s3TaskEvent(s3PendingTaskCal);
     CountDownEvent kvTaskEvent(kvPendingTaskCal);
+    // uploads to s3 take a slot of the budget shared by all inodes, the
+    // ones written to disk cache first are not limited
+    std::shared_ptr<UploadLimiter> uploadLimiter;
+    if (CachePolicy::WRCache != cachePolicy) {
+        uploadLimiter = s3ClientAdaptor_->GetUploadLimiter();
+    }
 
     PutObjectAsyncCallBack s3cb =
         [&](const std::shared_ptr<PutObjectAsyncContext>& context) {
             if (context->retCode >= 0) {
+                if (uploadLimiter != nullptr) {
+                    uploadLimiter->OnComplete(context->bufferSize,
+                                              context->timer.u_elapsed());
+                }
                 if (s3ClientAdaptor_->s3Metric_ != nullptr) {
                     metric::AsyncContextCollectMetrics(
                         s3ClientAdaptor_->s3Metric_, context);
@@ -2523,6 +2768,9 @@ void DataCache::FlushTaskExecute(
             }
 
             LOG(WARNING) << "Put object failed, key: " << context->key;
+            if (uploadLimiter != nullptr) {
+                uploadLimiter->OnError();
+            }
             // Retry using s3 no matter what the original was
             context->type = curve::common::ContextType::S3;
             s3ClientAdaptor_->GetS3Client()->UploadAsync(context);
@@ -2548,6 +2796,11 @@ void DataCache::FlushTaskExecute(
                     context->type = curve::common::ContextType::Disk;
                     s3ClientAdaptor_->GetDiskCacheManager()->Enqueue(context);
                 } else {
+                    if (uploadLimiter != nullptr) {
+                        uploadLimiter->Acquire();
+                        // measure the upload only, not the wait
+                        context->timer.start();
+                    }
                     context->type = curve::common::ContextType::S3;
                     s3ClientAdaptor_->GetS3Client()->UploadAsync(context);
                 }
@@ -23,6 +23,7 @@
 #define CURVEFS_SRC_CLIENT_S3_CLIENT_S3_CACHE_MANAGER_H_
 
 #include <algorithm>
+#include <array>
 #include <cstring>
 #include <list>
 #include <map>
@@ -38,6 +39,9 @@
 #include "curvefs/src/client/inode_wrapper.h"
 #include "curvefs/src/client/kvclient/kvclient_manager.h"
 #include "curvefs/src/client/s3/client_s3.h"
+#include "curvefs/src/client/s3/inflight_reads.h"
+#include "curvefs/src/client/s3/page_pool.h"
+#include "curvefs/src/client/s3/prefetch_window.h"
 #include "src/common/concurrent/concurrent.h"
 #include "src/common/concurrent/task_thread_pool.h"
 
@@ -96,6 +100,10 @@ struct S3ReadRequest {
     uint64_t fsId;
     uint64_t inodeId;
     uint64_t compaction;
+    // the data is a slice of a pack if packId is not 0, it begins at
+    // packOffset of the pack
+    uint64_t packId = 0;
+    uint64_t packOffset = 0;
 
     std::string DebugString() const {
         std::ostringstream os;
@@ -103,6 +111,7 @@ struct S3ReadRequest {
            << ", len = " << len << ", objectOffset = " << objectOffset
            << ", readOffset = " << readOffset << ", fsId = " << fsId
            << ", inodeId = " << inodeId << ", compaction = " << compaction
+           << ", packId = " << packId << ", packOffset = " << packOffset
            << " )";
         return os.str();
     }
@@ -143,8 +152,7 @@ class DataCache : public std::enable_shared_from_this<DataCache> {
         for (; iter != dataMap_.end(); iter++) {
             auto pageIter = iter->second.begin();
             for (; pageIter != iter->second.end(); pageIter++) {
-                delete[] pageIter->second->data;
-                delete pageIter->second;
+                FreePage(pageIter->second);
             }
         }
     }
@@ -154,6 +162,9 @@ class DataCache : public std::enable_shared_from_this<DataCache> {
     virtual void Truncate(uint64_t size);
     uint64_t GetChunkPos() { return chunkPos_; }
     uint64_t GetLen() { return len_; }
+    const ChunkCacheManagerPtr &GetChunkCacheManager() const {
+        return chunkCacheManager_;
+    }
     PageData *GetPageData(uint64_t blockIndex, uint64_t pageIndex) {
         PageDataMap &pdMap = dataMap_[blockIndex];
         if (pdMap.count(pageIndex)) {
@@ -222,6 +233,16 @@ class DataCache : public std::enable_shared_from_this<DataCache> {
 
     CachePolicy GetCachePolicy(bool toS3);
 
+    // whether to flush into a pack shared with other flushes, see
+    // ObjectPacker
+    bool ShouldPack(bool toS3);
+
+    CURVEFS_ERROR FlushToPack(uint64_t inodeId, const char *data);
+
+    // allocate a zeroed page from the page pool
+    PageData *NewPage(uint64_t pageIndex);
+    void FreePage(PageData *pageData);
+
  private:
     S3ClientAdaptorImpl *s3ClientAdaptor_;
     ChunkCacheManagerPtr chunkCacheManager_;
@@ -236,6 +257,8 @@ class DataCache : public std::enable_shared_from_this<DataCache> {
     std::map<uint64_t, PageDataMap> dataMap_;  // first is block index
 
     std::shared_ptr<KVClientManager> kvClientManager_;
+    // hold the pool, pages may be freed after the adaptor is gone
+    std::shared_ptr<PagePool> pagePool_;
 };
 
 class S3ReadResponse {
@@ -353,6 +376,10 @@ class FileCacheManager {
     virtual int Read(uint64_t inodeId, uint64_t offset, uint64_t length,
                      char *dataBuf);
 
+    // move the inline data of the file into the write cache, the inode
+    // must be locked
+    void MoveInlineDataLocked(InodeWrapper *inodeWrapper);
+
     bool IsEmpty() { return chunkCacheMap_.empty(); }
 
     uint64_t GetInodeId() const { return inode_; }
@@ -369,6 +396,22 @@ class FileCacheManager {
  private:
     void WriteChunk(uint64_t index, uint64_t chunkPos, uint64_t writeLen,
                     const char *dataBuf);
+
+    // write [offset, offset + length) into the write cache chunk by chunk
+    int WriteCache(uint64_t offset, uint64_t length, const char *dataBuf);
+
+    // write into the inline data if the file is inline and stays small
+    // enough, otherwise move the inline data to the write cache and set
+    // the chunk cache written first, held so that the file isn't turned
+    // inline by another write before the data is cached
+    // @return the bytes written inline, 0 if not, -1 on failure
+    int WriteInline(uint64_t offset, uint64_t length, const char *dataBuf,
+                    ChunkCacheManagerPtr *chunkCacheManager);
+
+    // read from the inline data, false if the file is not inline
+    bool ReadInline(const std::shared_ptr<InodeWrapper> &inodeWrapper,
+                    uint64_t offset, uint64_t length, char *dataBuf,
+                    uint64_t *readLen);
     void GenerateS3Request(ReadRequest request,
                            const S3ChunkInfoList& s3ChunkInfoList,
                            char* dataBuf, std::vector<S3ReadRequest>* requests,
@@ -410,6 +453,9 @@ class FileCacheManager {
 
     bool IsCachedInLocal(const std::string name);
 
+    // whether the object is being prefetched
+    bool IsDownloading(const std::string &name);
+
     enum class ReadStatus {
         OK = 0,
         S3_READ_FAIL = -1,
@@ -468,6 +514,10 @@ class FileCacheManager {
     S3ClientAdaptorImpl *s3ClientAdaptor_;
     curve::common::Mutex downloadMtx_;
     std::set<std::string> downloadingObj_;
+    // blocks to prefetch, following the access pattern of the file
+    PrefetchWindow prefetchWindow_;
+    // object ranges being read from s3, shared by concurrent readers
+    InflightReads inflightReads_;
 
     std::shared_ptr<KVClientManager> kvClientManager_;
     std::shared_ptr<TaskThreadPool<>> readTaskPool_;
@@ -538,15 +588,16 @@ class FsCacheManager {
     }
 
     uint64_t GetLruByte() {
-        std::lock_guard<std::mutex> lk(lruMtx_);
-        return lruByte_;
+        return lruByte_.load(std::memory_order_relaxed);
     }
 
     void SetFileCacheManagerForTest(uint64_t inodeId,
                                     FileCacheManagerPtr fileCacheManager) {
-        WriteLockGuard writeLockGuard(rwLock_);
+        FileCacheManagerShard &shard = GetFileCacheManagerShard(inodeId);
+        WriteLockGuard writeLockGuard(shard.rwLock);
 
-        auto ret = fileCacheManagerMap_.emplace(inodeId, fileCacheManager);
+        auto ret = shard.fileCacheManagerMap.emplace(inodeId,
+                                                     fileCacheManager);
         assert(ret.second);
         (void)ret;
     }
@@ -555,6 +606,11 @@ class FsCacheManager {
     void DataCacheByteInc(uint64_t v);
     void DataCacheByteDec(uint64_t v);
 
+    // create the pool of page buffers once the page size is known
+    void InitPagePool(uint32_t pageSize);
+
+    std::shared_ptr<PagePool> GetPagePool() { return pagePool_; }
+
  private:
     class ReadCacheReleaseExecutor {
      public:
@@ -576,14 +632,39 @@ class FsCacheManager {
         std::thread t_;
     };
 
+    static constexpr uint32_t kShardNum = 32;
+
+    // inodes are spread over the shards, so that different files
+    // rarely contend for the same lock
+    struct FileCacheManagerShard {
+        RWLock rwLock;
+        std::unordered_map<uint64_t, FileCacheManagerPtr>
+            fileCacheManagerMap;  // first is inodeid
+    };
+
+    // read data caches of the same chunk are in the same shard, a shard
+    // only trims its own lru list while the total bytes of all shards
+    // exceed readCacheMaxByte_, so the limit is approximate
+    struct LruShard {
+        std::mutex mtx;
+        std::list<DataCachePtr> lruReadDataCacheList;
+    };
+
+    FileCacheManagerShard &GetFileCacheManagerShard(uint64_t inodeId) {
+        return fileCacheManagerShards_[inodeId % kShardNum];
+    }
+
+    LruShard &GetLruShard(const DataCachePtr &dataCache) {
+        auto key = std::hash<ChunkCacheManager *>()(
+            dataCache->GetChunkCacheManager().get());
+        return lruShards_[key % kShardNum];
+    }
+
  private:
-    std::unordered_map<uint64_t, FileCacheManagerPtr>
-        fileCacheManagerMap_;  // first is inodeid
-    RWLock rwLock_;
-    std::mutex lruMtx_;
+    std::array<FileCacheManagerShard, kShardNum> fileCacheManagerShards_;
+    std::array<LruShard, kShardNum> lruShards_;
 
-    std::list<DataCachePtr> lruReadDataCacheList_;
-    uint64_t lruByte_;
+    std::atomic<uint64_t> lruByte_;
     std::atomic<uint64_t> wDataCacheNum_;
     std::atomic<uint64_t> wDataCacheByte_;
     uint64_t readCacheMaxByte_;
@@ -597,6 +678,9 @@ class FsCacheManager {
 
     std::shared_ptr<KVClientManager> kvClientManager_;
 
+    // page buffers shared by all data caches
+    std::shared_ptr<PagePool> pagePool_;
+
     std::shared_ptr<TaskThreadPool<>> readTaskPool_ =
         std::make_shared<TaskThreadPool<>>();
 };
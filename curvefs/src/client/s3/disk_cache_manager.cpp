@@ -23,6 +23,7 @@
 #include "curvefs/src/client/s3/disk_cache_manager.h"
 
 #include <errno.h>
+#include <fcntl.h>
 #include <glog/logging.h>
 #include <sys/vfs.h>
 
@@ -30,7 +31,9 @@
 #include <cstdio>
 #include <list>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include "curvefs/src/client/metric/client_metric.h"
 #include "curvefs/src/client/s3/client_s3_adaptor.h"
@@ -116,9 +119,21 @@ int DiskCacheManager::Init(std::shared_ptr<S3Client> client,
         LOG(ERROR) << "create cache dir error, ret = " << ret;
         return ret;
     }
+    if (option.diskCacheOpt.readCacheLayout == "slab") {
+        ret = cacheRead_->InitSlab(cacheDir_ + "/slab", option.blockSize,
+                                   FLAGS_diskMaxUsableSpaceBytes,
+                                   option.diskCacheOpt.slabDirectIO);
+        if (ret < 0) {
+            LOG(ERROR) << "init slab read cache error, ret = " << ret;
+            return ret;
+        }
+    } else if (option.diskCacheOpt.readCacheLayout != "file") {
+        LOG(ERROR) << "unknown read cache layout: "
+                   << option.diskCacheOpt.readCacheLayout;
+        return -1;
+    }
     // load all cache read file
-    // the all value of cachedObjName_ is set false
-    ret = cacheRead_->LoadAllCacheReadFile(cachedObjName_);
+    ret = LoadAllCacheReadFile();
     if (ret < 0) {
         LOG(ERROR) << "load all cache read file error. ret = " << ret;
         return ret;
@@ -200,11 +215,92 @@ int DiskCacheManager::UmountDiskCache() {
     LOG(INFO) << "umount disk cache.";
     TrimStop();
     cacheWrite_->AsyncUploadStop();
+    LOG_IF(WARNING, SaveCacheIndex() < 0) << "save disk cache index error.";
+    cacheRead_->CloseSlab();
     LOG_IF(ERROR, !IsCacheClean()) << "umount disk cache error.";
     LOG(INFO) << "umount disk cache end.";
     return 0;
 }
 
+int DiskCacheManager::LoadAllCacheReadFile() {
+    auto cached = std::make_shared<SglLRUCache<std::string>>(0, nullptr);
+    int ret = cacheRead_->LoadAllCacheReadFile(cached);
+    if (ret < 0) {
+        return ret;
+    }
+
+    // the index is only a hint, a missing or stale one keeps the
+    // objects, just loses their order
+    std::string content;
+    int fd = posixWrapper_->open(CacheIndexPath().c_str(), O_RDONLY, 0644);
+    if (fd >= 0) {
+        char buf[64 * 1024];
+        ssize_t n;
+        while ((n = posixWrapper_->read(fd, buf, sizeof(buf))) > 0) {
+            content.append(buf, n);
+        }
+        posixWrapper_->close(fd);
+    }
+
+    std::vector<std::string> ordered;
+    std::istringstream in(content);
+    std::string name;
+    while (std::getline(in, name)) {
+        if (!name.empty() && cached->IsCached(name)) {
+            cached->Remove(name);
+            ordered.emplace_back(std::move(name));
+        }
+    }
+    while (cached->GetBack(&name)) {
+        cached->Remove(name);
+        cachedObjName_->Put(name);
+    }
+    for (const auto &obj : ordered) {
+        cachedObjName_->Put(obj);
+    }
+    LOG(INFO) << "load " << cachedObjName_->Size()
+              << " cached read files, " << ordered.size()
+              << " of them in the index";
+    return 0;
+}
+
+int DiskCacheManager::SaveCacheIndex() {
+    std::string content;
+    std::string name, before;
+    if (cachedObjName_->GetBack(&name)) {
+        content.append(name).append("\n");
+        while (cachedObjName_->GetBefore(name, &before)) {
+            content.append(before).append("\n");
+            name.swap(before);
+        }
+    }
+
+    std::string tmpPath = CacheIndexPath() + ".tmp";
+    int fd = posixWrapper_->open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+                                 0644);
+    if (fd < 0) {
+        LOG(ERROR) << "open disk cache index error. errno = " << errno
+                   << ", file = " << tmpPath;
+        return -1;
+    }
+    ssize_t writeLen = posixWrapper_->write(fd, content.data(),
+                                            content.size());
+    if (writeLen != static_cast<ssize_t>(content.size()) ||
+        posixWrapper_->fdatasync(fd) < 0) {
+        LOG(ERROR) << "write disk cache index error. errno = " << errno
+                   << ", file = " << tmpPath;
+        posixWrapper_->close(fd);
+        return -1;
+    }
+    posixWrapper_->close(fd);
+    if (posixWrapper_->rename(tmpPath.c_str(), CacheIndexPath().c_str()) < 0) {
+        LOG(ERROR) << "rename disk cache index error. errno = " << errno
+                   << ", file = " << tmpPath;
+        return -1;
+    }
+    return 0;
+}
+
 int DiskCacheManager::CreateDir() {
     struct stat statFile;
     int ret;
@@ -458,10 +554,27 @@ void DiskCacheManager::TrimCache() {
                     VLOG(1) << "do not remove this disk file"
                             << ", file has not been uploaded to S3."
                             << ", file is: " << cacheKey;
+                    // move it to the front, so trim goes on with the
+                    // next coldest one instead of waiting for the upload
+                    cachedObjName_->Put(cacheKey);
                     usleep(1000);
                     continue;
                 }
                 cachedObjName_->Remove(cacheKey);
+                if (cacheRead_->IsSlabLayout()) {
+                    int64_t length = cacheRead_->RemoveFromSlab(cacheKey);
+                    if (length < 0) {
+                        VLOG(0) << "obj not in slab, obj is: " << cacheKey;
+                        continue;
+                    }
+                    curve::client::CollectMetrics(
+                        &metric_->trim_, length,
+                        butil::cpuwide_time_us() - start);
+                    UpdateDiskUsedBytes(-length);
+                    VLOG(6) << "remove obj from slab success, obj is: "
+                            << cacheKey;
+                    continue;
+                }
                 struct stat statReadFile;
                 ret = posixWrapper_->stat(cacheReadFile.c_str(), &statReadFile);
                 if (ret != 0) {
@@ -125,6 +125,7 @@ class DiskCacheManager {
     FRIEND_TEST(TestDiskCacheManager, IsDiskCacheSafe_TrimRatio_Full);
     FRIEND_TEST(TestDiskCacheManager, IsDiskCacheSafe_TrimRatio_Nearfull);
     FRIEND_TEST(TestDiskCacheManager, IsDiskCacheSafe_TrimRatio_Ok);
+    FRIEND_TEST(TestDiskCacheManager, CacheIndex);
 
     /**
      * @brief get use ratio of cache disk
@@ -172,6 +173,23 @@ class DiskCacheManager {
      */
     bool IsCacheClean();
 
+    /**
+     * @brief load the cached read files into cachedObjName_, in the lru
+     *        order saved by the last umount, the files not in the index
+     *        are taken as the coldest.
+     */
+    int LoadAllCacheReadFile();
+
+    /**
+     * @brief save the lru order of cachedObjName_ to the index file,
+     *        the coldest first, one object per line.
+     */
+    int SaveCacheIndex();
+
+    std::string CacheIndexPath() const {
+        return cacheDir_ + "/cacheread.index";
+    }
+
     curve::common::Thread backEndThread_;
     curve::common::Atomic<bool> isRunning_;
     curve::common::InterruptibleSleeper sleeper_;
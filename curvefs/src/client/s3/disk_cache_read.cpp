@@ -29,6 +29,7 @@
 #include <memory>
 #include <utility>
 
+#include "absl/memory/memory.h"
 #include "curvefs/src/client/s3/disk_cache_read.h"
 #include "curvefs/src/common/s3util.h"
 
@@ -42,10 +43,38 @@ void DiskCacheRead::Init(std::shared_ptr<PosixWrapper> posixWrapper,
     DiskCacheBase::Init(posixWrapper, cacheDir, objectPrefix);
 }
 
+int DiskCacheRead::InitSlab(const std::string &dir, uint64_t slotSize,
+                            uint64_t capacity, bool directIO) {
+    slab_ = absl::make_unique<DiskCacheSlab>(posixWrapper_, dir, slotSize,
+                                             capacity, directIO);
+    int ret = slab_->Open();
+    if (ret < 0) {
+        LOG(ERROR) << "open slab read cache error, dir = " << dir;
+        slab_.reset();
+    }
+    return ret;
+}
+
+void DiskCacheRead::CloseSlab() {
+    if (slab_ != nullptr) {
+        LOG_IF(ERROR, slab_->Close() < 0) << "close slab read cache error";
+    }
+}
+
+int64_t DiskCacheRead::RemoveFromSlab(const std::string &name) {
+    if (slab_ == nullptr) {
+        return -1;
+    }
+    return slab_->Remove(name);
+}
+
 int DiskCacheRead::ReadDiskFile(const std::string name, char *buf,
                                 uint64_t offset, uint64_t length) {
     VLOG(6) << "ReadDiskFile start. name = " << name << ", offset = " << offset
             << ", length = " << length;
+    if (slab_ != nullptr) {
+        return slab_->Get(name, buf, offset, length);
+    }
     std::string fileFullPath;
     int fd;
     fileFullPath = GetCacheIoFullDir() + "/" + name;
@@ -95,6 +124,10 @@ int DiskCacheRead::LinkWriteToRead(const std::string fileName,
         return -1;
     }
 
+    if (slab_ != nullptr) {
+        return CopyWriteToSlab(fileName, fullWritePath);
+    }
+
     if (objectPrefix_ != 0) {
         ret = CreateDir(fullReadPath);
         if (ret < 0 && errno != EEXIST) {
@@ -116,8 +149,47 @@ int DiskCacheRead::LinkWriteToRead(const std::string fileName,
     return 0;
 }
 
+int DiskCacheRead::CopyWriteToSlab(const std::string &fileName,
+                                   const std::string &fullWritePath) {
+    int fd = posixWrapper_->open(fullWritePath.c_str(), O_RDONLY, MODE);
+    if (fd < 0) {
+        LOG(ERROR) << "open write cache file error. errno = " << errno
+                   << ", file = " << fullWritePath;
+        return -1;
+    }
+    struct stat statFile;
+    if (posixWrapper_->fstat(fd, &statFile) < 0) {
+        LOG(ERROR) << "stat write cache file error. errno = " << errno
+                   << ", file = " << fullWritePath;
+        posixWrapper_->close(fd);
+        return -1;
+    }
+    std::string buf(statFile.st_size, '\0');
+    ssize_t readLen = posixWrapper_->pread(fd, &buf[0], buf.size(), 0);
+    posixWrapper_->close(fd);
+    if (readLen != static_cast<ssize_t>(buf.size())) {
+        LOG(ERROR) << "read write cache file error. ret = " << readLen
+                   << ", file = " << fullWritePath;
+        return -1;
+    }
+    if (slab_->Put(fileName, buf.data(), buf.size()) < 0) {
+        LOG(ERROR) << "copy write cache file to slab error, file = "
+                   << fullWritePath;
+        return -1;
+    }
+    VLOG(6) << "CopyWriteToSlab success. name = " << fileName;
+    return 0;
+}
+
 int DiskCacheRead::LoadAllCacheReadFile(
     std::shared_ptr<SglLRUCache<std::string>> cachedObj) {
+    if (slab_ != nullptr) {
+        for (auto &name : slab_->ListObjects()) {
+            cachedObj->Put(std::move(name));
+        }
+        return 0;
+    }
+
     std::set<std::string> tmp;
     int ret = LoadAllCacheFile(&tmp);
     if (ret < 0) {
@@ -138,6 +210,9 @@ int DiskCacheRead::WriteDiskFile(const std::string fileName, const char *buf,
                                  uint64_t length) {
     VLOG(9) << "WriteDiskFile start. name = " << fileName
             << ", length = " << length;
+    if (slab_ != nullptr) {
+        return slab_->Put(fileName, buf, length);
+    }
     std::string fileFullPath;
     int fd, ret;
     fileFullPath = GetCacheIoFullDir() + "/" + fileName;
@@ -168,6 +243,14 @@ int DiskCacheRead::WriteDiskFile(const std::string fileName, const char *buf,
 
 int DiskCacheRead::ClearReadCache(const std::list<std::string> &files) {
     VLOG(1) << "ClearReadCache start";
+    if (slab_ != nullptr) {
+        for (const auto &name : files) {
+            slab_->Remove(name);
+        }
+        VLOG(1) << "ClearReadCache end, clear " << files.size()
+                << " read cache objs from slab";
+        return 0;
+    }
 
     std::string cachePath = GetCacheIoFullDir();
     if (!IsFileExist(cachePath)) {
@@ -33,6 +33,7 @@
 #include "src/common/lru_cache.h"
 #include "curvefs/src/common/wrap_posix.h"
 #include "curvefs/src/client/s3/disk_cache_base.h"
+#include "curvefs/src/client/s3/disk_cache_slab.h"
 
 namespace curvefs {
 namespace client {
@@ -65,9 +66,31 @@ class DiskCacheRead : public DiskCacheBase {
         metric_ = metric;
     }
 
+    /**
+     * @brief store the read cache in one slab file under dir instead of
+     *        one file per object, must be called before loading the cache.
+     * @return success: 0, fail : < 0
+     */
+    virtual int InitSlab(const std::string &dir, uint64_t slotSize,
+                         uint64_t capacity, bool directIO);
+    /**
+     * @brief save the index of the slab, and close it.
+     */
+    virtual void CloseSlab();
+    bool IsSlabLayout() const { return slab_ != nullptr; }
+    /**
+     * @brief remove obj from slab
+     * @return the length of the obj, < 0 if not exist
+     */
+    virtual int64_t RemoveFromSlab(const std::string &name);
+
  private:
+    int CopyWriteToSlab(const std::string &fileName,
+                        const std::string &fullWritePath);
+
     // file system operation encapsulation
     std::shared_ptr<PosixWrapper> posixWrapper_;
+    std::unique_ptr<DiskCacheSlab> slab_;
     std::shared_ptr<DiskCacheMetric> metric_;
 };
 
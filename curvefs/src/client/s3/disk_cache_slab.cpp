@@ -0,0 +1,396 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "curvefs/src/client/s3/disk_cache_slab.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <glog/logging.h>
+#include <linux/falloc.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <utility>
+
+namespace curvefs {
+namespace client {
+
+namespace {
+
+const char kIndexMagic[] = "curvefs_slab";
+
+uint64_t AlignUp(uint64_t value, uint64_t align) {
+    return (value + align - 1) / align * align;
+}
+
+uint64_t AlignDown(uint64_t value, uint64_t align) {
+    return value / align * align;
+}
+
+struct AlignedBuffer {
+    explicit AlignedBuffer(uint64_t size) : data(nullptr) {
+        if (posix_memalign(reinterpret_cast<void **>(&data),
+                           DiskCacheSlab::kAlignSize, size) != 0) {
+            data = nullptr;
+        }
+    }
+    ~AlignedBuffer() { free(data); }
+
+    char *data;
+};
+
+}  // namespace
+
+DiskCacheSlab::DiskCacheSlab(std::shared_ptr<PosixWrapper> posixWrapper,
+                             const std::string &dir, uint64_t slotSize,
+                             uint64_t capacity, bool directIO)
+    : posixWrapper_(std::move(posixWrapper)),
+      dir_(dir),
+      slotSize_(AlignUp(std::max<uint64_t>(slotSize, 1), kAlignSize)),
+      slotNum_(std::max<uint64_t>(capacity / slotSize_, 1)),
+      directIO_(directIO),
+      fd_(-1) {}
+
+DiskCacheSlab::~DiskCacheSlab() {
+    if (fd_ >= 0) {
+        posixWrapper_->close(fd_);
+    }
+}
+
+int DiskCacheSlab::Open() {
+    struct stat statFile;
+    if (posixWrapper_->stat(dir_.c_str(), &statFile) < 0) {
+        int ret = posixWrapper_->mkdir(dir_.c_str(), 0755);
+        if (ret < 0 && errno != EEXIST) {
+            LOG(ERROR) << "create slab dir error. errno = " << errno
+                       << ", dir = " << dir_;
+            return -1;
+        }
+    }
+
+    int flags = O_RDWR | O_CREAT;
+    fd_ = posixWrapper_->open(SlabPath().c_str(),
+                              directIO_ ? flags | O_DIRECT : flags, 0644);
+    if (fd_ < 0 && directIO_ && errno == EINVAL) {
+        LOG(WARNING) << "slab file does not support direct io, use buffered "
+                     << "io, file = " << SlabPath();
+        directIO_ = false;
+        fd_ = posixWrapper_->open(SlabPath().c_str(), flags, 0644);
+    }
+    if (fd_ < 0) {
+        LOG(ERROR) << "open slab file error. errno = " << errno
+                   << ", file = " << SlabPath();
+        return -1;
+    }
+
+    slotSeqs_.assign(slotNum_, 0);
+    if (LoadIndex() < 0) {
+        // the objects of an unclean shutdown are not known, drop them
+        objects_.clear();
+        int ret = posixWrapper_->fallocate(
+            fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, 0,
+            slotNum_ * slotSize_);
+        LOG_IF(WARNING, ret < 0)
+            << "punch slab file error. errno = " << errno
+            << ", file = " << SlabPath();
+    }
+    // an index removed here is not valid after a crash
+    posixWrapper_->remove(IndexPath().c_str());
+
+    std::vector<bool> used(slotNum_, false);
+    for (const auto &obj : objects_) {
+        used[obj.second.index] = true;
+    }
+    freeSlots_.clear();
+    for (uint64_t i = slotNum_; i > 0; i--) {
+        if (!used[i - 1]) {
+            freeSlots_.push_back(i - 1);
+        }
+    }
+
+    LOG(INFO) << "open slab success, file = " << SlabPath()
+              << ", slot size = " << slotSize_ << ", slot num = " << slotNum_
+              << ", objects = " << objects_.size()
+              << ", direct io = " << directIO_;
+    return 0;
+}
+
+int DiskCacheSlab::Close() {
+    if (fd_ < 0) {
+        return 0;
+    }
+    int ret = SaveIndex();
+    posixWrapper_->close(fd_);
+    fd_ = -1;
+    return ret;
+}
+
+int DiskCacheSlab::LoadIndex() {
+    int fd = posixWrapper_->open(IndexPath().c_str(), O_RDONLY, 0644);
+    if (fd < 0) {
+        LOG(INFO) << "slab index not exist, file = " << IndexPath();
+        return -1;
+    }
+    struct stat statFile;
+    if (posixWrapper_->fstat(fd, &statFile) < 0) {
+        posixWrapper_->close(fd);
+        return -1;
+    }
+    std::string content(statFile.st_size, '\0');
+    ssize_t readLen = posixWrapper_->read(fd, &content[0], content.size());
+    posixWrapper_->close(fd);
+    if (readLen != static_cast<ssize_t>(content.size())) {
+        LOG(WARNING) << "read slab index error, file = " << IndexPath();
+        return -1;
+    }
+
+    std::istringstream in(content);
+    std::string magic;
+    uint64_t slotSize = 0;
+    uint64_t slotNum = 0;
+    if (!(in >> magic >> slotSize >> slotNum) || magic != kIndexMagic ||
+        slotSize != slotSize_ || slotNum != slotNum_) {
+        LOG(WARNING) << "slab index does not match, slot size = " << slotSize
+                     << ", slot num = " << slotNum;
+        return -1;
+    }
+
+    std::vector<bool> used(slotNum_, false);
+    std::string name;
+    Slot slot{0, 0, 0};
+    while (in >> name >> slot.index >> slot.length) {
+        if (slot.index >= slotNum_ || slot.length > slotSize_ ||
+            used[slot.index]) {
+            LOG(WARNING) << "invalid slab index entry, name = " << name
+                         << ", slot = " << slot.index;
+            return -1;
+        }
+        used[slot.index] = true;
+        objects_[name] = slot;
+    }
+    if (!in.eof()) {
+        LOG(WARNING) << "slab index is truncated, file = " << IndexPath();
+        return -1;
+    }
+    return 0;
+}
+
+int DiskCacheSlab::SaveIndex() {
+    std::ostringstream out;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        out << kIndexMagic << " " << slotSize_ << " " << slotNum_ << "\n";
+        for (const auto &obj : objects_) {
+            out << obj.first << " " << obj.second.index << " "
+                << obj.second.length << "\n";
+        }
+    }
+    std::string content = out.str();
+
+    std::string tmpPath = IndexPath() + ".tmp";
+    int fd = posixWrapper_->open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+                                 0644);
+    if (fd < 0) {
+        LOG(ERROR) << "open slab index error. errno = " << errno
+                   << ", file = " << tmpPath;
+        return -1;
+    }
+    ssize_t writeLen = posixWrapper_->write(fd, content.data(),
+                                            content.size());
+    if (writeLen != static_cast<ssize_t>(content.size()) ||
+        posixWrapper_->fdatasync(fd) < 0) {
+        LOG(ERROR) << "write slab index error. errno = " << errno
+                   << ", file = " << tmpPath;
+        posixWrapper_->close(fd);
+        return -1;
+    }
+    posixWrapper_->close(fd);
+    if (posixWrapper_->rename(tmpPath.c_str(), IndexPath().c_str()) < 0) {
+        LOG(ERROR) << "rename slab index error. errno = " << errno
+                   << ", file = " << tmpPath;
+        return -1;
+    }
+    return 0;
+}
+
+bool DiskCacheSlab::AllocateSlot(uint64_t *index, uint64_t *seq) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (freeSlots_.empty()) {
+        return false;
+    }
+    *index = freeSlots_.back();
+    freeSlots_.pop_back();
+    *seq = ++slotSeqs_[*index];
+    return true;
+}
+
+void DiskCacheSlab::ReleaseSlot(uint64_t index) {
+    int ret = posixWrapper_->fallocate(
+        fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, index * slotSize_,
+        slotSize_);
+    LOG_IF(WARNING, ret < 0) << "punch slab slot error. errno = " << errno
+                             << ", slot = " << index;
+    std::lock_guard<std::mutex> lk(mtx_);
+    freeSlots_.push_back(index);
+}
+
+int DiskCacheSlab::Put(const std::string &name, const char *buf,
+                       uint64_t length) {
+    if (length > slotSize_) {
+        LOG(ERROR) << "object is larger than slab slot, name = " << name
+                   << ", length = " << length << ", slot size = " << slotSize_;
+        return -1;
+    }
+    uint64_t index = 0;
+    uint64_t seq = 0;
+    if (!AllocateSlot(&index, &seq)) {
+        VLOG(6) << "no free slab slot, name = " << name;
+        return -1;
+    }
+
+    ssize_t writeLen = 0;
+    if (directIO_) {
+        uint64_t alignedLen = AlignUp(length, kAlignSize);
+        AlignedBuffer aligned(alignedLen);
+        if (aligned.data == nullptr) {
+            ReleaseSlot(index);
+            return -1;
+        }
+        memcpy(aligned.data, buf, length);
+        memset(aligned.data + length, 0, alignedLen - length);
+        writeLen = posixWrapper_->pwrite(fd_, aligned.data, alignedLen,
+                                         index * slotSize_);
+    } else {
+        writeLen = posixWrapper_->pwrite(fd_, buf, length, index * slotSize_);
+    }
+    if (writeLen < static_cast<ssize_t>(length)) {
+        LOG(ERROR) << "write slab slot error. ret = " << writeLen
+                   << ", errno = " << errno << ", name = " << name;
+        ReleaseSlot(index);
+        return -1;
+    }
+
+    bool replaced = false;
+    uint64_t oldIndex = 0;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        auto iter = objects_.find(name);
+        if (iter != objects_.end()) {
+            replaced = true;
+            oldIndex = iter->second.index;
+        }
+        objects_[name] = Slot{index, length, seq};
+    }
+    if (replaced) {
+        ReleaseSlot(oldIndex);
+    }
+    return static_cast<int>(length);
+}
+
+int DiskCacheSlab::Get(const std::string &name, char *buf, uint64_t offset,
+                       uint64_t length) {
+    Slot slot{0, 0, 0};
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        auto iter = objects_.find(name);
+        if (iter == objects_.end()) {
+            VLOG(9) << "object not in slab, name = " << name;
+            return -1;
+        }
+        slot = iter->second;
+    }
+    if (offset + length > slot.length) {
+        LOG(ERROR) << "read slab object out of range, name = " << name
+                   << ", offset = " << offset << ", length = " << length
+                   << ", object length = " << slot.length;
+        return -1;
+    }
+
+    uint64_t slotOffset = slot.index * slotSize_;
+    ssize_t readLen = 0;
+    if (directIO_) {
+        uint64_t start = AlignDown(offset, kAlignSize);
+        uint64_t end = AlignUp(offset + length, kAlignSize);
+        AlignedBuffer aligned(end - start);
+        if (aligned.data == nullptr) {
+            return -1;
+        }
+        readLen = posixWrapper_->pread(fd_, aligned.data, end - start,
+                                       slotOffset + start);
+        if (readLen >= static_cast<ssize_t>(offset + length - start)) {
+            memcpy(buf, aligned.data + (offset - start), length);
+            readLen = length;
+        }
+    } else {
+        readLen = posixWrapper_->pread(fd_, buf, length, slotOffset + offset);
+    }
+    if (readLen < static_cast<ssize_t>(length)) {
+        LOG(ERROR) << "read slab slot error. ret = " << readLen
+                   << ", errno = " << errno << ", name = " << name;
+        return -1;
+    }
+
+    // the slot may be released and reused while reading
+    std::lock_guard<std::mutex> lk(mtx_);
+    auto iter = objects_.find(name);
+    if (iter == objects_.end() || iter->second.index != slot.index ||
+        iter->second.seq != slot.seq) {
+        VLOG(6) << "slab object is changed while reading, name = " << name;
+        return -1;
+    }
+    return static_cast<int>(length);
+}
+
+int64_t DiskCacheSlab::Remove(const std::string &name) {
+    Slot slot{0, 0, 0};
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        auto iter = objects_.find(name);
+        if (iter == objects_.end()) {
+            return -1;
+        }
+        slot = iter->second;
+        objects_.erase(iter);
+    }
+    ReleaseSlot(slot.index);
+    return slot.length;
+}
+
+bool DiskCacheSlab::Exist(const std::string &name) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return objects_.find(name) != objects_.end();
+}
+
+std::vector<std::string> DiskCacheSlab::ListObjects() {
+    std::lock_guard<std::mutex> lk(mtx_);
+    std::vector<std::string> names;
+    names.reserve(objects_.size());
+    for (const auto &obj : objects_) {
+        names.push_back(obj.first);
+    }
+    return names;
+}
+
+size_t DiskCacheSlab::Size() {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return objects_.size();
+}
+
+}  // namespace client
+}  // namespace curvefs
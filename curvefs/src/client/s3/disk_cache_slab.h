@@ -0,0 +1,145 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef CURVEFS_SRC_CLIENT_S3_DISK_CACHE_SLAB_H_
+#define CURVEFS_SRC_CLIENT_S3_DISK_CACHE_SLAB_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "curvefs/src/common/wrap_posix.h"
+
+namespace curvefs {
+namespace client {
+
+using curvefs::common::PosixWrapper;
+
+/**
+ * The read cache objects stored in one large file instead of one file per
+ * object, which saves the inode, dentry and directory lookups of millions
+ * of small files.
+ *
+ * The file is divided into fixed size slots, an object takes one slot.
+ * The object name -> slot index is kept in memory, and saved to the index
+ * file when closed, so a clean restart loads it without scanning the
+ * cache directory. The index file is removed when opened, so after a crash
+ * the slab starts empty, which only costs the cached data.
+ *
+ * The slab file is sparse, the slot of a removed object is punched, so
+ * usage of the cache disk (statfs and du) is the same as with one file
+ * per object, and the trim thread works unchanged.
+ */
+class DiskCacheSlab {
+ public:
+    /**
+     * @param dir directory of the slab file and the index file
+     * @param slotSize max object size, rounded up to kAlignSize
+     * @param capacity max bytes of the slab file
+     * @param directIO read and write the slab file with O_DIRECT
+     */
+    DiskCacheSlab(std::shared_ptr<PosixWrapper> posixWrapper,
+                  const std::string &dir, uint64_t slotSize,
+                  uint64_t capacity, bool directIO);
+
+    ~DiskCacheSlab();
+
+    /**
+     * @brief open the slab file and load the index saved by Close()
+     * @return success: 0, fail : < 0
+     */
+    int Open();
+
+    /**
+     * @brief save the index and close the slab file
+     * @return success: 0, fail : < 0
+     */
+    int Close();
+
+    /**
+     * @brief store an object, replace the old one of the same name
+     * @return success: length, fail : < 0
+     */
+    int Put(const std::string &name, const char *buf, uint64_t length);
+
+    /**
+     * @brief read [offset, offset + length) of an object
+     * @return success: length, fail : < 0
+     */
+    int Get(const std::string &name, char *buf, uint64_t offset,
+            uint64_t length);
+
+    /**
+     * @brief remove an object and release its slot
+     * @return the length of the object, -1 if not exist
+     */
+    int64_t Remove(const std::string &name);
+
+    bool Exist(const std::string &name);
+
+    std::vector<std::string> ListObjects();
+
+    uint64_t GetSlotSize() const { return slotSize_; }
+
+    uint64_t GetSlotNum() const { return slotNum_; }
+
+    size_t Size();
+
+    static constexpr uint64_t kAlignSize = 4096;
+
+ private:
+    struct Slot {
+        uint64_t index;
+        uint64_t length;
+        // the sequence of the slot when it's allocated, to detect the
+        // slot being reused while reading it
+        uint64_t seq;
+    };
+
+    bool AllocateSlot(uint64_t *index, uint64_t *seq);
+
+    // punch the slot and put it back to the free list
+    void ReleaseSlot(uint64_t index);
+
+    int LoadIndex();
+
+    int SaveIndex();
+
+    std::string SlabPath() const { return dir_ + "/slab"; }
+
+    std::string IndexPath() const { return dir_ + "/slab.index"; }
+
+ private:
+    std::shared_ptr<PosixWrapper> posixWrapper_;
+    const std::string dir_;
+    const uint64_t slotSize_;
+    const uint64_t slotNum_;
+    bool directIO_;
+    int fd_;
+
+    std::mutex mtx_;
+    std::unordered_map<std::string, Slot> objects_;
+    std::vector<uint64_t> freeSlots_;
+    std::vector<uint64_t> slotSeqs_;
+};
+
+}  // namespace client
+}  // namespace curvefs
+
+#endif  // CURVEFS_SRC_CLIENT_S3_DISK_CACHE_SLAB_H_
@@ -28,6 +28,7 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <unordered_set>
 #include <vector>
 
 #include "curvefs/src/common/s3util.h"
@@ -37,6 +38,17 @@ namespace curvefs {
 
 namespace client {
 
+/**
+ * use curl -L mdsIp:port/flags/diskCacheUploadMaxInflight?setvalue=true
+ * for dynamic parameter configuration
+ */
+static bool pass_uint32(const char *, uint32_t) { return true; }
+DEFINE_uint32(diskCacheUploadMaxInflight, 128,
+              "max files of the write cache being uploaded to s3 by the "
+              "async upload thread, 0 means no limit, the files flushed "
+              "by inode are not limited");
+DEFINE_validator(diskCacheUploadMaxInflight, &pass_uint32);
+
 void DiskCacheWrite::Init(std::shared_ptr<S3Client> client,
                           std::shared_ptr<PosixWrapper> posixWrapper,
                           const std::string cacheDir,
@@ -138,6 +150,7 @@ int DiskCacheWrite::UploadFile(const std::string &name,
         return -1;
     }
     VLOG(9) << "async upload start, file = " << name;
+    OnUploadStart(name);
     PutObjectAsyncCallBack cb =
         [&, buffer, syncTask,
          name](const std::shared_ptr<PutObjectAsyncContext>& context) {
@@ -154,6 +167,7 @@ int DiskCacheWrite::UploadFile(const std::string &name,
                 VLOG(9) << " PutObjectAsyncCallBack success, "
                         << "remove file: " << context->key;
                 posixWrapper_->free(buffer);
+                OnUploadFinish(name);
                 if (syncTask) {
                     VLOG(9) << "UploadFile, name = "
                             << name << " signal start";
@@ -185,14 +199,38 @@ bool DiskCacheWrite::WriteCacheValid() {
     return IsFileExist(GetCacheIoFullDir());
 }
 
+void DiskCacheWrite::OnUploadStart(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    uploadingFiles_.insert(name);
+}
+
+void DiskCacheWrite::OnUploadFinish(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto iter = uploadingFiles_.find(name);
+    if (iter != uploadingFiles_.end()) {
+        uploadingFiles_.erase(iter);
+    }
+    if (waitUpload_.empty() && uploadingFiles_.empty()) {
+        cond_.notify_all();
+    }
+}
+
 int DiskCacheWrite::GetUploadFile(const std::string &inode,
-                                  std::list<std::string> *toUpload) {
+                                  std::list<std::string> *toUpload,
+                                  uint64_t maxNum) {
     std::unique_lock<std::mutex> lock(mtx_);
     if (waitUpload_.empty()) {
         return 0;
     }
     if (inode.empty()) {
-        toUpload->swap(waitUpload_);
+        if (maxNum == 0 || waitUpload_.size() <= maxNum) {
+            toUpload->swap(waitUpload_);
+        } else {
+            auto end = waitUpload_.begin();
+            std::advance(end, maxNum);
+            toUpload->splice(toUpload->end(), waitUpload_,
+                             waitUpload_.begin(), end);
+        }
         return toUpload->size();
     }
     waitUpload_.remove_if([&](const std::string &filename) {
@@ -208,23 +246,14 @@ int DiskCacheWrite::GetUploadFile(const std::string &inode,
 }
 
 int DiskCacheWrite::FileExist(const std::string &inode) {
-    // load all write cache
-    std::set<std::string> cachedObj;
-    int ret = LoadAllCacheFile(&cachedObj);
-    if (ret < 0) {
-        LOG(ERROR) << "DiskCacheWrite, load all cached file fail ret = "
-                   << ret;
-        return ret;
-    }
-
-    for (auto iter = cachedObj.begin(); iter != cachedObj.end(); iter++) {
-        bool exist = curvefs::common::s3util::ValidNameOfInode(
-                        inode, *iter, objectPrefix_);
-        if (exist) {
+    // the files not queued are being uploaded, no need to scan the dir
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (const auto &name : uploadingFiles_) {
+        if (curvefs::common::s3util::ValidNameOfInode(inode, name,
+                                                      objectPrefix_)) {
             return 1;
         }
     }
-
     return 0;
 }
 
@@ -285,10 +314,18 @@ int DiskCacheWrite::AsyncUploadFunc() {
             return 0;
         }
         toUpload.clear();
-        int num = GetUploadFile("", &toUpload);
+        uint64_t maxNum = 0;
+        if (FLAGS_diskCacheUploadMaxInflight > 0) {
+            std::unique_lock<std::mutex> lock(mtx_);
+            if (uploadingFiles_.size() >= FLAGS_diskCacheUploadMaxInflight) {
+                continue;
+            }
+            maxNum = FLAGS_diskCacheUploadMaxInflight - uploadingFiles_.size();
+        }
+        int num = GetUploadFile("", &toUpload, maxNum);
         if (num <= 0) {
             std::unique_lock<std::mutex> lock(mtx_);
-            if (waitUpload_.empty()) {
+            if (waitUpload_.empty() && uploadingFiles_.empty()) {
                 cond_.notify_all();
             }
             continue;
@@ -318,7 +355,7 @@ int DiskCacheWrite::AsyncUploadRun() {
 int DiskCacheWrite::AsyncUploadStop() {
     if (isRunning_.load()) {
         std::unique_lock<std::mutex> lock(mtx_);
-        while (!waitUpload_.empty()) {
+        while (!waitUpload_.empty() || !uploadingFiles_.empty()) {
             cond_.wait_for(lock, std::chrono::milliseconds(asyncLoadPeriodMs_));
         }
     }
@@ -337,7 +374,6 @@ int DiskCacheWrite::UploadAllCacheWriteFile() {
     VLOG(3) << "upload all cached write file start.";
     std::string fileFullPath;
     bool ret;
-    int doRet;
     fileFullPath = GetCacheIoFullDir();
     ret = IsFileExist(fileFullPath);
     if (!ret) {
@@ -385,54 +421,24 @@ int DiskCacheWrite::UploadAllCacheWriteFile() {
     if (uploadObjs.empty()) {
         return 0;
     }
-    curve::common::CountDownEvent cond(1);
-    std::atomic<uint64_t> pendingReq(0);
-    pendingReq.fetch_add(uploadObjs.size(), std::memory_order_seq_cst);
-    for (auto iter = uploadObjs.begin(); iter != uploadObjs.end(); iter++) {
-        uint64_t fileSize;
-        char *buffer = nullptr;
-        doRet = ReadFile(*iter, &buffer, &fileSize);
-        if (doRet < 0 || buffer == nullptr) {
-            if (buffer != nullptr)
-                posixWrapper_->free(buffer);
-            LOG(WARNING) << "read failed, file name is: " << *iter;
-            pendingReq.fetch_sub(1, std::memory_order_seq_cst);
-            continue;
+    // queue the files to the async upload thread, which limits the files
+    // being uploaded and removes each file once it's uploaded, the files
+    // of an inode flushed are uploaded first by UploadFileByInode()
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        std::unordered_set<std::string> queued(waitUpload_.begin(),
+                                               waitUpload_.end());
+        for (const auto &obj : uploadObjs) {
+            std::string name =
+                curvefs::common::s3util::GenPathByObjName(obj, objectPrefix_);
+            if (queued.count(name) == 0 && uploadingFiles_.count(name) == 0) {
+                queued.insert(name);
+                waitUpload_.push_back(std::move(name));
+            }
         }
-        PutObjectAsyncCallBack cb =
-            [&, buffer](const std::shared_ptr<PutObjectAsyncContext>& context) {
-                if (context->retCode >= 0) {
-                    if (s3Metric_ != nullptr) {
-                        curve::client::CollectMetrics(
-                            &metric_->writeS3, context->bufferSize,
-                            context->timer.u_elapsed());
-                        metric::AsyncContextCollectMetrics(s3Metric_, context);
-                    }
-                    if (pendingReq.fetch_sub(1, std::memory_order_seq_cst) ==
-                        1) {
-                        VLOG(3) << "pendingReq is over";
-                        cond.Signal();
-                    }
-                    VLOG(3) << "PutObjectAsyncCallBack success"
-                            << ", file: " << context->key;
-                    posixWrapper_->free(buffer);
-                    return;
-                }
-                LOG(WARNING) << "upload object failed: " << context->key;
-                client_->UploadAsync(context);
-            };
-        auto context = std::make_shared<PutObjectAsyncContext>(
-            curvefs::common::s3util::GenPathByObjName(*iter, objectPrefix_),
-            buffer, fileSize, cb, curve::common::ContextType::S3);
-        client_->UploadAsync(context);
-    }
-    if (pendingReq.load(std::memory_order_seq_cst)) {
-        VLOG(9) << "wait for pendingReq";
-        cond.Wait();
-    }
-    for (auto iter = uploadObjs.begin(); iter != uploadObjs.end(); iter++) {
-        RemoveFile(*iter);
     }
+    LOG(INFO) << "queue " << uploadObjs.size()
+              << " cached write files to upload";
     VLOG(3) << "upload all cached write file end.";
     return 0;
 }
@@ -96,7 +96,8 @@ class DiskCacheWrite : public DiskCacheBase {
                               const char* buf, uint64_t length,
                               bool force = true);
     /**
-    * @brief after reboot，upload all files store in write cache to s3
+    * @brief after reboot，queue all files store in write cache to upload
+    *        to s3 by the async upload thread, without waiting them.
     */
     virtual int UploadAllCacheWriteFile();
     /**
@@ -148,13 +149,23 @@ class DiskCacheWrite : public DiskCacheBase {
     void UploadFile(const std::list<std::string> &toUpload,
                     std::shared_ptr<SynchronizationTask> syncTask = nullptr);
     bool WriteCacheValid();
+    /**
+     * @brief take the files to upload from the queue
+     * @param[in] inode take the files of this inode, all files if empty
+     * @param[in] maxNum take at most maxNum files, 0 means no limit
+     */
     int GetUploadFile(const std::string &inode,
-                      std::list<std::string> *toUpload);
+                      std::list<std::string> *toUpload, uint64_t maxNum = 0);
+    // whether files of the inode are being uploaded
     int FileExist(const std::string &inode);
+    void OnUploadStart(const std::string &name);
+    void OnUploadFinish(const std::string &name);
 
     curve::common::Thread backEndThread_;
     curve::common::Atomic<bool> isRunning_;
     std::list<std::string> waitUpload_;
+    // files being uploaded
+    std::multiset<std::string> uploadingFiles_;
     std::mutex mtx_;
     std::condition_variable cond_;
     InterruptibleSleeper sleeper_;
@@ -0,0 +1,75 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "curvefs/src/client/s3/inflight_reads.h"
+
+#include <cstring>
+
+namespace curvefs {
+namespace client {
+
+int InflightReads::Read(const std::string &name, uint64_t offset,
+                        uint64_t length, char *buf, const Fetcher &fetcher,
+                        bool *shared) {
+    std::unique_lock<std::mutex> lk(mtx_);
+    auto range = flights_.equal_range(name);
+    for (auto it = range.first; it != range.second; ++it) {
+        std::shared_ptr<Flight> flight = it->second;
+        if (offset < flight->offset ||
+            offset + length > flight->offset + flight->length) {
+            continue;
+        }
+
+        // join the read covering this range
+        flight->joiners++;
+        flight->cond.wait(lk, [&flight]() { return flight->done; });
+        int ret = flight->ret;
+        if (ret >= 0) {
+            memcpy(buf, flight->buf + (offset - flight->offset), length);
+        }
+        if (--flight->joiners == 0) {
+            flight->cond.notify_all();
+        }
+        if (shared != nullptr) {
+            *shared = true;
+        }
+        return ret;
+    }
+
+    auto flight = std::make_shared<Flight>();
+    flight->offset = offset;
+    flight->length = length;
+    flight->buf = buf;
+    auto self = flights_.emplace(name, flight);
+    lk.unlock();
+
+    int ret = fetcher(buf, offset, length);
+
+    lk.lock();
+    flights_.erase(self);
+    flight->ret = ret;
+    flight->done = true;
+    flight->cond.notify_all();
+    // the joiners copy from buf, which is released after return
+    flight->cond.wait(lk, [&flight]() { return flight->joiners == 0; });
+    if (shared != nullptr) {
+        *shared = false;
+    }
+    return ret;
+}
+
+}  // namespace client
+}  // namespace curvefs
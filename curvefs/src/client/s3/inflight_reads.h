@@ -0,0 +1,80 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef CURVEFS_SRC_CLIENT_S3_INFLIGHT_READS_H_
+#define CURVEFS_SRC_CLIENT_S3_INFLIGHT_READS_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace curvefs {
+namespace client {
+
+/**
+ * The object ranges being read from s3, so that concurrent readers of the
+ * same range share one GET instead of downloading it again.
+ *
+ * A reader whose range is covered by a read in flight waits for it and
+ * copies its part, others send their own read. The data is read into the
+ * buffer of the first reader, which waits for the others to copy before
+ * it returns, so sharing costs no extra buffer.
+ */
+class InflightReads {
+ public:
+    // read [offset, offset + length) of the object into buf, < 0 on error
+    using Fetcher =
+        std::function<int(char *buf, uint64_t offset, uint64_t length)>;
+
+    /**
+     * @param[out] shared whether the data is copied from a read of another
+     *             reader, may be nullptr
+     *
+     * @return the return code of the fetcher
+     */
+    int Read(const std::string &name, uint64_t offset, uint64_t length,
+             char *buf, const Fetcher &fetcher, bool *shared = nullptr);
+
+    size_t Size() {
+        std::lock_guard<std::mutex> lk(mtx_);
+        return flights_.size();
+    }
+
+ private:
+    struct Flight {
+        uint64_t offset;
+        uint64_t length;
+        char *buf;
+        int ret = 0;
+        bool done = false;
+        // readers waiting for this read or copying from it
+        uint32_t joiners = 0;
+        std::condition_variable cond;
+    };
+
+ private:
+    std::mutex mtx_;
+    std::multimap<std::string, std::shared_ptr<Flight>> flights_;
+};
+
+}  // namespace client
+}  // namespace curvefs
+
+#endif  // CURVEFS_SRC_CLIENT_S3_INFLIGHT_READS_H_
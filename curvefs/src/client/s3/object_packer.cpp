@@ -0,0 +1,99 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "curvefs/src/client/s3/object_packer.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace curvefs {
+namespace client {
+
+ObjectPacker::ObjectPacker(uint64_t maxSize, uint32_t maxSlices,
+                           uint32_t maxDelayMs, uint32_t retryIntervalMs,
+                           AllocFunc alloc, UploadFunc upload)
+    : maxSize_(maxSize),
+      maxSlices_(std::max(maxSlices, 1u)),
+      maxDelay_(maxDelayMs),
+      retryIntervalMs_(retryIntervalMs),
+      alloc_(std::move(alloc)),
+      upload_(std::move(upload)) {}
+
+bool ObjectPacker::Pack(const char* data, uint64_t len, Slice* slice) {
+    std::unique_lock<std::mutex> lk(mtx_);
+    if (open_ == nullptr) {
+        open_ = std::make_shared<OpenPack>();
+        open_->deadline = std::chrono::steady_clock::now() + maxDelay_;
+    }
+    std::shared_ptr<OpenPack> pack = open_;
+    slice->offset = pack->buf.size();
+    slice->index = pack->count++;
+    pack->buf.append(data, len);
+
+    bool seal = pack->buf.size() >= maxSize_ || pack->count >= maxSlices_;
+    if (!seal) {
+        // wait for others to fill the pack up, seal it on timeout
+        seal = !cond_.wait_until(lk, pack->deadline,
+                                 [&]() { return pack->sealed; });
+    }
+
+    if (seal) {
+        pack->sealed = true;
+        open_.reset();
+        // wake the ones waiting on the deadline
+        cond_.notify_all();
+        lk.unlock();
+        // no one appends to a sealed pack, it's safe to read it unlocked
+        uint64_t packId = 0;
+        bool ok = Upload(*pack, &packId);
+        lk.lock();
+        pack->packId = packId;
+        pack->ok = ok;
+        pack->done = true;
+        cond_.notify_all();
+    } else {
+        cond_.wait(lk, [&]() { return pack->done; });
+    }
+
+    if (!pack->ok) {
+        return false;
+    }
+    slice->packId = pack->packId;
+    slice->count = pack->count;
+    return true;
+}
+
+bool ObjectPacker::Upload(const OpenPack& pack, uint64_t* packId) {
+    if (!alloc_(packId)) {
+        LOG(ERROR) << "alloc pack id failed, slices: " << pack.count;
+        return false;
+    }
+    while (upload_(*packId, pack.buf.data(), pack.buf.size()) != 0) {
+        LOG(WARNING) << "upload pack " << *packId << " failed, size: "
+                     << pack.buf.size() << ", retry later";
+        std::this_thread::sleep_for(
+            std::chrono::milliseconds(retryIntervalMs_));
+    }
+    VLOG(9) << "upload pack " << *packId << " ok, size: " << pack.buf.size()
+            << ", slices: " << pack.count;
+    return true;
+}
+
+}  // namespace client
+}  // namespace curvefs
@@ -0,0 +1,107 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef CURVEFS_SRC_CLIENT_S3_OBJECT_PACKER_H_
+#define CURVEFS_SRC_CLIENT_S3_OBJECT_PACKER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace curvefs {
+namespace client {
+
+/**
+ * Packs the small slices flushed concurrently, maybe of different inodes,
+ * into one s3 object, so that they take one put instead of one per slice.
+ *
+ * A flush appends its slice to the open pack and waits, the pack is sealed
+ * and uploaded by the flush filling it up, or by the first one waiting
+ * longer than the delay. So a pack holds at most the slices flushed at the
+ * same time, the aggregation is bounded by the flush concurrency.
+ *
+ * Every slice knows its index and the number of slices in its pack, the
+ * pack is deleted once all of them are released, see ReleasePackSlice() of
+ * metaserver.
+ */
+class ObjectPacker {
+ public:
+    struct Slice {
+        uint64_t packId = 0;
+        // the slice's begin in the pack
+        uint64_t offset = 0;
+        uint32_t index = 0;
+        // slices in the pack
+        uint32_t count = 0;
+    };
+
+    // allocate the id of a pack, false on failure
+    using AllocFunc = std::function<bool(uint64_t* packId)>;
+    // put the pack, 0 on success
+    using UploadFunc = std::function<int(uint64_t packId, const char* buf,
+                                         uint64_t len)>;
+
+    /**
+     * @param maxSize seal the pack once it reaches this bytes
+     * @param maxSlices seal the pack once it holds this slices
+     * @param maxDelayMs the longest a slice waits for others to join
+     * @param retryIntervalMs the interval of retrying a failed upload
+     */
+    ObjectPacker(uint64_t maxSize, uint32_t maxSlices, uint32_t maxDelayMs,
+                 uint32_t retryIntervalMs, AllocFunc alloc,
+                 UploadFunc upload);
+
+    /**
+     * @brief put the slice into a pack, return after the pack is uploaded
+     * @return false if the pack failed, nothing is kept of the slice then
+     */
+    bool Pack(const char* data, uint64_t len, Slice* slice);
+
+ private:
+    struct OpenPack {
+        std::string buf;
+        uint32_t count = 0;
+        std::chrono::steady_clock::time_point deadline;
+        bool sealed = false;
+        bool done = false;
+        bool ok = false;
+        uint64_t packId = 0;
+    };
+
+    // allocate the id and upload, retry the upload until it succeeds
+    bool Upload(const OpenPack& pack, uint64_t* packId);
+
+ private:
+    const uint64_t maxSize_;
+    const uint32_t maxSlices_;
+    const std::chrono::milliseconds maxDelay_;
+    const uint32_t retryIntervalMs_;
+    AllocFunc alloc_;
+    UploadFunc upload_;
+
+    std::mutex mtx_;
+    std::condition_variable cond_;
+    std::shared_ptr<OpenPack> open_;
+};
+
+}  // namespace client
+}  // namespace curvefs
+
+#endif  // CURVEFS_SRC_CLIENT_S3_OBJECT_PACKER_H_
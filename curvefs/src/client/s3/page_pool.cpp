@@ -0,0 +1,96 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "curvefs/src/client/s3/page_pool.h"
+
+#include <glog/logging.h>
+
+namespace curvefs {
+namespace client {
+
+PagePool::PagePool(uint32_t pageSize, uint64_t maxFreeByte)
+    : pageSize_(pageSize),
+      maxFreeNum_(pageSize == 0 ? 0 : maxFreeByte / pageSize),
+      inUseByte_(0),
+      allocatedByte_(0) {
+    CHECK_GT(pageSize_, 0);
+}
+
+PagePool::~PagePool() {
+    Trim(0);
+    LOG_IF(WARNING, GetInUseByte() != 0)
+        << "page pool destroyed with pages in use, inUseByte = "
+        << GetInUseByte();
+}
+
+char* PagePool::Allocate() {
+    char* page = nullptr;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (!freePages_.empty()) {
+            page = freePages_.back();
+            freePages_.pop_back();
+        }
+    }
+
+    if (page == nullptr) {
+        page = new char[pageSize_];
+        allocatedByte_.fetch_add(pageSize_, std::memory_order_relaxed);
+    }
+    inUseByte_.fetch_add(pageSize_, std::memory_order_relaxed);
+    return page;
+}
+
+void PagePool::Release(char* page) {
+    if (page == nullptr) {
+        return;
+    }
+
+    inUseByte_.fetch_sub(pageSize_, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (freePages_.size() < maxFreeNum_) {
+            freePages_.push_back(page);
+            return;
+        }
+    }
+
+    delete[] page;
+    allocatedByte_.fetch_sub(pageSize_, std::memory_order_relaxed);
+}
+
+void PagePool::Trim(uint64_t keepByte) {
+    std::vector<char*> pages;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        size_t keepNum = keepByte / pageSize_;
+        if (freePages_.size() <= keepNum) {
+            return;
+        }
+        pages.assign(freePages_.begin() + keepNum, freePages_.end());
+        freePages_.resize(keepNum);
+    }
+
+    for (char* page : pages) {
+        delete[] page;
+    }
+    allocatedByte_.fetch_sub(pages.size() * pageSize_,
+                             std::memory_order_relaxed);
+    VLOG(6) << "page pool trimmed " << pages.size() << " pages";
+}
+
+}  // namespace client
+}  // namespace curvefs
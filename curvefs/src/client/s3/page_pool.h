@@ -0,0 +1,85 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef CURVEFS_SRC_CLIENT_S3_PAGE_POOL_H_
+#define CURVEFS_SRC_CLIENT_S3_PAGE_POOL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace curvefs {
+namespace client {
+
+/**
+ * A pool of fixed-size page buffers shared by the data caches.
+ *
+ * Released pages are kept in a free list and reused by later allocations,
+ * which avoids a malloc/free pair for every page written or read. At most
+ * maxFreeByte of free pages are kept, the others go back to the system,
+ * and Trim() gives back the free pages when the cache shrinks.
+ */
+class PagePool {
+ public:
+    PagePool(uint32_t pageSize, uint64_t maxFreeByte);
+
+    ~PagePool();
+
+    PagePool(const PagePool&) = delete;
+    PagePool& operator=(const PagePool&) = delete;
+
+    // allocate a page of pageSize bytes, the content is undefined
+    char* Allocate();
+
+    // give back a page allocated by this pool
+    void Release(char* page);
+
+    // free the cached pages until at most keepByte of them are left
+    void Trim(uint64_t keepByte = 0);
+
+    uint32_t GetPageSize() const { return pageSize_; }
+
+    // bytes of the pages held by the data caches
+    uint64_t GetInUseByte() const {
+        return inUseByte_.load(std::memory_order_relaxed);
+    }
+
+    // bytes of the pages allocated from the system, in use or free
+    uint64_t GetAllocatedByte() const {
+        return allocatedByte_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t GetFreeByte() const {
+        std::lock_guard<std::mutex> lk(mtx_);
+        return static_cast<uint64_t>(freePages_.size()) * pageSize_;
+    }
+
+ private:
+    const uint32_t pageSize_;
+    const uint64_t maxFreeNum_;
+
+    mutable std::mutex mtx_;
+    std::vector<char*> freePages_;
+
+    std::atomic<uint64_t> inUseByte_;
+    std::atomic<uint64_t> allocatedByte_;
+};
+
+}  // namespace client
+}  // namespace curvefs
+
+#endif  // CURVEFS_SRC_CLIENT_S3_PAGE_POOL_H_
@@ -0,0 +1,62 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "curvefs/src/client/s3/prefetch_window.h"
+
+#include <algorithm>
+
+namespace curvefs {
+namespace client {
+
+uint32_t PrefetchWindow::OnRead(uint64_t offset, uint64_t length,
+                                uint32_t initBlocks, uint32_t maxBlocks) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    uint32_t window = window_.load(std::memory_order_relaxed);
+    if (initBlocks == 0 || maxBlocks == 0) {
+        window = 0;
+    } else if (!hasRead_) {
+        window = std::min(initBlocks, maxBlocks);
+    } else if (offset >= lastOffset_ && offset <= nextOffset_ + length) {
+        // continue the previous read, or skip forward less than a read
+        window = std::min(window == 0 ? 1 : window * 2, maxBlocks);
+    } else {
+        window = 0;
+    }
+
+    hasRead_ = true;
+    lastOffset_ = offset;
+    nextOffset_ = offset + length;
+    window_.store(window, std::memory_order_relaxed);
+    return window;
+}
+
+bool PrefetchBudget::TryAcquire(uint32_t maxBlocks) {
+    uint32_t inflight = inflight_.load(std::memory_order_relaxed);
+    do {
+        if (maxBlocks != 0 && inflight >= maxBlocks) {
+            return false;
+        }
+    } while (!inflight_.compare_exchange_weak(inflight, inflight + 1,
+                                              std::memory_order_relaxed));
+    return true;
+}
+
+void PrefetchBudget::Release() {
+    inflight_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+}  // namespace client
+}  // namespace curvefs
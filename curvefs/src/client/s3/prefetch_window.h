@@ -0,0 +1,85 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef CURVEFS_SRC_CLIENT_S3_PREFETCH_WINDOW_H_
+#define CURVEFS_SRC_CLIENT_S3_PREFETCH_WINDOW_H_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace curvefs {
+namespace client {
+
+/**
+ * Number of blocks to prefetch of a file, following its access pattern.
+ *
+ * The first read of a file prefetches initBlocks. Every read continuing
+ * the previous one doubles the window up to maxBlocks, a read elsewhere
+ * is taken as random access and closes the window, so that random
+ * readers do not download blocks they never read.
+ */
+class PrefetchWindow {
+ public:
+    PrefetchWindow() = default;
+
+    /**
+     * @brief record a read of the file
+     *
+     * @param initBlocks window of the first read, 0 disables prefetching
+     * @param maxBlocks the upper bound of the window
+     *
+     * @return the window after this read
+     */
+    uint32_t OnRead(uint64_t offset, uint64_t length, uint32_t initBlocks,
+                    uint32_t maxBlocks);
+
+    uint32_t GetWindow() const {
+        return window_.load(std::memory_order_relaxed);
+    }
+
+ private:
+    std::mutex mtx_;
+    bool hasRead_ = false;
+    uint64_t lastOffset_ = 0;
+    uint64_t nextOffset_ = 0;
+    std::atomic<uint32_t> window_{0};
+};
+
+/**
+ * Number of blocks being prefetched of all files, so that many readers
+ * prefetching together do not take all the bandwidth of s3.
+ */
+class PrefetchBudget {
+ public:
+    // take a block, false if maxBlocks are being prefetched, 0 means
+    // no limit
+    bool TryAcquire(uint32_t maxBlocks);
+
+    void Release();
+
+    uint32_t GetInflight() const {
+        return inflight_.load(std::memory_order_relaxed);
+    }
+
+ private:
+    std::atomic<uint32_t> inflight_{0};
+};
+
+}  // namespace client
+}  // namespace curvefs
+
+#endif  // CURVEFS_SRC_CLIENT_S3_PREFETCH_WINDOW_H_
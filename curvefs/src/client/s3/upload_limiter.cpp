@@ -0,0 +1,121 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "curvefs/src/client/s3/upload_limiter.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+namespace curvefs {
+namespace client {
+
+namespace {
+
+constexpr double kCostUnitBytes = 1024.0 * 1024.0;
+// weight of a new sample in the average cost
+constexpr double kAvgCostWeight = 0.1;
+// let the lowest cost drift up slowly, so that it follows s3 getting
+// slower for a long time instead of shrinking forever
+constexpr double kBaseCostDrift = 1.001;
+constexpr double kCongestionDecrease = 0.9;
+constexpr double kErrorDecrease = 0.5;
+
+}  // namespace
+
+UploadLimiter::UploadLimiter(uint32_t minConcurrency, uint32_t maxConcurrency,
+                             double latencyTolerance)
+    : minConcurrency_(std::max(1u, std::min(minConcurrency, maxConcurrency))),
+      maxConcurrency_(std::max(1u, maxConcurrency)),
+      latencyTolerance_(std::max(1.0, latencyTolerance)),
+      window_(minConcurrency_),
+      inflight_(0),
+      slowStart_(true),
+      baseCost_(0),
+      avgCost_(0),
+      sinceDecrease_(minConcurrency_) {}
+
+void UploadLimiter::Acquire() {
+    std::unique_lock<std::mutex> lk(mtx_);
+    cond_.wait(lk, [this]() {
+        return inflight_ < static_cast<uint32_t>(window_);
+    });
+    inflight_++;
+}
+
+void UploadLimiter::OnComplete(uint64_t bytes, uint64_t latencyUs) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (inflight_ > 0) {
+        inflight_--;
+    }
+
+    double cost = static_cast<double>(latencyUs) /
+                  std::max(1.0, static_cast<double>(bytes) / kCostUnitBytes);
+    if (baseCost_ == 0) {
+        baseCost_ = cost;
+        avgCost_ = cost;
+    } else {
+        baseCost_ = std::min(cost, baseCost_ * kBaseCostDrift);
+        avgCost_ = (1 - kAvgCostWeight) * avgCost_ + kAvgCostWeight * cost;
+    }
+    sinceDecrease_++;
+
+    if (avgCost_ > baseCost_ * latencyTolerance_) {
+        slowStart_ = false;
+        Decrease(kCongestionDecrease);
+    } else if (slowStart_) {
+        window_ += 1;
+    } else {
+        window_ += 1 / window_;
+    }
+    window_ = std::min(window_, static_cast<double>(maxConcurrency_));
+
+    VLOG(9) << "upload complete, bytes = " << bytes
+            << ", latencyUs = " << latencyUs << ", baseCost = " << baseCost_
+            << ", avgCost = " << avgCost_ << ", window = " << window_;
+    cond_.notify_all();
+}
+
+void UploadLimiter::OnError() {
+    std::lock_guard<std::mutex> lk(mtx_);
+    slowStart_ = false;
+    Decrease(kErrorDecrease);
+}
+
+uint32_t UploadLimiter::GetConcurrency() const {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return static_cast<uint32_t>(window_);
+}
+
+uint32_t UploadLimiter::GetInflight() const {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return inflight_;
+}
+
+void UploadLimiter::Decrease(double factor) {
+    // the uploads sent before the last decrease still see the old
+    // congestion, do not punish them again
+    if (sinceDecrease_ < static_cast<uint64_t>(window_)) {
+        return;
+    }
+    window_ = std::max(window_ * factor,
+                       static_cast<double>(minConcurrency_));
+    sinceDecrease_ = 0;
+    VLOG(6) << "upload concurrency decrease to " << window_;
+}
+
+}  // namespace client
+}  // namespace curvefs
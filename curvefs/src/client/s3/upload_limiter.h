@@ -0,0 +1,88 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef CURVEFS_SRC_CLIENT_S3_UPLOAD_LIMITER_H_
+#define CURVEFS_SRC_CLIENT_S3_UPLOAD_LIMITER_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace curvefs {
+namespace client {
+
+/**
+ * Concurrency budget of the object uploads of flushing, shared by all
+ * inodes of a filesystem.
+ *
+ * The number of concurrent uploads adapts to the measured cost of an
+ * upload, the latency per MiB: it grows while the cost stays close to the
+ * lowest cost seen, which means s3 still has spare bandwidth, and shrinks
+ * when the cost goes up or uploads fail. Flushing waits in Acquire() when
+ * the budget is used up, so the dirty data stays in the write cache and
+ * writers are throttled by it.
+ */
+class UploadLimiter {
+ public:
+    /**
+     * @param minConcurrency the lower bound of concurrent uploads
+     * @param maxConcurrency the upper bound of concurrent uploads
+     * @param latencyTolerance shrink when the average cost exceeds the
+     *        lowest cost by this ratio
+     */
+    UploadLimiter(uint32_t minConcurrency, uint32_t maxConcurrency,
+                  double latencyTolerance);
+
+    // wait for a free slot before an upload is sent
+    void Acquire();
+
+    // an upload succeeded, release its slot
+    void OnComplete(uint64_t bytes, uint64_t latencyUs);
+
+    // an upload failed and will be retried, it keeps its slot
+    void OnError();
+
+    uint32_t GetConcurrency() const;
+
+    uint32_t GetInflight() const;
+
+ private:
+    // apply a multiplicative decrease at most once per window
+    void Decrease(double factor);
+
+ private:
+    const uint32_t minConcurrency_;
+    const uint32_t maxConcurrency_;
+    const double latencyTolerance_;
+
+    mutable std::mutex mtx_;
+    std::condition_variable cond_;
+
+    double window_;
+    uint32_t inflight_;
+    // grow by one per completed upload until the first congestion
+    bool slowStart_;
+    // the lowest and the average latency per MiB, in microseconds
+    double baseCost_;
+    double avgCost_;
+    // completed uploads since the last decrease
+    uint64_t sinceDecrease_;
+};
+
+}  // namespace client
+}  // namespace curvefs
+
+#endif  // CURVEFS_SRC_CLIENT_S3_UPLOAD_LIMITER_H_
@@ -33,7 +33,7 @@ namespace curvefs {
 namespace client {
 namespace vfs {
 
-using ::curve::common::LRUCache;
+using ::curve::common::ClockCache;
 
 class EntryCache {
  public:
@@ -45,7 +45,7 @@ class EntryCache {
     // TODO(Wine93): is there a more effective type for entry cache? maybe
     // absl::btree<Ino, absl::btree<std::string, Entry>> is a choise,
     // but it is a bit complex to implement lru evit strategy.
-    using LRUType = LRUCache<std::string, Entry>;
+    using LRUType = ClockCache<std::string, Entry>;
 
  public:
     EntryCache() = delete;
@@ -75,7 +75,7 @@ class AttrCache {
         TimeSpec expire;
     };
 
-    using LRUType = LRUCache<Ino, Attr>;
+    using LRUType = ClockCache<Ino, Attr>;
 
  public:
     AttrCache() = delete;
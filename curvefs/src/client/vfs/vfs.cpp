@@ -28,6 +28,7 @@
 #include <vector>
 #include <iostream>
 
+#include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/str_split.h"
 #include "curvefs/src/client/sdk_helper.h"
@@ -75,6 +76,8 @@ VFS::VFS(std::shared_ptr<Configure> cfg) {
     attrCache_ = std::make_shared<AttrCache>(cacheOption.attrCacheLruSize);
     handlers_ = std::make_shared<FileHandlers>();
     op_ = std::make_shared<OperationsImpl>(permission_, client_);
+    asyncIOPool_ = absl::make_unique<::curve::common::TaskThreadPool<>>();
+    asyncIOPool_->Start(vfsOption.asyncIOThreads);
 }
 
 CURVEFS_ERROR VFS::Mount(const std::string& fsname,
@@ -419,6 +422,91 @@ CURVEFS_ERROR VFS::Write(uint64_t fd,
     return rc;
 }
 
+CURVEFS_ERROR VFS::PRead(uint64_t fd,
+                         char* buffer,
+                         size_t count,
+                         uint64_t offset,
+                         size_t* nread) {
+    std::shared_ptr<FileHandler> fh;
+    CURVEFS_ERROR rc;
+    *nread = 0;
+    AccessLogGuard log([&](){
+        return StrFormat("pread (%d,%d,%d): %s (%d)",
+                         fd, count, offset, StrErr(rc), *nread);
+    });
+
+    bool yes = handlers_->GetHandler(fd, &fh);
+    if (!yes) {
+        rc = CURVEFS_ERROR::BAD_FD;
+        return rc;
+    }
+
+    rc = op_->Read(fh->ino, offset, buffer, count, nread);
+    return rc;
+}
+
+CURVEFS_ERROR VFS::PWrite(uint64_t fd,
+                          const char* buffer,
+                          size_t count,
+                          uint64_t offset,
+                          size_t* nwritten) {
+    std::shared_ptr<FileHandler> fh;
+    CURVEFS_ERROR rc;
+    *nwritten = 0;
+    AccessLogGuard log([&](){
+        return StrFormat("pwrite (%d,%d,%d): %s (%d)",
+                         fd, count, offset, StrErr(rc), *nwritten);
+    });
+
+    bool yes = handlers_->GetHandler(fd, &fh);
+    if (!yes) {
+        rc = CURVEFS_ERROR::BAD_FD;
+        return rc;
+    }
+
+    rc = op_->Write(fh->ino, offset, buffer, count, nwritten);
+    if (rc == CURVEFS_ERROR::OK) {
+        PurgeAttrCache(fh->ino);
+    }
+    return rc;
+}
+
+CURVEFS_ERROR VFS::AsyncRead(uint64_t fd,
+                             char* buffer,
+                             size_t count,
+                             uint64_t offset,
+                             AsyncIOCallback done) {
+    std::shared_ptr<FileHandler> fh;
+    if (!handlers_->GetHandler(fd, &fh)) {
+        return CURVEFS_ERROR::BAD_FD;
+    }
+
+    asyncIOPool_->Enqueue([this, fd, buffer, count, offset, done]() {
+        size_t nread = 0;
+        auto rc = PRead(fd, buffer, count, offset, &nread);
+        done(rc, nread);
+    });
+    return CURVEFS_ERROR::OK;
+}
+
+CURVEFS_ERROR VFS::AsyncWrite(uint64_t fd,
+                              const char* buffer,
+                              size_t count,
+                              uint64_t offset,
+                              AsyncIOCallback done) {
+    std::shared_ptr<FileHandler> fh;
+    if (!handlers_->GetHandler(fd, &fh)) {
+        return CURVEFS_ERROR::BAD_FD;
+    }
+
+    asyncIOPool_->Enqueue([this, fd, buffer, count, offset, done]() {
+        size_t nwritten = 0;
+        auto rc = PWrite(fd, buffer, count, offset, &nwritten);
+        done(rc, nwritten);
+    });
+    return CURVEFS_ERROR::OK;
+}
+
 CURVEFS_ERROR VFS::FSync(uint64_t fd) {
     std::shared_ptr<FileHandler> fh;
     AttrOut attrOut;
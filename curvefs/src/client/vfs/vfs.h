@@ -23,10 +23,12 @@
 #ifndef CURVEFS_SRC_CLIENT_VFS_VFS_H_
 #define CURVEFS_SRC_CLIENT_VFS_VFS_H_
 
+#include <functional>
 #include <string>
 #include <memory>
 
 #include "src/common/configuration.h"
+#include "src/common/concurrent/task_thread_pool.h"
 #include "curvefs/src/client/common/config.h"
 #include "curvefs/src/client/vfs/meta.h"
 #include "curvefs/src/client/vfs/cache.h"
@@ -43,6 +45,9 @@ using ::curve::common::Configuration;
 using ::curvefs::client::common::VFSOption;
 using ::curvefs::client::common::FuseClientOption;
 
+// the result of async read/write: error code and bytes read/written
+using AsyncIOCallback = std::function<void(CURVEFS_ERROR rc, size_t nbytes)>;
+
 class VFS {
  public:
     // NOTE: |cfg| include all configures for client.conf
@@ -86,6 +91,35 @@ class VFS {
                         size_t count,
                         size_t* nwritten);
 
+    // read/write at |offset| and leave the file offset of |fd| unchanged,
+    // data is read into (or written from) |buffer| without extra copy,
+    // so they can be called concurrently on the same fd.
+    CURVEFS_ERROR PRead(uint64_t fd,
+                        char* buffer,
+                        size_t count,
+                        uint64_t offset,
+                        size_t* nread);
+
+    CURVEFS_ERROR PWrite(uint64_t fd,
+                         const char* buffer,
+                         size_t count,
+                         uint64_t offset,
+                         size_t* nwritten);
+
+    // same as PRead/PWrite but run in background, |done| is called
+    // once finished, |buffer| must be kept valid until then.
+    CURVEFS_ERROR AsyncRead(uint64_t fd,
+                            char* buffer,
+                            size_t count,
+                            uint64_t offset,
+                            AsyncIOCallback done);
+
+    CURVEFS_ERROR AsyncWrite(uint64_t fd,
+                             const char* buffer,
+                             size_t count,
+                             uint64_t offset,
+                             AsyncIOCallback done);
+
     CURVEFS_ERROR FSync(uint64_t fd);
 
     CURVEFS_ERROR Close(uint64_t fd);
@@ -148,6 +182,8 @@ class VFS {
     std::shared_ptr<FileHandlers> handlers_;
     std::shared_ptr<EntryCache> entryCache_;
     std::shared_ptr<AttrCache> attrCache_;
+    // declared last to stop it before other members are destroyed
+    std::unique_ptr<::curve::common::TaskThreadPool<>> asyncIOPool_;
 };
 
 }  // namespace vfs
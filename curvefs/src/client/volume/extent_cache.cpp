@@ -56,6 +56,28 @@ bvar::LatencyRecorder g_read_divide_latency("extent_cache_read_divide");
 bvar::LatencyRecorder g_merge_latency("extent_cache_merge");
 bvar::LatencyRecorder g_mark_written_latency("extent_cache_mark_written");
 
+// merge the reads that are contiguous both on block device and in buffer,
+// so they are issued as one block device request
+void MergeContiguousReads(std::vector<ReadPart>* reads, size_t from) {
+    if (reads->size() - from < 2) {
+        return;
+    }
+
+    size_t last = from;
+    for (size_t i = from + 1; i < reads->size(); ++i) {
+        auto& prev = (*reads)[last];
+        const auto& cur = (*reads)[i];
+        if (prev.offset + static_cast<off_t>(prev.length) == cur.offset &&
+            prev.data + prev.length == cur.data) {
+            prev.length += cur.length;
+        } else {
+            (*reads)[++last] = cur;
+        }
+    }
+
+    reads->resize(last + 1);
+}
+
 std::ostream& operator<<(std::ostream& os, const ExtentCacheOption& opt) {
     os << "prealloc size: " << opt.preAllocSize
        << ", slice size: " << opt.sliceSize
@@ -109,7 +131,8 @@ void ExtentCache::DivideForWrite(uint64_t offset,
 
     while (offset < end) {
         const auto length = std::min(
-            end - offset, option_.sliceSize - (offset & ~option_.sliceSize));
+            end - offset,
+            align_down(offset, option_.sliceSize) + option_.sliceSize - offset);
 
         auto slice = slices_.find(align_down(offset, option_.sliceSize));
         if (slice != slices_.end()) {
@@ -170,8 +193,9 @@ void ExtentCache::MarkWritten(uint64_t offset, uint64_t len) {
             << ", cur: " << cur << ", end: " << end;
 
     while (cur < end) {
-        const auto length =
-            std::min(end - cur, option_.sliceSize - (cur & ~option_.sliceSize));
+        const auto length = std::min(
+            end - cur,
+            align_down(cur, option_.sliceSize) + option_.sliceSize - cur);
         auto slice = slices_.find(align_down(cur, option_.sliceSize));
         assert(slice != slices_.end());
         VLOG(9) << "mark written for offset: " << offset << ", len: " << len
@@ -214,11 +238,13 @@ void ExtentCache::DivideForRead(uint64_t offset,
             << ", length: " << len;
 
     const auto end = offset + len;
+    const auto readsBefore = reads->size();
     char* datap = data;
 
     while (offset < end) {
         const auto length = std::min(
-            end - offset, option_.sliceSize - (offset & ~option_.sliceSize));
+            end - offset,
+            align_down(offset, option_.sliceSize) + option_.sliceSize - offset);
 
         auto slice = slices_.find(align_down(offset, option_.sliceSize));
         if (slice != slices_.end()) {
@@ -237,6 +263,8 @@ void ExtentCache::DivideForRead(uint64_t offset,
         datap += length;
         offset += length;
     }
+
+    MergeContiguousReads(reads, readsBefore);
 }
 
 void ExtentCache::SetOption(const ExtentCacheOption& option) {
@@ -49,6 +49,8 @@ namespace curvefs {
 namespace client {
 namespace warmup {
 
+using curve::common::ReadWriteThrottleParams;
+using curve::common::ThrottleParams;
 using curve::common::WriteLockGuard;
 
 #define WARMUP_CHECKINTERVAL_US (1000 * 1000)
@@ -59,6 +61,13 @@ static bool pass_uint32(const char*, uint32_t) { return true; }
 DEFINE_uint32(warmupMaxSymLink, 1 << 2,
               "The maximum number of times to parse sym link");
 DEFINE_validator(warmupMaxSymLink, &pass_uint32);
+DEFINE_uint32(warmupMaxInflightObjects, 512,
+              "The maximum number of objects being downloaded by all warmup "
+              "tasks, 0 means no limit");
+DEFINE_validator(warmupMaxInflightObjects, &pass_uint32);
+DEFINE_uint64(warmupMaxDownloadBytesPerSec, 0,
+              "The maximum download bandwidth of all warmup tasks, "
+              "0 means no limit");
 
 bool WarmupManagerS3Impl::AddWarmupFilelist(fuse_ino_t key,
                                             WarmupStorageType type,
@@ -146,16 +155,6 @@ bool WarmupManagerS3Impl::CancelWarmupDependentQueue(fuse_ino_t key) {
         inode2FetchDentryPool_.erase(key);
     }
 
-    WriteLockGuard lockInodes(warmupInodesDequeMutex_);
-    for (auto it = warmupInodesDeque_.begin();
-         it != warmupInodesDeque_.end();) {
-        if (it->GetKey() == key) {
-            it = warmupInodesDeque_.erase(it);
-        } else {
-            ++it;
-        }
-    }
-
     auto fetchS3ObjIt = inode2FetchS3ObjectsPool_.find(key);
     if (fetchS3ObjIt != inode2FetchS3ObjectsPool_.end()) {
         inode2FetchS3ObjectsPool_[key]->Stop();
@@ -171,6 +170,11 @@ void WarmupManagerS3Impl::UnInit() {
     if (initbgFetchThread_) {
         bgFetchThread_.join();
     }
+    {
+        // wake up the tasks waiting to download
+        curve::common::LockGuard lk(downloadMutex_);
+        downloadCond_.notify_all();
+    }
 
     for (auto& task : inode2FetchDentryPool_) {
         task.second->Stop();
@@ -184,9 +188,6 @@ void WarmupManagerS3Impl::UnInit() {
     WriteLockGuard lockS3Objects(inode2FetchS3ObjectsPoolMutex_);
     inode2FetchS3ObjectsPool_.clear();
 
-    WriteLockGuard lockInodes(warmupInodesDequeMutex_);
-    warmupInodesDeque_.clear();
-
     WriteLockGuard lockFileList(warmupFilelistDequeMutex_);
     warmupFilelistDeque_.clear();
 
@@ -195,6 +196,9 @@ void WarmupManagerS3Impl::UnInit() {
 
 void WarmupManagerS3Impl::Init(const FuseClientOption& option) {
     WarmupManager::Init(option);
+    ReadWriteThrottleParams params;
+    params.bpsRead = ThrottleParams(FLAGS_warmupMaxDownloadBytesPerSec, 0, 0);
+    downloadThrottle_.UpdateThrottleParams(params);
     bgFetchStop_.store(false, std::memory_order_release);
     bgFetchThread_ = Thread(&WarmupManagerS3Impl::BackGroundFetch, this);
     initbgFetchThread_ = true;
@@ -204,7 +208,6 @@ void WarmupManagerS3Impl::BackGroundFetch() {
     while (!bgFetchStop_.load(std::memory_order_acquire)) {
         usleep(WARMUP_CHECKINTERVAL_US);
         ScanWarmupFilelist();
-        ScanWarmupInodes();
         ScanCleanFetchS3ObjectsPool();
         ScanCleanFetchDentryPool();
         ScanCleanWarmupProgress();
@@ -308,14 +311,8 @@ void WarmupManagerS3Impl::FetchDentry(fuse_ino_t key, fuse_ino_t ino,
         return;
     }
     if (FsFileType::TYPE_S3 == dentry.type()) {
-        WriteLockGuard lock(warmupInodesDequeMutex_);
-        auto iterDeque = FindWarmupInodesByKeyLocked(key);
-        if (iterDeque == warmupInodesDeque_.end()) {
-            warmupInodesDeque_.emplace_back(
-                key, std::set<fuse_ino_t>{dentry.inodeid()});
-        } else {
-            iterDeque->AddFileInode(dentry.inodeid());
-        }
+        // fetch the file while walking the rest of the tree
+        FetchDataEnqueue(key, dentry.inodeid());
         return;
     } else if (FsFileType::TYPE_DIRECTORY == dentry.type()) {
         auto task = [this, key, dentry, symlink_depth]() {
@@ -436,6 +433,14 @@ void WarmupManagerS3Impl::TravelChunk(fuse_ino_t ino,
         compaction = chunkinfo.compaction();
         offset = chunkinfo.offset();
         len = chunkinfo.len();
+        if (chunkinfo.has_packid()) {
+            // a slice of a pack, fetch the pack up to the slice's end
+            auto objectName = curvefs::common::s3util::GenPackObjName(
+                chunkinfo.packid(), fsId, objectPrefix);
+            prefetchObjs->push_back(
+                std::make_pair(objectName, chunkinfo.packoffset() + len));
+            continue;
+        }
         // the offset in the chunk
         uint64_t chunkPos = offset % chunkSize;
         // the first blockIndex
@@ -522,7 +527,18 @@ void WarmupManagerS3Impl::TravelChunk(fuse_ino_t ino,
 void WarmupManagerS3Impl::WarmUpAllObjs(
     fuse_ino_t key,
     const std::list<std::pair<std::string, uint64_t>>& prefetchObjs) {
-    std::atomic<uint64_t> pendingReq(0);
+    uint64_t seq;
+    {
+        ReadLockGuard lock(inode2ProgressMutex_);
+        auto iterProgress = FindWarmupProgressByKeyLocked(key);
+        if (iterProgress == inode2Progress_.end()) {
+            VLOG(9) << "no this warmup task progress: " << key;
+            return;
+        }
+        seq = iterProgress->second.GetSeq();
+    }
+    // held by this thread until all objects are sent
+    std::atomic<uint64_t> pendingReq(1);
     curve::common::CountDownEvent cond(1);
     uint64_t start = butil::cpuwide_time_us();
     // callback function
@@ -532,69 +548,100 @@ void WarmupManagerS3Impl::WarmUpAllObjs(
             (void)adapter;
             if (bgFetchStop_.load(std::memory_order_acquire)) {
                 VLOG(9) << "need stop warmup";
-                cond.Signal();
-                return;
-            }
-            if (context->retCode >= 0) {
+                delete[] context->buf;
+            } else if (context->retCode >= 0) {
                 VLOG(9) << "Get Object success: " << context->key;
                 PutObjectToCache(key, context);
                 curve::client::CollectMetrics(&warmupS3Metric_.warmupS3Cached,
                                               context->len,
                                               butil::cpuwide_time_us() - start);
                 warmupS3Metric_.warmupS3CacheSize << context->len;
-                if (pendingReq.fetch_sub(1, std::memory_order_seq_cst) == 1) {
-                    VLOG(6) << "pendingReq is over";
-                    cond.Signal();
-                }
-                return;
-            }
-            warmupS3Metric_.warmupS3Cached.eps.count << 1;
-            if (++context->retry >= option_.downloadMaxRetryTimes) {
-                if (pendingReq.fetch_sub(1, std::memory_order_seq_cst) == 1) {
-                    VLOG(6) << "pendingReq is over";
-                    cond.Signal();
+            } else {
+                warmupS3Metric_.warmupS3Cached.eps.count << 1;
+                if (++context->retry < option_.downloadMaxRetryTimes) {
+                    LOG(WARNING) << "Get Object failed, key: " << context->key
+                                 << ", offset: " << context->offset;
+                    s3Adaptor_->GetS3Client()->DownloadAsync(context);
+                    return;
                 }
                 VLOG(9) << "Up to max retry times, "
                         << "download object failed, key: " << context->key;
+                // the object is done, otherwise the progress never finishes
+                ProgressFinishedPlusOne(key);
                 delete[] context->buf;
-                return;
             }
-
-            LOG(WARNING) << "Get Object failed, key: " << context->key
-                         << ", offset: " << context->offset;
-            s3Adaptor_->GetS3Client()->DownloadAsync(context);
+            ReleaseDownloadSlot();
+            if (pendingReq.fetch_sub(1, std::memory_order_seq_cst) == 1) {
+                VLOG(6) << "pendingReq is over";
+                cond.Signal();
+            }
         };
 
-    pendingReq.fetch_add(prefetchObjs.size(), std::memory_order_seq_cst);
-    if (pendingReq.load(std::memory_order_seq_cst)) {
-        VLOG(9) << "wait for pendingReq";
-        for (auto iter : prefetchObjs) {
-            VLOG(9) << "download start: " << iter.first;
-            std::string name = iter.first;
-            uint64_t readLen = iter.second;
-            {
-                ReadLockGuard lock(inode2ProgressMutex_);
-                auto iterProgress = FindWarmupProgressByKeyLocked(key);
-                if (iterProgress != inode2Progress_.end() &&
-                    iterProgress->second.GetStorageType() ==
-                        curvefs::client::common::WarmupStorageType::
-                            kWarmupStorageTypeDisk &&
-                    s3Adaptor_->GetDiskCacheManager()->IsCached(name)) {
-                    iterProgress->second.FinishedPlusOne();
-                    // storage in disk and has cached
-                    pendingReq.fetch_sub(1);
-                    continue;
-                }
+    for (const auto& iter : prefetchObjs) {
+        VLOG(9) << "download start: " << iter.first;
+        const std::string& name = iter.first;
+        uint64_t readLen = iter.second;
+        {
+            ReadLockGuard lock(inode2ProgressMutex_);
+            auto iterProgress = FindWarmupProgressByKeyLocked(key);
+            if (iterProgress != inode2Progress_.end() &&
+                iterProgress->second.GetStorageType() ==
+                    curvefs::client::common::WarmupStorageType::
+                        kWarmupStorageTypeDisk &&
+                s3Adaptor_->GetDiskCacheManager()->IsCached(name)) {
+                // storage in disk and has cached
+                iterProgress->second.FinishedPlusOne();
+                continue;
             }
-            char* cacheS3 = new char[readLen];
-            memset(cacheS3, 0, readLen);
-            auto context = std::make_shared<GetObjectAsyncContext>(
-                name, cacheS3, 0, readLen, cb);
-            context->retry = 0;
-            s3Adaptor_->GetS3Client()->DownloadAsync(context);
         }
-        if (pendingReq.load()) cond.Wait();
+        downloadThrottle_.Add(true, readLen);
+        if (!AcquireDownloadSlot(seq)) {
+            VLOG(9) << "need stop warmup";
+            break;
+        }
+        char* cacheS3 = new char[readLen];
+        memset(cacheS3, 0, readLen);
+        auto context = std::make_shared<GetObjectAsyncContext>(
+            name, cacheS3, 0, readLen, cb);
+        context->retry = 0;
+        pendingReq.fetch_add(1, std::memory_order_seq_cst);
+        s3Adaptor_->GetS3Client()->DownloadAsync(context);
+    }
+    if (pendingReq.fetch_sub(1, std::memory_order_seq_cst) != 1) {
+        VLOG(9) << "wait for pendingReq";
+        cond.Wait();
+    }
+}
+
+bool WarmupManagerS3Impl::AcquireDownloadSlot(uint64_t seq) {
+    curve::common::UniqueLock lk(downloadMutex_);
+    ++waitingDownloads_[seq];
+    downloadCond_.wait(lk, [this, seq]() {
+        return bgFetchStop_.load(std::memory_order_acquire) ||
+               ((FLAGS_warmupMaxInflightObjects == 0 ||
+                 inflightDownloads_ < FLAGS_warmupMaxInflightObjects) &&
+                waitingDownloads_.begin()->first == seq);
+    });
+    auto iter = waitingDownloads_.find(seq);
+    if (--iter->second == 0) {
+        waitingDownloads_.erase(iter);
+    }
+    if (bgFetchStop_.load(std::memory_order_acquire)) {
+        return false;
     }
+    ++inflightDownloads_;
+    if (FLAGS_warmupMaxInflightObjects == 0 ||
+        inflightDownloads_ < FLAGS_warmupMaxInflightObjects) {
+        // there is still room, maybe for the next task
+        downloadCond_.notify_all();
+    }
+    return true;
+}
+
+void WarmupManagerS3Impl::ReleaseDownloadSlot() {
+    curve::common::LockGuard lk(downloadMutex_);
+    --inflightDownloads_;
+    downloadCond_.notify_all();
 }
 
 bool WarmupManagerS3Impl::ProgressDone(fuse_ino_t key) {
@@ -610,12 +657,6 @@ bool WarmupManagerS3Impl::ProgressDone(fuse_ino_t key) {
                       inode2FetchDentryPool_.end());
     }
 
-    {
-        ReadLockGuard lockInodes(warmupInodesDequeMutex_);
-        ret = ret &&
-              (FindWarmupInodesByKeyLocked(key) == warmupInodesDeque_.end());
-    }
-
     {
         ReadLockGuard lockS3Objects(inode2FetchS3ObjectsPoolMutex_);
         ret = ret && (FindFetchS3ObjectsPoolByKeyLocked(key) ==
@@ -656,7 +697,7 @@ void WarmupManagerS3Impl::ScanCleanFetchS3ObjectsPool() {
 
 void WarmupManagerS3Impl::ScanCleanWarmupProgress() {
     // clean done warmupProgress
-    ReadLockGuard lock(inode2ProgressMutex_);
+    WriteLockGuard lock(inode2ProgressMutex_);
     for (auto iter = inode2Progress_.begin(); iter != inode2Progress_.end();) {
         if (ProgressDone(iter->first)) {
             LOG(INFO) << "warmup task: " << iter->first << " done!";
@@ -667,20 +708,6 @@ void WarmupManagerS3Impl::ScanCleanWarmupProgress() {
     }
 }
 
-void WarmupManagerS3Impl::ScanWarmupInodes() {
-    // file need warmup
-    WriteLockGuard lock(warmupInodesDequeMutex_);
-    if (!warmupInodesDeque_.empty()) {
-        WarmupInodes inodes = warmupInodesDeque_.front();
-        for (auto const& iter : inodes.GetReadAheadFiles()) {
-            VLOG(9) << "BackGroundFetch: key: " << inodes.GetKey()
-                    << " inode:" << iter;
-            FetchDataEnqueue(inodes.GetKey(), iter);
-        }
-        warmupInodesDeque_.pop_front();
-    }
-}
-
 void WarmupManagerS3Impl::AlignFilelistPathsToCurveFs(
     const WarmupFilelist& filelist, std::vector<std::string>* list) {
     for (auto filePathIt = list->begin(); filePathIt != list->end();) {
@@ -699,7 +726,8 @@ void WarmupManagerS3Impl::AlignFilelistPathsToCurveFs(
 void WarmupManagerS3Impl::ScanWarmupFilelist() {
     // Use a write lock to ensure that all parsing tasks are added.
     WriteLockGuard lock(warmupFilelistDequeMutex_);
-    if (!warmupFilelistDeque_.empty()) {
+    // parse all the filelists, their tasks run at the same time
+    while (!warmupFilelistDeque_.empty()) {
         WarmupFilelist warmupFilelist = warmupFilelistDeque_.front();
         VLOG(9) << "warmup ino: " << warmupFilelist.GetKey()
                 << " len is: " << warmupFilelist.GetFileLen()
@@ -768,6 +796,7 @@ void WarmupManagerS3Impl::PutObjectToCache(
     auto iter = FindWarmupProgressByKeyLocked(key);
     if (iter == inode2Progress_.end()) {
         VLOG(9) << "no this warmup task progress: " << key;
+        delete[] context->buf;
         return;
     }
     int ret;
@@ -798,6 +827,14 @@ void WarmupManagerS3Impl::PutObjectToCache(
     }
 }
 
+void WarmupManagerS3Impl::ProgressFinishedPlusOne(fuse_ino_t key) {
+    ReadLockGuard lock(inode2ProgressMutex_);
+    auto iter = FindWarmupProgressByKeyLocked(key);
+    if (iter != inode2Progress_.end()) {
+        iter->second.FinishedPlusOne();
+    }
+}
+
 bool WarmupManagerS3Impl::GetInodeSubPathParent(
     fuse_ino_t inode, const std::vector<std::string>& subPath, fuse_ino_t* ret,
     std::string* lastPath, uint32_t* symlink_depth) {
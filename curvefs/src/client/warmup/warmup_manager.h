@@ -33,7 +33,6 @@
 #include <map>
 #include <memory>
 #include <mutex>
-#include <set>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -51,6 +50,7 @@
 #include "curvefs/src/common/task_thread_pool.h"
 #include "src/common/concurrent/concurrent.h"
 #include "src/common/concurrent/rw_lock.h"
+#include "src/common/throttle.h"
 
 namespace curvefs {
 namespace client {
@@ -95,39 +95,23 @@ class WarmupFilelist : public WarmupFile {
     std::string root_;
 };
 
-class WarmupInodes {
- public:
-    explicit WarmupInodes(fuse_ino_t key = 0,
-                          std::set<fuse_ino_t> list = std::set<fuse_ino_t>())
-        : key_(key), readAheadFiles_(std::move(list)) {}
-
-    fuse_ino_t GetKey() const { return key_; }
-    const std::set<fuse_ino_t>& GetReadAheadFiles() const {
-        return readAheadFiles_;
-    }
-
-    void AddFileInode(fuse_ino_t file) { readAheadFiles_.emplace(file); }
-
- private:
-    fuse_ino_t key_;
-    std::set<fuse_ino_t> readAheadFiles_;
-};
-
 class WarmupProgress {
  public:
     explicit WarmupProgress(WarmupStorageType type = curvefs::client::common::
                                 WarmupStorageType::kWarmupStorageTypeUnknown,
-                            std::string filePath = "")
+                            std::string filePath = "", uint64_t seq = 0)
         : total_(0),
           finished_(0),
           storageType_(type),
-          filePathInClient_(filePath) {}
+          filePathInClient_(filePath),
+          seq_(seq) {}
 
     WarmupProgress(const WarmupProgress& wp)
         : total_(wp.total_),
           finished_(wp.finished_),
           storageType_(wp.storageType_),
-          filePathInClient_(wp.filePathInClient_) {}
+          filePathInClient_(wp.filePathInClient_),
+          seq_(wp.seq_) {}
 
     void AddTotal(uint64_t add) {
         std::lock_guard<std::mutex> lock(totalMutex_);
@@ -166,6 +150,10 @@ class WarmupProgress {
 
     WarmupStorageType GetStorageType() { return storageType_; }
 
+    // the order in which the warmup task was added, the smaller one
+    // downloads its objects first
+    uint64_t GetSeq() const { return seq_; }
+
  private:
     uint64_t total_;
     std::mutex totalMutex_;
@@ -173,6 +161,7 @@ class WarmupProgress {
     std::mutex finishedMutex_;
     WarmupStorageType storageType_;
     std::string filePathInClient_;
+    uint64_t seq_;
 };
 
 using FuseOpReadFunctionType =
@@ -287,7 +276,11 @@ class WarmupManager {
      */
     virtual bool AddWarmupProcessLocked(fuse_ino_t key, const std::string& path,
                                         WarmupStorageType type) {
-        auto retPg = inode2Progress_.emplace(key, WarmupProgress(type, path));
+        auto retPg = inode2Progress_.emplace(
+            key, WarmupProgress(type, path, nextSeq_));
+        if (retPg.second) {
+            ++nextSeq_;
+        }
         return retPg.second;
     }
 
@@ -345,6 +338,9 @@ class WarmupManager {
 
     BthreadRWLock inode2ProgressMutex_;
 
+    // seq of the next warmup task, protected by inode2ProgressMutex_
+    uint64_t nextSeq_ = 0;
+
     std::shared_ptr<KVClientManager> kvClientManager_ = nullptr;
 
     FuseClientOption option_;
@@ -418,21 +414,6 @@ class WarmupManagerS3Impl : public WarmupManager {
     void FetchChildDentry(fuse_ino_t key, fuse_ino_t ino,
                           uint32_t symlink_depth);
 
-    /**
-     * @brief
-     * Please use it with the lock warmupInodesDequeMutex_
-     * @param key
-     * @return std::deque<WarmupInodes>::iterator
-     */
-    std::deque<WarmupInodes>::iterator FindWarmupInodesByKeyLocked(
-        fuse_ino_t key) {
-        return std::find_if(warmupInodesDeque_.begin(),
-                            warmupInodesDeque_.end(),
-                            [key](const WarmupInodes& inodes) {
-                                return key == inodes.GetKey();
-                            });
-    }
-
     /**
      * @brief
      * Please use it with the lock warmupFilelistDequeMutex_
@@ -504,8 +485,6 @@ class WarmupManagerS3Impl : public WarmupManager {
 
     void ScanCleanWarmupProgress();
 
-    void ScanWarmupInodes();
-
     void ScanWarmupFilelist();
 
     void AddFetchDentryTask(fuse_ino_t key, std::function<void()> task);
@@ -515,6 +494,18 @@ class WarmupManagerS3Impl : public WarmupManager {
     void PutObjectToCache(
         fuse_ino_t key, const std::shared_ptr<GetObjectAsyncContext>& context);
 
+    void ProgressFinishedPlusOne(fuse_ino_t key);
+
+    /**
+     * @brief Wait until one more object can be downloaded, the objects of
+     * the earlier added warmup task (smaller seq) are downloaded first
+     *
+     * @return false: warmup is stopping
+     */
+    bool AcquireDownloadSlot(uint64_t seq);
+
+    void ReleaseDownloadSlot();
+
  protected:
     std::deque<WarmupFilelist> warmupFilelistDeque_;
     mutable RWLock warmupFilelistDequeMutex_;
@@ -528,9 +519,6 @@ class WarmupManagerS3Impl : public WarmupManager {
         inode2FetchDentryPool_;
     mutable RWLock inode2FetchDentryPoolMutex_;
 
-    std::deque<WarmupInodes> warmupInodesDeque_;
-    mutable RWLock warmupInodesDequeMutex_;
-
     // s3 adaptor
     std::shared_ptr<S3ClientAdaptor> s3Adaptor_;
 
@@ -539,6 +527,16 @@ class WarmupManagerS3Impl : public WarmupManager {
         inode2FetchS3ObjectsPool_;
     mutable RWLock inode2FetchS3ObjectsPoolMutex_;
 
+    // objects being downloaded by all warmup tasks
+    curve::common::Mutex downloadMutex_;
+    curve::common::ConditionVariable downloadCond_;
+    uint32_t inflightDownloads_ = 0;
+    // seq -> number of threads waiting to download objects of the task
+    std::map<uint64_t, uint32_t> waitingDownloads_;
+
+    // limit the download bandwidth of all warmup tasks
+    curve::common::Throttle downloadThrottle_;
+
     curvefs::client::metric::WarmupManagerS3Metric warmupS3Metric_;
 };
 
@@ -23,6 +23,9 @@
 
 #include "curvefs/src/client/xattr_manager.h"
 
+#include <chrono>
+#include <utility>
+
 #include "curvefs/src/client/common/common.h"
 #include "curvefs/src/client/filesystem/xattr.h"
 #include "src/common/string_util.h"
@@ -41,8 +44,54 @@ using ::curvefs::client::filesystem::XATTR_DIR_RENTRIES;
 using ::curvefs::client::filesystem::XATTR_DIR_RFBYTES;
 using ::curvefs::client::filesystem::XATTR_DIR_RFILES;
 using ::curvefs::client::filesystem::XATTR_DIR_RSUBDIRS;
+using ::curvefs::client::filesystem::XATTR_DIR_RSUM_ENTRIES;
+using ::curvefs::client::filesystem::XATTR_DIR_RSUM_FBYTES;
+using ::curvefs::client::filesystem::XATTR_DIR_RSUM_FILES;
+using ::curvefs::client::filesystem::XATTR_DIR_RSUM_SUBDIRS;
 using ::curvefs::client::filesystem::XATTR_DIR_SUBDIRS;
 
+namespace {
+
+bool ParseSummary(const google::protobuf::Map<std::string, std::string> &xattr,
+                  const char *files, const char *subdirs,
+                  const char *entries, const char *fbytes,
+                  SummaryDelta *summary) {
+    const std::pair<const char *, int64_t *> fields[] = {
+        {files, &summary->files},
+        {subdirs, &summary->subdirs},
+        {entries, &summary->entries},
+        {fbytes, &summary->fbytes},
+    };
+    for (const auto &field : fields) {
+        auto it = xattr.find(field.first);
+        uint64_t value = 0;
+        if (it == xattr.end() || !StringToUll(it->second, &value)) {
+            return false;
+        }
+        *field.second = static_cast<int64_t>(value);
+    }
+    return true;
+}
+
+bool AddToUllString(std::string *str, int64_t value) {
+    if (value == 0) {
+        return true;
+    }
+    return value > 0
+               ? AddUllStringToFirst(str, static_cast<uint64_t>(value), true)
+               : AddUllStringToFirst(str, static_cast<uint64_t>(-value),
+                                     false);
+}
+
+void Negate(SummaryDelta *delta) {
+    delta->files = -delta->files;
+    delta->subdirs = -delta->subdirs;
+    delta->entries = -delta->entries;
+    delta->fbytes = -delta->fbytes;
+}
+
+}  // namespace
+
 bool IsSummaryInfo(const char *name) {
     return std::strstr(name, XATTR_DIR_PREFIX);
 }
@@ -453,7 +502,9 @@ CURVEFS_ERROR XattrManager::GetXattr(const char* name, std::string *value,
         } else {
             if (IsOneLayer(name)) {
                 ret = FastCalOneLayerSumInfo(attr);
-            } else {
+            } else if (summaryPropagateIntervalMs_ == 0 ||
+                       !GetRecursiveSummary(attr)) {
+                // the directories created before keep no recursive summary
                 ret = FastCalAllLayerSumInfo(attr);
             }
         }
@@ -510,9 +561,181 @@ CURVEFS_ERROR XattrManager::UpdateParentInodeXattr(uint64_t parentId,
         inodeManager_->ShipToFlush(pInodeWrapper);
     }
 
+    // the ancestors may keep the recursive summary even if the parent
+    // doesn't, e.g. it's created before and renamed into a newer one
+    if (summaryPropagateIntervalMs_ > 0) {
+        SummaryDelta delta;
+        for (const auto &it : xattr.xattrinfos()) {
+            uint64_t dat = 0;
+            if (!StringToUll(it.second, &dat)) {
+                continue;
+            }
+            int64_t value = direction ? static_cast<int64_t>(dat)
+                                      : -static_cast<int64_t>(dat);
+            if (it.first == XATTR_DIR_FILES) {
+                delta.files += value;
+            } else if (it.first == XATTR_DIR_SUBDIRS) {
+                delta.subdirs += value;
+            } else if (it.first == XATTR_DIR_ENTRIES) {
+                delta.entries += value;
+            } else if (it.first == XATTR_DIR_FBYTES) {
+                delta.fbytes += value;
+            }
+        }
+        AddSummaryDelta(parentId, delta);
+    }
+
+    return CURVEFS_ERROR::OK;
+}
+
+bool XattrManager::GetRecursiveSummary(InodeAttr *attr) {
+    SummaryDelta summary;
+    if (!ParseSummary(attr->xattr(), XATTR_DIR_RSUM_FILES,
+                      XATTR_DIR_RSUM_SUBDIRS, XATTR_DIR_RSUM_ENTRIES,
+                      XATTR_DIR_RSUM_FBYTES, &summary)) {
+        return false;
+    }
+    auto *xattr = attr->mutable_xattr();
+    (*xattr)[XATTR_DIR_RFILES] = std::to_string(summary.files);
+    (*xattr)[XATTR_DIR_RSUBDIRS] = std::to_string(summary.subdirs);
+    (*xattr)[XATTR_DIR_RENTRIES] = std::to_string(summary.entries);
+    (*xattr)[XATTR_DIR_RFBYTES] =
+        std::to_string(summary.fbytes + attr->length());
+    return true;
+}
+
+CURVEFS_ERROR XattrManager::GetSubtreeSummary(uint64_t dirId,
+                                              SummaryDelta *summary) {
+    InodeAttr attr;
+    CURVEFS_ERROR ret = inodeManager_->GetInodeAttr(dirId, &attr);
+    if (ret != CURVEFS_ERROR::OK) {
+        LOG(ERROR) << "GetSubtreeSummary get inode attr fail, ret = " << ret
+                   << ", inodeid = " << dirId;
+        return ret;
+    }
+    if (ParseSummary(attr.xattr(), XATTR_DIR_RSUM_FILES,
+                     XATTR_DIR_RSUM_SUBDIRS, XATTR_DIR_RSUM_ENTRIES,
+                     XATTR_DIR_RSUM_FBYTES, summary)) {
+        return CURVEFS_ERROR::OK;
+    }
+
+    // walk the directories of the subtree, it has no recursive summary
+    SummaryDelta oneLayer;
+    if (!ParseSummary(attr.xattr(), XATTR_DIR_FILES, XATTR_DIR_SUBDIRS,
+                      XATTR_DIR_ENTRIES, XATTR_DIR_FBYTES, &oneLayer)) {
+        LOG(WARNING) << "GetSubtreeSummary no summary in inode = " << dirId;
+        return CURVEFS_ERROR::NOT_SUPPORT;
+    }
+    attr.mutable_xattr()->erase(XATTR_DIR_RFILES);
+    attr.mutable_xattr()->erase(XATTR_DIR_RSUBDIRS);
+    attr.mutable_xattr()->erase(XATTR_DIR_RENTRIES);
+    attr.mutable_xattr()->erase(XATTR_DIR_RFBYTES);
+    ret = FastCalAllLayerSumInfo(&attr);
+    if (ret != CURVEFS_ERROR::OK) {
+        return ret;
+    }
+    if (!ParseSummary(attr.xattr(), XATTR_DIR_RFILES, XATTR_DIR_RSUBDIRS,
+                      XATTR_DIR_RENTRIES, XATTR_DIR_RFBYTES, summary)) {
+        return CURVEFS_ERROR::INTERNAL;
+    }
+    // the length of the directory is counted in the one layer summary of
+    // its parent
+    summary->fbytes -= static_cast<int64_t>(attr.length());
     return CURVEFS_ERROR::OK;
 }
 
+void XattrManager::Start() {
+    if (summaryPropagateIntervalMs_ == 0) {
+        return;
+    }
+    sleeper_.init();
+    summaryThread_ = Thread(&XattrManager::PropagateSummary, this);
+    LOG(INFO) << "start propagating dir summary, interval = "
+              << summaryPropagateIntervalMs_ << " ms";
+}
+
+void XattrManager::Stop() {
+    isStop_.store(true);
+    sleeper_.interrupt();
+    if (summaryThread_.joinable()) {
+        summaryThread_.join();
+    }
+}
+
+void XattrManager::AddSummaryDelta(uint64_t dirId,
+                                   const SummaryDelta &delta) {
+    if (delta.Empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lk(summaryMtx_);
+    SummaryDelta &pending = summaryDeltas_[dirId];
+    pending.files += delta.files;
+    pending.subdirs += delta.subdirs;
+    pending.entries += delta.entries;
+    pending.fbytes += delta.fbytes;
+}
+
+void XattrManager::PropagateSummary() {
+    while (sleeper_.wait_for(
+        std::chrono::milliseconds(summaryPropagateIntervalMs_))) {
+        ApplySummaryDeltas();
+    }
+}
+
+void XattrManager::ApplySummaryDeltas() {
+    std::unordered_map<uint64_t, SummaryDelta> deltas;
+    {
+        std::lock_guard<std::mutex> lk(summaryMtx_);
+        deltas.swap(summaryDeltas_);
+    }
+
+    for (const auto &it : deltas) {
+        if (it.second.Empty()) {
+            continue;
+        }
+        std::shared_ptr<InodeWrapper> inodeWrapper;
+        CURVEFS_ERROR ret = inodeManager_->GetInode(it.first, inodeWrapper);
+        if (ret != CURVEFS_ERROR::OK) {
+            // the directory is removed, it was empty
+            LOG(WARNING) << "ApplySummaryDeltas get inode fail, ret = " << ret
+                         << ", inodeid = " << it.first;
+            continue;
+        }
+
+        uint64_t parent = 0;
+        {
+            ::curve::common::UniqueLock lgGuard =
+                inodeWrapper->GetUniqueLock();
+            const Inode *inode = inodeWrapper->GetInodeLocked();
+            if (inode->type() != FsFileType::TYPE_DIRECTORY) {
+                continue;
+            }
+            auto xattr = inode->xattr();
+            auto files = xattr.find(XATTR_DIR_RSUM_FILES);
+            auto subdirs = xattr.find(XATTR_DIR_RSUM_SUBDIRS);
+            auto entries = xattr.find(XATTR_DIR_RSUM_ENTRIES);
+            auto fbytes = xattr.find(XATTR_DIR_RSUM_FBYTES);
+            if (files != xattr.end() && subdirs != xattr.end() &&
+                entries != xattr.end() && fbytes != xattr.end()) {
+                // a negative result is reset to 0 and logged, the error
+                // of one directory doesn't stop its ancestors
+                AddToUllString(&files->second, it.second.files);
+                AddToUllString(&subdirs->second, it.second.subdirs);
+                AddToUllString(&entries->second, it.second.entries);
+                AddToUllString(&fbytes->second, it.second.fbytes);
+                inodeWrapper->MergeXAttrLocked(xattr);
+                inodeManager_->ShipToFlush(inodeWrapper);
+            }
+            if (inode->inodeid() != ROOTINODEID && inode->parent_size() > 0) {
+                parent = inode->parent(0);
+            }
+        }
+        if (parent != 0) {
+            AddSummaryDelta(parent, it.second);
+        }
+    }
+}
+
 CURVEFS_ERROR XattrManager::UpdateParentXattrAfterRename(uint64_t parent,
     uint64_t newparent, const char *newname, RenameOperator* renameOp) {
     CURVEFS_ERROR rc = CURVEFS_ERROR::OK;
@@ -561,6 +784,20 @@ CURVEFS_ERROR XattrManager::UpdateParentXattrAfterRename(uint64_t parent,
                        << ", xattr = " << xattr.DebugString();
             return rc;
         }
+
+        // the whole subtree moves along with the directory
+        if (summaryPropagateIntervalMs_ > 0 &&
+            dentry.type() == FsFileType::TYPE_DIRECTORY) {
+            SummaryDelta summary;
+            if (GetSubtreeSummary(ino, &summary) == CURVEFS_ERROR::OK) {
+                AddSummaryDelta(newparent, summary);
+                Negate(&summary);
+                AddSummaryDelta(parent, summary);
+            } else {
+                LOG(WARNING) << "recursive summary of the ancestors of inode "
+                             << ino << " is not updated after rename";
+            }
+        }
     }
 
     // if rename dest exist and is file or empty dir, it will be overwirte
@@ -47,6 +47,7 @@ namespace client {
 
 using curvefs::metaserver::FsFileType;
 using ::curve::common::Atomic;
+using ::curve::common::Thread;
 using ::curve::common::InterruptibleSleeper;
 
 struct SummaryInfo {
@@ -56,24 +57,48 @@ struct SummaryInfo {
     uint64_t fbytes = 0;
 };
 
+// the change of the recursive summary of a directory
+struct SummaryDelta {
+    int64_t files = 0;
+    int64_t subdirs = 0;
+    int64_t entries = 0;
+    int64_t fbytes = 0;
+
+    bool Empty() const {
+        return files == 0 && subdirs == 0 && entries == 0 && fbytes == 0;
+    }
+};
+
 class XattrManager {
  public:
     XattrManager(const std::shared_ptr<InodeCacheManager> &inodeManager,
         const std::shared_ptr<DentryCacheManager> &dentryManager,
         uint32_t listDentryLimit,
-        uint32_t listDentryThreads)
+        uint32_t listDentryThreads,
+        uint32_t summaryPropagateIntervalMs = 0)
         : inodeManager_(inodeManager),
         dentryManager_(dentryManager),
         listDentryLimit_(listDentryLimit),
         listDentryThreads_(listDentryThreads),
+        summaryPropagateIntervalMs_(summaryPropagateIntervalMs),
         isStop_(false) {}
 
-    ~XattrManager() {}
-
-    void Stop() {
-        isStop_.store(true);
+    ~XattrManager() {
+        Stop();
     }
 
+    // start propagating the recursive summaries if enabled
+    void Start();
+
+    void Stop();
+
+    /**
+     * @brief add delta to the recursive summary of dir and its ancestors,
+     *        it's applied asynchronously one level at a time, so the deltas
+     *        reaching the same directory are merged on the way up
+     */
+    void AddSummaryDelta(uint64_t dirId, const SummaryDelta &delta);
+
     CURVEFS_ERROR GetXattr(const char* name, std::string *value,
         InodeAttr *attr, bool enableSumInDir);
 
@@ -119,6 +144,19 @@ class XattrManager {
 
     CURVEFS_ERROR FastCalAllLayerSumInfo(InodeAttr *attr);
 
+    // fill the all layer summary from the one kept in the directory,
+    // false if the directory doesn't keep it
+    bool GetRecursiveSummary(InodeAttr *attr);
+
+    // the recursive summary of the subtree of dir, including the one layer
+    // summary of dir itself
+    CURVEFS_ERROR GetSubtreeSummary(uint64_t dirId, SummaryDelta *summary);
+
+    void PropagateSummary();
+
+    // apply the deltas to their directories and pass them to the parents
+    void ApplySummaryDeltas();
+
  private:
     // inode cache manager
     std::shared_ptr<InodeCacheManager> inodeManager_;
@@ -132,7 +170,15 @@ class XattrManager {
 
     uint32_t listDentryThreads_;
 
+    // |0| means not maintaining the recursive summaries
+    uint32_t summaryPropagateIntervalMs_;
+
     Atomic<bool> isStop_;
+
+    std::mutex summaryMtx_;
+    // the deltas not applied yet, keyed by directory
+    std::unordered_map<uint64_t, SummaryDelta> summaryDeltas_;
+    Thread summaryThread_;
 };
 
 }  // namespace client
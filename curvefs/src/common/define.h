@@ -39,6 +39,10 @@ using ::curvefs::client::filesystem::XATTR_DIR_RENTRIES;
 using ::curvefs::client::filesystem::XATTR_DIR_RFBYTES;
 using ::curvefs::client::filesystem::XATTR_DIR_RFILES;
 using ::curvefs::client::filesystem::XATTR_DIR_RSUBDIRS;
+using ::curvefs::client::filesystem::XATTR_DIR_RSUM_ENTRIES;
+using ::curvefs::client::filesystem::XATTR_DIR_RSUM_FBYTES;
+using ::curvefs::client::filesystem::XATTR_DIR_RSUM_FILES;
+using ::curvefs::client::filesystem::XATTR_DIR_RSUM_SUBDIRS;
 using ::curvefs::client::filesystem::XATTR_DIR_SUBDIRS;
 using ::curvefs::client::filesystem::XATTR_WARMUP_OP;
 using ::curvefs::client::filesystem::XATTR_WARMUP_OP_LIST;
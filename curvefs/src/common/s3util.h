@@ -57,6 +57,20 @@ inline std::string GenObjName(uint64_t chunkid, uint64_t index,
     return objName;
 }
 
+// a pack object holds the small chunks of several inodes, it's named as an
+// object of inode 0, which never exists
+inline std::string GenPackObjName(uint64_t packId, uint64_t fsid,
+                                  uint32_t objectPrefix) {
+    return GenObjName(packId, 0, 0, fsid, 0, objectPrefix);
+}
+
+// the empty object marking the slice of index in the pack is released
+inline std::string GenPackTombstoneName(uint64_t packId, uint32_t index,
+                                        uint64_t fsid,
+                                        uint32_t objectPrefix) {
+    return GenObjName(packId, index, 1, fsid, 0, objectPrefix);
+}
+
 bool ValidNameOfInode(const std::string &inode, const std::string &objName,
                       uint32_t objectPrefix);
 
@@ -28,6 +28,7 @@
 #include <string>
 
 #include <limits>
+#include <mutex>
 #include <list>
 #include <utility>
 #include <regex> // NOLINT
@@ -600,6 +601,42 @@ FSStatusCode FsManager::DeleteFs(const std::string& fsName) {
 
 FSStatusCode FsManager::MountFs(const std::string& fsName,
                                 const Mountpoint& mountpoint, FsInfo* fsInfo) {
+    PendingMount mount;
+    mount.mountpoint = &mountpoint;
+    mount.fsInfo = fsInfo;
+
+    std::unique_lock<Mutex> lk(mountQueueMutex_);
+    // the queue isn't erased while any of its request isn't done
+    auto& queue = mountQueues_[fsName];
+    queue.pending.push_back(&mount);
+    while (!mount.done) {
+        if (queue.leading) {
+            mountQueueCond_.wait(lk);
+            continue;
+        }
+
+        queue.leading = true;
+        std::vector<PendingMount*> batch;
+        batch.swap(queue.pending);
+        lk.unlock();
+        MountFsBatch(fsName, batch);
+        lk.lock();
+
+        for (auto* m : batch) {
+            m->done = true;
+        }
+        queue.leading = false;
+        if (queue.pending.empty()) {
+            mountQueues_.erase(fsName);
+        }
+        mountQueueCond_.notify_all();
+    }
+
+    return mount.ret;
+}
+
+void FsManager::MountFsBatch(const std::string& fsName,
+                             const std::vector<PendingMount*>& batch) {
     NameLockGuard lock(nameLock_, fsName);
 
     // query fs
@@ -608,11 +645,53 @@ FSStatusCode FsManager::MountFs(const std::string& fsName,
     if (ret != FSStatusCode::OK) {
         LOG(WARNING) << "MountFs fail, get fs fail, fsName = " << fsName
                      << ", errCode = " << FSStatusCode_Name(ret);
-        return ret;
+        for (auto* m : batch) {
+            m->ret = ret;
+        }
+        return;
+    }
+
+    std::vector<PendingMount*> added;
+    for (auto* m : batch) {
+        m->ret = CheckAndAddMountPoint(&wrapper, *m->mountpoint);
+        if (m->ret == FSStatusCode::OK) {
+            added.push_back(m);
+        }
+    }
+
+    if (added.empty()) {
+        return;
+    }
+
+    // for persistence consider, all mountpoints are persisted by one update
+    ret = fsStorage_->Update(wrapper);
+    if (ret != FSStatusCode::OK) {
+        LOG(WARNING) << "MountFs fail, update fs fail, fsName = " << fsName
+                     << ", mountpoints = " << added.size()
+                     << ", errCode = " << FSStatusCode_Name(ret);
+        for (auto* m : added) {
+            m->ret = ret;
+        }
+        return;
     }
 
+    VLOG(3) << "MountFs persist " << added.size()
+            << " mountpoints by one update, fsName = " << fsName;
+    for (auto* m : added) {
+        // update client alive time
+        UpdateClientAliveTime(*m->mountpoint, fsName, false);
+        FsMetric::GetInstance().OnMount(wrapper.GetFsName(), *m->mountpoint);
+        // convert fs info
+        *m->fsInfo = wrapper.ProtoFsInfo();
+    }
+}
+
+FSStatusCode FsManager::CheckAndAddMountPoint(FsInfoWrapper* wrapper,
+                                              const Mountpoint& mountpoint) {
+    const std::string fsName = wrapper->GetFsName();
+
     // check fs status
-    FsStatus status = wrapper.GetStatus();
+    FsStatus status = wrapper->GetStatus();
     switch (status) {
         case FsStatus::NEW:
             LOG(WARNING) << "MountFs fs is not inited, fsName = " << fsName;
@@ -637,17 +716,26 @@ FSStatusCode FsManager::MountFs(const std::string& fsName,
     }
 
     // mount point conflict
-    if (wrapper.IsMountPointConflict(mountpoint)) {
+    if (wrapper->IsMountPointConflict(mountpoint)) {
         LOG(WARNING) << "MountFs fail, mount point conflict, fsName = "
                      << fsName
                      << ", mountpoint = " << mountpoint.ShortDebugString();
         return FSStatusCode::MOUNT_POINT_CONFLICT;
     }
 
+    // the mountpoint holding the exclusive lease must flush all it deferred
+    // before another one can see the fs, the client retries the mount
+    if (RecallExclusiveLease(fsName, mountpoint)) {
+        LOG(INFO) << "MountFs wait exclusive lease recalled, fsName = "
+                  << fsName
+                  << ", mountpoint = " << mountpoint.ShortDebugString();
+        return FSStatusCode::EXCLUSIVE_LEASE_RECALLING;
+    }
+
     // If this is the first mountpoint, init space,
-    if (wrapper.GetFsType() == FSType::TYPE_VOLUME &&
-        wrapper.IsMountPointEmpty()) {
-        const auto& tempFsInfo = wrapper.ProtoFsInfo();
+    if (wrapper->GetFsType() == FSType::TYPE_VOLUME &&
+        wrapper->IsMountPointEmpty()) {
+        const auto& tempFsInfo = wrapper->ProtoFsInfo();
         auto ret = spaceManager_->AddVolume(tempFsInfo);
         if (ret != space::SpaceOk) {
             LOG(ERROR) << "MountFs fail, init space fail, fsName = " << fsName
@@ -658,22 +746,7 @@ FSStatusCode FsManager::MountFs(const std::string& fsName,
     }
 
     // insert mountpoint
-    wrapper.AddMountPoint(mountpoint);
-    // for persistence consider
-    ret = fsStorage_->Update(wrapper);
-    if (ret != FSStatusCode::OK) {
-        LOG(WARNING) << "MountFs fail, update fs fail, fsName = " << fsName
-                     << ", mountpoint = " << mountpoint.ShortDebugString()
-                     << ", errCode = " << FSStatusCode_Name(ret);
-        return ret;
-    }
-    // update client alive time
-    UpdateClientAliveTime(mountpoint, fsName, false);
-
-    // convert fs info
-    FsMetric::GetInstance().OnMount(wrapper.GetFsName(), mountpoint);
-    *fsInfo = std::move(wrapper).ProtoFsInfo();
-
+    wrapper->AddMountPoint(mountpoint);
     return FSStatusCode::OK;
 }
 
@@ -714,6 +787,7 @@ FSStatusCode FsManager::UmountFs(const std::string& fsName,
     std::string mountpath;
     MountPoint2Str(mountpoint, &mountpath);
     DeleteClientAliveTime(mountpath);
+    DeleteExclusiveLease(fsName, mountpath);
 
     // 3. if no mount point exist, release all block groups
     if (wrapper.GetFsType() == FSType::TYPE_VOLUME) {
@@ -975,6 +1049,12 @@ void FsManager::RefreshSession(const RefreshSessionRequest* request,
 
     response->set_enablesumindir(wrapper.ProtoFsInfo().enablesumindir());
 
+    if (request->wantexclusive() || request->holdexclusive()) {
+        response->set_exclusive(RefreshExclusiveLease(
+            request->fsname(), request->mountpoint(), request->wantexclusive(),
+            request->holdexclusive()));
+    }
+
     // collect fs delta reported by client
     if (request->has_fsdelta()) {
         const auto& delta = request->fsdelta();
@@ -1217,7 +1297,9 @@ FSStatusCode FsManager::AddMountPoint(const Mountpoint& mountpoint,
         return ret;
     }
 
-    // 2. insert mountpoint
+    // 2. insert mountpoint, the restored client can't wait the exclusive
+    // lease recalled, but the holder still need to flush
+    RecallExclusiveLease(fsName, mountpoint);
     wrapper.AddMountPoint(mountpoint);
     // for persistence consider
     ret = fsStorage_->Update(wrapper);
@@ -1231,6 +1313,89 @@ FSStatusCode FsManager::AddMountPoint(const Mountpoint& mountpoint,
     return FSStatusCode::OK;
 }
 
+bool FsManager::RefreshExclusiveLease(const std::string& fsName,
+                                      const Mountpoint& mountpoint,
+                                      bool want, bool hold) {
+    NameLockGuard lock(nameLock_, fsName);
+    std::string mountpath;
+    MountPoint2Str(mountpoint, &mountpath);
+
+    ::curve::common::LockGuard lg(exclusiveMutex_);
+    auto iter = exclusiveLeases_.find(fsName);
+    if (iter != exclusiveLeases_.end()) {
+        if (iter->second.mountpath != mountpath) {
+            return false;
+        } else if (hold) {
+            return !iter->second.recalling;
+        }
+
+        // the holder released the lease
+        bool recalling = iter->second.recalling;
+        exclusiveLeases_.erase(iter);
+        LOG(INFO) << "Exclusive lease released, fsName = " << fsName
+                  << ", mountpoint = " << mountpath;
+        if (recalling) {
+            return false;
+        }
+    }
+
+    if (!want) {
+        return false;
+    }
+
+    FsInfoWrapper wrapper;
+    FSStatusCode ret = fsStorage_->Get(fsName, &wrapper);
+    if (ret != FSStatusCode::OK) {
+        LOG(WARNING) << "RefreshExclusiveLease fail, get fs fail, fsName = "
+                     << fsName << ", errCode = " << FSStatusCode_Name(ret);
+        return false;
+    } else if (wrapper.MountPoints().size() != 1 ||
+               !wrapper.IsMountPointExist(mountpoint)) {
+        return false;
+    }
+
+    exclusiveLeases_[fsName] = ExclusiveLease{mountpath, false};
+    LOG(INFO) << "Exclusive lease granted, fsName = " << fsName
+              << ", mountpoint = " << mountpath;
+    return true;
+}
+
+bool FsManager::RecallExclusiveLease(const std::string& fsName,
+                                     const Mountpoint& mountpoint) {
+    std::string mountpath;
+    MountPoint2Str(mountpoint, &mountpath);
+
+    ::curve::common::LockGuard lg(exclusiveMutex_);
+    auto iter = exclusiveLeases_.find(fsName);
+    if (iter == exclusiveLeases_.end()) {
+        return false;
+    } else if (iter->second.mountpath == mountpath) {
+        // the holder mount again after restart, nothing deferred remains
+        exclusiveLeases_.erase(iter);
+        return false;
+    }
+
+    if (!iter->second.recalling) {
+        iter->second.recalling = true;
+        LOG(INFO) << "Exclusive lease recalling, fsName = " << fsName
+                  << ", holder = " << iter->second.mountpath
+                  << ", by mountpoint = " << mountpath;
+    }
+    return true;
+}
+
+void FsManager::DeleteExclusiveLease(const std::string& fsName,
+                                     const std::string& mountpath) {
+    ::curve::common::LockGuard lg(exclusiveMutex_);
+    auto iter = exclusiveLeases_.find(fsName);
+    if (iter != exclusiveLeases_.end() &&
+        iter->second.mountpath == mountpath) {
+        exclusiveLeases_.erase(iter);
+        LOG(INFO) << "Exclusive lease deleted, fsName = " << fsName
+                  << ", mountpoint = " << mountpath;
+    }
+}
+
 void FsManager::UpdateClientAliveTime(const Mountpoint& mountpoint,
     const std::string& fsName, bool addMountPoint) {
     VLOG(1) << "UpdateClientAliveTime fsName = " << fsName
@@ -23,10 +23,13 @@
 #ifndef CURVEFS_SRC_MDS_FS_MANAGER_H_
 #define CURVEFS_SRC_MDS_FS_MANAGER_H_
 
+#include <bthread/condition_variable.h>
+
 #include <atomic>
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <map>
 #include <utility>
@@ -256,6 +259,43 @@ class FsManager {
     FSStatusCode UpdateFsUsedBytes(
         const std::string& fsName, int64_t deltaBytes);
 
+    // grant, renew or release the exclusive lease of fs,
+    // return true if the mountpoint holds the lease after refresh
+    bool RefreshExclusiveLease(const std::string& fsName,
+                               const Mountpoint& mountpoint,
+                               bool want, bool hold);
+
+    // recall the exclusive lease held by another mountpoint,
+    // return true if the lease is still held and under recalling
+    bool RecallExclusiveLease(const std::string& fsName,
+                              const Mountpoint& mountpoint);
+
+    void DeleteExclusiveLease(const std::string& fsName,
+                              const std::string& mountpath);
+
+    // a mount request waiting to be handled with others of the same fs
+    struct PendingMount {
+        const Mountpoint* mountpoint;
+        FsInfo* fsInfo;
+        FSStatusCode ret = FSStatusCode::UNKNOWN_ERROR;
+        bool done = false;
+    };
+
+    struct MountQueue {
+        std::vector<PendingMount*> pending;
+        // whether one request is mounting a batch of the queue
+        bool leading = false;
+    };
+
+    // mount the requests of fs and persist them by one update,
+    // REQUIRES: the requests are taken from the fs's mount queue
+    void MountFsBatch(const std::string& fsName,
+                      const std::vector<PendingMount*>& batch);
+
+    // check the fs status and the mountpoint, then add it to fs
+    FSStatusCode CheckAndAddMountPoint(FsInfoWrapper* wrapper,
+                                       const Mountpoint& mountpoint);
+
  private:
     std::shared_ptr<FsStorage> fsStorage_;
     std::shared_ptr<SpaceManager> spaceManager_;
@@ -279,6 +319,21 @@ class FsManager {
     mutable RWLock recorderMutex_;
     // fsuage update lock
     mutable RWLock fsUsageMutex_;
+
+    // exclusive lease of fs, only the only mountpoint of fs can hold it
+    struct ExclusiveLease {
+        std::string mountpath;
+        bool recalling;
+    };
+    // <fsname, lease>
+    std::map<std::string, ExclusiveLease> exclusiveLeases_;
+    Mutex exclusiveMutex_;
+
+    // the concurrent mounts of the same fs are queued, and the first one
+    // mounts all queued ones on behalf of others, <fsname, queue>
+    std::unordered_map<std::string, MountQueue> mountQueues_;
+    Mutex mountQueueMutex_;
+    bthread::ConditionVariable mountQueueCond_;
 };
 }  // namespace mds
 }  // namespace curvefs
@@ -24,6 +24,8 @@
 
 #include <glog/logging.h>
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -215,17 +217,23 @@ void PersisKVStorage::Uninit() {}
 
 FSStatusCode PersisKVStorage::Get(const std::string& fsName,
                                   FsInfoWrapper* fsInfo) {
-    ReadLockGuard lock(fsLock_);
-    auto iter = fs_.find(fsName);
-    if (iter != fs_.end()) {
-        *fsInfo = iter->second;
-        return FSStatusCode::OK;
+    std::shared_ptr<const FsInfoWrapper> snapshot;
+    {
+        ReadLockGuard lock(fsLock_);
+        auto iter = fs_.find(fsName);
+        if (iter == fs_.end()) {
+            return FSStatusCode::NOT_FOUND;
+        }
+        snapshot = iter->second;
     }
 
-    return FSStatusCode::NOT_FOUND;
+    // copy outside the lock, the fs info with lots of mountpoints is big
+    *fsInfo = *snapshot;
+    return FSStatusCode::OK;
 }
 
 FSStatusCode PersisKVStorage::Insert(const FsInfoWrapper& fs) {
+    std::lock_guard<Mutex> updateLock(updateMutex_);
     WriteLockGuard idLock(idToNameLock_);
     WriteLockGuard fsLock(fsLock_);
 
@@ -242,26 +250,31 @@ FSStatusCode PersisKVStorage::Insert(const FsInfoWrapper& fs) {
     }
 
     // update cache
-    fs_.emplace(fs.GetFsName(), fs);
+    fs_.emplace(fs.GetFsName(), std::make_shared<const FsInfoWrapper>(fs));
     idToName_.emplace(fs.GetFsId(), fs.GetFsName());
 
     return FSStatusCode::OK;
 }
 
 FSStatusCode PersisKVStorage::Update(const FsInfoWrapper& fs) {
-    WriteLockGuard lock(fsLock_);
-    auto iter = fs_.find(fs.GetFsName());
-    if (iter == fs_.end()) {
-        LOG(ERROR) << "fsname not found, fsName: " << fs.GetFsName();
-        return FSStatusCode::NOT_FOUND;
-    }
+    // the updates are serialized by updateMutex_, so the cached fs info
+    // can be read while persisting it
+    std::lock_guard<Mutex> updateLock(updateMutex_);
+    {
+        ReadLockGuard lock(fsLock_);
+        auto iter = fs_.find(fs.GetFsName());
+        if (iter == fs_.end()) {
+            LOG(ERROR) << "fsname not found, fsName: " << fs.GetFsName();
+            return FSStatusCode::NOT_FOUND;
+        }
 
-    if (iter->second.GetFsId() != fs.GetFsId()) {
-        LOG(ERROR) << "fs id not match, fs id in cache: "
-                   << iter->second.GetFsId()
-                   << ", current fs id : " << fs.GetFsId()
-                   << ", fsName: " << fs.GetFsName();
-        return FSStatusCode::FS_ID_MISMATCH;
+        if (iter->second->GetFsId() != fs.GetFsId()) {
+            LOG(ERROR) << "fs id not match, fs id in cache: "
+                       << iter->second->GetFsId()
+                       << ", current fs id : " << fs.GetFsId()
+                       << ", fsName: " << fs.GetFsName();
+            return FSStatusCode::FS_ID_MISMATCH;
+        }
     }
 
     // update to storage
@@ -270,11 +283,14 @@ FSStatusCode PersisKVStorage::Update(const FsInfoWrapper& fs) {
         return FSStatusCode::STORAGE_ERROR;
     }
 
-    iter->second = fs;
+    auto snapshot = std::make_shared<const FsInfoWrapper>(fs);
+    WriteLockGuard lock(fsLock_);
+    fs_[fs.GetFsName()] = std::move(snapshot);
     return FSStatusCode::OK;
 }
 
 FSStatusCode PersisKVStorage::Delete(const std::string& fsName) {
+    std::lock_guard<Mutex> updateLock(updateMutex_);
     WriteLockGuard idLock(idToNameLock_);
     WriteLockGuard fsLock(fsLock_);
     auto iter = fs_.find(fsName);
@@ -283,18 +299,19 @@ FSStatusCode PersisKVStorage::Delete(const std::string& fsName) {
         return FSStatusCode::NOT_FOUND;
     }
 
-    if (!RemoveFromStorage(iter->second)) {
+    if (!RemoveFromStorage(*iter->second)) {
         LOG(ERROR) << "Remove fs from storage failed, fsName: " << fsName;
         return FSStatusCode::STORAGE_ERROR;
     }
 
-    idToName_.erase(iter->second.GetFsId());
+    idToName_.erase(iter->second->GetFsId());
     fs_.erase(iter);
     return FSStatusCode::OK;
 }
 
 FSStatusCode PersisKVStorage::Rename(const FsInfoWrapper& oldFs,
                                      const FsInfoWrapper& newFs) {
+    std::lock_guard<Mutex> updateLock(updateMutex_);
     WriteLockGuard idLock(idToNameLock_);
     WriteLockGuard fsLock(fsLock_);
     auto iter = fs_.find(oldFs.GetFsName());
@@ -303,9 +320,9 @@ FSStatusCode PersisKVStorage::Rename(const FsInfoWrapper& oldFs,
         return FSStatusCode::NOT_FOUND;
     }
 
-    if (iter->second.GetFsId() != oldFs.GetFsId()) {
+    if (iter->second->GetFsId() != oldFs.GetFsId()) {
         LOG(ERROR) << "fs id not match, fs id in cache: "
-                   << iter->second.GetFsId()
+                   << iter->second->GetFsId()
                    << ", old fs id : " << oldFs.GetFsId()
                    << ", old fsName: " << oldFs.GetFsName();
         return FSStatusCode::FS_ID_MISMATCH;
@@ -335,7 +352,8 @@ FSStatusCode PersisKVStorage::Rename(const FsInfoWrapper& oldFs,
     }
 
     fs_.erase(iter);
-    fs_.emplace(newFs.GetFsName(), newFs);
+    fs_.emplace(newFs.GetFsName(),
+                std::make_shared<const FsInfoWrapper>(newFs));
     idToName_[newFs.GetFsId()] = newFs.GetFsName();
     return FSStatusCode::OK;
 }
@@ -395,7 +413,9 @@ bool PersisKVStorage::LoadAllFs() {
             }
         }
 
-        fs_.emplace(fsInfo.fsname(), std::move(fsInfo));
+        auto name = fsInfo.fsname();
+        fs_.emplace(std::move(name),
+                    std::make_shared<const FsInfoWrapper>(std::move(fsInfo)));
 
         // load fs usage to cache
         FsUsage fsUsage;
@@ -500,9 +520,9 @@ bool PersisKVStorage::RenameFromStorage(const FsInfoWrapper& oldFs,
 }
 
 void PersisKVStorage::GetAll(std::vector<FsInfoWrapper>* fsInfoVec) {
-    ReadLockGuard lock(idToNameLock_);
+    ReadLockGuard lock(fsLock_);
     for (const auto& it : fs_) {
-        fsInfoVec->push_back(it.second);
+        fsInfoVec->push_back(*it.second);
     }
 }
 
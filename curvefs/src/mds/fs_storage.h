@@ -244,11 +244,15 @@ class PersisKVStorage : public FsStorage {
     // fs id generator
     std::unique_ptr<FsIdGenerator> idGen_;
 
+    // serialize the modifications, fs_ is only locked to switch the cache
+    // lock order: updateMutex_ => idToNameLock_ => fsLock_
+    Mutex updateMutex_;
+
     // protect fs_
     mutable RWLock fsLock_;
 
-    // from fs name to fs info
-    std::unordered_map<std::string, FsInfoWrapper> fs_;
+    // from fs name to fs info, which is never modified after cached
+    std::unordered_map<std::string, std::shared_ptr<const FsInfoWrapper>> fs_;
 
     // protect idToName
     mutable RWLock idToNameLock_;
@@ -24,6 +24,8 @@
 #include <glog/logging.h>
 #include <list>
 #include <set>
+#include <string>
+#include <unordered_map>
 #include <utility>
 #include "curvefs/src/mds/topology/deal_peerid.h"
 #include "src/common/string_util.h"
@@ -56,6 +58,7 @@ HeartbeatManager::HeartbeatManager(
 
     isStop_ = true;
     metaserverHealthyCheckerRunInter_ = option.heartbeatMissTimeOutMs;
+    partitionFullSyncIntervalMs_ = option.partitionFullSyncIntervalMs;
 }
 
 void HeartbeatManager::Init() {
@@ -136,11 +139,14 @@ void HeartbeatManager::UpdateMetaServerSpace(
 
 void HeartbeatManager::Coordinate(const MetaServerHeartbeatRequest &request,
                                   MetaServerHeartbeatResponse *response) {
+    // the copysets of one metaserver share a few peers, so resolve each
+    // peer from topology only once per heartbeat
+    std::unordered_map<std::string, MetaServerIdType> peerIds;
     for (auto &value : request.copysetinfos()) {
         // convert copysetInfo from heartbeat format to topology format
         ::curvefs::mds::topology::CopySetInfo reportCopySetInfo;
-        if (!TransformHeartbeatCopySetInfoToTopologyOne(value,
-                                                        &reportCopySetInfo)) {
+        if (!TransformHeartbeatCopySetInfoToTopologyOne(
+                value, &reportCopySetInfo, &peerIds)) {
             LOG(ERROR) << "heartbeatManager receive copyset(" << value.poolid()
                        << "," << value.copysetid()
                        << ") information, but can not transfer to topology one";
@@ -159,17 +165,18 @@ void HeartbeatManager::Coordinate(const MetaServerHeartbeatRequest &request,
             *res = conf;
         }
 
-        // convert partitionInfo from heartbeat format to topology format
-        std::list<::curvefs::mds::topology::Partition> partitionList;
-        for (int32_t i = 0; i < value.partitioninfolist_size(); i++) {
-            partitionList.emplace_back(value.partitioninfolist(i));
-        }
-
         // if a copyset is the leader, update (e.g. epoch) topology according
         // to its info
         if (request.metaserverid() == reportCopySetInfo.GetLeader()) {
             topoUpdater_->UpdateCopysetTopo(reportCopySetInfo);
-            if (!value.has_iscopysetloading() || !value.iscopysetloading()) {
+            if ((!value.has_iscopysetloading() || !value.iscopysetloading()) &&
+                NeedUpdatePartitionTopo(value)) {
+                // convert partitionInfo from heartbeat format to topology
+                // format
+                std::list<::curvefs::mds::topology::Partition> partitionList;
+                for (int32_t i = 0; i < value.partitioninfolist_size(); i++) {
+                    partitionList.emplace_back(value.partitioninfolist(i));
+                }
                 topoUpdater_->UpdatePartitionTopo(reportCopySetInfo.GetId(),
                                                   partitionList);
             }
@@ -177,6 +184,41 @@ void HeartbeatManager::Coordinate(const MetaServerHeartbeatRequest &request,
     }
 }
 
+bool HeartbeatManager::NeedUpdatePartitionTopo(
+    const ::curvefs::mds::heartbeat::CopySetInfo &info) {
+    if (partitionFullSyncIntervalMs_ == 0) {
+        return true;
+    }
+
+    // only the fields applied by TopoUpdater::UpdatePartitionTopo
+    std::string digest;
+    digest.reserve(info.partitioninfolist_size() * 5 * sizeof(uint64_t));
+    auto append = [&digest](uint64_t v) {
+        digest.append(reinterpret_cast<const char *>(&v), sizeof(v));
+    };
+    for (const auto &partition : info.partitioninfolist()) {
+        append(partition.partitionid());
+        append(partition.status());
+        append(partition.inodenum());
+        append(partition.dentrynum());
+        append(partition.nextid());
+    }
+
+    auto now = steady_clock::now();
+    CopySetKey key(info.poolid(), info.copysetid());
+    std::lock_guard<Mutex> lk(partitionReportsMutex_);
+    auto it = partitionReports_.find(key);
+    if (it != partitionReports_.end() && it->second.digest == digest &&
+        now - it->second.syncTime <
+            std::chrono::milliseconds(partitionFullSyncIntervalMs_)) {
+        return false;
+    }
+    auto &report = partitionReports_[key];
+    report.digest = std::move(digest);
+    report.syncTime = now;
+    return true;
+}
+
 void HeartbeatManager::UpdateDeallocatableBlockGroup(
     const MetaServerHeartbeatRequest &request,
     MetaServerHeartbeatResponse *response) {
@@ -253,7 +295,8 @@ HeartbeatStatusCode HeartbeatManager::CheckRequest(
 
 bool HeartbeatManager::TransformHeartbeatCopySetInfoToTopologyOne(
     const ::curvefs::mds::heartbeat::CopySetInfo &info,
-    ::curvefs::mds::topology::CopySetInfo *out) {
+    ::curvefs::mds::topology::CopySetInfo *out,
+    std::unordered_map<std::string, MetaServerIdType> *peerIds) {
     ::curvefs::mds::topology::CopySetInfo topoCopysetInfo(
         static_cast<PoolIdType>(info.poolid()), info.copysetid());
     // set epoch
@@ -262,8 +305,22 @@ bool HeartbeatManager::TransformHeartbeatCopySetInfoToTopologyOne(
     // set peers
     std::set<MetaServerIdType> peers;
     MetaServerIdType leader = UNINITIALIZE_ID;
+    auto getMetaServerId = [&](const std::string &peer) {
+        if (peerIds == nullptr) {
+            return GetMetaserverIdByPeerStr(peer);
+        }
+        auto it = peerIds->find(peer);
+        if (it != peerIds->end()) {
+            return it->second;
+        }
+        MetaServerIdType id = GetMetaserverIdByPeerStr(peer);
+        if (id != UNINITIALIZE_ID) {
+            peerIds->emplace(peer, id);
+        }
+        return id;
+    };
     for (const auto& value : info.peers()) {
-        MetaServerIdType res = GetMetaserverIdByPeerStr(value.address());
+        MetaServerIdType res = getMetaServerId(value.address());
         if (UNINITIALIZE_ID == res) {
             LOG(ERROR) << "heartbeat manager can not get metaServerInfo"
                           " according to report ipPort: "
@@ -289,7 +346,7 @@ bool HeartbeatManager::TransformHeartbeatCopySetInfoToTopologyOne(
     // set info of configuration changes
     if (info.configchangeinfo().IsInitialized()) {
         MetaServerIdType res =
-            GetMetaserverIdByPeerStr(info.configchangeinfo().peer().address());
+            getMetaServerId(info.configchangeinfo().peer().address());
         if (res == UNINITIALIZE_ID) {
             LOG(ERROR) << "heartbeat manager can not get metaInfo"
                        "according to report candidate ipPort: "
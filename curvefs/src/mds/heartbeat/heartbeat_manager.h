@@ -27,6 +27,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "curvefs/proto/heartbeat.pb.h"
@@ -42,6 +43,7 @@
 
 using ::curvefs::mds::topology::PoolIdType;
 using ::curvefs::mds::topology::CopySetIdType;
+using ::curvefs::mds::topology::CopySetKey;
 using ::curvefs::mds::topology::Topology;
 using ::curvefs::mds::schedule::Coordinator;
 using ::curvefs::mds::space::SpaceManager;
@@ -129,7 +131,8 @@ class HeartbeatManager {
      */
     bool TransformHeartbeatCopySetInfoToTopologyOne(
         const ::curvefs::mds::heartbeat::CopySetInfo &info,
-        ::curvefs::mds::topology::CopySetInfo *out);
+        ::curvefs::mds::topology::CopySetInfo *out,
+        std::unordered_map<std::string, MetaServerIdType> *peerIds = nullptr);
 
     /**
      * @brief Extract ip address and port number from string, and fetch
@@ -147,6 +150,14 @@ class HeartbeatManager {
     void Coordinate(const MetaServerHeartbeatRequest &request,
                     MetaServerHeartbeatResponse *response);
 
+    /**
+     * @brief Check whether the partitions reported by a copyset leader
+     *        need to be applied to topology, it's true when they are
+     *        different from the last applied ones or a full sync is due
+     */
+    bool NeedUpdatePartitionTopo(
+        const ::curvefs::mds::heartbeat::CopySetInfo &info);
+
     void
     UpdateDeallocatableBlockGroup(const MetaServerHeartbeatRequest &request,
                                   MetaServerHeartbeatResponse *response);
@@ -171,6 +182,15 @@ class HeartbeatManager {
     Atomic<bool> isStop_;
     InterruptibleSleeper sleeper_;
     int metaserverHealthyCheckerRunInter_;
+
+    // the partition report last applied to topology of a copyset
+    struct PartitionReport {
+        std::string digest;
+        steady_clock::time_point syncTime;
+    };
+    uint64_t partitionFullSyncIntervalMs_;
+    Mutex partitionReportsMutex_;
+    std::map<CopySetKey, PartitionReport> partitionReports_;
 };
 
 }  // namespace heartbeat
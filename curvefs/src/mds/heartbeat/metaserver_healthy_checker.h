@@ -62,6 +62,7 @@ struct HeartbeatOption {
           heartbeatMissTimeOutMs(option.heartbeatMissTimeOutMs),
           offLineTimeOutMs(option.offLineTimeOutMs),
           cleanFollowerAfterMs(option.cleanFollowerAfterMs),
+          partitionFullSyncIntervalMs(option.partitionFullSyncIntervalMs),
           mdsStartTime(option.mdsStartTime) {
         FLAGS_heartbeat_offlineTimeoutMs = offLineTimeOutMs;
         FLAGS_heartbeat_missTimeoutMs = heartbeatMissTimeOutMs;
@@ -86,6 +87,11 @@ struct HeartbeatOption {
     // starting mds for this peroid of time
     uint64_t cleanFollowerAfterMs;
 
+    // the partitions reported by copyset leader are applied to topology
+    // only when they changed, and at least once in this peroid.
+    // 0 means applying every report
+    uint64_t partitionFullSyncIntervalMs = 0;
+
     // the time when the mds start (fetch from system)
     steady_clock::time_point mdsStartTime;
 };
@@ -428,6 +428,13 @@ void MDS::InitHeartbeatOption(HeartbeatOption* heartbeatOption) {
                                &heartbeatOption->offLineTimeOutMs);
     conf_->GetValueFatalIfFail("mds.heartbeat.clean_follower_afterMs",
                                &heartbeatOption->cleanFollowerAfterMs);
+    LOG_IF(ERROR,
+           !conf_->GetUInt64Value(
+               "mds.heartbeat.partitionFullSyncIntervalMs",
+               &heartbeatOption->partitionFullSyncIntervalMs))
+        << "Get `mds.heartbeat.partitionFullSyncIntervalMs` from conf error, "
+           "use default value: "
+        << heartbeatOption->partitionFullSyncIntervalMs;
 }
 
 void MDS::InitHeartbeatManager() {
@@ -785,10 +785,21 @@ TopologyImpl::GetPartitionInfosInPool(PoolIdType poolId,
 std::list<Partition>
 TopologyImpl::GetPartitionInfosInCopyset(CopySetIdType copysetId) const {
     std::list<Partition> ret;
+    // called for every copyset reported by heartbeat, so look up the
+    // partitions recorded in the copysets instead of scanning all of them
+    ReadLockGuard rlockPool(poolMutex_);
+    ReadLockGuard rlockCopySet(copySetMutex_);
     ReadLockGuard rlockPartitionMap(partitionMutex_);
-    for (auto it = partitionMap_.begin(); it != partitionMap_.end(); it++) {
-        if (it->second.GetCopySetId() == copysetId) {
-            ret.push_back(it->second);
+    for (const auto &pool : poolMap_) {
+        auto cs = copySetMap_.find(CopySetKey(pool.first, copysetId));
+        if (cs == copySetMap_.end()) {
+            continue;
+        }
+        for (auto id : cs->second.GetPartitionIds()) {
+            auto it = partitionMap_.find(id);
+            if (it != partitionMap_.end()) {
+                ret.push_back(it->second);
+            }
         }
     }
     return ret;
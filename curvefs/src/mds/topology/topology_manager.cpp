@@ -28,6 +28,7 @@
 #include <algorithm>
 #include <chrono>  //NOLINT
 #include <list>
+#include <map>
 #include <set>
 #include <string>
 #include <thread>  //NOLINT
@@ -726,9 +727,17 @@ void TopologyManager::CreatePartitions(const CreatePartitionRequest *request,
             return;
         }
 
-        // sort copysetVec by partition num desent
+        // place the partitions on the least loaded copysets, which is
+        // measured by the inodes and dentries reported by heartbeat, and
+        // then by the partition num
+        std::map<CopySetKey, uint64_t> load = GetCopysetItemNum(copysetVec);
         std::sort(copysetVec.begin(), copysetVec.end(),
-                  [](const CopySetInfo &a, const CopySetInfo &b) {
+                  [&load](const CopySetInfo &a, const CopySetInfo &b) {
+                      uint64_t loadA = load[a.GetCopySetKey()];
+                      uint64_t loadB = load[b.GetCopySetKey()];
+                      if (loadA != loadB) {
+                          return loadA < loadB;
+                      }
                       return a.GetPartitionNum() < b.GetPartitionNum();
                   });
 
@@ -751,6 +760,30 @@ void TopologyManager::CreatePartitions(const CreatePartitionRequest *request,
     }
 }
 
+std::map<CopySetKey, uint64_t> TopologyManager::GetCopysetItemNum(
+    const std::vector<CopySetInfo> &copysets) {
+    std::map<CopySetKey, uint64_t> itemNum;
+    std::set<PoolIdType> pools;
+    for (const auto &copyset : copysets) {
+        itemNum.emplace(copyset.GetCopySetKey(), 0);
+        pools.insert(copyset.GetPoolId());
+    }
+
+    for (auto poolId : pools) {
+        for (const auto &partition :
+             topology_->GetPartitionInfosInPool(poolId)) {
+            auto it = itemNum.find(
+                CopySetKey(partition.GetPoolId(), partition.GetCopySetId()));
+            if (it != itemNum.end()) {
+                it->second +=
+                    partition.GetInodeNum() + partition.GetDentryNum();
+            }
+        }
+    }
+
+    return itemNum;
+}
+
 TopoStatusCode TopologyManager::DeletePartition(uint32_t partitionId) {
     DeletePartitionRequest request;
     DeletePartitionResponse response;
@@ -23,6 +23,7 @@
 #ifndef CURVEFS_SRC_MDS_TOPOLOGY_TOPOLOGY_MANAGER_H_
 #define CURVEFS_SRC_MDS_TOPOLOGY_TOPOLOGY_MANAGER_H_
 
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -193,6 +194,10 @@ class TopologyManager {
                                             const CopySetInfo& copyset,
                                             PartitionInfo *info);
 
+    // get the inode and dentry num of the partitions in each copyset
+    std::map<CopySetKey, uint64_t> GetCopysetItemNum(
+        const std::vector<CopySetInfo>& copysets);
+
  private:
     std::shared_ptr<Topology> topology_;
     std::shared_ptr<MetaserverClient> metaserverClient_;
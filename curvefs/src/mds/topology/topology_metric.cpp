@@ -251,34 +251,29 @@ void TopologyMetricService::UpdateTopologyMetrics() {
 void TopologyMetricService::CalcMetaServerMetrics(
     const std::vector<CopySetInfo> &copysets,
     std::map<MetaServerIdType, MetaServerMetricInfo> *msMetricInfoMap) {
+    // aggregate in one pass over the copysets, instead of going through
+    // all of them for every metaserver
+    std::map<MetaServerIdType, std::set<MetaServerIdType>> scatterWidthMap;
     for (const auto &cs : copysets) {
-        for (const auto &msId : cs.GetCopySetMembers()) {
-            msMetricInfoMap->emplace(msId, MetaServerMetricInfo());
+        const std::set<MetaServerIdType> &csMbs = cs.GetCopySetMembers();
+        for (const auto &msId : csMbs) {
+            auto &info = (*msMetricInfoMap)[msId];
+            info.copysetNum++;
+            info.partitionNum += cs.GetPartitionNum();
+            scatterWidthMap[msId].insert(csMbs.begin(), csMbs.end());
         }
     }
-    for (auto &pair : *msMetricInfoMap) {
-        std::set<MetaServerIdType> scatterWidthCollector;
-        uint32_t leaderCount = 0;
-        uint32_t copysetCount = 0;
-        uint32_t partitionNum = 0;
-        for (const auto &cs : copysets) {
-            std::set<MetaServerIdType> csMbs = cs.GetCopySetMembers();
-            if (csMbs.count(pair.first) != 0) {
-                scatterWidthCollector.insert(csMbs.begin(), csMbs.end());
-                copysetCount++;
-                partitionNum += cs.GetPartitionNum();
-            }
-            if (cs.GetLeader() == pair.first) {
-                leaderCount++;
-            }
+    for (const auto &cs : copysets) {
+        auto it = msMetricInfoMap->find(cs.GetLeader());
+        if (it != msMetricInfoMap->end()) {
+            it->second.leaderNum++;
         }
+    }
+    for (auto &pair : *msMetricInfoMap) {
         // scatterWidth - 1 because the metaserver that collect the data of
         // replica number should not be considered according to the definition
         // of scatter width.
-        pair.second.scatterWidth = scatterWidthCollector.size() - 1;
-        pair.second.copysetNum = copysetCount;
-        pair.second.leaderNum = leaderCount;
-        pair.second.partitionNum = partitionNum;
+        pair.second.scatterWidth = scatterWidthMap[pair.first].size() - 1;
     }
 }
 
@@ -24,6 +24,8 @@
 #include "curvefs/src/metaserver/copyset/concurrent_apply_queue.h"
 
 #include <algorithm>
+#include <mutex>  // NOLINT
+#include <vector>
 
 namespace curvefs {
 namespace metaserver {
@@ -65,6 +67,8 @@ bool ApplyQueue::CheckOptAndInit(const ApplyOption &opt) {
 
     wconcurrentsize_ = opt.wconcurrentsize;
     wqueuedepth_ = opt.wqueuedepth;
+    // tasks in queue and the running one of every worker
+    wcapacity_ = static_cast<size_t>(wconcurrentsize_) * (wqueuedepth_ + 1);
     rconcurrentsize_ = opt.rconcurrentsize;
     rqueuedepth_ = opt.rqueuedepth;
 
@@ -73,6 +77,13 @@ bool ApplyQueue::CheckOptAndInit(const ApplyOption &opt) {
 
 void ApplyQueue::InitThreadPool(
     ThreadPoolType type, int concurrent, int depth) {
+    if (type == ThreadPoolType::WRITE) {
+        for (int i = 0; i < concurrent; i++) {
+            wthreads_.emplace_back(&ApplyQueue::RunWrite, this);
+        }
+        return;
+    }
+
     for (int i = 0; i < concurrent; i++) {
         auto asyncth = new (std::nothrow) TaskThread(depth);
         CHECK(asyncth != nullptr) << "allocate failed!";
@@ -83,7 +94,6 @@ void ApplyQueue::InitThreadPool(
             break;
 
         case ThreadPoolType::WRITE:
-            wapplyMap_.insert(std::make_pair(i, asyncth));
             break;
         }
     }
@@ -96,8 +106,6 @@ void ApplyQueue::InitThreadPool(
             break;
 
         case ThreadPoolType::WRITE:
-            wapplyMap_[i]->th =
-                    std::thread(&ApplyQueue::Run, this, type, i);
             break;
         }
     }
@@ -105,16 +113,87 @@ void ApplyQueue::InitThreadPool(
 
 void ApplyQueue::Run(ThreadPoolType type, int index) {
     cond_.Signal();
+    TaskThread* taskThread = nullptr;
+    switch (type) {
+    case ThreadPoolType::READ:
+        taskThread = rapplyMap_[index];
+        break;
+
+    case ThreadPoolType::WRITE:
+        return;
+    }
+
+    // drain all the available tasks in one wakeup
+    std::vector<TaskThread::Queue::Task> tasks;
+    const size_t maxBatch = taskThread->tq.Capacity();
     while (start_) {
-        switch (type) {
-        case ThreadPoolType::READ:
-            rapplyMap_[index]->tq.Pop()();
-            break;
+        taskThread->tq.PopBatch(&tasks, maxBatch);
+        for (auto& task : tasks) {
+            task();
+        }
+        tasks.clear();
+    }
+}
 
-        case ThreadPoolType::WRITE:
-            wapplyMap_[index]->tq.Pop()();
+void ApplyQueue::PushWrite(uint64_t key, Task task) {
+    std::unique_lock<bthread::Mutex> lk(wmtx_);
+    while (wunfinished_.size() >= wcapacity_) {
+        wnotFull_.wait(lk);
+    }
+
+    uint64_t seq = wnextSeq_++;
+    wunfinished_.insert(seq);
+    auto iter = wpending_.find(key);
+    if (iter == wpending_.end()) {
+        wpending_[key].push_back(WriteTask{seq, std::move(task)});
+        wready_.push_back(key);
+        wnotEmpty_.notify_one();
+    } else {
+        // the key is already ready or running, its worker will pick it up
+        iter->second.push_back(WriteTask{seq, std::move(task)});
+    }
+}
+
+void ApplyQueue::RunWrite() {
+    cond_.Signal();
+    std::unique_lock<bthread::Mutex> lk(wmtx_);
+    while (true) {
+        while (wready_.empty() && start_) {
+            wnotEmpty_.wait(lk);
+        }
+        if (wready_.empty()) {  // stopped
             break;
         }
+
+        uint64_t key = wready_.front();
+        wready_.pop_front();
+        auto& tasks = wpending_[key];
+        WriteTask task = std::move(tasks.front());
+        tasks.pop_front();
+
+        lk.unlock();
+        task.task();
+        lk.lock();
+
+        auto iter = wpending_.find(key);
+        if (iter->second.empty()) {
+            wpending_.erase(iter);
+        } else {
+            wready_.push_back(key);
+            wnotEmpty_.notify_one();
+        }
+        wunfinished_.erase(task.seq);
+        wnotFull_.notify_one();
+        wfinished_.notify_all();
+    }
+}
+
+void ApplyQueue::FlushWrite() {
+    // wait the tasks pushed before, not the ones pushed meanwhile
+    std::unique_lock<bthread::Mutex> lk(wmtx_);
+    uint64_t last = wnextSeq_;
+    while (!wunfinished_.empty() && *wunfinished_.begin() < last) {
+        wfinished_.wait(lk);
     }
 }
 
@@ -132,12 +211,14 @@ void ApplyQueue::Stop() {
     }
     rapplyMap_.clear();
 
-    for (auto iter : wapplyMap_) {
-        iter.second->tq.Push(wakeup);
-        iter.second->th.join();
-        delete iter.second;
+    {
+        std::lock_guard<bthread::Mutex> lk(wmtx_);
+        wnotEmpty_.notify_all();
     }
-    wapplyMap_.clear();
+    for (auto& th : wthreads_) {
+        th.join();
+    }
+    wthreads_.clear();
 
     LOG(INFO) << "stop ApplyQueue ok.";
 }
@@ -147,16 +228,7 @@ void ApplyQueue::Flush() {
         return;
     }
 
-    CountDownEvent event(wconcurrentsize_);
-    auto flushtask = [&event]() {
-        event.Signal();
-    };
-
-    for (int i = 0; i < wconcurrentsize_; i++) {
-        wapplyMap_[i]->tq.Push(flushtask);
-    }
-
-    event.Wait();
+    FlushWrite();
 }
 
 void ApplyQueue::FlushAll() {
@@ -164,19 +236,16 @@ void ApplyQueue::FlushAll() {
         return;
     }
 
-    CountDownEvent event(wconcurrentsize_ + rconcurrentsize_);
+    CountDownEvent event(rconcurrentsize_);
     auto flushtask = [&event]() {
         event.Signal();
     };
 
-    for (int i = 0; i < wconcurrentsize_; i++) {
-        wapplyMap_[i]->tq.Push(flushtask);
-    }
-
     for (int i = 0; i < rconcurrentsize_; i++) {
         rapplyMap_[i]->tq.Push(flushtask);
     }
 
+    FlushWrite();
     event.Wait();
 }
 
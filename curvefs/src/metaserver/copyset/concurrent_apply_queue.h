@@ -28,13 +28,17 @@
 #include <glog/logging.h>
 
 #include <atomic>
+#include <deque>
+#include <functional>
+#include <set>
 #include <thread>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "include/curve_compiler_specific.h"
 #include "src/common/concurrent/count_down_event.h"
-#include "src/common/concurrent/task_queue.h"
+#include "src/common/concurrent/mpsc_task_queue.h"
 #include "curvefs/src/metaserver/copyset/operator_type.h"
 
 namespace curvefs {
@@ -42,7 +46,7 @@ namespace metaserver {
 namespace copyset {
 
 using curve::common::CountDownEvent;
-using curve::common::GenericTaskQueue;
+using curve::common::MPSCTaskQueue;
 
 struct ApplyOption {
     int wconcurrentsize = 3;
@@ -65,16 +69,23 @@ TODO: this moudle is same as curvebs's ConcurrentApplyModule,
       we can make ApplyQueue to a base class,
       and define Schedule with virtual function,
       derive class override Schedule.
+      unlike curvebs, write tasks are not hashed to a fixed worker,
+      a key (partition) is scheduled to any idle write worker while
+      keeping the order of its own tasks.
 */ 
 
 class CURVE_CACHELINE_ALIGNMENT ApplyQueue {
  public:
+    using Task = std::function<void()>;
+
     ApplyQueue(): start_(false),
                   rconcurrentsize_(0),
                   rqueuedepth_(0),
                   wconcurrentsize_(0),
                   wqueuedepth_(0),
-                  cond_(0) {}
+                  cond_(0),
+                  wcapacity_(0),
+                  wnextSeq_(0) {}
 
     /**
      * Init: initialize ApplyQueue
@@ -87,7 +98,10 @@ class CURVE_CACHELINE_ALIGNMENT ApplyQueue {
 
     /**
      * Push: apply task will be push to ApplyQueue
-     * @param[in] key: used to hash task to specified queue
+     * @param[in] key: used to hash read task to specified queue,
+     *                 write tasks of the same key (partition) are applied
+     *                 one by one in push order, and write tasks of
+     *                 different keys are applied by idle workers in parallel
      * @param[in] optype: operation type defined in proto
      * @param[in] f: task
      * @param[in] args: param to excute task
@@ -100,8 +114,8 @@ class CURVE_CACHELINE_ALIGNMENT ApplyQueue {
                         std::forward<F>(f), std::forward<Args>(args)...);
                 break;
             case ThreadPoolType::WRITE:
-                wapplyMap_[Hash(key, wconcurrentsize_)]->tq.Push(
-                        std::forward<F>(f), std::forward<Args>(args)...);
+                PushWrite(key, std::bind(std::forward<F>(f),
+                                         std::forward<Args>(args)...));
                 break;
         }
 
@@ -121,6 +135,12 @@ class CURVE_CACHELINE_ALIGNMENT ApplyQueue {
 
     void Run(ThreadPoolType type, int index);
 
+    void RunWrite();
+
+    void PushWrite(uint64_t key, Task task);
+
+    void FlushWrite();
+
     static ThreadPoolType Schedule(OperatorType optype);
 
     void InitThreadPool(ThreadPoolType type, int concorrent, int depth);
@@ -132,7 +152,9 @@ class CURVE_CACHELINE_ALIGNMENT ApplyQueue {
  private:
     struct TaskThread {
         std::thread th;
-        GenericTaskQueue<bthread::Mutex, bthread::ConditionVariable> tq;
+        using Queue =
+            MPSCTaskQueue<bthread::Mutex, bthread::ConditionVariable>;
+        Queue tq;
         explicit TaskThread(size_t capacity) : tq(capacity) {}
     };
 
@@ -142,8 +164,29 @@ class CURVE_CACHELINE_ALIGNMENT ApplyQueue {
     int wconcurrentsize_;
     int wqueuedepth_;
     CountDownEvent cond_;
-    CURVE_CACHELINE_ALIGNMENT std::unordered_map<int, TaskThread*> wapplyMap_;
     CURVE_CACHELINE_ALIGNMENT std::unordered_map<int, TaskThread*> rapplyMap_;
+
+    // write tasks, they are tracked by key instead of hashed to a fixed
+    // worker, so keys never wait behind another busy key with same hash
+    struct WriteTask {
+        uint64_t seq;
+        Task task;
+    };
+
+    CURVE_CACHELINE_ALIGNMENT bthread::Mutex wmtx_;
+    bthread::ConditionVariable wnotEmpty_;
+    bthread::ConditionVariable wnotFull_;
+    bthread::ConditionVariable wfinished_;
+    std::vector<std::thread> wthreads_;
+    // key => pending tasks, the key exists while it has a task pending
+    // or running
+    std::unordered_map<uint64_t, std::deque<WriteTask>> wpending_;
+    // keys which have pending tasks but none running
+    std::deque<uint64_t> wready_;
+    // sequences of the tasks pushed but not finished
+    std::set<uint64_t> wunfinished_;
+    size_t wcapacity_;
+    uint64_t wnextSeq_;
 };
 }   // namespace copyset
 }   // namespace metaserver
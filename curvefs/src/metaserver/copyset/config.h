@@ -55,6 +55,12 @@ struct CopysetNodeOptions {
     // Default: true
     bool enbaleLeaseRead;
 
+    // run the lease reads in current rpc thread instead of pushing them
+    // into the read apply queue, so the reads of one copyset are not
+    // serialized by the few read workers
+    // Default: true
+    bool inlineLeaseRead;
+
     // the number of concurrent recovery loads of copyset
     // Default: 1
     uint32_t loadConcurrency;
@@ -99,6 +105,7 @@ inline CopysetNodeOptions::CopysetNodeOptions()
       ip(),
       port(-1),
       enbaleLeaseRead(true),
+      inlineLeaseRead(true),
       loadConcurrency(1),
       checkRetryTimes(3),
       finishLoadMargin(2000),
@@ -133,6 +133,8 @@ class CopysetNode : public braft::StateMachine {
 
     ApplyQueue* GetApplyQueue() const;
 
+    bool IsInlineLeaseRead() const;
+
     OperatorMetric* GetMetric() const;
 
     const std::string& Name() const;
@@ -328,6 +330,10 @@ inline ApplyQueue* CopysetNode::GetApplyQueue() const {
     return applyQueue_.get();
 }
 
+inline bool CopysetNode::IsInlineLeaseRead() const {
+    return options_.inlineLeaseRead;
+}
+
 inline OperatorMetric* CopysetNode::GetMetric() const {
     return metric_.get();
 }
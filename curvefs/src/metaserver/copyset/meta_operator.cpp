@@ -24,6 +24,7 @@
 
 #include <brpc/closure_guard.h>
 #include <brpc/controller.h>
+#include <gflags/gflags.h>
 
 #include <algorithm>
 #include <memory>
@@ -34,12 +35,26 @@
 #include "curvefs/src/metaserver/copyset/meta_operator_closure.h"
 #include "curvefs/src/metaserver/copyset/raft_log_codec.h"
 #include "curvefs/src/metaserver/metastore.h"
+#include "curvefs/src/metaserver/storage/rocksdb_perf.h"
 #include "curvefs/src/metaserver/streaming_utils.h"
 #include "src/common/timeutility.h"
 
 static bvar::LatencyRecorder
     g_concurrent_fast_apply_wait_latency("concurrent_fast_apply_wait");
 
+static bool PassSlowUs(const char*, uint64_t) { return true; }
+DEFINE_uint64(meta_operator_slow_us, 0,
+              "trace the operators whose propose, wait in queue and execute "
+              "cost more than it, 0 means disabled");
+DEFINE_validator(meta_operator_slow_us, &PassSlowUs);
+
+static bool PassMaxInodeNum(const char*, uint64_t) { return true; }
+DEFINE_uint64(partition_max_inode_num, 0,
+              "reject creating inodes in the partition which has so many "
+              "inodes, so the client creates them in other partitions which "
+              "are placed on less loaded copysets, 0 means no limit");
+DEFINE_validator(partition_max_inode_num, &PassMaxInodeNum);
+
 
 namespace curvefs {
 namespace metaserver {
@@ -87,6 +102,12 @@ void MetaOperator::Propose() {
         // reuse `ProposeTask`, propose to raft
     }
 
+    auto code = PreCheck();
+    if (code != MetaStatusCode::OK) {
+        OnFailed(code);
+        return;
+    }
+
     // propose to raft
     if (ProposeTask()) {
         doneGuard.release();
@@ -118,6 +139,14 @@ bool MetaOperator::ProposeTask() {
 }
 
 void MetaOperator::FastApplyTask() {
+    // NOTE: the readonly operators only read metastore under its locks,
+    // so they are safe to run in current thread
+    if (node_->IsInlineLeaseRead()) {
+        OnApply(node_->GetAppliedIndex(), new MetaOperatorClosure(this),
+                TimeUtility::GetTimeofDayUs());
+        return;
+    }
+
     butil::Timer timer;
     timer.start();
     auto task =
@@ -129,6 +158,31 @@ void MetaOperator::FastApplyTask() {
     g_concurrent_fast_apply_wait_latency << timer.u_elapsed();
 }
 
+void MetaOperator::TraceApply(OperatorType type,
+                              const storage::RocksDBOpPerfScope& perfScope,
+                              uint64_t waitInQueueUs, uint64_t executeUs) {
+    storage::RocksDBPerfStats stats;
+    if (perfScope.Sampled()) {
+        perfScope.GetStats(&stats);
+        OperatorStorageMetric::GetInstance().OnSampled(type, stats);
+    }
+
+    // the propose timer is only started for the operators proposed by leader
+    uint64_t proposeUs = timerPropose.u_elapsed();
+    if (FLAGS_meta_operator_slow_us == 0 ||
+        proposeUs + waitInQueueUs + executeUs < FLAGS_meta_operator_slow_us) {
+        return;
+    }
+
+    LOG(WARNING) << "Slow operator, type: " << OperatorTypeName(type)
+                 << ", copyset: " << node_->Name()
+                 << ", propose: " << proposeUs << "us"
+                 << ", wait in queue: " << waitInQueueUs << "us"
+                 << ", execute: " << executeUs << "us"
+                 << (perfScope.Sampled() ? ", storage: " + stats.ToString()
+                                         : "");
+}
+
 #define OPERATOR_CAN_BY_PASS_PROPOSE(TYPE) \
     bool TYPE##Operator::CanBypassPropose() const { return true; }
 
@@ -150,11 +204,14 @@ OPERATOR_CAN_BY_PASS_PROPOSE(GetVolumeExtent);
         uint64_t timeUs = TimeUtility::GetTimeofDayUs();                     \
         node_->GetMetric()->WaitInQueueLatency(OperatorType::TYPE,           \
                                                timeUs - startTimeUs);        \
+        storage::RocksDBOpPerfScope perfScope;                               \
         auto status = node_->GetMetaStore()->TYPE(                           \
             static_cast<const TYPE##Request*>(request_),                     \
             static_cast<TYPE##Response*>(response_), index);                 \
         uint64_t executeTime = TimeUtility::GetTimeofDayUs() - timeUs;       \
         node_->GetMetric()->ExecuteLatency(OperatorType::TYPE, executeTime); \
+        TraceApply(OperatorType::TYPE, perfScope, timeUs - startTimeUs,      \
+                   executeTime);                                             \
         if (status == MetaStatusCode::OK) {                                  \
             node_->UpdateAppliedIndex(index);                                \
             static_cast<TYPE##Response*>(response_)->set_appliedindex(       \
@@ -294,8 +351,12 @@ void GetVolumeExtentOperator::OnApply(int64_t index,
     void TYPE##Operator::OnApplyFromLog(int64_t index, uint64_t startTimeUs) { \
         std::unique_ptr<TYPE##Operator> selfGuard(this);                       \
         TYPE##Response response;                                               \
+        uint64_t timeUs = TimeUtility::GetTimeofDayUs();                       \
+        storage::RocksDBOpPerfScope perfScope;                                 \
         auto status = node_->GetMetaStore()->TYPE(                             \
             static_cast<const TYPE##Request*>(request_), &response, index);    \
+        TraceApply(OperatorType::TYPE, perfScope, timeUs - startTimeUs,        \
+                   TimeUtility::GetTimeofDayUs() - timeUs);                    \
         node_->GetMetric()->OnOperatorCompleteFromLog(                         \
             OperatorType::TYPE, TimeUtility::GetTimeofDayUs() - startTimeUs,   \
             status == MetaStatusCode::OK);                                     \
@@ -469,6 +530,26 @@ OPERATOR_TYPE(UpdateDeallocatableBlockGroup);
 
 #undef OPERATOR_TYPE
 
+MetaStatusCode CreateInodeOperator::PreCheck() const {
+    if (FLAGS_partition_max_inode_num == 0) {
+        return MetaStatusCode::OK;
+    }
+
+    // the partition is full just like its inode id range is used up, the
+    // inode num only grows by applying logs, so it's a soft limit
+    const auto* request = static_cast<const CreateInodeRequest*>(request_);
+    uint64_t inodeNum = 0;
+    if (node_->GetMetaStore()->GetPartitionInodeNum(request->partitionid(),
+                                                    &inodeNum) &&
+        inodeNum >= FLAGS_partition_max_inode_num) {
+        VLOG(3) << "Partition " << request->partitionid() << " has "
+                << inodeNum << " inodes, reject creating inode";
+        return MetaStatusCode::PARTITION_ALLOC_ID_FAIL;
+    }
+
+    return MetaStatusCode::OK;
+}
+
 }  // namespace copyset
 }  // namespace metaserver
 }  // namespace curvefs
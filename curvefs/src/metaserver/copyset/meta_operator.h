@@ -33,6 +33,11 @@
 
 namespace curvefs {
 namespace metaserver {
+
+namespace storage {
+class RocksDBOpPerfScope;
+}  // namespace storage
+
 namespace copyset {
 
 class MetaOperator {
@@ -134,6 +139,22 @@ class MetaOperator {
      */
     virtual bool CanBypassPropose() const { return false; }
 
+    /**
+     * @brief Check the request on leader before proposing it, followers
+     *        never run it, so it can only reject the request and must not
+     *        change the state machine
+     */
+    virtual MetaStatusCode PreCheck() const { return MetaStatusCode::OK; }
+
+ protected:
+    /**
+     * @brief Report the sampled storage perf context of current operator,
+     *        and trace it if it's slow
+     */
+    void TraceApply(OperatorType type,
+                    const storage::RocksDBOpPerfScope& perfScope,
+                    uint64_t waitInQueueUs, uint64_t executeUs);
+
  protected:
     CopysetNode* node_;
 
@@ -316,6 +337,8 @@ class CreateInodeOperator : public MetaOperator {
     void Redirect() override;
 
     void OnFailed(MetaStatusCode code) override;
+
+    MetaStatusCode PreCheck() const override;
 };
 
 class UpdateInodeOperator : public MetaOperator {
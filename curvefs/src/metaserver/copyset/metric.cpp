@@ -23,6 +23,7 @@
 #include "curvefs/src/metaserver/copyset/metric.h"
 
 #include "absl/memory/memory.h"
+#include "curvefs/src/metaserver/storage/rocksdb_perf.h"
 
 namespace curvefs {
 namespace metaserver {
@@ -89,6 +90,45 @@ void OperatorMetric::NewArrival(OperatorType type) {
     }
 }
 
+OperatorStorageMetric::OpMetric::OpMetric(const std::string& prefix)
+    : sampled(prefix, "_sampled"),
+      blockCacheHit(prefix, "_block_cache_hit"),
+      blockRead(prefix, "_block_read"),
+      blockReadBytes(prefix, "_block_read_bytes"),
+      readBytes(prefix, "_read_bytes"),
+      seek(prefix, "_seek"),
+      blockCacheHitRatio(prefix, "_block_cache_hit_ratio",
+                         &OpMetric::GetBlockCacheHitRatio, this) {}
+
+double OperatorStorageMetric::OpMetric::GetBlockCacheHitRatio(void* arg) {
+    auto* metric = static_cast<OpMetric*>(arg);
+    uint64_t hit = metric->blockCacheHit.get_value();
+    uint64_t total = hit + metric->blockRead.get_value();
+    return total == 0 ? 0 : static_cast<double>(hit) / total;
+}
+
+OperatorStorageMetric::OperatorStorageMetric() {
+    const std::string prefix = "op_storage_";
+    for (uint32_t i = 0; i < kTotalOperatorNum; ++i) {
+        opMetrics_[i] = absl::make_unique<OpMetric>(
+            prefix + OperatorTypeName(static_cast<OperatorType>(i)));
+    }
+}
+
+void OperatorStorageMetric::OnSampled(OperatorType type,
+                                      const storage::RocksDBPerfStats& stats) {
+    auto index = static_cast<uint32_t>(type);
+    if (index < kTotalOperatorNum) {
+        auto& metric = opMetrics_[index];
+        metric->sampled << 1;
+        metric->blockCacheHit << stats.blockCacheHitCount;
+        metric->blockRead << stats.blockReadCount;
+        metric->blockReadBytes << stats.blockReadBytes;
+        metric->readBytes << stats.readBytes;
+        metric->seek << stats.seekCount;
+    }
+}
+
 }  // namespace copyset
 }  // namespace metaserver
 }  // namespace curvefs
@@ -37,6 +37,11 @@
 
 namespace curvefs {
 namespace metaserver {
+
+namespace storage {
+struct RocksDBPerfStats;
+}  // namespace storage
+
 namespace copyset {
 
 // Metric for each copyset to statistic operators apply latency/qps/eps/...
@@ -98,6 +103,44 @@ class OperatorMetric {
     std::array<std::unique_ptr<OpMetric>, kTotalOperatorNum> opMetricsFromLog_;
 };
 
+// Metric of the sampled rocksdb perf context for each operator type
+class OperatorStorageMetric {
+ public:
+    static OperatorStorageMetric& GetInstance() {
+        static OperatorStorageMetric instance;
+        return instance;
+    }
+
+    OperatorStorageMetric(const OperatorStorageMetric&) = delete;
+    OperatorStorageMetric& operator=(const OperatorStorageMetric&) = delete;
+
+    void OnSampled(OperatorType type, const storage::RocksDBPerfStats& stats);
+
+ private:
+    OperatorStorageMetric();
+
+    struct OpMetric {
+        explicit OpMetric(const std::string& prefix);
+
+        static double GetBlockCacheHitRatio(void* arg);
+
+        // sampled operators
+        bvar::Adder<uint64_t> sampled;
+        bvar::Adder<uint64_t> blockCacheHit;
+        bvar::Adder<uint64_t> blockRead;
+        bvar::Adder<uint64_t> blockReadBytes;
+        bvar::Adder<uint64_t> readBytes;
+        bvar::Adder<uint64_t> seek;
+        bvar::PassiveStatus<double> blockCacheHitRatio;
+    };
+
+ private:
+    static constexpr uint32_t kTotalOperatorNum =
+        static_cast<uint32_t>(OperatorType::OperatorTypeMax);
+
+    std::array<std::unique_ptr<OpMetric>, kTotalOperatorNum> opMetrics_;
+};
+
 // Metric for statictic raft snapshot latency/error count/...
 class RaftSnapshotMetric {
  public:
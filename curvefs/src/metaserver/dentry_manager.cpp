@@ -125,11 +125,12 @@ void DentryManager::ClearDentry() {
 }
 
 MetaStatusCode DentryManager::HandleRenameTx(const std::vector<Dentry>& dentrys,
-                                             int64_t logIndex) {
+                                             int64_t logIndex,
+                                             bool* committed) {
     for (const auto& dentry : dentrys) {
         Log4Dentry("HandleRenameTx", dentry);
     }
-    auto rc = txManager_->HandleRenameTx(dentrys, logIndex);
+    auto rc = txManager_->HandleRenameTx(dentrys, logIndex, committed);
     Log4Code("HandleRenameTx", rc);
     return rc;
 }
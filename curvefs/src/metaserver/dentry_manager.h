@@ -59,7 +59,8 @@ class DentryManager {
     void ClearDentry();
 
     MetaStatusCode HandleRenameTx(const std::vector<Dentry>& dentrys,
-                                  int64_t logIndex);
+                                  int64_t logIndex,
+                                  bool* committed = nullptr);
 
  private:
     void Log4Dentry(const std::string& request, const Dentry& dentry);
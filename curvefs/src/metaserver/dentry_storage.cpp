@@ -125,15 +125,19 @@ DentryList::DentryList(std::vector<Dentry>* list, uint32_t limit,
       onlyDir_(onlyDir) {}
 
 void DentryList::PushBack(DentryVec* vec) {
-    // NOTE: it's a cheap operation becacuse the size of
-    // dentryVec must less than 2
-    BTree dentrys;
-    DentryVector vector(vec);
-    vector.Filter(maxTxId_, &dentrys);
-    auto last = dentrys.rbegin();
+    // NOTE: pick the latest visible version by a linear scan instead of
+    // sorting them, the size of dentryVec must less than 2 and listing
+    // a big directory should not allocate for every entry
+    const Dentry* last = nullptr;
+    for (const Dentry& dentry : vec->dentrys()) {
+        if (dentry.txid() <= maxTxId_ &&
+            (last == nullptr || last->txid() < dentry.txid())) {
+            last = &dentry;
+        }
+    }
     if (IsFull()) {
         return;
-    } else if (dentrys.size() == 0 || HasDeleteMarkFlag(*last)) {
+    } else if (last == nullptr || HasDeleteMarkFlag(*last)) {
         return;
     } else if (last->name() == exclude_) {
         return;
@@ -645,9 +649,9 @@ MetaStatusCode DentryStorage::List(const Dentry& dentry,
     Key4Dentry key(fsId, parentInodeId, name);
     std::string lower = conv_.SerializeToString(key);  // "1:1:", "1:1:/a/b/c"
 
-    // 3. iterator key/value pair one by one
-    auto iterator = kvStorage_->SSeek(table4Dentry_, lower);
-    iterator->DisablePrefixChecking();
+    // 3. iterator key/value pair one by one, the iterator starts from
+    //    the lower key and never goes beyond the directory
+    auto iterator = kvStorage_->SSeekFrom(table4Dentry_, sprefix, lower);
     if (iterator->Status() < 0) {
         return MetaStatusCode::STORAGE_INTERNAL_ERROR;
     }
@@ -659,9 +663,7 @@ MetaStatusCode DentryStorage::List(const Dentry& dentry,
     time.start();
     for (iterator->SeekToFirst(); iterator->Valid(); iterator->Next()) {
         seekTimes++;
-        std::string skey = iterator->Key();
-        std::string svalue = iterator->Value();
-        if (!StringStartWith(skey, sprefix)) {
+        if (!StringStartWith(iterator->Key(), sprefix)) {
             break;
         } else if (!iterator->ParseFromValue(&current)) {
             return MetaStatusCode::PARSE_FROM_STRING_FAILED;
@@ -891,6 +893,106 @@ MetaStatusCode DentryStorage::RollbackTx(const std::vector<Dentry>& dentrys,
     return MetaStatusCode::STORAGE_INTERNAL_ERROR;
 }
 
+MetaStatusCode DentryStorage::Rename(const Dentry& src, const Dentry& dst,
+                                     int64_t logIndex) {
+    WriteLockGuard lg(rwLock_);
+
+    Status s;
+    const char* step = "Begin transaction";
+    std::shared_ptr<storage::StorageTransaction> txn;
+    do {
+        txn = kvStorage_->BeginTransaction();
+        if (txn == nullptr) {
+            break;
+        }
+        uint64_t count = nDentry_;
+        s = SetAppliedIndex(txn.get(), logIndex);
+        if (!s.ok()) {
+            step = "Insert applied index to transaction";
+            break;
+        }
+
+        Dentry srcOut;
+        DentryVec srcVec;
+        MetaStatusCode rc = Find(txn.get(), src, &srcOut, &srcVec, &count);
+        if (rc == MetaStatusCode::NOT_FOUND) {
+            // NOTE: the log entry may be applied already, the rename is
+            // done if the destination links to the same inode
+            Dentry dstOut;
+            DentryVec dstVec;
+            rc = Find(txn.get(), dst, &dstOut, &dstVec, &count);
+            if (rc != MetaStatusCode::OK && rc != MetaStatusCode::NOT_FOUND) {
+                step = "Find destination dentry";
+                break;
+            }
+            s = txn->Commit();
+            if (!s.ok()) {
+                step = "Commit transaction";
+                break;
+            }
+            nDentry_ = count;
+            if (rc == MetaStatusCode::OK && BelongSomeOne(dstOut, dst)) {
+                return MetaStatusCode::IDEMPOTENCE_OK;
+            }
+            return MetaStatusCode::NOT_FOUND;
+        } else if (rc != MetaStatusCode::OK) {
+            step = "Find source dentry";
+            break;
+        }
+
+        DentryVector srcVector(&srcVec);
+        srcVector.Delete(srcOut);
+        std::string skey = DentryKey(src);
+        if (srcVec.dentrys_size() == 0) {
+            s = txn->SDel(table4Dentry_, skey);
+        } else {
+            s = txn->SSet(table4Dentry_, skey, srcVec);
+        }
+        if (!s.ok()) {
+            step = "Delete source dentry from transaction";
+            break;
+        }
+        srcVector.Confirm(&count);
+
+        Dentry dstOut;
+        DentryVec dstVec;
+        rc = Find(txn.get(), dst, &dstOut, &dstVec, &count);
+        if (rc != MetaStatusCode::OK && rc != MetaStatusCode::NOT_FOUND) {
+            step = "Find destination dentry";
+            break;
+        }
+        DentryVector dstVector(&dstVec);
+        if (rc == MetaStatusCode::OK) {
+            dstVector.Delete(dstOut);
+        }
+        dstVector.Insert(dst);
+        s = txn->SSet(table4Dentry_, DentryKey(dst), dstVec);
+        if (!s.ok()) {
+            step = "Insert destination dentry to transaction";
+            break;
+        }
+        dstVector.Confirm(&count);
+
+        s = SetDentryCount(txn.get(), count);
+        if (!s.ok()) {
+            step = "Insert dentry count to transaction";
+            break;
+        }
+        s = txn->Commit();
+        if (!s.ok()) {
+            step = "Commit transaction";
+            break;
+        }
+        nDentry_ = count;
+        return MetaStatusCode::OK;
+    } while (false);
+    LOG(ERROR) << step << " failed, status = " << s.ToString();
+    if (txn != nullptr && !txn->Rollback().ok()) {
+        LOG(ERROR) << "Rollback transaction failed";
+    }
+    return MetaStatusCode::STORAGE_INTERNAL_ERROR;
+}
+
 std::shared_ptr<Iterator> DentryStorage::GetAll() {
     ReadLockGuard lg(rwLock_);
     return kvStorage_->SGetAll(table4Dentry_);
@@ -126,6 +126,12 @@ class DentryStorage {
     MetaStatusCode RollbackTx(const std::vector<Dentry>& dentrys,
                               int64_t logIndex);
 
+    // NOTE: Rename() moves the dentry `src` visible at src's txid to `dst`
+    // in one storage transaction, the dentry visible at dst's txid
+    // is overwritten, so no pending tx is needed
+    MetaStatusCode Rename(const Dentry& src, const Dentry& dst,
+                          int64_t logIndex);
+
     std::shared_ptr<Iterator> GetAll();
 
     size_t Size();
@@ -205,6 +205,10 @@ void InodeManager::GenerateInodeInternal(uint64_t inodeId,
         inode->mutable_xattr()->insert({XATTR_DIR_SUBDIRS, "0"});
         inode->mutable_xattr()->insert({XATTR_DIR_ENTRIES, "0"});
         inode->mutable_xattr()->insert({XATTR_DIR_FBYTES, "0"});
+        inode->mutable_xattr()->insert({XATTR_DIR_RSUM_FILES, "0"});
+        inode->mutable_xattr()->insert({XATTR_DIR_RSUM_SUBDIRS, "0"});
+        inode->mutable_xattr()->insert({XATTR_DIR_RSUM_ENTRIES, "0"});
+        inode->mutable_xattr()->insert({XATTR_DIR_RSUM_FBYTES, "0"});
     } else {
         inode->set_nlink(1);
     }
@@ -277,6 +281,36 @@ MetaStatusCode InodeManager::GetXAttr(uint32_t fsId, uint64_t inodeId,
     return MetaStatusCode::OK;
 }
 
+// NOTE: the batched gets don't take the inode locks, every inode is read
+// from storage as what the last committed update left
+MetaStatusCode InodeManager::BatchGetInodeAttr(
+    uint32_t fsId, const std::vector<uint64_t> &inodeIds,
+    google::protobuf::RepeatedPtrField<InodeAttr> *attrs) {
+    VLOG(6) << "BatchGetInodeAttr, fsId = " << fsId
+            << ", count = " << inodeIds.size();
+    MetaStatusCode ret = inodeStorage_->BatchGetAttr(fsId, inodeIds, attrs);
+    if (ret != MetaStatusCode::OK) {
+        LOG(ERROR) << "BatchGetInodeAttr fail, fsId = " << fsId
+                   << ", count = " << inodeIds.size()
+                   << ", ret = " << MetaStatusCode_Name(ret);
+    }
+    return ret;
+}
+
+MetaStatusCode InodeManager::BatchGetXAttr(
+    uint32_t fsId, const std::vector<uint64_t> &inodeIds,
+    google::protobuf::RepeatedPtrField<XAttr> *xattrs) {
+    VLOG(6) << "BatchGetXAttr, fsId = " << fsId
+            << ", count = " << inodeIds.size();
+    MetaStatusCode ret = inodeStorage_->BatchGetXAttr(fsId, inodeIds, xattrs);
+    if (ret != MetaStatusCode::OK) {
+        LOG(ERROR) << "BatchGetXAttr fail, fsId = " << fsId
+                   << ", count = " << inodeIds.size()
+                   << ", ret = " << MetaStatusCode_Name(ret);
+    }
+    return ret;
+}
+
 MetaStatusCode InodeManager::DeleteInode(uint32_t fsId, uint64_t inodeId,
                                          int64_t logIndex) {
     CHECK_APPLIED();
@@ -346,6 +380,15 @@ MetaStatusCode InodeManager::UpdateInode(const UpdateInodeRequest& request,
     UPDATE_INODE(gid)
     UPDATE_INODE(mode)
 
+    if (request.has_inlinedata()) {
+        if (request.inlinedata().empty()) {
+            old.clear_inlinedata();
+        } else {
+            old.set_inlinedata(request.inlinedata());
+        }
+        needUpdate = true;
+    }
+
     if (request.parent_size() > 0) {
         *(old.mutable_parent()) = request.parent();
         needUpdate = true;
@@ -633,6 +676,10 @@ bool InodeManager::GetInodeIdList(std::list<uint64_t>* inodeIdList) {
     return inodeStorage_->GetAllInodeId(inodeIdList);
 }
 
+uint64_t InodeManager::GetInodeS3MetaSize(uint32_t fsId, uint64_t inodeId) {
+    return inodeStorage_->GetInodeS3MetaSize(fsId, inodeId);
+}
+
 MetaStatusCode InodeManager::UpdateVolumeExtentSliceLocked(
     uint32_t fsId, uint64_t inodeId, const VolumeExtentSlice& slice,
     int64_t logIndex) {
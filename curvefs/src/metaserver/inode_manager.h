@@ -90,6 +90,14 @@ class InodeManager {
 
     MetaStatusCode GetXAttr(uint32_t fsId, uint64_t inodeId, XAttr *xattr);
 
+    MetaStatusCode BatchGetInodeAttr(
+        uint32_t fsId, const std::vector<uint64_t> &inodeIds,
+        google::protobuf::RepeatedPtrField<InodeAttr> *attrs);
+
+    MetaStatusCode BatchGetXAttr(
+        uint32_t fsId, const std::vector<uint64_t> &inodeIds,
+        google::protobuf::RepeatedPtrField<XAttr> *xattrs);
+
     MetaStatusCode DeleteInode(uint32_t fsId, uint64_t inodeId,
                                int64_t logIndex);
 
@@ -112,6 +120,10 @@ class InodeManager {
 
     bool GetInodeIdList(std::list<uint64_t>* inodeIdList);
 
+    // Return the number of s3 chunk infos of inode,
+    // or UINT64_MAX if failed
+    uint64_t GetInodeS3MetaSize(uint32_t fsId, uint64_t inodeId);
+
     // Update one or more volume extent slice
     MetaStatusCode UpdateVolumeExtent(uint32_t fsId, uint64_t inodeId,
                                       const VolumeExtentSliceList& extents,
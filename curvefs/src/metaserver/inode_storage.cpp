@@ -22,6 +22,7 @@
 
 #include "curvefs/src/metaserver/inode_storage.h"
 
+#include <gflags/gflags.h>
 #include <google/protobuf/empty.pb.h>
 
 #include <algorithm>
@@ -31,6 +32,7 @@
 #include <string>
 #include <vector>
 
+#include "absl/memory/memory.h"
 #include "curvefs/proto/common.pb.h"
 #include "curvefs/proto/metaserver.pb.h"
 #include "curvefs/src/metaserver/common/types.h"
@@ -58,6 +60,54 @@ using ::curvefs::metaserver::storage::Prefix4InodeS3ChunkInfoList;
 using ::curvefs::metaserver::storage::Prefix4InodeVolumeExtent;
 using ::curvefs::metaserver::storage::Status;
 
+DEFINE_uint32(inode_attr_cache_capacity, 4096,
+              "the number of inode attributes cached by each partition, "
+              "0 means disable the cache");
+
+namespace {
+
+std::unique_ptr<::curve::common::ClockCache<std::string, InodeAttr>>
+NewAttrCache() {
+    if (FLAGS_inode_attr_cache_capacity == 0) {
+        return nullptr;
+    }
+    return absl::make_unique<
+        ::curve::common::ClockCache<std::string, InodeAttr>>(
+        FLAGS_inode_attr_cache_capacity);
+}
+
+void InodeToAttr(const Inode& inode, InodeAttr* attr) {
+    attr->set_inodeid(inode.inodeid());
+    attr->set_fsid(inode.fsid());
+    attr->set_length(inode.length());
+    attr->set_ctime(inode.ctime());
+    attr->set_ctime_ns(inode.ctime_ns());
+    attr->set_mtime(inode.mtime());
+    attr->set_mtime_ns(inode.mtime_ns());
+    attr->set_atime(inode.atime());
+    attr->set_atime_ns(inode.atime_ns());
+    attr->set_uid(inode.uid());
+    attr->set_gid(inode.gid());
+    attr->set_mode(inode.mode());
+    attr->set_nlink(inode.nlink());
+    attr->set_type(inode.type());
+    *(attr->mutable_parent()) = inode.parent();
+    if (inode.has_symlink()) {
+        attr->set_symlink(inode.symlink());
+    }
+    if (inode.has_rdev()) {
+        attr->set_rdev(inode.rdev());
+    }
+    if (inode.has_dtime()) {
+        attr->set_dtime(inode.dtime());
+    }
+    if (inode.xattr_size() > 0) {
+        *(attr->mutable_xattr()) = inode.xattr();
+    }
+}
+
+}  // namespace
+
 const char* InodeStorage::kInodeCountKey("count");
 
 const char* InodeStorage::kInodeAppliedKey("inode");
@@ -77,7 +127,8 @@ InodeStorage::InodeStorage(std::shared_ptr<KVStorage> kvStorage,
       table4AppliedIndex_(nameGenerator->GetAppliedIndexTableName()),
       table4InodeCount_(nameGenerator->GetInodeCountTableName()),
       nInode_(nInode),
-      conv_() {
+      conv_(),
+      attrCache_(NewAttrCache()) {
     // NOTE: for compatibility with older versions
     // we cannot ignore `nInode` argument
 }
@@ -203,8 +254,12 @@ MetaStatusCode InodeStorage::Get(const Key4Inode& key, Inode* inode) {
 
 MetaStatusCode InodeStorage::GetAttr(const Key4Inode& key, InodeAttr* attr) {
     ReadLockGuard lg(rwLock_);
-    Inode inode;
     std::string skey = conv_.SerializeToString(key);
+    if (attrCache_ != nullptr && attrCache_->Get(skey, attr)) {
+        return MetaStatusCode::OK;
+    }
+
+    Inode inode;
     Status s = kvStorage_->HGet(table4Inode_, skey, &inode);
     if (s.IsNotFound()) {
         return MetaStatusCode::NOT_FOUND;
@@ -213,36 +268,99 @@ MetaStatusCode InodeStorage::GetAttr(const Key4Inode& key, InodeAttr* attr) {
     }
 
     // get attr from inode
-    attr->set_inodeid(inode.inodeid());
-    attr->set_fsid(inode.fsid());
-    attr->set_length(inode.length());
-    attr->set_ctime(inode.ctime());
-    attr->set_ctime_ns(inode.ctime_ns());
-    attr->set_mtime(inode.mtime());
-    attr->set_mtime_ns(inode.mtime_ns());
-    attr->set_atime(inode.atime());
-    attr->set_atime_ns(inode.atime_ns());
-    attr->set_uid(inode.uid());
-    attr->set_gid(inode.gid());
-    attr->set_mode(inode.mode());
-    attr->set_nlink(inode.nlink());
-    attr->set_type(inode.type());
-    *(attr->mutable_parent()) = inode.parent();
-    if (inode.has_symlink()) {
-        attr->set_symlink(inode.symlink());
+    InodeToAttr(inode, attr);
+    if (attrCache_ != nullptr) {
+        attrCache_->Put(skey, *attr);
     }
-    if (inode.has_rdev()) {
-        attr->set_rdev(inode.rdev());
+    return MetaStatusCode::OK;
+}
+
+MetaStatusCode InodeStorage::MultiGetInodes(
+    const std::vector<std::string>& keys, std::vector<Inode>* inodes) {
+    inodes->clear();
+    inodes->resize(keys.size());
+    std::vector<storage::ValueType*> values;
+    values.reserve(keys.size());
+    for (auto& inode : *inodes) {
+        values.push_back(&inode);
+    }
+
+    std::vector<Status> statuses;
+    kvStorage_->HMultiGet(table4Inode_, keys, values, &statuses);
+    for (const auto& s : statuses) {
+        if (s.IsNotFound()) {
+            return MetaStatusCode::NOT_FOUND;
+        } else if (!s.ok()) {
+            return MetaStatusCode::STORAGE_INTERNAL_ERROR;
+        }
     }
-    if (inode.has_dtime()) {
-        attr->set_dtime(inode.dtime());
+    return MetaStatusCode::OK;
+}
+
+// NOTE: the batched gets are not serialized with the updates by the inode
+// lock, so they only read the attribute cache and never fill it, otherwise
+// an attribute read before an update committed may be left in the cache.
+MetaStatusCode InodeStorage::BatchGetAttr(
+    uint32_t fsId, const std::vector<uint64_t>& inodeIds,
+    google::protobuf::RepeatedPtrField<InodeAttr>* attrs) {
+    ReadLockGuard lg(rwLock_);
+    std::vector<std::string> missKeys;
+    std::vector<int> missIndexes;
+    for (const auto& inodeId : inodeIds) {
+        std::string skey = conv_.SerializeToString(Key4Inode(fsId, inodeId));
+        InodeAttr* attr = attrs->Add();
+        if (attrCache_ == nullptr || !attrCache_->Get(skey, attr)) {
+            missIndexes.push_back(attrs->size() - 1);
+            missKeys.push_back(std::move(skey));
+        }
     }
-    if (inode.xattr_size() > 0) {
-        *(attr->mutable_xattr()) = inode.xattr();
+    if (missKeys.empty()) {
+        return MetaStatusCode::OK;
+    }
+
+    std::vector<Inode> inodes;
+    MetaStatusCode rc = MultiGetInodes(missKeys, &inodes);
+    if (rc != MetaStatusCode::OK) {
+        return rc;
+    }
+    for (size_t i = 0; i < inodes.size(); i++) {
+        InodeToAttr(inodes[i], attrs->Mutable(missIndexes[i]));
+    }
+    return MetaStatusCode::OK;
+}
+
+MetaStatusCode InodeStorage::BatchGetXAttr(
+    uint32_t fsId, const std::vector<uint64_t>& inodeIds,
+    google::protobuf::RepeatedPtrField<XAttr>* xattrs) {
+    ReadLockGuard lg(rwLock_);
+    std::vector<std::string> keys;
+    keys.reserve(inodeIds.size());
+    for (const auto& inodeId : inodeIds) {
+        keys.push_back(conv_.SerializeToString(Key4Inode(fsId, inodeId)));
+    }
+
+    std::vector<Inode> inodes;
+    MetaStatusCode rc = MultiGetInodes(keys, &inodes);
+    if (rc != MetaStatusCode::OK) {
+        return rc;
+    }
+    for (const auto& inode : inodes) {
+        XAttr* xattr = xattrs->Add();
+        xattr->set_fsid(fsId);
+        xattr->set_inodeid(inode.inodeid());
+        if (!inode.xattr().empty()) {
+            *(xattr->mutable_xattrinfos()) = inode.xattr();
+        }
     }
     return MetaStatusCode::OK;
 }
 
+void InodeStorage::InvalidateAttrCache(const std::string& skey) {
+    if (attrCache_ != nullptr) {
+        attrCache_->Remove(skey);
+    }
+}
+
 MetaStatusCode InodeStorage::GetXAttr(const Key4Inode& key, XAttr* xattr) {
     ReadLockGuard lg(rwLock_);
     Inode inode;
@@ -268,6 +386,7 @@ storage::Status InodeStorage::DeleteInternal(
     std::string skey = conv_.SerializeToString(key);
     Status s;
     const char* step = "Delete inode from transaction";
+    InvalidateAttrCache(skey);
     do {
         s = transaction->HDel(table4Inode_, skey);
         if (!s.ok()) {
@@ -357,6 +476,58 @@ MetaStatusCode InodeStorage::ForceDelete(const Key4Inode& key) {
     return MetaStatusCode::STORAGE_INTERNAL_ERROR;
 }
 
+MetaStatusCode InodeStorage::ForceDelete(const std::vector<Key4Inode>& keys) {
+    if (keys.empty()) {
+        return MetaStatusCode::OK;
+    }
+    WriteLockGuard lg(rwLock_);
+    std::shared_ptr<storage::StorageTransaction> txn = nullptr;
+    Status s;
+    const char* step = "Begin transaction";
+    do {
+        txn = kvStorage_->BeginTransaction();
+        if (txn == nullptr) {
+            break;
+        }
+        uint64_t count = nInode_;
+        for (const auto& key : keys) {
+            std::string skey = conv_.SerializeToString(key);
+            InvalidateAttrCache(skey);
+            s = txn->HDel(table4Inode_, skey);
+            if (!s.ok()) {
+                break;
+            }
+            // NOTE: same as DeleteInternal(), the count may be less
+            // than the real value if some inodes not exist
+            if (count > 0) {
+                count--;
+            }
+        }
+        if (!s.ok()) {
+            step = "Delete inodes from transaction";
+            break;
+        }
+        s = SetInodeCount(txn.get(), count);
+        if (!s.ok()) {
+            step = "Insert inode count to transaction";
+            break;
+        }
+        s = txn->Commit();
+        if (!s.ok()) {
+            step = "Delete inodes";
+            break;
+        }
+        nInode_ = count;
+        return MetaStatusCode::OK;
+    } while (false);
+    LOG(ERROR) << step << " failed, status = " << s.ToString();
+    if (txn != nullptr && !txn->Rollback().ok()) {
+        LOG(ERROR) << "Rollback delete inodes transaction failed, status = "
+                   << s.ToString();
+    }
+    return MetaStatusCode::STORAGE_INTERNAL_ERROR;
+}
+
 MetaStatusCode InodeStorage::Update(
     std::shared_ptr<storage::StorageTransaction>* txn, const Inode& inode,
     int64_t logIndex, bool inodeDeallocate) {
@@ -370,6 +541,8 @@ MetaStatusCode InodeStorage::Update(
     WriteLockGuard lg(rwLock_);
     Key4Inode key(inode.fsid(), inode.inodeid());
     std::string skey = conv_.SerializeToString(key);
+    // NOTE: the transaction is committed by caller
+    InvalidateAttrCache(skey);
     storage::Status s;
     s = SetAppliedIndex(txn->get(), logIndex);
     if (!s.ok()) {
@@ -472,6 +645,7 @@ MetaStatusCode InodeStorage::Clear() {
     // raft logs and clear it again
     WriteLockGuard lg(rwLock_);
 
+    attrCache_ = NewAttrCache();
     Status s = kvStorage_->HClear(table4Inode_);
     if (!s.ok()) {
         LOG(ERROR) << "InodeStorage clear inode table failed, status = "
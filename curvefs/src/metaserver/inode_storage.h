@@ -42,6 +42,7 @@
 #include "curvefs/src/metaserver/storage/storage.h"
 #include "curvefs/src/metaserver/storage/utils.h"
 #include "src/common/concurrent/rw_lock.h"
+#include "src/common/lru_cache.h"
 
 namespace curvefs {
 namespace metaserver {
@@ -100,6 +101,30 @@ class InodeStorage {
      */
     MetaStatusCode GetXAttr(const Key4Inode& key, XAttr* xattr);
 
+    /**
+     * @brief get the attributes of multiple inodes by one batched read
+     * @param[in] fsId: the fs which the inodes belong to
+     * @param[in] inodeIds: the inodes want to get
+     * @param[out] attrs: the attributes got, in the order of inodeIds
+     * @return If any inode not exist, return NOT_FOUND; else return OK
+     */
+    MetaStatusCode BatchGetAttr(
+        uint32_t fsId, const std::vector<uint64_t>& inodeIds,
+        google::protobuf::RepeatedPtrField<InodeAttr>* attrs);
+
+    /**
+     * @brief get the extended attributes of multiple inodes by one batched
+     *        read
+     * @param[in] fsId: the fs which the inodes belong to
+     * @param[in] inodeIds: the inodes want to get
+     * @param[out] xattrs: the extended attributes got, in the order of
+     *             inodeIds
+     * @return If any inode not exist, return NOT_FOUND; else return OK
+     */
+    MetaStatusCode BatchGetXAttr(
+        uint32_t fsId, const std::vector<uint64_t>& inodeIds,
+        google::protobuf::RepeatedPtrField<XAttr>* xattrs);
+
     /**
      * @brief delete inode from storage
      * @param[in] key: the key of inode want to delete
@@ -110,6 +135,13 @@ class InodeStorage {
 
     MetaStatusCode ForceDelete(const Key4Inode& key);
 
+    /**
+     * @brief delete inodes from storage in one transaction
+     * @param[in] keys: the keys of inodes want to delete
+     * @return OK if the inodes not exist or deleted
+     */
+    MetaStatusCode ForceDelete(const std::vector<Key4Inode>& keys);
+
     /**
      * @brief update inode from storage
      * @param[in] inode: the inode want to update
@@ -187,13 +219,14 @@ class InodeStorage {
     MetaStatusCode GetAllBlockGroup(
         std::vector<DeallocatableBlockGroup>* deallocatableBlockGroupVec);
 
+    // return the number of s3 chunk infos of inode, UINT64_MAX if failed
+    uint64_t GetInodeS3MetaSize(uint32_t fsId, uint64_t inodeId);
+
  private:
     MetaStatusCode UpdateInodeS3MetaSize(Transaction txn, uint32_t fsId,
                                          uint64_t inodeId, uint64_t size4add,
                                          uint64_t size4del);
 
-    uint64_t GetInodeS3MetaSize(uint32_t fsId, uint64_t inodeId);
-
     MetaStatusCode DelS3ChunkInfoList(Transaction txn, uint32_t fsId,
                                       uint64_t inodeId, uint64_t chunkIndex,
                                       const S3ChunkInfoList* list2del);
@@ -230,6 +263,12 @@ class InodeStorage {
     storage::Status DeleteInternal(storage::StorageTransaction* transaction,
                                    const Key4Inode& key);
 
+    void InvalidateAttrCache(const std::string& skey);
+
+    // get the inodes of keys by one HMultiGet()
+    MetaStatusCode MultiGetInodes(const std::vector<std::string>& keys,
+                                  std::vector<Inode>* inodes);
+
  private:
     // FIXME: please remove this lock, because we has locked each inode
     // in inode manager, this lock only for proetct storage, but now we
@@ -248,6 +287,14 @@ class InodeStorage {
     size_t nInode_;
     Converter conv_;
 
+    // inode key => attribute, it answers the getattr without reading
+    // and parsing the whole inode from storage.
+    // NOTE: the entry is removed before the inode is updated, and the
+    // update is serialized with the getattr by the inode lock in inode
+    // manager, so the cache never returns a stale attribute.
+    std::unique_ptr<::curve::common::ClockCache<std::string, InodeAttr>>
+        attrCache_;
+
     static const char* kInodeCountKey;
     static const char* kInodeAppliedKey;
 };
@@ -29,6 +29,7 @@
 #include <glog/logging.h>
 #include <braft/builtin_service_impl.h>
 #include <unistd.h>
+#include <algorithm>
 #include <utility>
 #include "absl/memory/memory.h"
 #include "curvefs/src/metaserver/copyset/copyset_service.h"
@@ -136,6 +137,12 @@ void Metaserver::InitLocalFileSystem() {
 void InitS3Option(const std::shared_ptr<Configuration>& conf,
                   S3ClientAdaptorOption* s3Opt) {
     LOG_IF(FATAL, !conf->GetUInt64Value("s3.batchsize", &s3Opt->batchSize));
+    // one DeleteObjects request deletes 1000 objects at most
+    constexpr uint64_t kMaxDeleteObjectsBatch = 1000;
+    LOG_IF(WARNING, s3Opt->batchSize > kMaxDeleteObjectsBatch)
+        << "s3.batchsize " << s3Opt->batchSize << " is too large, using "
+        << kMaxDeleteObjectsBatch;
+    s3Opt->batchSize = std::min(s3Opt->batchSize, kMaxDeleteObjectsBatch);
     bool ret =
         conf->GetBoolValue("s3.enableBatchDelete", &s3Opt->enableBatchDelete);
     LOG_IF(WARNING, ret == false)
@@ -673,6 +680,12 @@ void Metaserver::InitCopysetNodeOptions() {
         << "config no copyset.enable_lease_read info, using default value "
         << copysetNodeOptions_.enbaleLeaseRead;
 
+    ret = conf_->GetBoolValue("copyset.inline_lease_read",
+                &copysetNodeOptions_.inlineLeaseRead);
+    LOG_IF(WARNING, ret == false)
+        << "config no copyset.inline_lease_read info, using default value "
+        << copysetNodeOptions_.inlineLeaseRead;
+
     LOG_IF(FATAL, !conf_->GetStringValue("copyset.data_uri",
                 &copysetNodeOptions_.dataUri));
     LOG_IF(FATAL, !conf_->GetIntValue("copyset.election_timeout_ms",
@@ -278,6 +278,18 @@ MetaStatusCode MetaStoreImpl::DeletePartition(
         return MetaStatusCode::PARTITION_NOT_FOUND;
     }
 
+    if (request->clearinodes() &&
+        it->second->GetStatus() == PartitionStatus::DELETING) {
+        // drop the inodes by range deletion instead of one log entry per
+        // inode, it's idempotent when replay
+        LOG(INFO) << "DeletePartition, clear the inodes of partition"
+                  << ", partitionId = " << partitionId;
+        if (!it->second->Clear()) {
+            response->set_statuscode(MetaStatusCode::STORAGE_INTERNAL_ERROR);
+            return MetaStatusCode::STORAGE_INTERNAL_ERROR;
+        }
+    }
+
     if (it->second->IsDeletable()) {
         LOG(INFO) << "DeletePartition, partition is deletable, delete it"
                   << ", partitionId = " << partitionId;
@@ -483,11 +495,16 @@ MetaStatusCode MetaStoreImpl::PrepareRenameTx(
 
     std::vector<Dentry> dentrys{request->dentrys().begin(),
                                 request->dentrys().end()};
-    rc = partition->HandleRenameTx(dentrys, logIndex);
+    bool committed = false;
+    rc = partition->HandleRenameTx(dentrys, logIndex,
+                                   request->commit() ? &committed : nullptr);
     if (rc == MetaStatusCode::IDEMPOTENCE_OK) {
         rc = MetaStatusCode::OK;
     }
     response->set_statuscode(rc);
+    if (committed) {
+        response->set_committed(true);
+    }
     return rc;
 }
 
@@ -528,8 +545,17 @@ MetaStatusCode MetaStoreImpl::CreateInode(const CreateInodeRequest* request,
     std::shared_ptr<Partition> partition;
     GET_PARTITION_OR_RETURN(partition);
 
-    MetaStatusCode status =
-        partition->CreateInode(param, response->mutable_inode(), logIndex);
+    MetaStatusCode status;
+    if (request->has_dentry()) {
+        Time tm;
+        GET_TIME_FROM_REQUEST(tm);
+        status = partition->CreateInodeWithDentry(
+            param, request->dentry(), tm, response->mutable_inode(), logIndex);
+        response->set_dentrycreated(status == MetaStatusCode::OK);
+    } else {
+        status =
+            partition->CreateInode(param, response->mutable_inode(), logIndex);
+    }
     response->set_statuscode(status);
     if (status != MetaStatusCode::OK) {
         response->clear_inode();
@@ -664,16 +690,12 @@ MetaStatusCode MetaStoreImpl::BatchGetInodeAttr(
     std::shared_ptr<Partition> partition;
     GET_PARTITION_OR_RETURN(partition);
 
-    uint32_t fsId = request->fsid();
-    MetaStatusCode status = MetaStatusCode::OK;
-    for (int i = 0; i < request->inodeid_size(); i++) {
-        status = partition->GetInodeAttr(fsId, request->inodeid(i),
-                                         response->add_attr());
-        if (status != MetaStatusCode::OK) {
-            response->clear_attr();
-            response->set_statuscode(status);
-            return status;
-        }
+    std::vector<uint64_t> inodeIds(request->inodeid().begin(),
+                                   request->inodeid().end());
+    MetaStatusCode status = partition->BatchGetInodeAttr(
+        request->fsid(), inodeIds, response->mutable_attr());
+    if (status != MetaStatusCode::OK) {
+        response->clear_attr();
     }
     response->set_statuscode(status);
     return status;
@@ -688,16 +710,12 @@ MetaStatusCode MetaStoreImpl::BatchGetXAttr(const BatchGetXAttrRequest* request,
     std::shared_ptr<Partition> partition;
     GET_PARTITION_OR_RETURN(partition);
 
-    uint32_t fsId = request->fsid();
-    MetaStatusCode status = MetaStatusCode::OK;
-    for (int i = 0; i < request->inodeid_size(); i++) {
-        status = partition->GetXAttr(fsId, request->inodeid(i),
-                                     response->add_xattr());
-        if (status != MetaStatusCode::OK) {
-            response->clear_xattr();
-            response->set_statuscode(status);
-            return status;
-        }
+    std::vector<uint64_t> inodeIds(request->inodeid().begin(),
+                                   request->inodeid().end());
+    MetaStatusCode status = partition->BatchGetXAttr(
+        request->fsid(), inodeIds, response->mutable_xattr());
+    if (status != MetaStatusCode::OK) {
+        response->clear_xattr();
     }
     response->set_statuscode(status);
     return status;
@@ -792,6 +810,21 @@ MetaStatusCode MetaStoreImpl::SendS3ChunkInfoByStream(
     return MetaStatusCode::OK;
 }
 
+bool MetaStoreImpl::GetPartitionInodeNum(uint32_t partitionId,
+                                         uint64_t* inodeNum) {
+    // don't wait for the loading, which holds the rwLock_ for a long time
+    if (rwLock_.TryRDLock() != 0) {
+        return false;
+    }
+
+    auto partition = GetPartition(partitionId);
+    if (partition != nullptr) {
+        *inodeNum = partition->GetInodeNum();
+    }
+    rwLock_.Unlock();
+    return partition != nullptr;
+}
+
 std::shared_ptr<Partition> MetaStoreImpl::GetPartition(uint32_t partitionId) {
     auto it = partitionMap_.find(partitionId);
     if (it != partitionMap_.end()) {
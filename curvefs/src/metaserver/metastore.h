@@ -132,6 +132,11 @@ class MetaStore {
     virtual bool GetPartitionSnap(
         std::map<uint32_t, std::shared_ptr<Partition>> *partitionSnap) = 0;
 
+    // get the inode num of partition, return false if it's not found or
+    // the metastore is loading
+    virtual bool GetPartitionInodeNum(uint32_t partitionId,
+                                      uint64_t* inodeNum) = 0;
+
     virtual std::shared_ptr<StreamServer> GetStreamServer() = 0;
 
     // dentry
@@ -238,6 +243,9 @@ class MetaStoreImpl : public MetaStore {
     bool GetPartitionSnap(
         std::map<uint32_t, std::shared_ptr<Partition>> *partitionSnap) override;
 
+    bool GetPartitionInodeNum(uint32_t partitionId,
+                              uint64_t* inodeNum) override;
+
     std::shared_ptr<StreamServer> GetStreamServer() override;
 
     // dentry
@@ -201,12 +201,12 @@ MetaStatusCode Partition::ListDentry(const Dentry& dentry,
 void Partition::ClearDentry() { dentryManager_->ClearDentry(); }
 
 MetaStatusCode Partition::HandleRenameTx(const std::vector<Dentry>& dentrys,
-                                         int64_t logIndex) {
+                                         int64_t logIndex, bool* committed) {
     for (const auto& it : dentrys) {
         PRECHECK(it.fsid(), it.parentinodeid());
     }
 
-    return dentryManager_->HandleRenameTx(dentrys, logIndex);
+    return dentryManager_->HandleRenameTx(dentrys, logIndex, committed);
 }
 
 bool Partition::InsertPendingTx(const PrepareRenameTxRequest& pendingTx) {
@@ -277,6 +277,42 @@ MetaStatusCode Partition::CreateInode(const InodeParam& param, Inode* inode,
     return ret;
 }
 
+MetaStatusCode Partition::CreateInodeWithDentry(const InodeParam& param,
+                                                const Dentry& dentry,
+                                                const Time& tm, Inode* inode,
+                                                int64_t logIndex) {
+    PRECHECK(dentry.fsid(), dentry.parentinodeid());
+    if (GetStatus() == PartitionStatus::READONLY) {
+        return MetaStatusCode::PARTITION_ALLOC_ID_FAIL;
+    }
+
+    uint64_t inodeId = GetNewInodeId();
+    if (inodeId == UINT64_MAX) {
+        return MetaStatusCode::PARTITION_ALLOC_ID_FAIL;
+    }
+
+    if (!IsInodeBelongs(param.fsId, inodeId)) {
+        return MetaStatusCode::PARTITION_ID_MISSMATCH;
+    }
+
+    auto ret = inodeManager_->CreateInode(inodeId, param, inode, logIndex);
+    if (ret != MetaStatusCode::OK && ret != MetaStatusCode::IDEMPOTENCE_OK) {
+        return ret;
+    }
+
+    Dentry newDentry(dentry);
+    newDentry.set_inodeid(inodeId);
+    ret = CreateDentry(newDentry, tm, logIndex);
+    if (ret != MetaStatusCode::OK) {
+        auto rc = inodeManager_->DeleteInode(param.fsId, inodeId, logIndex);
+        LOG_IF(ERROR, rc != MetaStatusCode::OK &&
+                          rc != MetaStatusCode::IDEMPOTENCE_OK)
+            << "Delete inode after create dentry fail, inodeId = " << inodeId
+            << ", ret = " << MetaStatusCode_Name(rc);
+    }
+    return ret;
+}
+
 MetaStatusCode Partition::CreateRootInode(const InodeParam& param,
                                           int64_t logIndex) {
     PRECHECK_FSID(param.fsId);
@@ -305,6 +341,15 @@ MetaStatusCode Partition::GetInode(uint32_t fsId, uint64_t inodeId,
     return inodeManager_->GetInode(fsId, inodeId, inode);
 }
 
+MetaStatusCode Partition::GetInodeWithS3ChunkInfo(uint32_t fsId,
+                                                  uint64_t inodeId,
+                                                  Inode* inode) {
+    if (!IsInodeBelongs(fsId, inodeId)) {
+        return MetaStatusCode::PARTITION_ID_MISSMATCH;
+    }
+    return inodeManager_->GetInode(fsId, inodeId, inode, true);
+}
+
 MetaStatusCode Partition::GetInodeAttr(uint32_t fsId, uint64_t inodeId,
                                        InodeAttr* attr) {
     PRECHECK(fsId, inodeId);
@@ -317,6 +362,24 @@ MetaStatusCode Partition::GetXAttr(uint32_t fsId, uint64_t inodeId,
     return inodeManager_->GetXAttr(fsId, inodeId, xattr);
 }
 
+MetaStatusCode Partition::BatchGetInodeAttr(
+    uint32_t fsId, const std::vector<uint64_t>& inodeIds,
+    google::protobuf::RepeatedPtrField<InodeAttr>* attrs) {
+    for (const auto& inodeId : inodeIds) {
+        PRECHECK(fsId, inodeId);
+    }
+    return inodeManager_->BatchGetInodeAttr(fsId, inodeIds, attrs);
+}
+
+MetaStatusCode Partition::BatchGetXAttr(
+    uint32_t fsId, const std::vector<uint64_t>& inodeIds,
+    google::protobuf::RepeatedPtrField<XAttr>* xattrs) {
+    for (const auto& inodeId : inodeIds) {
+        PRECHECK(fsId, inodeId);
+    }
+    return inodeManager_->BatchGetXAttr(fsId, inodeIds, xattrs);
+}
+
 MetaStatusCode Partition::DeleteInode(uint32_t fsId, uint64_t inodeId,
                                       int64_t logIndex) {
     PRECHECK(fsId, inodeId);
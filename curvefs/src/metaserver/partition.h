@@ -76,7 +76,8 @@ class Partition {
     void ClearDentry();
 
     MetaStatusCode HandleRenameTx(const std::vector<Dentry>& dentrys,
-                                  int64_t logIndex);
+                                  int64_t logIndex,
+                                  bool* committed = nullptr);
 
     bool InsertPendingTx(const PrepareRenameTxRequest& pendingTx);
 
@@ -90,6 +91,12 @@ class Partition {
     MetaStatusCode CreateInode(const InodeParam& param, Inode* inode,
                                int64_t logIndex);
 
+    // create an inode and its dentry, the inode is removed if the dentry
+    // can't be created
+    MetaStatusCode CreateInodeWithDentry(const InodeParam& param,
+                                         const Dentry& dentry, const Time& tm,
+                                         Inode* inode, int64_t logIndex);
+
     MetaStatusCode CreateRootInode(const InodeParam& param, int64_t logIndex);
 
     MetaStatusCode CreateManageInode(const InodeParam& param,
@@ -98,11 +105,24 @@ class Partition {
 
     MetaStatusCode GetInode(uint32_t fsId, uint64_t inodeId, Inode* inode);
 
+    // get inode with all of its s3 chunk infos, it's used by partition
+    // cleaner, so it's allowed while partition is deleting
+    MetaStatusCode GetInodeWithS3ChunkInfo(uint32_t fsId, uint64_t inodeId,
+                                           Inode* inode);
+
     MetaStatusCode GetInodeAttr(uint32_t fsId, uint64_t inodeId,
                                 InodeAttr* attr);
 
     MetaStatusCode GetXAttr(uint32_t fsId, uint64_t inodeId, XAttr* xattr);
 
+    MetaStatusCode BatchGetInodeAttr(
+        uint32_t fsId, const std::vector<uint64_t>& inodeIds,
+        google::protobuf::RepeatedPtrField<InodeAttr>* attrs);
+
+    MetaStatusCode BatchGetXAttr(
+        uint32_t fsId, const std::vector<uint64_t>& inodeIds,
+        google::protobuf::RepeatedPtrField<XAttr>* xattrs);
+
     MetaStatusCode DeleteInode(uint32_t fsId, uint64_t inodeId,
                                int64_t logIndex);
 
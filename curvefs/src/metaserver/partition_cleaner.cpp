@@ -41,34 +41,51 @@ bool PartitionCleaner::ScanPartition() {
         return false;
     }
 
+    if (cleanedInodes_ > InodeIdList.size()) {
+        cleanedInodes_ = 0;
+    }
+
+    // only delete the data of inodes here, the metadata of them are
+    // deleted with the partition by one raft log entry at last
+    bool allCleaned = true;
+    uint64_t index = 0;
     for (auto inodeId : InodeIdList) {
+        if (index++ < cleanedInodes_) {
+            continue;
+        }
         if (isStop_ || !copysetNode_->IsLeaderTerm()) {
             return false;
         }
         Inode inode;
-        MetaStatusCode ret =
-            partition_->GetInode(partition_->GetFsId(), inodeId, &inode);
-        if (ret != MetaStatusCode::OK) {
+        MetaStatusCode ret = partition_->GetInodeWithS3ChunkInfo(
+            partition_->GetFsId(), inodeId, &inode);
+        if (ret == MetaStatusCode::OK) {
+            ret = CleanData(inode);
+            if (ret != MetaStatusCode::OK) {
+                LOG(WARNING) << "ScanPartition clean inode fail, inode = "
+                             << inode.ShortDebugString();
+                allCleaned = false;
+                continue;
+            }
+        } else if (ret != MetaStatusCode::NOT_FOUND) {
             LOG(WARNING) << "ScanPartition get inode fail, fsId = "
                          << partition_->GetFsId()
                          << ", inodeId = " << inodeId;
+            allCleaned = false;
             continue;
         }
-
-        ret = CleanDataAndDeleteInode(inode);
-        if (ret != MetaStatusCode::OK) {
-            LOG(WARNING) << "ScanPartition clean inode fail, inode = "
-                         << inode.ShortDebugString();
-            continue;
+        if (allCleaned) {
+            cleanedInodes_ = index;
         }
         usleep(inodeDeletePeriodMs_);
     }
 
     uint32_t partitionId = partition_->GetPartitionId();
-    if (partition_->EmptyInodeStorage()) {
-        LOG(INFO) << "Inode num is 0, delete partition from metastore"
-                  << ", partitonId = " << partitionId;
-        MetaStatusCode ret = DeletePartition();
+    if (allCleaned) {
+        LOG(INFO) << "Data of all inodes is deleted, delete partition from"
+                  << " metastore, partitonId = " << partitionId
+                  << ", inode num = " << InodeIdList.size();
+        MetaStatusCode ret = DeletePartition(!InodeIdList.empty());
         if (ret == MetaStatusCode::OK) {
             VLOG(3) << "DeletePartition success, partitionId = " << partitionId;
             return true;
@@ -83,7 +100,7 @@ bool PartitionCleaner::ScanPartition() {
     return false;
 }
 
-MetaStatusCode PartitionCleaner::CleanDataAndDeleteInode(const Inode& inode) {
+MetaStatusCode PartitionCleaner::CleanData(const Inode& inode) {
     // TODO(cw123) : consider FsFileType::TYPE_FILE
     if (FsFileType::TYPE_S3 == inode.type()) {
          // get s3info from mds
@@ -114,8 +131,17 @@ MetaStatusCode PartitionCleaner::CleanDataAndDeleteInode(const Inode& inode) {
         }
     }
 
+    return MetaStatusCode::OK;
+}
+
+MetaStatusCode PartitionCleaner::CleanDataAndDeleteInode(const Inode& inode) {
+    MetaStatusCode ret = CleanData(inode);
+    if (ret != MetaStatusCode::OK) {
+        return ret;
+    }
+
     // send request to copyset to delete inode
-    MetaStatusCode ret = DeleteInode(inode);
+    ret = DeleteInode(inode);
     if (ret != MetaStatusCode::OK && ret != MetaStatusCode::NOT_FOUND) {
         LOG(ERROR) << "Delete Inode fail, fsId = " << inode.fsid()
                    << ", inodeId = " << inode.inodeid()
@@ -141,11 +167,12 @@ MetaStatusCode PartitionCleaner::DeleteInode(const Inode& inode) {
     return response.statuscode();
 }
 
-MetaStatusCode PartitionCleaner::DeletePartition() {
+MetaStatusCode PartitionCleaner::DeletePartition(bool clearInodes) {
     DeletePartitionRequest request;
     request.set_poolid(partition_->GetPoolId());
     request.set_copysetid(partition_->GetCopySetId());
     request.set_partitionid(partition_->GetPartitionId());
+    request.set_clearinodes(clearInodes);
     DeletePartitionResponse response;
     PartitionCleanerClosure done;
     auto deletePartitionOp = new copyset::DeletePartitionOperator(
@@ -41,7 +41,7 @@ using ::curvefs::mds::FsInfo;
 class PartitionCleaner {
  public:
     explicit PartitionCleaner(const std::shared_ptr<Partition> &partition)
-        : partition_(partition) {
+        : partition_(partition), cleanedInodes_(0) {
         isStop_ = false;
         LOG(INFO) << "PartitionCleaner poolId = "
                   << partition->GetPoolId() << ", partitionId = "
@@ -65,9 +65,12 @@ class PartitionCleaner {
     }
 
     bool ScanPartition();
+    MetaStatusCode CleanData(const Inode &inode);
     MetaStatusCode CleanDataAndDeleteInode(const Inode &inode);
     MetaStatusCode DeleteInode(const Inode& inode);
-    MetaStatusCode DeletePartition();
+    // if clearInodes is true, the inodes left are deleted together with
+    // the partition by one raft log entry
+    MetaStatusCode DeletePartition(bool clearInodes = false);
     uint32_t GetPartitionId() {
         return partition_->GetPartitionId();
     }
@@ -83,6 +86,9 @@ class PartitionCleaner {
     std::shared_ptr<MdsClient> mdsClient_;
     bool isStop_;
     uint32_t inodeDeletePeriodMs_;
+    // the number of inodes from the beginning of inode list whose data
+    // has been deleted, the list doesn't change while partition is deleting
+    uint64_t cleanedInodes_;
 };
 
 class PartitionCleanerClosure : public google::protobuf::Closure {
@@ -22,9 +22,55 @@
 
 #include "curvefs/src/metaserver/s3/metaserver_s3.h"
 
+#include "curvefs/src/common/s3util.h"
+
 namespace curvefs {
 namespace metaserver {
 
+int ReleasePackSlice(curve::common::S3Adapter* adapter, uint64_t fsId,
+                     uint32_t objectPrefix, const S3ChunkInfo& info) {
+    const uint64_t packId = info.packid();
+    const uint32_t count = info.packcount();
+    auto tombstone = [&](uint32_t index) {
+        std::string name = curvefs::common::s3util::GenPackTombstoneName(
+            packId, index, fsId, objectPrefix);
+        return Aws::String(name.c_str(), name.size());
+    };
+
+    if (adapter->PutObject(tombstone(info.packindex()), std::string()) != 0) {
+        LOG(ERROR) << "put tombstone of pack " << packId << " slice "
+                   << info.packindex() << " fail";
+        return -1;
+    }
+    // start from the next slice, so it stops at once when the slices are
+    // released in order
+    for (uint32_t i = 1; i < count; ++i) {
+        if (!adapter->ObjectExist(tombstone((info.packindex() + i) % count))) {
+            return 0;
+        }
+    }
+
+    // the pack first, a failure left only the empty tombstones
+    std::string packName =
+        curvefs::common::s3util::GenPackObjName(packId, fsId, objectPrefix);
+    if (adapter->DeleteObject(Aws::String(packName.c_str(),
+                                          packName.size())) != 0 &&
+        adapter->ObjectExist(Aws::String(packName.c_str(),
+                                         packName.size()))) {
+        LOG(ERROR) << "delete pack object " << packName << " fail";
+        return -1;
+    }
+    std::list<Aws::String> tombstones;
+    for (uint32_t i = 0; i < count; ++i) {
+        tombstones.push_back(tombstone(i));
+    }
+    if (adapter->DeleteObjects(tombstones) != 0) {
+        LOG(WARNING) << "delete tombstones of pack " << packName << " fail";
+    }
+    LOG(INFO) << "delete pack object " << packName << ", slices: " << count;
+    return 0;
+}
+
 void S3ClientImpl::SetAdaptor(
     std::shared_ptr<curve::common::S3Adapter> s3Adapter) {
     s3Adapter_ = s3Adapter;
@@ -65,6 +111,12 @@ int S3ClientImpl::Delete(const std::string& name) {
     return ret;
 }
 
+int S3ClientImpl::ReleasePackSlice(uint64_t fsId, uint32_t objectPrefix,
+                                   const S3ChunkInfo& info) {
+    return metaserver::ReleasePackSlice(s3Adapter_.get(), fsId, objectPrefix,
+                                        info);
+}
+
 int S3ClientImpl::DeleteBatch(const std::list<std::string>& nameList) {
     std::list<Aws::String> keyList;
     for (const std::string& name : nameList) {
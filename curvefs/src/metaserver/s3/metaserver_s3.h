@@ -25,10 +25,23 @@
 #include <memory>
 #include <string>
 #include <list>
+#include "curvefs/proto/metaserver.pb.h"
 #include "src/common/s3_adapter.h"
 
 namespace curvefs {
 namespace metaserver {
+
+/**
+ * @brief release the pack slice of a packed chunk, the pack object is
+ *        deleted once all its slices are released. Every slice released
+ *        leaves an empty tombstone object and then checks the tombstones
+ *        of the others, the tombstones are written before checked, so the
+ *        last one released always sees all the others
+ * @return 0 on success, -1 if it should be retried
+ */
+int ReleasePackSlice(curve::common::S3Adapter* adapter, uint64_t fsId,
+                     uint32_t objectPrefix, const S3ChunkInfo& info);
+
 class S3Client {
  public:
     S3Client() {}
@@ -36,6 +49,9 @@ class S3Client {
     virtual void Init(const curve::common::S3AdapterOption& option) = 0;
     virtual int Delete(const std::string& name) = 0;
     virtual int DeleteBatch(const std::list<std::string>& nameList) = 0;
+    // see ReleasePackSlice()
+    virtual int ReleasePackSlice(uint64_t fsId, uint32_t objectPrefix,
+                                 const S3ChunkInfo& info) = 0;
     virtual void Reinit(const std::string& ak, const std::string& sk,
                         const std::string& endpoint,
                         const std::string& bucketName) = 0;
@@ -64,6 +80,9 @@ class S3ClientImpl : public S3Client {
 
     int DeleteBatch(const std::list<std::string>& nameList) override;
 
+    int ReleasePackSlice(uint64_t fsId, uint32_t objectPrefix,
+                         const S3ChunkInfo& info) override;
+
  private:
     std::shared_ptr<curve::common::S3Adapter> s3Adapter_;
     curve::common::S3AdapterOption option_;
@@ -89,6 +89,13 @@ int S3ClientAdaptorImpl::DeleteInodeByDeleteSingleChunk(const Inode &inode) {
             // delete chunkInfo from client
             uint64_t fsId = inode.fsid();
             uint64_t inodeId = inode.inodeid();
+            if (chunkInfo.has_packid()) {
+                if (client_->ReleasePackSlice(fsId, objectPrefix_,
+                                              chunkInfo) != 0) {
+                    ret = -1;
+                }
+                continue;
+            }
             uint64_t chunkId = chunkInfo.chunkid();
             uint64_t compaction = chunkInfo.compaction();
             uint64_t chunkPos = chunkInfo.offset() % chunkSize_;
@@ -169,6 +176,16 @@ int S3ClientAdaptorImpl::DeleteS3ChunkInfoList(
 
     GenObjNameListForChunkInfoList(fsId, inodeId, s3ChunkInfolist, &objList);
 
+    for (const auto& chunkInfo : s3ChunkInfolist.s3chunks()) {
+        if (chunkInfo.has_packid() &&
+            client_->ReleasePackSlice(fsId, objectPrefix_, chunkInfo) != 0) {
+            LOG(ERROR) << "DeleteS3ChunkInfoList release pack slice failed, "
+                       << "fsId = " << fsId << ", inodeId = " << inodeId
+                       << ", packId = " << chunkInfo.packid();
+            return -1;
+        }
+    }
+
     while (objList.size() != 0) {
         std::list<std::string> tempObjList;
         auto begin = objList.begin();
@@ -192,6 +209,10 @@ void S3ClientAdaptorImpl::GenObjNameListForChunkInfoList(
     std::list<std::string> *objList) {
     for (int i = 0; i < s3ChunkInfolist.s3chunks_size(); ++i) {
         S3ChunkInfo chunkInfo = s3ChunkInfolist.s3chunks(i);
+        // released by ReleasePackSlice()
+        if (chunkInfo.has_packid()) {
+            continue;
+        }
         std::list<std::string> tempObjList;
         GenObjNameListForChunkInfo(fsId, inodeId, chunkInfo, &tempObjList);
 
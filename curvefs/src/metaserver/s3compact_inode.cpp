@@ -27,6 +27,7 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -36,6 +37,8 @@
 #include "curvefs/src/common/s3util.h"
 #include "curvefs/src/metaserver/copyset/copyset_node_manager.h"
 #include "curvefs/src/metaserver/copyset/meta_operator.h"
+#include "curvefs/src/metaserver/s3/metaserver_s3.h"
+#include "src/common/throttle.h"
 
 using curve::common::Configuration;
 using curve::common::InitS3AdaptorOptionExceptS3InfoOption;
@@ -51,39 +54,109 @@ namespace metaserver {
 std::vector<uint64_t> CompactInodeJob::GetNeedCompact(
     const ::google::protobuf::Map<uint64_t, S3ChunkInfoList>& s3chunkinfoMap,
     uint64_t inodeLen, uint64_t chunkSize) {
-    std::vector<uint64_t> needCompact;
+    // (priority, chunk index)
+    std::vector<std::pair<uint64_t, uint64_t>> candidates;
     for (const auto& item : s3chunkinfoMap) {
-        if (needCompact.size() >= opts_->maxChunksPerCompact) {
-            VLOG(9) << "s3compact: reach max chunks to compact per time";
-            break;
-        }
+        const uint64_t fragments = item.second.s3chunks_size();
         if (item.first * chunkSize > inodeLen - 1) {
             // we need delete this chunk
-            needCompact.push_back(item.first);
+            candidates.emplace_back(UINT64_MAX, item.first);
             continue;
         }
-        if (static_cast<uint64_t>(item.second.s3chunks_size()) >
-            opts_->fragmentThreshold) {
-            needCompact.push_back(item.first);
+        if (fragments > opts_->fragmentThreshold) {
+            candidates.emplace_back(fragments, item.first);
         } else {
             const auto& l = item.second;
             for (int i = 0; i < l.s3chunks_size(); i++) {
                 if (l.s3chunks(i).offset() + l.s3chunks(i).len() > inodeLen) {
                     // part of chunk is useless, we need to delete them
-                    needCompact.push_back(item.first);
+                    candidates.emplace_back(fragments, item.first);
                     break;
                 }
             }
         }
     }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const std::pair<uint64_t, uint64_t>& a,
+                 const std::pair<uint64_t, uint64_t>& b) {
+                  return a.first != b.first ? a.first > b.first
+                                            : a.second < b.second;
+              });
+    if (candidates.size() > opts_->maxChunksPerCompact) {
+        VLOG(9) << "s3compact: reach max chunks to compact per time";
+        candidates.resize(opts_->maxChunksPerCompact);
+    }
+
+    std::vector<uint64_t> needCompact;
+    needCompact.reserve(candidates.size());
+    for (const auto& item : candidates) {
+        needCompact.push_back(item.second);
+    }
     return needCompact;
 }
 
+uint64_t CompactInodeJob::EstimateS3Requests(const struct S3CompactCtx& ctx,
+                                             uint64_t index,
+                                             const Inode& inode) {
+    const auto& s3chunkinfolist = inode.s3chunkinfomap().at(index);
+    // delete the objs of old s3chunkinfos
+    uint64_t requests = 0;
+    for (int i = 0; i < s3chunkinfolist.s3chunks_size(); i++) {
+        const auto& info = s3chunkinfolist.s3chunks(i);
+        if (info.len() == 0) {
+            continue;
+        }
+        uint64_t offRoundDown = info.offset() / ctx.chunkSize * ctx.chunkSize;
+        uint64_t first = (info.offset() - offRoundDown) / ctx.blockSize;
+        uint64_t last = (info.offset() + info.len() - 1 - offRoundDown) /
+                        ctx.blockSize;
+        requests += last - first + 1;
+    }
+
+    std::list<Node> validList(BuildValidList(s3chunkinfolist, inode.length(),
+                                             index, ctx.chunkSize));
+    if (validList.empty()) {
+        return requests;
+    }
+
+    // read the valid objs
+    std::vector<struct S3Request> reqs;
+    struct S3NewChunkInfo newChunkInfo;
+    GenS3ReadRequests(ctx, validList, &reqs, &newChunkInfo);
+    std::set<std::string> objs;
+    uint64_t len = 0;
+    for (const auto& req : reqs) {
+        if (!req.zero) {
+            objs.insert(req.objName);
+        }
+        len += req.len;
+    }
+    requests += objs.size();
+    if (len == 0) {
+        return requests;
+    }
+
+    // write the new objs
+    uint64_t offRoundDown =
+        newChunkInfo.newOff / ctx.chunkSize * ctx.chunkSize;
+    requests += (newChunkInfo.newOff + len - 1 - offRoundDown) / ctx.blockSize -
+                (newChunkInfo.newOff - offRoundDown) / ctx.blockSize + 1;
+    return requests;
+}
+
+void CompactInodeJob::ThrottleS3Request(bool isRead, uint64_t length) {
+    if (opts_->s3Throttle != nullptr) {
+        opts_->s3Throttle->Add(isRead, length);
+    }
+}
+
 void CompactInodeJob::DeleteObjs(const std::vector<std::string>& objs,
                                         S3Adapter* s3adapter) {
     for (const auto& obj : objs) {
         VLOG(9) << "s3compact: delete " << obj;
         const Aws::String aws_key(obj.c_str(), obj.size());
+        ThrottleS3Request(false, 0);
         int ret =
             s3adapter->DeleteObject(aws_key);  // don't care success or not
         if (ret != 0) {
@@ -166,7 +239,7 @@ CompactInodeJob::BuildValidList(const S3ChunkInfoList& s3chunkinfolist,
         const auto& info = s3chunkinfolist.s3chunks(v.second.second);
         validList.emplace_back(v.first, v.second.first, info.chunkid(),
                                info.compaction(), info.offset(), info.len(),
-                               info.zero());
+                               info.zero(), info.packid(), info.packoffset());
     }
 
     return validList;
@@ -191,36 +264,47 @@ void CompactInodeJob::GenS3ReadRequests(
         const auto& chunkSize = ctx.chunkSize;
         uint64_t beginRoundDown = curr->begin / chunkSize * chunkSize;
         uint64_t startIndex = (curr->begin - beginRoundDown) / blockSize;
-        for (uint64_t index = startIndex;
-             beginRoundDown + index * blockSize <= curr->end; index++) {
-            // read the block obj
-            std::string objName = curvefs::common::s3util::GenObjName(
-                curr->chunkid, index, curr->compaction, ctx.fsId,
-                ctx.inodeId, ctx.objectPrefix);
-            uint64_t s3objBegin =
-                std::max(curr->chunkoff, beginRoundDown + index * blockSize);
-            uint64_t s3objEnd =
-                std::min(curr->chunkoff + curr->chunklen - 1,
-                         beginRoundDown + (index + 1) * blockSize - 1);
-            if (curr->begin >= s3objBegin && curr->end <= s3objEnd) {
-                // all what we need is only part of block
-                reqs->emplace_back(reqIndex++, false, std::move(objName),
-                                   curr->begin - s3objBegin,
-                                   curr->end - curr->begin + 1);
-            } else if (curr->begin >= s3objBegin && curr->end > s3objEnd) {
-                // not last block, what we need is part of block
-                reqs->emplace_back(reqIndex++, false, std::move(objName),
-                                   curr->begin - s3objBegin,
-                                   s3objEnd - curr->begin + 1);
-            } else if (curr->begin < s3objBegin && curr->end > s3objEnd) {
-                // what we need is full block
-                reqs->emplace_back(reqIndex++, false, std::move(objName), 0,
-                                   blockSize);
-            } else if (curr->begin < s3objBegin && curr->end <= s3objEnd) {
-                // last block, what we need is part of block
-                reqs->emplace_back(reqIndex++, false, std::move(objName), 0,
-                                   curr->end - s3objBegin + 1);
-                break;
+        if (curr->packid != 0) {
+            // a packed chunk is within one block, it's a slice of the pack
+            reqs->emplace_back(
+                reqIndex++, false,
+                curvefs::common::s3util::GenPackObjName(curr->packid,
+                                                        ctx.fsId,
+                                                        ctx.objectPrefix),
+                curr->packoff + curr->begin - curr->chunkoff,
+                curr->end - curr->begin + 1);
+        } else {
+            for (uint64_t index = startIndex;
+                 beginRoundDown + index * blockSize <= curr->end; index++) {
+                // read the block obj
+                std::string objName = curvefs::common::s3util::GenObjName(
+                    curr->chunkid, index, curr->compaction, ctx.fsId,
+                    ctx.inodeId, ctx.objectPrefix);
+                uint64_t s3objBegin = std::max(
+                    curr->chunkoff, beginRoundDown + index * blockSize);
+                uint64_t s3objEnd =
+                    std::min(curr->chunkoff + curr->chunklen - 1,
+                             beginRoundDown + (index + 1) * blockSize - 1);
+                if (curr->begin >= s3objBegin && curr->end <= s3objEnd) {
+                    // all what we need is only part of block
+                    reqs->emplace_back(reqIndex++, false, std::move(objName),
+                                       curr->begin - s3objBegin,
+                                       curr->end - curr->begin + 1);
+                } else if (curr->begin >= s3objBegin && curr->end > s3objEnd) {
+                    // not last block, what we need is part of block
+                    reqs->emplace_back(reqIndex++, false, std::move(objName),
+                                       curr->begin - s3objBegin,
+                                       s3objEnd - curr->begin + 1);
+                } else if (curr->begin < s3objBegin && curr->end > s3objEnd) {
+                    // what we need is full block
+                    reqs->emplace_back(reqIndex++, false, std::move(objName), 0,
+                                       blockSize);
+                } else if (curr->begin < s3objBegin && curr->end <= s3objEnd) {
+                    // last block, what we need is part of block
+                    reqs->emplace_back(reqIndex++, false, std::move(objName), 0,
+                                       curr->end - s3objBegin + 1);
+                    break;
+                }
             }
         }
 
@@ -286,6 +370,7 @@ int CompactInodeJob::ReadFullChunk(
             // metadata may be newer than data in s3
             // which means you cannot read data from s3
             // we have to wait data to be flushed to s3
+            ThrottleS3Request(true, ctx.blockSize);
             int ret = ctx.s3adapter->GetObject(aws_key, &buf);
             if (ret != 0) {
                 LOG(WARNING)
@@ -359,6 +444,7 @@ int CompactInodeJob::WriteFullChunk(
             newOff + chunkLen - 1, offRoundDown + (index + 1) * blockSize - 1);
         VLOG(9) << "s3compact: put " << objName << ", [" << s3objBegin << "-"
                 << s3objEnd << "]";
+        ThrottleS3Request(false, s3objEnd - s3objBegin + 1);
         ret = ctx.s3adapter->PutObject(
             aws_key,
             fullChunk.substr(s3objBegin - newOff, s3objEnd - s3objBegin + 1));
@@ -523,6 +609,16 @@ void CompactInodeJob::DeleteObjsOfS3ChunkInfoList(
     const struct S3CompactCtx& ctx, const S3ChunkInfoList& s3chunkinfolist) {
     for (auto i = 0; i < s3chunkinfolist.s3chunks_size(); i++) {
         const auto& chunkinfo = s3chunkinfolist.s3chunks(i);
+        if (chunkinfo.has_packid()) {
+            // the pack is shared with other slices, drop only this one
+            ThrottleS3Request(false, 0);
+            if (ReleasePackSlice(ctx.s3adapter, ctx.fsId, ctx.objectPrefix,
+                                 chunkinfo) != 0) {
+                VLOG(6) << "s3compact: release pack slice of "
+                        << chunkinfo.packid() << " failed.";
+            }
+            continue;
+        }
         uint64_t off = chunkinfo.offset();
         uint64_t len = chunkinfo.len();
         uint64_t offRoundDown = off / ctx.chunkSize * ctx.chunkSize;
@@ -534,6 +630,7 @@ void CompactInodeJob::DeleteObjsOfS3ChunkInfoList(
                 ctx.inodeId, ctx.objectPrefix);
             VLOG(6) << "s3compact: delete " << objName;
             const Aws::String aws_key(objName.c_str(), objName.size());
+            ThrottleS3Request(false, 0);
             int r = ctx.s3adapter->DeleteObject(
                 aws_key);  // don't care success or not
             if (r != 0)
@@ -581,7 +678,21 @@ void CompactInodeJob::CompactChunks(const S3CompactTask& task) {
     ::google::protobuf::Map<uint64_t, S3ChunkInfoList> s3ChunkInfoRemove;
     VLOG(6) << "s3compact: begin to compact fsId:" << fsId
             << ", inodeId:" << inodeId;
+    const uint64_t budget = opts_->maxS3RequestsPerCompact;
+    uint64_t used = 0;
     for (const auto& index : needCompact) {
+        if (budget != 0) {
+            // skip chunks out of budget, they will be compacted next time,
+            // but always compact one chunk at least
+            uint64_t cost = EstimateS3Requests(compactCtx, index, inode);
+            if (used != 0 && used + cost > budget) {
+                VLOG(6) << "s3compact: skip index " << index
+                        << ", estimated s3 requests: " << cost
+                        << ", used: " << used << ", budget: " << budget;
+                continue;
+            }
+            used += cost;
+        }
         // s3chunklist order: from small chunkid to big chunkid
         CompactChunk(compactCtx, index, inode, &objsAddedMap, &s3ChunkInfoAdd,
                      &s3ChunkInfoRemove);
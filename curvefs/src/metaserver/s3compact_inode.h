@@ -133,16 +133,21 @@ class CompactInodeJob {
         uint64_t chunkoff;
         uint64_t chunklen;
         bool zero;
+        // the pack object holding the chunk, 0 if not packed
+        uint64_t packid;
+        uint64_t packoff;
         Node(uint64_t begin, uint64_t end, uint64_t chunkid,
              uint64_t compaction, uint64_t chunkoff, uint64_t chunklen,
-             bool zero)
+             bool zero, uint64_t packid = 0, uint64_t packoff = 0)
             : begin(begin),
               end(end),
               chunkid(chunkid),
               compaction(compaction),
               chunkoff(chunkoff),
               chunklen(chunklen),
-              zero(zero) {}
+              zero(zero),
+              packid(packid),
+              packoff(packoff) {}
     };
 
     // closure for updating inode, simply wait
@@ -165,10 +170,16 @@ class CompactInodeJob {
         }
     };
 
+    // return the chunks need compact, chunks truncated are returned first
+    // as they only need deletions, then chunks with more fragments
     std::vector<uint64_t> GetNeedCompact(
         const ::google::protobuf::Map<uint64_t, S3ChunkInfoList>&
             s3chunkinfoMap,
         uint64_t inodeLen, uint64_t chunkSize);
+    // estimate the s3 requests (get/put/delete) to compact the chunk
+    uint64_t EstimateS3Requests(const struct S3CompactCtx& ctx,
+                                uint64_t index, const Inode& inode);
+    void ThrottleS3Request(bool isRead, uint64_t length);
     bool CompactPrecheck(const struct S3CompactTask& task, Inode* inode);
     S3Adapter* SetupS3Adapter(uint64_t fsid, uint64_t* s3adapterIndex,
                               uint64_t* blockSize, uint64_t* chunkSize,
@@ -116,6 +116,19 @@ void S3CompactWorkQueueOption::Init(std::shared_ptr<Configuration> conf) {
     conf->GetValueFatalIfFail("s3compactwq.s3_read_max_retry", &s3ReadMaxRetry);
     conf->GetValueFatalIfFail("s3compactwq.s3_read_retry_interval",
                               &s3ReadRetryInterval);
+    LOG_IF(WARNING, !conf->GetUInt64Value("s3compactwq.s3_iops_limit",
+                                          &s3IopsLimit))
+        << "config no s3compactwq.s3_iops_limit info, using default value "
+        << s3IopsLimit;
+    LOG_IF(WARNING, !conf->GetUInt64Value("s3compactwq.s3_bps_limit_mb",
+                                          &s3BpsLimitMB))
+        << "config no s3compactwq.s3_bps_limit_mb info, using default value "
+        << s3BpsLimitMB;
+    LOG_IF(WARNING,
+           !conf->GetUInt64Value("s3compactwq.max_s3_requests_per_compact",
+                                 &maxS3RequestsPerCompact))
+        << "config no s3compactwq.max_s3_requests_per_compact info, "
+        << "using default value " << maxS3RequestsPerCompact;
 }
 
 void S3CompactManager::Init(std::shared_ptr<Configuration> conf) {
@@ -143,6 +156,15 @@ void S3CompactManager::Init(std::shared_ptr<Configuration> conf) {
         workerOptions_.s3ReadMaxRetry = opts_.s3ReadMaxRetry;
         workerOptions_.s3ReadRetryInterval = opts_.s3ReadRetryInterval;
         workerOptions_.sleepMS = opts_.enqueueSleepMS;
+        workerOptions_.maxS3RequestsPerCompact = opts_.maxS3RequestsPerCompact;
+        if (opts_.s3IopsLimit != 0 || opts_.s3BpsLimitMB != 0) {
+            curve::common::ReadWriteThrottleParams params;
+            params.iopsTotal.limit = opts_.s3IopsLimit;
+            params.bpsTotal.limit = opts_.s3BpsLimitMB * 1024 * 1024;
+            s3Throttle_ = absl::make_unique<curve::common::Throttle>();
+            s3Throttle_->UpdateThrottleParams(params);
+            workerOptions_.s3Throttle = s3Throttle_.get();
+        }
 
         inited_ = true;
     } else {
@@ -204,6 +226,10 @@ void S3CompactManager::Stop() {
     }
 
     workerContext_.cond.notify_all();
+    if (s3Throttle_ != nullptr) {
+        // let the workers waiting for tokens go
+        s3Throttle_->Stop();
+    }
     for (auto& worker : workers_) {
         worker->Stop();
     }
@@ -35,6 +35,7 @@
 #include "src/common/configuration.h"
 #include "src/common/interruptible_sleeper.h"
 #include "src/common/s3_adapter.h"
+#include "src/common/throttle.h"
 #include "curvefs/src/metaserver/s3compact_worker.h"
 
 namespace curvefs {
@@ -80,6 +81,10 @@ struct S3CompactWorkQueueOption {
     uint64_t s3infocacheSize;
     uint64_t s3ReadMaxRetry;
     uint64_t s3ReadRetryInterval;
+    // limits of all compaction workers, 0 means no limit
+    uint64_t s3IopsLimit = 0;
+    uint64_t s3BpsLimitMB = 0;
+    uint64_t maxS3RequestsPerCompact = 0;
 
     void Init(std::shared_ptr<Configuration> conf);
 };
@@ -89,6 +94,7 @@ class S3CompactManager {
     S3CompactWorkQueueOption opts_;
     std::unique_ptr<S3InfoCache> s3infoCache_;
     std::unique_ptr<S3AdapterManager> s3adapterManager_;
+    std::unique_ptr<curve::common::Throttle> s3Throttle_;
 
     S3CompactWorkerContext workerContext_;
     S3CompactWorkerOptions workerOptions_;
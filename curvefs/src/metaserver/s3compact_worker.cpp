@@ -24,14 +24,18 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <mutex>
+#include <limits>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include "absl/cleanup/cleanup.h"
 #include "curvefs/src/common/threading.h"
+#include "curvefs/src/metaserver/inode_manager.h"
 #include "curvefs/src/metaserver/s3compact.h"
 #include "curvefs/src/metaserver/s3compact_inode.h"
 #include "curvefs/src/metaserver/storage/converter.h"
@@ -156,6 +160,31 @@ bool S3CompactWorker::CompactInodes(const std::list<uint64_t>& inodes,
     return true;
 }
 
+void S3CompactWorker::SortInodesByFragments(std::list<uint64_t>* inodes) {
+    const auto fsId = s3Compact_->partitionInfo.fsid();
+    std::vector<std::pair<uint64_t, uint64_t>> fragments;  // (count, ino)
+    fragments.reserve(inodes->size());
+    for (auto ino : *inodes) {
+        uint64_t count =
+            s3Compact_->inodeManager->GetInodeS3MetaSize(fsId, ino);
+        if (count == std::numeric_limits<uint64_t>::max()) {
+            count = 0;  // failed to get it, compact it at last
+        }
+        fragments.emplace_back(count, ino);
+    }
+
+    std::stable_sort(fragments.begin(), fragments.end(),
+                     [](const std::pair<uint64_t, uint64_t>& a,
+                        const std::pair<uint64_t, uint64_t>& b) {
+                         return a.first > b.first;
+                     });
+
+    inodes->clear();
+    for (const auto& item : fragments) {
+        inodes->push_back(item.second);
+    }
+}
+
 void S3CompactWorker::CompactWorker() {
     common::SetThreadName("s3compact");
 
@@ -195,6 +224,7 @@ void S3CompactWorker::CompactWorker() {
             continue;
         }
 
+        SortInodesByFragments(&inodes);
         compactAgain = CompactInodes(inodes, s3Compact_->copysetNode.get());
     }
 
@@ -34,6 +34,12 @@
 #include "curvefs/src/metaserver/s3compact.h"
 #include "src/common/interruptible_sleeper.h"
 
+namespace curve {
+namespace common {
+class Throttle;
+}  // namespace common
+}  // namespace curve
+
 namespace curvefs {
 namespace metaserver {
 
@@ -68,6 +74,14 @@ struct S3CompactWorkerOptions {
 
     // sleep interval in ms between compacting two inodes
     uint64_t sleepMS;
+
+    // max estimated s3 requests (get/put/delete) to compact one inode at
+    // once, the most profitable chunks are compacted first, 0 means no limit
+    uint64_t maxS3RequestsPerCompact = 0;
+
+    // shared by all workers to limit the s3 requests of compaction,
+    // nullptr means no limit
+    curve::common::Throttle* s3Throttle = nullptr;
 };
 
 // S3CompactWorker compacts one partition at once
@@ -95,6 +109,10 @@ class S3CompactWorker {
     bool CompactInodes(const std::list<uint64_t>& inodes,
                        copyset::CopysetNode* node);
 
+    // Sort inodes by their s3 chunk info count in descending order, since
+    // every fragment of a chunk is an extra s3 request when reading it
+    void SortInodesByFragments(std::list<uint64_t>* inodes);
+
     void CleanupCompact(bool again);
 
  private:
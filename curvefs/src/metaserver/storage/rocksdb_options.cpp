@@ -26,6 +26,7 @@
 
 #include <memory>
 #include <mutex>
+#include <string>
 
 #include "curvefs/src/metaserver/storage/rocksdb_event_listener.h"
 #include "curvefs/src/metaserver/storage/rocksdb_storage.h"
@@ -82,6 +83,15 @@ DEFINE_double(rocksdb_memtable_prefix_bloom_size_ratio,
               0.1,
               "Rocksdb memtable prefix bloom size ratio");
 
+DEFINE_bool(rocksdb_user_key_prefix_bloom,
+            true,
+            "Build prefix bloom filter on the parent of dentry and the inode "
+            "of s3chunkinfo/extent, rather than the whole table");
+
+DEFINE_int32(rocksdb_bloom_filter_bits_per_key,
+             10,
+             "Bits per key of rocksdb bloom filter");
+
 DEFINE_int64(rocksdb_unordered_cf_write_buffer_size,
              64ULL << 20,
              "Writer buffer size for unordered column family");
@@ -114,6 +124,42 @@ std::shared_ptr<MetricEventListener> metricEventListener;
 
 const char* const kOrderedColumnFamilyName = "ordered_column_family";
 
+class UserKeyPrefixTransform : public rocksdb::SliceTransform {
+ public:
+    explicit UserKeyPrefixTransform(size_t userKeyOffset)
+        : userKeyOffset_(userKeyOffset) {}
+
+    // NOTE: rocksdb records the name in sst, and ignores the prefix filter
+    // of the sst built by a transform with other name, so change the name
+    // if the rule changes.
+    const char* Name() const override { return "curvefs.UserKeyPrefix.3"; }
+
+    rocksdb::Slice Transform(const rocksdb::Slice& key) const override {
+        return rocksdb::Slice(key.data(), PrefixLength(key));
+    }
+
+    bool InDomain(const rocksdb::Slice& key) const override {
+        return PrefixLength(key) != 0;
+    }
+
+ private:
+    size_t PrefixLength(const rocksdb::Slice& key) const {
+        int ndelimiter = 0;
+        for (size_t i = userKeyOffset_; i < key.size(); i++) {
+            if (key[i] == kDelimiter && ++ndelimiter == kPrefixDelimiters) {
+                return i + 1;
+            }
+        }
+        return 0;
+    }
+
+ private:
+    static constexpr char kDelimiter = ':';
+    static constexpr int kPrefixDelimiters = 3;
+
+    size_t userKeyOffset_;
+};
+
 void CreateBlockCacheAndWriterBufferManager() {
     static std::once_flag createBlockCache;
     std::call_once(createBlockCache, []() {
@@ -142,6 +188,10 @@ std::shared_ptr<MetricEventListener> GetMetricEventListener() {
 
 }  // namespace
 
+rocksdb::SliceTransform* NewUserKeyPrefixTransform(size_t userKeyOffset) {
+    return new UserKeyPrefixTransform(userKeyOffset);
+}
+
 void InitRocksdbOptions(
     rocksdb::DBOptions* options,
     std::vector<rocksdb::ColumnFamilyDescriptor>* columnFamilies,
@@ -171,7 +221,8 @@ void InitRocksdbOptions(
     tableOptions.block_cache = rocksdbBlockCache;
     tableOptions.cache_index_and_filter_blocks = true;
     tableOptions.pin_l0_filter_and_index_blocks_in_cache = true;
-    tableOptions.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10, false));
+    tableOptions.filter_policy.reset(rocksdb::NewBloomFilterPolicy(
+        FLAGS_rocksdb_bloom_filter_bits_per_key, false));
 
     rocksdb::ColumnFamilyOptions defaultCfOptions;
     defaultCfOptions.max_write_buffer_size_to_maintain =
@@ -183,8 +234,16 @@ void InitRocksdbOptions(
         FLAGS_rocksdb_level0_file_num_compaction_trigger;
     defaultCfOptions.max_bytes_for_level_base =
         FLAGS_rocksdb_max_bytes_for_level_base;
-    defaultCfOptions.prefix_extractor.reset(
-        rocksdb::NewFixedPrefixTransform(RocksDBStorage::GetKeyPrefixLength()));
+    if (FLAGS_rocksdb_user_key_prefix_bloom) {
+        // internal key: ordered:name:0:key
+        defaultCfOptions.prefix_extractor.reset(NewUserKeyPrefixTransform(
+            RocksDBStorage::GetKeyPrefixLength() +
+            RocksDBStorage::kDelimiter_.size()));
+    } else {
+        defaultCfOptions.prefix_extractor.reset(
+            rocksdb::NewFixedPrefixTransform(
+                RocksDBStorage::GetKeyPrefixLength()));
+    }
     defaultCfOptions.memtable_prefix_bloom_size_ratio =
         FLAGS_rocksdb_memtable_prefix_bloom_size_ratio;
     defaultCfOptions.table_factory.reset(
@@ -244,6 +303,14 @@ void ParseRocksdbOptions(curve::common::Configuration* conf) {
                "storage.rocksdb.memtable_prefix_bloom_size_ratio",
                &FLAGS_rocksdb_memtable_prefix_bloom_size_ratio,
                /*fatalIfMissing*/ false);
+    dummy.Load(conf, "rocksdb_user_key_prefix_bloom",
+               "storage.rocksdb.user_key_prefix_bloom",
+               &FLAGS_rocksdb_user_key_prefix_bloom,
+               /*fatalIfMissing*/ false);
+    dummy.Load(conf, "rocksdb_bloom_filter_bits_per_key",
+               "storage.rocksdb.bloom_filter_bits_per_key",
+               &FLAGS_rocksdb_bloom_filter_bits_per_key,
+               /*fatalIfMissing*/ false);
     dummy.Load(conf, "rocksdb_unordered_cf_write_buffer_size",
                "storage.rocksdb.unordered_write_buffer_size",
                &FLAGS_rocksdb_unordered_cf_write_buffer_size,
@@ -23,10 +23,12 @@
 #ifndef CURVEFS_SRC_METASERVER_STORAGE_ROCKSDB_OPTIONS_H_
 #define CURVEFS_SRC_METASERVER_STORAGE_ROCKSDB_OPTIONS_H_
 
+#include <cstddef>
 #include <vector>
 
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
+#include "rocksdb/slice_transform.h"
 
 namespace curve {
 namespace common {
@@ -38,6 +40,15 @@ namespace curvefs {
 namespace metaserver {
 namespace storage {
 
+// Extract the key prefix up to the third delimiter of the user key, which
+// begins at |userKeyOffset| of the internal key, e.g.
+//   dentry       3:fsId:parentInodeId:name  =>  3:fsId:parentInodeId:
+//   s3chunkinfo  2:fsId:inodeId:...         =>  2:fsId:inodeId:
+//   extent       4:fsId:inodeId:offset      =>  4:fsId:inodeId:
+// keys with less delimiters (inode, ...) are out of domain and only use
+// the whole key filter.
+rocksdb::SliceTransform* NewUserKeyPrefixTransform(size_t userKeyOffset);
+
 // Parse rocksdb related options from conf
 void ParseRocksdbOptions(curve::common::Configuration* conf);
 
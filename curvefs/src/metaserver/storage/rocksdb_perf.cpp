@@ -25,6 +25,7 @@
 #include <ostream>
 #include <iostream>
 
+#include "bthread/bthread.h"
 #include "butil/fast_rand.h"
 #include "src/common/timeutility.h"
 #include "curvefs/src/metaserver/storage/rocksdb_perf.h"
@@ -41,6 +42,9 @@ DEFINE_validator(rocksdb_perf_slow_us, &pass_uint64);
 DEFINE_double(rocksdb_perf_sampling_ratio, 0,
               "rocksdb perf sampling ratio");
 DEFINE_validator(rocksdb_perf_sampling_ratio, &pass_double);
+DEFINE_double(rocksdb_op_perf_sampling_ratio, 0,
+              "sampling ratio of rocksdb perf context for metadata operators");
+DEFINE_validator(rocksdb_op_perf_sampling_ratio, &pass_double);
 
 namespace curvefs {
 namespace metaserver {
@@ -50,6 +54,12 @@ using ::curve::common::TimeUtility;
 
 const uint32_t RocksDBPerfGuard::kPerfLevelOutOfBounds_ = 5;
 
+namespace {
+
+thread_local bool tlsInOpPerfScope = false;
+
+}  // namespace
+
 std::ostream& operator<<(std::ostream& os, OPERATOR_TYPE type) {
     switch (type) {
         case OP_GET:
@@ -94,6 +104,9 @@ std::ostream& operator<<(std::ostream& os, OPERATOR_TYPE type) {
         case OP_ROLLBACK_TRANSACTION:
             os << "ROLLBACK_TRANSACTION";
             break;
+        case OP_MULTI_GET:
+            os << "MULTI_GET";
+            break;
         default:
             os << "UNKNWON";
     }
@@ -116,7 +129,12 @@ rocksdb::PerfLevel RocksDBPerfGuard::ToPerfLevel(uint32_t level) {
     return rocksdb::PerfLevel::kDisable;
 }
 
-RocksDBPerfGuard::RocksDBPerfGuard(OPERATOR_TYPE opType) {
+RocksDBPerfGuard::RocksDBPerfGuard(OPERATOR_TYPE opType)
+    : inOpScope_(RocksDBOpPerfScope::InScope()) {
+    if (inOpScope_) {
+        return;
+    }
+
     rocksdb::PerfLevel level = ToPerfLevel(FLAGS_rocksdb_perf_level);
     if (level == rocksdb::PerfLevel::kDisable) {
         return;
@@ -130,6 +148,10 @@ RocksDBPerfGuard::RocksDBPerfGuard(OPERATOR_TYPE opType) {
 }
 
 RocksDBPerfGuard::~RocksDBPerfGuard() {
+    if (inOpScope_) {
+        return;
+    }
+
     rocksdb::PerfLevel level = ToPerfLevel(FLAGS_rocksdb_perf_level);
     if (level == rocksdb::PerfLevel::kDisable) {
         return;
@@ -159,6 +181,50 @@ RocksDBPerfGuard::~RocksDBPerfGuard() {
     }
 }
 
+std::string RocksDBPerfStats::ToString() const {
+    std::ostringstream oss;
+    oss << "blockCacheHit(" << blockCacheHitCount << ")"
+        << ", blockRead(" << blockReadCount << ")"
+        << ", blockReadBytes(" << blockReadBytes << ")"
+        << ", readBytes(" << readBytes << ")"
+        << ", memtableHit(" << memtableHitCount << ")"
+        << ", seek(" << seekCount << ")";
+    return oss.str();
+}
+
+RocksDBOpPerfScope::RocksDBOpPerfScope() : sampled_(false) {
+    if (FLAGS_rocksdb_op_perf_sampling_ratio <= 0 || tlsInOpPerfScope ||
+        bthread_self() != 0 ||
+        FLAGS_rocksdb_op_perf_sampling_ratio <= butil::fast_rand_double()) {
+        return;
+    }
+
+    sampled_ = true;
+    tlsInOpPerfScope = true;
+    rocksdb::SetPerfLevel(rocksdb::PerfLevel::kEnableCount);
+    rocksdb::get_perf_context()->Reset();
+}
+
+RocksDBOpPerfScope::~RocksDBOpPerfScope() {
+    if (sampled_) {
+        rocksdb::SetPerfLevel(rocksdb::PerfLevel::kDisable);
+        tlsInOpPerfScope = false;
+    }
+}
+
+void RocksDBOpPerfScope::GetStats(RocksDBPerfStats* stats) const {
+    const auto* ctx = rocksdb::get_perf_context();
+    stats->blockCacheHitCount = ctx->block_cache_hit_count;
+    stats->blockReadCount = ctx->block_read_count;
+    stats->blockReadBytes = ctx->block_read_byte;
+    stats->readBytes = ctx->get_read_bytes + ctx->multiget_read_bytes +
+                       ctx->iter_read_bytes;
+    stats->memtableHitCount = ctx->get_from_memtable_count;
+    stats->seekCount = ctx->seek_child_seek_count;
+}
+
+bool RocksDBOpPerfScope::InScope() { return tlsInOpPerfScope; }
+
 }  // namespace storage
 }  // namespace metaserver
 }  // namespace curvefs
@@ -48,6 +48,7 @@
 DECLARE_uint32(rocksdb_perf_level);
 DECLARE_uint64(rocksdb_perf_slow_us);
 DECLARE_double(rocksdb_perf_sampling_ratio);
+DECLARE_double(rocksdb_op_perf_sampling_ratio);
 
 namespace curvefs {
 namespace metaserver {
@@ -68,6 +69,7 @@ enum OPERATOR_TYPE : unsigned char {
     OP_BEGIN_TRANSACTION = 12,
     OP_COMMIT_TRANSACTION = 13,
     OP_ROLLBACK_TRANSACTION = 14,
+    OP_MULTI_GET = 15,
 };
 
 class RocksDBPerfGuard {
@@ -82,9 +84,52 @@ class RocksDBPerfGuard {
  private:
     OPERATOR_TYPE opType_;
     uint64_t startTimeUs_;
+    // the perf context is owned by the RocksDBOpPerfScope outside
+    bool inOpScope_;
     static const uint32_t kPerfLevelOutOfBounds_;
 };
 
+// rocksdb perf counters of all storage operations in one metadata operator
+struct RocksDBPerfStats {
+    uint64_t blockCacheHitCount = 0;
+    // blocks missed in block cache and read from file
+    uint64_t blockReadCount = 0;
+    uint64_t blockReadBytes = 0;
+    // bytes returned to user by get, multiget and iterator
+    uint64_t readBytes = 0;
+    uint64_t memtableHitCount = 0;
+    // seeks on the child iterators (memtables and sst files)
+    uint64_t seekCount = 0;
+
+    std::string ToString() const;
+};
+
+// Sample the rocksdb perf context of the storage operations inside one
+// metadata operator (by FLAGS rocksdb_op_perf_sampling_ratio), the
+// RocksDBPerfGuard inside it doesn't touch the perf context.
+//
+// NOTE: perf context is thread local, so operators running in bthread
+// are never sampled, because they may be scheduled to another pthread.
+class RocksDBOpPerfScope {
+ public:
+    RocksDBOpPerfScope();
+
+    ~RocksDBOpPerfScope();
+
+    RocksDBOpPerfScope(const RocksDBOpPerfScope&) = delete;
+    RocksDBOpPerfScope& operator=(const RocksDBOpPerfScope&) = delete;
+
+    bool Sampled() const { return sampled_; }
+
+    // get the stats since the scope begins, REQUIRES: Sampled()
+    void GetStats(RocksDBPerfStats* stats) const;
+
+    static bool InScope();
+
+ private:
+    bool sampled_;
+};
+
 }  // namespace storage
 }  // namespace metaserver
 }  // namespace curvefs
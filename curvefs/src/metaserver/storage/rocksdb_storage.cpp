@@ -33,6 +33,7 @@
 #include "curvefs/src/metaserver/storage/rocksdb_perf.h"
 #include "curvefs/src/metaserver/storage/rocksdb_storage.h"
 #include "curvefs/src/metaserver/storage/rocksdb_options.h"
+#include "rocksdb/env.h"
 #include "rocksdb/utilities/checkpoint.h"
 #include "src/fs/local_filesystem.h"
 
@@ -221,6 +222,55 @@ Status RocksDBStorage::Get(const std::string& name,
     return ToStorageStatus(s);
 }
 
+void RocksDBStorage::MultiGet(const std::string& name,
+                              const std::vector<std::string>& keys,
+                              const std::vector<ValueType*>& values,
+                              std::vector<Status>* statuses,
+                              bool ordered) {
+    statuses->clear();
+    if (!inited_) {
+        statuses->resize(keys.size(), Status::DBClosed());
+        return;
+    } else if (keys.empty()) {
+        return;
+    }
+
+    size_t nkeys = keys.size();
+    std::vector<std::string> ikeys;
+    std::vector<ROCKSDB_NAMESPACE::Slice> slices;
+    ikeys.reserve(nkeys);
+    slices.reserve(nkeys);
+    for (const auto& key : keys) {
+        ikeys.emplace_back(ToInternalKey(name, key, ordered));
+        slices.emplace_back(ikeys.back());
+    }
+
+    std::vector<ROCKSDB_NAMESPACE::PinnableSlice> svalues(nkeys);
+    std::vector<ROCKSDB_NAMESPACE::Status> s(nkeys);
+    auto handle = GetColumnFamilyHandle(ordered);
+    {
+        RocksDBPerfGuard guard(OP_MULTI_GET);
+        if (InTransaction_) {
+            txn_->MultiGet(dbReadOptions_, handle, nkeys, slices.data(),
+                           svalues.data(), s.data());
+        } else {
+            db_->MultiGet(dbReadOptions_, handle, nkeys, slices.data(),
+                          svalues.data(), s.data());
+        }
+    }
+
+    statuses->reserve(nkeys);
+    for (size_t i = 0; i < nkeys; i++) {
+        if (s[i].ok() &&
+            !values[i]->ParseFromArray(svalues[i].data(),
+                                       static_cast<int>(svalues[i].size()))) {
+            statuses->push_back(Status::ParsedFailed());
+        } else {
+            statuses->push_back(ToStorageStatus(s[i]));
+        }
+    }
+}
+
 Status RocksDBStorage::Set(const std::string& name,
                            const std::string& key,
                            const ValueType& value,
@@ -265,6 +315,16 @@ std::shared_ptr<Iterator> RocksDBStorage::Seek(const std::string& name,
         this, ikey, 0, status, true);
 }
 
+std::shared_ptr<Iterator> RocksDBStorage::SSeekFrom(const std::string& name,
+                                                    const std::string& prefix,
+                                                    const std::string& lower) {
+    int status = inited_ ? 0 : -1;
+    auto iterator = std::make_shared<RocksDBStorageIterator>(
+        this, ToInternalKey(name, prefix, true), 0, status, true);
+    iterator->SetRange(ToInternalKey(name, lower, true));
+    return iterator;
+}
+
 std::shared_ptr<Iterator> RocksDBStorage::GetAll(const std::string& name,
                                                  bool ordered) {
     int status = inited_ ? 0 : -1;
@@ -432,6 +492,75 @@ bool DuplicateRocksdbCheckpoint(const std::string& from,
     return DoCheckpoint(db, to);
 }
 
+bool IsImmutableFile(const std::string& filename) {
+    auto endWith = [&filename](const std::string& suffix) {
+        return filename.size() >= suffix.size() &&
+               filename.compare(filename.size() - suffix.size(),
+                                suffix.size(), suffix) == 0;
+    };
+    return endWith(".sst") || endWith(".blob");
+}
+
+// Duplicate the checkpoint by hard linking its table and blob files and
+// copying the small mutable files (CURRENT, MANIFEST, OPTIONS, WAL),
+// it's what rocksdb checkpoint does but without opening the checkpoint
+// as a database, which reads the metadata of every table file.
+bool LinkRocksdbCheckpoint(const std::string& from, const std::string& to) {
+    LOG(INFO) << "Linking rocksdb storage from `" << from << "` to `" << to
+              << "`";
+
+    auto* env = rocksdb::Env::Default();
+    std::vector<std::string> children;
+    auto status = env->GetChildren(from, &children);
+    if (!status.ok()) {
+        LOG(ERROR) << "Failed to list checkpoint `" << from
+                   << "`, error: " << status.ToString();
+        return false;
+    }
+
+    status = env->CreateDirIfMissing(to);
+    if (!status.ok()) {
+        LOG(ERROR) << "Failed to create dir `" << to
+                   << "`, error: " << status.ToString();
+        return false;
+    }
+
+    for (const auto& child : children) {
+        if (child == "." || child == "..") {
+            continue;
+        }
+        std::string src = from + "/" + child;
+        std::string dest = to + "/" + child;
+        if (IsImmutableFile(child)) {
+            status = env->LinkFile(src, dest);
+        } else {
+            std::string data;
+            status = rocksdb::ReadFileToString(env, src, &data);
+            if (status.ok()) {
+                status = rocksdb::WriteStringToFile(env, data, dest,
+                                                    /*should_sync*/ true);
+            }
+        }
+        if (!status.ok()) {
+            LOG(WARNING) << "Failed to duplicate `" << src
+                         << "`, error: " << status.ToString();
+            return false;
+        }
+    }
+
+    std::unique_ptr<rocksdb::Directory> dir;
+    status = env->NewDirectory(to, &dir);
+    if (status.ok()) {
+        status = dir->Fsync();
+    }
+    if (!status.ok()) {
+        LOG(ERROR) << "Failed to sync dir `" << to
+                   << "`, error: " << status.ToString();
+        return false;
+    }
+    return true;
+}
+
 }  // namespace
 
 bool RocksDBStorage::Checkpoint(const std::string& dir,
@@ -486,8 +615,18 @@ bool RocksDBStorage::Recover(const std::string& dir) {
         return false;
     }
 
-    succ = DuplicateRocksdbCheckpoint(dir + "/" + kRocksdbCheckpointPath,
-                                      options_.dataDir);
+    // NOTE: hard link is impossible if the snapshot and the storage are
+    // in different filesystems, fall back to open and duplicate it then
+    const std::string checkpoint = dir + "/" + kRocksdbCheckpointPath;
+    succ = LinkRocksdbCheckpoint(checkpoint, options_.dataDir);
+    if (!succ) {
+        ret = options_.localFileSystem->Delete(options_.dataDir);
+        if (ret != 0) {
+            LOG(ERROR) << "Failed to delete storage dir: " << options_.dataDir;
+            return false;
+        }
+        succ = DuplicateRocksdbCheckpoint(checkpoint, options_.dataDir);
+    }
     if (!succ) {
         LOG(ERROR) << "Failed to duplicate rocksdb checkpoint";
         return false;
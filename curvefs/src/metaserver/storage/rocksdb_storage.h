@@ -122,6 +122,23 @@ class RocksDBStorage : public KVStorage, public StorageTransaction {
 
     std::shared_ptr<StorageTransaction> BeginTransaction() override;
 
+    // the iterator is bounded by the upper bound of prefix, so rocksdb
+    // stops at the end of range instead of skipping the tombstones behind
+    std::shared_ptr<Iterator> SSeekFrom(const std::string& name,
+                                        const std::string& prefix,
+                                        const std::string& lower) override;
+
+    // batch the reads by rocksdb MultiGet()
+    void HMultiGet(const std::string& name,
+                   const std::vector<std::string>& keys,
+                   const std::vector<ValueType*>& values,
+                   std::vector<Status>* statuses) override;
+
+    void SMultiGet(const std::string& name,
+                   const std::vector<std::string>& keys,
+                   const std::vector<ValueType*>& values,
+                   std::vector<Status>* statuses) override;
+
     Status Commit() override;
 
     Status Rollback() override;
@@ -151,6 +168,12 @@ class RocksDBStorage : public KVStorage, public StorageTransaction {
                ValueType* value,
                bool ordered);
 
+    void MultiGet(const std::string& name,
+                  const std::vector<std::string>& keys,
+                  const std::vector<ValueType*>& values,
+                  std::vector<Status>* statuses,
+                  bool ordered);
+
     Status Set(const std::string& name,
                const std::string& key,
                const ValueType& value,
@@ -213,6 +236,13 @@ inline Status RocksDBStorage::HGet(const std::string& name,
     return Get(name, key, value, false);
 }
 
+inline void RocksDBStorage::HMultiGet(const std::string& name,
+                                      const std::vector<std::string>& keys,
+                                      const std::vector<ValueType*>& values,
+                                      std::vector<Status>* statuses) {
+    MultiGet(name, keys, values, statuses, false);
+}
+
 inline Status RocksDBStorage::HSet(const std::string& name,
                                    const std::string& key,
                                    const ValueType& value) {
@@ -243,6 +273,13 @@ inline Status RocksDBStorage::SGet(const std::string& name,
     return Get(name, key, value, true);
 }
 
+inline void RocksDBStorage::SMultiGet(const std::string& name,
+                                      const std::vector<std::string>& keys,
+                                      const std::vector<ValueType*>& values,
+                                      std::vector<Status>* statuses) {
+    MultiGet(name, keys, values, statuses, true);
+}
+
 inline Status RocksDBStorage::SSet(const std::string& name,
                                    const std::string& key,
                                    const ValueType& value) {
@@ -335,7 +372,7 @@ class RocksDBStorageIterator : public Iterator {
         }
 
         RocksDBPerfGuard guard(OP_ITERATOR_SEEK_TO_FIRST);
-        iter_->Seek(prefix_);
+        iter_->Seek(lower_.empty() ? prefix_ : lower_);
     }
 
     void Next() {
@@ -358,11 +395,8 @@ class RocksDBStorageIterator : public Iterator {
 
     bool ParseFromValue(ValueType* value) override {
         auto slice = iter_->value();
-        std::string str(slice.data(), slice.size());
-        if (!value->ParseFromString(str)) {
-            return false;
-        }
-        return true;
+        return value->ParseFromArray(slice.data(),
+                                     static_cast<int>(slice.size()));
     }
 
     int Status() {
@@ -373,9 +407,29 @@ class RocksDBStorageIterator : public Iterator {
         prefixChecking_ = false;
     }
 
+    // Seek to `lower` instead of prefix, and stop at the upper bound of
+    // prefix. It should be invoked before SeekToFirst().
+    void SetRange(std::string lower) {
+        lower_ = std::move(lower);
+        upperBound_ = prefix_;
+        // the smallest key greater than all keys start with prefix
+        while (!upperBound_.empty() &&
+               static_cast<unsigned char>(upperBound_.back()) == 0xff) {
+            upperBound_.pop_back();
+        }
+        if (!upperBound_.empty()) {
+            upperBound_.back() = static_cast<char>(upperBound_.back() + 1);
+            upperBoundSlice_ = rocksdb::Slice(upperBound_);
+            readOptions_.iterate_upper_bound = &upperBoundSlice_;
+        }
+    }
+
  private:
     RocksDBStorage* storage_;
     std::string prefix_;
+    std::string lower_;
+    std::string upperBound_;
+    rocksdb::Slice upperBoundSlice_;
     uint64_t size_;
     int status_;
     bool prefixChecking_;
@@ -105,6 +105,46 @@ class KVStorage : public BaseStorage {
 
     virtual std::shared_ptr<StorageTransaction> BeginTransaction() = 0;
 
+    // Seek the ordered storage to the first key not less than `lower`,
+    // the keys don't start with `prefix` are beyond the range.
+    // The default implementation only seeks to `lower` and the caller
+    // should check the prefix of keys, the storage should override it
+    // if it can stop the iterator at the end of range.
+    virtual std::shared_ptr<Iterator> SSeekFrom(const std::string& name,
+                                                const std::string& prefix,
+                                                const std::string& lower) {
+        (void)prefix;
+        auto iterator = SSeek(name, lower);
+        iterator->DisablePrefixChecking();
+        return iterator;
+    }
+
+    // Get the values of multiple keys by one call, (*statuses)[i] is the
+    // result of keys[i] and the value is parsed into values[i].
+    // The default implementation gets the keys one by one, the storage
+    // should override it if it can batch the reads.
+    virtual void HMultiGet(const std::string& name,
+                           const std::vector<std::string>& keys,
+                           const std::vector<ValueType*>& values,
+                           std::vector<Status>* statuses) {
+        statuses->clear();
+        statuses->reserve(keys.size());
+        for (size_t i = 0; i < keys.size(); i++) {
+            statuses->push_back(HGet(name, keys[i], values[i]));
+        }
+    }
+
+    virtual void SMultiGet(const std::string& name,
+                           const std::vector<std::string>& keys,
+                           const std::vector<ValueType*>& values,
+                           std::vector<Status>* statuses) {
+        statuses->clear();
+        statuses->reserve(keys.size());
+        for (size_t i = 0; i < keys.size(); i++) {
+            statuses->push_back(SGet(name, keys[i], values[i]));
+        }
+    }
+
     // Save storage's data into the destination directory, and return relative
     // filenames of current checkpoint under the directory
     virtual bool Checkpoint(const std::string& dir,
@@ -127,12 +127,19 @@ bool TxManager::Init() {
 }
 
 MetaStatusCode TxManager::HandleRenameTx(const std::vector<Dentry>& dentrys,
-                                         int64_t logIndex) {
+                                         int64_t logIndex, bool* committed) {
     auto rc = PreCheck(dentrys);
     if (rc != MetaStatusCode::OK) {
         return rc;
     }
 
+    if (committed != nullptr) {
+        *committed = CanCommitInPlace(dentrys);
+        if (*committed) {
+            return CommitInPlace(dentrys, logIndex);
+        }
+    }
+
     // Handle pending TX
     RenameTx pendingTx;
     if (FindPendingTx(&pendingTx)) {
@@ -169,6 +176,54 @@ MetaStatusCode TxManager::HandleRenameTx(const std::vector<Dentry>& dentrys,
     return MetaStatusCode::OK;
 }
 
+// The tx can skip the pending state if both the dentrys are in this partition,
+// it holds no lock of mds, and the pending tx (if any) is committed by mds,
+// which is known because the client has seen its txid.
+bool TxManager::CanCommitInPlace(const std::vector<Dentry>& dentrys) {
+    if (dentrys.size() != 2 || dentrys[0].txsequence() != 0 ||
+        dentrys[0].txid() == 0) {
+        return false;
+    }
+    const Dentry& src = dentrys[0];
+    const Dentry& dst = dentrys[1];
+    if (src.parentinodeid() == dst.parentinodeid() &&
+        src.name() == dst.name()) {
+        return false;
+    }
+    RenameTx pendingTx;
+    if (FindPendingTx(&pendingTx)) {
+        return src.txid() > pendingTx.GetTxId();
+    }
+    return true;
+}
+
+// Commit the rename with the txid the client reads, instead of the next one
+// which becomes visible after mds commits the tx, so it's visible to the
+// readers at once.
+MetaStatusCode TxManager::CommitInPlace(const std::vector<Dentry>& dentrys,
+                                        int64_t logIndex) {
+    RenameTx pendingTx;
+    if (FindPendingTx(&pendingTx)) {
+        if (!pendingTx.Commit(logIndex)) {
+            LOG(ERROR) << "Commit pending tx failed, pendingTx: " << pendingTx;
+            return MetaStatusCode::HANDLE_PENDING_TX_FAILED;
+        }
+        DeletePendingTx();
+    }
+
+    uint64_t txId = dentrys[0].txid() - 1;
+    Dentry src = dentrys[0];
+    src.set_txid(txId);
+    Dentry dst = dentrys[1];
+    dst.set_txid(txId);
+    dst.set_flag(dst.flag() & ~DentryFlag::TRANSACTION_PREPARE_FLAG);
+    auto rc = storage_->Rename(src, dst, logIndex);
+    if (rc == MetaStatusCode::IDEMPOTENCE_OK) {
+        rc = MetaStatusCode::OK;
+    }
+    return rc;
+}
+
 bool TxManager::InsertPendingTx(const RenameTx& tx) {
     WriteLockGuard w(rwLock_);
     if (pendingTx_ == EMPTY_TX) {
@@ -76,8 +76,11 @@ class TxManager {
     explicit TxManager(std::shared_ptr<DentryStorage> storage,
                        common::PartitionInfo partitionInfo);
 
+    // NOTE: if committed is not nullptr, the tx is committed in place when
+    // it can, and *committed tells whether it's committed or only prepared
     MetaStatusCode HandleRenameTx(const std::vector<Dentry>& dentrys,
-                                  int64_t logIndex);
+                                  int64_t logIndex,
+                                  bool* committed = nullptr);
 
     MetaStatusCode PreCheck(const std::vector<Dentry>& dentrys);
 
@@ -93,6 +96,12 @@ class TxManager {
 
     bool Init();
 
+ private:
+    bool CanCommitInPlace(const std::vector<Dentry>& dentrys);
+
+    MetaStatusCode CommitInPlace(const std::vector<Dentry>& dentrys,
+                                 int64_t logIndex);
+
  private:
     RWLock rwLock_;
 
@@ -22,6 +22,10 @@
 
 #include "curvefs/src/metaserver/trash.h"
 
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
 #include "curvefs/proto/mds.pb.h"
 #include "curvefs/src/metaserver/inode_storage.h"
 #include "src/common/timeutility.h"
@@ -41,11 +45,21 @@ DEFINE_uint32(trash_scanPeriodSec, 600, "recycle bin scan interval");
 DEFINE_validator(trash_expiredAfterSec, pass_uint32);
 DEFINE_validator(trash_scanPeriodSec, pass_uint32);
 
+constexpr uint32_t TrashImpl::kBucketSec;
+
 void TrashOption::InitTrashOptionFromConf(std::shared_ptr<Configuration> conf) {
     conf->GetValueFatalIfFail("trash.scanPeriodSec", &scanPeriodSec);
     FLAGS_trash_scanPeriodSec = scanPeriodSec;
     conf->GetValueFatalIfFail("trash.expiredAfterSec", &expiredAfterSec);
     FLAGS_trash_expiredAfterSec = expiredAfterSec;
+    LOG_IF(WARNING, !conf->GetUInt32Value("trash.deleteBatchSize",
+                                          &deleteBatchSize))
+        << "config no trash.deleteBatchSize info, using default value "
+        << deleteBatchSize;
+    LOG_IF(WARNING, !conf->GetUInt32Value("trash.maxDeletePerSec",
+                                          &maxDeletePerSec))
+        << "config no trash.maxDeletePerSec info, using default value "
+        << maxDeletePerSec;
 }
 
 void TrashImpl::Init(const TrashOption &option) {
@@ -65,48 +79,142 @@ void TrashImpl::Add(uint32_t fsId, uint64_t inodeId, uint32_t dtime) {
     if (isStop_) {
         return;
     }
-    trashItems_.push_back(item);
+    trashItems_[fsId][dtime / kBucketSec].push_back(item);
     VLOG(6) << "Add Trash Item success, item.fsId = " << item.fsId
             << ", item.inodeId = " << item.inodeId
             << ", item.dtime = " << item.dtime;
 }
 
+void TrashImpl::AddItems(const std::vector<TrashItem> &items) {
+    LockGuard lg(itemsMutex_);
+    for (const auto &item : items) {
+        trashItems_[item.fsId][item.dtime / kBucketSec].push_back(item);
+    }
+}
+
 void TrashImpl::ScanTrash() {
     LockGuard lgScan(scanMutex_);
-    std::list<TrashItem> temp;
-    {
-        LockGuard lgItems(itemsMutex_);
-        trashItems_.swap(temp);
+    std::vector<TrashItem> expired;
+    TakeExpiredItems(TimeUtility::GetTimeofDaySec(), &expired);
+    if (expired.empty()) {
+        return;
     }
 
-    for (auto it = temp.begin(); it != temp.end();) {
+    uint32_t batchSize = std::max(options_.deleteBatchSize, 1u);
+    uint64_t startUs = TimeUtility::GetTimeofDayUs();
+    uint32_t deleted = 0;
+    std::vector<TrashItem> batch;
+    std::vector<TrashItem> failed;
+    for (const auto &item : expired) {
         if (isStop_) {
             return;
         }
-        if (NeedDelete(*it)) {
-            MetaStatusCode ret = DeleteInodeAndData(*it);
-            if (MetaStatusCode::NOT_FOUND == ret) {
-                it = temp.erase(it);
-                continue;
-            }
-            if (ret != MetaStatusCode::OK) {
-                LOG(ERROR) << "DeleteInodeAndData fail, fsId = " << it->fsId
-                           << ", inodeId = " << it->inodeId
-                           << ", ret = " << MetaStatusCode_Name(ret);
-                it++;
-                continue;
-            }
-            VLOG(6) << "Trash Delete Inode, fsId = " << it->fsId
-                    << ", inodeId = " << it->inodeId;
-            it = temp.erase(it);
-        } else {
-            it++;
+        MetaStatusCode ret = DeleteData(item);
+        if (MetaStatusCode::NOT_FOUND == ret) {
+            continue;
+        }
+        if (ret != MetaStatusCode::OK) {
+            LOG(ERROR) << "DeleteInodeAndData fail, fsId = " << item.fsId
+                       << ", inodeId = " << item.inodeId
+                       << ", ret = " << MetaStatusCode_Name(ret);
+            failed.push_back(item);
+            continue;
+        }
+        batch.push_back(item);
+        if (batch.size() >= batchSize) {
+            DeleteInodes(batch, &failed);
+            deleted += batch.size();
+            batch.clear();
+            Throttle(startUs, deleted);
         }
     }
+    DeleteInodes(batch, &failed);
 
+    // retry in the next scan
+    AddItems(failed);
+}
+
+void TrashImpl::TakeExpiredItems(uint32_t now, std::vector<TrashItem> *items) {
+    std::vector<uint32_t> fsIds;
     {
         LockGuard lgItems(itemsMutex_);
-        trashItems_.splice(trashItems_.end(), temp);
+        for (const auto &pair : trashItems_) {
+            fsIds.push_back(pair.first);
+        }
+    }
+
+    for (auto fsId : fsIds) {
+        // for compatibility, if fs recycleTimeHour is 0, use old trash logic
+        // and wait expiredAfterSec, otherwise the items are expired at once
+        uint32_t delay = GetFsRecycleTimeHour(fsId) == 0 ?
+                         FLAGS_trash_expiredAfterSec : 0;
+        if (now < delay) {
+            continue;
+        }
+        // the items with dtime not after deadline are expired
+        uint64_t deadline = now - delay;
+        uint64_t partial = (deadline + 1) / kBucketSec;
+
+        LockGuard lgItems(itemsMutex_);
+        auto fsIt = trashItems_.find(fsId);
+        if (fsIt == trashItems_.end()) {
+            continue;
+        }
+        TrashBuckets &buckets = fsIt->second;
+        auto it = buckets.begin();
+        // all the items of buckets before the partial one are expired
+        for (; it != buckets.end() && it->first < partial;
+             it = buckets.erase(it)) {
+            items->insert(items->end(), it->second.begin(), it->second.end());
+        }
+        if (it != buckets.end() && it->first == partial) {
+            auto &bucket = it->second;
+            auto mid = std::partition(bucket.begin(), bucket.end(),
+                [deadline](const TrashItem &item) {
+                    return item.dtime > deadline;
+                });
+            items->insert(items->end(), mid, bucket.end());
+            bucket.erase(mid, bucket.end());
+            if (bucket.empty()) {
+                buckets.erase(it);
+            }
+        }
+        if (buckets.empty()) {
+            trashItems_.erase(fsIt);
+        }
+    }
+}
+
+void TrashImpl::DeleteInodes(const std::vector<TrashItem> &items,
+                             std::vector<TrashItem> *failed) {
+    if (items.empty()) {
+        return;
+    }
+    std::vector<Key4Inode> keys;
+    keys.reserve(items.size());
+    for (const auto &item : items) {
+        keys.emplace_back(item.fsId, item.inodeId);
+    }
+    MetaStatusCode ret = inodeStorage_->ForceDelete(keys);
+    if (ret != MetaStatusCode::OK) {
+        LOG(ERROR) << "Delete Inodes fail, count = " << keys.size()
+                   << ", ret = " << MetaStatusCode_Name(ret);
+        failed->insert(failed->end(), items.begin(), items.end());
+        return;
+    }
+    VLOG(6) << "Trash Delete Inodes, count = " << keys.size();
+}
+
+void TrashImpl::Throttle(uint64_t startUs, uint32_t deleted) {
+    if (options_.maxDeletePerSec == 0) {
+        return;
+    }
+    uint64_t expectedUs =
+        static_cast<uint64_t>(deleted) * 1000000 / options_.maxDeletePerSec;
+    uint64_t elapsedUs = TimeUtility::GetTimeofDayUs() - startUs;
+    if (expectedUs > elapsedUs) {
+        std::this_thread::sleep_for(
+            std::chrono::microseconds(expectedUs - elapsedUs));
     }
 }
 
@@ -118,34 +226,6 @@ bool TrashImpl::IsStop() {
     return isStop_;
 }
 
-bool TrashImpl::NeedDelete(const TrashItem &item) {
-    uint32_t now = TimeUtility::GetTimeofDaySec();
-    Inode inode;
-    MetaStatusCode ret =
-        inodeStorage_->Get(Key4Inode(item.fsId, item.inodeId), &inode);
-    if (MetaStatusCode::NOT_FOUND == ret) {
-        LOG(WARNING) << "GetInode find inode not exist, fsId = " << item.fsId
-                     << ", inodeId = " << item.inodeId
-                     << ", ret = " << MetaStatusCode_Name(ret);
-        return true;
-    } else if (ret != MetaStatusCode::OK) {
-        LOG(WARNING) << "GetInode fail, fsId = " << item.fsId
-                     << ", inodeId = " << item.inodeId
-                     << ", ret = " << MetaStatusCode_Name(ret);
-        return false;
-    }
-
-    // for compatibility, if fs recycleTimeHour is 0, use old trash logic
-    // if fs recycleTimeHour is 0, use trash wait until expiredAfterSec
-    // if fs recycleTimeHour is not 0, return true
-    uint64_t recycleTimeHour = GetFsRecycleTimeHour(item.fsId);
-    if (recycleTimeHour == 0) {
-        return ((now - item.dtime) >= FLAGS_trash_expiredAfterSec);
-    } else {
-        return true;
-    }
-}
-
 uint64_t TrashImpl::GetFsRecycleTimeHour(uint32_t fsId) {
     FsInfo fsInfo;
     uint64_t recycleTimeHour = 0;
@@ -176,7 +256,7 @@ uint64_t TrashImpl::GetFsRecycleTimeHour(uint32_t fsId) {
     return recycleTimeHour;
 }
 
-MetaStatusCode TrashImpl::DeleteInodeAndData(const TrashItem &item) {
+MetaStatusCode TrashImpl::DeleteData(const TrashItem &item) {
     Inode inode;
     MetaStatusCode ret =
         inodeStorage_->Get(Key4Inode(item.fsId, item.inodeId), &inode);
@@ -242,20 +322,19 @@ MetaStatusCode TrashImpl::DeleteInodeAndData(const TrashItem &item) {
             return MetaStatusCode::S3_DELETE_ERR;
         }
     }
-    ret = inodeStorage_->ForceDelete(Key4Inode(item.fsId, item.inodeId));
-    if (ret != MetaStatusCode::OK && ret != MetaStatusCode::NOT_FOUND) {
-        LOG(ERROR) << "Delete Inode fail, fsId = " << item.fsId
-                   << ", inodeId = " << item.inodeId
-                   << ", ret = " << MetaStatusCode_Name(ret);
-        return ret;
-    }
     return MetaStatusCode::OK;
 }
 
 void TrashImpl::ListItems(std::list<TrashItem> *items) {
     LockGuard lgScan(scanMutex_);
     LockGuard lgItems(itemsMutex_);
-    *items = trashItems_;
+    items->clear();
+    for (const auto &fsItems : trashItems_) {
+        for (const auto &bucket : fsItems.second) {
+            items->insert(items->end(), bucket.second.begin(),
+                          bucket.second.end());
+        }
+    }
 }
 
 }  // namespace metaserver
@@ -26,7 +26,9 @@
 #include <cstdint>
 #include <memory>
 #include <list>
+#include <map>
 #include <unordered_map>
+#include <vector>
 
 #include "src/common/configuration.h"
 #include "src/common/concurrent/concurrent.h"
@@ -60,11 +62,17 @@ struct TrashItem {
 struct TrashOption {
     uint32_t scanPeriodSec;
     uint32_t expiredAfterSec;
+    // inodes deleted from storage in one transaction
+    uint32_t deleteBatchSize;
+    // max inodes deleted per second of one trash, 0 means no limit
+    uint32_t maxDeletePerSec;
     std::shared_ptr<S3ClientAdaptor>  s3Adaptor;
     std::shared_ptr<MdsClient> mdsClient;
     TrashOption()
       : scanPeriodSec(0),
         expiredAfterSec(0),
+        deleteBatchSize(128),
+        maxDeletePerSec(0),
         s3Adaptor(nullptr),
         mdsClient(nullptr) {}
 
@@ -109,9 +117,25 @@ class TrashImpl : public Trash {
     bool IsStop() override;
 
  private:
-    bool NeedDelete(const TrashItem &item);
+    // items of a fs indexed by the bucket of their dtime
+    using TrashBuckets = std::map<uint32_t, std::vector<TrashItem>>;
 
-    MetaStatusCode DeleteInodeAndData(const TrashItem &item);
+    // seconds of dtime in a bucket
+    static constexpr uint32_t kBucketSec = 60;
+
+    // take out the items expired at now, walking the expired buckets only
+    void TakeExpiredItems(uint32_t now, std::vector<TrashItem> *items);
+
+    MetaStatusCode DeleteData(const TrashItem &item);
+
+    // delete the inodes of items the data of which are deleted,
+    // in one transaction
+    void DeleteInodes(const std::vector<TrashItem> &items,
+                      std::vector<TrashItem> *failed);
+
+    void Throttle(uint64_t startUs, uint32_t deleted);
+
+    void AddItems(const std::vector<TrashItem> &items);
 
     uint64_t GetFsRecycleTimeHour(uint32_t fsId);
 
@@ -121,7 +145,7 @@ class TrashImpl : public Trash {
     std::shared_ptr<MdsClient> mdsClient_;
     std::unordered_map<uint32_t, FsInfo> fsInfoMap_;
 
-    std::list<TrashItem> trashItems_;
+    std::unordered_map<uint32_t, TrashBuckets> trashItems_;
 
     mutable Mutex itemsMutex_;
 
@@ -21,6 +21,7 @@
  */
 
 #include <glog/logging.h>
+#include <algorithm>
 #include <utility>
 #include "absl/memory/memory.h"
 #include "curvefs/proto/space.pb.h"
@@ -51,10 +52,17 @@ BlockGroupManagerImpl::BlockGroupManagerImpl(
       allocatorOption_(allocatorOption) {}
 
 bool BlockGroupManagerImpl::AllocateBlockGroup(
+    uint32_t count,
     std::vector<AllocatorAndBitmapUpdater>* out) {
+    count = std::max(count, option_.blockGroupAllocateOnce);
+    if (option_.blockGroupMaxAllocateOnce != 0) {
+        count = std::min(count, std::max(option_.blockGroupMaxAllocateOnce,
+                                         option_.blockGroupAllocateOnce));
+    }
+
     std::vector<BlockGroup> groups;
     auto err = mdsClient_->AllocateVolumeBlockGroup(
-        option_.fsId, option_.blockGroupAllocateOnce, option_.owner, &groups);
+        option_.fsId, count, option_.owner, &groups);
 
     LOG_IF(ERROR, err != SpaceErrCode::SpaceOk)
         << "Allocate volume block group failed, err: "
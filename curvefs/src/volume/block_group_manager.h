@@ -45,7 +45,13 @@ class BlockGroupManager {
  public:
     virtual ~BlockGroupManager() = default;
 
+    /**
+     * @brief Allocate block groups from mds
+     * @param count number of block groups wanted, which is limited in
+     *        [blockGroupAllocateOnce, blockGroupMaxAllocateOnce]
+     */
     virtual bool AllocateBlockGroup(
+        uint32_t count,
         std::vector<AllocatorAndBitmapUpdater>* out) = 0;
 
     virtual bool ReleaseAllBlockGroups() = 0;
@@ -66,6 +72,7 @@ class BlockGroupManagerImpl final : public BlockGroupManager {
                           const AllocatorOption& allocatorOption);
 
     bool AllocateBlockGroup(
+        uint32_t count,
         std::vector<AllocatorAndBitmapUpdater>* out) override;
 
     bool AcquireBlockGroup(uint64_t blockGroupOffset,
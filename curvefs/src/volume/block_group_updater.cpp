@@ -24,15 +24,21 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <mutex>
 
 #include "absl/memory/memory.h"
 #include "curvefs/src/volume/block_device_client.h"
+#include "src/common/fast_align.h"
 
 namespace curvefs {
 namespace volume {
 
+using ::curve::common::align_down;
+using ::curve::common::align_up;
+
 void BlockGroupBitmapUpdater::Update(const Extent& ext, Op op) {
     assert(ext.len != 0);
     std::lock_guard<std::mutex> lk(bitmapMtx_);
@@ -48,37 +54,74 @@ void BlockGroupBitmapUpdater::Update(const Extent& ext, Op op) {
         bitmap_.Clear(startIdx, endIdx);
     }
 
-    dirty_ = true;
+    MarkDirty(startIdx / curve::common::BITMAP_UNIT_SIZE,
+              endIdx / curve::common::BITMAP_UNIT_SIZE + 1);
 }
 
-bool BlockGroupBitmapUpdater::Sync() {
-    std::unique_ptr<char[]> bitmap;
-    std::lock_guard<std::mutex> lk(syncMtx_);
-
-    {
-        std::lock_guard<std::mutex> lk(bitmapMtx_);
-
-        if (!dirty_) {
-            return true;
-        }
+void BlockGroupBitmapUpdater::MarkDirty(uint64_t begin, uint64_t end) {
+    end = std::min<uint64_t>(end, bitmapRange_.length);
+    if (begin >= end) {
+        return;
+    }
 
-        bitmap = absl::make_unique<char[]>(bitmapRange_.length);
-        mempcpy(bitmap.get(), bitmap_.GetBitmap(), bitmapRange_.length);
-        dirty_ = false;
+    if (dirtyBegin_ == dirtyEnd_) {
+        dirtyBegin_ = begin;
+        dirtyEnd_ = end;
+    } else {
+        dirtyBegin_ = std::min(dirtyBegin_, begin);
+        dirtyEnd_ = std::max(dirtyEnd_, end);
     }
+}
 
-    auto ret = blockDev_->Write(bitmap.get(), bitmapRange_.offset,
-                                bitmapRange_.length);
+bool BlockGroupBitmapUpdater::SyncBegin(SyncContext* ctx) {
+    ctx->lock = std::unique_lock<std::mutex>(syncMtx_);
 
-    if (ret < 0 || static_cast<size_t>(ret) != bitmapRange_.length) {
-        LOG(ERROR) << "Sync block group bitmap failed, err: " << ret
-                   << ", block group offset: " << groupOffset_;
+    std::lock_guard<std::mutex> lk(bitmapMtx_);
+    if (dirtyBegin_ == dirtyEnd_) {
+        ctx->lock.unlock();
         return false;
     }
 
-    dirty_ = false;
+    // only write the dirty blocks of bitmap
+    ctx->begin = align_down<uint64_t>(dirtyBegin_, blockSize_);
+    ctx->end = std::min<uint64_t>(align_up<uint64_t>(dirtyEnd_, blockSize_),
+                                  bitmapRange_.length);
+    dirtyBegin_ = dirtyEnd_ = 0;
+
+    uint64_t length = ctx->end - ctx->begin;
+    ctx->data = absl::make_unique<char[]>(length);
+    memcpy(ctx->data.get(), bitmap_.GetBitmap() + ctx->begin, length);
+    ctx->part = WritePart(bitmapRange_.offset + ctx->begin, length,
+                          ctx->data.get());
     return true;
 }
 
+void BlockGroupBitmapUpdater::SyncEnd(SyncContext* ctx, bool success) {
+    if (!success) {
+        LOG(ERROR) << "Sync block group bitmap failed, block group offset: "
+                   << groupOffset_ << ", bitmap range: [" << ctx->begin
+                   << ", " << ctx->end << ")";
+
+        std::lock_guard<std::mutex> lk(bitmapMtx_);
+        MarkDirty(ctx->begin, ctx->end);
+    }
+
+    ctx->data.reset();
+    ctx->lock.unlock();
+}
+
+bool BlockGroupBitmapUpdater::Sync() {
+    SyncContext ctx;
+    if (!SyncBegin(&ctx)) {
+        return true;
+    }
+
+    auto ret = blockDev_->Write(ctx.part.data, ctx.part.offset,
+                                ctx.part.length);
+    bool success = ret >= 0 && static_cast<size_t>(ret) == ctx.part.length;
+    SyncEnd(&ctx, success);
+    return success;
+}
+
 }  // namespace volume
 }  // namespace curvefs
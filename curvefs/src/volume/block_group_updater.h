@@ -23,6 +23,7 @@
 #ifndef CURVEFS_SRC_VOLUME_BLOCK_GROUP_UPDATER_H_
 #define CURVEFS_SRC_VOLUME_BLOCK_GROUP_UPDATER_H_
 
+#include <memory>
 #include <mutex>
 #include <utility>
 
@@ -50,7 +51,8 @@ class BlockGroupBitmapUpdater {
                             uint64_t groupOffset,
                             const BitmapRange& range,
                             BlockDeviceClient* blockDev)
-        : dirty_(false),
+        : dirtyBegin_(0),
+          dirtyEnd_(0),
           bitmap_(std::move(bitmap)),
           blockSize_(blockSize),
           groupSize_(groupSize),
@@ -72,10 +74,39 @@ class BlockGroupBitmapUpdater {
      */
     bool Sync();
 
+    // a sync in progress, it holds the sync lock of updater until SyncEnd()
+    struct SyncContext {
+        std::unique_lock<std::mutex> lock;
+        std::unique_ptr<char[]> data;
+        // synced range in bitmap, aligned to block size
+        uint64_t begin = 0;
+        uint64_t end = 0;
+        WritePart part;
+    };
+
+    /**
+     * @brief Begin to sync the dirty range of bitmap, the caller writes
+     *        `ctx->part` to backend storage and then calls SyncEnd()
+     * @return return false if bitmap isn't dirty
+     */
+    bool SyncBegin(SyncContext* ctx);
+
+    /**
+     * @brief Finish a sync began by SyncBegin()
+     * @param success whether `ctx->part` is written, the synced range is
+     *        marked dirty again on failure
+     */
+    void SyncEnd(SyncContext* ctx, bool success);
+
+ private:
+    void MarkDirty(uint64_t begin, uint64_t end);
+
  private:
     std::mutex bitmapMtx_;
     std::mutex syncMtx_;
-    bool dirty_;
+    // dirty bytes of bitmap, [dirtyBegin_, dirtyEnd_)
+    uint64_t dirtyBegin_;
+    uint64_t dirtyEnd_;
     Bitmap bitmap_;
     uint32_t blockSize_;
     uint32_t groupSize_;
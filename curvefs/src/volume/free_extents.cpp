@@ -25,6 +25,7 @@
 #include <glog/logging.h>
 
 #include <iostream>
+#include <iterator>
 #include <ostream>
 #include <sstream>
 #include <utility>
@@ -47,7 +48,7 @@ FreeExtents::FreeExtents(const uint64_t off, const uint64_t len)
       extents_(),
       blocks_() {
     if (len != 0) {
-        extents_.emplace(off, maxLength_);
+        InsertExtent(off, maxLength_);
     }
 }
 
@@ -71,6 +72,45 @@ FreeExtents::FreeExtents(const uint64_t maxExtentSize,
       extents_(),
       blocks_() {}
 
+FreeExtents::ExtentIter FreeExtents::InsertExtent(const uint64_t off,
+                                                  const uint64_t len) {
+    auto r = extents_.emplace(off, len);
+    if (r.second) {
+        sizeIndex_.emplace(len, off);
+    }
+
+    return r.first;
+}
+
+FreeExtents::ExtentIter FreeExtents::EraseExtent(ExtentIter iter) {
+    sizeIndex_.erase({iter->second, iter->first});
+    return extents_.erase(iter);
+}
+
+void FreeExtents::ResizeExtent(ExtentIter iter, const uint64_t len) {
+    sizeIndex_.erase({iter->second, iter->first});
+    iter->second = len;
+    sizeIndex_.emplace(len, iter->first);
+}
+
+uint64_t FreeExtents::AllocFromExtent(ExtentIter iter,
+                                      const uint64_t need,
+                                      std::vector<Extent>* exts) {
+    if (iter->second <= need) {
+        uint64_t len = iter->second;
+        exts->emplace_back(iter->first, len);
+        EraseExtent(iter);
+        return len;
+    }
+
+    auto newOff = iter->first + need;
+    auto newLen = iter->second - need;
+    exts->emplace_back(iter->first, need);
+    EraseExtent(iter);
+    InsertExtent(newOff, newLen);
+    return need;
+}
+
 uint64_t FreeExtents::AllocInternal(const uint64_t size,
                                     const AllocateHint& hint,
                                     std::vector<Extent>* exts) {
@@ -79,31 +119,14 @@ uint64_t FreeExtents::AllocInternal(const uint64_t size,
     }
 
     uint64_t need = size;
-    std::map<uint64_t, uint64_t>::const_iterator iter;
 
     // 1. find extents that satisfy hint.leftOffset
     if (hint.leftOffset != AllocateHint::INVALID_OFFSET) {
-        iter = extents_.lower_bound(hint.leftOffset);
-
-        if (iter != extents_.end() && iter->first == hint.leftOffset) {
-            if (iter->second >= need) {
-                exts->emplace_back(iter->first, need);
-
-                if (iter->second == need) {
-                    extents_.erase(iter);
-                } else {
-                    auto newOff = iter->first + need;
-                    auto newLen = iter->second - need;
-                    extents_.erase(iter);
-                    extents_.emplace(newOff, newLen);
-                }
-
+        auto iter = extents_.find(hint.leftOffset);
+        if (iter != extents_.end()) {
+            need -= AllocFromExtent(iter, need, exts);
+            if (need == 0) {
                 return size;
-            } else {
-                need -= iter->second;
-                exts->emplace_back(iter->first, iter->second);
-
-                extents_.erase(iter);
             }
         }
     }
@@ -111,74 +134,29 @@ uint64_t FreeExtents::AllocInternal(const uint64_t size,
     // 2. find extents that satisfy hint.rightOffset
     if (hint.rightOffset != AllocateHint::INVALID_OFFSET &&
         hint.rightOffset >= need) {
-        iter = extents_.lower_bound(hint.rightOffset - need);
-        if (iter != extents_.end() &&
-            iter->first == (hint.rightOffset - need)) {
-            if (iter->second >= need) {
-                exts->emplace_back(iter->first, need);
-
-                if (iter->second == need) {
-                    extents_.erase(iter);
-                } else {
-                    auto newOff = iter->first + need;
-                    auto newLen = iter->second - need;
-                    extents_.erase(iter);
-                    extents_.emplace(newOff, newLen);
-                }
-
+        auto iter = extents_.find(hint.rightOffset - need);
+        if (iter != extents_.end()) {
+            need -= AllocFromExtent(iter, need, exts);
+            if (need == 0) {
                 return size;
-            } else {
-                need -= iter->second;
-                exts->emplace_back(iter->first, iter->second);
-
-                extents_.erase(iter);
             }
         }
     }
 
     // both leftOffset and rightOffset aren't satisfied
-    // first loop find a extent that satisfy needed size
-    iter = extents_.begin();
-    while (iter != extents_.end()) {
-        if (iter->second >= need) {
-            exts->emplace_back(iter->first, need);
-
-            // modify this extents
-            if (iter->second == need) {
-                extents_.erase(iter);
-            } else {
-                auto newOff = iter->first + need;
-                auto newLen = iter->second - need;
-                extents_.erase(iter);
-                extents_.emplace(newOff, newLen);
-            }
-
-            return size;
-        } else {
-            ++iter;
-        }
+    // find the smallest extent that satisfy needed size
+    auto best = sizeIndex_.lower_bound({need, 0});
+    if (best != sizeIndex_.end()) {
+        need -= AllocFromExtent(extents_.find(best->second), need, exts);
+        return size;
     }
 
-    // second loop consume all existing extent
-    iter = extents_.begin();
+    // no extent is big enough, consume existing extents by offset
+    auto iter = extents_.begin();
     while (need > 0 && iter != extents_.end()) {
-        if (iter->second <= need) {
-            need -= iter->second;
-            exts->emplace_back(iter->first, iter->second);
-
-            // remove this extent
-            iter = extents_.erase(iter);
-        } else {  // iter->second > need
-            exts->emplace_back(iter->first, need);
-
-            auto newOff = iter->first + need;
-            auto newLen = iter->second - need;
-
-            extents_.erase(iter);
-            extents_.emplace(newOff, newLen);
-
-            return size;
-        }
+        auto next = std::next(iter);
+        need -= AllocFromExtent(iter, need, exts);
+        iter = next;
     }
 
     return size - need;
@@ -218,7 +196,7 @@ void FreeExtents::DeAllocInternal(const uint64_t off, const uint64_t len) {
 
     if (available_ == 0) {
         // FIXME: off/len may need recycle to blocks
-        extents_.emplace(off, len);
+        InsertExtent(off, len);
         return;
     }
 
@@ -229,22 +207,22 @@ void FreeExtents::DeAllocInternal(const uint64_t off, const uint64_t len) {
         --iter;
     }
     if ((iter->first + iter->second) == off) {
-        iter->second += len;
+        ResizeExtent(iter, iter->second + len);
         curIter = iter;
     } else {
         // TODO(wuhanqing): should tackle iter->first + iter->second > off ?
-        auto r = extents_.emplace(off, len);
-        curIter = r.first;
+        curIter = InsertExtent(off, len);
     }
 
     // try merge with right extent
     const auto endOff = curIter->first + curIter->second;
-    iter = extents_.lower_bound(endOff);
-    if (iter != extents_.end() && iter->first == endOff) {
-        curIter->second += iter->second;
+    iter = extents_.find(endOff);
+    if (iter != extents_.end()) {
+        auto rightLen = iter->second;
 
         // erase current iterator
-        extents_.erase(iter);
+        EraseExtent(iter);
+        ResizeExtent(curIter, curIter->second + rightLen);
     }
 
     // split it if it's big enough
@@ -256,21 +234,21 @@ void FreeExtents::DeAllocInternal(const uint64_t off, const uint64_t len) {
             }
 
             blocks_.emplace(curIter->first, curIter->second);
-            extents_.erase(curIter);
+            EraseExtent(curIter);
             return;
         } else {
             auto start = curIter->first;
             auto end = start + curIter->second;
-            extents_.erase(curIter);
+            EraseExtent(curIter);
 
             auto alignStart = align_up(start, maxExtentSize_);
             auto alignEnd = align_down(end, maxExtentSize_);
 
             if (start != alignStart) {
-                extents_.emplace(start, alignStart - start);
+                InsertExtent(start, alignStart - start);
             }
             if (end != alignEnd) {
-                extents_.emplace(alignEnd, end - alignEnd);
+                InsertExtent(alignEnd, end - alignEnd);
             }
 
             while (alignStart < alignEnd) {
@@ -291,12 +269,12 @@ void FreeExtents::MarkUsedInternal(const uint64_t off, const uint64_t len) {
     auto iter = extents_.lower_bound(off);
     if (iter != extents_.end() && iter->first == off) {
         if (iter->second == len) {
-            extents_.erase(iter);
+            EraseExtent(iter);
         } else {
             auto newOff = iter->first + len;
             auto newLen = iter->second - len;
-            extents_.erase(iter);
-            extents_.emplace(newOff, newLen);
+            EraseExtent(iter);
+            InsertExtent(newOff, newLen);
         }
     } else {
         if (iter != extents_.begin()) {
@@ -304,19 +282,16 @@ void FreeExtents::MarkUsedInternal(const uint64_t off, const uint64_t len) {
         }
 
         if ((iter->first + iter->second) == (off + len)) {
-            auto newOff = iter->first;
-            auto newLen = iter->second - len;
-            extents_.erase(iter);
-            extents_.emplace(newOff, newLen);
+            ResizeExtent(iter, iter->second - len);
         } else {
             // [off, len] is in the middle of [iter->first, iter->second]
             auto leftOff = iter->first;
             auto leftLen = off - iter->first;
             auto rightOff = off + len;
             auto rightLen = (iter->first + iter->second) - rightOff;
-            extents_.erase(iter);
-            extents_.emplace(leftOff, leftLen);
-            extents_.emplace(rightOff, rightLen);
+            EraseExtent(iter);
+            InsertExtent(leftOff, leftLen);
+            InsertExtent(rightOff, rightLen);
         }
     }
 }
@@ -25,9 +25,11 @@
 
 #include <cstdint>
 #include <map>
+#include <utility>
 #include <vector>
 #include <cassert>
 
+#include "absl/container/btree_set.h"
 #include "curvefs/src/volume/common.h"
 
 namespace curvefs {
@@ -118,6 +120,20 @@ class FreeExtents {
 
     void MarkUsedInternal(const uint64_t off, const uint64_t len);
 
+    using ExtentIter = std::map<uint64_t, uint64_t>::iterator;
+
+    // below helpers keep `extents_` and `sizeIndex_` consistent
+    ExtentIter InsertExtent(const uint64_t off, const uint64_t len);
+
+    ExtentIter EraseExtent(ExtentIter iter);
+
+    void ResizeExtent(ExtentIter iter, const uint64_t len);
+
+    // allocate `need` bytes from the head of extent, and return allocated size
+    uint64_t AllocFromExtent(ExtentIter iter,
+                             const uint64_t need,
+                             std::vector<Extent>* exts);
+
  private:
     const uint64_t startOffset_;
     const uint64_t length_;
@@ -125,7 +141,10 @@ class FreeExtents {
     const uint64_t maxExtentSize_;
     uint64_t available_;
 
+    // offset => length
     std::map<uint64_t, uint64_t> extents_;
+    // {length, offset} of `extents_`, used for best-fit allocation
+    absl::btree_set<std::pair<uint64_t, uint64_t>> sizeIndex_;
     std::map<uint64_t, uint64_t> blocks_;
 };
 
@@ -41,6 +41,9 @@ struct BitmapAllocatorOption {
 struct BlockGroupManagerOption {
     uint32_t fsId;
     uint32_t blockGroupAllocateOnce;
+    // upper limit of block groups allocated at once when the count is
+    // predicted by the alloc rate, 0 means no limit
+    uint32_t blockGroupMaxAllocateOnce{0};
     uint32_t blockSize;
     uint64_t blockGroupSize;
     std::string owner;
@@ -57,6 +60,16 @@ struct SpaceManagerOption {
 
     double threshold{1.0};
     uint64_t releaseInterSec{300};
+
+    // space reserved by each alloc shard at once, 0 means disabled
+    uint64_t reserveSize{0};
+    // number of alloc shards, 0 means the number of cpu cores
+    uint32_t reserveShards{0};
+
+    // keep enough block groups for the allocations of next so many seconds
+    // at recent alloc rate, and allocate them in background before the
+    // available space runs out, 0 means disabled
+    uint32_t allocateAheadSec{0};
 };
 
 }  // namespace volume
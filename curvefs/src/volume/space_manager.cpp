@@ -25,8 +25,12 @@
 #include <butil/time.h>
 #include <bvar/bvar.h>
 
+#include <algorithm>
 #include <atomic>
-#include <unordered_set>
+#include <functional>
+#include <limits>
+#include <set>
+#include <thread>
 #include <utility>
 
 #include "absl/cleanup/cleanup.h"
@@ -50,8 +54,22 @@ SpaceManagerImpl::SpaceManagerImpl(
       blockGroupManager_(new BlockGroupManagerImpl(
           this, mdsClient, blockDev, option.blockGroupManagerOption,
           option.allocatorOption)),
-      allocating_(false), threshold_(option.threshold),
-      releaseInterSec_(option.releaseInterSec) {}
+      blockDev_(blockDev),
+      allocating_(false), allocateAheadSec_(option.allocateAheadSec),
+      lastRateUpdateUs_(0),
+      threshold_(option.threshold),
+      releaseInterSec_(option.releaseInterSec),
+      reserveSize_(option.reserveSize) {
+    if (reserveSize_ != 0) {
+        uint32_t shards = option.reserveShards;
+        if (shards == 0) {
+            shards = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (uint32_t i = 0; i < shards; ++i) {
+            reserveShards_.emplace_back(new ReserveShard());
+        }
+    }
+}
 
 bool SpaceManagerImpl::Alloc(uint32_t size,
                              const AllocateHint& hint,
@@ -61,46 +79,137 @@ bool SpaceManagerImpl::Alloc(uint32_t size,
     butil::Timer timer;
     timer.start();
 
+    auto ret = reserveShards_.empty()
+                   ? AllocFromAllocators(size, hint, extents)
+                   : AllocFromReserved(size, hint, extents);
+    if (!ret) {
+        metric_.errorCount << 1;
+        return false;
+    }
+
+    ret = UpdateBitmap(*extents, BlockGroupBitmapUpdater::Set);
+    if (!ret) {
+        LOG(ERROR) << "Update bitmap failed";
+        metric_.errorCount << 1;
+        return false;
+    }
+
+    timer.stop();
+    metric_.allocLatency << timer.u_elapsed();
+    metric_.allocSize << size;
+
+    VLOG(9) << "Alloc success, " << *extents;
+
+    return true;
+}
+
+bool SpaceManagerImpl::AllocFromAllocators(uint64_t size,
+                                           const AllocateHint& hint,
+                                           std::vector<Extent>* exts) {
+    allocatedBytes_.fetch_add(size, std::memory_order_relaxed);
     if (availableBytes_.load(std::memory_order_acquire) < size) {
         auto ret = AllocateBlockGroup(size);
         if (!ret) {
             LOG(ERROR) << "Allocate block group error";
-            metric_.errorCount << 1;
             return false;
         }
     }
 
     int64_t left = size;
     while (left > 0) {
-        auto allocated = AllocInternal(left, hint, extents);
+        auto allocated = AllocInternal(left, hint, exts);
         availableBytes_.fetch_sub(allocated, std::memory_order_relaxed);
         if (allocated < left) {
             auto ret = AllocateBlockGroup(left);
             if (!ret) {
                 LOG(ERROR) << "Allocate block group error";
-                metric_.errorCount << 1;
                 return false;
             }
         }
         left -= allocated;
     }
 
-    auto ret = UpdateBitmap(*extents, BlockGroupBitmapUpdater::Set);
-    if (!ret) {
-        LOG(ERROR) << "Update bitmap failed";
-        metric_.errorCount << 1;
-        return false;
-    }
+    MaybeAllocateAhead();
+    return true;
+}
 
-    timer.stop();
-    metric_.allocLatency << timer.u_elapsed();
-    metric_.allocSize << size;
+bool SpaceManagerImpl::AllocFromReserved(uint64_t size,
+                                         const AllocateHint& hint,
+                                         std::vector<Extent>* exts) {
+    static thread_local size_t shardHash =
+        std::hash<std::thread::id>()(std::this_thread::get_id());
+    auto* shard = reserveShards_[shardHash % reserveShards_.size()].get();
 
-    VLOG(9) << "Alloc success, " << *extents;
+    std::lock_guard<std::mutex> lk(shard->mtx);
+    auto& reserved = shard->extents;
+    uint64_t left = size;
+    while (left > 0) {
+        if (reserved.empty()) {
+            std::vector<Extent> newReserved;
+            if (!AllocFromAllocators(std::max(left, reserveSize_),
+                                     AllocateHint(), &newReserved)) {
+                return false;
+            }
+            for (const auto& ext : newReserved) {
+                reserved.emplace(ext.offset, ext.len);
+            }
+        }
+
+        // prefer the space right after the left hint, so the file stays
+        // contiguous, otherwise continue from the lowest reserved offset
+        auto it = reserved.end();
+        if (hint.HasLeftHint()) {
+            it = reserved.find(hint.leftOffset);
+        }
+        if (it == reserved.end()) {
+            it = reserved.begin();
+        }
+
+        uint64_t offset = it->first;
+        uint64_t len = std::min(left, it->second);
+        if (len < it->second) {
+            reserved.emplace(offset + len, it->second - len);
+        }
+        reserved.erase(it);
+
+        if (!exts->empty() &&
+            exts->back().offset + exts->back().len == offset) {
+            exts->back().len += len;
+        } else {
+            exts->emplace_back(offset, len);
+        }
+        left -= len;
+    }
 
     return true;
 }
 
+std::vector<std::unique_lock<std::mutex>>
+SpaceManagerImpl::LockReserveShards() {
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(reserveShards_.size());
+    for (auto& shard : reserveShards_) {
+        locks.emplace_back(shard->mtx);
+    }
+
+    return locks;
+}
+
+void SpaceManagerImpl::ReturnReservedLocked() {
+    for (auto& shard : reserveShards_) {
+        for (const auto& ext : shard->extents) {
+            auto it = allocators_.find(align_down(ext.first, blockGroupSize_));
+            CHECK(it != allocators_.end())
+                << "reserved space without allocator, offset: " << ext.first;
+            CHECK(it->second->DeAlloc(ext.first, ext.second))
+                << "Return reserved space failed, offset: " << ext.first
+                << ", length: " << ext.second;
+            availableBytes_.fetch_add(ext.second, std::memory_order_relaxed);
+        }
+        shard->extents.clear();
+    }
+}
+
 bool SpaceManagerImpl::DeAlloc(uint64_t blockGroupOffset,
                                const std::vector<Extent> &extents) {
     butil::Timer timer;
@@ -193,18 +302,43 @@ bool SpaceManagerImpl::UpdateBitmap(const std::vector<Extent> &exts,
                                     BlockGroupBitmapUpdater::Op op) {
     ReadLockGuard lk(updatersLock_);
 
-    std::unordered_set<BlockGroupBitmapUpdater*> dirty;
+    // ordered by address, so the sync locks are always taken in same order
+    std::set<BlockGroupBitmapUpdater*> dirty;
     for (const auto& ext : exts) {
         BlockGroupBitmapUpdater* updater = FindBitmapUpdater(ext);
         updater->Update(ext, op);
         dirty.insert(updater);
     }
 
+    // write the dirty ranges of all bitmaps by one batch of aio, a range
+    // already synced by another thread's batch is skipped
+    std::vector<BlockGroupBitmapUpdater::SyncContext> ctxs(dirty.size());
+    std::vector<BlockGroupBitmapUpdater*> syncing;
+    std::vector<WritePart> parts;
+    ssize_t expected = 0;
     for (auto d : dirty) {
-        d->Sync();
+        auto& ctx = ctxs[syncing.size()];
+        if (d->SyncBegin(&ctx)) {
+            parts.push_back(ctx.part);
+            expected += ctx.part.length;
+            syncing.push_back(d);
+        }
     }
 
-    return true;
+    if (parts.empty()) {
+        return true;
+    }
+
+    ssize_t ret = parts.size() == 1
+                      ? blockDev_->Write(parts[0].data, parts[0].offset,
+                                         parts[0].length)
+                      : blockDev_->Writev(parts);
+    bool success = (ret == expected);
+    for (size_t i = 0; i < syncing.size(); ++i) {
+        syncing[i]->SyncEnd(&ctxs[i], success);
+    }
+
+    return success;
 }
 
 BlockGroupBitmapUpdater* SpaceManagerImpl::FindBitmapUpdater(
@@ -221,18 +355,100 @@ BlockGroupBitmapUpdater* SpaceManagerImpl::FindBitmapUpdater(
 
 void SpaceManagerImpl::Run() {
     releaseT_ = std::thread(&SpaceManagerImpl::ReleaseFullBlockGroups, this);
+    if (allocateAheadSec_ != 0) {
+        allocateAheadT_ =
+            std::thread(&SpaceManagerImpl::AllocateAheadLoop, this);
+    }
     running_ = true;
 }
 
+uint64_t SpaceManagerImpl::AllocateAheadBytes() const {
+    return allocRate_.load(std::memory_order_relaxed) * allocateAheadSec_;
+}
+
+void SpaceManagerImpl::UpdateAllocRateLocked() {
+    uint64_t now = butil::monotonic_time_us();
+    if (lastRateUpdateUs_ == 0) {
+        // the time before first allocation isn't counted
+        allocatedBytes_.store(0, std::memory_order_relaxed);
+        lastRateUpdateUs_ = now;
+        return;
+    }
+
+    uint64_t elapsed = now - lastRateUpdateUs_;
+    if (elapsed == 0) {
+        return;
+    }
+
+    uint64_t bytes = allocatedBytes_.exchange(0, std::memory_order_relaxed);
+    uint64_t current = bytes * 1000000.0 / elapsed;
+    uint64_t prev = allocRate_.load(std::memory_order_relaxed);
+    allocRate_.store(prev == 0 ? current : (prev + current) / 2,
+                     std::memory_order_relaxed);
+    lastRateUpdateUs_ = now;
+}
+
+void SpaceManagerImpl::MaybeAllocateAhead() {
+    if (allocateAheadSec_ == 0 ||
+        availableBytes_.load(std::memory_order_relaxed) >=
+            AllocateAheadBytes() / 2) {
+        return;
+    }
+
+    // mtx_ is held while allocating block groups, no need to wait for it
+    std::unique_lock<std::mutex> lk(mtx_, std::try_to_lock);
+    if (!lk.owns_lock() || allocating_) {
+        return;
+    }
+
+    allocating_ = true;
+    cond_.notify_one();
+}
+
+void SpaceManagerImpl::AllocateAheadLoop() {
+    std::unique_lock<std::mutex> lk(mtx_);
+    while (true) {
+        cond_.wait(lk, [this]() { return allocating_ || stopping_; });
+        if (stopping_) {
+            break;
+        }
+
+        lk.unlock();
+        metric_.allocateAheadCount << 1;
+        LOG_IF(WARNING, !AllocateBlockGroup(AllocateAheadBytes()))
+            << "Allocate block groups ahead failed";
+        lk.lock();
+        allocating_ = false;
+    }
+}
+
 
 void SpaceManagerImpl::ReleaseFullBlockGroups() {
     while (sleeper_.wait_for(std::chrono::seconds(releaseInterSec_))) {
         std::vector<uint64_t> selectBlockGroups;
+        std::set<uint64_t> idleBlockGroups;
+
+        // decay the alloc rate in case no block group is allocated for a
+        // long time, so the idle block groups can be released
+        if (allocateAheadSec_ != 0) {
+            std::lock_guard<std::mutex> lk(mtx_);
+            UpdateAllocRateLocked();
+        }
 
         // find the blockgroup whose space usage ratio is greater than a certain
-        // threshold
+        // threshold, the reserved space is returned first to count it as free
         {
+            auto shardLocks = LockReserveShards();
             ReadLockGuard lk(allocatorsLock_);
+            ReturnReservedLocked();
+
+            // the unused block groups beyond the space needed by the
+            // allocations of next allocateAheadSec_ seconds are idle
+            uint64_t keep = std::max(AllocateAheadBytes(), blockGroupSize_);
+            uint64_t totalAvailable =
+                availableBytes_.load(std::memory_order_relaxed);
+            uint64_t surplus =
+                totalAvailable > keep ? totalAvailable - keep : 0;
             for (auto &alloc : allocators_) {
                 if (alloc.second->Total() == 0) {
                     continue;
@@ -248,6 +464,13 @@ void SpaceManagerImpl::ReleaseFullBlockGroups() {
 
                 if (usedPer > threshold_) {
                     selectBlockGroups.push_back(alloc.first);
+                } else if (allocateAheadSec_ != 0 &&
+                           alloc.second->AvailableSize() ==
+                               alloc.second->Total() &&
+                           alloc.second->AvailableSize() <= surplus) {
+                    surplus -= alloc.second->AvailableSize();
+                    selectBlockGroups.push_back(alloc.first);
+                    idleBlockGroups.insert(alloc.first);
                 }
             }
         }
@@ -259,12 +482,21 @@ void SpaceManagerImpl::ReleaseFullBlockGroups() {
 
         // release selected blockgroups
         {
+            auto shardLocks = LockReserveShards();
             WriteLockGuard allocLk(allocatorsLock_);
             WriteLockGuard updaterLk(updatersLock_);
+            ReturnReservedLocked();
             for (auto &id : selectBlockGroups) {
                 auto iter = allocators_.find(id);
                 assert(iter != allocators_.end());
                 auto availableSize = iter->second->AvailableSize();
+                if (idleBlockGroups.count(id) != 0) {
+                    // allocated from after it's selected
+                    if (availableSize != iter->second->Total()) {
+                        continue;
+                    }
+                    metric_.releaseIdleCount << 1;
+                }
 
                 availableBytes_.fetch_sub(availableSize,
                                           std::memory_order_relaxed);
@@ -288,10 +520,23 @@ void SpaceManagerImpl::ReleaseFullBlockGroups() {
 bool SpaceManagerImpl::Shutdown() {
     bool ret = false;
 
+    if (allocateAheadT_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            stopping_ = true;
+        }
+        cond_.notify_all();
+        allocateAheadT_.join();
+    }
+
     {
+        auto shardLocks = LockReserveShards();
         WriteLockGuard allocLk(allocatorsLock_);
         WriteLockGuard updaterLk(updatersLock_);
 
+        // return the reserved space, it's never marked in bitmap
+        ReturnReservedLocked();
+
         // sync all bitmap updater
         for (auto &updater : bitmapUpdaters_) {
             ret = updater.second->Sync();
@@ -320,8 +565,21 @@ bool SpaceManagerImpl::AllocateBlockGroup(uint64_t hint) {
         return true;
     }
 
+    // 0 means the default count of block group manager
+    uint32_t count = 0;
+    if (allocateAheadSec_ != 0) {
+        UpdateAllocRateLocked();
+        uint64_t want = std::max(hint, AllocateAheadBytes());
+        uint64_t available = availableBytes_.load(std::memory_order_relaxed);
+        if (want > available) {
+            count = std::min<uint64_t>(
+                (want - available + blockGroupSize_ - 1) / blockGroupSize_,
+                std::numeric_limits<uint32_t>::max());
+        }
+    }
+
     std::vector<AllocatorAndBitmapUpdater> out;
-    auto ret = blockGroupManager_->AllocateBlockGroup(&out);
+    auto ret = blockGroupManager_->AllocateBlockGroup(count, &out);
     if (!ret) {
         LOG(ERROR) << "Allocate block group failed";
         return false;
@@ -363,6 +621,10 @@ bool SpaceManagerImpl::AcquireBlockGroup(uint64_t blockGroupOffset) {
     WriteLockGuard allocLk(allocatorsLock_);
     WriteLockGuard updaterLk(updatersLock_);
 
+    // it's allocated from and released like the allocated block groups
+    availableBytes_.fetch_add(out.allocator->AvailableSize(),
+                              std::memory_order_release);
+    totalBytes_.fetch_add(out.allocator->Total(), std::memory_order_release);
     allocators_.emplace(blockGroupOffset, std::move(out.allocator));
     bitmapUpdaters_.emplace(blockGroupOffset, std::move(out.bitmapUpdater));
     return true;
@@ -23,8 +23,12 @@
 #ifndef CURVEFS_SRC_VOLUME_SPACE_MANAGER_H_
 #define CURVEFS_SRC_VOLUME_SPACE_MANAGER_H_
 
+#include <atomic>
+#include <condition_variable>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "src/common/interruptible_sleeper.h"
@@ -87,6 +91,38 @@ class SpaceManagerImpl final : public SpaceManager {
     uint64_t GetBlockGroupSize() override { return blockGroupSize_; }
 
  private:
+    // per shard reserved space, which is already allocated from allocators
+    // but not marked in the on-disk bitmap
+    struct ReserveShard {
+        std::mutex mtx;
+        // offset => length, contiguous extents are not merged
+        std::map<uint64_t, uint64_t> extents;
+    };
+
+    /**
+     * @brief Allocate space from allocators, and allocate new block groups
+     *        if available space is not enough
+     */
+    bool AllocFromAllocators(uint64_t size,
+                             const AllocateHint& hint,
+                             std::vector<Extent>* exts);
+
+    /**
+     * @brief Allocate space from the reserved space of current thread's
+     *        shard, and reserve more if it's not enough
+     */
+    bool AllocFromReserved(uint64_t size,
+                           const AllocateHint& hint,
+                           std::vector<Extent>* exts);
+
+    std::vector<std::unique_lock<std::mutex>> LockReserveShards();
+
+    /**
+     * @brief Return all reserved space to allocators
+     *        REQUIRES: all shards and allocatorsLock_ are locked
+     */
+    void ReturnReservedLocked();
+
     int64_t AllocInternal(int64_t size,
                           const AllocateHint& hint,
                           std::vector<Extent>* exts);
@@ -104,6 +140,26 @@ class SpaceManagerImpl final : public SpaceManager {
 
     void ReleaseFullBlockGroups();
 
+    /**
+     * @brief Background thread allocates block groups ahead of the
+     *        allocations once it's woken up by MaybeAllocateAhead
+     */
+    void AllocateAheadLoop();
+
+    void MaybeAllocateAhead();
+
+    /**
+     * @brief Bytes needed by the allocations of next allocateAheadSec_
+     *        seconds at recent alloc rate
+     */
+    uint64_t AllocateAheadBytes() const;
+
+    /**
+     * @brief Update the alloc rate by the bytes allocated since last update
+     *        REQUIRES: mtx_ is locked
+     */
+    void UpdateAllocRateLocked();
+
  private:
     bool AllocateBlockGroup(uint64_t hint);
 
@@ -126,10 +182,23 @@ class SpaceManagerImpl final : public SpaceManager {
 
     std::unique_ptr<BlockGroupManager> blockGroupManager_;
 
+    std::shared_ptr<BlockDeviceClient> blockDev_;
+
+    // allocating_ is set when the background allocation is requested
     bool allocating_;
+    bool stopping_{false};
     std::mutex mtx_;
     std::condition_variable cond_;
 
+    const uint32_t allocateAheadSec_;
+    std::thread allocateAheadT_;
+    // bytes allocated from allocators since last rate update
+    std::atomic<uint64_t> allocatedBytes_{0};
+    // bytes per second, updated before allocating block groups
+    std::atomic<uint64_t> allocRate_{0};
+    // 0 means the rate isn't updated yet
+    uint64_t lastRateUpdateUs_;
+
     // releaseT_ is periodically release the allocated blockgroup
     double threshold_;
     uint64_t releaseInterSec_;
@@ -137,6 +206,9 @@ class SpaceManagerImpl final : public SpaceManager {
     bool running_{false};
     std::thread releaseT_;
 
+    // lock order: shard's mtx => mtx_ => allocatorsLock_ => updatersLock_
+    const uint64_t reserveSize_;
+    std::vector<std::unique_ptr<ReserveShard>> reserveShards_;
 
  private:
     struct Metric {
@@ -144,11 +216,15 @@ class SpaceManagerImpl final : public SpaceManager {
         bvar::LatencyRecorder deallocLatency;
         bvar::LatencyRecorder allocSize;
         bvar::Adder<uint64_t> errorCount;
+        bvar::Adder<uint64_t> allocateAheadCount;
+        bvar::Adder<uint64_t> releaseIdleCount;
 
         Metric()
             : allocLatency("space_alloc_latency"),
               deallocLatency("space_dealloc_latency"),
-              allocSize("space_alloc_size"), errorCount("space_alloc_error") {}
+              allocSize("space_alloc_size"), errorCount("space_alloc_error"),
+              allocateAheadCount("space_allocate_ahead"),
+              releaseIdleCount("space_release_idle_block_group") {}
     };
 
     Metric metric_;
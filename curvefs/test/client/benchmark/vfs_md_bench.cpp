@@ -0,0 +1,388 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * An mdtest like metadata benchmark on curvefs::client::vfs::VFS, without
+ * FUSE. Every thread creates, stats, lists, renames and unlinks its files
+ * in a directory tree of --depth levels and --branch subdirectories per
+ * level, e.g.
+ *
+ *   curvefs_vfs_md_bench --conf=client.conf --fsname=test \
+ *       --threads=16 --depth=1 --branch=8 --items=1000 --layout=shared
+ *
+ * With --layout=unique every thread has its own tree, with --layout=shared
+ * all threads work in the same directories. For every phase it prints the
+ * ops/s, a latency histogram, and the metaserver rpcs sent in the phase
+ * by type, which shows how a layout change of DentryStorage/InodeStorage
+ * moves the cost.
+ */
+
+#include <bvar/bvar.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "curvefs/src/client/filesystem/error.h"
+#include "curvefs/src/client/vfs/config.h"
+#include "curvefs/src/client/vfs/vfs.h"
+#include "src/common/string_util.h"
+#include "src/common/timeutility.h"
+
+DEFINE_string(conf, "", "client config file, the built-in defaults if empty");
+DEFINE_string(fsname, "", "name of the filesystem");
+DEFINE_string(mountpoint, "/", "mount point recorded in mds");
+DEFINE_string(benchDir, "/mdbench", "directory of the benchmark in the fs");
+DEFINE_uint32(threads, 8, "number of the threads");
+DEFINE_uint32(depth, 0, "depth of the directory tree, 0 is a single dir");
+DEFINE_uint32(branch, 4, "subdirectories of every directory in the tree");
+DEFINE_uint32(items, 1000, "files created by every thread in a leaf dir");
+DEFINE_string(layout, "unique", "unique: a tree per thread, "
+                                "shared: all threads share one tree");
+DEFINE_string(phases, "create,stat,readdir,rename,unlink",
+              "phases to run, in order");
+
+namespace curvefs {
+namespace client {
+namespace vfs {
+namespace {
+
+using ::curve::common::TimeUtility;
+using ::curvefs::client::filesystem::CURVEFS_ERROR;
+using ::curvefs::client::filesystem::StrErr;
+
+// the metaserver rpcs of MetaServerClientMetric used by metadata ops
+const char* const kMetaServerRpcs[] = {
+    "getDentry",   "listDentry",        "createDentry", "deleteDentry",
+    "getInode",    "batchGetInodeAttr", "createInode",  "updateInode",
+    "deleteInode", "prepareRenameTx",
+};
+const char kMetaServerMetricPrefix[] = "curvefs_metaserver_client_";
+
+// power of 2 buckets of microseconds
+const int kHistogramBuckets = 32;
+
+struct PhaseStat {
+    uint64_t ops = 0;
+    uint64_t errors = 0;
+    std::vector<uint32_t> latUs;
+
+    void Merge(const PhaseStat& other) {
+        ops += other.ops;
+        errors += other.errors;
+        latUs.insert(latUs.end(), other.latUs.begin(), other.latUs.end());
+    }
+};
+
+std::string RpcMetricName(const std::string& rpc, const std::string& suffix) {
+    std::string name;
+    bvar::to_underscored_name(&name, kMetaServerMetricPrefix + rpc +
+                                         "_lat_" + suffix);
+    return name;
+}
+
+std::string DescribeMetric(const std::string& name) {
+    std::string value;
+    if (bvar::Variable::describe_exposed(name, &value) != 0) {
+        return "-";
+    }
+    return value;
+}
+
+std::map<std::string, uint64_t> SnapshotRpcCounts() {
+    std::map<std::string, uint64_t> counts;
+    for (const char* rpc : kMetaServerRpcs) {
+        counts[rpc] =
+            std::strtoull(DescribeMetric(RpcMetricName(rpc, "count")).c_str(),
+                          nullptr, 10);
+    }
+    return counts;
+}
+
+class MdBench {
+ public:
+    explicit MdBench(std::shared_ptr<VFS> vfs) : vfs_(vfs) {}
+
+    int Prepare() {
+        leaves_.clear();
+        std::vector<std::string> roots;
+        if (FLAGS_layout == "shared") {
+            roots.push_back(FLAGS_benchDir + "/shared");
+        } else {
+            for (uint32_t i = 0; i < FLAGS_threads; i++) {
+                roots.push_back(FLAGS_benchDir + "/t" + std::to_string(i));
+            }
+        }
+        for (const auto& root : roots) {
+            std::vector<std::string> level{root};
+            for (uint32_t d = 0; d < FLAGS_depth; d++) {
+                std::vector<std::string> next;
+                for (const auto& dir : level) {
+                    for (uint32_t b = 0; b < FLAGS_branch; b++) {
+                        next.push_back(dir + "/d" + std::to_string(b));
+                    }
+                }
+                level.swap(next);
+            }
+            treeLeaves_.push_back(level);
+            leaves_.insert(leaves_.end(), level.begin(), level.end());
+        }
+        for (const auto& leaf : leaves_) {
+            CURVEFS_ERROR rc = vfs_->MkDirs(leaf, 0755);
+            if (rc != CURVEFS_ERROR::OK && rc != CURVEFS_ERROR::EXISTS) {
+                std::cerr << "mkdir " << leaf << " failed: " << StrErr(rc)
+                          << std::endl;
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    int RunPhase(const std::string& phase) {
+        auto before = SnapshotRpcCounts();
+        std::vector<PhaseStat> stats(FLAGS_threads);
+        std::vector<std::thread> threads;
+        uint64_t startUs = TimeUtility::GetTimeofDayUs();
+        for (uint32_t i = 0; i < FLAGS_threads; i++) {
+            threads.emplace_back([this, &phase, &stats, i]() {
+                RunThread(phase, i, &stats[i]);
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        uint64_t elapsedUs = TimeUtility::GetTimeofDayUs() - startUs;
+        auto after = SnapshotRpcCounts();
+
+        PhaseStat total;
+        for (const auto& stat : stats) {
+            total.Merge(stat);
+        }
+        Report(phase, elapsedUs, &total);
+        ReportRpcs(total.ops, before, after);
+        return total.errors == 0 ? 0 : -1;
+    }
+
+ private:
+    // the leaf dirs a thread works in and the prefix of its files
+    std::vector<std::string> ThreadLeaves(uint32_t thread, bool listing) {
+        if (FLAGS_layout != "shared") {
+            return treeLeaves_[thread];
+        }
+        if (!listing) {
+            return leaves_;
+        }
+        // every shared dir is listed by one thread
+        std::vector<std::string> leaves;
+        for (size_t i = thread; i < leaves_.size(); i += FLAGS_threads) {
+            leaves.push_back(leaves_[i]);
+        }
+        return leaves;
+    }
+
+    static std::string FilePath(const std::string& dir, uint32_t thread,
+                                uint32_t item, bool renamed) {
+        return dir + "/f" + std::to_string(thread) + "." +
+               std::to_string(item) + (renamed ? ".r" : "");
+    }
+
+    void RunThread(const std::string& phase, uint32_t thread,
+                   PhaseStat* stat) {
+        const bool listing = phase == "readdir";
+        for (const auto& dir : ThreadLeaves(thread, listing)) {
+            if (listing) {
+                Timed(stat, [&]() { return ListDir(dir); });
+                continue;
+            }
+            for (uint32_t j = 0; j < FLAGS_items; j++) {
+                const std::string path = FilePath(dir, thread, j, false);
+                const std::string renamed = FilePath(dir, thread, j, true);
+                Timed(stat, [&]() { return DoOp(phase, path, renamed); });
+            }
+        }
+    }
+
+    template <typename Op>
+    void Timed(PhaseStat* stat, Op op) {
+        uint64_t startUs = TimeUtility::GetTimeofDayUs();
+        CURVEFS_ERROR rc = op();
+        uint64_t latUs = TimeUtility::GetTimeofDayUs() - startUs;
+        if (rc != CURVEFS_ERROR::OK) {
+            stat->errors++;
+            LOG_EVERY_N(ERROR, 1000) << "md bench op failed: " << StrErr(rc);
+            return;
+        }
+        stat->ops++;
+        stat->latUs.push_back(latUs);
+    }
+
+    CURVEFS_ERROR DoOp(const std::string& phase, const std::string& path,
+                       const std::string& renamed) {
+        if (phase == "create") {
+            return vfs_->Create(path, 0644);
+        } else if (phase == "stat") {
+            struct stat st;
+            return vfs_->LStat(path, &st);
+        } else if (phase == "rename") {
+            return vfs_->Rename(path, renamed);
+        } else if (phase == "unlink") {
+            // the files are renamed if the rename phase ran
+            CURVEFS_ERROR rc = vfs_->Unlink(renamed);
+            return rc == CURVEFS_ERROR::NOT_EXIST ? vfs_->Unlink(path) : rc;
+        }
+        return CURVEFS_ERROR::NOT_SUPPORT;
+    }
+
+    CURVEFS_ERROR ListDir(const std::string& dir) {
+        DirStream stream;
+        CURVEFS_ERROR rc = vfs_->OpenDir(dir, &stream);
+        if (rc != CURVEFS_ERROR::OK) {
+            return rc;
+        }
+        DirEntry entry;
+        while ((rc = vfs_->ReadDir(&stream, &entry)) == CURVEFS_ERROR::OK) {
+        }
+        vfs_->CloseDir(&stream);
+        return rc == CURVEFS_ERROR::END_OF_FILE ? CURVEFS_ERROR::OK : rc;
+    }
+
+    static void Report(const std::string& phase, uint64_t elapsedUs,
+                       PhaseStat* stat) {
+        std::vector<uint32_t>& lat = stat->latUs;
+        std::sort(lat.begin(), lat.end());
+        const double seconds = std::max<uint64_t>(elapsedUs, 1) / 1e6;
+        std::cout << "== " << phase << ": " << stat->ops << " ops, "
+                  << stat->errors << " errors, "
+                  << static_cast<uint64_t>(stat->ops / seconds) << " ops/s"
+                  << std::endl;
+        if (lat.empty()) {
+            return;
+        }
+
+        auto percentile = [&lat](double p) {
+            return lat[std::min<size_t>(lat.size() * p, lat.size() - 1)];
+        };
+        std::cout << "   lat(us) p50: " << percentile(0.5)
+                  << ", p90: " << percentile(0.9)
+                  << ", p99: " << percentile(0.99)
+                  << ", p99.9: " << percentile(0.999)
+                  << ", max: " << lat.back() << std::endl;
+
+        uint64_t buckets[kHistogramBuckets] = {0};
+        for (uint32_t l : lat) {
+            int b = 0;
+            while (b < kHistogramBuckets - 1 && (1U << b) <= l) {
+                b++;
+            }
+            buckets[b]++;
+        }
+        for (int b = 0; b < kHistogramBuckets; b++) {
+            if (buckets[b] == 0) {
+                continue;
+            }
+            char line[128];
+            snprintf(line, sizeof(line), "   < %10u us: %10" PRIu64 " %6.2f%%",
+                     1U << b, buckets[b], 100.0 * buckets[b] / lat.size());
+            std::cout << line << std::endl;
+        }
+    }
+
+    // the counts are the rpcs sent in the phase, the latencies are the
+    // recent window of the LatencyRecorder in MetaServerClientMetric
+    static void ReportRpcs(uint64_t ops,
+                           const std::map<std::string, uint64_t>& before,
+                           const std::map<std::string, uint64_t>& after) {
+        for (const char* rpc : kMetaServerRpcs) {
+            uint64_t count = after.at(rpc) - before.at(rpc);
+            if (count == 0) {
+                continue;
+            }
+            char line[160];
+            snprintf(line, sizeof(line),
+                     "   rpc %-18s %10" PRIu64
+                     " (%.2f/op), lat(us) avg: %s, p99: %s",
+                     rpc, count, ops == 0 ? 0.0 : 1.0 * count / ops,
+                     DescribeMetric(RpcMetricName(rpc, "latency")).c_str(),
+                     DescribeMetric(RpcMetricName(rpc, "latency_99")).c_str());
+            std::cout << line << std::endl;
+        }
+    }
+
+ private:
+    std::shared_ptr<VFS> vfs_;
+    // the leaf dirs of every tree
+    std::vector<std::vector<std::string>> treeLeaves_;
+    std::vector<std::string> leaves_;
+};
+
+std::shared_ptr<Configure> LoadConfigure() {
+    auto cfg = Configure::Default();
+    if (!FLAGS_conf.empty()) {
+        std::ifstream in(FLAGS_conf);
+        std::stringstream content;
+        content << in.rdbuf();
+        cfg->LoadString(content.str());
+    }
+    return cfg;
+}
+
+}  // namespace
+}  // namespace vfs
+}  // namespace client
+}  // namespace curvefs
+
+int main(int argc, char** argv) {
+    using ::curvefs::client::filesystem::CURVEFS_ERROR;
+    using ::curvefs::client::filesystem::StrErr;
+
+    google::ParseCommandLineFlags(&argc, &argv, true);
+    if (FLAGS_fsname.empty() || FLAGS_threads == 0) {
+        std::cerr << "--fsname and --threads are required" << std::endl;
+        return -1;
+    }
+
+    auto vfs = std::make_shared<curvefs::client::vfs::VFS>(
+        curvefs::client::vfs::LoadConfigure());
+    CURVEFS_ERROR rc = vfs->Mount(FLAGS_fsname, FLAGS_mountpoint);
+    if (rc != CURVEFS_ERROR::OK) {
+        std::cerr << "mount " << FLAGS_fsname << " failed: " << StrErr(rc)
+                  << std::endl;
+        return -1;
+    }
+
+    curvefs::client::vfs::MdBench bench(vfs);
+    int ret = bench.Prepare();
+    std::vector<std::string> phases;
+    curve::common::SplitString(FLAGS_phases, ",", &phases);
+    for (size_t i = 0; ret == 0 && i < phases.size(); i++) {
+        ret = bench.RunPhase(phases[i]);
+    }
+
+    vfs->Umount(FLAGS_fsname, FLAGS_mountpoint);
+    return ret;
+}
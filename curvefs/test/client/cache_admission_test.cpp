@@ -0,0 +1,71 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "curvefs/src/client/s3/cache_admission.h"
+
+namespace curvefs {
+namespace client {
+
+TEST(CacheAdmissionTest, NewCacheAdmission) {
+    ASSERT_NE(nullptr, NewCacheAdmission("always", 1024, 2));
+    ASSERT_NE(nullptr, NewCacheAdmission("tinylfu", 1024, 2));
+    ASSERT_EQ(nullptr, NewCacheAdmission("unknown", 1024, 2));
+
+    auto always = NewCacheAdmission("always", 1024, 2);
+    ASSERT_TRUE(always->Admit("obj"));
+}
+
+TEST(CacheAdmissionTest, TinyLfuAdmitFrequent) {
+    TinyLfuAdmission admission(1024, 2);
+    ASSERT_FALSE(admission.Admit("hot"));
+    ASSERT_TRUE(admission.Admit("hot"));
+    ASSERT_TRUE(admission.Admit("hot"));
+    ASSERT_EQ(3, admission.Frequency("hot"));
+    ASSERT_EQ(0, admission.Frequency("cold"));
+}
+
+TEST(CacheAdmissionTest, TinyLfuRejectScan) {
+    TinyLfuAdmission admission(4096, 2);
+    int admitted = 0;
+    for (int i = 0; i < 1000; ++i) {
+        if (admission.Admit("scan_" + std::to_string(i))) {
+            admitted++;
+        }
+    }
+    // only hash collisions of the sketch
+    ASSERT_LT(admitted, 10);
+}
+
+TEST(CacheAdmissionTest, TinyLfuAging) {
+    TinyLfuAdmission admission(64, 2);
+    for (int i = 0; i < 15; ++i) {
+        admission.Admit("hot");
+    }
+    ASSERT_EQ(15, admission.Frequency("hot"));
+
+    // the counters are halved after every 10 * width accesses
+    for (int i = 0; i < 640; ++i) {
+        admission.Admit("other_" + std::to_string(i % 320));
+    }
+    ASSERT_LT(admission.Frequency("hot"), 15);
+}
+
+}  // namespace client
+}  // namespace curvefs
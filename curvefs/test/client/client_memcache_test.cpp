@@ -141,5 +141,58 @@ TEST_F(MemCachedTest, MultiThreadTask) {
         }
     }
 }
+
+TEST_F(MemCachedTest, BatchedGet) {
+    const int num = 100;
+    CountDownEvent setEvent(num);
+    std::vector<std::string> values;
+    for (int i = 0; i < num; i++) {
+        values.emplace_back(absl::StrCat("value_", 1000 + i));
+    }
+    for (int i = 0; i < num; i++) {
+        auto task = std::make_shared<SetKVCacheTask>(
+            absl::StrCat("batch_", i), values[i].c_str(), values[i].length());
+        task->done = [&setEvent](const std::shared_ptr<SetKVCacheTask>&) {
+            setEvent.Signal();
+        };
+        manager_.Set(task);
+    }
+    setEvent.Wait();
+
+    // gets queued concurrently are sent by multi-get, duplicated keys and
+    // missed keys are answered as well
+    std::vector<std::string> keys;
+    for (int i = 0; i < num; i++) {
+        keys.emplace_back(absl::StrCat("batch_", i));
+    }
+    keys.emplace_back("batch_0");
+    keys.emplace_back("batch_not_exist");
+
+    CountDownEvent getEvent(keys.size());
+    std::vector<std::string> results(keys.size(), std::string(4, '\0'));
+    std::vector<std::shared_ptr<GetKVCacheTask>> tasks;
+    for (size_t i = 0; i < keys.size(); i++) {
+        // read "_100x" from offset 5
+        auto task = std::make_shared<GetKVCacheTask>(keys[i], &results[i][0],
+                                                     5, 4);
+        task->done = [&getEvent](const std::shared_ptr<GetKVCacheTask>&) {
+            getEvent.Signal();
+        };
+        tasks.push_back(task);
+    }
+    for (auto& task : tasks) {
+        manager_.Get(task);
+    }
+    getEvent.Wait();
+
+    for (int i = 0; i < num; i++) {
+        ASSERT_TRUE(tasks[i]->res);
+        ASSERT_EQ(values[i].substr(5, 4), results[i]);
+    }
+    ASSERT_TRUE(tasks[num]->res);
+    ASSERT_EQ(values[0].substr(5, 4), results[num]);
+    ASSERT_FALSE(tasks[num + 1]->res);
+    ASSERT_EQ(num + 1, manager_.GetMetricForTesting()->get.latency.count());
+}
 }  // namespace client
 }  // namespace curvefs
@@ -134,15 +134,16 @@ TEST_F(ClientOperatorTest, PrepareTx) {
         .WillRepeatedly(DoAll(SetArgPointee<2>(1), Return(MetaStatusCode::OK)));
     ASSERT_EQ(renameOp_->GetTxId(), CURVEFS_ERROR::OK);
 
-    EXPECT_CALL(*metaClient_, PrepareRenameTx(_))
+    EXPECT_CALL(*metaClient_, PrepareRenameTx(_, _))
         .WillOnce(Return(MetaStatusCode::UNKNOWN_ERROR));
 
     auto rc = renameOp_->PrepareTx();
     ASSERT_EQ(rc, CURVEFS_ERROR::UNKNOWN);
 
     // CASE 2: PrepareTx success (same partition)
-    EXPECT_CALL(*metaClient_, PrepareRenameTx(_))
-        .WillOnce(Return(MetaStatusCode::OK));
+    EXPECT_CALL(*metaClient_, PrepareRenameTx(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(false),
+                        Return(MetaStatusCode::OK)));
 
     rc = renameOp_->PrepareTx();
     ASSERT_EQ(rc, CURVEFS_ERROR::OK);
@@ -191,5 +192,25 @@ TEST_F(ClientOperatorTest, CommitTx) {
     ASSERT_EQ(rc, CURVEFS_ERROR::OK);
 }
 
+TEST_F(ClientOperatorTest, CommitTxByMetaServer) {
+    EXPECT_CALL(*metaClient_, GetTxId(_, _, _, _))
+        .WillRepeatedly(DoAll(SetArgPointee<2>(1), Return(MetaStatusCode::OK)));
+    ASSERT_EQ(renameOp_->GetTxId(), CURVEFS_ERROR::OK);
+
+    // the tx in one partition is committed by metaserver
+    EXPECT_CALL(*metaClient_, PrepareRenameTx(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(true),
+                        Return(MetaStatusCode::OK)));
+    ASSERT_EQ(renameOp_->PrepareTx(), CURVEFS_ERROR::OK);
+
+    // no commit to mds, and the txid isn't changed
+    EXPECT_CALL(*mdsClient_, CommitTx(_))
+        .Times(0);
+    EXPECT_CALL(*metaClient_, SetTxId(_, _))
+        .Times(0);
+    ASSERT_EQ(renameOp_->CommitTx(), CURVEFS_ERROR::OK);
+    renameOp_->UpdateCache();
+}
+
 }  // namespace client
 }  // namespace curvefs
@@ -26,6 +26,9 @@
 #include <google/protobuf/util/message_differencer.h>
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <thread>
+
 #include "curvefs/src/client/inode_wrapper.h"
 #include "curvefs/test/client/mock_client_s3.h"
 #include "curvefs/test/client/mock_client_s3_cache_manager.h"
@@ -39,6 +42,7 @@ namespace curvefs {
 namespace client {
 using ::testing::_;
 using ::testing::DoAll;
+using ::testing::InSequence;
 using ::testing::Invoke;
 using ::testing::Return;
 using ::testing::SetArgPointee;
@@ -290,6 +294,72 @@ TEST_F(ClientS3AdaptorTest, FlushAllCache_with_cache) {
     EXPECT_CALL(*mockDiskcacheManagerImpl_, UploadWriteCacheByInode(_))
         .WillOnce(Return(0));
     ASSERT_EQ(CURVEFS_ERROR::OK, s3ClientAdaptor_->FlushAllCache(1));
+
+    LOG(INFO) << "############ case3: no file cache, upload write cache";
+    EXPECT_CALL(*mockFsCacheManager_, FindFileCacheManager(_))
+        .WillOnce(Return(nullptr));
+    EXPECT_CALL(*mockDiskcacheManagerImpl_, UploadWriteCacheByInode(_))
+        .WillOnce(Return(0));
+    ASSERT_EQ(CURVEFS_ERROR::OK, s3ClientAdaptor_->FlushAllCache(1));
+}
+
+TEST_F(ClientS3AdaptorTest, alloc_chunkId_by_lease) {
+    auto adaptor = std::make_shared<S3ClientAdaptorImpl>();
+    S3ClientAdaptorOption option;
+    option.blockSize = 1 * 1024 * 1024;
+    option.chunkSize = 4 * 1024 * 1024;
+    option.pageSize = 64 * 1024;
+    option.intervalSec = 5000;
+    option.flushIntervalSec = 5000;
+    option.chunkFlushThreads = 1;
+    option.objectPrefix = 0;
+    option.chunkIdLeaseMin = 4;
+    option.chunkIdLeaseMax = 16;
+    option.chunkIdLeaseTargetSec = 10;
+    option.diskCacheOpt.diskCacheType = (DiskCacheType)0;
+    ASSERT_EQ(CURVEFS_ERROR::OK,
+              adaptor->Init(option, mockS3Client_, mockInodeManager_,
+                            mockMdsClient_, mockFsCacheManager_,
+                            mockDiskcacheManagerImpl_, nullptr, false));
+
+    {
+        InSequence s;
+        // the first lease
+        EXPECT_CALL(*mockMdsClient_, AllocS3ChunkId(_, 4, _))
+            .WillOnce(DoAll(SetArgPointee<2>(100), Return(FSStatusCode::OK)));
+        // prefetch the next range when half of the lease is used
+        EXPECT_CALL(*mockMdsClient_, AllocS3ChunkId(_, 4, _))
+            .WillOnce(DoAll(SetArgPointee<2>(200), Return(FSStatusCode::OK)));
+        // requests not less than the min lease go to mds directly
+        EXPECT_CALL(*mockMdsClient_, AllocS3ChunkId(_, 5, _))
+            .WillOnce(DoAll(SetArgPointee<2>(300), Return(FSStatusCode::OK)));
+        // the lease is used up quickly, so lease more
+        EXPECT_CALL(*mockMdsClient_, AllocS3ChunkId(_, 8, _))
+            .WillOnce(DoAll(SetArgPointee<2>(400), Return(FSStatusCode::OK)));
+        EXPECT_CALL(*mockMdsClient_, AllocS3ChunkId(_, 16, _))
+            .WillOnce(DoAll(SetArgPointee<2>(500), Return(FSStatusCode::OK)));
+    }
+
+    uint64_t chunkId = 0;
+    ASSERT_EQ(FSStatusCode::OK, adaptor->AllocS3ChunkId(1, 1, &chunkId));
+    ASSERT_EQ(100, chunkId);
+    ASSERT_EQ(FSStatusCode::OK, adaptor->AllocS3ChunkId(1, 1, &chunkId));
+    ASSERT_EQ(101, chunkId);
+    ASSERT_EQ(FSStatusCode::OK, adaptor->AllocS3ChunkId(1, 2, &chunkId));
+    ASSERT_EQ(102, chunkId);
+    // wait the prefetch finish
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(FSStatusCode::OK, adaptor->AllocS3ChunkId(1, 5, &chunkId));
+    ASSERT_EQ(300, chunkId);
+    ASSERT_EQ(FSStatusCode::OK, adaptor->AllocS3ChunkId(1, 1, &chunkId));
+    ASSERT_EQ(200, chunkId);
+    ASSERT_EQ(FSStatusCode::OK, adaptor->AllocS3ChunkId(1, 2, &chunkId));
+    ASSERT_EQ(201, chunkId);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(FSStatusCode::OK, adaptor->AllocS3ChunkId(1, 2, &chunkId));
+    ASSERT_EQ(400, chunkId);
+
+    adaptor->Stop();
 }
 
 }  // namespace client
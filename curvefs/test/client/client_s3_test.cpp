@@ -67,6 +67,25 @@ TEST_F(ClientS3Test, init_s3Adapter_userAgent) {
     ASSERT_STREQ(userAgent.c_str(), s3Adapter.GetConfig()->userAgent.c_str());
 }
 
+TEST_F(ClientS3Test, init_s3Adapter_multi_clients) {
+    curve::common::S3AdapterOption option;
+    option.s3Address = "127.0.0.1:9000,127.0.0.2:9000";
+    option.maxConnections = 32;
+    option.asyncThreadNum = 8;
+    option.clientNum = 4;
+    option.enableTcpKeepAlive = true;
+    option.tcpKeepAliveIntervalMs = 10000;
+
+    curve::common::S3Adapter s3Adapter;
+    s3Adapter.Init(option);
+    auto* config = s3Adapter.GetConfig();
+    ASSERT_STREQ("127.0.0.1:9000", config->endpointOverride.c_str());
+    ASSERT_EQ(8, config->maxConnections);
+    ASSERT_TRUE(config->enableTcpKeepAlive);
+    ASSERT_EQ(10000, config->tcpKeepAliveIntervalMs);
+    ASSERT_EQ(option.s3Address, s3Adapter.GetS3Endpoint());
+}
+
 TEST_F(ClientS3Test, upload) {
     const std::string obj("test");
     uint64_t len = 1024;
@@ -0,0 +1,100 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+#include "curvefs/src/client/close_flusher.h"
+
+namespace curvefs {
+namespace client {
+
+class CloseFlusherTest : public ::testing::Test {
+ protected:
+    CloseFlusher::FlushFunc Flush() {
+        return [this](uint64_t ino) {
+            std::unique_lock<std::mutex> lk(mtx_);
+            cond_.wait(lk, [this]() { return !blocked_; });
+            flushed_++;
+            return ino == failIno_ ? CURVEFS_ERROR::INTERNAL
+                                   : CURVEFS_ERROR::OK;
+        };
+    }
+
+    void Unblock() {
+        std::lock_guard<std::mutex> lk(mtx_);
+        blocked_ = false;
+        cond_.notify_all();
+    }
+
+ protected:
+    std::mutex mtx_;
+    std::condition_variable cond_;
+    bool blocked_ = true;
+    uint64_t failIno_ = 0;
+    std::atomic<uint32_t> flushed_{0};
+};
+
+TEST_F(CloseFlusherTest, BoundPendingFiles) {
+    CloseFlusher flusher(1, 2, Flush());
+    ASSERT_FALSE(flusher.Submit(1));
+    flusher.Start();
+
+    ASSERT_TRUE(flusher.Submit(1));
+    ASSERT_TRUE(flusher.Submit(2));
+    // the queued flush of 2 covers this close
+    ASSERT_TRUE(flusher.Submit(2));
+    // too many pending, flush in place
+    ASSERT_FALSE(flusher.Submit(3));
+
+    Unblock();
+    ASSERT_EQ(CURVEFS_ERROR::OK, flusher.WaitAll());
+    ASSERT_EQ(2, flushed_.load());
+    flusher.Stop();
+}
+
+TEST_F(CloseFlusherTest, DeferErrorToWait) {
+    failIno_ = 2;
+    CloseFlusher flusher(2, 16, Flush());
+    flusher.Start();
+    ASSERT_TRUE(flusher.Submit(1));
+    ASSERT_TRUE(flusher.Submit(2));
+    Unblock();
+
+    ASSERT_EQ(CURVEFS_ERROR::OK, flusher.Wait(1));
+    ASSERT_EQ(CURVEFS_ERROR::INTERNAL, flusher.Wait(2));
+    // reported once
+    ASSERT_EQ(CURVEFS_ERROR::OK, flusher.Wait(2));
+    flusher.Stop();
+}
+
+TEST_F(CloseFlusherTest, StopFlushesPending) {
+    CloseFlusher flusher(1, 16, Flush());
+    flusher.Start();
+    for (uint64_t ino = 1; ino <= 8; ino++) {
+        ASSERT_TRUE(flusher.Submit(ino));
+    }
+    Unblock();
+    flusher.Stop();
+    ASSERT_EQ(8, flushed_.load());
+    ASSERT_FALSE(flusher.Submit(1));
+}
+
+}  // namespace client
+}  // namespace curvefs
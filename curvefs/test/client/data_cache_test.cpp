@@ -169,5 +169,16 @@ TEST_F(DataCacheTest, test_truncate3) {
     ASSERT_EQ(2, dataCache_->GetLen());
 }
 
+TEST_F(DataCacheTest, test_release_page_to_pool) {
+    auto pagePool = s3ClientAdaptor_->GetFsCacheManager()->GetPagePool();
+    ASSERT_EQ(1024 * 1024, pagePool->GetInUseByte());
+
+    dataCache_->Truncate(512 * 1024);
+    ASSERT_EQ(512 * 1024, pagePool->GetInUseByte());
+
+    dataCache_ = nullptr;
+    ASSERT_EQ(0, pagePool->GetInUseByte());
+}
+
 }  // namespace client
 }  // namespace curvefs
@@ -72,6 +72,7 @@ class FileCacheManagerTest : public testing::Test {
         option.readCacheThreads = 5;
         option.diskCacheOpt.diskCacheType = (DiskCacheType)0;
         option.chunkFlushThreads = 5;
+        option.inlineDataMaxSize = inlineDataMaxSize_;
         s3ClientAdaptor_ = new S3ClientAdaptorImpl();
         auto fsCacheManager = std::make_shared<FsCacheManager>(
             s3ClientAdaptor_, option.readCacheMaxByte, option.writeCacheMaxByte,
@@ -97,6 +98,7 @@ class FileCacheManagerTest : public testing::Test {
     }
 
  protected:
+    uint32_t inlineDataMaxSize_ = 0;
     S3ClientAdaptorImpl *s3ClientAdaptor_;
     std::shared_ptr<FileCacheManager> fileCacheManager_;
     std::shared_ptr<MockChunkCacheManager> mockChunkCacheManager_;
@@ -272,6 +274,59 @@ TEST_F(FileCacheManagerTest, test_read_s3) {
     ASSERT_EQ(-1, fileCacheManager_->Read(inodeId, offset, len, buf.data()));
 }
 
+class FileCacheManagerInlineTest : public FileCacheManagerTest {
+ protected:
+    FileCacheManagerInlineTest() { inlineDataMaxSize_ = 4096; }
+};
+
+TEST_F(FileCacheManagerInlineTest, test_write_read_inline) {
+    const uint64_t inodeId = 1;
+    Inode inode;
+    inode.set_inodeid(inodeId);
+    inode.set_length(0);
+    auto inodeWrapper = std::make_shared<InodeWrapper>(inode, nullptr);
+    EXPECT_CALL(*mockInodeManager_, GetInode(_, _))
+        .WillRepeatedly(
+            DoAll(SetArgReferee<1>(inodeWrapper), Return(CURVEFS_ERROR::OK)));
+
+    std::vector<char> buf(100, 'a');
+    ASSERT_EQ(100, fileCacheManager_->Write(10, buf.size(), buf.data()));
+    ASSERT_TRUE(fileCacheManager_->IsEmpty());
+    ASSERT_TRUE(inodeWrapper->IsDirty());
+    std::string expected = std::string(10, '\0') + std::string(100, 'a');
+    ASSERT_EQ(expected, inodeWrapper->GetInlineDataLocked());
+
+    std::vector<char> out(expected.size());
+    ASSERT_EQ(expected.size(),
+              fileCacheManager_->Read(inodeId, 0, out.size(), out.data()));
+    ASSERT_EQ(expected, std::string(out.begin(), out.end()));
+}
+
+TEST_F(FileCacheManagerInlineTest, test_move_inline_data) {
+    const uint64_t inodeId = 1;
+    const std::string data(1000, 'b');
+    Inode inode;
+    inode.set_inodeid(inodeId);
+    inode.set_length(data.size());
+    inode.set_inlinedata(data);
+    auto inodeWrapper = std::make_shared<InodeWrapper>(inode, nullptr);
+    EXPECT_CALL(*mockInodeManager_, GetInode(_, _))
+        .WillRepeatedly(
+            DoAll(SetArgReferee<1>(inodeWrapper), Return(CURVEFS_ERROR::OK)));
+
+    // grows beyond the inline size
+    std::vector<char> buf(200, 'c');
+    ASSERT_EQ(200, fileCacheManager_->Write(4000, buf.size(), buf.data()));
+    ASSERT_TRUE(inodeWrapper->GetInlineDataLocked().empty());
+    ASSERT_FALSE(fileCacheManager_->IsEmpty());
+
+    std::vector<char> out(data.size());
+    ASSERT_EQ(data.size(),
+              fileCacheManager_->Read(inodeId, 0, out.size(), out.data()));
+    ASSERT_EQ(data, std::string(out.begin(), out.end()));
+    fileCacheManager_->ReleaseCache();
+}
+
 }  // namespace client
 }  // namespace curvefs
 
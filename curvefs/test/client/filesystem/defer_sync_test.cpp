@@ -174,6 +174,46 @@ TEST_F(DeferSyncTest, Dirty) {
     deferSync->Stop();
 }
 
+TEST_F(DeferSyncTest, Coalesce) {
+    auto builder = DeferSyncBuilder();
+    auto deferSync = builder.SetOption([&](bool* cto, DeferSyncOption* option) {
+        option->delay = 3;
+    }).Build();
+    deferSync->Start();
+
+    // CASE 1: the same inode pushed many times is synced once
+    auto inode = MkInode(100, InodeOption().metaClient(metaClient_));
+    EXPECT_CALL_INDOE_SYNC_TIMES(*metaClient_, 100 /* ino */, 1 /* times */);
+    for (auto length = 1; length <= 10; length++) {
+        inode->SetLength(length);
+        deferSync->Push(inode);
+    }
+    deferSync->Stop();
+}
+
+TEST_F(DeferSyncTest, MaxPending) {
+    auto builder = DeferSyncBuilder();
+    auto deferSync = builder.SetOption([&](bool* cto, DeferSyncOption* option) {
+        *cto = false;
+        option->delay = 3600;
+        option->maxPending = 2;
+    }).Build();
+    deferSync->Start();
+
+    // CASE 1: below the max pending, wait for the delay
+    std::shared_ptr<InodeWrapper> inode;
+    deferSync->Push(MkInode(100, InodeOption()));
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    ASSERT_TRUE(deferSync->IsDefered(100, &inode));
+
+    // CASE 2: reach the max pending, sync ahead of the delay
+    deferSync->Push(MkInode(200, InodeOption()));
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    ASSERT_FALSE(deferSync->IsDefered(100, &inode));
+    ASSERT_FALSE(deferSync->IsDefered(200, &inode));
+    deferSync->Stop();
+}
+
 TEST_F(DeferSyncTest, IsDefered_cto) {
     auto builder = DeferSyncBuilder();
     auto deferSync = builder.SetOption([&](bool* cto, DeferSyncOption* option) {
@@ -52,6 +52,7 @@ class DeferSyncBuilder {
         return DeferSyncOption {
             delay: 3,
             deferDirMtime: false,
+            maxPending: 4096,
         };
     }
 
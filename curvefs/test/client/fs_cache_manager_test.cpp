@@ -23,6 +23,9 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <thread>
+#include <vector>
+
 #include "curvefs/src/client/s3/client_s3_adaptor.h"
 #include "curvefs/src/client/s3/client_s3_cache_manager.h"
 #include "src/common/concurrent/count_down_event.h"
@@ -112,6 +115,64 @@ TEST_F(FsCacheManagerTest, test_ReleaseFileCacheManager) {
     ASSERT_EQ(nullptr, fsCacheManager_->FindFileCacheManager(inodeId));
 }
 
+TEST_F(FsCacheManagerTest, test_FindOrCreateFileCacheManager_concurrent) {
+    uint64_t fsId = 1;
+    const uint64_t inodeNum = 256;
+    const int threadNum = 8;
+    std::vector<std::vector<FileCacheManagerPtr>> created(threadNum);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadNum; ++i) {
+        threads.emplace_back([&, i]() {
+            for (uint64_t inodeId = 1; inodeId <= inodeNum; ++inodeId) {
+                created[i].push_back(
+                    fsCacheManager_->FindOrCreateFileCacheManager(fsId,
+                                                                  inodeId));
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    // every inode has only one file cache manager
+    for (uint64_t inodeId = 1; inodeId <= inodeNum; ++inodeId) {
+        auto fileCacheManager = fsCacheManager_->FindFileCacheManager(inodeId);
+        ASSERT_NE(nullptr, fileCacheManager);
+        ASSERT_EQ(inodeId, fileCacheManager->GetInodeId());
+        for (int i = 0; i < threadNum; ++i) {
+            ASSERT_EQ(fileCacheManager, created[i][inodeId - 1]);
+        }
+    }
+}
+
+TEST_F(FsCacheManagerTest, test_lru_byte_of_all_shards) {
+    uint64_t dataCacheByte = 128ull * 1024;  // 128KiB
+    char *buf = new char[dataCacheByte];
+    std::list<DataCachePtr>::iterator outIter;
+    std::vector<std::list<DataCachePtr>::iterator> iters;
+    std::vector<std::shared_ptr<MockChunkCacheManager>> chunkCacheManagers;
+
+    for (int i = 0; i < 8; ++i) {
+        chunkCacheManagers.push_back(
+            std::make_shared<MockChunkCacheManager>());
+        ASSERT_TRUE(fsCacheManager_->Set(
+            std::make_shared<DataCache>(s3ClientAdaptor_,
+                                        chunkCacheManagers.back(), 0,
+                                        dataCacheByte, buf, nullptr),
+            &outIter));
+        iters.push_back(outIter);
+        fsCacheManager_->Get(outIter);
+    }
+    ASSERT_EQ(8 * dataCacheByte, fsCacheManager_->GetLruByte());
+
+    for (auto &iter : iters) {
+        ASSERT_TRUE(fsCacheManager_->Delete(iter));
+    }
+    ASSERT_EQ(0, fsCacheManager_->GetLruByte());
+    delete[] buf;
+}
+
 TEST_F(FsCacheManagerTest, test_lru_set_and_delete) {
     uint64_t smallDataCacheByte = 128ull * 1024;  // 128KiB
     uint64_t dataCacheByte = 4ull * 1024 * 1024;  // 4MiB
@@ -0,0 +1,176 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "curvefs/src/client/s3/inflight_reads.h"
+
+namespace curvefs {
+namespace client {
+
+namespace {
+
+// a fetcher filling buf with offset-based bytes, blocked until released
+class FakeS3 {
+ public:
+    int Fetch(char *buf, uint64_t offset, uint64_t length) {
+        fetchNum_++;
+        std::unique_lock<std::mutex> lk(mtx_);
+        cond_.wait(lk, [this]() { return released_; });
+        for (uint64_t i = 0; i < length; ++i) {
+            buf[i] = static_cast<char>((offset + i) % 251);
+        }
+        return ret_;
+    }
+
+    void Release(int ret) {
+        std::lock_guard<std::mutex> lk(mtx_);
+        ret_ = ret;
+        released_ = true;
+        cond_.notify_all();
+    }
+
+    int GetFetchNum() const { return fetchNum_.load(); }
+
+ private:
+    std::mutex mtx_;
+    std::condition_variable cond_;
+    bool released_ = false;
+    int ret_ = 0;
+    std::atomic<int> fetchNum_{0};
+};
+
+bool CheckData(const std::vector<char> &buf, uint64_t offset) {
+    for (uint64_t i = 0; i < buf.size(); ++i) {
+        if (buf[i] != static_cast<char>((offset + i) % 251)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void WaitFlights(InflightReads *reads, size_t num) {
+    while (reads->Size() < num) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+}  // namespace
+
+TEST(InflightReadsTest, ShareCoveredRange) {
+    InflightReads reads;
+    FakeS3 s3;
+    auto fetcher = [&s3](char *buf, uint64_t offset, uint64_t length) {
+        return s3.Fetch(buf, offset, length);
+    };
+
+    std::vector<char> buf1(4096);
+    bool shared1 = true;
+    std::thread t1([&]() {
+        ASSERT_EQ(0, reads.Read("obj", 0, buf1.size(), buf1.data(), fetcher,
+                                &shared1));
+    });
+    WaitFlights(&reads, 1);
+
+    // covered by the read in flight
+    std::vector<char> buf2(1024);
+    bool shared2 = false;
+    std::thread t2([&]() {
+        ASSERT_EQ(0, reads.Read("obj", 1024, buf2.size(), buf2.data(),
+                                fetcher, &shared2));
+    });
+    // not covered, or another object
+    std::vector<char> buf3(4096);
+    std::vector<char> buf4(1024);
+    std::thread t3([&]() {
+        ASSERT_EQ(0, reads.Read("obj", 2048, buf3.size(), buf3.data(),
+                                fetcher));
+    });
+    std::thread t4([&]() {
+        ASSERT_EQ(0, reads.Read("obj2", 0, buf4.size(), buf4.data(),
+                                fetcher));
+    });
+    WaitFlights(&reads, 3);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    s3.Release(0);
+    t1.join();
+    t2.join();
+    t3.join();
+    t4.join();
+
+    ASSERT_EQ(3, s3.GetFetchNum());
+    ASSERT_FALSE(shared1);
+    ASSERT_TRUE(shared2);
+    ASSERT_TRUE(CheckData(buf1, 0));
+    ASSERT_TRUE(CheckData(buf2, 1024));
+    ASSERT_TRUE(CheckData(buf3, 2048));
+    ASSERT_TRUE(CheckData(buf4, 0));
+    ASSERT_EQ(0, reads.Size());
+}
+
+TEST(InflightReadsTest, ShareError) {
+    InflightReads reads;
+    FakeS3 s3;
+    auto fetcher = [&s3](char *buf, uint64_t offset, uint64_t length) {
+        return s3.Fetch(buf, offset, length);
+    };
+
+    std::vector<char> buf1(4096);
+    std::vector<char> buf2(4096);
+    std::thread t1([&]() {
+        ASSERT_EQ(-1, reads.Read("obj", 0, buf1.size(), buf1.data(), fetcher));
+    });
+    WaitFlights(&reads, 1);
+    std::thread t2([&]() {
+        ASSERT_EQ(-1, reads.Read("obj", 0, buf2.size(), buf2.data(), fetcher));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    s3.Release(-1);
+    t1.join();
+    t2.join();
+    ASSERT_EQ(1, s3.GetFetchNum());
+}
+
+TEST(InflightReadsTest, SequentialReadsNotShared) {
+    InflightReads reads;
+    FakeS3 s3;
+    s3.Release(0);
+    auto fetcher = [&s3](char *buf, uint64_t offset, uint64_t length) {
+        return s3.Fetch(buf, offset, length);
+    };
+
+    std::vector<char> buf(4096);
+    bool shared = true;
+    ASSERT_EQ(0, reads.Read("obj", 0, buf.size(), buf.data(), fetcher,
+                            &shared));
+    ASSERT_FALSE(shared);
+    ASSERT_EQ(0, reads.Read("obj", 0, buf.size(), buf.data(), fetcher,
+                            &shared));
+    ASSERT_FALSE(shared);
+    ASSERT_EQ(2, s3.GetFetchNum());
+}
+
+}  // namespace client
+}  // namespace curvefs
@@ -67,6 +67,10 @@ class MockInodeCacheManager : public InodeCacheManager {
     MOCK_METHOD2(CreateManageInode, CURVEFS_ERROR(const InodeParam &param,
         std::shared_ptr<InodeWrapper> &out));     // NOLINT
 
+    MOCK_METHOD4(CreateInodeWithDentry, CURVEFS_ERROR(
+        const InodeParam &param, const Dentry &dentry,
+        std::shared_ptr<InodeWrapper> &out, bool *dentryCreated));  // NOLINT
+
     MOCK_METHOD1(DeleteInode, CURVEFS_ERROR(uint64_t inodeid));
 
     MOCK_METHOD1(ShipToFlush, void(
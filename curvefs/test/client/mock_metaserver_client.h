@@ -71,6 +71,10 @@ class MockMetaServerClient : public MetaServerClient {
     MOCK_METHOD1(PrepareRenameTx,
                  MetaStatusCode(const std::vector<Dentry>& dentrys));
 
+    MOCK_METHOD2(PrepareRenameTx,
+                 MetaStatusCode(const std::vector<Dentry>& dentrys,
+                                bool* committed));
+
     MOCK_METHOD4(GetInode, MetaStatusCode(
             uint32_t fsId, uint64_t inodeid, Inode *out, bool* streaming));
 
@@ -143,6 +147,10 @@ class MockMetaServerClient : public MetaServerClient {
     MOCK_METHOD2(CreateManageInode, MetaStatusCode(
                  const InodeParam &param, Inode *out));
 
+    MOCK_METHOD4(CreateInodeWithDentry, MetaStatusCode(
+                 const InodeParam &param, const Dentry &dentry, Inode *out,
+                 bool *dentryCreated));
+
     MOCK_METHOD2(DeleteInode, MetaStatusCode(uint32_t fsId, uint64_t inodeid));
 
     MOCK_METHOD3(SplitRequestInodes, bool(uint32_t fsId,
@@ -0,0 +1,132 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "curvefs/src/client/s3/object_packer.h"
+
+namespace curvefs {
+namespace client {
+
+class ObjectPackerTest : public ::testing::Test {
+ protected:
+    ObjectPacker::AllocFunc Alloc() {
+        return [this](uint64_t* packId) {
+            *packId = ++nextId_;
+            return true;
+        };
+    }
+
+    ObjectPacker::UploadFunc Upload() {
+        return [this](uint64_t packId, const char* buf, uint64_t len) {
+            if (failUploads_.load() > 0) {
+                failUploads_--;
+                return -1;
+            }
+            std::lock_guard<std::mutex> lk(mtx_);
+            packs_[packId].assign(buf, len);
+            return 0;
+        };
+    }
+
+ protected:
+    std::atomic<uint64_t> nextId_{0};
+    std::atomic<int> failUploads_{0};
+    std::mutex mtx_;
+    std::map<uint64_t, std::string> packs_;
+};
+
+TEST_F(ObjectPackerTest, SealOnTimeout) {
+    ObjectPacker packer(1024, 8, 10, 1, Alloc(), Upload());
+    ObjectPacker::Slice slice;
+    ASSERT_TRUE(packer.Pack("hello", 5, &slice));
+    ASSERT_EQ(1, slice.packId);
+    ASSERT_EQ(0, slice.offset);
+    ASSERT_EQ(0, slice.index);
+    ASSERT_EQ(1, slice.count);
+    ASSERT_EQ("hello", packs_[1]);
+}
+
+TEST_F(ObjectPackerTest, PackConcurrentSlices) {
+    const uint32_t slices = 4;
+    // sealed once all the slices joined, long before the delay
+    ObjectPacker packer(1024, slices, 60 * 1000, 1, Alloc(), Upload());
+    std::vector<ObjectPacker::Slice> results(slices);
+    std::vector<std::string> datas;
+    for (uint32_t i = 0; i < slices; ++i) {
+        datas.emplace_back(i + 1, static_cast<char>('a' + i));
+    }
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < slices; ++i) {
+        threads.emplace_back([&, i]() {
+            ASSERT_TRUE(packer.Pack(datas[i].data(), datas[i].size(),
+                                    &results[i]));
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    ASSERT_EQ(1, packs_.size());
+    const std::string& pack = packs_[1];
+    std::vector<bool> indexes(slices, false);
+    for (uint32_t i = 0; i < slices; ++i) {
+        ASSERT_EQ(1, results[i].packId);
+        ASSERT_EQ(slices, results[i].count);
+        ASSERT_LT(results[i].index, slices);
+        indexes[results[i].index] = true;
+        ASSERT_EQ(datas[i], pack.substr(results[i].offset, datas[i].size()));
+    }
+    ASSERT_EQ(std::vector<bool>(slices, true), indexes);
+}
+
+TEST_F(ObjectPackerTest, SealOnMaxSize) {
+    // sealed by the slice filling it up, without waiting for the delay
+    ObjectPacker packer(4, 8, 60 * 1000, 1, Alloc(), Upload());
+    ObjectPacker::Slice slice;
+    ASSERT_TRUE(packer.Pack("12345", 5, &slice));
+    ASSERT_EQ(1, slice.count);
+    ASSERT_TRUE(packer.Pack("6789", 4, &slice));
+    ASSERT_EQ(2, slice.packId);
+    ASSERT_EQ(0, slice.offset);
+    ASSERT_EQ(1, slice.count);
+    ASSERT_EQ("12345", packs_[1]);
+    ASSERT_EQ("6789", packs_[2]);
+}
+
+TEST_F(ObjectPackerTest, RetryUploadAndFailAlloc) {
+    failUploads_ = 2;
+    ObjectPacker packer(1024, 1, 10, 1, Alloc(), Upload());
+    ObjectPacker::Slice slice;
+    ASSERT_TRUE(packer.Pack("abc", 3, &slice));
+    ASSERT_EQ(0, failUploads_.load());
+    ASSERT_EQ("abc", packs_[slice.packId]);
+
+    ObjectPacker failed(1024, 1, 10, 1,
+                        [](uint64_t*) { return false; }, Upload());
+    ASSERT_FALSE(failed.Pack("abc", 3, &slice));
+}
+
+}  // namespace client
+}  // namespace curvefs
@@ -0,0 +1,87 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "curvefs/src/client/s3/page_pool.h"
+
+namespace curvefs {
+namespace client {
+
+TEST(PagePoolTest, AllocateAndReuse) {
+    PagePool pool(4096, 2 * 4096);
+
+    char *page1 = pool.Allocate();
+    char *page2 = pool.Allocate();
+    ASSERT_NE(page1, page2);
+    ASSERT_EQ(2 * 4096, pool.GetInUseByte());
+    ASSERT_EQ(2 * 4096, pool.GetAllocatedByte());
+
+    pool.Release(page1);
+    ASSERT_EQ(4096, pool.GetInUseByte());
+    ASSERT_EQ(4096, pool.GetFreeByte());
+
+    // the free page is reused
+    char *page3 = pool.Allocate();
+    ASSERT_EQ(page1, page3);
+    ASSERT_EQ(2 * 4096, pool.GetAllocatedByte());
+    ASSERT_EQ(0, pool.GetFreeByte());
+
+    pool.Release(page2);
+    pool.Release(page3);
+    ASSERT_EQ(0, pool.GetInUseByte());
+}
+
+TEST(PagePoolTest, KeepAtMostMaxFreeByte) {
+    PagePool pool(4096, 2 * 4096);
+    std::vector<char *> pages;
+    for (int i = 0; i < 4; i++) {
+        pages.push_back(pool.Allocate());
+    }
+    ASSERT_EQ(4 * 4096, pool.GetAllocatedByte());
+
+    for (auto page : pages) {
+        pool.Release(page);
+    }
+    ASSERT_EQ(0, pool.GetInUseByte());
+    ASSERT_EQ(2 * 4096, pool.GetFreeByte());
+    ASSERT_EQ(2 * 4096, pool.GetAllocatedByte());
+}
+
+TEST(PagePoolTest, Trim) {
+    PagePool pool(4096, 4 * 4096);
+    std::vector<char *> pages;
+    for (int i = 0; i < 4; i++) {
+        pages.push_back(pool.Allocate());
+    }
+    for (auto page : pages) {
+        pool.Release(page);
+    }
+    ASSERT_EQ(4 * 4096, pool.GetFreeByte());
+
+    pool.Trim(4096);
+    ASSERT_EQ(4096, pool.GetFreeByte());
+    ASSERT_EQ(4096, pool.GetAllocatedByte());
+
+    pool.Trim();
+    ASSERT_EQ(0, pool.GetFreeByte());
+    ASSERT_EQ(0, pool.GetAllocatedByte());
+}
+
+}  // namespace client
+}  // namespace curvefs
@@ -0,0 +1,78 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "curvefs/src/client/s3/prefetch_window.h"
+
+namespace curvefs {
+namespace client {
+
+namespace {
+constexpr uint64_t kReadLen = 128 * 1024;
+}  // namespace
+
+TEST(PrefetchWindowTest, GrowForSequentialRead) {
+    PrefetchWindow window;
+    uint64_t offset = 0;
+    ASSERT_EQ(1, window.OnRead(offset, kReadLen, 1, 16));
+    for (uint32_t expect : {2, 4, 8, 16, 16}) {
+        offset += kReadLen;
+        ASSERT_EQ(expect, window.OnRead(offset, kReadLen, 1, 16));
+    }
+    ASSERT_EQ(16, window.GetWindow());
+
+    // re-read the same range or skip a little is still sequential
+    ASSERT_EQ(16, window.OnRead(offset, kReadLen, 1, 16));
+    offset += 2 * kReadLen;
+    ASSERT_EQ(16, window.OnRead(offset, kReadLen, 1, 16));
+}
+
+TEST(PrefetchWindowTest, CloseForRandomRead) {
+    PrefetchWindow window;
+    ASSERT_EQ(4, window.OnRead(0, kReadLen, 4, 16));
+    ASSERT_EQ(0, window.OnRead(100 * kReadLen, kReadLen, 4, 16));
+    ASSERT_EQ(0, window.OnRead(10 * kReadLen, kReadLen, 4, 16));
+
+    // sequential again after the random reads
+    ASSERT_EQ(1, window.OnRead(11 * kReadLen, kReadLen, 4, 16));
+    ASSERT_EQ(2, window.OnRead(12 * kReadLen, kReadLen, 4, 16));
+}
+
+TEST(PrefetchWindowTest, Disabled) {
+    PrefetchWindow window;
+    ASSERT_EQ(0, window.OnRead(0, kReadLen, 0, 16));
+    ASSERT_EQ(0, window.OnRead(kReadLen, kReadLen, 0, 16));
+    ASSERT_EQ(0, window.OnRead(2 * kReadLen, kReadLen, 1, 0));
+}
+
+TEST(PrefetchBudgetTest, TryAcquire) {
+    PrefetchBudget budget;
+    ASSERT_TRUE(budget.TryAcquire(2));
+    ASSERT_TRUE(budget.TryAcquire(2));
+    ASSERT_FALSE(budget.TryAcquire(2));
+    ASSERT_EQ(2, budget.GetInflight());
+
+    budget.Release();
+    ASSERT_TRUE(budget.TryAcquire(2));
+
+    // no limit
+    ASSERT_TRUE(budget.TryAcquire(0));
+    ASSERT_EQ(3, budget.GetInflight());
+}
+
+}  // namespace client
+}  // namespace curvefs
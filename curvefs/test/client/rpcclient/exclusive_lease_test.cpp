@@ -0,0 +1,79 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <set>
+
+#include "curvefs/src/client/rpcclient/exclusive_lease.h"
+
+namespace curvefs {
+namespace client {
+
+class ExclusiveLeaseTest : public ::testing::Test {
+ protected:
+    void TearDown() override {
+        ExclusiveLease::GetInstance().Init(false, nullptr);
+    }
+};
+
+TEST_F(ExclusiveLeaseTest, Disabled) {
+    auto& lease = ExclusiveLease::GetInstance();
+    lease.Init(false, nullptr);
+    ASSERT_FALSE(lease.Want());
+    ASSERT_FALSE(lease.Hold());
+    ASSERT_FALSE(lease.Defer(1));
+}
+
+TEST_F(ExclusiveLeaseTest, GrantDeferRecall) {
+    std::set<uint64_t> flushed;
+    auto& lease = ExclusiveLease::GetInstance();
+    lease.Init(true, [&](const std::set<uint64_t>& inos) {
+        flushed.insert(inos.begin(), inos.end());
+    });
+    ASSERT_TRUE(lease.Want());
+
+    // not granted yet
+    ASSERT_FALSE(lease.Defer(1));
+    ASSERT_FALSE(lease.HandleRecall());
+
+    // granted
+    lease.Update(true);
+    ASSERT_TRUE(lease.Hold());
+    ASSERT_TRUE(lease.Defer(2));
+    ASSERT_TRUE(lease.Defer(3));
+    ASSERT_FALSE(lease.HandleRecall());
+
+    // recalled, still hold until the deferred flushed
+    lease.Update(false);
+    ASSERT_TRUE(lease.Hold());
+    ASSERT_FALSE(lease.Defer(4));
+    lease.Update(true);  // not granted again while recalling
+    ASSERT_FALSE(lease.Defer(4));
+
+    ASSERT_TRUE(lease.HandleRecall());
+    ASSERT_EQ(flushed, (std::set<uint64_t>{2, 3}));
+    ASSERT_FALSE(lease.Hold());
+    ASSERT_FALSE(lease.HandleRecall());
+
+    // granted again
+    lease.Update(true);
+    ASSERT_TRUE(lease.Hold());
+    ASSERT_TRUE(lease.Defer(5));
+}
+
+}  // namespace client
+}  // namespace curvefs
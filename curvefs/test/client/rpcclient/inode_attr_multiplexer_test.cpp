@@ -0,0 +1,128 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "curvefs/src/client/rpcclient/inode_attr_multiplexer.h"
+
+namespace curvefs {
+namespace client {
+namespace rpcclient {
+
+namespace {
+
+MetaStatusCode FillAttrs(const std::set<uint64_t>& inodeIds,
+                         std::list<InodeAttr>* attrs) {
+    for (const auto ino : inodeIds) {
+        InodeAttr attr;
+        attr.set_inodeid(ino);
+        attr.set_length(ino * 10);
+        attrs->emplace_back(attr);
+    }
+    return MetaStatusCode::OK;
+}
+
+}  // namespace
+
+TEST(InodeAttrMultiplexerTest, Single) {
+    std::atomic<int> rpcs(0);
+    InodeAttrMultiplexer multiplexer(
+        100, [&](uint32_t fsId, const std::set<uint64_t>& inodeIds,
+                 std::list<InodeAttr>* attrs) {
+            rpcs++;
+            EXPECT_EQ(fsId, 1);
+            return FillAttrs(inodeIds, attrs);
+        });
+
+    InodeAttr attr;
+    ASSERT_EQ(MetaStatusCode::OK, multiplexer.Get(1, 200, 100, &attr));
+    ASSERT_EQ(attr.inodeid(), 100);
+    ASSERT_EQ(attr.length(), 1000);
+    ASSERT_EQ(rpcs.load(), 1);
+}
+
+TEST(InodeAttrMultiplexerTest, Concurrent) {
+    std::atomic<int> rpcs(0);
+    std::atomic<uint64_t> maxBatch(0);
+    InodeAttrMultiplexer multiplexer(
+        100, [&](uint32_t fsId, const std::set<uint64_t>& inodeIds,
+                 std::list<InodeAttr>* attrs) {
+            rpcs++;
+            if (inodeIds.size() > maxBatch.load()) {
+                maxBatch.store(inodeIds.size());
+            }
+            // slow rpc, let the gets queue up
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            return FillAttrs(inodeIds, attrs);
+        });
+
+    std::vector<std::thread> threads;
+    for (uint64_t ino = 1; ino <= 32; ino++) {
+        threads.emplace_back([&, ino]() {
+            InodeAttr attr;
+            ASSERT_EQ(MetaStatusCode::OK,
+                      multiplexer.Get(1, 200, ino, &attr));
+            ASSERT_EQ(attr.inodeid(), ino);
+            ASSERT_EQ(attr.length(), ino * 10);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ASSERT_LT(rpcs.load(), 32);
+    ASSERT_GT(maxBatch.load(), 1);
+}
+
+TEST(InodeAttrMultiplexerTest, BatchFailed) {
+    // the inode 2 is deleted, which fails the whole batch
+    InodeAttrMultiplexer multiplexer(
+        100, [&](uint32_t fsId, const std::set<uint64_t>& inodeIds,
+                 std::list<InodeAttr>* attrs) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (inodeIds.count(2)) {
+                return MetaStatusCode::NOT_FOUND;
+            }
+            return FillAttrs(inodeIds, attrs);
+        });
+
+    std::vector<std::thread> threads;
+    for (uint64_t ino = 1; ino <= 8; ino++) {
+        threads.emplace_back([&, ino]() {
+            InodeAttr attr;
+            auto rc = multiplexer.Get(1, 200, ino, &attr);
+            if (ino == 2) {
+                ASSERT_EQ(MetaStatusCode::NOT_FOUND, rc);
+            } else {
+                ASSERT_EQ(MetaStatusCode::OK, rc);
+                ASSERT_EQ(attr.inodeid(), ino);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+}  // namespace rpcclient
+}  // namespace client
+}  // namespace curvefs
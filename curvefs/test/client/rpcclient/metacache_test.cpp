@@ -341,6 +341,52 @@ TEST_F(MetaCacheTest, test_GetPartitionIdByInodeId) {
     ASSERT_EQ(pid, 1);
 }
 
+TEST_F(MetaCacheTest, test_RouteUnsortedPartitions) {
+    std::vector<CopysetInfo<MetaserverID>> metaServerInfos;
+    metaServerInfos.push_back(metaServerList_);
+
+    // partitions listed out of order: [21, 30], [1, 10], [11, 20]
+    MetaCache::PartitionInfoList pInfoList;
+    for (uint32_t i = 0; i < 3; i++) {
+        PartitionInfo pInfo;
+        pInfo.CopyFrom(pInfoList_[0]);
+        uint64_t start = ((i + 2) % 3) * 10 + 1;
+        pInfo.set_partitionid(start / 10 + 1);
+        pInfo.set_start(start);
+        pInfo.set_end(start + 9);
+        pInfoList.emplace_back(pInfo);
+    }
+
+    EXPECT_CALL(*mockMdsClient_.get(), ListPartition(1, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(SetArgPointee<1>(pInfoList), Return(true)));
+    EXPECT_CALL(*mockMdsClient_.get(), GetCopysetOfPartitions(_, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(SetArgPointee<1>(copysetMap_), Return(true)));
+    EXPECT_CALL(*mockMdsClient_.get(), GetMetaServerListInCopysets(_, _, _))
+        .Times(2)
+        .WillRepeatedly(
+            DoAll(SetArgPointee<2>(metaServerInfos), Return(true)));
+
+    uint32_t pid = 0;
+    ASSERT_TRUE(metaCache_.GetPartitionIdByInodeId(1, 15, &pid));
+    ASSERT_EQ(2, pid);
+
+    // routed from the cache without listing again
+    ASSERT_TRUE(metaCache_.GetPartitionIdByInodeId(1, 1, &pid));
+    ASSERT_EQ(1, pid);
+    ASSERT_TRUE(metaCache_.GetPartitionIdByInodeId(1, 30, &pid));
+    ASSERT_EQ(3, pid);
+    uint64_t txId = 0;
+    ASSERT_TRUE(metaCache_.GetTxId(1, 20, &pid, &txId));
+    ASSERT_EQ(2, pid);
+    ASSERT_EQ(100, txId);
+    ASSERT_FALSE(metaCache_.GetTxId(2, 20, &pid, &txId));
+
+    // not in any partition, list again
+    ASSERT_FALSE(metaCache_.GetPartitionIdByInodeId(1, 31, &pid));
+}
+
 }  // namespace rpcclient
 }  // namespace client
 }  // namespace curvefs
@@ -54,6 +54,8 @@ class MockMetaCache : public MetaCache {
 
     MOCK_METHOD1(MarkPartitionUnavailable, bool(PartitionID pid));
 
+    MOCK_METHOD1(IsPartitionReadWrite, bool(PartitionID pid));
+
     MOCK_METHOD2(GetTargetLeader, bool(CopysetTarget *target, bool refresh));
 
     MOCK_METHOD3(GetPartitionIdByInodeId,
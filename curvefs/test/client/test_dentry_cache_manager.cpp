@@ -25,6 +25,9 @@
 #include <google/protobuf/util/message_differencer.h>
 #include <unistd.h>
 
+#include <utility>
+#include <vector>
+
 #include "curvefs/test/client/mock_metaserver_client.h"
 #include "curvefs/src/client/dentry_cache_manager.h"
 
@@ -238,6 +241,47 @@ TEST_F(TestDentryCacheManager, ListDentryFailed) {
     ASSERT_EQ(0, out.size());
 }
 
+TEST_F(TestDentryCacheManager, ListDentryPages) {
+    uint64_t parent = 99;
+    uint32_t limit = 100;
+
+    std::list<Dentry> part1, part2;
+    part1.resize(limit);
+    part1.back().set_name("last");
+    part2.resize(limit - 1);
+
+    EXPECT_CALL(*metaClient_, ListDentry(fsId_, parent, "", limit, false, _))
+        .WillOnce(DoAll(SetArgPointee<5>(part1),
+                Return(MetaStatusCode::OK)));
+    EXPECT_CALL(*metaClient_,
+                ListDentry(fsId_, parent, "last", limit, false, _))
+        .WillOnce(DoAll(SetArgPointee<5>(part2),
+                Return(MetaStatusCode::OK)));
+
+    std::vector<std::pair<size_t, bool>> pages;
+    CURVEFS_ERROR ret = dCacheManager_->ListDentryPages(parent, limit,
+        [&](std::list<Dentry>* dentries, bool last) {
+            pages.emplace_back(dentries->size(), last);
+        });
+    ASSERT_EQ(CURVEFS_ERROR::OK, ret);
+    ASSERT_EQ(2, pages.size());
+    ASSERT_EQ(limit, pages[0].first);
+    ASSERT_FALSE(pages[0].second);
+    ASSERT_EQ(limit - 1, pages[1].first);
+    ASSERT_TRUE(pages[1].second);
+
+    // list failed
+    EXPECT_CALL(*metaClient_, ListDentry(fsId_, parent, _, _, _, _))
+        .WillOnce(Return(MetaStatusCode::UNKNOWN_ERROR));
+    pages.clear();
+    ret = dCacheManager_->ListDentryPages(parent, limit,
+        [&](std::list<Dentry>* dentries, bool last) {
+            pages.emplace_back(dentries->size(), last);
+        });
+    ASSERT_EQ(CURVEFS_ERROR::UNKNOWN, ret);
+    ASSERT_TRUE(pages.empty());
+}
+
 TEST_F(TestDentryCacheManager, GetTimeOutDentry) {
     curvefs::client::common::FLAGS_enableCto = false;
     uint64_t parent = 99;
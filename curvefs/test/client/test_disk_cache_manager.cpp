@@ -584,6 +584,66 @@ TEST_F(TestDiskCacheManager, TrimCache_exceed) {
     diskCacheManager_->UmountDiskCache();
 }
 
+TEST_F(TestDiskCacheManager, CacheIndex) {
+    // a, b and c are cached, the index saved by the last umount
+    // has b, d (removed since then) and a, from the coldest
+    EXPECT_CALL(*diskCacheRead_, GetCacheIoFullDir())
+        .WillRepeatedly(Return("test"));
+    EXPECT_CALL(*wrapper, stat(NotNull(), NotNull())).WillOnce(Return(0));
+    DIR *dir = opendir(".");
+    ASSERT_NE(nullptr, dir);
+    struct dirent a, b, c;
+    strcpy(a.d_name, "a");  // NOLINT
+    strcpy(b.d_name, "b");  // NOLINT
+    strcpy(c.d_name, "c");  // NOLINT
+    EXPECT_CALL(*wrapper, opendir(NotNull())).WillOnce(Return(dir));
+    EXPECT_CALL(*wrapper, readdir(NotNull()))
+        .WillOnce(Return(&a))
+        .WillOnce(Return(&b))
+        .WillOnce(Return(&c))
+        .WillOnce(ReturnNull());
+    EXPECT_CALL(*wrapper, closedir(NotNull())).WillOnce(Return(0));
+    std::string index = "b\nd\na\n";
+    EXPECT_CALL(*wrapper, open(_, _, _)).WillOnce(Return(10));
+    EXPECT_CALL(*wrapper, read(10, _, _))
+        .WillOnce(Invoke([&](int, void *buf, size_t) {
+            memcpy(buf, index.data(), index.size());
+            return static_cast<ssize_t>(index.size());
+        }))
+        .WillOnce(Return(0));
+    EXPECT_CALL(*wrapper, close(10)).WillOnce(Return(0));
+    ASSERT_EQ(0, diskCacheManager_->LoadAllCacheReadFile());
+    closedir(dir);
+
+    // c is not in the index, so it's the coldest
+    std::string saved;
+    EXPECT_CALL(*wrapper, open(_, _, _)).WillOnce(Return(11));
+    EXPECT_CALL(*wrapper, write(11, _, _))
+        .WillOnce(Invoke([&](int, const void *buf, size_t count) {
+            saved.assign(static_cast<const char *>(buf), count);
+            return static_cast<ssize_t>(count);
+        }));
+    EXPECT_CALL(*wrapper, fdatasync(11)).WillOnce(Return(0));
+    EXPECT_CALL(*wrapper, close(11)).WillOnce(Return(0));
+    EXPECT_CALL(*wrapper, rename(_, _)).WillOnce(Return(0));
+    ASSERT_EQ(0, diskCacheManager_->SaveCacheIndex());
+    ASSERT_EQ("c\nb\na\n", saved);
+
+    // a read moves the object to the front
+    ASSERT_TRUE(diskCacheManager_->IsCached("c"));
+    EXPECT_CALL(*wrapper, open(_, _, _)).WillOnce(Return(11));
+    EXPECT_CALL(*wrapper, write(11, _, _))
+        .WillOnce(Invoke([&](int, const void *buf, size_t count) {
+            saved.assign(static_cast<const char *>(buf), count);
+            return static_cast<ssize_t>(count);
+        }));
+    EXPECT_CALL(*wrapper, fdatasync(11)).WillOnce(Return(0));
+    EXPECT_CALL(*wrapper, close(11)).WillOnce(Return(0));
+    EXPECT_CALL(*wrapper, rename(_, _)).WillOnce(Return(0));
+    ASSERT_EQ(0, diskCacheManager_->SaveCacheIndex());
+    ASSERT_EQ("b\na\nc\n", saved);
+}
+
 TEST_F(TestDiskCacheManager, WriteReadDirect) {
     std::string fileName = "test";
     std::string buf = "test";
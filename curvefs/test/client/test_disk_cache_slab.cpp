@@ -0,0 +1,146 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+#include <memory>
+#include <string>
+
+#include "curvefs/src/client/s3/disk_cache_slab.h"
+
+namespace curvefs {
+namespace client {
+
+class TestDiskCacheSlab : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        char tmpl[] = "/tmp/curvefs_slab_XXXXXX";
+        ASSERT_NE(nullptr, mkdtemp(tmpl));
+        dir_ = tmpl;
+        wrapper_ = std::make_shared<PosixWrapper>();
+    }
+
+    void TearDown() override {
+        std::string cmd = "rm -rf " + dir_;
+        ASSERT_EQ(0, system(cmd.c_str()));
+    }
+
+    std::unique_ptr<DiskCacheSlab> NewSlab(uint64_t slotNum = 4) {
+        // fall back to buffered io if /tmp does not support O_DIRECT
+        return std::unique_ptr<DiskCacheSlab>(
+            new DiskCacheSlab(wrapper_, dir_, kSlotSize,
+                              kSlotSize * slotNum, true));
+    }
+
+    static constexpr uint64_t kSlotSize = 8192;
+    std::string dir_;
+    std::shared_ptr<PosixWrapper> wrapper_;
+};
+
+TEST_F(TestDiskCacheSlab, PutGetRemove) {
+    auto slab = NewSlab();
+    ASSERT_EQ(0, slab->Open());
+    ASSERT_EQ(4, slab->GetSlotNum());
+
+    std::string data(5000, 'a');
+    data[4999] = 'z';
+    ASSERT_EQ(5000, slab->Put("obj1", data.data(), data.size()));
+    ASSERT_TRUE(slab->Exist("obj1"));
+
+    char buf[10];
+    ASSERT_EQ(10, slab->Get("obj1", buf, 4990, 10));
+    ASSERT_EQ(data.substr(4990, 10), std::string(buf, 10));
+    // out of the object
+    ASSERT_GT(0, slab->Get("obj1", buf, 4995, 10));
+    ASSERT_GT(0, slab->Get("obj2", buf, 0, 10));
+
+    // larger than a slot
+    std::string large(kSlotSize + 1, 'b');
+    ASSERT_GT(0, slab->Put("large", large.data(), large.size()));
+
+    ASSERT_EQ(5000, slab->Remove("obj1"));
+    ASSERT_EQ(-1, slab->Remove("obj1"));
+    ASSERT_GT(0, slab->Get("obj1", buf, 0, 10));
+    ASSERT_EQ(0, slab->Size());
+}
+
+TEST_F(TestDiskCacheSlab, Full) {
+    auto slab = NewSlab(2);
+    ASSERT_EQ(0, slab->Open());
+    std::string data(100, 'c');
+    ASSERT_EQ(100, slab->Put("obj1", data.data(), data.size()));
+    ASSERT_EQ(100, slab->Put("obj2", data.data(), data.size()));
+    ASSERT_GT(0, slab->Put("obj3", data.data(), data.size()));
+
+    // replace releases the old slot
+    std::string other(200, 'd');
+    ASSERT_EQ(100, slab->Remove("obj2"));
+    ASSERT_EQ(200, slab->Put("obj1", other.data(), other.size()));
+    ASSERT_EQ(1, slab->Size());
+    ASSERT_EQ(100, slab->Put("obj3", data.data(), data.size()));
+
+    char buf[200];
+    ASSERT_EQ(200, slab->Get("obj1", buf, 0, 200));
+    ASSERT_EQ(other, std::string(buf, 200));
+}
+
+TEST_F(TestDiskCacheSlab, Reopen) {
+    std::string data1(3000, 'e');
+    std::string data2(7000, 'f');
+    {
+        auto slab = NewSlab();
+        ASSERT_EQ(0, slab->Open());
+        ASSERT_EQ(3000, slab->Put("obj1", data1.data(), data1.size()));
+        ASSERT_EQ(7000, slab->Put("obj2", data2.data(), data2.size()));
+        ASSERT_EQ(0, slab->Close());
+    }
+
+    {
+        auto slab = NewSlab();
+        ASSERT_EQ(0, slab->Open());
+        ASSERT_EQ(2, slab->Size());
+        char buf[100];
+        ASSERT_EQ(100, slab->Get("obj2", buf, 6900, 100));
+        ASSERT_EQ(data2.substr(6900, 100), std::string(buf, 100));
+        // the slots loaded are not allocated again
+        ASSERT_EQ(3000, slab->Put("obj3", data1.data(), data1.size()));
+        ASSERT_EQ(3000, slab->Put("obj4", data1.data(), data1.size()));
+        ASSERT_EQ(100, slab->Get("obj2", buf, 6900, 100));
+        ASSERT_EQ(data2.substr(6900, 100), std::string(buf, 100));
+        // not closed, as if crashed
+    }
+
+    {
+        auto slab = NewSlab();
+        ASSERT_EQ(0, slab->Open());
+        ASSERT_EQ(0, slab->Size());
+    }
+
+    {
+        // the index of another slab size is dropped
+        auto slab = NewSlab();
+        ASSERT_EQ(0, slab->Open());
+        ASSERT_EQ(3000, slab->Put("obj1", data1.data(), data1.size()));
+        ASSERT_EQ(0, slab->Close());
+        auto other = NewSlab(8);
+        ASSERT_EQ(0, other->Open());
+        ASSERT_EQ(0, other->Size());
+    }
+}
+
+}  // namespace client
+}  // namespace curvefs
@@ -337,10 +337,9 @@ TEST_F(TestDiskCacheWrite, UploadAllCacheWriteFile) {
     dir = opendir(".");
     EXPECT_NE(dir, nullptr);
 
+    // the file is only queued, not read or uploaded
     EXPECT_CALL(*wrapper_, stat(NotNull(), NotNull()))
-        .Times(2)
-        .WillOnce(Return(0))
-        .WillOnce(Return(-1));
+        .WillOnce(Return(0));
     EXPECT_CALL(*wrapper_, opendir(NotNull()))
         .WillOnce(Return(dir));
     EXPECT_CALL(*wrapper_, readdir(NotNull()))
@@ -349,16 +348,20 @@ TEST_F(TestDiskCacheWrite, UploadAllCacheWriteFile) {
         .WillOnce(ReturnNull());
     EXPECT_CALL(*wrapper_, closedir(NotNull()))
         .WillOnce(Return(0));
+    EXPECT_CALL(*wrapper_, open(_, _, _)).Times(0);
+    EXPECT_CALL(*client_, UploadAsync(_)).Times(0);
     ret = diskCacheWrite_->UploadAllCacheWriteFile();
     ASSERT_EQ(0, ret);
 }
 
 TEST_F(TestDiskCacheWrite, UploadAllCacheWriteFile_2) {
     std::string path = "test";
-    DIR* dir;
+    DIR *dir, *dir2;
 
     dir = opendir(".");
     EXPECT_NE(dir, nullptr);
+    dir2 = opendir(".");
+    EXPECT_NE(dir2, nullptr);
 
     struct dirent fake, fake2;
     fake.d_type = 8;
@@ -369,14 +372,19 @@ TEST_F(TestDiskCacheWrite, UploadAllCacheWriteFile_2) {
     EXPECT_CALL(*wrapper_, stat(NotNull(), NotNull()))
         .WillRepeatedly(Return(0));
     EXPECT_CALL(*wrapper_, opendir(NotNull()))
-        .WillOnce(Return(dir));
+        .WillOnce(Return(dir))
+        .WillOnce(Return(dir2));
+    // the second scan finds a file already queued
     EXPECT_CALL(*wrapper_, readdir(NotNull()))
-        .Times(3)
+        .Times(5)
         .WillOnce(Return(&fake))
         .WillOnce(Return(&fake2))
+        .WillOnce(ReturnNull())
+        .WillOnce(Return(&fake))
         .WillOnce(ReturnNull());
     EXPECT_CALL(*wrapper_, closedir(NotNull()))
-        .WillOnce(Return(0));
+        .Times(2)
+        .WillRepeatedly(Return(0));
     EXPECT_CALL(*wrapper_, open(_, _, _))
         .WillRepeatedly(Return(0));
     EXPECT_CALL(*wrapper_, close(_))
@@ -415,6 +423,13 @@ TEST_F(TestDiskCacheWrite, UploadAllCacheWriteFile_2) {
         .WillRepeatedly(Return(0));
     int ret = diskCacheWrite_->UploadAllCacheWriteFile();
     ASSERT_EQ(0, ret);
+    ret = diskCacheWrite_->UploadAllCacheWriteFile();
+    ASSERT_EQ(0, ret);
+
+    // the queued files are uploaded by the async upload thread,
+    // and stop waits for them
+    (void)diskCacheWrite_->AsyncUploadRun();
+    diskCacheWrite_->AsyncUploadStop();
 }
 
 TEST_F(TestDiskCacheWrite, RemoveFile) {
@@ -483,23 +498,17 @@ TEST_F(TestDiskCacheWrite, UploadFileByInode) {
 
     LOG(INFO) << "#############case2: no file need upload";
     diskCacheWrite_->AsyncUploadEnqueue(obj1);
-    DIR *dir = opendir(".");
     EXPECT_CALL(*wrapper_, stat(NotNull(), NotNull()))
-        .Times(2)
-        .WillRepeatedly(Return(0));
-    EXPECT_CALL(*wrapper_, opendir(NotNull())).WillOnce(Return(dir));
-    EXPECT_CALL(*wrapper_, closedir(NotNull()))
         .WillOnce(Return(0));
-    EXPECT_CALL(*wrapper_, readdir(NotNull())).WillOnce(ReturnNull());
+    EXPECT_CALL(*wrapper_, opendir(NotNull())).Times(0);
     ASSERT_EQ(0, diskCacheWrite_->UploadFileByInode(inode));
 
     LOG(INFO) << "#############case3: file need to upload";
     std::string path("test");
     EXPECT_CALL(*wrapper_, stat(NotNull(), NotNull()))
-        .Times(4)
+        .Times(3)
         .WillRepeatedly(Return(0));
     EXPECT_CALL(*wrapper_, close(_)).WillOnce(Return(0));
-    EXPECT_CALL(*wrapper_, readdir(NotNull())).WillOnce(ReturnNull());
     EXPECT_CALL(*wrapper_, open(_, _, _)).WillOnce(Return(10));
     EXPECT_CALL(*wrapper_, malloc(_)).WillOnce(Return(&path));
     EXPECT_CALL(*wrapper_, memset(_, _, _)).WillOnce(Return(&path));
@@ -513,28 +522,34 @@ TEST_F(TestDiskCacheWrite, UploadFileByInode) {
                 context->retCode = 0;
                 context->cb(context);
             }));
-    EXPECT_CALL(*wrapper_, opendir(NotNull())).WillOnce(Return(dir));
-    EXPECT_CALL(*wrapper_, closedir(NotNull())).WillOnce(Return(0));
     ASSERT_EQ(0, diskCacheWrite_->UploadFileByInode("16777216"));
 
     LOG(INFO) << "#############case4: no file need to upload, but need other "
                  "upload task finish";
-    struct dirent fake;
-    fake.d_type = 8;
-    strcpy(fake.d_name, obj1.c_str());  // NOLINT
+    std::shared_ptr<PutObjectAsyncContext> uploading;
     EXPECT_CALL(*wrapper_, stat(NotNull(), NotNull()))
         .Times(3)
         .WillRepeatedly(Return(0));
-    EXPECT_CALL(*wrapper_, opendir(NotNull()))
-        .Times(2)
-        .WillRepeatedly(Return(dir));
-    EXPECT_CALL(*wrapper_, closedir(NotNull()))
-        .Times(2)
-        .WillRepeatedly(Return(0));
-    EXPECT_CALL(*wrapper_, readdir(NotNull()))
-        .WillOnce(Return(&fake))
-        .WillRepeatedly(ReturnNull());
+    EXPECT_CALL(*wrapper_, close(_)).WillOnce(Return(0));
+    EXPECT_CALL(*wrapper_, open(_, _, _)).WillOnce(Return(10));
+    EXPECT_CALL(*wrapper_, malloc(_)).WillOnce(Return(&path));
+    EXPECT_CALL(*wrapper_, memset(_, _, _)).WillOnce(Return(&path));
+    EXPECT_CALL(*wrapper_, read(_, _, _)).WillOnce(Return(239772865546436));
+    EXPECT_CALL(*wrapper_, opendir(NotNull())).Times(0);
+    EXPECT_CALL(*client_, UploadAsync(_))
+        .WillOnce(
+            Invoke([&](const std::shared_ptr<PutObjectAsyncContext> &context) {
+                uploading = context;
+            }));
+    ASSERT_EQ(0, diskCacheWrite_->UploadFile(obj1));
+    std::thread finish([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        uploading->key = obj1;
+        uploading->retCode = 0;
+        uploading->cb(uploading);
+    });
     ASSERT_EQ(0, diskCacheWrite_->UploadFileByInode("16777216"));
+    finish.join();
 }
 
 TEST_F(TestDiskCacheWrite, test_SynchronizationTask) {
@@ -80,6 +80,7 @@ using ::testing::Contains;
 using ::testing::DoAll;
 using ::testing::Invoke;
 using ::testing::Return;
+using ::testing::SaveArg;
 using ::testing::SetArgPointee;
 using ::testing::SetArgReferee;
 using ::testing::SetArrayArgument;
@@ -3750,12 +3751,13 @@ TEST_F(TestFuseS3Client, FuseOpCreate_EnableSummary) {
     inode.set_openmpcount(0);
     auto inodeWrapper = std::make_shared<InodeWrapper>(inode, metaClient_);
 
-    EXPECT_CALL(*inodeManager_, CreateInode(_, _))
-        .WillOnce(
-            DoAll(SetArgReferee<1>(inodeWrapper), Return(CURVEFS_ERROR::OK)));
+    // the dentry is created with the inode by one rpc
+    EXPECT_CALL(*inodeManager_, CreateInodeWithDentry(_, _, _, _))
+        .WillOnce(DoAll(SetArgReferee<2>(inodeWrapper), SetArgPointee<3>(true),
+                        Return(CURVEFS_ERROR::OK)));
 
     EXPECT_CALL(*dentryManager_, CreateDentry(_))
-        .WillOnce(Return(CURVEFS_ERROR::OK));
+        .Times(0);
 
     Inode parentInode;
     parentInode.set_fsid(fsId);
@@ -3791,6 +3793,45 @@ TEST_F(TestFuseS3Client, FuseOpCreate_EnableSummary) {
     ASSERT_EQ(p->xattr().find(XATTR_DIR_FBYTES)->second, "4196");
 }
 
+TEST_F(TestFuseS3Client, FuseOpCreate_CompoundCreateNotSupported) {
+    fuse_req fakeReq;
+    fuse_ctx fakeCtx;
+    fakeReq.ctx = &fakeCtx;
+    fuse_req_t req = &fakeReq;
+    fuse_ino_t parent = 1;
+    const char* name = "xxx";
+    mode_t mode = 1;
+    struct fuse_file_info fi;
+    fi.flags = 0;
+
+    fuse_ino_t ino = 2;
+    Inode inode;
+    inode.set_fsid(fsId);
+    inode.set_inodeid(ino);
+    inode.set_length(0);
+    inode.set_type(FsFileType::TYPE_FILE);
+    inode.set_openmpcount(0);
+    auto inodeWrapper = std::make_shared<InodeWrapper>(inode, metaClient_);
+
+    // the metaserver ignores the dentry, create it by another rpc
+    EXPECT_CALL(*inodeManager_, CreateInodeWithDentry(_, _, _, _))
+        .WillOnce(DoAll(SetArgReferee<2>(inodeWrapper),
+                        SetArgPointee<3>(false),
+                        Return(CURVEFS_ERROR::OK)));
+
+    Dentry dentry;
+    EXPECT_CALL(*dentryManager_, CreateDentry(_))
+        .WillOnce(DoAll(SaveArg<0>(&dentry), Return(CURVEFS_ERROR::OK)));
+
+    EntryOut entryOut;
+    CURVEFS_ERROR ret =
+        client_->FuseOpCreate(req, parent, name, mode, &fi, &entryOut);
+    ASSERT_EQ(CURVEFS_ERROR::OK, ret);
+    ASSERT_EQ(ino, dentry.inodeid());
+    ASSERT_EQ(parent, dentry.parentinodeid());
+    ASSERT_EQ(name, dentry.name());
+}
+
 TEST_F(TestFuseS3Client, FuseOpWrite_EnableSummary) {
     client_->SetEnableSumInDir(true);
 
@@ -104,6 +104,7 @@ class TestFuseVolumeClient : public ::testing::Test {
         fuseClientOption_.listDentryLimit = listDentryLimit_;
         fuseClientOption_.listDentryThreads = listDentryThreads_;
         fuseClientOption_.dummyServerStartPort = 5000;
+        fuseClientOption_.enableCompoundCreate = false;
         {
             auto option = FileSystemOption();
             option.maxNameLength = 20u;
@@ -1003,8 +1004,10 @@ TEST_F(TestFuseVolumeClient, FuseOpRenameOverwrite) {
 
 
     // step3: prepare tx
-    EXPECT_CALL(*metaClient_, PrepareRenameTx(_))
-        .WillOnce(Invoke([&](const std::vector<Dentry> &dentrys) {
+    EXPECT_CALL(*metaClient_, PrepareRenameTx(_, _))
+        .WillOnce(Invoke([&](const std::vector<Dentry> &dentrys,
+                             bool *committed) {
+            *committed = false;
             auto srcDentry = GenDentry(fsId, parent, name, txId + 1, inodeId,
                                        FILE | DELETE | TX_PREPARE);
             auto dstDentry = GenDentry(fsId, newparent, newname, txId + 1,
@@ -1184,9 +1187,10 @@ TEST_F(TestFuseVolumeClient, FuseOpRenameParallel) {
             Return(CURVEFS_ERROR::OK)));
 
     // step3: prepare tx
-    EXPECT_CALL(*metaClient_, PrepareRenameTx(_))
+    EXPECT_CALL(*metaClient_, PrepareRenameTx(_, _))
         .Times(times)
-        .WillRepeatedly(Return(MetaStatusCode::OK));
+        .WillRepeatedly(DoAll(SetArgPointee<1>(false),
+                              Return(MetaStatusCode::OK)));
 
     // step4: commit tx
     EXPECT_CALL(*mdsClient_, CommitTx(_))
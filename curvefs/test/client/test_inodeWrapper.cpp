@@ -29,6 +29,7 @@
 #include <condition_variable>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 #include "curvefs/proto/metaserver.pb.h"
 #include "curvefs/src/client/inode_wrapper.h"
@@ -127,6 +128,36 @@ TEST(TestAppendS3ChunkInfoToMap, testAppendS3ChunkInfoToMap) {
         info3, s3ChunkInfoMap[chunkIndex2].s3chunks(0)));
 }
 
+TEST(TestCompactS3ChunkInfoList, testCompactS3ChunkInfoList) {
+    // chunkid, offset, len, from the oldest to the newest
+    std::vector<std::vector<uint64_t>> infos = {
+        {1, 0, 1024},    // covered by 3 and 4 together
+        {2, 512, 1024},  // partly covered, kept
+        {3, 0, 600},
+        {4, 600, 600},
+        {5, 4096, 100},  // covered by 6
+        {6, 4000, 200},
+    };
+    S3ChunkInfoList list;
+    for (const auto &info : infos) {
+        S3ChunkInfo *tmp = list.add_s3chunks();
+        tmp->set_chunkid(info[0]);
+        tmp->set_compaction(0);
+        tmp->set_offset(info[1]);
+        tmp->set_len(info[2]);
+        tmp->set_size(info[2]);
+        tmp->set_zero(false);
+    }
+
+    ASSERT_EQ(2, CompactS3ChunkInfoList(&list));
+    std::vector<uint64_t> chunkIds;
+    for (const auto &info : list.s3chunks()) {
+        chunkIds.push_back(info.chunkid());
+    }
+    ASSERT_EQ(std::vector<uint64_t>({2, 3, 4, 6}), chunkIds);
+    ASSERT_EQ(0, CompactS3ChunkInfoList(&list));
+}
+
 TEST_F(TestInodeWrapper, testSyncSuccess) {
     inodeWrapper_->MarkDirty();
     inodeWrapper_->SetLength(1024);
@@ -346,6 +346,56 @@ TEST_F(TestInodeCacheManager, CreateAndGetInode) {
     */
 }
 
+TEST_F(TestInodeCacheManager, CreateInodeWithDentry) {
+    uint64_t inodeId = 100;
+
+    InodeParam param;
+    param.fsId = fsId_;
+    param.type = FsFileType::TYPE_FILE;
+    param.parent = 1;
+
+    Dentry dentry;
+    dentry.set_fsid(fsId_);
+    dentry.set_parentinodeid(1);
+    dentry.set_name("file");
+
+    Inode inode;
+    inode.set_inodeid(inodeId);
+    inode.set_fsid(fsId_);
+    inode.set_type(FsFileType::TYPE_FILE);
+
+    // 1. create failed
+    EXPECT_CALL(*metaClient_, CreateInodeWithDentry(_, _, _, _))
+        .WillOnce(Return(MetaStatusCode::UNKNOWN_ERROR));
+    std::shared_ptr<InodeWrapper> inodeWrapper;
+    bool dentryCreated = false;
+    CURVEFS_ERROR ret = iCacheManager_->CreateInodeWithDentry(
+        param, dentry, inodeWrapper, &dentryCreated);
+    ASSERT_EQ(CURVEFS_ERROR::UNKNOWN, ret);
+
+    // 2. inode and dentry created
+    EXPECT_CALL(*metaClient_, CreateInodeWithDentry(_, _, _, _))
+        .WillOnce(DoAll(SetArgPointee<2>(inode), SetArgPointee<3>(true),
+                        Return(MetaStatusCode::OK)));
+    ret = iCacheManager_->CreateInodeWithDentry(param, dentry, inodeWrapper,
+                                                &dentryCreated);
+    ASSERT_EQ(CURVEFS_ERROR::OK, ret);
+    ASSERT_TRUE(dentryCreated);
+    ASSERT_EQ(inodeId, inodeWrapper->GetInodeId());
+
+    // 3. partition of parent is full, create the inode only
+    EXPECT_CALL(*metaClient_, CreateInodeWithDentry(_, _, _, _))
+        .WillOnce(DoAll(SetArgPointee<3>(true),
+                        Return(MetaStatusCode::PARTITION_ALLOC_ID_FAIL)));
+    EXPECT_CALL(*metaClient_, CreateInode(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(inode), Return(MetaStatusCode::OK)));
+    ret = iCacheManager_->CreateInodeWithDentry(param, dentry, inodeWrapper,
+                                                &dentryCreated);
+    ASSERT_EQ(CURVEFS_ERROR::OK, ret);
+    ASSERT_FALSE(dentryCreated);
+    ASSERT_EQ(inodeId, inodeWrapper->GetInodeId());
+}
+
 TEST_F(TestInodeCacheManager, DeleteInode) {
     uint64_t inodeId = 100;
 
@@ -0,0 +1,113 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "curvefs/src/client/s3/upload_limiter.h"
+
+namespace curvefs {
+namespace client {
+
+namespace {
+constexpr uint64_t kObjectBytes = 4ull * 1024 * 1024;
+constexpr uint64_t kLatencyUs = 40000;
+}  // namespace
+
+TEST(UploadLimiterTest, SlowStartUntilMax) {
+    UploadLimiter limiter(2, 16, 2.0);
+    ASSERT_EQ(2, limiter.GetConcurrency());
+
+    for (int i = 0; i < 100; ++i) {
+        limiter.Acquire();
+        limiter.OnComplete(kObjectBytes, kLatencyUs);
+    }
+    ASSERT_EQ(16, limiter.GetConcurrency());
+    ASSERT_EQ(0, limiter.GetInflight());
+}
+
+TEST(UploadLimiterTest, DecreaseWhenLatencyGoesUp) {
+    UploadLimiter limiter(2, 16, 2.0);
+    for (int i = 0; i < 100; ++i) {
+        limiter.Acquire();
+        limiter.OnComplete(kObjectBytes, kLatencyUs);
+    }
+    ASSERT_EQ(16, limiter.GetConcurrency());
+
+    // s3 is saturated, every upload takes much longer
+    for (int i = 0; i < 200; ++i) {
+        limiter.Acquire();
+        limiter.OnComplete(kObjectBytes, 10 * kLatencyUs);
+    }
+    ASSERT_LT(limiter.GetConcurrency(), 16);
+    ASSERT_GE(limiter.GetConcurrency(), 2);
+}
+
+TEST(UploadLimiterTest, SmallObjectsAreNotCongestion) {
+    UploadLimiter limiter(2, 16, 2.0);
+    for (int i = 0; i < 100; ++i) {
+        limiter.Acquire();
+        limiter.OnComplete(kObjectBytes, kLatencyUs);
+    }
+    // the latency of small objects counts as 1MiB
+    for (int i = 0; i < 100; ++i) {
+        limiter.Acquire();
+        limiter.OnComplete(64 * 1024, kLatencyUs / 4);
+    }
+    ASSERT_EQ(16, limiter.GetConcurrency());
+}
+
+TEST(UploadLimiterTest, HalveOnError) {
+    UploadLimiter limiter(2, 16, 2.0);
+    for (int i = 0; i < 100; ++i) {
+        limiter.Acquire();
+        limiter.OnComplete(kObjectBytes, kLatencyUs);
+    }
+    ASSERT_EQ(16, limiter.GetConcurrency());
+
+    limiter.Acquire();
+    limiter.OnError();
+    ASSERT_EQ(8, limiter.GetConcurrency());
+    // the failed upload keeps its slot until it succeeds
+    ASSERT_EQ(1, limiter.GetInflight());
+    limiter.OnComplete(kObjectBytes, kLatencyUs);
+    ASSERT_EQ(0, limiter.GetInflight());
+}
+
+TEST(UploadLimiterTest, AcquireWaitForFreeSlot) {
+    UploadLimiter limiter(1, 1, 2.0);
+    limiter.Acquire();
+
+    std::atomic<bool> acquired(false);
+    std::thread t([&]() {
+        limiter.Acquire();
+        acquired.store(true);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_FALSE(acquired.load());
+
+    limiter.OnComplete(kObjectBytes, kLatencyUs);
+    t.join();
+    ASSERT_TRUE(acquired.load());
+    ASSERT_EQ(1, limiter.GetInflight());
+}
+
+}  // namespace client
+}  // namespace curvefs
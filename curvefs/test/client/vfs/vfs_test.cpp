@@ -22,8 +22,10 @@
 
 #include <gtest/gtest.h>
 
+#include <future>
 #include <vector>
 #include <string>
+#include <utility>
 
 #include "curvefs/src/client/vfs/handlers.h"
 #include "curvefs/test/client/vfs/helper/helper.h"
@@ -267,6 +269,75 @@ TEST_F(VFSTest, Write) {
     TEST_READ("/f1", 1 * KiB, "0123456789");
 }
 
+TEST_F(VFSTest, PRead) {
+    auto vfs = VFSBuilder().Build();
+
+    uint64_t fd;
+    size_t nread;
+    char buffer[16];
+    BAD_FD(vfs->PRead(100, buffer, sizeof(buffer), 0, &nread));
+
+    OK(vfs->Create("/f1", 0644));
+    TEST_WRITE("/f1", "abcde");
+
+    OK(vfs->Open("/f1", 0644, O_RDWR, &fd));
+    OK(vfs->PRead(fd, buffer, 2, 1, &nread));
+    ASSERT_EQ(std::string(buffer, nread), "bc");
+    OK(vfs->PRead(fd, buffer, sizeof(buffer), 3, &nread));
+    ASSERT_EQ(std::string(buffer, nread), "de");
+
+    // the file offset is unchanged
+    OK(vfs->Read(fd, buffer, sizeof(buffer), &nread));
+    ASSERT_EQ(std::string(buffer, nread), "abcde");
+}
+
+TEST_F(VFSTest, PWrite) {
+    auto vfs = VFSBuilder().Build();
+
+    uint64_t fd;
+    size_t nwritten;
+    BAD_FD(vfs->PWrite(100, "x", 1, 0, &nwritten));
+
+    OK(vfs->Create("/f1", 0644));
+    TEST_WRITE("/f1", "abcde");
+
+    OK(vfs->Open("/f1", 0644, O_RDWR, &fd));
+    OK(vfs->PWrite(fd, "xx", 2, 3, &nwritten));
+    ASSERT_EQ(nwritten, 2);
+
+    // the file offset is unchanged
+    OK(vfs->Write(fd, "y", 1, &nwritten));
+    TEST_READ("/f1", 1 * KiB, "ybcxx");
+}
+
+TEST_F(VFSTest, AsyncReadWrite) {
+    auto vfs = VFSBuilder().Build();
+
+    auto wait = [](std::promise<std::pair<CURVEFS_ERROR, size_t>>* promise) {
+        return [promise](CURVEFS_ERROR rc, size_t nbytes) {
+            promise->set_value(std::make_pair(rc, nbytes));
+        };
+    };
+
+    uint64_t fd;
+    char buffer[16];
+    std::promise<std::pair<CURVEFS_ERROR, size_t>> p1, p2;
+    BAD_FD(vfs->AsyncRead(100, buffer, sizeof(buffer), 0, wait(&p1)));
+
+    OK(vfs->Create("/f1", 0644));
+    OK(vfs->Open("/f1", 0644, O_RDWR, &fd));
+
+    OK(vfs->AsyncWrite(fd, "abcde", 5, 0, wait(&p1)));
+    auto result = p1.get_future().get();
+    OK(result.first);
+    ASSERT_EQ(result.second, 5);
+
+    OK(vfs->AsyncRead(fd, buffer, sizeof(buffer), 1, wait(&p2)));
+    result = p2.get_future().get();
+    OK(result.first);
+    ASSERT_EQ(std::string(buffer, result.second), "bcde");
+}
+
 TEST_F(VFSTest, FSync) {
     auto vfs = VFSBuilder().Build();
 
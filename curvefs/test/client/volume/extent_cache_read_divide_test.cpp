@@ -454,5 +454,38 @@ TEST(ExtentCacheReadDivideTest, DivideCase8_UnWritten) {
     ASSERT_EQ(data.get() + 4 * kKiB, holes[1].data);
 }
 
+// read          |--------|
+// slices    |---------|---------|
+// extents         |---|---|
+TEST(ExtentCacheReadDivideTest, DivideAcrossSlices) {
+    ExtentCache cache;
+
+    // the extents are in different slices, but contiguous on block device
+    const uint64_t sliceEnd = 3 * kGiB;
+    PExtent pext;
+    pext.len = 4 * kKiB;
+    pext.UnWritten = false;
+    pext.pOffset = 4 * kMiB;
+    cache.Merge(sliceEnd - 4 * kKiB, pext);
+
+    pext.pOffset = 4 * kMiB + 4 * kKiB;
+    cache.Merge(sliceEnd, pext);
+
+    off_t offset = sliceEnd - 4 * kKiB;
+    size_t length = 8 * kKiB;
+    std::unique_ptr<char[]> data(new char[length]);
+
+    std::vector<ReadPart> reads;
+    std::vector<ReadPart> holes;
+    cache.DivideForRead(offset, length, data.get(), &reads, &holes);
+
+    ASSERT_TRUE(holes.empty());
+    ASSERT_EQ(1, reads.size());
+
+    ASSERT_EQ(4 * kMiB, reads[0].offset);
+    ASSERT_EQ(8 * kKiB, reads[0].length);
+    ASSERT_EQ(data.get(), reads[0].data);
+}
+
 }  // namespace client
 }  // namespace curvefs
@@ -0,0 +1,136 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "curvefs/src/client/xattr_manager.h"
+#include "curvefs/test/client/mock_dentry_cache_mamager.h"
+#include "curvefs/test/client/mock_inode_cache_manager.h"
+
+namespace curvefs {
+namespace client {
+
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::Return;
+using ::testing::SetArgReferee;
+
+class XattrManagerTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        inodeManager_ = std::make_shared<MockInodeCacheManager>();
+        dentryManager_ = std::make_shared<MockDentryCacheManager>();
+        xattrManager_ = std::make_shared<XattrManager>(
+            inodeManager_, dentryManager_, 100, 2, 10);
+    }
+
+    void TearDown() override {
+        xattrManager_->Stop();
+    }
+
+    std::shared_ptr<InodeWrapper> MakeDir(uint64_t inodeId, uint64_t parent,
+                                          bool keepSummary) {
+        Inode inode;
+        inode.set_inodeid(inodeId);
+        inode.set_fsid(1);
+        inode.set_type(FsFileType::TYPE_DIRECTORY);
+        inode.set_length(4096);
+        inode.add_parent(parent);
+        inode.mutable_xattr()->insert({XATTR_DIR_FILES, "0"});
+        inode.mutable_xattr()->insert({XATTR_DIR_SUBDIRS, "0"});
+        inode.mutable_xattr()->insert({XATTR_DIR_ENTRIES, "0"});
+        inode.mutable_xattr()->insert({XATTR_DIR_FBYTES, "0"});
+        if (keepSummary) {
+            inode.mutable_xattr()->insert({XATTR_DIR_RSUM_FILES, "0"});
+            inode.mutable_xattr()->insert({XATTR_DIR_RSUM_SUBDIRS, "0"});
+            inode.mutable_xattr()->insert({XATTR_DIR_RSUM_ENTRIES, "0"});
+            inode.mutable_xattr()->insert({XATTR_DIR_RSUM_FBYTES, "0"});
+        }
+        return std::make_shared<InodeWrapper>(inode, nullptr);
+    }
+
+    static std::string XAttrOf(const std::shared_ptr<InodeWrapper> &inode,
+                               const std::string &key) {
+        InodeAttr attr;
+        inode->GetInodeAttr(&attr);
+        auto it = attr.xattr().find(key);
+        return it == attr.xattr().end() ? "" : it->second;
+    }
+
+ protected:
+    std::shared_ptr<MockInodeCacheManager> inodeManager_;
+    std::shared_ptr<MockDentryCacheManager> dentryManager_;
+    std::shared_ptr<XattrManager> xattrManager_;
+};
+
+TEST_F(XattrManagerTest, PropagateSummaryToAncestors) {
+    // root(1) <- 10 <- 100, dir 10 is created before and keeps no summary
+    auto root = MakeDir(ROOTINODEID, 0, true);
+    auto middle = MakeDir(10, ROOTINODEID, false);
+    auto leaf = MakeDir(100, 10, true);
+    EXPECT_CALL(*inodeManager_, GetInode(ROOTINODEID, _))
+        .WillRepeatedly(DoAll(SetArgReferee<1>(root),
+                              Return(CURVEFS_ERROR::OK)));
+    EXPECT_CALL(*inodeManager_, GetInode(10, _))
+        .WillRepeatedly(DoAll(SetArgReferee<1>(middle),
+                              Return(CURVEFS_ERROR::OK)));
+    EXPECT_CALL(*inodeManager_, GetInode(100, _))
+        .WillRepeatedly(DoAll(SetArgReferee<1>(leaf),
+                              Return(CURVEFS_ERROR::OK)));
+    EXPECT_CALL(*inodeManager_, ShipToFlush(_)).WillRepeatedly(Return());
+
+    // create two files of 1024 bytes in leaf
+    XAttr xattr;
+    xattr.mutable_xattrinfos()->insert({XATTR_DIR_ENTRIES, "1"});
+    xattr.mutable_xattrinfos()->insert({XATTR_DIR_FILES, "1"});
+    xattr.mutable_xattrinfos()->insert({XATTR_DIR_FBYTES, "1024"});
+    ASSERT_EQ(CURVEFS_ERROR::OK,
+              xattrManager_->UpdateParentInodeXattr(100, xattr, true));
+    ASSERT_EQ(CURVEFS_ERROR::OK,
+              xattrManager_->UpdateParentInodeXattr(100, xattr, true));
+    ASSERT_EQ("2", XAttrOf(leaf, XATTR_DIR_FILES));
+
+    xattrManager_->Start();
+    for (int i = 0; i < 500 && XAttrOf(root, XATTR_DIR_RSUM_FILES) != "2";
+         i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ("2", XAttrOf(root, XATTR_DIR_RSUM_FILES));
+    ASSERT_EQ("2", XAttrOf(root, XATTR_DIR_RSUM_ENTRIES));
+    ASSERT_EQ("2048", XAttrOf(root, XATTR_DIR_RSUM_FBYTES));
+    ASSERT_EQ("2", XAttrOf(leaf, XATTR_DIR_RSUM_FILES));
+    ASSERT_EQ("", XAttrOf(middle, XATTR_DIR_RSUM_FILES));
+
+    // read from the kept summary without walking the subtree
+    InodeAttr attr;
+    root->GetInodeAttr(&attr);
+    std::string value;
+    ASSERT_EQ(CURVEFS_ERROR::OK,
+              xattrManager_->GetXattr(XATTR_DIR_RFBYTES, &value, &attr, true));
+    ASSERT_EQ("6144", value);
+    ASSERT_EQ(CURVEFS_ERROR::OK,
+              xattrManager_->GetXattr(XATTR_DIR_RFILES, &value, &attr, true));
+    ASSERT_EQ("2", value);
+}
+
+}  // namespace client
+}  // namespace curvefs
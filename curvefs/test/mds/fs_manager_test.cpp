@@ -25,6 +25,10 @@
 #include <gmock/gmock.h>
 #include <google/protobuf/util/message_differencer.h>
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
 #include "absl/memory/memory.h"
 #include "curvefs/src/mds/fs_manager.h"
 #include "curvefs/test/mds/mock/mock_cli2.h"
@@ -617,6 +621,34 @@ TEST_F(FSManagerTest, test_fail_repeated_mount_s3_fs) {
     ASSERT_EQ(ret, FSStatusCode::MOUNT_POINT_CONFLICT);
 }
 
+TEST_F(FSManagerTest, test_success_concurrent_mount_s3_fs) {
+    CreateS3Fs();
+    const int kMounts = 32;
+    std::vector<Mountpoint> mountpoints(kMounts, s3MountPoint);
+    std::vector<FSStatusCode> rets(kMounts);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kMounts; ++i) {
+        // the last one conflicts with the first one
+        mountpoints[i].set_path("/mnt/" + std::to_string(i % (kMounts - 1)));
+        threads.emplace_back([&, i]() {
+            FsInfo fsInfo;
+            rets[i] = fsManager_->MountFs(kFsName2, mountpoints[i], &fsInfo);
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    ASSERT_EQ(kMounts - 1, std::count(rets.begin(), rets.end(),
+                                      FSStatusCode::OK));
+    ASSERT_EQ(1, std::count(rets.begin(), rets.end(),
+                            FSStatusCode::MOUNT_POINT_CONFLICT));
+
+    FsInfo fsInfo;
+    ASSERT_EQ(FSStatusCode::OK, fsManager_->GetFsInfo(kFsName2, &fsInfo));
+    ASSERT_EQ(kMounts - 1, fsInfo.mountpoints_size());
+}
+
 TEST_F(FSManagerTest, test_fail_delete_s3_fs_with_existing_mount_path) {
     CreateS3Fs();
     FSStatusCode ret;
@@ -637,6 +669,47 @@ TEST_F(FSManagerTest, test_success_umount_s3_fs_with_mount_path) {
     ASSERT_EQ(ret, FSStatusCode::OK);
 }
 
+TEST_F(FSManagerTest, test_exclusive_lease_grant_recall_release) {
+    CreateS3Fs();
+    FsInfo fsInfo;
+    ASSERT_EQ(FSStatusCode::OK,
+              fsManager_->MountFs(kFsName2, s3MountPoint, &fsInfo));
+
+    auto refresh = [&](const Mountpoint& mountpoint, bool hold) {
+        RefreshSessionRequest request;
+        RefreshSessionResponse response;
+        request.set_fsname(kFsName2);
+        *request.mutable_mountpoint() = mountpoint;
+        request.set_wantexclusive(true);
+        request.set_holdexclusive(hold);
+        fsManager_->RefreshSession(&request, &response);
+        return response.exclusive();
+    };
+
+    // granted to the only mountpoint
+    ASSERT_TRUE(refresh(s3MountPoint, false));
+    ASSERT_TRUE(refresh(s3MountPoint, true));
+
+    // another mountpoint recalls the lease
+    Mountpoint other = s3MountPoint;
+    other.set_path("/a/b/d");
+    ASSERT_EQ(FSStatusCode::EXCLUSIVE_LEASE_RECALLING,
+              fsManager_->MountFs(kFsName2, other, &fsInfo));
+    ASSERT_FALSE(refresh(s3MountPoint, true));
+    ASSERT_EQ(FSStatusCode::EXCLUSIVE_LEASE_RECALLING,
+              fsManager_->MountFs(kFsName2, other, &fsInfo));
+
+    // the holder released the lease
+    ASSERT_FALSE(refresh(s3MountPoint, false));
+    ASSERT_EQ(FSStatusCode::OK, fsManager_->MountFs(kFsName2, other, &fsInfo));
+    ASSERT_FALSE(refresh(s3MountPoint, false));
+    ASSERT_FALSE(refresh(other, false));
+
+    // granted again after the other one umount
+    ASSERT_EQ(FSStatusCode::OK, fsManager_->UmountFs(kFsName2, other));
+    ASSERT_TRUE(refresh(s3MountPoint, false));
+}
+
 TEST_F(FSManagerTest, test_success_delete_s3_fs_without_mount_path) {
     CreateS3Fs();
     FSStatusCode ret;
@@ -925,6 +925,78 @@ TEST_F(TestHeartbeatManager, test_update_partition) {
     ASSERT_EQ(HeartbeatStatusCode::hbOK, response.statuscode());
 }
 
+TEST_F(TestHeartbeatManager, test_update_partition_only_changed) {
+    HeartbeatOption option;
+    option.heartbeatIntervalMs = 1000;
+    option.heartbeatMissTimeOutMs = 10000;
+    option.offLineTimeOutMs = 30000;
+    option.partitionFullSyncIntervalMs = 3600 * 1000;
+    heartbeatManager_ = std::make_shared<HeartbeatManager>(
+        option, topology_, coordinator_, spaceManager_);
+
+    auto request = GetMetaServerHeartbeatRequestForTest();
+    auto info = request.mutable_copysetinfos(0);
+    auto partitioninfo = info->add_partitioninfolist();
+    partitioninfo->set_fsid(1);
+    partitioninfo->set_poolid(1);
+    partitioninfo->set_copysetid(1);
+    partitioninfo->set_partitionid(1);
+    partitioninfo->set_start(1);
+    partitioninfo->set_end(1);
+    partitioninfo->set_txid(1);
+    partitioninfo->set_status(PartitionStatus::READWRITE);
+    partitioninfo->set_inodenum(1);
+
+    ::curvefs::mds::topology::MetaServer metaServer1(
+        1, "hostname", "hello", 1, "192.168.10.1", 9000, "", 9000);
+    ::curvefs::mds::topology::MetaServer metaServer2(
+        2, "hostname", "hello", 1, "192.168.10.2", 9000, "", 9000);
+    ::curvefs::mds::topology::MetaServer metaServer3(
+        3, "hostname", "hello", 1, "192.168.10.3", 9000, "", 9000);
+    EXPECT_CALL(*topology_, GetMetaServer(1, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(metaServer1), Return(true)));
+    EXPECT_CALL(*topology_, GetMetaServer("192.168.10.1", _, _))
+        .WillRepeatedly(DoAll(SetArgPointee<2>(metaServer1), Return(true)));
+    EXPECT_CALL(*topology_, GetMetaServer("192.168.10.2", _, _))
+        .WillRepeatedly(DoAll(SetArgPointee<2>(metaServer2), Return(true)));
+    EXPECT_CALL(*topology_, GetMetaServer("192.168.10.3", _, _))
+        .WillRepeatedly(DoAll(SetArgPointee<2>(metaServer3), Return(true)));
+    ::curvefs::mds::topology::CopySetInfo recordCopySetInfo(1, 1);
+    recordCopySetInfo.SetEpoch(10);
+    recordCopySetInfo.SetLeader(1);
+    recordCopySetInfo.SetCopySetMembers({1, 2, 3});
+    EXPECT_CALL(*topology_, GetCopySet(_, _))
+        .WillRepeatedly(
+            DoAll(SetArgPointee<1>(recordCopySetInfo), Return(true)));
+
+    std::list<::curvefs::mds::topology::Partition> topoPartitionList;
+    ::curvefs::mds::topology::Partition partitionInTopo;
+    partitionInTopo.SetPartitionId(1);
+    topoPartitionList.push_back(partitionInTopo);
+    // the same report is applied to topology only once
+    EXPECT_CALL(*topology_, GetPartitionInfosInCopyset(_))
+        .Times(2)
+        .WillRepeatedly(Return(topoPartitionList));
+    EXPECT_CALL(*topology_, GetPartition(_, _))
+        .Times(2)
+        .WillRepeatedly(
+            DoAll(SetArgPointee<1>(partitionInTopo), Return(true)));
+    EXPECT_CALL(*topology_, UpdatePartitionStatistic(_, _))
+        .Times(2)
+        .WillRepeatedly(Return(TopoStatusCode::TOPO_OK));
+
+    MetaServerHeartbeatResponse response;
+    heartbeatManager_->MetaServerHeartbeat(request, &response);
+    ASSERT_EQ(HeartbeatStatusCode::hbOK, response.statuscode());
+    heartbeatManager_->MetaServerHeartbeat(request, &response);
+    ASSERT_EQ(HeartbeatStatusCode::hbOK, response.statuscode());
+
+    // the report changed
+    partitioninfo->set_inodenum(2);
+    heartbeatManager_->MetaServerHeartbeat(request, &response);
+    ASSERT_EQ(HeartbeatStatusCode::hbOK, response.statuscode());
+}
+
 TEST_F(TestHeartbeatManager, TEST_UpdateDeallocatableBlockGroup) {
     auto request = GetMetaServerHeartbeatRequestForTest();
     MetaServerHeartbeatResponse response;
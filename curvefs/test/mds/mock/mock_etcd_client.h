@@ -49,6 +49,8 @@ class MockEtcdClientImpl : public curve::kvstorage::KVStorageClient {
     MOCK_METHOD1(Delete, int(const std::string&));
     MOCK_METHOD2(DeleteRewithRevision, int(const std::string&, int64_t*));
     MOCK_METHOD1(TxnN, int(const std::vector<Operation>&));
+    MOCK_METHOD2(TxnNWithRevision, int(const std::vector<Operation>&,
+        int64_t*));
     MOCK_METHOD3(CompareAndSwap, int(const std::string&, const std::string&,
                                      const std::string&));
     MOCK_METHOD1(GetCurrentRevision, int(int64_t*));
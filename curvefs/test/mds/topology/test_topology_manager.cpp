@@ -1632,6 +1632,63 @@ TEST_F(TestTopologyManager, test_CreatePartitionWithAvailableCopyset_Success) {
     ASSERT_EQ(1, info.GetPartitionNum());
 }
 
+TEST_F(TestTopologyManager, test_CreatePartitionOnLeastLoadedCopyset) {
+    PoolIdType poolId = 0x11;
+    CopySetIdType busyCopysetId = 0x51;
+    CopySetIdType idleCopysetId = 0x52;
+    PartitionIdType partitionId = 0x61;
+
+    PrepareAddPool(poolId);
+    PrepareAddZone(0x21, "zone1", poolId);
+    PrepareAddZone(0x22, "zone2", poolId);
+    PrepareAddZone(0x23, "zone3", poolId);
+    PrepareAddServer(0x31, "server1", "127.0.0.1", 0, "127.0.0.1", 0, 0x21,
+                     0x11);
+    PrepareAddServer(0x32, "server2", "127.0.0.1", 0, "127.0.0.1", 0, 0x22,
+                     0x11);
+    PrepareAddServer(0x33, "server3", "127.0.0.1", 0, "127.0.0.1", 0, 0x23,
+                     0x11);
+    PrepareAddMetaServer(0x41, "ms1", "token1", 0x31, "127.0.0.1", 7777, "ip2",
+                         8888);
+    PrepareAddMetaServer(0x42, "ms2", "token2", 0x32, "127.0.0.1", 7777, "ip2",
+                         8888);
+    PrepareAddMetaServer(0x43, "ms3", "token3", 0x33, "127.0.0.1", 7777, "ip2",
+                         8888);
+
+    std::set<MetaServerIdType> replicas;
+    replicas.insert(0x41);
+    replicas.insert(0x42);
+    replicas.insert(0x43);
+    PrepareAddCopySet(busyCopysetId, poolId, replicas);
+    PrepareAddCopySet(idleCopysetId, poolId, replicas);
+
+    // the busy copyset has less partitions but much more inodes
+    Partition busy(0x01, poolId, busyCopysetId, 0x71, 1, 100);
+    busy.SetInodeNum(1000);
+    EXPECT_CALL(*storage_, StoragePartition(_)).WillOnce(Return(true));
+    EXPECT_CALL(*storage_, StorageClusterInfo(_)).WillOnce(Return(true));
+    ASSERT_EQ(TopoStatusCode::TOPO_OK, topology_->AddPartition(busy));
+    PrepareAddPartition(0x01, poolId, idleCopysetId, 0x72, 101, 200);
+    PrepareAddPartition(0x01, poolId, idleCopysetId, 0x73, 201, 300);
+
+    EXPECT_CALL(*idGenerator_, GenPartitionId()).WillOnce(Return(partitionId));
+    EXPECT_CALL(*storage_, StoragePartition(_))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*storage_, StorageClusterInfo(_))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*mockMetaserverClient_, CreatePartition(_, _, _, _, _, _, _))
+        .WillOnce(Return(FSStatusCode::OK));
+
+    CreatePartitionRequest request;
+    CreatePartitionResponse response;
+    request.set_fsid(0x01);
+    request.set_count(1);
+    serviceManager_->CreatePartitions(&request, &response);
+    ASSERT_EQ(TopoStatusCode::TOPO_OK, response.statuscode());
+    ASSERT_EQ(1, response.partitioninfolist().size());
+    ASSERT_EQ(idleCopysetId, response.partitioninfolist(0).copysetid());
+}
+
 TEST_F(TestTopologyManager, test_CreatePartitionAfterChangeInodeRange_Success) {
     PoolIdType poolId = 0x11;
     CopySetIdType copysetId = 0x51;
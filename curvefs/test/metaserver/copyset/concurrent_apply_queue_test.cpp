@@ -25,6 +25,8 @@
 #include <vector>
 #include <atomic>
 #include <functional>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
 
 #include "src/common/timeutility.h"
 #include "curvefs/src/metaserver/copyset/concurrent_apply_queue.h"
@@ -221,3 +223,60 @@ TEST(ApplyQueue, ConcurrentTest) {
     concurrentapply.Stop();
 }
 
+
+TEST(ApplyQueue, WriteOrderTest) {
+    std::vector<OperatorType> readTypeList;
+    std::vector<OperatorType> writeTypeList;
+    InitReadWriteTypeList(&readTypeList, &writeTypeList);
+
+    ApplyQueue concurrentapply;
+    ApplyOption opt(4, 100, 1, 1);
+    ASSERT_TRUE(concurrentapply.Init(opt));
+
+    // 1. tasks of the same key are applied in push order
+    std::mutex mtx;
+    std::vector<int> applied;
+    std::atomic<int> running(0);
+    std::atomic<bool> overlapped(false);
+    for (int i = 0; i < 200; i++) {
+        auto task = [&, i]() {
+            if (running.fetch_add(1) != 0) {
+                overlapped.store(true);
+            }
+            {
+                std::lock_guard<std::mutex> lk(mtx);
+                applied.push_back(i);
+            }
+            running.fetch_sub(1);
+        };
+        concurrentapply.Push(1, get_random_type(writeTypeList), task);
+    }
+    concurrentapply.Flush();
+    ASSERT_FALSE(overlapped.load());
+    ASSERT_EQ(200, applied.size());
+    for (int i = 0; i < 200; i++) {
+        ASSERT_EQ(i, applied[i]);
+    }
+
+    // 2. a slow key don't block other keys, even with the same hash
+    std::atomic<bool> slowDone(false);
+    std::atomic<uint32_t> fastnum(0);
+    auto slow = [&slowDone]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        slowDone.store(true);
+    };
+    auto fast = [&fastnum]() {
+        fastnum.fetch_add(1);
+    };
+    concurrentapply.Push(0, get_random_type(writeTypeList), slow);
+    for (int i = 1; i <= 10; i++) {
+        concurrentapply.Push(i * 4, get_random_type(writeTypeList), fast);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    ASSERT_EQ(10, fastnum.load());
+    ASSERT_FALSE(slowDone.load());
+    concurrentapply.Flush();
+    ASSERT_TRUE(slowDone.load());
+
+    concurrentapply.Stop();
+}
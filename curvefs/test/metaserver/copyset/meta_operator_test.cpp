@@ -23,6 +23,7 @@
 #include "curvefs/src/metaserver/copyset/meta_operator.h"
 
 #include <brpc/server.h>
+#include <gflags/gflags.h>
 #include <gtest/gtest.h>
 
 #include <condition_variable>
@@ -37,6 +38,8 @@
 #include "src/common/timeutility.h"
 #include "test/fs/mock_local_filesystem.h"
 
+DECLARE_uint64(partition_max_inode_num);
+
 namespace curvefs {
 namespace metaserver {
 namespace copyset {
@@ -419,6 +422,31 @@ TEST_F(MetaOperatorTest, PropostTest_IsNotLeader) {
     EXPECT_FALSE(response.has_appliedindex());
 }
 
+TEST_F(MetaOperatorTest, PropostTest_PartitionInodeNumExceeded) {
+    PoolId poolId = 100;
+    CopysetId copysetId = 100;
+    braft::Configuration conf;
+
+    CopysetNode node(poolId, copysetId, conf, &mockNodeManager_);
+    mock::MockMetaStore* mockMetaStore = new mock::MockMetaStore();
+    node.SetMetaStore(mockMetaStore);
+    ON_CALL(*mockMetaStore, Clear()).WillByDefault(Return(true));
+    node.on_leader_start(1);
+
+    FLAGS_partition_max_inode_num = 100;
+    EXPECT_CALL(*mockMetaStore, GetPartitionInodeNum(1, _))
+        .WillOnce(DoAll(SetArgPointee<1>(100), Return(true)));
+
+    CreateInodeRequest request;
+    request.set_partitionid(1);
+    CreateInodeResponse response;
+    auto op = absl::make_unique<CreateInodeOperator>(&node, nullptr, &request,
+                                                     &response, nullptr);
+    op->Propose();
+    EXPECT_EQ(MetaStatusCode::PARTITION_ALLOC_ID_FAIL, response.statuscode());
+    FLAGS_partition_max_inode_num = 0;
+}
+
 TEST_F(MetaOperatorTest, PropostTest_RequestCanBypassProcess) {
     curve::fs::MockLocalFileSystem localFs;
 
@@ -472,6 +500,60 @@ TEST_F(MetaOperatorTest, PropostTest_RequestCanBypassProcess) {
     node.Stop();
 }
 
+TEST_F(MetaOperatorTest, PropostTest_RequestCanBypassProcessByApplyQueue) {
+    curve::fs::MockLocalFileSystem localFs;
+
+    PoolId poolId = 100;
+    CopysetId copysetId = 100;
+    braft::Configuration conf;
+
+    CopysetNode node(poolId, copysetId, conf, &mockNodeManager_);
+    CopysetNodeOptions options;
+    options.dataUri = "local:///mnt/data";
+    options.localFileSystem = &localFs;
+    options.storageOptions.type = "memory";
+    options.inlineLeaseRead = false;
+
+    EXPECT_CALL(localFs, Mkdir(_)).WillOnce(Return(0));
+
+    EXPECT_TRUE(node.Init(options));
+    auto* mockMetaStore = new mock::MockMetaStore();
+    node.SetMetaStore(mockMetaStore);
+    auto* mockRaftNode = new MockRaftNode();
+    node.SetRaftNode(mockRaftNode);
+
+    ON_CALL(*mockMetaStore, Clear()).WillByDefault(Return(true));
+    EXPECT_CALL(*mockRaftNode, apply(_)).Times(0);
+    EXPECT_CALL(*mockRaftNode, shutdown(_)).Times(AtLeast(1));
+    EXPECT_CALL(*mockRaftNode, join()).Times(AtLeast(1));
+    EXPECT_CALL(*mockMetaStore, GetDentry(_, _, _))
+        .WillOnce(Return(MetaStatusCode::OK));
+
+    braft::LeaderLeaseStatus status;
+    status.state = braft::LEASE_VALID;
+    status.term = 1;
+    EXPECT_CALL(*mockRaftNode, get_leader_lease_status(_))
+        .WillOnce(SetArgPointee<0>(status));
+
+    node.on_leader_start(1);
+    node.UpdateAppliedIndex(101);
+
+    GetDentryRequest request;
+    request.set_appliedindex(100);
+    GetDentryResponse response;
+    auto op = absl::make_unique<GetDentryOperator>(&node, nullptr, &request,
+                                                   &response, nullptr);
+    op->Propose();
+    op.release();
+
+    node.FlushApplyQueue();
+
+    EXPECT_TRUE(response.has_appliedindex());
+    EXPECT_EQ(101, response.appliedindex());
+
+    node.Stop();
+}
+
 TEST_F(MetaOperatorTest, PropostTest_IsNotLeaseLeader) {
     PoolId poolId = 100;
     CopysetId copysetId = 100;
@@ -296,6 +296,79 @@ TEST_F(InodeStorageTest, testGetAttr) {
     ASSERT_EQ(attr.mode(), 777);
 }
 
+TEST_F(InodeStorageTest, testGetAttrAfterUpdateAndDelete) {
+    InodeStorage storage(kvStorage_, nameGenerator_, 0);
+    ASSERT_TRUE(storage.Init());
+    Inode inode;
+    inode.set_fsid(1);
+    inode.set_inodeid(1);
+    inode.set_length(1);
+    inode.set_ctime(100);
+    inode.set_ctime_ns(100);
+    inode.set_mtime(100);
+    inode.set_mtime_ns(100);
+    inode.set_atime(100);
+    inode.set_atime_ns(100);
+    inode.set_uid(0);
+    inode.set_gid(0);
+    inode.set_mode(777);
+    inode.set_nlink(1);
+    inode.set_type(FsFileType::TYPE_FILE);
+
+    // the attribute is cached by the first getattr
+    ASSERT_EQ(storage.Insert(inode, logIndex_++), MetaStatusCode::OK);
+    InodeAttr attr;
+    ASSERT_EQ(storage.GetAttr(Key4Inode(1, 1), &attr), MetaStatusCode::OK);
+    ASSERT_EQ(attr.length(), 1);
+
+    // update
+    inode.set_length(4096);
+    inode.set_mtime(200);
+    ASSERT_EQ(storage.Update(inode, logIndex_++), MetaStatusCode::OK);
+    ASSERT_EQ(storage.GetAttr(Key4Inode(1, 1), &attr), MetaStatusCode::OK);
+    ASSERT_EQ(attr.length(), 4096);
+    ASSERT_EQ(attr.mtime(), 200);
+
+    // delete
+    ASSERT_EQ(storage.Delete(Key4Inode(1, 1), logIndex_++),
+              MetaStatusCode::OK);
+    ASSERT_EQ(storage.GetAttr(Key4Inode(1, 1), &attr),
+              MetaStatusCode::NOT_FOUND);
+}
+
+TEST_F(InodeStorageTest, testBatchGetAttr) {
+    InodeStorage storage(kvStorage_, nameGenerator_, 0);
+    ASSERT_TRUE(storage.Init());
+    for (uint64_t inodeId = 1; inodeId <= 3; inodeId++) {
+        Inode inode = GenInode(1, inodeId);
+        ASSERT_EQ(storage.Insert(inode, logIndex_++), MetaStatusCode::OK);
+    }
+
+    // CASE 1: get attributes in the order of inode ids,
+    //         the inode 2 is got from the attribute cache
+    InodeAttr attr;
+    ASSERT_EQ(storage.GetAttr(Key4Inode(1, 2), &attr), MetaStatusCode::OK);
+    google::protobuf::RepeatedPtrField<InodeAttr> attrs;
+    ASSERT_EQ(storage.BatchGetAttr(1, {3, 2, 1}, &attrs), MetaStatusCode::OK);
+    ASSERT_EQ(attrs.size(), 3);
+    ASSERT_EQ(attrs[0].inodeid(), 3);
+    ASSERT_EQ(attrs[1].inodeid(), 2);
+    ASSERT_EQ(attrs[2].inodeid(), 1);
+
+    // CASE 2: some inode not found
+    attrs.Clear();
+    ASSERT_EQ(storage.BatchGetAttr(1, {1, 4}, &attrs),
+              MetaStatusCode::NOT_FOUND);
+
+    // CASE 3: get extended attributes
+    google::protobuf::RepeatedPtrField<XAttr> xattrs;
+    ASSERT_EQ(storage.BatchGetXAttr(1, {2, 1}, &xattrs), MetaStatusCode::OK);
+    ASSERT_EQ(xattrs.size(), 2);
+    ASSERT_EQ(xattrs[0].inodeid(), 2);
+    ASSERT_EQ(xattrs[1].inodeid(), 1);
+    ASSERT_EQ(xattrs[1].fsid(), 1);
+}
+
 TEST_F(InodeStorageTest, testGetXAttr) {
     InodeStorage storage(kvStorage_, nameGenerator_, 0);
     ASSERT_TRUE(storage.Init());
@@ -378,6 +378,16 @@ TEST_F(MetastoreTest, partition) {
     std::list<PartitionInfo> partitionList;
     ASSERT_TRUE(metastore.GetPartitionInfoList(&partitionList));
     ASSERT_EQ(partitionList.size(), 2);
+
+    // data of inodes is deleted by cleaner, drop inodes with partition
+    deletePartitionRequest.set_clearinodes(true);
+    ret = metastore.DeletePartition(&deletePartitionRequest,
+                                    &deletePartitionResponse, logIndex_++);
+    ASSERT_EQ(ret, MetaStatusCode::OK);
+    ASSERT_EQ(deletePartitionResponse.statuscode(), ret);
+    partitionList.clear();
+    ASSERT_TRUE(metastore.GetPartitionInfoList(&partitionList));
+    ASSERT_EQ(partitionList.size(), 1);
 }
 
 TEST_F(MetastoreTest, test_inode) {
@@ -56,6 +56,7 @@ class MockMetaStore : public curvefs::metaserver::MetaStore {
     MOCK_METHOD1(GetPartitionInfoList, bool(std::list<PartitionInfo>*));
     MOCK_METHOD1(GetPartitionSnap,
                  bool(std::map<uint32_t, std::shared_ptr<Partition>>*));
+    MOCK_METHOD2(GetPartitionInodeNum, bool(uint32_t, uint64_t*));
 
     MOCK_METHOD3(CreateDentry,
                  MetaStatusCode(const CreateDentryRequest*,
@@ -43,6 +43,9 @@ class MockS3Client : public S3Client {
     MOCK_METHOD1(Init, void(const curve::common::S3AdapterOption &options));
     MOCK_METHOD1(Delete, int(const std::string &name));
     MOCK_METHOD1(DeleteBatch, int(const std::list<std::string>& nameList));
+    MOCK_METHOD3(ReleasePackSlice,
+                 int(uint64_t fsId, uint32_t objectPrefix,
+                     const S3ChunkInfo& info));
     MOCK_METHOD4(Reinit, void(const std::string& ak, const std::string& sk,
                         const std::string& endpoint,
                         const std::string& bucketName));
@@ -167,24 +167,10 @@ TEST_F(PartitionCleanManagerTest, test1) {
         .WillOnce(Return(false))
         .WillRepeatedly(Return(true));
 
+    // inodes are deleted together with partition by one log entry
     EXPECT_CALL(*copyset_, Propose(_))
-        .WillOnce(Invoke([partition, fsId, this](const braft::Task& task) {
-            ASSERT_EQ(partition->DeleteInode(fsId, ROOTINODEID, logIndex_++),
-                      MetaStatusCode::OK);
-            LOG(INFO) << "Partition DeleteInode, fsId = " << fsId
-                      << ", inodeId = " << ROOTINODEID;
-            task.done->Run();
-        }))
-        .WillOnce(
-            Invoke([partition, fsId, inode1, this](const braft::Task& task) {
-                ASSERT_EQ(
-                    partition->DeleteInode(fsId, inode1.inodeid(), logIndex_++),
-                    MetaStatusCode::OK);
-                LOG(INFO) << "Partition DeleteInode, fsId = " << fsId
-                          << ", inodeId = " << inode1.inodeid();
-                task.done->Run();
-            }))
         .WillOnce(Invoke([partition](const braft::Task& task) {
+            ASSERT_TRUE(partition->Clear());
             LOG(INFO) << "Partition deletePartition";
             task.done->Run();
         }));
@@ -198,6 +184,7 @@ TEST_F(PartitionCleanManagerTest, test1) {
     sleep(4);
     manager->Fini();
     ASSERT_EQ(manager->GetCleanerCount(), 0);
+    ASSERT_TRUE(partition->EmptyInodeStorage());
 }
 
 TEST_F(PartitionCleanManagerTest, GetFsInfoFail) {
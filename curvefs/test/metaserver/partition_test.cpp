@@ -301,6 +301,68 @@ TEST_F(PartitionTest, dentrynum) {
     ASSERT_EQ(partition1.GetDentryNum(), 0);
 }
 
+TEST_F(PartitionTest, CreateInodeWithDentry) {
+    PartitionInfo partitionInfo1;
+    partitionInfo1.set_fsid(1);
+    partitionInfo1.set_poolid(2);
+    partitionInfo1.set_copysetid(3);
+    partitionInfo1.set_partitionid(4);
+    partitionInfo1.set_start(100);
+    partitionInfo1.set_end(199);
+
+    Partition partition1(partitionInfo1, kvStorage_);
+
+    ASSERT_TRUE(partition1.Init());
+
+    // create parent inode
+    Inode parent;
+    InodeParam param = param_;
+    param.type = FsFileType::TYPE_DIRECTORY;
+    ASSERT_EQ(partition1.CreateInode(param, &parent, logIndex_++),
+              MetaStatusCode::OK);
+    ASSERT_EQ(parent.inodeid(), 100);
+
+    Dentry dentry;
+    dentry.set_fsid(1);
+    dentry.set_parentinodeid(100);
+    dentry.set_name("name");
+    dentry.set_txid(0);
+    dentry.set_type(FsFileType::TYPE_FILE);
+    Time tm;
+    tm.set_sec(0);
+    tm.set_nsec(0);
+    param_.parent = 100;
+    Inode inode;
+    ASSERT_EQ(partition1.CreateInodeWithDentry(param_, dentry, tm, &inode,
+                                               logIndex_++),
+              MetaStatusCode::OK);
+    ASSERT_EQ(inode.inodeid(), 101);
+    ASSERT_EQ(partition1.GetInodeNum(), 2);
+    ASSERT_EQ(partition1.GetDentryNum(), 1);
+
+    Dentry out;
+    out.set_fsid(1);
+    out.set_parentinodeid(100);
+    out.set_name("name");
+    out.set_txid(0);
+    ASSERT_EQ(partition1.GetDentry(&out), MetaStatusCode::OK);
+    ASSERT_EQ(out.inodeid(), 101);
+
+    // the dentry exists, the new inode is removed
+    ASSERT_EQ(partition1.CreateInodeWithDentry(param_, dentry, tm, &inode,
+                                               logIndex_++),
+              MetaStatusCode::DENTRY_EXIST);
+    ASSERT_EQ(partition1.GetInodeNum(), 2);
+    ASSERT_EQ(partition1.GetDentryNum(), 1);
+
+    // the parent does not belong to the partition
+    dentry.set_parentinodeid(200);
+    ASSERT_EQ(partition1.CreateInodeWithDentry(param_, dentry, tm, &inode,
+                                               logIndex_++),
+              MetaStatusCode::PARTITION_ID_MISSMATCH);
+    ASSERT_EQ(partition1.GetInodeNum(), 2);
+}
+
 TEST_F(PartitionTest, PARTITION_ID_MISSMATCH_ERROR) {
     PartitionInfo partitionInfo1;
     partitionInfo1.set_fsid(1);
@@ -23,6 +23,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <memory>
+#include <vector>
 
 #include "curvefs/src/metaserver/s3compact_manager.h"
 #include "curvefs/src/metaserver/s3compact_worker.h"
@@ -268,6 +269,61 @@ TEST_F(S3CompactTest, test_GetNeedCompact) {
               opts_.maxChunksPerCompact);
 }
 
+TEST_F(S3CompactTest, test_GetNeedCompactOrder) {
+    ::google::protobuf::Map<uint64_t, S3ChunkInfoList> s3chunkinfoMap;
+    auto addChunks = [&](uint64_t index, int count) {
+        S3ChunkInfoList l;
+        for (int i = 0; i < count; i++) {
+            auto ref = l.add_s3chunks();
+            ref->set_chunkid(i);
+            ref->set_offset(index * 64 + i);
+            ref->set_len(1);
+        }
+        s3chunkinfoMap.insert({index, l});
+    };
+    addChunks(0, 25);
+    addChunks(1, 30);
+    addChunks(2, 5);
+    addChunks(3, 1);
+
+    // truncated chunk first, then chunks with more fragments
+    auto needCompact = impl_->GetNeedCompact(s3chunkinfoMap, 64 * 3, 64);
+    ASSERT_EQ(std::vector<uint64_t>({3, 1, 0}), needCompact);
+
+    workerOptions_.maxChunksPerCompact = 2;
+    needCompact = impl_->GetNeedCompact(s3chunkinfoMap, 64 * 3, 64);
+    ASSERT_EQ(std::vector<uint64_t>({3, 1}), needCompact);
+}
+
+TEST_F(S3CompactTest, test_EstimateS3Requests) {
+    struct CompactInodeJob::S3CompactCtx ctx {
+        1, 1, PartitionInfo(), 4, 64, 0, 0, s3adapter_.get()
+    };
+    Inode inode;
+    inode.set_length(64);
+    S3ChunkInfoList l0;
+    auto ref = l0.add_s3chunks();
+    ref->set_chunkid(0);
+    ref->set_offset(0);
+    ref->set_len(8);
+    ref = l0.add_s3chunks();
+    ref->set_chunkid(1);
+    ref->set_offset(4);
+    ref->set_len(4);
+    S3ChunkInfoList l1;
+    ref = l1.add_s3chunks();
+    ref->set_chunkid(2);
+    ref->set_offset(64);
+    ref->set_len(4);
+    inode.mutable_s3chunkinfomap()->insert({0, l0});
+    inode.mutable_s3chunkinfomap()->insert({1, l1});
+
+    // delete 3 objs, read 2 objs and write 2 objs
+    ASSERT_EQ(7, impl_->EstimateS3Requests(ctx, 0, inode));
+    // truncated, delete 1 obj only
+    ASSERT_EQ(1, impl_->EstimateS3Requests(ctx, 1, inode));
+}
+
 TEST_F(S3CompactTest, test_DeleteObjs) {
     std::vector<std::string> objs;
     objs.emplace_back("obj1");
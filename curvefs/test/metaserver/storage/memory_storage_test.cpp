@@ -71,6 +71,8 @@ TEST_F(MemoryStorageTest, HSizeTest) { TestHSize(kvStorage_);
                                        TestHSize(kvStorage2_); }
 TEST_F(MemoryStorageTest, HClearTest) { TestHClear(kvStorage_);
                                         TestHClear(kvStorage2_); }
+TEST_F(MemoryStorageTest, HMultiGetTest) { TestHMultiGet(kvStorage_);
+                                           TestHMultiGet(kvStorage2_); }
 
 TEST_F(MemoryStorageTest, SGetTest) { TestSGet(kvStorage_);
                                       TestSGet(kvStorage2_); }
@@ -80,12 +82,16 @@ TEST_F(MemoryStorageTest, SDelTest) { TestSDel(kvStorage_);
                                       TestSDel(kvStorage2_); }
 TEST_F(MemoryStorageTest, SSeekTest) { TestSSeek(kvStorage_);
                                        TestSSeek(kvStorage2_); }
+TEST_F(MemoryStorageTest, SSeekFromTest) { TestSSeekFrom(kvStorage_);
+                                           TestSSeekFrom(kvStorage2_); }
 TEST_F(MemoryStorageTest, SGetAllTest) { TestSGetAll(kvStorage_);
                                          TestSGetAll(kvStorage2_); }
 TEST_F(MemoryStorageTest, SSizeTest) { TestSSize(kvStorage_);
                                        TestSSize(kvStorage2_); }
 TEST_F(MemoryStorageTest, SClearTest) { TestSClear(kvStorage_);
                                         TestSClear(kvStorage2_); }
+TEST_F(MemoryStorageTest, SMultiGetTest) { TestSMultiGet(kvStorage_);
+                                           TestSMultiGet(kvStorage2_); }
 TEST_F(MemoryStorageTest, MixOperatorTest) { TestMixOperator(kvStorage_);
                                              TestMixOperator(kvStorage2_); }
 
@@ -30,6 +30,8 @@
 
 #include <memory>
 
+#include "curvefs/src/metaserver/storage/rocksdb_options.h"
+#include "curvefs/src/metaserver/storage/rocksdb_perf.h"
 #include "curvefs/src/metaserver/storage/storage.h"
 #include "curvefs/src/metaserver/storage/utils.h"
 #include "curvefs/test/metaserver/storage/storage_test.h"
@@ -161,14 +163,17 @@ TEST_F(RocksDBStorageTest, HDelTest) { TestHDel(kvStorage_); }
 TEST_F(RocksDBStorageTest, HGetAllTest) { TestHGetAll(kvStorage_); }
 TEST_F(RocksDBStorageTest, HSizeTest) { TestHSize(kvStorage_); }
 TEST_F(RocksDBStorageTest, HClearTest) { TestHClear(kvStorage_); }
+TEST_F(RocksDBStorageTest, HMultiGetTest) { TestHMultiGet(kvStorage_); }
 
 TEST_F(RocksDBStorageTest, SGetTest) { TestSGet(kvStorage_); }
 TEST_F(RocksDBStorageTest, SSetTest) { TestSSet(kvStorage_); }
 TEST_F(RocksDBStorageTest, SDelTest) { TestSDel(kvStorage_); }
 TEST_F(RocksDBStorageTest, SSeekTest) { TestSSeek(kvStorage_); }
+TEST_F(RocksDBStorageTest, SSeekFromTest) { TestSSeekFrom(kvStorage_); }
 TEST_F(RocksDBStorageTest, SGetAllTest) { TestSGetAll(kvStorage_); }
 TEST_F(RocksDBStorageTest, SSizeTest) { TestSSize(kvStorage_); }
 TEST_F(RocksDBStorageTest, SClearTest) { TestSClear(kvStorage_); }
+TEST_F(RocksDBStorageTest, SMultiGetTest) { TestSMultiGet(kvStorage_); }
 TEST_F(RocksDBStorageTest, MixOperatorTest) { TestMixOperator(kvStorage_); }
 TEST_F(RocksDBStorageTest, TransactionTest) { TestTransaction(kvStorage_); }
 TEST_F(RocksDBStorageTest, HClearTestSMixOperator) {
@@ -267,6 +272,15 @@ TEST_F(RocksDBStorageTest, TestCheckpointAndRecover) {
 
     ASSERT_TRUE(kvStorage_->Recover(dirname_));
 
+    // the table files are hard linked from checkpoint
+    for (const auto& file : files) {
+        if (file.size() > 4 && file.compare(file.size() - 4, 4, ".sst") == 0) {
+            struct stat st;
+            ASSERT_EQ(0, stat((dirname_ + "/" + file).c_str(), &st));
+            ASSERT_GE(st.st_nlink, 2);
+        }
+    }
+
     // get values that checkpoint should have
     Dentry dummyDentry;
     kvStorage_->SGet("1", "1", &dummyDentry);
@@ -294,6 +308,64 @@ TEST_F(RocksDBStorageTest, TestCheckpointAndRecover) {
     EXPECT_EQ(Value("7"), dummyDentry);
 }
 
+TEST(RocksDBOptionsTest, UserKeyPrefixTransform) {
+    std::unique_ptr<rocksdb::SliceTransform> transform(
+        NewUserKeyPrefixTransform(4));
+
+    // the first 4 bytes are skipped, they may contain delimiters
+    std::string dentry = "::::3:1:100:a:b";
+    ASSERT_TRUE(transform->InDomain(dentry));
+    ASSERT_EQ(transform->Transform(dentry).ToString(), "::::3:1:100:");
+    std::string prefix = "::::3:1:100:";
+    ASSERT_TRUE(transform->InDomain(prefix));
+    ASSERT_EQ(transform->Transform(prefix).ToString(), prefix);
+
+    std::string chunk = "::::2:1:100:0:00000000000000000001:"
+                        "00000000000000000002:4096";
+    ASSERT_EQ(transform->Transform(chunk).ToString(), "::::2:1:100:");
+
+    ASSERT_FALSE(transform->InDomain("::::1:1:100"));
+    ASSERT_FALSE(transform->InDomain("::::3:"));
+    ASSERT_FALSE(transform->InDomain("::::"));
+}
+
+TEST_F(RocksDBStorageTest, OpPerfScopeTest) {
+    auto s = kvStorage_->SSet("1", "1", Value("1"));
+    ASSERT_TRUE(s.ok()) << s.ToString();
+
+    // CASE 1: sampling disabled
+    FLAGS_rocksdb_op_perf_sampling_ratio = 0;
+    {
+        RocksDBOpPerfScope scope;
+        ASSERT_FALSE(scope.Sampled());
+        ASSERT_FALSE(RocksDBOpPerfScope::InScope());
+    }
+
+    // CASE 2: sample all operators, and the nested scope isn't sampled
+    FLAGS_rocksdb_op_perf_sampling_ratio = 1;
+    {
+        RocksDBOpPerfScope scope;
+        ASSERT_TRUE(scope.Sampled());
+        ASSERT_TRUE(RocksDBOpPerfScope::InScope());
+
+        {
+            RocksDBOpPerfScope nested;
+            ASSERT_FALSE(nested.Sampled());
+        }
+
+        Dentry dentry;
+        s = kvStorage_->SGet("1", "1", &dentry);
+        ASSERT_TRUE(s.ok()) << s.ToString();
+
+        RocksDBPerfStats stats;
+        scope.GetStats(&stats);
+        ASSERT_GE(stats.memtableHitCount, 1);
+        ASSERT_GT(stats.readBytes, 0);
+    }
+    ASSERT_FALSE(RocksDBOpPerfScope::InScope());
+    FLAGS_rocksdb_op_perf_sampling_ratio = 0;
+}
+
 }  // namespace storage
 }  // namespace metaserver
 }  // namespace curvefs
@@ -24,6 +24,7 @@
 #include <gtest/gtest.h>
 
 #include <unordered_map>
+#include <vector>
 
 #include "src/common/string_util.h"
 #include "curvefs/src/metaserver/storage/iterator.h"
@@ -373,6 +374,52 @@ void TestHClear(std::shared_ptr<KVStorage> kvStorage) {
     ASSERT_EQ(kvStorage->HSize(tablename3), 0);
 }
 
+void TestHMultiGet(std::shared_ptr<KVStorage> kvStorage) {
+    Status s;
+    Dentry value1, value2, value3;
+    std::vector<std::string> keys{ "key1", "key2", "key3" };
+    std::vector<ValueType*> values{ &value1, &value2, &value3 };
+    std::vector<Status> statuses;
+
+    // CASE 1: empty keys
+    kvStorage->HMultiGet(TableName(1), {}, {}, &statuses);
+    ASSERT_TRUE(statuses.empty());
+
+    // CASE 2: all not found
+    kvStorage->HMultiGet(TableName(1), keys, values, &statuses);
+    ASSERT_EQ(statuses.size(), 3);
+    for (const auto& status : statuses) {
+        ASSERT_TRUE(status.IsNotFound());
+    }
+
+    // CASE 3: some keys found
+    s = kvStorage->HSet(TableName(1), "key1", Value("value1"));
+    ASSERT_TRUE(s.ok());
+    s = kvStorage->HSet(TableName(1), "key3", Value("value3"));
+    ASSERT_TRUE(s.ok());
+    s = kvStorage->HSet(TableName(2), "key2", Value("value2"));
+    ASSERT_TRUE(s.ok());
+    kvStorage->HMultiGet(TableName(1), keys, values, &statuses);
+    ASSERT_EQ(statuses.size(), 3);
+    ASSERT_TRUE(statuses[0].ok());
+    ASSERT_EQ(value1, Value("value1"));
+    ASSERT_TRUE(statuses[1].IsNotFound());
+    ASSERT_TRUE(statuses[2].ok());
+    ASSERT_EQ(value3, Value("value3"));
+
+    // CASE 4: all keys found
+    s = kvStorage->HSet(TableName(1), "key2", Value("value2"));
+    ASSERT_TRUE(s.ok());
+    kvStorage->HMultiGet(TableName(1), keys, values, &statuses);
+    ASSERT_EQ(statuses.size(), 3);
+    for (const auto& status : statuses) {
+        ASSERT_TRUE(status.ok());
+    }
+    ASSERT_EQ(value1, Value("value1"));
+    ASSERT_EQ(value2, Value("value2"));
+    ASSERT_EQ(value3, Value("value3"));
+}
+
 void TestSGet(std::shared_ptr<KVStorage> kvStorage) {
     Status s;
     Dentry value;
@@ -583,6 +630,48 @@ void TestSSeek(std::shared_ptr<KVStorage> kvStorage) {
     ASSERT_EQ(size, 0);
 }
 
+void TestSSeekFrom(std::shared_ptr<KVStorage> kvStorage) {
+    Status s;
+    Dentry value;
+    std::vector<std::string> keys{
+        "1:1:/a", "1:1:/b", "1:1:/c", "1:2:/a", "1:2:/b", "2:1:/a",
+    };
+    for (const auto& key : keys) {
+        s = kvStorage->SSet(TableName(1), key, Value(key));
+        ASSERT_TRUE(s.ok());
+    }
+
+    auto list = [&](const std::string& prefix, const std::string& lower) {
+        std::vector<std::string> out;
+        auto iterator = kvStorage->SSeekFrom(TableName(1), prefix, lower);
+        EXPECT_EQ(iterator->Status(), 0);
+        for (iterator->SeekToFirst(); iterator->Valid(); iterator->Next()) {
+            std::string key = iterator->Key();
+            if (!StringStartWith(key, prefix)) {
+                break;
+            }
+            EXPECT_TRUE(iterator->ParseFromValue(&value));
+            EXPECT_EQ(value, Value(key));
+            out.push_back(key);
+        }
+        return out;
+    };
+
+    // CASE 1: seek from the begin of range
+    ASSERT_EQ(list("1:1:", "1:1:"),
+              (std::vector<std::string>{ "1:1:/a", "1:1:/b", "1:1:/c" }));
+
+    // CASE 2: seek from the middle of range
+    ASSERT_EQ(list("1:1:", "1:1:/b"),
+              (std::vector<std::string>{ "1:1:/b", "1:1:/c" }));
+    ASSERT_EQ(list("1:2:", "1:2:/aa"),
+              (std::vector<std::string>{ "1:2:/b" }));
+
+    // CASE 3: seek beyond the range
+    ASSERT_TRUE(list("1:1:", "1:1:/d").empty());
+    ASSERT_TRUE(list("1:3:", "1:3:").empty());
+}
+
 void TestSGetAll(std::shared_ptr<KVStorage> kvStorage) {
     Status s;
     size_t size = 0;
@@ -774,6 +863,52 @@ void TestSClear(std::shared_ptr<KVStorage> kvStorage) {
     ASSERT_EQ(kvStorage->SSize(tablename3), 0);
 }
 
+void TestSMultiGet(std::shared_ptr<KVStorage> kvStorage) {
+    Status s;
+    Dentry value1, value2, value3;
+    std::vector<std::string> keys{ "key1", "key2", "key3" };
+    std::vector<ValueType*> values{ &value1, &value2, &value3 };
+    std::vector<Status> statuses;
+
+    // CASE 1: empty keys
+    kvStorage->SMultiGet(TableName(1), {}, {}, &statuses);
+    ASSERT_TRUE(statuses.empty());
+
+    // CASE 2: all not found
+    kvStorage->SMultiGet(TableName(1), keys, values, &statuses);
+    ASSERT_EQ(statuses.size(), 3);
+    for (const auto& status : statuses) {
+        ASSERT_TRUE(status.IsNotFound());
+    }
+
+    // CASE 3: some keys found
+    s = kvStorage->SSet(TableName(1), "key1", Value("value1"));
+    ASSERT_TRUE(s.ok());
+    s = kvStorage->SSet(TableName(1), "key3", Value("value3"));
+    ASSERT_TRUE(s.ok());
+    s = kvStorage->SSet(TableName(2), "key2", Value("value2"));
+    ASSERT_TRUE(s.ok());
+    kvStorage->SMultiGet(TableName(1), keys, values, &statuses);
+    ASSERT_EQ(statuses.size(), 3);
+    ASSERT_TRUE(statuses[0].ok());
+    ASSERT_EQ(value1, Value("value1"));
+    ASSERT_TRUE(statuses[1].IsNotFound());
+    ASSERT_TRUE(statuses[2].ok());
+    ASSERT_EQ(value3, Value("value3"));
+
+    // CASE 4: all keys found
+    s = kvStorage->SSet(TableName(1), "key2", Value("value2"));
+    ASSERT_TRUE(s.ok());
+    kvStorage->SMultiGet(TableName(1), keys, values, &statuses);
+    ASSERT_EQ(statuses.size(), 3);
+    for (const auto& status : statuses) {
+        ASSERT_TRUE(status.ok());
+    }
+    ASSERT_EQ(value1, Value("value1"));
+    ASSERT_EQ(value2, Value("value2"));
+    ASSERT_EQ(value3, Value("value3"));
+}
+
 void TestMixOperator(std::shared_ptr<KVStorage> kvStorage) {
     Status s;
     size_t size;
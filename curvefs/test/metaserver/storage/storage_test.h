@@ -43,14 +43,17 @@ void TestHDel(std::shared_ptr<KVStorage> kvStorage);
 void TestHGetAll(std::shared_ptr<KVStorage> kvStorage);
 void TestHSize(std::shared_ptr<KVStorage> kvStorage);
 void TestHClear(std::shared_ptr<KVStorage> kvStorage);
+void TestHMultiGet(std::shared_ptr<KVStorage> kvStorage);
 
 void TestSGet(std::shared_ptr<KVStorage> kvStorage);
 void TestSSet(std::shared_ptr<KVStorage> kvStorage);
 void TestSDel(std::shared_ptr<KVStorage> kvStorage);
 void TestSSeek(std::shared_ptr<KVStorage> kvStorage);
+void TestSSeekFrom(std::shared_ptr<KVStorage> kvStorage);
 void TestSGetAll(std::shared_ptr<KVStorage> kvStorage);
 void TestSSize(std::shared_ptr<KVStorage> kvStorage);
 void TestSClear(std::shared_ptr<KVStorage> kvStorage);
+void TestSMultiGet(std::shared_ptr<KVStorage> kvStorage);
 
 void TestMixOperator(std::shared_ptr<KVStorage> kvStorage);
 void TestTransaction(std::shared_ptr<KVStorage> kvStorage);
@@ -353,5 +353,88 @@ TEST_F(TransactionTest, HandleTxWithTargetExist) {
     ASSERT_EQ(dentryStorage_->Size(), 3);  // /B /B/A /C(pending)
 }
 
+TEST_F(TransactionTest, HandleTxCommitInPlace) {
+    InsertDentrys(dentryStorage_,
+                  std::vector<Dentry>{
+                      // { fsId, parentId, name, txId, inodeId, flag }
+                      GenDentry(1, 0, "A", 0, 1, 0),
+                      GenDentry(1, 0, "B", 0, 2, 0),
+                  });
+
+    // step-1: rename A B in place, B is overwritten
+    auto dentrys = std::vector<Dentry>{
+        // { fsId, parentId, name, txId, inodeId, flag }
+        GenDentry(1, 0, "A", 1, 1, DELETE_FLAG),
+        GenDentry(1, 0, "B", 1, 1, 0),
+    };
+    bool committed = false;
+    auto rc = txManager_->HandleRenameTx(dentrys, logIndex_++, &committed);
+    ASSERT_EQ(rc, MetaStatusCode::OK);
+    ASSERT_TRUE(committed);
+    ASSERT_EQ(dentryStorage_->Size(), 1);
+
+    // step-2: visible with txid=0 without committing tx to mds
+    auto dentry = GenDentry(1, 0, "A", 0, 0, 0);
+    ASSERT_EQ(dentryManager_->GetDentry(&dentry), MetaStatusCode::NOT_FOUND);
+    dentry = GenDentry(1, 0, "B", 0, 0, 0);
+    ASSERT_EQ(dentryManager_->GetDentry(&dentry), MetaStatusCode::OK);
+    ASSERT_EQ(dentry.inodeid(), 1);
+
+    // step-3: apply the same log entry again
+    committed = false;
+    rc = txManager_->HandleRenameTx(dentrys, logIndex_ - 1, &committed);
+    ASSERT_EQ(rc, MetaStatusCode::OK);
+    ASSERT_TRUE(committed);
+    ASSERT_EQ(dentryStorage_->Size(), 1);
+
+    // step-4: prepare tx (rename B C), and mds commits it with txid=1
+    dentrys = std::vector<Dentry>{
+        // { fsId, parentId, name, txId, inodeId, flag }
+        GenDentry(1, 0, "B", 1, 1, DELETE_FLAG),
+        GenDentry(1, 0, "C", 1, 1, 0),
+    };
+    rc = txManager_->HandleRenameTx(dentrys, logIndex_++);
+    ASSERT_EQ(rc, MetaStatusCode::OK);
+
+    // step-5: rename C D in place, the pending tx is committed before
+    dentrys = std::vector<Dentry>{
+        // { fsId, parentId, name, txId, inodeId, flag }
+        GenDentry(1, 0, "C", 2, 1, DELETE_FLAG),
+        GenDentry(1, 0, "D", 2, 1, 0),
+    };
+    committed = false;
+    rc = txManager_->HandleRenameTx(dentrys, logIndex_++, &committed);
+    ASSERT_EQ(rc, MetaStatusCode::OK);
+    ASSERT_TRUE(committed);
+
+    dentrys.clear();
+    dentry = GenDentry(1, 0, "", 1, 0, 0);
+    rc = dentryManager_->ListDentry(dentry, &dentrys, 0);
+    ASSERT_EQ(rc, MetaStatusCode::OK);
+    ASSERT_DENTRYS_EQ(dentrys, std::vector<Dentry>{
+                                   GenDentry(1, 0, "D", 1, 1, 0),
+                               });
+
+    // step-6: prepare tx (rename D E) which mds doesn't commit yet,
+    //         the rename with the same txid can't be committed in place
+    dentrys = std::vector<Dentry>{
+        // { fsId, parentId, name, txId, inodeId, flag }
+        GenDentry(1, 0, "D", 2, 1, DELETE_FLAG),
+        GenDentry(1, 0, "E", 2, 1, 0),
+    };
+    rc = txManager_->HandleRenameTx(dentrys, logIndex_++);
+    ASSERT_EQ(rc, MetaStatusCode::OK);
+
+    dentrys = std::vector<Dentry>{
+        // { fsId, parentId, name, txId, inodeId, flag }
+        GenDentry(1, 0, "D", 2, 1, DELETE_FLAG),
+        GenDentry(1, 0, "F", 2, 1, 0),
+    };
+    committed = true;
+    rc = txManager_->HandleRenameTx(dentrys, logIndex_++, &committed);
+    ASSERT_EQ(rc, MetaStatusCode::OK);
+    ASSERT_FALSE(committed);
+}
+
 }  // namespace metaserver
 }  // namespace curvefs
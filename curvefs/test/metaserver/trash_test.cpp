@@ -30,6 +30,7 @@
 #include "src/fs/ext4_filesystem_impl.h"
 #include "curvefs/test/client/rpcclient/mock_mds_client.h"
 #include "curvefs/test/metaserver/mock_metaserver_s3_adaptor.h"
+#include "src/common/timeutility.h"
 
 using ::testing::_;
 using ::testing::AtLeast;
@@ -47,6 +48,7 @@ namespace {
 auto localfs = curve::fs::Ext4FileSystemImpl::getInstance();
 }
 
+using ::curve::common::TimeUtility;
 using ::curvefs::client::rpcclient::MockMdsClient;
 using ::curvefs::metaserver::storage::KVStorage;
 using ::curvefs::metaserver::storage::RandomStoragePath;
@@ -202,5 +204,39 @@ TEST_F(TestTrash, testAdd3ItemAndNoDelete) {
     trashManager_->Fini();
 }
 
+TEST_F(TestTrash, testDeleteExpiredItemsInBatch) {
+    TrashOption option;
+    option.scanPeriodSec = 1;
+    option.expiredAfterSec = 1;
+    option.deleteBatchSize = 2;
+    option.mdsClient = std::make_shared<MockMdsClient>();
+    option.s3Adaptor = std::make_shared<MockS3ClientAdaptor>();
+    trashManager_->Init(option);
+    trashManager_->Run();
+
+    auto trash1 = std::make_shared<TrashImpl>(inodeStorage_);
+    trashManager_->Add(1, trash1);
+
+    for (uint64_t inodeId = 1; inodeId <= 6; inodeId++) {
+        inodeStorage_->Insert(GenInodeHasChunks(1, inodeId), logIndex_++);
+    }
+    ASSERT_EQ(inodeStorage_->Size(), 6);
+    for (uint64_t inodeId = 1; inodeId <= 5; inodeId++) {
+        trash1->Add(1, inodeId, 0);
+    }
+    // not expired yet
+    uint32_t future = TimeUtility::GetTimeofDaySec() + 3600;
+    trash1->Add(1, 6, future);
+
+    std::this_thread::sleep_for(std::chrono::seconds(5));
+    std::list<TrashItem> list;
+    trashManager_->ListItems(&list);
+    ASSERT_EQ(1, list.size());
+    ASSERT_EQ(6, list.front().inodeId);
+    ASSERT_EQ(future, list.front().dtime);
+    ASSERT_EQ(inodeStorage_->Size(), 1);
+    trashManager_->Fini();
+}
+
 }  // namespace metaserver
 }  // namespace curvefs
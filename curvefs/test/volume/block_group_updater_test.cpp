@@ -107,5 +107,33 @@ TEST_F(BlockGroupBitmapUpdaterTest, SyncTest_WriteFailed) {
     ASSERT_FALSE(updater_->Sync());
 }
 
+TEST(BlockGroupBitmapUpdaterDirtyRangeTest, OnlySyncDirtyBlocks) {
+    MockBlockDeviceClient blockDev;
+    constexpr uint64_t groupSize = 1 * kGiB;
+    constexpr uint64_t bitmapLength =
+        groupSize / kBlockSize / curve::common::BITMAP_UNIT_SIZE;  // 32 KiB
+
+    Bitmap bitmap(groupSize / kBlockSize);
+    BitmapRange range{kBlockGroupOffset, bitmapLength};
+    BlockGroupBitmapUpdater updater(std::move(bitmap), kBlockSize, groupSize,
+                                    kBlockGroupOffset, range, &blockDev);
+
+    // bit 40000 is in the 5000th byte, which is in the second block
+    updater.Update({kBlockGroupOffset + 40000ULL * kBlockSize, kBlockSize},
+                   BlockGroupBitmapUpdater::Set);
+
+    // write failed, and the range is still dirty
+    EXPECT_CALL(blockDev, Write(_, kBlockGroupOffset + kBlockSize, kBlockSize))
+        .WillOnce(Return(-1))
+        .WillOnce(
+            Invoke([](const char*, off_t, size_t length) { return length; }));
+
+    ASSERT_FALSE(updater.Sync());
+    ASSERT_TRUE(updater.Sync());
+
+    // not dirty any more
+    ASSERT_TRUE(updater.Sync());
+}
+
 }  // namespace volume
 }  // namespace curvefs
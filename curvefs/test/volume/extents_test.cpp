@@ -339,5 +339,37 @@ TEST(ExtentTest, TestMarkUsed) {
     EXPECT_EQ(0, freeExt.AvailableExtents().size());
 }
 
+TEST(ExtentTest, TestBestFitAlloc) {
+    FreeExtents freeExt(0, 16 * kMiB);
+    AllocateHint hint;
+
+    Extents ext1;
+    ASSERT_EQ(16 * kMiB, freeExt.Alloc(16 * kMiB, hint, &ext1));
+
+    // free extents: [0, 8MiB), [10MiB, 12MiB), [14MiB, 15MiB)
+    freeExt.DeAlloc(0, 8 * kMiB);
+    freeExt.DeAlloc(10 * kMiB, 2 * kMiB);
+    freeExt.DeAlloc(14 * kMiB, 1 * kMiB);
+
+    // the smallest extent that satisfy the size is chosen
+    Extents ext2;
+    ASSERT_EQ(2 * kMiB, freeExt.Alloc(2 * kMiB, hint, &ext2));
+    Extents expected = {{10 * kMiB, 2 * kMiB}};
+    ASSERT_EQ(expected, ext2);
+
+    ext2.clear();
+    ASSERT_EQ(1 * kMiB, freeExt.Alloc(1 * kMiB, hint, &ext2));
+    expected = {{14 * kMiB, 1 * kMiB}};
+    ASSERT_EQ(expected, ext2);
+
+    // merged extent is indexed by its new size
+    freeExt.DeAlloc(8 * kMiB, 2 * kMiB);
+    ext2.clear();
+    ASSERT_EQ(10 * kMiB, freeExt.Alloc(10 * kMiB, hint, &ext2));
+    expected = {{0, 10 * kMiB}};
+    ASSERT_EQ(expected, ext2);
+    ASSERT_EQ(0, freeExt.AvailableSize());
+}
+
 }  // namespace volume
 }  // namespace curvefs
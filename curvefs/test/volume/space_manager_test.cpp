@@ -218,5 +218,104 @@ TEST_F(SpaceManagerImplTest, TestMultiThreadAlloc) {
     ASSERT_TRUE(spaceManager_->Shutdown());
 }
 
+TEST_F(SpaceManagerImplTest, TestAllocFromReserved) {
+    opt_.reserveSize = 1024 * 1024;
+    opt_.reserveShards = 1;
+    spaceManager_.reset(new SpaceManagerImpl(opt_, mdsClient_, devClient_));
+
+    mds::space::BlockGroup group;
+    group.set_offset(0);
+    group.set_size(kBlockGroupSize);
+    group.set_available(kBlockGroupSize / 2);
+    group.set_bitmaplocation(curvefs::common::BitmapLocation::AtStart);
+
+    EXPECT_CALL(*mdsClient_, AllocateVolumeBlockGroup(_, _, _, _))
+        .WillOnce(Invoke(MockAllocateBlockGroup{group}));
+
+    EXPECT_CALL(*devClient_, Read(_, _, _))
+        .Times(AtLeast(1))
+        .WillRepeatedly(Invoke(MockRead));
+
+    EXPECT_CALL(*devClient_, Write(_, _, _))
+        .Times(AtLeast(1))
+        .WillRepeatedly(Invoke(MockWrite));
+
+    std::vector<Extent> first;
+    ASSERT_TRUE(spaceManager_->Alloc(kBlockSize, {}, &first));
+    ASSERT_EQ(1, first.size());
+    ASSERT_EQ(kBlockSize, first[0].len);
+
+    // the following allocations continue right after the left hint
+    uint64_t end = first[0].offset + first[0].len;
+    for (int i = 0; i < 16; ++i) {
+        AllocateHint hint;
+        hint.leftOffset = end;
+        std::vector<Extent> ext;
+        ASSERT_TRUE(spaceManager_->Alloc(kBlockSize, hint, &ext));
+        ASSERT_EQ(1, ext.size());
+        ASSERT_EQ(end, ext[0].offset);
+        end += ext[0].len;
+    }
+
+    EXPECT_CALL(*mdsClient_, ReleaseVolumeBlockGroup(_, _, _))
+        .WillOnce(Return(SpaceErrCode::SpaceOk));
+    ASSERT_TRUE(spaceManager_->Shutdown());
+}
+
+TEST_F(SpaceManagerImplTest, TestAllocateByAllocRate) {
+    opt_.allocateAheadSec = 10;
+    opt_.blockGroupManagerOption.blockGroupMaxAllocateOnce = 4;
+    spaceManager_.reset(new SpaceManagerImpl(opt_, mdsClient_, devClient_));
+
+    mds::space::BlockGroup group;
+    group.set_offset(0);
+    group.set_size(kBlockGroupSize);
+    group.set_available(kBlockGroupSize);
+    group.set_bitmaplocation(curvefs::common::BitmapLocation::AtStart);
+
+    auto allocateGroups = [&group](uint32_t, uint32_t count,
+                                   const std::string&,
+                                   std::vector<mds::space::BlockGroup>* out) {
+        for (uint32_t i = 1; i <= count; ++i) {
+            out->push_back(group);
+            out->back().set_offset(i * kBlockGroupSize);
+        }
+        return mds::space::SpaceOk;
+    };
+
+    // nothing is allocated before the first block group, so only the
+    // default count is allocated, and the following one is predicted by
+    // the alloc rate which is limited by blockGroupMaxAllocateOnce
+    EXPECT_CALL(*mdsClient_, AllocateVolumeBlockGroup(_, 1, _, _))
+        .WillOnce(Invoke(MockAllocateBlockGroup{group}));
+    EXPECT_CALL(*mdsClient_, AllocateVolumeBlockGroup(_, 4, _, _))
+        .WillOnce(Invoke(allocateGroups));
+
+    EXPECT_CALL(*devClient_, Read(_, _, _))
+        .Times(AtLeast(1))
+        .WillRepeatedly(Invoke(MockRead));
+
+    EXPECT_CALL(*devClient_, Write(_, _, _))
+        .WillRepeatedly(Invoke(MockWrite));
+    EXPECT_CALL(*devClient_, Writev(_))
+        .WillRepeatedly(Invoke([](const std::vector<WritePart>& parts) {
+            ssize_t total = 0;
+            for (const auto& part : parts) {
+                total += part.length;
+            }
+            return total;
+        }));
+
+    const uint32_t allocSize = kBlockGroupSize / 2;
+    for (int i = 0; i < 4; ++i) {
+        std::vector<Extent> ext;
+        ASSERT_TRUE(spaceManager_->Alloc(allocSize, {}, &ext));
+    }
+
+    EXPECT_CALL(*mdsClient_, ReleaseVolumeBlockGroup(_, _, _))
+        .WillOnce(Return(SpaceErrCode::SpaceOk));
+    ASSERT_TRUE(spaceManager_->Shutdown());
+}
+
 }  // namespace volume
 }  // namespace curvefs
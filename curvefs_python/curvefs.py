@@ -504,6 +504,15 @@ class CBDClient(_object):
     def AioWrite(self, fd, aioctx):
         return _curvefs.CBDClient_AioWrite(self, fd, aioctx)
 
+    def ReadInto(self, fd, buf, offset):
+        return _curvefs.CBDClient_ReadInto(self, fd, buf, offset)
+
+    def AioReadInto(self, fd, buf, offset, callback):
+        return _curvefs.CBDClient_AioReadInto(self, fd, buf, offset, callback)
+
+    def AioWriteFrom(self, fd, buf, offset, callback):
+        return _curvefs.CBDClient_AioWriteFrom(self, fd, buf, offset, callback)
+
     def StatFile(self, filename, info, finfo):
         return _curvefs.CBDClient_StatFile(self, filename, info, finfo)
 
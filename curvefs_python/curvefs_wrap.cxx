@@ -6841,7 +6841,9 @@ SWIGINTERN PyObject *_wrap_CBDClient_Read(PyObject *SWIGUNUSEDPARM(self), PyObje
   } 
   arg5 = static_cast< unsigned long >(val5);
   arg3 = new char[arg5];
+  Py_BEGIN_ALLOW_THREADS
   result = (int)(arg1)->Read(arg2,arg3,arg4,arg5);
+  Py_END_ALLOW_THREADS
   if (result < 0) {
       delete[] arg3;
       resultobj = SWIG_From_int(static_cast< int >(result));
@@ -6877,7 +6879,7 @@ SWIGINTERN PyObject *_wrap_CBDClient_Write(PyObject *SWIGUNUSEDPARM(self), PyObj
   int res3 ;
   char *buf3 = 0 ;
 #if PY_MAJOR_VERSION == 3
-  Py_ssize_t input_len;
+  Py_buffer view3 = { 0 } ;
 #endif
   int alloc3 = 0 ;
   unsigned long val4 ;
@@ -6892,7 +6894,8 @@ SWIGINTERN PyObject *_wrap_CBDClient_Write(PyObject *SWIGUNUSEDPARM(self), PyObj
   int result;
   
 #if PY_MAJOR_VERSION == 3
-  if (!PyArg_ParseTuple(args,(char *)"OOy#OO:CBDClient_Write",&obj0,&obj1,&buf3,&input_len,&obj3,&obj4)) SWIG_fail;
+  if (!PyArg_ParseTuple(args,(char *)"OOy*OO:CBDClient_Write",&obj0,&obj1,&view3,&obj3,&obj4)) SWIG_fail;
+  buf3 = reinterpret_cast< char * >(view3.buf);
 #else
   if (!PyArg_ParseTuple(args,(char *)"OOOOO:CBDClient_Write",&obj0,&obj1,&obj2,&obj3,&obj4)) SWIG_fail;
 #endif
@@ -6924,11 +6927,24 @@ SWIGINTERN PyObject *_wrap_CBDClient_Write(PyObject *SWIGUNUSEDPARM(self), PyObj
     SWIG_exception_fail(SWIG_ArgError(ecode5), "in method '" "CBDClient_Write" "', argument " "5"" of type '" "unsigned long""'");
   } 
   arg5 = static_cast< unsigned long >(val5);
+#if PY_MAJOR_VERSION == 3
+  if (arg5 > static_cast< unsigned long >(view3.len)) {
+    SWIG_exception_fail(SWIG_ValueError, "in method '" "CBDClient_Write" "', length is larger than the buffer");
+  }
+#endif
+  Py_BEGIN_ALLOW_THREADS
   result = (int)(arg1)->Write(arg2,(char const *)arg3,arg4,arg5);
+  Py_END_ALLOW_THREADS
   resultobj = SWIG_From_int(static_cast< int >(result));
+#if PY_MAJOR_VERSION == 3
+  PyBuffer_Release(&view3);
+#endif
   if (alloc3 == SWIG_NEWOBJ) delete[] buf3;
   return resultobj;
 fail:
+#if PY_MAJOR_VERSION == 3
+  if (view3.obj) PyBuffer_Release(&view3);
+#endif
   if (alloc3 == SWIG_NEWOBJ) delete[] buf3;
   return NULL;
 }
@@ -7014,6 +7030,205 @@ fail:
 }
 
 
+/*
+ * 以下接口为手写，基于buffer protocol直接读写调用方的bytearray/memoryview等
+ * 可写缓冲区，不再拷贝数据，阻塞的IO期间释放GIL，以便多线程并发IO。
+ */
+SWIGINTERN PyObject *_wrap_CBDClient_ReadInto(PyObject *SWIGUNUSEDPARM(self), PyObject *args) {
+  PyObject *resultobj = 0;
+  CBDClient *arg1 = (CBDClient *) 0 ;
+  int arg2 ;
+  unsigned long arg4 ;
+  void *argp1 = 0 ;
+  int res1 = 0 ;
+  int val2 ;
+  int ecode2 = 0 ;
+  Py_buffer view3 = { 0 } ;
+  unsigned long val4 ;
+  int ecode4 = 0 ;
+  PyObject * obj0 = 0 ;
+  PyObject * obj1 = 0 ;
+  PyObject * obj2 = 0 ;
+  PyObject * obj3 = 0 ;
+  int result;
+
+  if (!PyArg_ParseTuple(args,(char *)"OOOO:CBDClient_ReadInto",&obj0,&obj1,&obj2,&obj3)) SWIG_fail;
+  res1 = SWIG_ConvertPtr(obj0, &argp1,SWIGTYPE_p_CBDClient, 0 |  0 );
+  if (!SWIG_IsOK(res1)) {
+    SWIG_exception_fail(SWIG_ArgError(res1), "in method '" "CBDClient_ReadInto" "', argument " "1"" of type '" "CBDClient *""'");
+  }
+  arg1 = reinterpret_cast< CBDClient * >(argp1);
+  ecode2 = SWIG_AsVal_int(obj1, &val2);
+  if (!SWIG_IsOK(ecode2)) {
+    SWIG_exception_fail(SWIG_ArgError(ecode2), "in method '" "CBDClient_ReadInto" "', argument " "2"" of type '" "int""'");
+  }
+  arg2 = static_cast< int >(val2);
+  ecode4 = SWIG_AsVal_unsigned_SS_long(obj3, &val4);
+  if (!SWIG_IsOK(ecode4)) {
+    SWIG_exception_fail(SWIG_ArgError(ecode4), "in method '" "CBDClient_ReadInto" "', argument " "4"" of type '" "unsigned long""'");
+  }
+  arg4 = static_cast< unsigned long >(val4);
+  if (PyObject_GetBuffer(obj2, &view3, PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS) != 0) SWIG_fail;
+  Py_BEGIN_ALLOW_THREADS
+  result = (int)(arg1)->Read(arg2,reinterpret_cast< char * >(view3.buf),arg4,static_cast< unsigned long >(view3.len));
+  Py_END_ALLOW_THREADS
+  PyBuffer_Release(&view3);
+  resultobj = SWIG_From_int(static_cast< int >(result));
+  return resultobj;
+fail:
+  return NULL;
+}
+
+
+/*
+ * 异步IO的上下文，ctx必须是第一个成员，libcurve回调时传回的是&ctx。
+ * 请求提交失败时libcurve可能已经同步调用过回调（如未对齐的请求），也可能没有，
+ * 所以上下文由提交方和回调方各持有一个引用，两方都在持有GIL时释放引用。
+ */
+struct PyAioContext {
+  AioContext ctx;
+  Py_buffer view;
+  PyObject *callback;
+  bool called;
+  int refs;
+};
+
+/* 持有GIL时调用 */
+static void PyAioContext_Unref(PyAioContext *pyctx) {
+  if (--pyctx->refs > 0) {
+    return;
+  }
+  PyBuffer_Release(&pyctx->view);
+  Py_DECREF(pyctx->callback);
+  delete pyctx;
+}
+
+/* 持有GIL时调用，保证python回调只被调用一次 */
+static void PyAioContext_Complete(PyAioContext *pyctx, int ret) {
+  if (pyctx->called) {
+    return;
+  }
+  pyctx->called = true;
+  PyObject *res = PyObject_CallFunction(pyctx->callback, (char *)"i", ret);
+  if (res == NULL) {
+    PyErr_Print();
+  } else {
+    Py_DECREF(res);
+  }
+}
+
+static void PyAioContext_Callback(AioContext *ctx) {
+  PyAioContext *pyctx = reinterpret_cast< PyAioContext * >(ctx);
+  PyGILState_STATE state = PyGILState_Ensure();
+  PyAioContext_Complete(pyctx, ctx->ret);
+  PyAioContext_Unref(pyctx);
+  PyGILState_Release(state);
+}
+
+/*
+ * AioReadInto/AioWriteFrom的公共实现，callback(ret)在IO完成后于libcurve的
+ * 线程中调用，请求提交失败时也会以错误码调用一次。IO完成前buf被持有，不能被
+ * 调用方resize。
+ */
+static PyObject *CBDClient_AioBuffer(PyObject *args, bool isRead) {
+  const char *name = isRead ? "CBDClient_AioReadInto" : "CBDClient_AioWriteFrom";
+  CBDClient *arg1 = (CBDClient *) 0 ;
+  int arg2 ;
+  unsigned long arg4 ;
+  void *argp1 = 0 ;
+  int res1 = 0 ;
+  int val2 ;
+  int ecode2 = 0 ;
+  unsigned long val4 ;
+  int ecode4 = 0 ;
+  PyObject * obj0 = 0 ;
+  PyObject * obj1 = 0 ;
+  PyObject * obj2 = 0 ;
+  PyObject * obj3 = 0 ;
+  PyObject * obj4 = 0 ;
+  PyAioContext *pyctx = 0 ;
+  int result;
+
+  if (!PyArg_ParseTuple(args,(char *)"OOOOO",&obj0,&obj1,&obj2,&obj3,&obj4)) SWIG_fail;
+  res1 = SWIG_ConvertPtr(obj0, &argp1,SWIGTYPE_p_CBDClient, 0 |  0 );
+  if (!SWIG_IsOK(res1)) {
+    PyErr_Format(SWIG_Python_ErrorType(SWIG_ArgError(res1)), "in method '%s', argument 1 of type 'CBDClient *'", name);
+    SWIG_fail;
+  }
+  arg1 = reinterpret_cast< CBDClient * >(argp1);
+  ecode2 = SWIG_AsVal_int(obj1, &val2);
+  if (!SWIG_IsOK(ecode2)) {
+    PyErr_Format(SWIG_Python_ErrorType(SWIG_ArgError(ecode2)), "in method '%s', argument 2 of type 'int'", name);
+    SWIG_fail;
+  }
+  arg2 = static_cast< int >(val2);
+  ecode4 = SWIG_AsVal_unsigned_SS_long(obj3, &val4);
+  if (!SWIG_IsOK(ecode4)) {
+    PyErr_Format(SWIG_Python_ErrorType(SWIG_ArgError(ecode4)), "in method '%s', argument 4 of type 'unsigned long'", name);
+    SWIG_fail;
+  }
+  arg4 = static_cast< unsigned long >(val4);
+  if (!PyCallable_Check(obj4)) {
+    PyErr_Format(PyExc_TypeError, "in method '%s', argument 5 must be callable", name);
+    SWIG_fail;
+  }
+
+#if PY_VERSION_HEX < 0x03070000
+  /* 回调在libcurve的线程中获取GIL */
+  PyEval_InitThreads();
+#endif
+  pyctx = new PyAioContext();
+  if (PyObject_GetBuffer(obj2, &pyctx->view, isRead ? (PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS) : PyBUF_C_CONTIGUOUS) != 0) {
+    delete pyctx;
+    SWIG_fail;
+  }
+  Py_INCREF(obj4);
+  pyctx->callback = obj4;
+  pyctx->called = false;
+  pyctx->refs = 2;
+  pyctx->ctx.offset = arg4;
+  pyctx->ctx.length = static_cast< unsigned long >(pyctx->view.len);
+  pyctx->ctx.ret = 0;
+  pyctx->ctx.op = isRead ? CURVE_OP_READ : CURVE_OP_WRITE;
+  pyctx->ctx.cb = PyAioContext_Callback;
+  pyctx->ctx.buf = pyctx->view.buf;
+
+  if (pyctx->ctx.length == 0) {
+    /* libcurve对长度为0的请求直接返回，不会调用回调 */
+    result = 0;
+    PyAioContext_Complete(pyctx, 0);
+    PyAioContext_Unref(pyctx);
+  } else {
+    Py_BEGIN_ALLOW_THREADS
+    if (isRead) {
+      result = (int)(arg1)->AioRead(arg2,&pyctx->ctx);
+    } else {
+      result = (int)(arg1)->AioWrite(arg2,&pyctx->ctx);
+    }
+    Py_END_ALLOW_THREADS
+    if (result != 0 && !pyctx->called) {
+      /* 提交失败且未同步回调，之后也不会再有异步回调 */
+      PyAioContext_Complete(pyctx, result);
+      PyAioContext_Unref(pyctx);
+    }
+  }
+  PyAioContext_Unref(pyctx);
+  return SWIG_From_int(static_cast< int >(result));
+fail:
+  return NULL;
+}
+
+
+SWIGINTERN PyObject *_wrap_CBDClient_AioReadInto(PyObject *SWIGUNUSEDPARM(self), PyObject *args) {
+  return CBDClient_AioBuffer(args, true);
+}
+
+
+SWIGINTERN PyObject *_wrap_CBDClient_AioWriteFrom(PyObject *SWIGUNUSEDPARM(self), PyObject *args) {
+  return CBDClient_AioBuffer(args, false);
+}
+
+
 SWIGINTERN PyObject *_wrap_CBDClient_StatFile(PyObject *SWIGUNUSEDPARM(self), PyObject *args) {
   PyObject *resultobj = 0;
   CBDClient *arg1 = (CBDClient *) 0 ;
@@ -7510,6 +7725,9 @@ static PyMethodDef SwigMethods[] = {
 	 { (char *)"CBDClient_Write", _wrap_CBDClient_Write, METH_VARARGS, NULL},
 	 { (char *)"CBDClient_AioRead", _wrap_CBDClient_AioRead, METH_VARARGS, NULL},
 	 { (char *)"CBDClient_AioWrite", _wrap_CBDClient_AioWrite, METH_VARARGS, NULL},
+	 { (char *)"CBDClient_ReadInto", _wrap_CBDClient_ReadInto, METH_VARARGS, NULL},
+	 { (char *)"CBDClient_AioReadInto", _wrap_CBDClient_AioReadInto, METH_VARARGS, NULL},
+	 { (char *)"CBDClient_AioWriteFrom", _wrap_CBDClient_AioWriteFrom, METH_VARARGS, NULL},
 	 { (char *)"CBDClient_StatFile", _wrap_CBDClient_StatFile, METH_VARARGS, NULL},
 	 { (char *)"CBDClient_ChangeOwner", _wrap_CBDClient_ChangeOwner, METH_VARARGS, NULL},
 	 { (char *)"CBDClient_OpenDir", _wrap_CBDClient_OpenDir, METH_VARARGS, NULL},
@@ -181,6 +181,14 @@ int AioWrite(int fd, CurveAioContext* aioctx);
  */
 int AioDiscard(int fd, CurveAioContext* aioctx);
 
+/**
+ * @brief 设置文件的IO优先级，对之后下发的IO生效
+ * @param fd file descriptor
+ * @param priority IO优先级
+ * @return 成功返回 0, fd无效返回-LIBCURVE_ERROR::BAD_FD
+ */
+int SetIOPriority(int fd, LIBCURVE_IO_PRIORITY priority);
+
 /**
  * 重命名文件
  * @param: userinfo是用户信息
@@ -370,8 +378,10 @@ inline bool operator==(const UserInfo& lhs, const UserInfo& rhs) {
 struct OpenFlags {
     bool exclusive;
     std::string confPath;
+    // 打开后文件的IO优先级
+    LIBCURVE_IO_PRIORITY priority;
 
-    OpenFlags() : exclusive(true) {}
+    OpenFlags() : exclusive(true), priority(LIBCURVE_IO_PRIORITY_NORMAL) {}
 };
 
 class CurveClient {
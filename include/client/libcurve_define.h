@@ -104,6 +104,13 @@ typedef enum LIBCURVE_OP {
     LIBCURVE_OP_MAX,
 } LIBCURVE_OP;
 
+// IO优先级，按文件设置，低优先级的文件（如备份、数据迁移）在client端
+// 共享一份较小的inflight rpc配额，并在rpc中携带给chunkserver
+typedef enum LIBCURVE_IO_PRIORITY {
+    LIBCURVE_IO_PRIORITY_NORMAL = 0,
+    LIBCURVE_IO_PRIORITY_LOW = 1,
+} LIBCURVE_IO_PRIORITY;
+
 
 typedef void (*LibCurveAioCallBack)(struct CurveAioContext* context);
 
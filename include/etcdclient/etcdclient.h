@@ -210,8 +210,47 @@ extern GoUint32 EtcdClientTxn2(int p0, struct Operation p1, struct Operation p2)
 
 extern GoUint32 EtcdClientTxn3(int p0, struct Operation p1, struct Operation p2, struct Operation p3);
 
+/* Return type for EtcdClientTxnN */
+struct EtcdClientTxnN_return {
+	GoUint32 r0;
+	GoInt64 r1;
+};
+
+extern struct EtcdClientTxnN_return EtcdClientTxnN(int p0, struct Operation* p1, int p2);
+
 extern GoUint32 EtcdClientCompareAndSwap(int p0, char* p1, char* p2, char* p3, int p4, int p5, int p6);
 
+/* Return type for EtcdClientWatch */
+struct EtcdClientWatch_return {
+	GoUint32 r0;
+	GoUint64 r1;
+	GoInt r2;
+	GoInt64 r3;
+};
+
+// EtcdClientWatch returns the first batch of events in range [start, end)
+// since startRevision. All events of a revision are in the same batch, the
+// returned revision is that of the last event.
+//
+
+extern struct EtcdClientWatch_return EtcdClientWatch(int p0, char* p1, char* p2, int p3, int p4, GoInt64 p5);
+
+/* Return type for EtcdClientGetWatchEvent */
+struct EtcdClientGetWatchEvent_return {
+	GoUint32 r0;
+	GoUint32 r1;
+	char* r2;
+	GoInt r3;
+	char* r4;
+	GoInt r5;
+};
+
+// EtcdClientGetWatchEvent returns the type, key and value of an event, the
+// value of a delete event is the value before deleted
+//
+
+extern struct EtcdClientGetWatchEvent_return EtcdClientGetWatchEvent(GoUint64 p0, GoInt p1);
+
 /* Return type for EtcdElectionCampaign */
 struct EtcdElectionCampaign_return {
 	GoUint32 r0;
@@ -0,0 +1,121 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NEBD_SRC_COMMON_READ_MOSTLY_H_
+#define NEBD_SRC_COMMON_READ_MOSTLY_H_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+
+#include "nebd/src/common/uncopyable.h"
+
+namespace nebd {
+namespace common {
+
+/**
+ * 读多写少的数据，读不加锁。
+ * 数据保存两份，读者只读当前生效的一份，并在分散的计数器上登记；
+ * 写者先修改另一份，切换后等待旧的一份上的读者全部离开，再修改旧的一份。
+ * 读操作期间不能阻塞，写操作之间互斥，写操作需要等待读者，只适合修改很少的数据。
+ */
+template <typename T>
+class ReadMostly : public Uncopyable {
+ public:
+    ReadMostly() : index_(0) {}
+
+    /**
+     * @brief 读取数据
+     * @param fn 形如void(const T&)，执行期间不能阻塞，也不能调用Modify
+     */
+    template <typename Fn>
+    void Read(Fn fn) const {
+        int stripe = Stripe();
+        int index = 0;
+        std::atomic<int64_t>* readers = nullptr;
+        while (true) {
+            index = index_.load();
+            readers = &readers_[index][stripe].value;
+            readers->fetch_add(1);
+            // 登记之后再确认没有切换，否则写者可能已经在修改这一份
+            if (index_.load() == index) {
+                break;
+            }
+            readers->fetch_sub(1, std::memory_order_release);
+        }
+
+        fn(data_[index]);
+        readers->fetch_sub(1, std::memory_order_release);
+    }
+
+    /**
+     * @brief 修改数据
+     * @param fn 形如void(T*)，会在两份数据上各执行一次，两次执行的结果必须相同
+     */
+    template <typename Fn>
+    void Modify(Fn fn) {
+        std::lock_guard<std::mutex> lock(modifyMtx_);
+        int index = index_.load(std::memory_order_relaxed);
+        int backup = 1 - index;
+
+        // 上次切换之后可能还有读者短暂地登记在backup上
+        WaitReaders(backup);
+        fn(&data_[backup]);
+
+        index_.store(backup);
+        WaitReaders(index);
+        fn(&data_[index]);
+    }
+
+ private:
+    static const int kStripeNum = 16;
+
+    struct alignas(64) Counter {
+        std::atomic<int64_t> value{0};
+    };
+
+    static int Stripe() {
+        static std::atomic<int> nextStripe{0};
+        static thread_local int stripe =
+            nextStripe.fetch_add(1, std::memory_order_relaxed) % kStripeNum;
+        return stripe;
+    }
+
+    void WaitReaders(int index) const {
+        while (true) {
+            int64_t total = 0;
+            for (int i = 0; i < kStripeNum; ++i) {
+                total += readers_[index][i].value.load();
+            }
+            if (total == 0) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+ private:
+    T data_[2];
+    std::atomic<int> index_;
+    mutable Counter readers_[2][kStripeNum];
+    std::mutex modifyMtx_;
+};
+
+}  // namespace common
+}  // namespace nebd
+
+#endif  // NEBD_SRC_COMMON_READ_MOSTLY_H_
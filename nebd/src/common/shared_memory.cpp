@@ -0,0 +1,365 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "nebd/src/common/shared_memory.h"
+
+#include <fcntl.h>
+#include <glog/logging.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <new>
+
+namespace nebd {
+namespace common {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "futex requires a plain 32 bit word");
+
+namespace {
+
+const uint32_t kShmMagic = 0x6e656264;  // "nebd"
+const uint32_t kShmVersion = 1;
+const size_t kSlotAlignment = 4096;
+
+size_t AlignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// part1重新提交请求时，完成队列中可能还有同一个slot之前的结果，
+// 因此队列容量取slot数的两倍
+uint32_t QueueCapacity(uint32_t slotNum) {
+    uint32_t capacity = 1;
+    while (capacity < 2 * slotNum) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+int Futex(std::atomic<uint32_t>* addr, int op, uint32_t value,
+          const struct timespec* timeout) {
+    // 共享内存上的futex不能使用FUTEX_PRIVATE_FLAG
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), op, value,
+                   timeout, nullptr, 0);
+}
+
+}  // namespace
+
+size_t ShmQueue::MemorySize(uint32_t capacity) {
+    return sizeof(ShmQueue) + sizeof(Cell) * capacity;
+}
+
+ShmQueue* ShmQueue::Format(void* mem, uint32_t capacity) {
+    ShmQueue* queue = new (mem) ShmQueue();
+    queue->enqueuePos_.store(0, std::memory_order_relaxed);
+    queue->dequeuePos_.store(0, std::memory_order_relaxed);
+    queue->notifySeq_.store(0, std::memory_order_relaxed);
+    queue->waiters_.store(0, std::memory_order_relaxed);
+    queue->capacity_ = capacity;
+
+    Cell* cells = queue->Cells();
+    for (uint32_t i = 0; i < capacity; ++i) {
+        new (&cells[i]) Cell();
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    return queue;
+}
+
+bool ShmQueue::Push(const ShmIODesc& desc) {
+    const uint64_t mask = capacity_ - 1;
+    Cell* cell = nullptr;
+    uint64_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    while (true) {
+        cell = &Cells()[pos & mask];
+        uint64_t seq = cell->sequence.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+        if (diff == 0) {
+            if (enqueuePos_.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->desc = desc;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool ShmQueue::Pop(ShmIODesc* desc) {
+    const uint64_t mask = capacity_ - 1;
+    Cell* cell = nullptr;
+    uint64_t pos = dequeuePos_.load(std::memory_order_relaxed);
+    while (true) {
+        cell = &Cells()[pos & mask];
+        uint64_t seq = cell->sequence.load(std::memory_order_acquire);
+        int64_t diff =
+            static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1);
+        if (diff == 0) {
+            if (dequeuePos_.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = dequeuePos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    *desc = cell->desc;
+    cell->sequence.store(pos + mask + 1, std::memory_order_release);
+    return true;
+}
+
+bool ShmQueue::Empty() const {
+    const uint64_t mask = capacity_ - 1;
+    uint64_t pos = dequeuePos_.load(std::memory_order_acquire);
+    return Cells()[pos & mask].sequence.load(std::memory_order_acquire) !=
+           pos + 1;
+}
+
+void ShmQueue::Notify() {
+    notifySeq_.fetch_add(1, std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_seq_cst) > 0) {
+        Futex(&notifySeq_, FUTEX_WAKE, INT_MAX, nullptr);
+    }
+}
+
+void ShmQueue::Wait(uint32_t timeoutMs) {
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+    uint32_t seq = notifySeq_.load(std::memory_order_seq_cst);
+    // 登记之后再检查一次，避免错过在此之前的Notify
+    if (Empty()) {
+        struct timespec timeout;
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_nsec = (timeoutMs % 1000) * 1000000L;
+        Futex(&notifySeq_, FUTEX_WAIT, seq, &timeout);
+    }
+    waiters_.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void ShmQueue::Clear() {
+    ShmIODesc desc;
+    while (Pop(&desc)) {
+    }
+}
+
+struct SharedMemoryRegion::Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotNum;
+    uint32_t slotSize;
+    uint64_t submitOffset;
+    uint64_t completeOffset;
+    uint64_t slotOffset;
+    uint64_t totalSize;
+    std::atomic<uint64_t> serverToken;
+};
+
+SharedMemoryRegion::~SharedMemoryRegion() {
+    Close();
+}
+
+int SharedMemoryRegion::Create(const std::string& name, uint32_t slotNum,
+                               uint32_t slotSize) {
+    if (slotNum == 0 || slotSize == 0) {
+        LOG(ERROR) << "Invalid shared memory option, slot num: " << slotNum
+                   << ", slot size: " << slotSize;
+        return -1;
+    }
+
+    uint32_t capacity = QueueCapacity(slotNum);
+    size_t submitOffset = AlignUp(sizeof(Header), 64);
+    size_t completeOffset =
+        AlignUp(submitOffset + ShmQueue::MemorySize(capacity), 64);
+    size_t slotOffset = AlignUp(
+        completeOffset + ShmQueue::MemorySize(capacity), kSlotAlignment);
+    size_t totalSize =
+        slotOffset + static_cast<size_t>(slotNum) * slotSize;
+
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        // 同名进程异常退出后遗留的共享内存
+        LOG(WARNING) << "Shared memory " << name << " exists, recreate it";
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    }
+    if (fd < 0) {
+        LOG(ERROR) << "Create shared memory " << name
+                   << " failed, error: " << strerror(errno);
+        return -1;
+    }
+
+    if (ftruncate(fd, totalSize) != 0) {
+        LOG(ERROR) << "Truncate shared memory " << name << " to "
+                   << totalSize << " failed, error: " << strerror(errno);
+        close(fd);
+        shm_unlink(name.c_str());
+        return -1;
+    }
+
+    int ret = Map(fd, totalSize);
+    close(fd);
+    if (ret != 0) {
+        shm_unlink(name.c_str());
+        return -1;
+    }
+
+    name_ = name;
+    owner_ = true;
+    header_->slotNum = slotNum;
+    header_->slotSize = slotSize;
+    header_->submitOffset = submitOffset;
+    header_->completeOffset = completeOffset;
+    header_->slotOffset = slotOffset;
+    header_->totalSize = totalSize;
+    header_->serverToken.store(0, std::memory_order_relaxed);
+    ShmQueue::Format(addr_ + submitOffset, capacity);
+    ShmQueue::Format(addr_ + completeOffset, capacity);
+    header_->version = kShmVersion;
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = kShmMagic;
+
+    LOG(INFO) << "Create shared memory " << name << " success, slot num: "
+              << slotNum << ", slot size: " << slotSize
+              << ", total size: " << totalSize;
+    return 0;
+}
+
+int SharedMemoryRegion::Open(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        LOG(ERROR) << "Open shared memory " << name
+                   << " failed, error: " << strerror(errno);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        LOG(ERROR) << "Shared memory " << name << " is too small";
+        close(fd);
+        return -1;
+    }
+
+    int ret = Map(fd, st.st_size);
+    close(fd);
+    if (ret != 0) {
+        return -1;
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header_->magic != kShmMagic || header_->version != kShmVersion ||
+        header_->totalSize != size_) {
+        LOG(ERROR) << "Shared memory " << name << " is invalid, magic: "
+                   << header_->magic << ", version: " << header_->version
+                   << ", total size: " << header_->totalSize
+                   << ", mapped size: " << size_;
+        Close();
+        return -1;
+    }
+
+    // 共享内存由其他进程写入，映射之前检查各部分都在范围之内
+    uint64_t capacity = QueueCapacity(header_->slotNum);
+    uint64_t queueSize = ShmQueue::MemorySize(capacity);
+    if (header_->slotNum == 0 ||
+        header_->submitOffset + queueSize > header_->completeOffset ||
+        header_->completeOffset + queueSize > header_->slotOffset ||
+        header_->slotOffset +
+                static_cast<uint64_t>(header_->slotNum) * header_->slotSize >
+            size_) {
+        LOG(ERROR) << "Shared memory " << name << " layout is invalid";
+        Close();
+        return -1;
+    }
+
+    name_ = name;
+    owner_ = false;
+    return 0;
+}
+
+int SharedMemoryRegion::Map(int fd, size_t size) {
+    void* addr =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        LOG(ERROR) << "Map shared memory failed, size: " << size
+                   << ", error: " << strerror(errno);
+        return -1;
+    }
+
+    addr_ = static_cast<char*>(addr);
+    size_ = size;
+    header_ = reinterpret_cast<Header*>(addr_);
+    return 0;
+}
+
+void SharedMemoryRegion::Close() {
+    if (addr_ != nullptr) {
+        munmap(addr_, size_);
+        addr_ = nullptr;
+        header_ = nullptr;
+        size_ = 0;
+    }
+    if (owner_) {
+        shm_unlink(name_.c_str());
+        owner_ = false;
+    }
+}
+
+ShmQueue* SharedMemoryRegion::SubmitQueue() {
+    return reinterpret_cast<ShmQueue*>(addr_ + header_->submitOffset);
+}
+
+ShmQueue* SharedMemoryRegion::CompleteQueue() {
+    return reinterpret_cast<ShmQueue*>(addr_ + header_->completeOffset);
+}
+
+char* SharedMemoryRegion::Slot(uint32_t index) {
+    return addr_ + header_->slotOffset +
+           static_cast<size_t>(index) * header_->slotSize;
+}
+
+uint32_t SharedMemoryRegion::SlotNum() const {
+    return header_->slotNum;
+}
+
+uint32_t SharedMemoryRegion::SlotSize() const {
+    return header_->slotSize;
+}
+
+uint64_t SharedMemoryRegion::ServerToken() const {
+    return header_->serverToken.load(std::memory_order_acquire);
+}
+
+void SharedMemoryRegion::SetServerToken(uint64_t token) {
+    header_->serverToken.store(token, std::memory_order_release);
+}
+
+}  // namespace common
+}  // namespace nebd
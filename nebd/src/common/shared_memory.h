@@ -0,0 +1,186 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NEBD_SRC_COMMON_SHARED_MEMORY_H_
+#define NEBD_SRC_COMMON_SHARED_MEMORY_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "nebd/src/common/uncopyable.h"
+
+namespace nebd {
+namespace common {
+
+// part1和part2之间通过共享内存传递的IO描述符，数据位于共享内存的slot中
+struct ShmIODesc {
+    // 请求标识，高32位为slot下标，低32位为slot的使用序号
+    uint64_t id;
+    int32_t fd;
+    // 请求类型，即LIBAIO_OP
+    uint32_t op;
+    uint64_t offset;
+    uint64_t length;
+    // 请求的返回值，小于0表示失败
+    int64_t ret;
+};
+
+inline uint64_t ShmDescId(uint32_t slot, uint32_t seq) {
+    return (static_cast<uint64_t>(slot) << 32) | seq;
+}
+
+inline uint32_t ShmDescSlot(uint64_t id) {
+    return id >> 32;
+}
+
+inline uint32_t ShmDescSeq(uint64_t id) {
+    return static_cast<uint32_t>(id);
+}
+
+/**
+ * 位于共享内存中的有界无锁队列，可以被多个进程中的多个线程并发读写。
+ * 队列本身就放在共享内存上，通过Format在调用者分配的内存上初始化。
+ */
+class ShmQueue : public Uncopyable {
+ public:
+    /**
+     * @brief 容量为capacity的队列需要的内存大小
+     */
+    static size_t MemorySize(uint32_t capacity);
+
+    /**
+     * @brief 在mem上初始化一个队列
+     * @param capacity 队列容量，必须是2的幂
+     */
+    static ShmQueue* Format(void* mem, uint32_t capacity);
+
+    /**
+     * @brief 入队，队列满时返回false
+     */
+    bool Push(const ShmIODesc& desc);
+
+    /**
+     * @brief 出队，队列空时返回false
+     */
+    bool Pop(ShmIODesc* desc);
+
+    bool Empty() const;
+
+    /**
+     * @brief 唤醒在Wait中等待的线程，入队之后调用
+     */
+    void Notify();
+
+    /**
+     * @brief 队列为空时等待，直到被Notify唤醒或超时
+     */
+    void Wait(uint32_t timeoutMs);
+
+    /**
+     * @brief 丢弃队列中的所有描述符，只能在没有其他消费者时调用
+     */
+    void Clear();
+
+    uint32_t Capacity() const {
+        return capacity_;
+    }
+
+ private:
+    struct Cell {
+        std::atomic<uint64_t> sequence;
+        ShmIODesc desc;
+    };
+
+    Cell* Cells() {
+        return reinterpret_cast<Cell*>(this + 1);
+    }
+
+    const Cell* Cells() const {
+        return reinterpret_cast<const Cell*>(this + 1);
+    }
+
+ private:
+    alignas(64) std::atomic<uint64_t> enqueuePos_;
+    alignas(64) std::atomic<uint64_t> dequeuePos_;
+    alignas(64) std::atomic<uint32_t> notifySeq_;
+    std::atomic<uint32_t> waiters_;
+    uint32_t capacity_;
+};
+
+/**
+ * part1创建、part2映射的一块共享内存，包含一个提交队列、一个完成队列和
+ * 存放请求数据的slot，每个slot同一时刻只属于一个请求。
+ */
+class SharedMemoryRegion : public Uncopyable {
+ public:
+    SharedMemoryRegion() = default;
+    ~SharedMemoryRegion();
+
+    /**
+     * @brief 创建并初始化共享内存，Close时删除
+     * @param name 共享内存名，形如"/nebd-<pid>"
+     * @return 成功返回0，失败返回-1
+     */
+    int Create(const std::string& name, uint32_t slotNum, uint32_t slotSize);
+
+    /**
+     * @brief 映射其他进程创建的共享内存
+     * @return 成功返回0，失败返回-1
+     */
+    int Open(const std::string& name);
+
+    void Close();
+
+    // part1向part2提交请求的队列
+    ShmQueue* SubmitQueue();
+
+    // part2向part1返回结果的队列
+    ShmQueue* CompleteQueue();
+
+    char* Slot(uint32_t index);
+
+    uint32_t SlotNum() const;
+
+    uint32_t SlotSize() const;
+
+    const std::string& Name() const {
+        return name_;
+    }
+
+    // part2每次重新映射时写入，part1据此发现part2重启
+    uint64_t ServerToken() const;
+
+    void SetServerToken(uint64_t token);
+
+ private:
+    struct Header;
+
+    int Map(int fd, size_t size);
+
+ private:
+    std::string name_;
+    bool owner_ = false;
+    char* addr_ = nullptr;
+    size_t size_ = 0;
+    Header* header_ = nullptr;
+};
+
+}  // namespace common
+}  // namespace nebd
+
+#endif  // NEBD_SRC_COMMON_SHARED_MEMORY_H_
@@ -29,7 +29,10 @@
 #include <glog/logging.h>
 #include <gflags/gflags.h>
 #include <bthread/bthread.h>
+
+#include <algorithm>
 #include <string>
+#include <utility>
 
 #include "nebd/src/part1/async_request_closure.h"
 #include "nebd/src/common/configuration.h"
@@ -109,8 +112,17 @@ int NebdClient::Init(const char* confpath) {
 
     heartbeatMgr_->Run();
 
-    // init rpc send exec-queue
-    rpcTaskQueues_.resize(option_.requestOption.rpcSendExecQueueNum);
+    ret = InitSubmitQueues();
+    if (ret != 0) {
+        LOG(ERROR) << "InitSubmitQueues failed";
+        return -1;
+    }
+
+    // init rpc send exec-queue, 每个提交队列的执行队列个数相同
+    uint32_t queueNum = submitQueues_.size();
+    uint32_t execNum = std::max(option_.requestOption.rpcSendExecQueueNum,
+                                queueNum);
+    rpcTaskQueues_.resize((execNum + queueNum - 1) / queueNum * queueNum);
     for (auto& q : rpcTaskQueues_) {
         int rc = bthread::execution_queue_start(
             &q, nullptr, &NebdClient::ExecAsyncRpcTask, this);
@@ -128,6 +140,12 @@ void NebdClient::Uninit() {
         heartbeatMgr_->Stop();
     }
 
+    for (auto& queue : submitQueues_) {
+        if (queue->shmTransport != nullptr) {
+            queue->shmTransport->Fini();
+        }
+    }
+
     // stop exec queue
     for (auto& q : rpcTaskQueues_) {
         bthread::execution_queue_stop(q);
@@ -359,8 +377,11 @@ int64_t NebdClient::GetBlockSize(int fd) {
 }
 
 int NebdClient::Discard(int fd, NebdClientAioContext* aioctx) {
-    auto task = [this, fd, aioctx]() {
-        nebd::client::NebdFileService_Stub stub(&channel_);
+    uint32_t queueIndex = GetSubmitQueueIndex();
+    SubmitQueue* queue = submitQueues_[queueIndex].get();
+
+    auto task = [this, fd, aioctx, queue]() {
+        nebd::client::NebdFileService_Stub stub(&queue->channel);
         nebd::client::DiscardRequest request;
         request.set_fd(fd);
         request.set_offset(aioctx->offset);
@@ -373,14 +394,21 @@ int NebdClient::Discard(int fd, NebdClientAioContext* aioctx) {
         stub.Discard(&done->cntl, &request, &done->response, done);
     };
 
-    PushAsyncTask(task);
+    PushAsyncTask(queueIndex, task);
 
     return 0;
 }
 
 int NebdClient::AioRead(int fd, NebdClientAioContext* aioctx) {
-    auto task = [this, fd, aioctx]() {
-        nebd::client::NebdFileService_Stub stub(&channel_);
+    uint32_t queueIndex = GetSubmitQueueIndex();
+    SubmitQueue* queue = submitQueues_[queueIndex].get();
+    if (queue->shmTransport != nullptr &&
+        queue->shmTransport->Submit(fd, aioctx)) {
+        return 0;
+    }
+
+    auto task = [this, fd, aioctx, queue]() {
+        nebd::client::NebdFileService_Stub stub(&queue->channel);
         nebd::client::ReadRequest request;
         request.set_fd(fd);
         request.set_offset(aioctx->offset);
@@ -393,7 +421,7 @@ int NebdClient::AioRead(int fd, NebdClientAioContext* aioctx) {
         stub.Read(&done->cntl, &request, &done->response, done);
     };
 
-    PushAsyncTask(task);
+    PushAsyncTask(queueIndex, task);
 
     return 0;
 }
@@ -403,8 +431,15 @@ static void EmptyDeleter(void* m) {
 }
 
 int NebdClient::AioWrite(int fd, NebdClientAioContext* aioctx) {
-    auto task = [this, fd, aioctx]() {
-        nebd::client::NebdFileService_Stub stub(&channel_);
+    uint32_t queueIndex = GetSubmitQueueIndex();
+    SubmitQueue* queue = submitQueues_[queueIndex].get();
+    if (queue->shmTransport != nullptr &&
+        queue->shmTransport->Submit(fd, aioctx)) {
+        return 0;
+    }
+
+    auto task = [this, fd, aioctx, queue]() {
+        nebd::client::NebdFileService_Stub stub(&queue->channel);
         nebd::client::WriteRequest request;
         request.set_fd(fd);
         request.set_offset(aioctx->offset);
@@ -420,14 +455,17 @@ int NebdClient::AioWrite(int fd, NebdClientAioContext* aioctx) {
         stub.Write(&done->cntl, &request, &done->response, done);
     };
 
-    PushAsyncTask(task);
+    PushAsyncTask(queueIndex, task);
 
     return 0;
 }
 
 int NebdClient::Flush(int fd, NebdClientAioContext* aioctx) {
-    auto task = [this, fd, aioctx]() {
-        nebd::client::NebdFileService_Stub stub(&channel_);
+    uint32_t queueIndex = GetSubmitQueueIndex();
+    SubmitQueue* queue = submitQueues_[queueIndex].get();
+
+    auto task = [this, fd, aioctx, queue]() {
+        nebd::client::NebdFileService_Stub stub(&queue->channel);
         nebd::client::FlushRequest request;
         request.set_fd(fd);
 
@@ -438,7 +476,7 @@ int NebdClient::Flush(int fd, NebdClientAioContext* aioctx) {
         stub.Flush(&done->cntl, &request, &done->response, done);
     };
 
-    PushAsyncTask(task);
+    PushAsyncTask(queueIndex, task);
 
     return 0;
 }
@@ -570,15 +608,52 @@ int NebdClient::InitNebdClientOption(Configuration* conf) {
            "value is "
         << requestOption.rpcSendExecQueueNum;
 
+    ret = conf->GetUInt32Value("request.submitQueueNum",
+                               &requestOption.submitQueueNum);
+    LOG_IF(WARNING, ret != true)
+        << "Load request.submitQueueNum from config file failed, current "
+           "value is "
+        << requestOption.submitQueueNum;
+    requestOption.submitQueueNum =
+        std::max(requestOption.submitQueueNum, 1u);
+
     option_.requestOption = requestOption;
 
     ret = conf->GetStringValue("log.path", &option_.logOption.logPath);
     LOG_IF(ERROR, ret != true) << "Load log.path failed";
     RETURN_IF_FALSE(ret);
 
+    InitShmOption(conf, &option_.shmOption);
+
     return 0;
 }
 
+void NebdClient::InitShmOption(Configuration* conf, ShmOption* shmOption) {
+    bool ret = conf->GetBoolValue("shm.enable", &shmOption->enable);
+    LOG_IF(WARNING, ret != true)
+        << "Load shm.enable failed, current value is " << shmOption->enable;
+
+    ret = conf->GetUInt32Value("shm.slotNum", &shmOption->slotNum);
+    LOG_IF(WARNING, ret != true)
+        << "Load shm.slotNum failed, current value is " << shmOption->slotNum;
+
+    ret = conf->GetUInt32Value("shm.slotSize", &shmOption->slotSize);
+    LOG_IF(WARNING, ret != true)
+        << "Load shm.slotSize failed, current value is "
+        << shmOption->slotSize;
+
+    ret = conf->GetUInt32Value("shm.pollSpinUs", &shmOption->pollSpinUs);
+    LOG_IF(WARNING, ret != true)
+        << "Load shm.pollSpinUs failed, current value is "
+        << shmOption->pollSpinUs;
+
+    ret = conf->GetUInt32Value("shm.checkTimeoutMs",
+                               &shmOption->checkTimeoutMs);
+    LOG_IF(WARNING, ret != true)
+        << "Load shm.checkTimeoutMs failed, current value is "
+        << shmOption->checkTimeoutMs;
+}
+
 int NebdClient::InitHeartBeatOption(Configuration* conf,
                                     HeartbeatOption* heartbeatOption) {
     bool ret = conf->GetInt64Value("heartbeat.intervalS",
@@ -615,6 +690,46 @@ int NebdClient::InitChannel() {
     return 0;
 }
 
+int NebdClient::InitSubmitQueues() {
+    uint32_t queueNum = option_.requestOption.submitQueueNum;
+    submitQueues_.clear();
+    for (uint32_t i = 0; i < queueNum; ++i) {
+        std::unique_ptr<SubmitQueue> queue(new SubmitQueue());
+
+        // 不同提交队列使用不同的连接，第一个队列与同步rpc共用连接
+        brpc::ChannelOptions options;
+        if (i > 0) {
+            options.connection_group = "submit-queue-" + std::to_string(i);
+        }
+        int ret = queue->channel.InitWithSockFile(
+            option_.serverAddress.c_str(), &options);
+        if (ret != 0) {
+            LOG(ERROR) << "Init submit queue channel failed, socket addr = "
+                       << option_.serverAddress << ", queue = " << i;
+            submitQueues_.clear();
+            return -1;
+        }
+
+        if (option_.shmOption.enable) {
+            std::string name = "/nebd-" + std::to_string(getpid()) + "-" +
+                               std::to_string(i);
+            queue->shmTransport.reset(new ShmTransport());
+            ret = queue->shmTransport->Init(name, option_.shmOption,
+                                            &queue->channel);
+            if (ret != 0) {
+                LOG(WARNING) << "Init shared memory transport failed, "
+                             << "read and write through rpc, queue = " << i;
+                queue->shmTransport.reset();
+            }
+        }
+
+        submitQueues_.push_back(std::move(queue));
+    }
+
+    LOG(INFO) << "Init " << queueNum << " submit queues success";
+    return 0;
+}
+
 int64_t NebdClient::ExecuteSyncRpc(RpcTask task) {
     int64_t retryTimes = 0;
     int64_t ret = 0;
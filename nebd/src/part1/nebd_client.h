@@ -37,6 +37,7 @@
 #include "nebd/src/part1/libnebd.h"
 #include "nebd/src/part1/heartbeat_manager.h"
 #include "nebd/src/part1/nebd_metacache.h"
+#include "nebd/src/part1/shm_transport.h"
 
 #include "include/curve_compiler_specific.h"
 
@@ -154,8 +155,12 @@ class NebdClient {
     int InitHeartBeatOption(Configuration* conf,
                             HeartbeatOption* hearbeatOption);
 
+    void InitShmOption(Configuration* conf, ShmOption* shmOption);
+
     int InitChannel();
 
+    int InitSubmitQueues();
+
     void InitLogger(const LogOption& logOption);
 
     /**
@@ -178,6 +183,28 @@ class NebdClient {
 
     std::atomic<uint64_t> logId_{1};
 
+ private:
+    // 读写请求的提交队列，每个队列有独立的连接和共享内存，
+    // 同一个线程（如qemu的iothread）提交的请求总是进入同一个队列
+    struct SubmitQueue {
+        brpc::Channel channel;
+        // 共享内存数据通道，未开启时为空
+        std::unique_ptr<ShmTransport> shmTransport;
+    };
+
+    std::vector<std::unique_ptr<SubmitQueue>> submitQueues_;
+
+    std::atomic<uint32_t> nextSubmitQueue_{0};
+
+    /**
+     * @brief 获取当前线程使用的提交队列下标
+     */
+    uint32_t GetSubmitQueueIndex() {
+        static thread_local uint32_t seq = nextSubmitQueue_.fetch_add(
+            1, std::memory_order_relaxed);
+        return seq % submitQueues_.size();
+    }
+
  private:
     using AsyncRpcTask = std::function<void()>;
 
@@ -185,10 +212,13 @@ class NebdClient {
 
     static int ExecAsyncRpcTask(void* meta, bthread::TaskIterator<AsyncRpcTask>& iter);  // NOLINT
 
-    void PushAsyncTask(const AsyncRpcTask& task) {
+    // 提交队列i的rpc由下标为i, i+n, i+2n...的执行队列发送，n为提交队列个数
+    void PushAsyncTask(uint32_t queueIndex, const AsyncRpcTask& task) {
         static thread_local unsigned int seed = time(nullptr);
 
-        int idx = rand_r(&seed) % rpcTaskQueues_.size();
+        uint32_t queueNum = submitQueues_.size();
+        uint32_t execNum = rpcTaskQueues_.size() / queueNum;
+        int idx = queueIndex + (rand_r(&seed) % execNum) * queueNum;
         int rc = bthread::execution_queue_execute(rpcTaskQueues_[idx], task);
 
         if (CURVE_UNLIKELY(rc != 0)) {
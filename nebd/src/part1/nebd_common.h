@@ -41,6 +41,22 @@ struct RequestOption {
     int64_t rpcMaxDelayHealthCheckIntervalMs;
     // rpc发送执行队列个数
     uint32_t rpcSendExecQueueNum = 2;
+    // 读写请求提交队列个数，每个队列使用独立的连接和共享内存
+    uint32_t submitQueueNum = 1;
+};
+
+// 共享内存数据通道配置项
+struct ShmOption {
+    // 是否通过共享内存向part2提交读写请求
+    bool enable = false;
+    // slot个数，即通过共享内存同时进行的请求数，超过的走rpc
+    uint32_t slotNum = 128;
+    // slot大小，超过的请求走rpc
+    uint32_t slotSize = 256 * 1024;
+    // 完成队列为空时忙等的时间
+    uint32_t pollSpinUs = 50;
+    // 请求超过该时间没有返回时检查part2是否重启
+    uint32_t checkTimeoutMs = 3000;
 };
 
 // 日志配置项
@@ -59,6 +75,8 @@ struct NebdClientOption {
     RequestOption requestOption;
     // 日志配置项
     LogOption logOption;
+    // 共享内存数据通道配置项
+    ShmOption shmOption;
 };
 
 // heartbeat配置项
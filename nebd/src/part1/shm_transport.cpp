@@ -0,0 +1,304 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "nebd/src/part1/shm_transport.h"
+
+#include <brpc/controller.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "nebd/proto/client.pb.h"
+#include "nebd/src/common/timeutility.h"
+
+namespace nebd {
+namespace client {
+
+using nebd::common::ShmDescId;
+using nebd::common::ShmDescSeq;
+using nebd::common::ShmDescSlot;
+using nebd::common::ShmQueue;
+using nebd::common::TimeUtility;
+using nebd::common::WriteLockGuard;
+
+namespace {
+
+const uint32_t kPollWaitMs = 100;
+
+}  // namespace
+
+ShmTransport::~ShmTransport() {
+    Fini();
+}
+
+int ShmTransport::Init(const std::string& name, const ShmOption& option,
+                       brpc::Channel* channel) {
+    option_ = option;
+    channel_ = channel;
+
+    if (region_.Create(name, option_.slotNum, option_.slotSize) != 0) {
+        LOG(ERROR) << "Create shared memory failed, name: " << name;
+        return -1;
+    }
+
+    if (Attach(&serverToken_) != 0) {
+        region_.Close();
+        return -1;
+    }
+
+    slots_.resize(option_.slotNum);
+    freeSlots_.reserve(option_.slotNum);
+    for (uint32_t slot = option_.slotNum; slot > 0; --slot) {
+        freeSlots_.push_back(slot - 1);
+    }
+
+    running_.store(true);
+    pollThread_ = std::thread(&ShmTransport::PollCompletion, this);
+    LOG(INFO) << "Init shared memory transport success, name: " << name
+              << ", slot num: " << option_.slotNum
+              << ", slot size: " << option_.slotSize;
+    return 0;
+}
+
+void ShmTransport::Fini() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    region_.CompleteQueue()->Notify();
+    pollThread_.join();
+    Detach();
+    region_.Close();
+    LOG(INFO) << "Shared memory transport stopped";
+}
+
+bool ShmTransport::Submit(int fd, NebdClientAioContext* aioctx) {
+    if (!running_.load(std::memory_order_relaxed) ||
+        (aioctx->op != LIBAIO_OP::LIBAIO_OP_READ &&
+         aioctx->op != LIBAIO_OP::LIBAIO_OP_WRITE) ||
+        aioctx->length > option_.slotSize) {
+        return false;
+    }
+
+    // 正在向重启后的part2重新提交请求，先走rpc
+    if (submitLock_.TryRDLock() != 0) {
+        return false;
+    }
+
+    uint32_t slot = 0;
+    SlotState state;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (freeSlots_.empty()) {
+            submitLock_.Unlock();
+            return false;
+        }
+        slot = freeSlots_.back();
+        freeSlots_.pop_back();
+
+        SlotState& s = slots_[slot];
+        s.aioctx = aioctx;
+        s.fd = fd;
+        s.seq++;
+        s.submitMs = TimeUtility::GetTimeofDayMs();
+        state = s;
+    }
+
+    if (aioctx->op == LIBAIO_OP::LIBAIO_OP_WRITE) {
+        memcpy(region_.Slot(slot), aioctx->buf, aioctx->length);
+    }
+
+    bool pushed = Push(slot, state);
+    submitLock_.Unlock();
+    if (!pushed) {
+        std::lock_guard<std::mutex> lk(mtx_);
+        slots_[slot].aioctx = nullptr;
+        freeSlots_.push_back(slot);
+    }
+    return pushed;
+}
+
+bool ShmTransport::Push(uint32_t slot, const SlotState& state) {
+    ShmIODesc desc;
+    desc.id = ShmDescId(slot, state.seq);
+    desc.fd = state.fd;
+    desc.op = state.aioctx->op;
+    desc.offset = state.aioctx->offset;
+    desc.length = state.aioctx->length;
+    desc.ret = 0;
+
+    ShmQueue* queue = region_.SubmitQueue();
+    if (!queue->Push(desc)) {
+        LOG(ERROR) << "Shared memory submit queue is full, slot: " << slot;
+        return false;
+    }
+    queue->Notify();
+    return true;
+}
+
+void ShmTransport::PollCompletion() {
+    ShmQueue* queue = region_.CompleteQueue();
+    uint64_t lastCheckMs = TimeUtility::GetTimeofDayMs();
+    ShmIODesc desc;
+    while (running_.load(std::memory_order_relaxed)) {
+        if (queue->Pop(&desc)) {
+            OnComplete(desc);
+            continue;
+        }
+
+        uint64_t spinUntil =
+            TimeUtility::GetTimeofDayUs() + option_.pollSpinUs;
+        while (queue->Empty() && TimeUtility::GetTimeofDayUs() < spinUntil) {
+            std::this_thread::yield();
+        }
+        if (queue->Empty()) {
+            queue->Wait(std::min(kPollWaitMs, option_.checkTimeoutMs));
+        }
+
+        uint64_t now = TimeUtility::GetTimeofDayMs();
+        if (now - lastCheckMs >= option_.checkTimeoutMs) {
+            CheckServer();
+            lastCheckMs = now;
+        }
+    }
+}
+
+void ShmTransport::OnComplete(const ShmIODesc& desc) {
+    uint32_t slot = ShmDescSlot(desc.id);
+    NebdClientAioContext* aioctx = nullptr;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (slot >= slots_.size() || slots_[slot].aioctx == nullptr ||
+            slots_[slot].seq != ShmDescSeq(desc.id)) {
+            // 重新提交之前的请求的结果
+            return;
+        }
+        aioctx = slots_[slot].aioctx;
+        slots_[slot].aioctx = nullptr;
+    }
+
+    if (desc.ret >= 0 && aioctx->op == LIBAIO_OP::LIBAIO_OP_READ) {
+        memcpy(aioctx->buf, region_.Slot(slot), aioctx->length);
+    }
+    ReleaseSlot(slot);
+
+    if (desc.ret < 0) {
+        LOG(ERROR) << "Shared memory request failed, fd = " << desc.fd
+                   << ", op = " << aioctx->op
+                   << ", offset = " << aioctx->offset
+                   << ", length = " << aioctx->length;
+        aioctx->ret = -1;
+    } else {
+        aioctx->ret = 0;
+    }
+    aioctx->cb(aioctx);
+}
+
+void ShmTransport::ReleaseSlot(uint32_t slot) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    freeSlots_.push_back(slot);
+}
+
+void ShmTransport::CheckServer() {
+    uint64_t now = TimeUtility::GetTimeofDayMs();
+    bool timeout = false;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        for (const auto& state : slots_) {
+            if (state.aioctx != nullptr &&
+                now - state.submitMs >= option_.checkTimeoutMs) {
+                timeout = true;
+                break;
+            }
+        }
+    }
+    if (!timeout) {
+        return;
+    }
+
+    WriteLockGuard guard(submitLock_);
+    uint64_t token = 0;
+    if (Attach(&token) != 0 || token == serverToken_) {
+        return;
+    }
+
+    // part2重启了，之前提交的请求已经丢失
+    std::vector<std::pair<uint32_t, SlotState>> inflight;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        for (uint32_t slot = 0; slot < slots_.size(); ++slot) {
+            SlotState& state = slots_[slot];
+            if (state.aioctx != nullptr) {
+                state.seq++;
+                state.submitMs = now;
+                inflight.emplace_back(slot, state);
+            }
+        }
+    }
+
+    LOG(WARNING) << "nebd-server restarted, resubmit " << inflight.size()
+                 << " requests through shared memory";
+    serverToken_ = token;
+    for (const auto& request : inflight) {
+        Push(request.first, request.second);
+    }
+}
+
+int ShmTransport::Attach(uint64_t* token) {
+    NebdFileService_Stub stub(channel_);
+    AttachSharedMemoryRequest request;
+    AttachSharedMemoryResponse response;
+    brpc::Controller cntl;
+    cntl.set_timeout_ms(option_.checkTimeoutMs);
+
+    request.set_name(region_.Name());
+    stub.AttachSharedMemory(&cntl, &request, &response, nullptr);
+    if (cntl.Failed()) {
+        LOG(WARNING) << "AttachSharedMemory rpc failed, error = "
+                     << cntl.ErrorText() << ", name = " << region_.Name();
+        return -1;
+    }
+    if (response.retcode() != RetCode::kOK) {
+        LOG(ERROR) << "AttachSharedMemory failed, "
+                   << "retcode = " << response.retcode()
+                   << ",  retmsg = " << response.retmsg()
+                   << ", name = " << region_.Name();
+        return -1;
+    }
+
+    *token = response.servertoken();
+    return 0;
+}
+
+void ShmTransport::Detach() {
+    NebdFileService_Stub stub(channel_);
+    DetachSharedMemoryRequest request;
+    DetachSharedMemoryResponse response;
+    brpc::Controller cntl;
+    cntl.set_timeout_ms(option_.checkTimeoutMs);
+
+    request.set_name(region_.Name());
+    stub.DetachSharedMemory(&cntl, &request, &response, nullptr);
+    if (cntl.Failed() || response.retcode() != RetCode::kOK) {
+        LOG(WARNING) << "DetachSharedMemory failed, name = "
+                     << region_.Name();
+    }
+}
+
+}  // namespace client
+}  // namespace nebd
@@ -0,0 +1,111 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NEBD_SRC_PART1_SHM_TRANSPORT_H_
+#define NEBD_SRC_PART1_SHM_TRANSPORT_H_
+
+#include <brpc/channel.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "nebd/src/common/rw_lock.h"
+#include "nebd/src/common/shared_memory.h"
+#include "nebd/src/part1/libnebd.h"
+#include "nebd/src/part1/nebd_common.h"
+
+namespace nebd {
+namespace client {
+
+using nebd::common::ShmIODesc;
+
+/**
+ * 通过共享内存向part2提交读写请求。
+ * 请求的数据放在共享内存的slot中，描述符通过共享内存上的队列传递，
+ * 省去了rpc的序列化、数据拷贝和unix socket的系统调用；
+ * 共享内存的建立和其他请求仍然走rpc。
+ */
+class ShmTransport {
+ public:
+    ShmTransport() = default;
+    ~ShmTransport();
+
+    /**
+     * @brief 创建共享内存并通知part2映射
+     * @param name 共享内存名，同一进程的不同提交队列使用不同的名字
+     * @return 成功返回0，失败返回-1
+     */
+    int Init(const std::string& name, const ShmOption& option,
+             brpc::Channel* channel);
+
+    void Fini();
+
+    /**
+     * @brief 通过共享内存提交读写请求
+     * @return 请求已提交返回true，返回false时调用者应走rpc
+     */
+    bool Submit(int fd, NebdClientAioContext* aioctx);
+
+ private:
+    struct SlotState {
+        NebdClientAioContext* aioctx = nullptr;
+        int fd = -1;
+        // slot每被使用一次加一，用来识别过期的结果
+        uint32_t seq = 0;
+        uint64_t submitMs = 0;
+    };
+
+    // 通知part2映射共享内存，返回part2的标识
+    int Attach(uint64_t* token);
+
+    void Detach();
+
+    bool Push(uint32_t slot, const SlotState& state);
+
+    void ReleaseSlot(uint32_t slot);
+
+    // 处理完成队列中的结果
+    void PollCompletion();
+
+    void OnComplete(const ShmIODesc& desc);
+
+    // 有请求长时间没有返回时，检查part2是否重启，重启后重新提交请求
+    void CheckServer();
+
+ private:
+    ShmOption option_;
+    brpc::Channel* channel_ = nullptr;
+    nebd::common::SharedMemoryRegion region_;
+
+    std::mutex mtx_;
+    std::vector<SlotState> slots_;
+    std::vector<uint32_t> freeSlots_;
+
+    // 重新提交请求时加写锁，提交请求时加读锁
+    nebd::common::RWLock submitLock_;
+    uint64_t serverToken_ = 0;
+
+    std::atomic<bool> running_{false};
+    std::thread pollThread_;
+};
+
+}  // namespace client
+}  // namespace nebd
+
+#endif  // NEBD_SRC_PART1_SHM_TRANSPORT_H_
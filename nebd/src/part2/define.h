@@ -124,6 +124,9 @@ const char HEARTBEATTIMEOUTSEC[] = "heartbeat.timeout.sec";
 const char HEARTBEATCHECKINTERVALMS[] = "heartbeat.check.interval.ms";
 const char CURVECLIENTCONFPATH[] = "curveclient.confPath";
 const char RESPONSERETURNRPCWHENIOERROR[] = "response.returnRpcWhenIoError";
+const char COMBINEWINDOWUS[] = "combine.windowUs";
+const char COMBINEMAXBYTES[] = "combine.maxBytes";
+const char COMBINEMAXREQUESTS[] = "combine.maxRequests";
 
 }  // namespace server
 }  // namespace nebd
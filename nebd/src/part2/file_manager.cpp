@@ -56,7 +56,10 @@ int NebdFileManager::Run() {
 
 int NebdFileManager::Fini() {
     isRunning_.store(false);
-    fileMap_.clear();
+    {
+        std::lock_guard<std::mutex> lock(mapMtx_);
+        fileMap_.Modify([](FileEntityMap* map) { map->clear(); });
+    }
     LOG(INFO) << "Stop file manager success.";
     return 0;
 }
@@ -176,19 +179,21 @@ int NebdFileManager::InvalidCache(int fd) {
 
 NebdFileEntityPtr
 NebdFileManager::GetFileEntity(int fd) {
-    ReadLockGuard readLock(rwLock_);
-    auto iter = fileMap_.find(fd);
-    if (iter == fileMap_.end()) {
-        return nullptr;
-    }
-    return iter->second;
+    NebdFileEntityPtr entity;
+    fileMap_.Read([&](const FileEntityMap& map) {
+        auto iter = map.find(fd);
+        if (iter != map.end()) {
+            entity = iter->second;
+        }
+    });
+    return entity;
 }
 
 int NebdFileManager::GenerateValidFd() {
     int fd = 0;
     while (true) {
         fd = fdAlloc_.GetNext();
-        if (fileMap_.find(fd) == fileMap_.end()) {
+        if (GetFileEntity(fd) == nullptr) {
             break;
         }
     }
@@ -197,36 +202,49 @@ int NebdFileManager::GenerateValidFd() {
 
 NebdFileEntityPtr NebdFileManager::GetOrCreateFileEntity(
     const std::string& fileName) {
-    {
-        ReadLockGuard readLock(rwLock_);
-        for (const auto& pair : fileMap_) {
-            std::string curFile = pair.second->GetFileName();
-            if (fileName == curFile) {
-                return pair.second;
-            }
-        }
+    std::lock_guard<std::mutex> lock(mapMtx_);
+    NebdFileEntityPtr entity = FindFileEntity(fileName);
+    if (entity != nullptr) {
+        return entity;
     }
 
     int fd = GenerateValidFd();
-    return GenerateFileEntity(fd, fileName);
+    return CreateFileEntity(fd, fileName);
 }
 
 NebdFileEntityPtr NebdFileManager::GenerateFileEntity(
     int fd, const std::string& fileName) {
-    WriteLockGuard writeLock(rwLock_);
-    for (const auto& pair : fileMap_) {
-        std::string curFile = pair.second->GetFileName();
-        if (fileName == curFile) {
-            return pair.second;
-        }
+    std::lock_guard<std::mutex> lock(mapMtx_);
+    NebdFileEntityPtr entity = FindFileEntity(fileName);
+    if (entity != nullptr) {
+        return entity;
     }
 
+    return CreateFileEntity(fd, fileName);
+}
+
+NebdFileEntityPtr NebdFileManager::FindFileEntity(
+    const std::string& fileName) {
+    NebdFileEntityPtr entity;
+    fileMap_.Read([&](const FileEntityMap& map) {
+        for (const auto& pair : map) {
+            if (pair.second->GetFileName() == fileName) {
+                entity = pair.second;
+                return;
+            }
+        }
+    });
+    return entity;
+}
+
+NebdFileEntityPtr NebdFileManager::CreateFileEntity(
+    int fd, const std::string& fileName) {
     // 检测是否存在冲突的文件记录
-    auto iter = fileMap_.find(fd);
-    if (iter != fileMap_.end()) {
+    NebdFileEntityPtr exist = GetFileEntity(fd);
+    if (exist != nullptr) {
         LOG(ERROR) << "File entity conflict. "
-                   << "Exist filename: " << iter->second->GetFileName()
-                   << ", Exist fd: " << iter->first
+                   << "Exist filename: " << exist->GetFileName()
+                   << ", Exist fd: " << fd
                    << ", Create filename: " << fileName
                    << ", Create fd: " << fd;
         return nullptr;
@@ -242,28 +260,26 @@ NebdFileEntityPtr NebdFileManager::GenerateFileEntity(
         LOG(ERROR) << "Generate file entity failed.";
         return nullptr;
     }
-    fileMap_.emplace(fd, entity);
+    fileMap_.Modify([&](FileEntityMap* map) { map->emplace(fd, entity); });
     return entity;
 }
 
 void NebdFileManager::RemoveEntity(int fd) {
-    WriteLockGuard writeLock(rwLock_);
-    auto iter = fileMap_.find(fd);
-    if (iter != fileMap_.end()) {
-        fileMap_.erase(iter);
-    }
+    std::lock_guard<std::mutex> lock(mapMtx_);
+    fileMap_.Modify([fd](FileEntityMap* map) { map->erase(fd); });
 }
 
 FileEntityMap NebdFileManager::GetFileEntityMap() {
-    ReadLockGuard readLock(rwLock_);
-    return fileMap_;
+    FileEntityMap map;
+    fileMap_.Read([&](const FileEntityMap& current) { map = current; });
+    return map;
 }
 
 std::string NebdFileManager::DumpAllFileStatus() {
-    ReadLockGuard readLock(rwLock_);
+    FileEntityMap map = GetFileEntityMap();
     std::ostringstream os;
     os << "{";
-    for (const auto& pair : fileMap_) {
+    for (const auto& pair : map) {
         os << *(pair.second);
     }
     os << "}";
@@ -33,6 +33,7 @@
 
 #include "nebd/src/common/rw_lock.h"
 #include "nebd/src/common/name_lock.h"
+#include "nebd/src/common/read_mostly.h"
 #include "nebd/src/part2/define.h"
 #include "nebd/src/part2/util.h"
 #include "nebd/src/part2/file_entity.h"
@@ -46,6 +47,7 @@ using nebd::common::NameLock;
 using nebd::common::NameLockGuard;
 using nebd::common::WriteLockGuard;
 using nebd::common::ReadLockGuard;
+using nebd::common::ReadMostly;
 using OpenFlags = nebd::client::ProtoOpenFlags;
 
 using FileEntityMap = std::unordered_map<int, NebdFileEntityPtr>;
@@ -152,6 +154,11 @@ class NebdFileManager {
     // 如果fd对于的entity已存在,直接返回entity指针
     // 如果entity不存在，则生成新的entity，并插入map，然后返回
     NebdFileEntityPtr GenerateFileEntity(int fd, const std::string& fileName);
+    // 以下两个函数需要持有mapMtx_
+    // 根据文件名查找entity，不存在返回nullptr
+    NebdFileEntityPtr FindFileEntity(const std::string& fileName);
+    // 生成新的entity并插入map
+    NebdFileEntityPtr CreateFileEntity(int fd, const std::string& fileName);
     // 删除指定fd对应的entity
     void RemoveEntity(int fd);
 
@@ -164,10 +171,10 @@ class NebdFileManager {
     FdAllocator fdAlloc_;
     // nebd server 文件记录管理
     MetaFileManagerPtr metaFileManager_;
-    // file map 读写保护锁
-    RWLock rwLock_;
+    // 串行化对file map的修改，读写请求查找文件时不加锁
+    std::mutex mapMtx_;
     // 文件fd和文件实体的映射
-    FileEntityMap fileMap_;
+    ReadMostly<FileEntityMap> fileMap_;
 };
 using NebdFileManagerPtr = std::shared_ptr<NebdFileManager>;
 
@@ -364,5 +364,48 @@ void NebdFileServiceImpl::InvalidateCache(
     }
 }
 
+void NebdFileServiceImpl::AttachSharedMemory(
+    google::protobuf::RpcController* cntl_base,
+    const nebd::client::AttachSharedMemoryRequest* request,
+    nebd::client::AttachSharedMemoryResponse* response,
+    google::protobuf::Closure* done) {
+    (void)cntl_base;
+    brpc::ClosureGuard doneGuard(done);
+    response->set_retcode(RetCode::kNoOK);
+
+    if (shmServer_ == nullptr) {
+        response->set_retmsg("shared memory is not supported");
+        return;
+    }
+
+    uint64_t token = 0;
+    int rc = shmServer_->Attach(request->name(), &token);
+    if (rc < 0) {
+        LOG(ERROR) << "Attach shared memory failed. "
+                   << "name: " << request->name();
+    } else {
+        response->set_retcode(RetCode::kOK);
+        response->set_servertoken(token);
+    }
+}
+
+void NebdFileServiceImpl::DetachSharedMemory(
+    google::protobuf::RpcController* cntl_base,
+    const nebd::client::DetachSharedMemoryRequest* request,
+    nebd::client::DetachSharedMemoryResponse* response,
+    google::protobuf::Closure* done) {
+    (void)cntl_base;
+    brpc::ClosureGuard doneGuard(done);
+    response->set_retcode(RetCode::kNoOK);
+
+    if (shmServer_ == nullptr) {
+        response->set_retmsg("shared memory is not supported");
+        return;
+    }
+
+    shmServer_->Detach(request->name());
+    response->set_retcode(RetCode::kOK);
+}
+
 }  // namespace server
 }  // namespace nebd
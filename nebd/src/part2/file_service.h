@@ -31,6 +31,7 @@
 
 #include "nebd/proto/client.pb.h"
 #include "nebd/src/part2/file_manager.h"
+#include "nebd/src/part2/shm_server.h"
 
 namespace nebd {
 namespace server {
@@ -40,9 +41,12 @@ void NebdFileServiceCallback(NebdServerAioContext* context);
 class NebdFileServiceImpl : public nebd::client::NebdFileService {
  public:
     explicit NebdFileServiceImpl(std::shared_ptr<NebdFileManager> fileManager,
-                                 const bool returnRpcWhenIoError)
+                                 const bool returnRpcWhenIoError,
+                                 std::shared_ptr<NebdShmServer> shmServer =
+                                     nullptr)
                                  : fileManager_(fileManager),
-                                 returnRpcWhenIoError_(returnRpcWhenIoError) {}
+                                 returnRpcWhenIoError_(returnRpcWhenIoError),
+                                 shmServer_(shmServer) {}
 
     virtual ~NebdFileServiceImpl() {}
 
@@ -91,9 +95,23 @@ class NebdFileServiceImpl : public nebd::client::NebdFileService {
                             nebd::client::InvalidateCacheResponse* response,
                             google::protobuf::Closure* done);
 
+    virtual void AttachSharedMemory(
+        google::protobuf::RpcController* cntl_base,
+        const nebd::client::AttachSharedMemoryRequest* request,
+        nebd::client::AttachSharedMemoryResponse* response,
+        google::protobuf::Closure* done);
+
+    virtual void DetachSharedMemory(
+        google::protobuf::RpcController* cntl_base,
+        const nebd::client::DetachSharedMemoryRequest* request,
+        nebd::client::DetachSharedMemoryResponse* response,
+        google::protobuf::Closure* done);
+
  private:
     std::shared_ptr<NebdFileManager> fileManager_;
     const bool returnRpcWhenIoError_;
+    // 处理共享内存上的读写请求，为空时不支持
+    std::shared_ptr<NebdShmServer> shmServer_;
 };
 
 }  // namespace server
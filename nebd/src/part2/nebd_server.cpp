@@ -95,6 +95,10 @@ int NebdServer::Fini() {
         brpc::AskToQuit();
     }
 
+    if (shmServer_ != nullptr) {
+        shmServer_->Fini();
+    }
+
     if (fileManager_ != nullptr) {
         fileManager_->Fini();
     }
@@ -148,7 +152,22 @@ bool NebdServer::InitCurveRequestExecutor() {
         return false;
     }
 
-    CurveRequestExecutor::GetInstance().Init(curveClient_);
+    RequestCombinerOption combinerOption;
+    getOk = conf_.GetUInt32Value(COMBINEWINDOWUS, &combinerOption.windowUs);
+    LOG_IF(WARNING, !getOk) << "get " << COMBINEWINDOWUS
+                            << " fail, use default value "
+                            << combinerOption.windowUs;
+    getOk = conf_.GetUInt32Value(COMBINEMAXBYTES, &combinerOption.maxBytes);
+    LOG_IF(WARNING, !getOk) << "get " << COMBINEMAXBYTES
+                            << " fail, use default value "
+                            << combinerOption.maxBytes;
+    getOk = conf_.GetUInt32Value(COMBINEMAXREQUESTS,
+                                 &combinerOption.maxRequests);
+    LOG_IF(WARNING, !getOk) << "get " << COMBINEMAXREQUESTS
+                            << " fail, use default value "
+                            << combinerOption.maxRequests;
+
+    CurveRequestExecutor::GetInstance().Init(curveClient_, combinerOption);
     return true;
 }
 
@@ -219,7 +238,10 @@ bool NebdServer::StartServer() {
         return false;
     }
 
-    NebdFileServiceImpl fileService(fileManager_, returnRpcWhenIoError);
+    shmServer_ =
+        std::make_shared<NebdShmServer>(fileManager_, returnRpcWhenIoError);
+    NebdFileServiceImpl fileService(fileManager_, returnRpcWhenIoError,
+                                    shmServer_);
     int addFileServiceRes = server_.AddService(
         &fileService, brpc::SERVER_DOESNT_OWN_SERVICE);
     if (0 != addFileServiceRes) {
@@ -30,6 +30,7 @@
 #include "nebd/src/part2/file_manager.h"
 #include "nebd/src/part2/heartbeat_manager.h"
 #include "nebd/src/part2/request_executor_curve.h"
+#include "nebd/src/part2/shm_server.h"
 
 namespace nebd {
 namespace server {
@@ -107,6 +108,8 @@ class NebdServer {
     brpc::Server server_;
     // 用于接受和处理client端的各种请求
     std::shared_ptr<NebdFileManager> fileManager_;
+    // 处理part1通过共享内存提交的读写请求
+    std::shared_ptr<NebdShmServer> shmServer_;
     // 负责文件心跳超时处理
     std::shared_ptr<HeartbeatManager> heartbeatManager_;
     // curveclient
@@ -0,0 +1,374 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "nebd/src/part2/request_combiner.h"
+
+#include <bthread/unstable.h>
+#include <butil/iobuf.h>
+#include <butil/time.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include "nebd/src/part2/util.h"
+
+namespace nebd {
+namespace server {
+
+struct RequestCombiner::CombinedRequest {
+    // curve client的回调只带回CurveAioContext，通过它找到所属的请求
+    struct AioContext {
+        CombinedRequest* request;
+        CurveAioContext curveCtx;
+    };
+
+    AioContext aio;
+    std::shared_ptr<RequestCombiner> combiner;
+    int curveFd = -1;
+    off_t begin = 0;
+    std::vector<NebdServerAioContext*> ctxs;
+    // 合并请求的数据，只有一个请求时直接使用该请求的buf
+    butil::IOBuf data;
+};
+
+struct RequestCombiner::FlushTask {
+    std::weak_ptr<RequestCombiner> combiner;
+    int curveFd;
+    int index;
+    uint64_t seq;
+};
+
+RequestCombiner::RequestCombiner(const RequestCombinerOption& option,
+                                 std::shared_ptr<CurveClient> client)
+    : option_(option),
+      client_(std::move(client)),
+      combinedRequests_("nebd_server_combined_requests") {}
+
+RequestCombiner::~RequestCombiner() = default;
+
+int RequestCombiner::AioRead(int curveFd, NebdServerAioContext* aioctx) {
+    return Submit(curveFd, aioctx, false);
+}
+
+int RequestCombiner::AioWrite(int curveFd, NebdServerAioContext* aioctx) {
+    return Submit(curveFd, aioctx, true);
+}
+
+int RequestCombiner::Submit(int curveFd, NebdServerAioContext* aioctx,
+                            bool isWrite) {
+    const int index = isWrite ? 1 : 0;
+    Batch other;
+    Batch full;
+    bool direct = false;
+    bool startTimer = false;
+    uint64_t seq = 0;
+
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        FileQueue& queue = files_[curveFd];
+
+        // 与另一类等待中的请求交叠时先下发它们，保证下发顺序
+        if (!queue.pending[1 - index].ctxs.empty() &&
+            Overlap(queue.pending[1 - index], aioctx)) {
+            TakePending(&queue, 1 - index, &other);
+        }
+
+        Batch& batch = queue.pending[index];
+        if (!batch.ctxs.empty() && Mergeable(batch, aioctx, isWrite)) {
+            Add(&batch, aioctx);
+            combinedRequests_ << 1;
+            if (batch.ctxs.size() >= option_.maxRequests ||
+                batch.end - batch.begin >=
+                    static_cast<off_t>(option_.maxBytes)) {
+                TakePending(&queue, index, &full);
+            }
+        } else {
+            if (!batch.ctxs.empty()) {
+                TakePending(&queue, index, &full);
+            }
+
+            if (queue.inflight == 0) {
+                // 文件上没有未完成的请求，等待只会增加时延
+                direct = true;
+                queue.inflight++;
+            } else {
+                Add(&batch, aioctx);
+                batch.seq = ++nextSeq_;
+                seq = batch.seq;
+                startTimer = true;
+            }
+        }
+    }
+
+    if (!other.ctxs.empty()) {
+        IssueBatch(curveFd, !isWrite, std::move(other));
+    }
+    if (!full.ctxs.empty()) {
+        IssueBatch(curveFd, isWrite, std::move(full));
+    }
+    if (startTimer) {
+        StartTimer(curveFd, index, seq);
+    }
+
+    if (direct) {
+        int ret = Issue(curveFd, isWrite, {aioctx}, aioctx->offset,
+                        aioctx->offset + aioctx->size);
+        if (ret != 0) {
+            Release(curveFd);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+bool RequestCombiner::Mergeable(const Batch& batch,
+                                const NebdServerAioContext* aioctx,
+                                bool isWrite) const {
+    if (batch.ctxs.size() >= option_.maxRequests) {
+        return false;
+    }
+
+    off_t begin = aioctx->offset;
+    off_t end = aioctx->offset + aioctx->size;
+    if (isWrite) {
+        // 重叠的写请求合并后无法保证后到的数据生效，只合并首尾相接的
+        if (begin != batch.end && end != batch.begin) {
+            return false;
+        }
+    } else if (begin > batch.end || end < batch.begin) {
+        return false;
+    }
+
+    return std::max(end, batch.end) - std::min(begin, batch.begin) <=
+           static_cast<off_t>(option_.maxBytes);
+}
+
+void RequestCombiner::Add(Batch* batch, NebdServerAioContext* aioctx) {
+    off_t begin = aioctx->offset;
+    off_t end = aioctx->offset + aioctx->size;
+    if (batch->ctxs.empty()) {
+        batch->begin = begin;
+        batch->end = end;
+        batch->ctxs.push_back(aioctx);
+        return;
+    }
+
+    // 写请求按offset排列，下发时依次拼接数据
+    if (end == batch->begin) {
+        batch->ctxs.insert(batch->ctxs.begin(), aioctx);
+    } else {
+        batch->ctxs.push_back(aioctx);
+    }
+    batch->begin = std::min(batch->begin, begin);
+    batch->end = std::max(batch->end, end);
+}
+
+bool RequestCombiner::Overlap(const Batch& batch,
+                              const NebdServerAioContext* aioctx) {
+    off_t begin = aioctx->offset;
+    off_t end = aioctx->offset + aioctx->size;
+    return begin < batch.end && end > batch.begin;
+}
+
+int RequestCombiner::Issue(int curveFd, bool isWrite,
+                           std::vector<NebdServerAioContext*> ctxs,
+                           off_t begin, off_t end) {
+    CombinedRequest* request = new CombinedRequest();
+    request->combiner = shared_from_this();
+    request->curveFd = curveFd;
+    request->begin = begin;
+    request->ctxs = std::move(ctxs);
+    request->aio.request = request;
+
+    CurveAioContext* curveCtx = &request->aio.curveCtx;
+    curveCtx->offset = begin;
+    curveCtx->length = end - begin;
+    curveCtx->op = isWrite ? LIBCURVE_OP::LIBCURVE_OP_WRITE
+                           : LIBCURVE_OP::LIBCURVE_OP_READ;
+    curveCtx->cb = CombinedCallback;
+    if (request->ctxs.size() == 1) {
+        curveCtx->buf = request->ctxs[0]->buf;
+    } else {
+        if (isWrite) {
+            for (auto* ctx : request->ctxs) {
+                request->data.append(
+                    *reinterpret_cast<butil::IOBuf*>(ctx->buf));
+            }
+        }
+        curveCtx->buf = &request->data;
+    }
+
+    int ret = isWrite
+                  ? client_->AioWrite(curveFd, curveCtx,
+                                      curve::client::UserDataType::IOBuffer)
+                  : client_->AioRead(curveFd, curveCtx,
+                                     curve::client::UserDataType::IOBuffer);
+    if (ret != LIBCURVE_ERROR::OK) {
+        delete request;
+        return -1;
+    }
+
+    return 0;
+}
+
+void RequestCombiner::IssueBatch(int curveFd, bool isWrite, Batch batch) {
+    if (batch.ctxs.size() > 1) {
+        if (Issue(curveFd, isWrite, batch.ctxs, batch.begin, batch.end) ==
+            0) {
+            return;
+        }
+
+        LOG(WARNING) << "Issue combined request failed, issue one by one, "
+                     << "curve fd: " << curveFd << ", offset: " << batch.begin
+                     << ", length: " << batch.end - batch.begin
+                     << ", request num: " << batch.ctxs.size();
+        std::lock_guard<std::mutex> lk(mtx_);
+        files_[curveFd].inflight += batch.ctxs.size() - 1;
+    }
+
+    for (auto* ctx : batch.ctxs) {
+        if (Issue(curveFd, isWrite, {ctx}, ctx->offset,
+                  ctx->offset + ctx->size) != 0) {
+            LOG(ERROR) << "Issue request failed, curve fd: " << curveFd
+                       << ", context: " << *ctx;
+            ctx->ret = -1;
+            ctx->cb(ctx);
+            Release(curveFd);
+        }
+    }
+}
+
+void RequestCombiner::TakePending(FileQueue* queue, int index, Batch* batch) {
+    *batch = std::move(queue->pending[index]);
+    queue->pending[index] = Batch();
+    queue->inflight++;
+}
+
+void RequestCombiner::Release(int curveFd) {
+    Batch batches[2];
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        auto it = files_.find(curveFd);
+        if (it == files_.end()) {
+            return;
+        }
+
+        FileQueue& queue = it->second;
+        if (--queue.inflight > 0) {
+            return;
+        }
+
+        // 文件上的请求都已返回，不再等待合并窗口结束
+        for (int i = 0; i < 2; ++i) {
+            if (!queue.pending[i].ctxs.empty()) {
+                TakePending(&queue, i, &batches[i]);
+            }
+        }
+        if (queue.inflight == 0) {
+            files_.erase(it);
+        }
+    }
+
+    // 等待中的读请求和写请求不会交叠，下发顺序无关
+    for (int i = 0; i < 2; ++i) {
+        if (!batches[i].ctxs.empty()) {
+            IssueBatch(curveFd, i == 1, std::move(batches[i]));
+        }
+    }
+}
+
+void RequestCombiner::StartTimer(int curveFd, int index, uint64_t seq) {
+    FlushTask* task = new FlushTask{shared_from_this(), curveFd, index, seq};
+    bthread_timer_t timer;
+    int ret = bthread_timer_add(
+        &timer, butil::microseconds_from_now(option_.windowUs),
+        &RequestCombiner::TimerCallback, task);
+    if (ret != 0) {
+        LOG(WARNING) << "Add combine timer failed, issue requests now";
+        delete task;
+        OnTimer(curveFd, index, seq);
+    }
+}
+
+void RequestCombiner::TimerCallback(void* arg) {
+    std::unique_ptr<FlushTask> task(static_cast<FlushTask*>(arg));
+    auto combiner = task->combiner.lock();
+    if (combiner != nullptr) {
+        combiner->OnTimer(task->curveFd, task->index, task->seq);
+    }
+}
+
+void RequestCombiner::OnTimer(int curveFd, int index, uint64_t seq) {
+    Batch batch;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        auto it = files_.find(curveFd);
+        if (it == files_.end()) {
+            return;
+        }
+
+        // 这组请求已经因为合并满了或文件空闲而下发
+        FileQueue& queue = it->second;
+        if (queue.pending[index].ctxs.empty() ||
+            queue.pending[index].seq != seq) {
+            return;
+        }
+        TakePending(&queue, index, &batch);
+    }
+
+    IssueBatch(curveFd, index == 1, std::move(batch));
+}
+
+void RequestCombiner::OnComplete(CombinedRequest* request) {
+    const CurveAioContext& curveCtx = request->aio.curveCtx;
+    const bool split = request->ctxs.size() > 1;
+    const bool isRead = curveCtx.op == LIBCURVE_OP::LIBCURVE_OP_READ;
+
+    for (auto* ctx : request->ctxs) {
+        if (curveCtx.ret < 0) {
+            ctx->ret = curveCtx.ret;
+        } else if (split) {
+            if (isRead) {
+                request->data.append_to(
+                    reinterpret_cast<butil::IOBuf*>(ctx->buf), ctx->size,
+                    ctx->offset - request->begin);
+            }
+            ctx->ret = ctx->size;
+        } else {
+            ctx->ret = curveCtx.ret;
+        }
+        ctx->cb(ctx);
+    }
+
+    std::shared_ptr<RequestCombiner> combiner = std::move(request->combiner);
+    int curveFd = request->curveFd;
+    delete request;
+    combiner->Release(curveFd);
+}
+
+void RequestCombiner::CombinedCallback(CurveAioContext* curveCtx) {
+    auto* aio = reinterpret_cast<CombinedRequest::AioContext*>(
+        reinterpret_cast<char*>(curveCtx) -
+        offsetof(CombinedRequest::AioContext, curveCtx));
+    CombinedRequest* request = aio->request;
+    request->combiner->OnComplete(request);
+}
+
+}  // namespace server
+}  // namespace nebd
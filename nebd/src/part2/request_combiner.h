@@ -0,0 +1,141 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NEBD_SRC_PART2_REQUEST_COMBINER_H_
+#define NEBD_SRC_PART2_REQUEST_COMBINER_H_
+
+#include <bvar/bvar.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "include/client/libcurve.h"
+#include "nebd/src/part2/define.h"
+
+namespace nebd {
+namespace server {
+
+using ::curve::client::CurveClient;
+
+// 请求合并配置项
+struct RequestCombinerOption {
+    // 合并窗口，请求最多等待这么久，0表示不合并
+    uint32_t windowUs = 0;
+    // 合并后请求的最大长度
+    uint32_t maxBytes = 1024 * 1024;
+    // 一个合并请求最多包含的请求数
+    uint32_t maxRequests = 64;
+};
+
+/**
+ * 把同一个文件上相邻或重叠的读请求、相邻的写请求合并成一个请求发给
+ * curve client，完成后再把结果拆分给每个NebdServerAioContext。
+ * 文件上没有未完成的请求时直接下发，不等待；有未完成的请求时，新来的
+ * 请求最多等待windowUs，期间能合并的请求合并在一起，文件上的请求全部
+ * 返回时立即下发等待中的请求。
+ * 重叠的写请求不合并，读写请求交叠时先下发等待中的另一类请求，
+ * 保证请求下发的顺序与到达的顺序一致。
+ */
+class RequestCombiner : public std::enable_shared_from_this<RequestCombiner> {
+ public:
+    RequestCombiner(const RequestCombinerOption& option,
+                    std::shared_ptr<CurveClient> client);
+
+    ~RequestCombiner();
+
+    /**
+     * @brief 异步读写curve文件，aioctx->buf为butil::IOBuf
+     * @param curveFd curve client中文件的fd
+     * @return 请求已经下发或等待合并返回0，直接下发失败返回-1
+     */
+    int AioRead(int curveFd, NebdServerAioContext* aioctx);
+
+    int AioWrite(int curveFd, NebdServerAioContext* aioctx);
+
+ private:
+    // 等待合并的一组请求，按offset排列
+    struct Batch {
+        std::vector<NebdServerAioContext*> ctxs;
+        off_t begin = 0;
+        off_t end = 0;
+        // 每组请求的编号，用来判断定时器对应的请求是否已经下发
+        uint64_t seq = 0;
+    };
+
+    struct FileQueue {
+        // 已经下发给curve client还没有返回的请求数
+        uint32_t inflight = 0;
+        // 等待合并的读请求和写请求
+        Batch pending[2];
+    };
+
+    struct CombinedRequest;
+    struct FlushTask;
+
+    int Submit(int curveFd, NebdServerAioContext* aioctx, bool isWrite);
+
+    // 判断请求能否加入batch
+    bool Mergeable(const Batch& batch, const NebdServerAioContext* aioctx,
+                   bool isWrite) const;
+
+    static void Add(Batch* batch, NebdServerAioContext* aioctx);
+
+    static bool Overlap(const Batch& batch,
+                        const NebdServerAioContext* aioctx);
+
+    // 向curve client下发一组请求，调用时不持有锁，失败返回-1
+    int Issue(int curveFd, bool isWrite,
+              std::vector<NebdServerAioContext*> ctxs, off_t begin,
+              off_t end);
+
+    // 下发等待合并的请求，合并下发失败时逐个下发，仍然失败的返回错误
+    void IssueBatch(int curveFd, bool isWrite, Batch batch);
+
+    // 从queue中取出等待中的请求，调用时持有锁
+    void TakePending(FileQueue* queue, int index, Batch* batch);
+
+    // 文件上的一个请求返回，请求全部返回时下发等待中的请求
+    void Release(int curveFd);
+
+    void StartTimer(int curveFd, int index, uint64_t seq);
+
+    static void TimerCallback(void* arg);
+
+    void OnTimer(int curveFd, int index, uint64_t seq);
+
+    void OnComplete(CombinedRequest* request);
+
+    static void CombinedCallback(CurveAioContext* curveCtx);
+
+ private:
+    const RequestCombinerOption option_;
+    std::shared_ptr<CurveClient> client_;
+
+    std::mutex mtx_;
+    std::unordered_map<int, FileQueue> files_;
+    uint64_t nextSeq_ = 0;
+
+    // 合并到其他请求中下发的请求数
+    bvar::Adder<uint64_t> combinedRequests_;
+};
+
+}  // namespace server
+}  // namespace nebd
+
+#endif  // NEBD_SRC_PART2_REQUEST_COMBINER_H_
@@ -84,8 +84,13 @@ FileNameParser::Parse(const std::string& fileName) {
     return std::make_pair(fileName.substr(beginPos, length), confPath);
 }
 
-void CurveRequestExecutor::Init(const std::shared_ptr<CurveClient> &client) {
+void CurveRequestExecutor::Init(const std::shared_ptr<CurveClient> &client,
+                                const RequestCombinerOption& combinerOption) {
     client_ = client;
+    combiner_.reset();
+    if (combinerOption.windowUs > 0) {
+        combiner_ = std::make_shared<RequestCombiner>(combinerOption, client);
+    }
 }
 
 std::shared_ptr<NebdFileInstance> CurveRequestExecutor::Open(
@@ -236,6 +241,10 @@ int CurveRequestExecutor::AioRead(
         return -1;
     }
 
+    if (combiner_ != nullptr) {
+        return combiner_->AioRead(curveFd, aioctx);
+    }
+
     CurveAioCombineContext *curveCombineCtx = new CurveAioCombineContext();
     curveCombineCtx->nebdCtx = aioctx;
     int ret = FromNebdCtxToCurveCtx(aioctx, &curveCombineCtx->curveCtx);
@@ -261,6 +270,10 @@ int CurveRequestExecutor::AioWrite(
         return -1;
     }
 
+    if (combiner_ != nullptr) {
+        return combiner_->AioWrite(curveFd, aioctx);
+    }
+
     CurveAioCombineContext *curveCombineCtx = new CurveAioCombineContext();
     curveCombineCtx->nebdCtx = aioctx;
     int ret = FromNebdCtxToCurveCtx(aioctx, &curveCombineCtx->curveCtx);
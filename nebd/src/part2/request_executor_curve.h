@@ -28,6 +28,7 @@
 #include <utility>
 #include "nebd/src/part2/request_executor.h"
 #include "nebd/src/part2/define.h"
+#include "nebd/src/part2/request_combiner.h"
 #include "include/client/libcurve.h"
 
 namespace nebd {
@@ -74,7 +75,14 @@ class CurveRequestExecutor : public NebdRequestExecutor {
         return executor;
     }
     ~CurveRequestExecutor() {}
-    void Init(const std::shared_ptr<CurveClient> &client);
+    /**
+     * @brief 初始化
+     * @param client curve client
+     * @param combinerOption 读写请求合并配置，windowUs为0时不合并
+     */
+    void Init(const std::shared_ptr<CurveClient> &client,
+              const RequestCombinerOption& combinerOption =
+                  RequestCombinerOption());
     std::shared_ptr<NebdFileInstance> Open(const std::string& filename,
                                            const OpenFlags* openflags) override;
     std::shared_ptr<NebdFileInstance> Reopen(
@@ -127,6 +135,8 @@ class CurveRequestExecutor : public NebdRequestExecutor {
 
  private:
     std::shared_ptr<::curve::client::CurveClient> client_;
+    // 读写请求合并，未开启时为空
+    std::shared_ptr<RequestCombiner> combiner_;
 };
 
 }  // namespace server
@@ -0,0 +1,244 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "nebd/src/part2/shm_server.h"
+
+#include <butil/iobuf.h>
+#include <glog/logging.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "nebd/src/common/timeutility.h"
+#include "nebd/src/part2/util.h"
+
+namespace nebd {
+namespace server {
+
+using nebd::common::ShmDescSlot;
+using nebd::common::ShmQueue;
+using nebd::common::SharedMemoryRegion;
+using nebd::common::TimeUtility;
+
+namespace {
+
+// 提交队列为空时，先忙等一段时间再睡眠，减少唤醒的开销
+const uint64_t kPollSpinUs = 50;
+const uint32_t kPollWaitMs = 100;
+
+void EmptyDeleter(void* m) {
+    (void)m;
+}
+
+}  // namespace
+
+struct NebdShmServer::Session {
+    SharedMemoryRegion region;
+    std::atomic<bool> running{true};
+    std::thread thread;
+};
+
+// 一个共享内存上的请求，作为NebdServerAioContext的done
+struct NebdShmServer::Request : public google::protobuf::Closure {
+    Request(SessionPtr s, const ShmIODesc& d)
+        : session(std::move(s)), desc(d) {}
+
+    void Run() override {
+        std::unique_ptr<Request> selfGuard(this);
+        Complete(session.get(), desc, ret);
+    }
+
+    SessionPtr session;
+    ShmIODesc desc;
+    int64_t ret = -1;
+};
+
+NebdShmServer::NebdShmServer(std::shared_ptr<NebdFileManager> fileManager,
+                             bool returnRpcWhenIoError)
+    : fileManager_(fileManager),
+      returnRpcWhenIoError_(returnRpcWhenIoError),
+      token_((static_cast<uint64_t>(getpid()) << 32) |
+             (TimeUtility::GetTimeofDayUs() & 0xffffffff)) {}
+
+NebdShmServer::~NebdShmServer() {
+    Fini();
+}
+
+int NebdShmServer::Attach(const std::string& name, uint64_t* token) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (sessions_.count(name) != 0) {
+        *token = token_;
+        return 0;
+    }
+
+    SessionPtr session = std::make_shared<Session>();
+    if (session->region.Open(name) != 0) {
+        LOG(ERROR) << "Attach shared memory failed, name: " << name;
+        return -1;
+    }
+
+    // 重启之前的进程没有处理完的请求由part1重新提交
+    session->region.SubmitQueue()->Clear();
+    session->region.SetServerToken(token_);
+    session->thread = std::thread(&NebdShmServer::Poll, this, session);
+    sessions_.emplace(name, session);
+
+    *token = token_;
+    LOG(INFO) << "Attach shared memory success, name: " << name
+              << ", slot num: " << session->region.SlotNum()
+              << ", slot size: " << session->region.SlotSize();
+    return 0;
+}
+
+void NebdShmServer::Detach(const std::string& name) {
+    SessionPtr session;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        auto iter = sessions_.find(name);
+        if (iter == sessions_.end()) {
+            return;
+        }
+        session = iter->second;
+        sessions_.erase(iter);
+    }
+
+    session->running.store(false, std::memory_order_relaxed);
+    session->region.SubmitQueue()->Notify();
+    session->thread.join();
+    LOG(INFO) << "Detach shared memory success, name: " << name;
+}
+
+void NebdShmServer::Fini() {
+    std::vector<std::string> names;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        for (const auto& session : sessions_) {
+            names.push_back(session.first);
+        }
+    }
+    for (const auto& name : names) {
+        Detach(name);
+    }
+}
+
+void NebdShmServer::Poll(SessionPtr session) {
+    ShmQueue* queue = session->region.SubmitQueue();
+    ShmIODesc desc;
+    while (session->running.load(std::memory_order_relaxed)) {
+        if (queue->Pop(&desc)) {
+            Submit(session, desc);
+            continue;
+        }
+
+        uint64_t spinUntil = TimeUtility::GetTimeofDayUs() + kPollSpinUs;
+        while (queue->Empty() && TimeUtility::GetTimeofDayUs() < spinUntil) {
+            std::this_thread::yield();
+        }
+        if (queue->Empty()) {
+            queue->Wait(kPollWaitMs);
+        }
+    }
+}
+
+void NebdShmServer::Submit(const SessionPtr& session, const ShmIODesc& desc) {
+    SharedMemoryRegion& region = session->region;
+    uint32_t slot = ShmDescSlot(desc.id);
+    LIBAIO_OP op = static_cast<LIBAIO_OP>(desc.op);
+    // 描述符由part1写入，使用之前检查
+    if (slot >= region.SlotNum() || desc.length > region.SlotSize() ||
+        (op != LIBAIO_OP::LIBAIO_OP_READ && op != LIBAIO_OP::LIBAIO_OP_WRITE)) {
+        LOG(ERROR) << "Invalid shared memory request, name: " << region.Name()
+                   << ", slot: " << slot << ", op: " << desc.op
+                   << ", length: " << desc.length;
+        Complete(session.get(), desc, -1);
+        return;
+    }
+
+    NebdServerAioContext* aioContext = new NebdServerAioContext();
+    aioContext->offset = desc.offset;
+    aioContext->size = desc.length;
+    aioContext->op = op;
+    aioContext->cb = &NebdShmServer::ShmRequestCallback;
+    aioContext->returnRpcWhenIoError = returnRpcWhenIoError_;
+    aioContext->done = new Request(session, desc);
+
+    butil::IOBuf* buf = new butil::IOBuf();
+    if (op == LIBAIO_OP::LIBAIO_OP_WRITE) {
+        // 直接写共享内存中的数据，part1在请求完成之前不会复用slot
+        buf->append_user_data(region.Slot(slot), desc.length, EmptyDeleter);
+    }
+    aioContext->buf = buf;
+
+    int rc = op == LIBAIO_OP::LIBAIO_OP_READ
+                 ? fileManager_->AioRead(desc.fd, aioContext)
+                 : fileManager_->AioWrite(desc.fd, aioContext);
+    if (rc < 0) {
+        LOG(ERROR) << "Shared memory request failed, fd: " << desc.fd
+                   << ", op: " << Op2Str(op) << ", offset: " << desc.offset
+                   << ", length: " << desc.length << ", return code: " << rc;
+        delete buf;
+        aioContext->done->Run();
+        delete aioContext;
+    }
+}
+
+void NebdShmServer::Complete(Session* session, ShmIODesc desc, int64_t ret) {
+    desc.ret = ret;
+    ShmQueue* queue = session->region.CompleteQueue();
+    if (!queue->Push(desc)) {
+        // 队列容量是slot数的两倍，正常情况下不会出现
+        LOG(ERROR) << "Shared memory complete queue is full, name: "
+                   << session->region.Name();
+        return;
+    }
+    queue->Notify();
+}
+
+void NebdShmServer::ShmRequestCallback(NebdServerAioContext* context) {
+    CHECK(context != nullptr);
+    std::unique_ptr<NebdServerAioContext> contextGuard(context);
+    std::unique_ptr<butil::IOBuf> iobufGuard(
+        reinterpret_cast<butil::IOBuf*>(context->buf));
+    Request* request = static_cast<Request*>(context->done);
+
+    if (context->ret < 0 && !context->returnRpcWhenIoError) {
+        LOG(ERROR) << *context;
+        // 与rpc一致，不向part1返回io错误
+        delete request;
+        return;
+    }
+
+    if (context->ret < 0) {
+        LOG(ERROR) << *context;
+        request->ret = -1;
+    } else {
+        if (context->op == LIBAIO_OP::LIBAIO_OP_READ) {
+            SharedMemoryRegion& region = request->session->region;
+            char* slot = region.Slot(ShmDescSlot(request->desc.id));
+            iobufGuard->copy_to(
+                slot, std::min<size_t>(iobufGuard->size(), region.SlotSize()));
+        }
+        request->ret = 0;
+    }
+    request->Run();
+}
+
+}  // namespace server
+}  // namespace nebd
@@ -0,0 +1,88 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NEBD_SRC_PART2_SHM_SERVER_H_
+#define NEBD_SRC_PART2_SHM_SERVER_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "nebd/src/common/shared_memory.h"
+#include "nebd/src/part2/file_manager.h"
+
+namespace nebd {
+namespace server {
+
+using nebd::common::ShmIODesc;
+
+/**
+ * 处理part1通过共享内存提交的读写请求。
+ * 每块共享内存由一个线程轮询其提交队列，读写完成后把结果放入完成队列，
+ * 请求的数据直接在共享内存的slot中，不经过rpc。
+ */
+class NebdShmServer {
+ public:
+    NebdShmServer(std::shared_ptr<NebdFileManager> fileManager,
+                  bool returnRpcWhenIoError);
+
+    virtual ~NebdShmServer();
+
+    /**
+     * @brief 映射part1创建的共享内存并开始处理其中的请求，已经映射的
+     *        直接返回。第一次映射时丢弃提交队列中遗留的请求，它们由
+     *        part1在发现part2重启后重新提交。
+     * @param name 共享内存名
+     * @param[out] token 本进程的标识
+     * @return 成功返回0，失败返回-1
+     */
+    int Attach(const std::string& name, uint64_t* token);
+
+    /**
+     * @brief 停止处理共享内存中的请求并解除映射
+     */
+    void Detach(const std::string& name);
+
+    void Fini();
+
+ private:
+    struct Session;
+    struct Request;
+    using SessionPtr = std::shared_ptr<Session>;
+
+    // 轮询提交队列
+    void Poll(SessionPtr session);
+
+    void Submit(const SessionPtr& session, const ShmIODesc& desc);
+
+    static void Complete(Session* session, ShmIODesc desc, int64_t ret);
+
+    static void ShmRequestCallback(NebdServerAioContext* context);
+
+ private:
+    std::shared_ptr<NebdFileManager> fileManager_;
+    const bool returnRpcWhenIoError_;
+    const uint64_t token_;
+
+    std::mutex mtx_;
+    std::unordered_map<std::string, SessionPtr> sessions_;
+};
+
+}  // namespace server
+}  // namespace nebd
+
+#endif  // NEBD_SRC_PART2_SHM_SERVER_H_
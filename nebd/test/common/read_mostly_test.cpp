@@ -0,0 +1,87 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <map>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "nebd/src/common/read_mostly.h"
+
+namespace nebd {
+namespace common {
+
+TEST(ReadMostlyTest, ReadAndModify) {
+    ReadMostly<std::map<int, int>> data;
+    data.Read([](const std::map<int, int>& m) { ASSERT_TRUE(m.empty()); });
+
+    data.Modify([](std::map<int, int>* m) { (*m)[1] = 10; });
+    data.Modify([](std::map<int, int>* m) { (*m)[2] = 20; });
+
+    std::map<int, int> copy;
+    data.Read([&](const std::map<int, int>& m) { copy = m; });
+    ASSERT_EQ(2, copy.size());
+    ASSERT_EQ(10, copy[1]);
+    ASSERT_EQ(20, copy[2]);
+
+    data.Modify([](std::map<int, int>* m) { m->erase(1); });
+    data.Read([&](const std::map<int, int>& m) { copy = m; });
+    ASSERT_EQ(1, copy.size());
+    ASSERT_EQ(0, copy.count(1));
+}
+
+TEST(ReadMostlyTest, ConcurrentReadAndModify) {
+    // 写者总是同时修改两个值，读者不应看到修改了一半的数据
+    ReadMostly<std::vector<int>> data;
+    data.Modify([](std::vector<int>* v) { v->assign(2, 0); });
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> broken{0};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&]() {
+            while (!stop.load()) {
+                data.Read([&](const std::vector<int>& v) {
+                    if (v[0] != v[1]) {
+                        ++broken;
+                    }
+                });
+            }
+        });
+    }
+
+    for (int n = 1; n <= 2000; ++n) {
+        data.Modify([n](std::vector<int>* v) {
+            (*v)[0] = n;
+            (*v)[1] = n;
+        });
+    }
+    stop.store(true);
+    for (auto& t : readers) {
+        t.join();
+    }
+
+    ASSERT_EQ(0, broken.load());
+    data.Read([](const std::vector<int>& v) {
+        ASSERT_EQ(2000, v[0]);
+        ASSERT_EQ(2000, v[1]);
+    });
+}
+
+}  // namespace common
+}  // namespace nebd
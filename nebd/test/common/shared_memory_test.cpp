@@ -0,0 +1,167 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "nebd/src/common/shared_memory.h"
+
+namespace nebd {
+namespace common {
+
+namespace {
+
+std::string ShmName() {
+    return "/nebd-shm-test-" + std::to_string(getpid());
+}
+
+}  // namespace
+
+TEST(ShmQueueTest, PushPop) {
+    const uint32_t capacity = 4;
+    std::vector<char> mem(ShmQueue::MemorySize(capacity));
+    ShmQueue* queue = ShmQueue::Format(mem.data(), capacity);
+    ASSERT_EQ(capacity, queue->Capacity());
+    ASSERT_TRUE(queue->Empty());
+
+    ShmIODesc desc;
+    ASSERT_FALSE(queue->Pop(&desc));
+
+    for (uint32_t i = 0; i < capacity; ++i) {
+        desc.id = ShmDescId(i, 1);
+        ASSERT_TRUE(queue->Push(desc));
+    }
+    ASSERT_FALSE(queue->Push(desc));
+
+    for (uint32_t i = 0; i < capacity; ++i) {
+        ASSERT_TRUE(queue->Pop(&desc));
+        ASSERT_EQ(i, ShmDescSlot(desc.id));
+        ASSERT_EQ(1, ShmDescSeq(desc.id));
+    }
+    ASSERT_TRUE(queue->Empty());
+
+    desc.id = 1;
+    ASSERT_TRUE(queue->Push(desc));
+    queue->Clear();
+    ASSERT_TRUE(queue->Empty());
+}
+
+TEST(ShmQueueTest, ConcurrentProducers) {
+    const uint32_t capacity = 64;
+    const int producers = 4;
+    const uint64_t perProducer = 10000;
+    std::vector<char> mem(ShmQueue::MemorySize(capacity));
+    ShmQueue* queue = ShmQueue::Format(mem.data(), capacity);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < producers; ++i) {
+        threads.emplace_back([queue, perProducer]() {
+            ShmIODesc desc;
+            desc.id = 1;
+            for (uint64_t n = 0; n < perProducer; ++n) {
+                while (!queue->Push(desc)) {
+                    std::this_thread::yield();
+                }
+                queue->Notify();
+            }
+        });
+    }
+
+    uint64_t popped = 0;
+    ShmIODesc desc;
+    while (popped < producers * perProducer) {
+        if (queue->Pop(&desc)) {
+            ASSERT_EQ(1, desc.id);
+            ++popped;
+        } else {
+            queue->Wait(10);
+        }
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    ASSERT_TRUE(queue->Empty());
+}
+
+TEST(ShmQueueTest, WaitTimeout) {
+    const uint32_t capacity = 2;
+    std::vector<char> mem(ShmQueue::MemorySize(capacity));
+    ShmQueue* queue = ShmQueue::Format(mem.data(), capacity);
+
+    auto start = std::chrono::steady_clock::now();
+    queue->Wait(50);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_GE(elapsed, std::chrono::milliseconds(40));
+
+    // 队列非空时不等待
+    ShmIODesc desc;
+    desc.id = 1;
+    ASSERT_TRUE(queue->Push(desc));
+    start = std::chrono::steady_clock::now();
+    queue->Wait(1000);
+    elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_LT(elapsed, std::chrono::milliseconds(500));
+}
+
+TEST(SharedMemoryRegionTest, CreateAndOpen) {
+    SharedMemoryRegion server;
+    ASSERT_EQ(-1, server.Open(ShmName()));
+
+    SharedMemoryRegion client;
+    ASSERT_EQ(-1, client.Create(ShmName(), 0, 4096));
+    ASSERT_EQ(0, client.Create(ShmName(), 3, 4096));
+    ASSERT_EQ(3, client.SlotNum());
+    ASSERT_EQ(4096, client.SlotSize());
+    ASSERT_EQ(0, client.ServerToken());
+
+    ASSERT_EQ(0, server.Open(ShmName()));
+    ASSERT_EQ(3, server.SlotNum());
+    ASSERT_EQ(4096, server.SlotSize());
+    ASSERT_EQ(8, server.SubmitQueue()->Capacity());
+
+    // 两端看到同一块内存
+    memset(client.Slot(2), 'a', 4096);
+    ASSERT_EQ('a', server.Slot(2)[4095]);
+    server.SetServerToken(100);
+    ASSERT_EQ(100, client.ServerToken());
+
+    ShmIODesc desc;
+    desc.id = ShmDescId(2, 7);
+    desc.length = 4096;
+    ASSERT_TRUE(client.SubmitQueue()->Push(desc));
+    ASSERT_TRUE(server.SubmitQueue()->Pop(&desc));
+    ASSERT_EQ(2, ShmDescSlot(desc.id));
+    ASSERT_TRUE(client.SubmitQueue()->Empty());
+    desc.ret = 0;
+    ASSERT_TRUE(server.CompleteQueue()->Push(desc));
+    ASSERT_TRUE(client.CompleteQueue()->Pop(&desc));
+    ASSERT_EQ(7, ShmDescSeq(desc.id));
+
+    // 创建者关闭后共享内存被删除
+    server.Close();
+    client.Close();
+    ASSERT_EQ(-1, server.Open(ShmName()));
+}
+
+}  // namespace common
+}  // namespace nebd
@@ -27,6 +27,8 @@
 #include <mutex>  // NOLINT
 #include <condition_variable>  // NOLINT
 #include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "nebd/src/part1/nebd_client.h"
 #include "nebd/src/part1/libnebd.h"
@@ -371,6 +373,67 @@ TEST_F(NebdFileClientTest, CommonTest) {
     StopServer();
 }
 
+TEST_F(NebdFileClientTest, MultiSubmitQueueTest) {
+    AddFakeService();
+    StartServer();
+
+    ASSERT_EQ(0, Init4Nebd(kNebdClientConf));
+
+    int fd = Open4Nebd(kFileName, nullptr);
+    ASSERT_GE(fd, 0);
+
+    // 不同线程的请求进入不同的提交队列
+    const int threadNum = 8;
+    const int ioPerThread = 100;
+    static std::atomic<int> finished{0};
+    finished = 0;
+    auto callback = [](NebdClientAioContext* ctx) {
+        ASSERT_EQ(0, ctx->ret);
+        delete ctx;
+        std::lock_guard<std::mutex> lk(mtx);
+        ++finished;
+        cond.notify_one();
+    };
+
+    std::vector<std::vector<char>> buffers(
+        threadNum, std::vector<char>(kBufSize));
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadNum; ++i) {
+        char* buffer = buffers[i].data();
+        threads.emplace_back([fd, callback, buffer]() {
+            for (int n = 0; n < ioPerThread; ++n) {
+                NebdClientAioContext* ctx = new NebdClientAioContext();
+                ctx->buf = buffer;
+                ctx->offset = n * kBufSize;
+                ctx->length = kBufSize;
+                ctx->ret = 0;
+                ctx->op = n % 2 == 0 ? LIBAIO_OP_WRITE : LIBAIO_OP_READ;
+                ctx->cb = callback;
+                ctx->retryCount = 0;
+                if (ctx->op == LIBAIO_OP_WRITE) {
+                    ASSERT_EQ(0, AioWrite4Nebd(fd, ctx));
+                } else {
+                    ASSERT_EQ(0, AioRead4Nebd(fd, ctx));
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    {
+        std::unique_lock<std::mutex> ulk(mtx);
+        cond.wait(ulk, [&]() {
+            return finished.load() == threadNum * ioPerThread;
+        });
+    }
+
+    ASSERT_EQ(0, Close4Nebd(fd));
+    ASSERT_NO_THROW(Uninit4Nebd());
+    StopServer();
+}
+
 TEST_F(NebdFileClientTest, ReOpenTest) {
     AddFakeService();
     StartServer();
@@ -0,0 +1,328 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <butil/iobuf.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "nebd/src/part2/request_combiner.h"
+#include "nebd/test/part2/mock_curve_client.h"
+
+namespace nebd {
+namespace server {
+
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::Invoke;
+using ::testing::Return;
+using ::testing::SaveArg;
+
+namespace {
+
+std::atomic<int> finished{0};
+
+void RequestCallback(NebdServerAioContext* context) {
+    (void)context;
+    ++finished;
+}
+
+struct Request {
+    Request(LIBAIO_OP op, off_t offset, size_t size, char c = 0) {
+        ctx.op = op;
+        ctx.offset = offset;
+        ctx.size = size;
+        ctx.buf = &buf;
+        ctx.cb = RequestCallback;
+        if (op == LIBAIO_OP::LIBAIO_OP_WRITE) {
+            buf.append(std::string(size, c));
+        }
+    }
+
+    NebdServerAioContext ctx;
+    butil::IOBuf buf;
+};
+
+}  // namespace
+
+class RequestCombinerTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        finished = 0;
+        client_ = std::make_shared<MockCurveClient>();
+        RequestCombinerOption option;
+        option.windowUs = 10 * 1000 * 1000;
+        option.maxBytes = 16 * 1024;
+        option.maxRequests = 4;
+        combiner_ = std::make_shared<RequestCombiner>(option, client_);
+    }
+
+    std::shared_ptr<MockCurveClient> client_;
+    std::shared_ptr<RequestCombiner> combiner_;
+};
+
+TEST_F(RequestCombinerTest, IssueDirectlyWhenIdle) {
+    Request req(LIBAIO_OP::LIBAIO_OP_READ, 4096, 4096);
+    CurveAioContext* curveCtx = nullptr;
+    EXPECT_CALL(*client_, AioRead(1, _, _))
+        .WillOnce(Return(LIBCURVE_ERROR::FAILED))
+        .WillOnce(DoAll(SaveArg<1>(&curveCtx), Return(LIBCURVE_ERROR::OK)));
+
+    // 直接下发失败时同步返回错误
+    ASSERT_EQ(-1, combiner_->AioRead(1, &req.ctx));
+
+    ASSERT_EQ(0, combiner_->AioRead(1, &req.ctx));
+    ASSERT_NE(nullptr, curveCtx);
+    ASSERT_EQ(4096, curveCtx->offset);
+    ASSERT_EQ(4096, curveCtx->length);
+    ASSERT_EQ(&req.buf, curveCtx->buf);
+
+    curveCtx->ret = 4096;
+    curveCtx->cb(curveCtx);
+    ASSERT_EQ(1, finished);
+    ASSERT_EQ(4096, req.ctx.ret);
+}
+
+TEST_F(RequestCombinerTest, CombineWrites) {
+    Request first(LIBAIO_OP::LIBAIO_OP_WRITE, 0, 4096, 'a');
+    Request w1(LIBAIO_OP::LIBAIO_OP_WRITE, 8192, 4096, 'b');
+    Request w2(LIBAIO_OP::LIBAIO_OP_WRITE, 12288, 4096, 'c');
+    Request w3(LIBAIO_OP::LIBAIO_OP_WRITE, 4096, 4096, 'd');
+    // 与已有的写请求重叠，不合并
+    Request w4(LIBAIO_OP::LIBAIO_OP_WRITE, 6144, 4096, 'e');
+
+    std::vector<CurveAioContext*> curveCtxs;
+    std::vector<std::string> data;
+    EXPECT_CALL(*client_, AioWrite(1, _, _))
+        .Times(3)
+        .WillRepeatedly(Invoke([&](int fd, CurveAioContext* ctx,
+                                   curve::client::UserDataType type) {
+            (void)fd;
+            (void)type;
+            curveCtxs.push_back(ctx);
+            data.push_back(reinterpret_cast<butil::IOBuf*>(ctx->buf)
+                               ->to_string());
+            return LIBCURVE_ERROR::OK;
+        }));
+
+    ASSERT_EQ(0, combiner_->AioWrite(1, &first.ctx));
+    ASSERT_EQ(1, curveCtxs.size());
+
+    // 文件上有未完成的请求，后续请求等待合并
+    ASSERT_EQ(0, combiner_->AioWrite(1, &w1.ctx));
+    ASSERT_EQ(0, combiner_->AioWrite(1, &w2.ctx));
+    ASSERT_EQ(0, combiner_->AioWrite(1, &w3.ctx));
+    ASSERT_EQ(1, curveCtxs.size());
+
+    // 不能合并的请求使等待中的请求下发
+    ASSERT_EQ(0, combiner_->AioWrite(1, &w4.ctx));
+    ASSERT_EQ(2, curveCtxs.size());
+    ASSERT_EQ(4096, curveCtxs[1]->offset);
+    ASSERT_EQ(3 * 4096, curveCtxs[1]->length);
+    ASSERT_EQ(std::string(4096, 'd') + std::string(4096, 'b') +
+                  std::string(4096, 'c'),
+              data[1]);
+
+    curveCtxs[1]->ret = 3 * 4096;
+    curveCtxs[1]->cb(curveCtxs[1]);
+    ASSERT_EQ(3, finished);
+    ASSERT_EQ(4096, w1.ctx.ret);
+    ASSERT_EQ(4096, w2.ctx.ret);
+    ASSERT_EQ(4096, w3.ctx.ret);
+
+    // 所有请求返回后立即下发等待中的请求
+    curveCtxs[0]->ret = 4096;
+    curveCtxs[0]->cb(curveCtxs[0]);
+    ASSERT_EQ(3, curveCtxs.size());
+    ASSERT_EQ(6144, curveCtxs[2]->offset);
+    ASSERT_EQ(&w4.buf, curveCtxs[2]->buf);
+
+    curveCtxs[2]->ret = -1;
+    curveCtxs[2]->cb(curveCtxs[2]);
+    ASSERT_EQ(5, finished);
+    ASSERT_EQ(-1, w4.ctx.ret);
+}
+
+TEST_F(RequestCombinerTest, CombineAndSplitReads) {
+    Request first(LIBAIO_OP::LIBAIO_OP_READ, 0, 4096);
+    Request r1(LIBAIO_OP::LIBAIO_OP_READ, 8192, 4096);
+    Request r2(LIBAIO_OP::LIBAIO_OP_READ, 10240, 4096);
+    Request r3(LIBAIO_OP::LIBAIO_OP_READ, 14336, 2048);
+    Request r4(LIBAIO_OP::LIBAIO_OP_READ, 4096, 4096);
+
+    std::vector<CurveAioContext*> curveCtxs;
+    EXPECT_CALL(*client_, AioRead(1, _, _))
+        .Times(2)
+        .WillRepeatedly(Invoke([&](int fd, CurveAioContext* ctx,
+                                   curve::client::UserDataType type) {
+            (void)fd;
+            (void)type;
+            curveCtxs.push_back(ctx);
+            return LIBCURVE_ERROR::OK;
+        }));
+
+    ASSERT_EQ(0, combiner_->AioRead(1, &first.ctx));
+    ASSERT_EQ(0, combiner_->AioRead(1, &r1.ctx));
+    ASSERT_EQ(0, combiner_->AioRead(1, &r2.ctx));
+    ASSERT_EQ(0, combiner_->AioRead(1, &r3.ctx));
+    ASSERT_EQ(1, curveCtxs.size());
+
+    // 达到maxRequests后立即下发
+    ASSERT_EQ(0, combiner_->AioRead(1, &r4.ctx));
+    ASSERT_EQ(2, curveCtxs.size());
+    ASSERT_EQ(4096, curveCtxs[1]->offset);
+    ASSERT_EQ(12288, curveCtxs[1]->length);
+
+    auto* buf = reinterpret_cast<butil::IOBuf*>(curveCtxs[1]->buf);
+    for (int i = 0; i < 12288 / 1024; ++i) {
+        buf->append(std::string(1024, 'a' + i));
+    }
+    curveCtxs[1]->ret = 12288;
+    curveCtxs[1]->cb(curveCtxs[1]);
+    ASSERT_EQ(4, finished);
+
+    ASSERT_EQ(std::string(1024, 'a') + std::string(1024, 'b') +
+                  std::string(1024, 'c') + std::string(1024, 'd'),
+              r4.buf.to_string());
+    ASSERT_EQ(std::string(1024, 'e') + std::string(1024, 'f') +
+                  std::string(1024, 'g') + std::string(1024, 'h'),
+              r1.buf.to_string());
+    ASSERT_EQ(std::string(1024, 'g') + std::string(1024, 'h') +
+                  std::string(1024, 'i') + std::string(1024, 'j'),
+              r2.buf.to_string());
+    ASSERT_EQ(std::string(1024, 'k') + std::string(1024, 'l'),
+              r3.buf.to_string());
+    ASSERT_EQ(2048, r3.ctx.ret);
+
+    curveCtxs[0]->ret = 4096;
+    curveCtxs[0]->cb(curveCtxs[0]);
+    ASSERT_EQ(5, finished);
+}
+
+TEST_F(RequestCombinerTest, FlushOverlappedRequestsFirst) {
+    Request first(LIBAIO_OP::LIBAIO_OP_WRITE, 0, 4096, 'a');
+    Request write(LIBAIO_OP::LIBAIO_OP_WRITE, 8192, 4096, 'b');
+    Request read(LIBAIO_OP::LIBAIO_OP_READ, 8192, 4096);
+
+    std::vector<CurveAioContext*> curveCtxs;
+    auto save = [&](int fd, CurveAioContext* ctx,
+                    curve::client::UserDataType type) {
+        (void)fd;
+        (void)type;
+        curveCtxs.push_back(ctx);
+        return LIBCURVE_ERROR::OK;
+    };
+    EXPECT_CALL(*client_, AioWrite(1, _, _))
+        .Times(2)
+        .WillRepeatedly(Invoke(save));
+    EXPECT_CALL(*client_, AioRead(1, _, _)).WillOnce(Invoke(save));
+
+    ASSERT_EQ(0, combiner_->AioWrite(1, &first.ctx));
+    ASSERT_EQ(0, combiner_->AioWrite(1, &write.ctx));
+    ASSERT_EQ(1, curveCtxs.size());
+
+    // 读请求与等待中的写请求交叠，写请求先下发
+    ASSERT_EQ(0, combiner_->AioRead(1, &read.ctx));
+    ASSERT_EQ(2, curveCtxs.size());
+    ASSERT_EQ(LIBCURVE_OP::LIBCURVE_OP_WRITE, curveCtxs[1]->op);
+    ASSERT_EQ(8192, curveCtxs[1]->offset);
+
+    for (auto* ctx : {curveCtxs[0], curveCtxs[1]}) {
+        ctx->ret = ctx->length;
+        ctx->cb(ctx);
+    }
+    ASSERT_EQ(3, curveCtxs.size());
+    ASSERT_EQ(LIBCURVE_OP::LIBCURVE_OP_READ, curveCtxs[2]->op);
+    curveCtxs[2]->ret = 4096;
+    curveCtxs[2]->cb(curveCtxs[2]);
+    ASSERT_EQ(3, finished);
+}
+
+TEST_F(RequestCombinerTest, IssueOneByOneWhenCombinedFailed) {
+    Request first(LIBAIO_OP::LIBAIO_OP_WRITE, 0, 4096, 'a');
+    Request w1(LIBAIO_OP::LIBAIO_OP_WRITE, 4096, 4096, 'b');
+    Request w2(LIBAIO_OP::LIBAIO_OP_WRITE, 8192, 4096, 'c');
+
+    CurveAioContext* firstCtx = nullptr;
+    CurveAioContext* w1Ctx = nullptr;
+    EXPECT_CALL(*client_, AioWrite(1, _, _))
+        .WillOnce(DoAll(SaveArg<1>(&firstCtx), Return(LIBCURVE_ERROR::OK)))
+        .WillOnce(Return(LIBCURVE_ERROR::FAILED))
+        .WillOnce(DoAll(SaveArg<1>(&w1Ctx), Return(LIBCURVE_ERROR::OK)))
+        .WillOnce(Return(LIBCURVE_ERROR::FAILED));
+
+    ASSERT_EQ(0, combiner_->AioWrite(1, &first.ctx));
+    ASSERT_EQ(0, combiner_->AioWrite(1, &w1.ctx));
+    ASSERT_EQ(0, combiner_->AioWrite(1, &w2.ctx));
+
+    firstCtx->ret = 4096;
+    firstCtx->cb(firstCtx);
+    ASSERT_EQ(2, finished);
+    ASSERT_EQ(-1, w2.ctx.ret);
+
+    ASSERT_NE(nullptr, w1Ctx);
+    ASSERT_EQ(4096, w1Ctx->offset);
+    w1Ctx->ret = 4096;
+    w1Ctx->cb(w1Ctx);
+    ASSERT_EQ(3, finished);
+    ASSERT_EQ(4096, w1.ctx.ret);
+}
+
+TEST_F(RequestCombinerTest, IssueWhenWindowExpired) {
+    RequestCombinerOption option;
+    option.windowUs = 1000;
+    auto combiner = std::make_shared<RequestCombiner>(option, client_);
+
+    Request first(LIBAIO_OP::LIBAIO_OP_READ, 0, 4096);
+    Request second(LIBAIO_OP::LIBAIO_OP_READ, 8192, 4096);
+
+    std::atomic<int> issued{0};
+    std::vector<CurveAioContext*> curveCtxs(2);
+    EXPECT_CALL(*client_, AioRead(1, _, _))
+        .Times(2)
+        .WillRepeatedly(Invoke([&](int fd, CurveAioContext* ctx,
+                                   curve::client::UserDataType type) {
+            (void)fd;
+            (void)type;
+            curveCtxs[issued] = ctx;
+            ++issued;
+            return LIBCURVE_ERROR::OK;
+        }));
+
+    ASSERT_EQ(0, combiner->AioRead(1, &first.ctx));
+    ASSERT_EQ(0, combiner->AioRead(1, &second.ctx));
+
+    for (int i = 0; i < 100 && issued.load() < 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(2, issued.load());
+    ASSERT_EQ(8192, curveCtxs[1]->offset);
+
+    for (auto* ctx : curveCtxs) {
+        ctx->ret = ctx->length;
+        ctx->cb(ctx);
+    }
+    ASSERT_EQ(2, finished);
+}
+
+}  // namespace server
+}  // namespace nebd
@@ -0,0 +1,184 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <butil/iobuf.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "nebd/src/part2/shm_server.h"
+#include "nebd/test/part2/mock_file_manager.h"
+
+namespace nebd {
+namespace server {
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+
+using nebd::common::ShmDescId;
+using nebd::common::ShmDescSeq;
+using nebd::common::ShmQueue;
+using nebd::common::SharedMemoryRegion;
+
+namespace {
+
+const uint32_t kSlotSize = 8192;
+
+bool WaitComplete(SharedMemoryRegion* region, ShmIODesc* desc) {
+    ShmQueue* queue = region->CompleteQueue();
+    for (int i = 0; i < 50; ++i) {
+        if (queue->Pop(desc)) {
+            return true;
+        }
+        queue->Wait(100);
+    }
+    return false;
+}
+
+ShmIODesc Desc(uint32_t slot, uint32_t seq, LIBAIO_OP op, uint64_t length) {
+    ShmIODesc desc;
+    desc.id = ShmDescId(slot, seq);
+    desc.fd = 1;
+    desc.op = static_cast<uint32_t>(op);
+    desc.offset = 4096;
+    desc.length = length;
+    desc.ret = 0;
+    return desc;
+}
+
+}  // namespace
+
+class ShmServerTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        name_ = "/nebd-shm-server-test-" + std::to_string(getpid());
+        ASSERT_EQ(0, client_.Create(name_, 4, kSlotSize));
+        fileManager_ = std::make_shared<MockFileManager>();
+    }
+
+    void TearDown() override {
+        client_.Close();
+    }
+
+    std::string name_;
+    SharedMemoryRegion client_;
+    std::shared_ptr<MockFileManager> fileManager_;
+};
+
+TEST_F(ShmServerTest, ReadWrite) {
+    NebdShmServer server(fileManager_, false);
+    uint64_t token = 0;
+    ASSERT_EQ(-1, server.Attach("/nebd-shm-server-test-none", &token));
+    ASSERT_EQ(0, server.Attach(name_, &token));
+    ASSERT_NE(0, token);
+    ASSERT_EQ(token, client_.ServerToken());
+
+    // 重复映射返回同样的标识
+    uint64_t token2 = 0;
+    ASSERT_EQ(0, server.Attach(name_, &token2));
+    ASSERT_EQ(token, token2);
+
+    // 写请求直接使用slot中的数据
+    memset(client_.Slot(1), 'w', kSlotSize);
+    EXPECT_CALL(*fileManager_, AioWrite(1, _))
+        .WillOnce(Invoke([](int fd, NebdServerAioContext* context) {
+            (void)fd;
+            auto* buf = reinterpret_cast<butil::IOBuf*>(context->buf);
+            EXPECT_EQ(4096, context->offset);
+            EXPECT_EQ(kSlotSize, buf->size());
+            EXPECT_EQ(std::string(kSlotSize, 'w'), buf->to_string());
+            context->ret = 0;
+            context->cb(context);
+            return 0;
+        }));
+    ASSERT_TRUE(client_.SubmitQueue()->Push(
+        Desc(1, 3, LIBAIO_OP::LIBAIO_OP_WRITE, kSlotSize)));
+    client_.SubmitQueue()->Notify();
+
+    ShmIODesc desc;
+    ASSERT_TRUE(WaitComplete(&client_, &desc));
+    ASSERT_EQ(ShmDescId(1, 3), desc.id);
+    ASSERT_EQ(0, desc.ret);
+
+    // 读到的数据放入slot
+    EXPECT_CALL(*fileManager_, AioRead(1, _))
+        .WillOnce(Invoke([](int fd, NebdServerAioContext* context) {
+            (void)fd;
+            auto* buf = reinterpret_cast<butil::IOBuf*>(context->buf);
+            buf->append(std::string(context->size, 'r'));
+            context->ret = 0;
+            context->cb(context);
+            return 0;
+        }));
+    ASSERT_TRUE(client_.SubmitQueue()->Push(
+        Desc(2, 1, LIBAIO_OP::LIBAIO_OP_READ, 4096)));
+    client_.SubmitQueue()->Notify();
+    ASSERT_TRUE(WaitComplete(&client_, &desc));
+    ASSERT_EQ(ShmDescId(2, 1), desc.id);
+    ASSERT_EQ(0, desc.ret);
+    ASSERT_EQ(std::string(4096, 'r'), std::string(client_.Slot(2), 4096));
+
+    server.Detach(name_);
+}
+
+TEST_F(ShmServerTest, Failed) {
+    NebdShmServer server(fileManager_, true);
+    uint64_t token = 0;
+    ASSERT_EQ(0, server.Attach(name_, &token));
+
+    // 越界的请求
+    ASSERT_TRUE(client_.SubmitQueue()->Push(
+        Desc(2, 1, LIBAIO_OP::LIBAIO_OP_READ, kSlotSize + 1)));
+    client_.SubmitQueue()->Notify();
+    ShmIODesc desc;
+    ASSERT_TRUE(WaitComplete(&client_, &desc));
+    ASSERT_EQ(ShmDescId(2, 1), desc.id);
+    ASSERT_EQ(-1, desc.ret);
+
+    // 文件没有打开
+    EXPECT_CALL(*fileManager_, AioRead(1, _)).WillOnce(Return(-1));
+    ASSERT_TRUE(client_.SubmitQueue()->Push(
+        Desc(0, 2, LIBAIO_OP::LIBAIO_OP_READ, 4096)));
+    client_.SubmitQueue()->Notify();
+    ASSERT_TRUE(WaitComplete(&client_, &desc));
+    ASSERT_EQ(ShmDescId(0, 2), desc.id);
+    ASSERT_EQ(-1, desc.ret);
+
+    // io错误
+    EXPECT_CALL(*fileManager_, AioWrite(1, _))
+        .WillOnce(Invoke([](int fd, NebdServerAioContext* context) {
+            (void)fd;
+            context->ret = -1;
+            context->cb(context);
+            return 0;
+        }));
+    ASSERT_TRUE(client_.SubmitQueue()->Push(
+        Desc(3, 5, LIBAIO_OP::LIBAIO_OP_WRITE, 4096)));
+    client_.SubmitQueue()->Notify();
+    ASSERT_TRUE(WaitComplete(&client_, &desc));
+    ASSERT_EQ(5, ShmDescSeq(desc.id));
+    ASSERT_EQ(-1, desc.ret);
+
+    server.Fini();
+}
+
+}  // namespace server
+}  // namespace nebd
@@ -35,6 +35,7 @@
 #include "src/chunkserver/chunkserver_metrics.h"
 #include "src/chunkserver/op_request.h"
 #include "src/chunkserver/chunk_service_closure.h"
+#include "src/chunkserver/qos_scheduler.h"
 #include "src/common/fast_align.h"
 
 #include "include/curve_compiler_specific.h"
@@ -50,6 +51,7 @@ ChunkServiceImpl::ChunkServiceImpl(
     : chunkServiceOptions_(chunkServiceOptions),
       copysetNodeManager_(chunkServiceOptions.copysetNodeManager),
       inflightThrottle_(chunkServiceOptions.inflightThrottle),
+      qosScheduler_(chunkServiceOptions.qosScheduler),
       epochMap_(epochMap),
       blockSize_(copysetNodeManager_->GetCopysetNodeOptions().blockSize) {
     maxChunkSize_ = copysetNodeManager_->GetCopysetNodeOptions().maxChunkSize;
@@ -106,9 +108,21 @@ void ChunkServiceImpl::WriteChunk(RpcController *controller,
                                                done);
     CHECK(nullptr != closure) << "new chunk service closure failed";
 
-    brpc::ClosureGuard doneGuard(closure);
+    if (nullptr != qosScheduler_) {
+        SubmitToQos(controller, request, response, closure,
+                    &ChunkServiceImpl::DoWriteChunk);
+        return;
+    }
+    DoWriteChunk(controller, request, response, closure);
+}
 
-    if (inflightThrottle_->IsOverLoad()) {
+void ChunkServiceImpl::DoWriteChunk(RpcController *controller,
+                                    const ChunkRequest *request,
+                                    ChunkResponse *response,
+                                    Closure *done) {
+    brpc::ClosureGuard doneGuard(done);
+
+    if (nullptr == qosScheduler_ && inflightThrottle_->IsOverLoad()) {
         response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD);
         LOG_EVERY_N(WARNING, 100)
             << "WriteChunk: "
@@ -212,6 +226,33 @@ void ChunkServiceImpl::CreateCloneChunk(RpcController *controller,
     req->Process();
 }
 
+void ChunkServiceImpl::CreateCloneChunks(
+    RpcController *controller,
+    const CreateCloneChunksRequest *request,
+    CreateCloneChunksResponse *response,
+    Closure *done) {
+    ChunkRequestsClosure* closure = new (std::nothrow) ChunkRequestsClosure(
+        request->requests_size(), response->mutable_responses(), done);
+    CHECK(nullptr != closure) << "new create clone chunks closure failed";
+
+    // 每个请求都和单独的CreateCloneChunk请求一样经过流控和检查，
+    // 各自提交raft，同一个copyset的请求由raft合并落盘和复制
+    for (int i = 0; i < request->requests_size(); ++i) {
+        const ChunkRequest &chunkRequest = request->requests(i);
+        ChunkResponse *chunkResponse = response->mutable_responses(i);
+        if (chunkRequest.optype() != CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE) {
+            chunkResponse->set_status(
+                CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST);
+            LOG(ERROR) << "CreateCloneChunks only accepts create clone "
+                       << "requests: " << chunkRequest.ShortDebugString();
+            closure->Run();
+            continue;
+        }
+        CreateCloneChunk(controller, &chunkRequest, chunkResponse, closure);
+    }
+    closure->Run();
+}
+
 void ChunkServiceImpl::CreateS3CloneChunk(RpcController* controller,
                        const CreateS3CloneChunkRequest* request,
                        CreateS3CloneChunkResponse* response,
@@ -234,9 +275,21 @@ void ChunkServiceImpl::ReadChunk(RpcController *controller,
                                                done);
     CHECK(nullptr != closure) << "new chunk service closure failed";
 
-    brpc::ClosureGuard doneGuard(closure);
+    if (nullptr != qosScheduler_) {
+        SubmitToQos(controller, request, response, closure,
+                    &ChunkServiceImpl::DoReadChunk);
+        return;
+    }
+    DoReadChunk(controller, request, response, closure);
+}
 
-    if (inflightThrottle_->IsOverLoad()) {
+void ChunkServiceImpl::DoReadChunk(RpcController *controller,
+                                   const ChunkRequest *request,
+                                   ChunkResponse *response,
+                                   Closure *done) {
+    brpc::ClosureGuard doneGuard(done);
+
+    if (nullptr == qosScheduler_ && inflightThrottle_->IsOverLoad()) {
         response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD);
         LOG_EVERY_N(WARNING, 100)
             << "ReadChunk: "
@@ -274,6 +327,35 @@ void ChunkServiceImpl::ReadChunk(RpcController *controller,
     req->Process();
 }
 
+void ChunkServiceImpl::ReadChunks(RpcController *controller,
+                                  const ReadChunksRequest *request,
+                                  ReadChunksResponse *response,
+                                  Closure *done) {
+    ReadChunksClosure* closure =
+        new (std::nothrow) ReadChunksClosure(
+            dynamic_cast<brpc::Controller *>(controller),
+            request,
+            response,
+            done);
+    CHECK(nullptr != closure) << "new read chunks closure failed";
+
+    // 每个读请求都和单独的ReadChunk请求一样经过流控、qos和metric统计
+    for (int i = 0; i < request->requests_size(); ++i) {
+        const ChunkRequest &chunkRequest = request->requests(i);
+        ChunkResponse *chunkResponse = response->mutable_responses(i);
+        if (chunkRequest.optype() != CHUNK_OP_TYPE::CHUNK_OP_READ) {
+            chunkResponse->set_status(
+                CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST);
+            LOG(ERROR) << "ReadChunks only accepts read requests: "
+                       << chunkRequest.ShortDebugString();
+            closure->Run();
+            continue;
+        }
+        ReadChunk(closure->GetCntl(i), &chunkRequest, chunkResponse, closure);
+    }
+    closure->Run();
+}
+
 void ChunkServiceImpl::RecoverChunk(RpcController *controller,
                                     const ChunkRequest *request,
                                     ChunkResponse *response,
@@ -326,6 +408,32 @@ void ChunkServiceImpl::RecoverChunk(RpcController *controller,
     req->Process();
 }
 
+void ChunkServiceImpl::RecoverChunks(RpcController *controller,
+                                     const RecoverChunksRequest *request,
+                                     RecoverChunksResponse *response,
+                                     Closure *done) {
+    ChunkRequestsClosure* closure = new (std::nothrow) ChunkRequestsClosure(
+        request->requests_size(), response->mutable_responses(), done);
+    CHECK(nullptr != closure) << "new recover chunks closure failed";
+
+    // 每个请求都和单独的RecoverChunk请求一样经过流控和检查，
+    // 由各自的copyset从源端拷贝数据
+    for (int i = 0; i < request->requests_size(); ++i) {
+        const ChunkRequest &chunkRequest = request->requests(i);
+        ChunkResponse *chunkResponse = response->mutable_responses(i);
+        if (chunkRequest.optype() != CHUNK_OP_TYPE::CHUNK_OP_RECOVER) {
+            chunkResponse->set_status(
+                CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST);
+            LOG(ERROR) << "RecoverChunks only accepts recover requests: "
+                       << chunkRequest.ShortDebugString();
+            closure->Run();
+            continue;
+        }
+        RecoverChunk(controller, &chunkRequest, chunkResponse, closure);
+    }
+    closure->Run();
+}
+
 void ChunkServiceImpl::ReadChunkSnapshot(RpcController *controller,
                                          const ChunkRequest *request,
                                          ChunkResponse *response,
@@ -577,6 +685,30 @@ void ChunkServiceImpl::UpdateEpoch(RpcController *controller,
     }
 }
 
+bool ChunkServiceImpl::SubmitToQos(RpcController *controller,
+                                   const ChunkRequest *request,
+                                   ChunkResponse *response,
+                                   Closure *done,
+                                   ChunkHandler handler) {
+    auto task = [this, controller, request, response, handler](
+                    Closure *qosDone) {
+        (this->*handler)(controller, request, response, qosDone);
+    };
+    if (qosScheduler_->Submit(request->logicpoolid(),
+                              request->copysetid(),
+                              done,
+                              task)) {
+        return true;
+    }
+    brpc::ClosureGuard doneGuard(done);
+    response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD);
+    LOG_EVERY_N(WARNING, 100)
+        << "I/O request, op: " << request->optype()
+        << ", too many requests queued on copyset("
+        << request->logicpoolid() << "," << request->copysetid() << ")";
+    return false;
+}
+
 bool ChunkServiceImpl::CheckRequestOffsetAndLength(uint32_t offset,
                                                    uint32_t len) const {
     // 检查offset+len是否越界
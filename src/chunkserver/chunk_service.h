@@ -60,6 +60,11 @@ class ChunkServiceImpl : public ChunkService {
                     ChunkResponse *response,
                     Closure *done);
 
+    void ReadChunks(RpcController *controller,
+                    const ReadChunksRequest *request,
+                    ReadChunksResponse *response,
+                    Closure *done);
+
     void ReadChunkSnapshot(RpcController *controller,
                            const ChunkRequest *request,
                            ChunkResponse *response,
@@ -74,6 +79,11 @@ class ChunkServiceImpl : public ChunkService {
                           const ChunkRequest *request,
                           ChunkResponse *response,
                           Closure *done);
+
+    void CreateCloneChunks(RpcController *controller,
+                           const CreateCloneChunksRequest *request,
+                           CreateCloneChunksResponse *response,
+                           Closure *done);
     void CreateS3CloneChunk(RpcController* controller,
                        const CreateS3CloneChunkRequest* request,
                        CreateS3CloneChunkResponse* response,
@@ -83,6 +93,11 @@ class ChunkServiceImpl : public ChunkService {
                       ChunkResponse *response,
                       Closure *done);
 
+    void RecoverChunks(RpcController *controller,
+                       const RecoverChunksRequest *request,
+                       RecoverChunksResponse *response,
+                       Closure *done);
+
     void GetChunkInfo(RpcController *controller,
                       const GetChunkInfoRequest *request,
                       GetChunkInfoResponse *response,
@@ -107,10 +122,36 @@ class ChunkServiceImpl : public ChunkService {
      */
     bool CheckRequestOffsetAndLength(uint32_t offset, uint32_t len) const;
 
+    using ChunkHandler = void (ChunkServiceImpl::*)(RpcController *,
+                                                    const ChunkRequest *,
+                                                    ChunkResponse *,
+                                                    Closure *);
+
+    /**
+     * 把读写请求交给qos调度器，调度到时执行handler
+     * @return 调度器的队列已满时返回false，请求被拒绝
+     */
+    bool SubmitToQos(RpcController *controller,
+                     const ChunkRequest *request,
+                     ChunkResponse *response,
+                     Closure *done,
+                     ChunkHandler handler);
+
+    void DoReadChunk(RpcController *controller,
+                     const ChunkRequest *request,
+                     ChunkResponse *response,
+                     Closure *done);
+
+    void DoWriteChunk(RpcController *controller,
+                      const ChunkRequest *request,
+                      ChunkResponse *response,
+                      Closure *done);
+
  private:
     ChunkServiceOptions chunkServiceOptions_;
     CopysetNodeManager  *copysetNodeManager_;
     std::shared_ptr<InflightThrottle> inflightThrottle_;
+    QosScheduler        *qosScheduler_;
     uint32_t            maxChunkSize_;
 
     std::shared_ptr<EpochMap> epochMap_;
@@ -151,5 +151,58 @@ void ChunkServiceClosure::OnResonse() {
     }
 }
 
+ReadChunksClosure::ReadChunksClosure(brpc::Controller *cntl,
+                                     const ReadChunksRequest *request,
+                                     ReadChunksResponse *response,
+                                     google::protobuf::Closure *done)
+    : cntl_(cntl)
+    , request_(request)
+    , response_(response)
+    , brpcDone_(done)
+    , cntls_(new brpc::Controller[request->requests_size()])
+    , pending_(request->requests_size() + 1) {
+    for (int i = 0; i < request->requests_size(); ++i) {
+        response->add_responses()->set_status(
+            CHUNK_OP_STATUS::CHUNK_OP_STATUS_FAILURE_UNKNOWN);
+    }
+}
+
+void ReadChunksClosure::Run() {
+    if (pending_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    std::unique_ptr<ReadChunksClosure> selfGuard(this);
+    brpc::ClosureGuard doneGuard(brpcDone_);
+    for (int i = 0; i < request_->requests_size(); ++i) {
+        if (response_->responses(i).status()
+            == CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS) {
+            cntl_->response_attachment().append(
+                cntls_[i].response_attachment());
+        }
+    }
+}
+
+ChunkRequestsClosure::ChunkRequestsClosure(
+    int requestNum,
+    google::protobuf::RepeatedPtrField<ChunkResponse> *responses,
+    google::protobuf::Closure *done)
+    : brpcDone_(done)
+    , pending_(requestNum + 1) {
+    for (int i = 0; i < requestNum; ++i) {
+        responses->Add()->set_status(
+            CHUNK_OP_STATUS::CHUNK_OP_STATUS_FAILURE_UNKNOWN);
+    }
+}
+
+void ChunkRequestsClosure::Run() {
+    if (pending_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    std::unique_ptr<ChunkRequestsClosure> selfGuard(this);
+    brpc::ClosureGuard doneGuard(brpcDone_);
+}
+
 }  // namespace chunkserver
 }  // namespace curve
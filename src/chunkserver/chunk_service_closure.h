@@ -24,6 +24,8 @@
 #define SRC_CHUNKSERVER_CHUNK_SERVICE_CLOSURE_H_
 
 #include <brpc/closure_guard.h>
+#include <brpc/controller.h>
+#include <atomic>
 #include <memory>
 
 #include "proto/chunk.pb.h"
@@ -87,6 +89,71 @@ class ChunkServiceClosure : public braft::Closure {
     uint64_t receivedTimeUs_;
 };
 
+/**
+ * ReadChunks请求的闭包，ReadChunks中的每个读请求都有自己的controller，
+ * 和单独的ReadChunk请求一样处理，全部返回后按顺序把读到的数据拼接到
+ * rpc的response attachment中
+ */
+class ReadChunksClosure : public google::protobuf::Closure {
+ public:
+    ReadChunksClosure(brpc::Controller *cntl,
+                      const ReadChunksRequest *request,
+                      ReadChunksResponse *response,
+                      google::protobuf::Closure *done);
+
+    ~ReadChunksClosure() = default;
+
+    // 第index个读请求使用的controller
+    brpc::Controller* GetCntl(int index) {
+        return &cntls_[index];
+    }
+
+    /**
+     * 每个读请求返回时调用一次，另外分发完所有读请求后调用一次，
+     * 最后一次调用时返回rpc
+     */
+    void Run() override;
+
+ private:
+    brpc::Controller *cntl_;
+    const ReadChunksRequest *request_;
+    ReadChunksResponse *response_;
+    google::protobuf::Closure *brpcDone_;
+    std::unique_ptr<brpc::Controller[]> cntls_;
+    // 还没有返回的读请求数量，包括分发请求的这一次
+    std::atomic<int> pending_;
+};
+
+/**
+ * CreateCloneChunks、RecoverChunks等批量请求的闭包，其中的每个请求和单独的
+ * 请求一样处理，全部返回后返回rpc
+ */
+class ChunkRequestsClosure : public google::protobuf::Closure {
+ public:
+    /**
+     * @param requestNum 批量请求中的请求数量
+     * @param responses 批量请求的响应，为每个请求添加一个响应
+     * @param done rpc的闭包
+     */
+    ChunkRequestsClosure(
+        int requestNum,
+        google::protobuf::RepeatedPtrField<ChunkResponse> *responses,
+        google::protobuf::Closure *done);
+
+    ~ChunkRequestsClosure() = default;
+
+    /**
+     * 每个请求返回时调用一次，另外分发完所有请求后调用一次，
+     * 最后一次调用时返回rpc
+     */
+    void Run() override;
+
+ private:
+    google::protobuf::Closure *brpcDone_;
+    // 还没有返回的请求数量，包括分发请求的这一次
+    std::atomic<int> pending_;
+};
+
 }  // namespace chunkserver
 }  // namespace curve
 
@@ -27,8 +27,11 @@
 #include <braft/storage.h>
 #include <butil/endpoint.h>
 #include <glog/logging.h>
+#include <sys/stat.h>
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "src/chunkserver/braft_cli_service.h"
 #include "src/chunkserver/braft_cli_service2.h"
@@ -38,6 +41,7 @@
 #include "src/chunkserver/chunkserver_service.h"
 #include "src/chunkserver/copyset_service.h"
 #include "src/chunkserver/raftlog/curve_segment_log_storage.h"
+#include "src/chunkserver/raftlog/shared_log_storage.h"
 #include "src/chunkserver/raftsnapshot/curve_file_service.h"
 #include "src/chunkserver/raftsnapshot/curve_snapshot_attachment.h"
 #include "src/chunkserver/raftsnapshot/curve_snapshot_storage.h"
@@ -46,6 +50,13 @@
 #include "src/common/curve_version.h"
 #include "src/common/uri_parser.h"
 #include "src/common/log_util.h"
+#include "src/common/string_util.h"
+
+namespace braft {
+DECLARE_int32(raft_election_heartbeat_factor);
+DECLARE_int32(raft_max_entries_size);
+DECLARE_int32(raft_max_body_size);
+}  // namespace braft
 
 using ::curve::fs::LocalFileSystem;
 using ::curve::fs::LocalFileSystemOption;
@@ -54,6 +65,39 @@ using ::curve::fs::FileSystemType;
 using ::curve::chunkserver::concurrent::ConcurrentApplyModule;
 using ::curve::common::UriParser;
 
+namespace {
+
+// 路径所在的设备，路径还不存在时取它最近的已存在的上级目录
+bool GetDeviceOfPath(const std::string& path, dev_t* dev) {
+    std::string current = path.empty() ? "." : path;
+    while (true) {
+        struct stat st;
+        if (::stat(current.c_str(), &st) == 0) {
+            *dev = st.st_dev;
+            return true;
+        }
+        if (current == "." || current == "/") {
+            return false;
+        }
+        size_t pos = current.find_last_of('/');
+        if (pos == std::string::npos) {
+            current = ".";
+        } else if (pos == 0) {
+            current = "/";
+        } else {
+            current = current.substr(0, pos);
+        }
+    }
+}
+
+bool OnSameDevice(const std::string& path1, const std::string& path2) {
+    dev_t dev1, dev2;
+    return GetDeviceOfPath(path1, &dev1) && GetDeviceOfPath(path2, &dev2) &&
+           dev1 == dev2;
+}
+
+}  // namespace
+
 DEFINE_string(conf, "ChunkServer.conf", "Path of configuration file");
 DEFINE_string(chunkServerIp, "127.0.0.1", "chunkserver ip");
 DEFINE_bool(enableExternalServer, false, "start external server or not");
@@ -92,6 +136,7 @@ int ChunkServer::Run(int argc, char** argv) {
     gflags::ParseCommandLineFlags(&argc, &argv, true);
 
     RegisterCurveSegmentLogStorageOrDie();
+    RegisterSharedLogStorageOrDie();
 
     // ==========================加载配置项===============================//
     LOG(INFO) << "Loading Configuration.";
@@ -104,6 +149,7 @@ int ChunkServer::Run(int argc, char** argv) {
         << conf.GetConfigPath();
     // 命令行可以覆盖配置文件中的参数
     LoadConfigFromCmdline(&conf);
+    InitBRaftFlags(&conf);
 
     // 初始化日志模块
     curve::common::DisableLoggingToStdErr();
@@ -116,6 +162,18 @@ int ChunkServer::Run(int argc, char** argv) {
     // ============================初始化各模块==========================//
     LOG(INFO) << "Initializing ChunkServer modules";
 
+    // 绑定numa节点要在创建其他线程之前，新线程继承cpu亲和性和内存分配策略
+    NumaAffinityOptions numaOptions;
+    InitNumaAffinityOptions(&conf, &numaOptions);
+    LOG_IF(FATAL, NumaAffinity::GetInstance()->Init(numaOptions) != 0)
+        << "Failed to bind chunkserver to numa node.";
+
+    // 绑定numa节点之后预留数据缓冲区，缓冲区的内存分配在绑定的节点上
+    BufferPoolOptions bufferPoolOptions;
+    InitBufferPoolOptions(&conf, &bufferPoolOptions);
+    LOG_IF(FATAL, BufferPool::Init(bufferPoolOptions) != 0)
+        << "Failed to init data buffer pool.";
+
     // 优先初始化 metric 收集模块
     ChunkServerMetricOptions metricOptions;
     InitMetricOptions(&conf, &metricOptions);
@@ -131,11 +189,20 @@ int ChunkServer::Run(int argc, char** argv) {
         << "Failed to initialize concurrentapply module!";
 
     // 初始化本地文件系统
-    std::shared_ptr<LocalFileSystem> fs(
-        LocalFsFactory::CreateFs(FileSystemType::EXT4, ""));
     LocalFileSystemOption lfsOption;
     LOG_IF(FATAL, !conf.GetBoolValue(
         "fs.enable_renameat2", &lfsOption.enableRenameat2));
+    bool enableIoUring = false;
+    LOG_IF(WARNING, !conf.GetBoolValue("fs.enable_io_uring", &enableIoUring))
+        << "config no fs.enable_io_uring info, using default value "
+        << enableIoUring;
+    LOG_IF(WARNING, !conf.GetUInt32Value("fs.io_uring_queue_depth",
+                                         &lfsOption.ioUringQueueDepth))
+        << "config no fs.io_uring_queue_depth info, using default value "
+        << lfsOption.ioUringQueueDepth;
+    std::shared_ptr<LocalFileSystem> fs(LocalFsFactory::CreateFs(
+        enableIoUring ? FileSystemType::EXT4_IO_URING : FileSystemType::EXT4,
+        ""));
     LOG_IF(FATAL, 0 != fs->Init(lfsOption))
         << "Failed to initialize local filesystem module!";
 
@@ -174,6 +241,28 @@ int ChunkServer::Run(int argc, char** argv) {
             &useChunkFilePoolAsWalPoolReserve));
             LOG(INFO) << "initialize to use chunkfilePool as walpool success.";
         }
+
+        // raft日志的segment从wal pool中rename得到，两者必须在同一个设备上
+        const FilePoolOptions& walPoolOpt = walFilePool->GetFilePoolOpt();
+        const std::string raftLogPath =
+            UriParser::GetPathFromUri(raftLogUri);
+        LOG_IF(FATAL, walPoolOpt.getFileFromPool &&
+                      !OnSameDevice(raftLogPath, walPoolOpt.filePoolDir))
+            << "raft log " << raftLogPath << " and wal pool "
+            << walPoolOpt.filePoolDir << " must be on the same device";
+    }
+
+    // Init shared wal stream, all copysets append to it
+    if (raftLogProtocol == kProtocolCurveShared) {
+        std::string sharedWalDir;
+        LOG_IF(FATAL, !conf.GetStringValue("copyset.shared_wal_dir",
+                                           &sharedWalDir));
+        auto sharedLogStream = std::make_shared<SharedLogStream>(
+            sharedWalDir, FLAGS_sharedWalFileSize);
+        LOG_IF(FATAL, sharedLogStream->Init() != 0)
+            << "Failed to init shared wal stream";
+        StoreSharedLogStream(sharedLogStream);
+        LOG(INFO) << "initialize shared wal stream success.";
     }
 
     // 远端拷贝管理模块选项
@@ -192,6 +281,7 @@ int ChunkServer::Run(int argc, char** argv) {
     LOG_IF(FATAL, !conf.GetBoolValue("clone.enable_paste", &enablePaste));
     cloneOptions.core =
         std::make_shared<CloneCore>(sliceSize, enablePaste, copyer);
+    cloneOptions.flattener = &cloneFlattener_;
     LOG_IF(FATAL, cloneManager_.Init(cloneOptions) != 0)
         << "Failed to initialize clone manager.";
 
@@ -249,6 +339,15 @@ int ChunkServer::Run(int argc, char** argv) {
     copysetNodeOptions.walFilePool = walFilePool;
     copysetNodeOptions.localFileSystem = fs;
     copysetNodeOptions.trash = trash_;
+    if (copysetNodeOptions.syncFsMinChunks > 0) {
+        copysetNodeOptions.syncFsGroup = std::make_shared<SyncFsGroup>(fs);
+    }
+    ChunkPageCacheOptions pageCacheOptions;
+    InitPageCacheOptions(&conf, &pageCacheOptions);
+    if (pageCacheOptions.capacity > 0) {
+        copysetNodeOptions.pageCache =
+            std::make_shared<ChunkPageCache>(pageCacheOptions);
+    }
     if (nullptr != walFilePool) {
         FilePoolOptions poolOpt = walFilePool->GetFilePoolOpt();
         uint32_t maxWalSegmentSize = poolOpt.fileSize + poolOpt.metaPageSize;
@@ -291,6 +390,14 @@ int ChunkServer::Run(int argc, char** argv) {
     // 注册curve snapshot storage
     RegisterCurveSnapshotStorageOrDie();
     CurveSnapshotStorage::set_server_addr(endPoint);
+    // install snapshot时并发下载的文件数
+    uint32_t snapshotCopyConcurrency = 1;
+    LOG_IF(WARNING, !conf.GetUInt32Value(
+                        "chunkserver.snapshot_copy_concurrency",
+                        &snapshotCopyConcurrency))
+        << "config no chunkserver.snapshot_copy_concurrency info, "
+        << "using default value " << snapshotCopyConcurrency;
+    CurveSnapshotStorage::set_copy_concurrency(snapshotCopyConcurrency);
     copysetNodeManager_ = &CopysetNodeManager::GetInstance();
     LOG_IF(FATAL, copysetNodeManager_->Init(copysetNodeOptions) != 0)
         << "Failed to initialize CopysetNodeManager.";
@@ -302,6 +409,18 @@ int ChunkServer::Run(int argc, char** argv) {
     LOG_IF(FATAL, scanManager_.Init(scanOpts) != 0)
         << "Failed to init scan manager.";
 
+    // qos调度器初始化
+    bool enableQos = false;
+    LOG_IF(WARNING, !conf.GetBoolValue("chunkserver.qos.enable", &enableQos))
+        << "config no chunkserver.qos.enable info, using default value "
+        << enableQos;
+    if (enableQos) {
+        QosSchedulerOptions qosOptions;
+        InitQosSchedulerOptions(&conf, &qosOptions);
+        LOG_IF(FATAL, qosScheduler_.Init(qosOptions) != 0)
+            << "Failed to init qos scheduler.";
+    }
+
     // 心跳模块初始化
     HeartbeatOptions heartbeatOptions;
     InitHeartbeatOptions(&conf, &heartbeatOptions);
@@ -311,6 +430,18 @@ int ChunkServer::Run(int argc, char** argv) {
     heartbeatOptions.chunkserverId = metadata.id();
     heartbeatOptions.chunkserverToken = metadata.token();
     heartbeatOptions.scanManager = &scanManager_;
+    heartbeatOptions.qosScheduler = enableQos ? &qosScheduler_ : nullptr;
+    // wal放在单独的设备上时，心跳中检查这个设备，它出错时上报磁盘错误
+    std::string walPath = UriParser::GetPathFromUri(raftLogUri);
+    if (raftLogProtocol == kProtocolCurveShared) {
+        LOG_IF(FATAL, !conf.GetStringValue("copyset.shared_wal_dir",
+                                           &walPath));
+    }
+    if (!OnSameDevice(walPath,
+                      UriParser::GetPathFromUri(heartbeatOptions.storeUri))) {
+        LOG(INFO) << "wal " << walPath << " is on a separate device";
+        heartbeatOptions.walPath = walPath;
+    }
     LOG_IF(FATAL, heartbeat_.Init(heartbeatOptions) != 0)
         << "Failed to init Heartbeat manager.";
 
@@ -344,11 +475,22 @@ int ChunkServer::Run(int argc, char** argv) {
         = std::make_shared<InflightThrottle>(maxInflight);
     CHECK(nullptr != inflightThrottle) << "new inflight throttle failed";
 
+    // clone flattener
+    CloneFlattenerOptions flattenerOptions;
+    InitCloneFlattenerOptions(&conf, &flattenerOptions);
+    flattenerOptions.copysetNodeManager = copysetNodeManager_;
+    flattenerOptions.cloneManager = &cloneManager_;
+    flattenerOptions.inflightThrottle = inflightThrottle;
+    flattenerOptions.sliceSize = sliceSize;
+    LOG_IF(FATAL, cloneFlattener_.Init(flattenerOptions) != 0)
+        << "Failed to init clone flattener.";
+
     // chunk service
     ChunkServiceOptions chunkServiceOptions;
     chunkServiceOptions.copysetNodeManager = copysetNodeManager_;
     chunkServiceOptions.cloneManager = &cloneManager_;
     chunkServiceOptions.inflightThrottle = inflightThrottle;
+    chunkServiceOptions.qosScheduler = enableQos ? &qosScheduler_ : nullptr;
 
     ChunkServiceImpl chunkService(chunkServiceOptions, epochMap);
     ret = server.AddService(&chunkService,
@@ -443,6 +585,8 @@ int ChunkServer::Run(int argc, char** argv) {
         << "Failed to start CopysetNodeManager.";
     LOG_IF(FATAL, scanManager_.Run() != 0)
         << "Failed to start scan manager.";
+    LOG_IF(FATAL, cloneFlattener_.Run() != 0)
+        << "Failed to start clone flattener.";
     LOG_IF(FATAL, !chunkfilePool->StartCleaning())
         << "Failed to start file pool clean worker.";
 
@@ -454,6 +598,10 @@ int ChunkServer::Run(int argc, char** argv) {
     LOG(INFO) << "ChunkServer is going to quit.";
     LOG_IF(ERROR, scanManager_.Fini() != 0)
         << "Failed to shutdown scan manager.";
+    LOG_IF(ERROR, cloneFlattener_.Fini() != 0)
+        << "Failed to shutdown clone flattener.";
+    // 排队的请求全部执行完，rpc服务才能退出
+    qosScheduler_.Fini();
 
     if (registerOptions.enableExternalServer) {
         externalServer.Stop(0);
@@ -545,6 +693,20 @@ void ChunkServer::InitChunkFilePoolOptions(
                                      &chunkFilePoolOptions->bytesPerWrite));
         LOG_IF(FATAL, !conf->GetUInt32Value("chunkfilepool.clean.throttle_iops",
             &chunkFilePoolOptions->iops4clean));
+        LOG_IF(WARNING, !conf->GetUInt32Value("chunkfilepool.clean.watermark",
+            &chunkFilePoolOptions->cleanWatermark))
+            << "config no chunkfilepool.clean.watermark info, using default "
+            << "value " << chunkFilePoolOptions->cleanWatermark;
+        LOG_IF(WARNING, !conf->GetUInt32Value(
+            "chunkfilepool.clean.latency_threshold_us",
+            &chunkFilePoolOptions->cleanLatencyThresholdUs))
+            << "config no chunkfilepool.clean.latency_threshold_us info, "
+            << "using default value "
+            << chunkFilePoolOptions->cleanLatencyThresholdUs;
+        LOG_IF(WARNING, !conf->GetBoolValue("chunkfilepool.clean.zero_range",
+            &chunkFilePoolOptions->cleanWithZeroRange))
+            << "config no chunkfilepool.clean.zero_range info, using default "
+            << "value " << chunkFilePoolOptions->cleanWithZeroRange;
 
         std::string copysetUri;
         LOG_IF(FATAL,
@@ -585,8 +747,16 @@ void ChunkServer::InitConcurrentApplyOptions(common::Configuration *conf,
         "wconcurrentapply.size", &concurrentApplyOptions->wconcurrentsize));
     LOG_IF(FATAL, !conf->GetIntValue(
         "rconcurrentapply.queuedepth", &concurrentApplyOptions->rqueuedepth));
+    LOG_IF(WARNING, !conf->GetBoolValue("rconcurrentapply.enable_work_stealing",
+                                        &concurrentApplyOptions->rworkstealing))
+        << "config no rconcurrentapply.enable_work_stealing info, "
+        << "using default value " << concurrentApplyOptions->rworkstealing;
     LOG_IF(FATAL, !conf->GetIntValue(
         "wconcurrentapply.queuedepth", &concurrentApplyOptions->wqueuedepth));
+    LOG_IF(WARNING, !conf->GetIntValue(
+        "wconcurrentapply.slot_num", &concurrentApplyOptions->wslotnum))
+        << "config no wconcurrentapply.slot_num info, using default value "
+        << concurrentApplyOptions->wslotnum;
 }
 
 void ChunkServer::InitWalFilePoolOptions(
@@ -613,17 +783,27 @@ void ChunkServer::InitWalFilePoolOptions(
         LOG_IF(FATAL, !conf->GetStringValue(
             "walfilepool.meta_path", &metaUri));
 
-        std::string pool_size;
-        LOG_IF(FATAL, !conf->GetStringValue("walfilepool.chunk_file_pool_size",
-                                            &pool_size));
+        // wal pool可以放在单独的设备上，和数据盘不在同一个目录下
+        std::string filePoolUri;
+        LOG_IF(FATAL, !conf->GetStringValue(
+            "walfilepool.file_pool_dir", &filePoolUri));
+        ::memcpy(walPoolOptions->filePoolDir,
+                 filePoolUri.c_str(),
+                 filePoolUri.size());
+
+        std::string poolSize;
+        LOG_IF(FATAL, !conf->GetStringValue("walfilepool.wal_file_pool_size",
+                                            &poolSize));
         LOG_IF(FATAL, !curve::common::ToNumbericByte(
-                          pool_size, &walPoolOptions->filePoolSize));
-        LOG_IF(FATAL, !conf->GetUInt64Value("walfilepool.wal_file_pool_size",
-                                            &walPoolOptions->filePoolSize));
+                          poolSize, &walPoolOptions->filePoolSize));
         LOG_IF(FATAL, !conf->GetBoolValue("walfilepool.allocated_by_percent",
                                           &walPoolOptions->allocatedByPercent));
-        LOG_IF(FATAL, !conf->GetUInt32Value("walfilepool.allocated_percent",
+        LOG_IF(FATAL, !conf->GetUInt32Value("walfilepool.allocate_percent",
                                             &walPoolOptions->allocatedPercent));
+        LOG_IF(WARNING, !conf->GetUInt32Value(
+            "walfilepool.device_share_num", &walPoolOptions->deviceShareNum))
+            << "config no walfilepool.device_share_num info, "
+            << "using default value " << walPoolOptions->deviceShareNum;
         LOG_IF(FATAL, !conf->GetUInt32Value("walfilepool.thread_num",
                                             &walPoolOptions->formatThreadNum));
 
@@ -688,6 +868,38 @@ void ChunkServer::InitCopysetNodeOptions(
         &copysetNodeOptions->locationLimit));
     LOG_IF(FATAL, !conf->GetUInt32Value("copyset.load_concurrency",
         &copysetNodeOptions->loadConcurrency));
+    LOG_IF(WARNING, !conf->GetUInt32Value("copyset.chunk_load_concurrency",
+        &copysetNodeOptions->chunkLoadConcurrency))
+        << "config no copyset.chunk_load_concurrency info, "
+        << "using default value " << copysetNodeOptions->chunkLoadConcurrency;
+    LOG_IF(WARNING, !conf->GetUInt32Value("copyset.scan_crc_cache_max_hits",
+        &copysetNodeOptions->scanCrcCacheMaxHits))
+        << "config no copyset.scan_crc_cache_max_hits info, "
+        << "using default value " << copysetNodeOptions->scanCrcCacheMaxHits;
+    LOG_IF(WARNING, !conf->GetUInt32Value("copyset.data_checksum_block_size",
+        &copysetNodeOptions->dataChecksumBlockSize))
+        << "config no copyset.data_checksum_block_size info, "
+        << "using default value " << copysetNodeOptions->dataChecksumBlockSize;
+    std::string checksumPools;
+    LOG_IF(WARNING, !conf->GetStringValue("copyset.data_checksum_logic_pools",
+        &checksumPools))
+        << "config no copyset.data_checksum_logic_pools info, "
+        << "keep data checksums of all logic pools";
+    std::vector<std::string> poolIds;
+    curve::common::SplitString(checksumPools, ",", &poolIds);
+    for (const auto& poolId : poolIds) {
+        uint32_t id = 0;
+        LOG_IF(FATAL, !curve::common::StringToUl(poolId, &id))
+            << "invalid logic pool id in copyset.data_checksum_logic_pools: "
+            << poolId;
+        copysetNodeOptions->dataChecksumLogicPools.insert(id);
+    }
+    LOG_IF(WARNING, !conf->GetBoolValue(
+        "copyset.enable_redirect_on_write_snapshot",
+        &copysetNodeOptions->enableRedirectOnWriteSnapshot))
+        << "config no copyset.enable_redirect_on_write_snapshot info, "
+        << "using default value "
+        << copysetNodeOptions->enableRedirectOnWriteSnapshot;
     LOG_IF(FATAL, !conf->GetUInt32Value("copyset.check_retrytimes",
         &copysetNodeOptions->checkRetryTimes));
     LOG_IF(FATAL, !conf->GetUInt32Value("copyset.finishload_margin",
@@ -696,6 +908,20 @@ void ChunkServer::InitCopysetNodeOptions(
         &copysetNodeOptions->checkLoadMarginIntervalMs));
     LOG_IF(FATAL, !conf->GetUInt32Value("copyset.sync_concurrency",
         &copysetNodeOptions->syncConcurrency));
+    LOG_IF(WARNING, !conf->GetUInt32Value("copyset.max_merged_write_size_byte",
+        &copysetNodeOptions->maxMergedWriteSize))
+        << "config no copyset.max_merged_write_size_byte info, "
+        << "using default value " << copysetNodeOptions->maxMergedWriteSize;
+    LOG_IF(WARNING, !conf->GetBoolValue("copyset.enable_follower_read",
+        &copysetNodeOptions->enableFollowerRead))
+        << "config no copyset.enable_follower_read info, "
+        << "using default value " << copysetNodeOptions->enableFollowerRead;
+    LOG_IF(WARNING, !conf->GetUInt32Value(
+        "copyset.follower_read_index_cache_ms",
+        &copysetNodeOptions->followerReadIndexCacheMs))
+        << "config no copyset.follower_read_index_cache_ms info, "
+        << "using default value "
+        << copysetNodeOptions->followerReadIndexCacheMs;
 
     LOG_IF(FATAL, !conf->GetBoolValue(
         "copyset.enable_odsync_when_open_chunkfile",
@@ -709,6 +935,10 @@ void ChunkServer::InitCopysetNodeOptions(
             &copysetNodeOptions->checkSyncingIntervalMs));
         LOG_IF(FATAL, !conf->GetUInt32Value("copyset.sync_trigger_seconds",
                 &copysetNodeOptions->syncTriggerSeconds));
+        LOG_IF(WARNING, !conf->GetUInt32Value("copyset.sync_fs_min_chunks",
+            &copysetNodeOptions->syncFsMinChunks))
+            << "config no copyset.sync_fs_min_chunks info, "
+            << "using default value " << copysetNodeOptions->syncFsMinChunks;
     }
 }
 
@@ -730,6 +960,14 @@ void ChunkServer::InitCopyerOptions(
         &disableS3Adapter));
     LOG_IF(FATAL, !conf->GetUInt64Value("curve.curve_file_timeout_s",
         &copyerOptions->curveFileTimeoutSec));
+    LOG_IF(WARNING, !conf->GetUInt64Value("clone.cache_max_count",
+        &copyerOptions->cacheMaxCount))
+        << "config no clone.cache_max_count info, using default value "
+        << copyerOptions->cacheMaxCount;
+    LOG_IF(WARNING, !conf->GetUInt64Value("clone.cache_max_data_size",
+        &copyerOptions->cacheMaxDataSize))
+        << "config no clone.cache_max_data_size info, using default value "
+        << copyerOptions->cacheMaxDataSize;
 
     if (disableCurveClient) {
         copyerOptions->curveClient = nullptr;
@@ -752,6 +990,34 @@ void ChunkServer::InitCloneOptions(
         &cloneOptions->queueCapacity));
 }
 
+void ChunkServer::InitCloneFlattenerOptions(
+    common::Configuration *conf, CloneFlattenerOptions *flattenerOptions) {
+    LOG_IF(WARNING, !conf->GetBoolValue("clone.flatten.enable",
+        &flattenerOptions->enable))
+        << "config no clone.flatten.enable info, using default value "
+        << flattenerOptions->enable;
+    LOG_IF(WARNING, !conf->GetUInt32Value("clone.flatten.concurrency",
+        &flattenerOptions->concurrency))
+        << "config no clone.flatten.concurrency info, using default value "
+        << flattenerOptions->concurrency;
+    LOG_IF(WARNING, !conf->GetUInt64Value("clone.flatten.idle_inflight",
+        &flattenerOptions->idleInflight))
+        << "config no clone.flatten.idle_inflight info, using default value "
+        << flattenerOptions->idleInflight;
+    LOG_IF(WARNING, !conf->GetUInt32Value("clone.flatten.interval_ms",
+        &flattenerOptions->intervalMs))
+        << "config no clone.flatten.interval_ms info, using default value "
+        << flattenerOptions->intervalMs;
+    LOG_IF(WARNING, !conf->GetUInt32Value("clone.flatten.max_backoff_ms",
+        &flattenerOptions->maxBackoffMs))
+        << "config no clone.flatten.max_backoff_ms info, "
+        << "using default value " << flattenerOptions->maxBackoffMs;
+    LOG_IF(WARNING, !conf->GetUInt32Value("clone.flatten.rescan_interval_s",
+        &flattenerOptions->rescanIntervalSec))
+        << "config no clone.flatten.rescan_interval_s info, "
+        << "using default value " << flattenerOptions->rescanIntervalSec;
+}
+
 void ChunkServer::InitScanOptions(
     common::Configuration *conf, ScanManagerOptions *scanOptions) {
     LOG_IF(FATAL, !conf->GetUInt32Value("copyset.scan_interval_sec",
@@ -766,6 +1032,85 @@ void ChunkServer::InitScanOptions(
         &scanOptions->retry));
     LOG_IF(FATAL, !conf->GetUInt64Value("copyset.scan_rpc_retry_interval_us",
         &scanOptions->retryIntervalUs));
+    LOG_IF(WARNING, !conf->GetUInt32Value("copyset.scan_duty_cycle_percent",
+        &scanOptions->dutyCyclePercent))
+        << "config no copyset.scan_duty_cycle_percent info, "
+        << "using default value " << scanOptions->dutyCyclePercent;
+}
+
+void ChunkServer::InitQosSchedulerOptions(
+    common::Configuration *conf, QosSchedulerOptions *qosOptions) {
+    LOG_IF(WARNING, !conf->GetUInt32Value("chunkserver.qos.max_inflight",
+        &qosOptions->maxInflight))
+        << "config no chunkserver.qos.max_inflight info, using default value "
+        << qosOptions->maxInflight;
+    LOG_IF(WARNING, !conf->GetUInt32Value("chunkserver.qos.max_queue_depth",
+        &qosOptions->maxQueueDepth))
+        << "config no chunkserver.qos.max_queue_depth info, "
+        << "using default value " << qosOptions->maxQueueDepth;
+    LOG_IF(WARNING, !conf->GetUInt32Value("chunkserver.qos.default_reservation",
+        &qosOptions->defaultParams.reservation))
+        << "config no chunkserver.qos.default_reservation info, "
+        << "using default value " << qosOptions->defaultParams.reservation;
+    LOG_IF(WARNING, !conf->GetUInt32Value("chunkserver.qos.default_limit",
+        &qosOptions->defaultParams.limit))
+        << "config no chunkserver.qos.default_limit info, "
+        << "using default value " << qosOptions->defaultParams.limit;
+    LOG_IF(WARNING, !conf->GetUInt32Value("chunkserver.qos.default_weight",
+        &qosOptions->defaultParams.weight))
+        << "config no chunkserver.qos.default_weight info, "
+        << "using default value " << qosOptions->defaultParams.weight;
+}
+
+void ChunkServer::InitPageCacheOptions(
+    common::Configuration *conf, ChunkPageCacheOptions *pageCacheOptions) {
+    uint64_t capacityMB = 0;
+    LOG_IF(WARNING, !conf->GetUInt64Value("chunkserver.page_cache.capacity_mb",
+        &capacityMB))
+        << "config no chunkserver.page_cache.capacity_mb info, "
+        << "using default value " << capacityMB;
+    pageCacheOptions->capacity = capacityMB * 1024 * 1024;
+    LOG_IF(WARNING, !conf->GetUInt32Value("chunkserver.page_cache.page_size",
+        &pageCacheOptions->pageSize))
+        << "config no chunkserver.page_cache.page_size info, "
+        << "using default value " << pageCacheOptions->pageSize;
+    LOG_IF(WARNING, !conf->GetUInt32Value(
+        "chunkserver.page_cache.max_read_size",
+        &pageCacheOptions->maxReadSize))
+        << "config no chunkserver.page_cache.max_read_size info, "
+        << "using default value " << pageCacheOptions->maxReadSize;
+    LOG_IF(FATAL, pageCacheOptions->pageSize == 0)
+        << "chunkserver.page_cache.page_size must not be 0";
+}
+
+void ChunkServer::InitNumaAffinityOptions(
+    common::Configuration *conf, NumaAffinityOptions *numaOptions) {
+    LOG_IF(WARNING, !conf->GetBoolValue("chunkserver.numa.enable",
+        &numaOptions->enable))
+        << "config no chunkserver.numa.enable info, using default value "
+        << numaOptions->enable;
+    LOG_IF(WARNING, !conf->GetIntValue("chunkserver.numa.node",
+        &numaOptions->node))
+        << "config no chunkserver.numa.node info, using default value "
+        << numaOptions->node;
+    LOG_IF(WARNING, !conf->GetBoolValue("chunkserver.numa.bind_memory",
+        &numaOptions->bindMemory))
+        << "config no chunkserver.numa.bind_memory info, "
+        << "using default value " << numaOptions->bindMemory;
+    std::string chunkDataUri;
+    LOG_IF(FATAL, !conf->GetStringValue("copyset.chunk_data_uri",
+        &chunkDataUri));
+    numaOptions->dataDir = UriParser::GetPathFromUri(chunkDataUri);
+}
+
+void ChunkServer::InitBufferPoolOptions(
+    common::Configuration *conf, BufferPoolOptions *bufferPoolOptions) {
+    uint64_t hugePageMB = 0;
+    LOG_IF(WARNING, !conf->GetUInt64Value("chunkserver.buffer_pool.hugepage_mb",
+        &hugePageMB))
+        << "config no chunkserver.buffer_pool.hugepage_mb info, "
+        << "using default value " << hugePageMB;
+    bufferPoolOptions->hugePageBytes = hugePageMB * 1024 * 1024;
 }
 
 void ChunkServer::InitHeartbeatOptions(
@@ -781,6 +1126,16 @@ void ChunkServer::InitHeartbeatOptions(
         &heartbeatOptions->intervalSec));
     LOG_IF(FATAL, !conf->GetUInt32Value("mds.heartbeat_timeout",
         &heartbeatOptions->timeout));
+    LOG_IF(WARNING, !conf->GetUInt32Value("mds.heartbeat_full_interval",
+        &heartbeatOptions->fullHeartbeatInterval))
+        << "config no mds.heartbeat_full_interval info, using default value "
+        << heartbeatOptions->fullHeartbeatInterval;
+    LOG_IF(WARNING, !conf->GetUInt32Value(
+        "mds.heartbeat_config_change_check_interval_ms",
+        &heartbeatOptions->configChangeCheckIntervalMs))
+        << "config no mds.heartbeat_config_change_check_interval_ms info, "
+        << "using default value "
+        << heartbeatOptions->configChangeCheckIntervalMs;
 }
 
 void ChunkServer::InitRegisterOptions(
@@ -815,6 +1170,19 @@ void ChunkServer::InitTrashOptions(
         "trash.expire_afterSec", &trashOptions->expiredAfterSec));
     LOG_IF(FATAL, !conf->GetIntValue(
         "trash.scan_periodSec", &trashOptions->scanPeriodSec));
+    LOG_IF(WARNING, !conf->GetUInt32Value(
+        "trash.recycle_batch_size", &trashOptions->recycleBatchSize))
+        << "config no trash.recycle_batch_size info, using default value "
+        << trashOptions->recycleBatchSize;
+    LOG_IF(WARNING, !conf->GetUInt32Value(
+        "trash.recycle_batch_interval_ms",
+        &trashOptions->recycleBatchIntervalMs))
+        << "config no trash.recycle_batch_interval_ms info, "
+        << "using default value " << trashOptions->recycleBatchIntervalMs;
+    LOG_IF(WARNING, !conf->GetUInt32Value(
+        "trash.recycle_iops", &trashOptions->recycleIops))
+        << "config no trash.recycle_iops info, using default value "
+        << trashOptions->recycleIops;
 }
 
 void ChunkServer::InitMetricOptions(
@@ -825,6 +1193,38 @@ void ChunkServer::InitMetricOptions(
         "global.ip", &metricOptions->ip));
     LOG_IF(FATAL, !conf->GetBoolValue(
         "metric.onoff", &metricOptions->collectMetric));
+    LOG_IF(WARNING, !conf->GetUInt32Value(
+        "metric.slow_request_threshold_ms",
+        &metricOptions->slowRequestThresholdMs))
+        << "config no metric.slow_request_threshold_ms info, "
+        << "using default value " << metricOptions->slowRequestThresholdMs;
+    LOG_IF(WARNING, !conf->GetUInt32Value(
+        "metric.slow_request_sample_rate",
+        &metricOptions->slowRequestSampleRate))
+        << "config no metric.slow_request_sample_rate info, "
+        << "using default value " << metricOptions->slowRequestSampleRate;
+}
+
+void ChunkServer::InitBRaftFlags(common::Configuration *conf) {
+    // 命令行中指定了的braft参数以命令行为准，配置文件中没有的保持braft的默认值
+    auto takeValue = [conf](const char* flagName, const std::string& key,
+                            int32_t* flag) {
+        google::CommandLineFlagInfo info;
+        if (GetCommandLineFlagInfo(flagName, &info) && !info.is_default) {
+            return;
+        }
+        int value;
+        if (conf->GetIntValue(key, &value)) {
+            *flag = value;
+        }
+    };
+    takeValue("raft_election_heartbeat_factor",
+              "braft.raft_election_heartbeat_factor",
+              &braft::FLAGS_raft_election_heartbeat_factor);
+    takeValue("raft_max_entries_size", "braft.raft_max_entries_size",
+              &braft::FLAGS_raft_max_entries_size);
+    takeValue("raft_max_body_size", "braft.raft_max_body_size",
+              &braft::FLAGS_raft_max_body_size);
 }
 
 void ChunkServer::LoadConfigFromCmdline(common::Configuration *conf) {
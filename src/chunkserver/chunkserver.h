@@ -30,10 +30,14 @@
 #include "src/chunkserver/heartbeat.h"
 #include "src/chunkserver/scan_manager.h"
 #include "src/chunkserver/clone_manager.h"
+#include "src/chunkserver/clone_flattener.h"
+#include "src/chunkserver/qos_scheduler.h"
 #include "src/chunkserver/register.h"
 #include "src/chunkserver/trash.h"
 #include "src/chunkserver/chunkserver_metrics.h"
 #include "src/chunkserver/concurrent_apply/concurrent_apply.h"
+#include "src/chunkserver/numa_affinity.h"
+#include "src/chunkserver/datastore/buffer_pool.h"
 #include "src/chunkserver/scan_service.h"
 
 using ::curve::chunkserver::concurrent::ConcurrentApplyOption;
@@ -76,9 +80,24 @@ class ChunkServer {
     void InitCloneOptions(common::Configuration *conf,
         CloneOptions *cloneOptions);
 
+    void InitCloneFlattenerOptions(common::Configuration *conf,
+        CloneFlattenerOptions *flattenerOptions);
+
     void InitScanOptions(common::Configuration *conf,
         ScanManagerOptions *scanOptions);
 
+    void InitQosSchedulerOptions(common::Configuration *conf,
+        QosSchedulerOptions *qosOptions);
+
+    void InitPageCacheOptions(common::Configuration *conf,
+        ChunkPageCacheOptions *pageCacheOptions);
+
+    void InitNumaAffinityOptions(common::Configuration *conf,
+        NumaAffinityOptions *numaOptions);
+
+    void InitBufferPoolOptions(common::Configuration *conf,
+        BufferPoolOptions *bufferPoolOptions);
+
     void InitHeartbeatOptions(common::Configuration *conf,
         HeartbeatOptions *heartbeatOptions);
 
@@ -93,6 +112,9 @@ class ChunkServer {
 
     void LoadConfigFromCmdline(common::Configuration *conf);
 
+    // 从配置文件设置braft复制相关的参数
+    void InitBRaftFlags(common::Configuration *conf);
+
     int GetChunkServerMetaFromLocal(const std::string &storeUri,
         const std::string &metaUri,
         const std::shared_ptr<LocalFileSystem> &fs,
@@ -108,9 +130,15 @@ class ChunkServer {
     // cloneManager_ 管理克隆任务
     CloneManager cloneManager_;
 
+    // 空闲时在后台拷贝clone chunk的数据
+    CloneFlattener cloneFlattener_;
+
     // scan copyset manager
     ScanManager scanManager_;
 
+    // 按copyset调度读写请求，开启时代替inflight throttle限制读写请求
+    QosScheduler qosScheduler_;
+
     // heartbeat_ 负责向mds定期发送心跳，并下发心跳中任务
     Heartbeat heartbeat_;
 
@@ -21,6 +21,8 @@
  */
 
 #include "src/chunkserver/chunkserver_metrics.h"
+#include <algorithm>
+#include <sstream>
 #include <vector>
 #include <map>
 
@@ -94,6 +96,57 @@ void IOMetric::OnResponse(size_t size, int64_t latUs, bool hasError) {
     }
 }
 
+std::string OpStageTrace::ToString() const {
+    std::ostringstream oss;
+    oss << "received: " << receivedUs
+        << ", proposed: " << proposedUs
+        << ", committed: " << committedUs
+        << ", apply start: " << applyStartUs
+        << ", store done: " << storeDoneUs
+        << ", total: " << TotalUs() << "us";
+    return oss.str();
+}
+
+int StageMetric::Init(const std::string &prefix) {
+    if (queueLatency_.expose(prefix, "queue_lat") != 0) {
+        LOG(ERROR) << "expose queue latency recorder failed.";
+        return -1;
+    }
+    if (commitLatency_.expose(prefix, "commit_lat") != 0) {
+        LOG(ERROR) << "expose commit latency recorder failed.";
+        return -1;
+    }
+    if (applyQueueLatency_.expose(prefix, "apply_queue_lat") != 0) {
+        LOG(ERROR) << "expose apply queue latency recorder failed.";
+        return -1;
+    }
+    if (storeLatency_.expose(prefix, "store_lat") != 0) {
+        LOG(ERROR) << "expose store latency recorder failed.";
+        return -1;
+    }
+    return 0;
+}
+
+namespace {
+// 时钟回退时按0统计
+inline int64_t StageLatency(uint64_t beginUs, uint64_t endUs) {
+    return endUs > beginUs ? endUs - beginUs : 0;
+}
+}  // namespace
+
+void StageMetric::OnStages(const OpStageTrace &trace) {
+    if (!trace.Complete()) {
+        return;
+    }
+    if (trace.proposedUs != 0) {
+        queueLatency_ << StageLatency(trace.receivedUs, trace.proposedUs);
+        commitLatency_ << StageLatency(trace.proposedUs, trace.committedUs);
+    } else {
+        queueLatency_ << StageLatency(trace.receivedUs, trace.committedUs);
+    }
+    applyQueueLatency_ << StageLatency(trace.committedUs, trace.applyStartUs);
+    storeLatency_ << StageLatency(trace.applyStartUs, trace.storeDoneUs);
+}
 
 int CSIOMetric::Init(const std::string &prefix) {
     // 初始化io统计项metric
@@ -132,6 +185,20 @@ int CSIOMetric::Init(const std::string &prefix) {
                    << " prefix = " << downloadPrefix;
         return -1;
     }
+    std::string readStagePrefix = readPrefix + "_stage";
+    std::string writeStagePrefix = writePrefix + "_stage";
+    readStageMetric_ = std::make_shared<StageMetric>();
+    writeStageMetric_ = std::make_shared<StageMetric>();
+    if (readStageMetric_->Init(readStagePrefix) != 0) {
+        LOG(ERROR) << "Init read stage metric failed."
+                   << " prefix = " << readStagePrefix;
+        return -1;
+    }
+    if (writeStageMetric_->Init(writeStagePrefix) != 0) {
+        LOG(ERROR) << "Init write stage metric failed."
+                   << " prefix = " << writeStagePrefix;
+        return -1;
+    }
     return 0;
 }
 
@@ -141,6 +208,8 @@ void CSIOMetric::Fini() {
     recoverMetric_ = nullptr;
     pasteMetric_ = nullptr;
     downloadMetric_ = nullptr;
+    readStageMetric_ = nullptr;
+    writeStageMetric_ = nullptr;
 }
 
 void CSIOMetric::OnRequest(CSIOMetricType type) {
@@ -158,6 +227,24 @@ void CSIOMetric::OnResponse(CSIOMetricType type, size_t size, int64_t latUs,
     }
 }
 
+void CSIOMetric::OnStages(CSIOMetricType type, const OpStageTrace &trace) {
+    StageMetricPtr stageMetric = GetStageMetric(type);
+    if (stageMetric != nullptr) {
+        stageMetric->OnStages(trace);
+    }
+}
+
+StageMetricPtr CSIOMetric::GetStageMetric(CSIOMetricType type) {
+    switch (type) {
+    case CSIOMetricType::READ_CHUNK:
+        return readStageMetric_;
+    case CSIOMetricType::WRITE_CHUNK:
+        return writeStageMetric_;
+    default:
+        return nullptr;
+    }
+}
+
 IOMetricPtr CSIOMetric::GetIOMetric(CSIOMetricType type) {
     IOMetricPtr result = nullptr;
     switch (type) {
@@ -219,7 +306,7 @@ ChunkServerMetric::ChunkServerMetric()
     : hasInited_(false), leaderCount_(nullptr), chunkLeft_(nullptr),
       walSegmentLeft_(nullptr), chunkTrashed_(nullptr), chunkCount_(nullptr),
       walSegmentCount_(nullptr), snapshotCount_(nullptr),
-      cloneChunkCount_(nullptr) {}
+      cloneChunkCount_(nullptr), slowRequestNum_(0) {}
 
 ChunkServerMetric *ChunkServerMetric::self_ = nullptr;
 
@@ -371,6 +458,31 @@ void ChunkServerMetric::OnResponse(const LogicPoolID &logicPoolId,
     ioMetrics_.OnResponse(type, size, latUs, hasError);
 }
 
+void ChunkServerMetric::OnStages(const LogicPoolID &logicPoolId,
+                                 const CopysetID &copysetId,
+                                 CSIOMetricType type,
+                                 const OpStageTrace &trace) {
+    if (!option_.collectMetric) {
+        return;
+    }
+
+    CopysetMetricPtr cpMetric = GetCopysetMetric(logicPoolId, copysetId);
+    if (cpMetric != nullptr) {
+        cpMetric->OnStages(type, trace);
+    }
+    ioMetrics_.OnStages(type, trace);
+}
+
+bool ChunkServerMetric::SampleSlowRequest(const OpStageTrace &trace) {
+    if (option_.slowRequestThresholdMs == 0 ||
+        trace.TotalUs() < option_.slowRequestThresholdMs * 1000ull) {
+        return false;
+    }
+    uint32_t sampleRate = std::max(option_.slowRequestSampleRate, 1u);
+    return slowRequestNum_.fetch_add(1, std::memory_order_relaxed)
+           % sampleRate == 0;
+}
+
 void ChunkServerMetric::MonitorChunkFilePool(FilePool *chunkFilePool) {
     if (!option_.collectMetric) {
         return;
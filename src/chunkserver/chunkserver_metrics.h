@@ -25,6 +25,7 @@
 
 #include <bvar/bvar.h>
 #include <butil/time.h>
+#include <atomic>
 #include <string>
 #include <unordered_map>
 #include <memory>
@@ -109,6 +110,65 @@ class IOMetric {
 };
 using IOMetricPtr = std::shared_ptr<IOMetric>;
 
+// 请求经过各阶段时的时间戳，为0表示请求没有经过该阶段
+struct OpStageTrace {
+    // 收到请求
+    uint64_t receivedUs = 0;
+    // propose给raft，lease read的读请求没有这个阶段
+    uint64_t proposedUs = 0;
+    // raft日志已经持久化并复制到多数副本，请求进入apply队列
+    uint64_t committedUs = 0;
+    // 请求从apply队列中取出，开始执行
+    uint64_t applyStartUs = 0;
+    // datastore执行完成
+    uint64_t storeDoneUs = 0;
+
+    // 经过了所有必需的阶段
+    bool Complete() const {
+        return receivedUs != 0 && committedUs != 0 &&
+               applyStartUs != 0 && storeDoneUs != 0;
+    }
+
+    uint64_t TotalUs() const {
+        return storeDoneUs > receivedUs ? storeDoneUs - receivedUs : 0;
+    }
+
+    std::string ToString() const;
+};
+
+/**
+ * 请求在各阶段的延时，用于定位请求的时间花在了哪里
+ */
+class StageMetric {
+ public:
+    StageMetric() = default;
+    ~StageMetric() = default;
+
+    /**
+     * 初始化 stage metric
+     * @param prefix: 用于bvar曝光时使用的前缀
+     * @return 成功返回0，失败返回-1
+     */
+    int Init(const std::string &prefix);
+
+    /**
+     * 请求执行完成后记录各阶段的延时，没有经过所有必需阶段的请求不统计
+     * @param trace: 请求经过各阶段时的时间戳
+     */
+    void OnStages(const OpStageTrace &trace);
+
+ public:
+    // 收到请求到propose给raft，lease read时为收到请求到进入apply队列
+    bvar::LatencyRecorder queueLatency_;
+    // raft日志持久化以及等待复制到多数副本
+    bvar::LatencyRecorder commitLatency_;
+    // 在apply队列中等待
+    bvar::LatencyRecorder applyQueueLatency_;
+    // datastore执行
+    bvar::LatencyRecorder storeLatency_;
+};
+using StageMetricPtr = std::shared_ptr<StageMetric>;
+
 enum class CSIOMetricType {
     READ_CHUNK = 0,
     WRITE_CHUNK = 1,
@@ -121,7 +181,8 @@ class CSIOMetric {
  public:
     CSIOMetric()
         : readMetric_(nullptr), writeMetric_(nullptr), recoverMetric_(nullptr),
-          pasteMetric_(nullptr), downloadMetric_(nullptr) {}
+          pasteMetric_(nullptr), downloadMetric_(nullptr),
+          readStageMetric_(nullptr), writeStageMetric_(nullptr) {}
 
     ~CSIOMetric() {}
 
@@ -149,6 +210,20 @@ class CSIOMetric {
      */
     IOMetricPtr GetIOMetric(CSIOMetricType type);
 
+    /**
+     * 请求执行完成后记录各阶段的延时
+     * @param type: 请求对应的metric类型，只统计读写请求
+     * @param trace: 请求经过各阶段时的时间戳
+     */
+    void OnStages(CSIOMetricType type, const OpStageTrace &trace);
+
+    /**
+     * 获取指定类型的StageMetric
+     * @param type: 请求对应的metric类型
+     * @return 返回指定类型对应的StageMetric指针，如果类型不存在则返回nullptr
+     */
+    StageMetricPtr GetStageMetric(CSIOMetricType type);
+
     /**
      * 初始化各项op的metric统计项
      * @return 成功返回0，失败返回-1
@@ -170,6 +245,10 @@ class CSIOMetric {
     IOMetricPtr pasteMetric_;
     // Download统计
     IOMetricPtr downloadMetric_;
+    // ReadChunk各阶段的延时统计
+    StageMetricPtr readStageMetric_;
+    // WriteChunk各阶段的延时统计
+    StageMetricPtr writeStageMetric_;
 };
 
 class CSCopysetMetric {
@@ -229,6 +308,19 @@ class CSCopysetMetric {
         return ioMetrics_.GetIOMetric(type);
     }
 
+    /**
+     * 请求执行完成后记录各阶段的延时
+     * @param type: 请求对应的metric类型
+     * @param trace: 请求经过各阶段时的时间戳
+     */
+    void OnStages(CSIOMetricType type, const OpStageTrace &trace) {
+        ioMetrics_.OnStages(type, trace);
+    }
+
+    StageMetricPtr GetStageMetric(CSIOMetricType type) {
+        return ioMetrics_.GetStageMetric(type);
+    }
+
     uint32_t GetChunkCount() const {
         if (chunkCount_ == nullptr) {
             return 0;
@@ -286,8 +378,13 @@ struct ChunkServerMetricOptions {
     std::string ip;
     // chunkserver的端口号
     uint32_t port;
+    // 超过该延时的请求为慢请求，为0表示不打印慢请求
+    uint32_t slowRequestThresholdMs;
+    // 每多少个慢请求打印一次各阶段的时间戳
+    uint32_t slowRequestSampleRate;
     ChunkServerMetricOptions()
-        : collectMetric(false), ip("127.0.0.1"), port(8888) {}
+        : collectMetric(false), ip("127.0.0.1"), port(8888),
+          slowRequestThresholdMs(0), slowRequestSampleRate(1) {}
 };
 
 using CopysetMetricPtr = std::shared_ptr<CSCopysetMetric>;
@@ -391,6 +488,23 @@ class ChunkServerMetric : public Uncopyable {
                     CSIOMetricType type, size_t size, int64_t latUs,
                     bool hasError);
 
+    /**
+     * 请求执行完成后记录各阶段的延时
+     * @param logicPoolId: 此次io操作所在的逻辑池id
+     * @param copysetId: 此次io操作所在的copysetid
+     * @param type: 请求类型
+     * @param trace: 请求经过各阶段时的时间戳
+     */
+    void OnStages(const LogicPoolID &logicPoolId, const CopysetID &copysetId,
+                  CSIOMetricType type, const OpStageTrace &trace);
+
+    /**
+     * 判断请求是否为需要打印的慢请求，慢请求按采样率打印
+     * @param trace: 请求经过各阶段时的时间戳
+     * @return 需要打印返回true，否则返回false
+     */
+    bool SampleSlowRequest(const OpStageTrace &trace);
+
     /**
      * 创建指定copyset的metric
      * 如果collectMetric为false，返回0，但实际并不会创建
@@ -462,6 +576,10 @@ class ChunkServerMetric : public Uncopyable {
         return ioMetrics_.GetIOMetric(type);
     }
 
+    StageMetricPtr GetStageMetric(CSIOMetricType type) {
+        return ioMetrics_.GetStageMetric(type);
+    }
+
     CopysetMetricMap *GetCopysetMetricMap() { return &copysetMetricMap_; }
 
     uint32_t GetCopysetCount() { return copysetMetricMap_.Size(); }
@@ -546,6 +664,8 @@ class ChunkServerMetric : public Uncopyable {
     CopysetMetricMap copysetMetricMap_;
     // chunkserver上的IO类型的metric统计
     CSIOMetric ioMetrics_;
+    // 慢请求的数量，用于采样
+    std::atomic<uint64_t> slowRequestNum_;
     // 用于单例模式的自指指针
     static ChunkServerMetric *self_;
 };
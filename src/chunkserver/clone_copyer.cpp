@@ -20,6 +20,11 @@
  * Author: yangyaokai
  */
 
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
 #include "src/chunkserver/clone_copyer.h"
 #include "src/chunkserver/clone_core.h"
 #include "src/common/timeutility.h"
@@ -53,6 +58,29 @@ void CurveAioCallback(struct CurveAioContext* context) {
     brpc::ClosureGuard doneGuard(done);
 }
 
+// 下载要缓存的区域，数据写入第一个请求的缓冲区，完成后回调copyer
+class CacheFetchClosure : public DownloadClosure {
+ public:
+    CacheFetchClosure(AsyncDownloadContext* downloadCtx,
+                      std::function<void(bool)> cb)
+        : DownloadClosure(nullptr, nullptr, downloadCtx, nullptr)
+        , cb_(cb) {}
+
+    void Run() override {
+        std::unique_ptr<CacheFetchClosure> selfGuard(this);
+        std::unique_ptr<AsyncDownloadContext> contextGuard(downloadCtx_);
+        cb_(isFailed_);
+    }
+
+ private:
+    std::function<void(bool)> cb_;
+};
+
+static std::string CacheKey(const AsyncDownloadContext& context) {
+    return context.location + ":" + std::to_string(context.offset)
+           + ":" + std::to_string(context.size);
+}
+
 void OriginCopyer::DeleteExpiredCurveCache(void* arg) {
     OriginCopyer* taskCopyer = static_cast<OriginCopyer*>(arg);
     std::unique_lock<std::mutex> lock(taskCopyer->mtx_);
@@ -84,7 +112,9 @@ void OriginCopyer::DeleteExpiredCurveCache(void* arg) {
 
 OriginCopyer::OriginCopyer()
     : curveClient_(nullptr)
-    , s3Client_(nullptr) {}
+    , s3Client_(nullptr)
+    , cache_(nullptr)
+    , cacheMaxDataSize_(0) {}
 
 int OriginCopyer::Init(const CopyerOptions& options) {
     curveFileTimeoutSec_ = options.curveFileTimeoutSec;
@@ -115,6 +145,16 @@ int OriginCopyer::Init(const CopyerOptions& options) {
         LOG(FATAL) << "init curveFile timer thread failed, " << berror(rc);
     }
     timerId_ = bthread::TimerThread::INVALID_TASK_ID;
+
+    if (options.cacheMaxCount > 0 && options.cacheMaxDataSize > 0) {
+        cache_.reset(new OriginDataCache(options.cacheMaxCount,
+            std::make_shared<curve::common::CacheMetrics>(
+                "chunkserver_origin_data_cache")));
+        cacheMaxDataSize_ = options.cacheMaxDataSize;
+        LOG(INFO) << "Origin data cache is enabled, max count: "
+                  << options.cacheMaxCount
+                  << ", max data size: " << cacheMaxDataSize_;
+    }
     return 0;
 }
 
@@ -138,6 +178,82 @@ int OriginCopyer::Fini() {
 }
 
 void OriginCopyer::DownloadAsync(DownloadClosure* done) {
+    AsyncDownloadContext* context = done->GetDownloadContext();
+    if (cache_ != nullptr && context->size <= cacheMaxDataSize_) {
+        DownloadWithCache(done);
+    } else {
+        DownloadFromOrigin(done);
+    }
+}
+
+void OriginCopyer::DownloadWithCache(DownloadClosure* done) {
+    AsyncDownloadContext* context = done->GetDownloadContext();
+    std::string key = CacheKey(*context);
+    std::shared_ptr<std::string> data;
+    {
+        std::lock_guard<std::mutex> lk(cacheMtx_);
+        if (!cache_->Get(key, &data)) {
+            auto iter = fetching_.find(key);
+            if (iter != fetching_.end()) {
+                // 相同区域正在下载，等待下载完成
+                iter->second.push_back(done);
+                return;
+            }
+            fetching_.emplace(key, std::vector<DownloadClosure*>());
+        }
+    }
+
+    if (data != nullptr) {
+        memcpy(context->buf, data->data(), data->size());
+        done->Run();
+        return;
+    }
+
+    AsyncDownloadContext* fetchCtx = new AsyncDownloadContext(*context);
+    CacheFetchClosure* fetchClosure = new CacheFetchClosure(fetchCtx,
+        [this, key, done](bool failed) {
+            OnCacheFetched(key, done, failed);
+        });
+    DownloadFromOrigin(fetchClosure);
+}
+
+void OriginCopyer::OnCacheFetched(const std::string& key,
+                                  DownloadClosure* done,
+                                  bool failed) {
+    AsyncDownloadContext* context = done->GetDownloadContext();
+    std::shared_ptr<std::string> data;
+    if (!failed) {
+        data = std::make_shared<std::string>(context->buf, context->size);
+    }
+    std::vector<DownloadClosure*> waiters;
+    {
+        std::lock_guard<std::mutex> lk(cacheMtx_);
+        auto iter = fetching_.find(key);
+        if (iter != fetching_.end()) {
+            waiters.swap(iter->second);
+            fetching_.erase(iter);
+        }
+        if (!failed) {
+            cache_->Put(key, data);
+        }
+    }
+
+    for (auto waiter : waiters) {
+        if (failed) {
+            waiter->SetFailed();
+        } else {
+            memcpy(waiter->GetDownloadContext()->buf,
+                   data->data(), data->size());
+        }
+        waiter->Run();
+    }
+    if (failed) {
+        done->SetFailed();
+    }
+    done->Run();
+}
+
+void OriginCopyer::DownloadFromOrigin(DownloadClosure* done) {
     brpc::ClosureGuard doneGuard(done);
     AsyncDownloadContext* context = done->GetDownloadContext();
     std::string originPath;
@@ -163,6 +279,11 @@ void OriginCopyer::DownloadAsync(DownloadClosure* done) {
                        context->size, context->buf,
                        done);
         doneGuard.release();
+    } else if (type == OriginType::S3CompressedOrigin) {
+        DownloadFromS3Compressed(originPath, context->offset,
+                                 context->size, context->buf,
+                                 done);
+        doneGuard.release();
     } else {
         LOG(ERROR) << "Unknown origin location."
                    << "location: " << context->location;
@@ -200,6 +321,88 @@ void OriginCopyer::DownloadFromS3(const string& objectName,
     doneGuard.release();
 }
 
+void OriginCopyer::DownloadFromS3Compressed(const string& objectName,
+                                           off_t off,
+                                           size_t size,
+                                           char* buf,
+                                           DownloadClosure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    if (s3Client_ == nullptr) {
+        LOG(ERROR) << "Failed to get s3 object."
+                   << "s3 adapter is disabled";
+        done->SetFailed();
+        return;
+    }
+
+    auto headerBuf = std::make_shared<std::string>(
+        BlockCompressor::kHeaderSize, '\0');
+    GetObjectAsyncCallBack cb =
+        [=] (const S3Adapter* adapter,
+             const std::shared_ptr<GetObjectAsyncContext>& context) {
+            (void)adapter;
+            brpc::ClosureGuard doneGuard(done);
+            CompressedDataHeader header;
+            if (context->retCode != 0 ||
+                !BlockCompressor::ParseHeader(headerBuf->data(),
+                                              headerBuf->size(), &header)) {
+                LOG(ERROR) << "Failed to get header of compressed object "
+                           << objectName;
+                done->SetFailed();
+                return;
+            }
+            doneGuard.release();
+            DownloadCompressedBlocks(objectName, header, off, size, buf,
+                                     done);
+        };
+
+    auto context = std::make_shared<GetObjectAsyncContext>(
+        objectName, &(*headerBuf)[0], 0, headerBuf->size(), cb);
+    s3Client_->GetObjectAsync(context);
+    doneGuard.release();
+}
+
+void OriginCopyer::DownloadCompressedBlocks(const string& objectName,
+                                           const CompressedDataHeader& header,
+                                           off_t off,
+                                           size_t size,
+                                           char* buf,
+                                           DownloadClosure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    uint64_t compressedOff = 0;
+    uint64_t compressedLen = 0;
+    if (!BlockCompressor::GetCompressedRange(header, off, size,
+                                             &compressedOff,
+                                             &compressedLen)) {
+        LOG(ERROR) << "Download range out of compressed object " << objectName
+                   << ", offset = " << off << ", size = " << size
+                   << ", object raw length = " << header.rawLen;
+        done->SetFailed();
+        return;
+    }
+
+    auto compressed = std::make_shared<std::string>(compressedLen, '\0');
+    GetObjectAsyncCallBack cb =
+        [=] (const S3Adapter* adapter,
+             const std::shared_ptr<GetObjectAsyncContext>& context) {
+            (void)adapter;
+            brpc::ClosureGuard doneGuard(done);
+            if (context->retCode != 0 ||
+                !BlockCompressor::Decompress(header, compressed->data(),
+                                             compressed->size(), off, size,
+                                             buf)) {
+                LOG(ERROR) << "Failed to get compressed object "
+                           << objectName << ", offset = " << off
+                           << ", size = " << size;
+                done->SetFailed();
+            }
+        };
+
+    auto context = std::make_shared<GetObjectAsyncContext>(
+        objectName, &(*compressed)[0], compressedOff, compressedLen, cb);
+    s3Client_->GetObjectAsync(context);
+    doneGuard.release();
+}
+
 void OriginCopyer::DownloadFromCurve(const string& fileName,
                                     off_t off,
                                     size_t size,
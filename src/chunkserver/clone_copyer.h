@@ -28,6 +28,8 @@
 #include <unordered_map>
 #include <string>
 #include <list>
+#include <mutex>  // NOLINT
+#include <vector>
 
 #include "include/chunkserver/chunkserver_common.h"
 #include "src/common/location_operator.h"
@@ -36,6 +38,8 @@
 #include "src/client/client_common.h"
 #include "include/client/libcurve.h"
 #include "src/common/s3_adapter.h"
+#include "src/common/lru_cache.h"
+#include "src/common/block_compressor.h"
 
 namespace curve {
 namespace chunkserver {
@@ -47,6 +51,8 @@ using curve::common::LocationOperator;
 using curve::common::OriginType;
 using curve::common::GetObjectAsyncCallBack;
 using curve::common::GetObjectAsyncContext;
+using curve::common::BlockCompressor;
+using curve::common::CompressedDataHeader;
 using std::string;
 
 class DownloadClosure;
@@ -64,6 +70,17 @@ struct CopyerOptions {
     std::shared_ptr<S3Adapter> s3Client;
     // curve file's time to live
     uint64_t curveFileTimeoutSec;
+    // 缓存的源端数据的最大个数，为0表示不缓存
+    uint64_t cacheMaxCount = 0;
+    // 只缓存长度不超过该值的下载结果
+    uint64_t cacheMaxDataSize = 0;
+};
+
+// 按数据长度统计缓存的字节数
+struct OriginDataTraits {
+    static uint64_t CountBytes(const std::shared_ptr<std::string>& data) {
+        return data->size();
+    }
 };
 
 struct AsyncDownloadContext {
@@ -118,11 +135,31 @@ class OriginCopyer {
     virtual void DownloadAsync(DownloadClosure* done);
 
  private:
+    // 从源端下载，不经过缓存
+    void DownloadFromOrigin(DownloadClosure* done);
+    // 从缓存中获取数据，相同区域正在下载时等待其完成，否则从源端下载
+    void DownloadWithCache(DownloadClosure* done);
+    // 缓存的区域下载完成，放入缓存并唤醒等待该区域的请求
+    void OnCacheFetched(const std::string& key,
+                        DownloadClosure* done,
+                        bool failed);
     void DownloadFromS3(const string& objectName,
                        off_t off,
                        size_t size,
                        char* buf,
                        DownloadClosure* done);
+    // 下载s3上按块压缩的对象，先读取对象头，再下载覆盖请求区域的块并解压
+    void DownloadFromS3Compressed(const string& objectName,
+                                  off_t off,
+                                  size_t size,
+                                  char* buf,
+                                  DownloadClosure* done);
+    void DownloadCompressedBlocks(const string& objectName,
+                                  const CompressedDataHeader& header,
+                                  off_t off,
+                                  size_t size,
+                                  char* buf,
+                                  DownloadClosure* done);
     void DownloadFromCurve(const string& fileName,
                           off_t off,
                           size_t size,
@@ -151,6 +188,17 @@ class OriginCopyer {
     bthread::TimerThread timer_;
     // timer's task id
     bthread::TimerThread::TaskId timerId_;
+
+    using OriginDataCache = curve::common::ARCCache<std::string,
+        std::shared_ptr<std::string>,
+        curve::common::CacheTraits<std::string>, OriginDataTraits>;
+    // 源端数据的缓存，key为location、偏移和长度，为nullptr表示不缓存
+    std::unique_ptr<OriginDataCache> cache_;
+    uint64_t cacheMaxDataSize_;
+    // 保护fetching_，保证区域下载完成时放入缓存和唤醒等待者的原子性
+    std::mutex cacheMtx_;
+    // 正在从源端下载的区域 -> 等待该区域数据的请求
+    std::unordered_map<std::string, std::vector<DownloadClosure*>> fetching_;
 };
 
 }  // namespace chunkserver
@@ -20,6 +20,7 @@
  * Author: yangyaokai
  */
 
+#include <cstring>
 #include <vector>
 #include <string>
 
@@ -29,6 +30,7 @@
 #include "src/chunkserver/copyset_node.h"
 #include "src/chunkserver/chunk_service_closure.h"
 #include "src/chunkserver/datastore/chunkserver_datastore.h"
+#include "src/chunkserver/datastore/buffer_pool.h"
 #include "src/common/timeutility.h"
 
 namespace curve {
@@ -37,10 +39,6 @@ namespace chunkserver {
 using curve::common::Bitmap;
 using curve::common::TimeUtility;
 
-static void ReadBufferDeleter(void* ptr) {
-    delete[] static_cast<char*>(ptr);
-}
-
 DownloadClosure::DownloadClosure(std::shared_ptr<ReadChunkRequest> readRequest,
                                  std::shared_ptr<CloneCore> cloneCore,
                                  AsyncDownloadContext* downloadCtx,
@@ -50,7 +48,9 @@ DownloadClosure::DownloadClosure(std::shared_ptr<ReadChunkRequest> readRequest,
     , downloadCtx_(downloadCtx)
     , cloneCore_(cloneCore)
     , readRequest_(readRequest)
-    , done_(done) {
+    , done_(done)
+    , pasteOffset_(downloadCtx->offset)
+    , pasteSize_(downloadCtx->size) {
     // 记录初始metric
     if (readRequest_ != nullptr) {
         const ChunkRequest* request = readRequest_->GetChunkRequest();
@@ -66,8 +66,8 @@ void DownloadClosure::Run() {
     std::unique_ptr<AsyncDownloadContext> contextGuard(downloadCtx_);
     brpc::ClosureGuard doneGuard(done_);
     butil::IOBuf copyData;
-    copyData.append_user_data(
-        downloadCtx_->buf, downloadCtx_->size, ReadBufferDeleter);
+    BufferPool::AppendToIOBuf(downloadCtx_->buf, downloadCtx_->size,
+                              &copyData);
 
     CHECK(readRequest_ != nullptr) << "read request is nullptr.";
     // 记录结束metric
@@ -93,12 +93,22 @@ void DownloadClosure::Run() {
         return;
     }
 
+    // 只paste需要的区域，引用下载缓冲区中的数据，不做拷贝
+    butil::IOBuf pasteData;
+    const butil::IOBuf* pasteBuf = &copyData;
+    if (pasteOffset_ != downloadCtx_->offset ||
+        pasteSize_ != downloadCtx_->size) {
+        copyData.append_to(&pasteData, pasteSize_,
+                           pasteOffset_ - downloadCtx_->offset);
+        pasteBuf = &pasteData;
+    }
+
     if (CHUNK_OP_TYPE::CHUNK_OP_RECOVER == request->optype()) {
         // release doneGuard，将closure交给paste请求处理
         cloneCore_->PasteCloneData(readRequest_,
-                                   &copyData,
-                                   downloadCtx_->offset,
-                                   downloadCtx_->size,
+                                   pasteBuf,
+                                   pasteOffset_,
+                                   pasteSize_,
                                    doneGuard.release());
     } else if (CHUNK_OP_TYPE::CHUNK_OP_READ == request->optype()) {
         // 出错或处理结束调用closure返回给用户
@@ -106,13 +116,31 @@ void DownloadClosure::Run() {
 
         // paste clone data是异步操作，很快就能处理完
         cloneCore_->PasteCloneData(readRequest_,
-                                   &copyData,
-                                   downloadCtx_->offset,
-                                   downloadCtx_->size,
+                                   pasteBuf,
+                                   pasteOffset_,
+                                   pasteSize_,
                                    nullptr);
     }
 }
 
+void DownloadRangeClosure::Run() {
+    // 数据写在parent的缓冲区中，这里只释放自己的上下文
+    std::unique_ptr<DownloadRangeClosure> selfGuard(this);
+    std::unique_ptr<AsyncDownloadContext> contextGuard(downloadCtx_);
+    if (isFailed_) {
+        LOG(ERROR) << "download origin data range failed, "
+                   << "AsyncDownloadContext: " << *downloadCtx_;
+        state_->failed.store(true);
+    }
+    // 最后一个完成的区域负责执行parent
+    if (state_->pending.fetch_sub(1) == 1) {
+        if (state_->failed.load()) {
+            parent_->SetFailed();
+        }
+        parent_->Run();
+    }
+}
+
 void CloneClosure::Run() {
     // 释放资源
     std::unique_ptr<CloneClosure> selfGuard(this);
@@ -166,21 +194,30 @@ int CloneCore::CloneReadByLocalInfo(
                     (chunkInfo.bitmap->NextClearBit(beginIndex, endIndex)
                      != Bitmap::NO_POS);
     if (needClone) {
-        // TODO(yyk) 这一块可以优化，但是优化方法判断条件可能比较复杂
-        // 目前只根据是否存在未写过的page来决定是否要触发拷贝
         // chunk中请求读取范围内的数据存在page未被写过，则需要从源端拷贝数据
+        // 只拷贝未被写过的区域，已经写过的区域在读时从本地chunk合并
+        std::vector<BitRange> uncopiedRanges;
+        chunkInfo.bitmap->Divide(beginIndex, endIndex,
+                                 &uncopiedRanges, nullptr);
         AsyncDownloadContext* downloadCtx =
             new (std::nothrow) AsyncDownloadContext;
         downloadCtx->location = chunkInfo.location;
         downloadCtx->offset = offset;
         downloadCtx->size = length;
-        downloadCtx->buf = new (std::nothrow) char[length];
+        downloadCtx->buf = BufferPool::Get(length);
         DownloadClosure* downloadClosure =
             new (std::nothrow) DownloadClosure(readRequest,
                                                shared_from_this(),
                                                downloadCtx,
                                                doneGuard.release());
-        copyer_->DownloadAsync(downloadClosure);
+        bool wholeRange = uncopiedRanges.size() == 1 &&
+                          uncopiedRanges[0].beginIndex == beginIndex &&
+                          uncopiedRanges[0].endIndex == endIndex;
+        if (wholeRange) {
+            copyer_->DownloadAsync(downloadClosure);
+        } else {
+            DownloadRanges(downloadClosure, uncopiedRanges, blockSize);
+        }
         return 0;
     }
 
@@ -209,7 +246,7 @@ void CloneCore::CloneReadByRequestInfo(std::shared_ptr<ReadChunkRequest>
     downloadCtx->location = location;
     downloadCtx->offset = chunkRequest->offset();
     downloadCtx->size = chunkRequest->size();
-    downloadCtx->buf = new (std::nothrow) char[chunkRequest->size()];
+    downloadCtx->buf = BufferPool::Get(chunkRequest->size());
     DownloadClosure* downloadClosure =
     new (std::nothrow) DownloadClosure(readRequest,
                                     shared_from_this(),
@@ -264,15 +301,16 @@ int CloneCore::ReadChunk(std::shared_ptr<ReadChunkRequest> readRequest) {
     const ChunkRequest* request = readRequest->request_;
     off_t offset = request->offset();
     size_t length = request->size();
-    std::unique_ptr<char[]> chunkData(new char[length]);
+    char* chunkData = BufferPool::Get(length);
     std::shared_ptr<CSDataStore> dataStore = readRequest->datastore_;
     CSErrorCode errorCode;
     errorCode = dataStore->ReadChunk(request->chunkid(),
                                      request->sn(),
-                                     chunkData.get(),
+                                     chunkData,
                                      offset,
                                      length);
     if (CSErrorCode::Success != errorCode) {
+        BufferPool::Release(chunkData, length);
         SetResponse(readRequest,
                     CHUNK_OP_STATUS::CHUNK_OP_STATUS_FAILURE_UNKNOWN);
         LOG(ERROR) << "read chunk failed: "
@@ -288,8 +326,8 @@ int CloneCore::ReadChunk(std::shared_ptr<ReadChunkRequest> readRequest) {
     // 读成功后需要更新 apply index
     readRequest->node_->UpdateAppliedIndex(readRequest->applyIndex);
     // Return 完成数据读取后可以将结果返回给用户
-    readRequest->cntl_->response_attachment().append(
-        chunkData.get(), length);
+    BufferPool::AppendToIOBuf(chunkData, length,
+                              &readRequest->cntl_->response_attachment());
     SetResponse(readRequest, CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
     return 0;
 }
@@ -329,10 +367,10 @@ int CloneCore::SetReadChunkResponse(
     butil::IOBuf responseData;
     // 如果chunk存在，则要从chunk中读取已经写过的区域合并后返回
     if (errorCode == CSErrorCode::Success) {
-        char* chunkData = new (std::nothrow) char[length];
+        char* chunkData = BufferPool::Get(length);
         int ret = ReadThenMerge(
             readRequest, chunkInfo, cloneData, chunkData);
-        responseData.append_user_data(chunkData, length, ReadBufferDeleter);
+        BufferPool::AppendToIOBuf(chunkData, length, &responseData);
         if (ret < 0) {
             SetResponse(readRequest,
                         CHUNK_OP_STATUS::CHUNK_OP_STATUS_FAILURE_UNKNOWN);
@@ -459,6 +497,45 @@ void CloneCore::PasteCloneData(std::shared_ptr<ReadChunkRequest> readRequest,
     req->Process();
 }
 
+void CloneCore::DownloadRanges(DownloadClosure* done,
+                               const std::vector<BitRange>& ranges,
+                               uint32_t blockSize) {
+    AsyncDownloadContext* context = done->GetDownloadContext();
+    off_t pasteBegin = static_cast<off_t>(ranges.front().beginIndex)
+                       * blockSize;
+    off_t pasteEnd = static_cast<off_t>(ranges.back().endIndex + 1)
+                     * blockSize;
+    done->SetPasteRange(pasteBegin, pasteEnd - pasteBegin);
+
+    // paste区域内已经写过的部分不会写入chunk，但会随paste请求写入raft日志，
+    // 填0避免将未初始化的内存写入日志
+    off_t gapBegin = pasteBegin;
+    for (const auto& range : ranges) {
+        off_t rangeBegin = static_cast<off_t>(range.beginIndex) * blockSize;
+        if (rangeBegin > gapBegin) {
+            memset(context->buf + (gapBegin - context->offset), 0,
+                   rangeBegin - gapBegin);
+        }
+        gapBegin = static_cast<off_t>(range.endIndex + 1) * blockSize;
+    }
+
+    auto state = std::make_shared<DownloadRangeState>();
+    state->pending.store(ranges.size());
+    state->failed.store(false);
+    for (const auto& range : ranges) {
+        AsyncDownloadContext* rangeCtx =
+            new (std::nothrow) AsyncDownloadContext;
+        rangeCtx->location = context->location;
+        rangeCtx->offset = static_cast<off_t>(range.beginIndex) * blockSize;
+        rangeCtx->size = static_cast<size_t>(
+            range.endIndex - range.beginIndex + 1) * blockSize;
+        rangeCtx->buf = context->buf + (rangeCtx->offset - context->offset);
+        DownloadRangeClosure* rangeClosure =
+            new (std::nothrow) DownloadRangeClosure(done, state, rangeCtx);
+        copyer_->DownloadAsync(rangeClosure);
+    }
+}
+
 inline void CloneCore::SetResponse(
     std::shared_ptr<ReadChunkRequest> readRequest, CHUNK_OP_STATUS status) {
     auto applyIndex = readRequest->node_->GetAppliedIndex();
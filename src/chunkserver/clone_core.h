@@ -27,7 +27,9 @@
 #include <google/protobuf/message.h>
 #include <google/protobuf/stubs/callback.h>
 #include <brpc/controller.h>
+#include <atomic>
 #include <memory>
+#include <vector>
 
 #include "proto/chunk.pb.h"
 #include "include/chunkserver/chunkserver_common.h"
@@ -41,6 +43,7 @@ namespace chunkserver {
 using ::google::protobuf::Closure;
 using ::google::protobuf::Message;
 using curve::chunkserver::CSChunkInfo;
+using curve::common::BitRange;
 using common::TimeUtility;
 
 class ReadChunkRequest;
@@ -64,6 +67,12 @@ class DownloadClosure : public Closure {
         return downloadCtx_;
     }
 
+    // 设置下载完成后要paste的区域，需在下载区域内，默认paste整个下载区域
+    void SetPasteRange(off_t offset, size_t size) {
+        pasteOffset_ = offset;
+        pasteSize_ = size;
+    }
+
  protected:
     // 下载是否出错出错
     bool isFailed_;
@@ -77,6 +86,37 @@ class DownloadClosure : public Closure {
     std::shared_ptr<ReadChunkRequest> readRequest_;
     // DownloadClosure生命周期结束后需要执行的回调
     Closure* done_;
+    // 需要paste到chunk文件的区域
+    off_t pasteOffset_;
+    size_t pasteSize_;
+};
+
+// 一个请求拆分成多个区域下载时各区域共享的状态
+struct DownloadRangeState {
+    // 尚未完成的区域个数
+    std::atomic<uint32_t> pending;
+    // 是否有区域下载失败
+    std::atomic<bool> failed;
+};
+
+/**
+ * 下载请求中的一段连续区域，数据直接写入parent的缓冲区中对应的位置，
+ * 所有区域都完成后执行parent，由parent统一返回结果并paste
+ */
+class DownloadRangeClosure : public DownloadClosure {
+ public:
+    DownloadRangeClosure(DownloadClosure* parent,
+                         std::shared_ptr<DownloadRangeState> state,
+                         AsyncDownloadContext* downloadCtx)
+        : DownloadClosure(nullptr, nullptr, downloadCtx, nullptr)
+        , parent_(parent)
+        , state_(state) {}
+
+    void Run() override;
+
+ private:
+    DownloadClosure* parent_;
+    std::shared_ptr<DownloadRangeState> state_;
 };
 
 class CloneClosure : public Closure {
@@ -190,6 +230,16 @@ class CloneCore : public std::enable_shared_from_this<CloneCore> {
     inline void SetResponse(std::shared_ptr<ReadChunkRequest> readRequest,
                             CHUNK_OP_STATUS status);
 
+    /**
+     * 只下载请求范围内未被写过的区域，各区域并发下载到done的缓冲区中
+     * @param done: 覆盖整个请求范围的下载closure
+     * @param ranges: 未被写过的连续区域
+     * @param blockSize: bitmap中每一位对应的数据大小
+     */
+    void DownloadRanges(DownloadClosure* done,
+                        const std::vector<BitRange>& ranges,
+                        uint32_t blockSize);
+
  private:
     // 每次拷贝的slice的大小
     uint32_t sliceSize_;
@@ -0,0 +1,314 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/chunkserver/clone_flattener.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "src/common/bitmap.h"
+#include "src/common/timeutility.h"
+#include "src/chunkserver/clone_manager.h"
+#include "src/chunkserver/copyset_node_manager.h"
+#include "src/chunkserver/op_request.h"
+
+namespace curve {
+namespace chunkserver {
+
+using curve::common::Bitmap;
+using curve::common::TimeUtility;
+
+namespace {
+
+// 后台recover请求的闭包，释放请求并通知flattener
+class FlattenClosure : public ::google::protobuf::Closure {
+ public:
+    FlattenClosure(ChunkRequest* request,
+                   ChunkResponse* response,
+                   std::atomic<bool>* failed,
+                   CountDownEvent* event)
+        : request_(request)
+        , response_(response)
+        , failed_(failed)
+        , event_(event) {}
+
+    void Run() override {
+        std::unique_ptr<FlattenClosure> selfGuard(this);
+        std::unique_ptr<ChunkRequest> requestGuard(request_);
+        std::unique_ptr<ChunkResponse> responseGuard(response_);
+        if (response_->status() != CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS) {
+            LOG(WARNING) << "Flatten clone chunk failed, request: "
+                         << request_->ShortDebugString()
+                         << ", status: " << response_->status();
+            failed_->store(true);
+        }
+        event_->Signal();
+    }
+
+ private:
+    ChunkRequest* request_;
+    ChunkResponse* response_;
+    std::atomic<bool>* failed_;
+    CountDownEvent* event_;
+};
+
+}  // namespace
+
+CloneFlattener::CloneFlattener()
+    : enable_(false)
+    , toStop_(true)
+    , recoverCount_("chunkserver_clone_flatten_recover_count")
+    , flattenedChunks_("chunkserver_clone_flattened_chunks") {}
+
+int CloneFlattener::Init(const CloneFlattenerOptions& options) {
+    options_ = options;
+    enable_ = options.enable;
+    if (!enable_) {
+        return 0;
+    }
+    if (options_.copysetNodeManager == nullptr ||
+        options_.cloneManager == nullptr ||
+        options_.sliceSize == 0 || options_.concurrency == 0) {
+        LOG(ERROR) << "Invalid clone flattener options";
+        return -1;
+    }
+    return 0;
+}
+
+int CloneFlattener::Run() {
+    if (!enable_) {
+        LOG(INFO) << "Clone flattener is disabled.";
+        return 0;
+    }
+    toStop_.store(false, std::memory_order_release);
+    sleeper_.init();
+    thread_ = Thread(&CloneFlattener::Flatten, this);
+    LOG(INFO) << "Start clone flattener success.";
+    return 0;
+}
+
+int CloneFlattener::Fini() {
+    if (!toStop_.exchange(true)) {
+        LOG(INFO) << "Begin to stop clone flattener.";
+        sleeper_.interrupt();
+        thread_.join();
+        LOG(INFO) << "Stop clone flattener success.";
+    }
+    return 0;
+}
+
+void CloneFlattener::OnCloneRead(LogicPoolID poolId,
+                                 CopysetID copysetId,
+                                 ChunkID chunkId) {
+    if (!enable_) {
+        return;
+    }
+    FlattenTarget target{poolId, copysetId, chunkId};
+    std::lock_guard<std::mutex> lk(mtx_);
+    candidates_.insert(target);
+    ++heat_[target];
+}
+
+void CloneFlattener::PickTargets(uint32_t num,
+                                 std::vector<FlattenTarget>* targets) {
+    targets->clear();
+    std::lock_guard<std::mutex> lk(mtx_);
+    // 读过的chunk按热度从高到低优先拷贝
+    std::vector<std::pair<uint64_t, FlattenTarget>> hot;
+    for (const auto& item : heat_) {
+        hot.emplace_back(item.second, item.first);
+    }
+    std::sort(hot.begin(), hot.end(),
+              [](const std::pair<uint64_t, FlattenTarget>& a,
+                 const std::pair<uint64_t, FlattenTarget>& b) {
+                  return a.first > b.first;
+              });
+    for (const auto& item : hot) {
+        if (targets->size() >= num) {
+            return;
+        }
+        targets->push_back(item.second);
+    }
+    for (const auto& target : candidates_) {
+        if (targets->size() >= num) {
+            return;
+        }
+        if (heat_.find(target) == heat_.end()) {
+            targets->push_back(target);
+        }
+    }
+}
+
+void CloneFlattener::RemoveTarget(const FlattenTarget& target) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    candidates_.erase(target);
+    heat_.erase(target);
+}
+
+void CloneFlattener::DecayHeat() {
+    std::lock_guard<std::mutex> lk(mtx_);
+    for (auto iter = heat_.begin(); iter != heat_.end();) {
+        iter->second /= 2;
+        if (iter->second == 0) {
+            iter = heat_.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+bool CloneFlattener::IsIdle() const {
+    if (options_.inflightThrottle == nullptr) {
+        return true;
+    }
+    return options_.inflightThrottle->GetInflight() <= options_.idleInflight;
+}
+
+void CloneFlattener::ScanCloneChunks() {
+    std::vector<std::shared_ptr<CopysetNode>> nodes;
+    options_.copysetNodeManager->GetAllCopysetNodes(&nodes);
+    std::set<FlattenTarget> found;
+    for (const auto& node : nodes) {
+        if (!node->IsLeaderTerm()) {
+            continue;
+        }
+        node->GetDataStore()->ForEachChunk(
+            [&](ChunkID id, const CSChunkFilePtr& chunkFile) {
+                CSChunkInfo info;
+                chunkFile->GetInfo(&info);
+                if (info.isClone) {
+                    found.insert({node->GetLogicPoolId(),
+                                  node->GetCopysetId(), id});
+                }
+            });
+    }
+    LOG(INFO) << "Clone flattener found " << found.size()
+              << " clone chunks on " << nodes.size() << " copysets";
+    std::lock_guard<std::mutex> lk(mtx_);
+    candidates_.swap(found);
+    // 读过但未被收集到的chunk可能是新创建的，一并保留
+    for (const auto& item : heat_) {
+        candidates_.insert(item.first);
+    }
+}
+
+bool CloneFlattener::IssueRecover(const FlattenTarget& target,
+                                  CountDownEvent* event,
+                                  std::atomic<bool>* failed) {
+    std::shared_ptr<CopysetNode> node =
+        options_.copysetNodeManager->GetCopysetNode(target.poolId,
+                                                    target.copysetId);
+    if (node == nullptr || !node->IsLeaderTerm()) {
+        return false;
+    }
+    CSChunkInfo info;
+    CSErrorCode errorCode =
+        node->GetDataStore()->GetChunkInfo(target.chunkId, &info);
+    if (errorCode != CSErrorCode::Success) {
+        return false;
+    }
+    uint32_t index = Bitmap::NO_POS;
+    if (info.isClone && info.bitmap != nullptr) {
+        index = info.bitmap->NextClearBit(0, info.bitmap->Size() - 1);
+    }
+    if (index == Bitmap::NO_POS) {
+        // chunk的数据已经全部在本地
+        flattenedChunks_ << 1;
+        return false;
+    }
+
+    // 从第一个未写过的block所在的slice开始recover
+    uint64_t offset = static_cast<uint64_t>(index) * info.blockSize;
+    offset = offset / options_.sliceSize * options_.sliceSize;
+    uint64_t size = std::min<uint64_t>(options_.sliceSize,
+                                       info.chunkSize - offset);
+
+    ChunkRequest* request = new ChunkRequest();
+    ChunkResponse* response = new ChunkResponse();
+    request->set_optype(CHUNK_OP_TYPE::CHUNK_OP_RECOVER);
+    request->set_logicpoolid(target.poolId);
+    request->set_copysetid(target.copysetId);
+    request->set_chunkid(target.chunkId);
+    request->set_offset(offset);
+    request->set_size(size);
+    FlattenClosure* done = new FlattenClosure(request, response,
+                                              failed, event);
+    auto req = std::make_shared<ReadChunkRequest>(node,
+                                                  options_.cloneManager,
+                                                  nullptr,
+                                                  request,
+                                                  response,
+                                                  done);
+    req->Process();
+    recoverCount_ << 1;
+    return true;
+}
+
+void CloneFlattener::Flatten() {
+    uint32_t waitMs = options_.intervalMs;
+    uint64_t lastScanUs = 0;
+    std::vector<FlattenTarget> targets;
+    while (!toStop_.load(std::memory_order_acquire)) {
+        if (waitMs > 0 &&
+            !sleeper_.wait_for(std::chrono::milliseconds(waitMs))) {
+            break;
+        }
+
+        // 前台繁忙时退避，空闲后恢复
+        if (!IsIdle()) {
+            waitMs = std::min(std::max(waitMs, options_.intervalMs) * 2,
+                              options_.maxBackoffMs);
+            continue;
+        }
+        waitMs = options_.intervalMs;
+
+        uint64_t nowUs = TimeUtility::GetTimeofDayUs();
+        if (lastScanUs == 0 ||
+            nowUs - lastScanUs >= options_.rescanIntervalSec * 1000000ull) {
+            DecayHeat();
+            ScanCloneChunks();
+            lastScanUs = nowUs;
+        }
+
+        PickTargets(options_.concurrency, &targets);
+        if (targets.empty()) {
+            continue;
+        }
+        std::atomic<bool> failed(false);
+        CountDownEvent event(targets.size());
+        uint32_t skipped = 0;
+        for (const auto& target : targets) {
+            if (!IssueRecover(target, &event, &failed)) {
+                RemoveTarget(target);
+                event.Signal();
+                ++skipped;
+            }
+        }
+        event.Wait();
+
+        // 拷贝成功时立即开始下一轮，失败时多半是源端出错，等待最长的退避时间
+        if (failed.load()) {
+            waitMs = options_.maxBackoffMs;
+        } else if (skipped < targets.size()) {
+            waitMs = 0;
+        }
+    }
+}
+
+}  // namespace chunkserver
+}  // namespace curve
@@ -0,0 +1,169 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_CHUNKSERVER_CLONE_FLATTENER_H_
+#define SRC_CHUNKSERVER_CLONE_FLATTENER_H_
+
+#include <bvar/bvar.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "include/chunkserver/chunkserver_common.h"
+#include "src/common/concurrent/concurrent.h"
+#include "src/common/concurrent/count_down_event.h"
+#include "src/common/interruptible_sleeper.h"
+#include "src/chunkserver/inflight_throttle.h"
+
+namespace curve {
+namespace chunkserver {
+
+using curve::common::Thread;
+using curve::common::CountDownEvent;
+using curve::common::InterruptibleSleeper;
+
+class CopysetNodeManager;
+class CloneManager;
+
+struct CloneFlattenerOptions {
+    // 是否在后台拷贝clone chunk未写过的数据
+    bool enable;
+    CopysetNodeManager* copysetNodeManager;
+    CloneManager* cloneManager;
+    // 前台请求的inflight计数，用于判断前台负载
+    std::shared_ptr<InflightThrottle> inflightThrottle;
+    // 每次recover的数据大小，同clone的slice大小
+    uint64_t sliceSize;
+    // 同时进行的recover请求个数
+    uint32_t concurrency;
+    // 前台inflight请求不超过该值时认为空闲
+    uint64_t idleInflight;
+    // 检查空闲的周期，单位ms
+    uint32_t intervalMs;
+    // 前台繁忙时检查周期的最大退避时间，单位ms
+    uint32_t maxBackoffMs;
+    // 重新收集clone chunk的周期，单位s
+    uint32_t rescanIntervalSec;
+    CloneFlattenerOptions() : enable(false)
+                            , copysetNodeManager(nullptr)
+                            , cloneManager(nullptr)
+                            , inflightThrottle(nullptr)
+                            , sliceSize(1024 * 1024)
+                            , concurrency(4)
+                            , idleInflight(16)
+                            , intervalMs(1000)
+                            , maxBackoffMs(30000)
+                            , rescanIntervalSec(300) {}
+};
+
+struct FlattenTarget {
+    LogicPoolID poolId;
+    CopysetID copysetId;
+    ChunkID chunkId;
+
+    bool operator<(const FlattenTarget& rhs) const {
+        return std::tie(poolId, copysetId, chunkId) <
+               std::tie(rhs.poolId, rhs.copysetId, rhs.chunkId);
+    }
+    bool operator==(const FlattenTarget& rhs) const {
+        return poolId == rhs.poolId && copysetId == rhs.copysetId &&
+               chunkId == rhs.chunkId;
+    }
+};
+
+/**
+ * 在前台空闲时，通过recover请求在后台把clone chunk未写过的数据从源端拷贝
+ * 到本地，缩短clone卷依赖源端的时间，也避免首次读时才从源端拷贝。
+ * 只处理本节点为leader的copyset上的chunk，最近读得多的chunk优先处理。
+ */
+class CloneFlattener {
+ public:
+    CloneFlattener();
+    virtual ~CloneFlattener() {}
+
+    int Init(const CloneFlattenerOptions& options);
+
+    int Run();
+
+    int Fini();
+
+    /**
+     * @brief 记录一次需要从源端拷贝数据的读请求，读得越多的chunk越先被拷贝
+     */
+    void OnCloneRead(LogicPoolID poolId, CopysetID copysetId, ChunkID chunkId);
+
+    /**
+     * @brief 按读热度从高到低选出要拷贝的chunk
+     * @param num: 最多选出的个数
+     * @param targets: 选出的chunk
+     */
+    void PickTargets(uint32_t num, std::vector<FlattenTarget>* targets);
+
+    /**
+     * @brief chunk已经拷贝完或不再需要拷贝
+     */
+    void RemoveTarget(const FlattenTarget& target);
+
+    // 每次收集clone chunk时热度减半，近期的读请求权重更高
+    void DecayHeat();
+
+ private:
+    void Flatten();
+
+    // 前台请求较少时返回true
+    bool IsIdle() const;
+
+    // 收集本节点为leader的copyset上的clone chunk
+    void ScanCloneChunks();
+
+    /**
+     * @brief 对chunk第一个未拷贝的slice发起recover请求
+     * @param event: 请求完成后通知
+     * @param failed: 请求失败时被置为true
+     * @return: 发起了请求返回true，chunk不需要拷贝时返回false
+     */
+    bool IssueRecover(const FlattenTarget& target,
+                      CountDownEvent* event,
+                      std::atomic<bool>* failed);
+
+ private:
+    CloneFlattenerOptions options_;
+    bool enable_;
+
+    Thread thread_;
+    std::atomic<bool> toStop_;
+    InterruptibleSleeper sleeper_;
+
+    // 保护candidates_和heat_
+    std::mutex mtx_;
+    // 待拷贝的clone chunk
+    std::set<FlattenTarget> candidates_;
+    // chunk近期的读热度
+    std::map<FlattenTarget, uint64_t> heat_;
+
+    bvar::Adder<uint64_t> recoverCount_;
+    bvar::Adder<uint64_t> flattenedChunks_;
+};
+
+}  // namespace chunkserver
+}  // namespace curve
+
+#endif  // SRC_CHUNKSERVER_CLONE_FLATTENER_H_
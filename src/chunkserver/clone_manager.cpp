@@ -21,6 +21,8 @@
  */
 
 #include "src/chunkserver/clone_manager.h"
+#include "src/chunkserver/clone_flattener.h"
+#include "src/chunkserver/op_request.h"
 
 namespace curve {
 namespace chunkserver {
@@ -74,6 +76,16 @@ std::shared_ptr<CloneTask> CloneManager::GenerateCloneTask(
     if (options_.core == nullptr)
         return nullptr;
 
+    // 记录需要从源端拷贝数据的读请求，后台优先拷贝读得多的chunk
+    if (options_.flattener != nullptr && request != nullptr) {
+        const ChunkRequest* chunkRequest = request->GetChunkRequest();
+        if (chunkRequest->optype() == CHUNK_OP_TYPE::CHUNK_OP_READ) {
+            options_.flattener->OnCloneRead(chunkRequest->logicpoolid(),
+                                            chunkRequest->copysetid(),
+                                            chunkRequest->chunkid());
+        }
+    }
+
     std::shared_ptr<CloneTask> cloneTask =
         std::make_shared<CloneTask>(request, options_.core, done);
     return cloneTask;
@@ -42,10 +42,13 @@ namespace chunkserver {
 using curve::common::TaskThreadPool;
 
 class ReadChunkRequest;
+class CloneFlattener;
 
 struct CloneOptions {
     // 核心逻辑处理类
     std::shared_ptr<CloneCore> core;
+    // 后台拷贝clone chunk的模块，用于统计clone chunk的读热度，可以为nullptr
+    CloneFlattener* flattener;
     // 最大线程数
     uint32_t threadNum;
     // 最大队列深度
@@ -53,6 +56,7 @@ struct CloneOptions {
     // 任务状态检查的周期,单位ms
     uint32_t checkPeriod;
     CloneOptions() : core(nullptr)
+                   , flattener(nullptr)
                    , threadNum(10)
                    , queueCapacity(100)
                    , checkPeriod(5000) {}
@@ -23,6 +23,7 @@
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <vector>
 #include "src/chunkserver/concurrent_apply/concurrent_apply.h"
 #include "src/common/concurrent/count_down_event.h"
 
@@ -42,9 +43,19 @@ bool ConcurrentApplyModule::Init(const ConcurrentApplyOption &opt) {
     }
 
     start_ = true;
-    cond_.Reset(opt.rconcurrentsize + opt.wconcurrentsize);
-    InitThreadPool(ApplyTaskType::READ, rconcurrentsize_, rqueuedepth_);
-    InitThreadPool(ApplyTaskType::WRITE, wconcurrentsize_, wqueuedepth_);
+    int wthreadnum = wslotnum_ > 0 ? 0 : wconcurrentsize_;
+    int rthreadnum = rworkstealing_ ? 0 : rconcurrentsize_;
+    cond_.Reset(wthreadnum + rthreadnum);
+    if (wslotnum_ > 0) {
+        wpool_.Start(wconcurrentsize_, wslotnum_, wqueuedepth_);
+    } else {
+        InitThreadPool(ApplyTaskType::WRITE, wconcurrentsize_, wqueuedepth_);
+    }
+    if (rworkstealing_) {
+        rpool_.Start(rconcurrentsize_, rqueuedepth_);
+    } else {
+        InitThreadPool(ApplyTaskType::READ, rconcurrentsize_, rqueuedepth_);
+    }
 
     if (!cond_.WaitFor(5000)) {
         LOG(ERROR) << "init concurrent module's threads fail";
@@ -58,12 +69,13 @@ bool ConcurrentApplyModule::Init(const ConcurrentApplyOption &opt) {
 bool ConcurrentApplyModule::checkOptAndInit(
     const ConcurrentApplyOption &opt) {
     if (opt.rconcurrentsize <= 0 || opt.wconcurrentsize <= 0 ||
-        opt.rqueuedepth <= 0 || opt.wqueuedepth <= 0) {
+        opt.rqueuedepth <= 0 || opt.wqueuedepth <= 0 || opt.wslotnum < 0) {
         LOG(INFO) << "init concurrent module fail, params must >=0"
             << ", rconcurrentsize=" << opt.rconcurrentsize
             << ", wconcurrentsize=" << opt.wconcurrentsize
             << ", rqueuedepth=" << opt.rqueuedepth
-            << ", wconcurrentsize=" << opt.wqueuedepth;
+            << ", wconcurrentsize=" << opt.wqueuedepth
+            << ", wslotnum=" << opt.wslotnum;
         return false;
     }
 
@@ -71,6 +83,8 @@ bool ConcurrentApplyModule::checkOptAndInit(
     wqueuedepth_ = opt.wqueuedepth;
     rconcurrentsize_ = opt.rconcurrentsize;
     rqueuedepth_ = opt.rqueuedepth;
+    wslotnum_ = opt.wslotnum;
+    rworkstealing_ = opt.rworkstealing;
 
     return true;
 }
@@ -110,16 +124,26 @@ void ConcurrentApplyModule::InitThreadPool(
 
 void ConcurrentApplyModule::Run(ApplyTaskType type, int index) {
     cond_.Signal();
-    while (start_) {
-        switch (type) {
-        case ApplyTaskType::READ:
-            rapplyMap_[index]->tq.Pop()();
-            break;
+    TaskThread* taskThread = nullptr;
+    switch (type) {
+    case ApplyTaskType::READ:
+        taskThread = rapplyMap_[index];
+        break;
+
+    case ApplyTaskType::WRITE:
+        taskThread = wapplyMap_[index];
+        break;
+    }
 
-        case ApplyTaskType::WRITE:
-            wapplyMap_[index]->tq.Pop()();
-            break;
+    // drain all the available tasks in one wakeup
+    std::vector<TaskThread::Queue::Task> tasks;
+    const size_t maxBatch = taskThread->tq.Capacity();
+    while (start_) {
+        taskThread->tq.PopBatch(&tasks, maxBatch);
+        for (auto& task : tasks) {
+            task();
         }
+        tasks.clear();
     }
 }
 
@@ -143,6 +167,8 @@ void ConcurrentApplyModule::Stop() {
         delete iter.second;
     }
     wapplyMap_.clear();
+    wpool_.Stop();
+    rpool_.Stop();
 
     LOG(INFO) << "stop ConcurrentApplyModule ok.";
 }
@@ -152,6 +178,11 @@ void ConcurrentApplyModule::Flush() {
         return;
     }
 
+    if (wslotnum_ > 0) {
+        wpool_.Flush();
+        return;
+    }
+
     CountDownEvent event(wconcurrentsize_);
     auto flushtask = [&event]() { event.Signal(); };
 
@@ -167,18 +198,27 @@ void ConcurrentApplyModule::FlushAll() {
         return;
     }
 
-    CountDownEvent event(wconcurrentsize_ + rconcurrentsize_);
+    int wqueuenum = wslotnum_ > 0 ? 0 : wconcurrentsize_;
+    int rqueuenum = rworkstealing_ ? 0 : rconcurrentsize_;
+    CountDownEvent event(wqueuenum + rqueuenum);
     auto flushtask = [&event]() { event.Signal(); };
 
-    for (int i = 0; i < wconcurrentsize_; i++) {
+    for (int i = 0; i < wqueuenum; i++) {
         wapplyMap_[i]->tq.Push(flushtask);
     }
 
-    for (int i = 0; i < rconcurrentsize_; i++) {
+    for (int i = 0; i < rqueuenum; i++) {
         rapplyMap_[i]->tq.Push(flushtask);
     }
 
     event.Wait();
+
+    if (wslotnum_ > 0) {
+        wpool_.Flush();
+    }
+    if (rworkstealing_) {
+        rpool_.Flush();
+    }
 }
 
 }   // namespace concurrent
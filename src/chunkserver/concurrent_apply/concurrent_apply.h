@@ -37,7 +37,9 @@
 #include "include/curve_compiler_specific.h"
 #include "proto/chunk.pb.h"
 #include "src/common/concurrent/count_down_event.h"
-#include "src/common/concurrent/task_queue.h"
+#include "src/common/concurrent/mpsc_task_queue.h"
+#include "src/chunkserver/concurrent_apply/ordered_task_pool.h"
+#include "src/chunkserver/concurrent_apply/work_stealing_task_pool.h"
 
 using curve::common::CountDownEvent;
 using curve::chunkserver::CHUNK_OP_TYPE;
@@ -46,18 +48,26 @@ namespace curve {
 namespace chunkserver {
 namespace concurrent {
 
-using ::curve::common::GenericTaskQueue;
+using ::curve::common::MPSCTaskQueue;
 
 struct ConcurrentApplyOption {
     int wconcurrentsize;
     int wqueuedepth;
     int rconcurrentsize;
     int rqueuedepth;
+    // if wslotnum > 0, write tasks are hashed into wslotnum ordered slots
+    // shared by all write threads instead of one queue per write thread,
+    // wqueuedepth is the depth of every slot then
+    int wslotnum;
+    // if true, idle read threads steal tasks from the queues of others
+    bool rworkstealing;
 
     ConcurrentApplyOption(int wconcurrentsize = 0, int wqueuedepth = 0,
-                          int rconcurrentsize = 0, int rqueuedepth = 0)
+                          int rconcurrentsize = 0, int rqueuedepth = 0,
+                          int wslotnum = 0, bool rworkstealing = false)
         : wconcurrentsize(wconcurrentsize), wqueuedepth(wqueuedepth),
-          rconcurrentsize(rconcurrentsize), rqueuedepth(rqueuedepth) {}
+          rconcurrentsize(rconcurrentsize), rqueuedepth(rqueuedepth),
+          wslotnum(wslotnum), rworkstealing(rworkstealing) {}
 };
 
 enum class ApplyTaskType {READ, WRITE};
@@ -69,6 +79,8 @@ class CURVE_CACHELINE_ALIGNMENT ConcurrentApplyModule {
                              rqueuedepth_(0),
                              wconcurrentsize_(0),
                              wqueuedepth_(0),
+                             wslotnum_(0),
+                             rworkstealing_(false),
                              cond_(0) {}
 
     /**
@@ -91,10 +103,20 @@ class CURVE_CACHELINE_ALIGNMENT ConcurrentApplyModule {
     bool Push(uint64_t key, ApplyTaskType optype, F&& f, Args&&... args) {
         switch (optype) {
             case ApplyTaskType::READ:
+                if (rworkstealing_) {
+                    rpool_.Push(key, std::forward<F>(f),
+                                std::forward<Args>(args)...);
+                    break;
+                }
                 rapplyMap_[Hash(key, rconcurrentsize_)]->tq.Push(
                         std::forward<F>(f), std::forward<Args>(args)...);
                 break;
             case ApplyTaskType::WRITE:
+                if (wslotnum_ > 0) {
+                    wpool_.Push(key, std::forward<F>(f),
+                                std::forward<Args>(args)...);
+                    break;
+                }
                 wapplyMap_[Hash(key, wconcurrentsize_)]->tq.Push(
                         std::forward<F>(f), std::forward<Args>(args)...);
                 break;
@@ -125,7 +147,9 @@ class CURVE_CACHELINE_ALIGNMENT ConcurrentApplyModule {
  private:
     struct TaskThread {
         std::thread th;
-        GenericTaskQueue<bthread::Mutex, bthread::ConditionVariable> tq;
+        using Queue =
+            MPSCTaskQueue<bthread::Mutex, bthread::ConditionVariable>;
+        Queue tq;
         explicit TaskThread(size_t capacity) : tq(capacity) {}
     };
 
@@ -134,9 +158,15 @@ class CURVE_CACHELINE_ALIGNMENT ConcurrentApplyModule {
     int rqueuedepth_;
     int wconcurrentsize_;
     int wqueuedepth_;
+    int wslotnum_;
+    bool rworkstealing_;
     CountDownEvent cond_;
     CURVE_CACHELINE_ALIGNMENT std::unordered_map<int, TaskThread*> wapplyMap_;
     CURVE_CACHELINE_ALIGNMENT std::unordered_map<int, TaskThread*> rapplyMap_;
+    // used for write tasks if wslotnum_ > 0
+    OrderedTaskPool wpool_;
+    // used for read tasks if rworkstealing_ is true
+    WorkStealingTaskPool rpool_;
 };
 }   // namespace concurrent
 }   // namespace chunkserver
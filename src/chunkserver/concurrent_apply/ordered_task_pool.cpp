@@ -0,0 +1,138 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <glog/logging.h>
+
+#include "src/chunkserver/concurrent_apply/ordered_task_pool.h"
+#include "src/common/concurrent/count_down_event.h"
+
+namespace curve {
+namespace chunkserver {
+namespace concurrent {
+
+using ::curve::common::CountDownEvent;
+
+void OrderedTaskPool::Start(int threadNum, int slotNum, int slotDepth) {
+    CHECK(threadNum > 0 && slotNum > 0 && slotDepth > 0)
+        << "invalid params, threadNum: " << threadNum
+        << ", slotNum: " << slotNum << ", slotDepth: " << slotDepth;
+
+    std::lock_guard<bthread::Mutex> lk(mtx_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    slotDepth_ = slotDepth;
+    slots_ = std::vector<Slot>(slotNum);
+    for (int i = 0; i < threadNum; ++i) {
+        workers_.emplace_back(&OrderedTaskPool::Run, this);
+    }
+}
+
+void OrderedTaskPool::Stop() {
+    {
+        std::lock_guard<bthread::Mutex> lk(mtx_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    readyCv_.notify_all();
+    notFullCv_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+
+    std::lock_guard<bthread::Mutex> lk(mtx_);
+    ready_.clear();
+    slots_.clear();
+}
+
+void OrderedTaskPool::PushTask(size_t index, Task task) {
+    {
+        std::unique_lock<bthread::Mutex> lk(mtx_);
+        Slot& slot = slots_[index];
+        while (running_ && slot.tasks.size() >= slotDepth_) {
+            notFullCv_.wait(lk);
+        }
+        if (!running_) {
+            return;
+        }
+        slot.tasks.push_back(std::move(task));
+        if (slot.scheduled) {
+            return;
+        }
+        slot.scheduled = true;
+        ready_.push_back(index);
+    }
+    readyCv_.notify_one();
+}
+
+void OrderedTaskPool::Flush() {
+    size_t slotNum = 0;
+    {
+        std::lock_guard<bthread::Mutex> lk(mtx_);
+        if (!running_) {
+            return;
+        }
+        slotNum = slots_.size();
+    }
+
+    CountDownEvent event(slotNum);
+    auto flushtask = [&event]() { event.Signal(); };
+    for (size_t i = 0; i < slotNum; ++i) {
+        PushTask(i, flushtask);
+    }
+    event.Wait();
+}
+
+void OrderedTaskPool::Run() {
+    std::unique_lock<bthread::Mutex> lk(mtx_);
+    while (true) {
+        while (running_ && ready_.empty()) {
+            readyCv_.wait(lk);
+        }
+        if (!running_) {
+            break;
+        }
+
+        size_t index = ready_.front();
+        ready_.pop_front();
+        Slot& slot = slots_[index];
+        // keep the task in the slot while executing, so that the slot
+        // is not full until the task is finished
+        Task task = std::move(slot.tasks.front());
+
+        lk.unlock();
+        task();
+        lk.lock();
+
+        slot.tasks.pop_front();
+        if (slot.tasks.empty()) {
+            slot.scheduled = false;
+        } else {
+            ready_.push_back(index);
+            readyCv_.notify_one();
+        }
+        notFullCv_.notify_all();
+    }
+}
+
+}  // namespace concurrent
+}  // namespace chunkserver
+}  // namespace curve
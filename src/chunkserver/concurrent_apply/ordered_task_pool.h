@@ -0,0 +1,104 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_CHUNKSERVER_CONCURRENT_APPLY_ORDERED_TASK_POOL_H_
+#define SRC_CHUNKSERVER_CONCURRENT_APPLY_ORDERED_TASK_POOL_H_
+
+#include <bthread/condition_variable.h>
+#include <bthread/mutex.h>
+
+#include <deque>
+#include <functional>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "src/common/uncopyable.h"
+
+namespace curve {
+namespace chunkserver {
+namespace concurrent {
+
+/**
+ * OrderedTaskPool hashes tasks into slots, tasks in the same slot are
+ * executed one by one in push order, while different slots are executed
+ * concurrently by any idle worker thread.
+ * Compared with binding every queue to one thread, a slow task only blocks
+ * the tasks in its own slot instead of all the tasks hashed to the thread.
+ */
+class OrderedTaskPool : public curve::common::Uncopyable {
+ public:
+    using Task = std::function<void()>;
+
+    OrderedTaskPool() : running_(false), slotDepth_(0) {}
+    ~OrderedTaskPool() { Stop(); }
+
+    /**
+     * @brief start the worker threads
+     * @param threadNum: number of worker threads
+     * @param slotNum: number of slots
+     * @param slotDepth: max number of tasks in one slot,
+     *        Push will be blocked if the slot is full
+     */
+    void Start(int threadNum, int slotNum, int slotDepth);
+
+    /**
+     * @brief stop the worker threads, tasks not executed yet are dropped
+     */
+    void Stop();
+
+    template <class F, class... Args>
+    void Push(uint64_t key, F&& f, Args&&... args) {
+        PushTask(key % slots_.size(),
+                 std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief wait until all the tasks pushed before are finished
+     */
+    void Flush();
+
+    int SlotNum() const { return static_cast<int>(slots_.size()); }
+
+ private:
+    struct Slot {
+        // the front task is being executed if scheduled is true
+        std::deque<Task> tasks;
+        bool scheduled = false;
+    };
+
+    void PushTask(size_t index, Task task);
+
+    void Run();
+
+ private:
+    bool running_;
+    size_t slotDepth_;
+    std::vector<Slot> slots_;
+    // slots which have tasks and are waiting for a worker
+    std::deque<size_t> ready_;
+    bthread::Mutex mtx_;
+    bthread::ConditionVariable readyCv_;
+    bthread::ConditionVariable notFullCv_;
+    std::vector<std::thread> workers_;
+};
+
+}  // namespace concurrent
+}  // namespace chunkserver
+}  // namespace curve
+
+#endif  // SRC_CHUNKSERVER_CONCURRENT_APPLY_ORDERED_TASK_POOL_H_
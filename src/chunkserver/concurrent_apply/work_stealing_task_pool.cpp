@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <glog/logging.h>
+
+#include "src/chunkserver/concurrent_apply/work_stealing_task_pool.h"
+
+namespace curve {
+namespace chunkserver {
+namespace concurrent {
+
+void WorkStealingTaskPool::Start(int threadNum, int depth) {
+    CHECK(threadNum > 0 && depth > 0)
+        << "invalid params, threadNum: " << threadNum << ", depth: " << depth;
+
+    if (running_.exchange(true)) {
+        return;
+    }
+    depth_ = depth;
+    for (int i = 0; i < threadNum; ++i) {
+        queues_.emplace_back(new TaskQueue());
+    }
+    for (int i = 0; i < threadNum; ++i) {
+        workers_.emplace_back(&WorkStealingTaskPool::Run, this, i);
+    }
+}
+
+void WorkStealingTaskPool::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    {
+        std::lock_guard<bthread::Mutex> lk(idleMtx_);
+        idleCv_.notify_all();
+        flushCv_.notify_all();
+    }
+    for (auto& queue : queues_) {
+        std::lock_guard<bthread::Mutex> lk(queue->mtx);
+        queue->notFullCv.notify_all();
+    }
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+    queues_.clear();
+    queued_ = 0;
+    unfinished_ = 0;
+}
+
+void WorkStealingTaskPool::PushTask(size_t index, Task task) {
+    TaskQueue* queue = queues_[index].get();
+    {
+        std::unique_lock<bthread::Mutex> lk(queue->mtx);
+        while (running_ && queue->tasks.size() >= depth_) {
+            queue->notFullCv.wait(lk);
+        }
+        if (!running_) {
+            return;
+        }
+        queue->tasks.push_back(std::move(task));
+        unfinished_.fetch_add(1);
+        queued_.fetch_add(1);
+    }
+
+    // only wake up a worker if someone is going to sleep
+    if (idle_.load() > 0) {
+        std::lock_guard<bthread::Mutex> lk(idleMtx_);
+        idleCv_.notify_one();
+    }
+}
+
+bool WorkStealingTaskPool::TryPop(size_t index, Task* task, bool wait) {
+    TaskQueue* queue = queues_[index].get();
+    std::unique_lock<bthread::Mutex> lk(queue->mtx, std::defer_lock);
+    if (wait) {
+        lk.lock();
+    } else if (!lk.try_lock()) {
+        return false;
+    }
+
+    if (queue->tasks.empty()) {
+        return false;
+    }
+    *task = std::move(queue->tasks.front());
+    queue->tasks.pop_front();
+    queued_.fetch_sub(1);
+    queue->notFullCv.notify_one();
+    return true;
+}
+
+void WorkStealingTaskPool::Flush() {
+    std::unique_lock<bthread::Mutex> lk(idleMtx_);
+    while (running_ && unfinished_.load() > 0) {
+        flushCv_.wait(lk);
+    }
+}
+
+void WorkStealingTaskPool::Run(size_t index) {
+    const size_t queueNum = queues_.size();
+    Task task;
+    while (running_) {
+        bool found = TryPop(index, &task, true);
+        for (size_t i = 1; !found && i < queueNum; ++i) {
+            found = TryPop((index + i) % queueNum, &task, false);
+        }
+
+        if (found) {
+            task();
+            task = nullptr;
+            if (unfinished_.fetch_sub(1) == 1) {
+                std::lock_guard<bthread::Mutex> lk(idleMtx_);
+                flushCv_.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<bthread::Mutex> lk(idleMtx_);
+        idle_.fetch_add(1);
+        while (running_ && queued_.load() == 0) {
+            idleCv_.wait(lk);
+        }
+        idle_.fetch_sub(1);
+    }
+}
+
+}  // namespace concurrent
+}  // namespace chunkserver
+}  // namespace curve
@@ -0,0 +1,111 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_CHUNKSERVER_CONCURRENT_APPLY_WORK_STEALING_TASK_POOL_H_
+#define SRC_CHUNKSERVER_CONCURRENT_APPLY_WORK_STEALING_TASK_POOL_H_
+
+#include <bthread/condition_variable.h>
+#include <bthread/mutex.h>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "src/common/uncopyable.h"
+
+namespace curve {
+namespace chunkserver {
+namespace concurrent {
+
+/**
+ * WorkStealingTaskPool is used for tasks which don't require any ordering,
+ * e.g. read requests. Every worker owns a queue and tasks are hashed into
+ * the queues by key, but a worker whose queue is empty steals tasks from
+ * its peers, so hot keys don't pin a single worker while others are idle.
+ */
+class WorkStealingTaskPool : public curve::common::Uncopyable {
+ public:
+    using Task = std::function<void()>;
+
+    WorkStealingTaskPool()
+        : running_(false), depth_(0), queued_(0), unfinished_(0), idle_(0) {}
+    ~WorkStealingTaskPool() { Stop(); }
+
+    /**
+     * @brief start the worker threads
+     * @param threadNum: number of worker threads as well as queues
+     * @param depth: max number of tasks in one queue,
+     *        Push will be blocked if the queue is full
+     */
+    void Start(int threadNum, int depth);
+
+    /**
+     * @brief stop the worker threads, tasks not executed yet are dropped
+     */
+    void Stop();
+
+    template <class F, class... Args>
+    void Push(uint64_t key, F&& f, Args&&... args) {
+        PushTask(key % queues_.size(),
+                 std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief wait until all the queued and running tasks are finished
+     */
+    void Flush();
+
+ private:
+    struct TaskQueue {
+        bthread::Mutex mtx;
+        bthread::ConditionVariable notFullCv;
+        std::deque<Task> tasks;
+    };
+
+    void PushTask(size_t index, Task task);
+
+    // pop a task from the queue, return false if it is empty
+    bool TryPop(size_t index, Task* task, bool wait);
+
+    void Run(size_t index);
+
+ private:
+    std::atomic<bool> running_;
+    size_t depth_;
+    std::vector<std::unique_ptr<TaskQueue>> queues_;
+    std::vector<std::thread> workers_;
+
+    // number of tasks in all queues
+    std::atomic<int64_t> queued_;
+    // number of tasks queued or running
+    std::atomic<int64_t> unfinished_;
+    // number of workers going to sleep
+    std::atomic<int> idle_;
+    bthread::Mutex idleMtx_;
+    bthread::ConditionVariable idleCv_;
+    bthread::ConditionVariable flushCv_;
+};
+
+}  // namespace concurrent
+}  // namespace chunkserver
+}  // namespace curve
+
+#endif  // SRC_CHUNKSERVER_CONCURRENT_APPLY_WORK_STEALING_TASK_POOL_H_
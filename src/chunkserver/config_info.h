@@ -25,11 +25,14 @@
 
 #include <string>
 #include <memory>
+#include <set>
 
 #include "src/fs/local_filesystem.h"
 #include "src/chunkserver/trash.h"
 #include "src/chunkserver/inflight_throttle.h"
 #include "src/chunkserver/concurrent_apply/concurrent_apply.h"
+#include "src/chunkserver/datastore/chunk_page_cache.h"
+#include "src/chunkserver/datastore/sync_fs_group.h"
 #include "include/chunkserver/chunkserver_common.h"
 
 namespace curve {
@@ -41,6 +44,7 @@ using curve::chunkserver::concurrent::ConcurrentApplyModule;
 class FilePool;
 class CopysetNodeManager;
 class CloneManager;
+class QosScheduler;
 
 /**
  * copyset node的配置选项
@@ -118,6 +122,19 @@ struct CopysetNodeOptions {
 
     // 限制chunkserver启动时copyset并发恢复加载的数量,为0表示不限制
     uint32_t loadConcurrency = 0;
+    // 每个copyset加载chunk文件的线程数
+    uint32_t chunkLoadConcurrency = 1;
+    // scan时chunk区域的crc被缓存后最多复用的次数，为0表示不缓存
+    uint32_t scanCrcCacheMaxHits = 0;
+    // 所有copyset共用的chunk数据页缓存，为nullptr表示不缓存
+    std::shared_ptr<ChunkPageCache> pageCache;
+    // 新建chunk的每块数据校验和覆盖的大小，为0表示不保存数据校验和
+    uint32_t dataChecksumBlockSize = 0;
+    // 保存数据校验和的逻辑池，为空表示所有逻辑池
+    std::set<LogicPoolID> dataChecksumLogicPools;
+    // chunk快照采用redirect-on-write，快照期间新写的数据写到快照文件，
+    // 快照数据留在chunk文件中，删除快照时再合并回chunk文件
+    bool enableRedirectOnWriteSnapshot = false;
     // chunkserver sync_thread_pool number of threads.
     uint32_t syncConcurrency = 20;
     // copyset trigger sync timeout
@@ -140,6 +157,19 @@ struct CopysetNodeOptions {
     uint64_t syncThreshold = 64 * 1024;
     // check syncing interval
     uint32_t checkSyncingIntervalMs = 500u;
+    // 一次sync的chunk数达到该值时，先启动所有chunk的回写再由一次syncfs落盘，
+    // 为0表示每个chunk各自fdatasync
+    uint32_t syncFsMinChunks = 0;
+    // 所有copyset共用的磁盘syncfs组，syncFsMinChunks为0时为nullptr
+    std::shared_ptr<SyncFsGroup> syncFsGroup;
+    // max bytes of adjacent writes merged into one write at apply time,
+    // 0 means writes are not merged
+    uint32_t maxMergedWriteSize = 0;
+    // 是否允许客户端从follower读取只读文件的数据
+    bool enableFollowerRead = false;
+    // follower从leader获取的committed index的缓存时间，follower读到的数据
+    // 最多落后这么长时间，为0表示每个请求都向leader获取
+    uint32_t followerReadIndexCacheMs = 100;
 
     CopysetNodeOptions();
 };
@@ -151,6 +181,8 @@ struct ChunkServiceOptions {
     CopysetNodeManager *copysetNodeManager;
     CloneManager *cloneManager;
     std::shared_ptr<InflightThrottle> inflightThrottle;
+    // 不为空时读写请求由qos调度器按copyset调度，不再检查inflightThrottle
+    QosScheduler* qosScheduler = nullptr;
 };
 
 inline CopysetNodeOptions::CopysetNodeOptions()
@@ -35,6 +35,7 @@
 #include <future>
 #include <deque>
 #include <set>
+#include <vector>
 #include <chrono>
 #include <condition_variable>
 
@@ -46,9 +47,11 @@
 #include "src/chunkserver/copyset_node_manager.h"
 #include "src/chunkserver/datastore/define.h"
 #include "src/chunkserver/datastore/datastore_file_helper.h"
+#include "src/chunkserver/datastore/filename_operator.h"
 #include "src/common/uri_parser.h"
 #include "src/common/crc32.h"
 #include "src/common/fs_util.h"
+#include "src/common/timeutility.h"
 
 namespace braft {
 DECLARE_bool(raft_enable_leader_lease);
@@ -58,6 +61,7 @@ namespace curve {
 namespace chunkserver {
 
 using curve::fs::FileSystemInfo;
+using curve::common::TimeUtility;
 
 const char *kCurveConfEpochFilename = "conf.epoch";
 
@@ -81,11 +85,24 @@ CopysetNode::CopysetNode(const LogicPoolID &logicPoolId,
     leaderTerm_(-1),
     configChange_(std::make_shared<ConfigurationChange>()),
     lastSnapshotIndex_(0),
+    snapshotDirtyChunksValid_(false),
+    dirtyChunksBaseIndex_(0),
+    savingSnapshotIndex_(0),
+    fsmAppliedIndex_(0),
+    dispatchedIndex_(0),
+    enableFollowerRead_(false),
+    followerReadIndexCacheMs_(0),
+    readIndex_(0),
+    readIndexUpdateUs_(0),
     scaning_(false),
     lastScanSec_(0),
     enableOdsyncWhenOpenChunkFile_(false),
     isSyncing_(false),
-    checkSyncingIntervalMs_(500) {
+    checkSyncingIntervalMs_(500),
+    syncFsMinChunks_(0),
+    blockSize_(0),
+    maxChunkSize_(0),
+    maxMergedWriteSize_(0) {
 }
 
 CopysetNode::~CopysetNode() {
@@ -124,6 +141,7 @@ int CopysetNode::Init(const CopysetNodeOptions &options) {
     fs_ = options.localFileSystem;
     CHECK(nullptr != fs_) << "local file sytem is null";
     epochFile_.reset(new ConfEpochFile(fs_));
+    dirtyChunkFile_.reset(new DirtyChunkFile(fs_));
 
     chunkDataRpath_ = RAFT_DATA_DIR;
     chunkDataApath_.append("/").append(RAFT_DATA_DIR);
@@ -135,6 +153,15 @@ int CopysetNode::Init(const CopysetNodeOptions &options) {
     dsOptions.locationLimit = options.locationLimit;
     dsOptions.enableOdsyncWhenOpenChunkFile =
         options.enableOdsyncWhenOpenChunkFile;
+    dsOptions.loadConcurrency = options.chunkLoadConcurrency;
+    dsOptions.crcCacheMaxHits = options.scanCrcCacheMaxHits;
+    dsOptions.pageCache = options.pageCache;
+    dsOptions.enableRedirectOnWrite = options.enableRedirectOnWriteSnapshot;
+    dsOptions.syncFsGroup = options.syncFsGroup;
+    if (options.dataChecksumLogicPools.empty() ||
+        options.dataChecksumLogicPools.count(logicPoolId_) > 0) {
+        dsOptions.checksumBlockSize = options.dataChecksumBlockSize;
+    }
     dataStore_ = std::make_shared<CSDataStore>(options.localFileSystem,
                                                options.chunkFilePool,
                                                dsOptions);
@@ -208,6 +235,14 @@ int CopysetNode::Init(const CopysetNodeOptions &options) {
     StoreOptForCurveSegmentLogStorage(lsOptions);
 
     checkSyncingIntervalMs_ = options.checkSyncingIntervalMs;
+    if (options.syncFsGroup != nullptr) {
+        syncFsMinChunks_ = options.syncFsMinChunks;
+    }
+    blockSize_ = options.blockSize;
+    maxChunkSize_ = options.maxChunkSize;
+    maxMergedWriteSize_ = options.maxMergedWriteSize;
+    enableFollowerRead_ = options.enableFollowerRead;
+    followerReadIndexCacheMs_ = options.followerReadIndexCacheMs;
 
     return 0;
 }
@@ -274,6 +309,8 @@ void CopysetNode::InitRaftNodeOptions(const CopysetNodeOptions &options) {
     std::vector<std::string> filterList;
     std::string snapshotMeta(BRAFT_SNAPSHOT_META_FILE);
     filterList.push_back(kCurveConfEpochFilename);
+    filterList.push_back(kCurveDirtyChunkFilename);
+    filterList.push_back(kCurveIncrementalSnapshotFlag);
     filterList.push_back(snapshotMeta);
     filterList.push_back(snapshotMeta.append(BRAFT_PROTOBUF_FILE_TEMP));
     cfa->SetFilterList(filterList);
@@ -282,10 +319,33 @@ void CopysetNode::InitRaftNodeOptions(const CopysetNodeOptions &options) {
         new scoped_refptr<braft::FileSystemAdaptor>(cfa);
 }
 
+namespace {
+
+// op是否会修改chunk文件
+bool ModifyChunk(CHUNK_OP_TYPE opType) {
+    switch (opType) {
+    case CHUNK_OP_TYPE::CHUNK_OP_WRITE:
+    case CHUNK_OP_TYPE::CHUNK_OP_DELETE:
+    case CHUNK_OP_TYPE::CHUNK_OP_DELETE_SNAP:
+    case CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE:
+    case CHUNK_OP_TYPE::CHUNK_OP_PASTE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+}  // namespace
+
 void CopysetNode::on_apply(::braft::Iterator &iter) {
+    // 同一个chunk上相邻的写请求合并后一起apply
+    std::shared_ptr<WriteChunkBatch> batch;
+    // 本批次中被修改的chunk
+    std::vector<ChunkID> dirtyChunks;
     for (; iter.valid(); iter.next()) {
         // 放在bthread中异步执行，避免阻塞当前状态机的执行
         braft::AsyncClosureGuard doneGuard(iter.done());
+        fsmAppliedIndex_ = iter.index();
 
         /**
          * 获取向braft提交任务时候传递的ChunkClosure，里面包含了
@@ -303,6 +363,16 @@ void CopysetNode::on_apply(::braft::Iterator &iter) {
             CHECK(nullptr != chunkClosure)
                 << "ChunkClosure dynamic cast failed";
             std::shared_ptr<ChunkOpRequest>& opRequest = chunkClosure->request_;
+            opRequest->OnCommitted();
+            if (ModifyChunk(opRequest->OpType())) {
+                dirtyChunks.push_back(opRequest->ChunkId());
+            }
+            if (opRequest->OpType() == CHUNK_OP_TYPE::CHUNK_OP_WRITE &&
+                MergeWrite(&batch, opRequest, iter.index(), closure)) {
+                doneGuard.release();
+                continue;
+            }
+            ApplyWriteBatch(&batch);
             concurrentapply_->Push(opRequest->ChunkId(), ChunkOpRequest::Schedule(opRequest->OpType()),  // NOLINT
                                    &ChunkOpRequest::OnApply, opRequest,
                                    iter.index(), doneGuard.release());
@@ -319,12 +389,75 @@ void CopysetNode::on_apply(::braft::Iterator &iter) {
             butil::IOBuf data;
             auto opReq = ChunkOpRequest::Decode(log, &request, &data,
                                                 iter.index(), GetLeaderId());
+            if (ModifyChunk(request.optype())) {
+                dirtyChunks.push_back(request.chunkid());
+            }
+            if (request.optype() == CHUNK_OP_TYPE::CHUNK_OP_WRITE &&
+                MergeWrite(&batch, &request, data)) {
+                continue;
+            }
+            ApplyWriteBatch(&batch);
             auto chunkId = request.chunkid();
             concurrentapply_->Push(chunkId, ChunkOpRequest::Schedule(request.optype()),  // NOLINT
                                    &ChunkOpRequest::OnApplyFromLog, opReq,
                                    dataStore_, std::move(request), data);
         }
     }
+    ApplyWriteBatch(&batch);
+    MarkChunksDirty(dirtyChunks);
+    // 合并的写请求也已经交给apply队列
+    dispatchedIndex_.store(fsmAppliedIndex_, std::memory_order_release);
+}
+
+void CopysetNode::MarkChunksDirty(const std::vector<ChunkID> &chunkIds) {
+    if (chunkIds.empty()) {
+        return;
+    }
+    curve::common::LockGuard lg(dirtyChunksLock_);
+    dirtyChunks_.insert(chunkIds.begin(), chunkIds.end());
+}
+
+void CopysetNode::GetChunksChangedSinceSnapshot(std::set<ChunkID> *chunkIds) {
+    curve::common::LockGuard lg(dirtyChunksLock_);
+    *chunkIds = dirtyChunks_;
+    chunkIds->insert(savingDirtyChunks_.begin(), savingDirtyChunks_.end());
+}
+
+bool CopysetNode::GetSnapshotDirtyChunks(std::set<ChunkID> *chunkIds) {
+    curve::common::LockGuard lg(dirtyChunksLock_);
+    if (!snapshotDirtyChunksValid_) {
+        return false;
+    }
+    *chunkIds = snapshotDirtyChunks_;
+    return true;
+}
+
+template <typename... Args>
+bool CopysetNode::MergeWrite(std::shared_ptr<WriteChunkBatch> *batch,
+                             Args&&... args) {
+    if (maxMergedWriteSize_ == 0) {
+        return false;
+    }
+    if (*batch != nullptr && (*batch)->Add(std::forward<Args>(args)...)) {
+        return true;
+    }
+
+    ApplyWriteBatch(batch);
+    if (*batch == nullptr) {
+        *batch = std::make_shared<WriteChunkBatch>(
+            blockSize_, maxChunkSize_, maxMergedWriteSize_);
+    }
+    return (*batch)->Add(std::forward<Args>(args)...);
+}
+
+void CopysetNode::ApplyWriteBatch(std::shared_ptr<WriteChunkBatch> *batch) {
+    if (*batch == nullptr || (*batch)->Empty()) {
+        return;
+    }
+    auto chunkId = (*batch)->ChunkId();
+    concurrentapply_->Push(chunkId, ApplyTaskType::WRITE,
+                           &WriteChunkBatch::Apply, *batch, dataStore_);
+    batch->reset();
 }
 
 void CopysetNode::on_shutdown() {
@@ -333,6 +466,16 @@ void CopysetNode::on_shutdown() {
 
 void CopysetNode::on_snapshot_save(::braft::SnapshotWriter *writer,
                                    ::braft::Closure *done) {
+    /**
+     * on_apply和on_snapshot_save都在状态机线程中执行，此时已经apply的
+     * 修改都属于这次快照，上一次保存失败时遗留的chunk也一起保存
+     */
+    {
+        curve::common::LockGuard lg(dirtyChunksLock_);
+        savingDirtyChunks_.insert(dirtyChunks_.begin(), dirtyChunks_.end());
+        dirtyChunks_.clear();
+        savingSnapshotIndex_ = fsmAppliedIndex_;
+    }
     snapshotFuture_ =
         std::async(std::launch::async,
             &CopysetNode::save_snapshot_background, this, writer, done);
@@ -373,7 +516,28 @@ void CopysetNode::save_snapshot_background(::braft::SnapshotWriter *writer,
     }
 
     /**
-     * 3.保存chunk文件名的列表到快照元数据文件中
+     * 3.保存上一次快照之后被修改的chunk列表: dirty.chunks
+     */
+    std::set<ChunkID> savingDirtyChunks;
+    uint64_t baseIndex;
+    {
+        curve::common::LockGuard lg(dirtyChunksLock_);
+        savingDirtyChunks = savingDirtyChunks_;
+        baseIndex = dirtyChunksBaseIndex_;
+    }
+    filePathTemp = writer->get_path() + "/" + kCurveDirtyChunkFilename;
+    if (0 != dirtyChunkFile_->Save(filePathTemp, baseIndex,
+                                   savingDirtyChunks)) {
+        done->status().set_error(errno, "invalid: %s", strerror(errno));
+        LOG(ERROR) << "Save dirty chunks failed. "
+                   << "Copyset: " << GroupIdString()
+                   << ", errno: " << errno << ", "
+                   << ", error message: " << strerror(errno);
+        return;
+    }
+
+    /**
+     * 4.保存chunk文件名的列表到快照元数据文件中
      */
     std::vector<std::string> files;
     if (0 == fs_->List(chunkDataApath_, &files)) {
@@ -401,9 +565,16 @@ void CopysetNode::save_snapshot_background(::braft::SnapshotWriter *writer,
     }
 
     /**
-     * 4. 保存conf.epoch文件到快照元数据文件中
+     * 5. 保存conf.epoch和dirty.chunks文件到快照元数据文件中
      */
-     writer->add_file(kCurveConfEpochFilename);
+    writer->add_file(kCurveConfEpochFilename);
+    writer->add_file(kCurveDirtyChunkFilename);
+
+    curve::common::LockGuard lg(dirtyChunksLock_);
+    snapshotDirtyChunks_.swap(savingDirtyChunks_);
+    savingDirtyChunks_.clear();
+    snapshotDirtyChunksValid_ = true;
+    dirtyChunksBaseIndex_ = savingSnapshotIndex_;
 }
 
 int CopysetNode::on_snapshot_load(::braft::SnapshotReader *reader) {
@@ -420,7 +591,15 @@ int CopysetNode::on_snapshot_load(::braft::SnapshotReader *reader) {
     LOG(INFO) << "load snapshot data path: " << snapshotChunkDataDir
               << ", Copyset: " << GroupIdString();
     // 如果数据目录不存在，那么说明 load snapshot 数据部分就不需要处理
-    if (fs_->DirExists(snapshotChunkDataDir)) {
+    std::string flagPath = snapshotPath + "/" + kCurveIncrementalSnapshotFlag;
+    bool hasSnapshotData = fs_->DirExists(snapshotChunkDataDir);
+    if (hasSnapshotData && fs_->FileExists(flagPath)) {
+        // 增量安装的快照只下载了被修改的chunk，其它chunk保留本地的文件
+        if (0 != LoadIncrementalSnapshotData(snapshotPath,
+                                             snapshotChunkDataDir)) {
+            return -1;
+        }
+    } else if (hasSnapshotData) {
         // 加载快照数据前，要先清理copyset data目录下的文件
         // 否则可能导致快照加载以后存在一些残留的数据
         // 如果delete_file失败或者rename失败，当前node状态会置为ERROR
@@ -468,7 +647,31 @@ int CopysetNode::on_snapshot_load(::braft::SnapshotReader *reader) {
     }
 
     /**
-     * 3.重新init data store，场景举例：
+     * 3. 加载快照中记录的dirty chunk，只用于跳过没有修改的chunk，
+     * 加载失败时认为没有记录，不影响快照加载。快照之后的修改在回放
+     * 日志的时候重新记录
+     */
+    {
+        std::set<ChunkID> snapshotDirtyChunks;
+        uint64_t baseIndex = 0;
+        bool valid = false;
+        filePath = reader->get_path() + "/" + kCurveDirtyChunkFilename;
+        if (fs_->FileExists(filePath)) {
+            valid = (0 == dirtyChunkFile_->Load(filePath, &baseIndex,
+                                                &snapshotDirtyChunks));
+            LOG_IF(WARNING, !valid) << "load dirty chunks failed. "
+                                    << "path:" << filePath
+                                    << ", Copyset: " << GroupIdString();
+        }
+        curve::common::LockGuard lg(dirtyChunksLock_);
+        dirtyChunks_.clear();
+        savingDirtyChunks_.clear();
+        snapshotDirtyChunks_.swap(snapshotDirtyChunks);
+        snapshotDirtyChunksValid_ = valid;
+    }
+
+    /**
+     * 4.重新init data store，场景举例：
      *
      * (1) 例如一个add peer，之后立马read这个时候data store会返回chunk
      * not exist，因为这个新增的peer在刚开始起来的时候，没有任何数据，这
@@ -490,7 +693,7 @@ int CopysetNode::on_snapshot_load(::braft::SnapshotReader *reader) {
     }
 
     /**
-     * 4.如果snapshot中存 conf，那么加载初始化，保证不需要以来
+     * 5.如果snapshot中存 conf，那么加载初始化，保证不需要以来
      * on_configuration_committed。需要注意的是这里会忽略joint stage的日志。
      */
     braft::SnapshotMeta meta;
@@ -505,6 +708,121 @@ int CopysetNode::on_snapshot_load(::braft::SnapshotReader *reader) {
     LOG(INFO) << "update lastSnapshotIndex_ from " << lastSnapshotIndex_;
     lastSnapshotIndex_ = meta.last_included_index();
     LOG(INFO) << "to lastSnapshotIndex_: " << lastSnapshotIndex_;
+    fsmAppliedIndex_ = meta.last_included_index();
+    dispatchedIndex_.store(fsmAppliedIndex_, std::memory_order_release);
+    {
+        curve::common::LockGuard lg(dirtyChunksLock_);
+        dirtyChunksBaseIndex_ = meta.last_included_index();
+    }
+    return 0;
+}
+
+int CopysetNode::LoadIncrementalSnapshotData(
+    const std::string &snapshotPath, const std::string &snapshotChunkDataDir) {
+    // 1. 读取被修改的chunk以及从leader下载的这些chunk的文件
+    uint64_t baseIndex;
+    std::set<ChunkID> dirtyChunks;
+    std::string filePath = snapshotPath + "/" + kCurveDirtyChunkFilename;
+    if (0 != dirtyChunkFile_->Load(filePath, &baseIndex, &dirtyChunks)) {
+        LOG(ERROR) << "load dirty chunks failed. path: " << filePath
+                   << ", Copyset: " << GroupIdString();
+        return -1;
+    }
+    std::set<std::string> downloadedFiles;
+    filePath = snapshotPath + "/" + kCurveIncrementalSnapshotFlag;
+    if (0 != LoadIncrementalSnapshotFlag(filePath, &downloadedFiles)) {
+        return -1;
+    }
+
+    /**
+     * 2. 删除leader上已经不存在的被修改chunk的文件，例如被删除的chunk和
+     * 快照；需要替换的文件在rename的时候回收。只删除不在下载列表中的文件，
+     * 中途重启后再次加载不会删除已经rename过来的文件
+     */
+    auto sfs = nodeOptions_.snapshot_file_system_adaptor->get();
+    std::vector<std::string> files;
+    if (0 != fs_->List(chunkDataApath_, &files)) {
+        LOG(ERROR) << "list chunk data dir failed. "
+                   << "Copyset: " << GroupIdString()
+                   << ", path: " << chunkDataApath_;
+        return -1;
+    }
+    for (const auto &fileName : files) {
+        auto info = FileNameOperator::ParseFileName(fileName);
+        if (info.type == FileNameOperator::FileType::UNKNOWN ||
+            dirtyChunks.count(info.id) == 0 ||
+            downloadedFiles.count(fileName) != 0) {
+            continue;
+        }
+        std::string chunkPath = chunkDataApath_ + "/" + fileName;
+        if (!sfs->delete_file(chunkPath, false)) {
+            LOG(ERROR) << "delete dirty chunk file " << chunkPath
+                       << " failed. Copyset: " << GroupIdString();
+            return -1;
+        }
+    }
+
+    // 3. 把下载的文件rename到chunk data目录，中途重启时已经rename的文件跳过
+    for (const auto &fileName : downloadedFiles) {
+        std::string srcPath = snapshotChunkDataDir + "/" + fileName;
+        if (!fs_->FileExists(srcPath)) {
+            continue;
+        }
+        std::string dstPath = chunkDataApath_ + "/" + fileName;
+        if (!sfs->rename(srcPath, dstPath)) {
+            LOG(ERROR) << "rename snapshot file " << srcPath
+                       << " to " << dstPath << " failed. "
+                       << "Copyset: " << GroupIdString();
+            return -1;
+        }
+    }
+
+    // 4. 删除快照中已经空了的数据目录，之后重启时不会再加载
+    if (!sfs->delete_file(snapshotChunkDataDir, true)) {
+        LOG(ERROR) << "delete snapshot data dir " << snapshotChunkDataDir
+                   << " failed. Copyset: " << GroupIdString();
+        return -1;
+    }
+    LOG(INFO) << "load incremental snapshot data success, base index: "
+              << baseIndex << ", dirty chunks: " << dirtyChunks.size()
+              << ", downloaded files: " << downloadedFiles.size()
+              << ", Copyset: " << GroupIdString();
+    return 0;
+}
+
+int CopysetNode::LoadIncrementalSnapshotFlag(
+    const std::string &filePath, std::set<std::string> *files) {
+    int fd = fs_->Open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG(ERROR) << "open incremental snapshot flag " << filePath
+                   << " failed. Copyset: " << GroupIdString();
+        return -1;
+    }
+    struct stat info;
+    if (0 != fs_->Fstat(fd, &info)) {
+        LOG(ERROR) << "stat incremental snapshot flag " << filePath
+                   << " failed. Copyset: " << GroupIdString();
+        fs_->Close(fd);
+        return -1;
+    }
+    std::string content(info.st_size, '\0');
+    if (info.st_size > 0 &&
+        info.st_size != fs_->Read(fd, &content[0], 0, info.st_size)) {
+        LOG(ERROR) << "read incremental snapshot flag " << filePath
+                   << " failed. Copyset: " << GroupIdString();
+        fs_->Close(fd);
+        return -1;
+    }
+    fs_->Close(fd);
+
+    std::vector<std::string> names;
+    curve::common::SplitString(content, "\n", &names);
+    files->clear();
+    for (const auto &name : names) {
+        if (!name.empty()) {
+            files->insert(name);
+        }
+    }
     return 0;
 }
 
@@ -552,6 +870,8 @@ void CopysetNode::on_error(const ::braft::Error &e) {
 
 void CopysetNode::on_configuration_committed(const Configuration& conf,
                                              int64_t index) {
+    fsmAppliedIndex_ = index;
+    dispatchedIndex_.store(fsmAppliedIndex_, std::memory_order_release);
     // This function is also called when loading snapshot.
     // Loading snapshot should not increase epoch. When loading
     // snapshot, the index is equal with lastSnapshotIndex_.
@@ -674,6 +994,11 @@ void CopysetNode::SetConfEpochFile(std::unique_ptr<ConfEpochFile> epochFile) {
     epochFile_ = std::move(epochFile);
 }
 
+void CopysetNode::SetDirtyChunkFile(
+    std::unique_ptr<DirtyChunkFile> dirtyChunkFile) {
+    dirtyChunkFile_ = std::move(dirtyChunkFile);
+}
+
 void CopysetNode::SetCopysetNode(std::shared_ptr<RaftNode> node) {
     raftNode_ = node;
 }
@@ -1046,6 +1371,27 @@ bool CopysetNode::GetLeaderStatus(NodeStatus *leaderStaus) {
     return true;
 }
 
+bool CopysetNode::IsFollowerReadable() {
+    if (!enableFollowerRead_) {
+        return false;
+    }
+
+    uint64_t nowUs = TimeUtility::GetTimeofDayUs();
+    uint64_t readIndex = readIndex_.load(std::memory_order_acquire);
+    uint64_t updateUs = readIndexUpdateUs_.load(std::memory_order_acquire);
+    if (updateUs == 0 ||
+        nowUs - updateUs >= followerReadIndexCacheMs_ * 1000ull) {
+        NodeStatus leaderStatus;
+        if (!GetLeaderStatus(&leaderStatus)) {
+            return false;
+        }
+        readIndex = leaderStatus.committed_index;
+        readIndex_.store(readIndex, std::memory_order_release);
+        readIndexUpdateUs_.store(nowUs, std::memory_order_release);
+    }
+    return dispatchedIndex_.load(std::memory_order_acquire) >= readIndex;
+}
+
 void CopysetNode::HandleSyncTimerOut() {
     if (isSyncing_.exchange(true)) {
         return;
@@ -1073,6 +1419,20 @@ void CopysetNode::SyncAllChunks() {
     for (auto chunkId : temp) {
         chunkIds.insert(chunkId);
     }
+    // 脏chunk较多时，一次syncfs比逐个fdatasync的落盘次数少得多
+    if (syncFsMinChunks_ > 0 && chunkIds.size() >= syncFsMinChunks_) {
+        std::vector<ChunkID> chunks(chunkIds.begin(), chunkIds.end());
+        copysetSyncPool_->Enqueue([=]() {
+            CSErrorCode r = dataStore_->SyncChunks(chunks);
+            if (r != CSErrorCode::Success) {
+                LOG(FATAL) << "Sync Chunks failed in Copyset: "
+                       << GroupIdString()
+                       << ", chunk count: " << chunks.size()
+                       << " data store return: " << r;
+            }
+        });
+        return;
+    }
     for (ChunkID chunk : chunkIds) {
         copysetSyncPool_->Enqueue([=]() {
             CSErrorCode r = dataStore_->SyncChunk(chunk);
@@ -33,6 +33,7 @@
 #include <climits>
 #include <memory>
 #include <deque>
+#include <set>
 
 #include "src/chunkserver/concurrent_apply/concurrent_apply.h"
 #include "src/chunkserver/datastore/chunkserver_datastore.h"
@@ -41,6 +42,7 @@
 #include "src/chunkserver/chunkserver_metrics.h"
 #include "src/chunkserver/raftlog/curve_segment_log_storage.h"
 #include "src/chunkserver/raftsnapshot/define.h"
+#include "src/chunkserver/raftsnapshot/dirty_chunk_file.h"
 #include "src/chunkserver/raftsnapshot/curve_snapshot_writer.h"
 #include "src/common/string_util.h"
 #include "src/common/concurrent/task_thread_pool.h"
@@ -60,6 +62,7 @@ using ::curve::common::Peer;
 using ::curve::common::TaskThreadPool;
 
 class CopysetNodeManager;
+class WriteChunkBatch;
 
 extern const char *kCurveConfEpochFilename;
 
@@ -298,6 +301,14 @@ class CopysetNode : public braft::StateMachine,
      */
     virtual bool GetLeaderStatus(NodeStatus *leaderStaus);
 
+    /**
+     * 判断follower能否处理读请求，要求本节点已经交给apply队列的日志不落后于
+     * leader的committed index，这样之后进入同一chunk写队列的读请求能读到
+     * 这些日志写入的数据。leader的committed index会缓存一段时间
+     * @return 可以从本节点读返回true，否则返回false
+     */
+    virtual bool IsFollowerReadable();
+
     /**
      * 返回data store指针
      * @return
@@ -422,6 +433,8 @@ class CopysetNode : public braft::StateMachine,
 
     void SetConfEpochFile(std::unique_ptr<ConfEpochFile> epochFile);
 
+    void SetDirtyChunkFile(std::unique_ptr<DirtyChunkFile> dirtyChunkFile);
+
     void SetCopysetNode(std::shared_ptr<RaftNode> node);
 
     void SetSnapshotFileSystem(scoped_refptr<FileSystemAdaptor>* fs);
@@ -469,7 +482,56 @@ class CopysetNode : public braft::StateMachine,
 
     void WaitSnapshotDone();
 
+    /**
+     * 获取最近一次raft快照之后被修改过的chunk
+     * @param chunkIds: 出参，chunk id集合
+     */
+    void GetChunksChangedSinceSnapshot(std::set<ChunkID> *chunkIds);
+
+    /**
+     * 获取最近一次raft快照相对于上一次快照被修改过的chunk
+     * @param chunkIds: 出参，chunk id集合
+     * @return true 成功，false 快照中没有记录（例如老版本的快照）
+     */
+    bool GetSnapshotDirtyChunks(std::set<ChunkID> *chunkIds);
+
  private:
+    /**
+     * 记录apply过程中被修改的chunk
+     */
+    void MarkChunksDirty(const std::vector<ChunkID> &chunkIds);
+
+    /**
+     * 加载增量安装的快照数据：删除被修改的chunk在leader上已经不存在的
+     * 文件，再把下载的文件rename到chunk data目录，没有修改的chunk保留
+     * 本地的文件。中途重启后可以重新加载
+     * @param snapshotPath: 快照目录
+     * @param snapshotChunkDataDir: 快照中下载的chunk文件所在的目录
+     * @return 0 成功，-1 失败
+     */
+    int LoadIncrementalSnapshotData(const std::string &snapshotPath,
+                                    const std::string &snapshotChunkDataDir);
+
+    /**
+     * 读取增量快照标记文件中记录的下载文件名
+     */
+    int LoadIncrementalSnapshotFlag(const std::string &filePath,
+                                    std::set<std::string> *files);
+
+    /**
+     * 尝试将写请求合并到batch中，不能合并时先将之前的batch下发到并发模块
+     * @param batch: 当前正在合并的写请求
+     * @param args: WriteChunkBatch::Add的参数
+     * @return true 合并成功，false 请求需要单独apply
+     */
+    template <typename... Args>
+    bool MergeWrite(std::shared_ptr<WriteChunkBatch> *batch, Args&&... args);
+
+    /**
+     * 将合并后的写请求下发到并发模块
+     */
+    void ApplyWriteBatch(std::shared_ptr<WriteChunkBatch> *batch);
+
     inline std::string GroupId() {
         return ToGroupId(logicPoolId_, copysetId_);
     }
@@ -511,6 +573,33 @@ class CopysetNode : public braft::StateMachine,
     ConcurrentApplyModule *concurrentapply_ = nullptr;
     // 配置版本持久化工具接口
     std::unique_ptr<ConfEpochFile> epochFile_;
+    // dirty chunk持久化工具接口
+    std::unique_ptr<DirtyChunkFile> dirtyChunkFile_;
+    // 最近一次快照之后被修改的chunk
+    std::set<ChunkID> dirtyChunks_;
+    // 正在保存的快照中被修改的chunk，保存失败时留给下一次快照
+    std::set<ChunkID> savingDirtyChunks_;
+    // 最近一次快照相对于上一次快照被修改的chunk
+    std::set<ChunkID> snapshotDirtyChunks_;
+    // snapshotDirtyChunks_是否有效
+    bool snapshotDirtyChunksValid_;
+    // dirtyChunks_和savingDirtyChunks_相对的快照，即最近一次快照的index
+    uint64_t dirtyChunksBaseIndex_;
+    // 正在保存的快照的index
+    uint64_t savingSnapshotIndex_;
+    // 状态机已经处理的log index，只在状态机线程中访问
+    int64_t fsmAppliedIndex_;
+    // 已经交给apply队列的log index，用于判断follower能否处理读请求
+    std::atomic<uint64_t> dispatchedIndex_;
+    // 是否允许从follower读
+    bool enableFollowerRead_;
+    // leader的committed index的缓存时间
+    uint32_t followerReadIndexCacheMs_;
+    // 最近一次从leader获取的committed index及获取的时间
+    std::atomic<uint64_t> readIndex_;
+    std::atomic<uint64_t> readIndexUpdateUs_;
+    // 保护上面dirty chunk相关的成员
+    mutable curve::common::Mutex dirtyChunksLock_;
     // 复制组的apply index
     std::atomic<uint64_t> appliedIndex_;
     // 复制组当前任期，如果<=0表明不是leader
@@ -543,6 +632,14 @@ class CopysetNode : public braft::StateMachine,
     std::atomic<bool> isSyncing_;
     // do snapshot check syncing interval
     uint32_t checkSyncingIntervalMs_;
+    // sync the chunks by one syncfs once there are this many, 0: disabled
+    uint32_t syncFsMinChunks_;
+    // alignment for I/O request
+    uint32_t blockSize_;
+    // chunk文件的大小
+    uint32_t maxChunkSize_;
+    // max bytes of adjacent writes merged at apply time, 0 means disabled
+    uint32_t maxMergedWriteSize_;
     // async snapshot future object
     std::future<void> snapshotFuture_;
 };
@@ -41,6 +41,7 @@
 #include "src/chunkserver/braft_cli_service.h"
 #include "src/chunkserver/braft_cli_service2.h"
 #include "src/common/uri_parser.h"
+#include "src/chunkserver/raftlog/shared_log_storage.h"
 #include "src/chunkserver/raftsnapshot/curve_file_service.h"
 
 
@@ -130,6 +131,7 @@ int CopysetNodeManager::ReloadCopysets() {
         return -1;
     }
 
+    copysetsToLoad_ << items.size();
     vector<std::string>::iterator it = items.begin();
     for (; it != items.end(); ++it) {
         LOG(INFO) << "Found copyset dir " << *it;
@@ -198,6 +200,7 @@ void CopysetNodeManager::LoadCopyset(const LogicPoolID &logicPoolId,
                    << ToGroupIdString(logicPoolId, copysetId);
         return;
     }
+    copysetsLoaded_ << 1;
     if (needCheckLoadFinished) {
         std::shared_ptr<CopysetNode> node =
             GetCopysetNode(logicPoolId, copysetId);
@@ -486,6 +489,7 @@ bool CopysetNodeManager::PurgeCopysetNodeData(const LogicPoolID &logicPoolId,
                           << ToGroupIdString(logicPoolId, copysetId)
                           << "to trash success.";
                 copysetNodeMap_.erase(it);
+                RemoveSharedLog(ToGroupNid(logicPoolId, copysetId));
                 ret = true;
             }
         }
@@ -515,6 +519,7 @@ bool CopysetNodeManager::DeleteBrokenCopyset(const LogicPoolID& poolId,
                    << ToGroupIdString(poolId, copysetId);
         return false;
     }
+    RemoveSharedLog(ToGroupNid(poolId, copysetId));
 
     return true;
 }
@@ -23,6 +23,7 @@
 #ifndef SRC_CHUNKSERVER_COPYSET_NODE_MANAGER_H_
 #define SRC_CHUNKSERVER_COPYSET_NODE_MANAGER_H_
 
+#include <bvar/bvar.h>
 #include <mutex>    //NOLINT
 #include <vector>
 #include <memory>
@@ -185,7 +186,9 @@ class CopysetNodeManager : public curve::common::Uncopyable {
     CopysetNodeManager()
         : copysetLoader_(nullptr)
         , running_(false)
-        , loadFinished_(false) {}
+        , loadFinished_(false)
+        , copysetsToLoad_("chunkserver_copysets_to_load")
+        , copysetsLoaded_("chunkserver_copysets_loaded") {}
 
  private:
     /**
@@ -227,6 +230,9 @@ class CopysetNodeManager : public curve::common::Uncopyable {
     Atomic<bool> running_;
     // 表示copyset node manager当前是否已经完成加载
     Atomic<bool> loadFinished_;
+    // 启动时需要加载的copyset数量和已经加载的数量，用于观察启动进度
+    bvar::Adder<uint32_t> copysetsToLoad_;
+    bvar::Adder<uint32_t> copysetsLoaded_;
 };
 
 }  // namespace chunkserver
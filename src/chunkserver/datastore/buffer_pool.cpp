@@ -0,0 +1,284 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/chunkserver/datastore/buffer_pool.h"
+
+#include <bvar/bvar.h>
+#include <glog/logging.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <mutex>  // NOLINT
+#include <vector>
+
+namespace curve {
+namespace chunkserver {
+
+constexpr size_t BufferPool::kAlignment;
+constexpr size_t BufferPool::kMinClassSize;
+constexpr int BufferPool::kClassNum;
+constexpr size_t BufferPool::kMaxCachedBytesPerClass;
+constexpr size_t BufferPool::kHugePageSize;
+
+namespace {
+
+struct SizeClassCache {
+    std::mutex mtx;
+    std::vector<char*> buffers;
+};
+
+struct Arena {
+    std::mutex mtx;
+    // published after size is set, never changed then
+    std::atomic<char*> base{nullptr};
+    size_t size = 0;
+    // bytes carved from the arena
+    size_t used = 0;
+};
+
+struct BufferPoolMetric {
+    BufferPoolMetric()
+        : arenaBytes("chunkserver_buffer_pool_arena_bytes"),
+          arenaUsedBytes("chunkserver_buffer_pool_arena_used_bytes"),
+          cachedBytes("chunkserver_buffer_pool_cached_bytes"),
+          allocCount("chunkserver_buffer_pool_alloc_count") {}
+
+    bvar::Adder<int64_t> arenaBytes;
+    bvar::Adder<int64_t> arenaUsedBytes;
+    bvar::Adder<int64_t> cachedBytes;
+    // buffers allocated from the system instead of the caches
+    bvar::Adder<int64_t> allocCount;
+};
+
+// never destroyed, buffers may be released by IOBuf after exit of main
+SizeClassCache* Caches() {
+    static SizeClassCache* caches =
+        new SizeClassCache[BufferPool::kClassNum];
+    return caches;
+}
+
+Arena* GetArena() {
+    static Arena* arena = new Arena;
+    return arena;
+}
+
+BufferPoolMetric* Metric() {
+    static BufferPoolMetric* metric = new BufferPoolMetric;
+    return metric;
+}
+
+size_t ClassSize(int sizeClass) {
+    return BufferPool::kMinClassSize << sizeClass;
+}
+
+char* AllocAligned(size_t size) {
+    void* ptr = nullptr;
+    int ret = posix_memalign(&ptr, BufferPool::kAlignment, size);
+    CHECK(ret == 0) << "posix_memalign buffer failed, size: " << size
+                    << ", error: " << strerror(ret);
+    Metric()->allocCount << 1;
+    return static_cast<char*>(ptr);
+}
+
+// carve a buffer of the class from the arena, the class under a huge page
+// takes a whole one and keeps the rest in its cache
+char* CarveFromArena(int sizeClass) {
+    const size_t classSize = ClassSize(sizeClass);
+    const size_t carveSize = std::max(classSize, BufferPool::kHugePageSize);
+    Arena* arena = GetArena();
+    char* begin = nullptr;
+    {
+        std::lock_guard<std::mutex> lk(arena->mtx);
+        char* base = arena->base.load(std::memory_order_relaxed);
+        if (base == nullptr || arena->used + carveSize > arena->size) {
+            return nullptr;
+        }
+        begin = base + arena->used;
+        arena->used += carveSize;
+    }
+    Metric()->arenaUsedBytes << carveSize;
+
+    if (carveSize > classSize) {
+        SizeClassCache& cache = Caches()[sizeClass];
+        std::lock_guard<std::mutex> lk(cache.mtx);
+        for (size_t off = classSize; off < carveSize; off += classSize) {
+            cache.buffers.push_back(begin + off);
+        }
+        Metric()->cachedBytes << carveSize - classSize;
+    }
+    return begin;
+}
+
+void PutBack(int sizeClass, char* buf) {
+    SizeClassCache& cache = Caches()[sizeClass];
+    size_t maxNum = BufferPool::kMaxCachedBytesPerClass /
+                    ClassSize(sizeClass);
+    {
+        std::lock_guard<std::mutex> lk(cache.mtx);
+        if (cache.buffers.size() < maxNum || BufferPool::InArena(buf)) {
+            cache.buffers.push_back(buf);
+            Metric()->cachedBytes << ClassSize(sizeClass);
+            return;
+        }
+    }
+    free(buf);
+}
+
+template <int N>
+void ClassDeleter(void* ptr) {
+    PutBack(N, static_cast<char*>(ptr));
+}
+
+void FreeDeleter(void* ptr) {
+    free(ptr);
+}
+
+// IOBuf deleter only takes the pointer, so every class has its own deleter
+using Deleter = void (*)(void*);
+const Deleter kDeleters[BufferPool::kClassNum] = {
+    ClassDeleter<0>, ClassDeleter<1>, ClassDeleter<2>, ClassDeleter<3>,
+    ClassDeleter<4>, ClassDeleter<5>, ClassDeleter<6>, ClassDeleter<7>,
+    ClassDeleter<8>, ClassDeleter<9>, ClassDeleter<10>,
+};
+
+}  // namespace
+
+int BufferPool::Init(const BufferPoolOptions& options) {
+    if (options.hugePageBytes == 0) {
+        return 0;
+    }
+    Arena* arena = GetArena();
+    std::lock_guard<std::mutex> lk(arena->mtx);
+    if (arena->base.load(std::memory_order_relaxed) != nullptr) {
+        LOG(WARNING) << "buffer pool arena is already reserved";
+        return 0;
+    }
+
+    const size_t size = (options.hugePageBytes + kHugePageSize - 1) /
+                        kHugePageSize * kHugePageSize;
+    // the huge pages reserved by the system first, they are reserved for
+    // the mapping here, so mmap fails if there are not enough of them
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr == MAP_FAILED) {
+        // transparent huge pages otherwise, align the arena to huge pages
+        const size_t reserve = size + kHugePageSize;
+        ptr = mmap(nullptr, reserve, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (ptr == MAP_FAILED) {
+            LOG(ERROR) << "mmap buffer pool arena failed, size: " << size
+                       << ", error: " << strerror(errno);
+            return -1;
+        }
+        uintptr_t begin = reinterpret_cast<uintptr_t>(ptr);
+        uintptr_t aligned = (begin + kHugePageSize - 1) &
+                            ~static_cast<uintptr_t>(kHugePageSize - 1);
+        if (aligned > begin) {
+            munmap(ptr, aligned - begin);
+        }
+        size_t tail = begin + reserve - (aligned + size);
+        if (tail > 0) {
+            munmap(reinterpret_cast<void*>(aligned + size), tail);
+        }
+        ptr = reinterpret_cast<void*>(aligned);
+        if (madvise(ptr, size, MADV_HUGEPAGE) != 0) {
+            LOG(WARNING) << "madvise buffer pool arena to huge pages failed"
+                         << ", error: " << strerror(errno);
+        }
+        LOG(INFO) << "buffer pool arena uses transparent huge pages, size: "
+                  << size;
+    } else {
+        LOG(INFO) << "buffer pool arena uses reserved huge pages, size: "
+                  << size;
+    }
+
+    arena->size = size;
+    arena->base.store(static_cast<char*>(ptr), std::memory_order_release);
+    Metric()->arenaBytes << size;
+    return 0;
+}
+
+bool BufferPool::InArena(const char* buf) {
+    Arena* arena = GetArena();
+    const char* base = arena->base.load(std::memory_order_acquire);
+    return base != nullptr && buf >= base && buf < base + arena->size;
+}
+
+int BufferPool::SizeClass(size_t size) {
+    int sizeClass = 0;
+    while (sizeClass < kClassNum && ClassSize(sizeClass) < size) {
+        ++sizeClass;
+    }
+    return sizeClass < kClassNum ? sizeClass : -1;
+}
+
+char* BufferPool::Get(size_t size) {
+    int sizeClass = SizeClass(size);
+    if (sizeClass < 0) {
+        return AllocAligned(size);
+    }
+
+    SizeClassCache& cache = Caches()[sizeClass];
+    {
+        std::lock_guard<std::mutex> lk(cache.mtx);
+        if (!cache.buffers.empty()) {
+            char* buf = cache.buffers.back();
+            cache.buffers.pop_back();
+            Metric()->cachedBytes << -static_cast<int64_t>(
+                ClassSize(sizeClass));
+            return buf;
+        }
+    }
+    char* buf = CarveFromArena(sizeClass);
+    if (buf != nullptr) {
+        return buf;
+    }
+    return AllocAligned(ClassSize(sizeClass));
+}
+
+void BufferPool::AppendToIOBuf(char* buf,
+                               size_t size,
+                               butil::IOBuf* iobuf) {
+    int sizeClass = SizeClass(size);
+    Deleter deleter = sizeClass < 0 ? FreeDeleter : kDeleters[sizeClass];
+    iobuf->append_user_data(buf, size, deleter);
+}
+
+void BufferPool::Release(char* buf, size_t size) {
+    int sizeClass = SizeClass(size);
+    if (sizeClass < 0) {
+        free(buf);
+        return;
+    }
+    PutBack(sizeClass, buf);
+}
+
+size_t BufferPool::CachedNum(size_t size) {
+    int sizeClass = SizeClass(size);
+    if (sizeClass < 0) {
+        return 0;
+    }
+    SizeClassCache& cache = Caches()[sizeClass];
+    std::lock_guard<std::mutex> lk(cache.mtx);
+    return cache.buffers.size();
+}
+
+}  // namespace chunkserver
+}  // namespace curve
@@ -0,0 +1,127 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_CHUNKSERVER_DATASTORE_BUFFER_POOL_H_
+#define SRC_CHUNKSERVER_DATASTORE_BUFFER_POOL_H_
+
+#include <butil/iobuf.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace curve {
+namespace chunkserver {
+
+struct BufferPoolOptions {
+    // bytes of the huge page backed arena, 0 means no arena
+    uint64_t hugePageBytes = 0;
+};
+
+/**
+ * Page aligned buffers shared by the data paths of chunkserver: reading
+ * chunk data, downloading clone data, copying on write and writing wal.
+ * The buffers are suitable for O_DIRECT, and a read buffer can be handed
+ * to brpc as IOBuf user data, so the data read from disk is sent without
+ * another copy.
+ * Buffers are cached in power of 2 size classes from 4KB to 4MB, and the
+ * IOBuf deleter puts the buffer back to its class. Reusing a buffer saves
+ * the page faults and page zeroing of fresh memory on every large read.
+ *
+ * With an arena, the buffers are carved from memory backed by 2MB huge
+ * pages, the classes under 2MB take a whole huge page and split it, so the
+ * hot buffers share few TLB entries. The arena is reserved by Init after
+ * chunkserver binds to its numa node, so it's allocated on that node.
+ * Buffers of the arena are always cached, the others are cached up to
+ * kMaxCachedBytesPerClass per class and freed beyond it.
+ */
+class BufferPool {
+ public:
+    static constexpr size_t kAlignment = 4096;
+    static constexpr size_t kMinClassSize = 4096;
+    static constexpr int kClassNum = 11;
+    // max bytes cached in one size class
+    static constexpr size_t kMaxCachedBytesPerClass = 32 * 1024 * 1024;
+    static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+    /**
+     * @brief reserve the huge page arena, should be called once before
+     *        the buffers are used, the pool works without it
+     * @return 0 on success, -1 if the arena can't be reserved
+     */
+    static int Init(const BufferPoolOptions& options);
+
+    /**
+     * @brief get a buffer of at least size bytes
+     * @return page aligned buffer, it should be returned by AppendToIOBuf
+     *         or Release with the same size
+     */
+    static char* Get(size_t size);
+
+    /**
+     * @brief append the buffer to iobuf without copy, the buffer is put back
+     *        to the pool when the iobuf releases it
+     * @param buf: buffer from Get
+     * @param size: the size passed to Get
+     * @param iobuf: output iobuf
+     */
+    static void AppendToIOBuf(char* buf, size_t size, butil::IOBuf* iobuf);
+
+    /**
+     * @brief put back a buffer which isn't appended to iobuf
+     */
+    static void Release(char* buf, size_t size);
+
+    /**
+     * @brief number of buffers cached in the size class of size
+     */
+    static size_t CachedNum(size_t size);
+
+    /**
+     * @brief whether the buffer is carved from the huge page arena
+     */
+    static bool InArena(const char* buf);
+
+ private:
+    // return -1 if the size is larger than the biggest class
+    static int SizeClass(size_t size);
+};
+
+/**
+ * Buffer of the pool released when out of scope
+ */
+class PooledBuffer {
+ public:
+    explicit PooledBuffer(size_t size)
+        : buf_(BufferPool::Get(size)), size_(size) {}
+    ~PooledBuffer() {
+        BufferPool::Release(buf_, size_);
+    }
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+    char* get() const {
+        return buf_;
+    }
+
+ private:
+    char* buf_;
+    size_t size_;
+};
+
+}  // namespace chunkserver
+}  // namespace curve
+
+#endif  // SRC_CHUNKSERVER_DATASTORE_BUFFER_POOL_H_
@@ -0,0 +1,93 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/chunkserver/datastore/chunk_free_list.h"
+
+#include <thread>  // NOLINT
+
+namespace curve {
+namespace chunkserver {
+
+namespace {
+
+// Every thread gets a sequence number when it first touches a free list,
+// threads are assigned to shards round robin by it
+std::atomic<uint32_t> g_threadSeq{0};
+
+uint32_t ThreadSeq() {
+    static thread_local uint32_t seq = g_threadSeq.fetch_add(1);
+    return seq;
+}
+
+}  // namespace
+
+ChunkFreeList::ChunkFreeList(uint32_t shardNum)
+    : shardNum_(shardNum) {
+    if (shardNum_ == 0) {
+        shardNum_ = std::thread::hardware_concurrency();
+    }
+    if (shardNum_ == 0) {
+        shardNum_ = 1;
+    }
+    shards_.reset(new Shard[shardNum_]);
+    count_[0].store(0);
+    count_[1].store(0);
+}
+
+uint32_t ChunkFreeList::LocalShard() const {
+    return ThreadSeq() % shardNum_;
+}
+
+void ChunkFreeList::Push(uint64_t chunkid, bool clean) {
+    Shard& shard = shards_[LocalShard()];
+    std::lock_guard<std::mutex> lk(shard.mtx);
+    shard.chunks[clean].push_back(chunkid);
+    count_[clean].fetch_add(1, std::memory_order_release);
+}
+
+bool ChunkFreeList::Pop(bool clean, uint64_t* chunkid) {
+    const uint32_t local = LocalShard();
+    for (uint32_t i = 0; i < shardNum_; ++i) {
+        if (Size(clean) == 0) {
+            return false;
+        }
+        Shard& shard = shards_[(local + i) % shardNum_];
+        std::lock_guard<std::mutex> lk(shard.mtx);
+        std::vector<uint64_t>& chunks = shard.chunks[clean];
+        if (chunks.empty()) {
+            continue;
+        }
+        *chunkid = chunks.back();
+        chunks.pop_back();
+        count_[clean].fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+    return false;
+}
+
+void ChunkFreeList::Clear() {
+    for (uint32_t i = 0; i < shardNum_; ++i) {
+        std::lock_guard<std::mutex> lk(shards_[i].mtx);
+        for (int clean = 0; clean < 2; ++clean) {
+            count_[clean].fetch_sub(shards_[i].chunks[clean].size(),
+                                    std::memory_order_release);
+            shards_[i].chunks[clean].clear();
+        }
+    }
+}
+
+}  // namespace chunkserver
+}  // namespace curve
@@ -0,0 +1,86 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_CHUNKSERVER_DATASTORE_CHUNK_FREE_LIST_H_
+#define SRC_CHUNKSERVER_DATASTORE_CHUNK_FREE_LIST_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "include/curve_compiler_specific.h"
+
+namespace curve {
+namespace chunkserver {
+
+/**
+ * Free chunk ids of FilePool, clean and dirty chunks are kept apart.
+ *
+ * The ids are spread over shards which have their own lock. A thread
+ * pushes to and pops from its own shard, and only steals from the other
+ * shards when its own one is empty, so threads allocating chunks at the
+ * same time rarely contend on one lock.
+ */
+class ChunkFreeList {
+ public:
+    /**
+     * @param shardNum: number of shards, 0 means the number of cpus
+     */
+    explicit ChunkFreeList(uint32_t shardNum = 0);
+
+    ChunkFreeList(const ChunkFreeList&) = delete;
+    ChunkFreeList& operator=(const ChunkFreeList&) = delete;
+
+    void Push(uint64_t chunkid, bool clean);
+
+    /**
+     * @brief: Take a chunk id
+     * @param clean: take a clean chunk or a dirty chunk
+     * @param chunkid: the chunk id taken
+     * @return: false if there is no chunk of the type
+     */
+    bool Pop(bool clean, uint64_t* chunkid);
+
+    // Number of chunks of the type
+    uint64_t Size(bool clean) const {
+        return count_[clean].load(std::memory_order_acquire);
+    }
+
+    void Clear();
+
+ private:
+    struct Shard {
+        std::mutex mtx;
+        // dirty chunks at 0, clean chunks at 1
+        std::vector<uint64_t> chunks[2];
+        // keep the locks of neighbouring shards off one cache line
+        char padding[CURVE_CACHELINE_SIZE];
+    };
+
+    // Shard of the current thread
+    uint32_t LocalShard() const;
+
+    uint32_t shardNum_;
+    std::unique_ptr<Shard[]> shards_;
+    std::atomic<uint64_t> count_[2];
+};
+
+}  // namespace chunkserver
+}  // namespace curve
+
+#endif  // SRC_CHUNKSERVER_DATASTORE_CHUNK_FREE_LIST_H_
@@ -0,0 +1,148 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/chunkserver/datastore/chunk_page_cache.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace curve {
+namespace chunkserver {
+
+namespace {
+
+double GetHitRatio(void* arg) {
+    auto metrics = static_cast<curve::common::CacheMetrics*>(arg);
+    uint64_t hit = metrics->cacheHit.get_value();
+    uint64_t total = hit + metrics->cacheMiss.get_value();
+    return total == 0 ? 0 : static_cast<double>(hit) / total;
+}
+
+}  // namespace
+
+const uint32_t ChunkPageCache::kStripeNum;
+
+ChunkPageCache::ChunkPageCache(const ChunkPageCacheOptions& options)
+    : options_(options),
+      metrics_(std::make_shared<curve::common::CacheMetrics>(
+          "chunkserver_page_cache")),
+      hitRatio_("chunkserver_page_cache", "hit_ratio",
+                GetHitRatio, metrics_.get()) {
+    CHECK(options_.pageSize > 0) << "Invalid page size of page cache";
+    // ARC keeps as many evicted keys as cached pages to detect pages
+    // coming back, the cached pages are half of its count
+    int64_t pageNum = options_.capacity / options_.pageSize;
+    pages_.reset(new PageLRU(pageNum * 2, metrics_));
+    LOG(INFO) << "Chunk page cache is enabled, capacity: "
+              << options_.capacity << ", page size: " << options_.pageSize
+              << ", max read size: " << options_.maxReadSize;
+}
+
+bool ChunkPageCache::Read(ChunkID id, char* buf,
+                          off_t offset, size_t length) {
+    uint32_t beginPage = offset / options_.pageSize;
+    uint32_t endPage = (offset + length - 1) / options_.pageSize;
+    // look up the pages before copying, so that a partial hit
+    // leaves buf untouched
+    std::vector<PagePtr> pages;
+    pages.reserve(endPage - beginPage + 1);
+    for (uint32_t page = beginPage; page <= endPage; ++page) {
+        PagePtr data;
+        if (!pages_->Get({id, page}, &data)) {
+            return false;
+        }
+        pages.emplace_back(std::move(data));
+    }
+
+    off_t pos = offset;
+    size_t copied = 0;
+    for (const auto& data : pages) {
+        off_t inPage = pos % options_.pageSize;
+        size_t len = std::min<size_t>(options_.pageSize - inPage,
+                                      length - copied);
+        memcpy(buf + copied, data->data() + inPage, len);
+        copied += len;
+        pos += len;
+    }
+    return true;
+}
+
+uint64_t ChunkPageCache::GetVersion(ChunkID id) {
+    Stripe* stripe = GetStripe(id);
+    std::lock_guard<std::mutex> lk(stripe->mtx);
+    return stripe->version;
+}
+
+void ChunkPageCache::Fill(ChunkID id, uint64_t version,
+                          const char* buf, off_t offset, size_t length) {
+    // only the pages fully covered by the area
+    uint64_t begin = (offset + options_.pageSize - 1) / options_.pageSize *
+                     options_.pageSize;
+    uint64_t end = (offset + length) / options_.pageSize * options_.pageSize;
+    if (begin >= end) {
+        return;
+    }
+
+    Stripe* stripe = GetStripe(id);
+    std::lock_guard<std::mutex> lk(stripe->mtx);
+    if (stripe->version != version) {
+        return;
+    }
+    for (uint64_t pos = begin; pos < end; pos += options_.pageSize) {
+        auto data = std::make_shared<std::string>(buf + (pos - offset),
+                                                  options_.pageSize);
+        pages_->Put({id, static_cast<uint32_t>(pos / options_.pageSize)},
+                    data);
+    }
+    stripe->chunks.insert(id);
+}
+
+void ChunkPageCache::Invalidate(ChunkID id, off_t offset, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    Stripe* stripe = GetStripe(id);
+    std::lock_guard<std::mutex> lk(stripe->mtx);
+    ++stripe->version;
+    if (stripe->chunks.count(id) == 0) {
+        return;
+    }
+    RemovePagesLocked(id, offset / options_.pageSize,
+                      (offset + length - 1) / options_.pageSize);
+}
+
+void ChunkPageCache::InvalidateChunk(ChunkID id, uint64_t chunkSize) {
+    Stripe* stripe = GetStripe(id);
+    std::lock_guard<std::mutex> lk(stripe->mtx);
+    ++stripe->version;
+    if (stripe->chunks.erase(id) == 0 || chunkSize == 0) {
+        return;
+    }
+    RemovePagesLocked(id, 0, (chunkSize - 1) / options_.pageSize);
+}
+
+void ChunkPageCache::RemovePagesLocked(ChunkID id, uint32_t beginPage,
+                                       uint32_t endPage) {
+    for (uint32_t page = beginPage; page <= endPage; ++page) {
+        pages_->Remove({id, page});
+    }
+}
+
+}  // namespace chunkserver
+}  // namespace curve
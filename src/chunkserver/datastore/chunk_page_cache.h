@@ -0,0 +1,162 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_CHUNKSERVER_DATASTORE_CHUNK_PAGE_CACHE_H_
+#define SRC_CHUNKSERVER_DATASTORE_CHUNK_PAGE_CACHE_H_
+
+#include <bvar/bvar.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_set>
+
+#include "include/chunkserver/chunkserver_common.h"
+#include "src/common/lru_cache.h"
+
+namespace curve {
+namespace chunkserver {
+
+struct ChunkPageKey {
+    ChunkID id;
+    uint32_t page;
+
+    bool operator==(const ChunkPageKey& rhs) const {
+        return id == rhs.id && page == rhs.page;
+    }
+};
+
+}  // namespace chunkserver
+}  // namespace curve
+
+namespace std {
+
+template <>
+struct hash<curve::chunkserver::ChunkPageKey> {
+    size_t operator()(const curve::chunkserver::ChunkPageKey& key) const {
+        return std::hash<uint64_t>()(key.id * 1000003 + key.page);
+    }
+};
+
+}  // namespace std
+
+namespace curve {
+namespace chunkserver {
+
+/**
+ * capacity: bytes of data cached, 0 means not to cache
+ * pageSize: size of a cached page, pages are aligned in the chunk
+ * maxReadSize: reads larger than it neither look up nor fill the cache,
+ *              they are mostly sequential and would only churn it
+ */
+struct ChunkPageCacheOptions {
+    uint64_t capacity = 0;
+    uint32_t pageSize = 4096;
+    uint32_t maxReadSize = 64 * 1024;
+};
+
+/**
+ * Cache of chunk data pages shared by the datastores of all copysets,
+ * it keeps the small hot working set (boot sectors, filesystem metadata)
+ * of many volumes in memory. Chunk ids are unique in the cluster, so
+ * pages are keyed by (chunk id, page index).
+ *
+ * Pages are replaced by ARC, so a scan reading every page once does not
+ * push out the pages read repeatedly.
+ *
+ * A page is only filled from the data the datastore just read. Writes
+ * invalidate the pages they touch after the data is on disk, and a fill
+ * is dropped if an invalidation of the chunk happened during the read,
+ * so a cached page never goes back to the data before a write.
+ */
+class ChunkPageCache {
+ public:
+    explicit ChunkPageCache(const ChunkPageCacheOptions& options);
+
+    ChunkPageCache(const ChunkPageCache&) = delete;
+    ChunkPageCache& operator=(const ChunkPageCache&) = delete;
+
+    /**
+     * @brief: Read the area from the cache
+     * @return: true if all pages of the area are cached and copied to buf
+     */
+    bool Read(ChunkID id, char* buf, off_t offset, size_t length);
+
+    /**
+     * @brief: Version of the chunk, taken before the data is read from disk
+     *         and passed to Fill
+     */
+    uint64_t GetVersion(ChunkID id);
+
+    /**
+     * @brief: Cache the pages fully covered by the area just read from disk,
+     *         nothing is cached if the chunk changed after version was taken
+     */
+    void Fill(ChunkID id, uint64_t version,
+              const char* buf, off_t offset, size_t length);
+
+    // Drop the cached pages of the written area
+    void Invalidate(ChunkID id, off_t offset, size_t length);
+
+    // Drop all cached pages of the chunk, e.g. when it is deleted
+    void InvalidateChunk(ChunkID id, uint64_t chunkSize);
+
+    bool Cacheable(size_t length) const {
+        return length > 0 && length <= options_.maxReadSize;
+    }
+
+ private:
+    using PagePtr = std::shared_ptr<std::string>;
+
+    struct PageTraits {
+        static uint64_t CountBytes(const PagePtr& page) {
+            return page->size();
+        }
+    };
+
+    using PageLRU = curve::common::ARCCache<ChunkPageKey, PagePtr,
+        curve::common::CacheTraits<ChunkPageKey>, PageTraits>;
+
+    // Version and cached chunks of the chunks hashed to the stripe,
+    // the lock orders fills against invalidations of these chunks
+    struct Stripe {
+        std::mutex mtx;
+        uint64_t version = 0;
+        std::unordered_set<ChunkID> chunks;
+    };
+
+    static const uint32_t kStripeNum = 256;
+
+    Stripe* GetStripe(ChunkID id) {
+        return &stripes_[std::hash<ChunkID>()(id) % kStripeNum];
+    }
+
+    void RemovePagesLocked(ChunkID id, uint32_t beginPage,
+                           uint32_t endPage);
+
+    ChunkPageCacheOptions options_;
+    std::shared_ptr<curve::common::CacheMetrics> metrics_;
+    std::unique_ptr<PageLRU> pages_;
+    Stripe stripes_[kStripeNum];
+    bvar::PassiveStatus<double> hitRatio_;
+};
+
+}  // namespace chunkserver
+}  // namespace curve
+
+#endif  // SRC_CHUNKSERVER_DATASTORE_CHUNK_PAGE_CACHE_H_
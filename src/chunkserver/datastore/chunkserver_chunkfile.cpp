@@ -21,10 +21,12 @@
  */
 #include <fcntl.h>
 #include <algorithm>
+#include <iterator>
 #include <memory>
 
 #include "src/chunkserver/datastore/chunkserver_datastore.h"
 #include "src/chunkserver/datastore/chunkserver_chunkfile.h"
+#include "src/chunkserver/datastore/buffer_pool.h"
 #include "src/common/crc32.h"
 #include "src/common/curve_define.h"
 
@@ -42,6 +44,15 @@ ChunkFileMetaPage::ChunkFileMetaPage(const ChunkFileMetaPage& metaPage) {
     } else {
         bitmap = nullptr;
     }
+    checksumBlockSize = metaPage.checksumBlockSize;
+    if (metaPage.checksumBitmap != nullptr) {
+        checksumBitmap = std::make_shared<Bitmap>(
+            metaPage.checksumBitmap->Size(),
+            metaPage.checksumBitmap->GetBitmap());
+    } else {
+        checksumBitmap = nullptr;
+    }
+    checksums = metaPage.checksums;
 }
 
 ChunkFileMetaPage& ChunkFileMetaPage::operator =(
@@ -58,6 +69,15 @@ ChunkFileMetaPage& ChunkFileMetaPage::operator =(
     } else {
         bitmap = nullptr;
     }
+    checksumBlockSize = metaPage.checksumBlockSize;
+    if (metaPage.checksumBitmap != nullptr) {
+        checksumBitmap = std::make_shared<Bitmap>(
+            metaPage.checksumBitmap->Size(),
+            metaPage.checksumBitmap->GetBitmap());
+    } else {
+        checksumBitmap = nullptr;
+    }
+    checksums = metaPage.checksums;
     return *this;
 }
 
@@ -83,6 +103,18 @@ void ChunkFileMetaPage::encode(char* buf) {
         memcpy(buf + len, bitmap->GetBitmap(), bitmapBytes);
         len += bitmapBytes;
     }
+    if (version == FORMAT_VERSION_V3) {
+        memcpy(buf + len, &checksumBlockSize, sizeof(checksumBlockSize));
+        len += sizeof(checksumBlockSize);
+        uint32_t count = checksums.size();
+        memcpy(buf + len, &count, sizeof(count));
+        len += sizeof(count);
+        size_t bitmapBytes = (count + 8 - 1) >> 3;
+        memcpy(buf + len, checksumBitmap->GetBitmap(), bitmapBytes);
+        len += bitmapBytes;
+        memcpy(buf + len, checksums.data(), count * sizeof(uint32_t));
+        len += count * sizeof(uint32_t);
+    }
     uint32_t crc = ::curve::common::CRC32(buf, len);
     memcpy(buf + len, &crc, sizeof(crc));
 }
@@ -108,6 +140,21 @@ CSErrorCode ChunkFileMetaPage::decode(const char* buf) {
         size_t bitmapBytes = (bitmap->Size() + 8 - 1) >> 3;
         len += bitmapBytes;
     }
+    checksumBlockSize = 0;
+    checksumBitmap = nullptr;
+    checksums.clear();
+    if (version == FORMAT_VERSION_V3) {
+        memcpy(&checksumBlockSize, buf + len, sizeof(checksumBlockSize));
+        len += sizeof(checksumBlockSize);
+        uint32_t count = 0;
+        memcpy(&count, buf + len, sizeof(count));
+        len += sizeof(count);
+        checksumBitmap = std::make_shared<Bitmap>(count, buf + len);
+        len += (count + 8 - 1) >> 3;
+        checksums.resize(count);
+        memcpy(checksums.data(), buf + len, count * sizeof(uint32_t));
+        len += count * sizeof(uint32_t);
+    }
     uint32_t crc =  ::curve::common::CRC32(buf, len);
     uint32_t recordCrc;
     memcpy(&recordCrc, buf + len, sizeof(recordCrc));
@@ -119,16 +166,31 @@ CSErrorCode ChunkFileMetaPage::decode(const char* buf) {
 
     // TODO(yyk) check version compatibility, currrent simple error handing,
     // need detailed implementation later
-    if (!(version == FORMAT_VERSION || version == FORMAT_VERSION_V2)) {
+    if (!(version == FORMAT_VERSION || version == FORMAT_VERSION_V2 ||
+          version == FORMAT_VERSION_V3)) {
         LOG(ERROR) << "File format version incompatible."
                    << "file version: " << version
                    << ", valid version: [" << FORMAT_VERSION
-                   << ", " << FORMAT_VERSION_V2 << "]";
+                   << ", " << FORMAT_VERSION_V3 << "]";
         return CSErrorCode::IncompatibleError;
     }
     return CSErrorCode::Success;
 }
 
+size_t ChunkFileMetaPage::MaxEncodedSize(uint32_t locationLimit,
+                                         uint32_t blockNum,
+                                         uint32_t checksumNum) {
+    size_t size = sizeof(uint8_t) + sizeof(SequenceNum) * 2 + sizeof(size_t);
+    // location and bitmap of clone chunk
+    size += locationLimit + sizeof(uint32_t) + ((blockNum + 8 - 1) >> 3);
+    if (checksumNum > 0) {
+        size += sizeof(uint32_t) * 2 + ((checksumNum + 8 - 1) >> 3) +
+                sizeof(uint32_t) * checksumNum;
+    }
+    // crc of the metapage
+    return size + sizeof(uint32_t);
+}
+
 uint64_t CSChunkFile::syncChunkLimits_ = 2 * 1024 * 1024;
 uint64_t CSChunkFile::syncThreshold_ = 64 * 1024;
 
@@ -148,7 +210,9 @@ CSChunkFile::CSChunkFile(std::shared_ptr<LocalFileSystem> lfs,
       chunkFilePool_(chunkFilePool),
       lfs_(lfs),
       metric_(options.metric),
-      enableOdsyncWhenOpenChunkFile_(options.enableOdsyncWhenOpenChunkFile) {
+      enableOdsyncWhenOpenChunkFile_(options.enableOdsyncWhenOpenChunkFile),
+      enableRedirectOnWrite_(options.enableRedirectOnWrite),
+      crcCacheMaxHits_(options.crcCacheMaxHits) {
     CHECK(!baseDir_.empty()) << "Create chunk file failed";
     CHECK(lfs_ != nullptr) << "Create chunk file failed";
     metaPage_.sn = options.sn;
@@ -160,6 +224,14 @@ CSChunkFile::CSChunkFile(std::shared_ptr<LocalFileSystem> lfs,
         uint32_t bits = size_ / blockSize_;
         metaPage_.bitmap = std::make_shared<Bitmap>(bits);
     }
+    // Only used when the chunk file is created, the metapage loaded
+    // from an existing chunk file overrides it
+    if (options.checksumBlockSize > 0) {
+        uint32_t count = size_ / options.checksumBlockSize;
+        metaPage_.checksumBlockSize = options.checksumBlockSize;
+        metaPage_.checksumBitmap = std::make_shared<Bitmap>(count);
+        metaPage_.checksums.resize(count, 0);
+    }
     if (metric_ != nullptr) {
         metric_->chunkFileCount << 1;
     }
@@ -195,7 +267,8 @@ CSErrorCode CSChunkFile::Open(bool createFile) {
         && metaPage_.sn > 0) {
         std::unique_ptr<char[]> buf(new char[metaPageSize_]);
         memset(buf.get(), 0, metaPageSize_);
-        metaPage_.version = FORMAT_VERSION_V2;
+        metaPage_.version = hasChecksum() ? FORMAT_VERSION_V3
+                                          : FORMAT_VERSION_V2;
         metaPage_.encode(buf.get());
 
         int rc = chunkFilePool_->GetFile(chunkFilePath, buf.get(), true);
@@ -239,6 +312,15 @@ CSErrorCode CSChunkFile::Open(bool createFile) {
     }
 
     CSErrorCode errCode = loadMetaPage();
+    if (errCode == CSErrorCode::Success && hasChecksum() &&
+        metaPage_.checksumBlockSize * metaPage_.checksums.size() != size_) {
+        LOG(ERROR) << "Wrong data checksums in metapage."
+                   << " filepath = " << chunkFilePath
+                   << ", checksum block size = "
+                   << metaPage_.checksumBlockSize
+                   << ", checksum count = " << metaPage_.checksums.size();
+        return CSErrorCode::FileFormatError;
+    }
     // After restarting, only after reopening and loading the metapage,
     // can we know whether it is a clone chunk
     if (!metaPage_.location.empty() && !isCloneChunk_) {
@@ -267,6 +349,7 @@ CSErrorCode CSChunkFile::LoadSnapshot(SequenceNum sn) {
     options.blockSize = blockSize_;
     options.metaPageSize = metaPageSize_;
     options.metric = metric_;
+    options.enableOdsyncWhenOpenChunkFile = enableOdsyncWhenOpenChunkFile_;
     snapshot_ = new(std::nothrow) CSSnapshot(lfs_,
                                             chunkFilePool_,
                                             options);
@@ -344,6 +427,9 @@ CSErrorCode CSChunkFile::Write(SequenceNum sn,
         options.blockSize = blockSize_;
         options.metaPageSize = metaPageSize_;
         options.metric = metric_;
+        options.enableOdsyncWhenOpenChunkFile =
+            enableOdsyncWhenOpenChunkFile_;
+        options.enableRedirectOnWrite = enableRedirectOnWrite_;
         snapshot_ = new(std::nothrow) CSSnapshot(lfs_,
                                                  chunkFilePool_,
                                                  options);
@@ -378,8 +464,11 @@ CSErrorCode CSChunkFile::Write(SequenceNum sn,
         }
         metaPage_.sn = tempMeta.sn;
     }
+    // If the snapshot is redirect-on-write, there is nothing to copy,
+    // the data is written to the snapshot file instead
+    bool redirect = isRedirectOnWrite();
     // If it is cow, copy the data to the snapshot file first
-    if (needCow(sn)) {
+    if (!redirect && needCow(sn)) {
         DLOG_EVERY_SECOND(INFO) << "COW On offset = " << offset
                                 << ", length = " << length
                                 << ", ChunkID: " << chunkId_
@@ -394,16 +483,38 @@ CSErrorCode CSChunkFile::Write(SequenceNum sn,
             return errorCode;
         }
     }
-    int rc = writeData(buf, offset, length);
-    if (rc < 0) {
-        LOG(ERROR) << "Write data to chunk file failed."
-                   << "ChunkID: " << chunkId_
-                   << ",request sn: " << sn
-                   << ",chunk sn: " << metaPage_.sn;
-        return CSErrorCode::InternalError;
+    invalidateCrc(offset, length);
+    CSErrorCode errorCode = CSErrorCode::Success;
+    if (redirect) {
+        errorCode = redirect2Snapshot(sn, buf, offset, length);
+        if (errorCode != CSErrorCode::Success) {
+            LOG(ERROR) << "Redirect data to snapshot failed."
+                       << "ChunkID: " << chunkId_
+                       << ",request sn: " << sn
+                       << ",chunk sn: " << metaPage_.sn;
+            return errorCode;
+        }
+    } else {
+        int rc = writeData(buf, offset, length);
+        if (rc < 0) {
+            LOG(ERROR) << "Write data to chunk file failed."
+                       << "ChunkID: " << chunkId_
+                       << ",request sn: " << sn
+                       << ",chunk sn: " << metaPage_.sn;
+            return CSErrorCode::InternalError;
+        }
+        errorCode = updateChecksums(buf, offset, length);
+        if (errorCode != CSErrorCode::Success) {
+            LOG(ERROR) << "Update data checksums failed."
+                       << "ChunkID: " << chunkId_
+                       << ",request sn: " << sn
+                       << ",chunk sn: " << metaPage_.sn;
+            return errorCode;
+        }
     }
-    // If it is a clone chunk, the bitmap will be updated
-    CSErrorCode errorCode = flush();
+    // If it is a clone chunk, the bitmap will be updated,
+    // the checksums of the written areas are updated as well
+    errorCode = flush();
     if (errorCode != CSErrorCode::Success) {
         LOG(ERROR) << "Write data to chunk file failed."
                    << "ChunkID: " << chunkId_
@@ -434,10 +545,48 @@ CSErrorCode CSChunkFile::Sync() {
                    << "ChunkID:" << chunkId_;
         return CSErrorCode::InternalError;
     }
+    // The latest data is partly in the snapshot file of redirect-on-write
+    if (isRedirectOnWrite()) {
+        return snapshot_->Sync();
+    }
+    return CSErrorCode::Success;
+}
+
+CSErrorCode CSChunkFile::WriteBack() {
+    ReadLockGuard readGuard(rwLock_);
+    // nothing to keep of a deleted chunk
+    if (fd_ < 0) {
+        return CSErrorCode::Success;
+    }
+    int rc = lfs_->SyncFileRange(fd_, 0, 0);
+    if (rc < 0) {
+        LOG(ERROR) << "Write back data failed, "
+                   << "ChunkID:" << chunkId_;
+        return CSErrorCode::InternalError;
+    }
+    if (isRedirectOnWrite()) {
+        return snapshot_->WriteBack();
+    }
+    return CSErrorCode::Success;
+}
+
+CSErrorCode CSChunkFile::SyncFs(SyncFsGroup* group) {
+    ReadLockGuard readGuard(rwLock_);
+    if (fd_ < 0) {
+        return CSErrorCode::ChunkNotExistError;
+    }
+    int rc = group->Sync(fd_);
+    if (rc < 0) {
+        LOG(ERROR) << "Sync file system failed, "
+                   << "ChunkID:" << chunkId_;
+        return CSErrorCode::InternalError;
+    }
     return CSErrorCode::Success;
 }
 
-CSErrorCode CSChunkFile::Paste(const char * buf, off_t offset, size_t length) {
+CSErrorCode CSChunkFile::Paste(const butil::IOBuf& buf,
+                               off_t offset,
+                               size_t length) {
     WriteLockGuard writeGuard(rwLock_);
     if (!CheckOffsetAndLength(offset, length)) {
         LOG(ERROR) << "Paste chunk failed, invalid offset or length."
@@ -472,7 +621,11 @@ CSErrorCode CSChunkFile::Paste(const char * buf, off_t offset, size_t length) {
     for (auto& range : uncopiedRange) {
         pasteOff = range.beginIndex * blockSize_;
         pasteSize = (range.endIndex - range.beginIndex + 1) * blockSize_;
-        int rc = writeData(buf + (pasteOff - offset), pasteOff, pasteSize);
+        // only the references of the blocks are copied
+        butil::IOBuf pasteData;
+        buf.append_to(&pasteData, pasteSize, pasteOff - offset);
+        invalidateCrc(pasteOff, pasteSize);
+        int rc = writeData(pasteData, pasteOff, pasteSize);
         if (rc < 0) {
             LOG(ERROR) << "Paste data to chunk failed."
                        << "ChunkID: " << chunkId_
@@ -480,6 +633,15 @@ CSErrorCode CSChunkFile::Paste(const char * buf, off_t offset, size_t length) {
                        << ", length: " << length;
             return CSErrorCode::InternalError;
         }
+        CSErrorCode errorCode =
+            updateChecksums(pasteData, pasteOff, pasteSize);
+        if (errorCode != CSErrorCode::Success) {
+            LOG(ERROR) << "Update data checksums failed."
+                       << "ChunkID: " << chunkId_
+                       << ", offset: " << offset
+                       << ", length: " << length;
+            return errorCode;
+        }
     }
 
     // Update bitmap
@@ -525,9 +687,14 @@ CSErrorCode CSChunkFile::Read(char * buf, off_t offset, size_t length) {
         }
     }
 
-    int rc = readData(buf, offset, length);
+    return readLatestData(buf, offset, length);
+}
+
+CSErrorCode CSChunkFile::ReadMetaPage(char * buf) {
+    ReadLockGuard readGuard(rwLock_);
+    int rc = readMetaPage(buf);
     if (rc < 0) {
-        LOG(ERROR) << "Read chunk file failed."
+        LOG(ERROR) << "Read chunk meta page failed."
                    << "ChunkID: " << chunkId_
                    << ",chunk sn: " << metaPage_.sn;
         return CSErrorCode::InternalError;
@@ -535,15 +702,68 @@ CSErrorCode CSChunkFile::Read(char * buf, off_t offset, size_t length) {
     return CSErrorCode::Success;
 }
 
-CSErrorCode CSChunkFile::ReadMetaPage(char * buf) {
+CSErrorCode CSChunkFile::ReadCrc(off_t offset, size_t length, uint32_t* crc) {
     ReadLockGuard readGuard(rwLock_);
-    int rc = readMetaPage(buf);
-    if (rc < 0) {
-        LOG(ERROR) << "Read chunk meta page failed."
+    if (!CheckOffsetAndLength(offset, length)) {
+        LOG(ERROR) << "Read chunk crc failed, invalid offset or length."
                    << "ChunkID: " << chunkId_
-                   << ",chunk sn: " << metaPage_.sn;
+                   << ", offset: " << offset
+                   << ", length: " << length
+                   << ", chunk size: " << size_
+                   << ", block size: " << blockSize_;
+        return CSErrorCode::InvalidArgError;
+    }
+
+    if (isCloneChunk_) {
+        uint32_t beginIndex = offset / blockSize_;
+        uint32_t endIndex = (offset + length - 1) / blockSize_;
+        if (metaPage_.bitmap->NextClearBit(beginIndex, endIndex)
+            != Bitmap::NO_POS) {
+            LOG(ERROR) << "Read chunk crc failed, has page never written."
+                       << "ChunkID: " << chunkId_
+                       << ", offset: " << offset
+                       << ", length: " << length;
+            return CSErrorCode::PageNerverWrittenError;
+        }
+    }
+
+    if (crcCacheMaxHits_ > 0) {
+        std::lock_guard<std::mutex> lk(crcMtx_);
+        auto iter = crcCache_.find(offset);
+        if (iter != crcCache_.end() && iter->second.length == length &&
+            iter->second.hits < crcCacheMaxHits_) {
+            ++iter->second.hits;
+            *crc = iter->second.crc;
+            return CSErrorCode::Success;
+        }
+    }
+
+    std::unique_ptr<char[]> buf(new(std::nothrow) char[length]);
+    if (buf == nullptr) {
         return CSErrorCode::InternalError;
     }
+    if (isRedirectOnWrite()) {
+        CSErrorCode errorCode = readLatestData(buf.get(), offset, length);
+        if (errorCode != CSErrorCode::Success) {
+            return errorCode;
+        }
+    } else {
+        int rc = readData(buf.get(), offset, length);
+        if (rc < 0) {
+            LOG(ERROR) << "Read chunk file failed."
+                       << "ChunkID: " << chunkId_
+                       << ",chunk sn: " << metaPage_.sn;
+            return CSErrorCode::InternalError;
+        }
+    }
+    *crc = ::curve::common::CRC32(buf.get(), length);
+
+    // Writers are excluded by the read lock, so the crc is still up to date
+    if (crcCacheMaxHits_ > 0) {
+        std::lock_guard<std::mutex> lk(crcMtx_);
+        eraseCrcLocked(offset, length);
+        crcCache_[offset] = CachedCrc{length, *crc, 0};
+    }
     return CSErrorCode::Success;
 }
 
@@ -565,20 +785,17 @@ CSErrorCode CSChunkFile::ReadSpecifiedChunk(SequenceNum sn,
     // If the sequence equals the sequence of the current chunk,
     // read the current chunk file
     if (sn == metaPage_.sn) {
-        int rc = readData(buf, offset, length);
-        if (rc < 0) {
-            LOG(ERROR) << "Read chunk file failed."
-                       << "ChunkID: " << chunkId_
-                       << ",chunk sn: " << metaPage_.sn;
-            return CSErrorCode::InternalError;
-        }
-        return CSErrorCode::Success;
+        return readLatestData(buf, offset, length);
     }
     // If the snapshot file does not exist or the sequence is not equal to
     // the sequence of the snapshot file, a ChunkNotExist error is returned
     if (snapshot_ == nullptr || sn != snapshot_->GetSn()) {
         return CSErrorCode::ChunkNotExistError;
     }
+    // The data of the redirect-on-write snapshot stays in the chunk file
+    if (snapshot_->IsRedirectOnWrite()) {
+        return readVerifiedData(buf, offset, length);
+    }
 
     // Get the copied areas and uncopied areas in the snapshot file
     uint32_t blockBeginIndex = offset / blockSize_;
@@ -608,14 +825,14 @@ CSErrorCode CSChunkFile::ReadSpecifiedChunk(SequenceNum sn,
     for (auto& range : uncopiedRange) {
         readOff = range.beginIndex * blockSize_;
         readSize = (range.endIndex - range.beginIndex + 1) * blockSize_;
-        int rc = readData(buf + (readOff - offset),
-                          readOff,
-                          readSize);
-        if (rc < 0) {
+        errorCode = readVerifiedData(buf + (readOff - offset),
+                                     readOff,
+                                     readSize);
+        if (errorCode != CSErrorCode::Success) {
             LOG(ERROR) << "Read chunk file failed. "
                        << "ChunkID: " << chunkId_
                        << ", chunk sn: " << metaPage_.sn;
-            return CSErrorCode::InternalError;
+            return errorCode;
         }
     }
     // For the copied range, read the snapshot data
@@ -714,6 +931,19 @@ CSErrorCode CSChunkFile::DeleteSnapshotOrCorrectSn(SequenceNum correctedSn)  {
      * log of playback, and deletion is not allowed in this case.
      */
     if (snapshot_ != nullptr && metaPage_.sn > snapshot_->GetSn()) {
+        // The latest data of the redirected pages is only in the snapshot
+        // file of redirect-on-write, write it back before the deletion.
+        // If it fails halfway, the pages are merged again on retry or log
+        // replay, because the snapshot file is still there
+        if (snapshot_->IsRedirectOnWrite()) {
+            CSErrorCode errorCode = mergeSnapshot();
+            if (errorCode != CSErrorCode::Success) {
+                LOG(ERROR) << "Merge snapshot failed."
+                           << "ChunkID: " << chunkId_
+                           << ",snapshot sn: " << snapshot_->GetSn();
+                return errorCode;
+            }
+        }
         CSErrorCode errorCode = snapshot_->Delete();
         if (errorCode != CSErrorCode::Success) {
             LOG(ERROR) << "Delete snapshot failed."
@@ -810,6 +1040,30 @@ CSErrorCode CSChunkFile::GetHash(off_t offset,
     return CSErrorCode::Success;
 }
 
+void CSChunkFile::invalidateCrc(off_t offset, size_t length) {
+    if (crcCacheMaxHits_ == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lk(crcMtx_);
+    eraseCrcLocked(offset, length);
+}
+
+void CSChunkFile::eraseCrcLocked(off_t offset, size_t length) {
+    // The cached areas never overlap with each other,
+    // so only the one before offset may cover the area from left
+    auto iter = crcCache_.lower_bound(offset);
+    if (iter != crcCache_.begin()) {
+        auto prev = std::prev(iter);
+        if (prev->first + static_cast<off_t>(prev->second.length) > offset) {
+            iter = prev;
+        }
+    }
+    while (iter != crcCache_.end() &&
+           iter->first < offset + static_cast<off_t>(length)) {
+        iter = crcCache_.erase(iter);
+    }
+}
+
 bool CSChunkFile::needCreateSnapshot(SequenceNum sn) {
     // The maximum value of correctSn_ and sn_ can represent
     // the true sequence number of the chunk file
@@ -928,7 +1182,7 @@ CSErrorCode CSChunkFile::copy2Snapshot(off_t offset, size_t length) {
     for (auto& range : uncopiedRange) {
         copyOff = range.beginIndex * blockSize_;
         copySize = (range.endIndex - range.beginIndex + 1) * blockSize_;
-        std::unique_ptr<char[]> buf(new char[copySize]);
+        PooledBuffer buf(copySize);
         int rc = readData(buf.get(),
                           copyOff,
                           copySize);
@@ -962,13 +1216,316 @@ CSErrorCode CSChunkFile::copy2Snapshot(off_t offset, size_t length) {
     return CSErrorCode::Success;
 }
 
+CSErrorCode CSChunkFile::redirect2Snapshot(SequenceNum sn,
+                                           const butil::IOBuf& buf,
+                                           off_t offset,
+                                           size_t length) {
+    uint32_t pageBeginIndex = offset / blockSize_;
+    uint32_t pageEndIndex = (offset + length - 1) / blockSize_;
+    std::vector<BitRange> chunkRange;
+    std::vector<BitRange> snapRange;
+    // Same as cow, needCow tells whether the write must keep the data of
+    // the snapshot, if so all the pages are redirected.
+    // Otherwise, e.g. log replay after restart, only the pages already
+    // redirected go to the snapshot file, so that the latest data of
+    // a page is always in one place
+    if (needCow(sn)) {
+        snapRange.push_back(BitRange{pageBeginIndex, pageEndIndex});
+    } else {
+        std::shared_ptr<const Bitmap> snapBitmap = snapshot_->GetPageStatus();
+        snapBitmap->Divide(pageBeginIndex,
+                           pageEndIndex,
+                           &chunkRange,
+                           &snapRange);
+    }
+
+    CSErrorCode errorCode = CSErrorCode::Success;
+    off_t writeOff;
+    size_t writeSize;
+    for (auto& range : chunkRange) {
+        writeOff = range.beginIndex * blockSize_;
+        writeSize = (range.endIndex - range.beginIndex + 1) * blockSize_;
+        // only the references of the blocks are copied
+        butil::IOBuf data;
+        buf.append_to(&data, writeSize, writeOff - offset);
+        int rc = writeData(data, writeOff, writeSize);
+        if (rc < 0) {
+            LOG(ERROR) << "Write data to chunk file failed."
+                       << "ChunkID: " << chunkId_
+                       << ",chunk sn: " << metaPage_.sn;
+            return CSErrorCode::InternalError;
+        }
+        errorCode = updateChecksums(data, writeOff, writeSize);
+        if (errorCode != CSErrorCode::Success) {
+            return errorCode;
+        }
+    }
+    for (auto& range : snapRange) {
+        writeOff = range.beginIndex * blockSize_;
+        writeSize = (range.endIndex - range.beginIndex + 1) * blockSize_;
+        butil::IOBuf data;
+        buf.append_to(&data, writeSize, writeOff - offset);
+        errorCode = snapshot_->Write(data, writeOff, writeSize);
+        if (errorCode != CSErrorCode::Success) {
+            LOG(ERROR) << "Write to snapshot failed."
+                       << "ChunkID: " << chunkId_
+                       << ",chunk sn: " << metaPage_.sn
+                       << ",snapshot sn: " << snapshot_->GetSn();
+            return errorCode;
+        }
+    }
+    // Persist the newly redirected pages in the metapage of the snapshot,
+    // it does nothing if all the pages are redirected before
+    if (snapRange.size() > 0) {
+        errorCode = snapshot_->Flush();
+        if (errorCode != CSErrorCode::Success) {
+            LOG(ERROR) << "Flush snapshot metapage failed."
+                       << "ChunkID: " << chunkId_
+                       << ",chunk sn: " << metaPage_.sn
+                       << ",snapshot sn: " << snapshot_->GetSn();
+            return errorCode;
+        }
+    }
+    return CSErrorCode::Success;
+}
+
+CSErrorCode CSChunkFile::readLatestData(char* buf,
+                                        off_t offset,
+                                        size_t length) {
+    if (!isRedirectOnWrite()) {
+        return readVerifiedData(buf, offset, length);
+    }
+
+    uint32_t pageBeginIndex = offset / blockSize_;
+    uint32_t pageEndIndex = (offset + length - 1) / blockSize_;
+    std::vector<BitRange> chunkRange;
+    std::vector<BitRange> snapRange;
+    std::shared_ptr<const Bitmap> snapBitmap = snapshot_->GetPageStatus();
+    snapBitmap->Divide(pageBeginIndex,
+                       pageEndIndex,
+                       &chunkRange,
+                       &snapRange);
+
+    CSErrorCode errorCode = CSErrorCode::Success;
+    off_t readOff;
+    size_t readSize;
+    for (auto& range : chunkRange) {
+        readOff = range.beginIndex * blockSize_;
+        readSize = (range.endIndex - range.beginIndex + 1) * blockSize_;
+        errorCode = readVerifiedData(buf + (readOff - offset),
+                                     readOff,
+                                     readSize);
+        if (errorCode != CSErrorCode::Success) {
+            return errorCode;
+        }
+    }
+    for (auto& range : snapRange) {
+        readOff = range.beginIndex * blockSize_;
+        readSize = (range.endIndex - range.beginIndex + 1) * blockSize_;
+        errorCode = snapshot_->Read(buf + (readOff - offset),
+                                    readOff,
+                                    readSize);
+        if (errorCode != CSErrorCode::Success) {
+            LOG(ERROR) << "Read snapshot failed."
+                       << "ChunkID: " << chunkId_
+                       << ",chunk sn: " << metaPage_.sn
+                       << ",snapshot sn: " << snapshot_->GetSn();
+            return errorCode;
+        }
+    }
+    return CSErrorCode::Success;
+}
+
+CSErrorCode CSChunkFile::mergeSnapshot() {
+    std::vector<BitRange> snapRange;
+    std::shared_ptr<const Bitmap> snapBitmap = snapshot_->GetPageStatus();
+    snapBitmap->Divide(0, snapBitmap->Size() - 1, nullptr, &snapRange);
+
+    CSErrorCode errorCode = CSErrorCode::Success;
+    off_t mergeOff;
+    size_t mergeSize;
+    for (auto& range : snapRange) {
+        mergeOff = range.beginIndex * blockSize_;
+        mergeSize = (range.endIndex - range.beginIndex + 1) * blockSize_;
+        char* buf = BufferPool::Get(mergeSize);
+        errorCode = snapshot_->Read(buf, mergeOff, mergeSize);
+        if (errorCode != CSErrorCode::Success) {
+            BufferPool::Release(buf, mergeSize);
+            return errorCode;
+        }
+        butil::IOBuf data;
+        BufferPool::AppendToIOBuf(buf, mergeSize, &data);
+        int rc = writeData(data, mergeOff, mergeSize);
+        if (rc < 0) {
+            LOG(ERROR) << "Write data to chunk file failed."
+                       << "ChunkID: " << chunkId_
+                       << ",chunk sn: " << metaPage_.sn;
+            return CSErrorCode::InternalError;
+        }
+        // The checksums cover the data in the chunk file, the areas shared
+        // with the later ranges are computed again when they are merged
+        errorCode = updateChecksums(data, mergeOff, mergeSize);
+        if (errorCode != CSErrorCode::Success) {
+            return errorCode;
+        }
+    }
+    if (snapRange.empty()) {
+        return CSErrorCode::Success;
+    }
+    errorCode = flush();
+    if (errorCode != CSErrorCode::Success) {
+        return errorCode;
+    }
+    // The merged data must be on disk before the snapshot file is recycled
+    int rc = SyncData();
+    if (rc < 0) {
+        LOG(ERROR) << "Sync data failed, "
+                   << "ChunkID:" << chunkId_;
+        return CSErrorCode::InternalError;
+    }
+    return CSErrorCode::Success;
+}
+
+CSErrorCode CSChunkFile::readVerifiedData(char* buf,
+                                          off_t offset,
+                                          size_t length) {
+    if (!hasChecksum()) {
+        int rc = readData(buf, offset, length);
+        if (rc < 0) {
+            LOG(ERROR) << "Read chunk file failed."
+                       << "ChunkID: " << chunkId_
+                       << ",chunk sn: " << metaPage_.sn;
+            return CSErrorCode::InternalError;
+        }
+        return CSErrorCode::Success;
+    }
+
+    const uint32_t checksumBlockSize = metaPage_.checksumBlockSize;
+    const std::shared_ptr<Bitmap>& recorded = metaPage_.checksumBitmap;
+    uint32_t beginIndex = offset / checksumBlockSize;
+    uint32_t endIndex = (offset + length - 1) / checksumBlockSize;
+    off_t alignedOff = static_cast<off_t>(beginIndex) * checksumBlockSize;
+    off_t alignedEnd = static_cast<off_t>(endIndex + 1) * checksumBlockSize;
+    // Only the recorded areas at the two ends may be partly read
+    bool needAlign =
+        (alignedOff < offset && recorded->Test(beginIndex)) ||
+        (alignedEnd > static_cast<off_t>(offset + length) &&
+         recorded->Test(endIndex));
+
+    char* data = buf;
+    std::unique_ptr<char[]> alignedBuf;
+    if (needAlign) {
+        alignedBuf.reset(new(std::nothrow) char[alignedEnd - alignedOff]);
+        if (alignedBuf == nullptr) {
+            return CSErrorCode::InternalError;
+        }
+        data = alignedBuf.get();
+    } else {
+        alignedOff = offset;
+        alignedEnd = offset + length;
+    }
+    int rc = readData(data, alignedOff, alignedEnd - alignedOff);
+    if (rc < 0) {
+        LOG(ERROR) << "Read chunk file failed."
+                   << "ChunkID: " << chunkId_
+                   << ",chunk sn: " << metaPage_.sn;
+        return CSErrorCode::InternalError;
+    }
+
+    for (uint32_t index = beginIndex; index <= endIndex; ++index) {
+        off_t areaOff = static_cast<off_t>(index) * checksumBlockSize;
+        if (!recorded->Test(index) || areaOff < alignedOff ||
+            areaOff + checksumBlockSize > alignedEnd) {
+            continue;
+        }
+        uint32_t crc = ::curve::common::CRC32(
+            data + (areaOff - alignedOff), checksumBlockSize);
+        if (crc != metaPage_.checksums[index]) {
+            LOG(ERROR) << "Data checksum mismatch, the data may be corrupted."
+                       << "ChunkID: " << chunkId_
+                       << ", area offset: " << areaOff
+                       << ", area length: " << checksumBlockSize
+                       << ", expect crc: " << metaPage_.checksums[index]
+                       << ", real crc: " << crc;
+            return CSErrorCode::CrcCheckError;
+        }
+    }
+
+    if (needAlign) {
+        memcpy(buf, data + (offset - alignedOff), length);
+    }
+    return CSErrorCode::Success;
+}
+
+CSErrorCode CSChunkFile::updateChecksums(const butil::IOBuf& buf,
+                                         off_t offset,
+                                         size_t length) {
+    if (!hasChecksum()) {
+        return CSErrorCode::Success;
+    }
+
+    const uint32_t checksumBlockSize = metaPage_.checksumBlockSize;
+    uint32_t beginIndex = offset / checksumBlockSize;
+    uint32_t endIndex = (offset + length - 1) / checksumBlockSize;
+    std::unique_ptr<char[]> unwritten;
+    for (uint32_t index = beginIndex; index <= endIndex; ++index) {
+        off_t areaOff = static_cast<off_t>(index) * checksumBlockSize;
+        off_t areaEnd = areaOff + checksumBlockSize;
+        off_t writtenOff = std::max(areaOff, offset);
+        off_t writtenEnd = std::min(areaEnd,
+                                    static_cast<off_t>(offset + length));
+        uint32_t crc = 0;
+        // the data around the written part is read from disk
+        if (writtenOff > areaOff || writtenEnd < areaEnd) {
+            if (unwritten == nullptr) {
+                unwritten.reset(new(std::nothrow) char[checksumBlockSize]);
+                if (unwritten == nullptr) {
+                    return CSErrorCode::InternalError;
+                }
+            }
+        }
+        if (writtenOff > areaOff) {
+            int rc = readData(unwritten.get(), areaOff, writtenOff - areaOff);
+            if (rc < 0) {
+                return CSErrorCode::InternalError;
+            }
+            crc = ::curve::common::CRC32(crc, unwritten.get(),
+                                         writtenOff - areaOff);
+        }
+        butil::IOBuf written;
+        buf.append_to(&written, writtenEnd - writtenOff, writtenOff - offset);
+        for (size_t i = 0; i < written.backing_block_num(); ++i) {
+            butil::StringPiece block = written.backing_block(i);
+            crc = ::curve::common::CRC32(crc, block.data(), block.size());
+        }
+        if (writtenEnd < areaEnd) {
+            int rc = readData(unwritten.get(), writtenEnd,
+                              areaEnd - writtenEnd);
+            if (rc < 0) {
+                return CSErrorCode::InternalError;
+            }
+            crc = ::curve::common::CRC32(crc, unwritten.get(),
+                                         areaEnd - writtenEnd);
+        }
+        dirtyChecksums_[index] = crc;
+    }
+    return CSErrorCode::Success;
+}
+
 CSErrorCode CSChunkFile::flush() {
+    if (dirtyPages_.empty() && dirtyChecksums_.empty() && !isCloneChunk_) {
+        return CSErrorCode::Success;
+    }
     ChunkFileMetaPage tempMeta = metaPage_;
-    bool needUpdateMeta = dirtyPages_.size() > 0;
+    bool needUpdateMeta = !dirtyPages_.empty() || !dirtyChecksums_.empty();
     bool clearClone = false;
     for (auto pageIndex : dirtyPages_) {
         tempMeta.bitmap->Set(pageIndex);
     }
+    for (auto& checksum : dirtyChecksums_) {
+        tempMeta.checksumBitmap->Set(checksum.first);
+        tempMeta.checksums[checksum.first] = checksum.second;
+    }
     if (isCloneChunk_) {
         // If all pages have been written, mark the Chunk as a non-clone chunk
         if (tempMeta.bitmap->NextClearBit(0) == Bitmap::NO_POS) {
@@ -988,7 +1545,10 @@ CSErrorCode CSChunkFile::flush() {
         }
         metaPage_.bitmap = tempMeta.bitmap;
         metaPage_.location = tempMeta.location;
+        metaPage_.checksumBitmap = tempMeta.checksumBitmap;
+        metaPage_.checksums.swap(tempMeta.checksums);
         dirtyPages_.clear();
+        dirtyChecksums_.clear();
         if (clearClone) {
             if (metric_ != nullptr) {
                 metric_->cloneChunkCount << -1;
@@ -27,6 +27,8 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <map>
+#include <mutex>  // NOLINT
 #include <atomic>
 #include <functional>
 #include <memory>
@@ -42,6 +44,7 @@
 #include "src/chunkserver/datastore/chunkserver_snapshot.h"
 #include "src/chunkserver/datastore/define.h"
 #include "src/chunkserver/datastore/file_pool.h"
+#include "src/chunkserver/datastore/sync_fs_group.h"
 #include "src/common/fast_align.h"
 
 namespace curve {
@@ -65,6 +68,12 @@ struct DataStoreMetric;
  * correctedSn: 8 bytes
  * crc: 4 bytes
  * padding: 4075 bytes
+ *
+ * In FORMAT_VERSION_V3, the data checksums are encoded before crc:
+ * checksumBlockSize: 4 bytes
+ * checksum count: 4 bytes
+ * checksum bitmap: (count + 7) / 8 bytes
+ * checksums: 4 * count bytes
  */
 struct ChunkFileMetaPage {
     // File format version
@@ -79,17 +88,37 @@ struct ChunkFileMetaPage {
     // Indicates the state of the page in the current Chunk,
     // if it is not CloneChunk, it is nullptr
     std::shared_ptr<Bitmap> bitmap;
+    // The size of the area covered by one data checksum,
+    // 0 means the chunk keeps no data checksum
+    uint32_t checksumBlockSize;
+    // Indicates whether the checksum of an area is recorded,
+    // the checksum is recorded once the area is written
+    std::shared_ptr<Bitmap> checksumBitmap;
+    // crc32c of every area
+    std::vector<uint32_t> checksums;
 
     ChunkFileMetaPage() : version(FORMAT_VERSION)
                         , sn(0)
                         , correctedSn(0)
                         , location("")
-                        , bitmap(nullptr) {}
+                        , bitmap(nullptr)
+                        , checksumBlockSize(0)
+                        , checksumBitmap(nullptr) {}
     ChunkFileMetaPage(const ChunkFileMetaPage& metaPage);
     ChunkFileMetaPage& operator = (const ChunkFileMetaPage& metaPage);
 
     void encode(char* buf);
     CSErrorCode decode(const char* buf);
+
+    /**
+     * The max size of the encoded metapage
+     * @param locationLimit: the max length of the clone location
+     * @param blockNum: the number of blocks in the chunk
+     * @param checksumNum: the number of data checksums, 0 if none
+     */
+    static size_t MaxEncodedSize(uint32_t locationLimit,
+                                 uint32_t blockNum,
+                                 uint32_t checksumNum);
 };
 
 struct ChunkOptions {
@@ -114,6 +143,16 @@ struct ChunkOptions {
     bool enableOdsyncWhenOpenChunkFile;
     // datastore internal statistical metric
     std::shared_ptr<DataStoreMetric> metric;
+    // How many times a cached crc of a range can be reused before the range
+    // is read from disk again, 0 means the crc is never cached
+    uint32_t crcCacheMaxHits;
+    // The size of the area covered by one data checksum of a new chunk,
+    // 0 means new chunks keep no data checksum. The chunks already created
+    // keep the format they are created with
+    uint32_t checksumBlockSize;
+    // Whether the new snapshots of the chunk are redirect-on-write, the
+    // snapshots already created keep the way they are created with
+    bool enableRedirectOnWrite;
 
     ChunkOptions() : id(0)
                    , sn(0)
@@ -123,7 +162,10 @@ struct ChunkOptions {
                    , chunkSize(0)
                    , blockSize(0)
                    , metaPageSize(0)
-                   , metric(nullptr) {}
+                   , metric(nullptr)
+                   , crcCacheMaxHits(0)
+                   , checksumBlockSize(0)
+                   , enableRedirectOnWrite(false) {}
 };
 
 class CSChunkFile {
@@ -175,6 +217,22 @@ class CSChunkFile {
 
     CSErrorCode Sync();
 
+    /**
+     * Start writing back the dirty pages of the chunk without waiting for
+     * them, a later SyncFs() of any chunk on the same disk makes them
+     * durable, so that the chunks synced together take one syncfs instead
+     * of one fdatasync each
+     * @return: return error code
+     */
+    CSErrorCode WriteBack();
+
+    /**
+     * Sync the file system of the chunk through the group shared by the
+     * chunks of the disk
+     * @return: ChunkNotExistError if the chunk is deleted
+     */
+    CSErrorCode SyncFs(SyncFsGroup* group);
+
     /**
      * Write the copied data into Chunk
      * Only write areas that have not been written, and will not overwrite
@@ -185,7 +243,7 @@ class CSChunkFile {
      * @param length: the length of the data requested for Paste
      * @return: return error code
      */
-    CSErrorCode Paste(const char * buf, off_t offset, size_t length);
+    CSErrorCode Paste(const butil::IOBuf& buf, off_t offset, size_t length);
     /**
      * Read chunk files
      * There may be concurrency, add read lock
@@ -203,6 +261,19 @@ class CSChunkFile {
      * @return: return error code
      */
     CSErrorCode ReadMetaPage(char * buf);
+    /**
+     * Get the crc32 of the data in the specified area of the chunk,
+     * same as crc32 of the data returned by Read.
+     * The crc is cached until the area is written or it has been reused
+     * crcCacheMaxHits times, so that the scan of a rarely written chunk
+     * does not read it from disk every time, and bit rot is still found
+     * when the area is read again.
+     * @param offset: the offset of the area
+     * @param length: the length of the area
+     * @param crc: the crc32 of the area
+     * @return: return error code
+     */
+    CSErrorCode ReadCrc(off_t offset, size_t length, uint32_t* crc);
 
     /**
      * Read the chunk of the specified Sequence
@@ -310,6 +381,34 @@ class CSChunkFile {
      * @return: return error code
      */
     CSErrorCode copy2Snapshot(off_t offset, size_t length);
+    /**
+     * Write the data when the snapshot is redirect-on-write. The pages
+     * written after the snapshot go to the snapshot file, the data of the
+     * snapshot stays in the chunk file
+     * @param sn: write request sequence number
+     * @param buf: data requested to be written
+     * @param offset: the starting offset of the write data area
+     * @param length: the length of the write data area
+     * @return: return error code
+     */
+    CSErrorCode redirect2Snapshot(SequenceNum sn,
+                                  const butil::IOBuf& buf,
+                                  off_t offset,
+                                  size_t length);
+    /**
+     * Read the latest data of the chunk, the redirected pages are read
+     * from the snapshot file of redirect-on-write
+     */
+    CSErrorCode readLatestData(char* buf, off_t offset, size_t length);
+    /**
+     * Write the redirected pages back to the chunk file, so that the
+     * snapshot file of redirect-on-write can be deleted
+     */
+    CSErrorCode mergeSnapshot();
+
+    inline bool isRedirectOnWrite() const {
+        return snapshot_ != nullptr && snapshot_->IsRedirectOnWrite();
+    }
     /**
      * Update the bitmap of the clone chunk
      * If all pages have been written, the clone chunk will be converted
@@ -338,6 +437,26 @@ class CSChunkFile {
         return lfs_->Read(fd_, buf, offset + metaPageSize_, length);
     }
 
+    inline bool hasChecksum() const {
+        return metaPage_.checksumBlockSize > 0;
+    }
+
+    /**
+     * Read data of the chunk, and verify it by data checksums if the chunk
+     * has them. The areas partly read are read entirely in the same io
+     * to be verified.
+     * @return: CrcCheckError if the data doesn't match its checksum
+     */
+    CSErrorCode readVerifiedData(char* buf, off_t offset, size_t length);
+    /**
+     * Calculate the checksums of the areas covered by the data just written,
+     * the unwritten parts of the first and the last areas are read from
+     * disk. The checksums are persisted by flush.
+     */
+    CSErrorCode updateChecksums(const butil::IOBuf& buf,
+                                off_t offset,
+                                size_t length);
+
     inline int writeData(const char* buf, off_t offset, size_t length) {
         int rc = lfs_->Write(fd_, buf, offset + metaPageSize_, length);
         if (rc < 0) {
@@ -393,6 +512,14 @@ class CSChunkFile {
                common::is_aligned(len, blockSize_);
     }
 
+    /**
+     * Drop the cached crcs overlapping with the written area,
+     * called with the write lock held
+     */
+    void invalidateCrc(off_t offset, size_t length);
+    // Drop the cached crcs overlapping with the area, crcMtx_ must be held
+    void eraseCrcLocked(off_t offset, size_t length);
+
     uint64_t MayUpdateWriteLimits(uint64_t write_len) {
         if (write_len > syncThreshold_) {
             return syncChunkLimits_ * 2;
@@ -422,6 +549,9 @@ class CSChunkFile {
     // has been written but has not yet been updated to the
     // page index in the metapage
     std::set<uint32_t> dirtyPages_;
+    // checksums of the written areas not yet updated to the metapage,
+    // area index -> crc
+    std::map<uint32_t, uint32_t> dirtyChecksums_;
     // read-write lock
     RWLock rwLock_;
     // Snapshot file pointer
@@ -434,6 +564,19 @@ class CSChunkFile {
     std::shared_ptr<DataStoreMetric> metric_;
     // enable O_DSYNC When Open ChunkFile
     bool enableOdsyncWhenOpenChunkFile_;
+    // create redirect-on-write snapshots instead of copy-on-write ones
+    bool enableRedirectOnWrite_;
+
+    struct CachedCrc {
+        size_t length;
+        uint32_t crc;
+        uint32_t hits;
+    };
+    uint32_t crcCacheMaxHits_;
+    // Readers holding the read lock update the cache concurrently
+    std::mutex crcMtx_;
+    // offset of the area -> crc of the area
+    std::map<off_t, CachedCrc> crcCache_;
 };
 }  // namespace chunkserver
 }  // namespace curve
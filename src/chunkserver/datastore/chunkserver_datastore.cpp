@@ -22,9 +22,12 @@
 
 #include <gflags/gflags.h>
 #include <fcntl.h>
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <iostream>
 #include <list>
+#include <map>
 #include <memory>
 
 #include "src/chunkserver/datastore/chunkserver_datastore.h"
@@ -34,6 +37,14 @@
 namespace curve {
 namespace chunkserver {
 
+namespace {
+
+// chunk files loaded by all datastores, shows the progress of startup
+bvar::Adder<uint64_t> g_loaded_chunk_files(
+    "chunkserver_datastore_loaded_chunk_files");
+
+}  // namespace
+
 CSDataStore::CSDataStore(std::shared_ptr<LocalFileSystem> lfs,
                          std::shared_ptr<FilePool> chunkFilePool,
                          const DataStoreOptions& options)
@@ -44,16 +55,45 @@ CSDataStore::CSDataStore(std::shared_ptr<LocalFileSystem> lfs,
       baseDir_(options.baseDir),
       chunkFilePool_(chunkFilePool),
       lfs_(lfs),
-      enableOdsyncWhenOpenChunkFile_(options.enableOdsyncWhenOpenChunkFile) {
+      enableOdsyncWhenOpenChunkFile_(options.enableOdsyncWhenOpenChunkFile),
+      loadConcurrency_(options.loadConcurrency),
+      crcCacheMaxHits_(options.crcCacheMaxHits),
+      pageCache_(options.pageCache),
+      checksumBlockSize_(options.checksumBlockSize),
+      enableRedirectOnWrite_(options.enableRedirectOnWrite),
+      syncFsGroup_(options.syncFsGroup) {
     CHECK(!baseDir_.empty()) << "Create datastore failed";
     CHECK(lfs_ != nullptr) << "Create datastore failed";
     CHECK(chunkFilePool_ != nullptr) << "Create datastore failed";
 }
 
 CSDataStore::~CSDataStore() {
+    // the chunks may come back with other data, e.g. after the copyset
+    // is removed and then added to this chunkserver again
+    InvalidatePageCache();
 }
 
 bool CSDataStore::Initialize() {
+    if (checksumBlockSize_ > 0) {
+        if (checksumBlockSize_ % blockSize_ != 0 ||
+            chunkSize_ % checksumBlockSize_ != 0) {
+            LOG(ERROR) << "Invalid checksum block size: " << checksumBlockSize_
+                       << ", block size: " << blockSize_
+                       << ", chunk size: " << chunkSize_;
+            return false;
+        }
+        size_t metaSize = ChunkFileMetaPage::MaxEncodedSize(
+            locationLimit_, chunkSize_ / blockSize_,
+            chunkSize_ / checksumBlockSize_);
+        if (metaSize > metaPageSize_) {
+            LOG(ERROR) << "Data checksums don't fit in the metapage,"
+                       << " checksum block size: " << checksumBlockSize_
+                       << ", metapage size needed: " << metaSize
+                       << ", metapage size: " << metaPageSize_;
+            return false;
+        }
+    }
+
     // Make sure the baseDir directory exists
     if (!lfs_->DirExists(baseDir_.c_str())) {
         int rc = lfs_->Mkdir(baseDir_.c_str());
@@ -71,18 +111,17 @@ bool CSDataStore::Initialize() {
     }
 
     // If loaded before, reload here
+    InvalidatePageCache();
     metaCache_.Clear();
     metric_ = std::make_shared<DataStoreMetric>();
+    // group the files by chunk id, so that a chunk file and its snapshots
+    // are loaded together and different chunks can be loaded concurrently
+    std::map<ChunkID, std::vector<SequenceNum>> chunks;
     for (size_t i = 0; i < files.size(); ++i) {
         FileNameOperator::FileInfo info =
             FileNameOperator::ParseFileName(files[i]);
         if (info.type == FileNameOperator::FileType::CHUNK) {
-            // If the chunk file has not been loaded yet, load it to metaCache
-            CSErrorCode errorCode = loadChunkFile(info.id);
-            if (errorCode != CSErrorCode::Success) {
-                LOG(ERROR) << "Load chunk file failed: " << files[i];
-                return false;
-            }
+            chunks.emplace(info.id, std::vector<SequenceNum>());
         } else if (info.type == FileNameOperator::FileType::SNAPSHOT) {
             string chunkFilePath = baseDir_ + "/" +
                         FileNameOperator::GenerateChunkFileName(info.id);
@@ -93,23 +132,16 @@ bool CSDataStore::Initialize() {
                              << files[i] << "' chunk.";
                 continue;
             }
-            // If the chunk file exists, load the chunk file to metaCache first
-            CSErrorCode errorCode = loadChunkFile(info.id);
-            if (errorCode != CSErrorCode::Success) {
-                LOG(ERROR) << "Load chunk file failed.";
-                return false;
-            }
-
-            // Load snapshot to memory
-            errorCode = metaCache_.Get(info.id)->LoadSnapshot(info.sn);
-            if (errorCode != CSErrorCode::Success) {
-                LOG(ERROR) << "Load snapshot failed.";
-                return false;
-            }
+            chunks[info.id].push_back(info.sn);
         } else {
             LOG(WARNING) << "Unknown file: " << files[i];
         }
     }
+
+    std::vector<ChunkLoadTask> tasks(chunks.begin(), chunks.end());
+    if (!loadChunks(tasks)) {
+        return false;
+    }
     LOG(INFO) << "Initialize data store success.";
     return true;
 }
@@ -124,6 +156,9 @@ CSErrorCode CSDataStore::DeleteChunk(ChunkID id, SequenceNum sn) {
             return errorCode;
         }
         metaCache_.Remove(id);
+        if (pageCache_ != nullptr) {
+            pageCache_->InvalidateChunk(id, chunkSize_);
+        }
     }
     return CSErrorCode::Success;
 }
@@ -154,12 +189,44 @@ CSErrorCode CSDataStore::ReadChunk(ChunkID id,
         return CSErrorCode::ChunkNotExistError;
     }
 
+    bool cacheable = pageCache_ != nullptr && pageCache_->Cacheable(length);
+    uint64_t version = 0;
+    if (cacheable) {
+        if (pageCache_->Read(id, buf, offset, length)) {
+            return CSErrorCode::Success;
+        }
+        version = pageCache_->GetVersion(id);
+    }
+
     CSErrorCode errorCode = chunkFile->Read(buf, offset, length);
     if (errorCode != CSErrorCode::Success) {
         LOG(WARNING) << "Read chunk file failed."
                      << "ChunkID = " << id;
         return errorCode;
     }
+    if (cacheable) {
+        pageCache_->Fill(id, version, buf, offset, length);
+    }
+    return CSErrorCode::Success;
+}
+
+CSErrorCode CSDataStore::ReadChunkCrc(ChunkID id,
+                                      SequenceNum sn,
+                                      off_t offset,
+                                      size_t length,
+                                      uint32_t* crc) {
+    (void)sn;
+    auto chunkFile = metaCache_.Get(id);
+    if (chunkFile == nullptr) {
+        return CSErrorCode::ChunkNotExistError;
+    }
+
+    CSErrorCode errorCode = chunkFile->ReadCrc(offset, length, crc);
+    if (errorCode != CSErrorCode::Success) {
+        LOG(WARNING) << "Read chunk crc failed."
+                     << "ChunkID = " << id;
+        return errorCode;
+    }
     return CSErrorCode::Success;
 }
 
@@ -254,6 +321,9 @@ CSErrorCode CSDataStore::WriteChunk(ChunkID id,
         options.blockSize = blockSize_;
         options.metaPageSize = metaPageSize_;
         options.metric = metric_;
+        options.crcCacheMaxHits = crcCacheMaxHits_;
+        options.checksumBlockSize = checksumBlockSize_;
+        options.enableRedirectOnWrite = enableRedirectOnWrite_;
         options.enableOdsyncWhenOpenChunkFile = enableOdsyncWhenOpenChunkFile_;
         CSErrorCode errorCode = CreateChunkFile(options, &chunkFile);
         if (errorCode != CSErrorCode::Success) {
@@ -266,6 +336,10 @@ CSErrorCode CSDataStore::WriteChunk(ChunkID id,
                                              offset,
                                              length,
                                              cost);
+    // invalidate even if the write failed, the data may be partly written
+    if (pageCache_ != nullptr) {
+        pageCache_->Invalidate(id, offset, length);
+    }
     if (errorCode != CSErrorCode::Success) {
         LOG(WARNING) << "Write chunk file failed."
                      << "ChunkID = " << id;
@@ -289,6 +363,44 @@ CSErrorCode CSDataStore::SyncChunk(ChunkID id) {
     return CSErrorCode::Success;
 }
 
+CSErrorCode CSDataStore::SyncChunks(const std::vector<ChunkID>& ids) {
+    CSErrorCode errorCode;
+    if (syncFsGroup_ == nullptr) {
+        for (ChunkID id : ids) {
+            errorCode = SyncChunk(id);
+            if (errorCode != CSErrorCode::Success) {
+                return errorCode;
+            }
+        }
+        return CSErrorCode::Success;
+    }
+
+    std::vector<CSChunkFilePtr> chunkFiles;
+    chunkFiles.reserve(ids.size());
+    for (ChunkID id : ids) {
+        auto chunkFile = metaCache_.Get(id);
+        if (chunkFile == nullptr) {
+            continue;
+        }
+        errorCode = chunkFile->WriteBack();
+        if (errorCode != CSErrorCode::Success) {
+            LOG(WARNING) << "Write back chunk file failed."
+                         << "ChunkID = " << id;
+            return errorCode;
+        }
+        chunkFiles.push_back(chunkFile);
+    }
+    // sync through any chunk still open, the deleted ones have nothing
+    // to keep
+    for (auto it = chunkFiles.rbegin(); it != chunkFiles.rend(); ++it) {
+        errorCode = (*it)->SyncFs(syncFsGroup_.get());
+        if (errorCode != CSErrorCode::ChunkNotExistError) {
+            return errorCode;
+        }
+    }
+    return CSErrorCode::Success;
+}
+
 CSErrorCode CSDataStore::CreateCloneChunk(ChunkID id,
                                           SequenceNum sn,
                                           SequenceNum correctedSn,
@@ -319,6 +431,9 @@ CSErrorCode CSDataStore::CreateCloneChunk(ChunkID id,
         options.blockSize = blockSize_;
         options.metaPageSize = metaPageSize_;
         options.metric = metric_;
+        options.crcCacheMaxHits = crcCacheMaxHits_;
+        options.checksumBlockSize = checksumBlockSize_;
+        options.enableRedirectOnWrite = enableRedirectOnWrite_;
         CSErrorCode errorCode = CreateChunkFile(options, &chunkFile);
         if (errorCode != CSErrorCode::Success) {
             return errorCode;
@@ -349,7 +464,7 @@ CSErrorCode CSDataStore::CreateCloneChunk(ChunkID id,
 }
 
 CSErrorCode CSDataStore::PasteChunk(ChunkID id,
-                                    const char * buf,
+                                    const butil::IOBuf& buf,
                                     off_t offset,
                                     size_t length) {
     auto chunkFile = metaCache_.Get(id);
@@ -360,6 +475,9 @@ CSErrorCode CSDataStore::PasteChunk(ChunkID id,
         return CSErrorCode::ChunkNotExistError;
     }
     CSErrorCode errcode = chunkFile->Paste(buf, offset, length);
+    if (pageCache_ != nullptr) {
+        pageCache_->Invalidate(id, offset, length);
+    }
     if (errcode != CSErrorCode::Success) {
         LOG(WARNING) << "Paste Chunk failed, Chunk not exists."
                      << "ChunkID = " << id;
@@ -412,6 +530,9 @@ CSErrorCode CSDataStore::loadChunkFile(ChunkID id) {
         options.blockSize = blockSize_;
         options.metaPageSize = metaPageSize_;
         options.metric = metric_;
+        options.crcCacheMaxHits = crcCacheMaxHits_;
+        options.checksumBlockSize = checksumBlockSize_;
+        options.enableRedirectOnWrite = enableRedirectOnWrite_;
         CSChunkFilePtr chunkFilePtr =
             std::make_shared<CSChunkFile>(lfs_,
                                           chunkFilePool_,
@@ -424,9 +545,84 @@ CSErrorCode CSDataStore::loadChunkFile(ChunkID id) {
     return CSErrorCode::Success;
 }
 
+CSErrorCode CSDataStore::loadChunk(const ChunkLoadTask& task) {
+    // If the chunk file exists, load the chunk file to metaCache first
+    CSErrorCode errorCode = loadChunkFile(task.first);
+    if (errorCode != CSErrorCode::Success) {
+        LOG(ERROR) << "Load chunk file failed, ChunkID = " << task.first;
+        return errorCode;
+    }
+    g_loaded_chunk_files << 1;
+
+    // Load snapshot to memory
+    for (SequenceNum sn : task.second) {
+        errorCode = metaCache_.Get(task.first)->LoadSnapshot(sn);
+        if (errorCode != CSErrorCode::Success) {
+            LOG(ERROR) << "Load snapshot failed, ChunkID = " << task.first
+                       << ", sn = " << sn;
+            return errorCode;
+        }
+    }
+    return CSErrorCode::Success;
+}
+
+bool CSDataStore::loadChunks(const std::vector<ChunkLoadTask>& tasks) {
+    const size_t threadNum = std::min<size_t>(
+        std::max<uint32_t>(loadConcurrency_, 1), tasks.size());
+    if (threadNum <= 1) {
+        for (const auto& task : tasks) {
+            if (loadChunk(task) != CSErrorCode::Success) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // every thread takes the next chunk until all chunks are loaded or
+    // any of them fails, metaCache is safe for concurrent Set
+    std::atomic<size_t> next(0);
+    std::atomic<bool> failed(false);
+    auto worker = [&]() {
+        while (!failed.load(std::memory_order_relaxed)) {
+            size_t i = next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= tasks.size()) {
+                break;
+            }
+            if (loadChunk(tasks[i]) != CSErrorCode::Success) {
+                failed.store(true, std::memory_order_relaxed);
+            }
+        }
+    };
+    std::vector<curve::common::Thread> threads;
+    threads.reserve(threadNum);
+    for (size_t i = 0; i < threadNum; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    LOG(INFO) << "Loaded " << tasks.size() << " chunks of " << baseDir_
+              << " with " << threadNum << " threads"
+              << (failed.load() ? " failed" : "");
+    return !failed.load();
+}
+
+void CSDataStore::InvalidatePageCache() {
+    if (pageCache_ == nullptr) {
+        return;
+    }
+    metaCache_.ForEach([this](ChunkID id, const CSChunkFilePtr&) {
+        pageCache_->InvalidateChunk(id, chunkSize_);
+    });
+}
+
 ChunkMap CSDataStore::GetChunkMap() {
     return metaCache_.GetMap();
 }
 
+void CSDataStore::ForEachChunk(const ChunkVisitor& visitor) {
+    metaCache_.ForEach(visitor);
+}
+
 }  // namespace chunkserver
 }  // namespace curve
@@ -26,7 +26,10 @@
 #include <bvar/bvar.h>
 #include <glog/logging.h>
 #include <butil/iobuf.h>
+#include <array>
+#include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 #include <unordered_map>
 #include <memory>
@@ -38,7 +41,9 @@
 #include "src/common/concurrent/concurrent.h"
 #include "src/chunkserver/datastore/define.h"
 #include "src/chunkserver/datastore/chunkserver_chunkfile.h"
+#include "src/chunkserver/datastore/chunk_page_cache.h"
 #include "src/chunkserver/datastore/file_pool.h"
+#include "src/chunkserver/datastore/sync_fs_group.h"
 #include "src/fs/local_filesystem.h"
 
 namespace curve {
@@ -55,6 +60,9 @@ inline void TrivialDeleter(void* /*ptr*/) {}
  * chunkSize: The size of the chunk file or snapshot file in the DataStore
  * blockSize: the size of the smallest read-write unit
  * metaPageSize: meta page size for chunk
+ * loadConcurrency: number of threads loading chunk files in Initialize
+ * pageCache: cache of chunk pages shared by all datastores, nullptr means
+ *            reads always go to the chunk files
  */
 struct DataStoreOptions {
     std::string                         baseDir;
@@ -63,6 +71,20 @@ struct DataStoreOptions {
     PageSizeType                        metaPageSize;
     uint32_t                            locationLimit;
     bool                                enableOdsyncWhenOpenChunkFile;
+    uint32_t                            loadConcurrency = 1;
+    // times a cached crc of a chunk area can be reused by scan,
+    // 0 means not to cache the crc
+    uint32_t                            crcCacheMaxHits = 0;
+    std::shared_ptr<ChunkPageCache>     pageCache;
+    // size of the area covered by one data checksum of the new chunks,
+    // 0 means not to keep data checksums
+    uint32_t                            checksumBlockSize = 0;
+    // create redirect-on-write snapshots of the chunks instead of
+    // copy-on-write ones
+    bool                                enableRedirectOnWrite = false;
+    // syncfs group of the disk, SyncChunks() syncs the chunks one by one
+    // if it's nullptr
+    std::shared_ptr<SyncFsGroup>        syncFsGroup;
 };
 
 /**
@@ -96,46 +118,83 @@ using DataStoreMetricPtr = std::shared_ptr<DataStoreMetric>;
 using ChunkMap = std::unordered_map<ChunkID, CSChunkFilePtr>;
 // For the mapping from chunkid to chunkfile,
 // use read-write lock to protect the map operation
+using ChunkVisitor = std::function<void(ChunkID, const CSChunkFilePtr&)>;
+
+/**
+ * The chunk files of a copyset, sharded by chunk id so that the chunks
+ * created or deleted concurrently rarely contend on one lock, and a walk
+ * over all the chunks only holds one shard at a time.
+ */
 class CSMetaCache {
  public:
     CSMetaCache() : cvar_(nullptr),
         sumChunkRate_(std::make_shared<std::atomic<uint64_t>>()) {}
     virtual ~CSMetaCache() {}
 
+    /**
+     * Copy of all the chunks, prefer ForEach() unless the chunks are kept
+     */
     ChunkMap GetMap() {
-        ReadLockGuard readGuard(rwLock_);
-        return chunkMap_;
+        ChunkMap chunkMap;
+        ForEach([&chunkMap](ChunkID id, const CSChunkFilePtr& chunkFile) {
+            chunkMap.emplace(id, chunkFile);
+        });
+        return chunkMap;
+    }
+
+    /**
+     * Visit all the chunks. Each shard is snapshotted under its lock and
+     * visited without it, so the visitor never blocks the writers and may
+     * call back into the cache. A chunk added or removed during the walk
+     * may or may not be visited.
+     */
+    void ForEach(const ChunkVisitor& visitor) {
+        std::vector<std::pair<ChunkID, CSChunkFilePtr>> chunks;
+        for (auto& shard : shards_) {
+            chunks.clear();
+            {
+                ReadLockGuard readGuard(shard.rwLock);
+                chunks.assign(shard.chunkMap.begin(), shard.chunkMap.end());
+            }
+            for (const auto& chunk : chunks) {
+                visitor(chunk.first, chunk.second);
+            }
+        }
     }
 
     CSChunkFilePtr Get(ChunkID id) {
-        ReadLockGuard readGuard(rwLock_);
-        if (chunkMap_.find(id) == chunkMap_.end()) {
+        Shard& shard = GetShard(id);
+        ReadLockGuard readGuard(shard.rwLock);
+        auto it = shard.chunkMap.find(id);
+        if (it == shard.chunkMap.end()) {
             return nullptr;
         }
-        return chunkMap_[id];
+        return it->second;
     }
 
     CSChunkFilePtr Set(ChunkID id, CSChunkFilePtr chunkFile) {
-        WriteLockGuard writeGuard(rwLock_);
-       // When two write requests are concurrently created to create a chunk
-       // file, return the first set chunkFile
-        if (chunkMap_.find(id) == chunkMap_.end()) {
+        Shard& shard = GetShard(id);
+        WriteLockGuard writeGuard(shard.rwLock);
+        // When two write requests are concurrently created to create a chunk
+        // file, return the first set chunkFile
+        auto ret = shard.chunkMap.emplace(id, chunkFile);
+        if (ret.second) {
             chunkFile->SetSyncInfo(sumChunkRate_, cvar_);
-            chunkMap_[id] = chunkFile;
         }
-        return chunkMap_[id];
+        return ret.first->second;
     }
 
     void Remove(ChunkID id) {
-        WriteLockGuard writeGuard(rwLock_);
-        if (chunkMap_.find(id) != chunkMap_.end()) {
-            chunkMap_.erase(id);
-        }
+        Shard& shard = GetShard(id);
+        WriteLockGuard writeGuard(shard.rwLock);
+        shard.chunkMap.erase(id);
     }
 
     void Clear() {
-        WriteLockGuard writeGuard(rwLock_);
-        chunkMap_.clear();
+        for (auto& shard : shards_) {
+            WriteLockGuard writeGuard(shard.rwLock);
+            shard.chunkMap.clear();
+        }
     }
 
     void SetCondPtr(std::shared_ptr<std::condition_variable> cond) {
@@ -147,12 +206,23 @@ class CSMetaCache {
         CSChunkFile::syncThreshold_ = threshold;
     }
 
+ private:
+    struct Shard {
+        RWLock      rwLock;
+        ChunkMap    chunkMap;
+    };
+
+    static constexpr uint32_t kShardNum = 32;
+
+    Shard& GetShard(ChunkID id) {
+        return shards_[id % kShardNum];
+    }
+
  private:
     std::shared_ptr<std::condition_variable> cvar_;
     // sum of all chunks rate
     std::shared_ptr<std::atomic<uint64_t>> sumChunkRate_;
-    RWLock      rwLock_;
-    ChunkMap    chunkMap_;
+    std::array<Shard, kShardNum> shards_;
 };
 
 class CSDataStore {
@@ -218,6 +288,22 @@ class CSDataStore {
                                           SequenceNum sn,
                                           char * buf);
 
+    /**
+     * Get the crc32 of the data in the specified area of the current chunk,
+     * the crc may be cached by the chunk file until the area is written
+     * @param id: the chunk id to be read
+     * @param sn: used to record trace, not used in actual logic processing
+     * @param offset: the logical offset of the area in the chunk
+     * @param length: the length of the area
+     * @param crc: the crc32 of the area
+     * @return: return error code
+     */
+    virtual CSErrorCode ReadChunkCrc(ChunkID id,
+                                     SequenceNum sn,
+                                     off_t offset,
+                                     size_t length,
+                                     uint32_t* crc);
+
     /**
      * Read the data of the specified sequence, it may read the current
      * chunk file, or it may read the snapshot file
@@ -257,6 +343,13 @@ class CSDataStore {
 
     virtual CSErrorCode SyncChunk(ChunkID id);
 
+    /**
+     * Sync the chunks together, start writing back all of them and then
+     * make them durable by one syncfs shared with the other copysets of
+     * the disk, the chunks not exist are skipped
+     */
+    virtual CSErrorCode SyncChunks(const std::vector<ChunkID>& ids);
+
 
     // Deprecated, only use for unit & integration test
     virtual CSErrorCode WriteChunk(
@@ -299,9 +392,20 @@ class CSDataStore {
      * @return: return error code
      */
     virtual CSErrorCode PasteChunk(ChunkID id,
-                                   const char* buf,
+                                   const butil::IOBuf& buf,
                                    off_t offset,
                                    size_t length);
+
+    // Deprecated, only use for unit & integration test
+    virtual CSErrorCode PasteChunk(ChunkID id,
+                                   const char* buf,
+                                   off_t offset,
+                                   size_t length) {
+        butil::IOBuf data;
+        data.append_user_data(const_cast<char*>(buf), length, TrivialDeleter);
+
+        return PasteChunk(id, data, offset, length);
+    }
     /**
      * Get detailed information about Chunk
      * @param id: the id of the chunk requested
@@ -328,6 +432,12 @@ class CSDataStore {
 
     virtual ChunkMap GetChunkMap();
 
+    /**
+     * Visit all the chunks without copying the whole chunk map,
+     * see CSMetaCache::ForEach()
+     */
+    virtual void ForEachChunk(const ChunkVisitor& visitor);
+
     void SetCacheCondPtr(std::shared_ptr<std::condition_variable> cond) {
         metaCache_.SetCondPtr(cond);
     }
@@ -337,9 +447,18 @@ class CSDataStore {
     }
 
  private:
+    // chunk id and the sequence numbers of its snapshots
+    using ChunkLoadTask = std::pair<ChunkID, std::vector<SequenceNum>>;
+
     CSErrorCode loadChunkFile(ChunkID id);
+    // load the chunk file and its snapshots to metaCache
+    CSErrorCode loadChunk(const ChunkLoadTask& task);
+    // load chunks with loadConcurrency_ threads
+    bool loadChunks(const std::vector<ChunkLoadTask>& tasks);
     CSErrorCode CreateChunkFile(const ChunkOptions & ops,
                                 CSChunkFilePtr* chunkFile);
+    // drop the cached pages of all chunks loaded by this datastore
+    void InvalidatePageCache();
 
  private:
     // The size of each chunk
@@ -362,6 +481,18 @@ class CSDataStore {
     DataStoreMetricPtr metric_;
     // enable O_DSYNC When Open ChunkFile
     bool enableOdsyncWhenOpenChunkFile_;
+    // number of threads loading chunk files in Initialize
+    uint32_t loadConcurrency_;
+    // times a cached crc of a chunk area can be reused
+    uint32_t crcCacheMaxHits_;
+    // cache of chunk pages, nullptr if not enabled
+    std::shared_ptr<ChunkPageCache> pageCache_;
+    // size of the area covered by one data checksum of the new chunks
+    uint32_t checksumBlockSize_;
+    // create redirect-on-write snapshots of the chunks
+    bool enableRedirectOnWrite_;
+    // syncfs group of the disk, nullptr if not enabled
+    std::shared_ptr<SyncFsGroup> syncFsGroup_;
 };
 
 }  // namespace chunkserver
@@ -70,7 +70,7 @@ CSErrorCode SnapshotMetaPage::decode(const char* buf) {
 
     // TODO(yyk) judge version compatibility, simple processing at present,
     // detailed implementation later
-    if (version != FORMAT_VERSION) {
+    if (version != FORMAT_VERSION && version != FORMAT_VERSION_ROW) {
         LOG(ERROR) << "File format version incompatible."
                     << "file version: "
                     << static_cast<uint32_t>(version)
@@ -116,12 +116,18 @@ CSSnapshot::CSSnapshot(std::shared_ptr<LocalFileSystem> lfs,
       baseDir_(options.baseDir),
       lfs_(lfs),
       chunkFilePool_(chunkFilePool),
-      metric_(options.metric) {
+      metric_(options.metric),
+      enableOdsyncWhenOpenChunkFile_(options.enableOdsyncWhenOpenChunkFile) {
     CHECK(!baseDir_.empty()) << "Create snapshot failed";
     CHECK(lfs_ != nullptr) << "Create snapshot failed";
     uint32_t bits = size_ / blockSize_;
     metaPage_.bitmap = std::make_shared<Bitmap>(bits);
     metaPage_.sn = options.sn;
+    // Only used when the snapshot file is created, the metapage loaded
+    // from an existing snapshot file overrides it
+    if (options.enableRedirectOnWrite) {
+        metaPage_.version = FORMAT_VERSION_ROW;
+    }
     if (metric_ != nullptr) {
         metric_->snapshotCount << 1;
     }
@@ -177,7 +183,25 @@ CSErrorCode CSSnapshot::Open(bool createFile) {
                    << ",filesize = " << fileInfo.st_size;
         return CSErrorCode::FileFormatError;
     }
-    return loadMetaPage();
+    CSErrorCode errorCode = loadMetaPage();
+    if (errorCode != CSErrorCode::Success) {
+        return errorCode;
+    }
+    // The snapshot of redirect-on-write keeps the latest data of the chunk,
+    // it is written as often as the chunk file, so it is opened the same way
+    // as the chunk file and synced together with the chunk file
+    if (IsRedirectOnWrite() && !enableOdsyncWhenOpenChunkFile_) {
+        lfs_->Close(fd_);
+        fd_ = -1;
+        rc = lfs_->Open(snapshotPath, O_RDWR|O_NOATIME);
+        if (rc < 0) {
+            LOG(ERROR) << "Error occured when opening file."
+                       << " filepath = "<< snapshotPath;
+            return CSErrorCode::InternalError;
+        }
+        fd_ = rc;
+    }
+    return CSErrorCode::Success;
 }
 
 CSErrorCode CSSnapshot::Read(char * buf, off_t offset, size_t length) {
@@ -218,15 +242,62 @@ CSErrorCode CSSnapshot::Write(const char * buf, off_t offset, size_t length) {
                    << ",snapshot sn: " << metaPage_.sn;
         return CSErrorCode::InternalError;
     }
+    markDirtyPages(offset, length);
+    return CSErrorCode::Success;
+}
+
+CSErrorCode CSSnapshot::Write(const butil::IOBuf& buf,
+                              off_t offset,
+                              size_t length) {
+    int rc = writeData(buf, offset, length);
+    if (rc < 0) {
+        LOG(ERROR) << "Write snapshot failed."
+                   << "ChunkID: " << chunkId_
+                   << ",snapshot sn: " << metaPage_.sn;
+        return CSErrorCode::InternalError;
+    }
+    markDirtyPages(offset, length);
+    return CSErrorCode::Success;
+}
+
+void CSSnapshot::markDirtyPages(off_t offset, size_t length) {
     uint32_t pageBeginIndex = offset / blockSize_;
     uint32_t pageEndIndex = (offset + length - 1) / blockSize_;
     for (uint32_t i = pageBeginIndex; i <= pageEndIndex; ++i) {
-        dirtyPages_.insert(i);
+        if (!metaPage_.bitmap->Test(i)) {
+            dirtyPages_.insert(i);
+        }
+    }
+}
+
+CSErrorCode CSSnapshot::Sync() {
+    int rc = lfs_->Sync(fd_);
+    if (rc < 0) {
+        LOG(ERROR) << "Sync snapshot failed."
+                   << "ChunkID: " << chunkId_
+                   << ",snapshot sn: " << metaPage_.sn;
+        return CSErrorCode::InternalError;
+    }
+    return CSErrorCode::Success;
+}
+
+CSErrorCode CSSnapshot::WriteBack() {
+    int rc = lfs_->SyncFileRange(fd_, 0, 0);
+    if (rc < 0) {
+        LOG(ERROR) << "Write back snapshot failed."
+                   << "ChunkID: " << chunkId_
+                   << ",snapshot sn: " << metaPage_.sn;
+        return CSErrorCode::InternalError;
     }
     return CSErrorCode::Success;
 }
 
 CSErrorCode CSSnapshot::Flush() {
+    // The pages rewritten after they are in the bitmap don't change
+    // the metapage
+    if (dirtyPages_.empty()) {
+        return CSErrorCode::Success;
+    }
     SnapshotMetaPage tempMeta = metaPage_;
     for (auto pageIndex : dirtyPages_) {
         tempMeta.bitmap->Set(pageIndex);
@@ -100,6 +100,7 @@ class CSSnapshot {
      * @return: return error code
      */
     CSErrorCode Write(const char * buf, off_t offset, size_t length);
+    CSErrorCode Write(const butil::IOBuf& buf, off_t offset, size_t length);
     /**
      * Read the snapshot data, according to the bitmap to determine whether to read the data from the chunk file
      * @param buf: Snapshot data read
@@ -120,6 +121,19 @@ class CSSnapshot {
      * and the error code is a negative number
      */
     CSErrorCode Flush();
+    /**
+     * Sync the data of the snapshot file to disk, only the snapshot of
+     * redirect-on-write needs it, the other snapshot files are opened
+     * with O_DSYNC
+     * @return: return error code
+     */
+    CSErrorCode Sync();
+    /**
+     * Start writing back the dirty pages of the snapshot file without
+     * waiting for them, see CSChunkFile::WriteBack()
+     * @return: return error code
+     */
+    CSErrorCode WriteBack();
     /**
      * Get the snapshot sequence number
      * @return: Return the snapshot sequence number
@@ -130,6 +144,15 @@ class CSSnapshot {
      * @return: return bitmap
      */
     std::shared_ptr<const Bitmap> GetPageStatus() const;
+    /**
+     * Whether the snapshot is redirect-on-write. If so, the snapshot file
+     * keeps the pages written after the snapshot and the data of the
+     * snapshot stays in the chunk file, the pages in the bitmap are the
+     * redirected ones
+     */
+    bool IsRedirectOnWrite() const {
+        return metaPage_.version == FORMAT_VERSION_ROW;
+    }
 
  private:
     /**
@@ -170,6 +193,14 @@ class CSSnapshot {
         return lfs_->Write(fd_, buf, offset + metaPageSize_, length);
     }
 
+    inline int writeData(const butil::IOBuf& buf, off_t offset,
+                         size_t length) {
+        return lfs_->Write(fd_, buf, offset + metaPageSize_, length);
+    }
+
+    // Record the written pages, they are added to the bitmap by Flush
+    void markDirtyPages(off_t offset, size_t length);
+
  private:
     // Snapshot file descriptor
     int fd_;
@@ -194,6 +225,9 @@ class CSSnapshot {
     std::shared_ptr<FilePool> chunkFilePool_;
     // datastore internal statistical indicators
     std::shared_ptr<DataStoreMetric> metric_;
+    // open the snapshot file of redirect-on-write with O_DSYNC,
+    // the same as the chunk file
+    bool enableOdsyncWhenOpenChunkFile_;
 };
 
 }  // namespace chunkserver
@@ -38,6 +38,11 @@ using curve::common::Bitmap;
 // otherwise, the version is 1
 const uint8_t FORMAT_VERSION = 1;
 const uint8_t FORMAT_VERSION_V2 = 2;
+// Zeroed chunk file keeping checksums of its data in the metapage
+const uint8_t FORMAT_VERSION_V3 = 3;
+// Snapshot file of redirect-on-write, it keeps the data written after the
+// snapshot, while the data of the snapshot stays in the chunk file
+const uint8_t FORMAT_VERSION_ROW = 4;
 const SequenceNum kInvalidSeq = 0;
 
 // define error code
@@ -44,6 +44,7 @@
 #include "src/common/curve_define.h"
 #include "src/common/string_util.h"
 #include "src/common/throttle.h"
+#include "src/common/timeutility.h"
 
 using curve::common::kFilePoolMagic;
 DEFINE_int64(formatInterval, 100, "Sets a interval between formatting.");
@@ -60,6 +61,7 @@ const uint32_t FilePoolHelper::kPersistSize = 4096;
 const std::string FilePool::kCleanChunkSuffix_ = ".clean";  // NOLINT
 const std::chrono::milliseconds FilePool::kSuccessSleepMsec_(10);
 const std::chrono::milliseconds FilePool::kFailSleepMsec_(500);
+const uint32_t FilePool::kCleanAdjustSamples_ = 32;
 
 using ::curve::common::kDefaultBlockSize;
 
@@ -213,7 +215,10 @@ int FilePoolHelper::DecodeMetaInfoFromMetaFile(
 }
 
 FilePool::FilePool(std::shared_ptr<LocalFileSystem> fsptr)
-    : currentmaxfilenum_(0) {
+    : currentmaxfilenum_(0),
+      cleanIops_(0),
+      cleanLatencySamples_(0),
+      cleanLatencySumUs_(0) {
     CHECK(fsptr != nullptr) << "fs ptr allocate failed!";
     fsptr_ = fsptr;
     cleanAlived_ = false;
@@ -311,13 +316,20 @@ bool FilePool::CleanChunk(uint64_t chunkid, bool onlyMarked) {
     std::shared_ptr<void> _(nullptr, defer);
 
     uint64_t chunklen = poolOpt_.fileSize + poolOpt_.metaPageSize;
-    if (onlyMarked) {
-        ret = fsptr_->Fallocate(fd, FALLOC_FL_ZERO_RANGE, 0, chunklen);
-        if (ret < 0) {
+    if (onlyMarked || poolOpt_.cleanWithZeroRange) {
+        ret = zeroRangeUnsupported_.load()
+                  ? -EOPNOTSUPP
+                  : fsptr_->Fallocate(fd, FALLOC_FL_ZERO_RANGE, 0, chunklen);
+        if (ret == -EOPNOTSUPP && !zeroRangeUnsupported_.exchange(true)) {
+            LOG(WARNING) << "FALLOC_FL_ZERO_RANGE is not supported by "
+                         << currentdir_ << ", clean chunks by writing zeros";
+        }
+        if (ret < 0 && onlyMarked) {
             LOG(ERROR) << "Fallocate file failed: " << chunkpath;
             return false;
         }
-    } else {
+    }
+    if (!onlyMarked && (!poolOpt_.cleanWithZeroRange || ret < 0)) {
         int nbytes;
         uint64_t nwrite = 0;
         uint64_t ntotal = chunklen;
@@ -325,6 +337,7 @@ bool FilePool::CleanChunk(uint64_t chunkid, bool onlyMarked) {
         char *buffer = writeBuffer_.get();
 
         while (nwrite < ntotal) {
+            uint64_t startUs = curve::common::TimeUtility::GetTimeofDayUs();
             nbytes = fsptr_->Write(
                 fd, buffer, nwrite,
                 std::min(ntotal - nwrite, (uint64_t)bytesPerWrite));
@@ -335,6 +348,8 @@ bool FilePool::CleanChunk(uint64_t chunkid, bool onlyMarked) {
                 LOG(ERROR) << "Fsync file failed: " << chunkpath;
                 return false;
             }
+            AdjustCleanThrottle(
+                curve::common::TimeUtility::GetTimeofDayUs() - startUs);
 
             cleanThrottle_.Add(false, bytesPerWrite);
             nwrite += nbytes;
@@ -352,44 +367,64 @@ bool FilePool::CleanChunk(uint64_t chunkid, bool onlyMarked) {
 }
 
 bool FilePool::CleaningChunk() {
-    auto popBack = [this](std::vector<uint64_t> *chunks,
-                          uint64_t *chunksLeft) -> uint64_t {
-        std::unique_lock<std::mutex> lk(mtx_);
-        if (chunks->empty()) {
-            return 0;
-        }
-
-        uint64_t chunkid = chunks->back();
-        chunks->pop_back();
-        (*chunksLeft)--;
-        currentState_.preallocatedChunksLeft--;
-        return chunkid;
-    };
-
-    auto pushBack = [this](std::vector<uint64_t> *chunks, uint64_t chunkid,
-                           uint64_t *chunksLeft) {
-        std::unique_lock<std::mutex> lk(mtx_);
-        chunks->push_back(chunkid);
-        (*chunksLeft)++;
-        currentState_.preallocatedChunksLeft++;
-    };
+    // Enough clean chunks are kept, the rest are cleaned on demand
+    if (poolOpt_.cleanWatermark > 0 &&
+        freeChunks_.Size(true) >= poolOpt_.cleanWatermark) {
+        return false;
+    }
 
-    uint64_t chunkid = popBack(&dirtyChunks_, &currentState_.dirtyChunksLeft);
-    if (0 == chunkid) {
+    uint64_t chunkid = 0;
+    if (!freeChunks_.Pop(false, &chunkid)) {
         return false;
     }
 
     // Fill zero to specify chunk
     if (!CleanChunk(chunkid, false)) {
-        pushBack(&dirtyChunks_, chunkid, &currentState_.dirtyChunksLeft);
+        freeChunks_.Push(chunkid, false);
         return false;
     }
 
     LOG(INFO) << "Clean chunk success, chunkid: " << chunkid;
-    pushBack(&cleanChunks_, chunkid, &currentState_.cleanChunksLeft);
+    freeChunks_.Push(chunkid, true);
     return true;
 }
 
+void FilePool::AdjustCleanThrottle(uint64_t latencyUs) {
+    if (poolOpt_.cleanLatencyThresholdUs == 0) {
+        return;
+    }
+
+    cleanLatencySumUs_ += latencyUs;
+    if (++cleanLatencySamples_ < kCleanAdjustSamples_) {
+        return;
+    }
+
+    uint64_t avgLatencyUs = cleanLatencySumUs_ / cleanLatencySamples_;
+    cleanLatencySamples_ = 0;
+    cleanLatencySumUs_ = 0;
+
+    // Decrease multiplicatively when the disk is busy, and increase
+    // additively when it isn't, so cleaning yields to foreground I/O
+    uint32_t iops = cleanIops_;
+    if (avgLatencyUs > poolOpt_.cleanLatencyThresholdUs) {
+        iops = std::max<uint32_t>(iops / 2, 1);
+    } else {
+        uint32_t step = std::max<uint32_t>(poolOpt_.iops4clean / 10, 1);
+        iops = poolOpt_.iops4clean - iops > step ? iops + step
+                                                 : poolOpt_.iops4clean;
+    }
+    if (iops == cleanIops_) {
+        return;
+    }
+
+    LOG(INFO) << "Adjust clean iops from " << cleanIops_ << " to " << iops
+              << ", average latency of cleaning = " << avgLatencyUs << "us";
+    cleanIops_ = iops;
+    ReadWriteThrottleParams params;
+    params.iopsTotal = ThrottleParams(cleanIops_, 0, 0);
+    cleanThrottle_.UpdateThrottleParams(params);
+}
+
 void FilePool::CleanWorker() {
     auto sleepInterval = kSuccessSleepMsec_;
     while (cleanSleeper_.wait_for(sleepInterval)) {
@@ -406,7 +441,8 @@ bool FilePool::PrepareFormat() {
     }
 
     if (poolOpt_.allocatedByPercent) {
-        poolOpt_.filePoolSize = finfo.total * poolOpt_.allocatedPercent / 100;
+        poolOpt_.filePoolSize = finfo.total * poolOpt_.allocatedPercent / 100 /
+                                std::max<uint32_t>(1, poolOpt_.deviceShareNum);
     }
 
     uint64_t bytesPerPage = poolOpt_.fileSize + poolOpt_.metaFileSize;
@@ -482,10 +518,8 @@ int FilePool::FormatTask(uint64_t indexOffset,
             LOG(ERROR) << "Format ERROR!";
             break;
         }
+        freeChunks_.Push(chunkIndex + indexOffset, true);
         this->mtx_.lock();
-        cleanChunks_.push_back(chunkIndex + indexOffset);
-        this->currentState_.cleanChunksLeft++;
-        this->currentState_.preallocatedChunksLeft++;
         this->currentState_.chunkNum++;
         this->formatStat_.allocateChunkNum++;
         this->mtx_.unlock();
@@ -522,8 +556,11 @@ int FilePool::FormatWorker() {
 
 bool FilePool::StartCleaning() {
     if (poolOpt_.needClean && !cleanAlived_.exchange(true)) {
+        cleanIops_ = poolOpt_.iops4clean;
+        cleanLatencySamples_ = 0;
+        cleanLatencySumUs_ = 0;
         ReadWriteThrottleParams params;
-        params.iopsTotal = ThrottleParams(poolOpt_.iops4clean, 0, 0);
+        params.iopsTotal = ThrottleParams(cleanIops_, 0, 0);
         cleanThrottle_.UpdateThrottleParams(params);
 
         cleanThread_ = Thread(&FilePool::CleanWorker, this);
@@ -545,16 +582,10 @@ bool FilePool::StopCleaning() {
 }
 
 bool FilePool::GetChunk(bool needClean, uint64_t *chunkid, bool *isCleaned) {
-    auto pop = [&](std::vector<uint64_t>* chunks, uint64_t* chunksLeft,
-                   bool isCleanChunks) -> bool {
-        if (chunks->empty()) {
+    auto pop = [&](bool isCleanChunks) -> bool {
+        if (!freeChunks_.Pop(isCleanChunks, chunkid)) {
             return false;
         }
-
-        *chunkid = chunks->back();
-        chunks->pop_back();
-        (*chunksLeft)--;
-        currentState_.preallocatedChunksLeft--;
         *isCleaned = isCleanChunks;
         return true;
     };
@@ -562,25 +593,22 @@ bool FilePool::GetChunk(bool needClean, uint64_t *chunkid, bool *isCleaned) {
     auto wake_up = [&]() {
         return (formatStat_.allocateChunkNum.load() ==
                 formatStat_.preAllocateNum)  // NOLINT
-               || !(dirtyChunks_.empty() && cleanChunks_.empty());
+               || freeChunks_.Size(false) + freeChunks_.Size(true) > 0;
     };
 
-    bool ret = true;
-    {
+    // Only wait for the chunks being formatted, taking chunks doesn't
+    // need the lock
+    if (formatStat_.allocateChunkNum.load() != formatStat_.preAllocateNum) {
         std::unique_lock<std::mutex> lk(mtx_);
-        if (formatStat_.allocateChunkNum.load() != formatStat_.preAllocateNum) {
-            cond_.wait(lk, wake_up);
-        }
-        if (!needClean) {
-            return pop(&dirtyChunks_, &currentState_.dirtyChunksLeft, false) ||
-                   pop(&cleanChunks_, &currentState_.cleanChunksLeft, true);
-        }
-
-        // Need clean chunk
-        *isCleaned = false;
-        ret = pop(&cleanChunks_, &currentState_.cleanChunksLeft, true) ||
-              pop(&dirtyChunks_, &currentState_.dirtyChunksLeft, false);
+        cond_.wait(lk, wake_up);
+    }
+    if (!needClean) {
+        return pop(false) || pop(true);
     }
+
+    // Need clean chunk
+    *isCleaned = false;
+    bool ret = pop(true) || pop(false);
     if (true == ret && false == *isCleaned && CleanChunk(*chunkid, true)) {
         *isCleaned = true;
     }
@@ -638,8 +666,7 @@ int FilePool::GetFile(const std::string &targetpath, const char *metapage,
                 LOG(ERROR) << "file rename failed, " << srcpath.c_str();
             } else {
                 LOG(INFO) << "get file " << targetpath
-                          << " success! now pool size = "
-                          << currentState_.preallocatedChunksLeft;
+                          << " success! now pool size = " << Size();
                 break;
             }
         } else {
@@ -765,15 +792,9 @@ int FilePool::RecycleFile(const std::string &chunkpath) {
 
         fsptr_->Close(fd);
 
-        uint64_t newfilenum = 0;
-        std::string newfilename;
-        {
-            std::unique_lock<std::mutex> lk(mtx_);
-            currentmaxfilenum_.fetch_add(1);
-            newfilenum = currentmaxfilenum_.load();
-            newfilename = std::to_string(newfilenum);
-        }
-        std::string targetpath = currentdir_ + "/" + newfilename;
+        uint64_t newfilenum = currentmaxfilenum_.fetch_add(1) + 1;
+        std::string targetpath = currentdir_ + "/" +
+                                 std::to_string(newfilenum);
 
         ret = fsptr_->Rename(chunkpath.c_str(), targetpath.c_str());
         if (ret < 0) {
@@ -782,12 +803,9 @@ int FilePool::RecycleFile(const std::string &chunkpath) {
         } else {
             LOG(INFO) << "Recycle " << chunkpath.c_str() << ", success!"
                       << ", now chunkpool size = "
-                      << currentState_.dirtyChunksLeft + 1;
+                      << freeChunks_.Size(false) + 1;
         }
-        std::unique_lock<std::mutex> lk(mtx_);
-        dirtyChunks_.push_back(newfilenum);
-        currentState_.dirtyChunksLeft++;
-        currentState_.preallocatedChunksLeft++;
+        freeChunks_.Push(newfilenum, false);
     }
     return 0;
 }
@@ -795,9 +813,7 @@ int FilePool::RecycleFile(const std::string &chunkpath) {
 void FilePool::UnInitialize() {
     currentdir_ = "";
     StopFormatting();
-    std::unique_lock<std::mutex> lk(mtx_);
-    dirtyChunks_.clear();
-    cleanChunks_.clear();
+    freeChunks_.Clear();
 }
 
 bool FilePool::ScanInternal() {
@@ -863,11 +879,7 @@ bool FilePool::ScanInternal() {
         fsptr_->Close(fd);
         uint64_t filenum = atoll(chunkNum.c_str());
         if (filenum != 0) {
-            if (isCleaned) {
-                cleanChunks_.push_back(filenum);
-            } else {
-                dirtyChunks_.push_back(filenum);
-            }
+            freeChunks_.Push(filenum, isCleaned);
             if (filenum > maxnum) {
                 maxnum = filenum;
             }
@@ -878,15 +890,9 @@ bool FilePool::ScanInternal() {
     currentState_.chunkNum += CountAllocatedNum(poolOpt_.copysetDir);
     currentState_.chunkNum += CountAllocatedNum(poolOpt_.recycleDir);
 
-    std::unique_lock<std::mutex> lk(mtx_);
     currentmaxfilenum_.store(maxnum + 1);
-    currentState_.dirtyChunksLeft = dirtyChunks_.size();
-    currentState_.cleanChunksLeft = cleanChunks_.size();
-    currentState_.preallocatedChunksLeft =
-        currentState_.dirtyChunksLeft + currentState_.cleanChunksLeft;
 
-    LOG(INFO) << "scan done, pool size = "
-              << currentState_.preallocatedChunksLeft;
+    LOG(INFO) << "scan done, pool size = " << Size();
     return true;
 }
 
@@ -915,12 +921,16 @@ uint64_t FilePool::CountAllocatedNum(const std::string& path) {
 }
 
 size_t FilePool::Size() {
-    std::unique_lock<std::mutex> lk(mtx_);
-    return currentState_.preallocatedChunksLeft;
+    return freeChunks_.Size(false) + freeChunks_.Size(true);
 }
 
 FilePoolState FilePool::GetState() const {
-    return currentState_;
+    FilePoolState state = currentState_;
+    state.dirtyChunksLeft = freeChunks_.Size(false);
+    state.cleanChunksLeft = freeChunks_.Size(true);
+    state.preallocatedChunksLeft =
+        state.dirtyChunksLeft + state.cleanChunksLeft;
+    return state;
 }
 
 const ChunkFormatStat& FilePool::GetChunkFormatStat() const {
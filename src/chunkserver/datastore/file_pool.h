@@ -35,6 +35,7 @@
 #include <vector>
 
 #include "include/curve_compiler_specific.h"
+#include "src/chunkserver/datastore/chunk_free_list.h"
 #include "src/common/concurrent/concurrent.h"
 #include "src/common/interruptible_sleeper.h"
 #include "src/common/throttle.h"
@@ -56,6 +57,14 @@ struct FilePoolOptions {
     // Bytes per write for cleaning chunk (4096)
     uint32_t    bytesPerWrite;
     uint32_t    iops4clean;
+    // Keep this number of clean chunks, 0 means cleaning all dirty chunks
+    uint32_t    cleanWatermark;
+    // The throttle of cleaning is lowered when the latency of its writes
+    // exceeds this threshold, 0 means cleaning with iops4clean all the time
+    uint32_t    cleanLatencyThresholdUs;
+    // Clean chunk with fallocate(FALLOC_FL_ZERO_RANGE) instead of writing
+    // zeros, it falls back to writing if the file system doesn't support it
+    bool        cleanWithZeroRange;
     // it should be set when getFileFromPool=false
     char        filePoolDir[256];
     uint32_t    fileSize;
@@ -68,6 +77,10 @@ struct FilePoolOptions {
 
     bool allocatedByPercent;
     uint32_t allocatedPercent;
+    // Number of pools allocated by percent on the same device, e.g. the WAL
+    // pools of the chunkservers sharing a NVMe device, each of them gets
+    // 1 / deviceShareNum of allocatedPercent
+    uint32_t deviceShareNum;
     uint32_t preAllocateNum;
     uint64_t filePoolSize;
     uint32_t formatThreadNum;
@@ -82,6 +95,9 @@ struct FilePoolOptions {
         needClean = false;
         bytesPerWrite = 4096;
         iops4clean = -1;
+        cleanWatermark = 0;
+        cleanLatencyThresholdUs = 0;
+        cleanWithZeroRange = false;
         metaFileSize = 4096;
         fileSize = 0;
         metaPageSize = 0;
@@ -89,6 +105,7 @@ struct FilePoolOptions {
         blockSize = 0;
         allocatedByPercent = false;
         allocatedPercent = 0;
+        deviceShareNum = 1;
         preAllocateNum = 0;
         filePoolSize = 0;
         formatThreadNum = 1;
@@ -324,6 +341,14 @@ class CURVE_CACHELINE_ALIGNMENT FilePool {
      */
     bool CleaningChunk();
 
+    /**
+     * @brief: Adjust the throttle of cleaning by the latency of its write,
+     *         the iops is halved when the average latency exceeds
+     *         cleanLatencyThresholdUs, otherwise it grows back to iops4clean
+     * @param latencyUs: latency of one write and fsync
+     */
+    void AdjustCleanThrottle(uint64_t latencyUs);
+
     int FormatTask(uint64_t indexOffset, std::atomic<uint32_t>* allocatIndex);
 
     /**
@@ -352,7 +377,10 @@ class CURVE_CACHELINE_ALIGNMENT FilePool {
     // Sets a pause between cleaning when clean chunk fail
     static const std::chrono::milliseconds kFailSleepMsec_;
 
-    // Protect dirtyChunks_, cleanChunks_
+    // Number of writes between adjustments of the clean throttle
+    static const uint32_t kCleanAdjustSamples_;
+
+    // Protect currentState_.chunkNum and waiting for formatting
     std::mutex mtx_;
 
     // Wait for GetChunk
@@ -365,11 +393,8 @@ class CURVE_CACHELINE_ALIGNMENT FilePool {
     // which provides the basic interface for manipulating files
     std::shared_ptr<LocalFileSystem> fsptr_;
 
-    // The numeric format of the file name for all dirty chunk
-    std::vector<uint64_t> dirtyChunks_;
-
-    // The numeric format of the file name for all clean chunk
-    std::vector<uint64_t> cleanChunks_;
+    // The numeric format of the file name for all dirty and clean chunks
+    ChunkFreeList freeChunks_;
 
     // The current largest file name number format
     std::atomic<uint64_t> currentmaxfilenum_;
@@ -389,6 +414,16 @@ class CURVE_CACHELINE_ALIGNMENT FilePool {
     // The throttle iops for cleaning chunk (4KB/IO)
     Throttle cleanThrottle_;
 
+    // Current iops of cleanThrottle_, adjusted by the latency of cleaning
+    uint32_t cleanIops_;
+
+    // Latency samples of cleaning since the last adjustment
+    uint32_t cleanLatencySamples_;
+    uint64_t cleanLatencySumUs_;
+
+    // Whether the file system doesn't support FALLOC_FL_ZERO_RANGE
+    Atomic<bool> zeroRangeUnsupported_{false};
+
     // Whether the format thread is alive
     Atomic<bool> formatAlived_{true};
 
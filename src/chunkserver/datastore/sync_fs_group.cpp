@@ -0,0 +1,60 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/chunkserver/datastore/sync_fs_group.h"
+
+#include <glog/logging.h>
+
+#include <utility>
+
+namespace curve {
+namespace chunkserver {
+
+SyncFsGroup::SyncFsGroup(std::shared_ptr<LocalFileSystem> lfs)
+    : lfs_(std::move(lfs)),
+      running_(false),
+      started_(0),
+      finished_(0),
+      lastRet_(0) {}
+
+int SyncFsGroup::Sync(int fd) {
+    std::unique_lock<std::mutex> lk(mtx_);
+    // the first syncfs started after the call covers it
+    const uint64_t need = started_ + 1;
+    while (finished_ < need) {
+        if (running_) {
+            cond_.wait(lk);
+            continue;
+        }
+        running_ = true;
+        const uint64_t round = ++started_;
+        lk.unlock();
+        int rc = lfs_->SyncFs(fd);
+        lk.lock();
+        LOG_IF(ERROR, rc < 0) << "syncfs failed, fd: " << fd
+                              << ", ret: " << rc;
+        running_ = false;
+        finished_ = round;
+        lastRet_ = rc;
+        cond_.notify_all();
+    }
+    // a later syncfs failing is reported even if an earlier one covering
+    // the call succeeded, the caller can't tell which one made it durable
+    return lastRet_;
+}
+
+}  // namespace chunkserver
+}  // namespace curve
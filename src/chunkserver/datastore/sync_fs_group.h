@@ -0,0 +1,68 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_CHUNKSERVER_DATASTORE_SYNC_FS_GROUP_H_
+#define SRC_CHUNKSERVER_DATASTORE_SYNC_FS_GROUP_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "src/fs/local_filesystem.h"
+
+namespace curve {
+namespace chunkserver {
+
+using curve::fs::LocalFileSystem;
+
+/**
+ * Group commit of the syncfs of one disk, shared by all its copysets.
+ *
+ * A syncfs running when a caller arrives may have missed the caller's
+ * writes, so the caller waits for the next one, and all the callers
+ * arriving while a syncfs is running share the next one. Under load the
+ * disk sees one syncfs at a time whatever the number of callers.
+ */
+class SyncFsGroup {
+ public:
+    explicit SyncFsGroup(std::shared_ptr<LocalFileSystem> lfs);
+
+    /**
+     * Make everything written to the file system of fd before the call
+     * durable
+     * @param fd: any file of the file system
+     * @return: 0 on success, the error of the syncfs covering the call on
+     * failure
+     */
+    int Sync(int fd);
+
+ private:
+    std::shared_ptr<LocalFileSystem> lfs_;
+    std::mutex mtx_;
+    std::condition_variable cond_;
+    bool running_;
+    // the number of syncfs started and finished
+    uint64_t started_;
+    uint64_t finished_;
+    // the result of the last finished syncfs
+    int lastRet_;
+};
+
+}  // namespace chunkserver
+}  // namespace curve
+
+#endif  // SRC_CHUNKSERVER_DATASTORE_SYNC_FS_GROUP_H_
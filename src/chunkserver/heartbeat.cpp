@@ -21,12 +21,14 @@
  *          2018/12/20  Wenyu Zhou   Initial version
  */
 
+#include <fcntl.h>
 #include <sys/statvfs.h>
 #include <sys/time.h>
 #include <brpc/channel.h>
 #include <brpc/controller.h>
 #include <braft/closure_helper.h>
 
+#include <chrono>  //NOLINT
 #include <vector>
 #include <memory>
 
@@ -41,6 +43,16 @@ using curve::fs::FileSystemInfo;
 
 namespace curve {
 namespace chunkserver {
+
+namespace {
+
+// 心跳上报的磁盘错误类型，0为正常
+const uint32_t kWalDeviceError = 1;
+// wal设备探测写的字节数
+const int kWalProbeSize = 4096;
+
+}  // namespace
+
 TaskStatus Heartbeat::PurgeCopyset(LogicPoolID poolId, CopysetID copysetId) {
     if (!copysetMan_->PurgeCopysetNodeData(poolId, copysetId)) {
         LOG(ERROR) << "Failed to clean copyset "
@@ -96,6 +108,14 @@ int Heartbeat::Init(const HeartbeatOptions &options) {
 
     // init scanManager
     scanMan_ = options.scanManager;
+
+    seq_ = 0;
+    baseSeq_ = 0;
+    baseCopysets_.clear();
+    sendingCopysets_.clear();
+    deltaCount_ = 0;
+    changingCopysets_.clear();
+    nextHeartbeatMs_ = 0;
     return 0;
 }
 
@@ -140,6 +160,42 @@ int Heartbeat::GetFileSystemSpaces(size_t* capacity, size_t* avail) {
     return 0;
 }
 
+int Heartbeat::CheckWalDevice(std::string* errMsg) {
+    const std::string& walPath = options_.walPath;
+    struct FileSystemInfo info;
+    if (options_.fs->Statfs(walPath, &info) != 0) {
+        *errMsg = "failed to statfs wal device of " + walPath;
+        return -1;
+    }
+
+    // statfs成功时设备也可能已经不能写，写一个探测文件并落盘
+    const std::string probePath = walPath + "/.wal_device_check";
+    int fd = options_.fs->Open(probePath, O_RDWR | O_CREAT);
+    if (fd < 0) {
+        *errMsg = "failed to open " + probePath;
+        return -1;
+    }
+    char buf[kWalProbeSize] = {0};
+    int ret = options_.fs->Write(fd, buf, 0, sizeof(buf));
+    if (ret == static_cast<int>(sizeof(buf))) {
+        ret = options_.fs->Fsync(fd);
+    } else {
+        ret = -1;
+    }
+    options_.fs->Close(fd);
+    if (ret != 0) {
+        *errMsg = "failed to write " + probePath;
+        return -1;
+    }
+
+    if (info.available < info.total / 100) {
+        LOG(WARNING) << "wal device of " << walPath << " is almost full"
+                     << ", total = " << info.total
+                     << ", available = " << info.available;
+    }
+    return 0;
+}
+
 int Heartbeat::BuildCopysetInfo(curve::mds::heartbeat::CopySetInfo* info,
                                 CopysetNodePtr copyset) {
     int ret;
@@ -240,6 +296,13 @@ int Heartbeat::BuildRequest(HeartbeatRequest* req) {
                     new curve::mds::heartbeat::DiskState();
     diskState->set_errtype(0);
     diskState->set_errmsg("");
+    // wal设备出错时这个chunkserver上所有copyset的日志都不能写
+    std::string walErrMsg;
+    if (!options_.walPath.empty() && CheckWalDevice(&walErrMsg) != 0) {
+        LOG(ERROR) << "wal device error: " << walErrMsg;
+        diskState->set_errtype(kWalDeviceError);
+        diskState->set_errmsg(walErrMsg);
+    }
     req->set_allocated_diskstate(diskState);
 
     ChunkServerMetric* metric = ChunkServerMetric::GetInstance();
@@ -318,9 +381,68 @@ int Heartbeat::BuildRequest(HeartbeatRequest* req) {
     req->set_leadercount(leaders);
     req->set_version(curve::common::CurveVersion());
 
+    BuildDelta(req);
     return 0;
 }
 
+void Heartbeat::BuildDelta(HeartbeatRequest* req) {
+    sendingCopysets_.clear();
+    // 不设置序号时mds不记录心跳内容
+    if (options_.fullHeartbeatInterval == 0) {
+        return;
+    }
+
+    req->set_seq(++seq_);
+    for (const auto& info : req->copysetinfos()) {
+        sendingCopysets_[ToGroupNid(info.logicalpoolid(), info.copysetid())] =
+            info.SerializeAsString();
+    }
+
+    if (baseSeq_ == 0 || deltaCount_ >= options_.fullHeartbeatInterval) {
+        deltaCount_ = 0;
+        return;
+    }
+    ++deltaCount_;
+    req->set_baseseq(baseSeq_);
+
+    // 只保留相对于基准有变化的copyset
+    auto* infos = req->mutable_copysetinfos();
+    int changed = 0;
+    for (int i = 0; i < infos->size(); ++i) {
+        const auto& info = infos->Get(i);
+        GroupNid id = ToGroupNid(info.logicalpoolid(), info.copysetid());
+        auto it = baseCopysets_.find(id);
+        if (it != baseCopysets_.end() && it->second == sendingCopysets_[id]) {
+            continue;
+        }
+        infos->SwapElements(i, changed++);
+    }
+    while (infos->size() > changed) {
+        infos->RemoveLast();
+    }
+
+    for (const auto& item : baseCopysets_) {
+        if (sendingCopysets_.count(item.first) == 0) {
+            auto* key = req->add_removedcopysets();
+            key->set_logicalpoolid(GetPoolID(item.first));
+            key->set_copysetid(GetCopysetID(item.first));
+        }
+    }
+}
+
+void Heartbeat::UpdateDeltaBase(const HeartbeatRequest& req,
+                                const HeartbeatResponse& resp) {
+    if (req.has_seq() && resp.has_baseseq() && resp.baseseq() == req.seq()) {
+        baseSeq_ = req.seq();
+        baseCopysets_.swap(sendingCopysets_);
+    } else {
+        // mds没有记录本次心跳，下次发送全量心跳
+        baseSeq_ = 0;
+        baseCopysets_.clear();
+    }
+    sendingCopysets_.clear();
+}
+
 void Heartbeat::DumpHeartbeatRequest(const HeartbeatRequest& request) {
     DVLOG(6) << "Heartbeat request: Chunkserver ID: "
              << request.chunkserverid()
@@ -423,6 +545,19 @@ int Heartbeat::SendHeartbeat(const HeartbeatRequest& request,
 }
 
 int Heartbeat::ExecTask(const HeartbeatResponse& response) {
+    if (options_.qosScheduler != nullptr) {
+        for (int i = 0; i < response.copysetqos_size(); i++) {
+            const CopysetQos& qos = response.copysetqos(i);
+            QosParams params;
+            params.reservation = qos.reservation();
+            params.limit = qos.limit();
+            params.weight = qos.has_weight() ? qos.weight() : 1;
+            options_.qosScheduler->UpdateParams(qos.logicalpoolid(),
+                                                qos.copysetid(),
+                                                params);
+        }
+    }
+
     int count = response.needupdatecopysets_size();
     for (int i = 0; i < count; i ++) {
         CopySetConf conf = response.needupdatecopysets(i);
@@ -487,6 +622,8 @@ int Heartbeat::ExecTask(const HeartbeatResponse& response) {
                     << conf.configchangeitem().address() << " on copyset"
                     << ToGroupIdStr(conf.logicalpoolid(), conf.copysetid());
                 copyset->TransferLeader(conf.configchangeitem());
+                changingCopysets_.emplace(
+                    ToGroupNid(conf.logicalpoolid(), conf.copysetid()));
                 break;
             }
 
@@ -495,6 +632,8 @@ int Heartbeat::ExecTask(const HeartbeatResponse& response) {
                 << " to copyset"
                 << ToGroupIdStr(conf.logicalpoolid(), conf.copysetid());
             copyset->AddPeer(conf.configchangeitem());
+            changingCopysets_.emplace(
+                ToGroupNid(conf.logicalpoolid(), conf.copysetid()));
             break;
 
         case curve::mds::heartbeat::REMOVE_PEER:
@@ -502,6 +641,8 @@ int Heartbeat::ExecTask(const HeartbeatResponse& response) {
                 << " from copyset"
                 << ToGroupIdStr(conf.logicalpoolid(), conf.copysetid());
             copyset->RemovePeer(conf.configchangeitem());
+            changingCopysets_.emplace(
+                ToGroupNid(conf.logicalpoolid(), conf.copysetid()));
             break;
 
         case curve::mds::heartbeat::CHANGE_PEER:
@@ -513,6 +654,8 @@ int Heartbeat::ExecTask(const HeartbeatResponse& response) {
                         << conf.configchangeitem().address() << " on copyset"
                         << ToGroupIdStr(conf.logicalpoolid(), conf.copysetid());
                     copyset->ChangePeer(newPeers);
+                    changingCopysets_.emplace(
+                        ToGroupNid(conf.logicalpoolid(), conf.copysetid()));
                 } else {
                     LOG(ERROR) << "Build new peer for copyset"
                         << ToGroupIdStr(conf.logicalpoolid(), conf.copysetid())
@@ -575,6 +718,54 @@ int Heartbeat::ExecTask(const HeartbeatResponse& response) {
     return 0;
 }
 
+void Heartbeat::WaitForNextHeartbeat() {
+    uint64_t checkIntervalMs = options_.configChangeCheckIntervalMs;
+    uint64_t intervalMs = options_.intervalSec * 1000;
+    if (nextHeartbeatMs_ == 0) {
+        nextHeartbeatMs_ =
+            ::curve::common::TimeUtility::GetTimeofDayMs() + intervalMs;
+    }
+    // 配置变更完成后立即上报，mds确认后即可下发该copyset或
+    // 相关chunkserver上的后续变更，无需等待一个心跳周期；
+    // 提前发送的心跳不影响周期心跳的时间点
+    while (checkIntervalMs > 0 && !changingCopysets_.empty() &&
+           !toStop_.load(std::memory_order_acquire) &&
+           ::curve::common::TimeUtility::GetTimeofDayMs() + checkIntervalMs <
+               nextHeartbeatMs_) {
+        std::this_thread::sleep_for(
+            std::chrono::milliseconds(checkIntervalMs));
+        if (ConfigChangeFinished()) {
+            return;
+        }
+    }
+
+    waitInterval_.WaitForNextExcution();
+    nextHeartbeatMs_ =
+        ::curve::common::TimeUtility::GetTimeofDayMs() + intervalMs;
+}
+
+bool Heartbeat::ConfigChangeFinished() {
+    bool finished = false;
+    for (auto it = changingCopysets_.begin();
+         it != changingCopysets_.end();) {
+        CopysetNodePtr copyset =
+            copysetMan_->GetCopysetNode(GetPoolID(*it), GetCopysetID(*it));
+        ConfigChangeType type = curve::mds::heartbeat::NONE;
+        Configuration conf;
+        Peer peer;
+        // copyset被删除、不再是leader或变更已结束，都需要尽快上报
+        if (copyset == nullptr ||
+            copyset->GetConfChange(&type, &conf, &peer) != 0 ||
+            type == curve::mds::heartbeat::NONE) {
+            it = changingCopysets_.erase(it);
+            finished = true;
+            continue;
+        }
+        ++it;
+    }
+    return finished;
+}
+
 void Heartbeat::HeartbeatWorker() {
     int ret;
     int errorIntervalSec = 2;
@@ -607,6 +798,7 @@ void Heartbeat::HeartbeatWorker() {
             ::sleep(errorIntervalSec);
             continue;
         }
+        UpdateDeltaBase(req, resp);
 
         LOG(INFO) << "executing heartbeat info";
         ret = ExecTask(resp);
@@ -616,7 +808,7 @@ void Heartbeat::HeartbeatWorker() {
             continue;
         }
 
-        waitInterval_.WaitForNextExcution();
+        WaitForNextHeartbeat();
     }
 
     LOG(INFO) << "Heartbeat worker thread stopped.";
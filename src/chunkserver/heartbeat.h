@@ -28,6 +28,7 @@
 #include <braft/node.h>                  // NodeImpl
 
 #include <map>
+#include <set>
 #include <vector>
 #include <string>
 #include <atomic>
@@ -39,6 +40,7 @@
 #include "src/common/wait_interval.h"
 #include "src/common/concurrent/concurrent.h"
 #include "src/chunkserver/scan_manager.h"
+#include "src/chunkserver/qos_scheduler.h"
 #include "proto/heartbeat.pb.h"
 #include "proto/scan.pb.h"
 
@@ -51,6 +53,7 @@ using HeartbeatRequest  = curve::mds::heartbeat::ChunkServerHeartbeatRequest;
 using HeartbeatResponse = curve::mds::heartbeat::ChunkServerHeartbeatResponse;
 using ConfigChangeInfo  = curve::mds::heartbeat::ConfigChangeInfo;
 using CopySetConf       = curve::mds::heartbeat::CopySetConf;
+using CopysetQos        = curve::mds::heartbeat::CopysetQos;
 using CandidateError    = curve::mds::heartbeat::CandidateError;
 using TaskStatus        = butil::Status;
 using CopysetNodePtr    = std::shared_ptr<CopysetNode>;
@@ -69,6 +72,15 @@ struct HeartbeatOptions {
     uint32_t                timeout;
     CopysetNodeManager*     copysetNodeManager;
     ScanManager*            scanManager;
+    // 为空时忽略MDS下发的QoS参数
+    QosScheduler*           qosScheduler = nullptr;
+    // 每发送多少个增量心跳后发送一次全量心跳，为0时只发送全量心跳
+    uint32_t                fullHeartbeatInterval = 0;
+    // mds下发的配置变更执行期间每隔多少ms检查一次，变更完成后立即发送心跳，
+    // 以便mds尽快确认并下发后续变更；为0时只按intervalSec发送心跳
+    uint32_t                configChangeCheckIntervalMs = 0;
+    // 和数据不在同一个设备上的wal目录，每次心跳检查它是否可用，为空时不检查
+    std::string             walPath;
 
     std::shared_ptr<LocalFileSystem> fs;
     std::shared_ptr<FilePool> chunkFilePool;
@@ -118,6 +130,11 @@ class Heartbeat {
      */
     int GetFileSystemSpaces(size_t* capacity, size_t* free);
 
+    /*
+     * 检查单独设备上的wal目录是否可用，不可用时返回非0并设置errMsg
+     */
+    int CheckWalDevice(std::string* errMsg);
+
     /*
      * 构建心跳消息的Copyset信息项
      */
@@ -129,6 +146,17 @@ class Heartbeat {
      */
     int BuildRequest(HeartbeatRequest* request);
 
+    /*
+     * 设置心跳序号，可以的话去掉与mds已确认的心跳相同的copyset信息
+     */
+    void BuildDelta(HeartbeatRequest* request);
+
+    /*
+     * 根据mds的回应更新增量心跳的基准
+     */
+    void UpdateDeltaBase(const HeartbeatRequest& request,
+                         const HeartbeatResponse& response);
+
     /*
      * 发送心跳消息
      */
@@ -140,6 +168,16 @@ class Heartbeat {
      */
     int ExecTask(const HeartbeatResponse& response);
 
+    /*
+     * 等待下一次心跳，mds下发的配置变更完成时提前返回
+     */
+    void WaitForNextHeartbeat();
+
+    /*
+     * 检查mds下发的配置变更是否有已完成的
+     */
+    bool ConfigChangeFinished();
+
     /*
      * 输出心跳请求信息
      */
@@ -187,6 +225,23 @@ class Heartbeat {
     uint64_t startUpTime_;
 
     ScanManager *scanMan_;
+
+    // 以下为增量心跳的状态，只在心跳线程中访问
+    // 最近一次心跳的序号
+    uint64_t seq_;
+    // mds已确认的心跳序号，为0时下次发送全量心跳
+    uint64_t baseSeq_;
+    // 序号为baseSeq_的心跳中各copyset序列化后的信息
+    std::map<GroupNid, std::string> baseCopysets_;
+    // 正在发送的心跳中各copyset序列化后的信息
+    std::map<GroupNid, std::string> sendingCopysets_;
+    // 自上次全量心跳以来的增量心跳个数
+    uint32_t deltaCount_;
+
+    // 正在执行mds下发的配置变更的copyset，只在心跳线程中访问
+    std::set<GroupNid> changingCopysets_;
+    // 下一次周期心跳的时间点，unix时间，单位ms
+    uint64_t nextHeartbeatMs_;
 };
 
 }  // namespace chunkserver
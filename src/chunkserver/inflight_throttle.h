@@ -52,6 +52,13 @@ class InflightThrottle {
         }
     }
 
+    /**
+     * @brief: 当前inflight request数量
+     */
+    inline uint64_t GetInflight() const {
+        return inflightRequestCount_.load(std::memory_order_relaxed);
+    }
+
     /**
      * @brief: inflight request计数加1
      */
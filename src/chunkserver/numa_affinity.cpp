@@ -0,0 +1,283 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/chunkserver/numa_affinity.h"
+
+#include <dirent.h>
+#include <glog/logging.h>
+#include <sched.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace curve {
+namespace chunkserver {
+
+namespace {
+
+// MPOL_PREFERRED in linux/mempolicy.h, libnuma is not a dependency
+const int kMpolPreferred = 1;
+const int kMaxNodeNum = 1024;
+
+bool ReadFirstLine(const std::string& path, std::string* line) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        return false;
+    }
+    std::getline(in, *line);
+    return !in.bad();
+}
+
+bool ParseInt(const std::string& str, int* value) {
+    if (str.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    long v = strtol(str.c_str(), &end, 10);  // NOLINT
+    if (*end != '\0' && *end != '\n') {
+        return false;
+    }
+    *value = static_cast<int>(v);
+    return true;
+}
+
+}  // namespace
+
+NumaAffinity* NumaAffinity::GetInstance() {
+    static NumaAffinity instance;
+    return &instance;
+}
+
+int NumaAffinity::Init(const NumaAffinityOptions& options) {
+    if (!options.enable) {
+        return 0;
+    }
+
+    int node = options.node;
+    if (node < 0) {
+        node = GetDiskNode(options.sysfsRoot, options.dataDir);
+        if (node < 0) {
+            LOG(ERROR) << "Failed to get numa node of the disk of "
+                       << options.dataDir;
+            return -1;
+        }
+    }
+
+    std::vector<int> cpuNodes;
+    if (!LoadCpuNodes(options.sysfsRoot, &cpuNodes)) {
+        LOG(ERROR) << "Failed to load numa topology";
+        return -1;
+    }
+    std::vector<int> cpus;
+    for (size_t cpu = 0; cpu < cpuNodes.size(); ++cpu) {
+        if (cpuNodes[cpu] == node) {
+            cpus.push_back(cpu);
+        }
+    }
+    if (cpus.empty()) {
+        LOG(ERROR) << "No cpu in numa node " << node;
+        return -1;
+    }
+
+    if (BindCpus(cpus) != 0) {
+        return -1;
+    }
+    if (options.bindMemory && BindMemory(node) != 0) {
+        LOG(WARNING) << "Failed to prefer memory of numa node " << node
+                     << ", memory is allocated by the default policy";
+    }
+
+    node_ = node;
+    cpuNodes_.swap(cpuNodes);
+    nodeStatus_.reset(new bvar::Status<int>("chunkserver_numa_node", node_));
+    localCount_.reset(
+        new bvar::Adder<uint64_t>("chunkserver_numa_local_cpu_count"));
+    remoteCount_.reset(
+        new bvar::Adder<uint64_t>("chunkserver_numa_remote_cpu_count"));
+    LOG(INFO) << "Bind chunkserver to numa node " << node_
+              << ", cpu num: " << cpus.size()
+              << ", bind memory: " << options.bindMemory;
+    return 0;
+}
+
+void NumaAffinity::RecordCpu() {
+    if (node_ < 0) {
+        return;
+    }
+    int cpu = sched_getcpu();
+    if (cpu < 0 || static_cast<size_t>(cpu) >= cpuNodes_.size()) {
+        return;
+    }
+    if (cpuNodes_[cpu] == node_) {
+        *localCount_ << 1;
+    } else {
+        *remoteCount_ << 1;
+    }
+}
+
+bool NumaAffinity::ParseCpuList(const std::string& str,
+                                std::vector<int>* cpus) {
+    cpus->clear();
+    size_t pos = 0;
+    while (pos < str.size() && str[pos] != '\n') {
+        size_t end = str.find_first_of(",\n", pos);
+        if (end == std::string::npos) {
+            end = str.size();
+        }
+        std::string range = str.substr(pos, end - pos);
+        size_t dash = range.find('-');
+        int first = 0;
+        int last = 0;
+        if (dash == std::string::npos) {
+            if (!ParseInt(range, &first)) {
+                return false;
+            }
+            last = first;
+        } else if (!ParseInt(range.substr(0, dash), &first) ||
+                   !ParseInt(range.substr(dash + 1), &last)) {
+            return false;
+        }
+        if (first < 0 || first > last) {
+            return false;
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus->push_back(cpu);
+        }
+        pos = (end < str.size() && str[end] == ',') ? end + 1 : end;
+    }
+    return true;
+}
+
+int NumaAffinity::GetDiskNode(const std::string& sysfsRoot,
+                              const std::string& path) {
+    // the data dir is not created yet on the first start, use its nearest
+    // existing parent
+    struct stat st;
+    std::string dir = path.empty() ? "." : path;
+    while (stat(dir.c_str(), &st) != 0) {
+        size_t pos = dir.find_last_of('/', dir.size() - 2);
+        if (pos == std::string::npos) {
+            dir = ".";
+        } else {
+            dir = pos == 0 ? "/" : dir.substr(0, pos);
+        }
+        if (dir == "." || dir == "/") {
+            if (stat(dir.c_str(), &st) != 0) {
+                LOG(ERROR) << "Failed to stat " << path
+                           << ", errno: " << errno;
+                return -1;
+            }
+            break;
+        }
+    }
+    std::string devDir = sysfsRoot + "/dev/block/" +
+                         std::to_string(major(st.st_dev)) + ":" +
+                         std::to_string(minor(st.st_dev));
+    // a partition has no device of its own, its parent is the whole disk;
+    // the block device of nvme belongs to the controller, whose parent is
+    // the pci device
+    const char* candidates[] = {
+        "/device/numa_node",
+        "/device/device/numa_node",
+        "/../device/numa_node",
+        "/../device/device/numa_node",
+    };
+    for (const char* candidate : candidates) {
+        std::string line;
+        int node = -1;
+        if (ReadFirstLine(devDir + candidate, &line) &&
+            ParseInt(line, &node) && node >= 0) {
+            return node;
+        }
+    }
+    return -1;
+}
+
+bool NumaAffinity::LoadCpuNodes(const std::string& sysfsRoot,
+                                std::vector<int>* cpuNodes) {
+    cpuNodes->clear();
+    std::string nodeDir = sysfsRoot + "/devices/system/node";
+    DIR* dir = opendir(nodeDir.c_str());
+    if (dir == nullptr) {
+        LOG(ERROR) << "Failed to open " << nodeDir << ", errno: " << errno;
+        return false;
+    }
+    bool found = false;
+    struct dirent* entry = nullptr;
+    while ((entry = readdir(dir)) != nullptr) {
+        std::string name = entry->d_name;
+        int node = -1;
+        if (name.compare(0, 4, "node") != 0 ||
+            !ParseInt(name.substr(4), &node) || node < 0) {
+            continue;
+        }
+        std::string line;
+        std::vector<int> cpus;
+        if (!ReadFirstLine(nodeDir + "/" + name + "/cpulist", &line) ||
+            !ParseCpuList(line, &cpus)) {
+            LOG(WARNING) << "Failed to read cpu list of numa node " << node;
+            continue;
+        }
+        for (int cpu : cpus) {
+            if (static_cast<size_t>(cpu) >= cpuNodes->size()) {
+                cpuNodes->resize(cpu + 1, -1);
+            }
+            (*cpuNodes)[cpu] = node;
+        }
+        found = true;
+    }
+    closedir(dir);
+    return found;
+}
+
+int NumaAffinity::BindCpus(const std::vector<int>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        LOG(ERROR) << "Failed to set cpu affinity, errno: " << errno;
+        return -1;
+    }
+    return 0;
+}
+
+int NumaAffinity::BindMemory(int node) {
+    if (node >= kMaxNodeNum) {
+        return -1;
+    }
+    const int bits = sizeof(unsigned long) * 8;  // NOLINT
+    unsigned long mask[kMaxNodeNum / bits] = {0};  // NOLINT
+    mask[node / bits] |= 1UL << (node % bits);
+    if (syscall(SYS_set_mempolicy, kMpolPreferred, mask, kMaxNodeNum) != 0) {
+        LOG(ERROR) << "Failed to set memory policy, errno: " << errno;
+        return -1;
+    }
+    return 0;
+}
+
+}  // namespace chunkserver
+}  // namespace curve
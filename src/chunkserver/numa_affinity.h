@@ -0,0 +1,113 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_CHUNKSERVER_NUMA_AFFINITY_H_
+#define SRC_CHUNKSERVER_NUMA_AFFINITY_H_
+
+#include <bvar/bvar.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/uncopyable.h"
+
+namespace curve {
+namespace chunkserver {
+
+/**
+ * enable: bind the chunkserver to a numa node
+ * node: the node to bind, -1 means the node the disk of dataDir is
+ *       attached to
+ * bindMemory: prefer allocating memory from the node
+ * dataDir: any path on the disk served by the chunkserver
+ * sysfsRoot: root of sysfs, only changed by tests
+ */
+struct NumaAffinityOptions {
+    bool enable = false;
+    int node = -1;
+    bool bindMemory = true;
+    std::string dataDir;
+    std::string sysfsRoot = "/sys";
+};
+
+/**
+ * A chunkserver serves one disk, so all its threads (brpc workers, raft
+ * and apply threads) and its buffers are placed on the numa node of the
+ * disk, the data read from or written to the disk then never crosses the
+ * socket interconnect.
+ *
+ * The binding is done on the calling thread before the other threads are
+ * created, threads inherit the cpu affinity and the memory policy of their
+ * creator. Requests applied on a cpu out of the node are counted, they
+ * show that the binding is not in effect, e.g. limited by the cgroup.
+ */
+class NumaAffinity : public curve::common::Uncopyable {
+ public:
+    static NumaAffinity* GetInstance();
+
+    /**
+     * @brief bind the calling thread to the numa node
+     * @return 0 if disabled or bound, -1 on failure and nothing is bound
+     */
+    int Init(const NumaAffinityOptions& options);
+
+    // count the cpu the calling thread runs on, no-op if not bound
+    void RecordCpu();
+
+    // the node bound, -1 if not bound
+    int GetNode() const {
+        return node_;
+    }
+
+    /**
+     * @brief parse cpu list in sysfs, e.g. "0-3,8-11"
+     * @return false if the format is invalid
+     */
+    static bool ParseCpuList(const std::string& str, std::vector<int>* cpus);
+
+    /**
+     * @brief numa node of the disk the path is on
+     * @return node id, -1 if it is unknown
+     */
+    static int GetDiskNode(const std::string& sysfsRoot,
+                           const std::string& path);
+
+    /**
+     * @brief node of every cpu, indexed by the cpu id, -1 for the cpus not
+     *        in any node
+     * @return false if no node is found
+     */
+    static bool LoadCpuNodes(const std::string& sysfsRoot,
+                             std::vector<int>* cpuNodes);
+
+ private:
+    NumaAffinity() : node_(-1) {}
+
+    int BindCpus(const std::vector<int>& cpus);
+    int BindMemory(int node);
+
+    int node_;
+    std::vector<int> cpuNodes_;
+    std::unique_ptr<bvar::Status<int>> nodeStatus_;
+    std::unique_ptr<bvar::Adder<uint64_t>> localCount_;
+    std::unique_ptr<bvar::Adder<uint64_t>> remoteCount_;
+};
+
+}  // namespace chunkserver
+}  // namespace curve
+
+#endif  // SRC_CHUNKSERVER_NUMA_AFFINITY_H_
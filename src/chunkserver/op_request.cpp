@@ -35,10 +35,15 @@
 #include "src/chunkserver/chunk_closure.h"
 #include "src/chunkserver/clone_manager.h"
 #include "src/chunkserver/clone_task.h"
+#include "src/chunkserver/numa_affinity.h"
+#include "src/chunkserver/datastore/buffer_pool.h"
+#include "src/common/timeutility.h"
 
 namespace curve {
 namespace chunkserver {
 
+using curve::common::TimeUtility;
+
 ChunkOpRequest::ChunkOpRequest() :
     datastore_(nullptr),
     node_(nullptr),
@@ -59,6 +64,7 @@ ChunkOpRequest::ChunkOpRequest(std::shared_ptr<CopysetNode> nodePtr,
     request_(request),
     response_(response),
     done_(done) {
+    trace_.receivedUs = TimeUtility::GetTimeofDayUs();
 }
 
 void ChunkOpRequest::Process() {
@@ -100,6 +106,7 @@ int ChunkOpRequest::Propose(const ChunkRequest *request,
      */
     task.expected_term = node_->LeaderTerm();
 
+    trace_.proposedUs = TimeUtility::GetTimeofDayUs();
     node_->Propose(task);
 
     return 0;
@@ -115,6 +122,33 @@ void ChunkOpRequest::RedirectChunkRequest() {
     response_->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_REDIRECTED);
 }
 
+void ChunkOpRequest::OnCommitted() {
+    if (trace_.receivedUs != 0) {
+        trace_.committedUs = TimeUtility::GetTimeofDayUs();
+    }
+}
+
+void ChunkOpRequest::OnApplyStart() {
+    NumaAffinity::GetInstance()->RecordCpu();
+    if (trace_.receivedUs != 0) {
+        trace_.applyStartUs = TimeUtility::GetTimeofDayUs();
+    }
+}
+
+void ChunkOpRequest::OnStoreDone(CSIOMetricType type) {
+    if (trace_.receivedUs == 0) {
+        return;
+    }
+    trace_.storeDoneUs = TimeUtility::GetTimeofDayUs();
+    ChunkServerMetric *metric = ChunkServerMetric::GetInstance();
+    metric->OnStages(request_->logicpoolid(), request_->copysetid(),
+                     type, trace_);
+    if (metric->SampleSlowRequest(trace_)) {
+        LOG(WARNING) << "Slow request, " << trace_.ToString()
+                     << ", request: " << request_->ShortDebugString();
+    }
+}
+
 int ChunkOpRequest::Encode(const ChunkRequest *request,
                            const butil::IOBuf *data,
                            butil::IOBuf *log) {
@@ -247,13 +281,20 @@ ReadChunkRequest::ReadChunkRequest(std::shared_ptr<CopysetNode> nodePtr,
     ChunkOpRequest(nodePtr, cntl, request, response, done),
     cloneMgr_(cloneMgr),
     concurrentApplyModule_(nodePtr->GetConcurrentApplyModule()),
-    applyIndex(0) {
+    applyIndex(0),
+    followerRead_(false) {
 }
 
 void ReadChunkRequest::Process() {
     brpc::ClosureGuard doneGuard(done_);
 
     if (!node_->IsLeaderTerm()) {
+        // 只读的文件可以从follower读，follower落后时转给leader处理
+        if (request_->optype() == CHUNK_OP_TYPE::CHUNK_OP_READ &&
+            request_->readfromfollower() && node_->IsFollowerReadable()) {
+            ReadFromFollower(doneGuard.release());
+            return;
+        }
         RedirectChunkRequest();
         return;
     }
@@ -279,6 +320,7 @@ void ReadChunkRequest::Process() {
                               thisPtr,
                               node_->GetAppliedIndex(),
                               doneGuard.release());
+        OnCommitted();
         concurrentApplyModule_->Push(request_->chunkid(),
                                      ChunkOpRequest::Schedule(request_->optype()),  // NOLINT
                                      task);
@@ -297,8 +339,27 @@ void ReadChunkRequest::Process() {
     }
 }
 
+void ReadChunkRequest::ReadFromFollower(::google::protobuf::Closure *done) {
+    followerRead_ = true;
+    auto thisPtr
+        = std::dynamic_pointer_cast<ReadChunkRequest>(shared_from_this());
+    auto task = std::bind(&ReadChunkRequest::OnApply,
+                          thisPtr,
+                          node_->GetAppliedIndex(),
+                          done);
+    /*
+     * 进入chunk的写队列，排在已经交给apply队列的写请求之后，
+     * 保证能读到leader的committed index之前写入的数据
+     */
+    OnCommitted();
+    concurrentApplyModule_->Push(request_->chunkid(),
+                                 ApplyTaskType::WRITE,
+                                 task);
+}
+
 void ReadChunkRequest::OnApply(uint64_t index,
                                ::google::protobuf::Closure *done) {
+    OnApplyStart();
     // 先清除response中的status，以保证CheckForward后的判断的正确性
     response_->clear_status();
 
@@ -324,6 +385,11 @@ void ReadChunkRequest::OnApply(uint64_t index,
                 CHUNK_OP_STATUS::CHUNK_OP_STATUS_FAILURE_UNKNOWN);
             break;
         }
+        // follower不能从源端拷贝数据，交给leader处理
+        if (followerRead_ && (needLazyClone || NeedClone(chunkInfo))) {
+            RedirectChunkRequest();
+            break;
+        }
         // 如果需要从源端拷贝数据，需要将请求转发给clone manager处理
         if ( needLazyClone || NeedClone(chunkInfo) ) {
             applyIndex = index;
@@ -346,6 +412,7 @@ void ReadChunkRequest::OnApply(uint64_t index,
         // 如果是ReadChunk请求还需要从本地读取数据
         if (request_->optype() == CHUNK_OP_TYPE::CHUNK_OP_READ) {
             ReadChunk();
+            OnStoreDone(CSIOMetricType::READ_CHUNK);
         }
         // 如果是recover请求，说明请求区域已经被写过了，可以直接返回成功
         if (request_->optype() == CHUNK_OP_TYPE::CHUNK_OP_RECOVER) {
@@ -353,7 +420,8 @@ void ReadChunkRequest::OnApply(uint64_t index,
         }
     } while (false);
 
-    if (response_->status() == CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS) {
+    if (!followerRead_ &&
+        response_->status() == CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS) {
         node_->UpdateAppliedIndex(index);
     }
 
@@ -388,17 +456,10 @@ bool ReadChunkRequest::NeedClone(const CSChunkInfo& chunkInfo) {
     return false;
 }
 
-static void ReadBufferDeleter(void* ptr) {
-    delete[] static_cast<char*>(ptr);
-}
-
 void ReadChunkRequest::ReadChunk() {
-    char *readBuffer = nullptr;
     size_t size = request_->size();
-
-    readBuffer = new(std::nothrow)char[size];
-    CHECK(nullptr != readBuffer)
-        << "new readBuffer failed " << strerror(errno);
+    // the buffer is sent as response attachment without copy
+    char *readBuffer = BufferPool::Get(size);
 
     auto ret = datastore_->ReadChunk(request_->chunkid(),
                                      request_->sn(),
@@ -406,7 +467,7 @@ void ReadChunkRequest::ReadChunk() {
                                      request_->offset(),
                                      size);
     butil::IOBuf wrapper;
-    wrapper.append_user_data(readBuffer, size, ReadBufferDeleter);
+    BufferPool::AppendToIOBuf(readBuffer, size, &wrapper);
     if (CSErrorCode::Success == ret) {
         cntl_->response_attachment().append(wrapper);
         response_->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
@@ -431,6 +492,7 @@ void WriteChunkRequest::OnApply(uint64_t index,
     brpc::ClosureGuard doneGuard(done);
     uint32_t cost;
 
+    OnApplyStart();
     std::string  cloneSourceLocation;
     if (existCloneInfo(request_)) {
         auto func = ::curve::common::LocationOperator::GenerateCurveLocation;
@@ -445,6 +507,14 @@ void WriteChunkRequest::OnApply(uint64_t index,
                                       request_->size(),
                                       &cost,
                                       cloneSourceLocation);
+    OnWriteDone(index, doneGuard.release(), ret);
+}
+
+void WriteChunkRequest::OnWriteDone(uint64_t index,
+                                    ::google::protobuf::Closure *done,
+                                    CSErrorCode ret) {
+    brpc::ClosureGuard doneGuard(done);
+    OnStoreDone(CSIOMetricType::WRITE_CHUNK);
 
     if (CSErrorCode::Success == ret) {
         response_->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
@@ -499,9 +569,14 @@ void WriteChunkRequest::OnApplyFromLog(std::shared_ptr<CSDataStore> datastore,
                                      request.size(),
                                      &cost,
                                      cloneSourceLocation);
-     if (CSErrorCode::Success == ret) {
-         return;
-     } else if (CSErrorCode::BackwardRequestError == ret) {
+    OnWriteFromLogDone(request, ret);
+}
+
+void WriteChunkRequest::OnWriteFromLogDone(const ChunkRequest &request,
+                                           CSErrorCode ret) {
+    if (CSErrorCode::Success == ret) {
+        return;
+    } else if (CSErrorCode::BackwardRequestError == ret) {
         LOG(WARNING) << "write failed: "
                      << " data store return: " << ret
                      << ", request: " << request.ShortDebugString();
@@ -518,21 +593,108 @@ void WriteChunkRequest::OnApplyFromLog(std::shared_ptr<CSDataStore> datastore,
     }
 }
 
+bool WriteChunkBatch::CanMerge(const ChunkRequest &request,
+                               size_t dataSize) const {
+    if (request.optype() != CHUNK_OP_TYPE::CHUNK_OP_WRITE ||
+        existCloneInfo(&request) ||
+        request.size() != dataSize ||
+        request.offset() % blockSize_ != 0 ||
+        request.size() % blockSize_ != 0 ||
+        request.offset() + request.size() > chunkSize_) {
+        return false;
+    }
+    if (entries_.empty()) {
+        return request.size() <= maxSize_;
+    }
+    return request.chunkid() == chunkId_ &&
+           request.sn() == sn_ &&
+           request.offset() == offset_ + length_ &&
+           length_ + request.size() <= maxSize_;
+}
+
+void WriteChunkBatch::Merge(const ChunkRequest &request) {
+    if (entries_.empty()) {
+        chunkId_ = request.chunkid();
+        sn_ = request.sn();
+        offset_ = request.offset();
+        length_ = 0;
+    }
+    length_ += request.size();
+}
+
+bool WriteChunkBatch::Add(const std::shared_ptr<ChunkOpRequest> &opRequest,
+                          uint64_t index,
+                          ::google::protobuf::Closure *done) {
+    auto writeRequest =
+        std::dynamic_pointer_cast<WriteChunkRequest>(opRequest);
+    if (writeRequest == nullptr ||
+        !CanMerge(*writeRequest->request_,
+                  writeRequest->cntl_->request_attachment().size())) {
+        return false;
+    }
+
+    Merge(*writeRequest->request_);
+    Entry entry;
+    entry.opRequest = std::move(writeRequest);
+    entry.data = entry.opRequest->cntl_->request_attachment();
+    entry.index = index;
+    entry.done = done;
+    entries_.push_back(std::move(entry));
+    return true;
+}
+
+bool WriteChunkBatch::Add(ChunkRequest *request, const butil::IOBuf &data) {
+    if (!CanMerge(*request, data.size())) {
+        return false;
+    }
+
+    Merge(*request);
+    Entry entry;
+    entry.request.Swap(request);
+    entry.data = data;
+    entries_.push_back(std::move(entry));
+    return true;
+}
+
+void WriteChunkBatch::Apply(std::shared_ptr<CSDataStore> datastore) {
+    // IOBuf only holds references of the blocks, so no data is copied here
+    butil::IOBuf data;
+    for (const auto &entry : entries_) {
+        data.append(entry.data);
+        if (entry.opRequest != nullptr) {
+            entry.opRequest->OnApplyStart();
+        }
+    }
+
+    uint32_t cost;
+    auto ret = datastore->WriteChunk(chunkId_,
+                                     sn_,
+                                     data,
+                                     offset_,
+                                     length_,
+                                     &cost);
+    for (auto &entry : entries_) {
+        if (entry.opRequest != nullptr) {
+            entry.opRequest->OnWriteDone(entry.index, entry.done, ret);
+        } else {
+            WriteChunkRequest::OnWriteFromLogDone(entry.request, ret);
+        }
+    }
+    entries_.clear();
+}
+
 void ReadSnapshotRequest::OnApply(uint64_t index,
                                   ::google::protobuf::Closure *done) {
     brpc::ClosureGuard doneGuard(done);
-    char *readBuffer = nullptr;
     uint32_t size = request_->size();
-    readBuffer = new(std::nothrow)char[size];
-    CHECK(nullptr != readBuffer) << "new readBuffer failed, "
-                                 << errno << ":" << strerror(errno);
+    char *readBuffer = BufferPool::Get(size);
     auto ret = datastore_->ReadSnapshotChunk(request_->chunkid(),
                                              request_->sn(),
                                              readBuffer,
                                              request_->offset(),
                                              request_->size());
     butil::IOBuf wrapper;
-    wrapper.append_user_data(readBuffer, size, ReadBufferDeleter);
+    BufferPool::AppendToIOBuf(readBuffer, size, &wrapper);
 
     do {
         /**
@@ -727,7 +889,7 @@ void PasteChunkInternalRequest::OnApply(uint64_t index,
     brpc::ClosureGuard doneGuard(done);
 
     auto ret = datastore_->PasteChunk(request_->chunkid(),
-                                      data_.to_string().c_str(),  //NOLINT
+                                      data_,
                                       request_->offset(),
                                       request_->size());
 
@@ -751,7 +913,7 @@ void PasteChunkInternalRequest::OnApplyFromLog(std::shared_ptr<CSDataStore> data
                                                const butil::IOBuf &data) {
     // NOTE: 处理过程中优先使用参数传入的datastore/request
     auto ret = datastore->PasteChunk(request.chunkid(),
-                                     data.to_string().c_str(),
+                                     data,
                                      request.offset(),
                                      request.size());
     if (CSErrorCode::Success == ret)
@@ -773,25 +935,28 @@ void ScanChunkRequest::OnApply(uint64_t index,
     // read and calculate crc, build scanmap
     uint32_t crc = 0;
     size_t size = request_->size();
-    std::unique_ptr<char[]> readBuffer(new(std::nothrow)char[size]);
-    CHECK(nullptr != readBuffer)
-        << "new readBuffer failed " << strerror(errno);
-    // scan chunk metapage or user data
+    // scan chunk metapage or user data, the crc of user data may be
+    // cached by datastore if it's not written since last scan
     auto ret = 0;
     if (request_->has_readmetapage() && request_->readmetapage()) {
+        std::unique_ptr<char[]> readBuffer(new(std::nothrow)char[size]);
+        CHECK(nullptr != readBuffer)
+            << "new readBuffer failed " << strerror(errno);
         ret = datastore_->ReadChunkMetaPage(request_->chunkid(),
                                             request_->sn(),
                                             readBuffer.get());
+        if (CSErrorCode::Success == ret) {
+            crc = ::curve::common::CRC32(readBuffer.get(), size);
+        }
     } else {
-        ret = datastore_->ReadChunk(request_->chunkid(),
-                                    request_->sn(),
-                                    readBuffer.get(),
-                                    request_->offset(),
-                                    size);
+        ret = datastore_->ReadChunkCrc(request_->chunkid(),
+                                       request_->sn(),
+                                       request_->offset(),
+                                       size,
+                                       &crc);
     }
 
     if (CSErrorCode::Success == ret) {
-        crc = ::curve::common::CRC32(readBuffer.get(), size);
         // build scanmap
         ScanMap scanMap;
         scanMap.set_logicalpoolid(request_->logicpoolid());
@@ -825,26 +990,28 @@ void ScanChunkRequest::OnApplyFromLog(std::shared_ptr<CSDataStore> datastore,  /
     (void)data;
     uint32_t crc = 0;
     size_t size = request.size();
-    std::unique_ptr<char[]> readBuffer(new(std::nothrow)char[size]);
-    CHECK(nullptr != readBuffer)
-        << "new readBuffer failed " << strerror(errno);
 
     // scan chunk metapage or user data
     auto ret = 0;
     if (request.has_readmetapage() && request.readmetapage()) {
+        std::unique_ptr<char[]> readBuffer(new(std::nothrow)char[size]);
+        CHECK(nullptr != readBuffer)
+            << "new readBuffer failed " << strerror(errno);
         ret = datastore->ReadChunkMetaPage(request.chunkid(),
                                             request.sn(),
                                             readBuffer.get());
+        if (CSErrorCode::Success == ret) {
+            crc = ::curve::common::CRC32(readBuffer.get(), size);
+        }
     } else {
-        ret = datastore->ReadChunk(request.chunkid(),
-                                    request.sn(),
-                                    readBuffer.get(),
-                                    request.offset(),
-                                    size);
+        ret = datastore->ReadChunkCrc(request.chunkid(),
+                                      request.sn(),
+                                      request.offset(),
+                                      size,
+                                      &crc);
     }
 
     if (CSErrorCode::Success == ret) {
-        crc = ::curve::common::CRC32(readBuffer.get(), size);
         BuildAndSendScanMap(request, index_, crc);
     } else if (CSErrorCode::ChunkNotExistError == ret) {
         LOG(ERROR) << "scan failed: chunk not exist, "
@@ -28,9 +28,11 @@
 #include <brpc/controller.h>
 
 #include <memory>
+#include <vector>
 
 #include "proto/chunk.pb.h"
 #include "include/chunkserver/chunkserver_common.h"
+#include "src/chunkserver/chunkserver_metrics.h"
 #include "src/chunkserver/concurrent_apply/concurrent_apply.h"
 #include "src/chunkserver/datastore/define.h"
 #include "src/chunkserver/scan_manager.h"
@@ -123,6 +125,11 @@ class ChunkOpRequest : public std::enable_shared_from_this<ChunkOpRequest> {
      */
     virtual void RedirectChunkRequest();
 
+    /**
+     * raft日志已提交或者lease read的请求不经过raft，请求进入apply队列
+     */
+    void OnCommitted();
+
  public:
     /**
      * Op序列化工具函数
@@ -169,6 +176,17 @@ class ChunkOpRequest : public std::enable_shared_from_this<ChunkOpRequest> {
     int Propose(const ChunkRequest *request,
                 const butil::IOBuf *data);
 
+    /**
+     * 请求在apply队列中开始执行
+     */
+    void OnApplyStart();
+
+    /**
+     * datastore执行完成，记录各阶段的延时，慢请求按采样打印各阶段的时间戳
+     * @param type: 请求对应的metric类型
+     */
+    void OnStoreDone(CSIOMetricType type);
+
  protected:
     // chunk持久化接口
     std::shared_ptr<CSDataStore> datastore_;
@@ -182,6 +200,8 @@ class ChunkOpRequest : public std::enable_shared_from_this<ChunkOpRequest> {
     ChunkResponse *response_;
     // rpc done closure
     ::google::protobuf::Closure *done_;
+    // 请求经过各阶段时的时间戳，从日志中解析出的请求不统计
+    OpStageTrace trace_;
 };
 
 class DeleteChunkRequest : public ChunkOpRequest {
@@ -212,7 +232,7 @@ class ReadChunkRequest : public ChunkOpRequest {
 
  public:
     ReadChunkRequest() :
-        ChunkOpRequest() {}
+        ChunkOpRequest(), followerRead_(false) {}
     ReadChunkRequest(std::shared_ptr<CopysetNode> nodePtr,
                      CloneManager* cloneMgr,
                      RpcController *cntl,
@@ -237,6 +257,8 @@ class ReadChunkRequest : public ChunkOpRequest {
     bool NeedClone(const CSChunkInfo& chunkInfo);
     // 从chunk文件中读数据
     void ReadChunk();
+    // 在follower上处理读请求
+    void ReadFromFollower(::google::protobuf::Closure *done);
 
  private:
     CloneManager* cloneMgr_;
@@ -244,9 +266,13 @@ class ReadChunkRequest : public ChunkOpRequest {
     ConcurrentApplyModule* concurrentApplyModule_;
     // 保存 apply index
     uint64_t applyIndex;
+    // 是否在follower上处理的读请求
+    bool followerRead_;
 };
 
 class WriteChunkRequest : public ChunkOpRequest {
+    friend class WriteChunkBatch;
+
  public:
     WriteChunkRequest() :
         ChunkOpRequest() {}
@@ -266,6 +292,87 @@ class WriteChunkRequest : public ChunkOpRequest {
     void OnApplyFromLog(std::shared_ptr<CSDataStore> datastore,
                         const ChunkRequest &request,
                         const butil::IOBuf &data) override;
+
+ private:
+    // 根据datastore的返回值设置response并调用done
+    void OnWriteDone(uint64_t index, ::google::protobuf::Closure *done,
+                     CSErrorCode ret);
+    static void OnWriteFromLogDone(const ChunkRequest &request,
+                                   CSErrorCode ret);
+};
+
+/**
+ * Consecutive writes in one apply batch which target adjacent ranges of the
+ * same chunk, they are written to the datastore with one merged write and
+ * then every request is completed with the result of the merged write.
+ * Only plain writes are merged: same sn, block aligned, inside the chunk
+ * and without clone source, so that the result of the merged write is the
+ * same as applying the writes one by one.
+ */
+class WriteChunkBatch {
+ public:
+    /**
+     * @param blockSize: alignment for I/O request
+     * @param chunkSize: size of chunk file
+     * @param maxSize: max bytes of the merged write
+     */
+    WriteChunkBatch(uint32_t blockSize, uint32_t chunkSize, uint32_t maxSize)
+        : blockSize_(blockSize), chunkSize_(chunkSize), maxSize_(maxSize),
+          chunkId_(0), sn_(0), offset_(0), length_(0) {}
+
+    /**
+     * @brief append a write to the batch, the request context is in memory
+     * @param opRequest: the WriteChunkRequest
+     * @param index: log entry index
+     * @param done: closure of the request
+     * @return true if appended, false if it can't be merged with the batch
+     */
+    bool Add(const std::shared_ptr<ChunkOpRequest> &opRequest,
+             uint64_t index,
+             ::google::protobuf::Closure *done);
+
+    /**
+     * @brief append a write decoded from log entry
+     * @param request: decoded request, it is swapped out if appended
+     * @param data: data of the request
+     * @return true if appended, false if it can't be merged with the batch
+     */
+    bool Add(ChunkRequest *request, const butil::IOBuf &data);
+
+    bool Empty() const { return entries_.empty(); }
+
+    size_t Size() const { return entries_.size(); }
+
+    ChunkID ChunkId() const { return chunkId_; }
+
+    /**
+     * @brief write the merged data to datastore and complete the requests
+     */
+    void Apply(std::shared_ptr<CSDataStore> datastore);
+
+ private:
+    struct Entry {
+        // nullptr if the entry is decoded from log
+        std::shared_ptr<WriteChunkRequest> opRequest;
+        ChunkRequest request;
+        butil::IOBuf data;
+        uint64_t index = 0;
+        ::google::protobuf::Closure *done = nullptr;
+    };
+
+    bool CanMerge(const ChunkRequest &request, size_t dataSize) const;
+
+    void Merge(const ChunkRequest &request);
+
+ private:
+    const uint32_t blockSize_;
+    const uint32_t chunkSize_;
+    const uint32_t maxSize_;
+    ChunkID chunkId_;
+    SequenceNum sn_;
+    off_t offset_;
+    size_t length_;
+    std::vector<Entry> entries_;
 };
 
 class ReadSnapshotRequest : public ChunkOpRequest {
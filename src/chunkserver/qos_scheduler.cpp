@@ -0,0 +1,331 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/chunkserver/qos_scheduler.h"
+
+#include <bthread/bthread.h>
+#include <bthread/unstable.h>
+#include <butil/time.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+#include "src/common/timeutility.h"
+
+namespace curve {
+namespace chunkserver {
+
+using curve::common::TimeUtility;
+
+namespace {
+
+const double kUsPerSecond = 1000000.0;
+const double kInfiniteTag = std::numeric_limits<double>::max();
+
+}  // namespace
+
+// 请求处理完时先返回rpc，再通知调度器处理下一个请求
+class QosDoneClosure : public google::protobuf::Closure {
+ public:
+    QosDoneClosure(QosScheduler* scheduler, google::protobuf::Closure* done)
+        : scheduler_(scheduler), done_(done) {}
+
+    void Run() override {
+        std::unique_ptr<QosDoneClosure> selfGuard(this);
+        if (done_ != nullptr) {
+            done_->Run();
+        }
+        scheduler_->OnComplete();
+    }
+
+ private:
+    QosScheduler* scheduler_;
+    google::protobuf::Closure* done_;
+};
+
+QosScheduler::QosScheduler()
+    : inflight_(0)
+    , stopped_(false)
+    , timerArmed_(false)
+    , timerUs_(0)
+    , timer_(0)
+    , rejectedCount_("chunkserver_qos_rejected_count") {}
+
+QosScheduler::~QosScheduler() {
+    Fini();
+}
+
+int QosScheduler::Init(const QosSchedulerOptions& options) {
+    if (options.maxInflight == 0 || options.maxQueueDepth == 0) {
+        LOG(ERROR) << "Invalid qos scheduler options, max inflight: "
+                   << options.maxInflight
+                   << ", max queue depth: " << options.maxQueueDepth;
+        return -1;
+    }
+    std::lock_guard<std::mutex> lk(mtx_);
+    options_ = options;
+    if (options_.defaultParams.weight == 0) {
+        options_.defaultParams.weight = 1;
+    }
+    stopped_ = false;
+    return 0;
+}
+
+void QosScheduler::Fini() {
+    std::vector<Request> requests;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (stopped_) {
+            return;
+        }
+        stopped_ = true;
+        if (timerArmed_) {
+            bthread_timer_del(timer_);
+            timerArmed_ = false;
+        }
+        for (Client* client : active_) {
+            for (auto& request : client->queue) {
+                requests.emplace_back(std::move(request));
+            }
+            client->queue.clear();
+        }
+        active_.clear();
+        inflight_ += requests.size();
+    }
+    RunRequests(&requests, true);
+}
+
+bool QosScheduler::Submit(LogicPoolID poolId,
+                          CopysetID copysetId,
+                          google::protobuf::Closure* done,
+                          Task task) {
+    std::vector<Request> picked;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (stopped_) {
+            picked.push_back(Request{std::move(task), done, 0, 0, 0});
+            ++inflight_;
+        } else {
+            auto iter = clients_.find({poolId, copysetId});
+            if (iter == clients_.end()) {
+                iter = clients_.emplace(std::make_pair(poolId, copysetId),
+                                        Client()).first;
+                iter->second.params = options_.defaultParams;
+            }
+            Client* client = &iter->second;
+            if (client->queue.size() >= options_.maxQueueDepth) {
+                rejectedCount_ << 1;
+                return false;
+            }
+
+            double now = TimeUtility::GetTimeofDayUs();
+            const QosParams& params = client->params;
+            Request request{std::move(task), done, kInfiniteTag, 0, 0};
+            if (params.reservation > 0) {
+                client->reservationTag = std::max(
+                    client->reservationTag + kUsPerSecond / params.reservation,
+                    now);
+                request.reservationTag = client->reservationTag;
+            }
+            if (params.limit > 0) {
+                client->limitTag = std::max(
+                    client->limitTag + kUsPerSecond / params.limit, now);
+                request.limitTag = client->limitTag;
+            }
+            if (client->queue.empty()) {
+                // 刚开始有请求的copyset从其他copyset的进度开始分配，
+                // 避免空闲期间积累的份额一次性挤占其他copyset
+                client->weightTag = MinWeightTagLocked(now);
+                active_.insert(client);
+            } else {
+                client->weightTag += kUsPerSecond / params.weight;
+            }
+            request.weightTag = client->weightTag;
+            client->queue.emplace_back(std::move(request));
+            PickLocked(&picked);
+        }
+    }
+    RunRequests(&picked, true);
+    return true;
+}
+
+void QosScheduler::UpdateParams(LogicPoolID poolId,
+                                CopysetID copysetId,
+                                const QosParams& params) {
+    QosParams newParams = params;
+    if (newParams.weight == 0) {
+        newParams.weight = 1;
+    }
+    std::lock_guard<std::mutex> lk(mtx_);
+    Client& client = clients_[{poolId, copysetId}];
+    if (client.params == newParams) {
+        return;
+    }
+    LOG(INFO) << "Update qos of copyset(" << poolId << "," << copysetId
+              << "), reservation: " << newParams.reservation
+              << ", limit: " << newParams.limit
+              << ", weight: " << newParams.weight;
+    client.params = newParams;
+}
+
+uint64_t QosScheduler::GetInflight() {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return inflight_;
+}
+
+uint64_t QosScheduler::GetQueued(LogicPoolID poolId, CopysetID copysetId) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    auto iter = clients_.find({poolId, copysetId});
+    return iter == clients_.end() ? 0 : iter->second.queue.size();
+}
+
+void QosScheduler::OnComplete() {
+    std::vector<Request> picked;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        --inflight_;
+        if (!stopped_) {
+            PickLocked(&picked);
+        }
+    }
+    RunRequests(&picked, false);
+}
+
+double QosScheduler::MinWeightTagLocked(double now) const {
+    double minTag = kInfiniteTag;
+    for (const Client* client : active_) {
+        minTag = std::min(minTag, client->queue.front().weightTag);
+    }
+    return minTag == kInfiniteTag ? now : minTag;
+}
+
+void QosScheduler::PickLocked(std::vector<Request>* picked) {
+    double now = TimeUtility::GetTimeofDayUs();
+    while (inflight_ < options_.maxInflight && !active_.empty()) {
+        // 先满足reservation
+        Client* chosen = nullptr;
+        for (Client* client : active_) {
+            const Request& head = client->queue.front();
+            if (head.reservationTag <= now &&
+                (chosen == nullptr ||
+                 head.reservationTag <
+                     chosen->queue.front().reservationTag)) {
+                chosen = client;
+            }
+        }
+        bool byWeight = false;
+        // 再在没有超过limit的copyset之间按权重分配
+        if (chosen == nullptr) {
+            byWeight = true;
+            for (Client* client : active_) {
+                const Request& head = client->queue.front();
+                if (head.limitTag <= now &&
+                    (chosen == nullptr ||
+                     head.weightTag < chosen->queue.front().weightTag)) {
+                    chosen = client;
+                }
+            }
+        }
+        if (chosen == nullptr) {
+            // 都超过了limit，等最早的一个到期
+            double nextUs = kInfiniteTag;
+            for (Client* client : active_) {
+                nextUs = std::min(nextUs, client->queue.front().limitTag);
+            }
+            ArmTimerLocked(nextUs);
+            return;
+        }
+
+        picked->emplace_back(std::move(chosen->queue.front()));
+        chosen->queue.pop_front();
+        ++inflight_;
+        // 按权重处理的请求不计入reservation，后面的请求相应提前
+        if (byWeight && chosen->params.reservation > 0) {
+            double delta = kUsPerSecond / chosen->params.reservation;
+            for (auto& request : chosen->queue) {
+                request.reservationTag -= delta;
+            }
+            chosen->reservationTag -= delta;
+        }
+        if (chosen->queue.empty()) {
+            active_.erase(chosen);
+        }
+    }
+}
+
+void QosScheduler::ArmTimerLocked(double atUs) {
+    if (timerArmed_) {
+        if (atUs >= timerUs_) {
+            return;
+        }
+        // 有更早到期的请求，定时器已经在运行时删除会失败，不影响正确性
+        if (bthread_timer_del(timer_) != 0) {
+            return;
+        }
+    }
+    timespec abstime =
+        butil::microseconds_to_timespec(static_cast<int64_t>(atUs));
+    if (bthread_timer_add(&timer_, abstime, OnTimer, this) != 0) {
+        LOG(ERROR) << "Add qos scheduler timer failed";
+        timerArmed_ = false;
+        return;
+    }
+    timerArmed_ = true;
+    timerUs_ = atUs;
+}
+
+void QosScheduler::OnTimer(void* arg) {
+    QosScheduler* scheduler = static_cast<QosScheduler*>(arg);
+    std::vector<Request> picked;
+    {
+        std::lock_guard<std::mutex> lk(scheduler->mtx_);
+        scheduler->timerArmed_ = false;
+        if (!scheduler->stopped_) {
+            scheduler->PickLocked(&picked);
+        }
+    }
+    scheduler->RunRequests(&picked, false);
+}
+
+void QosScheduler::RunRequests(std::vector<Request>* requests, bool inplace) {
+    for (auto& request : *requests) {
+        request.done = new QosDoneClosure(this, request.done);
+        if (!inplace) {
+            Request* arg = new Request(std::move(request));
+            bthread_t tid;
+            if (bthread_start_background(&tid, nullptr, RunRequest, arg) == 0) {
+                continue;
+            }
+            LOG(WARNING) << "Start bthread for qos request failed, "
+                         << "run it in place";
+            request = std::move(*arg);
+            delete arg;
+        }
+        request.task(request.done);
+    }
+    requests->clear();
+}
+
+void* QosScheduler::RunRequest(void* arg) {
+    std::unique_ptr<Request> request(static_cast<Request*>(arg));
+    request->task(request->done);
+    return nullptr;
+}
+
+}  // namespace chunkserver
+}  // namespace curve
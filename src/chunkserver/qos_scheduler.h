@@ -0,0 +1,172 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_CHUNKSERVER_QOS_SCHEDULER_H_
+#define SRC_CHUNKSERVER_QOS_SCHEDULER_H_
+
+#include <bthread/types.h>
+#include <bvar/bvar.h>
+#include <google/protobuf/stubs/callback.h>
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>  // NOLINT
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "include/chunkserver/chunkserver_common.h"
+
+namespace curve {
+namespace chunkserver {
+
+struct QosParams {
+    // 每秒保证处理的请求数，为0表示不保证
+    uint32_t reservation = 0;
+    // 每秒最多处理的请求数，为0表示不限制
+    uint32_t limit = 0;
+    // 保证之外的处理能力按权重在copyset之间分配
+    uint32_t weight = 1;
+
+    bool operator==(const QosParams& rhs) const {
+        return reservation == rhs.reservation && limit == rhs.limit &&
+               weight == rhs.weight;
+    }
+};
+
+struct QosSchedulerOptions {
+    // 同时在处理的请求数上限
+    uint32_t maxInflight = 256;
+    // 每个copyset排队的请求数上限，超过时拒绝请求
+    uint32_t maxQueueDepth = 1024;
+    // MDS没有下发参数的copyset使用的参数
+    QosParams defaultParams;
+};
+
+/**
+ * 按mClock算法调度copyset的读写请求，在各copyset之间隔离负载：
+ * 1. 每个请求到达时按所在copyset的参数打上reservation、limit和
+ *    weight三个时间标签
+ * 2. 有处理能力时，优先处理reservation标签已到期的请求，保证每个
+ *    copyset的最低处理速率
+ * 3. 否则在limit标签已到期的请求中选weight标签最小的，按权重分配
+ *    剩余的处理能力，同时不超过copyset的上限
+ * 一个copyset的请求再多也只能占满自己的队列，不会挤占其他copyset。
+ */
+class QosScheduler {
+ public:
+    // 请求被调度时执行，task处理完请求后必须调用传入的closure
+    using Task = std::function<void(google::protobuf::Closure*)>;
+
+    QosScheduler();
+    ~QosScheduler();
+
+    int Init(const QosSchedulerOptions& options);
+
+    /**
+     * @brief 停止调度，排队的请求全部立即执行
+     */
+    void Fini();
+
+    /**
+     * @brief 把请求加入所在copyset的队列
+     * @param done: 请求处理完时调用
+     * @param task: 请求被调度时执行
+     * @return 队列已满返回false，请求没有被接受，由调用者处理done
+     */
+    bool Submit(LogicPoolID poolId,
+                CopysetID copysetId,
+                google::protobuf::Closure* done,
+                Task task);
+
+    /**
+     * @brief 更新copyset的QoS参数，由MDS通过心跳下发
+     */
+    void UpdateParams(LogicPoolID poolId,
+                      CopysetID copysetId,
+                      const QosParams& params);
+
+    // 正在处理的请求数
+    uint64_t GetInflight();
+
+    // copyset排队的请求数
+    uint64_t GetQueued(LogicPoolID poolId, CopysetID copysetId);
+
+ private:
+    friend class QosDoneClosure;
+
+    struct Request {
+        Task task;
+        google::protobuf::Closure* done;
+        double reservationTag;
+        double limitTag;
+        double weightTag;
+    };
+
+    struct Client {
+        QosParams params;
+        std::deque<Request> queue;
+        // 最近一个请求的标签
+        double reservationTag = 0;
+        double limitTag = 0;
+        double weightTag = 0;
+    };
+
+    // 请求处理完成，调度下一个请求
+    void OnComplete();
+
+    /**
+     * @brief 在处理能力内选出可以执行的请求，都被限速时设置定时器
+     * @param picked: 选出的请求
+     */
+    void PickLocked(std::vector<Request>* picked);
+
+    // 所有排队请求中最小的weight标签
+    double MinWeightTagLocked(double now) const;
+
+    void ArmTimerLocked(double atUs);
+
+    static void OnTimer(void* arg);
+
+    /**
+     * @brief 执行选出的请求
+     * @param inplace: 为true时在当前线程执行，否则每个请求启动一个bthread，
+     *                 避免在请求完成的回调或定时器线程里处理新的请求
+     */
+    void RunRequests(std::vector<Request>* requests, bool inplace);
+
+    static void* RunRequest(void* arg);
+
+    QosSchedulerOptions options_;
+
+    std::mutex mtx_;
+    std::map<std::pair<LogicPoolID, CopysetID>, Client> clients_;
+    // 有请求在排队的copyset
+    std::unordered_set<Client*> active_;
+    uint64_t inflight_;
+    bool stopped_;
+    bool timerArmed_;
+    double timerUs_;
+    bthread_timer_t timer_;
+
+    bvar::Adder<uint64_t> rejectedCount_;
+};
+
+}  // namespace chunkserver
+}  // namespace curve
+
+#endif  // SRC_CHUNKSERVER_QOS_SCHEDULER_H_
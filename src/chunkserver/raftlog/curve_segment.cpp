@@ -39,12 +39,15 @@
 //          Xiong,Kai(xiongkai@baidu.com)
 
 #include <fcntl.h>
+#include <sys/mman.h>
+#include <butil/crc32c.h>
 #include <butil/fd_utility.h>
 #include <butil/raw_pack.h>
 #include <braft/local_storage.pb.h>
 #include <braft/fsync.h>
 #include "src/chunkserver/raftlog/curve_segment.h"
 #include "src/chunkserver/raftlog/define.h"
+#include "src/chunkserver/datastore/buffer_pool.h"
 
 namespace curve {
 namespace chunkserver {
@@ -52,6 +55,25 @@ namespace chunkserver {
 DEFINE_bool(raftSyncSegments, true, "call fsync when a segment is closed");
 DEFINE_bool(enableWalDirectWrite, true, "enable wal direct write or not");
 DEFINE_uint32(walAlignSize, 4096, "wal align size to write");
+DEFINE_uint32(walMaxBatchBytes, 1024 * 1024,
+              "max bytes of entries appended to wal with one write");
+
+namespace {
+
+// magic of the index in meta page, which is "CSIX"
+const uint32_t kSegmentIndexMagic = 0x43534958;
+
+CurveSegmentIndexEntry make_index_entry(int64_t offset, int type,
+                                        int64_t term) {
+    CurveSegmentIndexEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.offset = static_cast<uint32_t>(offset);
+    entry.type = static_cast<uint8_t>(type);
+    entry.term = term;
+    return entry;
+}
+
+}  // namespace
 
 int CurveSegment::create() {
     if (!_is_open) {
@@ -144,6 +166,19 @@ int CurveSegment::load(braft::ConfigurationManager* configuration_manager) {
         return -1;
     }
 
+    // closed segment with index, only configurations need to be read
+    if (!_is_open && _load_index() == 0) {
+        for (int64_t i = _first_index; i <= _last_index.load(); ++i) {
+            const CurveSegmentIndexEntry& entry = _index_at(i - _first_index);
+            if (entry.type == braft::ENTRY_TYPE_CONFIGURATION &&
+                _load_configuration(i, entry.offset,
+                                    configuration_manager) != 0) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+
     // load entry index
     int64_t load_size = _meta.bytes;
     int64_t entry_off = _meta_page_size;
@@ -169,28 +204,13 @@ int CurveSegment::load(braft::ConfigurationManager* configuration_manager) {
             break;
         }
         if (header.type == braft::ENTRY_TYPE_CONFIGURATION) {
-            butil::IOBuf data;
-            // Header will be parsed again but it's fine as configuration
-            // changing is rare
-            if (_load_entry(entry_off, NULL, &data,
-                            header_size + header.data_real_len) != 0) {
-                break;
-            }
-            scoped_refptr<braft::LogEntry> entry = new braft::LogEntry();
-            entry->id.index = i;
-            entry->id.term = header.term;
-            butil::Status status = parse_configuration_meta(data, entry);
-            if (status.ok()) {
-                braft::ConfigurationEntry conf_entry(*entry);
-                configuration_manager->add(conf_entry);
-            } else {
-                LOG(ERROR) << "fail to parse configuration meta, path: "
-                           << _path << " entry_off " << entry_off;
-                ret = -1;
+            ret = _load_configuration(i, entry_off, configuration_manager);
+            if (ret != 0) {
                 break;
             }
         }
-        _offset_and_term.push_back(std::make_pair(entry_off, header.term));
+        _offset_and_term.push_back(
+            make_index_entry(entry_off, header.type, header.term));
         ++actual_last_index;
         entry_off += skip_len;
     }
@@ -236,11 +256,171 @@ int CurveSegment::_load_meta() {
         return -1;
     }
     memcpy(&_meta.bytes, metaPage, sizeof(_meta.bytes));
+    uint32_t index_meta[3];
+    memcpy(index_meta, metaPage + sizeof(_meta.bytes), sizeof(index_meta));
+    if (index_meta[0] == kSegmentIndexMagic) {
+        _meta.index_count = index_meta[1];
+        _meta.index_checksum = index_meta[2];
+    } else {
+        _meta.index_count = 0;
+        _meta.index_checksum = 0;
+    }
     delete[] metaPage;
-    LOG(INFO) << "loaded bytes: " << _meta.bytes;
+    LOG(INFO) << "loaded bytes: " << _meta.bytes
+              << ", index count: " << _meta.index_count;
+    return 0;
+}
+
+int CurveSegment::_load_configuration(
+        int64_t index, int64_t offset,
+        braft::ConfigurationManager* configuration_manager) {
+    EntryHeader header;
+    if (_load_entry(offset, &header, NULL, kEntryHeaderSize) != 0) {
+        LOG(ERROR) << "fail to load configuration header, path: " << _path
+                   << " entry_off " << offset;
+        return -1;
+    }
+    butil::IOBuf data;
+    // Header will be parsed again but it's fine as configuration
+    // changing is rare
+    if (_load_entry(offset, NULL, &data,
+                    kEntryHeaderSize + header.data_real_len) != 0) {
+        LOG(ERROR) << "fail to load configuration, path: " << _path
+                   << " entry_off " << offset;
+        return -1;
+    }
+    scoped_refptr<braft::LogEntry> entry = new braft::LogEntry();
+    entry->id.index = index;
+    entry->id.term = header.term;
+    butil::Status status = parse_configuration_meta(data, entry);
+    if (!status.ok()) {
+        LOG(ERROR) << "fail to parse configuration meta, path: "
+                   << _path << " entry_off " << offset;
+        return -1;
+    }
+    braft::ConfigurationEntry conf_entry(*entry);
+    configuration_manager->add(conf_entry);
+    return 0;
+}
+
+size_t CurveSegment::index_size(int64_t entry_num) {
+    size_t size = entry_num * sizeof(CurveSegmentIndexEntry);
+    if (size % FLAGS_walAlignSize != 0) {
+        size = (size / FLAGS_walAlignSize + 1) * FLAGS_walAlignSize;
+    }
+    return size;
+}
+
+int CurveSegment::_save_index() {
+    const size_t count = _offset_and_term.size();
+    if (count == 0) {
+        return 0;
+    }
+    const size_t data_size = count * sizeof(CurveSegmentIndexEntry);
+    const size_t to_write = index_size(count);
+    const uint64_t file_size = _walFilePool->GetFilePoolOpt().fileSize
+                             + _meta_page_size;
+    if (_meta.bytes + to_write > file_size) {
+        LOG(INFO) << "No room for index of segment, path: " << _path
+                  << ", bytes: " << _meta.bytes << ", index size: "
+                  << to_write;
+        return 0;
+    }
+
+    char* buf = nullptr;
+    int ret = posix_memalign(reinterpret_cast<void **>(&buf),
+                             FLAGS_walAlignSize, to_write);
+    LOG_IF(FATAL, ret < 0 || buf == nullptr)
+        << "posix_memalign WAL index buffer failed " << strerror(ret);
+    memset(buf, 0, to_write);
+    memcpy(buf, _offset_and_term.data(), data_size);
+    const int fd = FLAGS_enableWalDirectWrite ? _direct_fd : _fd;
+    ret = ::pwrite(fd, buf, to_write, _meta.bytes);
+    const uint32_t checksum = butil::crc32c::Value(buf, data_size);
+    free(buf);
+    if (ret != static_cast<int>(to_write)) {
+        LOG(ERROR) << "Fail to write index into fd=" << fd
+                   << ", path: " << _path << berror();
+        return -1;
+    }
+    if (!FLAGS_enableWalDirectWrite && braft::raft_fsync(_fd) != 0) {
+        LOG(ERROR) << "Fail to sync index, path: " << _path << berror();
+        return -1;
+    }
+
+    // the index is valid only after the meta page points to it
+    char* metaPage = nullptr;
+    ret = posix_memalign(reinterpret_cast<void **>(&metaPage),
+                         FLAGS_walAlignSize, _meta_page_size);
+    LOG_IF(FATAL, ret < 0 || metaPage == nullptr)
+        << "posix_memalign WAL meta page failed " << strerror(ret);
+    memset(metaPage, 0, _meta_page_size);
+    memcpy(metaPage, &_meta.bytes, sizeof(_meta.bytes));
+    const uint32_t index_meta[3] = {
+        kSegmentIndexMagic, static_cast<uint32_t>(count), checksum};
+    memcpy(metaPage + sizeof(_meta.bytes), index_meta, sizeof(index_meta));
+    ret = ::pwrite(fd, metaPage, _meta_page_size, 0);
+    free(metaPage);
+    if (ret != static_cast<int>(_meta_page_size)) {
+        LOG(ERROR) << "Fail to write meta page with index into fd=" << fd
+                   << ", path: " << _path << berror();
+        return -1;
+    }
+    _meta.index_count = count;
+    _meta.index_checksum = checksum;
     return 0;
 }
 
+int CurveSegment::_load_index() {
+    const int64_t count = _last_index.load() - _first_index + 1;
+    if (_meta.index_count == 0 || count != _meta.index_count) {
+        return -1;
+    }
+    const size_t data_size = count * sizeof(CurveSegmentIndexEntry);
+    const off_t page_size = sysconf(_SC_PAGESIZE);
+    const off_t map_offset = _meta.bytes / page_size * page_size;
+    const size_t delta = _meta.bytes - map_offset;
+    void* addr = ::mmap(nullptr, data_size + delta, PROT_READ, MAP_SHARED,
+                        _fd, map_offset);
+    if (addr == MAP_FAILED) {
+        LOG(WARNING) << "Fail to mmap index, path: " << _path << berror();
+        return -1;
+    }
+    const CurveSegmentIndexEntry* index =
+        reinterpret_cast<const CurveSegmentIndexEntry*>(
+            static_cast<char*>(addr) + delta);
+    bool valid = butil::crc32c::Value(reinterpret_cast<const char*>(index),
+                                      data_size) == _meta.index_checksum &&
+                 index[0].offset == _meta_page_size;
+    for (int64_t i = 1; valid && i < count; ++i) {
+        valid = index[i].offset > index[i - 1].offset &&
+                index[i].offset < _meta.bytes;
+    }
+    if (!valid) {
+        LOG(WARNING) << "Found corrupted index, scan the entries instead"
+                     << ", path: " << _path;
+        ::munmap(addr, data_size + delta);
+        return -1;
+    }
+
+    BAIDU_SCOPED_LOCK(_mutex);
+    _mmap_addr = addr;
+    _mmap_size = data_size + delta;
+    _mapped_index = index;
+    LOG(INFO) << "Loaded index of segment, path: " << _path
+              << ", entries: " << count;
+    return 0;
+}
+
+void CurveSegment::_unmap_index() {
+    if (_mmap_addr != nullptr) {
+        ::munmap(_mmap_addr, _mmap_size);
+        _mmap_addr = nullptr;
+        _mmap_size = 0;
+        _mapped_index = nullptr;
+    }
+}
+
 inline bool verify_checksum(int checksum_type,
                             const char* data, size_t len, uint32_t value) {
     switch (checksum_type) {
@@ -370,26 +550,25 @@ int CurveSegment::_load_entry(off_t offset, EntryHeader* head,
     return 0;
 }
 
-int CurveSegment::append(const braft::LogEntry* entry) {
-    if (BAIDU_UNLIKELY(!entry || !_is_open)) {
-        return EINVAL;
-    } else if (entry->id.index !=
-                    _last_index.load(butil::memory_order_consume) + 1) {
-        CHECK(false) << "entry->index=" << entry->id.index
-                  << " _last_index=" << _last_index
-                  << " _first_index=" << _first_index;
-        return ERANGE;
+size_t CurveSegment::aligned_entry_size(size_t data_size) {
+    size_t size = kEntryHeaderSize + data_size;
+    if (size % FLAGS_walAlignSize != 0) {
+        size = (size / FLAGS_walAlignSize + 1) * FLAGS_walAlignSize;
     }
-    butil::IOBuf data;
+    return size;
+}
+
+int CurveSegment::_pack_entry(const braft::LogEntry* entry, char* header,
+                              butil::IOBuf* data) {
     switch (entry->type) {
     case braft::ENTRY_TYPE_DATA:
-        data.append(entry->data);
+        data->append(entry->data);
         break;
     case braft::ENTRY_TYPE_NO_OP:
         break;
     case braft::ENTRY_TYPE_CONFIGURATION:
         {
-            butil::Status status = serialize_configuration_meta(entry, data);
+            butil::Status status = serialize_configuration_meta(entry, *data);
             if (!status.ok()) {
                 LOG(ERROR) << "Fail to serialize ConfigurationPBMeta, path: "
                            << _path;
@@ -402,73 +581,119 @@ int CurveSegment::append(const braft::LogEntry* entry) {
                    << ", path: " << _path;
         return -1;
     }
-    uint32_t data_check_sum = get_checksum(_checksum_type, data);
-    uint32_t real_length = data.length();
-    size_t to_write = kEntryHeaderSize + data.length();
-    uint32_t zero_bytes_num = 0;
+    uint32_t data_check_sum = get_checksum(_checksum_type, *data);
+    uint32_t real_length = data->length();
     // 4KB alignment
-    if (to_write % FLAGS_walAlignSize != 0) {
-        zero_bytes_num = (to_write / FLAGS_walAlignSize + 1) *
-                                        FLAGS_walAlignSize - to_write;
-    }
-    data.resize(data.length() + zero_bytes_num);
-    to_write = kEntryHeaderSize + data.length();
-    CHECK_LE(data.length(), 1ul << 56ul);
-    char* write_buf = nullptr;
-    if (FLAGS_enableWalDirectWrite) {
-        int ret = posix_memalign(reinterpret_cast<void **>(&write_buf),
-                                 FLAGS_walAlignSize, to_write);
-        LOG_IF(FATAL, ret < 0 || write_buf == nullptr)
-        << "posix_memalign WAL write buffer failed " << strerror(ret);
-    } else {
-        write_buf = new char[kEntryHeaderSize];
-    }
+    size_t to_write = aligned_entry_size(real_length);
+    data->resize(to_write - kEntryHeaderSize);
+    CHECK_LE(data->length(), 1ul << 56ul);
 
     const uint32_t meta_field = (entry->type << 24) | (_checksum_type << 16);
-    butil::RawPacker packer(write_buf);
+    butil::RawPacker packer(header);
     packer.pack64(entry->id.term)
           .pack32(meta_field)
-          .pack32((uint32_t)data.length())
+          .pack32((uint32_t)data->length())
           .pack32(real_length)
           .pack32(data_check_sum);
     packer.pack32(get_checksum(
-                  _checksum_type, write_buf, kEntryHeaderSize - 4));
+                  _checksum_type, header, kEntryHeaderSize - 4));
+    return 0;
+}
+
+int CurveSegment::append(const braft::LogEntry* entry) {
+    return append_entries(&entry, 1);
+}
+
+int CurveSegment::append_entries(const braft::LogEntry* const* entries,
+                                 size_t count) {
+    if (BAIDU_UNLIKELY(!entries || count == 0 || !_is_open)) {
+        return EINVAL;
+    }
+    const int64_t last_index = _last_index.load(butil::memory_order_consume);
+    for (size_t i = 0; i < count; ++i) {
+        if (BAIDU_UNLIKELY(!entries[i])) {
+            return EINVAL;
+        } else if (entries[i]->id.index !=
+                        last_index + 1 + static_cast<int64_t>(i)) {
+            CHECK(false) << "entry->index=" << entries[i]->id.index
+                      << " _last_index=" << last_index + i
+                      << " _first_index=" << _first_index;
+            return ERANGE;
+        }
+    }
+
+    // serialize all entries first, then write them with one I/O, every
+    // entry is still padded to walAlignSize, so the layout on disk is the
+    // same as appending them one by one
+    std::vector<butil::IOBuf> datas(count);
+    std::vector<char> headers(count * kEntryHeaderSize);
+    std::vector<size_t> sizes(count);
+    size_t to_write = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (_pack_entry(entries[i], &headers[i * kEntryHeaderSize],
+                        &datas[i]) != 0) {
+            return -1;
+        }
+        sizes[i] = kEntryHeaderSize + datas[i].length();
+        to_write += sizes[i];
+    }
+
     if (FLAGS_enableWalDirectWrite) {
-        data.copy_to(write_buf + kEntryHeaderSize, real_length);
+        // buffers of the pool are aligned to pages, enough for the wal
+        // aligned to at most a page
+        char* write_buf = nullptr;
+        bool pooled = FLAGS_walAlignSize <= BufferPool::kAlignment;
+        if (pooled) {
+            write_buf = BufferPool::Get(to_write);
+        } else {
+            int ret = posix_memalign(reinterpret_cast<void **>(&write_buf),
+                                     FLAGS_walAlignSize, to_write);
+            LOG_IF(FATAL, ret != 0 || write_buf == nullptr)
+            << "posix_memalign WAL write buffer failed " << strerror(ret);
+        }
+        size_t pos = 0;
+        for (size_t i = 0; i < count; ++i) {
+            memcpy(write_buf + pos, &headers[i * kEntryHeaderSize],
+                   kEntryHeaderSize);
+            datas[i].copy_to(write_buf + pos + kEntryHeaderSize);
+            pos += sizes[i];
+        }
         int ret = ::pwrite(_direct_fd, write_buf, to_write, _meta.bytes);
-        free(write_buf);
+        if (pooled) {
+            BufferPool::Release(write_buf, to_write);
+        } else {
+            free(write_buf);
+        }
         if (ret != static_cast<int>(to_write)) {
             LOG(ERROR) << "Fail to write directly to fd=" << _direct_fd
-                       << ", buf=" << static_cast<void*>(write_buf)
+                       << ", entries=" << count
                        << ", size=" << to_write << ", offset=" << _meta.bytes
                        << ", error=" << berror();
             return -1;
         }
     } else {
-        butil::IOBuf header;
-        header.append(write_buf, kEntryHeaderSize);
-        delete write_buf;
-        butil::IOBuf* pieces[2] = { &header, &data };
-        size_t start = 0;
-        ssize_t written = 0;
-        while (written < (ssize_t)to_write) {
-            const ssize_t n = butil::IOBuf::cut_multiple_into_file_descriptor(
-                    _fd, pieces + start, ARRAY_SIZE(pieces) - start);
+        butil::IOBuf buf;
+        for (size_t i = 0; i < count; ++i) {
+            buf.append(&headers[i * kEntryHeaderSize], kEntryHeaderSize);
+            buf.append(datas[i]);
+        }
+        while (!buf.empty()) {
+            const ssize_t n = buf.cut_into_file_descriptor(_fd);
             if (n < 0) {
                 LOG(ERROR) << "Fail to write to fd=" << _fd
                            << ", path: " << _path << berror();
                 return -1;
             }
-            written += n;
-            for (; start < ARRAY_SIZE(pieces) && pieces[start]->empty();
-                    ++start) {}
         }
     }
     {
         BAIDU_SCOPED_LOCK(_mutex);
-        _offset_and_term.push_back(std::make_pair(_meta.bytes, entry->id.term));
-        _last_index.fetch_add(1, butil::memory_order_relaxed);
-        _meta.bytes += to_write;
+        for (size_t i = 0; i < count; ++i) {
+            _offset_and_term.push_back(make_index_entry(
+                _meta.bytes, entries[i]->type, entries[i]->id.term));
+            _meta.bytes += sizes[i];
+        }
+        _last_index.fetch_add(count, butil::memory_order_relaxed);
     }
     return _update_meta_page();
 }
@@ -571,13 +796,13 @@ int CurveSegment::_get_meta(int64_t index, LogMeta* meta) const {
         return -1;
     }
     int64_t meta_index = index - _first_index;
-    int64_t entry_cursor = _offset_and_term[meta_index].first;
+    int64_t entry_cursor = _index_at(meta_index).offset;
     int64_t next_cursor = (index <
                         _last_index.load(butil::memory_order_relaxed))
-                      ? _offset_and_term[meta_index + 1].first : _meta.bytes;
+                      ? _index_at(meta_index + 1).offset : _meta.bytes;
     DCHECK_LT(entry_cursor, next_cursor);
     meta->offset = entry_cursor;
-    meta->term = _offset_and_term[meta_index].second;
+    meta->term = _index_at(meta_index).term;
     meta->length = next_cursor - entry_cursor;
     return 0;
 }
@@ -615,6 +840,11 @@ int CurveSegment::close(bool will_sync) {
 
     _offset_and_term.shrink_to_fit();
 
+    if (ret == 0 && _save_index() != 0) {
+        // the segment can still be loaded by scanning the entries
+        LOG(WARNING) << "Fail to save index of segment, path: " << new_path;
+    }
+
     if (ret == 0) {
         _is_open = false;
         const int rc = ::rename(old_path.c_str(), new_path.c_str());
@@ -667,8 +897,15 @@ int CurveSegment::truncate(const int64_t last_index_kept) {
     if (last_index_kept >= _last_index) {
         return 0;
     }
+    if (_mapped_index != nullptr) {
+        // the segment will be open again, so the index is kept in memory
+        _offset_and_term.assign(_mapped_index,
+                                _mapped_index + _meta.index_count);
+        _unmap_index();
+        _meta.index_count = 0;
+    }
     first_truncate_in_offset = last_index_kept + 1 - _first_index;
-    truncate_size = _offset_and_term[first_truncate_in_offset].first;
+    truncate_size = _offset_and_term[first_truncate_in_offset].offset;
     BRAFT_VLOG << "Truncating " << _path << " first_index: " << _first_index
               << " last_index from " << _last_index << " to " << last_index_kept
               << " truncate size to " << truncate_size;
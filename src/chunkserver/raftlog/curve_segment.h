@@ -60,10 +60,25 @@ namespace curve {
 namespace chunkserver {
 
 DECLARE_bool(enableWalDirectWrite);
+DECLARE_uint32(walAlignSize);
+DECLARE_uint32(walMaxBatchBytes);
 
 struct CurveSegmentMeta {
-    CurveSegmentMeta() : bytes(0) {}
+    CurveSegmentMeta() : bytes(0), index_count(0), index_checksum(0) {}
     int64_t bytes;
+    // index saved after the entries of a closed segment, 0 if no index
+    uint32_t index_count;
+    uint32_t index_checksum;
+};
+
+// offset and term of an entry, the index of a closed segment is saved
+// right after its entries, so that it is mmapped instead of scanning all
+// the entries when the segment is loaded
+struct CurveSegmentIndexEntry {
+    uint32_t offset;
+    uint8_t type;
+    uint8_t reserved[3];
+    int64_t term;
 };
 
 class BAIDU_CACHELINE_ALIGNMENT CurveSegment:
@@ -75,6 +90,7 @@ class BAIDU_CACHELINE_ALIGNMENT CurveSegment:
         _fd(-1), _direct_fd(-1), _is_open(true),
         _first_index(first_index), _last_index(first_index - 1),
         _checksum_type(checksum_type),
+        _mapped_index(nullptr), _mmap_addr(nullptr), _mmap_size(0),
         _walFilePool(walFilePool),
         _meta_page_size(walFilePool->GetFilePoolOpt().metaPageSize) {
     }
@@ -85,10 +101,12 @@ class BAIDU_CACHELINE_ALIGNMENT CurveSegment:
         _fd(-1), _direct_fd(-1), _is_open(false),
         _first_index(first_index), _last_index(last_index),
         _checksum_type(checksum_type),
+        _mapped_index(nullptr), _mmap_addr(nullptr), _mmap_size(0),
         _walFilePool(walFilePool),
         _meta_page_size(walFilePool->GetFilePoolOpt().metaPageSize) {
     }
     ~CurveSegment() {
+        _unmap_index();
         if (_fd >= 0) {
             ::close(_fd);
             _fd = -1;
@@ -111,6 +129,10 @@ class BAIDU_CACHELINE_ALIGNMENT CurveSegment:
     // serialize entry, and append to open segment
     int append(const braft::LogEntry* entry) override;
 
+    // serialize entries, and append them to open segment with one write
+    int append_entries(const braft::LogEntry* const* entries,
+                       size_t count) override;
+
     // get entry by index
     braft::LogEntry* get(const int64_t index) const override;
 
@@ -146,6 +168,13 @@ class BAIDU_CACHELINE_ALIGNMENT CurveSegment:
     }
 
     std::string file_name() override;
+
+    // bytes of an entry on disk, header and data padded to walAlignSize
+    static size_t aligned_entry_size(size_t data_size);
+
+    // bytes of the index of a closed segment, padded to walAlignSize
+    static size_t index_size(int64_t entry_num);
+
  private:
     struct LogMeta {
         off_t offset;
@@ -162,6 +191,28 @@ class BAIDU_CACHELINE_ALIGNMENT CurveSegment:
 
     int _update_meta_page();
 
+    // serialize entry into header and data padded to walAlignSize
+    int _pack_entry(const braft::LogEntry* entry, char* header,
+                    butil::IOBuf* data);
+
+    int _load_configuration(
+            int64_t index, int64_t offset,
+            braft::ConfigurationManager* configuration_manager);
+
+    // save the offset and term index after the entries when the segment
+    // is closed, it's skipped if there is no room in the file
+    int _save_index();
+
+    // mmap the index of a closed segment
+    int _load_index();
+
+    void _unmap_index();
+
+    const CurveSegmentIndexEntry& _index_at(int64_t meta_index) const {
+        return _mapped_index != nullptr ? _mapped_index[meta_index]
+                                        : _offset_and_term[meta_index];
+    }
+
     std::string _path;
     CurveSegmentMeta _meta;
     mutable braft::raft_mutex_t _mutex;
@@ -171,7 +222,11 @@ class BAIDU_CACHELINE_ALIGNMENT CurveSegment:
     const int64_t _first_index;
     butil::atomic<int64_t> _last_index;
     int _checksum_type;
-    std::vector<std::pair<int64_t, int64_t> > _offset_and_term;
+    std::vector<CurveSegmentIndexEntry> _offset_and_term;
+    // index mmapped from a closed segment, _offset_and_term is not used
+    const CurveSegmentIndexEntry* _mapped_index;
+    void* _mmap_addr;
+    size_t _mmap_size;
     std::shared_ptr<FilePool> _walFilePool;
     uint32_t _meta_page_size;
 };
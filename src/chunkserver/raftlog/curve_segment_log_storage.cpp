@@ -405,7 +405,7 @@ int64_t CurveSegmentLogStorage::get_term(const int64_t index) {
 
 int CurveSegmentLogStorage::append_entry(const braft::LogEntry* entry) {
     scoped_refptr<Segment> segment =
-                open_segment(entry->data.size() + kEntryHeaderSize);
+                open_segment(entry->data.size() + kEntryHeaderSize, 1);
     if (NULL == segment) {
         return EIO;
     }
@@ -435,20 +435,42 @@ int CurveSegmentLogStorage::append_entries(
         return -1;
     }
     scoped_refptr<Segment> last_segment = NULL;
-    for (size_t i = 0; i < entries.size(); i++) {
-        braft::LogEntry* entry = entries[i];
+    size_t i = 0;
+    while (i < entries.size()) {
+        // group consecutive entries into one write, a batch is limited
+        // by walMaxBatchBytes and never crosses a segment
+        size_t end = i;
+        size_t batch_bytes = 0;
+        while (end < entries.size()) {
+            size_t entry_bytes = CurveSegment::aligned_entry_size(
+                                        entries[end]->data.size());
+            if (end > i &&
+                    batch_bytes + entry_bytes > FLAGS_walMaxBatchBytes) {
+                break;
+            }
+            batch_bytes += entry_bytes;
+            ++end;
+        }
 
-        scoped_refptr<Segment> segment =
-                    open_segment(entry->data.size() + kEntryHeaderSize);
+        scoped_refptr<Segment> segment = open_segment(batch_bytes, end - i);
         if (NULL == segment) {
             return i;
         }
-        int ret = segment->append(entry);
+        int ret = segment->append_entries(entries.data() + i, end - i);
         if (0 != ret) {
+            // some entries may be appended before the failure
+            int64_t appended = segment->last_index() -
+                    _last_log_index.load(butil::memory_order_relaxed);
+            if (appended > 0) {
+                _last_log_index.fetch_add(appended,
+                                          butil::memory_order_release);
+                i += appended;
+            }
             return i;
         }
-        _last_log_index.fetch_add(1, butil::memory_order_release);
+        _last_log_index.fetch_add(end - i, butil::memory_order_release);
         last_segment = segment;
+        i = end;
     }
     last_segment->sync(_enable_sync);
     return entries.size();
@@ -693,7 +715,7 @@ braft::LogStorage* CurveSegmentLogStorage::new_instance(
 }
 
 scoped_refptr<Segment> CurveSegmentLogStorage::open_segment(
-                                                    size_t to_write) {
+                                    size_t to_write, size_t entry_num) {
     scoped_refptr<Segment> prev_open_segment;
     {
         BAIDU_SCOPED_LOCK(_mutex);
@@ -707,7 +729,11 @@ scoped_refptr<Segment> CurveSegmentLogStorage::open_segment(
         }
         uint32_t maxTotalFileSize = _walFilePool->GetFilePoolOpt().fileSize
                                   + _walFilePool->GetFilePoolOpt().metaPageSize;
-        if (_open_segment->bytes() + to_write > maxTotalFileSize) {
+        // keep room for the index saved when the segment is closed
+        const int64_t index_num = _open_segment->last_index()
+                                - _open_segment->first_index() + 1 + entry_num;
+        if (_open_segment->bytes() + to_write
+                + CurveSegment::index_size(index_num) > maxTotalFileSize) {
             _segments[_open_segment->first_index()] = _open_segment;
             prev_open_segment.swap(_open_segment);
         }
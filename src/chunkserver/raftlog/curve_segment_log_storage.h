@@ -153,7 +153,9 @@ class CurveSegmentLogStorage : public braft::LogStorage {
     LogStorageStatus GetStatus();
 
  private:
-    scoped_refptr<Segment> open_segment(size_t to_write);
+    // to_write and entry_num are the bytes and number of entries to be
+    // appended, the segment is rolled if they and the index don't fit
+    scoped_refptr<Segment> open_segment(size_t to_write, size_t entry_num);
     int save_meta(const int64_t log_index);
     int load_meta();
     int list_segments(bool is_empty);
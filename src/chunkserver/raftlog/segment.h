@@ -44,6 +44,18 @@ class Segment : public butil::RefCountedThreadSafe<Segment> {
     // serialize entry, and append to open segment
     virtual int append(const braft::LogEntry* entry) = 0;
 
+    // append consecutive entries, appended one by one by default
+    virtual int append_entries(const braft::LogEntry* const* entries,
+                               size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            int ret = append(entries[i]);
+            if (ret != 0) {
+                return ret;
+            }
+        }
+        return 0;
+    }
+
     // get entry by index
     virtual braft::LogEntry* get(const int64_t index) const = 0;
 
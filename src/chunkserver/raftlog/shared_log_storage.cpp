@@ -0,0 +1,321 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/chunkserver/raftlog/shared_log_storage.h"
+
+#include <braft/local_storage.pb.h>
+#include <braft/protobuf_file.h>
+#include <butil/file_util.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+#include "src/chunkserver/raftlog/define.h"
+
+namespace curve {
+namespace chunkserver {
+
+const char kProtocolCurveShared[] = "curveshared";
+
+std::shared_ptr<SharedLogStream> StoreSharedLogStream(
+    std::shared_ptr<SharedLogStream> stream) {
+    static std::shared_ptr<SharedLogStream> stream_;
+    if (nullptr != stream) {
+        stream_ = stream;
+    }
+    return stream_;
+}
+
+void RegisterSharedLogStorageOrDie() {
+    static SharedLogStorage logStorage;
+    braft::log_storage_extension()->RegisterOrDie(
+                                    kProtocolCurveShared, &logStorage);
+}
+
+void RemoveSharedLog(uint64_t groupId) {
+    std::shared_ptr<SharedLogStream> stream = StoreSharedLogStream(nullptr);
+    if (nullptr == stream) {
+        return;
+    }
+    LOG_IF(ERROR, stream->Remove(groupId) != 0)
+        << "Fail to remove log " << groupId << " from shared log stream";
+}
+
+SharedLogStorage::SharedLogStorage(const std::string& path,
+                                   std::shared_ptr<SharedLogStream> stream)
+    : path_(path), id_(0), stream_(stream), firstIndex_(1) {}
+
+SharedLogStorage::SharedLogStorage()
+    : id_(0), stream_(nullptr), firstIndex_(1) {}
+
+int SharedLogStorage::init(
+    braft::ConfigurationManager* configuration_manager) {
+    if (nullptr == stream_) {
+        LOG(ERROR) << "Shared log stream is not set, path: " << path_;
+        return -1;
+    }
+    butil::FilePath dirPath(path_);
+    butil::File::Error e;
+    if (!butil::CreateDirectoryAndGetError(
+                dirPath, &e, braft::FLAGS_raft_create_parent_directories)) {
+        LOG(ERROR) << "Fail to create " << dirPath.value() << " : " << e;
+        return -1;
+    }
+    std::string groupId = dirPath.DirName().BaseName().value();
+    char* end = nullptr;
+    id_ = strtoull(groupId.c_str(), &end, 10);
+    if (groupId.empty() || *end != '\0') {
+        LOG(ERROR) << "Fail to get group id from log path: " << path_;
+        return -1;
+    }
+
+    SharedLogRecovered log;
+    stream_->TakeRecovered(id_, &log);
+    int64_t metaFirstIndex = 1;
+    if (LoadMeta(&metaFirstIndex) != 0) {
+        if (errno != ENOENT) {
+            return -1;
+        }
+        // a new log, records of the same id are left by a deleted copyset
+        LOG(WARNING) << path_ << " is empty";
+        if ((log.firstIndex != 0 || !log.entries.empty()) &&
+                stream_->Remove(id_) != 0) {
+            return -1;
+        }
+        std::lock_guard<braft::raft_mutex_t> lk(mutex_);
+        firstIndex_ = 1;
+        entries_.clear();
+        return SaveMeta(1);
+    }
+
+    std::vector<SharedLogLocation> popped;
+    {
+        std::lock_guard<braft::raft_mutex_t> lk(mutex_);
+        firstIndex_ = log.firstIndex;
+        entries_.swap(log.entries);
+        PopFront(metaFirstIndex, &popped);
+        firstIndex_ = std::max(firstIndex_, metaFirstIndex);
+    }
+    stream_->Release(id_, popped);
+
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        if (entries_[i].type != braft::ENTRY_TYPE_CONFIGURATION) {
+            continue;
+        }
+        braft::LogEntry* entry = stream_->Read(entries_[i], firstIndex_ + i);
+        if (nullptr == entry) {
+            LOG(ERROR) << "Fail to load configuration entry "
+                       << firstIndex_ + i << ", path: " << path_;
+            return -1;
+        }
+        braft::ConfigurationEntry confEntry(*entry);
+        configuration_manager->add(confEntry);
+        entry->Release();
+    }
+
+    LOG(INFO) << "Load shared log " << id_ << " of " << path_
+              << ", first_log_index: " << first_log_index()
+              << ", last_log_index: " << last_log_index();
+    return 0;
+}
+
+int64_t SharedLogStorage::first_log_index() {
+    std::lock_guard<braft::raft_mutex_t> lk(mutex_);
+    return firstIndex_;
+}
+
+int64_t SharedLogStorage::last_log_index() {
+    std::lock_guard<braft::raft_mutex_t> lk(mutex_);
+    return firstIndex_ + static_cast<int64_t>(entries_.size()) - 1;
+}
+
+braft::LogEntry* SharedLogStorage::get_entry(const int64_t index) {
+    SharedLogLocation location;
+    {
+        std::lock_guard<braft::raft_mutex_t> lk(mutex_);
+        if (index < firstIndex_ ||
+                index >= firstIndex_ + static_cast<int64_t>(entries_.size())) {
+            return nullptr;
+        }
+        location = entries_[index - firstIndex_];
+    }
+    return stream_->Read(location, index);
+}
+
+int64_t SharedLogStorage::get_term(const int64_t index) {
+    std::lock_guard<braft::raft_mutex_t> lk(mutex_);
+    if (index < firstIndex_ ||
+            index >= firstIndex_ + static_cast<int64_t>(entries_.size())) {
+        return 0;
+    }
+    return entries_[index - firstIndex_].term;
+}
+
+int SharedLogStorage::append_entry(const braft::LogEntry* entry) {
+    if (entry->id.index != last_log_index() + 1) {
+        LOG(ERROR) << "Append entry " << entry->id.index
+                   << " not after last_log_index " << last_log_index()
+                   << ", path: " << path_;
+        return ERANGE;
+    }
+    std::vector<SharedLogLocation> locations;
+    if (stream_->Append(id_, &entry, 1, &locations) != 0) {
+        return EIO;
+    }
+    std::lock_guard<braft::raft_mutex_t> lk(mutex_);
+    entries_.push_back(locations[0]);
+    return 0;
+}
+
+int SharedLogStorage::append_entries(
+    const std::vector<braft::LogEntry*>& entries, braft::IOMetric* metric) {
+    (void)metric;
+    if (entries.empty()) {
+        return 0;
+    }
+    if (last_log_index() + 1 != entries.front()->id.index) {
+        LOG(FATAL) << "There's gap between appending entries and"
+                   << " _last_log_index path: " << path_;
+        return -1;
+    }
+    std::vector<SharedLogLocation> locations;
+    if (stream_->Append(id_, entries.data(), entries.size(),
+                        &locations) != 0) {
+        return 0;
+    }
+    std::lock_guard<braft::raft_mutex_t> lk(mutex_);
+    entries_.insert(entries_.end(), locations.begin(), locations.end());
+    return entries.size();
+}
+
+int SharedLogStorage::truncate_prefix(const int64_t first_index_kept) {
+    if (first_log_index() >= first_index_kept) {
+        return 0;
+    }
+    // save meta first, entries before first_index_kept are not loaded
+    // even if the process crashes before they are released
+    if (SaveMeta(first_index_kept) != 0) {
+        return -1;
+    }
+    std::vector<SharedLogLocation> popped;
+    {
+        std::lock_guard<braft::raft_mutex_t> lk(mutex_);
+        PopFront(first_index_kept, &popped);
+        firstIndex_ = first_index_kept;
+    }
+    stream_->Release(id_, popped);
+    return 0;
+}
+
+int SharedLogStorage::truncate_suffix(const int64_t last_index_kept) {
+    if (last_log_index() <= last_index_kept) {
+        return 0;
+    }
+    if (stream_->TruncateSuffix(id_, last_index_kept) != 0) {
+        LOG(ERROR) << "Fail to truncate suffix to " << last_index_kept
+                   << ", path: " << path_;
+        return -1;
+    }
+    std::vector<SharedLogLocation> popped;
+    {
+        std::lock_guard<braft::raft_mutex_t> lk(mutex_);
+        PopBack(last_index_kept, &popped);
+    }
+    stream_->Release(id_, popped);
+    return 0;
+}
+
+int SharedLogStorage::reset(const int64_t next_log_index) {
+    if (next_log_index <= 0) {
+        LOG(ERROR) << "Invalid next_log_index=" << next_log_index
+                   << " path: " << path_;
+        return EINVAL;
+    }
+    // the reset record is synced before the meta, entries before it are
+    // dropped when the stream is loaded again
+    if (stream_->Reset(id_, next_log_index) != 0) {
+        LOG(ERROR) << "Fail to reset to " << next_log_index
+                   << ", path: " << path_;
+        return -1;
+    }
+    std::vector<SharedLogLocation> popped;
+    {
+        std::lock_guard<braft::raft_mutex_t> lk(mutex_);
+        popped.assign(entries_.begin(), entries_.end());
+        entries_.clear();
+        firstIndex_ = next_log_index;
+    }
+    stream_->Release(id_, popped);
+    return SaveMeta(next_log_index);
+}
+
+braft::LogStorage* SharedLogStorage::new_instance(
+    const std::string& uri) const {
+    std::shared_ptr<SharedLogStream> stream = StoreSharedLogStream(nullptr);
+    CHECK(nullptr != stream) << "shared log stream is null";
+    return new SharedLogStorage(uri, stream);
+}
+
+int SharedLogStorage::LoadMeta(int64_t* firstIndex) {
+    std::string metaPath(path_);
+    metaPath.append("/" BRAFT_SEGMENT_META_FILE);
+
+    braft::ProtoBufFile pbFile(metaPath);
+    braft::LogPBMeta meta;
+    if (0 != pbFile.load(&meta)) {
+        PLOG_IF(ERROR, errno != ENOENT)
+                << "Fail to load meta from " << metaPath;
+        return -1;
+    }
+    *firstIndex = meta.first_log_index();
+    return 0;
+}
+
+int SharedLogStorage::SaveMeta(int64_t firstIndex) {
+    std::string metaPath(path_);
+    metaPath.append("/" BRAFT_SEGMENT_META_FILE);
+
+    braft::LogPBMeta meta;
+    meta.set_first_log_index(firstIndex);
+    braft::ProtoBufFile pbFile(metaPath);
+    int ret = pbFile.save(&meta, braft::raft_sync_meta());
+    PLOG_IF(ERROR, ret != 0) << "Fail to save meta to " << metaPath;
+    return ret;
+}
+
+void SharedLogStorage::PopFront(int64_t firstIndex,
+                                std::vector<SharedLogLocation>* popped) {
+    while (!entries_.empty() && firstIndex_ < firstIndex) {
+        popped->push_back(entries_.front());
+        entries_.pop_front();
+        ++firstIndex_;
+    }
+}
+
+void SharedLogStorage::PopBack(int64_t lastIndexKept,
+                               std::vector<SharedLogLocation>* popped) {
+    while (!entries_.empty() &&
+            firstIndex_ + static_cast<int64_t>(entries_.size()) - 1 >
+                lastIndexKept) {
+        popped->push_back(entries_.back());
+        entries_.pop_back();
+    }
+}
+
+}  // namespace chunkserver
+}  // namespace curve
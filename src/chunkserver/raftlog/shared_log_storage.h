@@ -0,0 +1,126 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_CHUNKSERVER_RAFTLOG_SHARED_LOG_STORAGE_H_
+#define SRC_CHUNKSERVER_RAFTLOG_SHARED_LOG_STORAGE_H_
+
+#include <braft/log_entry.h>
+#include <braft/storage.h>
+#include <braft/util.h>
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/chunkserver/raftlog/shared_log_stream.h"
+
+namespace curve {
+namespace chunkserver {
+
+extern const char kProtocolCurveShared[];
+
+/**
+ * @brief keep the shared log stream used by SharedLogStorage instances
+ * @param stream: the stream is stored if it is not nullptr
+ * @return the stored stream
+ */
+std::shared_ptr<SharedLogStream> StoreSharedLogStream(
+    std::shared_ptr<SharedLogStream> stream);
+
+void RegisterSharedLogStorageOrDie();
+
+/**
+ * @brief remove the log of a copyset from the shared log stream after the
+ *        copyset is deleted, nothing is done if the stream is not used
+ */
+void RemoveSharedLog(uint64_t groupId);
+
+// LogStorage of a copyset whose entries are appended to the shared log
+// stream of the disk, the index of entries is in memory, and the first
+// log index is saved in log_meta of the copyset's log dir as
+// CurveSegmentLogStorage does. The log id in the stream is the group id,
+// which is the name of the parent dir of the log dir.
+class SharedLogStorage : public braft::LogStorage {
+ public:
+    SharedLogStorage(const std::string& path,
+                     std::shared_ptr<SharedLogStream> stream);
+
+    SharedLogStorage();
+
+    virtual ~SharedLogStorage() {}
+
+    // init logstorage, check consistency and integrity
+    int init(braft::ConfigurationManager* configuration_manager) override;
+
+    // first log index in log
+    int64_t first_log_index() override;
+
+    // last log index in log
+    int64_t last_log_index() override;
+
+    // get logentry by index
+    braft::LogEntry* get_entry(const int64_t index) override;
+
+    // get logentry's term by index
+    int64_t get_term(const int64_t index) override;
+
+    // append entry to log
+    int append_entry(const braft::LogEntry* entry) override;
+
+    // append entries to log, return success append number
+    int append_entries(const std::vector<braft::LogEntry*>& entries,
+                       braft::IOMetric* metric) override;
+
+    // delete logs from storage's head, [1, first_index_kept) will be discarded
+    int truncate_prefix(const int64_t first_index_kept) override;
+
+    // delete uncommitted logs from storage's tail,
+    // (last_index_kept, infinity) will be discarded
+    int truncate_suffix(const int64_t last_index_kept) override;
+
+    int reset(const int64_t next_log_index) override;
+
+    braft::LogStorage* new_instance(const std::string& uri) const override;
+
+ private:
+    int LoadMeta(int64_t* firstIndex);
+
+    int SaveMeta(int64_t firstIndex);
+
+    // drop entries before firstIndex, mutex_ must be held
+    void PopFront(int64_t firstIndex,
+                  std::vector<SharedLogLocation>* popped);
+
+    // drop entries after lastIndexKept, mutex_ must be held
+    void PopBack(int64_t lastIndexKept,
+                 std::vector<SharedLogLocation>* popped);
+
+    std::string path_;
+    uint64_t id_;
+    std::shared_ptr<SharedLogStream> stream_;
+
+    braft::raft_mutex_t mutex_;
+    int64_t firstIndex_;
+    // location of entries in [firstIndex_, firstIndex_ + entries_.size())
+    std::deque<SharedLogLocation> entries_;
+};
+
+}  // namespace chunkserver
+}  // namespace curve
+
+#endif  // SRC_CHUNKSERVER_RAFTLOG_SHARED_LOG_STORAGE_H_
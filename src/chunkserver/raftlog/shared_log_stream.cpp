@@ -0,0 +1,633 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/chunkserver/raftlog/shared_log_stream.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <braft/fsync.h>
+#include <braft/storage.h>
+#include <butil/crc32c.h>
+#include <butil/file_util.h>
+#include <butil/files/dir_reader_posix.h>
+#include <butil/raw_pack.h>
+#include <butil/strings/stringprintf.h>
+#include <glog/logging.h>
+
+#include <utility>
+
+#include "src/chunkserver/raftlog/define.h"
+
+namespace curve {
+namespace chunkserver {
+
+DEFINE_uint64(sharedWalFileSize, 64 * 1024 * 1024,
+              "max size of a file in the shared wal stream");
+
+namespace {
+
+uint32_t DataChecksum(const butil::IOBuf& data) {
+    uint32_t crc = 0;
+    const size_t n = data.backing_block_num();
+    for (size_t i = 0; i < n; ++i) {
+        butil::StringPiece block = data.backing_block(i);
+        crc = butil::crc32c::Extend(crc, block.data(), block.size());
+    }
+    return crc;
+}
+
+bool IsEntryType(int type) {
+    return type == braft::ENTRY_TYPE_DATA ||
+           type == braft::ENTRY_TYPE_NO_OP ||
+           type == braft::ENTRY_TYPE_CONFIGURATION;
+}
+
+}  // namespace
+
+SharedLogStream::LogFile::~LogFile() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+SharedLogStream::SharedLogStream(const std::string& path,
+                                 uint64_t maxFileSize)
+    : path_(path), maxFileSize_(maxFileSize), written_(0),
+      syncing_(false), synced_(0) {}
+
+SharedLogStream::~SharedLogStream() {}
+
+int SharedLogStream::Init() {
+    butil::FilePath dirPath(path_);
+    butil::File::Error e;
+    if (!butil::CreateDirectoryAndGetError(dirPath, &e, true)) {
+        LOG(ERROR) << "Fail to create " << path_ << " : " << e;
+        return -1;
+    }
+
+    butil::DirReaderPosix reader(path_.c_str());
+    if (!reader.IsValid()) {
+        LOG(ERROR) << "Fail to open " << path_ << ", " << berror();
+        return -1;
+    }
+    while (reader.Next()) {
+        uint64_t seq = 0;
+        if (sscanf(reader.name(), SHARED_LOG_FILE_PATTERN, &seq) != 1) {
+            continue;
+        }
+        std::string name;
+        butil::string_appendf(&name, SHARED_LOG_FILE_PATTERN, seq);
+        if (name != reader.name()) {
+            continue;
+        }
+        std::string filePath = path_ + "/" + name;
+        int fd = ::open(filePath.c_str(), O_RDWR | O_NOATIME);
+        if (fd < 0) {
+            LOG(ERROR) << "Fail to open " << filePath << ", " << berror();
+            return -1;
+        }
+        files_[seq] = std::make_shared<LogFile>(seq, filePath, fd);
+    }
+
+    for (auto it = files_.begin(); it != files_.end(); ++it) {
+        bool isLast = std::next(it) == files_.end();
+        if (LoadFile(it->second, isLast) != 0) {
+            return -1;
+        }
+    }
+    for (const auto& log : recovered_) {
+        for (const auto& location : log.second.entries) {
+            ++files_[location.fileSeq]->refs[log.first];
+        }
+    }
+
+    std::vector<std::shared_ptr<LogFile>> recycled;
+    {
+        std::lock_guard<bthread::Mutex> lk(mutex_);
+        if (RollFile() != 0) {
+            return -1;
+        }
+        RecycleFiles(&recycled);
+    }
+    UnlinkFiles(recycled);
+    LOG(INFO) << "Init shared log stream " << path_ << " success, load "
+              << recovered_.size() << " logs";
+    return 0;
+}
+
+void SharedLogStream::PackRecord(int type, uint64_t id, int64_t index,
+                                 int64_t term, const butil::IOBuf& data,
+                                 butil::IOBuf* record) {
+    char header[kSharedLogHeaderSize];
+    const uint32_t metaField = (type << 24) | (CHECKSUM_CRC32 << 16);
+    butil::RawPacker packer(header);
+    packer.pack32(metaField)
+          .pack64(id)
+          .pack64(index)
+          .pack64(term)
+          .pack32(data.length())
+          .pack32(DataChecksum(data));
+    packer.pack32(butil::crc32c::Value(header, kSharedLogHeaderSize - 4));
+    record->append(header, kSharedLogHeaderSize);
+    record->append(data);
+}
+
+bool SharedLogStream::ParseHeader(const char* buf, RecordHeader* header) {
+    uint32_t metaField;
+    uint64_t index;
+    uint64_t term;
+    uint32_t headerChecksum;
+    butil::RawUnpacker unpacker(buf);
+    unpacker.unpack32(metaField)
+            .unpack64(header->id)
+            .unpack64(index)
+            .unpack64(term)
+            .unpack32(header->dataLen)
+            .unpack32(header->dataChecksum)
+            .unpack32(headerChecksum);
+    if (headerChecksum !=
+            butil::crc32c::Value(buf, kSharedLogHeaderSize - 4)) {
+        return false;
+    }
+    header->type = metaField >> 24;
+    header->index = static_cast<int64_t>(index);
+    header->term = static_cast<int64_t>(term);
+    return true;
+}
+
+int SharedLogStream::LoadFile(const std::shared_ptr<LogFile>& file,
+                              bool isLast) {
+    struct stat st;
+    if (::fstat(file->fd, &st) != 0) {
+        LOG(ERROR) << "Fail to stat " << file->path << ", " << berror();
+        return -1;
+    }
+    const uint64_t fileSize = st.st_size;
+    uint64_t offset = 0;
+    char buf[kSharedLogHeaderSize];
+    while (offset < fileSize) {
+        RecordHeader header;
+        bool complete = false;
+        if (fileSize - offset >= kSharedLogHeaderSize &&
+                ::pread(file->fd, buf, kSharedLogHeaderSize, offset) ==
+                    static_cast<ssize_t>(kSharedLogHeaderSize) &&
+                ParseHeader(buf, &header)) {
+            complete = offset + kSharedLogHeaderSize + header.dataLen <=
+                       fileSize;
+        }
+        if (!complete) {
+            if (!isLast) {
+                LOG(ERROR) << "Found corrupted record in " << file->path
+                           << " at offset " << offset;
+                return -1;
+            }
+            // the last record was not completely written
+            LOG(WARNING) << "Truncate " << file->path << " from " << offset
+                         << ", size: " << fileSize;
+            if (::ftruncate(file->fd, offset) != 0) {
+                LOG(ERROR) << "Fail to truncate " << file->path << ", "
+                           << berror();
+                return -1;
+            }
+            break;
+        }
+
+        SharedLogLocation location;
+        location.fileSeq = file->seq;
+        location.offset = offset;
+        location.length = kSharedLogHeaderSize + header.dataLen;
+        location.type = header.type;
+        location.term = header.term;
+        ApplyRecord(header, location);
+        offset += location.length;
+    }
+    file->size = offset;
+    return 0;
+}
+
+void SharedLogStream::ApplyRecord(const RecordHeader& header,
+                                  const SharedLogLocation& location) {
+    if (header.type == SHARED_LOG_REMOVE) {
+        recovered_.erase(header.id);
+        return;
+    }
+
+    SharedLogRecovered& log = recovered_[header.id];
+    std::deque<SharedLogLocation>& entries = log.entries;
+    int64_t lastIndex = log.firstIndex + entries.size() - 1;
+    switch (header.type) {
+    case SHARED_LOG_TRUNCATE_SUFFIX:
+        while (!entries.empty() && lastIndex > header.index) {
+            entries.pop_back();
+            --lastIndex;
+        }
+        break;
+    case SHARED_LOG_RESET:
+        entries.clear();
+        log.firstIndex = header.index;
+        break;
+    default:
+        if (!IsEntryType(header.type)) {
+            LOG(WARNING) << "Skip unknown record type " << header.type
+                         << " of log " << header.id;
+            break;
+        }
+        if (!entries.empty() && header.index >= log.firstIndex &&
+                header.index <= lastIndex + 1) {
+            // entries are rewritten from index
+            while (lastIndex >= header.index) {
+                entries.pop_back();
+                --lastIndex;
+            }
+        } else {
+            entries.clear();
+            log.firstIndex = header.index;
+        }
+        entries.push_back(location);
+        break;
+    }
+}
+
+int SharedLogStream::Append(uint64_t id,
+                            const braft::LogEntry* const* entries,
+                            size_t count,
+                            std::vector<SharedLogLocation>* locations) {
+    butil::IOBuf records;
+    std::vector<uint32_t> lengths(count);
+    for (size_t i = 0; i < count; ++i) {
+        const braft::LogEntry* entry = entries[i];
+        butil::IOBuf data;
+        switch (entry->type) {
+        case braft::ENTRY_TYPE_DATA:
+            data.append(entry->data);
+            break;
+        case braft::ENTRY_TYPE_NO_OP:
+            break;
+        case braft::ENTRY_TYPE_CONFIGURATION:
+            {
+                butil::Status status =
+                    braft::serialize_configuration_meta(entry, data);
+                if (!status.ok()) {
+                    LOG(ERROR) << "Fail to serialize ConfigurationPBMeta"
+                               << ", log id: " << id;
+                    return -1;
+                }
+            }
+            break;
+        default:
+            LOG(ERROR) << "unknow entry type: " << entry->type
+                       << ", log id: " << id;
+            return -1;
+        }
+        lengths[i] = kSharedLogHeaderSize + data.length();
+        PackRecord(entry->type, id, entry->id.index, entry->id.term, data,
+                   &records);
+    }
+
+    uint64_t fileSeq;
+    uint64_t offset;
+    uint64_t written;
+    {
+        std::lock_guard<bthread::Mutex> lk(mutex_);
+        if (AppendRecord(&records, &fileSeq, &offset) != 0) {
+            return -1;
+        }
+        current_->refs[id] += count;
+        written = written_;
+    }
+
+    locations->clear();
+    locations->reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        SharedLogLocation location;
+        location.fileSeq = fileSeq;
+        location.offset = offset;
+        location.length = lengths[i];
+        location.type = entries[i]->type;
+        location.term = entries[i]->id.term;
+        locations->push_back(location);
+        offset += lengths[i];
+    }
+
+    if (Sync(written) != 0) {
+        Release(id, *locations);
+        locations->clear();
+        return -1;
+    }
+    return 0;
+}
+
+int SharedLogStream::TruncateSuffix(uint64_t id, int64_t lastIndexKept) {
+    butil::IOBuf record;
+    PackRecord(SHARED_LOG_TRUNCATE_SUFFIX, id, lastIndexKept, 0,
+               butil::IOBuf(), &record);
+    uint64_t fileSeq;
+    uint64_t offset;
+    uint64_t written;
+    {
+        std::lock_guard<bthread::Mutex> lk(mutex_);
+        if (AppendRecord(&record, &fileSeq, &offset) != 0) {
+            return -1;
+        }
+        written = written_;
+    }
+    return Sync(written);
+}
+
+int SharedLogStream::Reset(uint64_t id, int64_t nextIndex) {
+    butil::IOBuf record;
+    PackRecord(SHARED_LOG_RESET, id, nextIndex, 0, butil::IOBuf(), &record);
+    uint64_t fileSeq;
+    uint64_t offset;
+    uint64_t written;
+    {
+        std::lock_guard<bthread::Mutex> lk(mutex_);
+        if (AppendRecord(&record, &fileSeq, &offset) != 0) {
+            return -1;
+        }
+        written = written_;
+    }
+    return Sync(written);
+}
+
+int SharedLogStream::Remove(uint64_t id) {
+    butil::IOBuf record;
+    PackRecord(SHARED_LOG_REMOVE, id, 0, 0, butil::IOBuf(), &record);
+    uint64_t fileSeq;
+    uint64_t offset;
+    uint64_t written;
+    {
+        std::lock_guard<bthread::Mutex> lk(mutex_);
+        if (AppendRecord(&record, &fileSeq, &offset) != 0) {
+            return -1;
+        }
+        written = written_;
+    }
+    if (Sync(written) != 0) {
+        return -1;
+    }
+
+    std::vector<std::shared_ptr<LogFile>> recycled;
+    {
+        std::lock_guard<bthread::Mutex> lk(mutex_);
+        for (auto& file : files_) {
+            file.second->refs.erase(id);
+        }
+        recovered_.erase(id);
+        RecycleFiles(&recycled);
+    }
+    UnlinkFiles(recycled);
+    LOG(INFO) << "Remove log " << id << " from shared log stream " << path_;
+    return 0;
+}
+
+braft::LogEntry* SharedLogStream::Read(const SharedLogLocation& location,
+                                       int64_t index) {
+    std::shared_ptr<LogFile> file;
+    {
+        std::lock_guard<bthread::Mutex> lk(mutex_);
+        auto it = files_.find(location.fileSeq);
+        if (it == files_.end()) {
+            return nullptr;
+        }
+        file = it->second;
+    }
+
+    std::unique_ptr<char[]> buf(new char[location.length]);
+    ssize_t n = ::pread(file->fd, buf.get(), location.length,
+                        location.offset);
+    if (n != static_cast<ssize_t>(location.length)) {
+        LOG(ERROR) << "Fail to read " << file->path << " at offset "
+                   << location.offset << ", length " << location.length
+                   << ", " << berror();
+        return nullptr;
+    }
+    RecordHeader header;
+    if (!ParseHeader(buf.get(), &header) || header.index != index ||
+            kSharedLogHeaderSize + header.dataLen != location.length) {
+        LOG(ERROR) << "Found corrupted record header in " << file->path
+                   << " at offset " << location.offset;
+        return nullptr;
+    }
+    butil::IOBuf data;
+    data.append(buf.get() + kSharedLogHeaderSize, header.dataLen);
+    if (DataChecksum(data) != header.dataChecksum) {
+        LOG(ERROR) << "Found corrupted data in " << file->path
+                   << " at offset " << location.offset;
+        return nullptr;
+    }
+
+    braft::LogEntry* entry = new braft::LogEntry();
+    entry->AddRef();
+    entry->id.index = header.index;
+    entry->id.term = header.term;
+    switch (header.type) {
+    case braft::ENTRY_TYPE_DATA:
+        entry->type = braft::ENTRY_TYPE_DATA;
+        entry->data.swap(data);
+        break;
+    case braft::ENTRY_TYPE_NO_OP:
+        entry->type = braft::ENTRY_TYPE_NO_OP;
+        break;
+    case braft::ENTRY_TYPE_CONFIGURATION:
+        {
+            entry->type = braft::ENTRY_TYPE_CONFIGURATION;
+            butil::Status status =
+                braft::parse_configuration_meta(data, entry);
+            if (!status.ok()) {
+                LOG(WARNING) << "Fail to parse ConfigurationPBMeta in "
+                             << file->path << " at offset "
+                             << location.offset;
+                entry->Release();
+                return nullptr;
+            }
+        }
+        break;
+    default:
+        LOG(ERROR) << "Record in " << file->path << " at offset "
+                   << location.offset << " is not an entry";
+        entry->Release();
+        return nullptr;
+    }
+    return entry;
+}
+
+void SharedLogStream::Release(
+    uint64_t id, const std::vector<SharedLogLocation>& locations) {
+    if (locations.empty()) {
+        return;
+    }
+    std::vector<std::shared_ptr<LogFile>> recycled;
+    {
+        std::lock_guard<bthread::Mutex> lk(mutex_);
+        for (const auto& location : locations) {
+            auto it = files_.find(location.fileSeq);
+            if (it == files_.end()) {
+                continue;
+            }
+            auto ref = it->second->refs.find(id);
+            if (ref != it->second->refs.end() && --ref->second <= 0) {
+                it->second->refs.erase(ref);
+            }
+        }
+        RecycleFiles(&recycled);
+    }
+    UnlinkFiles(recycled);
+}
+
+void SharedLogStream::TakeRecovered(uint64_t id, SharedLogRecovered* log) {
+    std::lock_guard<bthread::Mutex> lk(mutex_);
+    auto it = recovered_.find(id);
+    if (it == recovered_.end()) {
+        *log = SharedLogRecovered();
+        return;
+    }
+    *log = std::move(it->second);
+    recovered_.erase(it);
+}
+
+size_t SharedLogStream::FileCount() {
+    std::lock_guard<bthread::Mutex> lk(mutex_);
+    return files_.size();
+}
+
+int SharedLogStream::AppendRecord(butil::IOBuf* record, uint64_t* fileSeq,
+                                  uint64_t* offset) {
+    const uint64_t size = record->length();
+    if (current_->size > 0 && current_->size + size > maxFileSize_) {
+        if (RollFile() != 0) {
+            return -1;
+        }
+    }
+    uint64_t pos = current_->size;
+    while (!record->empty()) {
+        ssize_t n = record->pcut_into_file_descriptor(current_->fd, pos);
+        if (n < 0) {
+            LOG(ERROR) << "Fail to write to " << current_->path
+                       << ", offset: " << pos << ", " << berror();
+            return -1;
+        }
+        pos += n;
+    }
+    *fileSeq = current_->seq;
+    *offset = current_->size;
+    current_->size = pos;
+    written_ += size;
+    return 0;
+}
+
+int SharedLogStream::RollFile() {
+    // data of the old file must be synced before the writes of the new
+    // file are acked, Sync only syncs the current file
+    if (current_ != nullptr && braft::FLAGS_raft_sync &&
+            braft::raft_fsync(current_->fd) != 0) {
+        LOG(ERROR) << "Fail to sync " << current_->path << ", " << berror();
+        return -1;
+    }
+
+    uint64_t seq = files_.empty() ? 1 : files_.rbegin()->first + 1;
+    std::string filePath(path_);
+    butil::string_appendf(&filePath, "/" SHARED_LOG_FILE_PATTERN, seq);
+    int fd = ::open(filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_NOATIME,
+                    0644);
+    if (fd < 0) {
+        LOG(ERROR) << "Fail to create " << filePath << ", " << berror();
+        return -1;
+    }
+    int dirFd = ::open(path_.c_str(), O_RDONLY);
+    if (dirFd < 0 || braft::raft_fsync(dirFd) != 0) {
+        LOG(ERROR) << "Fail to sync dir " << path_ << ", " << berror();
+        if (dirFd >= 0) {
+            ::close(dirFd);
+        }
+        ::close(fd);
+        ::unlink(filePath.c_str());
+        return -1;
+    }
+    ::close(dirFd);
+
+    current_ = std::make_shared<LogFile>(seq, filePath, fd);
+    files_[seq] = current_;
+    LOG(INFO) << "Created shared log file " << filePath;
+    return 0;
+}
+
+int SharedLogStream::Sync(uint64_t written) {
+    if (!braft::FLAGS_raft_sync) {
+        return 0;
+    }
+    std::unique_lock<bthread::Mutex> lk(syncMutex_);
+    while (synced_ < written) {
+        if (syncing_) {
+            // the sync in flight may cover the data
+            syncCond_.wait(lk);
+            continue;
+        }
+        syncing_ = true;
+        lk.unlock();
+
+        uint64_t target;
+        std::shared_ptr<LogFile> file;
+        {
+            std::lock_guard<bthread::Mutex> fileLk(mutex_);
+            target = written_;
+            file = current_;
+        }
+        int ret = braft::raft_fsync(file->fd);
+
+        lk.lock();
+        syncing_ = false;
+        if (ret == 0 && target > synced_) {
+            synced_ = target;
+        }
+        syncCond_.notify_all();
+        if (ret != 0) {
+            LOG(ERROR) << "Fail to sync " << file->path << ", " << berror();
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void SharedLogStream::RecycleFiles(
+    std::vector<std::shared_ptr<LogFile>>* recycled) {
+    // only delete from the oldest file, a file may hold records which
+    // truncate entries in older files
+    while (!files_.empty()) {
+        auto it = files_.begin();
+        if (it->second == current_ || !it->second->refs.empty()) {
+            break;
+        }
+        recycled->push_back(it->second);
+        files_.erase(it);
+    }
+}
+
+void SharedLogStream::UnlinkFiles(
+    const std::vector<std::shared_ptr<LogFile>>& files) {
+    for (const auto& file : files) {
+        if (::unlink(file->path.c_str()) != 0) {
+            LOG(WARNING) << "Fail to unlink " << file->path << ", "
+                         << berror();
+        } else {
+            LOG(INFO) << "Unlinked shared log file " << file->path;
+        }
+    }
+}
+
+}  // namespace chunkserver
+}  // namespace curve
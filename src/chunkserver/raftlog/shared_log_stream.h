@@ -0,0 +1,231 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_CHUNKSERVER_RAFTLOG_SHARED_LOG_STREAM_H_
+#define SRC_CHUNKSERVER_RAFTLOG_SHARED_LOG_STREAM_H_
+
+#include <braft/log_entry.h>
+#include <bthread/condition_variable.h>
+#include <bthread/mutex.h>
+#include <butil/iobuf.h>
+#include <gflags/gflags.h>
+
+#include <cinttypes>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace curve {
+namespace chunkserver {
+
+DECLARE_uint64(sharedWalFileSize);
+
+#define SHARED_LOG_FILE_PATTERN "shared_log_%020" PRIu64
+
+// Format of record header, all fields are in network order
+// | record-type (8bits) | checksum_type (8bits) | reserved(16bits) |
+// | ------------------ log id (64bits) --------------------------- |
+// | ------------------ index (64bits) ---------------------------- |
+// | ------------------ term (64bits) ----------------------------- |
+// | ------------------ data len (32bits) ------------------------- |
+// | data_checksum (32bits) | header checksum (32bits)              |
+const size_t kSharedLogHeaderSize = 40;
+
+// record types beside braft::EntryType, they only have header
+enum SharedLogRecordType {
+    // drop entries after index of the log
+    SHARED_LOG_TRUNCATE_SUFFIX = 100,
+    // drop all entries of the log, the next entry is index
+    SHARED_LOG_RESET = 101,
+    // the log is removed
+    SHARED_LOG_REMOVE = 102,
+};
+
+// position of a log entry in the shared stream
+struct SharedLogLocation {
+    uint64_t fileSeq;
+    uint64_t offset;
+    uint32_t length;
+    int8_t type;
+    int64_t term;
+};
+
+// entries of one log found in the stream when it is loaded
+struct SharedLogRecovered {
+    SharedLogRecovered() : firstIndex(0) {}
+    // index of the first entry, or the next index after a reset,
+    // 0 if the log has no record
+    int64_t firstIndex;
+    std::deque<SharedLogLocation> entries;
+};
+
+/**
+ * One append-only log stream shared by all the copysets on a disk.
+ *
+ * Entries of every copyset are appended to the current file of the
+ * stream, so the disk sees sequential writes no matter how many
+ * copysets there are, and the index of each copyset is kept in memory by
+ * SharedLogStorage. Truncation of a copyset's tail, reset and remove are
+ * appended as records too, so replaying the files in order rebuilds every
+ * copyset's log.
+ *
+ * Every file counts the live entries of each log in it, only the oldest
+ * files without live entries are deleted. A record which truncates
+ * entries is never deleted before the files holding these entries.
+ *
+ * Appends from different copysets share fsync, a writer waits for the
+ * sync in flight instead of issuing its own when that sync covers its
+ * data.
+ */
+class SharedLogStream {
+ public:
+    /**
+     * @param path: directory of the stream files
+     * @param maxFileSize: a new file is used when the current file
+     *        reaches this size
+     */
+    SharedLogStream(const std::string& path, uint64_t maxFileSize);
+    ~SharedLogStream();
+
+    /**
+     * @brief load the files in path and replay all records, then start
+     *        a new file for appending
+     * @return 0 on success, -1 on failure
+     */
+    int Init();
+
+    /**
+     * @brief append consecutive entries of a log and sync them
+     * @param id: log id
+     * @param entries: entries to append
+     * @param count: number of entries
+     * @param locations: output, location of each entry
+     * @return 0 on success, -1 on failure
+     */
+    int Append(uint64_t id, const braft::LogEntry* const* entries,
+               size_t count, std::vector<SharedLogLocation>* locations);
+
+    // append a record which drops entries after lastIndexKept of the log
+    int TruncateSuffix(uint64_t id, int64_t lastIndexKept);
+
+    // append a record which drops all entries of the log
+    int Reset(uint64_t id, int64_t nextIndex);
+
+    /**
+     * @brief remove a log, its entries are not loaded any more, and the
+     *        files only held by it are deleted
+     */
+    int Remove(uint64_t id);
+
+    /**
+     * @brief read the entry at location
+     * @return the entry with a reference, nullptr on failure
+     */
+    braft::LogEntry* Read(const SharedLogLocation& location, int64_t index);
+
+    /**
+     * @brief entries of the log are dropped from its index, the files
+     *        without live entries are deleted
+     * @param id: log id
+     * @param locations: location of the dropped entries
+     */
+    void Release(uint64_t id,
+                 const std::vector<SharedLogLocation>& locations);
+
+    /**
+     * @brief take the entries of the log found by Init, the entries are
+     *        handed over only once
+     */
+    void TakeRecovered(uint64_t id, SharedLogRecovered* log);
+
+    // number of files in the stream
+    size_t FileCount();
+
+ private:
+    struct LogFile {
+        LogFile(uint64_t seq, const std::string& path, int fd)
+            : seq(seq), path(path), fd(fd), size(0) {}
+        ~LogFile();
+
+        const uint64_t seq;
+        const std::string path;
+        const int fd;
+        uint64_t size;
+        // number of live entries of each log in this file
+        std::unordered_map<uint64_t, int64_t> refs;
+    };
+
+    struct RecordHeader {
+        int type;
+        uint64_t id;
+        int64_t index;
+        int64_t term;
+        uint32_t dataLen;
+        uint32_t dataChecksum;
+    };
+
+    static void PackRecord(int type, uint64_t id, int64_t index,
+                           int64_t term, const butil::IOBuf& data,
+                           butil::IOBuf* record);
+
+    static bool ParseHeader(const char* buf, RecordHeader* header);
+
+    // load records of a file, torn record at the end is only allowed
+    // in the last file and it is truncated
+    int LoadFile(const std::shared_ptr<LogFile>& file, bool isLast);
+
+    void ApplyRecord(const RecordHeader& header,
+                     const SharedLogLocation& location);
+
+    // write record to the current file, mutex_ must be held
+    int AppendRecord(butil::IOBuf* record, uint64_t* fileSeq,
+                     uint64_t* offset);
+
+    // create a new file as the current file, mutex_ must be held
+    int RollFile();
+
+    // wait until bytes up to written are synced
+    int Sync(uint64_t written);
+
+    // delete the oldest files without live entries, mutex_ must be held
+    void RecycleFiles(std::vector<std::shared_ptr<LogFile>>* recycled);
+
+    void UnlinkFiles(const std::vector<std::shared_ptr<LogFile>>& files);
+
+    const std::string path_;
+    const uint64_t maxFileSize_;
+
+    bthread::Mutex mutex_;
+    std::map<uint64_t, std::shared_ptr<LogFile>> files_;
+    std::shared_ptr<LogFile> current_;
+    // bytes written to the stream since Init
+    uint64_t written_;
+    std::unordered_map<uint64_t, SharedLogRecovered> recovered_;
+
+    bthread::Mutex syncMutex_;
+    bthread::ConditionVariable syncCond_;
+    bool syncing_;
+    uint64_t synced_;
+};
+
+}  // namespace chunkserver
+}  // namespace curve
+
+#endif  // SRC_CHUNKSERVER_RAFTLOG_SHARED_LOG_STREAM_H_
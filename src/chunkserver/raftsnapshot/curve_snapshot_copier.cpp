@@ -41,13 +41,36 @@
 
 #include "src/chunkserver/raftsnapshot/curve_snapshot_copier.h"
 
+#include <algorithm>
+#include <deque>
+
+#include "src/chunkserver/datastore/filename_operator.h"
+#include "src/chunkserver/raftsnapshot/dirty_chunk_file.h"
+
 namespace curve {
 namespace chunkserver {
 
+namespace {
+
+// 返回chunk文件或者chunk快照文件的文件名及chunk id，不是chunk的文件返回false
+bool parse_chunk_file(const std::string& filename,
+                      std::string* name, ChunkID* id) {
+    *name = butil::FilePath(filename).BaseName().value();
+    auto info = FileNameOperator::ParseFileName(*name);
+    if (info.type == FileNameOperator::FileType::UNKNOWN) {
+        return false;
+    }
+    *id = info.id;
+    return true;
+}
+
+}  // namespace
+
 CurveSnapshotCopier::CurveSnapshotCopier(CurveSnapshotStorage* storage,
                                          bool filter_before_copy_remote,
                                          braft::FileSystemAdaptor* fs,
-                                         braft::SnapshotThrottle* throttle)
+                                         braft::SnapshotThrottle* throttle,
+                                         uint32_t copy_concurrency)
     : _tid(INVALID_BTHREAD)
     , _cancelled(false)
     , _filter_before_copy_remote(filter_before_copy_remote)
@@ -56,7 +79,8 @@ CurveSnapshotCopier::CurveSnapshotCopier(CurveSnapshotStorage* storage,
     , _writer(NULL)
     , _storage(storage)
     , _reader(NULL)
-    , _cur_session(NULL)
+    , _incremental(false)
+    , _copy_concurrency(std::max(copy_concurrency, 1u))
 {}
 
 CurveSnapshotCopier::~CurveSnapshotCopier() {
@@ -80,11 +104,13 @@ void CurveSnapshotCopier::copy() {
         if (!ok()) {
             break;
         }
+        load_dirty_chunks();
+        if (!ok()) {
+            break;
+        }
         std::vector<std::string> files;
         _remote_snapshot.list_files(&files);
-        for (size_t i = 0; i < files.size() && ok(); ++i) {
-            copy_file(files[i]);
-        }
+        copy_files(files, false);
 
         // 下载snapshot attachment文件
         load_attach_meta_table();
@@ -93,8 +119,10 @@ void CurveSnapshotCopier::copy() {
         }
         std::vector<std::string> attachFiles;
         _remote_snapshot.list_attach_files(&attachFiles);
-        for (size_t i = 0; i < attachFiles.size() && ok(); ++i) {
-            copy_file(attachFiles[i], true);
+        copy_files(attachFiles, true);
+
+        if (_incremental && ok()) {
+            save_incremental_flag();
         }
     } while (0);
     if (!ok() && _writer && _writer->ok()) {
@@ -126,11 +154,11 @@ void CurveSnapshotCopier::load_meta_table() {
     scoped_refptr<braft::RemoteFileCopier::Session> session
             = _copier.start_to_copy_to_iobuf(BRAFT_SNAPSHOT_META_FILE,
                                             &meta_buf, NULL);
-    _cur_session = session.get();
+    _cur_sessions.insert(session.get());
     lck.unlock();
     session->join();
     lck.lock();
-    _cur_session = NULL;
+    _cur_sessions.erase(session.get());
     lck.unlock();
     if (!session->status().ok()) {
         LOG(WARNING) << "Fail to copy meta file : " << session->status();
@@ -146,6 +174,133 @@ void CurveSnapshotCopier::load_meta_table() {
     CHECK(_remote_snapshot._meta_table.has_meta());
 }
 
+void CurveSnapshotCopier::load_dirty_chunks() {
+    _incremental = false;
+    _dirty_chunks.clear();
+    _downloaded_files.clear();
+    // filter会复用writer中已有的文件，这些文件没有记录在下载列表中
+    if (_filter_before_copy_remote) {
+        return;
+    }
+
+    // 老版本的leader没有记录dirty chunk
+    std::vector<std::string> files;
+    _remote_snapshot.list_files(&files);
+    if (std::find(files.begin(), files.end(), kCurveDirtyChunkFilename)
+        == files.end()) {
+        return;
+    }
+
+    // 本地没有快照的时候无法判断本地数据的状态，需要全量下载
+    braft::SnapshotReader* reader = _storage->open();
+    if (reader == NULL) {
+        return;
+    }
+    braft::SnapshotMeta local_meta;
+    int rc = reader->load_meta(&local_meta);
+    _storage->close(reader);
+    if (rc != 0) {
+        LOG(WARNING) << "Fail to load local snapshot meta, copy all files";
+        return;
+    }
+
+    butil::IOBuf buf;
+    std::unique_lock<braft::raft_mutex_t> lck(_mutex);
+    if (_cancelled) {
+        set_error(ECANCELED, "%s", berror(ECANCELED));
+        return;
+    }
+    scoped_refptr<braft::RemoteFileCopier::Session> session
+        = _copier.start_to_copy_to_iobuf(kCurveDirtyChunkFilename, &buf, NULL);
+    _cur_sessions.insert(session.get());
+    lck.unlock();
+    session->join();
+    lck.lock();
+    _cur_sessions.erase(session.get());
+    lck.unlock();
+    if (!session->status().ok()) {
+        LOG(WARNING) << "Fail to copy dirty chunk file : "
+                     << session->status();
+        set_error(session->status().error_code(),
+                  session->status().error_cstr());
+        return;
+    }
+
+    uint64_t base_index;
+    std::set<ChunkID> dirty_chunks;
+    if (DirtyChunkFile::Decode(buf.to_string(), &base_index,
+                               &dirty_chunks) != 0) {
+        LOG(WARNING) << "Bad dirty chunk file, copy all files";
+        return;
+    }
+    // 本地数据在base之后的修改都是远端快照中已经提交的log，
+    // 一定包含在dirty chunk中，所以其它chunk和远端快照一致
+    if (static_cast<int64_t>(base_index) !=
+        local_meta.last_included_index()) {
+        LOG(INFO) << "Local snapshot index " << local_meta.last_included_index()
+                  << " isn't the base index " << base_index
+                  << " of remote snapshot, copy all files";
+        return;
+    }
+
+    _incremental = true;
+    _dirty_chunks.swap(dirty_chunks);
+    LOG(INFO) << "Copy snapshot incrementally, base index: " << base_index
+              << ", dirty chunks: " << _dirty_chunks.size()
+              << ", writer path: " << _writer->get_path();
+}
+
+bool CurveSnapshotCopier::need_copy(const std::string& filename) {
+    if (!_incremental) {
+        return true;
+    }
+    std::string name;
+    ChunkID id;
+    if (!parse_chunk_file(filename, &name, &id)) {
+        return true;
+    }
+    return _dirty_chunks.count(id) != 0;
+}
+
+void CurveSnapshotCopier::keep_file(const std::string& filename) {
+    braft::LocalFileMeta meta;
+    _remote_snapshot.get_file_meta(filename, &meta);
+    if (_writer->add_file(filename, &meta) != 0) {
+        set_error(EIO, "Fail to add file to writer");
+        return;
+    }
+    if (_writer->sync() != 0) {
+        set_error(EIO, "Fail to sync writer");
+        return;
+    }
+}
+
+void CurveSnapshotCopier::save_incremental_flag() {
+    butil::IOBuf buf;
+    for (const auto& name : _downloaded_files) {
+        buf.append(name);
+        buf.append("\n");
+    }
+    std::string path = _writer->get_path() + "/"
+                       + kCurveIncrementalSnapshotFlag;
+    butil::File::Error e;
+    braft::FileAdaptor* file = _fs->open(path, O_CREAT | O_TRUNC | O_RDWR,
+                                         NULL, &e);
+    if (file == NULL) {
+        LOG(ERROR) << "Fail to open " << path
+                   << " : " << butil::File::ErrorToString(e);
+        set_error(braft::file_error_to_os_error(e),
+                  "Fail to open incremental snapshot flag");
+        return;
+    }
+    ssize_t size = buf.size();
+    if (file->write(buf, 0) != size || !file->sync()) {
+        LOG(ERROR) << "Fail to write " << path;
+        set_error(EIO, "Fail to write incremental snapshot flag");
+    }
+    delete file;
+}
+
 void CurveSnapshotCopier::load_attach_meta_table() {
     butil::IOBuf meta_buf;
     std::unique_lock<braft::raft_mutex_t> lck(_mutex);
@@ -156,11 +311,11 @@ void CurveSnapshotCopier::load_attach_meta_table() {
     scoped_refptr<braft::RemoteFileCopier::Session> session
         = _copier.start_to_copy_to_iobuf(BRAFT_SNAPSHOT_ATTACH_META_FILE,
                                          &meta_buf, NULL);
-    _cur_session = session.get();
+    _cur_sessions.insert(session.get());
     lck.unlock();
     session->join();
     lck.lock();
-    _cur_session = NULL;
+    _cur_sessions.erase(session.get());
     lck.unlock();
     if (!session->status().ok()) {
         LOG(WARNING) << "Fail to copy attach meta file : " << session->status();
@@ -305,11 +460,41 @@ void CurveSnapshotCopier::filter() {
     }
 }
 
-void CurveSnapshotCopier::copy_file(const std::string& filename, bool attch) {
+void CurveSnapshotCopier::copy_files(const std::vector<std::string>& files,
+                                     bool attach) {
+    // 同时下载多个文件，避免逐个下载时受网络延迟的限制，
+    // 所有文件的下载共享snapshot throttle的带宽
+    std::deque<CopyTask> tasks;
+    for (size_t i = 0; i < files.size() && ok(); ++i) {
+        if (!need_copy(files[i])) {
+            if (!attach) {
+                keep_file(files[i]);
+            }
+            continue;
+        }
+        CopyTask task;
+        if (!start_copy_file(files[i], attach, &task)) {
+            continue;
+        }
+        tasks.push_back(task);
+        if (tasks.size() >= _copy_concurrency) {
+            finish_copy_file(&tasks.front());
+            tasks.pop_front();
+        }
+    }
+    // 出错的时候也要等待所有已经发起的下载结束
+    while (!tasks.empty()) {
+        finish_copy_file(&tasks.front());
+        tasks.pop_front();
+    }
+}
+
+bool CurveSnapshotCopier::start_copy_file(const std::string& filename,
+                                          bool attch, CopyTask* task) {
     if (_writer->get_file_meta(filename, NULL) == 0) {
         LOG(INFO) << "Skipped downloading " << filename
                   << " path: " << _writer->get_path();
-        return;
+        return false;
     }
     std::string rfilename = get_rfilename(filename);
     std::string file_path = _writer->get_path() + '/' + rfilename;
@@ -333,27 +518,38 @@ void CurveSnapshotCopier::copy_file(const std::string& filename, bool attch) {
                       "Fail to create directory");
         }
     }
-    braft::LocalFileMeta meta;
-    _remote_snapshot.get_file_meta(filename, &meta);
+    task->filename = filename;
+    task->file_path = file_path;
+    task->attach = attch;
+    _remote_snapshot.get_file_meta(filename, &task->meta);
     std::unique_lock<braft::raft_mutex_t> lck(_mutex);
     if (_cancelled) {
         set_error(ECANCELED, "%s", berror(ECANCELED));
-        return;
+        return false;
     }
-    scoped_refptr<braft::RemoteFileCopier::Session> session
-        = _copier.start_to_copy_to_file(filename, file_path, NULL);
-    if (session == NULL) {
+    task->session = _copier.start_to_copy_to_file(filename, file_path, NULL);
+    if (task->session == NULL) {
         LOG(WARNING) << "Fail to copy " << filename
                      << " path: " << _writer->get_path();
         set_error(-1, "Fail to copy %s", filename.c_str());
-        return;
+        return false;
     }
-    _cur_session = session.get();
-    lck.unlock();
+    _cur_sessions.insert(task->session.get());
+    return true;
+}
+
+void CurveSnapshotCopier::finish_copy_file(CopyTask* task) {
+    scoped_refptr<braft::RemoteFileCopier::Session>& session = task->session;
+    const std::string& filename = task->filename;
+    const std::string& file_path = task->file_path;
     session->join();
-    lck.lock();
-    _cur_session = NULL;
+    std::unique_lock<braft::raft_mutex_t> lck(_mutex);
+    _cur_sessions.erase(session.get());
     lck.unlock();
+    // 前面的下载已经出错，其它下载的结果不再处理
+    if (!ok()) {
+        return;
+    }
     if (!session->status().ok()) {
         // 如果是文件不存在，那么删除刚开始open的文件
         if (session->status().error_code() == ENOENT) {
@@ -372,7 +568,7 @@ void CurveSnapshotCopier::copy_file(const std::string& filename, bool attch) {
         return;
     }
     // 如果是attach file，那么不需要持久化file meta信息
-    if (!attch && _writer->add_file(filename, &meta) != 0) {
+    if (!task->attach && _writer->add_file(filename, &task->meta) != 0) {
         set_error(EIO, "Fail to add file to writer");
         return;
     }
@@ -380,6 +576,11 @@ void CurveSnapshotCopier::copy_file(const std::string& filename, bool attch) {
         set_error(EIO, "Fail to sync writer");
         return;
     }
+    std::string name;
+    ChunkID id;
+    if (_incremental && parse_chunk_file(filename, &name, &id)) {
+        _downloaded_files.push_back(name);
+    }
 }
 
 std::string CurveSnapshotCopier::get_rfilename(const std::string& filename) {
@@ -411,8 +612,8 @@ void CurveSnapshotCopier::cancel() {
         return;
     }
     _cancelled = true;
-    if (_cur_session) {
-        _cur_session->cancel();
+    for (auto session : _cur_sessions) {
+        session->cancel();
     }
 }
 
@@ -43,8 +43,11 @@
 #define SRC_CHUNKSERVER_RAFTSNAPSHOT_CURVE_SNAPSHOT_COPIER_H_
 
 #include <braft/storage.h>
+#include <braft/local_file_meta.pb.h>
+#include <set>
 #include <vector>
 #include <string>
+#include "include/chunkserver/chunkserver_common.h"
 #include "src/chunkserver/raftsnapshot/curve_snapshot.h"
 #include "src/chunkserver/raftsnapshot/curve_snapshot_storage.h"
 
@@ -58,7 +61,8 @@ class CurveSnapshotCopier : public braft::SnapshotCopier {
     CurveSnapshotCopier(CurveSnapshotStorage* storage,
                         bool filter_before_copy_remote,
                         braft::FileSystemAdaptor* fs,
-                        braft::SnapshotThrottle* throttle);
+                        braft::SnapshotThrottle* throttle,
+                        uint32_t copy_concurrency);
     ~CurveSnapshotCopier();
     virtual void cancel();
     virtual void join();
@@ -74,7 +78,28 @@ class CurveSnapshotCopier : public braft::SnapshotCopier {
     int filter_before_copy(CurveSnapshotWriter* writer,
                            braft::SnapshotReader* last_snapshot);
     void filter();
-    void copy_file(const std::string& filename, bool attach = false);
+    struct CopyTask {
+        std::string filename;
+        std::string file_path;
+        bool attach;
+        braft::LocalFileMeta meta;
+        scoped_refptr<braft::RemoteFileCopier::Session> session;
+    };
+    // 并发下载文件，同时进行的下载不超过_copy_concurrency个
+    void copy_files(const std::vector<std::string>& files, bool attach);
+    // 发起文件下载，返回false表示文件不需要下载或者出错
+    bool start_copy_file(const std::string& filename, bool attach,
+                         CopyTask* task);
+    // 等待下载结束，并把文件加入writer
+    void finish_copy_file(CopyTask* task);
+    // 本地最近的快照就是远端快照的base时，只下载被修改的chunk
+    void load_dirty_chunks();
+    // 文件是否属于被修改的chunk，非chunk文件都需要下载
+    bool need_copy(const std::string& filename);
+    // 不下载文件，直接使用本地的chunk文件
+    void keep_file(const std::string& filename);
+    // 记录下载的文件，加载快照时据此替换本地被修改的chunk
+    void save_incremental_flag();
     // 这里的filename是相对于快照目录的路径，为了先把文件下载到临时目录，需要把前面的..去掉
     std::string get_rfilename(const std::string& filename);
 
@@ -87,7 +112,11 @@ class CurveSnapshotCopier : public braft::SnapshotCopier {
     CurveSnapshotWriter* _writer;
     CurveSnapshotStorage* _storage;
     braft::SnapshotReader* _reader;
-    braft::RemoteFileCopier::Session* _cur_session;
+    bool _incremental;
+    std::set<ChunkID> _dirty_chunks;
+    std::vector<std::string> _downloaded_files;
+    uint32_t _copy_concurrency;
+    std::set<braft::RemoteFileCopier::Session*> _cur_sessions;
     CurveSnapshot _remote_snapshot;
     braft::RemoteFileCopier _copier;
 };
@@ -88,6 +88,10 @@ friend class CurveSnapshotCopier;
         _addr = server_addr;
     }
     static bool has_server_addr() { return _addr != butil::EndPoint(); }
+    // install snapshot时同时下载的文件数
+    static void set_copy_concurrency(uint32_t copy_concurrency) {
+        _copy_concurrency = copy_concurrency;
+    }
 
  private:
     braft::SnapshotWriter* create(bool from_empty) WARN_UNUSED_RESULT;
@@ -104,6 +108,7 @@ friend class CurveSnapshotCopier;
     scoped_refptr<braft::FileSystemAdaptor> _fs;
     scoped_refptr<braft::SnapshotThrottle> _snapshot_throttle;
     static butil::EndPoint _addr;
+    static uint32_t _copy_concurrency;
 };
 
 }  // namespace chunkserver
@@ -38,6 +38,11 @@ const char RAFT_LOG_DIR[]  = "log";
 #define BRAFT_SNAPSHOT_ATTACH_META_FILE "__raft_snapshot_attach_meta"
 #define BRAFT_PROTOBUF_FILE_TEMP ".tmp"
 
+// 快照中记录的相对于上一次快照被修改过的chunk
+const char kCurveDirtyChunkFilename[] = "dirty.chunks";
+// 增量安装的快照中记录下载了哪些被修改的chunk文件
+const char kCurveIncrementalSnapshotFlag[] = "incremental.flag";
+
 }  // namespace chunkserver
 }  // namespace curve
 
@@ -0,0 +1,211 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/chunkserver/raftsnapshot/dirty_chunk_file.h"
+
+#include <glog/logging.h>
+#include <fcntl.h>
+#include <string.h>
+
+#include <vector>
+
+#include "src/common/crc32.h"
+
+namespace curve {
+namespace chunkserver {
+
+const uint64_t kDirtyChunkFileMagic = 0x4449525459434b53;
+const size_t kDirtyChunkFileHeadSize =
+    sizeof(uint64_t) * 3 + sizeof(uint32_t);
+// more than all the chunks of a copyset, protect against a bad count
+const uint64_t kDirtyChunkFileMaxCount = 16 * 1024 * 1024;
+
+namespace {
+
+uint32_t DirtyChunkCrc(uint64_t baseIndex,
+                       uint64_t count,
+                       const char *ids) {
+    uint64_t magic = kDirtyChunkFileMagic;
+    uint32_t crc32c = 0;
+    crc32c = curve::common::CRC32(
+        crc32c, reinterpret_cast<const char *>(&baseIndex), sizeof(baseIndex));
+    crc32c = curve::common::CRC32(
+        crc32c, reinterpret_cast<const char *>(&count), sizeof(count));
+    if (count > 0) {
+        crc32c = curve::common::CRC32(crc32c, ids, count * sizeof(ChunkID));
+    }
+    crc32c = curve::common::CRC32(
+        crc32c, reinterpret_cast<const char *>(&magic), sizeof(magic));
+    return crc32c;
+}
+
+}  // namespace
+
+std::string DirtyChunkFile::Encode(uint64_t baseIndex,
+                                   const std::set<ChunkID> &chunkIds) {
+    std::vector<ChunkID> ids(chunkIds.begin(), chunkIds.end());
+    uint64_t magic = kDirtyChunkFileMagic;
+    uint64_t count = ids.size();
+    const char *idsData = reinterpret_cast<const char *>(ids.data());
+    uint32_t crc32c = DirtyChunkCrc(baseIndex, count, idsData);
+
+    std::string out;
+    out.reserve(kDirtyChunkFileHeadSize + count * sizeof(ChunkID));
+    out.append(reinterpret_cast<const char *>(&magic), sizeof(magic));
+    out.append(reinterpret_cast<const char *>(&baseIndex), sizeof(baseIndex));
+    out.append(reinterpret_cast<const char *>(&count), sizeof(count));
+    out.append(reinterpret_cast<const char *>(&crc32c), sizeof(crc32c));
+    if (count > 0) {
+        out.append(idsData, count * sizeof(ChunkID));
+    }
+    return out;
+}
+
+int DirtyChunkFile::Decode(const std::string &data,
+                           uint64_t *baseIndex,
+                           std::set<ChunkID> *chunkIds) {
+    if (data.size() < kDirtyChunkFileHeadSize) {
+        LOG(ERROR) << "dirty chunk data too short, size: " << data.size();
+        return -1;
+    }
+
+    uint64_t magic;
+    uint64_t base;
+    uint64_t count;
+    uint32_t crc32c;
+    const char *pos = data.data();
+    memcpy(&magic, pos, sizeof(magic));
+    pos += sizeof(magic);
+    memcpy(&base, pos, sizeof(base));
+    pos += sizeof(base);
+    memcpy(&count, pos, sizeof(count));
+    pos += sizeof(count);
+    memcpy(&crc32c, pos, sizeof(crc32c));
+    pos += sizeof(crc32c);
+    if (magic != kDirtyChunkFileMagic || count > kDirtyChunkFileMaxCount ||
+        data.size() != kDirtyChunkFileHeadSize + count * sizeof(ChunkID)) {
+        LOG(ERROR) << "dirty chunk data invalid, magic: " << magic
+                   << ", count: " << count << ", size: " << data.size();
+        return -1;
+    }
+    if (crc32c != DirtyChunkCrc(base, count, pos)) {
+        LOG(ERROR) << "dirty chunk data crc error";
+        return -1;
+    }
+
+    std::vector<ChunkID> ids(count);
+    if (count > 0) {
+        memcpy(ids.data(), pos, count * sizeof(ChunkID));
+    }
+    *baseIndex = base;
+    chunkIds->clear();
+    chunkIds->insert(ids.begin(), ids.end());
+    return 0;
+}
+
+int DirtyChunkFile::Load(const std::string &path,
+                         uint64_t *baseIndex,
+                         std::set<ChunkID> *chunkIds) {
+    int fd = fs_->Open(path.c_str(), O_RDONLY);
+    if (0 > fd) {
+        LOG(ERROR) << "LoadDirtyChunk failed open file " << path
+                   << ", errno: " << errno
+                   << ", error message: " << strerror(errno);
+        return -1;
+    }
+
+    // 1. read head to get the count of chunk ids
+    std::string data(kDirtyChunkFileHeadSize, '\0');
+    int size = fs_->Read(fd, &data[0], 0, kDirtyChunkFileHeadSize);
+    if (size != static_cast<int>(kDirtyChunkFileHeadSize)) {
+        LOG(ERROR) << "LoadDirtyChunk read head failed: " << path
+                   << ", read size: " << size
+                   << ", errno: " << errno
+                   << ", error message: " << strerror(errno);
+        fs_->Close(fd);
+        return -1;
+    }
+    uint64_t count;
+    memcpy(&count, data.data() + sizeof(uint64_t) * 2, sizeof(count));
+    if (count > kDirtyChunkFileMaxCount) {
+        LOG(ERROR) << "LoadDirtyChunk invalid count: " << count
+                   << ", path: " << path;
+        fs_->Close(fd);
+        return -1;
+    }
+
+    // 2. read chunk ids
+    int length = count * sizeof(ChunkID);
+    if (length > 0) {
+        data.resize(kDirtyChunkFileHeadSize + length);
+        size = fs_->Read(fd, &data[kDirtyChunkFileHeadSize],
+                         kDirtyChunkFileHeadSize, length);
+        if (size != length) {
+            LOG(ERROR) << "LoadDirtyChunk read chunk ids failed: " << path
+                       << ", read size: " << size
+                       << ", expected size: " << length
+                       << ", errno: " << errno
+                       << ", error message: " << strerror(errno);
+            fs_->Close(fd);
+            return -1;
+        }
+    }
+    fs_->Close(fd);
+
+    // 3. verify and decode
+    if (0 != Decode(data, baseIndex, chunkIds)) {
+        LOG(ERROR) << "LoadDirtyChunk decode failed: " << path;
+        return -1;
+    }
+    return 0;
+}
+
+int DirtyChunkFile::Save(const std::string &path,
+                         uint64_t baseIndex,
+                         const std::set<ChunkID> &chunkIds) {
+    std::string out = Encode(baseIndex, chunkIds);
+
+    int fd = fs_->Open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC);
+    if (0 > fd) {
+        LOG(ERROR) << "SaveDirtyChunk failed open file " << path
+                   << ", errno: " << errno
+                   << ", error message: " << strerror(errno);
+        return -1;
+    }
+
+    if (static_cast<int>(out.size()) !=
+        fs_->Write(fd, out.c_str(), 0, out.size())) {
+        LOG(ERROR) << "SaveDirtyChunk write failed, path: " << path
+                   << ", errno: " << errno
+                   << ", error message: " << strerror(errno);
+        fs_->Close(fd);
+        return -1;
+    }
+
+    if (0 != fs_->Fsync(fd)) {
+        LOG(ERROR) << "SaveDirtyChunk sync failed, path: " << path
+                   << ", errno: " << errno
+                   << ", error message: " << strerror(errno);
+        fs_->Close(fd);
+        return -1;
+    }
+    fs_->Close(fd);
+
+    return 0;
+}
+
+}  // namespace chunkserver
+}  // namespace curve
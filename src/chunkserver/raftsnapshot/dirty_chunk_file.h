@@ -0,0 +1,85 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_CHUNKSERVER_RAFTSNAPSHOT_DIRTY_CHUNK_FILE_H_
+#define SRC_CHUNKSERVER_RAFTSNAPSHOT_DIRTY_CHUNK_FILE_H_
+
+#include <memory>
+#include <set>
+#include <string>
+
+#include "src/fs/local_filesystem.h"
+#include "include/chunkserver/chunkserver_common.h"
+
+namespace curve {
+namespace chunkserver {
+
+using curve::fs::LocalFileSystem;
+
+/**
+ * Serialize and deserialize the ids of the chunks changed since a base raft
+ * snapshot of a copyset, the file is saved in the snapshot together with
+ * conf.epoch. A follower holding the base snapshot only needs to download
+ * these chunks to install the snapshot.
+ */
+class DirtyChunkFile {
+ public:
+    explicit DirtyChunkFile(std::shared_ptr<LocalFileSystem> fs)
+        : fs_(fs) {}
+
+    /**
+     * load the dirty chunk ids from file
+     * @param path: file path
+     * @param baseIndex: output, last included index of the base snapshot
+     * @param chunkIds: output, ids of the dirty chunks
+     * @return 0 success, -1 failed
+     */
+    int Load(const std::string &path,
+             uint64_t *baseIndex,
+             std::set<ChunkID> *chunkIds);
+
+    /**
+     * save the dirty chunk ids to file and sync it, the format is:
+     * |                       head                        |    chunk ids    |
+     * | 8 bytes magic | 8 bytes base | 8 bytes count | crc | count * 8 bytes|
+     * crc32 is calculated over base, count, chunk ids and magic
+     * @param path: file path
+     * @param baseIndex: last included index of the base snapshot
+     * @param chunkIds: ids of the dirty chunks
+     * @return 0 success, -1 failed
+     */
+    int Save(const std::string &path,
+             uint64_t baseIndex,
+             const std::set<ChunkID> &chunkIds);
+
+    static std::string Encode(uint64_t baseIndex,
+                              const std::set<ChunkID> &chunkIds);
+
+    /**
+     * @return 0 success, -1 the data is corrupted
+     */
+    static int Decode(const std::string &data,
+                      uint64_t *baseIndex,
+                      std::set<ChunkID> *chunkIds);
+
+ private:
+    std::shared_ptr<LocalFileSystem> fs_;
+};
+
+}  // namespace chunkserver
+}  // namespace curve
+
+#endif  // SRC_CHUNKSERVER_RAFTSNAPSHOT_DIRTY_CHUNK_FILE_H_
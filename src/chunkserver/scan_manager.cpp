@@ -20,6 +20,9 @@
  * Author: huyao
  */
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+
 #include "src/chunkserver/scan_manager.h"
 #include "src/chunkserver/op_request.h"
 
@@ -27,6 +30,7 @@ namespace curve {
 namespace chunkserver {
 
 using ::google::protobuf::util::MessageDifferencer;
+using ::curve::common::TimeUtility;
 
 int ScanManager::Init(const ScanManagerOptions &options) {
     toStop_.store(false, std::memory_order_release);
@@ -35,9 +39,8 @@ int ScanManager::Init(const ScanManagerOptions &options) {
     timeoutMs_ = options.timeoutMs;
     retry_ = options.retry;
     retryIntervalUs_ = options.retryIntervalUs;
+    dutyCyclePercent_ = options.dutyCyclePercent;
     jobWaitInterval_.Init(options.intervalSec * 1000);
-    // reuse timeout 1000ms as send scan task interval
-    scanTaskWaitInterval_.Init(options.timeoutMs);
     copysetNodeManager_ = options.copysetNodeManager;
     chunkSize_ = copysetNodeManager_->GetCopysetNodeOptions().maxChunkSize;
     if (scanSize_ > chunkSize_ || scanSize_ <= 0 ||
@@ -46,6 +49,12 @@ int ScanManager::Init(const ScanManagerOptions &options) {
                    << "the scan size: " << scanSize_;
         return -1;
     }
+    if (dutyCyclePercent_ == 0 || dutyCyclePercent_ > 100) {
+        LOG(ERROR) << "Init scan manager failed, "
+                   << "the duty cycle percent: " << dutyCyclePercent_;
+        return -1;
+    }
+    scanTaskSleeper_.init();
     return 0;
 }
 
@@ -53,6 +62,7 @@ int ScanManager::Fini() {
     LOG(INFO) << "Stopping scan manager.";
     jobWaitInterval_.StopWait();
     toStop_.store(true, std::memory_order_release);
+    scanTaskSleeper_.interrupt();
     scanThread_.join();
     waitScanSet_.clear();
     jobs_.clear();
@@ -225,7 +235,7 @@ int ScanManager::ScanJobProcess(const std::shared_ptr<ScanJob> job) {
     while (iter != job->chunkMap.end()) {
         // check chunk version
         auto csChunkFile = iter->second;
-        if (csChunkFile->GetChunkFileMetaPage().version !=
+        if (csChunkFile->GetChunkFileMetaPage().version <
             FORMAT_VERSION_V2) {
             iter++;
         } else {
@@ -282,11 +292,9 @@ int ScanManager::ScanJobProcess(const std::shared_ptr<ScanJob> job) {
                     currentOffset += scanSize_;
                 }
                 // wait for scan task finished
-                uint32_t retry = retry_;
-                while (!job->isFinished && retry > 0) {
-                    scanTaskWaitInterval_.WaitForNextExcution();
-                    retry--;
-                }
+                uint64_t startUs = TimeUtility::GetTimeofDayUs();
+                WaitScanTask(job);
+                PauseAfterScanTask(TimeUtility::GetTimeofDayUs() - startUs);
                 scanChunkMetaPage = false;
             }
             iter++;
@@ -295,6 +303,37 @@ int ScanManager::ScanJobProcess(const std::shared_ptr<ScanJob> job) {
     return 0;
 }
 
+void ScanManager::WaitScanTask(std::shared_ptr<ScanJob> job) {
+    // poll the task in small steps instead of waiting a whole timeout,
+    // so that a task finished quickly, e.g. with a cached crc, is followed
+    // by the next one immediately
+    const uint64_t stepUs = 10 * 1000;
+    uint64_t deadlineUs = TimeUtility::GetTimeofDayUs() +
+                          timeoutMs_ * 1000 * retry_;
+    while (!job->isFinished) {
+        uint64_t nowUs = TimeUtility::GetTimeofDayUs();
+        if (nowUs >= deadlineUs) {
+            break;
+        }
+        uint64_t waitUs = std::min(stepUs, deadlineUs - nowUs);
+        if (!scanTaskSleeper_.wait_for(std::chrono::microseconds(waitUs))) {
+            break;
+        }
+    }
+}
+
+void ScanManager::PauseAfterScanTask(uint64_t costUs) {
+    if (dutyCyclePercent_ >= 100) {
+        return;
+    }
+    // the slower the disk responds, the longer the pause,
+    // keep the scan away from the foreground io on a busy disk
+    uint64_t pauseUs = costUs * (100 - dutyCyclePercent_) / dutyCyclePercent_;
+    if (pauseUs > 0) {
+        scanTaskSleeper_.wait_for(std::chrono::microseconds(pauseUs));
+    }
+}
+
 void ScanManager::SetLocalScanMap(ScanKey key, ScanMap map) {
     auto job = GetJob(key);
     if (nullptr == job) {
@@ -33,6 +33,7 @@
 #include "include/chunkserver/chunkserver_common.h"
 #include "src/common/concurrent/concurrent.h"
 #include "src/common/wait_interval.h"
+#include "src/common/interruptible_sleeper.h"
 #include "proto/scan.pb.h"
 #include "src/chunkserver/datastore/chunkserver_datastore.h"
 #include "src/chunkserver/copyset_node_manager.h"
@@ -42,6 +43,7 @@
 using curve::common::Thread;
 using curve::common::RWLock;
 using curve::common::WaitInterval;
+using curve::common::InterruptibleSleeper;
 
 namespace curve {
 namespace chunkserver {
@@ -63,6 +65,10 @@ struct ScanManagerOptions {
     uint32_t retry;
     uint64_t retryIntervalUs;
     CopysetNodeManager* copysetNodeManager;
+    // percentage of time a scan job keeps a scan task in flight, the job
+    // pauses after each task in proportion to the time the task took,
+    // so it slows down when the disk is busy, 100 means never pause
+    uint32_t dutyCyclePercent = 100;
 };
 
 /**
@@ -234,13 +240,25 @@ class ScanManager {
      */
     std::shared_ptr<ScanJob> GetJob(ScanKey key);
 
+    /**
+     * @brief wait for the scan task of the job finished or timeout
+     * @param[in] job: the scan job
+     */
+    void WaitScanTask(std::shared_ptr<ScanJob> job);
+
+    /**
+     * @brief pause according to duty cycle after a scan task
+     * @param[in] costUs: the time the scan task took
+     */
+    void PauseAfterScanTask(uint64_t costUs);
+
     // scan process thread
     Thread scanThread_;
     std::atomic<bool> toStop_;
     std::set<ScanKey> waitScanSet_;
     RWLock waitSetLock_;
     WaitInterval jobWaitInterval_;
-    WaitInterval scanTaskWaitInterval_;
+    InterruptibleSleeper scanTaskSleeper_;
     std::map<ScanKey, std::shared_ptr<ScanJob>> jobs_;
     RWLock jobMapLock_;
     CopysetNodeManager *copysetNodeManager_;
@@ -250,6 +268,7 @@ class ScanManager {
     uint64_t timeoutMs_;
     uint32_t retry_;
     uint64_t retryIntervalUs_;
+    uint32_t dutyCyclePercent_;
 };
 }  // namespace chunkserver
 }  // namespace curve
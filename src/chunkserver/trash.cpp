@@ -29,6 +29,7 @@
 #include "src/chunkserver/copyset_node.h"
 #include "include/chunkserver/chunkserver_common.h"
 #include "src/common/uri_parser.h"
+#include "src/common/timeutility.h"
 #include "src/chunkserver/raftlog/define.h"
 
 using ::curve::chunkserver::RAFT_DATA_DIR;
@@ -38,6 +39,13 @@ using ::curve::chunkserver::RAFT_LOG_DIR;
 
 namespace curve {
 namespace chunkserver {
+
+using ::curve::common::ReadWriteThrottleParams;
+using ::curve::common::ThrottleParams;
+using ::curve::common::TimeUtility;
+
+const char Trash::kPendingIndexName[] = "recycle_pending";
+
 int Trash::Init(TrashOptions options) {
     isStop_ = true;
 
@@ -58,6 +66,17 @@ int Trash::Init(TrashOptions options) {
     localFileSystem_ = options.localFileSystem;
     chunkFilePool_ = options.chunkFilePool;
     walPool_ = options.walPool;
+    recycleBatchSize_ = options.recycleBatchSize;
+    recycleBatchIntervalMs_ = options.recycleBatchIntervalMs;
+    if (recycleBatchSize_ > 0 && recycleBatchIntervalMs_ == 0) {
+        LOG(ERROR) << "recycle batch interval must not be 0";
+        return -1;
+    }
+    ReadWriteThrottleParams params;
+    params.iopsTotal = ThrottleParams(options.recycleIops, 0, 0);
+    recycleThrottle_.UpdateThrottleParams(params);
+    pending_.clear();
+    pendingDirs_.clear();
     chunkNum_.store(0);
 
      // 读取trash目录下的所有目录
@@ -137,13 +156,34 @@ int Trash::RecycleCopySet(const std::string &dirPath) {
 }
 
 void Trash::DeleteEligibleFileInTrashInterval() {
-     while (sleeper_.wait_for(std::chrono::seconds(scanPeriodSec_))) {
-        // 扫描回收站
-         DeleteEligibleFileInTrash();
-     }
+    if (recycleBatchSize_ == 0) {
+        while (sleeper_.wait_for(std::chrono::seconds(scanPeriodSec_))) {
+            // 扫描回收站
+            DeleteEligibleFileInTrash();
+        }
+        return;
+    }
+
+    // 分批回收时按扫描周期发现过期的copyset，每批之间暂停一段时间
+    uint64_t lastScanUs = TimeUtility::GetTimeofDayUs();
+    while (sleeper_.wait_for(
+               std::chrono::milliseconds(recycleBatchIntervalMs_))) {
+        uint64_t nowUs = TimeUtility::GetTimeofDayUs();
+        if (nowUs - lastScanUs >= scanPeriodSec_ * 1000000ull) {
+            ScanExpiredCopysets();
+            lastScanUs = nowUs;
+        }
+        RecycleBatch(true);
+    }
 }
 
 void Trash::DeleteEligibleFileInTrash() {
+    if (recycleBatchSize_ > 0) {
+        ScanExpiredCopysets();
+        RecycleBatch(false);
+        return;
+    }
+
     // trash目录暂不存在
     if (!localFileSystem_->DirExists(trashPath_)) {
         return;
@@ -180,6 +220,189 @@ void Trash::DeleteEligibleFileInTrash() {
     }
 }
 
+void Trash::ScanExpiredCopysets() {
+    // trash目录暂不存在
+    if (!localFileSystem_->DirExists(trashPath_)) {
+        return;
+    }
+
+    std::vector<std::string> files;
+    if (0 != localFileSystem_->List(trashPath_, &files)) {
+        LOG(ERROR) << "Trash failed list files in " << trashPath_;
+        return;
+    }
+
+    for (auto &file : files) {
+        if (!IsCopysetInTrash(file)) {
+            continue;
+        }
+        std::string copysetDir = trashPath_ + "/" + file;
+        if (pendingDirs_.count(copysetDir) != 0 || !NeedDelete(copysetDir)) {
+            continue;
+        }
+
+        PendingCopyset copyset;
+        copyset.dir = copysetDir;
+        std::vector<std::string> pendingFiles;
+        if (0 != LoadPendingFiles(copysetDir, &pendingFiles,
+                                  &copyset.fromIndex)) {
+            continue;
+        }
+        copyset.files.assign(pendingFiles.begin(), pendingFiles.end());
+        LOG(INFO) << "Trash start to recycle " << copyset.files.size()
+                  << " files in " << copysetDir;
+        pending_.emplace_back(std::move(copyset));
+        pendingDirs_.insert(copysetDir);
+    }
+}
+
+void Trash::RecycleBatch(bool interruptible) {
+    uint32_t recycled = 0;
+    while (!pending_.empty() && recycled < recycleBatchSize_) {
+        PendingCopyset &copyset = pending_.front();
+        while (!copyset.files.empty() && recycled < recycleBatchSize_) {
+            // 停止时不再等待限速，未回收的文件留给下次启动
+            if (interruptible && isStop_.load()) {
+                return;
+            }
+            std::string filePath = copyset.dir + "/" + copyset.files.front();
+            copyset.files.pop_front();
+            recycleThrottle_.Add(false, 0);
+            // recycle 失败不应该中断其他文件的recycle
+            if (!RecycleOneFile(filePath, copyset.fromIndex)) {
+                copyset.failed = true;
+            }
+            ++recycled;
+        }
+        if (!copyset.files.empty()) {
+            return;
+        }
+
+        // 文件都回收成功后删除copyset目录，否则保留索引等下次扫描时重试
+        if (!copyset.failed) {
+            if (0 != localFileSystem_->Delete(copyset.dir)) {
+                LOG(ERROR) << "Trash fail to delete " << copyset.dir;
+            } else {
+                LOG(INFO) << "Trash recycled copyset " << copyset.dir;
+            }
+        }
+        pendingDirs_.erase(copyset.dir);
+        pending_.pop_front();
+    }
+}
+
+int Trash::LoadPendingFiles(const std::string &copysetDir,
+                            std::vector<std::string> *files,
+                            bool *fromIndex) {
+    std::string indexPath = copysetDir + "/" + kPendingIndexName;
+    if (localFileSystem_->FileExists(indexPath)) {
+        if (0 == ReadPendingIndex(indexPath, files)) {
+            *fromIndex = true;
+            return 0;
+        }
+        LOG(WARNING) << "Trash failed to read " << indexPath
+                     << ", list the copyset again";
+        files->clear();
+    }
+
+    *fromIndex = false;
+    if (!ListRecyclableFiles(copysetDir, "", files)) {
+        return -1;
+    }
+    // 索引写入失败不影响本次回收，重启后重新遍历即可
+    if (0 != WritePendingIndex(indexPath, *files)) {
+        LOG(WARNING) << "Trash failed to write " << indexPath;
+    }
+    return 0;
+}
+
+bool Trash::ListRecyclableFiles(const std::string &dir,
+                                const std::string &prefix,
+                                std::vector<std::string> *files) {
+    std::vector<std::string> names;
+    if (0 != localFileSystem_->List(dir, &names)) {
+        LOG(ERROR) << "Trash failed to list files in " << dir;
+        return false;
+    }
+
+    for (auto &name : names) {
+        std::string path = dir + "/" + name;
+        std::string relative = prefix.empty() ? name : prefix + "/" + name;
+        if (localFileSystem_->DirExists(path)) {
+            if (!ListRecyclableFiles(path, relative, files)) {
+                return false;
+            }
+        } else if (IsChunkOrSnapShotFile(name) || IsWALFile(name)) {
+            files->push_back(relative);
+        }
+    }
+    return true;
+}
+
+int Trash::ReadPendingIndex(const std::string &path,
+                            std::vector<std::string> *files) {
+    int fd = localFileSystem_->Open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat info;
+    if (0 != localFileSystem_->Fstat(fd, &info)) {
+        localFileSystem_->Close(fd);
+        return -1;
+    }
+    std::string content(info.st_size, '\0');
+    if (info.st_size > 0 &&
+        localFileSystem_->Read(fd, &content[0], 0, info.st_size) !=
+            info.st_size) {
+        localFileSystem_->Close(fd);
+        return -1;
+    }
+    localFileSystem_->Close(fd);
+    ::curve::common::SplitString(content, "\n", files);
+    return 0;
+}
+
+int Trash::WritePendingIndex(const std::string &path,
+                             const std::vector<std::string> &files) {
+    std::string content;
+    for (auto &file : files) {
+        content.append(file).append("\n");
+    }
+
+    // 先写临时文件再rename，避免重启后读到不完整的索引
+    std::string tmpPath = path + ".tmp";
+    int fd = localFileSystem_->Open(tmpPath, O_RDWR | O_CREAT | O_TRUNC);
+    if (fd < 0) {
+        return -1;
+    }
+    int ret = 0;
+    if (!content.empty() &&
+        localFileSystem_->Write(fd, content.c_str(), 0, content.size()) !=
+            static_cast<int>(content.size())) {
+        ret = -1;
+    }
+    if (ret == 0 && 0 != localFileSystem_->Fsync(fd)) {
+        ret = -1;
+    }
+    localFileSystem_->Close(fd);
+    if (ret == 0 && 0 != localFileSystem_->Rename(tmpPath, path)) {
+        ret = -1;
+    }
+    return ret;
+}
+
+bool Trash::RecycleOneFile(const std::string &filepath, bool checkExist) {
+    // 索引中的文件可能在重启前已经回收
+    if (checkExist && !localFileSystem_->FileExists(filepath)) {
+        return true;
+    }
+    std::string filename = filepath.substr(filepath.find_last_of('/') + 1);
+    if (IsChunkOrSnapShotFile(filename)) {
+        return RecycleChunkfile(filepath, filename);
+    }
+    return RecycleWAL(filepath, filename);
+}
+
 bool Trash::IsCopysetInTrash(const std::string &dirName) {
     // 合法的copyset目录: 高32位PoolId(>0)组成， 低32位由copysetId(>0)组成
     // 目录是十进制形式
@@ -321,6 +544,9 @@ uint32_t Trash::CountChunkNumInCopyset(const std::string &copysetPath) {
         std::string filePath = copysetPath + "/" + file;
         bool isDir = localFileSystem_->DirExists(filePath);
         if (!isDir) {
+            if (file == kPendingIndexName) {
+                continue;
+            }
             // valid: chunkfile, snapshotfile, walfile
             if (!(IsChunkOrSnapShotFile(file) ||
                   IsWALFile(file))) {
@@ -23,18 +23,23 @@
 #ifndef SRC_CHUNKSERVER_TRASH_H_
 #define SRC_CHUNKSERVER_TRASH_H_
 
+#include <deque>
 #include <memory>
+#include <set>
 #include <string>
+#include <vector>
 #include "src/fs/local_filesystem.h"
 #include "src/chunkserver/datastore/file_pool.h"
 #include "src/common/concurrent/concurrent.h"
 #include "src/common/interruptible_sleeper.h"
+#include "src/common/throttle.h"
 
 using ::curve::common::Thread;
 using ::curve::common::Atomic;
 using ::curve::common::Mutex;
 using ::curve::common::LockGuard;
 using ::curve::common::InterruptibleSleeper;
+using ::curve::common::Throttle;
 
 namespace curve {
 namespace chunkserver {
@@ -45,6 +50,12 @@ struct TrashOptions{
     int expiredAfterSec;
     // 扫描trash目录的时间间隔
     int scanPeriodSec;
+    // 每批回收的文件数，为0表示每次扫描时回收完所有过期copyset的文件
+    uint32_t recycleBatchSize = 0;
+    // 分批回收时两批之间的间隔
+    uint32_t recycleBatchIntervalMs = 1000;
+    // 每秒最多回收的文件数，为0表示不限制
+    uint32_t recycleIops = 0;
 
     std::shared_ptr<LocalFileSystem> localFileSystem;
     std::shared_ptr<FilePool> chunkFilePool;
@@ -60,7 +71,8 @@ class Trash {
     int Fini();
 
     /*
-    * @brief DeleteEligibleFileInTrash 回收trash目录下的物理空间
+    * @brief DeleteEligibleFileInTrash 回收trash目录下的物理空间，
+    *        分批回收时只回收一批文件
     */
     void DeleteEligibleFileInTrash();
 
@@ -154,13 +166,82 @@ class Trash {
     */
     uint32_t CountChunkNumInCopyset(const std::string &copysetPath);
 
+    /*
+    * @brief 扫描trash目录，把新过期的copyset加入待回收列表
+    */
+    void ScanExpiredCopysets();
+
+    /*
+    * @brief 从待回收列表中回收一批文件，copyset的文件都回收后删除copyset目录
+    *
+    * @param[in] interruptible 后台线程停止时是否中断本批回收
+    */
+    void RecycleBatch(bool interruptible);
+
+    /*
+    * @brief 获取copyset中待回收的文件，优先读取上次生成的索引，
+    *        没有索引时遍历copyset目录并持久化索引，避免重启后重复遍历
+    *
+    * @param[in] copysetDir copyset目录
+    * @param[out] files 相对copyset目录的文件路径
+    * @param[out] fromIndex 是否读取的已有索引，索引中的文件可能已经被回收
+    *
+    * @return 成功返回0
+    */
+    int LoadPendingFiles(const std::string &copysetDir,
+                         std::vector<std::string> *files, bool *fromIndex);
+
+    /*
+    * @brief 遍历目录下的chunk、snapshot和wal文件
+    *
+    * @param[in] dir 遍历的目录
+    * @param[in] prefix 目录相对copyset目录的路径
+    * @param[out] files 相对copyset目录的文件路径
+    */
+    bool ListRecyclableFiles(const std::string &dir, const std::string &prefix,
+                             std::vector<std::string> *files);
+
+    int ReadPendingIndex(const std::string &path,
+                         std::vector<std::string> *files);
+
+    int WritePendingIndex(const std::string &path,
+                          const std::vector<std::string> &files);
+
+    // 回收一个chunk、snapshot或wal文件
+    bool RecycleOneFile(const std::string &filepath, bool checkExist);
+
  private:
+    // copyset中待回收文件的索引文件名
+    static const char kPendingIndexName[];
+
+    // 分批回收中的copyset
+    struct PendingCopyset {
+        std::string dir;
+        // 待回收的文件，相对copyset目录的路径
+        std::deque<std::string> files;
+        // 文件来自上次生成的索引，回收前需要检查文件是否还存在
+        bool fromIndex = false;
+        // 有文件回收失败，本轮不删除copyset目录，下次扫描时重试
+        bool failed = false;
+    };
+
     // 文件在放入trash中expiredAfteSec秒后，可以被物理回收
     int expiredAfterSec_;
 
     // 扫描trash目录的时间间隔
     int scanPeriodSec_;
 
+    // 每批回收的文件数，为0表示不分批
+    uint32_t recycleBatchSize_;
+    uint32_t recycleBatchIntervalMs_;
+    // 限制回收文件的速度，避免大量rename和unlink影响前台io
+    Throttle recycleThrottle_;
+
+    // 分批回收中的copyset，只由回收线程访问
+    std::deque<PendingCopyset> pending_;
+    // pending_中copyset的目录
+    std::set<std::string> pendingDirs_;
+
     // 回收站中chunk的个数
     Atomic<uint32_t> chunkNum_;
 
@@ -170,6 +170,10 @@ void ClientClosure::Run() {
     status_ = -1;
     cntlstatus_ = cntl_->ErrorCode();
 
+    metaCache_->GetUnstableHelper().RecordResult(
+        chunkserverID_, RpcLatencyUs(), cntl_->Failed());
+    reqDone_->SetRpcLatencyUs(RpcLatencyUs());
+
     bool needRetry = false;
 
     if (cntl_->Failed()) {
@@ -317,7 +321,7 @@ void ClientClosure::ProcessUnstableState() {
 void ClientClosure::OnSuccess() {
     reqDone_->SetFailed(0);
 
-    auto duration = cntl_->latency_us();
+    auto duration = RpcLatencyUs();
     MetricHelper::LatencyRecord(fileMetric_, duration, reqCtx_->optype_);
     MetricHelper::IncremRPCQPSCount(
         fileMetric_, reqCtx_->rawlength_, reqCtx_->optype_);
@@ -335,7 +339,7 @@ void ClientClosure::OnChunkNotExist() {
         << ", remote side = "
         << butil::endpoint2str(cntl_->remote_side()).c_str();
 
-    auto duration = cntl_->latency_us();
+    auto duration = RpcLatencyUs();
     MetricHelper::LatencyRecord(fileMetric_, duration, reqCtx_->optype_);
     MetricHelper::IncremRPCQPSCount(
         fileMetric_, reqCtx_->rawlength_, reqCtx_->optype_);
@@ -507,6 +511,22 @@ void ReadChunkClosure::OnSuccess() {
     reqCtx_->readData_ = cntl_->response_attachment();
 }
 
+void ReadChunkClosure::OnRedirected() {
+    // 从follower读被拒绝，直接重试，重试时发给缓存的leader，不需要刷新leader
+    ChunkServerID leaderId;
+    butil::EndPoint leaderAddr;
+    if (client_->ReadFromFollower() &&
+        0 == metaCache_->GetLeader(chunkIdInfo_.lpid_, chunkIdInfo_.cpid_,
+                                   &leaderId, &leaderAddr, false,
+                                   fileMetric_) &&
+        leaderId != chunkserverID_) {
+        retryDirectly_ = true;
+        return;
+    }
+
+    ClientClosure::OnRedirected();
+}
+
 void ReadChunkClosure::OnChunkNotExist() {
     ClientClosure::OnChunkNotExist();
 
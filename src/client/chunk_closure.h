@@ -35,6 +35,7 @@
 #include "src/client/client_metric.h"
 #include "src/client/request_closure.h"
 #include "src/common/math_util.h"
+#include "src/common/object_pool.h"
 
 namespace curve {
 namespace client {
@@ -83,6 +84,11 @@ class ClientClosure : public Closure {
         return chunkserverEndPoint_;
     }
 
+    // 合并发送的读请求没有自己的rpc，使用合并后的rpc的延时
+    void SetBatchLatencyUs(int64_t latencyUs) {
+        batchLatencyUs_ = latencyUs;
+    }
+
     // 统一Run函数入口
     void Run() override;
 
@@ -207,6 +213,10 @@ class ClientClosure : public Closure {
 
     void RefreshLeader();
 
+    int64_t RpcLatencyUs() const {
+        return batchLatencyUs_ >= 0 ? batchLatencyUs_ : cntl_->latency_us();
+    }
+
     static FailureRequestOption         failReqOpt_;
 
     brpc::Controller*                   cntl_;
@@ -233,9 +243,14 @@ class ClientClosure : public Closure {
 
     // rpc 状态码
     int                                 cntlstatus_;
+
+    // 合并发送时rpc的延时，-1表示没有合并发送
+    int64_t                             batchLatencyUs_ = -1;
 };
 
-class WriteChunkClosure : public ClientClosure {
+// 读写chunk的closure每次rpc都会分配和释放，内存从ObjectPool中复用
+class WriteChunkClosure : public ClientClosure,
+                          public common::PoolAllocated<WriteChunkClosure> {
  public:
     WriteChunkClosure(CopysetClient* client, Closure* done)
         : ClientClosure(client, done) {}
@@ -244,13 +259,15 @@ class WriteChunkClosure : public ClientClosure {
     void SendRetryRequest() override;
 };
 
-class ReadChunkClosure : public ClientClosure {
+class ReadChunkClosure : public ClientClosure,
+                         public common::PoolAllocated<ReadChunkClosure> {
  public:
     ReadChunkClosure(CopysetClient* client, Closure* done)
         : ClientClosure(client, done) {}
 
     void OnSuccess() override;
     void OnChunkNotExist() override;
+    void OnRedirected() override;
     void SendRetryRequest() override;
 };
 
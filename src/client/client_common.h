@@ -338,7 +338,8 @@ inline bool CloneSourceInfo::IsSegmentAllocated(uint64_t offset) const {
 }
 
 inline std::ostream& operator<<(std::ostream& os, const OpenFlags& flags) {
-    os << "[exclusive: " << std::boolalpha << flags.exclusive << "]";
+    os << "[exclusive: " << std::boolalpha << flags.exclusive
+       << ", priority: " << flags.priority << "]";
 
     return os;
 }
@@ -67,6 +67,18 @@ int ClientConfig::Init(const std::string& configpath) {
     LOG_IF(ERROR, ret == false) << "config no global.fileIOSplitMaxSizeKB info";           // NOLINT
     RETURN_IF_FALSE(ret);
 
+    ret = conf_.GetUInt32Value("global.fileSegmentBatchNum",
+          &fileServiceOption_.ioOpt.ioSplitOpt.fileSegmentBatchNum);
+    LOG_IF(WARNING, ret == false)
+        << "config no global.fileSegmentBatchNum info, using default value "
+        << fileServiceOption_.ioOpt.ioSplitOpt.fileSegmentBatchNum;
+
+    ret = conf_.GetBoolValue("global.fileSegmentWarmupOnOpen",
+          &fileServiceOption_.ioOpt.ioSplitOpt.fileSegmentWarmupOnOpen);
+    LOG_IF(WARNING, ret == false)
+        << "config no global.fileSegmentWarmupOnOpen info, using default value "
+        << fileServiceOption_.ioOpt.ioSplitOpt.fileSegmentWarmupOnOpen;
+
     ret = conf_.GetUInt32Value("chunkserver.opMaxRetry",
           &fileServiceOption_.ioOpt.ioSenderOpt.failRequestOpt.chunkserverOPMaxRetry);    // NOLINT
     LOG_IF(ERROR, ret == false) << "config no chunkserver.opMaxRetry info";
@@ -111,6 +123,27 @@ int ClientConfig::Init(const std::string& configpath) {
         << "config no chunkserver.serverStableThreshold info";  // NOLINT
     RETURN_IF_FALSE(ret);
 
+    ret = conf_.GetDoubleValue(
+        "chunkserver.slowLatencyRatio",
+        &fileServiceOption_.ioOpt.metaCacheOpt.chunkserverUnstableOption.slowLatencyRatio);  // NOLINT
+    LOG_IF(WARNING, ret == false)
+        << "config no chunkserver.slowLatencyRatio info, using default value "
+        << fileServiceOption_.ioOpt.metaCacheOpt.chunkserverUnstableOption.slowLatencyRatio;  // NOLINT
+
+    ret = conf_.GetUInt64Value(
+        "chunkserver.slowMinLatencyUs",
+        &fileServiceOption_.ioOpt.metaCacheOpt.chunkserverUnstableOption.slowMinLatencyUs);  // NOLINT
+    LOG_IF(WARNING, ret == false)
+        << "config no chunkserver.slowMinLatencyUs info, using default value "
+        << fileServiceOption_.ioOpt.metaCacheOpt.chunkserverUnstableOption.slowMinLatencyUs;  // NOLINT
+
+    ret = conf_.GetDoubleValue(
+        "chunkserver.slowErrorRatio",
+        &fileServiceOption_.ioOpt.metaCacheOpt.chunkserverUnstableOption.slowErrorRatio);  // NOLINT
+    LOG_IF(WARNING, ret == false)
+        << "config no chunkserver.slowErrorRatio info, using default value "
+        << fileServiceOption_.ioOpt.metaCacheOpt.chunkserverUnstableOption.slowErrorRatio;  // NOLINT
+
     ret = conf_.GetUInt64Value("chunkserver.minRetryTimesForceTimeoutBackoff",
         &fileServiceOption_.ioOpt.ioSenderOpt.failRequestOpt.chunkserverMinRetryTimesForceTimeoutBackoff);  // NOLINT
     LOG_IF(ERROR, ret == false)
@@ -128,11 +161,63 @@ int ClientConfig::Init(const std::string& configpath) {
                           << fileServiceOption_.ioOpt.ioSenderOpt.failRequestOpt
                                  .chunkserverSlowRequestThresholdMS;
 
+    ret = conf_.GetBoolValue("chunkserver.readFromFollower",
+        &fileServiceOption_.ioOpt.ioSenderOpt.readFromFollower);
+    LOG_IF(WARNING, ret == false)
+        << "config no chunkserver.readFromFollower info, using default value "
+        << fileServiceOption_.ioOpt.ioSenderOpt.readFromFollower;
+
+    ret = conf_.GetUInt32Value("chunkserver.readBatchMaxNum",
+        &fileServiceOption_.ioOpt.ioSenderOpt.readBatchMaxNum);
+    LOG_IF(WARNING, ret == false)
+        << "config no chunkserver.readBatchMaxNum info, using default value "
+        << fileServiceOption_.ioOpt.ioSenderOpt.readBatchMaxNum;
+
+    ret = conf_.GetUInt32Value("chunkserver.createCloneBatchMaxNum",
+        &fileServiceOption_.ioOpt.ioSenderOpt.createCloneBatchMaxNum);
+    LOG_IF(WARNING, ret == false)
+        << "config no chunkserver.createCloneBatchMaxNum info, "
+        << "using default value "
+        << fileServiceOption_.ioOpt.ioSenderOpt.createCloneBatchMaxNum;
+
+    ret = conf_.GetUInt32Value("chunkserver.recoverBatchMaxNum",
+        &fileServiceOption_.ioOpt.ioSenderOpt.recoverBatchMaxNum);
+    LOG_IF(WARNING, ret == false)
+        << "config no chunkserver.recoverBatchMaxNum info, "
+        << "using default value "
+        << fileServiceOption_.ioOpt.ioSenderOpt.recoverBatchMaxNum;
+
+    ret = conf_.GetBoolValue("chunkserver.hedgedRead.enable",
+        &fileServiceOption_.ioOpt.ioSenderOpt.hedgedReadOpt.enable);
+    LOG_IF(WARNING, ret == false)
+        << "config no chunkserver.hedgedRead.enable info, using default value "
+        << fileServiceOption_.ioOpt.ioSenderOpt.hedgedReadOpt.enable;
+
+    ret = conf_.GetDoubleValue("chunkserver.hedgedRead.latencyPercentile",
+        &fileServiceOption_.ioOpt.ioSenderOpt.hedgedReadOpt.latencyPercentile);
+    LOG_IF(WARNING, ret == false)
+        << "config no chunkserver.hedgedRead.latencyPercentile info, "
+        << "using default value "
+        << fileServiceOption_.ioOpt.ioSenderOpt.hedgedReadOpt.latencyPercentile;
+
+    ret = conf_.GetUInt64Value("chunkserver.hedgedRead.minDelayUs",
+        &fileServiceOption_.ioOpt.ioSenderOpt.hedgedReadOpt.minDelayUs);
+    LOG_IF(WARNING, ret == false)
+        << "config no chunkserver.hedgedRead.minDelayUs info, "
+        << "using default value "
+        << fileServiceOption_.ioOpt.ioSenderOpt.hedgedReadOpt.minDelayUs;
+
     ret = conf_.GetUInt64Value("global.fileMaxInFlightRPCNum",
         &fileServiceOption_.ioOpt.ioSenderOpt.inflightOpt.fileMaxInFlightRPCNum);   // NOLINT
     LOG_IF(ERROR, ret == false) << "config no global.fileMaxInFlightRPCNum info";   // NOLINT
     RETURN_IF_FALSE(ret);
 
+    ret = conf_.GetUInt64Value("global.lowPriorityMaxInFlightRPCNum",
+        &fileServiceOption_.ioOpt.ioSenderOpt.inflightOpt.lowPriorityMaxInFlightRPCNum);   // NOLINT
+    LOG_IF(WARNING, ret == false)
+        << "config no global.lowPriorityMaxInFlightRPCNum info, using default value "   // NOLINT
+        << fileServiceOption_.ioOpt.ioSenderOpt.inflightOpt.lowPriorityMaxInFlightRPCNum;   // NOLINT
+
     ret = conf_.GetUInt32Value("metacache.getLeaderRetry",
         &fileServiceOption_.ioOpt.metaCacheOpt.metacacheGetLeaderRetry);
     LOG_IF(ERROR, ret == false) << "config no metacache.getLeaderRetry info";
@@ -158,11 +243,47 @@ int ClientConfig::Init(const std::string& configpath) {
     LOG_IF(ERROR, ret == false) << "config no schedule.threadpoolSize info";
     RETURN_IF_FALSE(ret);
 
+    ret = conf_.GetUInt32Value("schedule.busyPollUs",
+        &fileServiceOption_.ioOpt.reqSchdulerOpt.scheduleBusyPollUs);
+    LOG_IF(WARNING, ret == false)
+        << "config no schedule.busyPollUs info, using default value "
+        << fileServiceOption_.ioOpt.reqSchdulerOpt.scheduleBusyPollUs;
+
+    ret = conf_.GetBoolValue("schedule.runToCompletion",
+        &fileServiceOption_.ioOpt.reqSchdulerOpt.scheduleRunToCompletion);
+    LOG_IF(WARNING, ret == false)
+        << "config no schedule.runToCompletion info, using default value "
+        << fileServiceOption_.ioOpt.reqSchdulerOpt.scheduleRunToCompletion;
+
+    ret = conf_.GetUInt32Value("schedule.writeMergeWindowUs",
+        &fileServiceOption_.ioOpt.reqSchdulerOpt.writeMergeWindowUs);
+    LOG_IF(WARNING, ret == false)
+        << "config no schedule.writeMergeWindowUs info, using default value "
+        << fileServiceOption_.ioOpt.reqSchdulerOpt.writeMergeWindowUs;
+
+    ret = conf_.GetUInt32Value("schedule.writeMergeMaxSize",
+        &fileServiceOption_.ioOpt.reqSchdulerOpt.writeMergeMaxSize);
+    LOG_IF(WARNING, ret == false)
+        << "config no schedule.writeMergeMaxSize info, using default value "
+        << fileServiceOption_.ioOpt.reqSchdulerOpt.writeMergeMaxSize;
+
     ret = conf_.GetUInt32Value("mds.refreshTimesPerLease",
         &fileServiceOption_.leaseOpt.mdsRefreshTimesPerLease);
     LOG_IF(ERROR, ret == false) << "config no mds.refreshTimesPerLease info";
     RETURN_IF_FALSE(ret);
 
+    ret = conf_.GetBoolValue("mds.enableBatchRefreshSession",
+        &fileServiceOption_.leaseOpt.enableBatchRefresh);
+    LOG_IF(WARNING, ret == false)
+        << "config no mds.enableBatchRefreshSession info, using default value "
+        << fileServiceOption_.leaseOpt.enableBatchRefresh;
+
+    ret = conf_.GetUInt32Value("mds.maxBatchRefreshSessionSize",
+        &fileServiceOption_.leaseOpt.maxBatchRefreshSize);
+    LOG_IF(WARNING, ret == false)
+        << "config no mds.maxBatchRefreshSessionSize info, using default value "
+        << fileServiceOption_.leaseOpt.maxBatchRefreshSize;
+
     fileServiceOption_.ioOpt.reqSchdulerOpt.ioSenderOpt =
         fileServiceOption_.ioOpt.ioSenderOpt;
 
@@ -217,6 +338,10 @@ int ClientConfig::Init(const std::string& configpath) {
         &fileServiceOption_.metaServerOpt.mdsMaxRetryMS);
     LOG_IF(WARNING, ret == false) << "config no mds.maxRetryMS info";
 
+    ret = conf_.GetUInt32Value("mds.listDirPageSize",
+        &fileServiceOption_.metaServerOpt.listDirPageSize);
+    LOG_IF(WARNING, ret == false) << "config no mds.listDirPageSize info";
+
     ret = conf_.GetUInt32Value("mds.maxFailedTimesBeforeChangeMDS",
         &fileServiceOption_.metaServerOpt.rpcRetryOpt.maxFailedTimesBeforeChangeAddr);  // NOLINT
     LOG_IF(ERROR, ret == false) << "config no mds.maxFailedTimesBeforeChangeMDS info";  // NOLINT
@@ -261,6 +386,21 @@ int ClientConfig::Init(const std::string& configpath) {
         << "config no closefd.timeInterval info, using default value "
         << fileServiceOption_.ioOpt.closeFdThreadOption.fdCloseTimeInterval;
 
+    ret = conf_.GetBoolValue(
+        "sourceReader.mergeInflightReads",
+        &fileServiceOption_.ioOpt.sourceReaderOpt.mergeInflightReads);
+    LOG_IF(WARNING, ret == false)
+        << "config no sourceReader.mergeInflightReads info, "
+        << "using default value "
+        << fileServiceOption_.ioOpt.sourceReaderOpt.mergeInflightReads;
+
+    ret = conf_.GetBoolValue(
+        "sourceReader.readAhead",
+        &fileServiceOption_.ioOpt.sourceReaderOpt.readAhead);
+    LOG_IF(WARNING, ret == false)
+        << "config no sourceReader.readAhead info, using default value "
+        << fileServiceOption_.ioOpt.sourceReaderOpt.readAhead;
+
     ret = conf_.GetBoolValue(
         "throttle.enable",
         &fileServiceOption_.ioOpt.throttleOption.enable);
@@ -268,6 +408,31 @@ int ClientConfig::Init(const std::string& configpath) {
         << "config no throttle.enable info, using default value "
         << fileServiceOption_.ioOpt.throttleOption.enable;
 
+    ThrottleOption* throttleOpt = &fileServiceOption_.ioOpt.throttleOption;
+    LOG_IF(WARNING, !conf_.GetUInt64Value("throttle.host.iopsTotalLimit",
+                                          &throttleOpt->hostIopsTotalLimit))
+        << "config no throttle.host.iopsTotalLimit info, using default value "
+        << throttleOpt->hostIopsTotalLimit;
+    LOG_IF(WARNING, !conf_.GetUInt64Value("throttle.host.bpsTotalLimitMB",
+                                          &throttleOpt->hostBpsTotalLimitMB))
+        << "config no throttle.host.bpsTotalLimitMB info, using default value "
+        << throttleOpt->hostBpsTotalLimitMB;
+    LOG_IF(WARNING,
+           !conf_.GetUInt64Value("throttle.tenant.iopsTotalLimit",
+                                 &throttleOpt->tenantIopsTotalLimit))
+        << "config no throttle.tenant.iopsTotalLimit info, using default value "
+        << throttleOpt->tenantIopsTotalLimit;
+    LOG_IF(WARNING,
+           !conf_.GetUInt64Value("throttle.tenant.bpsTotalLimitMB",
+                                 &throttleOpt->tenantBpsTotalLimitMB))
+        << "config no throttle.tenant.bpsTotalLimitMB info, "
+           "using default value "
+        << throttleOpt->tenantBpsTotalLimitMB;
+    LOG_IF(WARNING, !conf_.GetUInt64Value("throttle.sharedBurstSeconds",
+                                          &throttleOpt->sharedBurstSeconds))
+        << "config no throttle.sharedBurstSeconds info, using default value "
+        << throttleOpt->sharedBurstSeconds;
+
     ret = conf_.GetBoolValue("discard.enable",
                              &fileServiceOption_.ioOpt.discardOption.enable);
     LOG_IF(ERROR, ret == false) << "config no discard.enable info";
@@ -285,6 +450,152 @@ int ClientConfig::Init(const std::string& configpath) {
     LOG_IF(ERROR, ret == false) << "config no discard.taskDelayMs info";
     RETURN_IF_FALSE(ret);
 
+    ret = conf_.GetUInt32Value(
+        "discard.maxBatchSegments",
+        &fileServiceOption_.ioOpt.discardOption.maxBatchSegments);
+    LOG_IF(WARNING, ret == false)
+        << "config no discard.maxBatchSegments info, using default value "
+        << fileServiceOption_.ioOpt.discardOption.maxBatchSegments;
+
+    ret = conf_.GetUInt32Value(
+        "discard.batchWindowMs",
+        &fileServiceOption_.ioOpt.discardOption.batchWindowMs);
+    LOG_IF(WARNING, ret == false)
+        << "config no discard.batchWindowMs info, using default value "
+        << fileServiceOption_.ioOpt.discardOption.batchWindowMs;
+
+    ret = conf_.GetUInt32Value(
+        "discard.targetLatencyMs",
+        &fileServiceOption_.ioOpt.discardOption.targetLatencyMs);
+    LOG_IF(WARNING, ret == false)
+        << "config no discard.targetLatencyMs info, using default value "
+        << fileServiceOption_.ioOpt.discardOption.targetLatencyMs;
+
+    ret = conf_.GetUInt32Value(
+        "discard.maxIntervalMs",
+        &fileServiceOption_.ioOpt.discardOption.maxIntervalMs);
+    LOG_IF(WARNING, ret == false)
+        << "config no discard.maxIntervalMs info, using default value "
+        << fileServiceOption_.ioOpt.discardOption.maxIntervalMs;
+
+    ret = conf_.GetBoolValue("readAhead.enable",
+                             &fileServiceOption_.ioOpt.readAheadOpt.enable);
+    LOG_IF(WARNING, ret == false)
+        << "config no readAhead.enable info, using default value "
+        << fileServiceOption_.ioOpt.readAheadOpt.enable;
+
+    ret = conf_.GetUInt32Value(
+        "readAhead.sequentialThreshold",
+        &fileServiceOption_.ioOpt.readAheadOpt.sequentialThreshold);
+    LOG_IF(WARNING, ret == false)
+        << "config no readAhead.sequentialThreshold info, using default value "
+        << fileServiceOption_.ioOpt.readAheadOpt.sequentialThreshold;
+
+    ret = conf_.GetUInt64Value(
+        "readAhead.minWindowBytes",
+        &fileServiceOption_.ioOpt.readAheadOpt.minWindowBytes);
+    LOG_IF(WARNING, ret == false)
+        << "config no readAhead.minWindowBytes info, using default value "
+        << fileServiceOption_.ioOpt.readAheadOpt.minWindowBytes;
+
+    ret = conf_.GetUInt64Value(
+        "readAhead.maxWindowBytes",
+        &fileServiceOption_.ioOpt.readAheadOpt.maxWindowBytes);
+    LOG_IF(WARNING, ret == false)
+        << "config no readAhead.maxWindowBytes info, using default value "
+        << fileServiceOption_.ioOpt.readAheadOpt.maxWindowBytes;
+
+    ret = conf_.GetUInt64Value(
+        "readAhead.maxCacheBytes",
+        &fileServiceOption_.ioOpt.readAheadOpt.maxCacheBytes);
+    LOG_IF(WARNING, ret == false)
+        << "config no readAhead.maxCacheBytes info, using default value "
+        << fileServiceOption_.ioOpt.readAheadOpt.maxCacheBytes;
+
+    ret = conf_.GetBoolValue("readCache.enable",
+                             &fileServiceOption_.ioOpt.readCacheOpt.enable);
+    LOG_IF(WARNING, ret == false)
+        << "config no readCache.enable info, using default value "
+        << fileServiceOption_.ioOpt.readCacheOpt.enable;
+
+    ret = conf_.GetUInt32Value(
+        "readCache.blockSize",
+        &fileServiceOption_.ioOpt.readCacheOpt.blockSize);
+    LOG_IF(WARNING, ret == false)
+        << "config no readCache.blockSize info, using default value "
+        << fileServiceOption_.ioOpt.readCacheOpt.blockSize;
+
+    ret = conf_.GetUInt64Value(
+        "readCache.memoryBytes",
+        &fileServiceOption_.ioOpt.readCacheOpt.memoryBytes);
+    LOG_IF(WARNING, ret == false)
+        << "config no readCache.memoryBytes info, using default value "
+        << fileServiceOption_.ioOpt.readCacheOpt.memoryBytes;
+
+    ret = conf_.GetStringValue(
+        "readCache.diskPath",
+        &fileServiceOption_.ioOpt.readCacheOpt.diskPath);
+    LOG_IF(WARNING, ret == false)
+        << "config no readCache.diskPath info, using default value "
+        << fileServiceOption_.ioOpt.readCacheOpt.diskPath;
+
+    ret = conf_.GetUInt64Value(
+        "readCache.diskBytes",
+        &fileServiceOption_.ioOpt.readCacheOpt.diskBytes);
+    LOG_IF(WARNING, ret == false)
+        << "config no readCache.diskBytes info, using default value "
+        << fileServiceOption_.ioOpt.readCacheOpt.diskBytes;
+
+    ret = conf_.GetBoolValue(
+        "writeBackLog.enable",
+        &fileServiceOption_.ioOpt.writeBackLogOpt.enable);
+    LOG_IF(WARNING, ret == false)
+        << "config no writeBackLog.enable info, using default value "
+        << fileServiceOption_.ioOpt.writeBackLogOpt.enable;
+
+    ret = conf_.GetStringValue(
+        "writeBackLog.dir",
+        &fileServiceOption_.ioOpt.writeBackLogOpt.dir);
+    LOG_IF(WARNING, ret == false)
+        << "config no writeBackLog.dir info, using default value "
+        << fileServiceOption_.ioOpt.writeBackLogOpt.dir;
+
+    ret = conf_.GetUInt64Value(
+        "writeBackLog.capacityBytes",
+        &fileServiceOption_.ioOpt.writeBackLogOpt.capacityBytes);
+    LOG_IF(WARNING, ret == false)
+        << "config no writeBackLog.capacityBytes info, using default value "
+        << fileServiceOption_.ioOpt.writeBackLogOpt.capacityBytes;
+
+    ret = conf_.GetUInt32Value(
+        "writeBackLog.flushConcurrency",
+        &fileServiceOption_.ioOpt.writeBackLogOpt.flushConcurrency);
+    LOG_IF(WARNING, ret == false)
+        << "config no writeBackLog.flushConcurrency info, using default value "
+        << fileServiceOption_.ioOpt.writeBackLogOpt.flushConcurrency;
+
+    ret = conf_.GetBoolValue(
+        "fileMetric.exposePerFileBvar",
+        &fileServiceOption_.ioOpt.fileMetricOpt.exposePerFileBvar);
+    LOG_IF(WARNING, ret == false)
+        << "config no fileMetric.exposePerFileBvar info, using default value "
+        << fileServiceOption_.ioOpt.fileMetricOpt.exposePerFileBvar;
+
+    ret = conf_.GetUInt32Value(
+        "fileMetric.latencyStatsIntervalS",
+        &fileServiceOption_.ioOpt.fileMetricOpt.latencyStatsIntervalS);
+    LOG_IF(WARNING, ret == false)
+        << "config no fileMetric.latencyStatsIntervalS info, "
+        << "using default value "
+        << fileServiceOption_.ioOpt.fileMetricOpt.latencyStatsIntervalS;
+
+    ret = conf_.GetUInt32Value(
+        "fileMetric.spanSampleRate",
+        &fileServiceOption_.ioOpt.fileMetricOpt.spanSampleRate);
+    LOG_IF(WARNING, ret == false)
+        << "config no fileMetric.spanSampleRate info, using default value "
+        << fileServiceOption_.ioOpt.fileMetricOpt.spanSampleRate;
+
     // only client side need these follow 5 options
     ret = conf_.GetUInt32Value("csClientOpt.rpcTimeoutMs",
                                &fileServiceOption_.csClientOpt.rpcTimeoutMs);
@@ -102,6 +102,28 @@ struct DiscardMetric {
     bvar::Adder<int64_t> pending;
 };
 
+struct ReadAheadMetric {
+    explicit ReadAheadMetric(const std::string& prefix)
+        : hitBytes(prefix, "read_ahead_hit_bytes"),
+          prefetchBytes(prefix, "read_ahead_prefetch_bytes") {}
+
+    // bytes of the user reads served by the prefetched data
+    bvar::Adder<int64_t> hitBytes;
+    // bytes prefetched
+    bvar::Adder<int64_t> prefetchBytes;
+};
+
+struct HedgedReadMetric {
+    explicit HedgedReadMetric(const std::string& prefix)
+        : sent(prefix, "hedged_read_sent"),
+          won(prefix, "hedged_read_won") {}
+
+    // 发出的对冲请求数
+    bvar::Adder<int64_t> sent;
+    // 对冲请求先于原请求成功返回的次数
+    bvar::Adder<int64_t> won;
+};
+
 // 文件级别metric信息统计
 struct FileMetric {
     const std::string prefix = "curve_client";
@@ -136,6 +158,10 @@ struct FileMetric {
 
     DiscardMetric discardMetric;
 
+    ReadAheadMetric readAheadMetric;
+
+    HedgedReadMetric hedgedReadMetric;
+
     explicit FileMetric(const std::string& name)
         : filename(name),
           inflightRPCNum(prefix, filename + "_inflight_rpc_num"),
@@ -150,7 +176,9 @@ struct FileMetric {
           userDiscard(prefix, filename + "_discard"),
           getLeaderRetryQPS(prefix, filename + "_get_leader_retry_rpc"),
           slowRequestMetric(prefix, filename + "_slow_request"),
-          discardMetric(prefix + filename) {}
+          discardMetric(prefix + filename),
+          readAheadMetric(prefix + filename),
+          hedgedReadMetric(prefix + filename) {}
 };
 
 // 用于全局mds接口统计信息调用信息统计
@@ -171,12 +199,16 @@ struct MDSClientMetric {
     InterfaceMetric getFile;
     // RefreshSession接口统计信息
     InterfaceMetric refreshSession;
+    // BatchRefreshSession接口统计信息
+    InterfaceMetric batchRefreshSession;
     // GetServerList接口统计信息
     InterfaceMetric getServerList;
     // GetOrAllocateSegment接口统计信息
     InterfaceMetric getOrAllocateSegment;
     // DeAllocateSegment接口统计信息
     InterfaceMetric deAllocateSegment;
+    // ListSegment接口统计信息
+    InterfaceMetric listSegment;
     // RenameFile接口统计信息
     InterfaceMetric renameFile;
     // Extend接口统计信息
@@ -212,9 +244,11 @@ struct MDSClientMetric {
           closeFile(prefix, "closeFile"),
           getFile(prefix, "getFileInfo"),
           refreshSession(prefix, "refreshSession"),
+          batchRefreshSession(prefix, "batchRefreshSession"),
           getServerList(prefix, "getServerList"),
           getOrAllocateSegment(prefix, "getOrAllocateSegment"),
           deAllocateSegment(prefix, "deAllocateSegment"),
+          listSegment(prefix, "listSegment"),
           renameFile(prefix, "renameFile"),
           extendFile(prefix, "extendFile"),
           deleteFile(prefix, "deleteFile"),
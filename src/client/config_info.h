@@ -43,13 +43,18 @@ struct LogInfo {
 /**
  * in flight IO控制信息
  * @fileMaxInFlightRPCNum: 为一个文件中最大允许的inflight IO数量
+ * @lowPriorityMaxInFlightRPCNum: 进程内所有低优先级文件共享的最大
+ *                                inflight IO数量
  */
 struct InFlightIOCntlInfo {
     uint64_t fileMaxInFlightRPCNum = 2048;
+    uint64_t lowPriorityMaxInFlightRPCNum = 64;
 };
 
 struct MetaServerOption {
     uint64_t mdsMaxRetryMS = 8000;
+    // max number of files listed by one rpc, 0 means all files at once
+    uint32_t listDirPageSize = 0;
     struct RpcRetryOption {
         // rpc max timeout
         uint64_t maxRPCTimeoutMS = 2000;
@@ -87,6 +92,10 @@ struct MetaServerOption {
  */
 struct LeaseOption {
     uint32_t mdsRefreshTimesPerLease = 5;
+    // 打开的所有文件是否通过一个rpc批量续约，需要mds支持BatchRefreshSession
+    bool enableBatchRefresh = false;
+    // 一个批量续约rpc最多包含的文件数
+    uint32_t maxBatchRefreshSize = 1000;
 };
 
 /**
@@ -99,11 +108,21 @@ struct LeaseOption {
  * @serverUnstableThreashold:
  *     一个server上超过serverUnstableThreashold个chunkserver都标记为unstable，
  *     整个server上的所有chunkserver都标记为unstable
+ * @slowLatencyRatio:
+ *     chunkserver rpc延时的滑动平均超过所有chunkserver的该倍数时认为变慢，
+ *     0表示不按延时判断
+ * @slowMinLatencyUs: 延时的滑动平均低于该值时不认为变慢
+ * @slowErrorRatio: rpc失败比例的滑动平均超过该值时认为变慢
+ * @slowMinSamples: 统计到的rpc数量少于该值时不判断是否变慢
  */
 struct ChunkServerUnstableOption {
     uint32_t maxStableChunkServerTimeoutTimes = 64;
     uint32_t checkHealthTimeoutMS = 100;
     uint32_t serverUnstableThreshold = 3;
+    double slowLatencyRatio = 3.0;
+    uint64_t slowMinLatencyUs = 10 * 1000;
+    double slowErrorRatio = 0.3;
+    uint32_t slowMinSamples = 32;
 };
 
 /**
@@ -153,14 +172,44 @@ struct FailureRequestOption {
     uint32_t chunkserverSlowRequestThresholdMS = 45 * 1000;
 };
 
+/**
+ * 对冲读配置，只对从follower读的只读文件生效
+ * @enable: 是否开启对冲读
+ * @latencyPercentile: 读请求超过chunkserver读延时的该分位值还没有返回时，
+ *                     把同样的请求发给copyset的另一个副本，先返回的结果生效
+ * @minDelayUs: 发送对冲请求前最少等待的时间，还没有延时统计时也使用该值
+ */
+struct HedgedReadOption {
+    bool enable = false;
+    double latencyPercentile = 0.99;
+    uint64_t minDelayUs = 2000;
+};
+
 /**
  * 发送rpc给chunkserver的配置
  * @inflightOpt: 一个文件向chunkserver发送请求时的inflight 请求控制配置
  * @failRequestOpt: rpc发送失败之后，需要进行rpc重试的相关配置
+ * @readFromFollower: 只读文件是否从follower读取数据
+ * @readBatchMaxNum: 合并成一个rpc发给同一个chunkserver的读请求的最大数量
+ * @createCloneBatchMaxNum: 合并成一个rpc发给同一个chunkserver的创建clone
+ *                          chunk请求的最大数量
+ * @recoverBatchMaxNum: 合并成一个rpc发给同一个chunkserver的recover chunk
+ *                      请求的最大数量
+ * @hedgedReadOpt: 对冲读配置
  */
 struct IOSenderOption {
     InFlightIOCntlInfo inflightOpt;
     FailureRequestOption failRequestOpt;
+    // 只读打开的文件把读请求分散到copyset的各个副本，需要chunkserver开启follower读
+    bool readFromFollower = false;
+    // 小于等于1表示不合并，需要chunkserver支持ReadChunks
+    uint32_t readBatchMaxNum = 0;
+    // 小于等于1表示不合并，需要chunkserver支持CreateCloneChunks
+    uint32_t createCloneBatchMaxNum = 0;
+    // 小于等于1表示不合并，需要chunkserver支持RecoverChunks
+    uint32_t recoverBatchMaxNum = 0;
+    // 对冲读的请求不参与合并
+    HedgedReadOption hedgedReadOpt;
 };
 
 /**
@@ -168,10 +217,19 @@ struct IOSenderOption {
  * 线程池，线程池中的线程各自配置一个队列
  * @scheduleQueueCapacity: schedule模块配置的队列深度
  * @scheduleThreadpoolSize: schedule模块线程池大小
+ * @scheduleBusyPollUs: 队列为空时调度线程忙等新请求的时间，超过后才睡眠等待
+ * @scheduleRunToCompletion: 队列为空时由提交请求的线程直接下发请求
  */
 struct RequestScheduleOption {
     uint32_t scheduleQueueCapacity = 1024;
     uint32_t scheduleThreadpoolSize = 2;
+    // 0表示不忙等，忙等会让调度线程一直占用cpu
+    uint32_t scheduleBusyPollUs = 0;
+    bool scheduleRunToCompletion = false;
+    // 写请求的合并窗口，0表示不合并
+    uint32_t writeMergeWindowUs = 0;
+    // 合并后写请求的最大长度
+    uint32_t writeMergeMaxSize = 128 * 1024;
     IOSenderOption ioSenderOpt;
 };
 
@@ -212,9 +270,14 @@ struct MetaCacheOption {
  * @fileIOSplitMaxSizeKB:
  * 用户下发IO大小client没有限制，但是client会将用户的IO进行拆分，
  *                        发向同一个chunkserver的请求锁携带的数据大小不能超过该值。
+ * @fileSegmentBatchNum: 向mds获取或分配segment时，一次rpc连同后续的segment
+ *                       一起获取的segment数量
+ * @fileSegmentWarmupOnOpen: 打开文件时是否通过一次rpc获取文件所有已分配的segment
  */
 struct IOSplitOption {
     uint64_t fileIOSplitMaxSizeKB = 64;
+    uint32_t fileSegmentBatchNum = 1;
+    bool fileSegmentWarmupOnOpen = false;
 };
 
 /**
@@ -233,6 +296,84 @@ struct TaskThreadOption {
 struct DiscardOption {
     bool enable = false;
     uint32_t taskDelayMs = 1000 * 60;  // 1 min
+
+    // max consecutive segments deallocated by one DeAllocateSegment request
+    uint32_t maxBatchSegments = 1;
+    // tasks of the following segments due within this window are sent
+    // together with the task running
+    uint32_t batchWindowMs = 1000;
+
+    // interval between DeAllocateSegment requests, it's doubled when the
+    // rpc takes longer than targetLatencyMs or fails, and halved otherwise,
+    // up to maxIntervalMs, 0 means no rate limit
+    uint32_t targetLatencyMs = 100;
+    uint32_t maxIntervalMs = 0;
+};
+
+/**
+ * read ahead of sequential reads
+ * @enable: enable/disable read ahead
+ * @sequentialThreshold: reads in a row that start where the previous one
+ *                       ended before prefetching
+ * @minWindowBytes: initial window, also the size of a prefetch
+ * @maxWindowBytes: max window
+ * @maxCacheBytes: max bytes prefetched for one file
+ */
+struct ReadAheadOption {
+    bool enable = false;
+    uint32_t sequentialThreshold = 2;
+    uint64_t minWindowBytes = 256 * 1024;
+    uint64_t maxWindowBytes = 8 * 1024 * 1024;
+    uint64_t maxCacheBytes = 32 * 1024 * 1024;
+};
+
+/**
+ * read cache config, only used by the files opened read only
+ * @enable: enable/disable read cache
+ * @blockSize: size of the blocks cached, chunk size must be a multiple of it
+ * @memoryBytes: max bytes cached in memory
+ * @diskPath: local file keeping the blocks evicted from memory, empty to
+ *            disable
+ * @diskBytes: max bytes cached in the local file
+ */
+struct ReadCacheOption {
+    bool enable = false;
+    uint32_t blockSize = 64 * 1024;
+    uint64_t memoryBytes = 256 * 1024 * 1024;
+    std::string diskPath;
+    uint64_t diskBytes = 0;
+};
+
+/**
+ * write-back log of the files opened read write, writes are acknowledged
+ * once they are durable in a local log and flushed in the background
+ * @enable: enable/disable the write-back log
+ * @dir: directory of the logs, e.g. on a nvme disk, one log for a file
+ * @capacityBytes: max bytes of a log, the writes larger than a quarter of
+ *                 it are written through
+ * @flushConcurrency: max records of a log flushed at a time
+ */
+struct WriteBackLogOption {
+    bool enable = false;
+    std::string dir;
+    uint64_t capacityBytes = 1024ULL * 1024 * 1024;
+    uint32_t flushConcurrency = 32;
+};
+
+/**
+ * per file metric config
+ * @exposePerFileBvar: expose a set of bvars for every file, the files share
+ *                     one set if disabled, which saves the cost of the bvar
+ *                     registration when thousands of files are opened
+ * @latencyStatsIntervalS: interval the latency percentiles of every file are
+ *                         computed and exposed in one bvar, 0 to disable
+ * @spanSampleRate: log the time spent on split, schedule, rpc and retry of
+ *                  one in every spanSampleRate user ios, 0 to disable
+ */
+struct FileMetricOption {
+    bool exposePerFileBvar = true;
+    uint32_t latencyStatsIntervalS = 0;
+    uint32_t spanSampleRate = 0;
 };
 
 /**
@@ -245,8 +386,34 @@ struct CloseFdThreadOption {
     uint32_t fdCloseTimeInterval = 600;
 };
 
+/**
+ * SourceReader config
+ * @mergeInflightReads: reads of a source range already being read wait for
+ *                      the result instead of reading it again
+ * @readAhead: enable read ahead on the source files, the clone files are
+ *             usually recovered sequentially
+ */
+struct SourceReaderOption {
+    bool mergeInflightReads = true;
+    bool readAhead = false;
+};
+
+/**
+ * throttle配置
+ * @enable: 打开文件级别的限流, 限流参数来自mds
+ * @host*: 本机所有client共享的限流, 通过共享内存在多个进程间生效, 0表示不限
+ * @tenant*: 同一租户(文件owner)在本机所有client共享的限流
+ * @sharedBurstSeconds: 空闲时积累的突发额度, 为该时长内的limit
+ */
 struct ThrottleOption {
     bool enable = false;
+    uint64_t hostIopsTotalLimit = 0;
+    uint64_t hostBpsTotalLimitMB = 0;
+    uint64_t tenantIopsTotalLimit = 0;
+    uint64_t tenantBpsTotalLimitMB = 0;
+    uint64_t sharedBurstSeconds = 1;
+    // 文件所属租户, 打开文件时设置
+    std::string tenant;
 };
 
 /**
@@ -259,8 +426,13 @@ struct IOOption {
     TaskThreadOption taskThreadOpt;
     RequestScheduleOption reqSchdulerOpt;
     CloseFdThreadOption closeFdThreadOption;
+    SourceReaderOption sourceReaderOpt;
     ThrottleOption throttleOption;
     DiscardOption discardOption;
+    ReadAheadOption readAheadOpt;
+    ReadCacheOption readCacheOpt;
+    WriteBackLogOption writeBackLogOpt;
+    FileMetricOption fileMetricOpt;
 };
 
 /**
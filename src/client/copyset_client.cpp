@@ -26,6 +26,7 @@
 #include <unistd.h>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "src/client/request_sender.h"
 #include "src/client/metacache.h"
@@ -82,6 +83,47 @@ bool CopysetClient::FetchLeader(LogicPoolID lpid, CopysetID cpid,
     return true;
 }
 
+bool CopysetClient::FetchReadPeer(const ChunkIDInfo& idinfo, uint32_t shift,
+    ChunkServerID* peerId, butil::EndPoint* peerAddr) {
+    CopysetInfo<ChunkServerID> cpinfo =
+        metaCache_->GetCopysetinfo(idinfo.lpid_, idinfo.cpid_);
+    if (cpinfo.csinfos_.empty()) {
+        return false;
+    }
+
+    // 不同chunk的读请求分散到各个副本上，变慢的副本排在最后
+    const size_t num = cpinfo.csinfos_.size();
+    std::vector<size_t> candidates;
+    std::vector<size_t> slowPeers;
+    candidates.reserve(num);
+    UnstableHelper& helper = metaCache_->GetUnstableHelper();
+    for (size_t i = 0; i < num; ++i) {
+        size_t index = (idinfo.cid_ + i) % num;
+        if (helper.IsSlow(cpinfo.csinfos_[index].peerID)) {
+            slowPeers.push_back(index);
+        } else {
+            candidates.push_back(index);
+        }
+    }
+    candidates.insert(candidates.end(), slowPeers.begin(), slowPeers.end());
+
+    const auto& peer = cpinfo.csinfos_[candidates[shift % num]];
+    *peerId = peer.peerID;
+    *peerAddr = peer.externalAddr.addr_;
+    return true;
+}
+
+std::shared_ptr<RequestSender> CopysetClient::GetHedgeSender(
+    const ChunkIDInfo& idinfo, ChunkServerID primaryId) {
+    ChunkServerID peerId;
+    butil::EndPoint peerAddr;
+    if (!FetchReadPeer(idinfo, 1, &peerId, &peerAddr) || peerId == primaryId) {
+        return nullptr;
+    }
+
+    return senderManager_->GetOrCreateSender(peerId, peerAddr, iosenderopt_);
+}
+
 // 因为这里的CopysetClient::ReadChunk(会在两个逻辑里调用
 // 1. 从request scheduler下发的新的请求
 // 2. clientclosure再重试逻辑里调用copyset client重试
@@ -128,6 +170,32 @@ int CopysetClient::ReadChunk(const ChunkIDInfo& idinfo, uint64_t sn,
                              length, sourceInfo, readDone);
     };
 
+    // 第一次发送时按chunk选择副本，被拒绝后重试时发给leader
+    // 需要从源端拷贝数据的请求只有leader能处理
+    if (iosenderopt_.readFromFollower && !sourceInfo.IsValid() &&
+        reqclosure->GetRetriedTimes() == 0) {
+        ChunkServerID peerId;
+        butil::EndPoint peerAddr;
+        if (FetchReadPeer(idinfo, 0, &peerId, &peerAddr)) {
+            auto senderPtr = senderManager_->GetOrCreateSender(peerId,
+                                            peerAddr, iosenderopt_);
+            if (nullptr != senderPtr) {
+                reqclosure->IncremRetriedTimes();
+                auto hedgePtr = iosenderopt_.hedgedReadOpt.enable
+                                    ? GetHedgeSender(idinfo, peerId)
+                                    : nullptr;
+                if (nullptr != hedgePtr) {
+                    senderPtr->HedgedReadChunk(
+                        idinfo, offset, length, std::move(hedgePtr),
+                        new ReadChunkClosure(this, doneGuard.release()));
+                    return 0;
+                }
+                task(doneGuard.release(), senderPtr);
+                return 0;
+            }
+        }
+    }
+
     return DoRPCTask(idinfo, task, doneGuard.release());
 }
 
@@ -79,6 +79,13 @@ class CopysetClient {
         return metaCache_;
     }
 
+    /**
+     * 是否从follower读取数据
+     */
+    bool ReadFromFollower() const {
+        return iosenderopt_.readFromFollower;
+    }
+
     /**
      * 读Chunk
      * @param idinfo为chunk相关的id信息
@@ -224,6 +231,17 @@ class CopysetClient {
                      ChunkServerID* leaderid,
                      butil::EndPoint* leaderaddr);
 
+    // 从follower读时选择chunk所在copyset的一个副本，变慢的副本最后选择，
+    // shift为0时按chunk选择，对冲读使用1选择下一个副本
+    bool FetchReadPeer(const ChunkIDInfo& idinfo,
+                       uint32_t shift,
+                       ChunkServerID* peerId,
+                       butil::EndPoint* peerAddr);
+
+    // 对冲读发给的副本，没有与primaryId不同的副本时返回nullptr
+    std::shared_ptr<RequestSender> GetHedgeSender(const ChunkIDInfo& idinfo,
+                                                  ChunkServerID primaryId);
+
     /**
      * 执行发送rpc task，并进行错误重试
      * @param[in]: idinfo为当前rpc task的id信息
@@ -24,7 +24,9 @@
 #include "src/client/discard_task.h"
 
 #include <bthread/unstable.h>
+#include <butil/time.h>
 
+#include <algorithm>
 #include <memory>
 #include <unordered_set>
 #include <utility>
@@ -32,61 +34,141 @@
 namespace curve {
 namespace client {
 
+namespace {
+
+// the interval between requests starts from it when MDS turns slow
+const uint64_t kMinIntervalUs = 10 * 1000;
+
+}  // namespace
+
+static void RunDiscardTask(void* arg) {
+    DiscardTask* task = static_cast<DiscardTask*>(arg);
+    task->Run();
+}
+
 void DiscardTask::Run() {
-    const FInfo* fileInfo = metaCache_->GetFileInfo();
-    uint64_t offset =
-        static_cast<uint64_t>(segmentIndex_) * fileInfo->segmentsize;
-    FileSegment* fileSegment = metaCache_->GetFileSegment(segmentIndex_);
+    if (taskManager_->DelayTask(this)) {
+        return;
+    }
 
-    fileSegment->AcquireWriteLock();
+    const FInfo* fileInfo = metaCache_->GetFileInfo();
+    std::vector<SegmentIndex> indexes = taskManager_->TakeFollowingTasks(this);
+    std::vector<FileSegment*> segments;
+    segments.reserve(indexes.size());
+    for (auto index : indexes) {
+        FileSegment* fileSegment = metaCache_->GetFileSegment(index);
+        fileSegment->AcquireWriteLock();
+        segments.push_back(fileSegment);
+    }
     metric_->pending << -1;
 
-    if (!fileSegment->IsAllBitSet()) {
-        LOG(WARNING) << "DiscardTask find bitmap was cleared, cancel task, "
-                        "filename = "
-                     << fileInfo->fullPathName << ", offset = " << offset
-                     << ", taskid = " << timerId_;
-        metric_->totalCanceled << 1;
+    size_t begin = 0;
+    while (begin < indexes.size()) {
+        if (!segments[begin]->IsAllBitSet()) {
+            LOG(WARNING) << "DiscardTask find bitmap was cleared, cancel task, "
+                            "filename = "
+                         << fileInfo->fullPathName << ", offset = "
+                         << indexes[begin] * fileInfo->segmentsize
+                         << ", taskid = " << timerId_;
+            metric_->totalCanceled << 1;
+            ++begin;
+            continue;
+        }
+
+        size_t end = begin + 1;
+        while (end < indexes.size() && segments[end]->IsAllBitSet()) {
+            ++end;
+        }
+        DeAllocate(indexes, segments, begin, end);
+        begin = end;
+    }
+
+    for (auto fileSegment : segments) {
         fileSegment->ReleaseLock();
-        taskManager_->OnTaskFinish(timerId_);
-        return;
     }
+    taskManager_->OnTaskFinish(timerId_);
+}
 
-    LIBCURVE_ERROR errCode = mdsClient_->DeAllocateSegment(fileInfo, offset);
-    if (errCode == LIBCURVE_ERROR::OK) {
+void DiscardTask::DeAllocate(const std::vector<SegmentIndex>& indexes,
+                             const std::vector<FileSegment*>& segments,
+                             size_t begin, size_t end) {
+    const FInfo* fileInfo = metaCache_->GetFileInfo();
+    uint64_t offset =
+        static_cast<uint64_t>(indexes[begin]) * fileInfo->segmentsize;
+    uint32_t segmentNum = end - begin;
+    uint32_t deallocated = 0;
+
+    uint64_t startUs = butil::gettimeofday_us();
+    LIBCURVE_ERROR errCode;
+    if (segmentNum == 1) {
+        errCode = mdsClient_->DeAllocateSegment(fileInfo, offset);
+        deallocated = errCode == LIBCURVE_ERROR::OK ? 1 : 0;
+    } else {
+        errCode = mdsClient_->DeAllocateSegments(fileInfo, offset, segmentNum,
+                                                 &deallocated);
+    }
+    // a file under snapshot says nothing about the load of MDS
+    taskManager_->OnRequestFinish(
+        butil::gettimeofday_us() - startUs,
+        errCode != LIBCURVE_ERROR::OK &&
+            errCode != LIBCURVE_ERROR::UNDER_SNAPSHOT);
+
+    for (size_t i = begin; i < begin + deallocated; ++i) {
         metric_->totalSuccess << 1;
-        fileSegment->ClearBitmap();
-        metaCache_->CleanChunksInSegment(segmentIndex_);
+        segments[i]->ClearBitmap();
+        metaCache_->CleanChunksInSegment(indexes[i]);
+    }
+
+    if (errCode == LIBCURVE_ERROR::OK) {
         LOG(INFO) << "DiscardTask success, filename = "
                   << fileInfo->fullPathName << ", offset = " << offset
+                  << ", segment num = " << segmentNum
                   << ", taskid = " << timerId_;
-    } else if (errCode == LIBCURVE_ERROR::UNDER_SNAPSHOT) {
-        metric_->totalError << 1;
+        return;
+    }
+
+    metric_->totalError << (segmentNum - deallocated);
+    if (errCode == LIBCURVE_ERROR::UNDER_SNAPSHOT) {
         LOG(WARNING) << "DiscardTask failed, " << fileInfo->fullPathName
                      << " has snapshot, offset = " << offset
+                     << ", segment num = " << segmentNum
+                     << ", deallocated = " << deallocated
                      << ", taskid = " << timerId_;
     } else {
-        metric_->totalError << 1;
         LOG(ERROR) << "DiscardTask failed, mds return error = " << errCode
                    << ", filename = " << fileInfo->fullPathName
-                   << ", offset = " << offset << ", taskid = " << timerId_;
+                   << ", offset = " << offset
+                   << ", segment num = " << segmentNum
+                   << ", deallocated = " << deallocated
+                   << ", taskid = " << timerId_;
     }
-
-    fileSegment->ReleaseLock();
-    taskManager_->OnTaskFinish(timerId_);
 }
 
 DiscardTaskManager::DiscardTaskManager(DiscardMetric* metric)
-    : mtx_(), cond_(), unfinishedTasks_(), metric_(metric) {}
+    : DiscardTaskManager(metric, DiscardOption()) {}
 
-static void RunDiscardTask(void* arg) {
-    DiscardTask* task = static_cast<DiscardTask*>(arg);
-    task->Run();
-}
+DiscardTaskManager::DiscardTaskManager(DiscardMetric* metric,
+                                       const DiscardOption& option)
+    : option_(option),
+      mtx_(),
+      cond_(),
+      unfinishedTasks_(),
+      stopped_(false),
+      intervalUs_(0),
+      nextRequestUs_(0),
+      metric_(metric) {}
 
 void DiscardTaskManager::OnTaskFinish(bthread_timer_t timerId) {
     std::lock_guard<bthread::Mutex> lk(mtx_);
-    unfinishedTasks_.erase(timerId);
+    auto iter = unfinishedTasks_.find(timerId);
+    if (iter != unfinishedTasks_.end()) {
+        auto pending =
+            pendingSegments_.find(iter->second->GetSegmentIndex());
+        if (pending != pendingSegments_.end() && pending->second == timerId) {
+            pendingSegments_.erase(pending);
+        }
+        unfinishedTasks_.erase(iter);
+    }
     cond_.notify_one();
 }
 
@@ -96,13 +178,16 @@ bool DiscardTaskManager::ScheduleTask(SegmentIndex segmentIndex,
     bthread_timer_t timerId;
     std::unique_ptr<DiscardTask> task(
         new DiscardTask(this, segmentIndex, metaCache, mdsclient, metric_));
+    task->SetDueUs(butil::timespec_to_microseconds(abstime));
 
+    // hold the lock, so that the task can't be taken over before it's added
+    std::lock_guard<bthread::Mutex> lk(mtx_);
     int ret = bthread_timer_add(&timerId, abstime, RunDiscardTask, task.get());
     if (ret == 0) {
         task->SetId(timerId);
         LOG(INFO) << "Schedule discard task success, taskid = " << task->Id();
-        std::lock_guard<bthread::Mutex> lk(mtx_);
         unfinishedTasks_.emplace(timerId, std::move(task));
+        pendingSegments_[segmentIndex] = timerId;
         metric_->pending << 1;
         return true;
     }
@@ -112,11 +197,111 @@ bool DiscardTaskManager::ScheduleTask(SegmentIndex segmentIndex,
     return false;
 }
 
+bool DiscardTaskManager::DelayTask(DiscardTask* task) {
+    std::lock_guard<bthread::Mutex> lk(mtx_);
+    if (task->SlotUs() != 0) {
+        // it runs in the slot reserved
+        task->SetSlotUs(0);
+        return false;
+    }
+
+    uint64_t now = butil::gettimeofday_us();
+    if (stopped_ || now >= nextRequestUs_) {
+        nextRequestUs_ = now + intervalUs_;
+        return false;
+    }
+
+    bthread_timer_t timerId;
+    uint64_t slot = nextRequestUs_;
+    int ret = bthread_timer_add(&timerId, butil::microseconds_to_timespec(slot),
+                                RunDiscardTask, task);
+    if (ret != 0) {
+        LOG(WARNING) << "bthread_timer_add failed, ret = " << ret
+                     << ", run discard task directly, taskid = "
+                     << task->Id();
+        return false;
+    }
+    nextRequestUs_ += intervalUs_;
+
+    // the task is kept by the new timer id
+    auto iter = unfinishedTasks_.find(task->Id());
+    if (iter != unfinishedTasks_.end()) {
+        std::unique_ptr<DiscardTask> owned = std::move(iter->second);
+        unfinishedTasks_.erase(iter);
+        unfinishedTasks_.emplace(timerId, std::move(owned));
+    }
+    auto pending = pendingSegments_.find(task->GetSegmentIndex());
+    if (pending != pendingSegments_.end() && pending->second == task->Id()) {
+        pending->second = timerId;
+    }
+    task->SetId(timerId);
+    task->SetSlotUs(slot);
+    return true;
+}
+
+std::vector<SegmentIndex> DiscardTaskManager::TakeFollowingTasks(
+    DiscardTask* task) {
+    std::vector<SegmentIndex> indexes{task->GetSegmentIndex()};
+
+    std::lock_guard<bthread::Mutex> lk(mtx_);
+    auto self = pendingSegments_.find(task->GetSegmentIndex());
+    if (self != pendingSegments_.end() && self->second == task->Id()) {
+        pendingSegments_.erase(self);
+    }
+
+    uint64_t deadline =
+        butil::gettimeofday_us() + option_.batchWindowMs * 1000ull;
+    while (indexes.size() < option_.maxBatchSegments) {
+        auto pending = pendingSegments_.find(indexes.back() + 1);
+        if (pending == pendingSegments_.end()) {
+            break;
+        }
+        auto iter = unfinishedTasks_.find(pending->second);
+        if (iter == unfinishedTasks_.end() ||
+            iter->second->DueUs() > deadline) {
+            break;
+        }
+        // it's running or about to run by itself
+        if (bthread_timer_del(pending->second) != 0) {
+            break;
+        }
+
+        indexes.push_back(pending->first);
+        metric_->pending << -1;
+        unfinishedTasks_.erase(iter);
+        pendingSegments_.erase(pending);
+    }
+
+    return indexes;
+}
+
+void DiscardTaskManager::OnRequestFinish(uint64_t latencyUs, bool failed) {
+    if (option_.maxIntervalMs == 0) {
+        return;
+    }
+
+    std::lock_guard<bthread::Mutex> lk(mtx_);
+    if (failed || latencyUs > option_.targetLatencyMs * 1000ull) {
+        intervalUs_ = std::min<uint64_t>(option_.maxIntervalMs * 1000ull,
+                                         std::max(kMinIntervalUs,
+                                                  intervalUs_ * 2));
+    } else {
+        intervalUs_ = intervalUs_ / 2 < kMinIntervalUs ? 0 : intervalUs_ / 2;
+    }
+}
+
+uint64_t DiscardTaskManager::IntervalUs() const {
+    std::lock_guard<bthread::Mutex> lk(mtx_);
+    return intervalUs_;
+}
+
 void DiscardTaskManager::Stop() {
     std::unordered_set<bthread_timer_t> currentTasks;
 
     {
         std::lock_guard<bthread::Mutex> lk(mtx_);
+        // tasks delayed from now on run directly
+        stopped_ = true;
         for (auto& kv : unfinishedTasks_) {
             currentTasks.emplace(kv.first);
         }
@@ -29,8 +29,13 @@
 #include <time.h>
 
 #include <atomic>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "src/client/client_metric.h"
+#include "src/client/config_info.h"
 #include "src/client/metacache.h"
 #include "src/client/metacache_struct.h"
 
@@ -44,6 +49,8 @@ class DiscardTaskManager;
  * DiscardTask corresponding to one segment discard task.
  * It's main function is to send DeAllocateSegment request to MDS
  * and clear cached segment info on success.
+ * Tasks of the following segments due soon are taken over by the running
+ * task, and the segments still marked discarded are deallocated together.
  */
 class DiscardTask {
  public:
@@ -67,6 +74,36 @@ class DiscardTask {
         timerId_ = id;
     }
 
+    SegmentIndex GetSegmentIndex() const {
+        return segmentIndex_;
+    }
+
+    uint64_t DueUs() const {
+        return dueUs_;
+    }
+
+    void SetDueUs(uint64_t dueUs) {
+        dueUs_ = dueUs;
+    }
+
+    // time slot reserved by the rate limit when the task is delayed
+    uint64_t SlotUs() const {
+        return slotUs_;
+    }
+
+    void SetSlotUs(uint64_t slotUs) {
+        slotUs_ = slotUs;
+    }
+
+ private:
+    /**
+     * @brief deallocate segments [begin, end) of segments, which are
+     *        consecutive and locked
+     */
+    void DeAllocate(const std::vector<SegmentIndex>& indexes,
+                    const std::vector<FileSegment*>& segments, size_t begin,
+                    size_t end);
+
  private:
     DiscardTaskManager* taskManager_;
     SegmentIndex segmentIndex_;
@@ -74,6 +111,8 @@ class DiscardTask {
     MDSClient* mdsClient_;
     bthread_timer_t timerId_;
     DiscardMetric* metric_;
+    uint64_t dueUs_ = 0;
+    uint64_t slotUs_ = 0;
 
     static std::atomic<uint64_t> taskId_;
 };
@@ -85,20 +124,52 @@ class DiscardTaskManager {
  public:
     explicit DiscardTaskManager(DiscardMetric* metric);
 
+    DiscardTaskManager(DiscardMetric* metric, const DiscardOption& option);
+
     void OnTaskFinish(bthread_timer_t timerId);
 
     bool ScheduleTask(SegmentIndex segmentIndex, MetaCache* metaCache,
                       MDSClient* mdsclient, timespec abstime);
 
+    /**
+     * @brief Delay the task to the next time slot if requests are sent to
+     *        MDS too fast
+     * @return true if the task is delayed, and it will run again later
+     */
+    bool DelayTask(DiscardTask* task);
+
+    /**
+     * @brief Take over the pending tasks of the segments following the task,
+     *        which are due within batchWindowMs
+     * @return indexes of the segments starting with the task's own
+     */
+    std::vector<SegmentIndex> TakeFollowingTasks(DiscardTask* task);
+
+    /**
+     * @brief Adjust the interval between requests by the latency of the
+     *        last one
+     */
+    void OnRequestFinish(uint64_t latencyUs, bool failed);
+
+    uint64_t IntervalUs() const;
+
     /**
      * @brief Cancel all unfinished discard tasks
      */
     void Stop();
 
  private:
-    bthread::Mutex mtx_;
+    DiscardOption option_;
+
+    mutable bthread::Mutex mtx_;
     bthread::ConditionVariable cond_;
     std::unordered_map<bthread_timer_t, std::unique_ptr<DiscardTask>> unfinishedTasks_;  // NOLINT
+    // tasks waiting for their timers, by segment index
+    std::map<SegmentIndex, bthread_timer_t> pendingSegments_;
+
+    bool stopped_;
+    uint64_t intervalUs_;
+    uint64_t nextRequestUs_;
 
     DiscardMetric* metric_;
 };
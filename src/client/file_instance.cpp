@@ -28,6 +28,7 @@
 
 #include "src/client/iomanager4file.h"
 #include "src/client/mds_client.h"
+#include "src/client/splitor.h"
 #include "src/common/timeutility.h"
 #include "src/common/curve_define.h"
 #include "src/common/fast_align.h"
@@ -49,9 +50,17 @@ bool FileInstance::Initialize(const std::string& filename,
                               const UserInfo& userinfo,
                               const OpenFlags& openflags,
                               const FileServiceOption& fileservicopt,
-                              bool readonly) {
+                              bool readonly,
+                              LeaseRefresher* refresher) {
     readonly_ = readonly;
     fileopt_ = fileservicopt;
+    // 可写的文件从follower读可能读不到刚写入的数据
+    if (!readonly_) {
+        fileopt_.ioOpt.ioSenderOpt.readFromFollower = false;
+        fileopt_.ioOpt.reqSchdulerOpt.ioSenderOpt.readFromFollower = false;
+        // 可写的文件数据会变化，不能缓存
+        fileopt_.ioOpt.readCacheOpt.enable = false;
+    }
     bool ret = false;
     do {
         if (!userinfo.Valid()) {
@@ -68,6 +77,7 @@ bool FileInstance::Initialize(const std::string& filename,
         finfo_.openflags = openflags;
         finfo_.userinfo = userinfo;
         finfo_.fullPathName = filename;
+        fileopt_.ioOpt.throttleOption.tenant = userinfo.owner;
 
         if (!iomanager4file_.Initialize(filename, fileopt_.ioOpt,
                                         mdsclient_.get())) {
@@ -77,10 +87,11 @@ bool FileInstance::Initialize(const std::string& filename,
         }
 
         iomanager4file_.UpdateFileInfo(finfo_);
+        iomanager4file_.SetIOPriority(openflags.priority);
 
         leaseExecutor_.reset(new (std::nothrow) LeaseExecutor(
             fileopt_.leaseOpt, finfo_.userinfo, mdsclient_.get(),
-            &iomanager4file_));
+            &iomanager4file_, refresher));
         if (leaseExecutor_ == nullptr) {
             LOG(ERROR) << "Allocate LeaseExecutor failed, filename = "
                        << filename;
@@ -214,6 +225,18 @@ int FileInstance::Open(std::string* sessionId) {
         }
         iomanager4file_.UpdateFileEpoch(fEpoch);
         blocksize_ = finfo_.blocksize;
+
+        // 预热失败不影响打开，segment在使用时再获取
+        if (ret == LIBCURVE_ERROR::OK) {
+            Splitor::WarmupSegments(mdsclient_.get(),
+                                    iomanager4file_.GetMetaCache(), &finfo_);
+        }
+
+        // 写回日志打不开时不能打开文件，否则上次没有刷下去的数据会丢失
+        if (ret == LIBCURVE_ERROR::OK && !readonly_ &&
+            iomanager4file_.OpenWriteBackLog(mdsclient_.get()) != 0) {
+            ret = LIBCURVE_ERROR::FAILED;
+        }
     }
     return -ret;
 }
@@ -231,6 +254,9 @@ int FileInstance::Close() {
         return 0;
     }
 
+    // 关闭之前把写回日志中的数据都刷下去，失败时数据留在日志中
+    iomanager4file_.CloseWriteBackLog();
+
     StopLease();
 
     LIBCURVE_ERROR ret =
@@ -244,7 +270,8 @@ FileInstance* FileInstance::NewInitedFileInstance(
     const std::string& filename,
     const UserInfo& userInfo,
     const OpenFlags& openflags,  // TODO(all): maybe we can put userinfo and readonly into openflags  // NOLINT
-    bool readonly) {
+    bool readonly,
+    LeaseRefresher* refresher) {
     FileInstance *instance = new (std::nothrow) FileInstance();
     if (instance == nullptr) {
         LOG(ERROR) << "Create FileInstance failed, filename: " << filename;
@@ -252,7 +279,7 @@ FileInstance* FileInstance::NewInitedFileInstance(
     }
 
     bool ret = instance->Initialize(filename, mdsClient, userInfo, openflags,
-                                    fileServiceOption, readonly);
+                                    fileServiceOption, readonly, refresher);
     if (!ret) {
         LOG(ERROR) << "FileInstance initialize failed"
                    << ", filename = " << filename
@@ -49,6 +49,7 @@ class CURVE_CACHELINE_ALIGNMENT FileInstance {
      * @param: fileservicopt fileclient的配置选项
      * @param: clientMetric为client端要统计的metric信息
      * @param: readonly是否以只读方式打开
+     * @param: refresher不为空时文件与其他文件一起批量续约
      * @return: 成功返回true、否则返回false
      */
     bool Initialize(const std::string& filename,
@@ -56,7 +57,8 @@ class CURVE_CACHELINE_ALIGNMENT FileInstance {
                     const UserInfo& userinfo,
                     const OpenFlags& openflags,
                     const FileServiceOption& fileservicopt,
-                    bool readonly = false);
+                    bool readonly = false,
+                    LeaseRefresher* refresher = nullptr);
     /**
      * 打开文件
      * @return: 成功返回LIBCURVE_ERROR::OK,否则LIBCURVE_ERROR::FAILED
@@ -146,7 +148,8 @@ class CURVE_CACHELINE_ALIGNMENT FileInstance {
         const std::string& filename,
         const UserInfo& userInfo,
         const OpenFlags& openflags,
-        bool readonly);
+        bool readonly,
+        LeaseRefresher* refresher = nullptr);
 
     static FileInstance* Open4Readonly(
         const FileServiceOption& opt,
@@ -0,0 +1,243 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/client/file_latency_stats.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <sstream>
+
+#include "src/common/timeutility.h"
+
+namespace curve {
+namespace client {
+
+namespace {
+
+// values beyond 2^28 us are counted in the last bucket
+const int kMaxPower = 27;
+
+int CurrentShard(int shardNum) {
+    static std::atomic<uint32_t> next(0);
+    thread_local int shard = next.fetch_add(1, std::memory_order_relaxed);
+    return shard % shardNum;
+}
+
+uint64_t BucketLowerBound(int bucket) {
+    if (bucket < 4) {
+        return bucket;
+    }
+    int power = bucket / 4 + 1;
+    return static_cast<uint64_t>(4 + bucket % 4) << (power - 2);
+}
+
+void PrintPercentiles(std::ostream& os, const char* name,
+                      const std::vector<uint64_t>& buckets) {
+    uint64_t count = 0;
+    for (auto c : buckets) {
+        count += c;
+    }
+    os << " " << name << "_count=" << count
+       << " " << name << "_p50=" << LatencyHistogram::Percentile(buckets, 0.5)
+       << " " << name << "_p99=" << LatencyHistogram::Percentile(buckets, 0.99)
+       << " " << name
+       << "_p999=" << LatencyHistogram::Percentile(buckets, 0.999);
+}
+
+// buckets -= previous, previous = the buckets before
+bool Delta(std::vector<uint64_t>* buckets, std::vector<uint64_t>* previous) {
+    bool changed = false;
+    if (previous->empty()) {
+        previous->assign(buckets->size(), 0);
+    }
+    for (size_t i = 0; i < buckets->size(); ++i) {
+        uint64_t current = (*buckets)[i];
+        (*buckets)[i] = current - (*previous)[i];
+        (*previous)[i] = current;
+        changed = changed || (*buckets)[i] != 0;
+    }
+    return changed;
+}
+
+}  // namespace
+
+LatencyHistogram::LatencyHistogram() {
+    for (auto& shard : shards_) {
+        for (auto& count : shard.counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+int LatencyHistogram::BucketOf(uint64_t value) {
+    if (value < 4) {
+        return value;
+    }
+    int power = 63 - __builtin_clzll(value);
+    if (power > kMaxPower) {
+        return kBucketNum - 1;
+    }
+    return (power - 1) * 4 + ((value >> (power - 2)) & 3);
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(int bucket) {
+    return BucketLowerBound(bucket + 1) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t value) {
+    shards_[CurrentShard(kShardNum)].counts[BucketOf(value)].fetch_add(
+        1, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Snapshot(std::vector<uint64_t>* buckets) const {
+    buckets->assign(kBucketNum, 0);
+    for (const auto& shard : shards_) {
+        for (int i = 0; i < kBucketNum; ++i) {
+            (*buckets)[i] += shard.counts[i].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+uint64_t LatencyHistogram::Percentile(const std::vector<uint64_t>& buckets,
+                                      double ratio) {
+    uint64_t total = 0;
+    for (auto count : buckets) {
+        total += count;
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t target = std::max<uint64_t>(1, std::ceil(total * ratio));
+    uint64_t accumulated = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        accumulated += buckets[i];
+        if (accumulated >= target) {
+            return BucketUpperBound(i);
+        }
+    }
+    return BucketUpperBound(buckets.size() - 1);
+}
+
+bool FileLatencyStats::SampleSpan() const {
+    if (option_.spanSampleRate == 0) {
+        return false;
+    }
+    thread_local uint32_t ios = 0;
+    return ++ios % option_.spanSampleRate == 0;
+}
+
+void FileLatencyStats::LogSpan(const IOSpan& span, OpType type, off_t offset,
+                               size_t length) const {
+    uint64_t now = common::TimeUtility::GetTimeofDayUs();
+    LOG(INFO) << "io span, filename: " << filename_
+              << ", op: " << OpTypeToString(type) << ", offset: " << offset
+              << ", length: " << length << ", requests: " << span.requests
+              << ", split us: " << span.splitDoneUs - span.startUs
+              << ", max queue us: " << span.maxQueueUs
+              << ", max rpc us: " << span.maxRpcUs
+              << ", retries: " << span.retries
+              << ", total us: " << now - span.startUs;
+}
+
+FileLatencyCollector::FileLatencyCollector()
+    : running_(false),
+      reportStatus_("curve_client_file_latency",
+                    &FileLatencyCollector::ReportTo, this) {}
+
+FileLatencyCollector::~FileLatencyCollector() {
+    Stop();
+}
+
+void FileLatencyCollector::Start(const FileMetricOption& option) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (running_ || option.latencyStatsIntervalS == 0) {
+        return;
+    }
+    sleeper_.init();
+    thread_.reset(new std::thread(&FileLatencyCollector::Run, this,
+                                  option.latencyStatsIntervalS));
+    running_ = true;
+    LOG(INFO) << "file latency collector started, interval: "
+              << option.latencyStatsIntervalS << "s";
+}
+
+void FileLatencyCollector::Stop() {
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    sleeper_.interrupt();
+    thread_->join();
+    thread_.reset();
+}
+
+void FileLatencyCollector::Register(const FileLatencyStats* stats) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    files_[stats];
+}
+
+void FileLatencyCollector::Unregister(const FileLatencyStats* stats) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    files_.erase(stats);
+}
+
+void FileLatencyCollector::Run(uint32_t intervalS) {
+    while (sleeper_.wait_for(std::chrono::seconds(intervalS))) {
+        Collect();
+    }
+}
+
+void FileLatencyCollector::Collect() {
+    std::ostringstream os;
+    std::vector<uint64_t> read;
+    std::vector<uint64_t> write;
+
+    std::lock_guard<std::mutex> lk(mtx_);
+    for (auto& file : files_) {
+        file.first->ReadLatency().Snapshot(&read);
+        file.first->WriteLatency().Snapshot(&write);
+        bool readChanged = Delta(&read, &file.second.read);
+        bool writeChanged = Delta(&write, &file.second.write);
+        if (!readChanged && !writeChanged) {
+            continue;
+        }
+
+        os << file.first->FileName();
+        PrintPercentiles(os, "read", read);
+        PrintPercentiles(os, "write", write);
+        os << "\n";
+    }
+    report_ = os.str();
+}
+
+std::string FileLatencyCollector::Report() const {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return report_;
+}
+
+void FileLatencyCollector::ReportTo(std::ostream& os, void* arg) {
+    os << static_cast<FileLatencyCollector*>(arg)->Report();
+}
+
+}  // namespace client
+}  // namespace curve
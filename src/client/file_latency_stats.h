@@ -0,0 +1,210 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_CLIENT_FILE_LATENCY_STATS_H_
+#define SRC_CLIENT_FILE_LATENCY_STATS_H_
+
+#include <bvar/bvar.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "include/curve_compiler_specific.h"
+#include "src/client/client_common.h"
+#include "src/client/config_info.h"
+#include "src/common/interruptible_sleeper.h"
+#include "src/common/uncopyable.h"
+
+namespace curve {
+namespace client {
+
+/**
+ * Latency histogram cheap enough to be kept for every opened file.
+ *
+ * Values are counted in log-linear buckets, 4 buckets for every power of 2,
+ * so a percentile is accurate within 25%. Counters are spread over a few
+ * shards picked by the recording thread, recording is a relaxed atomic add
+ * on a cache line mostly touched by the current thread only, nothing is
+ * registered or sampled in the background.
+ */
+class LatencyHistogram : public curve::common::Uncopyable {
+ public:
+    static const int kBucketNum = 108;
+
+    LatencyHistogram();
+
+    void Record(uint64_t value);
+
+    /**
+     * @brief sum up the counts of the shards into buckets
+     */
+    void Snapshot(std::vector<uint64_t>* buckets) const;
+
+    static int BucketOf(uint64_t value);
+
+    // upper bound of the values counted in the bucket
+    static uint64_t BucketUpperBound(int bucket);
+
+    /**
+     * @brief percentile of the values counted in buckets
+     * @param ratio in (0, 1], e.g. 0.99
+     * @return 0 if buckets is empty
+     */
+    static uint64_t Percentile(const std::vector<uint64_t>& buckets,
+                               double ratio);
+
+ private:
+    static const int kShardNum = 4;
+
+    struct CURVE_CACHELINE_ALIGNMENT Shard {
+        std::atomic<uint64_t> counts[kBucketNum];
+    };
+
+    Shard shards_[kShardNum];
+};
+
+/**
+ * Timestamps of a sampled user io, from which the time spent on split,
+ * schedule, rpc and retry is logged when the io is done.
+ */
+struct IOSpan {
+    uint64_t startUs = 0;
+    uint64_t splitDoneUs = 0;
+
+    std::mutex mtx;
+    uint32_t requests = 0;
+    // max time a sub request waits in the scheduler queue
+    uint64_t maxQueueUs = 0;
+    // max latency of the last rpc of a sub request
+    uint64_t maxRpcUs = 0;
+    // retries of all the sub requests
+    uint64_t retries = 0;
+};
+
+/**
+ * Latency of the user ios of one file.
+ */
+class FileLatencyStats : public curve::common::Uncopyable {
+ public:
+    FileLatencyStats(const std::string& filename,
+                     const FileMetricOption& option)
+        : filename_(filename), option_(option) {}
+
+    const std::string& FileName() const {
+        return filename_;
+    }
+
+    void Record(OpType type, uint64_t latencyUs) {
+        if (type == OpType::READ) {
+            read_.Record(latencyUs);
+        } else if (type == OpType::WRITE) {
+            write_.Record(latencyUs);
+        }
+    }
+
+    const LatencyHistogram& ReadLatency() const {
+        return read_;
+    }
+
+    const LatencyHistogram& WriteLatency() const {
+        return write_;
+    }
+
+    /**
+     * @brief whether the span of the next io should be logged, one in every
+     *        spanSampleRate ios issued by the calling thread is sampled
+     */
+    bool SampleSpan() const;
+
+    void LogSpan(const IOSpan& span, OpType type, off_t offset,
+                 size_t length) const;
+
+ private:
+    const std::string filename_;
+    const FileMetricOption option_;
+
+    LatencyHistogram read_;
+    LatencyHistogram write_;
+};
+
+/**
+ * Computes the latency percentiles of the registered files periodically.
+ *
+ * The percentiles of the last interval of all the files are exposed in one
+ * bvar `curve_client_file_latency`, a line for every file with ios in the
+ * interval, instead of a set of bvars for every file.
+ */
+class FileLatencyCollector : public curve::common::Uncopyable {
+ public:
+    static FileLatencyCollector& GetInstance() {
+        static FileLatencyCollector collector;
+        return collector;
+    }
+
+    /**
+     * @brief start the thread collecting every latencyStatsIntervalS
+     *        seconds, only the first call takes effect
+     */
+    void Start(const FileMetricOption& option);
+
+    void Stop();
+
+    void Register(const FileLatencyStats* stats);
+
+    void Unregister(const FileLatencyStats* stats);
+
+    /**
+     * @brief compute the percentiles since the last collection
+     */
+    void Collect();
+
+    std::string Report() const;
+
+    ~FileLatencyCollector();
+
+ private:
+    FileLatencyCollector();
+
+    struct Previous {
+        std::vector<uint64_t> read;
+        std::vector<uint64_t> write;
+    };
+
+    void Run(uint32_t intervalS);
+
+    static void ReportTo(std::ostream& os, void* arg);
+
+ private:
+    mutable std::mutex mtx_;
+    std::unordered_map<const FileLatencyStats*, Previous> files_;
+    std::string report_;
+
+    bool running_;
+    common::InterruptibleSleeper sleeper_;
+    std::unique_ptr<std::thread> thread_;
+
+    bvar::PassiveStatus<std::string> reportStatus_;
+};
+
+}  // namespace client
+}  // namespace curve
+
+#endif  // SRC_CLIENT_FILE_LATENCY_STATS_H_
@@ -36,7 +36,7 @@ class InflightControl {
     InflightControl() = default;
 
     void SetMaxInflightNum(uint64_t maxInflightNum) {
-        maxInflightNum_ = maxInflightNum;
+        maxInflightNum_.store(maxInflightNum, std::memory_order_relaxed);
     }
 
     /**
@@ -117,7 +117,8 @@ class InflightControl {
     }
 
  private:
-    uint64_t              maxInflightNum_ = 0;
+    // 低优先级文件共享的控制器在每个文件初始化时都会设置
+    std::atomic<uint64_t> maxInflightNum_{0};
     std::atomic<uint64_t> curInflightIONum_{0};
 
     Mutex                 inflightComeBackmtx_;
@@ -35,6 +35,7 @@
 #include "src/client/source_reader.h"
 #include "src/client/metacache_struct.h"
 #include "src/client/discard_task.h"
+#include "src/client/read_cache.h"
 
 namespace curve {
 namespace client {
@@ -53,7 +54,11 @@ IOTracker::IOTracker(IOManager* iomanager,
       scheduler_(scheduler),
       iomanager_(iomanager),
       fileMetric_(clientMetric),
-      disableStripe_(disableStripe) {
+      disableStripe_(disableStripe),
+      readCache_(nullptr),
+      readCacheEpoch_(0),
+      latencyStats_(iomanager != nullptr ? iomanager->GetLatencyStats()
+                                         : nullptr) {
     id_         = tracekerID_.fetch_add(1, std::memory_order_relaxed);
     scc_        = nullptr;
     aioctx_     = nullptr;
@@ -102,6 +107,7 @@ void IOTracker::StartAioRead(CurveAioContext* ctx, MDSClient* mdsclient,
 
 void IOTracker::DoRead(MDSClient* mdsclient, const FInfo_t* fileInfo,
                        Throttle* throttle) {
+    StartSpan();
     if (throttle) {
         throttle->Add(true, length_);
     }
@@ -109,9 +115,15 @@ void IOTracker::DoRead(MDSClient* mdsclient, const FInfo_t* fileInfo,
     int ret = Splitor::IO2ChunkRequests(this, mc_, &reqlist_, nullptr, offset_,
                                         length_, mdsclient, fileInfo, nullptr);
     if (ret == 0) {
-        PrepareReadIOBuffers(reqlist_.size());
+        MarkSpanRequests();
+        uint32_t subIoCount = 0;
+        for (auto r : reqlist_) {
+            subIoCount += r->stripeUnits_.empty() ? 1 : r->stripeUnits_.size();
+        }
+        PrepareReadIOBuffers(subIoCount);
         uint32_t subIoIndex = 0;
         std::vector<RequestContext*> originReadVec;
+        const LIBCURVE_IO_PRIORITY priority = GetIOPriority();
 
         std::for_each(reqlist_.begin(), reqlist_.end(), [&](RequestContext* r) {
             // fake subrequest
@@ -129,12 +141,31 @@ void IOTracker::DoRead(MDSClient* mdsclient, const FInfo_t* fileInfo,
 
             r->done_->SetFileMetric(fileMetric_);
             r->done_->SetIOManager(iomanager_);
-            r->subIoIndex_ = subIoIndex++;
+            // 条带单元的位置在拆分时已确定
+            if (r->stripeUnits_.empty()) {
+                r->subIoIndex_ = subIoIndex++;
+            }
+            r->priority_ = priority;
         });
 
+        // 缓存块不能跨chunk
+        bool useCache = readCache_ != nullptr &&
+                        fileInfo->chunksize % readCache_->BlockSize() == 0;
+        std::vector<RequestContext*> cacheHitVec;
+        std::vector<RequestContext*> scheduleVec;
+        if (useCache) {
+            readCacheEpoch_ = mc_->GetFileEpoch()->epoch;
+            ReadFromCache(&cacheHitVec, &scheduleVec);
+        }
+
+        const std::vector<RequestContext*>& toSchedule =
+            useCache ? scheduleVec : reqlist_;
         reqcount_.store(reqlist_.size(), std::memory_order_release);
-        if (scheduler_->ScheduleRequest(reqlist_) == 0 &&
+        if (scheduler_->ScheduleRequest(toSchedule) == 0 &&
             ReadFromSource(originReadVec, fileInfo->userinfo, mdsclient) == 0) {
+            for (auto r : cacheHitVec) {
+                r->done_->Run();
+            }
             ret = 0;
         } else {
             ret = -1;
@@ -150,6 +181,65 @@ void IOTracker::DoRead(MDSClient* mdsclient, const FInfo_t* fileInfo,
     }
 }
 
+void IOTracker::ReadFromCache(std::vector<RequestContext*>* hits,
+                              std::vector<RequestContext*>* others) {
+    const uint64_t blockSize = readCache_->BlockSize();
+    for (auto r : reqlist_) {
+        if (!r->idinfo_.chunkExist || r->sourceInfo_.IsValid()) {
+            others->push_back(r);
+            continue;
+        }
+
+        uint64_t first = r->offset_ / blockSize;
+        uint64_t last = (r->offset_ + r->rawlength_ - 1) / blockSize;
+        butil::IOBuf data;
+        bool hit = true;
+        for (uint64_t index = first; index <= last; ++index) {
+            if (!readCache_->Get(r->idinfo_.cid_, index, readCacheEpoch_,
+                                 r->seq_, &data)) {
+                hit = false;
+                break;
+            }
+        }
+
+        if (hit) {
+            data.append_to(&r->readData_, r->rawlength_,
+                           r->offset_ - first * blockSize);
+            r->done_->SetFailed(LIBCURVE_ERROR::OK);
+            hits->push_back(r);
+            continue;
+        }
+
+        r->readCacheFill_ = true;
+        r->originOffset_ = r->offset_;
+        r->originLength_ = r->rawlength_;
+        r->offset_ = first * blockSize;
+        r->rawlength_ = (last + 1) * blockSize - r->offset_;
+        others->push_back(r);
+    }
+}
+
+void IOTracker::FillReadCache(RequestContext* reqctx) {
+    if (reqctx->done_->GetErrorCode() != 0 ||
+        reqctx->readData_.size() != reqctx->rawlength_) {
+        return;
+    }
+
+    const uint64_t blockSize = readCache_->BlockSize();
+    uint64_t index = reqctx->offset_ / blockSize;
+    for (uint64_t pos = 0; pos < reqctx->rawlength_; pos += blockSize) {
+        butil::IOBuf block;
+        reqctx->readData_.append_to(&block, blockSize, pos);
+        readCache_->Put(reqctx->idinfo_.cid_, index++, readCacheEpoch_,
+                        reqctx->seq_, block);
+    }
+
+    butil::IOBuf origin;
+    reqctx->readData_.append_to(&origin, reqctx->originLength_,
+                                reqctx->originOffset_ - reqctx->offset_);
+    reqctx->readData_.swap(origin);
+}
+
 int IOTracker::ReadFromSource(const std::vector<RequestContext*>& reqCtxVec,
                               const UserInfo_t& userInfo,
                               MDSClient* mdsClient) {
@@ -207,6 +297,7 @@ void IOTracker::DoWrite(MDSClient* mdsclient, const FInfo_t* fileInfo,
             break;
     }
 
+    StartSpan();
     if (throttle) {
         throttle->Add(false, length_);
     }
@@ -215,13 +306,16 @@ void IOTracker::DoWrite(MDSClient* mdsclient, const FInfo_t* fileInfo,
                                         offset_, length_,
                                         mdsclient, fileInfo, fEpoch);
     if (ret == 0) {
+        MarkSpanRequests();
         uint32_t subIoIndex = 0;
+        const LIBCURVE_IO_PRIORITY priority = GetIOPriority();
 
         reqcount_.store(reqlist_.size(), std::memory_order_release);
         std::for_each(reqlist_.begin(), reqlist_.end(), [&](RequestContext* r) {
             r->done_->SetFileMetric(fileMetric_);
             r->done_->SetIOManager(iomanager_);
             r->subIoIndex_ = subIoIndex++;
+            r->priority_ = priority;
         });
         ret = scheduler_->ScheduleRequest(reqlist_);
     } else {
@@ -447,7 +541,24 @@ void IOTracker::HandleResponse(RequestContext* reqctx) {
 
     // copy read data
     if (OpType::READ == type_ || OpType::READ_SNAP == type_) {
-        SetReadData(reqctx->subIoIndex_, reqctx->readData_);
+        if (reqctx->readCacheFill_) {
+            FillReadCache(reqctx);
+        }
+        if (reqctx->stripeUnits_.empty()) {
+            SetReadData(reqctx->subIoIndex_, reqctx->readData_);
+        } else {
+            uint64_t pos = 0;
+            for (const auto& unit : reqctx->stripeUnits_) {
+                butil::IOBuf piece;
+                reqctx->readData_.append_to(&piece, unit.length, pos);
+                SetReadData(unit.subIoIndex, piece);
+                pos += unit.length;
+            }
+        }
+    }
+
+    if (span_) {
+        RecordSpan(reqctx);
     }
 
     if (1 == reqcount_.fetch_sub(1, std::memory_order_acq_rel)) {
@@ -459,6 +570,46 @@ void IOTracker::InitDiscardOption(const DiscardOption& opt) {
     discardOption_ = opt;
 }
 
+void IOTracker::StartSpan() {
+    if (latencyStats_ != nullptr && latencyStats_->SampleSpan()) {
+        span_.reset(new IOSpan());
+        span_->startUs = opStartTimePoint_;
+    }
+}
+
+void IOTracker::MarkSpanRequests() {
+    if (!span_) {
+        return;
+    }
+    span_->splitDoneUs = TimeUtility::GetTimeofDayUs();
+    span_->requests = reqlist_.size();
+    for (auto r : reqlist_) {
+        r->traced_ = true;
+    }
+}
+
+void IOTracker::RecordSpan(RequestContext* reqctx) {
+    std::lock_guard<std::mutex> lk(span_->mtx);
+    if (reqctx->dispatchUs_ > span_->splitDoneUs) {
+        span_->maxQueueUs = std::max(span_->maxQueueUs,
+                                     reqctx->dispatchUs_ - span_->splitDoneUs);
+    }
+    span_->maxRpcUs =
+        std::max(span_->maxRpcUs, reqctx->done_->GetRpcLatencyUs());
+    span_->retries += reqctx->done_->GetRetriedTimes();
+}
+
+const std::string& IOTracker::FileName() const {
+    // 不为每个文件注册bvar时fileMetric_是所有文件共享的
+    return latencyStats_ != nullptr ? latencyStats_->FileName()
+                                    : fileMetric_->filename;
+}
+
+LIBCURVE_IO_PRIORITY IOTracker::GetIOPriority() const {
+    return iomanager_ != nullptr ? iomanager_->GetIOPriority()
+                                 : LIBCURVE_IO_PRIORITY_NORMAL;
+}
+
 int IOTracker::Wait() {
     return iocv_.Wait();
 }
@@ -472,6 +623,9 @@ void IOTracker::Done() {
         uint64_t duration = TimeUtility::GetTimeofDayUs() - opStartTimePoint_;
         MetricHelper::UserLatencyRecord(fileMetric_, duration, type_);
         MetricHelper::IncremUserQPSCount(fileMetric_, length_, type_);
+        if (latencyStats_ != nullptr) {
+            latencyStats_->Record(type_, duration);
+        }
 
         // copy read data to user buffer
         if (OpType::READ == type_ || OpType::READ_SNAP == type_) {
@@ -501,7 +655,7 @@ void IOTracker::Done() {
 
             if (errcode_ != LIBCURVE_ERROR::OK) {
                 LOG(ERROR) << "IO Error, copy data to read buffer failed, "
-                           << ", filename: " << fileMetric_->filename
+                           << ", filename: " << FileName()
                            << ", offset: " << offset_
                            << ", length: " << length_;
             }
@@ -510,12 +664,12 @@ void IOTracker::Done() {
         MetricHelper::IncremUserEPSCount(fileMetric_, type_);
         if (type_ == OpType::READ || type_ == OpType::WRITE) {
             if (LIBCURVE_ERROR::EPOCH_TOO_OLD == errcode_) {
-                LOG(WARNING) << "file [" << fileMetric_->filename << "]"
+                LOG(WARNING) << "file [" << FileName() << "]"
                         << ", epoch too old, OpType = " << OpTypeToString(type_)
                         << ", offset = " << offset_
                         << ", length = " << length_;
             } else {
-                LOG(ERROR) << "file [" << fileMetric_->filename << "]"
+                LOG(ERROR) << "file [" << FileName() << "]"
                         << ", IO Error, OpType = " << OpTypeToString(type_)
                         << ", offset = " << offset_
                         << ", length = " << length_;
@@ -531,6 +685,10 @@ void IOTracker::Done() {
         }
     }
 
+    if (span_) {
+        latencyStats_->LogSpan(*span_, type_, offset_, length_);
+    }
+
     DestoryRequestList();
 
     // scc_和aioctx都为空的时候肯定是个同步调用
@@ -25,6 +25,7 @@
 #include <butil/iobuf.h>
 
 #include <atomic>
+#include <memory>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -33,11 +34,13 @@
 #include "include/curve_compiler_specific.h"
 #include "proto/chunk.pb.h"
 #include "src/client/client_common.h"
+#include "src/client/file_latency_stats.h"
 #include "src/client/io_condition_varaiable.h"
 #include "src/client/mds_client.h"
 #include "src/client/metacache.h"
 #include "src/client/request_context.h"
 #include "src/client/request_scheduler.h"
+#include "src/common/object_pool.h"
 #include "src/common/throttle.h"
 
 namespace curve {
@@ -48,11 +51,14 @@ using curve::common::Throttle;
 class IOManager;
 class FileSegment;
 class DiscardTaskManager;
+class ReadCache;
 
 // IOTracker用于跟踪一个用户IO，因为一个用户IO可能会跨chunkserver，
 // 因此在真正下发的时候会被拆分成多个小IO并发的向下发送，因此我们需要
 // 跟踪发送的request的执行情况。
-class CURVE_CACHELINE_ALIGNMENT IOTracker {
+// 每个用户IO都会分配和释放IOTracker，内存从ObjectPool中复用。
+class CURVE_CACHELINE_ALIGNMENT IOTracker
+    : public common::PoolAllocated<IOTracker> {
     friend class Splitor;
 
  public:
@@ -190,6 +196,10 @@ class CURVE_CACHELINE_ALIGNMENT IOTracker {
     // 设置操作类型，测试使用
     void SetOpType(OpType type) { type_ = type; }
 
+    off_t Offset() const { return offset_; }
+
+    uint64_t Length() const { return length_; }
+
     /**
      * 因为client的IO都是异步发送的，且一个IO被拆分成多个Request，因此在异步
      * IO返回后就应该告诉IOTracker当前request已经返回，这样tracker可以处理
@@ -226,11 +236,30 @@ class CURVE_CACHELINE_ALIGNMENT IOTracker {
         return disableStripe_;
     }
 
+    // 设置读缓存，只对只读打开的文件设置
+    void SetReadCache(ReadCache* readCache) {
+        readCache_ = readCache;
+    }
+
     static void InitDiscardOption(const DiscardOption& opt);
 
  private:
+    // 拆分出的请求使用iomanager当前的IO优先级
+    LIBCURVE_IO_PRIORITY GetIOPriority() const;
+
     void ReleaseAllSegmentLocks();
 
+    const std::string& FileName() const;
+
+    // 按采样率决定是否记录当前IO的span
+    void StartSpan();
+
+    // 拆分完成，在请求下发之前标记需要记录下发时间
+    void MarkSpanRequests();
+
+    // 子请求返回，记录其排队、rpc耗时和重试次数
+    void RecordSpan(RequestContext* reqctx);
+
     /**
      * 当IO返回的时候调用done，由done负责向上返回
      */
@@ -281,6 +310,19 @@ class CURVE_CACHELINE_ALIGNMENT IOTracker {
     int ReadFromSource(const std::vector<RequestContext*>& reqCtxVec,
                        const UserInfo_t& userInfo, MDSClient* mdsClient);
 
+    /**
+     * @brief look up the read cache for the requests of reqlist_, misses are
+     *        extended to the block boundaries so that they can fill the cache
+     * @param[out] hits requests served by the cache
+     * @param[out] others requests to schedule
+     */
+    void ReadFromCache(std::vector<RequestContext*>* hits,
+                       std::vector<RequestContext*>* others);
+
+    // put the data read by a miss to the cache, and cut it to the range
+    // requested
+    void FillReadCache(RequestContext* reqctx);
+
     // perform write operation
     void DoWrite(MDSClient* mdsclient, const FInfo_t* fileInfo,
                  const FileEpoch* fEpoch,
@@ -361,6 +403,18 @@ class CURVE_CACHELINE_ALIGNMENT IOTracker {
 
     bool disableStripe_;
 
+    // 只读文件的读缓存，为空时不使用
+    ReadCache* readCache_;
+
+    // 读缓存数据的epoch标记，在拆分请求时从metacache获取
+    uint64_t readCacheEpoch_;
+
+    // 文件级别的延迟统计，没有开启时为空
+    FileLatencyStats* latencyStats_;
+
+    // 当前IO被采样时记录的span，没有采样时为空
+    std::unique_ptr<IOSpan> span_;
+
     // read/write operations will hold segment's read lock,
     // so store corresponding segment lock and release after operations finished
     std::vector<FileSegment*> segmentLocks_;
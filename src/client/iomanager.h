@@ -32,6 +32,8 @@ namespace client {
 
 using curve::common::Atomic;
 
+class FileLatencyStats;
+
 class IOManager {
  public:
     IOManager() {
@@ -46,17 +48,35 @@ class IOManager {
         return id_;
     }
 
+    /**
+     * @brief 获取当前下发IO的优先级
+     */
+    virtual LIBCURVE_IO_PRIORITY GetIOPriority() const {
+        return LIBCURVE_IO_PRIORITY_NORMAL;
+    }
+
+    /**
+     * @brief 获取文件的延迟统计，没有开启时为空
+     */
+    virtual FileLatencyStats* GetLatencyStats() const {
+        return nullptr;
+    }
+
     /**
      * @brief 获取rpc发送令牌
+     * @param: priority为rpc所属IO的优先级
      */
-    virtual void GetInflightRpcToken() {
+    virtual void GetInflightRpcToken(LIBCURVE_IO_PRIORITY priority) {
+        (void)priority;
         return;
     }
 
     /**
      * @brief 释放rpc发送令牌
+     * @param: priority为获取令牌时的优先级
      */
-    virtual void ReleaseInflightRpcToken() {
+    virtual void ReleaseInflightRpcToken(LIBCURVE_IO_PRIORITY priority) {
+        (void)priority;
         return;
     }
 
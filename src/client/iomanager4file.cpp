@@ -22,16 +22,111 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <chrono>   // NOLINT
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <utility>
 
 #include "src/client/metacache.h"
 #include "src/client/iomanager4file.h"
 #include "src/client/file_instance.h"
 #include "src/client/io_tracker.h"
 #include "src/client/splitor.h"
+#include "src/common/concurrent/count_down_event.h"
 
 namespace curve {
 namespace client {
+
+namespace {
+
+// 内部发起的异步IO的上下文，IO返回时以ret调用done
+struct AioCallbackContext {
+    std::function<void(int)>* done;
+    CurveAioContext curveCtx;
+};
+
+void AioCallback(CurveAioContext* context) {
+    auto callbackCtx = reinterpret_cast<AioCallbackContext*>(
+        reinterpret_cast<char*>(context) -
+        offsetof(AioCallbackContext, curveCtx));
+    std::unique_ptr<std::function<void(int)>> done(callbackCtx->done);
+    int ret = context->ret;
+    delete callbackCtx;
+    (*done)(ret);
+}
+
+AioCallbackContext* NewAioCallbackContext(off_t offset, size_t length,
+                                          LIBCURVE_OP op, void* buf,
+                                          std::function<void(int)> done) {
+    AioCallbackContext* callbackCtx = new AioCallbackContext();
+    callbackCtx->done = new std::function<void(int)>(std::move(done));
+    callbackCtx->curveCtx.offset = offset;
+    callbackCtx->curveCtx.length = length;
+    callbackCtx->curveCtx.op = op;
+    callbackCtx->curveCtx.cb = AioCallback;
+    callbackCtx->curveCtx.buf = buf;
+    return callbackCtx;
+}
+
+// 把读到的数据拷贝给用户
+void CopyReadData(CurveAioContext* ctx, UserDataType dataType,
+                  const butil::IOBuf& data) {
+    switch (dataType) {
+        case UserDataType::RawBuffer:
+            data.copy_to(ctx->buf, ctx->length);
+            break;
+        case UserDataType::IOBuffer:
+            *reinterpret_cast<butil::IOBuf*>(ctx->buf) = data;
+            break;
+    }
+}
+
+// 写回日志中的数据是否覆盖了整个[offset, offset + length)
+bool CoveredByWriteBack(const std::vector<WriteBackLog::Extent>& extents,
+                        size_t length) {
+    size_t covered = 0;
+    for (const auto& extent : extents) {
+        covered += extent.data.size();
+    }
+    return covered == length;
+}
+
+// 用写回日志中的数据覆盖data中[offset, offset + length)的数据
+void OverlayWriteBack(const std::vector<WriteBackLog::Extent>& extents,
+                      off_t offset, size_t length, butil::IOBuf* data) {
+    butil::IOBuf merged;
+    off_t pos = offset;
+    for (const auto& extent : extents) {
+        if (extent.offset > pos) {
+            data->append_to(&merged, extent.offset - pos, pos - offset);
+        }
+        merged.append(extent.data);
+        pos = extent.offset + static_cast<off_t>(extent.data.size());
+    }
+    const off_t end = offset + static_cast<off_t>(length);
+    if (pos < end) {
+        data->append_to(&merged, end - pos, pos - offset);
+    }
+    *data = merged;
+}
+
+// 进程内所有低优先级文件共享的inflight rpc控制，限制备份等后台IO
+// 占用的rpc总数，为正常优先级的IO留出处理能力
+InflightControl& LowPriorityInflightControl() {
+    static InflightControl control;
+    return control;
+}
+
+// 不为每个文件注册bvar时，所有文件共用的metric，进程退出前不释放
+FileMetric& SharedFileMetric() {
+    static FileMetric* metric = new FileMetric("all_files");
+    return *metric;
+}
+
+}  // namespace
+
 Atomic<uint64_t> IOManager::idRecorder_(1);
 IOManager4File::IOManager4File() : scheduler_(nullptr), exit_(false) {}
 
@@ -48,11 +143,28 @@ bool IOManager4File::Initialize(const std::string& filename,
 
     inflightRpcCntl_.SetMaxInflightNum(
         ioopt_.ioSenderOpt.inflightOpt.fileMaxInFlightRPCNum);
+    // 进程内所有文件的配置相同，最小为1，避免低优先级IO永远无法下发
+    LowPriorityInflightControl().SetMaxInflightNum(std::max<uint64_t>(
+        1, ioopt_.ioSenderOpt.inflightOpt.lowPriorityMaxInFlightRPCNum));
+
+    const FileMetricOption& metricOpt = ioopt_.fileMetricOpt;
+    if (metricOpt.exposePerFileBvar) {
+        fileMetric_ = new (std::nothrow) FileMetric(filename);
+        if (fileMetric_ == nullptr) {
+            LOG(ERROR) << "allocate client metric failed!";
+            return false;
+        }
+    } else {
+        fileMetric_ = &SharedFileMetric();
+        ownFileMetric_ = false;
+    }
 
-    fileMetric_ = new (std::nothrow) FileMetric(filename);
-    if (fileMetric_ == nullptr) {
-        LOG(ERROR) << "allocate client metric failed!";
-        return false;
+    // 共享metric时文件级别的延迟只由latencyStats_统计
+    if (!metricOpt.exposePerFileBvar || metricOpt.latencyStatsIntervalS > 0 ||
+        metricOpt.spanSampleRate > 0) {
+        latencyStats_.reset(new FileLatencyStats(filename, metricOpt));
+        FileLatencyCollector::GetInstance().Register(latencyStats_.get());
+        FileLatencyCollector::GetInstance().Start(metricOpt);
     }
 
     // IO Manager中不控制inflight IO数量，所以传入UINT64_MAX
@@ -73,8 +185,24 @@ bool IOManager4File::Initialize(const std::string& filename,
     }
     scheduler_->Run();
 
-    if (ioopt_.throttleOption.enable) {
+    const ThrottleOption& throttleOpt = ioopt_.throttleOption;
+    std::shared_ptr<common::SharedThrottle> hostThrottle =
+        OpenSharedThrottle("host", throttleOpt.hostIopsTotalLimit,
+                           throttleOpt.hostBpsTotalLimitMB,
+                           throttleOpt.sharedBurstSeconds);
+    std::shared_ptr<common::SharedThrottle> tenantThrottle =
+        OpenSharedThrottle("tenant_" + throttleOpt.tenant,
+                           throttleOpt.tenantIopsTotalLimit,
+                           throttleOpt.tenantBpsTotalLimitMB,
+                           throttleOpt.sharedBurstSeconds);
+    if (throttleOpt.enable || hostThrottle || tenantThrottle) {
         throttle_.reset(new common::Throttle());
+        if (hostThrottle) {
+            throttle_->AddParent(std::move(hostThrottle));
+        }
+        if (tenantThrottle) {
+            throttle_->AddParent(std::move(tenantThrottle));
+        }
     }
 
     ret = taskPool_.Start(ioopt_.taskThreadOpt.isolationTaskThreadPoolSize,
@@ -85,13 +213,34 @@ bool IOManager4File::Initialize(const std::string& filename,
     }
 
     discardTaskManager_.reset(
-        new DiscardTaskManager(&(fileMetric_->discardMetric)));
+        new DiscardTaskManager(&(fileMetric_->discardMetric),
+                               ioopt_.discardOption));
+
+    if (ioopt_.readCacheOpt.enable) {
+        if (ReadCache::GetInstance().Init(ioopt_.readCacheOpt) == 0) {
+            readCache_ = &ReadCache::GetInstance();
+        } else {
+            LOG(WARNING) << "read cache init failed, disable it, filename: "
+                         << filename;
+        }
+    }
+
+    if (ioopt_.readAheadOpt.enable) {
+        readAhead_.reset(new ReadAhead(
+            ioopt_.readAheadOpt,
+            [this, mdsclient](off_t offset, size_t length,
+                              butil::IOBuf* data,
+                              ReadAhead::PrefetchDone done) {
+                Prefetch(mdsclient, offset, length, data, std::move(done));
+            }));
+    }
 
     LOG(INFO) << "iomanager init success, conf info: "
               << "isolationTaskThreadPoolSize = "
               << ioopt_.taskThreadOpt.isolationTaskThreadPoolSize
               << ", isolationTaskQueueCapacity = "
-              << ioopt_.taskThreadOpt.isolationTaskQueueCapacity;
+              << ioopt_.taskThreadOpt.isolationTaskQueueCapacity
+              << ", readAhead = " << ioopt_.readAheadOpt.enable;
     return true;
 }
 
@@ -101,6 +250,12 @@ void IOManager4File::UnInitialize() {
         throttle_->Stop();
     }
 
+    // 停止刷写回日志，等待中的写和discard都返回失败，没有刷下去的记录
+    // 留在日志中，下次打开时重新刷
+    if (writeBackLog_) {
+        writeBackLog_->Stop();
+    }
+
     bool exitFlag = false;
     std::mutex exitMtx;
     std::condition_variable exitCv;
@@ -133,11 +288,21 @@ void IOManager4File::UnInitialize() {
         std::unique_lock<std::mutex> lk(exitMtx_);
         exit_ = true;
 
+        // 预读和回退的直接读都已经返回
+        readAhead_.reset();
+        writeBackLog_.reset();
         delete scheduler_;
-        delete fileMetric_;
+        if (ownFileMetric_) {
+            delete fileMetric_;
+        }
         scheduler_ = nullptr;
         fileMetric_ = nullptr;
     }
+
+    if (latencyStats_) {
+        FileLatencyCollector::GetInstance().Unregister(latencyStats_.get());
+        latencyStats_.reset();
+    }
 }
 
 int IOManager4File::Read(char* buf, off_t offset,
@@ -147,8 +312,20 @@ int IOManager4File::Read(char* buf, off_t offset,
 
     butil::IOBuf data;
 
+    // 写回日志中没有刷下去的数据比chunkserver上的新
+    std::vector<WriteBackLog::Extent> extents;
+    if (writeBackLog_) {
+        writeBackLog_->Lookup(offset, length, &extents);
+        if (CoveredByWriteBack(extents, length)) {
+            OverlayWriteBack(extents, offset, length, &data);
+            data.copy_to(buf, length);
+            return length;
+        }
+    }
+
     IOTracker temp(this, &mc_, scheduler_, fileMetric_, disableStripe_);
     temp.SetUserDataType(UserDataType::IOBuffer);
+    temp.SetReadCache(readCache_);
     temp.StartRead(&data, offset, length, mdsclient, this->GetFileInfo(),
                    throttle_.get());
 
@@ -157,6 +334,9 @@ int IOManager4File::Read(char* buf, off_t offset,
     if (rc < 0) {
         return rc;
     } else {
+        if (!extents.empty()) {
+            OverlayWriteBack(extents, offset, length, &data);
+        }
         size_t nc = data.copy_to(buf, length);
         return nc == length ? rc : -LIBCURVE_ERROR::FAILED;
     }
@@ -167,11 +347,29 @@ int IOManager4File::Write(const char* buf,
                           size_t length,
                           MDSClient* mdsclient) {
     MetricHelper::IncremUserRPSCount(fileMetric_, OpType::WRITE);
+
+    if (writeBackLog_) {
+        common::CountDownEvent event(1);
+        int ret = 0;
+        AioCallbackContext* callbackCtx = NewAioCallbackContext(
+            offset, length, LIBCURVE_OP_WRITE, const_cast<char*>(buf),
+            [&event, &ret](int rc) {
+                ret = rc;
+                event.Signal();
+            });
+        inflightCntl_.IncremInflightNum();
+        BeginWrite(offset, length);
+        WriteBack(&callbackCtx->curveCtx, mdsclient, UserDataType::RawBuffer);
+        event.Wait();
+        return ret;
+    }
+
     FlightIOGuard guard(this);
 
     butil::IOBuf data;
     data.append_user_data(const_cast<char*>(buf), length, TrivialDeleter);
 
+    BeginWrite(offset, length);
     IOTracker temp(this, &mc_, scheduler_, fileMetric_, disableStripe_);
     temp.SetUserDataType(UserDataType::IOBuffer);
     temp.StartWrite(&data, offset, length, mdsclient, this->GetFileInfo(),
@@ -179,6 +377,7 @@ int IOManager4File::Write(const char* buf,
                     throttle_.get());
 
     int rc = temp.Wait();
+    EndWrite(offset, length);
     return rc;
 }
 
@@ -186,6 +385,24 @@ int IOManager4File::AioRead(CurveAioContext* ctx, MDSClient* mdsclient,
                             UserDataType dataType) {
     MetricHelper::IncremUserRPSCount(fileMetric_, OpType::READ);
 
+    if (writeBackLog_) {
+        inflightCntl_.IncremInflightNum();
+        auto task = [this, ctx, mdsclient, dataType]() {
+            ReadWithWriteBack(ctx, mdsclient, dataType);
+        };
+        taskPool_.Enqueue(task);
+        return LIBCURVE_ERROR::OK;
+    }
+
+    if (readAhead_) {
+        inflightCntl_.IncremInflightNum();
+        auto task = [this, ctx, mdsclient, dataType]() {
+            ReadWithReadAhead(ctx, mdsclient, dataType);
+        };
+        taskPool_.Enqueue(task);
+        return LIBCURVE_ERROR::OK;
+    }
+
     IOTracker* temp = new (std::nothrow)
         IOTracker(this, &mc_, scheduler_, fileMetric_, disableStripe_);
     if (temp == nullptr) {
@@ -196,6 +413,7 @@ int IOManager4File::AioRead(CurveAioContext* ctx, MDSClient* mdsclient,
     }
 
     temp->SetUserDataType(dataType);
+    temp->SetReadCache(readCache_);
     inflightCntl_.IncremInflightNum();
     auto task = [this, ctx, mdsclient, temp]() {
         temp->StartAioRead(ctx, mdsclient, this->GetFileInfo(),
@@ -210,6 +428,16 @@ int IOManager4File::AioWrite(CurveAioContext* ctx, MDSClient* mdsclient,
                              UserDataType dataType) {
     MetricHelper::IncremUserRPSCount(fileMetric_, OpType::WRITE);
 
+    if (writeBackLog_) {
+        inflightCntl_.IncremInflightNum();
+        BeginWrite(ctx->offset, ctx->length);
+        auto task = [this, ctx, mdsclient, dataType]() {
+            WriteBack(ctx, mdsclient, dataType);
+        };
+        taskPool_.Enqueue(task);
+        return LIBCURVE_ERROR::OK;
+    }
+
     IOTracker* temp = new (std::nothrow)
         IOTracker(this, &mc_, scheduler_, fileMetric_, disableStripe_);
     if (temp == nullptr) {
@@ -221,6 +449,7 @@ int IOManager4File::AioWrite(CurveAioContext* ctx, MDSClient* mdsclient,
 
     temp->SetUserDataType(dataType);
     inflightCntl_.IncremInflightNum();
+    BeginWrite(ctx->offset, ctx->length);
     auto task = [this, ctx, mdsclient, temp]() {
         temp->StartAioWrite(ctx, mdsclient, this->GetFileInfo(),
                             this->GetFileEpoch(),
@@ -240,10 +469,18 @@ int IOManager4File::Discard(off_t offset, size_t length, MDSClient* mdsclient) {
 
     FlightIOGuard guard(this);
 
+    // 之前写入的数据刷下去之后再discard，避免被之后刷下去的数据覆盖
+    if (writeBackLog_ && WaitWriteBack() != 0) {
+        return -LIBCURVE_ERROR::FAILED;
+    }
+
+    BeginWrite(offset, length);
     IOTracker tracker(this, &mc_, scheduler_, fileMetric_);
     tracker.StartDiscard(offset, length, mdsclient, GetFileInfo(),
                          discardTaskManager_.get());
-    return tracker.Wait();
+    int rc = tracker.Wait();
+    EndWrite(offset, length);
+    return rc;
 }
 
 int IOManager4File::AioDiscard(CurveAioContext* aioctx, MDSClient* mdsclient) {
@@ -266,19 +503,105 @@ int IOManager4File::AioDiscard(CurveAioContext* aioctx, MDSClient* mdsclient) {
     }
 
     inflightCntl_.IncremInflightNum();
+    BeginWrite(aioctx->offset, aioctx->length);
     auto task = [this, aioctx, mdsclient, ioTracker]() {
         ioTracker->StartAioDiscard(aioctx, mdsclient, this->GetFileInfo(),
                                    discardTaskManager_.get());
     };
 
+    if (writeBackLog_) {
+        writeBackLog_->Barrier([this, aioctx, ioTracker, task](int ret) {
+            if (ret == 0) {
+                taskPool_.Enqueue(task);
+                return;
+            }
+            aioctx->ret = -LIBCURVE_ERROR::FAILED;
+            aioctx->cb(aioctx);
+            EndWrite(aioctx->offset, aioctx->length);
+            inflightCntl_.DecremInflightNum();
+            delete ioTracker;
+        });
+        return LIBCURVE_ERROR::OK;
+    }
+
     taskPool_.Enqueue(task);
     return LIBCURVE_ERROR::OK;
 }
 
+int IOManager4File::OpenWriteBackLog(MDSClient* mdsclient) {
+    const WriteBackLogOption& option = ioopt_.writeBackLogOpt;
+    if (!option.enable) {
+        return 0;
+    }
+
+    const std::string& filename = GetFileInfo()->fullPathName;
+    std::string logName = filename;
+    std::replace(logName.begin(), logName.end(), '/', '_');
+    const std::string path = option.dir + "/" + logName + ".wblog";
+
+    std::unique_ptr<WriteBackLog> log(new WriteBackLog(
+        option, [this, mdsclient](off_t offset, const butil::IOBuf& data,
+                                  WriteBackLog::Done done) {
+            FlushWriteBack(mdsclient, offset, data, std::move(done));
+        }));
+    std::vector<std::pair<off_t, size_t>> replayed;
+    if (log->Open(path, filename, &replayed) != 0) {
+        LOG(ERROR) << "open write back log failed, filename: " << filename
+                   << ", path: " << path;
+        return -1;
+    }
+
+    if (!replayed.empty()) {
+        LOG(INFO) << "write back log of " << filename << " has "
+                  << replayed.size() << " records not flushed, flush them";
+    }
+    writeBackLog_ = std::move(log);
+    writeBackLog_->Start();
+    return 0;
+}
+
+int IOManager4File::CloseWriteBackLog() {
+    if (!writeBackLog_) {
+        return 0;
+    }
+
+    int ret = writeBackLog_->Close();
+    if (ret != 0) {
+        LOG(ERROR) << "close write back log failed, records not flushed are "
+                   << "kept, filename: " << GetFileInfo()->fullPathName;
+    }
+    return ret;
+}
+
 void IOManager4File::UpdateFileInfo(const FInfo_t& fi) {
     mc_.UpdateFileInfo(fi);
 }
 
+std::shared_ptr<common::SharedThrottle> IOManager4File::OpenSharedThrottle(
+    const std::string& name, uint64_t iopsLimit, uint64_t bpsLimitMB,
+    uint64_t burstSeconds) {
+    if (iopsLimit == 0 && bpsLimitMB == 0) {
+        return nullptr;
+    }
+
+    auto throttle = common::SharedThrottle::Open(name);
+    if (throttle == nullptr) {
+        LOG(WARNING) << "open shared throttle " << name
+                     << " failed, disable it";
+        return nullptr;
+    }
+
+    // the credits of burstSeconds at 2 * limit is burstSeconds of limit
+    common::ReadWriteThrottleParams params;
+    params.iopsTotal = common::ThrottleParams(iopsLimit, 2 * iopsLimit,
+                                              burstSeconds);
+    const uint64_t bpsLimit = bpsLimitMB * 1024 * 1024;
+    params.bpsTotal = common::ThrottleParams(bpsLimit, 2 * bpsLimit,
+                                             burstSeconds);
+    throttle->UpdateThrottleParams(params);
+    return throttle;
+}
+
 void IOManager4File::UpdateFileThrottleParams(
     const common::ReadWriteThrottleParams& params) {
     if (throttle_) {
@@ -291,10 +614,240 @@ void IOManager4File::SetDisableStripe() {
 }
 
 void IOManager4File::HandleAsyncIOResponse(IOTracker* iotracker) {
+    if (iotracker->Optype() == OpType::WRITE ||
+        iotracker->Optype() == OpType::DISCARD) {
+        EndWrite(iotracker->Offset(), iotracker->Length());
+    }
     inflightCntl_.DecremInflightNum();
     delete iotracker;
 }
 
+void IOManager4File::ReadWithoutReadAhead(CurveAioContext* ctx,
+                                          MDSClient* mdsclient,
+                                          UserDataType dataType) {
+    IOTracker* temp = new (std::nothrow)
+        IOTracker(this, &mc_, scheduler_, fileMetric_, disableStripe_);
+    if (temp == nullptr) {
+        ctx->ret = -LIBCURVE_ERROR::FAILED;
+        ctx->cb(ctx);
+        inflightCntl_.DecremInflightNum();
+        LOG(ERROR) << "allocate tracker failed!";
+        return;
+    }
+
+    temp->SetUserDataType(dataType);
+    temp->SetReadCache(readCache_);
+    temp->StartAioRead(ctx, mdsclient, this->GetFileInfo(), throttle_.get());
+}
+
+void IOManager4File::ReadWithReadAhead(CurveAioContext* ctx,
+                                       MDSClient* mdsclient,
+                                       UserDataType dataType) {
+    // 预读失败或者被写覆盖时，在预读返回的线程中直接读
+    auto done = [this, ctx, mdsclient, dataType](const butil::IOBuf* data) {
+        if (data != nullptr) {
+            CompleteRead(ctx, dataType, *data);
+        } else {
+            ReadWithoutReadAhead(ctx, mdsclient, dataType);
+        }
+    };
+
+    if (!readAhead_->Read(ctx->offset, ctx->length, GetFileInfo()->length,
+                          done)) {
+        ReadWithoutReadAhead(ctx, mdsclient, dataType);
+    }
+}
+
+void IOManager4File::CompleteRead(CurveAioContext* ctx, UserDataType dataType,
+                                  const butil::IOBuf& data) {
+    CopyReadData(ctx, dataType, data);
+    fileMetric_->readAheadMetric.hitBytes << ctx->length;
+
+    ctx->ret = ctx->length;
+    ctx->cb(ctx);
+    inflightCntl_.DecremInflightNum();
+}
+
+void IOManager4File::Prefetch(MDSClient* mdsclient, off_t offset,
+                              size_t length, butil::IOBuf* data,
+                              ReadAhead::PrefetchDone done) {
+    IOTracker* temp = new (std::nothrow)
+        IOTracker(this, &mc_, scheduler_, fileMetric_, disableStripe_);
+    if (temp == nullptr) {
+        LOG(ERROR) << "allocate tracker failed!";
+        done(-LIBCURVE_ERROR::FAILED);
+        return;
+    }
+
+    AioCallbackContext* prefetchCtx = NewAioCallbackContext(
+        offset, length, LIBCURVE_OP_READ, data, std::move(done));
+    fileMetric_->readAheadMetric.prefetchBytes << length;
+
+    temp->SetUserDataType(UserDataType::IOBuffer);
+    temp->SetReadCache(readCache_);
+    inflightCntl_.IncremInflightNum();
+    temp->StartAioRead(&prefetchCtx->curveCtx, mdsclient, this->GetFileInfo(),
+                       throttle_.get());
+}
+
+void IOManager4File::WriteBack(CurveAioContext* ctx, MDSClient* mdsclient,
+                               UserDataType dataType) {
+    // 用户的buffer在返回后就可能被复用，写回日志保留一份拷贝
+    butil::IOBuf data;
+    switch (dataType) {
+        case UserDataType::RawBuffer:
+            data.append(ctx->buf, ctx->length);
+            break;
+        case UserDataType::IOBuffer:
+            data = *reinterpret_cast<const butil::IOBuf*>(ctx->buf);
+            break;
+    }
+
+    // 日志写失败或者写太大时，之前的记录刷下去之后直接写，保证写的顺序
+    auto writeThrough = [this, ctx, mdsclient, dataType]() {
+        writeBackLog_->Barrier([this, ctx, mdsclient, dataType](int ret) {
+            if (ret == 0) {
+                taskPool_.Enqueue([this, ctx, mdsclient, dataType]() {
+                    WriteThrough(ctx, mdsclient, dataType);
+                });
+                return;
+            }
+            ctx->ret = -LIBCURVE_ERROR::FAILED;
+            ctx->cb(ctx);
+            EndWrite(ctx->offset, ctx->length);
+            inflightCntl_.DecremInflightNum();
+        });
+    };
+
+    auto done = [this, ctx, writeThrough](int ret) {
+        if (ret != 0) {
+            LOG(WARNING) << "append write back log failed, write through, "
+                         << "offset: " << ctx->offset
+                         << ", length: " << ctx->length;
+            writeThrough();
+            return;
+        }
+        ctx->ret = ctx->length;
+        ctx->cb(ctx);
+        EndWrite(ctx->offset, ctx->length);
+        inflightCntl_.DecremInflightNum();
+    };
+
+    if (!writeBackLog_->Append(ctx->offset, data, done)) {
+        writeThrough();
+    }
+}
+
+void IOManager4File::WriteThrough(CurveAioContext* ctx, MDSClient* mdsclient,
+                                  UserDataType dataType) {
+    IOTracker* temp = new (std::nothrow)
+        IOTracker(this, &mc_, scheduler_, fileMetric_, disableStripe_);
+    if (temp == nullptr) {
+        ctx->ret = -LIBCURVE_ERROR::FAILED;
+        ctx->cb(ctx);
+        EndWrite(ctx->offset, ctx->length);
+        inflightCntl_.DecremInflightNum();
+        LOG(ERROR) << "allocate tracker failed!";
+        return;
+    }
+
+    temp->SetUserDataType(dataType);
+    temp->StartAioWrite(ctx, mdsclient, this->GetFileInfo(),
+                        this->GetFileEpoch(), throttle_.get());
+}
+
+void IOManager4File::ReadWithWriteBack(CurveAioContext* ctx,
+                                       MDSClient* mdsclient,
+                                       UserDataType dataType) {
+    std::vector<WriteBackLog::Extent> extents;
+    writeBackLog_->Lookup(ctx->offset, ctx->length, &extents);
+    if (extents.empty()) {
+        if (readAhead_) {
+            ReadWithReadAhead(ctx, mdsclient, dataType);
+        } else {
+            ReadWithoutReadAhead(ctx, mdsclient, dataType);
+        }
+        return;
+    }
+
+    if (CoveredByWriteBack(extents, ctx->length)) {
+        butil::IOBuf data;
+        OverlayWriteBack(extents, ctx->offset, ctx->length, &data);
+        CopyReadData(ctx, dataType, data);
+        ctx->ret = ctx->length;
+        ctx->cb(ctx);
+        inflightCntl_.DecremInflightNum();
+        return;
+    }
+
+    IOTracker* temp = new (std::nothrow)
+        IOTracker(this, &mc_, scheduler_, fileMetric_, disableStripe_);
+    if (temp == nullptr) {
+        ctx->ret = -LIBCURVE_ERROR::FAILED;
+        ctx->cb(ctx);
+        inflightCntl_.DecremInflightNum();
+        LOG(ERROR) << "allocate tracker failed!";
+        return;
+    }
+
+    // 读到的数据用写回日志中的数据覆盖之后再拷贝给用户
+    std::shared_ptr<butil::IOBuf> data = std::make_shared<butil::IOBuf>();
+    std::shared_ptr<std::vector<WriteBackLog::Extent>> overlay =
+        std::make_shared<std::vector<WriteBackLog::Extent>>(
+            std::move(extents));
+    AioCallbackContext* callbackCtx = NewAioCallbackContext(
+        ctx->offset, ctx->length, LIBCURVE_OP_READ, data.get(),
+        [ctx, dataType, data, overlay](int ret) {
+            if (ret >= 0) {
+                OverlayWriteBack(*overlay, ctx->offset, ctx->length,
+                                 data.get());
+                CopyReadData(ctx, dataType, *data);
+            }
+            ctx->ret = ret;
+            ctx->cb(ctx);
+        });
+
+    temp->SetUserDataType(UserDataType::IOBuffer);
+    temp->SetReadCache(readCache_);
+    temp->StartAioRead(&callbackCtx->curveCtx, mdsclient, this->GetFileInfo(),
+                       throttle_.get());
+}
+
+void IOManager4File::FlushWriteBack(MDSClient* mdsclient, off_t offset,
+                                    const butil::IOBuf& data,
+                                    WriteBackLog::Done done) {
+    IOTracker* temp = new (std::nothrow)
+        IOTracker(this, &mc_, scheduler_, fileMetric_, disableStripe_);
+    if (temp == nullptr) {
+        LOG(ERROR) << "allocate tracker failed!";
+        done(-LIBCURVE_ERROR::FAILED);
+        return;
+    }
+
+    // IOTracker下发时拷贝了data，刷写期间不预读这段数据，避免缓存旧数据
+    AioCallbackContext* callbackCtx = NewAioCallbackContext(
+        offset, data.size(), LIBCURVE_OP_WRITE,
+        const_cast<butil::IOBuf*>(&data),
+        [done](int ret) { done(ret < 0 ? ret : 0); });
+
+    temp->SetUserDataType(UserDataType::IOBuffer);
+    inflightCntl_.IncremInflightNum();
+    BeginWrite(offset, data.size());
+    temp->StartAioWrite(&callbackCtx->curveCtx, mdsclient, this->GetFileInfo(),
+                        this->GetFileEpoch(), throttle_.get());
+}
+
+int IOManager4File::WaitWriteBack() {
+    common::CountDownEvent event(1);
+    int ret = 0;
+    writeBackLog_->Barrier([&event, &ret](int rc) {
+        ret = rc;
+        event.Signal();
+    });
+    event.Wait();
+    return ret;
+}
+
 bool IOManager4File::IsNeedDiscard(size_t len) const {
     if (ioopt_.discardOption.enable &&
         len >= ioopt_.metaCacheOpt.discardGranularity) {
@@ -322,12 +875,18 @@ void IOManager4File::ResumeIO() {
     }
 }
 
-void IOManager4File::ReleaseInflightRpcToken() {
+void IOManager4File::ReleaseInflightRpcToken(LIBCURVE_IO_PRIORITY priority) {
+    if (priority == LIBCURVE_IO_PRIORITY_LOW) {
+        LowPriorityInflightControl().ReleaseInflightToken();
+    }
     inflightRpcCntl_.ReleaseInflightToken();
 }
 
-void IOManager4File::GetInflightRpcToken() {
+void IOManager4File::GetInflightRpcToken(LIBCURVE_IO_PRIORITY priority) {
     inflightRpcCntl_.GetInflightToken();
+    if (priority == LIBCURVE_IO_PRIORITY_LOW) {
+        LowPriorityInflightControl().GetInflightToken();
+    }
 }
 
 }   // namespace client
@@ -31,6 +31,7 @@
 #include <mutex>               // NOLINT
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "include/curve_compiler_specific.h"
 #include "src/client/client_common.h"
@@ -41,8 +42,13 @@
 #include "src/client/request_scheduler.h"
 #include "src/common/concurrent/concurrent.h"
 #include "src/common/concurrent/task_thread_pool.h"
+#include "src/common/shared_throttle.h"
 #include "src/common/throttle.h"
 #include "src/client/discard_task.h"
+#include "src/client/file_latency_stats.h"
+#include "src/client/read_ahead.h"
+#include "src/client/read_cache.h"
+#include "src/client/write_back_log.h"
 
 namespace curve {
 namespace client {
@@ -128,14 +134,44 @@ class IOManager4File : public IOManager {
     int AioDiscard(CurveAioContext* aioctx, MDSClient* mdsclient);
 
     /**
-     * @brief 获取rpc发送令牌
+     * @brief 开启写回日志时打开文件的写回日志，文件打开成功后调用，
+     *        上次没有刷到chunkserver的记录在后台重新刷
+     * @param mdsclient 刷写回日志时透传给底层
+     * @return 0为成功，-1为失败，此时文件不能打开
      */
-    void GetInflightRpcToken() override;
+    int OpenWriteBackLog(MDSClient* mdsclient);
+
+    /**
+     * @brief 把写回日志中的记录都刷到chunkserver并关闭日志，关闭文件前调用
+     * @return 0为成功，-1为有记录没有刷下去，它们留在日志中
+     */
+    int CloseWriteBackLog();
+
+    /**
+     * @brief 设置之后下发IO的优先级
+     */
+    void SetIOPriority(LIBCURVE_IO_PRIORITY priority) {
+        priority_.store(priority, std::memory_order_relaxed);
+    }
+
+    LIBCURVE_IO_PRIORITY GetIOPriority() const override {
+        return priority_.load(std::memory_order_relaxed);
+    }
+
+    FileLatencyStats* GetLatencyStats() const override {
+        return latencyStats_.get();
+    }
+
+    /**
+     * @brief 获取rpc发送令牌，低优先级的rpc还需要获取进程内
+     *        所有低优先级文件共享的令牌
+     */
+    void GetInflightRpcToken(LIBCURVE_IO_PRIORITY priority) override;
 
     /**
      * @brief 释放rpc发送令牌
      */
-    void ReleaseInflightRpcToken() override;
+    void ReleaseInflightRpcToken(LIBCURVE_IO_PRIORITY priority) override;
 
     /**
      * 获取metacache，测试代码使用
@@ -260,6 +296,78 @@ class IOManager4File : public IOManager {
 
     bool IsNeedDiscard(size_t len) const;
 
+    /**
+     * 打开本机共享的限流并更新其参数, limit都为0时不限流, 返回nullptr
+     */
+    static std::shared_ptr<common::SharedThrottle> OpenSharedThrottle(
+        const std::string& name, uint64_t iopsLimit, uint64_t bpsLimitMB,
+        uint64_t burstSeconds);
+
+    /**
+     * 不经过预读直接读，inflight IO计数已经增加
+     */
+    void ReadWithoutReadAhead(CurveAioContext* ctx, MDSClient* mdsclient,
+                              UserDataType dataType);
+
+    /**
+     * 优先从预读的数据中读，没有预读到时直接读
+     */
+    void ReadWithReadAhead(CurveAioContext* ctx, MDSClient* mdsclient,
+                           UserDataType dataType);
+
+    /**
+     * 用预读的数据完成用户的读请求
+     */
+    void CompleteRead(CurveAioContext* ctx, UserDataType dataType,
+                      const butil::IOBuf& data);
+
+    /**
+     * 预读[offset, offset + length)到data中
+     */
+    void Prefetch(MDSClient* mdsclient, off_t offset, size_t length,
+                  butil::IOBuf* data, ReadAhead::PrefetchDone done);
+
+    /**
+     * 写入写回日志，inflight IO计数已经增加，BeginWrite已经调用
+     */
+    void WriteBack(CurveAioContext* ctx, MDSClient* mdsclient,
+                   UserDataType dataType);
+
+    /**
+     * 不经过写回日志直接写，inflight IO计数已经增加
+     */
+    void WriteThrough(CurveAioContext* ctx, MDSClient* mdsclient,
+                      UserDataType dataType);
+
+    /**
+     * 读数据并用写回日志中没有刷下去的数据覆盖，inflight IO计数已经增加
+     */
+    void ReadWithWriteBack(CurveAioContext* ctx, MDSClient* mdsclient,
+                           UserDataType dataType);
+
+    /**
+     * 把写回日志中的一条记录写到chunkserver
+     */
+    void FlushWriteBack(MDSClient* mdsclient, off_t offset,
+                        const butil::IOBuf& data, WriteBackLog::Done done);
+
+    /**
+     * 等待写回日志中已有的记录都刷下去，0为成功
+     */
+    int WaitWriteBack();
+
+    void BeginWrite(off_t offset, size_t length) {
+        if (readAhead_) {
+            readAhead_->BeginWrite(offset, length);
+        }
+    }
+
+    void EndWrite(off_t offset, size_t length) {
+        if (readAhead_) {
+            readAhead_->EndWrite(offset, length);
+        }
+    }
+
  private:
     // 每个IOManager都有其IO配置，保存在iooption里
     IOOption ioopt_;
@@ -283,6 +391,9 @@ class IOManager4File : public IOManager {
     // inflight rpc控制
     InflightControl inflightRpcCntl_;
 
+    // 当前下发IO的优先级
+    std::atomic<LIBCURVE_IO_PRIORITY> priority_{LIBCURVE_IO_PRIORITY_NORMAL};
+
     std::unique_ptr<common::Throttle> throttle_;
 
     // 是否退出
@@ -306,6 +417,21 @@ class IOManager4File : public IOManager {
     bool disableStripe_;
 
     std::unique_ptr<DiscardTaskManager> discardTaskManager_;
+
+    // 顺序读的预读，没有开启时为空
+    std::unique_ptr<ReadAhead> readAhead_;
+
+    // 只读文件的读缓存，进程内所有文件共享，没有开启时为空
+    ReadCache* readCache_ = nullptr;
+
+    // 可写文件的写回日志，没有开启时为空
+    std::unique_ptr<WriteBackLog> writeBackLog_;
+
+    // 没有为每个文件注册bvar时，fileMetric_是所有文件共享的，不能释放
+    bool ownFileMetric_ = true;
+
+    // 文件级别的延迟分位值统计和span采样，没有开启时为空
+    std::unique_ptr<FileLatencyStats> latencyStats_;
 };
 
 }  // namespace client
@@ -21,6 +21,9 @@
  */
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <utility>
+
 #include "src/common/timeutility.h"
 #include "src/client/lease_executor.h"
 #include "src/client/service_helper.h"
@@ -31,7 +34,8 @@ namespace curve {
 namespace client {
 LeaseExecutor::LeaseExecutor(const LeaseOption& leaseOpt,
                              const UserInfo& userinfo, MDSClient* mdsclient,
-                             IOManager4File* iomanager)
+                             IOManager4File* iomanager,
+                             LeaseRefresher* refresher)
     : fullFileName_(),
       mdsclient_(mdsclient),
       userinfo_(userinfo),
@@ -40,9 +44,14 @@ LeaseExecutor::LeaseExecutor(const LeaseOption& leaseOpt,
       leasesession_(),
       isleaseAvaliable_(true),
       failedrefreshcount_(0),
-      task_() {}
+      task_(),
+      refresher_(refresher),
+      batched_(false) {}
 
 LeaseExecutor::~LeaseExecutor() {
+    if (batched_) {
+        refresher_->Remove(this);
+    }
     if (task_) {
         task_->Stop();
         task_->WaitTaskExit();
@@ -69,6 +78,14 @@ bool LeaseExecutor::Start(const FInfo_t& fi, const LeaseSession_t& lease) {
     auto interval =
         leasesession_.leaseTime / leaseoption_.mdsRefreshTimesPerLease;
 
+    if (refresher_ != nullptr && refresher_->Add(this, interval)) {
+        batched_ = true;
+        LOG(INFO) << "LeaseExecutor for " << fullFileName_
+                  << " started in batch, lease interval is " << interval
+                  << " us";
+        return true;
+    }
+
     task_.reset(new (std::nothrow) RefreshSessionTask(this, interval));
     if (task_ == nullptr) {
         LOG(ERROR) << "Allocate RefreshSessionTask failed, filename = "
@@ -86,15 +103,23 @@ bool LeaseExecutor::Start(const FInfo_t& fi, const LeaseSession_t& lease) {
 }
 
 bool LeaseExecutor::RefreshLease() {
-    if (!LeaseValid()) {
-        LOG(INFO) << "lease not valid!";
-        iomanager_->LeaseTimeoutBlockIO();
-    }
+    BeforeRefresh();
 
     LeaseRefreshResult response;
     LIBCURVE_ERROR ret = mdsclient_->RefreshSession(
         fullFileName_, userinfo_, leasesession_.sessionID, &response);
+    return OnRefreshed(ret, response);
+}
 
+void LeaseExecutor::BeforeRefresh() {
+    if (!LeaseValid()) {
+        LOG(INFO) << "lease not valid!";
+        iomanager_->LeaseTimeoutBlockIO();
+    }
+}
+
+bool LeaseExecutor::OnRefreshed(LIBCURVE_ERROR ret,
+                                const LeaseRefreshResult& response) {
     if (LIBCURVE_ERROR::FAILED == ret) {
         LOG(WARNING) << "Refresh session rpc failed, filename = "
                      << fullFileName_;
@@ -138,6 +163,11 @@ bool LeaseExecutor::RefreshLease() {
 }
 
 void LeaseExecutor::Stop() {
+    if (batched_) {
+        refresher_->Remove(this);
+        LOG(INFO) << "LeaseExecutor for " << fullFileName_ << " stopped";
+    }
+
     if (task_ != nullptr) {
         task_->Stop();
 
@@ -203,5 +233,110 @@ void LeaseExecutor::ResetRefreshSessionTask() {
     isleaseAvaliable_.store(true);
 }
 
+LeaseRefresher::LeaseRefresher(const LeaseOption& leaseOpt,
+                               MDSClient* mdsclient)
+    : leaseoption_(leaseOpt),
+      mdsclient_(mdsclient),
+      executors_(),
+      nextId_(0),
+      task_() {}
+
+LeaseRefresher::~LeaseRefresher() {
+    std::unique_ptr<RefreshSessionTask> task;
+    {
+        std::lock_guard<bthread::Mutex> lk(mtx_);
+        task = std::move(task_);
+    }
+    if (task) {
+        task->Stop();
+        task->WaitTaskExit();
+    }
+}
+
+bool LeaseRefresher::Add(LeaseExecutor* executor, uint64_t intervalUs) {
+    std::lock_guard<bthread::Mutex> lk(mtx_);
+    if (task_ == nullptr) {
+        task_.reset(new (std::nothrow) RefreshSessionTask(this, intervalUs));
+        if (task_ == nullptr) {
+            LOG(ERROR) << "Allocate RefreshSessionTask failed";
+            return false;
+        }
+        timespec abstime = butil::microseconds_from_now(intervalUs);
+        brpc::PeriodicTaskManager::StartTaskAt(task_.get(), abstime);
+        LOG(INFO) << "LeaseRefresher started, lease interval is "
+                  << intervalUs << " us";
+    } else if (task_->RefreshIntervalUs() != intervalUs) {
+        LOG(WARNING) << "lease interval " << intervalUs
+                     << " us is different from the batch interval "
+                     << task_->RefreshIntervalUs() << " us";
+        return false;
+    }
+
+    executors_[executor] = ++nextId_;
+    return true;
+}
+
+void LeaseRefresher::Remove(LeaseExecutor* executor) {
+    std::lock_guard<bthread::Mutex> lk(mtx_);
+    executors_.erase(executor);
+}
+
+bool LeaseRefresher::RefreshLease() {
+    std::vector<Member> members;
+    std::vector<SessionToRefresh> sessions;
+    {
+        std::lock_guard<bthread::Mutex> lk(mtx_);
+        members.reserve(executors_.size());
+        sessions.reserve(executors_.size());
+        for (const auto& e : executors_) {
+            e.first->BeforeRefresh();
+            members.push_back(e);
+            sessions.push_back(e.first->GetSession());
+        }
+    }
+
+    const size_t batchSize =
+        std::max<size_t>(leaseoption_.maxBatchRefreshSize, 1);
+    for (size_t begin = 0; begin < sessions.size(); begin += batchSize) {
+        size_t end = std::min(begin + batchSize, sessions.size());
+        RefreshBatch(
+            std::vector<Member>(members.begin() + begin,
+                                members.begin() + end),
+            std::vector<SessionToRefresh>(sessions.begin() + begin,
+                                          sessions.begin() + end));
+    }
+    return true;
+}
+
+void LeaseRefresher::RefreshBatch(
+    const std::vector<Member>& members,
+    const std::vector<SessionToRefresh>& sessions) {
+    // 不持锁发送rpc，文件在此期间可以加入或退出
+    std::vector<LIBCURVE_ERROR> rets;
+    std::vector<LeaseRefreshResult> resps;
+    LIBCURVE_ERROR ret = mdsclient_->BatchRefreshSession(sessions, &rets,
+                                                         &resps);
+    if (ret != LIBCURVE_ERROR::OK) {
+        LOG(WARNING) << "Batch refresh session rpc failed, sessions = "
+                     << sessions.size();
+        rets.assign(sessions.size(), LIBCURVE_ERROR::FAILED);
+        resps.assign(sessions.size(), LeaseRefreshResult());
+    }
+
+    std::lock_guard<bthread::Mutex> lk(mtx_);
+    for (size_t i = 0; i < members.size(); ++i) {
+        auto iter = executors_.find(members[i].first);
+        if (iter == executors_.end() || iter->second != members[i].second) {
+            // 已经退出，或者退出后又重新加入了
+            continue;
+        }
+
+        if (!iter->first->OnRefreshed(rets[i], resps[i])) {
+            // session不存在，不再续约
+            executors_.erase(iter);
+        }
+    }
+}
+
 }   // namespace client
 }   // namespace curve
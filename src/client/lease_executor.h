@@ -27,8 +27,11 @@
 #include <bthread/condition_variable.h>
 #include <bthread/mutex.h>
 
+#include <map>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "src/client/client_common.h"
 #include "src/client/client_config.h"
@@ -39,6 +42,7 @@ namespace curve {
 namespace client {
 
 class RefreshSessionTask;
+class LeaseRefresher;
 
 /**
  * lease refresh结果，session如果不存在就不需要再续约
@@ -75,9 +79,11 @@ class LeaseExecutor : public LeaseExecutorBase {
      * @param: leaseopt为当前lease续约的option配置
      * @param: mdsclient是与mds续约的client
      * @param: iomanager会在续约失败或者版本变更的时候进行io调度
+     * @param: refresher不为空时由refresher与其他文件一起批量续约
      */
     LeaseExecutor(const LeaseOption& leaseOpt, const UserInfo& userinfo,
-                  MDSClient* mdscllent, IOManager4File* iomanager);
+                  MDSClient* mdscllent, IOManager4File* iomanager,
+                  LeaseRefresher* refresher = nullptr);
 
     ~LeaseExecutor();
 
@@ -115,6 +121,27 @@ class LeaseExecutor : public LeaseExecutorBase {
      */
     bool RefreshLease() override;
 
+    /**
+     * @brief 续约前检查lease，lease已失效则block io
+     */
+    void BeforeRefresh();
+
+    /**
+     * @brief 处理续约结果
+     * @param: ret是续约rpc的返回值
+     * @param: response是续约结果
+     * @return 是否继续续约
+     */
+    bool OnRefreshed(LIBCURVE_ERROR ret, const LeaseRefreshResult& response);
+
+    /**
+     * @brief 批量续约使用的session信息
+     */
+    SessionToRefresh GetSession() const {
+        return SessionToRefresh{fullFileName_, userinfo_,
+                                leasesession_.sessionID};
+    }
+
     /**
      * @brief 测试使用，重置refresh session task
      */
@@ -161,6 +188,68 @@ class LeaseExecutor : public LeaseExecutorBase {
 
     // refresh session定时任务，会间隔固定时间执行一次
     std::unique_ptr<RefreshSessionTask> task_;
+
+    // 批量续约，为空或者加入失败时由task_单独续约
+    LeaseRefresher*         refresher_;
+
+    // 当前是否由refresher_续约
+    bool                    batched_;
+};
+
+/**
+ * 一个client打开的所有文件通过LeaseRefresher批量续约，
+ * 每个续约周期只向mds发送一个BatchRefreshSession rpc，
+ * 而不是每个文件一个RefreshSession rpc
+ */
+class LeaseRefresher : public LeaseExecutorBase {
+ public:
+    LeaseRefresher(const LeaseOption& leaseOpt, MDSClient* mdsclient);
+
+    ~LeaseRefresher();
+
+    /**
+     * @brief 加入批量续约
+     * @param: executor是要续约的文件
+     * @param: intervalUs是文件的续约间隔，
+     *         mds给所有文件的lease时间相同，所以第一个文件决定了续约周期
+     * @return 续约间隔与当前周期不同时返回false，由文件自己续约
+     */
+    bool Add(LeaseExecutor* executor, uint64_t intervalUs);
+
+    /**
+     * @brief 退出批量续约，返回后refresher不会再访问executor
+     */
+    void Remove(LeaseExecutor* executor);
+
+    /**
+     * @brief 为所有文件续约
+     * @return 始终返回true，持续执行续约任务
+     */
+    bool RefreshLease() override;
+
+ private:
+    // 文件及其加入时分配的id
+    using Member = std::pair<LeaseExecutor*, uint64_t>;
+
+    // 批量续约一组文件，members与sessions一一对应
+    void RefreshBatch(const std::vector<Member>& members,
+                      const std::vector<SessionToRefresh>& sessions);
+
+ private:
+    LeaseOption leaseoption_;
+
+    MDSClient* mdsclient_;
+
+    // 保护executors_和task_
+    bthread::Mutex mtx_;
+
+    // 文件及其加入时分配的id，
+    // 续约rpc返回时通过id判断文件在此期间是否退出后又重新加入
+    std::map<LeaseExecutor*, uint64_t> executors_;
+
+    uint64_t nextId_;
+
+    std::unique_ptr<RefreshSessionTask> task_;
 };
 
 // RefreshSessin定期任务
@@ -182,6 +182,11 @@ int FileClient::Init(const std::string& configpath) {
 
     mdsClient_ = std::move(tmpMdsClient);
 
+    if (fileSvcOpts.leaseOpt.enableBatchRefresh) {
+        leaseRefresher_.reset(
+            new LeaseRefresher(fileSvcOpts.leaseOpt, mdsClient_.get()));
+    }
+
     int rc2 = csClient_->Init(fileSvcOpts.csClientOpt);
     if (rc2 != 0) {
         LOG(ERROR) << "Init ChunkServer Client failed!";
@@ -210,6 +215,7 @@ void FileClient::UnInit() {
     fileserviceMap_.clear();
     fileserviceFileNameMap_.clear();
 
+    leaseRefresher_.reset();
     mdsClient_.reset();
     inited_ = false;
 }
@@ -235,9 +241,11 @@ int FileClient::Open(const std::string &filename, const UserInfo_t &userinfo,
         return -LIBCURVE_ERROR::FAILED;
     }
 
+    // 指定了配置文件的文件可能属于其他mds，单独续约
     FileInstance *fileserv = FileInstance::NewInitedFileInstance(
         clientConfig.GetFileServiceOption(), mdsClient, filename, userinfo,
-        openflags, false);
+        openflags, false,
+        openflags.confPath.empty() ? leaseRefresher_.get() : nullptr);
     if (fileserv == nullptr) {
         LOG(ERROR) << "NewInitedFileInstance fail";
         return -1;
@@ -451,6 +459,18 @@ int FileClient::AioDiscard(int fd, CurveAioContext *aioctx) {
     }
 }
 
+int FileClient::SetIOPriority(int fd, LIBCURVE_IO_PRIORITY priority) {
+    ReadLockGuard lk(rwlock_);
+    auto iter = fileserviceMap_.find(fd);
+    if (CURVE_UNLIKELY(iter == fileserviceMap_.end())) {
+        LOG(ERROR) << "invalid fd, fd = " << fd;
+        return -LIBCURVE_ERROR::BAD_FD;
+    }
+
+    iter->second->GetIOManager4File()->SetIOPriority(priority);
+    return LIBCURVE_ERROR::OK;
+}
+
 int FileClient::Rename(const UserInfo_t &userinfo, const std::string &oldpath,
                        const std::string &newpath) {
     LIBCURVE_ERROR ret;
@@ -909,6 +929,15 @@ int AioDiscard(int fd, CurveAioContext *aioctx) {
     return globalclient->AioDiscard(fd, aioctx);
 }
 
+int SetIOPriority(int fd, LIBCURVE_IO_PRIORITY priority) {
+    if (globalclient == nullptr) {
+        LOG(ERROR) << "Not inited!";
+        return -LIBCURVE_ERROR::FAILED;
+    }
+
+    return globalclient->SetIOPriority(fd, priority);
+}
+
 int Create(const char *filename, const C_UserInfo_t *userinfo, size_t size) {
     if (globalclient == nullptr) {
         LOG(ERROR) << "not inited!";
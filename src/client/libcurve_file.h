@@ -162,6 +162,14 @@ class FileClient {
      */
     virtual int AioDiscard(int fd, CurveAioContext* aioctx);
 
+    /**
+     * @brief 设置文件的IO优先级
+     * @param fd file descriptor
+     * @param priority IO优先级
+     * @return 成功返回0, fd无效返回-LIBCURVE_ERROR::BAD_FD
+     */
+    virtual int SetIOPriority(int fd, LIBCURVE_IO_PRIORITY priority);
+
     /**
      * 重命名文件
      * @param: userinfo是用户信息
@@ -324,6 +332,9 @@ class FileClient {
     // fileclient对应的全局mdsclient
     std::shared_ptr<MDSClient> mdsClient_;
 
+    // 使用全局配置打开的文件通过全局mdsclient批量续约，未开启时为空
+    std::unique_ptr<LeaseRefresher> leaseRefresher_;
+
     // chunkserver client
     std::shared_ptr<ChunkServerClient> csClient_;
     // chunkserver broadCaster
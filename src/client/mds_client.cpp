@@ -45,6 +45,80 @@ using curve::mds::StatusCode;
 using curve::common::ChunkServerLocation;
 using curve::mds::topology::CopySetServerInfo;
 
+namespace {
+
+void ParsePageFileSegment(const PageFileSegment& pfs, SegmentInfo* segInfo) {
+    segInfo->chunksize = pfs.chunksize();
+    segInfo->segmentsize = pfs.segmentsize();
+    segInfo->startoffset = pfs.startoffset();
+    LogicPoolID logicpoolid = pfs.logicalpoolid();
+    segInfo->lpcpIDInfo.lpid = pfs.logicalpoolid();
+
+    for (int i = 0; i < pfs.chunks_size(); i++) {
+        ChunkID chunkid = pfs.chunks(i).chunkid();
+        CopysetID copysetid = pfs.chunks(i).copysetid();
+        segInfo->lpcpIDInfo.cpidVec.push_back(copysetid);
+        segInfo->chunkvec.emplace_back(chunkid, logicpoolid, copysetid);
+    }
+}
+
+LIBCURVE_ERROR ParseRefreshSessionResponse(
+    const std::string& filename, const UserInfo_t& userinfo,
+    const std::string& sessionid, const ReFreshSessionResponse& response,
+    LeaseRefreshResult* resp, LeaseSession* lease) {
+    StatusCode stcode = response.statuscode();
+    if (stcode != StatusCode::kOK) {
+        LOG(WARNING) << "RefreshSession NOT OK: filename = " << filename
+                     << ", owner = " << userinfo.owner
+                     << ", sessionid = " << sessionid
+                     << ", status code = " << StatusCode_Name(stcode);
+    } else {
+        LOG_EVERY_N(INFO, 100)
+            << "RefreshSession returned: filename = " << filename
+            << ", owner = " << userinfo.owner
+            << ", sessionid = " << sessionid
+            << ", status code = " << StatusCode_Name(stcode);
+    }
+
+    switch (stcode) {
+    case StatusCode::kSessionNotExist:
+    case StatusCode::kFileNotExists:
+        resp->status = LeaseRefreshResult::Status::NOT_EXIST;
+        break;
+    case StatusCode::kOwnerAuthFail:
+        resp->status = LeaseRefreshResult::Status::FAILED;
+        return LIBCURVE_ERROR::AUTHFAIL;
+    case StatusCode::kOK:
+        if (response.has_fileinfo()) {
+            FileEpoch_t fEpoch;
+            ServiceHelper::ProtoFileInfo2Local(response.fileinfo(),
+                                               &resp->finfo,
+                                               &fEpoch);
+            resp->status = LeaseRefreshResult::Status::OK;
+        } else {
+            LOG(WARNING) << "session response has no fileinfo!";
+            return LIBCURVE_ERROR::FAILED;
+        }
+        if (nullptr != lease) {
+            if (!response.has_protosession()) {
+                LOG(WARNING) << "session response has no protosession";
+                return LIBCURVE_ERROR::FAILED;
+            }
+            ProtoSession leasesession = response.protosession();
+            lease->sessionID = leasesession.sessionid();
+            lease->leaseTime = leasesession.leasetime();
+            lease->createTime = leasesession.createtime();
+        }
+        break;
+    default:
+        resp->status = LeaseRefreshResult::Status::FAILED;
+        return LIBCURVE_ERROR::FAILED;
+    }
+    return LIBCURVE_ERROR::OK;
+}
+
+}  // namespace
+
 // rpc发送和mds地址切换状态机
 int RPCExcutorRetryPolicy::DoRPCTask(RPCFunc rpctask, uint64_t maxRetryTimeMS) {
     // 记录上一次正在服务的mds index
@@ -713,55 +787,52 @@ LIBCURVE_ERROR MDSClient::RefreshSession(const std::string &filename,
             return -cntl->ErrorCode();
         }
 
+        return ParseRefreshSessionResponse(filename, userinfo, sessionid,
+                                           response, resp, lease);
+    };
+    return ReturnError(
+        rpcExcutor_.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS));
+}
+
+LIBCURVE_ERROR MDSClient::BatchRefreshSession(
+    const std::vector<SessionToRefresh> &sessions,
+    std::vector<LIBCURVE_ERROR> *rets,
+    std::vector<LeaseRefreshResult> *resps) {
+    auto task = RPCTaskDefine {
+        (void)addrindex;
+        (void)rpctimeoutMS;
+        BatchRefreshSessionResponse response;
+        mdsClientMetric_.batchRefreshSession.qps.count << 1;
+        LatencyGuard lg(&mdsClientMetric_.batchRefreshSession.latency);
+        MDSClientBase::BatchRefreshSession(sessions, &response, cntl, channel);
+        if (cntl->Failed()) {
+            mdsClientMetric_.batchRefreshSession.eps.count << 1;
+            LOG(WARNING) << "Fail to send BatchRefreshSessionRequest, "
+                         << cntl->ErrorText()
+                         << ", sessions = " << sessions.size();
+            return -cntl->ErrorCode();
+        }
+
         StatusCode stcode = response.statuscode();
-        if (stcode != StatusCode::kOK) {
-            LOG(WARNING) << "RefreshSession NOT OK: filename = " << filename
-                         << ", owner = " << userinfo.owner
-                         << ", sessionid = " << sessionid
+        if (stcode != StatusCode::kOK ||
+            static_cast<size_t>(response.responses_size()) !=
+                sessions.size()) {
+            LOG(WARNING) << "BatchRefreshSession NOT OK: sessions = "
+                         << sessions.size() << ", responses = "
+                         << response.responses_size()
                          << ", status code = " << StatusCode_Name(stcode);
-        } else {
-            LOG_EVERY_N(INFO, 100)
-                << "RefreshSession returned: filename = " << filename
-                << ", owner = " << userinfo.owner
-                << ", sessionid = " << sessionid
-                << ", status code = " << StatusCode_Name(stcode);
+            return LIBCURVE_ERROR::FAILED;
         }
 
-        switch (stcode) {
-        case StatusCode::kSessionNotExist:
-        case StatusCode::kFileNotExists:
-            resp->status = LeaseRefreshResult::Status::NOT_EXIST;
-            break;
-        case StatusCode::kOwnerAuthFail:
-            resp->status = LeaseRefreshResult::Status::FAILED;
-            return LIBCURVE_ERROR::AUTHFAIL;
-            break;
-        case StatusCode::kOK:
-            if (response.has_fileinfo()) {
-                FileEpoch_t fEpoch;
-                ServiceHelper::ProtoFileInfo2Local(response.fileinfo(),
-                                                   &resp->finfo,
-                                                   &fEpoch);
-                resp->status = LeaseRefreshResult::Status::OK;
-            } else {
-                LOG(WARNING) << "session response has no fileinfo!";
-                return LIBCURVE_ERROR::FAILED;
-            }
-            if (nullptr != lease) {
-                if (!response.has_protosession()) {
-                    LOG(WARNING) << "session response has no protosession";
-                    return LIBCURVE_ERROR::FAILED;
-                }
-                ProtoSession leasesession = response.protosession();
-                lease->sessionID = leasesession.sessionid();
-                lease->leaseTime = leasesession.leasetime();
-                lease->createTime = leasesession.createtime();
-            }
-            break;
-        default:
-            resp->status = LeaseRefreshResult::Status::FAILED;
-            return LIBCURVE_ERROR::FAILED;
-            break;
+        rets->clear();
+        resps->clear();
+        rets->reserve(sessions.size());
+        resps->resize(sessions.size());
+        for (size_t i = 0; i < sessions.size(); ++i) {
+            rets->push_back(ParseRefreshSessionResponse(
+                sessions[i].filename, sessions[i].userinfo,
+                sessions[i].sessionid, response.responses(i), &(*resps)[i],
+                nullptr));
         }
         return LIBCURVE_ERROR::OK;
     };
@@ -1031,6 +1102,18 @@ LIBCURVE_ERROR MDSClient::GetOrAllocateSegment(bool allocate, uint64_t offset,
                                                const FInfo_t *fi,
                                                const FileEpoch_t *fEpoch,
                                                SegmentInfo *segInfo) {
+    std::vector<SegmentInfo> segInfos;
+    LIBCURVE_ERROR ret =
+        GetOrAllocateSegment(allocate, offset, 1, fi, fEpoch, &segInfos);
+    if (ret == LIBCURVE_ERROR::OK) {
+        *segInfo = std::move(segInfos[0]);
+    }
+    return ret;
+}
+
+LIBCURVE_ERROR MDSClient::GetOrAllocateSegment(
+    bool allocate, uint64_t offset, uint32_t segmentNum, const FInfo_t *fi,
+    const FileEpoch_t *fEpoch, std::vector<SegmentInfo> *segInfos) {
     auto task = RPCTaskDefine {
         (void)addrindex;
         (void)rpctimeoutMS;
@@ -1038,7 +1121,8 @@ LIBCURVE_ERROR MDSClient::GetOrAllocateSegment(bool allocate, uint64_t offset,
         mdsClientMetric_.getOrAllocateSegment.qps.count << 1;
         LatencyGuard lg(&mdsClientMetric_.getOrAllocateSegment.latency);
         MDSClientBase::GetOrAllocateSegment(allocate, offset, fi, fEpoch,
-                                            &response, cntl, channel);
+                                            segmentNum, &response, cntl,
+                                            channel);
         if (cntl->Failed()) {
             mdsClientMetric_.getOrAllocateSegment.eps.count << 1;
             LOG(WARNING) << "allocate segment failed, error code = "
@@ -1069,31 +1153,76 @@ LIBCURVE_ERROR MDSClient::GetOrAllocateSegment(bool allocate, uint64_t offset,
             break;
         }
 
-        PageFileSegment pfs = response.pagefilesegment();
-        segInfo->chunksize = pfs.chunksize();
-        segInfo->segmentsize = pfs.segmentsize();
-        segInfo->startoffset = pfs.startoffset();
-        LogicPoolID logicpoolid = pfs.logicalpoolid();
-        segInfo->lpcpIDInfo.lpid = pfs.logicalpoolid();
-
-        int chunksNum = pfs.chunks_size();
-        if (allocate && chunksNum <= 0) {
+        if (allocate && response.pagefilesegment().chunks_size() <= 0) {
             LOG(WARNING) << "MDS allocate segment, but no chunkinfo!";
             // Now, we will retry until allocate segment success
             return -LIBCURVE_ERROR::RETRY_UNTIL_SUCCESS;
         }
 
-        for (int i = 0; i < chunksNum; i++) {
-            ChunkID chunkid = pfs.chunks(i).chunkid();
-            CopysetID copysetid = pfs.chunks(i).copysetid();
-            segInfo->lpcpIDInfo.cpidVec.push_back(copysetid);
-            segInfo->chunkvec.emplace_back(chunkid, logicpoolid, copysetid);
+        segInfos->clear();
+        segInfos->emplace_back();
+        ParsePageFileSegment(response.pagefilesegment(), &segInfos->back());
+        for (const auto& pfs : response.extrasegments()) {
+            // skip the segment broken, it will be got again when it is used
+            if (pfs.chunks_size() <= 0) {
+                continue;
+            }
+            segInfos->emplace_back();
+            ParsePageFileSegment(pfs, &segInfos->back());
         }
         return LIBCURVE_ERROR::OK;
     };
     return ReturnError(rpcExcutor_.DoRPCTask(task, 0));
 }
 
+LIBCURVE_ERROR MDSClient::ListSegment(const FInfo_t *fi,
+                                      std::vector<SegmentInfo> *segInfos) {
+    auto task = RPCTaskDefine {
+        (void)addrindex;
+        (void)rpctimeoutMS;
+        ListSegmentResponse response;
+        mdsClientMetric_.listSegment.qps.count << 1;
+        LatencyGuard lg(&mdsClientMetric_.listSegment.latency);
+        MDSClientBase::ListSegment(fi, &response, cntl, channel);
+        if (cntl->Failed()) {
+            mdsClientMetric_.listSegment.eps.count << 1;
+            LOG(WARNING) << "ListSegment failed, error code = "
+                         << cntl->ErrorCode()
+                         << ", error content:" << cntl->ErrorText()
+                         << ", filename = " << fi->fullPathName;
+            // mds of old version, don't retry
+            if (cntl->ErrorCode() == brpc::ENOMETHOD) {
+                return LIBCURVE_ERROR::NOT_SUPPORT;
+            }
+            return -cntl->ErrorCode();
+        }
+
+        auto statusCode = response.statuscode();
+        if (statusCode != StatusCode::kOK) {
+            LOG(WARNING) << "ListSegment mds return failed, error = "
+                         << mds::StatusCode_Name(statusCode)
+                         << ", filename = " << fi->fullPathName;
+            LIBCURVE_ERROR errCode;
+            MDSStatusCode2LibcurveError(statusCode, &errCode);
+            return errCode;
+        }
+
+        segInfos->clear();
+        segInfos->reserve(response.segments_size());
+        for (const auto& pfs : response.segments()) {
+            // skip the segment broken, it will be got again when it is used
+            if (pfs.chunks_size() <= 0) {
+                continue;
+            }
+            segInfos->emplace_back();
+            ParsePageFileSegment(pfs, &segInfos->back());
+        }
+        return LIBCURVE_ERROR::OK;
+    };
+    return ReturnError(
+        rpcExcutor_.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS));
+}
+
 LIBCURVE_ERROR MDSClient::DeAllocateSegment(const FInfo *fileInfo,
                                             uint64_t offset) {
     auto task = RPCTaskDefine {
@@ -1102,7 +1231,7 @@ LIBCURVE_ERROR MDSClient::DeAllocateSegment(const FInfo *fileInfo,
         DeAllocateSegmentResponse response;
         mdsClientMetric_.deAllocateSegment.qps.count << 1;
         LatencyGuard lg(&mdsClientMetric_.deAllocateSegment.latency);
-        MDSClientBase::DeAllocateSegment(fileInfo, offset, &response, cntl,
+        MDSClientBase::DeAllocateSegment(fileInfo, offset, 1, &response, cntl,
                                          channel);
 
         if (cntl->Failed()) {
@@ -1133,6 +1262,61 @@ LIBCURVE_ERROR MDSClient::DeAllocateSegment(const FInfo *fileInfo,
         rpcExcutor_.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS));
 }
 
+LIBCURVE_ERROR MDSClient::DeAllocateSegments(const FInfo *fileInfo,
+                                             uint64_t offset,
+                                             uint32_t segmentNum,
+                                             uint32_t *deallocatedNum) {
+    *deallocatedNum = 0;
+    auto task = RPCTaskDefine {
+        (void)addrindex;
+        (void)rpctimeoutMS;
+        DeAllocateSegmentResponse response;
+        mdsClientMetric_.deAllocateSegment.qps.count << 1;
+        LatencyGuard lg(&mdsClientMetric_.deAllocateSegment.latency);
+        MDSClientBase::DeAllocateSegment(fileInfo, offset, segmentNum,
+                                         &response, cntl, channel);
+
+        if (cntl->Failed()) {
+            mdsClientMetric_.deAllocateSegment.eps.count << 1;
+            LOG(WARNING) << "DeAllocateSegment failed, error = "
+                         << cntl->ErrorText()
+                         << ", filename = " << fileInfo->fullPathName
+                         << ", offset = " << offset
+                         << ", segment num = " << segmentNum;
+            return -cntl->ErrorCode();
+        }
+
+        // mds not supporting segmentNum only deallocates the first one
+        auto statusCode = response.statuscode();
+        bool ok = statusCode == StatusCode::kOK ||
+                  statusCode == StatusCode::kSegmentNotAllocated;
+        if (response.has_deallocatednum()) {
+            *deallocatedNum = std::min(response.deallocatednum(), segmentNum);
+        } else {
+            *deallocatedNum = ok ? 1 : 0;
+        }
+
+        if (ok && *deallocatedNum == segmentNum) {
+            return LIBCURVE_ERROR::OK;
+        } else if (ok) {
+            return LIBCURVE_ERROR::FAILED;
+        } else {
+            LOG(WARNING) << "DeAllocateSegment mds return failed, error = "
+                         << mds::StatusCode_Name(statusCode)
+                         << ", filename = " << fileInfo->fullPathName
+                         << ", offset = " << offset
+                         << ", deallocated = " << *deallocatedNum << "/"
+                         << segmentNum;
+            LIBCURVE_ERROR errCode;
+            MDSStatusCode2LibcurveError(statusCode, &errCode);
+            return errCode;
+        }
+    };
+
+    return ReturnError(
+        rpcExcutor_.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS));
+}
+
 LIBCURVE_ERROR MDSClient::RenameFile(const UserInfo_t &userinfo,
                                      const std::string &origin,
                                      const std::string &destination,
@@ -1329,13 +1513,18 @@ LIBCURVE_ERROR MDSClient::ChangeOwner(const std::string &filename,
 LIBCURVE_ERROR MDSClient::Listdir(const std::string &dirpath,
                                   const UserInfo_t &userinfo,
                                   std::vector<FileStatInfo> *filestatVec) {
+    // 大目录分页拉取，每页是一次独立的rpc，失败时只重试当前页
+    std::string pageToken;
+    std::string nextPageToken;
     auto task = RPCTaskDefine {
         (void)addrindex;
         (void)rpctimeoutMS;
         ListDirResponse response;
         mdsClientMetric_.listDir.qps.count << 1;
         LatencyGuard lg(&mdsClientMetric_.listDir.latency);
-        MDSClientBase::Listdir(dirpath, userinfo, &response, cntl, channel);
+        MDSClientBase::Listdir(dirpath, userinfo, pageToken,
+                               metaServerOpt_.listDirPageSize, &response,
+                               cntl, channel);
 
         if (cntl->Failed()) {
             mdsClientMetric_.listDir.eps.count << 1;
@@ -1372,11 +1561,22 @@ LIBCURVE_ERROR MDSClient::Listdir(const std::string &dirpath,
                        NAME_MAX_SIZE);
                 filestatVec->push_back(filestat);
             }
+            nextPageToken = response.nextpagetoken();
         }
         return retcode;
     };
-    return ReturnError(
-        rpcExcutor_.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS));
+
+    do {
+        nextPageToken.clear();
+        LIBCURVE_ERROR ret = ReturnError(
+            rpcExcutor_.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS));
+        if (ret != LIBCURVE_ERROR::OK) {
+            return ret;
+        }
+        pageToken = nextPageToken;
+    } while (!pageToken.empty());
+
+    return LIBCURVE_ERROR::OK;
 }
 
 LIBCURVE_ERROR MDSClient::GetChunkServerInfo(const PeerAddr &csAddr,
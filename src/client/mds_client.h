@@ -233,6 +233,32 @@ class MDSClient : public MDSClientBase,
                                         const FileEpoch_t *fEpoch,
                                         SegmentInfo *segInfo);
 
+    /**
+     * Get or Alloc segmentNum segments from offset with one rpc
+     * @param: segmentNum  number of segments wanted
+     * @param[out]: segInfos  the segment at offset first, followed by the
+     *              segments after it that mds returned, segments not
+     *              allocated are skipped when allocate is false
+     * @return: same as above, it only depends on the segment at offset
+     */
+    LIBCURVE_ERROR GetOrAllocateSegment(bool allocate, uint64_t offset,
+                                        uint32_t segmentNum,
+                                        const FInfo_t *fi,
+                                        const FileEpoch_t *fEpoch,
+                                        std::vector<SegmentInfo> *segInfos);
+
+    /**
+     * List all the allocated segments of the file with one rpc
+     * @param: fi file info
+     * @param[out]: segInfos  the segments in order of offset, segments without
+     *              chunks are skipped
+     * @return: LIBCURVE_ERROR::OK for success,
+     *          LIBCURVE_ERROR::NOT_SUPPORT if mds does not support it,
+     *          otherwise the error mds returned
+     */
+    virtual LIBCURVE_ERROR ListSegment(const FInfo_t *fi,
+                                       std::vector<SegmentInfo> *segInfos);
+
     /**
      * @brief Send DeAllocateSegment request to current working MDS
      * @param fileInfo current file info
@@ -242,6 +268,21 @@ class MDSClient : public MDSClientBase,
     virtual LIBCURVE_ERROR DeAllocateSegment(const FInfo *fileInfo,
                                              uint64_t offset);
 
+    /**
+     * @brief Deallocate consecutive segments with one DeAllocateSegment
+     *        request, segments not allocated are counted as deallocated
+     * @param fileInfo current file info
+     * @param offset start offset of the first segment
+     * @param segmentNum number of segments
+     * @param[out] deallocatedNum segments deallocated from offset before
+     *             the first failure
+     * @return LIBCURVE_ERROR::OK if all the segments are deallocated
+     */
+    virtual LIBCURVE_ERROR DeAllocateSegments(const FInfo *fileInfo,
+                                              uint64_t offset,
+                                              uint32_t segmentNum,
+                                              uint32_t *deallocatedNum);
+
     /**
      * Get File Info
      * @param: filename  file name
@@ -382,6 +423,19 @@ class MDSClient : public MDSClientBase,
                                   const std::string &sessionid,
                                   LeaseRefreshResult *resp,
                                   LeaseSession *lease = nullptr);
+
+    /**
+     * 通过一个rpc为多个文件续约
+     * @param: sessions是要续约的文件及session信息
+     * @param[out]: rets是每个文件续约的返回值，含义同RefreshSession
+     * @param[out]: resps是每个文件的续约结果
+     * @return: rpc成功返回LIBCURVE_ERROR::OK，此时才会填充rets和resps，
+     *          否则返回LIBCURVE_ERROR::FAILED
+     */
+    LIBCURVE_ERROR BatchRefreshSession(
+        const std::vector<SessionToRefresh> &sessions,
+        std::vector<LIBCURVE_ERROR> *rets,
+        std::vector<LeaseRefreshResult> *resps);
     /**
      * 关闭文件，需要携带sessionid，这样mds端会在数据库删除该session信息
      * @param: filename是要续约的文件名
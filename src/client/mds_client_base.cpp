@@ -267,6 +267,29 @@ void MDSClientBase::RefreshSession(const std::string& filename,
     stub.RefreshSession(cntl, &request, response, nullptr);
 }
 
+void MDSClientBase::BatchRefreshSession(
+    const std::vector<SessionToRefresh>& sessions,
+    BatchRefreshSessionResponse* response,
+    brpc::Controller* cntl,
+    brpc::Channel* channel) {
+    BatchRefreshSessionRequest request;
+    for (const auto& session : sessions) {
+        ReFreshSessionRequest* req = request.add_requests();
+        req->set_filename(session.filename);
+        req->set_sessionid(session.sessionid);
+        req->set_clientversion(curve::common::CurveVersion());
+        FillUserInfo(req, session.userinfo);
+        FillClienIpPortIfRegistered(req);
+    }
+
+    LOG_EVERY_N(INFO, 10) << "BatchRefreshSession: sessions = "
+                          << sessions.size()
+                          << ", log id = " << cntl->log_id();
+
+    curve::mds::CurveFSService_Stub stub(channel);
+    stub.BatchRefreshSession(cntl, &request, response, nullptr);
+}
+
 void MDSClientBase::CheckSnapShotStatus(const std::string& filename,
                                         const UserInfo_t& userinfo,
                                         uint64_t seq,
@@ -383,6 +406,7 @@ void MDSClientBase::GetOrAllocateSegment(bool allocate,
                                          uint64_t offset,
                                          const FInfo_t* fi,
                                          const FileEpoch_t *fEpoch,
+                                         uint32_t segmentNum,
                                          GetOrAllocateSegmentResponse* response,
                                          brpc::Controller* cntl,
                                          brpc::Channel* channel) {
@@ -397,11 +421,15 @@ void MDSClientBase::GetOrAllocateSegment(bool allocate,
     if (allocate && fEpoch != nullptr && fEpoch->epoch != 0) {
         request.set_epoch(fEpoch->epoch);
     }
+    if (segmentNum > 1) {
+        request.set_segmentnum(segmentNum);
+    }
     FillUserInfo(&request, fi->userinfo);
 
     LOG(INFO) << "GetOrAllocateSegment: filename = " << fi->fullPathName
               << ", allocate = " << allocate << ", owner = " << fi->owner
               << ", offset = " << offset << ", segment offset = " << seg_offset
+              << ", segment num = " << segmentNum
               << ", log id = " << cntl->log_id();
 
     curve::mds::CurveFSService_Stub stub(channel);
@@ -410,23 +438,44 @@ void MDSClientBase::GetOrAllocateSegment(bool allocate,
 
 void MDSClientBase::DeAllocateSegment(const FInfo* fileInfo,
                                       uint64_t segmentOffset,
+                                      uint32_t segmentNum,
                                       DeAllocateSegmentResponse* response,
                                       brpc::Controller* cntl,
                                       brpc::Channel* channel) {
     DeAllocateSegmentRequest request;
     request.set_filename(fileInfo->fullPathName);
     request.set_offset(segmentOffset);
+    if (segmentNum > 1) {
+        request.set_segmentnum(segmentNum);
+    }
 
     FillUserInfo(&request, fileInfo->userinfo);
 
     LOG(INFO) << "DeAllocateSegment: filename = " << fileInfo->fullPathName
               << ", offset = " << segmentOffset
+              << ", segment num = " << segmentNum
               << ", logid = " << cntl->log_id();
 
     curve::mds::CurveFSService_Stub stub(channel);
     stub.DeAllocateSegment(cntl, &request, response, nullptr);
 }
 
+void MDSClientBase::ListSegment(const FInfo_t* fi,
+                                ListSegmentResponse* response,
+                                brpc::Controller* cntl,
+                                brpc::Channel* channel) {
+    ListSegmentRequest request;
+    request.set_filename(fi->fullPathName);
+    FillUserInfo(&request, fi->userinfo);
+
+    LOG(INFO) << "ListSegment: filename = " << fi->fullPathName
+              << ", owner = " << fi->owner
+              << ", log id = " << cntl->log_id();
+
+    curve::mds::CurveFSService_Stub stub(channel);
+    stub.ListSegment(cntl, &request, response, nullptr);
+}
+
 void MDSClientBase::RenameFile(const UserInfo_t& userinfo,
                                const std::string& origin,
                                const std::string& destination,
@@ -542,11 +591,17 @@ void MDSClientBase::ChangeOwner(const std::string& filename,
 
 void MDSClientBase::Listdir(const std::string& dirpath,
                             const UserInfo_t& userinfo,
+                            const std::string& pageToken,
+                            uint32_t pageSize,
                             ListDirResponse* response,
                             brpc::Controller* cntl,
                             brpc::Channel* channel) {
     curve::mds::ListDirRequest request;
     request.set_filename(dirpath);
+    if (pageSize > 0) {
+        request.set_pagesize(pageSize);
+        request.set_pagetoken(pageToken);
+    }
 
     FillUserInfo(&request, userinfo);
 
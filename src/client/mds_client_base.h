@@ -59,6 +59,8 @@ using curve::mds::DeleteSnapShotRequest;
 using curve::mds::DeleteSnapShotResponse;
 using curve::mds::ReFreshSessionRequest;
 using curve::mds::ReFreshSessionResponse;
+using curve::mds::BatchRefreshSessionRequest;
+using curve::mds::BatchRefreshSessionResponse;
 using curve::mds::ListDirRequest;
 using curve::mds::ListDirResponse;
 using curve::mds::ChangeOwnerRequest;
@@ -73,6 +75,8 @@ using curve::mds::GetOrAllocateSegmentRequest;
 using curve::mds::GetOrAllocateSegmentResponse;
 using curve::mds::DeAllocateSegmentRequest;
 using curve::mds::DeAllocateSegmentResponse;
+using curve::mds::ListSegmentRequest;
+using curve::mds::ListSegmentResponse;
 using curve::mds::CheckSnapShotStatusRequest;
 using curve::mds::CheckSnapShotStatusResponse;
 using curve::mds::ListSnapShotFileInfoRequest;
@@ -92,6 +96,13 @@ using curve::mds::topology::ListPoolsetResponse;
 
 extern const char* kRootUserName;
 
+// 批量续约中一个文件的session
+struct SessionToRefresh {
+    std::string filename;
+    UserInfo_t userinfo;
+    std::string sessionid;
+};
+
 // MDSClientBase将所有与mds的RPC接口抽离，与业务逻辑解耦
 // 这里只负责rpc的发送，具体的业务处理逻辑通过reponse和controller向上
 // 返回给调用者，有调用者处理
@@ -246,6 +257,17 @@ class MDSClientBase {
                         ReFreshSessionResponse* response,
                         brpc::Controller* cntl,
                         brpc::Channel* channel);
+    /**
+     * 通过一个rpc为多个文件续约
+     * @param: sessions是要续约的文件及session信息
+     * @param[out]: response为该rpc的response，提供给外部处理
+     * @param[in|out]: cntl既是入参，也是出参，返回RPC状态
+     * @param[in]:channel是当前与mds建立的通道
+     */
+    void BatchRefreshSession(const std::vector<SessionToRefresh>& sessions,
+                             BatchRefreshSessionResponse* response,
+                             brpc::Controller* cntl,
+                             brpc::Channel* channel);
     /**
      * 获取快照状态
      * @param: filenam文件名
@@ -340,6 +362,7 @@ class MDSClientBase {
      * @param: offset  segment start offset
      * @param: fi file info
      * @param: fEpoch  file epoch info
+     * @param: segmentNum  number of segments to get or allocate from offset
      * @param[out]: reponse  rpc response
      * @param[in|out]: cntl  rpc controller
      * @param[in]:channel  rpc channel
@@ -348,14 +371,28 @@ class MDSClientBase {
                               uint64_t offset,
                               const FInfo_t* fi,
                               const FileEpoch_t *fEpoch,
+                              uint32_t segmentNum,
                               GetOrAllocateSegmentResponse* response,
                               brpc::Controller* cntl,
                               brpc::Channel* channel);
 
     void DeAllocateSegment(const FInfo* fileInfo, uint64_t segmentOffset,
+                           uint32_t segmentNum,
                            DeAllocateSegmentResponse* response,
                            brpc::Controller* cntl, brpc::Channel* channel);
 
+    /**
+     * @brief 获取文件所有已分配的segment
+     * @param: fi 文件信息
+     * @param[out]: response rpc response
+     * @param[in|out]: cntl rpc controller
+     * @param[in]: channel rpc channel
+     */
+    void ListSegment(const FInfo_t* fi,
+                     ListSegmentResponse* response,
+                     brpc::Controller* cntl,
+                     brpc::Channel* channel);
+
     /**
      * @brief 重名文件
      * @param:userinfo 用户信息
@@ -443,12 +480,16 @@ class MDSClientBase {
      * 枚举目录内容
      * @param: userinfo是用户信息
      * @param: dirpath是目录路径
+     * @param: pageToken是上一页返回的nextPageToken，第一页为空
+     * @param: pageSize是每页最多返回的文件数，0表示不分页
      * @param[out]: response为该rpc的response，提供给外部处理
      * @param[in|out]: cntl既是入参，也是出参，返回RPC状态
      * @param[in]:channel是当前与mds建立的通道
       */
     void Listdir(const std::string& dirpath,
                  const UserInfo_t& userinfo,
+                 const std::string& pageToken,
+                 uint32_t pageSize,
                  ListDirResponse* response,
                  brpc::Controller* cntl,
                  brpc::Channel* channel);
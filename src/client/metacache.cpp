@@ -57,9 +57,10 @@ void MetaCache::Init(const MetaCacheOption& metaCacheOpt,
 
 MetaCacheErrorType MetaCache::GetChunkInfoByIndex(ChunkIndex chunkidx,
                                                   ChunkIDInfo* chunxinfo) {
-    ReadLockGuard rdlk(rwlock4ChunkInfo_);
-    auto iter = chunkindex2idMap_.find(chunkidx);
-    if (iter != chunkindex2idMap_.end()) {
+    ChunkIndexShard& shard = GetChunkIndexShard(chunkidx);
+    ReadLockGuard rdlk(shard.rwlock);
+    auto iter = shard.map.find(chunkidx);
+    if (iter != shard.map.end()) {
         *chunxinfo = iter->second;
         return MetaCacheErrorType::OK;
     }
@@ -68,23 +69,22 @@ MetaCacheErrorType MetaCache::GetChunkInfoByIndex(ChunkIndex chunkidx,
 
 void MetaCache::UpdateChunkInfoByIndex(ChunkIndex cindex,
                                        const ChunkIDInfo& cinfo) {
-    WriteLockGuard wrlk(rwlock4ChunkInfo_);
-    chunkindex2idMap_[cindex] = cinfo;
+    ChunkIndexShard& shard = GetChunkIndexShard(cindex);
+    WriteLockGuard wrlk(shard.rwlock);
+    shard.map[cindex] = cinfo;
 }
 
 bool MetaCache::IsLeaderMayChange(LogicPoolID logicPoolId,
                                   CopysetID copysetId) {
-    rwlock4ChunkInfo_.RDLock();
-    auto iter = lpcsid2CopsetInfoMap_.find(
-        CalcLogicPoolCopysetID(logicPoolId, copysetId));
-    if (iter == lpcsid2CopsetInfoMap_.end()) {
-        rwlock4ChunkInfo_.Unlock();
+    const auto key = CalcLogicPoolCopysetID(logicPoolId, copysetId);
+    CopysetShard& shard = GetCopysetShard(key);
+    ReadLockGuard rdlk(shard.rwlock);
+    auto iter = shard.map.find(key);
+    if (iter == shard.map.end()) {
         return false;
     }
 
-    bool flag = iter->second.LeaderMayChange();
-    rwlock4ChunkInfo_.Unlock();
-    return flag;
+    return iter->second.LeaderMayChange();
 }
 
 int MetaCache::GetLeader(LogicPoolID logicPoolId,
@@ -95,17 +95,24 @@ int MetaCache::GetLeader(LogicPoolID logicPoolId,
                          FileMetric* fm) {
     const auto key = CalcLogicPoolCopysetID(logicPoolId, copysetId);
 
+    CopysetShard& shard = GetCopysetShard(key);
     CopysetInfo<ChunkServerID> targetInfo;
-    rwlock4CopysetInfo_.RDLock();
-    auto iter = lpcsid2CopsetInfoMap_.find(key);
-    if (iter == lpcsid2CopsetInfoMap_.end()) {
-        rwlock4CopysetInfo_.Unlock();
+    shard.rwlock.RDLock();
+    auto iter = shard.map.find(key);
+    if (iter == shard.map.end()) {
+        shard.rwlock.Unlock();
         LOG(ERROR) << "server list not exist, LogicPoolID = " << logicPoolId
                    << ", CopysetID = " << copysetId;
         return -1;
     }
+    // leader稳定时直接返回，避免每个IO都拷贝copyset的peer列表
+    if (!refresh && iter->second.HasValidLeader()) {
+        int ret = iter->second.GetLeaderInfo(serverId, serverAddr);
+        shard.rwlock.Unlock();
+        return ret;
+    }
     targetInfo = iter->second;
-    rwlock4CopysetInfo_.Unlock();
+    shard.rwlock.Unlock();
 
     int ret = 0;
     if (refresh || targetInfo.LeaderMayChange()) {
@@ -236,9 +243,10 @@ CopysetInfo<ChunkServerID> MetaCache::GetServerList(LogicPoolID logicPoolId,
     const auto key = CalcLogicPoolCopysetID(logicPoolId, copysetId);
     CopysetInfo<ChunkServerID> ret;
 
-    ReadLockGuard rdlk(rwlock4CopysetInfo_);
-    auto iter = lpcsid2CopsetInfoMap_.find(key);
-    if (iter == lpcsid2CopsetInfoMap_.end()) {
+    CopysetShard& shard = GetCopysetShard(key);
+    ReadLockGuard rdlk(shard.rwlock);
+    auto iter = shard.map.find(key);
+    if (iter == shard.map.end()) {
         // it's impossible to get here
         return ret;
     }
@@ -255,9 +263,11 @@ int MetaCache::UpdateLeader(LogicPoolID logicPoolId,
                             const EndPoint& leaderAddr) {
     const auto key = CalcLogicPoolCopysetID(logicPoolId, copysetId);
 
-    ReadLockGuard rdlk(rwlock4CopysetInfo_);
-    auto iter = lpcsid2CopsetInfoMap_.find(key);
-    if (iter == lpcsid2CopsetInfoMap_.end()) {
+    // 写锁保证读者看到的leader信息是完整的
+    CopysetShard& shard = GetCopysetShard(key);
+    WriteLockGuard wrlk(shard.rwlock);
+    auto iter = shard.map.find(key);
+    if (iter == shard.map.end()) {
         // it's impossible to get here
         return -1;
     }
@@ -269,20 +279,21 @@ int MetaCache::UpdateLeader(LogicPoolID logicPoolId,
 void MetaCache::UpdateCopysetInfo(LogicPoolID logicPoolid, CopysetID copysetid,
                                   const CopysetInfo<ChunkServerID>& csinfo) {
     const auto key = CalcLogicPoolCopysetID(logicPoolid, copysetid);
-    WriteLockGuard wrlk(rwlock4CopysetInfo_);
-    lpcsid2CopsetInfoMap_[key] = csinfo;
+    CopysetShard& shard = GetCopysetShard(key);
+    WriteLockGuard wrlk(shard.rwlock);
+    shard.map[key] = csinfo;
 }
 
 void MetaCache::AddCopysetsInfo(
     LogicPoolID poolId,
     std::vector<CopysetInfo<ChunkServerID>>&& copysetsInfo) {
-    WriteLockGuard guard(rwlock4CopysetInfo_);
-
     for (auto& copyset : copysetsInfo) {
         const auto key = CalcLogicPoolCopysetID(poolId, copyset.cpid_);
-        auto it = lpcsid2CopsetInfoMap_.find(key);
-        if (it == lpcsid2CopsetInfoMap_.end()) {
-            lpcsid2CopsetInfoMap_.emplace(key, std::move(copyset));
+        CopysetShard& shard = GetCopysetShard(key);
+        WriteLockGuard guard(shard.rwlock);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end()) {
+            shard.map.emplace(key, std::move(copyset));
         }
     }
 }
@@ -321,11 +332,12 @@ void MetaCache::SetChunkserverUnstable(ChunkServerID csid) {
         }
     }
 
-    ReadLockGuard rdlk(rwlock4CopysetInfo_);
     for (auto it : copysetIDSet) {
         const auto key = CalcLogicPoolCopysetID(it.lpid, it.cpid);
-        auto cpinfo = lpcsid2CopsetInfoMap_.find(key);
-        if (cpinfo != lpcsid2CopsetInfoMap_.end()) {
+        CopysetShard& shard = GetCopysetShard(key);
+        WriteLockGuard wrlk(shard.rwlock);
+        auto cpinfo = shard.map.find(key);
+        if (cpinfo != shard.map.end()) {
             ChunkServerID leaderid;
             if (cpinfo->second.GetCurrentLeaderID(&leaderid)) {
                 if (leaderid == csid) {
@@ -348,11 +360,12 @@ void MetaCache::AddCopysetIDInfo(ChunkServerID csid,
 
 void MetaCache::UpdateChunkserverCopysetInfo(LogicPoolID lpid,
                                  const CopysetInfo<ChunkServerID>& cpinfo) {
-    ReadLockGuard rdlk(rwlock4CopysetInfo_);
     const auto key = CalcLogicPoolCopysetID(lpid, cpinfo.cpid_);
+    CopysetShard& shard = GetCopysetShard(key);
+    ReadLockGuard rdlk(shard.rwlock);
     // 先获取原来的chunkserver到copyset映射
-    auto previouscpinfo = lpcsid2CopsetInfoMap_.find(key);
-    if (previouscpinfo != lpcsid2CopsetInfoMap_.end()) {
+    auto previouscpinfo = shard.map.find(key);
+    if (previouscpinfo != shard.map.end()) {
         std::vector<ChunkServerID> newID;
         std::vector<ChunkServerID> changedID;
 
@@ -392,10 +405,11 @@ void MetaCache::UpdateChunkserverCopysetInfo(LogicPoolID lpid,
 
 CopysetInfo<ChunkServerID> MetaCache::GetCopysetinfo(
     LogicPoolID lpid, CopysetID csid) {
-    ReadLockGuard rdlk(rwlock4CopysetInfo_);
     const auto key = CalcLogicPoolCopysetID(lpid, csid);
-    auto cpinfo = lpcsid2CopsetInfoMap_.find(key);
-    if (cpinfo != lpcsid2CopsetInfoMap_.end()) {
+    CopysetShard& shard = GetCopysetShard(key);
+    ReadLockGuard rdlk(shard.rwlock);
+    auto cpinfo = shard.map.find(key);
+    if (cpinfo != shard.map.end()) {
         return cpinfo->second;
     }
     return CopysetInfo<ChunkServerID>();
@@ -422,7 +436,6 @@ FileSegment* MetaCache::GetFileSegment(SegmentIndex segmentIndex) {
 }
 
 void MetaCache::CleanChunksInSegment(SegmentIndex segmentIndex) {
-    WriteLockGuard lk(rwlock4chunkInfoMap_);
     ChunkIndex beginChunkIndex = static_cast<uint64_t>(segmentIndex) *
                                  fileInfo_.segmentsize / fileInfo_.chunksize;
     ChunkIndex endChunkIndex = static_cast<uint64_t>(segmentIndex + 1) *
@@ -430,7 +443,9 @@ void MetaCache::CleanChunksInSegment(SegmentIndex segmentIndex) {
 
     auto currentIndex = beginChunkIndex;
     while (currentIndex < endChunkIndex) {
-        chunkindex2idMap_.erase(currentIndex);
+        ChunkIndexShard& shard = GetChunkIndexShard(currentIndex);
+        WriteLockGuard lk(shard.rwlock);
+        shard.map.erase(currentIndex);
         ++currentIndex;
     }
 }
@@ -268,27 +268,47 @@ class MetaCache {
                                                CopysetID copysetId,
                                                const PeerAddr &leaderAddr);
 
+    // 映射表按key分片，每个分片有自己的读写锁，不同IO线程访问不同的chunk
+    // 和copyset时不会竞争同一把锁
+    static constexpr uint32_t kShardNum = 32;
+
+    template <typename Map>
+    struct CURVE_CACHELINE_ALIGNMENT Shard {
+        RWLock rwlock;
+        Map map;
+    };
+
+    using ChunkIndexShard = Shard<ChunkIndexInfoMap>;
+    using CopysetShard = Shard<CopysetInfoMap>;
+
+    // 连续的chunk落在不同的分片
+    ChunkIndexShard &GetChunkIndexShard(ChunkIndex chunkidx) {
+        return chunkIndexShards_[chunkidx % kShardNum];
+    }
+
+    CopysetShard &GetCopysetShard(LogicPoolCopysetID key) {
+        return copysetShards_[(key ^ (key >> 32)) % kShardNum];
+    }
+
  private:
     MDSClient *mdsclient_;
     MetaCacheOption metacacheopt_;
 
     // chunkindex到chunkidinfo的映射表
-    CURVE_CACHELINE_ALIGNMENT ChunkIndexInfoMap chunkindex2idMap_;
+    ChunkIndexShard chunkIndexShards_[kShardNum];
 
     CURVE_CACHELINE_ALIGNMENT RWLock rwlock4Segments_;
     CURVE_CACHELINE_ALIGNMENT std::unordered_map<SegmentIndex, FileSegment>
         segments_;  // NOLINT
 
     // logicalpoolid和copysetid到copysetinfo的映射表
-    CURVE_CACHELINE_ALIGNMENT CopysetInfoMap lpcsid2CopsetInfoMap_;
+    CopysetShard copysetShards_[kShardNum];
 
     // chunkid到chunkidinfo的映射表
     CURVE_CACHELINE_ALIGNMENT ChunkInfoMap chunkid2chunkInfoMap_;
 
-    // 三个读写锁分别保护上述三个映射表
+    // 保护chunkid到chunkidinfo的映射表
     CURVE_CACHELINE_ALIGNMENT RWLock rwlock4chunkInfoMap_;
-    CURVE_CACHELINE_ALIGNMENT RWLock rwlock4ChunkInfo_;
-    CURVE_CACHELINE_ALIGNMENT RWLock rwlock4CopysetInfo_;
 
     // chunkserverCopysetIDMap_存放当前chunkserver到copyset的映射
     // 当rpc closure设置SetChunkserverUnstable时，会设置该chunkserver
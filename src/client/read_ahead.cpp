@@ -0,0 +1,316 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/client/read_ahead.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "src/common/timeutility.h"
+
+namespace curve {
+namespace client {
+
+using curve::common::TimeUtility;
+
+ReadAhead::ReadAhead(const ReadAheadOption& option, PrefetchFunc prefetch)
+    : option_(option),
+      prefetch_(std::move(prefetch)),
+      cachedBytes_(0),
+      nextOffset_(0),
+      prefetchEnd_(0),
+      sequentialCount_(0),
+      window_(option.minWindowBytes),
+      streamStartUs_(0),
+      streamBytes_(0),
+      latencyUs_(0) {}
+
+bool ReadAhead::Read(off_t offset, size_t length, uint64_t fileLength,
+                     ReadDone done) {
+    if (length == 0) {
+        return false;
+    }
+
+    std::vector<SegmentPtr> toIssue;
+    butil::IOBuf data;
+    bool hit = false;
+    bool waiting = false;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (sequentialCount_ > 0 && offset == nextOffset_) {
+            ++sequentialCount_;
+            streamBytes_ += length;
+        } else {
+            DropAllLocked();
+            sequentialCount_ = 1;
+            window_ = option_.minWindowBytes;
+            streamStartUs_ = TimeUtility::GetTimeofDayUs();
+            streamBytes_ = length;
+        }
+        nextOffset_ = offset + static_cast<off_t>(length);
+
+        std::vector<SegmentPtr> segments = LookupLocked(offset, length);
+        if (!segments.empty()) {
+            auto waiter = std::make_shared<Waiter>();
+            for (auto& segment : segments) {
+                if (!segment->ready) {
+                    ++waiter->pending;
+                    segment->waiters.push_back(waiter);
+                }
+            }
+            if (waiter->pending > 0) {
+                waiter->offset = offset;
+                waiter->length = length;
+                waiter->done = std::move(done);
+                waiter->segments = std::move(segments);
+                waiting = true;
+                hit = true;
+            } else {
+                hit = Assemble(segments, offset, length, &data);
+            }
+        }
+
+        EvictLocked(offset);
+        if (sequentialCount_ > 1) {
+            UpdateWindowLocked(waiting);
+        }
+        if (sequentialCount_ >= option_.sequentialThreshold) {
+            PrepareLocked(nextOffset_, fileLength, &toIssue);
+        }
+    }
+
+    for (auto& segment : toIssue) {
+        prefetch_(segment->offset, segment->length, &segment->data,
+                  [this, segment](int ret) { OnPrefetchDone(segment, ret); });
+    }
+
+    if (hit && !waiting) {
+        done(&data);
+    }
+    return hit;
+}
+
+void ReadAhead::OnPrefetchDone(const SegmentPtr& segment, int ret) {
+    struct Resolved {
+        std::shared_ptr<Waiter> waiter;
+        butil::IOBuf data;
+        bool ok = false;
+    };
+    std::vector<Resolved> resolved;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        segment->ready = true;
+        if (ret < 0 || segment->data.size() != segment->length) {
+            LOG(WARNING) << "Prefetch failed, offset = " << segment->offset
+                         << ", length = " << segment->length
+                         << ", ret = " << ret;
+            segment->invalid = true;
+        } else {
+            uint64_t latency =
+                TimeUtility::GetTimeofDayUs() - segment->issueUs;
+            latencyUs_ =
+                latencyUs_ == 0 ? latency : (latencyUs_ * 7 + latency) / 8;
+        }
+
+        if (segment->invalid) {
+            auto iter = segments_.find(segment->offset);
+            if (iter != segments_.end() && iter->second == segment) {
+                EraseLocked(iter);
+            }
+        }
+
+        for (auto& waiter : segment->waiters) {
+            if (--waiter->pending > 0) {
+                continue;
+            }
+            resolved.emplace_back();
+            Resolved& item = resolved.back();
+            item.waiter = waiter;
+            item.ok = Assemble(waiter->segments, waiter->offset,
+                               waiter->length, &item.data);
+            waiter->segments.clear();
+        }
+        segment->waiters.clear();
+    }
+
+    for (auto& item : resolved) {
+        item.waiter->done(item.ok ? &item.data : nullptr);
+    }
+}
+
+void ReadAhead::BeginWrite(off_t offset, size_t length) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    writes_.emplace(offset, length);
+
+    off_t end = offset + static_cast<off_t>(length);
+    auto iter = segments_.upper_bound(offset);
+    if (iter != segments_.begin()) {
+        --iter;
+    }
+    while (iter != segments_.end() && iter->first < end) {
+        if (iter->second->End() > offset) {
+            iter->second->invalid = true;
+            auto next = std::next(iter);
+            EraseLocked(iter);
+            iter = next;
+        } else {
+            ++iter;
+        }
+    }
+}
+
+void ReadAhead::EndWrite(off_t offset, size_t length) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    auto range = writes_.equal_range(offset);
+    for (auto iter = range.first; iter != range.second; ++iter) {
+        if (iter->second == length) {
+            writes_.erase(iter);
+            return;
+        }
+    }
+    LOG(WARNING) << "No write in flight, offset = " << offset
+                 << ", length = " << length;
+}
+
+uint64_t ReadAhead::Window() const {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return window_;
+}
+
+uint64_t ReadAhead::CachedBytes() const {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return cachedBytes_;
+}
+
+std::vector<ReadAhead::SegmentPtr> ReadAhead::LookupLocked(
+    off_t offset, size_t length) const {
+    std::vector<SegmentPtr> result;
+    auto iter = segments_.upper_bound(offset);
+    if (iter == segments_.begin()) {
+        return result;
+    }
+    --iter;
+
+    off_t pos = offset;
+    off_t end = offset + static_cast<off_t>(length);
+    while (pos < end) {
+        if (iter == segments_.end() || iter->first > pos ||
+            iter->second->End() <= pos) {
+            result.clear();
+            return result;
+        }
+        result.push_back(iter->second);
+        pos = iter->second->End();
+        ++iter;
+    }
+    return result;
+}
+
+bool ReadAhead::Assemble(const std::vector<SegmentPtr>& segments,
+                         off_t offset, size_t length, butil::IOBuf* data) {
+    off_t end = offset + static_cast<off_t>(length);
+    for (auto& segment : segments) {
+        if (segment->invalid) {
+            return false;
+        }
+        off_t begin = std::max(offset, segment->offset);
+        size_t n = std::min(end, segment->End()) - begin;
+        segment->data.append_to(data, n, begin - segment->offset);
+    }
+    return data->size() == length;
+}
+
+void ReadAhead::UpdateWindowLocked(bool stalled) {
+    // keep two round trips of the throughput in flight
+    uint64_t elapsed = TimeUtility::GetTimeofDayUs() - streamStartUs_;
+    uint64_t target = 0;
+    if (elapsed > 0) {
+        target = static_cast<uint64_t>(2.0 * streamBytes_ * latencyUs_ /
+                                       elapsed);
+    }
+    uint64_t window = std::max(target, stalled ? window_ * 2 : window_);
+    window_ = std::min(std::max(window, option_.minWindowBytes),
+                       option_.maxWindowBytes);
+}
+
+void ReadAhead::EraseLocked(std::map<off_t, SegmentPtr>::iterator iter) {
+    cachedBytes_ -= iter->second->length;
+    segments_.erase(iter);
+}
+
+void ReadAhead::DropAllLocked() {
+    // segments in flight are still referenced by their waiters
+    segments_.clear();
+    cachedBytes_ = 0;
+    prefetchEnd_ = 0;
+}
+
+void ReadAhead::EvictLocked(off_t offset) {
+    while (!segments_.empty() &&
+           segments_.begin()->second->End() <= offset) {
+        EraseLocked(segments_.begin());
+    }
+}
+
+void ReadAhead::PrepareLocked(off_t end, uint64_t fileLength,
+                              std::vector<SegmentPtr>* toIssue) {
+    if (prefetchEnd_ < end) {
+        prefetchEnd_ = end;
+    }
+    // prefetch again when half of the window is consumed, so that the
+    // segments are always of full size
+    if (prefetchEnd_ - end >= static_cast<off_t>(window_ / 2)) {
+        return;
+    }
+    off_t limit = std::min(end + static_cast<off_t>(window_),
+                           static_cast<off_t>(fileLength));
+
+    uint64_t now = TimeUtility::GetTimeofDayUs();
+    while (prefetchEnd_ < limit) {
+        size_t length = std::min(
+            static_cast<off_t>(option_.minWindowBytes),
+            static_cast<off_t>(fileLength) - prefetchEnd_);
+        if (cachedBytes_ + length > option_.maxCacheBytes ||
+            OverlapWriteLocked(prefetchEnd_, length)) {
+            break;
+        }
+
+        auto segment = std::make_shared<Segment>();
+        segment->offset = prefetchEnd_;
+        segment->length = length;
+        segment->issueUs = now;
+        segments_.emplace(segment->offset, segment);
+        cachedBytes_ += length;
+        prefetchEnd_ += length;
+        toIssue->push_back(std::move(segment));
+    }
+}
+
+bool ReadAhead::OverlapWriteLocked(off_t offset, size_t length) const {
+    off_t end = offset + static_cast<off_t>(length);
+    for (auto& write : writes_) {
+        if (write.first < end &&
+            write.first + static_cast<off_t>(write.second) > offset) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace client
+}  // namespace curve
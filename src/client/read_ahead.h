@@ -0,0 +1,168 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_CLIENT_READ_AHEAD_H_
+#define SRC_CLIENT_READ_AHEAD_H_
+
+#include <butil/iobuf.h>
+#include <sys/types.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "src/client/config_info.h"
+#include "src/common/uncopyable.h"
+
+namespace curve {
+namespace client {
+
+/**
+ * Read ahead of one opened file.
+ *
+ * Reads are checked in the order they are submitted, a stream is sequential
+ * once `sequentialThreshold` reads in a row start where the previous one
+ * ended. From then on, the range after the last read is prefetched in
+ * segments of `minWindowBytes`, the window keeps about two round trips of the
+ * observed read throughput ahead of the reader, and it is doubled each time
+ * the reader catches up with the prefetching. A random read resets the
+ * stream and drops the cached segments.
+ *
+ * Writes and discards must be bracketed by BeginWrite()/EndWrite(), cached
+ * data overlapping them is dropped and nothing overlapping them is
+ * prefetched or cached until they are done.
+ */
+class ReadAhead : public curve::common::Uncopyable {
+ public:
+    // called with 0 or a positive value on success, negative on failure
+    using PrefetchDone = std::function<void(int ret)>;
+    // read [offset, offset + length) into data and call done
+    using PrefetchFunc = std::function<void(off_t offset, size_t length,
+                                            butil::IOBuf* data,
+                                            PrefetchDone done)>;
+    // called with the data read, or nullptr if the read can't be served and
+    // the caller must read it by itself
+    using ReadDone = std::function<void(const butil::IOBuf* data)>;
+
+    ReadAhead(const ReadAheadOption& option, PrefetchFunc prefetch);
+
+    /**
+     * @brief serve a read from the prefetched data
+     * @param fileLength length of the file, nothing beyond is prefetched
+     * @return false if the range is not prefetched and done is not called,
+     *         true if done is called, maybe before returning
+     */
+    bool Read(off_t offset, size_t length, uint64_t fileLength,
+              ReadDone done);
+
+    void BeginWrite(off_t offset, size_t length);
+
+    void EndWrite(off_t offset, size_t length);
+
+    // current window of the stream, for tests
+    uint64_t Window() const;
+
+    // bytes of the segments cached, for tests
+    uint64_t CachedBytes() const;
+
+ private:
+    struct Waiter;
+
+    struct Segment {
+        off_t offset = 0;
+        size_t length = 0;
+        butil::IOBuf data;
+        // prefetch is done
+        bool ready = false;
+        // prefetch failed or overlapped by a write
+        bool invalid = false;
+        uint64_t issueUs = 0;
+        std::vector<std::shared_ptr<Waiter>> waiters;
+
+        off_t End() const {
+            return offset + static_cast<off_t>(length);
+        }
+    };
+
+    using SegmentPtr = std::shared_ptr<Segment>;
+
+    // a read waiting for the segments in flight
+    struct Waiter {
+        off_t offset = 0;
+        size_t length = 0;
+        ReadDone done;
+        uint32_t pending = 0;
+        std::vector<SegmentPtr> segments;
+    };
+
+    void OnPrefetchDone(const SegmentPtr& segment, int ret);
+
+    // segments covering [offset, offset + length) in order, empty if any
+    // part of the range is not prefetched
+    std::vector<SegmentPtr> LookupLocked(off_t offset, size_t length) const;
+
+    // copy the range from the segments, false if any of them is invalid
+    static bool Assemble(const std::vector<SegmentPtr>& segments,
+                         off_t offset, size_t length, butil::IOBuf* data);
+
+    void UpdateWindowLocked(bool stalled);
+
+    void EraseLocked(std::map<off_t, SegmentPtr>::iterator iter);
+
+    void DropAllLocked();
+
+    // erase the ready segments behind offset, they are consumed
+    void EvictLocked(off_t offset);
+
+    // segments to prefetch after end
+    void PrepareLocked(off_t end, uint64_t fileLength,
+                       std::vector<SegmentPtr>* toIssue);
+
+    bool OverlapWriteLocked(off_t offset, size_t length) const;
+
+ private:
+    const ReadAheadOption option_;
+    PrefetchFunc prefetch_;
+
+    mutable std::mutex mtx_;
+
+    // segments prefetched or being prefetched, keyed by offset
+    std::map<off_t, SegmentPtr> segments_;
+    uint64_t cachedBytes_;
+
+    // writes in flight, keyed by offset, value is length
+    std::multimap<off_t, size_t> writes_;
+
+    // where the next sequential read starts
+    off_t nextOffset_;
+    // where the next segment to prefetch starts
+    off_t prefetchEnd_;
+    uint32_t sequentialCount_;
+    uint64_t window_;
+
+    // throughput of the stream
+    uint64_t streamStartUs_;
+    uint64_t streamBytes_;
+    // average latency of prefetching a segment
+    uint64_t latencyUs_;
+};
+
+}  // namespace client
+}  // namespace curve
+
+#endif  // SRC_CLIENT_READ_AHEAD_H_
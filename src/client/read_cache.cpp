@@ -0,0 +1,248 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/client/read_cache.h"
+
+#include <fcntl.h>
+#include <glog/logging.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+namespace curve {
+namespace client {
+
+ReadCache::ReadCache()
+    : inited_(false),
+      memoryBytes_(0),
+      fd_(-1),
+      hitCount_("curve_client_read_cache_hit"),
+      missCount_("curve_client_read_cache_miss") {}
+
+ReadCache::~ReadCache() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+int ReadCache::Init(const ReadCacheOption& option) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (inited_) {
+        return 0;
+    }
+
+    if (option.blockSize == 0 || option.memoryBytes < option.blockSize) {
+        LOG(ERROR) << "Invalid read cache option, block size: "
+                   << option.blockSize
+                   << ", memory bytes: " << option.memoryBytes;
+        return -1;
+    }
+
+    if (!option.diskPath.empty()) {
+        uint64_t slots = option.diskBytes / option.blockSize;
+        if (slots == 0) {
+            LOG(ERROR) << "Read cache disk bytes " << option.diskBytes
+                       << " is less than block size " << option.blockSize;
+            return -1;
+        }
+        // the blocks in the file are indexed in memory, they are useless
+        // after restart
+        int fd = ::open(option.diskPath.c_str(), O_RDWR | O_CREAT | O_TRUNC,
+                        0644);
+        if (fd < 0) {
+            LOG(ERROR) << "Failed to open read cache file "
+                       << option.diskPath << ", errno: " << errno;
+            return -1;
+        }
+        if (::ftruncate(fd, slots * option.blockSize) != 0) {
+            LOG(ERROR) << "Failed to truncate read cache file "
+                       << option.diskPath << ", errno: " << errno;
+            ::close(fd);
+            return -1;
+        }
+        fd_ = fd;
+        freeSlots_.reserve(slots);
+        for (uint64_t slot = slots; slot > 0; --slot) {
+            freeSlots_.push_back(slot - 1);
+        }
+    }
+
+    option_ = option;
+    inited_ = true;
+    LOG(INFO) << "Read cache inited, block size: " << option_.blockSize
+              << ", memory bytes: " << option_.memoryBytes
+              << ", disk path: " << option_.diskPath
+              << ", disk bytes: " << option_.diskBytes;
+    return 0;
+}
+
+bool ReadCache::Get(ChunkID chunkId, uint64_t index, uint64_t epoch,
+                    uint64_t seq, butil::IOBuf* data) {
+    Key key{chunkId, index};
+    std::lock_guard<std::mutex> lk(mtx_);
+    auto iter = memoryMap_.find(key);
+    if (iter != memoryMap_.end()) {
+        MemoryList::iterator block = iter->second;
+        if (block->epoch == epoch && block->seq == seq) {
+            memoryList_.splice(memoryList_.begin(), memoryList_, block);
+            data->append(block->data);
+            hitCount_ << 1;
+            return true;
+        }
+        EraseLocked(key);
+        missCount_ << 1;
+        return false;
+    }
+
+    if (LoadFromDiskLocked(key, epoch, seq, data)) {
+        hitCount_ << 1;
+        return true;
+    }
+    missCount_ << 1;
+    return false;
+}
+
+void ReadCache::Put(ChunkID chunkId, uint64_t index, uint64_t epoch,
+                    uint64_t seq, const butil::IOBuf& data) {
+    Key key{chunkId, index};
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (!inited_ || data.size() != option_.blockSize) {
+        return;
+    }
+    EraseLocked(key);
+    InsertLocked(key, epoch, seq, data);
+}
+
+uint64_t ReadCache::MemoryBytes() const {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return memoryBytes_;
+}
+
+uint64_t ReadCache::DiskBlocks() const {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return diskList_.size();
+}
+
+void ReadCache::Reset() {
+    std::lock_guard<std::mutex> lk(mtx_);
+    memoryList_.clear();
+    memoryMap_.clear();
+    memoryBytes_ = 0;
+    diskList_.clear();
+    diskMap_.clear();
+    freeSlots_.clear();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    inited_ = false;
+}
+
+void ReadCache::EraseLocked(const Key& key) {
+    auto iter = memoryMap_.find(key);
+    if (iter != memoryMap_.end()) {
+        memoryBytes_ -= iter->second->data.size();
+        memoryList_.erase(iter->second);
+        memoryMap_.erase(iter);
+    }
+    auto diskIter = diskMap_.find(key);
+    if (diskIter != diskMap_.end()) {
+        EraseDiskLocked(diskIter);
+    }
+}
+
+void ReadCache::EraseDiskLocked(
+    std::unordered_map<Key, DiskList::iterator, KeyHash>::iterator iter) {
+    freeSlots_.push_back(iter->second->slot);
+    diskList_.erase(iter->second);
+    diskMap_.erase(iter);
+}
+
+void ReadCache::InsertLocked(const Key& key, uint64_t epoch, uint64_t seq,
+                             const butil::IOBuf& data) {
+    memoryList_.push_front(MemoryBlock{key, epoch, seq, data});
+    memoryMap_[key] = memoryList_.begin();
+    memoryBytes_ += data.size();
+    EvictLocked();
+}
+
+void ReadCache::EvictLocked() {
+    while (memoryBytes_ > option_.memoryBytes && !memoryList_.empty()) {
+        MemoryBlock& block = memoryList_.back();
+        if (fd_ >= 0) {
+            SaveToDiskLocked(block);
+        }
+        memoryBytes_ -= block.data.size();
+        memoryMap_.erase(block.key);
+        memoryList_.pop_back();
+    }
+}
+
+void ReadCache::SaveToDiskLocked(const MemoryBlock& block) {
+    if (freeSlots_.empty()) {
+        auto victim = diskMap_.find(diskList_.back().key);
+        EraseDiskLocked(victim);
+    }
+    uint64_t slot = freeSlots_.back();
+    freeSlots_.pop_back();
+
+    std::string buf = block.data.to_string();
+    off_t offset = slot * option_.blockSize;
+    ssize_t ret = ::pwrite(fd_, buf.data(), buf.size(), offset);
+    if (ret != static_cast<ssize_t>(buf.size())) {
+        LOG(WARNING) << "Failed to write read cache file, slot: " << slot
+                     << ", ret: " << ret << ", errno: " << errno;
+        freeSlots_.push_back(slot);
+        return;
+    }
+
+    diskList_.push_front(
+        DiskBlock{block.key, block.epoch, block.seq, slot, buf.size()});
+    diskMap_[block.key] = diskList_.begin();
+}
+
+bool ReadCache::LoadFromDiskLocked(const Key& key, uint64_t epoch,
+                                   uint64_t seq, butil::IOBuf* data) {
+    auto iter = diskMap_.find(key);
+    if (iter == diskMap_.end()) {
+        return false;
+    }
+    DiskBlock block = *iter->second;
+    EraseDiskLocked(iter);
+    if (block.epoch != epoch || block.seq != seq) {
+        return false;
+    }
+
+    std::string buf(block.length, '\0');
+    off_t offset = block.slot * option_.blockSize;
+    ssize_t ret = ::pread(fd_, &buf[0], buf.size(), offset);
+    if (ret != static_cast<ssize_t>(buf.size())) {
+        LOG(WARNING) << "Failed to read read cache file, slot: "
+                     << block.slot << ", ret: " << ret
+                     << ", errno: " << errno;
+        return false;
+    }
+
+    // promote to the memory, it may push other blocks to the disk
+    butil::IOBuf blockData;
+    blockData.append(buf);
+    InsertLocked(key, epoch, seq, blockData);
+    data->append(blockData);
+    return true;
+}
+
+}  // namespace client
+}  // namespace curve
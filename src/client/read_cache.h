@@ -0,0 +1,161 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_CLIENT_READ_CACHE_H_
+#define SRC_CLIENT_READ_CACHE_H_
+
+#include <butil/iobuf.h>
+#include <bvar/bvar.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "src/client/client_common.h"
+#include "src/client/config_info.h"
+#include "src/common/uncopyable.h"
+
+namespace curve {
+namespace client {
+
+/**
+ * Cache of chunk data shared by the files opened read only in the process,
+ * e.g. the clone source files read by SourceReader.
+ *
+ * Data is cached in blocks of `blockSize` aligned in the chunk, keyed by the
+ * chunk id and the index of the block. Every block is tagged with the file
+ * epoch in MetaCache and the sequence number it is read with, a block read
+ * with another tag is a miss and is replaced, which invalidates the data
+ * cached before the file is opened for write again or snapshotted.
+ *
+ * Blocks evicted from the memory are kept in a local file if `diskPath` is
+ * set, e.g. on an NVMe disk, they are read back on a hit.
+ */
+class ReadCache : public curve::common::Uncopyable {
+ public:
+    static ReadCache& GetInstance() {
+        static ReadCache cache;
+        return cache;
+    }
+
+    /**
+     * @brief init the cache, only the first call takes effect
+     * @return 0 on success, -1 if the options are invalid or the local file
+     *         can't be created
+     */
+    int Init(const ReadCacheOption& option);
+
+    uint32_t BlockSize() const {
+        return option_.blockSize;
+    }
+
+    /**
+     * @brief append the data of the block to data
+     * @return false if the block is not cached with the tag
+     */
+    bool Get(ChunkID chunkId, uint64_t index, uint64_t epoch, uint64_t seq,
+             butil::IOBuf* data);
+
+    void Put(ChunkID chunkId, uint64_t index, uint64_t epoch, uint64_t seq,
+             const butil::IOBuf& data);
+
+    // for tests
+    uint64_t MemoryBytes() const;
+    uint64_t DiskBlocks() const;
+    void Reset();
+
+    ~ReadCache();
+
+ private:
+    ReadCache();
+
+    struct Key {
+        ChunkID chunkId;
+        uint64_t index;
+
+        bool operator==(const Key& other) const {
+            return chunkId == other.chunkId && index == other.index;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return std::hash<uint64_t>()(key.chunkId) * 31 +
+                   std::hash<uint64_t>()(key.index);
+        }
+    };
+
+    struct MemoryBlock {
+        Key key;
+        uint64_t epoch;
+        uint64_t seq;
+        butil::IOBuf data;
+    };
+
+    struct DiskBlock {
+        Key key;
+        uint64_t epoch;
+        uint64_t seq;
+        uint64_t slot;
+        size_t length;
+    };
+
+    using MemoryList = std::list<MemoryBlock>;
+    using DiskList = std::list<DiskBlock>;
+
+    void EraseLocked(const Key& key);
+
+    void EraseDiskLocked(std::unordered_map<Key, DiskList::iterator,
+                                            KeyHash>::iterator iter);
+
+    // move the least recently used blocks out of the memory
+    void EvictLocked();
+
+    void SaveToDiskLocked(const MemoryBlock& block);
+
+    bool LoadFromDiskLocked(const Key& key, uint64_t epoch, uint64_t seq,
+                            butil::IOBuf* data);
+
+    void InsertLocked(const Key& key, uint64_t epoch, uint64_t seq,
+                      const butil::IOBuf& data);
+
+ private:
+    bool inited_;
+    ReadCacheOption option_;
+
+    mutable std::mutex mtx_;
+
+    // most recently used first
+    MemoryList memoryList_;
+    std::unordered_map<Key, MemoryList::iterator, KeyHash> memoryMap_;
+    uint64_t memoryBytes_;
+
+    int fd_;
+    DiskList diskList_;
+    std::unordered_map<Key, DiskList::iterator, KeyHash> diskMap_;
+    std::vector<uint64_t> freeSlots_;
+
+    bvar::Adder<uint64_t> hitCount_;
+    bvar::Adder<uint64_t> missCount_;
+};
+
+}  // namespace client
+}  // namespace curve
+
+#endif  // SRC_CLIENT_READ_CACHE_H_
@@ -38,9 +38,31 @@ void RequestClosure::Run() {
     tracker_->HandleResponse(reqCtx_);
 }
 
+void MergedWriteClosure::Run() {
+    ReleaseInflightRPCToken();
+    if (CURVE_UNLIKELY(IsSlowRequest())) {
+        MetricHelper::DecremSlowRequestNum(GetMetric());
+    }
+
+    int errcode = GetErrorCode();
+    std::vector<RequestContext*> reqs;
+    reqs.swap(reqs_);
+    // 回收后this不再可用
+    RequestContext* merged = GetReqCtx();
+    merged->UnInit();
+    delete merged;
+
+    for (auto req : reqs) {
+        req->done_->SetFailed(errcode);
+        req->done_->Run();
+    }
+}
+
 void RequestClosure::GetInflightRPCToken() {
     if (ioManager_ != nullptr) {
-        ioManager_->GetInflightRpcToken();
+        inflightPriority_ = reqCtx_ != nullptr ? reqCtx_->priority_
+                                               : LIBCURVE_IO_PRIORITY_NORMAL;
+        ioManager_->GetInflightRpcToken(inflightPriority_);
         MetricHelper::IncremInflightRPC(metric_);
         ownInflight_ = true;
     }
@@ -48,7 +70,7 @@ void RequestClosure::GetInflightRPCToken() {
 
 void RequestClosure::ReleaseInflightRPCToken() {
     if (ioManager_ != nullptr && ownInflight_) {
-        ioManager_->ReleaseInflightRpcToken();
+        ioManager_->ReleaseInflightRpcToken(inflightPriority_);
         MetricHelper::DecremInflightRPC(metric_);
     }
 }
@@ -26,11 +26,15 @@
 // for Closure
 #include <google/protobuf/stubs/callback.h>
 
+#include <utility>
+#include <vector>
+
 #include "include/curve_compiler_specific.h"
 #include "src/client/client_common.h"
 #include "src/client/client_metric.h"
 #include "src/client/inflight_controller.h"
 #include "src/common/concurrent/concurrent.h"
+#include "src/common/object_pool.h"
 #include "src/common/timeutility.h"
 
 namespace curve {
@@ -42,8 +46,11 @@ class RequestScheduler;
 struct FileMetric;
 struct RequestContext;
 
+// 随RequestContext分配和释放，内存从ObjectPool中复用，
+// MergedWriteClosure等大小不同的子类直接使用malloc
 class CURVE_CACHELINE_ALIGNMENT RequestClosure
-    : public ::google::protobuf::Closure {
+    : public ::google::protobuf::Closure,
+      public common::PoolAllocated<RequestClosure> {
  public:
     explicit RequestClosure(RequestContext* reqctx) : reqCtx_(reqctx) {}
     virtual ~RequestClosure() = default;
@@ -102,6 +109,10 @@ class CURVE_CACHELINE_ALIGNMENT RequestClosure
         ioManager_ = ioManager;
     }
 
+    IOManager* GetIOManager() const {
+        return ioManager_;
+    }
+
     /**
      * @brief 设置当前closure重试次数
      */
@@ -147,12 +158,22 @@ class CURVE_CACHELINE_ALIGNMENT RequestClosure
 
     uint64_t CreatedMS() const { return createdMS_; }
 
+    /**
+     * @brief 最近一次rpc的耗时，用于采样的IO记录span
+     */
+    void SetRpcLatencyUs(uint64_t latencyUs) { rpcLatencyUs_ = latencyUs; }
+
+    uint64_t GetRpcLatencyUs() const { return rpcLatencyUs_; }
+
  private:
     bool slowRequest_ = false;
 
     // whether own inflight count
     bool ownInflight_ = false;
 
+    // priority of the inflight token owned
+    LIBCURVE_IO_PRIORITY inflightPriority_ = LIBCURVE_IO_PRIORITY_NORMAL;
+
     // 当前request的错误码
     int errcode_ = -1;
 
@@ -174,10 +195,34 @@ class CURVE_CACHELINE_ALIGNMENT RequestClosure
     // 下一次rpc超时时间
     uint64_t nextTimeoutMS_ = 0;
 
+    // 最近一次rpc的耗时
+    uint64_t rpcLatencyUs_ = 0;
+
     // create time of this closure(in millisecond)
     uint64_t createdMS_ = common::TimeUtility::GetTimeofDayMs();
 };
 
+/**
+ * 多个写请求合并成一个request发送，rpc返回后把结果交给被合并的每个请求，
+ * 并回收合并出来的request
+ */
+class MergedWriteClosure : public RequestClosure {
+ public:
+    MergedWriteClosure(RequestContext* reqctx,
+                       std::vector<RequestContext*> reqs)
+        : RequestClosure(reqctx), reqs_(std::move(reqs)) {}
+
+    void Run() override;
+
+    const std::vector<RequestContext*>& MergedRequests() const {
+        return reqs_;
+    }
+
+ private:
+    // 被合并的请求，按offset递增
+    std::vector<RequestContext*> reqs_;
+};
+
 }  // namespace client
 }  // namespace curve
 
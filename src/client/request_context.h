@@ -27,9 +27,11 @@
 
 #include <atomic>
 #include <string>
+#include <vector>
 
 #include "src/client/client_common.h"
 #include "src/client/request_closure.h"
+#include "src/common/object_pool.h"
 #include "include/curve_compiler_specific.h"
 
 namespace curve {
@@ -58,7 +60,19 @@ inline std::ostream& operator<<(std::ostream& os,
     return os;
 }
 
-struct CURVE_CACHELINE_ALIGNMENT RequestContext {
+// 条带化文件的读请求中一段条带单元，subIoIndex为其在用户IO中的位置
+struct StripeUnit {
+    uint32_t subIoIndex = 0;
+    uint64_t length = 0;
+
+    StripeUnit() = default;
+    StripeUnit(uint32_t index, uint64_t len)
+        : subIoIndex(index), length(len) {}
+};
+
+// 每个IO都会分配和释放，内存从ObjectPool中复用
+struct CURVE_CACHELINE_ALIGNMENT RequestContext
+    : public common::PoolAllocated<RequestContext> {
     RequestContext() : id_(GetNextRequestContextId()) {}
 
     ~RequestContext() = default;
@@ -85,6 +99,10 @@ struct CURVE_CACHELINE_ALIGNMENT RequestContext {
     // subIoIndex_ is an index of serveral requests
     uint32_t subIoIndex_ = 0;
 
+    // 条带化文件的读，落在同一chunk上的多个条带单元合并为一个请求，
+    // 返回的数据按各单元依次拆分，放回其在用户IO中的位置，为空时用subIoIndex_
+    std::vector<StripeUnit> stripeUnits_;
+
     // read data of current request
     butil::IOBuf readData_;
 
@@ -115,6 +133,19 @@ struct CURVE_CACHELINE_ALIGNMENT RequestContext {
     // 当前request context id
     uint64_t            id_ = 0;
 
+    // 所属IO的优先级，拆分时从iomanager获取
+    LIBCURVE_IO_PRIORITY priority_ = LIBCURVE_IO_PRIORITY_NORMAL;
+
+    // 读缓存未命中时请求被扩展到缓存块的边界，返回后填充缓存，
+    // 并截取用户请求的原始范围
+    bool                readCacheFill_ = false;
+    off_t               originOffset_ = 0;
+    size_t              originLength_ = 0;
+
+    // 所属IO被采样记录span时，记录请求第一次被scheduler下发的时间
+    bool                traced_ = false;
+    uint64_t            dispatchUs_ = 0;
+
     static RequestContext* NewInitedRequestContext() {
         RequestContext* ctx = new (std::nothrow) RequestContext();
         if (ctx && ctx->Init()) {
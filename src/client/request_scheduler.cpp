@@ -25,13 +25,21 @@
 #include <brpc/closure_guard.h>
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include "src/client/request_context.h"
 #include "src/client/request_closure.h"
 #include "src/client/chunk_closure.h"
+#include "src/client/request_sender.h"
+#include "src/common/timeutility.h"
 
 namespace curve {
 namespace client {
 
+using curve::common::TimeUtility;
+
 RequestScheduler::~RequestScheduler() {}
 
 int RequestScheduler::Init(const RequestScheduleOption& reqSchdulerOpt,
@@ -40,6 +48,23 @@ int RequestScheduler::Init(const RequestScheduleOption& reqSchdulerOpt,
     blockIO_.store(false);
     reqschopt_ = reqSchdulerOpt;
 
+    // 合并发送前每个线程最多持有readBatchMaxNum-1个还没发出的读请求的
+    // inflight token，不能让所有的token都被还没发出的请求持有
+    uint32_t& readBatchMaxNum = reqschopt_.ioSenderOpt.readBatchMaxNum;
+    uint64_t maxInflight =
+        reqschopt_.ioSenderOpt.inflightOpt.fileMaxInFlightRPCNum;
+    uint32_t threadNum = std::max(reqschopt_.scheduleThreadpoolSize, 1u);
+    if (readBatchMaxNum > 1 &&
+        static_cast<uint64_t>(readBatchMaxNum - 1) * threadNum >=
+            maxInflight) {
+        uint32_t maxNum = maxInflight > 0 ? (maxInflight - 1) / threadNum + 1
+                                          : 1;
+        LOG(WARNING) << "readBatchMaxNum " << readBatchMaxNum
+                     << " is too large for fileMaxInFlightRPCNum "
+                     << maxInflight << ", use " << maxNum;
+        readBatchMaxNum = maxNum;
+    }
+
     int rc = 0;
     rc = queue_.Init(reqschopt_.scheduleQueueCapacity);
     if (0 != rc) {
@@ -61,7 +86,9 @@ int RequestScheduler::Init(const RequestScheduleOption& reqSchdulerOpt,
               << "scheduleQueueCapacity = "
               << reqschopt_.scheduleQueueCapacity
               << ", scheduleThreadpoolSize = "
-              << reqschopt_.scheduleThreadpoolSize;
+              << reqschopt_.scheduleThreadpoolSize
+              << ", writeMergeWindowUs = "
+              << reqschopt_.writeMergeWindowUs;
     return 0;
 }
 
@@ -90,6 +117,7 @@ int RequestScheduler::ScheduleRequest(
     const std::vector<RequestContext*>& requests) {
     if (running_.load(std::memory_order_acquire)) {
         /* TODO(wudemiao): 后期考虑 qos */
+        bool directly = CanProcessDirectly();
         for (auto it : requests) {
             // skip the fake request
             if (!it->idinfo_.chunkExist) {
@@ -99,6 +127,11 @@ int RequestScheduler::ScheduleRequest(
                 continue;
             }
 
+            if (directly) {
+                ProcessOne(it);
+                continue;
+            }
+
             BBQItem<RequestContext *> req(it);
             queue_.PutBack(req);
         }
@@ -109,6 +142,10 @@ int RequestScheduler::ScheduleRequest(
 
 int RequestScheduler::ScheduleRequest(RequestContext *request) {
     if (running_.load(std::memory_order_acquire)) {
+        if (CanProcessDirectly()) {
+            ProcessOne(request);
+            return 0;
+        }
         BBQItem<RequestContext *> req(request);
         queue_.PutBack(req);
         return 0;
@@ -145,10 +182,29 @@ void RequestScheduler::Process() {
             !queue_.Empty())  // flush all request in the queue
            && !stop_.load(std::memory_order_acquire)) {
         WaitValidSession();
-        BBQItem<RequestContext*> item = queue_.TakeFront();
+        BBQItem<RequestContext*> item(nullptr);
+        if (!PollQueue(&item)) {
+            item = queue_.TakeFront();
+        }
         if (!item.IsStop()) {
             RequestContext* req = item.Item();
-            ProcessOne(req);
+            if (req->optype_ == OpType::READ &&
+                reqschopt_.ioSenderOpt.readBatchMaxNum > 1) {
+                ProcessReads(req);
+            } else if (req->optype_ == OpType::CREATE_CLONE &&
+                       reqschopt_.ioSenderOpt.createCloneBatchMaxNum > 1) {
+                ProcessCloneRequests(req,
+                    reqschopt_.ioSenderOpt.createCloneBatchMaxNum);
+            } else if (req->optype_ == OpType::RECOVER_CHUNK &&
+                       reqschopt_.ioSenderOpt.recoverBatchMaxNum > 1) {
+                ProcessCloneRequests(req,
+                    reqschopt_.ioSenderOpt.recoverBatchMaxNum);
+            } else if (req->optype_ == OpType::WRITE &&
+                       reqschopt_.writeMergeWindowUs > 0) {
+                ProcessWrites(req);
+            } else {
+                ProcessOne(req);
+            }
         } else {
             /**
              * 一旦遇到stop item，所有线程都可以退出，因为此时
@@ -159,9 +215,140 @@ void RequestScheduler::Process() {
     }
 }
 
+bool RequestScheduler::CanProcessDirectly() {
+    // 队列中有请求时直接下发会让新的请求越过队列中的请求，
+    // session失效时请求需要在队列中等待续约成功
+    return reqschopt_.scheduleRunToCompletion &&
+           !blockIO_.load(std::memory_order_acquire) &&
+           queue_.Empty();
+}
+
+bool RequestScheduler::PollQueue(BBQItem<RequestContext*>* item) {
+    if (0 == reqschopt_.scheduleBusyPollUs) {
+        return false;
+    }
+
+    auto any = [](BBQItem<RequestContext*>&) { return true; };
+    uint64_t deadline =
+        TimeUtility::GetTimeofDayUs() + reqschopt_.scheduleBusyPollUs;
+    do {
+        if (queue_.TakeFrontIf(any, item)) {
+            return true;
+        }
+    } while (TimeUtility::GetTimeofDayUs() < deadline);
+    return false;
+}
+
+void RequestScheduler::ProcessReads(RequestContext* ctx) {
+    // 一次用户读拆分出的请求是一起入队的，把队列里已有的读请求一起下发，
+    // 发给同一个chunkserver的请求在作用域结束时合并发送
+    uint32_t maxNum = reqschopt_.ioSenderOpt.readBatchMaxNum;
+    ReadBatchScope scope(maxNum);
+    ProcessOne(ctx);
+    auto isRead = [](BBQItem<RequestContext*>& item) {
+        return !item.IsStop() && item.Item()->optype_ == OpType::READ;
+    };
+    BBQItem<RequestContext*> item(nullptr);
+    for (uint32_t i = 1; i < maxNum && queue_.TakeFrontIf(isRead, &item);
+         ++i) {
+        ProcessOne(item.Item());
+    }
+}
+
+void RequestScheduler::ProcessCloneRequests(RequestContext* ctx,
+                                            uint32_t maxNum) {
+    // 克隆时并发下发的创建clone chunk或recover chunk请求在队列中排队，
+    // 一起下发，发给同一个chunkserver的请求在作用域结束时合并发送
+    OpType type = ctx->optype_;
+    CloneBatchScope scope(type, maxNum);
+    ProcessOne(ctx);
+    auto isSameType = [type](BBQItem<RequestContext*>& item) {
+        return !item.IsStop() && item.Item()->optype_ == type;
+    };
+    BBQItem<RequestContext*> item(nullptr);
+    for (uint32_t i = 1;
+         i < maxNum && queue_.TakeFrontIf(isSameType, &item); ++i) {
+        ProcessOne(item.Item());
+    }
+}
+
+bool RequestScheduler::CanMergeWrite(const RequestContext* prev,
+                                     const RequestContext* next) {
+    // 重试的请求有自己的超时退避，clone请求需要源文件信息，都不合并
+    return next->optype_ == OpType::WRITE &&
+           next->idinfo_.cid_ == prev->idinfo_.cid_ &&
+           next->idinfo_.cpid_ == prev->idinfo_.cpid_ &&
+           next->idinfo_.lpid_ == prev->idinfo_.lpid_ &&
+           next->offset_ == prev->offset_ +
+                                static_cast<off_t>(prev->rawlength_) &&
+           next->seq_ == prev->seq_ &&
+           next->fileId_ == prev->fileId_ &&
+           next->epoch_ == prev->epoch_ &&
+           !next->sourceInfo_.IsValid() &&
+           next->done_->GetRetriedTimes() == 0;
+}
+
+void RequestScheduler::ProcessWrites(RequestContext* ctx) {
+    if (ctx->sourceInfo_.IsValid() || ctx->done_->GetRetriedTimes() != 0) {
+        ProcessOne(ctx);
+        return;
+    }
+
+    std::vector<RequestContext*> reqs{ctx};
+    size_t length = ctx->rawlength_;
+    uint32_t maxSize = reqschopt_.writeMergeMaxSize;
+    auto adjacent = [&](BBQItem<RequestContext*>& item) {
+        return !item.IsStop() &&
+               length + item.Item()->rawlength_ <= maxSize &&
+               CanMergeWrite(reqs.back(), item.Item());
+    };
+
+    // 只在队列为空时等待，队首是其他请求时不再推迟它们的下发
+    BBQItem<RequestContext*> item(nullptr);
+    uint64_t deadline =
+        TimeUtility::GetTimeofDayUs() + reqschopt_.writeMergeWindowUs;
+    while (length < maxSize) {
+        if (queue_.TakeFrontIf(adjacent, &item)) {
+            reqs.push_back(item.Item());
+            length += item.Item()->rawlength_;
+            continue;
+        }
+        if (!queue_.Empty() || TimeUtility::GetTimeofDayUs() >= deadline) {
+            break;
+        }
+    }
+
+    if (reqs.size() == 1) {
+        ProcessOne(ctx);
+        return;
+    }
+
+    RequestContext* merged = new RequestContext();
+    merged->optype_ = OpType::WRITE;
+    merged->idinfo_ = ctx->idinfo_;
+    merged->offset_ = ctx->offset_;
+    merged->rawlength_ = length;
+    merged->fileId_ = ctx->fileId_;
+    merged->epoch_ = ctx->epoch_;
+    merged->seq_ = ctx->seq_;
+    merged->priority_ = ctx->priority_;
+    for (auto req : reqs) {
+        merged->writeData_.append(req->writeData_);
+    }
+    merged->done_ = new MergedWriteClosure(merged, std::move(reqs));
+    merged->done_->SetIOTracker(ctx->done_->GetIOTracker());
+    merged->done_->SetFileMetric(ctx->done_->GetMetric());
+    merged->done_->SetIOManager(ctx->done_->GetIOManager());
+    ProcessOne(merged);
+}
+
 void RequestScheduler::ProcessOne(RequestContext* ctx) {
     brpc::ClosureGuard guard(ctx->done_);
 
+    if (ctx->traced_ && ctx->dispatchUs_ == 0) {
+        ctx->dispatchUs_ = TimeUtility::GetTimeofDayUs();
+    }
+
     switch (ctx->optype_) {
         case OpType::READ:
             ctx->done_->GetInflightRPCToken();
@@ -140,6 +140,40 @@ class RequestScheduler : public Uncopyable {
 
     void ProcessOne(RequestContext* ctx);
 
+    /**
+     * 开启了run to completion，且队列为空、session有效时，由提交请求的线程
+     * 直接下发请求
+     */
+    bool CanProcessDirectly();
+
+    /**
+     * 忙等scheduleBusyPollUs从队列中取请求
+     * @return 取到请求返回true，没有开启忙等或者超时返回false
+     */
+    bool PollQueue(BBQItem<RequestContext*>* item);
+
+    /**
+     * 下发读请求及队列中紧随其后的读请求，发给同一个chunkserver的读请求合并发送
+     */
+    void ProcessReads(RequestContext* ctx);
+
+    /**
+     * 下发创建clone chunk或recover chunk的请求及队列中紧随其后的同类请求，
+     * 发给同一个chunkserver的请求最多maxNum个合并发送
+     */
+    void ProcessCloneRequests(RequestContext* ctx, uint32_t maxNum);
+
+    /**
+     * 在writeMergeWindowUs内等待同一个chunk上紧接着的写请求，合并后一起下发
+     */
+    void ProcessWrites(RequestContext* ctx);
+
+    /**
+     * next能否追加到prev之后合并发送
+     */
+    static bool CanMergeWrite(const RequestContext* prev,
+                              const RequestContext* next);
+
     void WaitValidSession() {
         // lease续约失败的时候需要阻塞IO直到续约成功
         if (blockIO_.load(std::memory_order_acquire) && blockingQueue_) {
@@ -21,13 +21,20 @@
  */
 
 #include "src/client/request_sender.h"
+#include <bthread/unstable.h>
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "proto/chunk.pb.h"
 #include "src/common/timeutility.h"
 #include "src/client/request_closure.h"
+#include "src/client/request_context.h"
 #include "src/common/location_operator.h"
 
 namespace curve {
@@ -36,11 +43,276 @@ namespace client {
 using curve::chunkserver::ChunkRequest;
 using curve::chunkserver::ChunkResponse;
 using curve::chunkserver::ChunkService_Stub;
+using curve::chunkserver::CreateCloneChunksRequest;
+using curve::chunkserver::CreateCloneChunksResponse;
 using curve::chunkserver::GetChunkInfoRequest;
 using curve::chunkserver::GetChunkInfoResponse;
+using curve::chunkserver::ReadChunksRequest;
+using curve::chunkserver::RecoverChunksRequest;
+using curve::chunkserver::RecoverChunksResponse;
+using curve::chunkserver::ReadChunksResponse;
 using curve::common::TimeUtility;
 using ::google::protobuf::Closure;
 
+namespace {
+
+thread_local ReadBatchScope* currentReadBatchScope = nullptr;
+thread_local CloneBatchScope* currentCloneBatchScope = nullptr;
+
+// ReadChunks rpc返回后，把结果拆分给各个读请求的closure
+class ReadChunksClosure : public Closure {
+ public:
+    explicit ReadChunksClosure(std::vector<BatchedRequest>* reads) {
+        reads_.swap(*reads);
+    }
+
+    void Run() override {
+        std::unique_ptr<ReadChunksClosure> selfGuard(this);
+        butil::IOBuf& data = cntl_.response_attachment();
+        for (size_t i = 0; i < reads_.size(); ++i) {
+            BatchedRequest& read = reads_[i];
+            if (cntl_.Failed()) {
+                read.cntl->SetFailed(cntl_.ErrorCode(), "%s",
+                                     cntl_.ErrorText().c_str());
+            } else if (i >= static_cast<size_t>(response_.responses_size())) {
+                read.cntl->SetFailed(brpc::ERESPONSE,
+                                     "missing response in ReadChunks");
+            } else {
+                read.response->Swap(response_.mutable_responses(i));
+                if (read.response->status() ==
+                        curve::chunkserver::CHUNK_OP_STATUS_SUCCESS &&
+                    data.cutn(&read.cntl->response_attachment(),
+                              read.request.size()) != read.request.size()) {
+                    read.cntl->SetFailed(brpc::ERESPONSE,
+                                         "missing data in ReadChunks");
+                }
+            }
+            read.done->SetBatchLatencyUs(cntl_.latency_us());
+            read.done->Run();
+        }
+    }
+
+    brpc::Controller* GetCntl() {
+        return &cntl_;
+    }
+
+    ReadChunksResponse* GetResponse() {
+        return &response_;
+    }
+
+    const std::vector<BatchedRequest>& GetReads() const {
+        return reads_;
+    }
+
+ private:
+    brpc::Controller cntl_;
+    ReadChunksResponse response_;
+    std::vector<BatchedRequest> reads_;
+};
+
+// CreateCloneChunks、RecoverChunks rpc返回后，把结果拆分给各个请求的closure
+template <typename Response>
+class BatchedChunksClosure : public Closure {
+ public:
+    explicit BatchedChunksClosure(std::vector<BatchedRequest>* requests) {
+        requests_.swap(*requests);
+    }
+
+    void Run() override {
+        std::unique_ptr<BatchedChunksClosure> selfGuard(this);
+        for (size_t i = 0; i < requests_.size(); ++i) {
+            BatchedRequest& req = requests_[i];
+            if (cntl_.Failed()) {
+                req.cntl->SetFailed(cntl_.ErrorCode(), "%s",
+                                    cntl_.ErrorText().c_str());
+            } else if (i >= static_cast<size_t>(response_.responses_size())) {
+                req.cntl->SetFailed(brpc::ERESPONSE,
+                                    "missing response in batched rpc");
+            } else {
+                req.response->Swap(response_.mutable_responses(i));
+            }
+            req.done->SetBatchLatencyUs(cntl_.latency_us());
+            req.done->Run();
+        }
+    }
+
+    brpc::Controller* GetCntl() {
+        return &cntl_;
+    }
+
+    Response* GetResponse() {
+        return &response_;
+    }
+
+    const std::vector<BatchedRequest>& GetRequests() const {
+        return requests_;
+    }
+
+    // 超时时间取各个请求中最长的
+    template <typename Request>
+    void BuildRequest(Request* request) {
+        int64_t timeoutMs = 0;
+        for (const BatchedRequest& req : requests_) {
+            *request->add_requests() = req.request;
+            timeoutMs = std::max(timeoutMs, req.cntl->timeout_ms());
+        }
+        cntl_.set_timeout_ms(timeoutMs);
+    }
+
+ private:
+    brpc::Controller cntl_;
+    Response response_;
+    std::vector<BatchedRequest> requests_;
+};
+
+// 对冲读，同一个读请求最多发给两个副本，先成功返回的结果交给done，
+// 都失败时把后返回的结果交给done，按正常流程重试。
+// 原请求、定时器、对冲请求各持有一个引用，都结束后释放
+class HedgedRead {
+ public:
+    HedgedRead(ClientClosure* done, const ChunkRequest& request,
+               uint64_t timeoutMs, std::shared_ptr<RequestSender> primary,
+               std::shared_ptr<RequestSender> hedge)
+        : done_(done),
+          metric_(static_cast<RequestClosure*>(done->GetClosure())
+                      ->GetMetric()),
+          request_(request),
+          timeoutMs_(timeoutMs),
+          primary_(this, std::move(primary)),
+          hedge_(this, std::move(hedge)),
+          pending_(0),
+          timerArmed_(false),
+          refs_(1) {}
+
+    void Start(uint64_t delayUs) {
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            pending_ = 1;
+            refs_.fetch_add(1, std::memory_order_relaxed);
+            if (0 == bthread_timer_add(&timer_,
+                                       butil::microseconds_from_now(delayUs),
+                                       OnTimer, this)) {
+                timerArmed_ = true;
+                refs_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        Send(&primary_);
+        Unref();
+    }
+
+ private:
+    struct Attempt : public Closure {
+        Attempt(HedgedRead* read, std::shared_ptr<RequestSender> sender)
+            : read(read), sender(std::move(sender)) {}
+
+        void Run() override {
+            read->OnComplete(this);
+        }
+
+        HedgedRead* read;
+        std::shared_ptr<RequestSender> sender;
+        brpc::Controller* cntl = nullptr;
+        ChunkResponse* response = nullptr;
+    };
+
+    void Send(Attempt* attempt) {
+        attempt->cntl = new brpc::Controller();
+        attempt->cntl->set_timeout_ms(timeoutMs_);
+        attempt->response = new ChunkResponse();
+        attempt->sender->SendReadChunk(attempt->cntl, &request_,
+                                       attempt->response, attempt);
+    }
+
+    static void OnTimer(void* arg) {
+        HedgedRead* read = static_cast<HedgedRead*>(arg);
+        bool send = false;
+        {
+            std::lock_guard<std::mutex> lk(read->mtx_);
+            read->timerArmed_ = false;
+            if (read->done_ != nullptr) {
+                send = true;
+                ++read->pending_;
+                read->refs_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (send) {
+            if (read->metric_ != nullptr) {
+                read->metric_->hedgedReadMetric.sent << 1;
+            }
+            read->Send(&read->hedge_);
+        }
+        read->Unref();
+    }
+
+    void OnComplete(Attempt* attempt) {
+        bool finished = false;
+        if (!attempt->cntl->Failed()) {
+            attempt->sender->RecordReadLatency(attempt->cntl->latency_us());
+            auto status = attempt->response->status();
+            finished =
+                status == curve::chunkserver::CHUNK_OP_STATUS_SUCCESS ||
+                status == curve::chunkserver::CHUNK_OP_STATUS_CHUNK_NOTEXIST;
+        }
+
+        ClientClosure* done = nullptr;
+        bool cancelTimer = false;
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            --pending_;
+            if (done_ != nullptr && (finished || pending_ == 0)) {
+                done = done_;
+                done_ = nullptr;
+                cancelTimer = timerArmed_;
+                timerArmed_ = false;
+            }
+        }
+
+        // 定时器已经在执行时由定时器释放自己的引用
+        if (cancelTimer && 0 == bthread_timer_del(timer_)) {
+            Unref();
+        }
+
+        std::unique_ptr<brpc::Controller> cntl(attempt->cntl);
+        std::unique_ptr<ChunkResponse> response(attempt->response);
+        attempt->cntl = nullptr;
+        attempt->response = nullptr;
+        if (done != nullptr) {
+            if (attempt == &hedge_ && finished && metric_ != nullptr) {
+                metric_->hedgedReadMetric.won << 1;
+            }
+            done->SetCntl(cntl.release());
+            done->SetResponse(response.release());
+            done->SetChunkServerID(attempt->sender->GetChunkServerID());
+            done->SetChunkServerEndPoint(
+                attempt->sender->GetChunkServerEndPoint());
+            done->Run();
+        }
+        Unref();
+    }
+
+    void Unref() {
+        if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    std::mutex mtx_;
+    // 结果交给done之后置为空
+    ClientClosure* done_;
+    FileMetric* metric_;
+    const ChunkRequest request_;
+    const uint64_t timeoutMs_;
+    Attempt primary_;
+    Attempt hedge_;
+    // 没有返回的请求数
+    int pending_;
+    bool timerArmed_;
+    bthread_timer_t timer_;
+    std::atomic<int> refs_;
+};
+
+}  // namespace
+
 inline void RequestSender::UpdateRpcRPS(ClientClosure* done,
                                         OpType type) const {
     RequestClosure* request = static_cast<RequestClosure*>(done->GetClosure());
@@ -61,6 +333,15 @@ inline void RequestSender::SetRpcStuff(
     done->SetChunkServerEndPoint(serverEndPoint_);
 }
 
+inline void RequestSender::SetPriority(ClientClosure* done,
+                                       ChunkRequest* request) const {
+    RequestClosure* closure = static_cast<RequestClosure*>(done->GetClosure());
+    RequestContext* ctx = closure->GetReqCtx();
+    if (ctx != nullptr && ctx->priority_ != LIBCURVE_IO_PRIORITY_NORMAL) {
+        request->set_priority(ctx->priority_);
+    }
+}
+
 int RequestSender::Init(const IOSenderOption& ioSenderOpt) {
     if (0 != channel_.Init(serverEndPoint_, NULL)) {
         LOG(ERROR) << "failed to init channel to server, id: " << chunkServerId_
@@ -94,18 +375,129 @@ int RequestSender::ReadChunk(const ChunkIDInfo& idinfo,
     request.set_chunkid(idinfo.cid_);
     request.set_offset(offset);
     request.set_size(length);
+    if (iosenderopt_.readFromFollower) {
+        request.set_readfromfollower(true);
+    }
+    SetPriority(done, &request);
 
     if (sourceInfo.IsValid()) {
         request.set_clonefilesource(sourceInfo.cloneFileSource);
         request.set_clonefileoffset(sourceInfo.cloneFileOffset);
     }
 
+    ReadBatchScope* scope = ReadBatchScope::Current();
+    if (nullptr != scope) {
+        scope->Add(this, BatchedRequest{std::move(request), cntl, response,
+                                     doneGuard.release()});
+        return 0;
+    }
+
     ChunkService_Stub stub(&channel_);
     stub.ReadChunk(cntl, &request, response, doneGuard.release());
 
     return 0;
 }
 
+int RequestSender::HedgedReadChunk(const ChunkIDInfo& idinfo,
+                                   off_t offset,
+                                   size_t length,
+                                   std::shared_ptr<RequestSender> hedgeSender,
+                                   ClientClosure *done) {
+    UpdateRpcRPS(done, OpType::READ);
+    done->SetChunkServerID(chunkServerId_);
+    done->SetChunkServerEndPoint(serverEndPoint_);
+
+    ChunkRequest request;
+    request.set_optype(curve::chunkserver::CHUNK_OP_TYPE::CHUNK_OP_READ);
+    request.set_logicpoolid(idinfo.lpid_);
+    request.set_copysetid(idinfo.cpid_);
+    request.set_chunkid(idinfo.cid_);
+    request.set_offset(offset);
+    request.set_size(length);
+    request.set_readfromfollower(true);
+    SetPriority(done, &request);
+
+    RequestClosure* closure = static_cast<RequestClosure*>(done->GetClosure());
+    uint64_t timeoutMs =
+        std::max(closure->GetNextTimeoutMS(),
+                 iosenderopt_.failRequestOpt.chunkserverRPCTimeoutMS);
+    HedgedRead* read = new HedgedRead(done, request, timeoutMs,
+                                      shared_from_this(),
+                                      std::move(hedgeSender));
+    read->Start(HedgeDelayUs());
+    return 0;
+}
+
+void RequestSender::SendReadChunk(brpc::Controller* cntl,
+                                  const ChunkRequest* request,
+                                  ChunkResponse* response,
+                                  Closure* done) {
+    ChunkService_Stub stub(&channel_);
+    stub.ReadChunk(cntl, request, response, done);
+}
+
+uint64_t RequestSender::HedgeDelayUs() const {
+    const HedgedReadOption& option = iosenderopt_.hedgedReadOpt;
+    int64_t latencyUs = readLatency_.latency_percentile(
+        option.latencyPercentile);
+    return std::max<uint64_t>(option.minDelayUs,
+                              latencyUs > 0 ? latencyUs : 0);
+}
+
+void RequestSender::SendReadChunks(std::vector<BatchedRequest>* reads) {
+    ChunkService_Stub stub(&channel_);
+    if (reads->size() == 1) {
+        BatchedRequest& read = reads->front();
+        stub.ReadChunk(read.cntl, &read.request, read.response, read.done);
+        reads->clear();
+        return;
+    }
+
+    ReadChunksClosure* done = new ReadChunksClosure(reads);
+    ReadChunksRequest request;
+    int64_t timeoutMs = 0;
+    for (const BatchedRequest& read : done->GetReads()) {
+        *request.add_requests() = read.request;
+        timeoutMs = std::max(timeoutMs, read.cntl->timeout_ms());
+    }
+    done->GetCntl()->set_timeout_ms(timeoutMs);
+    stub.ReadChunks(done->GetCntl(), &request, done->GetResponse(), done);
+}
+
+void RequestSender::SendCreateCloneChunks(
+    std::vector<BatchedRequest>* creates) {
+    ChunkService_Stub stub(&channel_);
+    if (creates->size() == 1) {
+        BatchedRequest& create = creates->front();
+        stub.CreateCloneChunk(create.cntl, &create.request, create.response,
+                              create.done);
+        creates->clear();
+        return;
+    }
+
+    auto* done = new BatchedChunksClosure<CreateCloneChunksResponse>(creates);
+    CreateCloneChunksRequest request;
+    done->BuildRequest(&request);
+    stub.CreateCloneChunks(done->GetCntl(), &request, done->GetResponse(),
+                           done);
+}
+
+void RequestSender::SendRecoverChunks(std::vector<BatchedRequest>* recovers) {
+    ChunkService_Stub stub(&channel_);
+    if (recovers->size() == 1) {
+        BatchedRequest& recover = recovers->front();
+        stub.RecoverChunk(recover.cntl, &recover.request, recover.response,
+                          recover.done);
+        recovers->clear();
+        return;
+    }
+
+    auto* done = new BatchedChunksClosure<RecoverChunksResponse>(recovers);
+    RecoverChunksRequest request;
+    done->BuildRequest(&request);
+    stub.RecoverChunks(done->GetCntl(), &request, done->GetResponse(), done);
+}
+
 int RequestSender::WriteChunk(const ChunkIDInfo& idinfo,
                               uint64_t fileId,
                               uint64_t epoch,
@@ -137,6 +529,7 @@ int RequestSender::WriteChunk(const ChunkIDInfo& idinfo,
     if (epoch != 0) {
         request.set_epoch(epoch);
     }
+    SetPriority(done, &request);
 
     if (sourceInfo.IsValid()) {
         request.set_clonefilesource(sourceInfo.cloneFileSource);
@@ -242,6 +635,13 @@ int RequestSender::CreateCloneChunk(const ChunkIDInfo& idinfo,
     request.set_correctedsn(correntSn);
     request.set_size(chunkSize);
 
+    CloneBatchScope* scope = CloneBatchScope::Current();
+    if (nullptr != scope && scope->GetType() == OpType::CREATE_CLONE) {
+        scope->Add(this, BatchedRequest{std::move(request), cntl, response,
+                                        doneGuard.release()});
+        return 0;
+    }
+
     ChunkService_Stub stub(&channel_);
     stub.CreateCloneChunk(cntl, &request, response, doneGuard.release());
 
@@ -267,6 +667,13 @@ int RequestSender::RecoverChunk(const ChunkIDInfo& idinfo,
     request.set_offset(offset);
     request.set_size(len);
 
+    CloneBatchScope* scope = CloneBatchScope::Current();
+    if (nullptr != scope && scope->GetType() == OpType::RECOVER_CHUNK) {
+        scope->Add(this, BatchedRequest{std::move(request), cntl, response,
+                                        doneGuard.release()});
+        return 0;
+    }
+
     ChunkService_Stub stub(&channel_);
     stub.RecoverChunk(cntl, &request, response, doneGuard.release());
 
@@ -280,5 +687,69 @@ int RequestSender::ResetSender(ChunkServerID chunkServerId,
     return Init(iosenderopt_);
 }
 
+ReadBatchScope::ReadBatchScope(uint32_t maxNum) : maxNum_(maxNum) {
+    CHECK(nullptr == currentReadBatchScope)
+        << "read batch scope can not be nested";
+    currentReadBatchScope = this;
+}
+
+ReadBatchScope::~ReadBatchScope() {
+    currentReadBatchScope = nullptr;
+    for (auto& item : reads_) {
+        if (!item.second.empty()) {
+            item.first->SendReadChunks(&item.second);
+        }
+    }
+}
+
+ReadBatchScope* ReadBatchScope::Current() {
+    return currentReadBatchScope;
+}
+
+void ReadBatchScope::Add(RequestSender* sender, BatchedRequest&& read) {
+    std::vector<BatchedRequest>& reads = reads_[sender];
+    reads.emplace_back(std::move(read));
+    if (reads.size() >= maxNum_) {
+        sender->SendReadChunks(&reads);
+    }
+}
+
+CloneBatchScope::CloneBatchScope(OpType type, uint32_t maxNum)
+    : type_(type), maxNum_(maxNum) {
+    CHECK(nullptr == currentCloneBatchScope)
+        << "clone batch scope can not be nested";
+    currentCloneBatchScope = this;
+}
+
+CloneBatchScope::~CloneBatchScope() {
+    currentCloneBatchScope = nullptr;
+    for (auto& item : requests_) {
+        if (!item.second.empty()) {
+            Send(item.first, &item.second);
+        }
+    }
+}
+
+CloneBatchScope* CloneBatchScope::Current() {
+    return currentCloneBatchScope;
+}
+
+void CloneBatchScope::Add(RequestSender* sender, BatchedRequest&& request) {
+    std::vector<BatchedRequest>& requests = requests_[sender];
+    requests.emplace_back(std::move(request));
+    if (requests.size() >= maxNum_) {
+        Send(sender, &requests);
+    }
+}
+
+void CloneBatchScope::Send(RequestSender* sender,
+                           std::vector<BatchedRequest>* requests) {
+    if (type_ == OpType::RECOVER_CHUNK) {
+        sender->SendRecoverChunks(requests);
+    } else {
+        sender->SendCreateCloneChunks(requests);
+    }
+}
+
 }   // namespace client
 }   // namespace curve
@@ -26,23 +26,36 @@
 #include <brpc/channel.h>
 #include <butil/endpoint.h>
 #include <butil/iobuf.h>
+#include <bvar/bvar.h>
 
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "src/client/client_config.h"
 #include "src/client/client_common.h"
 #include "src/client/chunk_closure.h"
 #include "include/curve_compiler_specific.h"
 #include "src/client/request_context.h"
+#include "src/common/uncopyable.h"
 
 namespace curve {
 namespace client {
 
+// 等待合并发送的请求
+struct BatchedRequest {
+    curve::chunkserver::ChunkRequest request;
+    brpc::Controller* cntl;
+    ChunkResponse* response;
+    ClientClosure* done;
+};
+
 /**
  * 一个RequestSender负责管理一个ChunkServer的所有
  * connection，目前一个ChunkServer仅有一个connection
  */
-class RequestSender {
+class RequestSender : public std::enable_shared_from_this<RequestSender> {
  public:
     RequestSender(ChunkServerID chunkServerId,
                   butil::EndPoint serverEndPoint)
@@ -69,6 +82,22 @@ class RequestSender {
                   const RequestSourceInfo& sourceInfo,
                   ClientClosure *done);
 
+    /**
+     * 对冲读Chunk，先发给当前chunkserver，超过当前chunkserver读延时的
+     * 分位值还没有返回时，把同样的请求发给hedgeSender，先成功返回的结果
+     * 交给done，对冲读的请求不参与合并
+     * @param idinfo为chunk相关的id信息
+     * @param offset:读的偏移
+     * @param length:读的长度
+     * @param hedgeSender:对冲请求发给的副本
+     * @param done:上一层异步回调的closure
+     */
+    int HedgedReadChunk(const ChunkIDInfo& idinfo,
+                        off_t offset,
+                        size_t length,
+                        std::shared_ptr<RequestSender> hedgeSender,
+                        ClientClosure *done);
+
     /**
    * 写Chunk
    * @param idinfo为chunk相关的id信息
@@ -175,11 +204,58 @@ class RequestSender {
     }
 
  private:
+    friend class ReadBatchScope;
+    friend class CloneBatchScope;
+
+    /**
+     * 把读请求合并成一个ReadChunks rpc发送，只有一个请求时用ReadChunk发送，
+     * 各个读请求的结果分别交给自己的closure处理
+     */
+    void SendReadChunks(std::vector<BatchedRequest>* reads);
+
+    /**
+     * 把创建clone chunk的请求合并成一个CreateCloneChunks rpc发送，
+     * 只有一个请求时用CreateCloneChunk发送
+     */
+    void SendCreateCloneChunks(std::vector<BatchedRequest>* creates);
+
+    /**
+     * 把recover chunk的请求合并成一个RecoverChunks rpc发送，
+     * 只有一个请求时用RecoverChunk发送
+     */
+    void SendRecoverChunks(std::vector<BatchedRequest>* recovers);
+
     void UpdateRpcRPS(ClientClosure* done, OpType type) const;
 
     void SetRpcStuff(ClientClosure* done, brpc::Controller* cntl,
                      google::protobuf::Message* rpcResponse) const;
 
+    ChunkServerID GetChunkServerID() const {
+        return chunkServerId_;
+    }
+
+    const butil::EndPoint& GetChunkServerEndPoint() const {
+        return serverEndPoint_;
+    }
+
+    // 对冲读时直接发送一个读请求
+    void SendReadChunk(brpc::Controller* cntl,
+                       const curve::chunkserver::ChunkRequest* request,
+                       ChunkResponse* response,
+                       google::protobuf::Closure* done);
+
+    // 统计对冲读时发给当前chunkserver的读请求的延时
+    void RecordReadLatency(int64_t latencyUs) {
+        readLatency_ << latencyUs;
+    }
+
+    // 发送对冲请求前的等待时间
+    uint64_t HedgeDelayUs() const;
+
+    // 低优先级的请求在rpc中携带优先级，正常优先级的不设置
+    void SetPriority(ClientClosure* done,
+                     curve::chunkserver::ChunkRequest* request) const;
+
  private:
     // Rpc stub配置
     IOSenderOption iosenderopt_;
@@ -188,6 +264,62 @@ class RequestSender {
     // ChunkServer 的地址
     butil::EndPoint serverEndPoint_;
     brpc::Channel channel_; /* TODO(wudemiao): 后期会维护多个 channel */
+    // 读请求的延时，用于计算对冲读的等待时间，不对外暴露
+    bvar::LatencyRecorder readLatency_;
+};
+
+/**
+ * 读请求合并的作用域，作用域内当前线程通过RequestSender下发的读请求先缓存起来，
+ * 发给同一个chunkserver的读请求缓存到maxNum个或者作用域结束时，合并成一个
+ * ReadChunks rpc发送。作用域外下发的读请求（例如重试的请求）直接发送
+ */
+class ReadBatchScope : public curve::common::Uncopyable {
+ public:
+    explicit ReadBatchScope(uint32_t maxNum);
+    ~ReadBatchScope();
+
+    // 当前线程所在的作用域，不在作用域内返回nullptr
+    static ReadBatchScope* Current();
+
+    void Add(RequestSender* sender, BatchedRequest&& read);
+
+ private:
+    uint32_t maxNum_;
+    std::unordered_map<RequestSender*, std::vector<BatchedRequest>> reads_;
+};
+
+/**
+ * 克隆请求合并的作用域，和ReadBatchScope一样，发给同一个chunkserver的
+ * type类型的请求缓存到maxNum个或者作用域结束时，创建clone chunk请求合并成
+ * 一个CreateCloneChunks rpc发送，recover chunk请求合并成一个RecoverChunks
+ * rpc发送。重试的请求不在作用域内，单独发送
+ */
+class CloneBatchScope : public curve::common::Uncopyable {
+ public:
+    /**
+     * @param type 合并的请求类型，CREATE_CLONE或RECOVER_CHUNK
+     * @param maxNum 合并成一个rpc的请求的最大数量
+     */
+    CloneBatchScope(OpType type, uint32_t maxNum);
+    ~CloneBatchScope();
+
+    // 当前线程所在的作用域，不在作用域内返回nullptr
+    static CloneBatchScope* Current();
+
+    OpType GetType() const {
+        return type_;
+    }
+
+    void Add(RequestSender* sender, BatchedRequest&& request);
+
+ private:
+    void Send(RequestSender* sender, std::vector<BatchedRequest>* requests);
+
+ private:
+    OpType type_;
+    uint32_t maxNum_;
+    std::unordered_map<RequestSender*, std::vector<BatchedRequest>>
+        requests_;
 };
 
 }   // namespace client
@@ -30,24 +30,48 @@
 namespace curve {
 namespace client {
 
-struct CurveAioCombineContext {
-    RequestClosure* done;
-    CurveAioContext curveCtx;
+struct SourceReader::InflightRead {
+    struct AioContext {
+        InflightRead* read;
+        CurveAioContext curveCtx;
+    };
+
+    InflightKey key;
+    // 是否登记在inflightReads_中
+    bool merged;
+    butil::IOBuf data;
+    // 等待该区间数据的请求，第一个是下发读的请求
+    std::vector<RequestContext*> waiters;
+    AioContext aio;
 };
 
-void CurveAioCallback(struct CurveAioContext* context) {
-    auto curveCombineCtx = reinterpret_cast<CurveAioCombineContext *>(
-        reinterpret_cast<char *>(context) -
-        offsetof(CurveAioCombineContext, curveCtx));
-    RequestClosure* done = curveCombineCtx->done;
-    if (context->ret < 0) {
-        done->SetFailed(LIBCURVE_ERROR::FAILED);
-    } else {
-        done->SetFailed(LIBCURVE_ERROR::OK);
+void SourceReader::OnReadDone(CurveAioContext* context) {
+    auto aio = reinterpret_cast<InflightRead::AioContext*>(
+        reinterpret_cast<char*>(context) -
+        offsetof(InflightRead::AioContext, curveCtx));
+    InflightRead* read = aio->read;
+
+    std::vector<RequestContext*> waiters;
+    {
+        SourceReader& reader = GetInstance();
+        std::lock_guard<std::mutex> lk(reader.inflightMtx_);
+        if (read->merged) {
+            reader.inflightReads_.erase(read->key);
+        }
+        waiters.swap(read->waiters);
     }
 
-    delete curveCombineCtx;
-    brpc::ClosureGuard doneGuard(done);
+    int errcode = context->ret < 0 ? LIBCURVE_ERROR::FAILED
+                                   : LIBCURVE_ERROR::OK;
+    for (auto reqCtx : waiters) {
+        if (errcode == LIBCURVE_ERROR::OK) {
+            reqCtx->readData_ = read->data;
+        }
+        reqCtx->done_->SetFailed(errcode);
+        brpc::ClosureGuard doneGuard(reqCtx->done_);
+    }
+
+    delete read;
 }
 
 SourceReader::ReadHandler::~ReadHandler() {
@@ -58,6 +82,10 @@ SourceReader::ReadHandler::~ReadHandler() {
     }
 }
 
+SourceReader::SourceReader()
+    : running_(false),
+      mergedReads_("curve_client_source_reader_merged_reads") {}
+
 SourceReader::~SourceReader() {
     Stop();
 }
@@ -122,8 +150,14 @@ SourceReader::ReadHandler* SourceReader::GetReadHandler(
         }
     }
 
+    // 克隆卷的源文件一般被顺序读，可以打开预读
+    FileServiceOption option = fileOption_;
+    if (fileOption_.ioOpt.sourceReaderOpt.readAhead) {
+        option.ioOpt.readAheadOpt.enable = true;
+    }
+
     FileInstance* instance = FileInstance::Open4Readonly(
-        fileOption_, mdsclient->shared_from_this(), fileName, userInfo);
+        option, mdsclient->shared_from_this(), fileName, userInfo);
     if (instance == nullptr) {
         return nullptr;
     }
@@ -153,17 +187,15 @@ int SourceReader::Read(const std::vector<RequestContext*>& reqCtxVec,
     static std::once_flag flag;
     std::call_once(flag, []() { GetInstance().Run(); });
 
+    const bool mergeInflight =
+        fileOption_.ioOpt.sourceReaderOpt.mergeInflightReads;
+
     for (auto reqCtx : reqCtxVec) {
         brpc::ClosureGuard doneGuard(reqCtx->done_);
-        std::string fileName = reqCtx->sourceInfo_.cloneFileSource;
-        CurveAioCombineContext* curveCombineCtx = new CurveAioCombineContext();
-        curveCombineCtx->done = reqCtx->done_;
-        curveCombineCtx->curveCtx.offset =
-            reqCtx->sourceInfo_.cloneFileOffset + reqCtx->offset_;
-        curveCombineCtx->curveCtx.length = reqCtx->rawlength_;
-        curveCombineCtx->curveCtx.buf = &reqCtx->readData_;
-        curveCombineCtx->curveCtx.op = LIBCURVE_OP::LIBCURVE_OP_READ;
-        curveCombineCtx->curveCtx.cb = CurveAioCallback;
+        const std::string& fileName = reqCtx->sourceInfo_.cloneFileSource;
+        InflightKey key{fileName,
+                        reqCtx->sourceInfo_.cloneFileOffset + reqCtx->offset_,
+                        reqCtx->rawlength_};
 
         ReadHandler* handler = GetReadHandler(fileName, userInfo, mdsClient);
         if (handler == nullptr) {
@@ -171,12 +203,49 @@ int SourceReader::Read(const std::vector<RequestContext*>& reqCtxVec,
             return -1;
         }
 
-        int ret = handler->file_->AioRead(&curveCombineCtx->curveCtx,
+        InflightRead* read = new InflightRead();
+        read->key = key;
+        read->merged = mergeInflight;
+        read->waiters.push_back(reqCtx);
+        read->aio.read = read;
+        read->aio.curveCtx.offset = key.offset;
+        read->aio.curveCtx.length = key.length;
+        read->aio.curveCtx.buf = &read->data;
+        read->aio.curveCtx.op = LIBCURVE_OP::LIBCURVE_OP_READ;
+        read->aio.curveCtx.cb = &SourceReader::OnReadDone;
+
+        if (mergeInflight) {
+            std::lock_guard<std::mutex> lk(inflightMtx_);
+            auto res = inflightReads_.emplace(key, read);
+            if (!res.second) {
+                // 该区间已经在读，等待其结果即可
+                res.first->second->waiters.push_back(reqCtx);
+                mergedReads_ << 1;
+                delete read;
+                doneGuard.release();
+                continue;
+            }
+        }
+
+        int ret = handler->file_->AioRead(&read->aio.curveCtx,
                                           UserDataType::IOBuffer);
         if (ret != LIBCURVE_ERROR::OK) {
             LOG(ERROR) << "Read curve failed failed, filename = " << fileName
                        << ", error = " << ret;
-            delete curveCombineCtx;
+            // 已经合并进来的请求也一并失败
+            std::vector<RequestContext*> waiters;
+            {
+                std::lock_guard<std::mutex> lk(inflightMtx_);
+                if (mergeInflight) {
+                    inflightReads_.erase(key);
+                }
+                waiters.swap(read->waiters);
+            }
+            for (size_t i = 1; i < waiters.size(); ++i) {
+                waiters[i]->done_->SetFailed(LIBCURVE_ERROR::FAILED);
+                brpc::ClosureGuard waiterGuard(waiters[i]->done_);
+            }
+            delete read;
             return -1;
         } else {
             doneGuard.release();
@@ -23,7 +23,10 @@
 #ifndef SRC_CLIENT_SOURCE_READER_H_
 #define SRC_CLIENT_SOURCE_READER_H_
 
+#include <bvar/bvar.h>
+
 #include <atomic>
+#include <functional>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -32,6 +35,7 @@
 #include <vector>
 #include <memory>
 
+#include "include/client/libcurve.h"
 #include "src/client/config_info.h"
 #include "src/common/interruptible_sleeper.h"
 
@@ -97,7 +101,7 @@ class SourceReader {
         const std::unordered_map<std::string, ReadHandler>& handlers);
 
  private:
-    SourceReader() = default;
+    SourceReader();
     ~SourceReader();
     SourceReader(const SourceReader&);
     SourceReader& operator=(const SourceReader&);
@@ -110,6 +114,33 @@ class SourceReader {
     ReadHandler* GetReadHandler(const std::string& fileName,
                                 const UserInfo& userInfo, MDSClient* mdsclient);
 
+    // 同一源文件的同一区间只向下发一次读，其余请求等待其结果
+    struct InflightKey {
+        std::string fileName;
+        uint64_t offset;
+        uint64_t length;
+
+        bool operator==(const InflightKey& other) const {
+            return offset == other.offset && length == other.length &&
+                   fileName == other.fileName;
+        }
+    };
+
+    struct InflightKeyHash {
+        size_t operator()(const InflightKey& key) const {
+            return std::hash<std::string>()(key.fileName) ^
+                   std::hash<uint64_t>()(key.offset) ^
+                   (std::hash<uint64_t>()(key.length) << 1);
+        }
+    };
+
+    struct InflightRead;
+
+    /**
+     * 源文件读完成的回调，将结果交给所有等待该区间的请求
+     */
+    static void OnReadDone(CurveAioContext* context);
+
  private:
     // the mutex lock for readHandlers_
     curve::common::RWLock rwLock_;
@@ -125,6 +156,16 @@ class SourceReader {
     std::unique_ptr<curve::common::InterruptibleSleeper> sleeper_;
 
     FileServiceOption fileOption_;
+
+    // the mutex lock for inflightReads_
+    std::mutex inflightMtx_;
+
+    // 正在读的源文件区间
+    std::unordered_map<InflightKey, InflightRead*, InflightKeyHash>
+        inflightReads_;
+
+    // 合并到已下发读上的请求数
+    bvar::Adder<uint64_t> mergedReads_;
 };
 
 }  // namespace client
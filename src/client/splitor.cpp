@@ -25,6 +25,9 @@
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -217,9 +220,32 @@ bool Splitor::GetOrAllocateSegment(bool allocateIfNotExist,
                                    const FInfo* fileInfo,
                                    const FileEpoch_t *fEpoch,
                                    ChunkIndex chunkidx) {
-    SegmentInfo segmentInfo;
+    // get the segments after this one with the same rpc, so that sequential
+    // io on a new file doesn't wait for mds on every segment
+    const uint64_t segmentSize = fileInfo->segmentsize;
+    const SegmentIndex segmentIndex = offset / segmentSize;
+    const uint64_t segmentCount = fileInfo->length / segmentSize;
+    uint32_t segmentNum = 1;
+    if (segmentIndex + 1 < segmentCount) {
+        segmentNum = std::min<uint64_t>(
+            std::max(iosplitopt_.fileSegmentBatchNum, 1u),
+            segmentCount - segmentIndex);
+    }
+
+    // the chunks of a segment are cleaned by the discard task under the
+    // write lock of the segment, hold the read locks of the segments after
+    // this one until their chunks are cached, otherwise chunks deallocated
+    // may be cached again
+    std::vector<std::unique_ptr<FileSegmentReadLockGuard>> extraLocks;
+    for (uint32_t i = 1; i < segmentNum; ++i) {
+        extraLocks.emplace_back(new FileSegmentReadLockGuard(
+            metaCache->GetFileSegment(segmentIndex + i)));
+    }
+
+    std::vector<SegmentInfo> segmentInfos;
     LIBCURVE_ERROR errCode = mdsClient->GetOrAllocateSegment(
-        allocateIfNotExist, offset, fileInfo, fEpoch, &segmentInfo);
+        allocateIfNotExist, offset, segmentNum, fileInfo, fEpoch,
+        &segmentInfos);
 
     if (errCode != LIBCURVE_ERROR::OK) {
         if (errCode == LIBCURVE_ERROR::NOT_ALLOCATE) {
@@ -241,43 +267,94 @@ bool Splitor::GetOrAllocateSegment(bool allocateIfNotExist,
         }
     }
 
-    const auto chunksize = fileInfo->chunksize;
-    uint32_t count = 0;
-    for (const auto& chunkIdInfo : segmentInfo.chunkvec) {
-        uint64_t chunkIdx =
-            (segmentInfo.startoffset + count * chunksize) / chunksize;
-        metaCache->UpdateChunkInfoByIndex(chunkIdx, chunkIdInfo);
-        ++count;
-    }
+    return CacheSegments(mdsClient, metaCache, fileInfo, segmentInfos);
+}
 
-    std::vector<CopysetInfo<ChunkServerID>> copysetInfos;
-    errCode = mdsClient->GetServerList(segmentInfo.lpcpIDInfo.lpid,
-                                       segmentInfo.lpcpIDInfo.cpidVec,
-                                       &copysetInfos);
+bool Splitor::WarmupSegments(MDSClient* mdsClient,
+                             MetaCache* metaCache,
+                             const FInfo* fileInfo) {
+    if (!iosplitopt_.fileSegmentWarmupOnOpen) {
+        return true;
+    }
 
-    if (errCode == LIBCURVE_ERROR::FAILED) {
-        std::string failedCopysets;
-        for (const auto& id : segmentInfo.lpcpIDInfo.cpidVec) {
-            failedCopysets.append(std::to_string(id)).append(",");
-        }
+    std::vector<SegmentInfo> segmentInfos;
+    LIBCURVE_ERROR errCode = mdsClient->ListSegment(fileInfo, &segmentInfos);
+    if (errCode != LIBCURVE_ERROR::OK) {
+        LOG(WARNING) << "ListSegment failed, filename: " << fileInfo->filename
+                     << ", error: " << errCode
+                     << ", segments will be got when they are used";
+        return false;
+    }
 
-        LOG(ERROR) << "GetServerList failed, logicpool id: "
-                   << segmentInfo.lpcpIDInfo.lpid
-                   << ", copysets: " << failedCopysets;
+    // same as GetOrAllocateSegment, hold the read locks of the segments
+    // until their chunks are cached
+    std::vector<std::unique_ptr<FileSegmentReadLockGuard>> locks;
+    locks.reserve(segmentInfos.size());
+    for (const auto& segmentInfo : segmentInfos) {
+        locks.emplace_back(new FileSegmentReadLockGuard(
+            metaCache->GetFileSegment(segmentInfo.startoffset /
+                                      fileInfo->segmentsize)));
+    }
 
+    if (!CacheSegments(mdsClient, metaCache, fileInfo, segmentInfos)) {
+        LOG(WARNING) << "cache segments failed, filename: "
+                     << fileInfo->filename;
         return false;
     }
 
-    for (const auto& copysetInfo : copysetInfos) {
-        for (const auto& peerInfo : copysetInfo.csinfos_) {
-            metaCache->AddCopysetIDInfo(
-                peerInfo.peerID,
-                CopysetIDInfo(segmentInfo.lpcpIDInfo.lpid, copysetInfo.cpid_));
+    LOG(INFO) << "warmup " << segmentInfos.size()
+              << " segments on open, filename: " << fileInfo->filename;
+    return true;
+}
+
+bool Splitor::CacheSegments(MDSClient* mdsClient,
+                            MetaCache* metaCache,
+                            const FInfo* fileInfo,
+                            const std::vector<SegmentInfo>& segmentInfos) {
+    LIBCURVE_ERROR errCode;
+    const auto chunksize = fileInfo->chunksize;
+    std::map<LogicPoolID, std::set<CopysetID>> copysetIds;
+    for (const auto& segmentInfo : segmentInfos) {
+        uint32_t count = 0;
+        for (const auto& chunkIdInfo : segmentInfo.chunkvec) {
+            uint64_t chunkIdx =
+                (segmentInfo.startoffset + count * chunksize) / chunksize;
+            metaCache->UpdateChunkInfoByIndex(chunkIdx, chunkIdInfo);
+            ++count;
         }
+
+        copysetIds[segmentInfo.lpcpIDInfo.lpid].insert(
+            segmentInfo.lpcpIDInfo.cpidVec.begin(),
+            segmentInfo.lpcpIDInfo.cpidVec.end());
     }
 
-    metaCache->AddCopysetsInfo(segmentInfo.lpcpIDInfo.lpid,
-                               std::move(copysetInfos));
+    for (const auto& pool : copysetIds) {
+        const LogicPoolID lpid = pool.first;
+        std::vector<CopysetID> cpidVec(pool.second.begin(), pool.second.end());
+        std::vector<CopysetInfo<ChunkServerID>> copysetInfos;
+        errCode = mdsClient->GetServerList(lpid, cpidVec, &copysetInfos);
+
+        if (errCode == LIBCURVE_ERROR::FAILED) {
+            std::string failedCopysets;
+            for (const auto& id : cpidVec) {
+                failedCopysets.append(std::to_string(id)).append(",");
+            }
+
+            LOG(ERROR) << "GetServerList failed, logicpool id: " << lpid
+                       << ", copysets: " << failedCopysets;
+
+            return false;
+        }
+
+        for (const auto& copysetInfo : copysetInfos) {
+            for (const auto& peerInfo : copysetInfo.csinfos_) {
+                metaCache->AddCopysetIDInfo(
+                    peerInfo.peerID, CopysetIDInfo(lpid, copysetInfo.cpid_));
+            }
+        }
+
+        metaCache->AddCopysetsInfo(lpid, std::move(copysetInfos));
+    }
 
     return true;
 }
@@ -348,6 +425,19 @@ int Splitor::SplitForStripe(IOTracker* iotracker, MetaCache* metaCache,
     const uint64_t stripeCount = fileInfo->stripeCount;
     const uint64_t stripesPerChunk = chunksize / stripeUnit;
 
+    // IO连续的条带落在同一chunk上的单元在chunk内也是连续的，
+    // 按chunk合并为一段chunk内的IO，而不是每个条带单元一个请求
+    struct StripeChunkIO {
+        uint64_t offset = 0;
+        uint64_t length = 0;
+        butil::IOBuf data;
+        // 各单元在用户IO中的偏移和长度, 只有读需要
+        std::vector<std::pair<uint64_t, uint64_t>> units;
+    };
+    std::map<ChunkIndex, StripeChunkIO> chunkIOs;
+    const bool isWrite = iotracker->Optype() == OpType::WRITE;
+    const bool isRead = iotracker->Optype() == OpType::READ;
+
     uint64_t cur = offset;
     uint64_t left = length;
 
@@ -364,21 +454,83 @@ int Splitor::SplitForStripe(IOTracker* iotracker, MetaCache* metaCache,
         uint64_t curChunkOffset = blockInChunkStartOff + blockOff;
         uint64_t requestLength = std::min((stripeUnit - blockOff), left);
 
-        if (!AssignInternal(iotracker, metaCache, targetlist, data,
-                            curChunkOffset, requestLength, mdsclient,
-                            fileInfo, fEpoch, curChunkIndex)) {
+        StripeChunkIO& chunkIO = chunkIOs[curChunkIndex];
+        if (chunkIO.length == 0) {
+            chunkIO.offset = curChunkOffset;
+        }
+        chunkIO.length += requestLength;
+        if (isWrite) {
+            auto nc = data->cutn(&chunkIO.data, requestLength);
+            if (nc != requestLength) {
+                LOG(ERROR) << "IOBuf::cutn failed, expected: "
+                           << requestLength << ", return: " << nc;
+                return -1;
+            }
+        } else if (isRead) {
+            chunkIO.units.emplace_back(cur - offset, requestLength);
+        }
+
+        left -= requestLength;
+        cur += requestLength;
+    }
+
+    // 读请求中的各段条带单元在用户IO中的偏移, 用于确定其位置
+    struct UnitPiece {
+        uint64_t ioOffset;
+        RequestContext* req;
+        size_t index;
+    };
+    std::vector<UnitPiece> pieces;
+    for (auto& item : chunkIOs) {
+        const ChunkIndex chunkIndex = item.first;
+        StripeChunkIO& chunkIO = item.second;
+        size_t first = targetlist->size();
+        if (!AssignInternal(iotracker, metaCache, targetlist,
+                            isWrite ? &chunkIO.data : nullptr,
+                            chunkIO.offset, chunkIO.length, mdsclient,
+                            fileInfo, fEpoch, chunkIndex)) {
             LOG(ERROR) << "request split failed"
-                       << ", off = " << curChunkOffset
-                       << ", len = " << requestLength
+                       << ", off = " << chunkIO.offset
+                       << ", len = " << chunkIO.length
                        << ", seqnum = " << fileInfo->seqnum
                        << ", chunksize = " << chunksize
-                       << ", chunkindex = " << curChunkIndex;
+                       << ", chunkindex = " << chunkIndex;
 
             return -1;
         }
 
-        left -= requestLength;
-        cur += requestLength;
+        if (!isRead) {
+            continue;
+        }
+
+        // 超过拆分大小的chunk内IO被拆为多个请求, 条带单元跨请求时被拆开
+        auto unit = chunkIO.units.begin();
+        uint64_t unitDone = 0;
+        for (size_t i = first; i < targetlist->size(); ++i) {
+            RequestContext* req = (*targetlist)[i];
+            uint64_t reqLeft = req->rawlength_;
+            while (reqLeft > 0 && unit != chunkIO.units.end()) {
+                uint64_t len = std::min(unit->second - unitDone, reqLeft);
+                pieces.push_back(
+                    {unit->first + unitDone, req, req->stripeUnits_.size()});
+                req->stripeUnits_.emplace_back(0, len);
+                reqLeft -= len;
+                unitDone += len;
+                if (unitDone == unit->second) {
+                    ++unit;
+                    unitDone = 0;
+                }
+            }
+        }
+    }
+
+    // 按chunk合并后单元的顺序与用户IO中的不同, 以偏移的顺序作为其位置
+    std::sort(pieces.begin(), pieces.end(),
+              [](const UnitPiece& a, const UnitPiece& b) {
+                  return a.ioOffset < b.ioOffset;
+              });
+    for (size_t i = 0; i < pieces.size(); ++i) {
+        pieces[i].req->stripeUnits_[pieces[i].index].subIoIndex = i;
     }
 
     return 0;
@@ -103,6 +103,18 @@ class Splitor {
                                          const ChunkIDInfo& chunkInfo,
                                          const MetaCache* metaCache);
 
+    /**
+     * 打开文件时通过一次rpc获取文件所有已分配的segment，并更新到metacache，
+     * 未开启fileSegmentWarmupOnOpen时直接返回
+     * @param: mdsClient 获取segment以及copyset信息
+     * @param: metaCache 文件的缓存信息
+     * @param: fileInfo 文件信息
+     * @return: 成功返回true，失败返回false，失败时segment在使用时再获取
+     */
+    static bool WarmupSegments(MDSClient* mdsClient,
+                               MetaCache* metaCache,
+                               const FInfo* fileInfo);
+
  private:
     /**
      * IO2ChunkRequests内部会调用这个函数，进行真正的拆分操作
@@ -135,6 +147,14 @@ class Splitor {
                                      const FileEpoch_t *fEpoch,
                                      ChunkIndex chunkidx);
 
+    /**
+     * 将segment的chunk信息更新到metacache，并获取其copyset的chunkserver信息
+     */
+    static bool CacheSegments(MDSClient* mdsClient,
+                              MetaCache* metaCache,
+                              const FInfo* fileInfo,
+                              const std::vector<SegmentInfo>& segmentInfos);
+
     static int SplitForNormal(IOTracker* iotracker, MetaCache* metaCache,
                               std::vector<RequestContext*>* targetlist,
                               butil::IOBuf* data, off_t offset, size_t length,
@@ -24,6 +24,48 @@
 namespace curve {
 namespace client {
 
+namespace {
+
+// 滑动平均中最新一个rpc的权重
+const double kScoreWeight = 0.05;
+
+inline void UpdateAverage(double* average, double value, uint64_t samples) {
+    // 样本少时用算术平均，避免初始值的影响
+    double weight = samples < 1.0 / kScoreWeight ? 1.0 / samples : kScoreWeight;
+    *average += (value - *average) * weight;
+}
+
+}  // namespace
+
+void UnstableHelper::RecordResult(ChunkServerID csId, int64_t latencyUs,
+                                  bool failed) {
+    std::unique_lock<decltype(mtx_)> guard(mtx_);
+    Score& score = scores_[csId];
+    UpdateAverage(&score.errorRatio, failed ? 1 : 0, ++score.samples);
+    if (!failed) {
+        UpdateAverage(&score.latencyUs, latencyUs, ++score.latencySamples);
+        UpdateAverage(&latencyUs_, latencyUs, ++latencySamples_);
+    }
+}
+
+bool UnstableHelper::IsSlow(ChunkServerID csId) {
+    std::unique_lock<decltype(mtx_)> guard(mtx_);
+    auto iter = scores_.find(csId);
+    if (iter == scores_.end() ||
+        iter->second.samples < option_.slowMinSamples) {
+        return false;
+    }
+
+    const Score& score = iter->second;
+    if (score.errorRatio > option_.slowErrorRatio) {
+        return true;
+    }
+
+    return option_.slowLatencyRatio > 0 &&
+           score.latencyUs > option_.slowMinLatencyUs &&
+           score.latencyUs > latencyUs_ * option_.slowLatencyRatio;
+}
+
 UnstableState
 UnstableHelper::GetCurrentUnstableState(ChunkServerID csId,
                                         const butil::EndPoint &csEndPoint) {
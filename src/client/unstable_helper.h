@@ -76,6 +76,19 @@ class UnstableHelper {
         serverUnstabledChunkservers_[ip].clear();
     }
 
+    /**
+     * @brief 每个rpc返回时更新chunkserver延时和失败比例的滑动平均
+     * @param: latencyUs rpc的延时
+     * @param: failed rpc是否失败，失败的rpc不统计延时
+     */
+    void RecordResult(ChunkServerID csId, int64_t latencyUs, bool failed);
+
+    /**
+     * @brief chunkserver是否变慢，变慢的chunkserver还没有超时，
+     *        只是延时或者失败比例明显高于其他chunkserver
+     */
+    bool IsSlow(ChunkServerID csId);
+
  private:
     /**
      * @brief 检查chunkserver状态
@@ -98,6 +111,20 @@ class UnstableHelper {
     // 同一server上unstable chunkserver的id
     std::unordered_map<std::string, std::unordered_set<ChunkServerID>>
         serverUnstabledChunkservers_;
+
+    struct Score {
+        double latencyUs = 0;
+        uint64_t latencySamples = 0;
+        double errorRatio = 0;
+        uint64_t samples = 0;
+    };
+
+    // 每个chunkserver rpc延时和失败比例的滑动平均
+    std::unordered_map<ChunkServerID, Score> scores_;
+
+    // 所有chunkserver rpc延时的滑动平均
+    double latencyUs_ = 0;
+    uint64_t latencySamples_ = 0;
 };
 
 }  // namespace client
@@ -0,0 +1,816 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/client/write_back_log.h"
+
+#include <fcntl.h>
+#include <glog/logging.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>  // NOLINT
+#include <cstddef>
+#include <cstring>
+#include <utility>
+
+#include "src/common/crc32.h"
+#include "src/common/timeutility.h"
+
+namespace curve {
+namespace client {
+
+using curve::common::TimeUtility;
+
+namespace {
+
+const uint32_t kSuperBlockMagic = 0x57424c47;  // "WBLG"
+const uint32_t kRecordMagic = 0x57424c52;      // "WBLR"
+const uint32_t kVersion = 1;
+
+// the log is too small to be useful below it
+const uint64_t kMinCapacity = 16 * WriteBackLog::kBlockSize;
+// bytes written and synced at most at a time
+const uint64_t kMaxBatchBytes = 4 * 1024 * 1024;
+const uint64_t kFlushRetryIntervalUs = 100 * 1000;
+const uint64_t kIdleWaitUs = 1000 * 1000;
+
+// followed by the name of the file logged, at offset 0 of the log
+struct SuperBlock {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;
+    // position and seq of the first record not flushed
+    uint64_t tailPos;
+    uint64_t tailSeq;
+    // crc of the record before the tail
+    uint32_t tailPrevCrc;
+    uint32_t nameLength;
+    // of the whole block with crc 0
+    uint32_t crc;
+    uint32_t reserved;
+};
+
+// followed by the data, the records are aligned to kAlignment
+struct RecordHeader {
+    uint32_t magic;
+    // of the header with crc 0 and the data
+    uint32_t crc;
+    uint64_t seq;
+    uint64_t offset;
+    uint32_t length;
+    // crc of the record before
+    uint32_t prevCrc;
+};
+
+uint64_t RecordBytes(size_t length) {
+    const uint64_t bytes = sizeof(RecordHeader) + length;
+    return (bytes + WriteBackLog::kAlignment - 1) / WriteBackLog::kAlignment *
+           WriteBackLog::kAlignment;
+}
+
+uint32_t RecordCrc(RecordHeader header, const char* data, size_t length) {
+    header.crc = 0;
+    uint32_t crc = curve::common::CRC32(reinterpret_cast<const char*>(&header),
+                                        sizeof(header));
+    return curve::common::CRC32(crc, data, length);
+}
+
+bool PreadFull(int fd, char* buf, size_t length, uint64_t offset) {
+    while (length > 0) {
+        ssize_t ret = ::pread(fd, buf, length, offset);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            return false;
+        }
+        buf += ret;
+        length -= ret;
+        offset += ret;
+    }
+    return true;
+}
+
+bool PwriteFull(int fd, const char* buf, size_t length, uint64_t offset) {
+    while (length > 0) {
+        ssize_t ret = ::pwrite(fd, buf, length, offset);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            return false;
+        }
+        buf += ret;
+        length -= ret;
+        offset += ret;
+    }
+    return true;
+}
+
+// make the file created durable in its directory
+int SyncDir(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    std::string dir = slash == std::string::npos ? "." :
+                      slash == 0 ? "/" : path.substr(0, slash);
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        return -1;
+    }
+    int ret = ::fsync(fd);
+    ::close(fd);
+    return ret;
+}
+
+}  // namespace
+
+const uint32_t WriteBackLog::kBlockSize;
+const uint32_t WriteBackLog::kAlignment;
+
+WriteBackLog::WriteBackLog(const WriteBackLogOption& option, FlushFunc flush)
+    : option_(option),
+      flush_(std::move(flush)),
+      fd_(-1),
+      capacity_(0),
+      pendingBytes_(0),
+      headPos_(kBlockSize),
+      nextSeq_(1),
+      lastCrc_(0),
+      tailPos_(kBlockSize),
+      tailSeq_(1),
+      tailPrevCrc_(0),
+      broken_(false),
+      stopping_(false) {}
+
+WriteBackLog::~WriteBackLog() {
+    Stop();
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+int WriteBackLog::Open(const std::string& path, const std::string& filename,
+                       std::vector<std::pair<off_t, size_t>>* replayed) {
+    filename_ = filename;
+    replayed->clear();
+    if (sizeof(SuperBlock) + filename_.size() > kBlockSize) {
+        LOG(ERROR) << "File name too long for write back log: " << filename_;
+        return -1;
+    }
+    if (option_.capacityBytes < kMinCapacity) {
+        LOG(ERROR) << "Write back log capacity " << option_.capacityBytes
+                   << " is less than " << kMinCapacity;
+        return -1;
+    }
+
+    fd_ = ::open(path.c_str(), O_RDWR);
+    if (fd_ < 0) {
+        if (errno != ENOENT) {
+            LOG(ERROR) << "Failed to open write back log " << path
+                       << ", errno: " << errno;
+            return -1;
+        }
+        return Create(path);
+    }
+
+    int ret = Load();
+    if (ret < 0) {
+        LOG(ERROR) << "Failed to load write back log " << path;
+        return -1;
+    }
+    if (ret > 0) {
+        // crashed while creating it, nothing was written
+        ::close(fd_);
+        fd_ = -1;
+        return Create(path);
+    }
+
+    // the capacity is changed only when nothing is left in the log
+    const uint64_t capacity =
+        option_.capacityBytes / kAlignment * kAlignment;
+    if (records_.empty() && capacity_ != capacity) {
+        ::close(fd_);
+        fd_ = -1;
+        return Create(path);
+    }
+
+    for (const auto& record : records_) {
+        replayed->emplace_back(record->offset, record->length);
+    }
+    LOG(INFO) << "Open write back log " << path << ", " << records_.size()
+              << " records to flush, " << pendingBytes_ << " bytes";
+    return 0;
+}
+
+int WriteBackLog::Create(const std::string& path) {
+    capacity_ = option_.capacityBytes / kAlignment * kAlignment;
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        LOG(ERROR) << "Failed to create write back log " << path
+                   << ", errno: " << errno;
+        return -1;
+    }
+    if (::ftruncate(fd_, DataEnd()) != 0) {
+        LOG(ERROR) << "Failed to truncate write back log " << path
+                   << ", errno: " << errno;
+        return -1;
+    }
+    headPos_ = tailPos_ = kBlockSize;
+    nextSeq_ = tailSeq_ = 1;
+    lastCrc_ = tailPrevCrc_ = 0;
+    if (PersistTail(tailPos_, tailSeq_, tailPrevCrc_) != 0 ||
+        SyncDir(path) != 0) {
+        LOG(ERROR) << "Failed to sync write back log " << path
+                   << ", errno: " << errno;
+        return -1;
+    }
+    LOG(INFO) << "Create write back log " << path << ", capacity "
+              << capacity_;
+    return 0;
+}
+
+int WriteBackLog::Load() {
+    std::string block(kBlockSize, '\0');
+    if (!PreadFull(fd_, &block[0], kBlockSize, 0)) {
+        LOG(ERROR) << "Failed to read super block, errno: " << errno;
+        return -1;
+    }
+    SuperBlock super;
+    memcpy(&super, block.data(), sizeof(super));
+    if (super.magic == 0) {
+        return 1;
+    }
+    const uint32_t crc = super.crc;
+    memset(&block[offsetof(SuperBlock, crc)], 0, sizeof(super.crc));
+    if (super.magic != kSuperBlockMagic || super.version != kVersion ||
+        crc != curve::common::CRC32(block.data(), block.size())) {
+        LOG(ERROR) << "Invalid super block";
+        return -1;
+    }
+    if (super.nameLength + sizeof(super) > kBlockSize ||
+        filename_ != block.substr(sizeof(super), super.nameLength)) {
+        LOG(ERROR) << "Write back log is not of " << filename_;
+        return -1;
+    }
+    capacity_ = super.capacity;
+    if (super.tailPos < kBlockSize || super.tailPos > DataEnd()) {
+        LOG(ERROR) << "Invalid tail position " << super.tailPos;
+        return -1;
+    }
+
+    // the records after the tail, until the first one torn by a crash, a
+    // record wraps to the start if it isn't found where the last one ends
+    tailPos_ = super.tailPos;
+    tailSeq_ = super.tailSeq;
+    tailPrevCrc_ = super.tailPrevCrc;
+    uint64_t pos = tailPos_;
+    uint64_t seq = tailSeq_;
+    uint32_t prevCrc = tailPrevCrc_;
+    while (true) {
+        RecordPtr record;
+        if (!ReadRecord(pos, seq, prevCrc, &record) &&
+            (pos == kBlockSize ||
+             !ReadRecord(kBlockSize, seq, prevCrc, &record))) {
+            break;
+        }
+        CommitLocked(record);
+        pos = record->pos + record->bytes;
+        ++seq;
+        prevCrc = record->crc;
+    }
+    headPos_ = pos;
+    nextSeq_ = seq;
+    lastCrc_ = prevCrc;
+    return 0;
+}
+
+bool WriteBackLog::ReadRecord(uint64_t pos, uint64_t seq, uint32_t prevCrc,
+                              RecordPtr* record) {
+    RecordHeader header;
+    if (pos + sizeof(header) > DataEnd() ||
+        !PreadFull(fd_, reinterpret_cast<char*>(&header), sizeof(header),
+                   pos)) {
+        return false;
+    }
+    if (header.magic != kRecordMagic || header.seq != seq ||
+        header.prevCrc != prevCrc ||
+        pos + RecordBytes(header.length) > DataEnd()) {
+        return false;
+    }
+    std::string data(header.length, '\0');
+    if (!PreadFull(fd_, &data[0], data.size(), pos + sizeof(header)) ||
+        header.crc != RecordCrc(header, data.data(), data.size())) {
+        return false;
+    }
+
+    record->reset(new Record());
+    (*record)->seq = seq;
+    (*record)->offset = header.offset;
+    (*record)->length = header.length;
+    (*record)->data.append(data);
+    (*record)->pos = pos;
+    (*record)->bytes = RecordBytes(header.length);
+    (*record)->crc = header.crc;
+    (*record)->prevCrc = prevCrc;
+    return true;
+}
+
+int WriteBackLog::PersistTail(uint64_t pos, uint64_t seq, uint32_t prevCrc) {
+    std::string block(kBlockSize, '\0');
+    SuperBlock super;
+    super.magic = kSuperBlockMagic;
+    super.version = kVersion;
+    super.capacity = capacity_;
+    super.tailPos = pos;
+    super.tailSeq = seq;
+    super.tailPrevCrc = prevCrc;
+    super.nameLength = filename_.size();
+    super.crc = 0;
+    super.reserved = 0;
+    memcpy(&block[0], &super, sizeof(super));
+    memcpy(&block[sizeof(super)], filename_.data(), filename_.size());
+    super.crc = curve::common::CRC32(block.data(), block.size());
+    memcpy(&block[offsetof(SuperBlock, crc)], &super.crc, sizeof(super.crc));
+
+    if (!PwriteFull(fd_, block.data(), block.size(), 0) ||
+        ::fdatasync(fd_) != 0) {
+        LOG(ERROR) << "Failed to write super block, errno: " << errno;
+        return -1;
+    }
+    return 0;
+}
+
+void WriteBackLog::Start() {
+    writeThread_ = std::thread(&WriteBackLog::WriteLoop, this);
+    flushThread_ = std::thread(&WriteBackLog::FlushLoop, this);
+}
+
+void WriteBackLog::Stop() {
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+    }
+    writeCond_.notify_all();
+    flushCond_.notify_all();
+    if (writeThread_.joinable()) {
+        writeThread_.join();
+    }
+    if (flushThread_.joinable()) {
+        flushThread_.join();
+    }
+
+    std::vector<Done> dones;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        for (auto& record : queued_) {
+            dones.push_back(std::move(record->done));
+        }
+        queued_.clear();
+        auto iter = records_.begin();
+        while (iter != records_.end()) {
+            if ((*iter)->barrier) {
+                dones.push_back(std::move((*iter)->done));
+                iter = records_.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+    }
+    for (auto& done : dones) {
+        done(-1);
+    }
+}
+
+int WriteBackLog::Close() {
+    std::mutex mtx;
+    std::condition_variable cond;
+    bool finished = false;
+    int ret = 0;
+    Barrier([&](int barrierRet) {
+        std::lock_guard<std::mutex> lk(mtx);
+        ret = barrierRet;
+        finished = true;
+        cond.notify_one();
+    });
+    {
+        std::unique_lock<std::mutex> lk(mtx);
+        cond.wait(lk, [&finished]() { return finished; });
+    }
+
+    Stop();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    return ret;
+}
+
+bool WriteBackLog::Append(off_t offset, const butil::IOBuf& data,
+                          Done done) {
+    const uint64_t bytes = RecordBytes(data.size());
+    if (bytes > capacity_ / 4) {
+        return false;
+    }
+
+    RecordPtr record(new Record());
+    record->offset = offset;
+    record->length = data.size();
+    record->data = data;
+    record->bytes = bytes;
+    record->done = std::move(done);
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (!stopping_) {
+            queued_.push_back(record);
+            writeCond_.notify_one();
+            return true;
+        }
+    }
+    record->done(-1);
+    return true;
+}
+
+void WriteBackLog::Barrier(Done done) {
+    RecordPtr record(new Record());
+    record->barrier = true;
+    record->done = std::move(done);
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (!stopping_) {
+            queued_.push_back(record);
+            writeCond_.notify_one();
+            return;
+        }
+    }
+    record->done(-1);
+}
+
+void WriteBackLog::Lookup(off_t offset, size_t length,
+                          std::vector<Extent>* extents) const {
+    extents->clear();
+    const off_t end = offset + static_cast<off_t>(length);
+    std::lock_guard<std::mutex> lk(mtx_);
+    auto iter = index_.upper_bound(offset);
+    if (iter != index_.begin()) {
+        auto prev = std::prev(iter);
+        if (prev->first + static_cast<off_t>(prev->second.length) > offset) {
+            iter = prev;
+        }
+    }
+    for (; iter != index_.end() && iter->first < end; ++iter) {
+        const off_t start = std::max(iter->first, offset);
+        const off_t stop = std::min(
+            iter->first + static_cast<off_t>(iter->second.length), end);
+        Extent extent;
+        extent.offset = start;
+        iter->second.data.append_to(&extent.data, stop - start,
+                                    start - iter->first);
+        extents->push_back(std::move(extent));
+    }
+}
+
+uint64_t WriteBackLog::PendingBytes() const {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return pendingBytes_;
+}
+
+void WriteBackLog::WriteLoop() {
+    std::unique_lock<std::mutex> lk(mtx_);
+    while (true) {
+        writeCond_.wait(lk, [this]() {
+            return stopping_ || WritableLocked();
+        });
+        if (stopping_) {
+            break;
+        }
+
+        // the records written in a batch are contiguous in the log, and a
+        // barrier waits for the records before it to be written
+        std::vector<RecordPtr> batch;
+        std::vector<Done> failed;
+        uint64_t batchBytes = 0;
+        while (!queued_.empty()) {
+            RecordPtr record = queued_.front();
+            if (record->barrier) {
+                if (!batch.empty()) {
+                    break;
+                }
+                records_.push_back(record);
+                queued_.pop_front();
+                flushCond_.notify_one();
+                continue;
+            }
+            if (broken_) {
+                failed.push_back(std::move(record->done));
+                queued_.pop_front();
+                continue;
+            }
+            uint64_t pos = 0;
+            if (batchBytes >= kMaxBatchBytes ||
+                !AllocateLocked(record->bytes, &pos) ||
+                (!batch.empty() && pos != headPos_)) {
+                break;
+            }
+            record->pos = pos;
+            record->seq = nextSeq_++;
+            headPos_ = pos + record->bytes;
+            batchBytes += record->bytes;
+            batch.push_back(record);
+            queued_.pop_front();
+        }
+        writing_ = batch;
+        const uint32_t prevCrc = lastCrc_;
+        if (!batch.empty()) {
+            batch.front()->prevCrc = prevCrc;
+        }
+        lk.unlock();
+
+        for (auto& done : failed) {
+            done(-1);
+        }
+        std::vector<uint32_t> crcs;
+        int ret = batch.empty() ? 0 : WriteRecords(batch, prevCrc, &crcs);
+
+        std::vector<Done> dones;
+        lk.lock();
+        writing_.clear();
+        if (ret != 0) {
+            broken_ = true;
+        }
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (ret == 0) {
+                batch[i]->prevCrc = i == 0 ? prevCrc : crcs[i - 1];
+                batch[i]->crc = crcs[i];
+                lastCrc_ = crcs[i];
+                CommitLocked(batch[i]);
+            }
+            dones.push_back(std::move(batch[i]->done));
+        }
+        if (!batch.empty()) {
+            flushCond_.notify_one();
+        }
+        lk.unlock();
+        for (auto& done : dones) {
+            done(ret);
+        }
+        lk.lock();
+    }
+}
+
+int WriteBackLog::WriteRecords(const std::vector<RecordPtr>& records,
+                               uint32_t prevCrc,
+                               std::vector<uint32_t>* crcs) {
+    const uint64_t start = records.front()->pos;
+    const uint64_t end = records.back()->pos + records.back()->bytes;
+    std::string buf(end - start, '\0');
+    for (const auto& record : records) {
+        char* pos = &buf[record->pos - start];
+        record->data.copy_to(pos + sizeof(RecordHeader), record->length);
+        RecordHeader header;
+        header.magic = kRecordMagic;
+        header.seq = record->seq;
+        header.offset = record->offset;
+        header.length = record->length;
+        header.prevCrc = prevCrc;
+        header.crc = RecordCrc(header, pos + sizeof(header), record->length);
+        memcpy(pos, &header, sizeof(header));
+        crcs->push_back(header.crc);
+        prevCrc = header.crc;
+    }
+
+    if (!PwriteFull(fd_, buf.data(), buf.size(), start) ||
+        ::fdatasync(fd_) != 0) {
+        LOG(ERROR) << "Failed to write write back log, errno: " << errno
+                   << ", the writes after are written through";
+        return -1;
+    }
+    return 0;
+}
+
+void WriteBackLog::FlushLoop() {
+    std::unique_lock<std::mutex> lk(mtx_);
+    while (!stopping_) {
+        std::vector<RecordPtr> toIssue;
+        const uint64_t now = TimeUtility::GetTimeofDayUs();
+        uint64_t waitUs = kIdleWaitUs;
+        for (const auto& record : flushing_) {
+            if (record->retryUs == 0) {
+                continue;
+            }
+            if (record->retryUs <= now) {
+                record->retryUs = 0;
+                toIssue.push_back(record);
+            } else {
+                waitUs = std::min(waitUs, record->retryUs - now);
+            }
+        }
+        while (!toFlush_.empty() &&
+               flushing_.size() < option_.flushConcurrency &&
+               !OverlapFlushingLocked(toFlush_.front())) {
+            flushing_.push_back(toFlush_.front());
+            toIssue.push_back(toFlush_.front());
+            toFlush_.pop_front();
+        }
+
+        uint64_t pos = 0;
+        uint64_t seq = 0;
+        uint32_t prevCrc = 0;
+        NextTailLocked(&pos, &seq, &prevCrc);
+        const bool persist = pos != tailPos_ || seq != tailSeq_;
+        std::vector<Done> dones;
+        TrimLocked(&dones);
+        if (toIssue.empty() && !persist && dones.empty()) {
+            flushCond_.wait_for(lk, std::chrono::microseconds(waitUs));
+            continue;
+        }
+
+        lk.unlock();
+        for (auto& done : dones) {
+            done(0);
+        }
+        for (const auto& record : toIssue) {
+            flush_(record->offset, record->data,
+                   [this, record](int ret) { OnFlushDone(record, ret); });
+        }
+        // the records before the tail persisted are not replayed, so their
+        // space can be reused. if the super block can't be written, the log
+        // fails and nothing is written to it any more
+        int ret = persist ? PersistTail(pos, seq, prevCrc) : 0;
+        lk.lock();
+        if (persist) {
+            if (ret != 0) {
+                broken_ = true;
+            }
+            tailPos_ = pos;
+            tailSeq_ = seq;
+            tailPrevCrc_ = prevCrc;
+            writeCond_.notify_one();
+        }
+    }
+}
+
+void WriteBackLog::OnFlushDone(const RecordPtr& record, int ret) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (ret < 0) {
+        LOG(WARNING) << "Failed to flush write back record, offset = "
+                     << record->offset << ", length = " << record->length
+                     << ", ret = " << ret << ", retry later";
+        record->retryUs =
+            TimeUtility::GetTimeofDayUs() + kFlushRetryIntervalUs;
+    } else {
+        flushing_.erase(
+            std::find(flushing_.begin(), flushing_.end(), record));
+        record->flushed = true;
+        EraseIndexLocked(record);
+        pendingBytes_ -= record->length;
+        record->data.clear();
+    }
+    flushCond_.notify_one();
+}
+
+bool WriteBackLog::AllocateLocked(uint64_t bytes, uint64_t* pos) const {
+    // the space in use is [tailPos_, headPos_), it wraps at the end, and
+    // the head never catches up with the tail from behind
+    if (headPos_ >= tailPos_) {
+        if (headPos_ + bytes <= DataEnd()) {
+            *pos = headPos_;
+            return true;
+        }
+        if (kBlockSize + bytes < tailPos_) {
+            *pos = kBlockSize;
+            return true;
+        }
+        return false;
+    }
+    if (headPos_ + bytes < tailPos_) {
+        *pos = headPos_;
+        return true;
+    }
+    return false;
+}
+
+void WriteBackLog::InsertIndexLocked(const RecordPtr& record) {
+    const off_t start = record->offset;
+    const off_t end = record->End();
+    auto iter = index_.upper_bound(start);
+    if (iter != index_.begin()) {
+        auto prev = std::prev(iter);
+        if (prev->first + static_cast<off_t>(prev->second.length) > start) {
+            iter = prev;
+        }
+    }
+
+    // cut the older extents overlapping the record
+    while (iter != index_.end() && iter->first < end) {
+        const off_t oldStart = iter->first;
+        const off_t oldEnd = oldStart + static_cast<off_t>(iter->second.length);
+        IndexEntry old = std::move(iter->second);
+        iter = index_.erase(iter);
+        if (oldStart < start) {
+            IndexEntry left{static_cast<size_t>(start - oldStart), old.seq,
+                            butil::IOBuf()};
+            old.data.append_to(&left.data, left.length, 0);
+            index_.emplace(oldStart, std::move(left));
+        }
+        if (oldEnd > end) {
+            IndexEntry right{static_cast<size_t>(oldEnd - end), old.seq,
+                             butil::IOBuf()};
+            old.data.append_to(&right.data, right.length, end - oldStart);
+            index_.emplace(end, std::move(right));
+            break;
+        }
+    }
+    index_.emplace(start,
+                   IndexEntry{record->length, record->seq, record->data});
+}
+
+void WriteBackLog::EraseIndexLocked(const RecordPtr& record) {
+    // the parts of the record not overwritten by the newer ones
+    auto iter = index_.lower_bound(record->offset);
+    while (iter != index_.end() && iter->first < record->End()) {
+        if (iter->second.seq == record->seq) {
+            iter = index_.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+void WriteBackLog::CommitLocked(const RecordPtr& record) {
+    records_.push_back(record);
+    toFlush_.push_back(record);
+    InsertIndexLocked(record);
+    pendingBytes_ += record->length;
+}
+
+bool WriteBackLog::WritableLocked() const {
+    if (queued_.empty()) {
+        return false;
+    }
+    uint64_t pos = 0;
+    const RecordPtr& record = queued_.front();
+    return record->barrier || broken_ ||
+           AllocateLocked(record->bytes, &pos);
+}
+
+void WriteBackLog::NextTailLocked(uint64_t* pos, uint64_t* seq,
+                                  uint32_t* prevCrc) const {
+    for (const auto& record : records_) {
+        if (!record->barrier && !record->flushed) {
+            *pos = record->pos;
+            *seq = record->seq;
+            *prevCrc = record->prevCrc;
+            return;
+        }
+    }
+    if (!writing_.empty()) {
+        *pos = writing_.front()->pos;
+        *seq = writing_.front()->seq;
+        *prevCrc = writing_.front()->prevCrc;
+        return;
+    }
+    *pos = headPos_;
+    *seq = nextSeq_;
+    *prevCrc = lastCrc_;
+}
+
+void WriteBackLog::TrimLocked(std::vector<Done>* dones) {
+    while (!records_.empty()) {
+        const RecordPtr& record = records_.front();
+        if (record->barrier) {
+            dones->push_back(std::move(record->done));
+        } else if (record->seq >= tailSeq_) {
+            break;
+        }
+        records_.pop_front();
+    }
+}
+
+bool WriteBackLog::OverlapFlushingLocked(const RecordPtr& record) const {
+    for (const auto& flushing : flushing_) {
+        if (flushing->offset < record->End() &&
+            record->offset < flushing->End()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace client
+}  // namespace curve
@@ -0,0 +1,254 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_CLIENT_WRITE_BACK_LOG_H_
+#define SRC_CLIENT_WRITE_BACK_LOG_H_
+
+#include <butil/iobuf.h>
+#include <sys/types.h>
+
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "src/client/config_info.h"
+#include "src/common/uncopyable.h"
+
+namespace curve {
+namespace client {
+
+/**
+ * Persistent write-back log of one opened file, kept in a local file.
+ *
+ * A write is acknowledged once it is durable in the log, the records are
+ * written in batches by one thread and synced together, so the log is a
+ * prefix of the acknowledged writes after a crash. Every record carries
+ * the crc of the one before it, the records left by an earlier crash are
+ * not taken as the successors of the ones written later. The logged records are
+ * flushed to the chunkservers in the order they are appended, and a record
+ * is not flushed while an earlier one overlapping it is in flight. The space
+ * of the flushed records is reused after the log tail is persisted past
+ * them, the records after the tail are flushed again when the log is
+ * reopened.
+ *
+ * The data not flushed yet is also kept in memory, reads must overlay it on
+ * the data read from the chunkservers, see Lookup().
+ */
+class WriteBackLog : public curve::common::Uncopyable {
+ public:
+    // called with 0 on success, negative on failure
+    using Done = std::function<void(int ret)>;
+    // write data at offset to the chunkservers and call done
+    using FlushFunc = std::function<void(off_t offset,
+                                         const butil::IOBuf& data,
+                                         Done done)>;
+
+    struct Extent {
+        off_t offset;
+        butil::IOBuf data;
+    };
+
+    WriteBackLog(const WriteBackLogOption& option, FlushFunc flush);
+
+    ~WriteBackLog();
+
+    /**
+     * @brief open the log of file at path, create it if not exist
+     * @param filename the file logged, checked against the existing log
+     * @param replayed set to the ranges of the records left by the last
+     *        run, they are flushed again after Start()
+     * @return 0 on success, -1 on failure
+     */
+    int Open(const std::string& path, const std::string& filename,
+             std::vector<std::pair<off_t, size_t>>* replayed);
+
+    // start writing and flushing the records
+    void Start();
+
+    /**
+     * @brief stop writing and flushing, the records not flushed are kept in
+     *        the log, the appends and barriers pending are failed
+     */
+    void Stop();
+
+    /**
+     * @brief flush all the records and close the log
+     * @return 0 if all the records are flushed
+     */
+    int Close();
+
+    /**
+     * @brief append a write to the log, done is called once it's durable,
+     *        or with a negative value if the log failed, and then the
+     *        caller must write it through after a Barrier()
+     * @return false if the write is too large for the log, done is not
+     *         called
+     */
+    bool Append(off_t offset, const butil::IOBuf& data, Done done);
+
+    // call done once the records appended before are all flushed
+    void Barrier(Done done);
+
+    /**
+     * @brief the data of [offset, offset + length) not flushed yet
+     * @param extents set to the disjoint extents in the range, ordered by
+     *        offset, they are newer than the data on the chunkservers
+     */
+    void Lookup(off_t offset, size_t length,
+                std::vector<Extent>* extents) const;
+
+    // bytes of the records not flushed yet
+    uint64_t PendingBytes() const;
+
+    static const uint32_t kBlockSize = 4096;
+    static const uint32_t kAlignment = 512;
+
+ private:
+    struct Record {
+        bool barrier = false;
+        uint64_t seq = 0;
+        off_t offset = 0;
+        size_t length = 0;
+        butil::IOBuf data;
+        Done done;
+        // position and bytes in the log
+        uint64_t pos = 0;
+        uint64_t bytes = 0;
+        // crc of the record, and of the one before it
+        uint32_t crc = 0;
+        uint32_t prevCrc = 0;
+        bool flushed = false;
+        // time to retry a failed flush, 0 if not failed
+        uint64_t retryUs = 0;
+
+        off_t End() const {
+            return offset + static_cast<off_t>(length);
+        }
+    };
+
+    using RecordPtr = std::shared_ptr<Record>;
+
+    struct IndexEntry {
+        size_t length;
+        uint64_t seq;
+        butil::IOBuf data;
+    };
+
+    int Create(const std::string& path);
+
+    // 1 if the super block is not written yet
+    int Load();
+
+    // read the record at pos following the one of seq - 1 and prevCrc,
+    // false if it isn't there
+    bool ReadRecord(uint64_t pos, uint64_t seq, uint32_t prevCrc,
+                    RecordPtr* record);
+
+    int PersistTail(uint64_t pos, uint64_t seq, uint32_t prevCrc);
+
+    void WriteLoop();
+
+    void FlushLoop();
+
+    // write the records into the log, they are contiguous and follow the
+    // record of prevCrc, crcs is set to their crcs
+    int WriteRecords(const std::vector<RecordPtr>& records, uint32_t prevCrc,
+                     std::vector<uint32_t>* crcs);
+
+    void OnFlushDone(const RecordPtr& record, int ret);
+
+    // where a record of bytes can be written, false if there is no space
+    bool AllocateLocked(uint64_t bytes, uint64_t* pos) const;
+
+    void InsertIndexLocked(const RecordPtr& record);
+
+    void EraseIndexLocked(const RecordPtr& record);
+
+    // the record is durable in the log
+    void CommitLocked(const RecordPtr& record);
+
+    bool WritableLocked() const;
+
+    // where the tail can be moved to
+    void NextTailLocked(uint64_t* pos, uint64_t* seq,
+                        uint32_t* prevCrc) const;
+
+    // pop the flushed records and the barriers behind the persisted tail
+    void TrimLocked(std::vector<Done>* dones);
+
+    bool OverlapFlushingLocked(const RecordPtr& record) const;
+
+    uint64_t DataEnd() const {
+        return kBlockSize + capacity_;
+    }
+
+ private:
+    const WriteBackLogOption option_;
+    FlushFunc flush_;
+
+    std::string filename_;
+    int fd_;
+    uint64_t capacity_;
+
+    mutable std::mutex mtx_;
+    std::condition_variable writeCond_;
+    std::condition_variable flushCond_;
+
+    // appended, waiting for the space in the log
+    std::deque<RecordPtr> queued_;
+    // being written by the write thread
+    std::vector<RecordPtr> writing_;
+    // written and not trimmed yet, in log order, including barriers
+    std::deque<RecordPtr> records_;
+    // written and not issued to flush yet
+    std::deque<RecordPtr> toFlush_;
+    // issued to flush, or failed and waiting for retry
+    std::vector<RecordPtr> flushing_;
+
+    // the data not flushed yet, keyed by offset
+    std::map<off_t, IndexEntry> index_;
+    uint64_t pendingBytes_;
+
+    // where the next record is written
+    uint64_t headPos_;
+    uint64_t nextSeq_;
+    // crc of the last record written
+    uint32_t lastCrc_;
+    // the tail persisted, records before it can be overwritten
+    uint64_t tailPos_;
+    uint64_t tailSeq_;
+    uint32_t tailPrevCrc_;
+
+    // the log failed to write, the records after are failed
+    bool broken_;
+    bool stopping_;
+
+    std::thread writeThread_;
+    std::thread flushThread_;
+};
+
+}  // namespace client
+}  // namespace curve
+
+#endif  // SRC_CLIENT_WRITE_BACK_LOG_H_
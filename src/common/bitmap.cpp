@@ -42,6 +42,64 @@ std::string BitRangeVecToString(const std::vector<BitRange> &ranges) {
 
 const uint32_t Bitmap::NO_POS = 0xFFFFFFFF;
 
+namespace {
+
+const uint32_t kBitsPerWord = 64;
+
+// 从第byte个字节起读取至多8字节，返回值第i位对应bitmap第(byte*8+i)位
+// validBits返回读到的有效位数
+inline uint64_t LoadWord(const char* bitmap, uint32_t unitCount,
+                         uint32_t byte, uint32_t* validBits) {
+    uint64_t word = 0;
+    uint32_t bytes = unitCount - byte;
+    if (bytes >= sizeof(word)) {
+        bytes = sizeof(word);
+        memcpy(&word, bitmap + byte, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        word = __builtin_bswap64(word);
+#endif
+    } else {
+        for (uint32_t i = 0; i < bytes; ++i) {
+            word |= static_cast<uint64_t>(
+                        static_cast<unsigned char>(bitmap[byte + i]))
+                    << (i * BITMAP_UNIT_SIZE);
+        }
+    }
+    *validBits = bytes * BITMAP_UNIT_SIZE;
+    return word;
+}
+
+// 在[startIndex, endIndex]中查找第一个值为expectSet的位，每次比较64位
+uint32_t FindNextBit(const char* bitmap, uint32_t unitCount,
+                     uint32_t startIndex, uint32_t endIndex,
+                     bool expectSet) {
+    const uint64_t flip = expectSet ? 0 : ~0ULL;
+    uint64_t index = startIndex;
+    while (index <= endIndex) {
+        uint32_t validBits = 0;
+        uint32_t offset = index % BITMAP_UNIT_SIZE;
+        uint64_t word = LoadWord(bitmap, unitCount, index >> ALIGN_FACTOR,
+                                 &validBits);
+        word = (word ^ flip) >> offset;
+        validBits -= offset;
+
+        uint64_t remain = endIndex - index + 1;
+        if (remain < validBits) {
+            validBits = remain;
+        }
+        if (validBits < kBitsPerWord) {
+            word &= (1ULL << validBits) - 1;
+        }
+        if (word != 0) {
+            return static_cast<uint32_t>(index + __builtin_ctzll(word));
+        }
+        index += validBits;
+    }
+    return Bitmap::NO_POS;
+}
+
+}  // namespace
+
 Bitmap::Bitmap(uint32_t bits) : bits_(bits) {
     int count = unitCount();
     bitmap_ = new(std::nothrow) char[count];
@@ -138,10 +196,7 @@ void Bitmap::Set(uint32_t index) {
 }
 
 void Bitmap::Set(uint32_t startIndex, uint32_t endIndex) {
-    // TODO(wuhanqing): implement fast algorithm if one byte is all set
-    for (uint32_t index = startIndex; index <= endIndex; ++index) {
-        Set(index);
-    }
+    SetRange(startIndex, endIndex, true);
 }
 
 void Bitmap::Clear() {
@@ -154,9 +209,38 @@ void Bitmap::Clear(uint32_t index) {
 }
 
 void Bitmap::Clear(uint32_t startIndex, uint32_t endIndex) {
-    // TODO(wuhanqing): implement fast algorithm if one byte is all clear
-    for (uint32_t index = startIndex; index <= endIndex; ++index) {
-        Clear(index);
+    SetRange(startIndex, endIndex, false);
+}
+
+void Bitmap::SetRange(uint32_t startIndex, uint32_t endIndex, bool set) {
+    if (bits_ == 0) {
+        return;
+    }
+    // endIndex值不能超过lastIndex
+    if (endIndex > bits_ - 1) {
+        endIndex = bits_ - 1;
+    }
+
+    uint32_t index = startIndex;
+    // 1.逐位处理起始处未按字节对齐的部分
+    while (index <= endIndex && index % BITMAP_UNIT_SIZE != 0) {
+        set ? Set(index) : Clear(index);
+        ++index;
+    }
+    if (index > endIndex) {
+        return;
+    }
+
+    // 2.整字节部分直接memset
+    uint32_t bytes = (endIndex - index + 1) >> ALIGN_FACTOR;
+    if (bytes > 0) {
+        memset(bitmap_ + indexOfUnit(index), set ? 0xff : 0, bytes);
+        index += bytes << ALIGN_FACTOR;
+    }
+
+    // 3.逐位处理剩余部分
+    for (; index <= endIndex; ++index) {
+        set ? Set(index) : Clear(index);
     }
 }
 
@@ -168,54 +252,32 @@ bool Bitmap::Test(uint32_t index) const {
 }
 
 uint32_t Bitmap::NextSetBit(uint32_t index) const {
-    for (; index < bits_; ++index) {
-        if (Test(index))
-            break;
-    }
-    if (index >= bits_)
-        index = NO_POS;
-    return index;
+    return NextSetBit(index, bits_ - 1);
 }
 
 uint32_t Bitmap::NextSetBit(uint32_t startIndex, uint32_t endIndex) const {
-    uint32_t index = startIndex;
+    if (bits_ == 0)
+        return NO_POS;
     // bitmap中最后一个bit的index值
     uint32_t lastIndex = bits_ - 1;
     // endIndex值不能超过lastIndex
     if (endIndex > lastIndex)
         endIndex = lastIndex;
-    for (; index <= endIndex; ++index) {
-        if (Test(index))
-            break;
-    }
-    if (index > endIndex)
-        index = NO_POS;
-    return index;
+    return FindNextBit(bitmap_, unitCount(), startIndex, endIndex, true);
 }
 
 uint32_t Bitmap::NextClearBit(uint32_t index) const {
-    for (; index < bits_; ++index) {
-        if (!Test(index))
-            break;
-    }
-    if (index >= bits_)
-        index = NO_POS;
-    return index;
+    return NextClearBit(index, bits_ - 1);
 }
 
 uint32_t Bitmap::NextClearBit(uint32_t startIndex, uint32_t endIndex) const {
-    uint32_t index = startIndex;
+    if (bits_ == 0)
+        return NO_POS;
     uint32_t lastIndex = bits_ - 1;
     // endIndex值不能超过lastIndex
     if (endIndex > lastIndex)
         endIndex = lastIndex;
-    for (; index <= endIndex; ++index) {
-        if (!Test(index))
-            break;
-    }
-    if (index > endIndex)
-        index = NO_POS;
-    return index;
+    return FindNextBit(bitmap_, unitCount(), startIndex, endIndex, false);
 }
 
 void Bitmap::Divide(uint32_t startIndex,
@@ -198,6 +198,8 @@ class Bitmap {
         char mask = 0x01 << indexInUnit;
         return mask;
     }
+    // 将[startIndex, endIndex]的位全部置1或清0，整字节部分按字节处理
+    void SetRange(uint32_t startIndex, uint32_t endIndex, bool set);
 
  public:
     // 表示不存在的位置，值为0xffffffff
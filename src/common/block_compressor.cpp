@@ -0,0 +1,231 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/common/block_compressor.h"
+
+#include <butil/third_party/snappy/snappy.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "src/common/encode.h"
+
+namespace curve {
+namespace common {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x43424c4b;  // "CBLK"
+constexpr uint32_t kFixedHeaderSize = 24;
+constexpr uint32_t kMaxBlockNum =
+    (BlockCompressor::kHeaderSize - kFixedHeaderSize) / sizeof(uint32_t);
+constexpr uint32_t kRawBlockFlag = 0x80000000;
+constexpr uint32_t kBlockAlignment = 4096;
+
+uint32_t DecodeUint32(const char *buf) {
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(buf);
+    return (static_cast<uint32_t>(p[0]) << 24) |
+           (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+uint64_t DecodeUint64(const char *buf) {
+    return (static_cast<uint64_t>(DecodeUint32(buf)) << 32) |
+           DecodeUint32(buf + 4);
+}
+
+}  // namespace
+
+constexpr uint32_t BlockCompressor::kHeaderSize;
+constexpr uint32_t BlockCompressor::kDefaultBlockSize;
+
+bool StringToCompressType(const std::string &str, CompressType *type) {
+    if (str == "none") {
+        *type = CompressType::NONE;
+    } else if (str == "snappy") {
+        *type = CompressType::SNAPPY;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char *CompressTypeToString(CompressType type) {
+    switch (type) {
+        case CompressType::NONE:
+            return "none";
+        case CompressType::SNAPPY:
+            return "snappy";
+        default:
+            return "unknown";
+    }
+}
+
+bool BlockCompressor::Compress(CompressType type, const char *data,
+                               uint64_t len, std::string *out) {
+    if (type != CompressType::SNAPPY) {
+        LOG(ERROR) << "Unsupported compress type "
+                   << static_cast<uint32_t>(type);
+        return false;
+    }
+
+    // enlarge the blocks if the header can not hold all of them
+    uint64_t blockSize = kDefaultBlockSize;
+    if ((len + blockSize - 1) / blockSize > kMaxBlockNum) {
+        blockSize = (len + kMaxBlockNum - 1) / kMaxBlockNum;
+        blockSize = (blockSize + kBlockAlignment - 1) / kBlockAlignment *
+                    kBlockAlignment;
+    }
+    uint32_t blockNum = (len + blockSize - 1) / blockSize;
+
+    out->assign(kHeaderSize, '\0');
+    out->reserve(kHeaderSize +
+                 butil::snappy::MaxCompressedLength(blockSize) * blockNum);
+    char *header = &(*out)[0];
+    EncodeBigEndian_uint32(header, kMagic);
+    EncodeBigEndian_uint32(header + 4, static_cast<uint32_t>(type));
+    EncodeBigEndian_uint32(header + 8, blockSize);
+    EncodeBigEndian_uint32(header + 12, blockNum);
+    EncodeBigEndian(header + 16, len);
+
+    std::string block(butil::snappy::MaxCompressedLength(blockSize), '\0');
+    for (uint32_t i = 0; i < blockNum; i++) {
+        uint64_t off = i * blockSize;
+        uint64_t rawLen = std::min(blockSize, len - off);
+        size_t compressedLen = 0;
+        butil::snappy::RawCompress(data + off, rawLen, &block[0],
+                                   &compressedLen);
+        uint32_t blockLen = 0;
+        if (compressedLen < rawLen) {
+            out->append(block.data(), compressedLen);
+            blockLen = compressedLen;
+        } else {
+            out->append(data + off, rawLen);
+            blockLen = rawLen | kRawBlockFlag;
+        }
+        EncodeBigEndian_uint32(&(*out)[kFixedHeaderSize + i * 4], blockLen);
+    }
+    return true;
+}
+
+bool BlockCompressor::ParseHeader(const char *buf, uint64_t len,
+                                  CompressedDataHeader *header) {
+    if (len < kFixedHeaderSize || DecodeUint32(buf) != kMagic) {
+        LOG(ERROR) << "Invalid compressed data header";
+        return false;
+    }
+    uint32_t type = DecodeUint32(buf + 4);
+    uint32_t blockSize = DecodeUint32(buf + 8);
+    uint32_t blockNum = DecodeUint32(buf + 12);
+    uint64_t rawLen = DecodeUint64(buf + 16);
+    if (type != static_cast<uint32_t>(CompressType::SNAPPY) ||
+        blockSize == 0 || blockNum > kMaxBlockNum ||
+        len < kFixedHeaderSize + blockNum * 4 ||
+        (rawLen + blockSize - 1) / blockSize != blockNum) {
+        LOG(ERROR) << "Invalid compressed data header, type = " << type
+                   << ", blockSize = " << blockSize
+                   << ", blockNum = " << blockNum << ", rawLen = " << rawLen;
+        return false;
+    }
+
+    header->type = static_cast<CompressType>(type);
+    header->rawLen = rawLen;
+    header->blockSize = blockSize;
+    header->blockLens.resize(blockNum);
+    for (uint32_t i = 0; i < blockNum; i++) {
+        header->blockLens[i] = DecodeUint32(buf + kFixedHeaderSize + i * 4);
+    }
+    return true;
+}
+
+bool BlockCompressor::GetCompressedRange(const CompressedDataHeader &header,
+                                         uint64_t off, uint64_t len,
+                                         uint64_t *compressedOff,
+                                         uint64_t *compressedLen) {
+    if (len == 0 || off + len > header.rawLen) {
+        return false;
+    }
+    uint64_t first = off / header.blockSize;
+    uint64_t last = (off + len - 1) / header.blockSize;
+    *compressedOff = kHeaderSize;
+    *compressedLen = 0;
+    for (uint64_t i = 0; i <= last; i++) {
+        uint32_t blockLen = header.blockLens[i] & ~kRawBlockFlag;
+        if (i < first) {
+            *compressedOff += blockLen;
+        } else {
+            *compressedLen += blockLen;
+        }
+    }
+    return true;
+}
+
+bool BlockCompressor::Decompress(const CompressedDataHeader &header,
+                                 const char *compressed,
+                                 uint64_t compressedLen, uint64_t off,
+                                 uint64_t len, char *out) {
+    if (len == 0 || off + len > header.rawLen) {
+        return false;
+    }
+    uint64_t first = off / header.blockSize;
+    uint64_t last = (off + len - 1) / header.blockSize;
+    std::string block;
+    uint64_t pos = 0;
+    for (uint64_t i = first; i <= last; i++) {
+        uint64_t blockOff = i * header.blockSize;
+        uint64_t rawLen = std::min<uint64_t>(header.blockSize,
+                                             header.rawLen - blockOff);
+        bool raw = (header.blockLens[i] & kRawBlockFlag) != 0;
+        uint32_t blockLen = header.blockLens[i] & ~kRawBlockFlag;
+        if (pos + blockLen > compressedLen) {
+            LOG(ERROR) << "Compressed data is shorter than the header says"
+                       << ", block = " << i;
+            return false;
+        }
+
+        const char *src = compressed + pos;
+        const char *data = src;
+        if (raw) {
+            if (blockLen != rawLen) {
+                return false;
+            }
+        } else {
+            size_t uncompressedLen = 0;
+            if (!butil::snappy::GetUncompressedLength(src, blockLen,
+                                                      &uncompressedLen) ||
+                uncompressedLen != rawLen) {
+                LOG(ERROR) << "Invalid compressed block " << i;
+                return false;
+            }
+            block.resize(rawLen);
+            if (!butil::snappy::RawUncompress(src, blockLen, &block[0])) {
+                LOG(ERROR) << "Decompress block " << i << " failed";
+                return false;
+            }
+            data = block.data();
+        }
+
+        uint64_t from = std::max(off, blockOff);
+        uint64_t to = std::min(off + len, blockOff + rawLen);
+        memcpy(out + (from - off), data + (from - blockOff), to - from);
+        pos += blockLen;
+    }
+    return true;
+}
+
+}  // namespace common
+}  // namespace curve
@@ -0,0 +1,121 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_COMMON_BLOCK_COMPRESSOR_H_
+#define SRC_COMMON_BLOCK_COMPRESSOR_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace curve {
+namespace common {
+
+enum class CompressType : uint32_t {
+    NONE = 0,
+    SNAPPY = 1,
+};
+
+// "none" or "snappy"
+bool StringToCompressType(const std::string &str, CompressType *type);
+
+const char *CompressTypeToString(CompressType type);
+
+struct CompressedDataHeader {
+    CompressType type = CompressType::NONE;
+    // length of the data before compression
+    uint64_t rawLen = 0;
+    uint32_t blockSize = 0;
+    // length of every block after compression, blocks are stored in order
+    // after the header, the highest bit is set if a block is stored raw
+    std::vector<uint32_t> blockLens;
+};
+
+/**
+ * Compress data in fixed size blocks independently, so that a range of the
+ * data can be read and decompressed without the whole data. The layout is
+ *
+ *   | header (kHeaderSize) | block 0 | block 1 | ... |
+ *
+ * and the header is
+ *
+ *   | magic | type | blockSize | blockNum | rawLen | blockLen * blockNum |
+ *
+ * with all integers in big endian, padded to kHeaderSize.
+ */
+class BlockCompressor {
+ public:
+    static constexpr uint32_t kHeaderSize = 4096;
+    static constexpr uint32_t kDefaultBlockSize = 64 * 1024;
+
+    /**
+     * @brief compress the data
+     *
+     * @param type compress type, NONE is not allowed
+     * @param data data to compress
+     * @param len length of the data
+     * @param[out] out the compressed data with the header
+     *
+     * @return false if the type is not supported
+     */
+    static bool Compress(CompressType type, const char *data, uint64_t len,
+                         std::string *out);
+
+    /**
+     * @brief parse the header at the beginning of the compressed data
+     *
+     * @param buf the first kHeaderSize bytes of the compressed data
+     * @param len length of buf
+     * @param[out] header the header
+     *
+     * @return false if the header is invalid
+     */
+    static bool ParseHeader(const char *buf, uint64_t len,
+                            CompressedDataHeader *header);
+
+    /**
+     * @brief the range of the compressed data holding [off, off + len) of
+     *        the raw data, i.e. the blocks covering it
+     *
+     * @return false if the range is out of the raw data
+     */
+    static bool GetCompressedRange(const CompressedDataHeader &header,
+                                   uint64_t off, uint64_t len,
+                                   uint64_t *compressedOff,
+                                   uint64_t *compressedLen);
+
+    /**
+     * @brief decompress [off, off + len) of the raw data
+     *
+     * @param header the header
+     * @param compressed the compressed data read according to
+     *        GetCompressedRange
+     * @param compressedLen length of compressed
+     * @param off offset in the raw data
+     * @param len length to decompress
+     * @param[out] out buffer of at least len bytes
+     *
+     * @return false if the data is corrupted
+     */
+    static bool Decompress(const CompressedDataHeader &header,
+                           const char *compressed, uint64_t compressedLen,
+                           uint64_t off, uint64_t len, char *out);
+};
+
+}  // namespace common
+}  // namespace curve
+
+#endif  // SRC_COMMON_BLOCK_COMPRESSOR_H_
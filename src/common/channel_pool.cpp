@@ -27,25 +27,61 @@ namespace common {
 
 int ChannelPool::GetOrInitChannel(const std::string& addr,
                                   ChannelPtr* channelPtr) {
-    LockGuard guard(mutex_);
+    {
+        ReadLockGuard guard(rwlock_);
+        auto iter = channelMap_.find(addr);
+        if (iter != channelMap_.end()) {
+            *channelPtr = PickChannel(iter->second.get());
+            return 0;
+        }
+    }
+
+    WriteLockGuard guard(rwlock_);
     auto iter = channelMap_.find(addr);
     if (iter != channelMap_.end()) {
-        *channelPtr = iter->second;
+        *channelPtr = PickChannel(iter->second.get());
         return 0;
     }
 
-    auto newChannel = std::make_shared<brpc::Channel>();
-    if (newChannel->Init(addr.c_str(), NULL) != 0) {
-        LOG(ERROR) << "Fail to init channel to " << addr;
-        return -1;
+    auto endpoint = std::make_shared<Endpoint>();
+    for (int i = 0; i < connectionNum_; ++i) {
+        // 同一个连接组的single连接是共享的, 不同的组才会建立各自的连接
+        brpc::ChannelOptions options;
+        if (connectionNum_ > 1) {
+            options.connection_group = "channel_pool_" + std::to_string(i);
+        }
+        auto newChannel = std::make_shared<brpc::Channel>();
+        if (newChannel->Init(addr.c_str(), &options) != 0) {
+            LOG(ERROR) << "Fail to init channel to " << addr;
+            return -1;
+        }
+        endpoint->channels.emplace_back(std::move(newChannel));
     }
-    channelMap_.insert(std::pair<std::string, ChannelPtr>(addr, newChannel));
-    *channelPtr = newChannel;
+    channelMap_.emplace(addr, endpoint);
+    *channelPtr = PickChannel(endpoint.get());
     return 0;
 }
 
+ChannelPtr ChannelPool::PickChannel(Endpoint* endpoint) {
+    const auto& channels = endpoint->channels;
+    const size_t num = channels.size();
+    if (num == 1) {
+        return channels[0];
+    }
+
+    uint64_t start = endpoint->next.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < num; ++i) {
+        const ChannelPtr& channel = channels[(start + i) % num];
+        if (channel->CheckHealth() == 0) {
+            return channel;
+        }
+    }
+    // 都不健康时仍然返回一个, 由rpc返回错误
+    return channels[start % num];
+}
+
 void ChannelPool::Clear() {
-    LockGuard guard(mutex_);
+    WriteLockGuard guard(rwlock_);
     channelMap_.clear();
 }
 
@@ -24,10 +24,12 @@
 #define SRC_COMMON_CHANNEL_POOL_H_
 
 #include <brpc/channel.h>
+#include <atomic>
 #include <unordered_map>
 #include <string>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "src/common/concurrent/concurrent.h"
 
@@ -36,8 +38,19 @@ using ChannelPtr = std::shared_ptr<brpc::Channel>;
 namespace curve {
 namespace common {
 
+/**
+ * 到每个地址的channel池。每个地址可以建立多个连接, 每个连接一个channel,
+ * 请求轮流使用这些连接, 跳过brpc检测为不健康的连接, 断开的连接由brpc的
+ * 健康检查自动重连。查找已有的channel只加读锁
+ */
 class ChannelPool {
  public:
+    /**
+     * @param connectionNum 到每个地址的连接数, 小于1时按1处理
+     */
+    explicit ChannelPool(int connectionNum = 1)
+        : connectionNum_(connectionNum < 1 ? 1 : connectionNum) {}
+
     /**
      * @brief 从channelMap获取或创建并Init到指定地址的channel
      *
@@ -55,8 +68,18 @@ class ChannelPool {
     void Clear();
 
  private:
-    Mutex mutex_;
-    std::unordered_map<std::string, ChannelPtr> channelMap_;
+    struct Endpoint {
+        std::vector<ChannelPtr> channels;
+        std::atomic<uint64_t> next{0};
+    };
+
+    // 轮流选择连接, 优先选择健康的连接
+    static ChannelPtr PickChannel(Endpoint* endpoint);
+
+ private:
+    const int connectionNum_;
+    RWLock rwlock_;
+    std::unordered_map<std::string, std::shared_ptr<Endpoint>> channelMap_;
 };
 
 }  // namespace common
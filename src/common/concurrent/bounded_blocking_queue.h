@@ -120,6 +120,22 @@ class BoundedBlockingDeque : public Uncopyable {
         return front;
     }
 
+    /**
+     * 不阻塞，队列非空且队首元素满足pred时取出队首元素
+     * @return 取出元素返回true，否则返回false
+     */
+    template <typename Pred>
+    bool TakeFrontIf(Pred pred, T *x) {
+        std::unique_lock<std::mutex> guard(mutex_);
+        if (deque_.empty() || !pred(deque_.front())) {
+            return false;
+        }
+        *x = std::move(deque_.front());
+        deque_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+
     T TakeBack() {
         std::unique_lock<std::mutex> guard(mutex_);
         while (deque_.empty()) {
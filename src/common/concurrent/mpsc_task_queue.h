@@ -0,0 +1,232 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_COMMON_CONCURRENT_MPSC_TASK_QUEUE_H_
+#define SRC_COMMON_CONCURRENT_MPSC_TASK_QUEUE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "include/curve_compiler_specific.h"
+#include "src/common/uncopyable.h"
+
+namespace curve {
+namespace common {
+
+/**
+ * Bounded lock-free multi-producer single-consumer task queue.
+ *
+ * Push/Pop only touch atomics in the ring unless the queue is full or
+ * empty, the mutex and condition variables are used to park the waiting
+ * side and the other side only takes the mutex when somebody is parked.
+ * PopBatch drains all the available tasks with one wakeup.
+ *
+ * Only one thread is allowed to call Pop/PopBatch.
+ */
+template <typename MutexT, typename CondVarT>
+class MPSCTaskQueue : public Uncopyable {
+ public:
+    using Task = std::function<void()>;
+
+    /**
+     * @param capacity: max number of tasks in queue,
+     *        rounded up to a power of 2, and at least 2
+     */
+    explicit MPSCTaskQueue(size_t capacity)
+        : capacity_(RoundUpPowerOf2(capacity)),
+          mask_(capacity_ - 1),
+          cells_(new Cell[capacity_]),
+          enqueuePos_(0),
+          dequeuePos_(0),
+          consumerWaiting_(false),
+          producersWaiting_(0) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    template <class F, class... Args>
+    void Push(F&& f, Args&&... args) {
+        Task task = std::bind(std::forward<F>(f), std::forward<Args>(args)...);
+        while (!TryPush(&task)) {
+            WaitNotFull();
+        }
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumerWaiting_.load(std::memory_order_relaxed)) {
+            std::lock_guard<MutexT> lk(mtx_);
+            notEmptyCv_.notify_one();
+        }
+    }
+
+    Task Pop() {
+        Task task;
+        while (!TryPop(&task)) {
+            WaitNotEmpty();
+        }
+        NotifyNotFull();
+        return task;
+    }
+
+    /**
+     * @brief wait until the queue is not empty, then pop at most maxNum
+     *        tasks which are available
+     * @return number of tasks popped
+     */
+    size_t PopBatch(std::vector<Task>* tasks, size_t maxNum) {
+        Task task;
+        while (!TryPop(&task)) {
+            WaitNotEmpty();
+        }
+        tasks->push_back(std::move(task));
+
+        size_t num = 1;
+        while (num < maxNum && TryPop(&task)) {
+            tasks->push_back(std::move(task));
+            ++num;
+        }
+        NotifyNotFull();
+        return num;
+    }
+
+    size_t Size() const {
+        size_t enqueue = enqueuePos_.load(std::memory_order_acquire);
+        size_t dequeue = dequeuePos_.load(std::memory_order_acquire);
+        return enqueue > dequeue ? enqueue - dequeue : 0;
+    }
+
+    size_t Capacity() const { return capacity_; }
+
+ private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        Task task;
+    };
+
+    // the sequence of a cell can't distinguish full from empty if there
+    // is only one cell, so the capacity is at least 2
+    static size_t RoundUpPowerOf2(size_t n) {
+        size_t size = 2;
+        while (size < n) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    bool TryPush(Task* task) {
+        Cell* cell;
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff =
+                static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->task = std::move(*task);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPop(Task* task) {
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        Cell* cell = &cells_[pos & mask_];
+        size_t seq = cell->seq.load(std::memory_order_acquire);
+        if (seq != pos + 1) {
+            return false;
+        }
+
+        *task = std::move(cell->task);
+        cell->task = nullptr;
+        cell->seq.store(pos + capacity_, std::memory_order_release);
+        dequeuePos_.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Empty() const {
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        return cells_[pos & mask_].seq.load(std::memory_order_acquire) !=
+               pos + 1;
+    }
+
+    bool Full() const {
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        size_t seq = cells_[pos & mask_].seq.load(std::memory_order_acquire);
+        return static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos) < 0;
+    }
+
+    void WaitNotEmpty() {
+        std::unique_lock<MutexT> lk(mtx_);
+        consumerWaiting_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (Empty()) {
+            notEmptyCv_.wait(lk);
+        }
+        consumerWaiting_.store(false, std::memory_order_relaxed);
+    }
+
+    void WaitNotFull() {
+        std::unique_lock<MutexT> lk(mtx_);
+        producersWaiting_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (Full()) {
+            notFullCv_.wait(lk);
+        }
+        producersWaiting_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void NotifyNotFull() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (producersWaiting_.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<MutexT> lk(mtx_);
+            notFullCv_.notify_all();
+        }
+    }
+
+ private:
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+
+    CURVE_CACHELINE_ALIGNMENT std::atomic<size_t> enqueuePos_;
+    CURVE_CACHELINE_ALIGNMENT std::atomic<size_t> dequeuePos_;
+
+    CURVE_CACHELINE_ALIGNMENT std::atomic<bool> consumerWaiting_;
+    std::atomic<int> producersWaiting_;
+    MutexT mtx_;
+    CondVarT notEmptyCv_;
+    CondVarT notFullCv_;
+};
+
+}  // namespace common
+}  // namespace curve
+
+#endif  // SRC_COMMON_CONCURRENT_MPSC_TASK_QUEUE_H_
@@ -0,0 +1,229 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/common/concurrent/work_stealing_thread_pool.h"
+
+#include <sys/time.h>
+
+namespace curve {
+namespace common {
+
+namespace {
+
+// the pool and index of the current worker, only set in pthread workers
+// as a bthread may be moved to another pthread
+thread_local WorkStealingThreadPool *tlsPool = nullptr;
+thread_local size_t tlsIndex = 0;
+
+uint64_t NowUs() {
+    struct timeval tm;
+    gettimeofday(&tm, nullptr);
+    return tm.tv_sec * 1000000ULL + tm.tv_usec;
+}
+
+struct BthreadWorkerArg {
+    WorkStealingThreadPool *pool;
+    size_t index;
+};
+
+}  // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool(const std::string &metricPrefix)
+    : useBthread_(false),
+      running_(false),
+      next_(0),
+      pending_(0),
+      sleeping_(0),
+      busy_(0),
+      saturation_(&WorkStealingThreadPool::GetSaturation, this),
+      queueSize_(&WorkStealingThreadPool::GetQueueSize, this) {
+    if (!metricPrefix.empty()) {
+        queueWait_.expose(metricPrefix, "queue_wait");
+        runTime_.expose(metricPrefix, "run");
+        saturation_.expose(metricPrefix + "_saturation");
+        queueSize_.expose(metricPrefix + "_queue_size");
+        stealCount_.expose(metricPrefix + "_steal_count");
+    }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+    Stop();
+}
+
+int WorkStealingThreadPool::Start(int numThreads, bool useBthread) {
+    if (numThreads <= 0) {
+        return -1;
+    }
+    if (running_.exchange(true)) {
+        return 0;
+    }
+
+    useBthread_ = useBthread;
+    workers_.clear();
+    for (int i = 0; i < numThreads; i++) {
+        workers_.emplace_back(new Worker());
+    }
+
+    threads_.clear();
+    bthreads_.clear();
+    for (int i = 0; i < numThreads; i++) {
+        if (!useBthread_) {
+            threads_.emplace_back(
+                new std::thread(&WorkStealingThreadPool::WorkerFunc, this, i));
+            continue;
+        }
+        bthread_t tid;
+        auto *arg = new BthreadWorkerArg{this, static_cast<size_t>(i)};
+        if (bthread_start_background(&tid, nullptr, RunBthreadWorker, arg) !=
+            0) {
+            delete arg;
+            Stop();
+            return -1;
+        }
+        bthreads_.push_back(tid);
+    }
+    return 0;
+}
+
+void WorkStealingThreadPool::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<bthread::Mutex> lk(idleMtx_);
+        idleCond_.notify_all();
+    }
+    for (auto &thr : threads_) {
+        thr->join();
+    }
+    for (auto tid : bthreads_) {
+        bthread_join(tid, nullptr);
+    }
+    threads_.clear();
+    bthreads_.clear();
+
+    for (auto &worker : workers_) {
+        pending_.fetch_sub(static_cast<int64_t>(worker->deque.size()));
+        worker->deque.clear();
+    }
+}
+
+void WorkStealingThreadPool::Submit(Task task) {
+    size_t index = tlsPool == this
+                       ? tlsIndex
+                       : next_.fetch_add(1, std::memory_order_relaxed) %
+                             workers_.size();
+    // counted before pushed so it never goes negative, a worker which
+    // sees it before the push just looks for the task again
+    pending_.fetch_add(1);
+    {
+        Worker *worker = workers_[index].get();
+        std::lock_guard<std::mutex> lk(worker->mtx);
+        worker->deque.push_back(Item{std::move(task), NowUs()});
+    }
+
+    // pairs with the check of pending_ by a parking worker, which has
+    // increased sleeping_ before, so either side sees the other
+    if (sleeping_.load() > 0) {
+        std::lock_guard<bthread::Mutex> lk(idleMtx_);
+        idleCond_.notify_one();
+    }
+}
+
+void *WorkStealingThreadPool::RunBthreadWorker(void *arg) {
+    std::unique_ptr<BthreadWorkerArg> workerArg(
+        static_cast<BthreadWorkerArg *>(arg));
+    workerArg->pool->WorkerFunc(workerArg->index);
+    return nullptr;
+}
+
+void WorkStealingThreadPool::WorkerFunc(size_t index) {
+    if (!useBthread_) {
+        tlsPool = this;
+        tlsIndex = index;
+    }
+
+    while (running_.load(std::memory_order_acquire)) {
+        Item item;
+        if (!PopLocal(index, &item) && !Steal(index, &item)) {
+            Park();
+            continue;
+        }
+
+        pending_.fetch_sub(1);
+        busy_.fetch_add(1, std::memory_order_relaxed);
+        uint64_t startUs = NowUs();
+        queueWait_ << startUs - item.enqueueUs;
+        item.task();
+        runTime_ << NowUs() - startUs;
+        busy_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    if (!useBthread_) {
+        tlsPool = nullptr;
+    }
+}
+
+bool WorkStealingThreadPool::PopLocal(size_t index, Item *item) {
+    Worker *worker = workers_[index].get();
+    std::lock_guard<std::mutex> lk(worker->mtx);
+    if (worker->deque.empty()) {
+        return false;
+    }
+    *item = std::move(worker->deque.front());
+    worker->deque.pop_front();
+    return true;
+}
+
+bool WorkStealingThreadPool::Steal(size_t index, Item *item) {
+    const size_t num = workers_.size();
+    for (size_t i = 1; i < num; i++) {
+        Worker *victim = workers_[(index + i) % num].get();
+        std::unique_lock<std::mutex> lk(victim->mtx, std::try_to_lock);
+        if (!lk.owns_lock() || victim->deque.empty()) {
+            continue;
+        }
+        // the owner takes the oldest, so take the newest
+        *item = std::move(victim->deque.back());
+        victim->deque.pop_back();
+        stealCount_ << 1;
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingThreadPool::Park() {
+    std::unique_lock<bthread::Mutex> lk(idleMtx_);
+    sleeping_.fetch_add(1);
+    while (pending_.load() == 0 && running_.load(std::memory_order_acquire)) {
+        idleCond_.wait(lk);
+    }
+    sleeping_.fetch_sub(1);
+}
+
+double WorkStealingThreadPool::GetSaturation(void *arg) {
+    auto *pool = static_cast<WorkStealingThreadPool *>(arg);
+    size_t num = pool->workers_.size();
+    return num == 0 ? 0.0
+                    : static_cast<double>(pool->busy_.load()) / num;
+}
+
+int64_t WorkStealingThreadPool::GetQueueSize(void *arg) {
+    return static_cast<WorkStealingThreadPool *>(arg)->pending_.load();
+}
+
+}  // namespace common
+}  // namespace curve
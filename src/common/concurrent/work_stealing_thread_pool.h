@@ -0,0 +1,146 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_COMMON_CONCURRENT_WORK_STEALING_THREAD_POOL_H_
+#define SRC_COMMON_CONCURRENT_WORK_STEALING_THREAD_POOL_H_
+
+#include <bthread/bthread.h>
+#include <bthread/condition_variable.h>
+#include <bthread/mutex.h>
+#include <bvar/bvar.h>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "include/curve_compiler_specific.h"
+#include "src/common/uncopyable.h"
+
+namespace curve {
+namespace common {
+
+/**
+ * Thread pool with one task deque per worker. A task submitted by a worker
+ * of the pool goes to its own deque, the others are spread over the deques
+ * round robin, so the submitters and workers rarely contend on one lock.
+ * An idle worker steals the newest task of the other deques before it
+ * parks, unlike TaskThreadPool the tasks are not run in submission order.
+ *
+ * The workers are pthreads by default, or bthreads if |useBthread| so the
+ * tasks may block on bthread primitives without blocking a pthread.
+ *
+ * If |metricPrefix| is not empty, exports:
+ *   <prefix>_queue_wait: latency from submission to start of the tasks
+ *   <prefix>_run: run time of the tasks
+ *   <prefix>_saturation: ratio of workers running a task
+ *   <prefix>_queue_size: number of tasks waiting
+ *   <prefix>_steal_count: number of tasks stolen from other workers
+ */
+class WorkStealingThreadPool : public Uncopyable {
+ public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingThreadPool(const std::string &metricPrefix = "");
+
+    ~WorkStealingThreadPool();
+
+    /**
+     * @param numThreads number of workers, must be greater than 0
+     * @param useBthread run the workers in bthreads instead of pthreads
+     * @return 0 if success, -1 otherwise
+     */
+    int Start(int numThreads, bool useBthread = false);
+
+    // the tasks not started yet are dropped
+    void Stop();
+
+    // same as TaskThreadPool::Enqueue, but the queue is unbounded
+    template <class F, class... Args>
+    void Enqueue(F &&f, Args &&... args) {
+        Submit(std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+    }
+
+    // must be called after Start
+    void Submit(Task task);
+
+    // number of tasks waiting
+    int QueueSize() const {
+        return static_cast<int>(pending_.load(std::memory_order_relaxed));
+    }
+
+    int ThreadOfNums() const {
+        return static_cast<int>(workers_.size());
+    }
+
+ private:
+    struct Item {
+        Task task;
+        uint64_t enqueueUs;
+    };
+
+    struct CURVE_CACHELINE_ALIGNMENT Worker {
+        std::mutex mtx;
+        std::deque<Item> deque;
+    };
+
+    static void *RunBthreadWorker(void *arg);
+
+    void WorkerFunc(size_t index);
+
+    bool PopLocal(size_t index, Item *item);
+
+    bool Steal(size_t index, Item *item);
+
+    // wait until a task is submitted or the pool stops
+    void Park();
+
+    static double GetSaturation(void *arg);
+
+    static int64_t GetQueueSize(void *arg);
+
+ private:
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::unique_ptr<std::thread>> threads_;
+    std::vector<bthread_t> bthreads_;
+    bool useBthread_;
+    std::atomic<bool> running_;
+    std::atomic<uint64_t> next_;
+
+    std::atomic<int64_t> pending_;
+    std::atomic<int64_t> sleeping_;
+    std::atomic<int64_t> busy_;
+    // works in both pthreads and bthreads
+    bthread::Mutex idleMtx_;
+    bthread::ConditionVariable idleCond_;
+
+    bvar::LatencyRecorder queueWait_;
+    bvar::LatencyRecorder runTime_;
+    bvar::PassiveStatus<double> saturation_;
+    bvar::PassiveStatus<int64_t> queueSize_;
+    bvar::Adder<uint64_t> stealCount_;
+};
+
+}  // namespace common
+}  // namespace curve
+
+#endif  // SRC_COMMON_CONCURRENT_WORK_STEALING_THREAD_POOL_H_
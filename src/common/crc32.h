@@ -24,13 +24,206 @@
 #define SRC_COMMON_CRC32_H_
 
 #include <stdint.h>
+#include <string.h>
 #include <sys/types.h>
 
 #include <butil/crc32c.h>
+#include <butil/iobuf.h>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
 
 namespace curve {
 namespace common {
 
+namespace detail {
+
+// CRC32C的反射多项式
+constexpr uint32_t kCrc32cPoly = 0x82f63b78;
+
+/**
+ * GF(2)上模多项式的乘法 a * b mod P, 最高位表示x^0。
+ * 以寄存器值r开始计算长度为n的数据，相当于r乘以x^(8n)
+ */
+inline uint32_t Crc32cMultModP(uint32_t a, uint32_t b) {
+    uint32_t m = 1u << 31;
+    uint32_t p = 0;
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0) {
+                break;
+            }
+        }
+        m >>= 1;
+        b = b & 1 ? (b >> 1) ^ kCrc32cPoly : b >> 1;
+    }
+    return p;
+}
+
+// x^(n * 2^k) mod P
+inline uint32_t Crc32cX2nModP(uint64_t n, unsigned k) {
+    struct X2nTable {
+        uint32_t t[32];
+        X2nTable() {
+            uint32_t p = 1u << 30;  // x^1
+            t[0] = p;
+            for (int i = 1; i < 32; i++) {
+                t[i] = p = Crc32cMultModP(p, p);
+            }
+        }
+    };
+    static const X2nTable table;
+
+    uint32_t p = 1u << 31;  // x^0
+    while (n) {
+        if (n & 1) {
+            p = Crc32cMultModP(table.t[k & 31], p);
+        }
+        n >>= 1;
+        k++;
+    }
+    return p;
+}
+
+/**
+ * 把寄存器值后移固定长度的查表实现, 即乘以x^(8 * len), 用于合并交织计算的
+ * 多路CRC, 4次查表代替Crc32cMultModP的逐位计算
+ */
+class Crc32cShift {
+ public:
+    explicit Crc32cShift(size_t len) {
+        uint32_t op = Crc32cX2nModP(len, 3);
+        for (int i = 0; i < 4; i++) {
+            for (uint32_t b = 0; b < 256; b++) {
+                t_[i][b] = Crc32cMultModP(op, b << (8 * i));
+            }
+        }
+    }
+
+    uint32_t operator()(uint32_t crc) const {
+        return t_[0][crc & 0xff] ^ t_[1][(crc >> 8) & 0xff] ^
+               t_[2][(crc >> 16) & 0xff] ^ t_[3][crc >> 24];
+    }
+
+ private:
+    uint32_t t_[4][256];
+};
+
+// 交织计算时每一路的长度, 长的用于大块数据, 短的用于剩余部分
+constexpr size_t kCrc32cLongLane = 8192;
+constexpr size_t kCrc32cShortLane = 256;
+
+#if defined(__x86_64__) || \
+    (defined(__aarch64__) && defined(__ARM_FEATURE_CRC32))
+
+#if defined(__x86_64__)
+#define CURVE_CRC32C_TARGET __attribute__((target("sse4.2")))
+CURVE_CRC32C_TARGET inline uint32_t Crc32cU8(uint32_t crc, uint8_t v) {
+    return _mm_crc32_u8(crc, v);
+}
+CURVE_CRC32C_TARGET inline uint32_t Crc32cU64(uint32_t crc, uint64_t v) {
+    return static_cast<uint32_t>(_mm_crc32_u64(crc, v));
+}
+inline bool Crc32cHwAvailable() {
+    static const bool available = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse4.2") != 0;
+    }();
+    return available;
+}
+#else
+#define CURVE_CRC32C_TARGET
+inline uint32_t Crc32cU8(uint32_t crc, uint8_t v) {
+    return __crc32cb(crc, v);
+}
+inline uint32_t Crc32cU64(uint32_t crc, uint64_t v) {
+    return __crc32cd(crc, v);
+}
+inline bool Crc32cHwAvailable() {
+    return true;
+}
+#endif
+
+inline uint64_t Crc32cLoad64(const char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// 3路交织计算, 每路长度为lane, 返回后data和len指向剩余的部分
+CURVE_CRC32C_TARGET inline uint32_t Crc32cHw3Way(uint32_t crc, size_t lane,
+                                                 const Crc32cShift &shift,
+                                                 const char **data,
+                                                 size_t *len) {
+    const char *p = *data;
+    size_t n = *len;
+    while (n >= 3 * lane) {
+        uint32_t crc1 = 0;
+        uint32_t crc2 = 0;
+        const char *end = p + lane;
+        do {
+            crc = Crc32cU64(crc, Crc32cLoad64(p));
+            crc1 = Crc32cU64(crc1, Crc32cLoad64(p + lane));
+            crc2 = Crc32cU64(crc2, Crc32cLoad64(p + 2 * lane));
+            p += 8;
+        } while (p < end);
+        crc = shift(crc) ^ crc1;
+        crc = shift(crc) ^ crc2;
+        p += 2 * lane;
+        n -= 3 * lane;
+    }
+    *data = p;
+    *len = n;
+    return crc;
+}
+
+/**
+ * 硬件指令计算CRC32C, 输入输出都是未取反的寄存器值。每条crc32指令有3个周期
+ * 的延迟, 单路计算时只能利用1/3的吞吐, 所以大块数据分成3路交织计算再合并
+ */
+CURVE_CRC32C_TARGET inline uint32_t Crc32cHw(uint32_t crc, const char *data,
+                                             size_t len) {
+    static const Crc32cShift longShift(kCrc32cLongLane);
+    static const Crc32cShift shortShift(kCrc32cShortLane);
+
+    while (len > 0 && (reinterpret_cast<uintptr_t>(data) & 7) != 0) {
+        crc = Crc32cU8(crc, *data++);
+        len--;
+    }
+    crc = Crc32cHw3Way(crc, kCrc32cLongLane, longShift, &data, &len);
+    crc = Crc32cHw3Way(crc, kCrc32cShortLane, shortShift, &data, &len);
+    while (len >= 8) {
+        crc = Crc32cU64(crc, Crc32cLoad64(data));
+        data += 8;
+        len -= 8;
+    }
+    while (len > 0) {
+        crc = Crc32cU8(crc, *data++);
+        len--;
+    }
+    return crc;
+}
+
+#undef CURVE_CRC32C_TARGET
+
+#else
+
+inline bool Crc32cHwAvailable() {
+    return false;
+}
+
+inline uint32_t Crc32cHw(uint32_t crc, const char *, size_t) {
+    return crc;
+}
+
+#endif
+
+}  // namespace detail
+
 /**
  * 计算数据的CRC32校验码(CRC32C)，基于brpc的crc32库进行封装
  * @param pData 待计算的数据
@@ -38,6 +231,9 @@ namespace common {
  * @return 32位的数据CRC32校验码
  */
 inline uint32_t CRC32(const char *pData, size_t iLen) {
+    if (detail::Crc32cHwAvailable()) {
+        return ~detail::Crc32cHw(~0u, pData, iLen);
+    }
     return butil::crc32c::Value(pData, iLen);
 }
 
@@ -51,9 +247,47 @@ inline uint32_t CRC32(const char *pData, size_t iLen) {
  * @return 32位的数据CRC32校验码
  */
 inline uint32_t CRC32(uint32_t crc, const char *pData, size_t iLen) {
+    if (detail::Crc32cHwAvailable()) {
+        return ~detail::Crc32cHw(~crc, pData, iLen);
+    }
     return butil::crc32c::Extend(crc, pData, iLen);
 }
 
+/**
+ * 合并两段数据的CRC32校验码, 满足如下约束:
+ * CRC32("hello world", 11) ==
+ *     CRC32Combine(CRC32("hello ", 6), CRC32("world", 5), 5)
+ * 所以大块数据可以分段并行计算后再合并
+ * @param crc1 前一段数据的crc校验码
+ * @param crc2 后一段数据的crc校验码
+ * @param len2 后一段数据的长度
+ * @return 32位的数据CRC32校验码
+ */
+inline uint32_t CRC32Combine(uint32_t crc1, uint32_t crc2, size_t len2) {
+    return detail::Crc32cMultModP(detail::Crc32cX2nModP(len2, 3), crc1) ^
+           crc2;
+}
+
+/**
+ * 继承式计算IOBuf的CRC32校验码, 逐个计算IOBuf引用的内存块, 不需要拷贝成
+ * 连续的内存
+ * @param crc 起始的crc校验码
+ * @param buf 待计算的数据
+ * @return 32位的数据CRC32校验码
+ */
+inline uint32_t CRC32(uint32_t crc, const butil::IOBuf &buf) {
+    const size_t num = buf.backing_block_num();
+    for (size_t i = 0; i < num; i++) {
+        butil::StringPiece block = buf.backing_block(i);
+        crc = CRC32(crc, block.data(), block.size());
+    }
+    return crc;
+}
+
+inline uint32_t CRC32(const butil::IOBuf &buf) {
+    return CRC32(0, buf);
+}
+
 }  // namespace common
 }  // namespace curve
 
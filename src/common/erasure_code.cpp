@@ -0,0 +1,230 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/common/erasure_code.h"
+
+#include <cstring>
+#include <utility>
+
+namespace curve {
+namespace common {
+
+namespace {
+
+// GF(2^8) with the polynomial x^8 + x^4 + x^3 + x^2 + 1
+class GaloisField {
+ public:
+    GaloisField() {
+        uint32_t x = 1;
+        for (uint32_t i = 0; i < 255; ++i) {
+            exp_[i] = static_cast<uint8_t>(x);
+            exp_[i + 255] = static_cast<uint8_t>(x);
+            log_[x] = static_cast<uint8_t>(i);
+            x <<= 1;
+            if (x & 0x100) {
+                x ^= 0x11d;
+            }
+        }
+        log_[0] = 0;
+        for (uint32_t a = 0; a < 256; ++a) {
+            for (uint32_t b = 0; b < 256; ++b) {
+                mul_[a][b] = Multiply(a, b);
+            }
+        }
+    }
+
+    uint8_t Multiply(uint32_t a, uint32_t b) const {
+        if (a == 0 || b == 0) {
+            return 0;
+        }
+        return exp_[log_[a] + log_[b]];
+    }
+
+    // a must not be 0
+    uint8_t Inverse(uint32_t a) const {
+        return exp_[255 - log_[a]];
+    }
+
+    // products of a and every byte
+    const uint8_t* MulTable(uint8_t a) const {
+        return mul_[a];
+    }
+
+ private:
+    uint8_t exp_[510];
+    uint8_t log_[256];
+    uint8_t mul_[256][256];
+};
+
+const GaloisField& GF() {
+    static const GaloisField* field = new GaloisField();
+    return *field;
+}
+
+}  // namespace
+
+const uint32_t ErasureCode::kMaxShardNum;
+
+bool ErasureCode::Init(uint32_t dataNum, uint32_t parityNum) {
+    if (dataNum == 0 || parityNum == 0 ||
+        dataNum + parityNum > kMaxShardNum) {
+        return false;
+    }
+
+    dataNum_ = dataNum;
+    parityNum_ = parityNum;
+    // cauchy matrix 1 / (x_i + y_j), x_i = dataNum + i and y_j = j are
+    // distinct elements
+    parityMatrix_.resize(parityNum * dataNum);
+    for (uint32_t i = 0; i < parityNum; ++i) {
+        for (uint32_t j = 0; j < dataNum; ++j) {
+            parityMatrix_[i * dataNum + j] = GF().Inverse((dataNum + i) ^ j);
+        }
+    }
+    return true;
+}
+
+void ErasureCode::Encode(const uint8_t* const* data, uint8_t* const* parity,
+                         size_t length) const {
+    for (uint32_t i = 0; i < parityNum_; ++i) {
+        Combine(&parityMatrix_[i * dataNum_], data, dataNum_, parity[i],
+                length);
+    }
+}
+
+bool ErasureCode::Decode(uint8_t* const* shards,
+                         const std::vector<bool>& present,
+                         size_t length) const {
+    const uint32_t total = dataNum_ + parityNum_;
+    if (present.size() != total) {
+        return false;
+    }
+
+    // the rows of the generator matrix of the first dataNum valid shards
+    std::vector<uint32_t> rows;
+    bool dataLost = false;
+    for (uint32_t i = 0; i < total && rows.size() < dataNum_; ++i) {
+        if (present[i]) {
+            rows.push_back(i);
+        } else if (i < dataNum_) {
+            dataLost = true;
+        }
+    }
+    if (rows.size() < dataNum_) {
+        return false;
+    }
+
+    if (dataLost) {
+        std::vector<uint8_t> matrix(dataNum_ * dataNum_, 0);
+        std::vector<const uint8_t*> in(dataNum_);
+        for (uint32_t i = 0; i < dataNum_; ++i) {
+            const uint32_t row = rows[i];
+            if (row < dataNum_) {
+                matrix[i * dataNum_ + row] = 1;
+            } else {
+                memcpy(&matrix[i * dataNum_],
+                       &parityMatrix_[(row - dataNum_) * dataNum_], dataNum_);
+            }
+            in[i] = shards[row];
+        }
+        if (!Invert(&matrix, dataNum_)) {
+            return false;
+        }
+        for (uint32_t j = 0; j < dataNum_; ++j) {
+            if (!present[j]) {
+                Combine(&matrix[j * dataNum_], in.data(), dataNum_,
+                        shards[j], length);
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < parityNum_; ++i) {
+        if (!present[dataNum_ + i]) {
+            Combine(&parityMatrix_[i * dataNum_], shards, dataNum_,
+                    shards[dataNum_ + i], length);
+        }
+    }
+    return true;
+}
+
+bool ErasureCode::Invert(std::vector<uint8_t>* matrix, uint32_t n) {
+    std::vector<uint8_t>& m = *matrix;
+    std::vector<uint8_t> inv(n * n, 0);
+    for (uint32_t i = 0; i < n; ++i) {
+        inv[i * n + i] = 1;
+    }
+
+    for (uint32_t col = 0; col < n; ++col) {
+        uint32_t pivot = col;
+        while (pivot < n && m[pivot * n + col] == 0) {
+            ++pivot;
+        }
+        if (pivot == n) {
+            return false;
+        }
+        if (pivot != col) {
+            for (uint32_t k = 0; k < n; ++k) {
+                std::swap(m[pivot * n + k], m[col * n + k]);
+                std::swap(inv[pivot * n + k], inv[col * n + k]);
+            }
+        }
+
+        const uint8_t* scale = GF().MulTable(GF().Inverse(m[col * n + col]));
+        for (uint32_t k = 0; k < n; ++k) {
+            m[col * n + k] = scale[m[col * n + k]];
+            inv[col * n + k] = scale[inv[col * n + k]];
+        }
+
+        for (uint32_t row = 0; row < n; ++row) {
+            const uint8_t factor = m[row * n + col];
+            if (row == col || factor == 0) {
+                continue;
+            }
+            const uint8_t* mul = GF().MulTable(factor);
+            for (uint32_t k = 0; k < n; ++k) {
+                m[row * n + k] ^= mul[m[col * n + k]];
+                inv[row * n + k] ^= mul[inv[col * n + k]];
+            }
+        }
+    }
+
+    m.swap(inv);
+    return true;
+}
+
+void ErasureCode::Combine(const uint8_t* coef, const uint8_t* const* in,
+                          uint32_t count, uint8_t* out, size_t length) {
+    memset(out, 0, length);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (coef[i] == 0) {
+            continue;
+        }
+        const uint8_t* src = in[i];
+        if (coef[i] == 1) {
+            for (size_t b = 0; b < length; ++b) {
+                out[b] ^= src[b];
+            }
+            continue;
+        }
+        const uint8_t* mul = GF().MulTable(coef[i]);
+        for (size_t b = 0; b < length; ++b) {
+            out[b] ^= mul[src[b]];
+        }
+    }
+}
+
+}  // namespace common
+}  // namespace curve
@@ -0,0 +1,93 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_COMMON_ERASURE_CODE_H_
+#define SRC_COMMON_ERASURE_CODE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace curve {
+namespace common {
+
+/**
+ * Systematic Reed-Solomon code over GF(2^8), a stripe is dataNum data
+ * shards followed by parityNum parity shards of the same length, and any
+ * dataNum of them recover the others.
+ *
+ * The generator matrix is the identity on top of a Cauchy matrix, every
+ * square submatrix of it is invertible, so the shards can be lost in any
+ * combination as long as no more than parityNum of them.
+ */
+class ErasureCode {
+ public:
+    // dataNum + parityNum must not exceed it
+    static const uint32_t kMaxShardNum = 256;
+
+    /**
+     * @brief set up the code of dataNum data shards and parityNum parity
+     *        shards
+     * @return false if the numbers are invalid
+     */
+    bool Init(uint32_t dataNum, uint32_t parityNum);
+
+    uint32_t DataNum() const {
+        return dataNum_;
+    }
+
+    uint32_t ParityNum() const {
+        return parityNum_;
+    }
+
+    /**
+     * @brief compute the parity shards of a stripe
+     * @param data dataNum data shards of length bytes
+     * @param parity parityNum buffers of length bytes for the parity shards
+     */
+    void Encode(const uint8_t* const* data, uint8_t* const* parity,
+                size_t length) const;
+
+    /**
+     * @brief recover the shards lost
+     * @param shards dataNum + parityNum shards of length bytes, the data
+     *        and then the parity ones
+     * @param present whether every shard is valid, the ones not valid are
+     *        overwritten with the recovered content
+     * @return false if less than dataNum shards are valid
+     */
+    bool Decode(uint8_t* const* shards, const std::vector<bool>& present,
+                size_t length) const;
+
+ private:
+    // invert the n x n matrix in place, false if it's singular
+    static bool Invert(std::vector<uint8_t>* matrix, uint32_t n);
+
+    // out = sum(coef[i] * in[i]) of count shards
+    static void Combine(const uint8_t* coef, const uint8_t* const* in,
+                        uint32_t count, uint8_t* out, size_t length);
+
+ private:
+    uint32_t dataNum_ = 0;
+    uint32_t parityNum_ = 0;
+    // parityNum x dataNum coefficients of the parity shards
+    std::vector<uint8_t> parityMatrix_;
+};
+
+}  // namespace common
+}  // namespace curve
+
+#endif  // SRC_COMMON_ERASURE_CODE_H_
@@ -31,6 +31,8 @@ namespace common {
 
 const char CURVE_TYPE[] = "cs";
 const char S3_TYPE[] = "s3";
+// s3上按块压缩的对象，格式见BlockCompressor
+const char S3_COMPRESSED_TYPE[] = "s3z";
 const char kOriginTypeSeprator[] = "@";
 const char kOriginPathSeprator[] = ":";
 
@@ -38,6 +40,7 @@ enum class OriginType {
     S3Origin = 0,
     CurveOrigin = 1,
     InvalidOrigin = 2,
+    S3CompressedOrigin = 3,
 };
 
 class LocationOperator {
@@ -49,6 +52,14 @@ class LocationOperator {
      * @return:生成的location
      */
     static std::string GenerateS3Location(const std::string& objectName);
+    /**
+     * 生成s3上按块压缩的对象的location
+     * location格式:${objectname}@s3z
+     * @param objectName:s3上object的名称
+     * @return:生成的location
+     */
+    static std::string GenerateS3CompressedLocation(
+        const std::string& objectName);
     /**
      * 生成curve的location
      * location格式:${filename}:${offset}@cs
@@ -59,6 +70,7 @@ class LocationOperator {
      * 解析数据源的位置信息
      * location格式:
      * s3示例：${objectname}@s3
+     * s3压缩对象示例：${objectname}@s3z
      * curve示例：${filename}:${offset}@cs
      *
      * @param location[in]:数据源的位置，其格式为originPath@originType
@@ -26,10 +26,14 @@
 #include <bvar/bvar.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <list>
 #include <string>
 #include <memory>
+#include <vector>
 #include <unordered_map>
 #include "src/common/concurrent/concurrent.h"
 #include "src/common/timeutility.h"
@@ -166,6 +170,14 @@ class LRUCache : public LRUCacheInterface<K, V> {
       : maxCount_(maxCount),
         cacheMetrics_(cacheMetrics) {}
 
+    // also evict the oldest items once the bytes of all keys and values
+    // exceed |maxBytes|, the newest item is always kept
+    LRUCache(uint64_t maxCount, uint64_t maxBytes,
+        std::shared_ptr<CacheMetrics> cacheMetrics = nullptr)
+      : maxCount_(maxCount),
+        maxBytes_(maxBytes),
+        cacheMetrics_(cacheMetrics) {}
+
     /**
      * @brief Store key-value to the cache
      *
@@ -203,6 +215,11 @@ class LRUCache : public LRUCacheInterface<K, V> {
     */
     void Remove(const K &key) override;
 
+    /*
+    * @brief Clear Remove all key-values from cache
+    */
+    void Clear();
+
     /*
     * @brief Get the first key that $value = value
     *
@@ -286,6 +303,9 @@ class LRUCache : public LRUCacheInterface<K, V> {
 
     // the maximum length of the queue. 0 indicates unlimited length
     uint64_t maxCount_;
+    // the maximum bytes of the items. 0 indicates unlimited
+    uint64_t maxBytes_ = 0;
+    uint64_t bytes_ = 0;
     // dequeue for storing items
     std::list<Item> ll_;
     // record the position of the item corresponding to the key in the dequeue
@@ -392,6 +412,14 @@ void LRUCache<K, V, KeyTraits, ValueTraits>::Remove(const K &key) {
     RemoveLocked(key);
 }
 
+template <typename K,  typename V, typename KeyTraits, typename ValueTraits>
+void LRUCache<K, V, KeyTraits, ValueTraits>::Clear() {
+    ::curve::common::WriteLockGuard guard(lock_);
+    while (!ll_.empty()) {
+        RemoveElement(ll_.begin());
+    }
+}
+
 template <typename K,  typename V, typename KeyTraits, typename ValueTraits>
 bool LRUCache<K, V, KeyTraits, ValueTraits>::PutLocked(
     const K &key, const V &value, V *eliminated) {
@@ -407,15 +435,21 @@ bool LRUCache<K, V, KeyTraits, ValueTraits>::PutLocked(
     ll_.push_front(kv);
     cache_[key] = ll_.begin();
     ll_.begin()->key = &(cache_.find(key)->first);
+    uint64_t bytes =
+        KeyTraits::CountBytes(key) + ValueTraits::CountBytes(value);
+    bytes_ += bytes;
     if (cacheMetrics_ != nullptr) {
         cacheMetrics_->UpdateAddToCacheCount();
-        cacheMetrics_->UpdateAddToCacheBytes(
-           KeyTraits::CountBytes(key)  + ValueTraits::CountBytes(value));
+        cacheMetrics_->UpdateAddToCacheBytes(bytes);
     }
+    bool evicted = false;
     if (maxCount_ != 0 && ll_.size() > maxCount_) {
-        return RemoveOldest(eliminated);
+        evicted = RemoveOldest(eliminated);
     }
-    return false;
+    while (maxBytes_ != 0 && bytes_ > maxBytes_ && ll_.size() > 1) {
+        evicted = RemoveOldest(eliminated);
+    }
+    return evicted;
 }
 
 template <typename K,  typename V, typename KeyTraits, typename ValueTraits>
@@ -448,11 +482,12 @@ bool LRUCache<K, V, KeyTraits, ValueTraits>::RemoveOldest(V *eliminated) {
 template <typename K,  typename V, typename KeyTraits, typename ValueTraits>
 void LRUCache<K, V, KeyTraits, ValueTraits>::RemoveElement(
     const typename std::list<Item>::iterator &elem) {
+    uint64_t bytes = KeyTraits::CountBytes(*(elem->key)) +
+                     ValueTraits::CountBytes(elem->value);
+    bytes_ -= bytes;
     if (cacheMetrics_ != nullptr) {
         cacheMetrics_->UpdateRemoveFromCacheCount();
-        cacheMetrics_->UpdateRemoveFromCacheBytes(
-            KeyTraits::CountBytes(*(elem->key)) +
-            ValueTraits::CountBytes(elem->value));
+        cacheMetrics_->UpdateRemoveFromCacheBytes(bytes);
     }
     const typename std::list<Item>::iterator elemTmp = elem;
     auto iter = cache_.find(*(elem->key));
@@ -841,6 +876,396 @@ void SglLRUCache<K, KeyTraits>::RemoveElement(
 
 #include "src/common/arc_cache.h"
 
+// ClockCache is a sharded cache which approximates LRU by the CLOCK
+// algorithm. Unlike LRUCache, a hit only sets the atomic reference bit of
+// the item instead of moving it to the list head, so Get() holds the shard
+// lock in read mode and concurrent hits never block each other.
+// Every shard evicts on its own, |maxCount| is split evenly over shards.
+template <typename K, typename V,
+    typename Hash = std::hash<K>,
+    typename KeyTraits = CacheTraits<K>,
+    typename ValueTraits = CacheTraits<V>>
+class ClockCache : public LRUCacheInterface<K, V> {
+ public:
+    explicit ClockCache(uint64_t maxCount,
+        uint32_t shardNum = 16,
+        std::shared_ptr<CacheMetrics> cacheMetrics = nullptr);
+
+    void Put(const K &key, const V &value) override;
+
+    bool Put(const K &key, const V &value, V *eliminated) override;
+
+    bool Get(const K &key, V *value) override;
+
+    void Remove(const K &key) override;
+
+    uint64_t Size() override;
+
+    std::shared_ptr<CacheMetrics> GetCacheMetrics() const;
+
+ private:
+    struct Slot {
+        K key;
+        V value;
+        bool used = false;
+        std::atomic<bool> referenced{false};
+    };
+
+    struct Shard {
+        ::curve::common::RWLock lock;
+        // slots never move once created, so the index can refer to them
+        // by position
+        std::deque<Slot> slots;
+        std::unordered_map<K, size_t, Hash> index;
+        std::vector<size_t> freeSlots;
+        // the clock hand
+        size_t hand = 0;
+    };
+
+    Shard* GetShard(const K &key);
+
+    bool PutLocked(Shard *shard, const K &key, const V &value,
+                   V *eliminated);
+
+    // Return the position of the slot to be reused, the item in it is
+    // the one which isn't referenced since the hand passed last time.
+    size_t EvictLocked(Shard *shard);
+
+    void OnRemove(const Slot &slot);
+
+ private:
+    // the maximum items of one shard. 0 indicates unlimited
+    uint64_t shardCapacity_;
+    Hash hash_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::shared_ptr<CacheMetrics> cacheMetrics_;
+};
+
+template <typename K, typename V, typename Hash, typename KeyTraits,
+          typename ValueTraits>
+ClockCache<K, V, Hash, KeyTraits, ValueTraits>::ClockCache(
+    uint64_t maxCount, uint32_t shardNum,
+    std::shared_ptr<CacheMetrics> cacheMetrics)
+    : shardCapacity_(0),
+      hash_(),
+      shards_(),
+      cacheMetrics_(cacheMetrics) {
+    shardNum = std::max(shardNum, 1u);
+    if (maxCount != 0) {
+        shardNum = std::min<uint64_t>(shardNum, maxCount);
+        shardCapacity_ = (maxCount + shardNum - 1) / shardNum;
+    }
+    for (uint32_t i = 0; i < shardNum; i++) {
+        shards_.emplace_back(new Shard());
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyTraits,
+          typename ValueTraits>
+typename ClockCache<K, V, Hash, KeyTraits, ValueTraits>::Shard*
+ClockCache<K, V, Hash, KeyTraits, ValueTraits>::GetShard(const K &key) {
+    return shards_[hash_(key) % shards_.size()].get();
+}
+
+template <typename K, typename V, typename Hash, typename KeyTraits,
+          typename ValueTraits>
+void ClockCache<K, V, Hash, KeyTraits, ValueTraits>::Put(
+    const K &key, const V &value) {
+    V eliminated;
+    Put(key, value, &eliminated);
+}
+
+template <typename K, typename V, typename Hash, typename KeyTraits,
+          typename ValueTraits>
+bool ClockCache<K, V, Hash, KeyTraits, ValueTraits>::Put(
+    const K &key, const V &value, V *eliminated) {
+    Shard* shard = GetShard(key);
+    ::curve::common::WriteLockGuard guard(shard->lock);
+    return PutLocked(shard, key, value, eliminated);
+}
+
+template <typename K, typename V, typename Hash, typename KeyTraits,
+          typename ValueTraits>
+bool ClockCache<K, V, Hash, KeyTraits, ValueTraits>::PutLocked(
+    Shard *shard, const K &key, const V &value, V *eliminated) {
+    auto iter = shard->index.find(key);
+    if (iter != shard->index.end()) {  // overwrite
+        Slot& slot = shard->slots[iter->second];
+        OnRemove(slot);
+        slot.value = value;
+        slot.referenced.store(true, std::memory_order_relaxed);
+        if (cacheMetrics_ != nullptr) {
+            cacheMetrics_->UpdateAddToCacheCount();
+            cacheMetrics_->UpdateAddToCacheBytes(
+                KeyTraits::CountBytes(key) + ValueTraits::CountBytes(value));
+        }
+        return false;
+    }
+
+    size_t pos;
+    bool evicted = false;
+    if (!shard->freeSlots.empty()) {
+        pos = shard->freeSlots.back();
+        shard->freeSlots.pop_back();
+    } else if (shardCapacity_ == 0 ||
+               shard->slots.size() < shardCapacity_) {
+        shard->slots.emplace_back();
+        pos = shard->slots.size() - 1;
+    } else {
+        pos = EvictLocked(shard);
+        Slot& victim = shard->slots[pos];
+        OnRemove(victim);
+        *eliminated = std::move(victim.value);
+        shard->index.erase(victim.key);
+        evicted = true;
+    }
+
+    Slot& slot = shard->slots[pos];
+    slot.key = key;
+    slot.value = value;
+    slot.used = true;
+    slot.referenced.store(false, std::memory_order_relaxed);
+    shard->index[key] = pos;
+    if (cacheMetrics_ != nullptr) {
+        cacheMetrics_->UpdateAddToCacheCount();
+        cacheMetrics_->UpdateAddToCacheBytes(
+            KeyTraits::CountBytes(key) + ValueTraits::CountBytes(value));
+    }
+    return evicted;
+}
+
+template <typename K, typename V, typename Hash, typename KeyTraits,
+          typename ValueTraits>
+size_t ClockCache<K, V, Hash, KeyTraits, ValueTraits>::EvictLocked(
+    Shard *shard) {
+    // it takes at most two rounds: the first round clears all reference bits
+    for (;;) {
+        size_t pos = shard->hand;
+        shard->hand = (shard->hand + 1) % shard->slots.size();
+        Slot& slot = shard->slots[pos];
+        if (!slot.used) {
+            continue;
+        } else if (slot.referenced.exchange(false,
+                                            std::memory_order_relaxed)) {
+            continue;  // second chance
+        }
+        return pos;
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyTraits,
+          typename ValueTraits>
+bool ClockCache<K, V, Hash, KeyTraits, ValueTraits>::Get(
+    const K &key, V *value) {
+    Shard* shard = GetShard(key);
+    ::curve::common::ReadLockGuard guard(shard->lock);
+    auto iter = shard->index.find(key);
+    if (iter == shard->index.end()) {
+        if (cacheMetrics_ != nullptr) {
+            cacheMetrics_->OnCacheMiss();
+        }
+        return false;
+    }
+
+    Slot& slot = shard->slots[iter->second];
+    // avoid the store if it's set already, which keeps the cache line
+    // shared among the readers of a hot item
+    if (!slot.referenced.load(std::memory_order_relaxed)) {
+        slot.referenced.store(true, std::memory_order_relaxed);
+    }
+    *value = slot.value;
+    if (cacheMetrics_ != nullptr) {
+        cacheMetrics_->OnCacheHit();
+    }
+    return true;
+}
+
+template <typename K, typename V, typename Hash, typename KeyTraits,
+          typename ValueTraits>
+void ClockCache<K, V, Hash, KeyTraits, ValueTraits>::Remove(const K &key) {
+    Shard* shard = GetShard(key);
+    ::curve::common::WriteLockGuard guard(shard->lock);
+    auto iter = shard->index.find(key);
+    if (iter == shard->index.end()) {
+        return;
+    }
+
+    size_t pos = iter->second;
+    Slot& slot = shard->slots[pos];
+    OnRemove(slot);
+    slot.used = false;
+    slot.key = K();
+    slot.value = V();
+    shard->index.erase(iter);
+    shard->freeSlots.push_back(pos);
+}
+
+template <typename K, typename V, typename Hash, typename KeyTraits,
+          typename ValueTraits>
+void ClockCache<K, V, Hash, KeyTraits, ValueTraits>::OnRemove(
+    const Slot &slot) {
+    if (cacheMetrics_ != nullptr) {
+        cacheMetrics_->UpdateRemoveFromCacheCount();
+        cacheMetrics_->UpdateRemoveFromCacheBytes(
+            KeyTraits::CountBytes(slot.key) +
+            ValueTraits::CountBytes(slot.value));
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyTraits,
+          typename ValueTraits>
+uint64_t ClockCache<K, V, Hash, KeyTraits, ValueTraits>::Size() {
+    uint64_t size = 0;
+    for (const auto& shard : shards_) {
+        ::curve::common::ReadLockGuard guard(shard->lock);
+        size += shard->index.size();
+    }
+    return size;
+}
+
+template <typename K, typename V, typename Hash, typename KeyTraits,
+          typename ValueTraits>
+std::shared_ptr<CacheMetrics>
+    ClockCache<K, V, Hash, KeyTraits, ValueTraits>::GetCacheMetrics() const {
+    return cacheMetrics_;
+}
+
+// CacheShardFactory creates the shards of ShardedCache, only LRUCache
+// supports the byte capacity.
+template <typename Shard>
+struct CacheShardFactory {
+    static Shard* New(uint64_t maxCount, uint64_t /*maxBytes*/,
+                      std::shared_ptr<CacheMetrics> cacheMetrics) {
+        return new Shard(maxCount, cacheMetrics);
+    }
+};
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits>
+struct CacheShardFactory<LRUCache<K, V, KeyTraits, ValueTraits>> {
+    static LRUCache<K, V, KeyTraits, ValueTraits>* New(
+        uint64_t maxCount, uint64_t maxBytes,
+        std::shared_ptr<CacheMetrics> cacheMetrics) {
+        return new LRUCache<K, V, KeyTraits, ValueTraits>(
+            maxCount, maxBytes, cacheMetrics);
+    }
+};
+
+// ShardedCache spreads the keys over independent caches by hash, each shard
+// has its own lock, so the operations on different shards never serialize.
+// |Shard| can be LRUCache or ARCCache (which needs a non zero |maxCount|),
+// |maxCount| and |maxBytes| are split evenly over the shards, and every
+// shard evicts on its own.
+template <typename K, typename V,
+    typename Shard = LRUCache<K, V>,
+    typename Hash = std::hash<K>>
+class ShardedCache : public LRUCacheInterface<K, V> {
+ public:
+    // all shards report to |cacheMetrics|
+    explicit ShardedCache(uint64_t maxCount,
+        uint32_t shardNum = 16,
+        std::shared_ptr<CacheMetrics> cacheMetrics = nullptr,
+        uint64_t maxBytes = 0);
+
+    // every shard reports to its own metrics "<shardMetricPrefix>_shard<i>"
+    ShardedCache(uint64_t maxCount,
+        uint32_t shardNum,
+        uint64_t maxBytes,
+        const std::string &shardMetricPrefix);
+
+    void Put(const K &key, const V &value) override {
+        GetShard(key)->Put(key, value);
+    }
+
+    bool Put(const K &key, const V &value, V *eliminated) override {
+        return GetShard(key)->Put(key, value, eliminated);
+    }
+
+    bool Get(const K &key, V *value) override {
+        return GetShard(key)->Get(key, value);
+    }
+
+    void Remove(const K &key) override {
+        GetShard(key)->Remove(key);
+    }
+
+    uint64_t Size() override;
+
+    std::shared_ptr<CacheMetrics> GetCacheMetrics() const {
+        return cacheMetrics_;
+    }
+
+    uint32_t GetShardNum() const {
+        return shards_.size();
+    }
+
+    std::shared_ptr<CacheMetrics> GetShardCacheMetrics(uint32_t index) const {
+        return shards_[index]->GetCacheMetrics();
+    }
+
+ private:
+    void Init(uint64_t maxCount, uint32_t shardNum, uint64_t maxBytes,
+              const std::string &shardMetricPrefix);
+
+    Shard* GetShard(const K &key) {
+        return shards_[hash_(key) % shards_.size()].get();
+    }
+
+ private:
+    Hash hash_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::shared_ptr<CacheMetrics> cacheMetrics_;
+};
+
+template <typename K, typename V, typename Shard, typename Hash>
+ShardedCache<K, V, Shard, Hash>::ShardedCache(
+    uint64_t maxCount, uint32_t shardNum,
+    std::shared_ptr<CacheMetrics> cacheMetrics, uint64_t maxBytes)
+    : hash_(),
+      shards_(),
+      cacheMetrics_(cacheMetrics) {
+    Init(maxCount, shardNum, maxBytes, "");
+}
+
+template <typename K, typename V, typename Shard, typename Hash>
+ShardedCache<K, V, Shard, Hash>::ShardedCache(
+    uint64_t maxCount, uint32_t shardNum, uint64_t maxBytes,
+    const std::string &shardMetricPrefix)
+    : hash_(),
+      shards_(),
+      cacheMetrics_(nullptr) {
+    Init(maxCount, shardNum, maxBytes, shardMetricPrefix);
+}
+
+template <typename K, typename V, typename Shard, typename Hash>
+void ShardedCache<K, V, Shard, Hash>::Init(
+    uint64_t maxCount, uint32_t shardNum, uint64_t maxBytes,
+    const std::string &shardMetricPrefix) {
+    shardNum = std::max(shardNum, 1u);
+    if (maxCount != 0) {
+        shardNum = std::min<uint64_t>(shardNum, maxCount);
+    }
+    uint64_t shardCount = (maxCount + shardNum - 1) / shardNum;
+    uint64_t shardBytes = (maxBytes + shardNum - 1) / shardNum;
+    for (uint32_t i = 0; i < shardNum; i++) {
+        std::shared_ptr<CacheMetrics> metrics = cacheMetrics_;
+        if (!shardMetricPrefix.empty()) {
+            metrics = std::make_shared<CacheMetrics>(
+                shardMetricPrefix + "_shard" + std::to_string(i));
+        }
+        shards_.emplace_back(
+            CacheShardFactory<Shard>::New(shardCount, shardBytes, metrics));
+    }
+}
+
+template <typename K, typename V, typename Shard, typename Hash>
+uint64_t ShardedCache<K, V, Shard, Hash>::Size() {
+    uint64_t size = 0;
+    for (const auto& shard : shards_) {
+        size += shard->Size();
+    }
+    return size;
+}
+
 }  // namespace common
 }  // namespace curve
 
@@ -36,6 +36,8 @@ const char INODESTOREKEY[] = "04";
 const char INODESTOREKEYEND[] = "05";
 const char CHUNKSTOREKEY[] = "05";
 const char CHUNKSTOREKEYEND[] = "06";
+// put by a new leader, whose standby warmer catches up till its revision
+const char STANDBYFENCEKEY[] = "06standbyfence";
 const char LEADERCAMPAIGNNPFX[] = "07leader";
 const char SEGMENTALLOCSIZEKEY[] = "08";
 const char SEGMENTALLOCSIZEKEYEND[] = "09";
@@ -67,6 +69,16 @@ const char DISCARDSEGMENTKEYEND[] = "14";
 const char BLOCKSIZEKEY[] = "15blocksize";
 const char CHUNKSIZEKEY[] = "15chunksize";
 
+// change log of segment alloc, folded into SEGMENTALLOCSIZEKEY periodically
+const char SEGMENTALLOCLOGKEYPREFIX[] = "16";
+const char SEGMENTALLOCLOGKEYEND[] = "17";
+// exists if SEGMENTALLOCSIZEKEY plus the change log is exact
+const char SEGMENTALLOCEXACTKEY[] = "17segmentallocexact";
+
+// references of the snapshot chunks to the deduplicated chunk data
+const char CHUNKDATAREFKEYPREFIX[] = "18";
+const char CHUNKDATAREFKEYEND[] = "19";
+
 // TODO(hzsunjianliang): if use single prefix for snapshot file?
 const int COMMON_PREFIX_LENGTH = 2;
 const int LEADER_PREFIX_LENGTH = 8;
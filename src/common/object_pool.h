@@ -0,0 +1,233 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_COMMON_OBJECT_POOL_H_
+#define SRC_COMMON_OBJECT_POOL_H_
+
+#include <stdlib.h>
+
+#include <cstddef>
+#include <mutex>  // NOLINT
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace curve {
+namespace common {
+
+/**
+ * Pool of the memory blocks of sizeof(T), for the objects allocated and
+ * freed once or more for every IO.
+ *
+ * Every thread caches two batches of free blocks. The IOs are usually
+ * allocated in one thread and freed in another one, e.g. the rpc
+ * callbacks, so the full batches are moved between threads through a
+ * global list, whose lock is taken once per kBatchSize blocks. The blocks
+ * are malloc'ed, those beyond the limit of the global list are freed.
+ */
+template <typename T>
+class ObjectPool {
+ public:
+    static const size_t kBatchSize = 64;
+    static const size_t kMaxGlobalBatches = 1024;
+
+    /**
+     * @brief Get a block of sizeof(T) aligned for T
+     * @return nullptr if out of memory
+     */
+    static void* Allocate() {
+        LocalCache& cache = Local();
+        if (cache.current.count == 0) {
+            if (cache.spare.count > 0) {
+                std::swap(cache.current, cache.spare);
+            } else {
+                GetGlobal()->Get(&cache.current);
+            }
+        }
+        if (cache.current.count > 0) {
+            return cache.current.Pop();
+        }
+        void* ptr = nullptr;
+        if (posix_memalign(&ptr, kAlign, sizeof(T)) != 0) {
+            return nullptr;
+        }
+        return ptr;
+    }
+
+    /**
+     * @brief Put back a block returned by Allocate
+     */
+    static void Deallocate(void* ptr) {
+        LocalCache& cache = Local();
+        if (cache.current.count == kBatchSize) {
+            if (cache.spare.count > 0) {
+                GetGlobal()->Put(&cache.spare);
+            }
+            std::swap(cache.current, cache.spare);
+        }
+        cache.current.Push(ptr);
+    }
+
+ private:
+    static const size_t kAlign =
+        alignof(T) > sizeof(void*) ? alignof(T) : sizeof(void*);
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Batch {
+        FreeBlock* head = nullptr;
+        size_t count = 0;
+
+        void Push(void* ptr) {
+            FreeBlock* block = static_cast<FreeBlock*>(ptr);
+            block->next = head;
+            head = block;
+            ++count;
+        }
+
+        void* Pop() {
+            FreeBlock* block = head;
+            head = block->next;
+            --count;
+            return block;
+        }
+
+        void Free() {
+            while (count > 0) {
+                free(Pop());
+            }
+        }
+    };
+
+    class GlobalList {
+     public:
+        void Get(Batch* batch) {
+            std::lock_guard<std::mutex> lk(mtx_);
+            if (!batches_.empty()) {
+                *batch = batches_.back();
+                batches_.pop_back();
+            }
+        }
+
+        void Put(Batch* batch) {
+            {
+                std::lock_guard<std::mutex> lk(mtx_);
+                if (batches_.size() < kMaxGlobalBatches) {
+                    batches_.push_back(*batch);
+                    *batch = Batch();
+                    return;
+                }
+            }
+            batch->Free();
+        }
+
+     private:
+        std::mutex mtx_;
+        std::vector<Batch> batches_;
+    };
+
+    struct LocalCache {
+        Batch current;
+        Batch spare;
+
+        // the blocks cached by an exiting thread go to the other threads
+        ~LocalCache() {
+            if (current.count > 0) {
+                GetGlobal()->Put(&current);
+            }
+            if (spare.count > 0) {
+                GetGlobal()->Put(&spare);
+            }
+        }
+    };
+
+    static LocalCache& Local() {
+        static thread_local LocalCache cache;
+        return cache;
+    }
+
+    // never destroyed, the threads may exit after the static destructors
+    static GlobalList* GetGlobal() {
+        static GlobalList* global = new GlobalList();
+        return global;
+    }
+};
+
+template <typename T>
+const size_t ObjectPool<T>::kBatchSize;
+template <typename T>
+const size_t ObjectPool<T>::kMaxGlobalBatches;
+template <typename T>
+const size_t ObjectPool<T>::kAlign;
+
+/**
+ * Inherited by class T to allocate its objects from ObjectPool<T>, the
+ * new and delete expressions stay the same. Every object is constructed
+ * from scratch, nothing is left over from the last use of the block.
+ * The derived classes of a different size, and the memory freed by
+ * the nothrow delete when a constructor throws, fall back to malloc/free.
+ */
+template <typename T>
+class PoolAllocated {
+ public:
+    static void* operator new(size_t size) {
+        void* ptr = Allocate(size);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+
+    static void* operator new(size_t size, const std::nothrow_t&) noexcept {
+        return Allocate(size);
+    }
+
+    static void operator delete(void* ptr, size_t size) {
+        if (ptr == nullptr) {
+            return;
+        }
+        if (size == sizeof(T)) {
+            ObjectPool<T>::Deallocate(ptr);
+        } else {
+            free(ptr);
+        }
+    }
+
+    static void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+        free(ptr);
+    }
+
+ private:
+    static void* Allocate(size_t size) {
+        if (size == sizeof(T)) {
+            return ObjectPool<T>::Allocate();
+        }
+        void* ptr = nullptr;
+        if (posix_memalign(&ptr, alignof(T) > sizeof(void*)
+                                     ? alignof(T) : sizeof(void*),
+                           size) != 0) {
+            return nullptr;
+        }
+        return ptr;
+    }
+};
+
+}  // namespace common
+}  // namespace curve
+
+#endif  // SRC_COMMON_OBJECT_POOL_H_
@@ -25,13 +25,17 @@
 #include <aws/core/utils/stream/PreallocatedStreamBuf.h>
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <memory>
 #include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "src/common/concurrent/count_down_event.h"
 #include "src/common/curve_define.h"
 #include "src/common/macros.h"
+#include "src/common/string_util.h"
 
 #define AWS_ALLOCATE_TAG __FILE__ ":" STRINGIFY(__LINE__)
 
@@ -112,6 +116,49 @@ void InitS3AdaptorOptionExceptS3InfoOption(Configuration* conf,
         LOG(WARNING) << "Not found s3.maxAsyncRequestInflightBytes in conf";
         s3Opt->maxAsyncRequestInflightBytes = 0;
     }
+    if (!conf->GetUInt32Value("s3.clientNum", &s3Opt->clientNum)) {
+        LOG(WARNING) << "Not found s3.clientNum in conf, use default "
+                     << s3Opt->clientNum;
+    }
+    if (!conf->GetBoolValue("s3.enableTcpKeepAlive",
+                            &s3Opt->enableTcpKeepAlive)) {
+        LOG(WARNING) << "Not found s3.enableTcpKeepAlive in conf, use default "
+                     << s3Opt->enableTcpKeepAlive;
+    }
+    if (!conf->GetUInt32Value("s3.tcpKeepAliveIntervalMs",
+                              &s3Opt->tcpKeepAliveIntervalMs)) {
+        LOG(WARNING) << "Not found s3.tcpKeepAliveIntervalMs in conf, "
+                        "use default "
+                     << s3Opt->tcpKeepAliveIntervalMs;
+    }
+    if (!conf->GetStringValue("s3.asyncEngine", &s3Opt->asyncEngine)) {
+        LOG(WARNING) << "Not found s3.asyncEngine in conf, use default "
+                     << s3Opt->asyncEngine;
+    }
+    if (!conf->GetUInt32Value("s3.parallelGet.maxParts",
+                              &s3Opt->parallelGetMaxParts)) {
+        LOG(WARNING) << "Not found s3.parallelGet.maxParts in conf, "
+                        "use default "
+                     << s3Opt->parallelGetMaxParts;
+    }
+    if (!conf->GetUInt64Value("s3.parallelGet.minPartBytes",
+                              &s3Opt->parallelGetMinPartBytes)) {
+        LOG(WARNING) << "Not found s3.parallelGet.minPartBytes in conf, "
+                        "use default "
+                     << s3Opt->parallelGetMinPartBytes;
+    }
+    if (!conf->GetUInt64Value("s3.parallelGet.maxPartBytes",
+                              &s3Opt->parallelGetMaxPartBytes)) {
+        LOG(WARNING) << "Not found s3.parallelGet.maxPartBytes in conf, "
+                        "use default "
+                     << s3Opt->parallelGetMaxPartBytes;
+    }
+    if (!conf->GetUInt32Value("s3.parallelGet.targetPartMs",
+                              &s3Opt->parallelGetTargetPartMs)) {
+        LOG(WARNING) << "Not found s3.parallelGet.targetPartMs in conf, "
+                        "use default "
+                     << s3Opt->parallelGetTargetPartMs;
+    }
 }
 
 void S3Adapter::Init(const std::string& path) {
@@ -147,25 +194,71 @@ void S3Adapter::Init(const S3AdapterOption &option) {
     s3Ak_ = option.ak.c_str();
     s3Sk_ = option.sk.c_str();
     bucketName_ = option.bucketName.c_str();
-    clientCfg_ = Aws::New<Aws::Client::ClientConfiguration>(AWS_ALLOCATE_TAG);
-    clientCfg_->scheme = Aws::Http::Scheme(option.scheme);
-    clientCfg_->verifySSL = option.verifySsl;
-    clientCfg_->userAgent = option.userAgent.c_str();
-    clientCfg_->region = option.region.c_str();
-    clientCfg_->maxConnections = option.maxConnections;
-    clientCfg_->connectTimeoutMs = option.connectTimeout;
-    clientCfg_->requestTimeoutMs = option.requestTimeout;
-    clientCfg_->endpointOverride = s3Address_;
-    auto asyncThreadNum = option.asyncThreadNum;
-    LOG(INFO) << "S3Adapter init thread num = " << asyncThreadNum << std::endl;
-    clientCfg_->executor =
-        Aws::MakeShared<Aws::Utils::Threading::PooledThreadExecutor>(
-            "S3Adapter.S3Client", asyncThreadNum);
-    s3Client_ = Aws::New<Aws::S3::S3Client>(AWS_ALLOCATE_TAG,
-            Aws::Auth::AWSCredentials(s3Ak_, s3Sk_),
-            *clientCfg_,
+
+    // 每个S3Client有各自的curl连接池和异步线程池,
+    // 多个client分摊请求, 避免单个连接池和线程池成为瓶颈
+    std::vector<std::string> endpoints;
+    SplitString(option.s3Address, ",", &endpoints);
+    if (endpoints.empty()) {
+        endpoints.emplace_back(option.s3Address);
+    }
+    uint32_t clientNum = std::max<uint32_t>(
+        std::max<uint32_t>(option.clientNum, 1), endpoints.size());
+    int maxConnections = std::max<int>(
+        (option.maxConnections + clientNum - 1) / clientNum, 1);
+    int asyncThreadNum = std::max<int>(
+        (option.asyncThreadNum + clientNum - 1) / clientNum, 1);
+    LOG(INFO) << "S3Adapter init client num = " << clientNum
+              << ", endpoint num = " << endpoints.size()
+              << ", thread num per client = " << asyncThreadNum
+              << ", max connections per client = " << maxConnections;
+    for (uint32_t i = 0; i < clientNum; i++) {
+        auto *clientCfg =
+            Aws::New<Aws::Client::ClientConfiguration>(AWS_ALLOCATE_TAG);
+        clientCfg->scheme = Aws::Http::Scheme(option.scheme);
+        clientCfg->verifySSL = option.verifySsl;
+        clientCfg->userAgent = option.userAgent.c_str();
+        clientCfg->region = option.region.c_str();
+        clientCfg->maxConnections = maxConnections;
+        clientCfg->connectTimeoutMs = option.connectTimeout;
+        clientCfg->requestTimeoutMs = option.requestTimeout;
+        clientCfg->enableTcpKeepAlive = option.enableTcpKeepAlive;
+        clientCfg->tcpKeepAliveIntervalMs = option.tcpKeepAliveIntervalMs;
+        clientCfg->endpointOverride =
+            endpoints[i % endpoints.size()].c_str();
+        clientCfg->executor =
+            Aws::MakeShared<Aws::Utils::Threading::PooledThreadExecutor>(
+                "S3Adapter.S3Client", asyncThreadNum);
+        clientCfgs_.push_back(clientCfg);
+        s3Clients_.push_back(Aws::New<Aws::S3::S3Client>(
+            AWS_ALLOCATE_TAG, Aws::Auth::AWSCredentials(s3Ak_, s3Sk_),
+            *clientCfg,
             Aws::Client::AWSAuthV4Signer::PayloadSigningPolicy::Never,
-            option.useVirtualAddressing);
+            option.useVirtualAddressing));
+    }
+
+    if (option.asyncEngine == "brpc") {
+        S3HttpEngineOption engineOpt;
+        engineOpt.endpoints = endpoints;
+        engineOpt.ak = option.ak;
+        engineOpt.sk = option.sk;
+        engineOpt.region = option.region;
+        engineOpt.bucket = option.bucketName;
+        engineOpt.https = option.scheme == static_cast<int>(
+                                               Aws::Http::Scheme::HTTPS);
+        engineOpt.useVirtualAddressing = option.useVirtualAddressing;
+        engineOpt.connectTimeoutMs = option.connectTimeout;
+        engineOpt.requestTimeoutMs = option.requestTimeout;
+        httpEngine_.reset(new S3HttpEngine());
+        if (!httpEngine_->Init(engineOpt)) {
+            LOG(ERROR) << "S3Adapter init brpc engine failed, "
+                          "use aws sdk instead";
+            httpEngine_.reset();
+        }
+    } else if (option.asyncEngine != "aws") {
+        LOG(WARNING) << "S3Adapter unknown async engine: "
+                     << option.asyncEngine << ", use aws sdk";
+    }
 
     ReadWriteThrottleParams params;
     params.iopsTotal.limit = option.iopsTotalLimit;
@@ -182,18 +275,29 @@ void S3Adapter::Init(const S3AdapterOption &option) {
         option.maxAsyncRequestInflightBytes == 0
             ? UINT64_MAX
             : option.maxAsyncRequestInflightBytes));
+
+    parallelGetMaxParts_ = option.parallelGetMaxParts;
+    parallelGetMinPartBytes_ = std::max<uint64_t>(
+        option.parallelGetMinPartBytes, 1);
+    parallelGetMaxPartBytes_ = std::max(option.parallelGetMaxPartBytes,
+                                        parallelGetMinPartBytes_);
+    parallelGetTargetPartMs_ = std::max<uint32_t>(
+        option.parallelGetTargetPartMs, 1);
+    parallelGetPartBytes_.store(parallelGetMinPartBytes_,
+                                std::memory_order_relaxed);
 }
 
 void S3Adapter::Deinit() {
     // delete s3client in s3adapter
-    if (clientCfg_ != nullptr) {
-        Aws::Delete<Aws::Client::ClientConfiguration>(clientCfg_);
-        clientCfg_ = nullptr;
+    for (auto *clientCfg : clientCfgs_) {
+        Aws::Delete<Aws::Client::ClientConfiguration>(clientCfg);
     }
-    if (s3Client_ != nullptr) {
-        Aws::Delete<Aws::S3::S3Client>(s3Client_);
-        s3Client_ = nullptr;
+    clientCfgs_.clear();
+    for (auto *s3Client : s3Clients_) {
+        Aws::Delete<Aws::S3::S3Client>(s3Client);
     }
+    s3Clients_.clear();
+    httpEngine_.reset();
     if (throttle_ != nullptr) {
         delete throttle_;
         throttle_ = nullptr;
@@ -234,7 +338,7 @@ int S3Adapter::CreateBucket() {
     conf.SetLocationConstraint(
             Aws::S3::Model::BucketLocationConstraint::us_east_1);
     request.SetCreateBucketConfiguration(conf);
-    auto response = s3Client_->CreateBucket(request);
+    auto response = GetS3Client()->CreateBucket(request);
     if (response.IsSuccess()) {
         return 0;
     } else {
@@ -250,7 +354,7 @@ int S3Adapter::CreateBucket() {
 int S3Adapter::DeleteBucket() {
     Aws::S3::Model::DeleteBucketRequest request;
     request.SetBucket(bucketName_);
-    auto response = s3Client_->DeleteBucket(request);
+    auto response = GetS3Client()->DeleteBucket(request);
     if (response.IsSuccess()) {
         return 0;
     } else {
@@ -266,7 +370,7 @@ int S3Adapter::DeleteBucket() {
 bool S3Adapter::BucketExist() {
     Aws::S3::Model::HeadBucketRequest request;
     request.SetBucket(bucketName_);
-    auto response = s3Client_->HeadBucket(request);
+    auto response = GetS3Client()->HeadBucket(request);
     if (response.IsSuccess()) {
         return true;
     } else {
@@ -292,7 +396,7 @@ int S3Adapter::PutObject(const Aws::String &key, const char *buffer,
         throttle_->Add(false, bufferSize);
     }
 
-    auto response = s3Client_->PutObject(request);
+    auto response = GetS3Client()->PutObject(request);
     if (response.IsSuccess()) {
         return 0;
     } else {
@@ -321,7 +425,7 @@ int S3Adapter::PutObject(const Aws::String &key, const std::string &data) {
                         bufferSize);
                 return stream.release();
             });
-        auto response = s3Client_->GetObject(request);
+        auto response = GetS3Client()->GetObject(request);
         if (response.IsSuccess()) {
             *buffer << response.GetResult().GetBody().rdbuf();
         } else {
@@ -334,6 +438,22 @@ int S3Adapter::PutObject(const Aws::String &key, const std::string &data) {
 */
 
 void S3Adapter::PutObjectAsync(std::shared_ptr<PutObjectAsyncContext> context) {
+    if (httpEngine_ != nullptr) {
+        if (throttle_) {
+            throttle_->Add(false, context->bufferSize);
+        }
+        inflightBytesThrottle_->OnStart(context->bufferSize);
+        httpEngine_->PutObjectAsync(
+            context->key, context->buffer, context->bufferSize,
+            [this, context](int retCode) {
+                inflightBytesThrottle_->OnComplete(context->bufferSize);
+                context->retCode = retCode;
+                context->timer.stop();
+                context->cb(context);
+            });
+        return;
+    }
+
     Aws::S3::Model::PutObjectRequest request;
     request.SetBucket(bucketName_);
     request.SetKey(Aws::String{context->key.c_str(), context->key.size()});
@@ -379,7 +499,7 @@ void S3Adapter::PutObjectAsync(std::shared_ptr<PutObjectAsyncContext> context) {
 
     inflightBytesThrottle_->OnStart(context->bufferSize);
     context->cb = std::move(wrapperCallback);
-    s3Client_->PutObjectAsync(request, handler, context);
+    GetS3Client()->PutObjectAsync(request, handler, context);
 }
 
 int S3Adapter::GetObject(const Aws::String &key,
@@ -391,7 +511,7 @@ int S3Adapter::GetObject(const Aws::String &key,
     if (throttle_) {
         throttle_->Add(true,  1);
     }
-    auto response = s3Client_->GetObject(request);
+    auto response = GetS3Client()->GetObject(request);
     if (response.IsSuccess()) {
         ss << response.GetResult().GetBody().rdbuf();
         *data = ss.str();
@@ -408,6 +528,10 @@ int S3Adapter::GetObject(const std::string &key,
                          char *buf,
                          off_t offset,
                          size_t len) {
+    if (parallelGetMaxParts_ > 1 && len >= 2 * parallelGetMinPartBytes_) {
+        return GetObjectInParts(key, buf, offset, len);
+    }
+
     Aws::S3::Model::GetObjectRequest request;
     request.SetBucket(bucketName_);
     request.SetKey(Aws::String{key.c_str(), key.size()});
@@ -420,7 +544,7 @@ int S3Adapter::GetObject(const std::string &key,
     if (throttle_) {
         throttle_->Add(true, len);
     }
-    auto response = s3Client_->GetObject(request);
+    auto response = GetS3Client()->GetObject(request);
     if (response.IsSuccess()) {
         return 0;
     } else {
@@ -431,7 +555,75 @@ int S3Adapter::GetObject(const std::string &key,
     }
 }
 
+int S3Adapter::GetObjectInParts(const std::string &key, char *buf,
+                                off_t offset, size_t len) {
+    uint64_t partBytes = parallelGetPartBytes_.load(std::memory_order_relaxed);
+    uint64_t partNum = std::min<uint64_t>((len + partBytes - 1) / partBytes,
+                                          parallelGetMaxParts_);
+    partNum = std::max<uint64_t>(partNum, 1);
+    partBytes = (len + partNum - 1) / partNum;
+
+    // 各分片经GetObjectAsync轮询分散到各个S3Client的连接上
+    CountDownEvent done(partNum);
+    std::atomic<uint32_t> failed{0};
+    butil::Timer timer(butil::Timer::STARTED);
+    for (uint64_t i = 0; i < partNum; i++) {
+        uint64_t partOff = i * partBytes;
+        size_t partLen = std::min<uint64_t>(partBytes, len - partOff);
+        auto context = std::make_shared<GetObjectAsyncContext>(
+            key, buf + partOff, offset + partOff, partLen,
+            [&done, &failed](const S3Adapter * /*adapter*/,
+                             const std::shared_ptr<GetObjectAsyncContext>
+                                 &ctx) {
+                if (ctx->retCode < 0) {
+                    failed.fetch_add(1, std::memory_order_relaxed);
+                }
+                done.Signal();
+            });
+        GetObjectAsync(context);
+    }
+    done.Wait();
+    timer.stop();
+
+    if (failed.load(std::memory_order_relaxed) > 0) {
+        LOG(ERROR) << "GetObject in parts error, key: " << key
+                   << ", offset: " << offset << ", len: " << len
+                   << ", failed parts: " << failed.load() << "/" << partNum;
+        return -1;
+    }
+    AdjustGetPartBytes(partBytes, timer.m_elapsed());
+    return 0;
+}
+
+void S3Adapter::AdjustGetPartBytes(uint64_t partBytes, int64_t elapsedMs) {
+    // 各分片并发读取, 单个分片的耗时约等于总耗时,
+    // 按实测吞吐换算出耗时为目标值的分片大小, 并与旧值平均以平滑抖动
+    uint64_t target = partBytes * parallelGetTargetPartMs_ /
+                      std::max<int64_t>(elapsedMs, 1);
+    target = std::min(std::max(target, parallelGetMinPartBytes_),
+                      parallelGetMaxPartBytes_);
+    uint64_t old = parallelGetPartBytes_.load(std::memory_order_relaxed);
+    parallelGetPartBytes_.store((old + target) / 2,
+                                std::memory_order_relaxed);
+}
+
 void S3Adapter::GetObjectAsync(std::shared_ptr<GetObjectAsyncContext> context) {
+    if (httpEngine_ != nullptr) {
+        if (throttle_) {
+            throttle_->Add(true, context->len);
+        }
+        inflightBytesThrottle_->OnStart(context->len);
+        httpEngine_->GetObjectAsync(
+            context->key, context->buf, context->offset, context->len,
+            [this, context](int retCode, size_t actualLen) {
+                inflightBytesThrottle_->OnComplete(context->len);
+                context->actualLen = actualLen;
+                context->retCode = retCode;
+                context->cb(this, context);
+            });
+        return;
+    }
+
     Aws::S3::Model::GetObjectRequest request;
     request.SetBucket(bucketName_);
     request.SetKey(Aws::String{context->key.c_str(), context->key.size()});
@@ -478,14 +670,14 @@ void S3Adapter::GetObjectAsync(std::shared_ptr<GetObjectAsyncContext> context) {
 
     inflightBytesThrottle_->OnStart(context->len);
     context->cb = std::move(wrapperCallback);
-    s3Client_->GetObjectAsync(request, handler, context);
+    GetS3Client()->GetObjectAsync(request, handler, context);
 }
 
 bool S3Adapter::ObjectExist(const Aws::String &key) {
     Aws::S3::Model::HeadObjectRequest request;
     request.SetBucket(bucketName_);
     request.SetKey(key);
-    auto response = s3Client_->HeadObject(request);
+    auto response = GetS3Client()->HeadObject(request);
     if (response.IsSuccess()) {
         return true;
     } else {
@@ -500,7 +692,7 @@ int S3Adapter::DeleteObject(const Aws::String &key) {
     Aws::S3::Model::DeleteObjectRequest request;
     request.SetBucket(bucketName_);
     request.SetKey(key);
-    auto response = s3Client_->DeleteObject(request);
+    auto response = GetS3Client()->DeleteObject(request);
     if (response.IsSuccess()) {
         return 0;
     } else {
@@ -522,7 +714,7 @@ int S3Adapter::DeleteObjects(const std::list<Aws::String>& keyList) {
 
     deleteObjects.SetQuiet(false);
     deleteObjectsRequest.WithBucket(bucketName_).WithDelete(deleteObjects);
-    auto response = s3Client_->DeleteObjects(deleteObjectsRequest);
+    auto response = GetS3Client()->DeleteObjects(deleteObjectsRequest);
     if (response.IsSuccess()) {
         for (auto del : response.GetResult().GetDeleted()) {
             LOG(INFO) << "delete ok : " << del.GetKey();
@@ -556,7 +748,7 @@ int S3Adapter::UpdateObjectMeta(const Aws::String &key,
         Aws::MakeShared<Aws::StringStream>("PutObjectInputStream");
     request.SetBody(input_data);
     request.SetMetadata(meta);
-    auto response = s3Client_->PutObject(request);
+    auto response = GetS3Client()->PutObject(request);
     if (response.IsSuccess()) {
         return 0;
     } else {
@@ -573,7 +765,7 @@ int S3Adapter::GetObjectMeta(const Aws::String &key,
     Aws::S3::Model::HeadObjectRequest request;
     request.SetBucket(bucketName_);
     request.SetKey(key);
-    auto response = s3Client_->HeadObject(request);
+    auto response = GetS3Client()->HeadObject(request);
     if (response.IsSuccess()) {
         *meta = response.GetResult().GetMetadata();
         return 0;
@@ -589,7 +781,7 @@ int S3Adapter::GetObjectMeta(const Aws::String &key,
 Aws::String S3Adapter::MultiUploadInit(const Aws::String &key) {
     Aws::S3::Model::CreateMultipartUploadRequest request;
     request.WithBucket(bucketName_).WithKey(key);
-    auto response = s3Client_->CreateMultipartUpload(request);
+    auto response = GetS3Client()->CreateMultipartUpload(request);
     if (response.IsSuccess()) {
         return response.GetResult().GetUploadId();
     } else {
@@ -618,7 +810,7 @@ Aws::S3::Model::CompletedPart S3Adapter::UploadOnePart(
     if (throttle_) {
         throttle_->Add(false, partSize);
     }
-    auto result = s3Client_->UploadPart(request);
+    auto result = GetS3Client()->UploadPart(request);
     if (result.IsSuccess()) {
         return Aws::S3::Model::CompletedPart()
             .WithETag(result.GetResult().GetETag()).WithPartNumber(partNum);
@@ -637,7 +829,7 @@ int S3Adapter::CompleteMultiUpload(const Aws::String &key,
     request.SetUploadId(uploadId);
     request.SetMultipartUpload(
         Aws::S3::Model::CompletedMultipartUpload().WithParts(cp_v));
-    auto response = s3Client_->CompleteMultipartUpload(request);
+    auto response = GetS3Client()->CompleteMultipartUpload(request);
     if (response.IsSuccess()) {
         return 0;
     } else {
@@ -654,7 +846,7 @@ int S3Adapter::AbortMultiUpload(const Aws::String &key,
     request.WithBucket(bucketName_);
     request.SetKey(key);
     request.SetUploadId(uploadId);
-    auto response = s3Client_->AbortMultipartUpload(request);
+    auto response = GetS3Client()->AbortMultipartUpload(request);
     if (response.IsSuccess()) {
         return 0;
     } else {
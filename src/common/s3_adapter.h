@@ -50,6 +50,7 @@
 #include <aws/s3/model/PutObjectRequest.h>                //NOLINT
 #include <aws/s3/model/UploadPartRequest.h>               //NOLINT
 
+#include <atomic>
 #include <condition_variable>
 #include <cstdint>
 #include <list>
@@ -58,8 +59,10 @@
 #include <mutex>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "src/common/configuration.h"
+#include "src/common/s3_http_engine.h"
 #include "src/common/throttle.h"
 
 namespace curve {
@@ -92,6 +95,23 @@ struct S3AdapterOption {
     uint64_t bpsReadMB;
     uint64_t bpsWriteMB;
     bool useVirtualAddressing;
+    // s3Address可以是逗号分隔的多个endpoint(如多个网关)
+    // 创建max(clientNum, endpoint数)个S3Client轮询使用,
+    // 每个S3Client有各自的连接池和异步线程池,
+    // maxConnections和asyncThreadNum在各client间均分
+    uint32_t clientNum = 1;
+    // 空闲连接保持tcp keep-alive, 以复用连接
+    bool enableTcpKeepAlive = true;
+    uint32_t tcpKeepAliveIntervalMs = 30000;
+    // 数据面异步读写使用的引擎, "aws": aws sdk, "brpc": S3HttpEngine
+    std::string asyncEngine = "aws";
+    // 大的同步范围读拆成至多parallelGetMaxParts个分片, 经多个连接并发读取,
+    // 分片大小按实测吞吐在[min, max]PartBytes间调整,
+    // 使单个分片耗时约为parallelGetTargetPartMs, |0|表示不拆分
+    uint32_t parallelGetMaxParts = 0;
+    uint64_t parallelGetMinPartBytes = 4 * 1024 * 1024;
+    uint64_t parallelGetMaxPartBytes = 64 * 1024 * 1024;
+    uint32_t parallelGetTargetPartMs = 500;
 };
 
 struct S3InfoOption {
@@ -179,8 +199,6 @@ struct PutObjectAsyncContext : public Aws::Client::AsyncCallerContext {
 class S3Adapter {
  public:
     S3Adapter() {
-        clientCfg_ = nullptr;
-        s3Client_ = nullptr;
         throttle_ = nullptr;
     }
     virtual ~S3Adapter() { Deinit(); }
@@ -352,7 +370,9 @@ class S3Adapter {
     void SetBucketName(const Aws::String &name) { bucketName_ = name; }
     Aws::String GetBucketName() { return bucketName_; }
 
-    Aws::Client::ClientConfiguration *GetConfig() { return clientCfg_; }
+    Aws::Client::ClientConfiguration *GetConfig() {
+        return clientCfgs_.empty() ? nullptr : clientCfgs_[0];
+    }
 
  private:
     class AsyncRequestInflightBytesThrottle {
@@ -373,6 +393,19 @@ class S3Adapter {
     };
 
  private:
+    // 把[offset, offset + len)拆成多个分片异步读取, 全部完成后返回
+    int GetObjectInParts(const std::string &key, char *buf, off_t offset,
+                         size_t len);
+
+    // 根据本次分片读取的耗时调整下次的分片大小
+    void AdjustGetPartBytes(uint64_t partBytes, int64_t elapsedMs);
+
+    // 轮询选取一个S3Client
+    Aws::S3::S3Client *GetS3Client() {
+        return s3Clients_[nextClient_.fetch_add(1, std::memory_order_relaxed) %
+                          s3Clients_.size()];
+    }
+
     // S3服务器地址
     Aws::String s3Address_;
     // 用于用户认证的AK/SK，需要从对象存储的用户管理中申请
@@ -380,9 +413,18 @@ class S3Adapter {
     Aws::String s3Sk_;
     // 对象的桶名
     Aws::String bucketName_;
-    // aws sdk的配置
-    Aws::Client::ClientConfiguration *clientCfg_;
-    Aws::S3::S3Client *s3Client_;
+    // aws sdk的配置, 与s3Clients_一一对应
+    std::vector<Aws::Client::ClientConfiguration *> clientCfgs_;
+    std::vector<Aws::S3::S3Client *> s3Clients_;
+    std::atomic<uint64_t> nextClient_{0};
+    // 不为空时GetObjectAsync/PutObjectAsync由它发送
+    std::unique_ptr<S3HttpEngine> httpEngine_;
+    // 分片并发读的参数
+    uint32_t parallelGetMaxParts_{0};
+    uint64_t parallelGetMinPartBytes_{0};
+    uint64_t parallelGetMaxPartBytes_{0};
+    uint32_t parallelGetTargetPartMs_{0};
+    std::atomic<uint64_t> parallelGetPartBytes_{0};
     Configuration conf_;
 
     Throttle *throttle_;
@@ -0,0 +1,287 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/common/s3_http_engine.h"
+
+#include <brpc/controller.h>
+#include <glog/logging.h>
+#include <openssl/hmac.h>
+#include <openssl/sha.h>
+
+#include <cctype>
+#include <utility>
+
+namespace curve {
+namespace common {
+
+namespace {
+
+const char kUnsignedPayload[] = "UNSIGNED-PAYLOAD";
+
+std::string ToHex(const unsigned char *data, size_t len) {
+    static const char digits[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(len * 2);
+    for (size_t i = 0; i < len; i++) {
+        out.push_back(digits[data[i] >> 4]);
+        out.push_back(digits[data[i] & 0xf]);
+    }
+    return out;
+}
+
+std::string HmacSha256(const std::string &key, const std::string &data) {
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    unsigned int len = 0;
+    HMAC(EVP_sha256(), key.data(), static_cast<int>(key.size()),
+         reinterpret_cast<const unsigned char *>(data.data()), data.size(),
+         digest, &len);
+    return std::string(reinterpret_cast<char *>(digest), len);
+}
+
+// request attachments refer to the caller's buffers, which are released
+// by the caller when the request is done
+void NoopDeleter(void * /*data*/) {}
+
+// strip the scheme of endpoint, e.g. http://127.0.0.1:9000
+std::string EndpointHost(const std::string &endpoint) {
+    auto pos = endpoint.find("://");
+    return pos == std::string::npos ? endpoint : endpoint.substr(pos + 3);
+}
+
+void HandlePutResponse(brpc::Controller *cntl, S3HttpEngine::PutDone *done) {
+    std::unique_ptr<brpc::Controller> cntlGuard(cntl);
+    std::unique_ptr<S3HttpEngine::PutDone> doneGuard(done);
+    LOG_IF(ERROR, cntl->Failed())
+        << "PutObjectAsync error, uri: " << cntl->http_request().uri()
+        << ", status: " << cntl->http_response().status_code()
+        << ", error: " << cntl->ErrorText();
+    (*done)(cntl->Failed() ? -1 : 0);
+}
+
+void HandleGetResponse(brpc::Controller *cntl, char *buf, size_t len,
+                       S3HttpEngine::GetDone *done) {
+    std::unique_ptr<brpc::Controller> cntlGuard(cntl);
+    std::unique_ptr<S3HttpEngine::GetDone> doneGuard(done);
+    if (cntl->Failed()) {
+        LOG(ERROR) << "GetObjectAsync error, uri: "
+                   << cntl->http_request().uri()
+                   << ", status: " << cntl->http_response().status_code()
+                   << ", error: " << cntl->ErrorText();
+        (*done)(-1, 0);
+        return;
+    }
+    size_t actualLen = cntl->response_attachment().copy_to(buf, len);
+    (*done)(0, actualLen);
+}
+
+}  // namespace
+
+S3SignerV4::S3SignerV4(std::string ak, std::string sk, std::string region,
+                       std::string service)
+    : ak_(std::move(ak)),
+      sk_(std::move(sk)),
+      region_(std::move(region)),
+      service_(std::move(service)) {}
+
+std::string S3SignerV4::AmzDate(time_t t) {
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    char buf[32];
+    strftime(buf, sizeof(buf), "%Y%m%dT%H%M%SZ", &tm);
+    return buf;
+}
+
+std::string S3SignerV4::UriEncode(const std::string &in, bool encodeSlash) {
+    static const char digits[] = "0123456789ABCDEF";
+    std::string out;
+    out.reserve(in.size());
+    for (unsigned char c : in) {
+        if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~' ||
+            (c == '/' && !encodeSlash)) {
+            out.push_back(c);
+        } else {
+            out.push_back('%');
+            out.push_back(digits[c >> 4]);
+            out.push_back(digits[c & 0xf]);
+        }
+    }
+    return out;
+}
+
+std::string S3SignerV4::Sha256Hex(const std::string &data) {
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    SHA256(reinterpret_cast<const unsigned char *>(data.data()), data.size(),
+           digest);
+    return ToHex(digest, sizeof(digest));
+}
+
+std::string S3SignerV4::SigningKey(const std::string &date) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (keyDate_ != date) {
+        std::string key = HmacSha256("AWS4" + sk_, date);
+        key = HmacSha256(key, region_);
+        key = HmacSha256(key, service_);
+        signingKey_ = HmacSha256(key, "aws4_request");
+        keyDate_ = date;
+    }
+    return signingKey_;
+}
+
+std::string S3SignerV4::Authorization(
+    const std::string &method, const std::string &uri,
+    const std::string &query,
+    const std::map<std::string, std::string> &headers) {
+    std::string canonicalHeaders;
+    std::string signedHeaders;
+    for (const auto &header : headers) {
+        canonicalHeaders.append(header.first)
+            .append(":")
+            .append(header.second)
+            .append("\n");
+        if (!signedHeaders.empty()) {
+            signedHeaders.append(";");
+        }
+        signedHeaders.append(header.first);
+    }
+
+    auto it = headers.find("x-amz-content-sha256");
+    const std::string payloadHash =
+        it == headers.end() ? kUnsignedPayload : it->second;
+    std::string canonicalRequest;
+    canonicalRequest.append(method).append("\n")
+        .append(uri).append("\n")
+        .append(query).append("\n")
+        .append(canonicalHeaders).append("\n")
+        .append(signedHeaders).append("\n")
+        .append(payloadHash);
+
+    it = headers.find("x-amz-date");
+    const std::string amzDate = it == headers.end() ? "" : it->second;
+    const std::string date = amzDate.substr(0, 8);
+    const std::string scope =
+        date + "/" + region_ + "/" + service_ + "/aws4_request";
+    const std::string stringToSign = "AWS4-HMAC-SHA256\n" + amzDate + "\n" +
+                                     scope + "\n" +
+                                     Sha256Hex(canonicalRequest);
+    const std::string signature = HmacSha256(SigningKey(date), stringToSign);
+    return "AWS4-HMAC-SHA256 Credential=" + ak_ + "/" + scope +
+           ",SignedHeaders=" + signedHeaders + ",Signature=" +
+           ToHex(reinterpret_cast<const unsigned char *>(signature.data()),
+                 signature.size());
+}
+
+bool S3HttpEngine::Init(const S3HttpEngineOption &option) {
+    option_ = option;
+    signer_.reset(new S3SignerV4(option.ak, option.sk, option.region));
+
+    brpc::ChannelOptions channelOpt;
+    channelOpt.protocol = brpc::PROTOCOL_HTTP;
+    channelOpt.connection_type = brpc::CONNECTION_TYPE_POOLED;
+    channelOpt.connect_timeout_ms = option.connectTimeoutMs;
+    channelOpt.timeout_ms = option.requestTimeoutMs;
+    // the callers retry the failed requests by themselves
+    channelOpt.max_retry = 0;
+
+    endpoints_.clear();
+    for (const auto &endpoint : option.endpoints) {
+        Endpoint ep;
+        ep.host = EndpointHost(endpoint);
+        if (option.useVirtualAddressing) {
+            ep.host = option.bucket + "." + ep.host;
+        }
+        ep.channel.reset(new brpc::Channel());
+        std::string addr = (option.https ? "https://" : "http://") + ep.host;
+        if (ep.channel->Init(addr.c_str(), &channelOpt) != 0) {
+            LOG(ERROR) << "S3HttpEngine init channel to " << addr
+                       << " failed";
+            return false;
+        }
+        endpoints_.emplace_back(std::move(ep));
+    }
+    if (endpoints_.empty()) {
+        LOG(ERROR) << "S3HttpEngine has no endpoint";
+        return false;
+    }
+    LOG(INFO) << "S3HttpEngine init success, endpoint num: "
+              << endpoints_.size();
+    return true;
+}
+
+std::string S3HttpEngine::ObjectPath(const std::string &key) const {
+    std::string path = "/";
+    if (!option_.useVirtualAddressing) {
+        path.append(option_.bucket).append("/");
+    }
+    return path.append(S3SignerV4::UriEncode(key, false));
+}
+
+void S3HttpEngine::SignRequest(brpc::Controller *cntl,
+                               const std::string &method,
+                               const std::string &host,
+                               const std::string &path) {
+    std::map<std::string, std::string> headers{
+        {"host", host},
+        {"x-amz-content-sha256", kUnsignedPayload},
+        {"x-amz-date", S3SignerV4::AmzDate(time(nullptr))},
+    };
+    auto &request = cntl->http_request();
+    for (const auto &header : headers) {
+        request.SetHeader(header.first, header.second);
+    }
+    request.SetHeader("Authorization",
+                      signer_->Authorization(method, path, "", headers));
+}
+
+void S3HttpEngine::PutObjectAsync(const std::string &key, const char *buf,
+                                  size_t len, PutDone done) {
+    Endpoint *ep = PickEndpoint();
+    std::string path = ObjectPath(key);
+
+    auto *cntl = new brpc::Controller();
+    cntl->http_request().set_method(brpc::HTTP_METHOD_PUT);
+    cntl->http_request().uri() = path;
+    cntl->http_request().set_content_type("application/octet-stream");
+    cntl->request_attachment().append_user_data(const_cast<char *>(buf), len,
+                                                NoopDeleter);
+    SignRequest(cntl, "PUT", ep->host, path);
+
+    ep->channel->CallMethod(
+        nullptr, cntl, nullptr, nullptr,
+        brpc::NewCallback(&HandlePutResponse, cntl,
+                          new PutDone(std::move(done))));
+}
+
+void S3HttpEngine::GetObjectAsync(const std::string &key, char *buf,
+                                  off_t offset, size_t len, GetDone done) {
+    Endpoint *ep = PickEndpoint();
+    std::string path = ObjectPath(key);
+
+    auto *cntl = new brpc::Controller();
+    cntl->http_request().set_method(brpc::HTTP_METHOD_GET);
+    cntl->http_request().uri() = path;
+    cntl->http_request().SetHeader(
+        "Range", "bytes=" + std::to_string(offset) + "-" +
+                     std::to_string(offset + len - 1));
+    SignRequest(cntl, "GET", ep->host, path);
+
+    ep->channel->CallMethod(
+        nullptr, cntl, nullptr, nullptr,
+        brpc::NewCallback(&HandleGetResponse, cntl, buf, len,
+                          new GetDone(std::move(done))));
+}
+
+}  // namespace common
+}  // namespace curve
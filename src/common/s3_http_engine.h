@@ -0,0 +1,144 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_COMMON_S3_HTTP_ENGINE_H_
+#define SRC_COMMON_S3_HTTP_ENGINE_H_
+
+#include <brpc/channel.h>
+#include <sys/types.h>
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace curve {
+namespace common {
+
+/**
+ * AWS signature version 4 of s3 requests, the payload is not signed
+ * (UNSIGNED-PAYLOAD) like the aws sdk client created by S3Adapter.
+ */
+class S3SignerV4 {
+ public:
+    S3SignerV4(std::string ak, std::string sk, std::string region,
+               std::string service = "s3");
+
+    /**
+     * @brief Get the value of Authorization header
+     *
+     * @param method http method, e.g. GET
+     * @param uri uri encoded path
+     * @param query canonical query string, empty if no query
+     * @param headers headers to sign with lower case names, which should
+     *        have host, x-amz-date and x-amz-content-sha256
+     */
+    std::string Authorization(
+        const std::string &method, const std::string &uri,
+        const std::string &query,
+        const std::map<std::string, std::string> &headers);
+
+    // format time as "yyyymmddThhmmssZ"
+    static std::string AmzDate(time_t t);
+
+    // uri encode as s3 required, the '/' is kept if !encodeSlash
+    static std::string UriEncode(const std::string &in, bool encodeSlash);
+
+    static std::string Sha256Hex(const std::string &data);
+
+ private:
+    // the signing key only changes by date, so cache it
+    std::string SigningKey(const std::string &date);
+
+ private:
+    const std::string ak_;
+    const std::string sk_;
+    const std::string region_;
+    const std::string service_;
+
+    std::mutex mtx_;
+    std::string keyDate_;
+    std::string signingKey_;
+};
+
+struct S3HttpEngineOption {
+    std::vector<std::string> endpoints;
+    std::string ak;
+    std::string sk;
+    std::string region;
+    std::string bucket;
+    bool https = false;
+    bool useVirtualAddressing = false;
+    int connectTimeoutMs = 60000;
+    int requestTimeoutMs = 10000;
+};
+
+/**
+ * A lightweight s3 client for the data plane, it sends the object reads
+ * and writes by brpc http channels instead of the aws sdk, so a request
+ * costs no sdk request objects, streams and executor thread hops.
+ * The writes are sent from the caller's buffers without copies.
+ */
+class S3HttpEngine {
+ public:
+    using PutDone = std::function<void(int retCode)>;
+    using GetDone = std::function<void(int retCode, size_t actualLen)>;
+
+    S3HttpEngine() = default;
+
+    bool Init(const S3HttpEngineOption &option);
+
+    // |buf| should be valid until |done| is called
+    void PutObjectAsync(const std::string &key, const char *buf, size_t len,
+                        PutDone done);
+
+    // read [offset, offset + len) of the object into |buf|
+    void GetObjectAsync(const std::string &key, char *buf, off_t offset,
+                        size_t len, GetDone done);
+
+ private:
+    struct Endpoint {
+        std::string host;
+        std::unique_ptr<brpc::Channel> channel;
+    };
+
+    Endpoint *PickEndpoint() {
+        return &endpoints_[next_.fetch_add(1, std::memory_order_relaxed) %
+                           endpoints_.size()];
+    }
+
+    // the path of object, path style is "/bucket/key"
+    std::string ObjectPath(const std::string &key) const;
+
+    void SignRequest(brpc::Controller *cntl, const std::string &method,
+                     const std::string &host, const std::string &path);
+
+ private:
+    S3HttpEngineOption option_;
+    std::vector<Endpoint> endpoints_;
+    std::atomic<uint64_t> next_{0};
+    std::unique_ptr<S3SignerV4> signer_;
+};
+
+}  // namespace common
+}  // namespace curve
+
+#endif  // SRC_COMMON_S3_HTTP_ENGINE_H_
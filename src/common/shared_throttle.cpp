@@ -0,0 +1,219 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/common/shared_throttle.h"
+
+#include <bthread/bthread.h>
+#include <fcntl.h>
+#include <glog/logging.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace curve {
+namespace common {
+
+namespace {
+
+const uint32_t kSegmentVersion = 1;
+const uint64_t kNsPerSec = 1000000000ULL;
+
+enum BucketIndex {
+    kIopsTotal = 0,
+    kIopsRead,
+    kIopsWrite,
+    kBpsTotal,
+    kBpsRead,
+    kBpsWrite,
+    kBucketNum,
+};
+
+int64_t NowNs() {
+    // CLOCK_MONOTONIC is the same for all processes on one host
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * kNsPerSec + ts.tv_nsec;
+}
+
+uint64_t TokensToNs(uint64_t tokens, uint64_t limit) {
+    return static_cast<uint64_t>(
+        static_cast<unsigned __int128>(tokens) * kNsPerSec / limit);
+}
+
+uint64_t CalcTokens(bool isRead, uint64_t length, int index) {
+    if ((isRead && (index == kIopsWrite || index == kBpsWrite)) ||
+        (!isRead && (index == kIopsRead || index == kBpsRead))) {
+        return 0;
+    }
+    return index < kBpsTotal ? 1 : length;
+}
+
+std::string SegmentName(const std::string& name) {
+    std::string shmName = "/curve_throttle_";
+    for (char c : name) {
+        shmName.push_back(isalnum(static_cast<unsigned char>(c)) ? c : '_');
+    }
+    return shmName;
+}
+
+}  // namespace
+
+struct SharedThrottle::Bucket {
+    // tokens per second, 0 means no limit
+    std::atomic<uint64_t> limit;
+    // the burst credits, in the time to take them at |limit|
+    std::atomic<int64_t> creditNs;
+    // theoretical arrival time of the next request
+    std::atomic<int64_t> tat;
+    // one bucket per cache line, the buckets are updated independently
+    char padding[64 - 3 * sizeof(uint64_t)];
+};
+
+struct SharedThrottle::Segment {
+    std::atomic<uint32_t> version;
+    Bucket buckets[kBucketNum];
+};
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_LONG_LOCK_FREE == 2,
+              "the atomics in shared memory must be lock free");
+
+std::shared_ptr<SharedThrottle> SharedThrottle::Open(const std::string& name) {
+    static std::mutex mtx;
+    static std::map<std::string, std::weak_ptr<SharedThrottle>> opened;
+
+    std::lock_guard<std::mutex> lk(mtx);
+    auto throttle = opened[name].lock();
+    if (throttle != nullptr) {
+        return throttle;
+    }
+
+    // a new segment is filled with zero, which is a valid unlimited state,
+    // so the processes opening it concurrently need no initialization
+    const std::string shmName = SegmentName(name);
+    int fd = shm_open(shmName.c_str(), O_CREAT | O_RDWR, 0666);
+    if (fd < 0) {
+        PLOG(ERROR) << "shm_open " << shmName << " failed";
+        return nullptr;
+    }
+    // let the processes of other users share it
+    (void)fchmod(fd, 0666);
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        (st.st_size < static_cast<off_t>(sizeof(Segment)) &&
+         ftruncate(fd, sizeof(Segment)) != 0)) {
+        PLOG(ERROR) << "resize shared memory " << shmName << " failed";
+        close(fd);
+        return nullptr;
+    }
+    void* addr = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        PLOG(ERROR) << "mmap shared memory " << shmName << " failed";
+        return nullptr;
+    }
+
+    auto* segment = static_cast<Segment*>(addr);
+    uint32_t version = 0;
+    if (!segment->version.compare_exchange_strong(version, kSegmentVersion) &&
+        version != kSegmentVersion) {
+        LOG(ERROR) << "shared throttle " << shmName << " version mismatch, "
+                   << "expect " << kSegmentVersion << ", actual " << version;
+        munmap(addr, sizeof(Segment));
+        return nullptr;
+    }
+
+    LOG(INFO) << "open shared throttle " << shmName << " success";
+    throttle.reset(new SharedThrottle(name, segment));
+    opened[name] = throttle;
+    return throttle;
+}
+
+SharedThrottle::SharedThrottle(std::string name, Segment* segment)
+    : name_(std::move(name)), segment_(segment) {}
+
+SharedThrottle::~SharedThrottle() {
+    munmap(segment_, sizeof(Segment));
+}
+
+void SharedThrottle::UpdateThrottleParams(
+    const ReadWriteThrottleParams& params) {
+    const ThrottleParams* all[kBucketNum] = {
+        &params.iopsTotal, &params.iopsRead, &params.iopsWrite,
+        &params.bpsTotal,  &params.bpsRead,  &params.bpsWrite};
+    for (int i = 0; i < kBucketNum; i++) {
+        const ThrottleParams& p = *all[i];
+        Bucket* bucket = &segment_->buckets[i];
+        int64_t creditNs = 0;
+        if (p.limit != 0 && p.burst > p.limit) {
+            creditNs = TokensToNs((p.burst - p.limit) * p.burstSeconds,
+                                  p.limit);
+        }
+        bucket->creditNs.store(creditNs, std::memory_order_relaxed);
+        bucket->limit.store(p.limit, std::memory_order_relaxed);
+    }
+    LOG(INFO) << "update shared throttle " << name_
+              << ", iops total: " << params.iopsTotal
+              << ", bps total: " << params.bpsTotal;
+}
+
+uint64_t SharedThrottle::AcquireBucket(Bucket* bucket, uint64_t tokens,
+                                       int64_t nowNs) {
+    uint64_t limit = bucket->limit.load(std::memory_order_relaxed);
+    if (limit == 0 || tokens == 0) {
+        return 0;
+    }
+
+    const int64_t costNs = TokensToNs(tokens, limit);
+    const int64_t creditNs = bucket->creditNs.load(std::memory_order_relaxed);
+    int64_t tat = bucket->tat.load(std::memory_order_relaxed);
+    int64_t start;
+    do {
+        // the idle time before now earns at most |creditNs| of credits
+        start = std::max(tat, nowNs - creditNs);
+    } while (!bucket->tat.compare_exchange_weak(
+        tat, start + costNs, std::memory_order_relaxed));
+
+    return start > nowNs ? (start - nowNs) / 1000 : 0;
+}
+
+uint64_t SharedThrottle::Acquire(bool isRead, uint64_t length) {
+    const int64_t nowNs = NowNs();
+    uint64_t waitUs = 0;
+    for (int i = 0; i < kBucketNum; i++) {
+        waitUs = std::max(
+            waitUs, AcquireBucket(&segment_->buckets[i],
+                                  CalcTokens(isRead, length, i), nowNs));
+    }
+    return waitUs;
+}
+
+void SharedThrottle::Add(bool isRead, uint64_t length) {
+    uint64_t waitUs = Acquire(isRead, length);
+    if (waitUs > 0) {
+        bthread_usleep(waitUs);
+    }
+}
+
+}  // namespace common
+}  // namespace curve
@@ -0,0 +1,88 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_COMMON_SHARED_THROTTLE_H_
+#define SRC_COMMON_SHARED_THROTTLE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "src/common/throttle.h"
+
+namespace curve {
+namespace common {
+
+/**
+ * A throttle whose state lives in a POSIX shared memory segment, so all
+ * the processes on a host which open the same name, e.g. nebd-servers
+ * and libcurve instances, share one limit. It's the upper levels of the
+ * hierarchy tenant -> host -> volume, see Throttle::AddParent.
+ *
+ * Every bucket is a GCRA (generic cell rate algorithm) limiter of one
+ * atomic "theoretical arrival time", a request takes one CAS in the fast
+ * path and never takes a lock which may be held by a dead process. The
+ * idle time accumulates burst credits up to (burst - limit) * burstSeconds
+ * tokens.
+ */
+class SharedThrottle {
+ public:
+    /**
+     * @brief Open the shared throttle of |name|, the throttles of the same
+     *        name in one process share one mapping
+     * @return nullptr if failed
+     */
+    static std::shared_ptr<SharedThrottle> Open(const std::string& name);
+
+    ~SharedThrottle();
+
+    /**
+     * @brief Take the tokens of the request, and sleep if it exceeds the
+     *        limits
+     */
+    void Add(bool isRead, uint64_t length);
+
+    /**
+     * @brief Update the limits shared by all processes, the last update
+     *        wins. A |0| limit means no limit.
+     */
+    void UpdateThrottleParams(const ReadWriteThrottleParams& params);
+
+    /**
+     * @brief Take the tokens and return the time in microseconds to wait
+     *        before sending the request
+     */
+    uint64_t Acquire(bool isRead, uint64_t length);
+
+ private:
+    struct Bucket;
+    struct Segment;
+
+    SharedThrottle(std::string name, Segment* segment);
+
+    static uint64_t AcquireBucket(Bucket* bucket, uint64_t tokens,
+                                  int64_t nowNs);
+
+ private:
+    const std::string name_;
+    Segment* segment_;
+};
+
+}  // namespace common
+}  // namespace curve
+
+#endif  // SRC_COMMON_SHARED_THROTTLE_H_
@@ -41,6 +41,7 @@ const char* kFlattenAction = "Flatten";
 const char* kGetFileSnapshotListAction = "GetFileSnapshotList";
 const char* kGetCloneTaskListAction = "GetCloneTaskList";
 const char* kGetCloneRefStatusAction = "GetCloneRefStatus";
+const char* kGetSnapshotDiffAction = "GetSnapshotDiff";
 
 const char* kActionStr = "Action";
 const char* kVersionStr = "Version";
@@ -57,6 +58,7 @@ const char* kPoolset = "Poolset";
 const char* kStatusStr = "Status";
 const char* kTypeStr = "Type";
 const char* kInodeStr = "Inode";
+const char* kBaseUUIDStr = "BaseUUID";
 
 const char* kCodeStr = "Code";
 const char* kMessageStr = "Message";
@@ -66,6 +68,10 @@ const char* kSnapshotsStr = "Snapshots";
 const char* kTaskInfosStr = "TaskInfos";
 const char* kRefStatusStr = "RefStatus";
 const char* kCloneFileInfoStr = "CloneFileInfo";
+const char* kChunkSizeStr = "ChunkSize";
+const char* kFileLengthStr = "FileLength";
+const char* kChangedRangesStr = "ChangedRanges";
+const char* kLengthStr = "Length";
 
 std::map<int, std::string> code2Msg = {
     {kErrCodeSuccess, "Exec success."},
@@ -44,6 +44,7 @@ extern const char* kFlattenAction;
 extern const char* kGetFileSnapshotListAction;
 extern const char* kGetCloneTaskListAction;
 extern const char* kGetCloneRefStatusAction;
+extern const char* kGetSnapshotDiffAction;
 // param
 extern const char* kActionStr;
 extern const char* kVersionStr;
@@ -60,6 +61,7 @@ extern const char* kPoolset;
 extern const char* kStatusStr;
 extern const char* kTypeStr;
 extern const char* kInodeStr;
+extern const char* kBaseUUIDStr;
 
 // json key
 extern const char* kCodeStr;
@@ -70,6 +72,10 @@ extern const char* kSnapshotsStr;
 extern const char* kTaskInfosStr;
 extern const char* kRefStatusStr;
 extern const char* kCloneFileInfoStr;
+extern const char* kChunkSizeStr;
+extern const char* kFileLengthStr;
+extern const char* kChangedRangesStr;
+extern const char* kLengthStr;
 
 typedef std::string UUID;
 using TaskIdType = UUID;
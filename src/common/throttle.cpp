@@ -28,6 +28,8 @@
 #include <string>
 #include <utility>
 
+#include "src/common/shared_throttle.h"
+
 namespace curve {
 namespace common {
 
@@ -76,6 +78,14 @@ void Throttle::Add(bool isReadOp, uint64_t length) {
             throttle.leakyBucket->Add(tokens);
         }
     }
+
+    for (auto& parent : parents_) {
+        parent->Add(isReadOp, length);
+    }
+}
+
+void Throttle::AddParent(std::shared_ptr<SharedThrottle> parent) {
+    parents_.emplace_back(std::move(parent));
 }
 
 void Throttle::ResetThrottleParams(Type type, uint64_t limit, uint64_t burst,
@@ -33,6 +33,8 @@
 namespace curve {
 namespace common {
 
+class SharedThrottle;
+
 struct ReadWriteThrottleParams {
     ThrottleParams iopsTotal;
     ThrottleParams iopsRead;
@@ -96,6 +98,13 @@ class Throttle {
      */
     bool IsThrottleEnabled(Type type) const;
 
+    /**
+     * @brief Add an upper level throttle, e.g. the host or tenant wide
+     *        one, the requests pass this throttle and then all parents.
+     *        Should be called before any request.
+     */
+    void AddParent(std::shared_ptr<SharedThrottle> parent);
+
  private:
     void UpdateIfNotEqual(Type type,
                           const curve::common::ThrottleParams& oldParams,
@@ -130,6 +139,9 @@ class Throttle {
     // iops-total/iops-read/iops-write/bps-total/bps-read/bps-write throttle
     // std::vector<std::pair<Type, common::LeakyBucketThrottle*>> throttles_;
     std::vector<InternalThrottle> throttles_;
+
+    // the upper levels of the hierarchy
+    std::vector<std::shared_ptr<SharedThrottle>> parents_;
 };
 
 }  // namespace common
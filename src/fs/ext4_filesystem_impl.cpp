@@ -416,5 +416,26 @@ int Ext4FileSystemImpl::Fsync(int fd) {
     return 0;
 }
 
+int Ext4FileSystemImpl::SyncFileRange(int fd,
+                                      uint64_t offset,
+                                      uint64_t length) {
+    int rc = posixWrapper_->sync_file_range(fd, offset, length,
+                                            SYNC_FILE_RANGE_WRITE);
+    if (rc < 0) {
+        LOG(ERROR) << "sync_file_range failed: " << strerror(errno);
+        return -errno;
+    }
+    return 0;
+}
+
+int Ext4FileSystemImpl::SyncFs(int fd) {
+    int rc = posixWrapper_->syncfs(fd);
+    if (rc < 0) {
+        LOG(ERROR) << "syncfs failed: " << strerror(errno);
+        return -errno;
+    }
+    return 0;
+}
+
 }  // namespace fs
 }  // namespace curve
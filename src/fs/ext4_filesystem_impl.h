@@ -61,6 +61,8 @@ class Ext4FileSystemImpl : public LocalFileSystem {
                   int length) override;
     int Fstat(int fd, struct stat* info) override;
     int Fsync(int fd) override;
+    int SyncFileRange(int fd, uint64_t offset, uint64_t length) override;
+    int SyncFs(int fd) override;
 
  private:
     explicit Ext4FileSystemImpl(std::shared_ptr<PosixWrapper>);
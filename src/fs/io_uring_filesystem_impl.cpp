@@ -0,0 +1,546 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <glog/logging.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "src/fs/io_uring_filesystem_impl.h"
+
+namespace curve {
+namespace fs {
+
+namespace {
+
+// max number of writev requests submitted in one batch by Write(IOBuf)
+const uint32_t kMaxBatchedWritev = 32;
+
+int SysIoUringSetup(uint32_t entries, struct io_uring_params* p) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, p));
+}
+
+int SysIoUringEnter(int fd, uint32_t toSubmit, uint32_t minComplete,
+                    uint32_t flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit,
+                                      minComplete, flags, nullptr, 0));
+}
+
+}  // namespace
+
+IoUringQueue::IoUringQueue()
+    : ringFd_(-1),
+      sqRing_(nullptr),
+      sqRingSize_(0),
+      cqRing_(nullptr),
+      cqRingSize_(0),
+      sqes_(nullptr),
+      sqesSize_(0),
+      sqHead_(nullptr),
+      sqTail_(nullptr),
+      sqMask_(nullptr),
+      sqArray_(nullptr),
+      sqEntries_(0),
+      cqHead_(nullptr),
+      cqTail_(nullptr),
+      cqMask_(nullptr),
+      cqes_(nullptr),
+      pending_(0) {}
+
+IoUringQueue::~IoUringQueue() {
+    Close();
+}
+
+int IoUringQueue::Init(uint32_t entries) {
+    struct io_uring_params p;
+    ::memset(&p, 0, sizeof(p));
+    int fd = SysIoUringSetup(entries, &p);
+    if (fd < 0) {
+        LOG(ERROR) << "io_uring_setup failed: " << strerror(errno)
+                   << ", entries: " << entries;
+        return -errno;
+    }
+    ringFd_ = fd;
+
+    sqRingSize_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cqRingSize_ = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    bool singleMmap = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap) {
+        sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+    }
+
+    sqRing_ = ::mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sqRing_ == MAP_FAILED) {
+        LOG(ERROR) << "mmap io_uring sq ring failed: " << strerror(errno);
+        sqRing_ = nullptr;
+        int ret = -errno;
+        Close();
+        return ret;
+    }
+
+    if (singleMmap) {
+        cqRing_ = sqRing_;
+    } else {
+        cqRing_ = ::mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cqRing_ == MAP_FAILED) {
+            LOG(ERROR) << "mmap io_uring cq ring failed: " << strerror(errno);
+            cqRing_ = nullptr;
+            int ret = -errno;
+            Close();
+            return ret;
+        }
+    }
+
+    sqesSize_ = p.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = ::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        LOG(ERROR) << "mmap io_uring sqes failed: " << strerror(errno);
+        int ret = -errno;
+        Close();
+        return ret;
+    }
+    sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(sqRing_);
+    sqHead_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+    sqTail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    sqMask_ = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    sqArray_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+    sqEntries_ = p.sq_entries;
+
+    char* cq = static_cast<char*>(cqRing_);
+    cqHead_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    cqTail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    cqMask_ = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + p.cq_off.cqes);
+    pending_ = 0;
+    return 0;
+}
+
+void IoUringQueue::Close() {
+    if (sqes_ != nullptr) {
+        ::munmap(sqes_, sqesSize_);
+        sqes_ = nullptr;
+    }
+    if (cqRing_ != nullptr && cqRing_ != sqRing_) {
+        ::munmap(cqRing_, cqRingSize_);
+    }
+    cqRing_ = nullptr;
+    if (sqRing_ != nullptr) {
+        ::munmap(sqRing_, sqRingSize_);
+        sqRing_ = nullptr;
+    }
+    if (ringFd_ >= 0) {
+        ::close(ringFd_);
+        ringFd_ = -1;
+    }
+}
+
+struct io_uring_sqe* IoUringQueue::GetSqe() {
+    unsigned head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    unsigned tail = *sqTail_;
+    if (tail - head + pending_ >= sqEntries_) {
+        return nullptr;
+    }
+    unsigned index = (tail + pending_) & *sqMask_;
+    struct io_uring_sqe* sqe = &sqes_[index];
+    ::memset(sqe, 0, sizeof(*sqe));
+    sqArray_[index] = index;
+    ++pending_;
+    return sqe;
+}
+
+bool IoUringQueue::PrepRead(int fd, void* buf, uint32_t length,
+                            uint64_t offset, uint64_t userData) {
+    struct io_uring_sqe* sqe = GetSqe();
+    if (sqe == nullptr) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(buf);
+    sqe->len = length;
+    sqe->off = offset;
+    sqe->user_data = userData;
+    return true;
+}
+
+bool IoUringQueue::PrepWrite(int fd, const void* buf, uint32_t length,
+                             uint64_t offset, uint64_t userData) {
+    struct io_uring_sqe* sqe = GetSqe();
+    if (sqe == nullptr) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(buf);
+    sqe->len = length;
+    sqe->off = offset;
+    sqe->user_data = userData;
+    return true;
+}
+
+bool IoUringQueue::PrepWritev(int fd, const struct iovec* iov,
+                              uint32_t iovcnt, uint64_t offset,
+                              uint64_t userData) {
+    struct io_uring_sqe* sqe = GetSqe();
+    if (sqe == nullptr) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_WRITEV;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(iov);
+    sqe->len = iovcnt;
+    sqe->off = offset;
+    sqe->user_data = userData;
+    return true;
+}
+
+int IoUringQueue::Submit(uint32_t waitNr) {
+    uint32_t toSubmit = pending_;
+    if (toSubmit > 0) {
+        __atomic_store_n(sqTail_, *sqTail_ + toSubmit, __ATOMIC_RELEASE);
+        pending_ = 0;
+    }
+
+    uint32_t flags = waitNr > 0 ? IORING_ENTER_GETEVENTS : 0;
+    int ret = 0;
+    do {
+        ret = SysIoUringEnter(ringFd_, toSubmit, waitNr, flags);
+    } while (ret < 0 && errno == EINTR);
+
+    if (ret < 0) {
+        LOG(ERROR) << "io_uring_enter failed: " << strerror(errno)
+                   << ", to submit: " << toSubmit << ", wait: " << waitNr;
+        return -errno;
+    }
+    return ret;
+}
+
+bool IoUringQueue::PopCompletion(uint64_t* userData, int* res) {
+    unsigned head = *cqHead_;
+    unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+        return false;
+    }
+    struct io_uring_cqe* cqe = &cqes_[head & *cqMask_];
+    *userData = cqe->user_data;
+    *res = cqe->res;
+    __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+namespace {
+
+// rings are created per thread and released when the thread exits
+struct ThreadLocalQueue {
+    ~ThreadLocalQueue() { delete queue; }
+    IoUringQueue* queue = nullptr;
+};
+
+thread_local ThreadLocalQueue tlsQueue;
+
+}  // namespace
+
+std::shared_ptr<IoUringFileSystemImpl> IoUringFileSystemImpl::self_ = nullptr;
+std::mutex IoUringFileSystemImpl::mutex_;
+
+IoUringFileSystemImpl::IoUringFileSystemImpl(
+    std::shared_ptr<Ext4FileSystemImpl> ext4)
+    : ext4_(ext4),
+      queueDepth_(LocalFileSystemOption().ioUringQueueDepth) {
+    CHECK(ext4_ != nullptr) << "Ext4FileSystemImpl is null";
+}
+
+IoUringFileSystemImpl::~IoUringFileSystemImpl() {}
+
+std::shared_ptr<IoUringFileSystemImpl> IoUringFileSystemImpl::getInstance() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (self_ == nullptr) {
+        self_ = std::shared_ptr<IoUringFileSystemImpl>(
+            new (std::nothrow)
+                IoUringFileSystemImpl(Ext4FileSystemImpl::getInstance()));
+        CHECK(self_ != nullptr) << "Failed to new io_uring local fs.";
+    }
+    return self_;
+}
+
+int IoUringFileSystemImpl::Init(const LocalFileSystemOption& option) {
+    if (option.ioUringQueueDepth == 0) {
+        LOG(ERROR) << "io_uring queue depth must be greater than 0";
+        return -1;
+    }
+    queueDepth_ = option.ioUringQueueDepth;
+
+    // make sure the kernel supports io_uring before any io is issued
+    IoUringQueue probe;
+    if (probe.Init(queueDepth_) != 0) {
+        LOG(ERROR) << "io_uring is not supported on this system";
+        return -1;
+    }
+    return ext4_->Init(option);
+}
+
+IoUringQueue* IoUringFileSystemImpl::GetQueue() {
+    if (tlsQueue.queue == nullptr) {
+        IoUringQueue* queue = new IoUringQueue();
+        if (queue->Init(queueDepth_) != 0) {
+            delete queue;
+            return nullptr;
+        }
+        tlsQueue.queue = queue;
+    }
+    return tlsQueue.queue;
+}
+
+int IoUringFileSystemImpl::DoRw(bool isRead, int fd, char* buf,
+                                uint64_t offset, int length) {
+    IoUringQueue* queue = GetQueue();
+    if (queue == nullptr) {
+        return -EIO;
+    }
+
+    int remainLength = length;
+    int relativeOffset = 0;
+    int retryTimes = 0;
+    while (remainLength > 0) {
+        bool prepared = isRead
+            ? queue->PrepRead(fd, buf + relativeOffset, remainLength,
+                              offset, 0)
+            : queue->PrepWrite(fd, buf + relativeOffset, remainLength,
+                               offset, 0);
+        CHECK(prepared) << "io_uring submission queue overflow";
+        int rc = queue->Submit(1);
+        if (rc < 0) {
+            return rc;
+        }
+
+        uint64_t userData = 0;
+        int ret = 0;
+        CHECK(queue->PopCompletion(&userData, &ret))
+            << "io_uring completion queue is empty";
+        if (ret == 0 && isRead) {
+            // same as pread, if offset is beyond the end of file
+            LOG(WARNING) << "io_uring read returns zero."
+                         << "offset: " << offset
+                         << ", length: " << remainLength;
+            break;
+        }
+        if (ret < 0) {
+            if ((ret == -EINTR || ret == -EAGAIN) &&
+                retryTimes < MAX_RETYR_TIME) {
+                ++retryTimes;
+                continue;
+            }
+            LOG(ERROR) << "io_uring " << (isRead ? "read" : "write")
+                       << " failed, fd: " << fd
+                       << ", size: " << remainLength << ", offset: " << offset
+                       << ", error: " << strerror(-ret);
+            return ret;
+        }
+        remainLength -= ret;
+        offset += ret;
+        relativeOffset += ret;
+    }
+    return length - remainLength;
+}
+
+int IoUringFileSystemImpl::Read(int fd, char* buf, uint64_t offset,
+                                int length) {
+    return DoRw(true, fd, buf, offset, length);
+}
+
+int IoUringFileSystemImpl::Write(int fd, const char* buf, uint64_t offset,
+                                 int length) {
+    int ret = DoRw(false, fd, const_cast<char*>(buf), offset, length);
+    return ret < 0 ? ret : length;
+}
+
+int IoUringFileSystemImpl::Write(int fd, butil::IOBuf buf, uint64_t offset,
+                                 int length) {
+    if (length != static_cast<int>(buf.size())) {
+        LOG(ERROR) << "io_uring writev failed, fd: " << fd
+                   << ", data size doesn't equal to length, data size: "
+                   << buf.size() << ", length: " << length;
+        return -EINVAL;
+    }
+
+    IoUringQueue* queue = GetQueue();
+    if (queue == nullptr) {
+        return -EIO;
+    }
+
+    const uint32_t maxBatch = std::min(kMaxBatchedWritev, queue->Capacity());
+    std::vector<struct iovec> iovs;
+    std::vector<uint64_t> expected;
+    int retryTimes = 0;
+    while (!buf.empty()) {
+        // split the blocks of buf into several writev requests, each one
+        // covers at most IOV_MAX blocks, and submit them all at once
+        size_t blockNum = buf.backing_block_num();
+        iovs.resize(blockNum);
+        expected.clear();
+        uint64_t reqOffset = offset;
+        size_t block = 0;
+        while (block < blockNum && expected.size() < maxBatch) {
+            size_t end = std::min(blockNum, block + IOV_MAX);
+            uint64_t reqLength = 0;
+            for (size_t i = block; i < end; ++i) {
+                butil::StringPiece piece = buf.backing_block(i);
+                iovs[i].iov_base = const_cast<char*>(piece.data());
+                iovs[i].iov_len = piece.size();
+                reqLength += piece.size();
+            }
+            queue->PrepWritev(fd, &iovs[block], end - block, reqOffset,
+                              expected.size());
+            expected.push_back(reqLength);
+            reqOffset += reqLength;
+            block = end;
+        }
+
+        int rc = queue->Submit(expected.size());
+        if (rc < 0) {
+            return rc;
+        }
+
+        std::vector<int> results(expected.size(), 0);
+        size_t completed = 0;
+        while (completed < expected.size()) {
+            uint64_t userData = 0;
+            int res = 0;
+            if (!queue->PopCompletion(&userData, &res)) {
+                rc = queue->Submit(1);
+                if (rc < 0) {
+                    return rc;
+                }
+                continue;
+            }
+            results[userData] = res;
+            ++completed;
+        }
+
+        // only the bytes before the first short or failed request are
+        // considered written, the rest will be written again
+        uint64_t written = 0;
+        for (size_t i = 0; i < results.size(); ++i) {
+            if (results[i] < 0) {
+                if (written == 0) {
+                    if ((results[i] == -EINTR || results[i] == -EAGAIN) &&
+                        retryTimes < MAX_RETYR_TIME) {
+                        ++retryTimes;
+                        break;
+                    }
+                    LOG(ERROR) << "io_uring writev failed, fd: " << fd
+                               << ", size: " << buf.size()
+                               << ", offset: " << offset
+                               << ", error: " << strerror(-results[i]);
+                    return results[i];
+                }
+                break;
+            }
+            written += results[i];
+            if (static_cast<uint64_t>(results[i]) < expected[i]) {
+                break;
+            }
+        }
+
+        buf.pop_front(written);
+        offset += written;
+    }
+
+    return length;
+}
+
+int IoUringFileSystemImpl::Statfs(const string& path,
+                                  struct FileSystemInfo* info) {
+    return ext4_->Statfs(path, info);
+}
+
+int IoUringFileSystemImpl::Open(const string& path, int flags) {
+    return ext4_->Open(path, flags);
+}
+
+int IoUringFileSystemImpl::Close(int fd) {
+    return ext4_->Close(fd);
+}
+
+int IoUringFileSystemImpl::Delete(const string& path) {
+    return ext4_->Delete(path);
+}
+
+int IoUringFileSystemImpl::Mkdir(const string& dirPath) {
+    return ext4_->Mkdir(dirPath);
+}
+
+bool IoUringFileSystemImpl::DirExists(const string& dirPath) {
+    return ext4_->DirExists(dirPath);
+}
+
+bool IoUringFileSystemImpl::FileExists(const string& filePath) {
+    return ext4_->FileExists(filePath);
+}
+
+int IoUringFileSystemImpl::DoRename(const string& oldPath,
+                                    const string& newPath,
+                                    unsigned int flags) {
+    return ext4_->Rename(oldPath, newPath, flags);
+}
+
+int IoUringFileSystemImpl::List(const string& dirPath,
+                                vector<std::string>* names) {
+    return ext4_->List(dirPath, names);
+}
+
+int IoUringFileSystemImpl::Sync(int fd) {
+    return ext4_->Sync(fd);
+}
+
+int IoUringFileSystemImpl::Append(int fd, const char* buf, int length) {
+    return ext4_->Append(fd, buf, length);
+}
+
+int IoUringFileSystemImpl::Fallocate(int fd, int op, uint64_t offset,
+                                     int length) {
+    return ext4_->Fallocate(fd, op, offset, length);
+}
+
+int IoUringFileSystemImpl::Fstat(int fd, struct stat* info) {
+    return ext4_->Fstat(fd, info);
+}
+
+int IoUringFileSystemImpl::Fsync(int fd) {
+    return ext4_->Fsync(fd);
+}
+
+int IoUringFileSystemImpl::SyncFileRange(int fd,
+                                         uint64_t offset,
+                                         uint64_t length) {
+    return ext4_->SyncFileRange(fd, offset, length);
+}
+
+int IoUringFileSystemImpl::SyncFs(int fd) {
+    return ext4_->SyncFs(fd);
+}
+
+}  // namespace fs
+}  // namespace curve
@@ -0,0 +1,166 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_FS_IO_URING_FILESYSTEM_IMPL_H_
+#define SRC_FS_IO_URING_FILESYSTEM_IMPL_H_
+
+#include <butil/iobuf.h>
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "src/fs/local_filesystem.h"
+#include "src/fs/ext4_filesystem_impl.h"
+
+namespace curve {
+namespace fs {
+
+/**
+ * A minimal io_uring submission/completion queue pair, driven directly
+ * through the io_uring_setup/io_uring_enter syscalls so that no extra
+ * library is needed. One instance must only be used by one thread.
+ */
+class IoUringQueue {
+ public:
+    IoUringQueue();
+    ~IoUringQueue();
+
+    /**
+     * @brief setup the ring and map the shared queues
+     * @param entries: number of sqes, rounded up to a power of 2 by kernel
+     * @return 0 on success, otherwise return -errno
+     */
+    int Init(uint32_t entries);
+
+    void Close();
+
+    /**
+     * @brief queue a read/write/writev request, it is not submitted
+     *        until Submit() is called
+     * @return false if the submission queue is full
+     */
+    bool PrepRead(int fd, void* buf, uint32_t length, uint64_t offset,
+                  uint64_t userData);
+    bool PrepWrite(int fd, const void* buf, uint32_t length, uint64_t offset,
+                   uint64_t userData);
+    bool PrepWritev(int fd, const struct iovec* iov, uint32_t iovcnt,
+                    uint64_t offset, uint64_t userData);
+
+    /**
+     * @brief submit all queued requests with one syscall and wait until
+     *        at least waitNr requests are completed
+     * @return number of submitted requests, or -errno on failure
+     */
+    int Submit(uint32_t waitNr);
+
+    /**
+     * @brief pop one completion if there is any
+     * @param[out] userData: userData of the completed request
+     * @param[out] res: result of the request, -errno on failure
+     * @return false if the completion queue is empty
+     */
+    bool PopCompletion(uint64_t* userData, int* res);
+
+    uint32_t Capacity() const { return sqEntries_; }
+
+ private:
+    struct io_uring_sqe* GetSqe();
+
+ private:
+    int ringFd_;
+
+    void* sqRing_;
+    size_t sqRingSize_;
+    void* cqRing_;
+    size_t cqRingSize_;
+    struct io_uring_sqe* sqes_;
+    size_t sqesSize_;
+
+    unsigned* sqHead_;
+    unsigned* sqTail_;
+    unsigned* sqMask_;
+    unsigned* sqArray_;
+    uint32_t sqEntries_;
+
+    unsigned* cqHead_;
+    unsigned* cqTail_;
+    unsigned* cqMask_;
+    struct io_uring_cqe* cqes_;
+
+    // sqes prepared but not submitted yet
+    uint32_t pending_;
+};
+
+/**
+ * LocalFileSystem which issues data I/O (Read/Write) through io_uring,
+ * all the other operations are delegated to Ext4FileSystemImpl.
+ * Each calling thread owns its own ring, so the apply threads don't
+ * contend with each other, and an IOBuf write is split into several
+ * writev requests submitted in one batch.
+ */
+class IoUringFileSystemImpl : public LocalFileSystem {
+ public:
+    virtual ~IoUringFileSystemImpl();
+    static std::shared_ptr<IoUringFileSystemImpl> getInstance();
+
+    int Init(const LocalFileSystemOption& option) override;
+    int Statfs(const string& path, struct FileSystemInfo* info) override;
+    int Open(const string& path, int flags) override;
+    int Close(int fd) override;
+    int Delete(const string& path) override;
+    int Mkdir(const string& dirPath) override;
+    bool DirExists(const string& dirPath) override;
+    bool FileExists(const string& filePath) override;
+    int List(const string& dirPath, vector<std::string>* names) override;
+    int Read(int fd, char* buf, uint64_t offset, int length) override;
+    int Write(int fd, const char* buf, uint64_t offset, int length) override;
+    int Write(int fd, butil::IOBuf buf, uint64_t offset, int length) override;
+    int Sync(int fd) override;
+    int Append(int fd, const char* buf, int length) override;
+    int Fallocate(int fd, int op, uint64_t offset,
+                  int length) override;
+    int Fstat(int fd, struct stat* info) override;
+    int Fsync(int fd) override;
+    int SyncFileRange(int fd, uint64_t offset, uint64_t length) override;
+    int SyncFs(int fd) override;
+
+ private:
+    explicit IoUringFileSystemImpl(std::shared_ptr<Ext4FileSystemImpl> ext4);
+    int DoRename(const string& oldPath,
+                 const string& newPath,
+                 unsigned int flags) override;
+
+    // return the ring of current thread, create it if not exist
+    IoUringQueue* GetQueue();
+
+    // submit a single read or write request and wait for its result
+    int DoRw(bool isRead, int fd, char* buf, uint64_t offset, int length);
+
+ private:
+    static std::shared_ptr<IoUringFileSystemImpl> self_;
+    static std::mutex mutex_;
+    std::shared_ptr<Ext4FileSystemImpl> ext4_;
+    uint32_t queueDepth_;
+};
+
+}  // namespace fs
+}  // namespace curve
+
+#endif  // SRC_FS_IO_URING_FILESYSTEM_IMPL_H_
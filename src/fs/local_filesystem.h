@@ -45,7 +45,10 @@ namespace fs {
 
 struct LocalFileSystemOption {
     bool enableRenameat2;
-    LocalFileSystemOption() : enableRenameat2(false) {}
+    // number of sqes of each io_uring, only used by EXT4_IO_URING
+    uint32_t ioUringQueueDepth;
+    LocalFileSystemOption()
+        : enableRenameat2(false), ioUringQueueDepth(128) {}
 };
 
 class LocalFileSystem {
@@ -215,6 +218,22 @@ class LocalFileSystem {
      */
     virtual int Fsync(int fd) = 0;
 
+    /**
+     * 启动文件指定区域脏页的回写，不等待回写完成，也不刷元数据
+     * @param fd：文件句柄id，通过Open接口获取
+     * @param offset：区域的起始偏移
+     * @param length：区域的长度，0表示到文件末尾
+     * @return 成功返回0
+     */
+    virtual int SyncFileRange(int fd, uint64_t offset, uint64_t length) = 0;
+
+    /**
+     * 将fd所在文件系统的所有数据和元数据刷新到磁盘
+     * @param fd：文件系统上任一文件的句柄id
+     * @return 成功返回0
+     */
+    virtual int SyncFs(int fd) = 0;
+
  private:
     virtual int DoRename(const string& /* oldPath */,
                          const string& /* newPath */,
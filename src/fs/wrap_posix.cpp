@@ -121,6 +121,15 @@ int PosixWrapper::fsync(int fd) {
     return ::fsync(fd);
 }
 
+int PosixWrapper::sync_file_range(int fd, off_t offset, off_t nbytes,
+                                  unsigned int flags) {
+    return ::sync_file_range(fd, offset, nbytes, flags);
+}
+
+int PosixWrapper::syncfs(int fd) {
+    return ::syncfs(fd);
+}
+
 int PosixWrapper::statfs(const char *path, struct statfs *buf) {
     return ::statfs(path, buf);
 }
@@ -64,6 +64,9 @@ class PosixWrapper {
     virtual int fstat(int fd, struct stat *buf);
     virtual int fallocate(int fd, int mode, off_t offset, off_t len);
     virtual int fsync(int fd);
+    virtual int sync_file_range(int fd, off_t offset, off_t nbytes,
+                                unsigned int flags);
+    virtual int syncfs(int fd);
     virtual int statfs(const char *path, struct statfs *buf);
     virtual int uname(struct utsname *buf);
 };
@@ -21,6 +21,7 @@
  */
 
 #include <glog/logging.h>
+#include <algorithm>
 #include <cassert>
 #include "src/common/string_util.h"
 #include "src/kvstorageclient/etcd_client.h"
@@ -207,6 +208,83 @@ int EtcdClientImp::TxnN(const std::vector<Operation> &ops) {
     return errCode;
 }
 
+int EtcdClientImp::TxnNWithRevision(const std::vector<Operation> &ops,
+    int64_t *revision) {
+    if (ops.empty()) {
+        LOG(ERROR) << "do not support empty Txn";
+        return EtcdErrCode::EtcdInvalidArgument;
+    }
+
+    bool needRetry = false;
+    int retry = 0;
+    int errCode;
+    do {
+        EtcdClientTxnN_return res = EtcdClientTxnN(timeout_,
+            const_cast<Operation*>(ops.data()), ops.size());
+        if (res.r0 == EtcdErrCode::EtcdOK) {
+            *revision = res.r1;
+        }
+        errCode = res.r0;
+        needRetry = NeedRetry(errCode);
+    } while (needRetry && ++retry <= retryTimes_);
+    return errCode;
+}
+
+int EtcdClientImp::MultiGet(const std::vector<std::string> &keys,
+                            std::map<std::string, std::string> *out) {
+    assert(out != nullptr);
+    out->clear();
+
+    for (size_t start = 0; start < keys.size();
+         start += kMultiGetBatchSize) {
+        size_t end = std::min(keys.size(), start + kMultiGetBatchSize);
+        std::vector<Operation> ops;
+        ops.reserve(end - start);
+        for (size_t i = start; i < end; i++) {
+            ops.emplace_back(Operation{OpType::OpPut,
+                const_cast<char*>(keys[i].c_str()), nullptr,
+                static_cast<int>(keys[i].size()), 0});
+        }
+
+        bool needRetry = false;
+        int retry = 0;
+        int errCode;
+        do {
+            EtcdClientMultiGet_return res = EtcdClientMultiGet(
+                timeout_, ops.data(), ops.size());
+            errCode = res.r0;
+            needRetry = NeedRetry(errCode);
+            if (res.r0 != EtcdErrCode::EtcdOK) {
+                LOG(WARNING) << "multi get " << ops.size()
+                             << " keys err: " << res.r0
+                             << ", retry: " << retry
+                             << ", needRetry: " << needRetry;
+                continue;
+            }
+            for (int i = 0; i < res.r2; i++) {
+                EtcdClientGetMultiObject_return objRes =
+                    EtcdClientGetMultiObject(res.r1, i);
+                if (objRes.r0 != EtcdErrCode::EtcdOK) {
+                    LOG(ERROR) << "get object:" << res.r1 << " index: " << i
+                               << "err: " << objRes.r0;
+                    EtcdClientRemoveObject(res.r1);
+                    return objRes.r0;
+                }
+                out->emplace(std::string(objRes.r3, objRes.r3 + objRes.r4),
+                             std::string(objRes.r1, objRes.r1 + objRes.r2));
+                free(objRes.r1);
+                free(objRes.r3);
+            }
+            EtcdClientRemoveObject(res.r1);
+        } while (needRetry && ++retry <= retryTimes_);
+
+        if (errCode != EtcdErrCode::EtcdOK) {
+            return errCode;
+        }
+    }
+    return EtcdErrCode::EtcdOK;
+}
+
 int EtcdClientImp::GetCurrentRevision(int64_t *revision) {
     bool needRetry = false;
     int retry = 0;
@@ -293,6 +371,48 @@ int EtcdClientImp::CompareAndSwap(const std::string &key,
     return errCode;
 }
 
+int EtcdClientImp::Watch(const std::string &startKey,
+    const std::string &endKey, int64_t startRevision, int timeoutMs,
+    std::vector<WatchEvent> *events, int64_t *revision) {
+    // no retry, the caller watches again on error
+    EtcdClientWatch_return res = EtcdClientWatch(
+        timeoutMs, const_cast<char*>(startKey.c_str()),
+        const_cast<char*>(endKey.c_str()), startKey.size(), endKey.size(),
+        startRevision);
+    if (res.r0 == EtcdErrCode::EtcdOutOfRange) {
+        *revision = res.r3;
+        return res.r0;
+    } else if (res.r0 != EtcdErrCode::EtcdOK) {
+        return res.r0;
+    }
+
+    int errCode = EtcdErrCode::EtcdOK;
+    for (int i = 0; i < res.r2; i++) {
+        EtcdClientGetWatchEvent_return objRes =
+            EtcdClientGetWatchEvent(res.r1, i);
+        if (objRes.r0 != EtcdErrCode::EtcdOK) {
+            LOG(ERROR) << "get watch event:" << res.r1 << " index:" << i
+                       << ", count:" << res.r2 << " err: " << objRes.r0;
+            errCode = objRes.r0;
+            break;
+        }
+
+        WatchEvent event;
+        event.deleted = (objRes.r1 == OpType::OpDelete);
+        event.key = std::string(objRes.r2, objRes.r2 + objRes.r3);
+        event.value = std::string(objRes.r4, objRes.r4 + objRes.r5);
+        events->emplace_back(std::move(event));
+        free(objRes.r2);
+        free(objRes.r4);
+    }
+    EtcdClientRemoveObject(res.r1);
+
+    if (errCode == EtcdErrCode::EtcdOK) {
+        *revision = res.r3;
+    }
+    return errCode;
+}
+
 int EtcdClientImp::CampaignLeader(
     const std::string &pfx, const std::string &leaderName,
     uint32_t sessionInterSec, uint32_t electionTimeoutMs, uint64_t *leaderOid) {
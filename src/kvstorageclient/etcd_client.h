@@ -24,12 +24,21 @@
 #define SRC_KVSTORAGECLIENT_ETCD_CLIENT_H_
 
 #include <libetcdclient.h>
+#include <map>
 #include <string>
 #include <vector>
 #include <utility>
 
 namespace curve {
 namespace kvstorage {
+// a change of key-value got by watch
+struct WatchEvent {
+    bool deleted = false;
+    std::string key;
+    // the value before deleted if deleted
+    std::string value;
+};
+
 class KVStorageClient {
  public:
     KVStorageClient() {}
@@ -120,6 +129,33 @@ class KVStorageClient {
     */
     virtual int TxnN(const std::vector<Operation> &ops) = 0;
 
+    /*
+    * @brief TxnNWithRevision Operate transactions in the order of ops[0] ops[1] ..., any number of operations is supported //NOLINT
+    *
+    * @param[in] ops Operation set
+    * @param[out] revision Version number of the transaction
+    *
+    * @return error code
+    */
+    virtual int TxnNWithRevision(const std::vector<Operation> &ops,
+        int64_t *revision) = 0;
+
+    /**
+     * @brief ListWithLimitAndRevision
+     *        get key-value pairs between [startKey, endKey)
+     *        with specify number and revision
+     *
+     * @param[in] startKey start key
+     * @param[in] endKey end key, not included
+     * @param[in] limit max number
+     * @param[in] revision get the key <= revision, 0 means the latest
+     * @param[out] values the value vector of all the key-value pairs
+     * @param[out] lastKey the last key of the vector
+     */
+    virtual int ListWithLimitAndRevision(const std::string &startKey,
+        const std::string &endKey, int64_t limit, int64_t revision,
+        std::vector<std::string> *values, std::string *lastKey) = 0;
+
     /**
      * @brief CompareAndSwap Transaction, to achieve CAS
      *
@@ -174,26 +210,50 @@ class EtcdClientImp : public KVStorageClient {
 
     int TxnN(const std::vector<Operation> &ops) override;
 
+    int TxnNWithRevision(const std::vector<Operation> &ops,
+        int64_t *revision) override;
+
     int CompareAndSwap(const std::string &key, const std::string &preV,
         const std::string &target) override;
 
     virtual int GetCurrentRevision(int64_t *revision);
 
     /**
-     * @brief ListWithLimitAndRevision
-     *        get key-value pairs between [startKey, endKey)
-     *        with specify number and revision
+     * @brief MultiGet get the values of keys by one txn per
+     *        kMultiGetBatchSize keys instead of one request per key
      *
-     * @param[in] startKey start key
-     * @param[in] endKey end key, not included
-     * @param[in] limit max number
-     * @param[in] revision get the key <= revision
-     * @param[out] values the value vector of all the key-value pairs
-     * @param[out] lastKey the last key of the vector
+     * @param[in] keys
+     * @param[out] out the existing key-values, the missing keys are absent
+     *
+     * @return error code EtcdErrCode
      */
-    virtual int ListWithLimitAndRevision(const std::string &startKey,
+    virtual int MultiGet(const std::vector<std::string> &keys,
+        std::map<std::string, std::string> *out);
+
+    // the default --max-txn-ops of etcd
+    static constexpr size_t kMultiGetBatchSize = 128;
+
+    int ListWithLimitAndRevision(const std::string &startKey,
         const std::string &endKey, int64_t limit, int64_t revision,
-        std::vector<std::string> *values, std::string *lastKey);
+        std::vector<std::string> *values, std::string *lastKey) override;
+
+    /**
+     * @brief Watch get the first batch of changes in range [startKey, endKey)
+     *              since startRevision, blocks until some key changes or
+     *              timeout. The changes of a revision are in the same batch.
+     *
+     * @param[in] timeoutMs max time to wait for changes
+     * @param[out] events changes ordered by revision
+     * @param[out] revision revision of the last change, or the compacted
+     *                      revision if startRevision is compacted
+     *
+     * @return EtcdErrCode::EtcdOK if some key changed,
+     *         EtcdErrCode::EtcdDeadlineExceeded if no change till timeout,
+     *         EtcdErrCode::EtcdOutOfRange if startRevision is compacted
+     */
+    virtual int Watch(const std::string &startKey, const std::string &endKey,
+        int64_t startRevision, int timeoutMs,
+        std::vector<WatchEvent> *events, int64_t *revision);
 
     /**
      * @brief CampaignLeader Leader campaign through etcd, return directly if
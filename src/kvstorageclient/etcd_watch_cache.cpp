@@ -0,0 +1,204 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/kvstorageclient/etcd_watch_cache.h"
+
+#include <glog/logging.h>
+
+#include <chrono>  // NOLINT
+#include <utility>
+#include <vector>
+
+namespace curve {
+namespace kvstorage {
+
+using ::curve::common::ReadLockGuard;
+using ::curve::common::UniqueLock;
+using ::curve::common::WriteLockGuard;
+
+EtcdWatchCache::EtcdWatchCache(std::shared_ptr<EtcdClientImp> client,
+                               const std::string &start,
+                               const std::string &end,
+                               const EtcdWatchCacheOption &option)
+    : client_(std::move(client)),
+      start_(start),
+      end_(end),
+      option_(option),
+      revision_(0),
+      readyRevision_(0),
+      synced_(false),
+      ready_(false),
+      isStop_(true) {}
+
+EtcdWatchCache::~EtcdWatchCache() {
+    Stop();
+}
+
+void EtcdWatchCache::Start() {
+    if (!isStop_.exchange(false)) {
+        return;
+    }
+    sleeper_.init();
+    tailThread_ = std::thread(&EtcdWatchCache::Tail, this);
+    LOG(INFO) << "etcd watch cache of [" << start_ << ", " << end_
+              << ") started";
+}
+
+void EtcdWatchCache::Stop() {
+    if (isStop_.exchange(true)) {
+        return;
+    }
+    sleeper_.interrupt();
+    tailThread_.join();
+    ready_.store(false);
+    synced_ = false;
+    LOG(INFO) << "etcd watch cache of [" << start_ << ", " << end_
+              << ") stopped at revision " << revision_.load();
+}
+
+int EtcdWatchCache::Get(const std::string &key, std::string *out) {
+    if (ready_.load()) {
+        ReadLockGuard guard(rwlock_);
+        // check again, the mirror may be replaced by Sync
+        if (ready_.load()) {
+            auto it = mirror_.find(key);
+            if (it == mirror_.end()) {
+                return EtcdErrCode::EtcdKeyNotExist;
+            }
+            *out = it->second;
+            return EtcdErrCode::EtcdOK;
+        }
+    }
+    return client_->Get(key, out);
+}
+
+bool EtcdWatchCache::WaitRevision(int64_t revision, uint32_t timeoutMs) {
+    UniqueLock lk(mtx_);
+    return cond_.wait_for(lk, std::chrono::milliseconds(timeoutMs), [&] {
+        return ready_.load() && revision_.load() >= revision;
+    });
+}
+
+void EtcdWatchCache::Tail() {
+    while (!isStop_.load()) {
+        if (!synced_ && !Sync()) {
+            sleeper_.wait_for(
+                std::chrono::milliseconds(option_.watchTimeoutMs));
+            continue;
+        }
+
+        int errCode = WatchOnce();
+        if (errCode != EtcdErrCode::EtcdOK &&
+            errCode != EtcdErrCode::EtcdDeadlineExceeded &&
+            errCode != EtcdErrCode::EtcdOutOfRange) {
+            LOG(WARNING) << "etcd watch cache watch since revision "
+                         << revision_.load() + 1 << " err: " << errCode;
+            sleeper_.wait_for(
+                std::chrono::milliseconds(option_.watchTimeoutMs));
+        }
+    }
+}
+
+bool EtcdWatchCache::Sync() {
+    // the changes after the first revision are watched, some of them may
+    // have been listed, applying them again is harmless as they are applied
+    // in order. The mirror is ready after catching up with the second one,
+    // which is not older than the list.
+    int64_t revision = 0;
+    int errCode = client_->GetCurrentRevision(&revision);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(WARNING) << "etcd watch cache get current revision err: "
+                     << errCode;
+        return false;
+    }
+
+    std::vector<std::pair<std::string, std::string>> kvs;
+    errCode = client_->List(start_, end_, &kvs);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(WARNING) << "etcd watch cache list [" << start_ << ", " << end_
+                     << ") err: " << errCode;
+        return false;
+    }
+
+    int64_t readyRevision = 0;
+    errCode = client_->GetCurrentRevision(&readyRevision);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(WARNING) << "etcd watch cache get current revision err: "
+                     << errCode;
+        return false;
+    }
+
+    {
+        WriteLockGuard guard(rwlock_);
+        mirror_.clear();
+        mirror_.insert(kvs.begin(), kvs.end());
+    }
+    revision_.store(revision);
+    readyRevision_ = readyRevision;
+    synced_ = true;
+    if (revision >= readyRevision) {
+        UniqueLock lk(mtx_);
+        ready_.store(true);
+        cond_.notify_all();
+    }
+    LOG(INFO) << "etcd watch cache of [" << start_ << ", " << end_
+              << ") synced at revision " << revision << ", " << kvs.size()
+              << " key-values mirrored";
+    return true;
+}
+
+int EtcdWatchCache::WatchOnce() {
+    std::vector<WatchEvent> events;
+    int64_t revision = 0;
+    int errCode = client_->Watch(start_, end_, revision_.load() + 1,
+                                 option_.watchTimeoutMs, &events, &revision);
+    if (errCode == EtcdErrCode::EtcdOK ||
+        errCode == EtcdErrCode::EtcdDeadlineExceeded) {
+        if (!events.empty()) {
+            WriteLockGuard guard(rwlock_);
+            for (const auto &event : events) {
+                if (event.deleted) {
+                    mirror_.erase(event.key);
+                } else {
+                    mirror_[event.key] = event.value;
+                }
+            }
+        }
+
+        UniqueLock lk(mtx_);
+        if (errCode == EtcdErrCode::EtcdOK) {
+            revision_.store(revision);
+        }
+        // no change in the range until now also means caught up
+        if (revision_.load() >= readyRevision_ ||
+            errCode == EtcdErrCode::EtcdDeadlineExceeded) {
+            ready_.store(true);
+        }
+        cond_.notify_all();
+        return errCode;
+    }
+
+    // the changes in between may be lost, read from etcd until synced again
+    LOG(WARNING) << "etcd watch cache changes since revision "
+                 << revision_.load() + 1 << " err: " << errCode
+                 << ", sync again";
+    ready_.store(false);
+    synced_ = false;
+    return errCode;
+}
+
+}  // namespace kvstorage
+}  // namespace curve
@@ -0,0 +1,118 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_KVSTORAGECLIENT_ETCD_WATCH_CACHE_H_
+#define SRC_KVSTORAGECLIENT_ETCD_WATCH_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+
+#include "src/common/concurrent/concurrent.h"
+#include "src/common/interruptible_sleeper.h"
+#include "src/kvstorageclient/etcd_client.h"
+
+namespace curve {
+namespace kvstorage {
+
+struct EtcdWatchCacheOption {
+    // max time of a watch, also the retry interval on error
+    uint32_t watchTimeoutMs = 500;
+};
+
+/**
+ * A local mirror of the key-values in [start, end), it is loaded by one
+ * list and then kept up to date by watching the changes, so a read of a
+ * key in the range is served from memory instead of a round trip to etcd.
+ *
+ * The reads go to etcd until the mirror has caught up with the revision
+ * of etcd when it's loaded, and after a watch error, so a read never sees
+ * a state older than the mirror has seen. The changes made by others are
+ * visible after the watch delivers them, a caller which needs to read its
+ * own write waits for the revision of the write by WaitRevision.
+ */
+class EtcdWatchCache {
+ public:
+    EtcdWatchCache(std::shared_ptr<EtcdClientImp> client,
+                   const std::string &start, const std::string &end,
+                   const EtcdWatchCacheOption &option);
+
+    ~EtcdWatchCache();
+
+    // start loading and watching the range in background
+    void Start();
+
+    void Stop();
+
+    /**
+     * @brief Get the value of a key in the range
+     *
+     * @return EtcdOK, EtcdKeyNotExist, or the error of etcd if the
+     *         read goes to etcd
+     */
+    int Get(const std::string &key, std::string *out);
+
+    /**
+     * @brief Wait until the changes up to |revision| are applied
+     *
+     * @return false if timeout
+     */
+    bool WaitRevision(int64_t revision, uint32_t timeoutMs);
+
+    // whether the reads are served by the mirror
+    bool Ready() const { return ready_.load(); }
+
+    // the revision of etcd the mirror reflects
+    int64_t Revision() const { return revision_.load(); }
+
+ private:
+    void Tail();
+
+    // load the range again and watch from the revision of the list
+    bool Sync();
+
+    int WatchOnce();
+
+ private:
+    std::shared_ptr<EtcdClientImp> client_;
+    const std::string start_;
+    const std::string end_;
+    const EtcdWatchCacheOption option_;
+
+    ::curve::common::RWLock rwlock_;
+    std::map<std::string, std::string> mirror_;
+
+    std::atomic<int64_t> revision_;
+    // the mirror is ready after the changes up to it are applied
+    int64_t readyRevision_;
+    bool synced_;
+    std::atomic<bool> ready_;
+
+    ::curve::common::Mutex mtx_;
+    ::curve::common::ConditionVariable cond_;
+
+    std::atomic<bool> isStop_;
+    ::curve::common::InterruptibleSleeper sleeper_;
+    std::thread tailThread_;
+};
+
+}  // namespace kvstorage
+}  // namespace curve
+
+#endif  // SRC_KVSTORAGECLIENT_ETCD_WATCH_CACHE_H_
@@ -96,7 +96,13 @@ int CopysetClient::DeleteChunk(LogicalPoolID logicalPoolId,
                                     CopysetID copysetId,
                                     ChunkID chunkId,
                                     uint64_t sn) {
-    int ret = kMdsFail;
+    return DeleteChunks(logicalPoolId, copysetId, {chunkId}, sn);
+}
+
+int CopysetClient::DeleteChunks(LogicalPoolID logicalPoolId,
+                                CopysetID copysetId,
+                                const std::vector<ChunkID> &chunkIds,
+                                uint64_t sn) {
     CopySetInfo copyset;
     if (true != topo_->GetCopySet(
         CopySetKey(logicalPoolId, copysetId),
@@ -108,48 +114,66 @@ int CopysetClient::DeleteChunk(LogicalPoolID logicalPoolId,
     ChunkServerIdType leaderId =
         copyset.GetLeader();
 
-    if (leaderId != UNINTIALIZE_ID) {
-        ret = chunkserverClient_->DeleteChunk(
-            leaderId, logicalPoolId, copysetId, chunkId, sn);
-        if (kMdsSuccess == ret) {
-            return ret;
-        }
-    }
-
-    // delete Chunk needs to retry when kCsClientCSOffline
-    // or kRpcFail or kCsClientNotLeader returned
-    uint32_t retry = 0;
-    while ((retry < updateLeaderRetryTimes_) &&
-           ((UNINTIALIZE_ID == leaderId) ||
-            (kCsClientCSOffline == ret) ||
-            (kRpcFail == ret) ||
-            (kCsClientNotLeader == ret))) {
-        std::this_thread::sleep_for(
-                std::chrono::milliseconds(updateLeaderRetryIntervalMs_));
-        ret = UpdateLeader(&copyset);
-        if (ret < 0) {
-            LOG(ERROR) << "UpdateLeader fail."
-                       << " logicalPoolId = " << logicalPoolId
-                       << ", copysetId = " << copysetId;
-            break;
-        }
-
-        leaderId = copyset.GetLeader();
-        LOG(INFO) << "UpdateLeader success, new leaderId = " << leaderId;
-
+    for (ChunkID chunkId : chunkIds) {
+        int ret = kMdsFail;
         if (leaderId != UNINTIALIZE_ID) {
             ret = chunkserverClient_->DeleteChunk(
                 leaderId, logicalPoolId, copysetId, chunkId, sn);
             if (kMdsSuccess == ret) {
+                continue;
+            }
+        }
+
+        // delete Chunk needs to retry when kCsClientCSOffline
+        // or kRpcFail or kCsClientNotLeader returned
+        uint32_t retry = 0;
+        while ((retry < updateLeaderRetryTimes_) &&
+               ((UNINTIALIZE_ID == leaderId) ||
+                (kCsClientCSOffline == ret) ||
+                (kRpcFail == ret) ||
+                (kCsClientNotLeader == ret))) {
+            std::this_thread::sleep_for(
+                    std::chrono::milliseconds(updateLeaderRetryIntervalMs_));
+            ret = UpdateLeader(&copyset);
+            if (ret < 0) {
+                LOG(ERROR) << "UpdateLeader fail."
+                           << " logicalPoolId = " << logicalPoolId
+                           << ", copysetId = " << copysetId;
                 break;
             }
-        } else {
-            LOG(ERROR) << "UpdateLeader success, but leaderId is uninit.";
-            return kMdsFail;
+
+            leaderId = copyset.GetLeader();
+            LOG(INFO) << "UpdateLeader success, new leaderId = " << leaderId;
+
+            if (leaderId != UNINTIALIZE_ID) {
+                ret = chunkserverClient_->DeleteChunk(
+                    leaderId, logicalPoolId, copysetId, chunkId, sn);
+                if (kMdsSuccess == ret) {
+                    break;
+                }
+            } else {
+                LOG(ERROR) << "UpdateLeader success, but leaderId is uninit.";
+                return kMdsFail;
+            }
+            retry++;
+        }
+
+        if (ret != kMdsSuccess) {
+            return ret;
         }
-        retry++;
     }
-    return ret;
+    return kMdsSuccess;
+}
+
+ChunkServerIdType CopysetClient::GetLeader(LogicalPoolID logicalPoolId,
+                                           CopysetID copysetId) {
+    CopySetInfo copyset;
+    if (true != topo_->GetCopySet(
+        CopySetKey(logicalPoolId, copysetId),
+        &copyset)) {
+        return UNINTIALIZE_ID;
+    }
+    return copyset.GetLeader();
 }
 
 int CopysetClient::UpdateLeader(CopySetInfo *copyset) {
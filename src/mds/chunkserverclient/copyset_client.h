@@ -24,6 +24,7 @@
 #define SRC_MDS_CHUNKSERVERCLIENT_COPYSET_CLIENT_H_
 
 #include <memory>
+#include <vector>
 #include "src/mds/common/mds_define.h"
 #include "src/mds/topology/topology.h"
 
@@ -92,6 +93,33 @@ class CopysetClient {
         ChunkID chunkId,
         uint64_t sn);
 
+    /**
+     * @brief delete chunks of one copyset, the leader is looked up once and
+     *        reused by the following chunks
+     *
+     * @param logicPoolId
+     * @param copysetId
+     * @param chunkIds chunks in the copyset
+     * @param sn file version number
+     *
+     * @return error code of the first chunk failed to delete
+     */
+    int DeleteChunks(LogicalPoolID logicalPoolId,
+        CopysetID copysetId,
+        const std::vector<ChunkID> &chunkIds,
+        uint64_t sn);
+
+    /**
+     * @brief get the leader of copyset known by topology
+     *
+     * @param logicPoolId
+     * @param copysetId
+     *
+     * @return leader id, UNINTIALIZE_ID if unknown
+     */
+    ChunkServerIdType GetLeader(LogicalPoolID logicalPoolId,
+        CopysetID copysetId);
+
     /**
      * @brief update leader
      *
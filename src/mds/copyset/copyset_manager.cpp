@@ -80,34 +80,37 @@ bool CopysetManager::GenCopyset(const ClusterInfo& cluster,
             return false;
         }
     } else {
-        policy_->GetMinCopySetFromScatterWidth(
-            numChunkServers,
-            targetScatterWidth,
-            constrait_.replicaNum,
-            &numCopysets);
         // set an upper limit here to avoid infinite loop,
         // for every permutation N/R copysets are generated,
         // assume that we can tolerate generating only one scatter-width for
         // every 10 permutation, we need P=10S permutations for 10SN/R copysets.
         // P: permutations S: scatter width
         // N: number of chunkservers R: number of replicas
-        int maxRetryNum =
+        int maxNum =
             10 * targetScatterWidth * numChunkServers / constrait_.replicaNum;
-        while (numCopysets <= maxRetryNum) {
-            if (GenCopyset(cluster, numCopysets, out)) {
-                if (validator_->ValidateScatterWidth(targetScatterWidth,
-                    scatterWidth, *out)) {
-                    return true;
-                } else {
-                    numCopysets++;
-                }
-            } else {
+        // the policy stops at the first copyset reaching the scatter width,
+        // so the copysets are generated and validated once for every retry
+        // rather than once for every copyset number tried
+        int retry = 0;
+        while (retry < option_.copysetRetryTimes) {
+            out->clear();
+            if (!policy_->GenCopysetByScatterWidth(cluster,
+                targetScatterWidth, maxNum, out)) {
                 LOG(ERROR) << "GenCopyset by scatterWidth failed, "
                            << "scatterWidth can not reach, scatterWidth = "
                            << targetScatterWidth;
                 return false;
             }
+            if (validator_->Validate(*out)) {
+                return validator_->ValidateScatterWidth(targetScatterWidth,
+                    scatterWidth, *out);
+            }
+            LOG(WARNING) << "Validate copyset metric failed, retry = "
+                         << retry;
+            retry++;
         }
+        LOG(ERROR) << "GenCopyset by scatterWidth retry times exceed, "
+                   << "times = " << option_.copysetRetryTimes;
     }
     return false;
 }
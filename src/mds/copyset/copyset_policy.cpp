@@ -31,6 +31,7 @@
 #include <sstream>
 #include <iterator>
 #include <set>
+#include <unordered_map>
 #include <unordered_set>
 #include <random>
 #include <utility>
@@ -113,6 +114,63 @@ bool CopysetZoneShufflePolicy::GenCopyset(const ClusterInfo& cluster,
     return false;
 }
 
+bool CopysetZoneShufflePolicy::GenCopysetByScatterWidth(
+    const ClusterInfo& cluster,
+    uint32_t scatterWidth,
+    int maxCopysets,
+    std::vector<Copyset>* out) {
+
+    std::vector<ChunkServerInfo> chunkServers = cluster.GetChunkServerInfo();
+    uint32_t numReplicas = permutationPolicy_->GetReplicaNum();
+
+    // peers of every chunkserver in the copysets generated, and the sum of
+    // their scatter width, so the average is known after every copyset
+    std::unordered_map<ChunkServerIdType,
+                       std::unordered_set<ChunkServerIdType>> peers;
+    uint64_t sumScatterWidth = 0;
+    int copysetNum = 0;
+
+    while (copysetNum < maxCopysets) {
+        std::vector<ChunkServerInfo> csList;
+        if (!permutationPolicy_->permutation(chunkServers, &csList)) {
+            return false;
+        }
+        if (csList.size() < numReplicas) {
+            return false;
+        }
+
+        for (uint32_t i = 0; i + numReplicas <= csList.size();
+             i += numReplicas) {
+            Copyset copyset;
+            for (uint32_t j = i; j < i + numReplicas; j++) {
+                copyset.replicas.insert(csList[j].id);
+            }
+            for (auto csId : copyset.replicas) {
+                auto &peer = peers[csId];
+                for (auto other : copyset.replicas) {
+                    if (other != csId && peer.insert(other).second) {
+                        sumScatterWidth++;
+                    }
+                }
+            }
+            out->emplace_back(std::move(copyset));
+            copysetNum++;
+
+            if (sumScatterWidth >=
+                    static_cast<uint64_t>(scatterWidth) * peers.size()) {
+                LOG(INFO) << "Generate copyset by scatterWidth success"
+                          << ", scatterWidth = " << scatterWidth
+                          << ", numCopysets = " << copysetNum;
+                return true;
+            }
+            if (copysetNum >= maxCopysets) {
+                break;
+            }
+        }
+    }
+    return false;
+}
+
 void CopysetZoneShufflePolicy::GetMinCopySetFromScatterWidth(
     int numChunkServers,
     int scatterWidth,
@@ -176,14 +234,11 @@ bool CopysetPermutationPolicyNXX::permutation(
         return false;
     }
 
-    std::random_device rd;
-    std::mt19937 g(rd());
-
     serversOut->clear();
     if (!csMap.empty()) {
         auto minSize = csMap.begin()->second.size();
         for (auto& it : csMap) {
-            std::shuffle(it.second.begin(), it.second.end(), g);
+            std::shuffle(it.second.begin(), it.second.end(), rng_);
             if (it.second.size() <  minSize) {
                 minSize = it.second.size();
             }
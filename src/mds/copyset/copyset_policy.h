@@ -27,6 +27,7 @@
 #include <set>
 #include <vector>
 #include <memory>
+#include <random>
 #include <iostream>
 #include <cstdint>
 #include <iterator>
@@ -51,6 +52,14 @@ class CopysetPolicy {
         int numCopysets,
         std::vector<Copyset>* out) = 0;
 
+    // GenCopysetByScatterWidth generate copysets for a cluster until the
+    // average scatter width reaches scatterWidth
+    // return: if succeed return true, false if scatterWidth can't be
+    //         reached with maxCopysets copysets
+    virtual bool GenCopysetByScatterWidth(const ClusterInfo& cluster,
+        uint32_t scatterWidth,
+        int maxCopysets,
+        std::vector<Copyset>* out) = 0;
 
     virtual void GetMinCopySetFromScatterWidth(
         int numChunkServers,
@@ -107,6 +116,14 @@ class CopysetZoneShufflePolicy : public CopysetPolicy {
         int numCopysets,
         std::vector<Copyset>* out) override;
 
+    // GenCopysetByScatterWidth generate copysets permutation by permutation,
+    // the scatter width is tracked while generating, so the copysets are
+    // generated only once for a target scatter width
+    bool GenCopysetByScatterWidth(const ClusterInfo& cluster,
+        uint32_t scatterWidth,
+        int maxCopysets,
+        std::vector<Copyset>* out) override;
+
     void GetMinCopySetFromScatterWidth(
         int numChunkServers,
         int scatterWidth,
@@ -126,12 +143,16 @@ class CopysetZoneShufflePolicy : public CopysetPolicy {
 class CopysetPermutationPolicyNXX : public CopysetPermutationPolicy {
  public:
     explicit CopysetPermutationPolicyNXX(const CopysetConstrait &constrait)
-        : CopysetPermutationPolicy(constrait) {}
+        : CopysetPermutationPolicy(constrait), rng_(std::random_device()()) {}
 
     ~CopysetPermutationPolicyNXX() {}
 
     bool permutation(const std::vector<ChunkServerInfo> &serversIn,
             std::vector<ChunkServerInfo> *serversOut) override;
+
+ private:
+    // seeded once, reading random_device for every permutation is slow
+    std::mt19937 rng_;
 };
 
 }  // namespace copyset
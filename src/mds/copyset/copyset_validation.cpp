@@ -26,6 +26,8 @@
 
 #include <set>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <cmath>
 #include <algorithm>
@@ -132,21 +134,18 @@ bool CopysetValidation::ValidateScatterWidth(uint32_t scatterWidth,
 
 void CopysetValidation::CalcScatterWidth(const std::vector<Copyset> &copysets,
     std::map<ChunkServerIdType, uint32_t> *scatterWidthMap) const {
-    for (auto cs : copysets) {
+    // collect the peers of every chunkserver in one pass over the copysets,
+    // instead of scanning all the copysets for every chunkserver
+    std::unordered_map<ChunkServerIdType,
+                       std::unordered_set<ChunkServerIdType>> peers;
+    for (const auto &cs : copysets) {
         for (auto csId : cs.replicas) {
-            scatterWidthMap->emplace(csId, 0);
+            peers[csId].insert(cs.replicas.begin(), cs.replicas.end());
         }
     }
-    std::set<ChunkServerIdType> collector;
-    for (auto &pair : *scatterWidthMap) {
-        collector.clear();
-        for (auto cs : copysets) {
-            if (cs.replicas.count(pair.first) != 0) {
-                collector.insert(cs.replicas.begin(), cs.replicas.end());
-            }
-        }
+    for (const auto &pair : peers) {
         // scatterWidth -1 is for excluding one of the copy itself
-        pair.second = collector.size() - 1;
+        scatterWidthMap->emplace(pair.first, pair.second.size() - 1);
     }
 }
 
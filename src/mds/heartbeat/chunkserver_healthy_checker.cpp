@@ -37,8 +37,21 @@ namespace mds {
 namespace heartbeat {
 void ChunkserverHealthyChecker::CheckHeartBeatInterval() {
     ::curve::common::WriteLockGuard lk(hbinfoLock_);
-    auto iter = heartbeatInfos_.begin();
-    while (iter != heartbeatInfos_.end()) {
+    // the chunkservers due to check, in the order of chunkserver id
+    std::set<ChunkServerIdType> dues;
+    steady_clock::time_point now = steady_clock::now();
+    auto due = checkQueue_.begin();
+    while (due != checkQueue_.end() && due->first <= now) {
+        dues.emplace(due->second);
+        due = checkQueue_.erase(due);
+    }
+
+    for (auto id : dues) {
+        auto iter = heartbeatInfos_.find(id);
+        if (iter == heartbeatInfos_.end()) {
+            continue;
+        }
+
         // Check whether status need to be updated
         OnlineState newState;
         bool needUpdate = ChunkServerStateNeedUpdate(iter->second, &newState);
@@ -53,13 +66,25 @@ void ChunkserverHealthyChecker::CheckHeartBeatInterval() {
         // Function usually called when a disk need to be switched
         bool iterNeedMove = TrySetChunkServerRetiredIfNeed(iter->second);
         if (iterNeedMove) {
-            iter = heartbeatInfos_.erase(iter);
+            heartbeatInfos_.erase(iter);
         } else {
-            iter++;
+            UpdateNextCheckTimeLocked(&iter->second);
         }
     }
 }
 
+void ChunkserverHealthyChecker::UpdateNextCheckTimeLocked(
+    HeartbeatInfo *info) {
+    steady_clock::time_point next = steady_clock::time_point::min();
+    if (OnlineState::ONLINE == info->state) {
+        next = info->lastReceivedTime +
+               milliseconds(option_.heartbeatMissTimeOutMs);
+    }
+    checkQueue_.erase({info->nextCheckTime, info->csId});
+    info->nextCheckTime = next;
+    checkQueue_.emplace(next, info->csId);
+}
+
 bool ChunkserverHealthyChecker::ChunkServerStateNeedUpdate(
     const HeartbeatInfo &info, OnlineState *newState) {
     // time interval since last heartbeat arrived
@@ -103,12 +128,14 @@ bool ChunkserverHealthyChecker::ChunkServerStateNeedUpdate(
 void ChunkserverHealthyChecker::UpdateLastReceivedHeartbeatTime(
     ChunkServerIdType csId, const steady_clock::time_point &time) {
     ::curve::common::WriteLockGuard lk(hbinfoLock_);
-    if (heartbeatInfos_.find(csId) == heartbeatInfos_.end()) {
-        heartbeatInfos_.emplace(
-            csId, HeartbeatInfo(csId, time, OnlineState::UNSTABLE));
-        return;
+    auto iter = heartbeatInfos_.find(csId);
+    if (iter == heartbeatInfos_.end()) {
+        iter = heartbeatInfos_.emplace(
+            csId, HeartbeatInfo(csId, time, OnlineState::UNSTABLE)).first;
+    } else {
+        iter->second.lastReceivedTime = time;
     }
-    heartbeatInfos_[csId].lastReceivedTime = time;
+    UpdateNextCheckTimeLocked(&iter->second);
 }
 
 bool ChunkserverHealthyChecker::GetHeartBeatInfo(
@@ -26,6 +26,8 @@
 #include <chrono> //NOLINT
 #include <memory>
 #include <map>
+#include <set>
+#include <utility>
 #include "src/mds/common/mds_define.h"
 #include "src/mds/topology/topology.h"
 #include "proto/topology.pb.h"
@@ -85,6 +87,9 @@ struct HeartbeatInfo {
     ChunkServerIdType csId;
     steady_clock::time_point lastReceivedTime;
     OnlineState state;
+    // when to check the state again, the online chunkservers are checked
+    // when the heartbeat misses, the others in every check
+    steady_clock::time_point nextCheckTime;
 };
 
 class ChunkserverHealthyChecker {
@@ -121,6 +126,8 @@ class ChunkserverHealthyChecker {
      *     If current-time - last-heartbeat-received-time > offLineTimeOut_:
      *         Set OnlineFlag to false and update OnlineState to OFFLINE in
      *         topology, then alarm
+     * Only the chunkservers due to check are visited, that is the online
+     * ones whose heartbeat is missed and the ones not online
      */
     void CheckHeartBeatInterval();
 
@@ -136,12 +143,18 @@ class ChunkserverHealthyChecker {
 
     bool TrySetChunkServerRetiredIfNeed(const HeartbeatInfo &info);
 
+    // move the chunkserver in checkQueue_ according to its state
+    void UpdateNextCheckTimeLocked(HeartbeatInfo *info);
+
  private:
     HeartbeatOption option_;
     std::shared_ptr<Topology> topo_;
 
     mutable RWLock hbinfoLock_;
     std::map<ChunkServerIdType, HeartbeatInfo> heartbeatInfos_;
+    // chunkservers ordered by the next check time
+    std::set<std::pair<steady_clock::time_point, ChunkServerIdType>>
+        checkQueue_;
 };
 
 }  // namespace heartbeat
@@ -119,8 +119,64 @@ void HeartbeatManager::UpdateChunkServerDiskStatus(
     }
 }
 
+void HeartbeatManager::ConvertReportedCopySet(
+    const ChunkServerHeartbeatRequest &request,
+    const ::curve::mds::heartbeat::CopySetInfo &info,
+    ReportedCopySet *out) {
+    out->changed = true;
+    // convert copysetInfo from heartbeat format to topology format
+    out->valid = FromHeartbeatCopySetInfoToTopologyOne(info, &out->info);
+    if (!out->valid) {
+        LOG(ERROR) << "heartbeatManager receive copyset("
+                   << info.logicalpoolid() << ","
+                   << info.copysetid()
+                   << ") information, but can not transfer to topology one";
+    }
+    if (info.has_configchangeinfo()) {
+        out->configChangeInfo = info.configchangeinfo();
+    } else {
+        out->configChangeInfo.Clear();
+    }
+
+    CopysetStat &cstat = out->stat;
+    cstat = CopysetStat();
+    cstat.logicalPoolId = info.logicalpoolid();
+    cstat.copysetId = info.copysetid();
+
+    // TODO(xuchaojie): use id instead when new protocol supported
+    std::string leaderPeer = info.leaderpeer().address();
+    std::string leaderIp;
+    uint32_t leaderPort;
+    if (SplitPeerId(leaderPeer, &leaderIp, &leaderPort)) {
+        cstat.leader =
+            topology_->FindChunkServerNotRetired(leaderIp, leaderPort);
+        if (UNINTIALIZE_ID == cstat.leader) {
+            LOG(INFO) << "hearbeat receive from chunkserver(id:"
+                << request.chunkserverid()
+                << ",ip:"<< request.ip() << ",port:" << request.port()
+                << "), in which copyset(" << cstat.logicalPoolId
+                << "," << cstat.copysetId << ") dose not have leader.";
+        }
+    } else {
+        LOG(ERROR) << "hearbeat failed on SplitPeerId, "
+                   << "peerId string = " << leaderPeer;
+    }
+    if (info.has_stats()) {
+        cstat.readRate = info.stats().readrate();
+        cstat.writeRate = info.stats().writerate();
+        cstat.readIOPS = info.stats().readiops();
+        cstat.writeIOPS = info.stats().writeiops();
+    } else if (request.has_stats()) {
+        LOG(WARNING) << "hearbeat manager receive request "
+                     << "copyset {" << cstat.logicalPoolId
+                     << ", " << cstat.copysetId << "} "
+                     << "do not have CopysetStatistics";
+    }
+}
+
 void HeartbeatManager::UpdateChunkServerStatistics(
-    const ChunkServerHeartbeatRequest &request) {
+    const ChunkServerHeartbeatRequest &request,
+    const std::map<CopySetKey, ReportedCopySet> &copysets) {
     ChunkServerStat stat;
     stat.leaderCount = request.leadercount();
     stat.copysetCount = request.copysetcount();
@@ -142,45 +198,10 @@ void HeartbeatManager::UpdateChunkServerStatistics(
                 request.stats().chunkfilepoolformatpercent();  // NOLINT
         }
 
-        for (int i = 0; i < request.copysetinfos_size(); i++) {
-            CopysetStat cstat;
-            cstat.logicalPoolId = request.copysetinfos(i).logicalpoolid();
-            cstat.copysetId = request.copysetinfos(i).copysetid();
-
-            // TODO(xuchaojie): use id instead when new protocol supported
-            std::string leaderPeer =
-                request.copysetinfos(i).leaderpeer().address();
-            std::string leaderIp;
-            uint32_t leaderPort;
-            if (SplitPeerId(leaderPeer, &leaderIp, &leaderPort)) {
-                cstat.leader =
-                    topology_->FindChunkServerNotRetired(
-                    leaderIp, leaderPort);
-                if (UNINTIALIZE_ID == cstat.leader) {
-                    LOG(INFO) << "hearbeat receive from chunkserver(id:"
-                        << request.chunkserverid()
-                        << ",ip:"<< request.ip() << ",port:" << request.port()
-                        << "), in which copyset(" << cstat.logicalPoolId
-                        << "," << cstat.copysetId << ") dose not have leader.";
-                }
-            } else {
-                LOG(ERROR) << "hearbeat failed on SplitPeerId, "
-                           << "peerId string = " << leaderPeer;
-            }
-            if (request.copysetinfos(i).has_stats()) {
-                cstat.readRate = request.copysetinfos(i).stats().readrate();
-                cstat.writeRate = request.copysetinfos(i).stats().writerate();
-                cstat.readIOPS = request.copysetinfos(i).stats().readiops();
-                cstat.writeIOPS = request.copysetinfos(i).stats().writeiops();
-            } else {
-                LOG(WARNING) << "hearbeat manager receive request "
-                             << "copyset {" << cstat.logicalPoolId
-                             << ", " << cstat.copysetId << "} "
-                             << "do not have CopysetStatistics";
-            }
-            stat.copysetStats.push_back(cstat);
+        stat.copysetStats.reserve(copysets.size());
+        for (const auto &item : copysets) {
+            stat.copysetStats.push_back(item.second.stat);
         }
-
     } else {
         LOG(WARNING) << "hearbeat manager receive request "
                      << "do not have ChunkServerStatisticInfo";
@@ -188,6 +209,16 @@ void HeartbeatManager::UpdateChunkServerStatistics(
     topologyStat_->UpdateChunkServerStat(request.chunkserverid(), stat);
 }
 
+std::shared_ptr<HeartbeatManager::ChunkServerReport>
+HeartbeatManager::GetChunkServerReport(ChunkServerIdType csId) {
+    ::curve::common::LockGuard lk(reportsMtx_);
+    auto &report = reports_[csId];
+    if (report == nullptr) {
+        report = std::make_shared<ChunkServerReport>();
+    }
+    return report;
+}
+
 void HeartbeatManager::ChunkServerHeartbeat(
     const ChunkServerHeartbeatRequest &request,
     ChunkServerHeartbeatResponse *response) {
@@ -212,31 +243,69 @@ void HeartbeatManager::ChunkServerHeartbeat(
 
     UpdateChunkServerDiskStatus(request);
 
-    UpdateChunkServerStatistics(request);
+    // the copysets are kept only if the chunkserver sends delta heartbeats
+    std::shared_ptr<ChunkServerReport> report;
+    if (request.has_seq()) {
+        report = GetChunkServerReport(request.chunkserverid());
+    } else {
+        {
+            ::curve::common::LockGuard lk(reportsMtx_);
+            reports_.erase(request.chunkserverid());
+        }
+        report = std::make_shared<ChunkServerReport>();
+    }
+    ::curve::common::LockGuard lk(report->mtx);
+
+    auto &copysets = report->copysets;
+    bool isDelta = request.has_baseseq() && request.baseseq() != 0;
+    // the delta is based on a heartbeat which is not kept, e.g. mds restarted
+    bool partial = isDelta && request.baseseq() != report->seq;
+    if (!isDelta || partial) {
+        copysets.clear();
+    }
+    for (auto &value : request.copysetinfos()) {
+        CopySetKey key(value.logicalpoolid(), value.copysetid());
+        ConvertReportedCopySet(request, value, &copysets[key]);
+    }
+    if (isDelta && !partial) {
+        for (auto &key : request.removedcopysets()) {
+            copysets.erase(CopySetKey(key.logicalpoolid(), key.copysetid()));
+        }
+    }
+    if (partial) {
+        LOG(INFO) << "heartbeatManager receive delta heartbeat from "
+                  << "chunkserver " << request.chunkserverid()
+                  << " based on seq " << request.baseseq()
+                  << ", but the copysets are of seq " << report->seq
+                  << ", ask for a full one";
+        report->seq = 0;
+    } else if (request.has_seq()) {
+        report->seq = request.seq();
+        response->set_baseseq(request.seq());
+    }
+
+    UpdateChunkServerStatistics(request, copysets);
 
     UpdateChunkServerVersion(request);
 
     // no copyset info in the request
-    if (request.copysetinfos_size() == 0) {
+    if (copysets.empty() && !partial) {
         response->set_statuscode(HeartbeatStatusCode::hbRequestNoCopyset);
     }
-    // dealing with copysets included in the heartbeat request
-    for (auto &value : request.copysetinfos()) {
+    // dealing with copysets on the chunkserver
+    for (auto &item : copysets) {
+        ReportedCopySet &reported = item.second;
+        bool changed = reported.changed;
+        reported.changed = false;
+
         // discard copysets of invalid logical pool
         ::curve::mds::topology::LogicalPool lPool;
-        if (topology_->GetLogicalPool(value.logicalpoolid(), &lPool)) {
+        if (topology_->GetLogicalPool(item.first.first, &lPool)) {
             if (lPool.GetLogicalPoolAvaliableFlag() != true) {
                 continue;
             }
         }
-        // convert copysetInfo from heartbeat format to topology format
-        ::curve::mds::topology::CopySetInfo reportCopySetInfo;
-        if (!FromHeartbeatCopySetInfoToTopologyOne(value,
-                &reportCopySetInfo)) {
-            LOG(ERROR) << "heartbeatManager receive copyset("
-                       << value.logicalpoolid() << ","
-                       << value.copysetid()
-                       << ") information, but can not transfer to topology one";
+        if (!reported.valid) {
             response->set_statuscode(
                             HeartbeatStatusCode::hbAnalyseCopysetError);
             continue;
@@ -244,18 +313,18 @@ void HeartbeatManager::ChunkServerHeartbeat(
 
         // forward reported copyset info to CopysetConfGenerator
         CopySetConf conf;
-        ConfigChangeInfo configChInfo;
         if (copysetConfGenerator_->GenCopysetConf(
-                request.chunkserverid(), reportCopySetInfo,
-                value.configchangeinfo(), &conf)) {
+                request.chunkserverid(), reported.info,
+                reported.configChangeInfo, &conf)) {
             CopySetConf *res = response->add_needupdatecopysets();
             *res = conf;
         }
 
         // if a copyset is the leader, update (e.g. epoch) topology according
-        // to its info
-        if (request.chunkserverid() == reportCopySetInfo.GetLeader()) {
-            topoUpdater_->UpdateTopo(reportCopySetInfo);
+        // to its info, unchanged ones have been updated when reported
+        if (changed &&
+            request.chunkserverid() == reported.info.GetLeader()) {
+            topoUpdater_->UpdateTopo(reported.info);
         }
     }
 }
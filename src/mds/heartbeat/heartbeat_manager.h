@@ -28,6 +28,7 @@
 #include <atomic>
 #include <string>
 #include <memory>
+#include <unordered_map>
 
 #include "src/mds/topology/topology.h"
 #include "src/mds/common/mds_define.h"
@@ -41,6 +42,8 @@
 #include "src/mds/topology/topology_stat.h"
 
 using ::curve::mds::topology::CopySetInfo;
+using ::curve::mds::topology::CopySetKey;
+using ::curve::mds::topology::CopysetStat;
 using ::curve::mds::topology::PoolIdType;
 using ::curve::mds::topology::CopySetIdType;
 using ::curve::mds::topology::Topology;
@@ -70,6 +73,12 @@ namespace heartbeat {
 // 3. update topology information
 //    - update epoch, copy relationship and other statistical data of topology
 //      according to the copyset information reported by the chunkserver
+//
+// A chunkserver may send delta heartbeats, which only carry the copysets
+// changed since a previous heartbeat acknowledged by the response. The
+// copysets last reported by each chunkserver are kept in converted form, the
+// unchanged ones are still passed to CopysetConfGenerator for operators to be
+// dispatched, but not converted or updated to topology again.
 
 class HeartbeatManager {
  public:
@@ -111,6 +120,39 @@ class HeartbeatManager {
                                 ChunkServerHeartbeatResponse *response);
 
  private:
+    // a copyset reported by a chunkserver
+    struct ReportedCopySet {
+        // whether it is converted to topology format successfully
+        bool valid = false;
+        // whether it is reported by the heartbeat being processed
+        bool changed = false;
+        ::curve::mds::topology::CopySetInfo info;
+        ConfigChangeInfo configChangeInfo;
+        CopysetStat stat;
+    };
+
+    // copysets last reported by a chunkserver
+    struct ChunkServerReport {
+        ::curve::common::Mutex mtx;
+        // seq of the heartbeat the copysets are up to date with, 0 if none
+        uint64_t seq = 0;
+        std::map<CopySetKey, ReportedCopySet> copysets;
+    };
+
+    std::shared_ptr<ChunkServerReport> GetChunkServerReport(
+        ChunkServerIdType csId);
+
+    /**
+     * @brief Convert a copyset reported by the chunkserver
+     *
+     * @param request Heartbeat request
+     * @param info Copyset info in the request
+     * @param[out] out Converted copyset
+     */
+    void ConvertReportedCopySet(const ChunkServerHeartbeatRequest &request,
+        const ::curve::mds::heartbeat::CopySetInfo &info,
+        ReportedCopySet *out);
+
     /**
      * @brief Update disk status data of chunkserver
      *
@@ -123,9 +165,11 @@ class HeartbeatManager {
      * @brief Update statistical data of chunkserver
      *
      * @param request Heartbeat request
+     * @param copysets Copysets on the chunkserver
      */
     void UpdateChunkServerStatistics(
-        const ChunkServerHeartbeatRequest &request);
+        const ChunkServerHeartbeatRequest &request,
+        const std::map<CopySetKey, ReportedCopySet> &copysets);
 
     /**
      * @brief Update version of chunkserver
@@ -195,6 +239,10 @@ class HeartbeatManager {
     Atomic<bool> isStop_;
     InterruptibleSleeper sleeper_;
     int chunkserverHealthyCheckerRunInter_;
+
+    ::curve::common::Mutex reportsMtx_;
+    std::unordered_map<ChunkServerIdType,
+        std::shared_ptr<ChunkServerReport>> reports_;
 };
 
 }  // namespace heartbeat
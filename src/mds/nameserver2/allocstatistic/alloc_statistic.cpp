@@ -24,7 +24,9 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "proto/nameserver2.pb.h"
@@ -37,9 +39,17 @@
 using ::curve::common::Thread;
 using ::curve::common::ReadLockGuard;
 using ::curve::common::WriteLockGuard;
+using ::curve::common::SEGMENTALLOCEXACTKEY;
+using ::curve::common::SEGMENTALLOCLOGKEYPREFIX;
+using ::curve::common::SEGMENTALLOCLOGKEYEND;
 
 namespace curve {
 namespace mds {
+
+// number of change log entries folded in one txn, the puts and deletes in the
+// txn must not exceed the default --max-txn-ops of etcd
+const int FOLDBUNDLE = 64;
+
 int AllocStatistic::Init() {
     // get the current revision
     int res = client_->GetCurrentRevision(&curRevision_);
@@ -50,7 +60,47 @@ int AllocStatistic::Init() {
 
     res = AllocStatisticHelper::GetExistSegmentAllocValues(
         &existSegmentAllocValues_, client_);
-    return res;
+    if (res != 0) {
+        return res;
+    }
+
+    if (!changeLog_) {
+        // the persisted value will be overwritten by the value in memory,
+        // re-enabling the change log needs a full scan again
+        res = client_->Delete(SEGMENTALLOCEXACTKEY);
+        if (res != EtcdErrCode::EtcdOK && res != EtcdErrCode::EtcdKeyNotExist) {
+            LOG(ERROR) << "delete segment alloc exact key fail, errCode: "
+                       << res;
+            return -1;
+        }
+        return 0;
+    }
+
+    std::string value;
+    res = client_->Get(SEGMENTALLOCEXACTKEY, &value);
+    if (res == EtcdErrCode::EtcdKeyNotExist) {
+        LOG(INFO) << "segment alloc is not exact, calculate it from segments";
+        return 0;
+    } else if (res != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "get segment alloc exact key fail, errCode: " << res;
+        return -1;
+    }
+
+    // no need to scan segments, the persisted value plus change log is exact
+    std::map<PoolIdType, int64_t> alloc;
+    res = AllocStatisticHelper::GetSegmentAllocWithLog(
+        curRevision_, client_, &alloc);
+    if (res != 0) {
+        return res;
+    }
+    persisted_ = existSegmentAllocValues_;
+    segmentAlloc_ = std::move(alloc);
+    exact_.store(true);
+    segmentAllocFromEtcdOK_.store(true);
+    currentValueAvalible_.store(true);
+    LOG(INFO) << "get segment alloc from change log at revision "
+              << curRevision_ << " ok";
+    return 0;
 }
 
 void AllocStatistic::Run() {
@@ -131,15 +181,20 @@ void AllocStatistic::DeAllocSpace(
 }
 
 void AllocStatistic::CalculateSegmentAlloc() {
+    if (exact_.load()) {
+        VerifySegmentAlloc();
+        return;
+    }
+
     // get the alloc data before revision from Etcd
     int res;
     do {
-        res =  AllocStatisticHelper::CalculateSegmentAlloc(
-            curRevision_, client_, &segmentAlloc_);
+        res = CalculateSegmentAllocOnce(curRevision_, &segmentAlloc_);
     } while (HandleResult(res));
 
     LOG(INFO) << "calculate segment alloc revision not bigger than "
               << curRevision_ << " ok";
+    std::map<PoolIdType, int64_t> scanned = segmentAlloc_;
     // set fetch data from etcd success
     segmentAllocFromEtcdOK_.store(true);
 
@@ -151,6 +206,125 @@ void AllocStatistic::CalculateSegmentAlloc() {
 
     // set segmentAlloc_available
     currentValueAvalible_.store(true);
+
+    if (!changeLog_) {
+        return;
+    }
+
+    // initialize the persisted value, the value in memory is already exact
+    while (!CorrectSegmentAlloc(curRevision_, scanned, false)) {
+        if (!sleeper_.wait_for(std::chrono::milliseconds(retryInterMs_))) {
+            return;
+        }
+    }
+    VerifySegmentAlloc();
+}
+
+int AllocStatistic::CalculateSegmentAllocOnce(
+    int64_t revision, std::map<PoolIdType, int64_t> *out) {
+    int res = AllocStatisticHelper::CalculateSegmentAlloc(
+        revision, client_, out);
+    if (res == 0 && changeLog_) {
+        res = AllocStatisticHelper::CalculateDiscardSegmentAlloc(
+            revision, client_, out);
+    }
+    return res;
+}
+
+void AllocStatistic::VerifySegmentAlloc() {
+    if (verifyInterSec_ == 0) {
+        return;
+    }
+
+    while (sleeper_.wait_for(std::chrono::seconds(verifyInterSec_))) {
+        int64_t revision;
+        int res = client_->GetCurrentRevision(&revision);
+        if (EtcdErrCode::EtcdOK != res) {
+            LOG(ERROR) << "get current revision fail, errCode: " << res;
+            continue;
+        }
+
+        std::map<PoolIdType, int64_t> scanned;
+        if (CalculateSegmentAllocOnce(revision, &scanned) != 0) {
+            LOG(ERROR) << "verify segment alloc at revision " << revision
+                       << " fail, retry later";
+            continue;
+        }
+        CorrectSegmentAlloc(revision, scanned, true);
+    }
+}
+
+bool AllocStatistic::CorrectSegmentAlloc(
+    int64_t revision, const std::map<PoolIdType, int64_t> &scanned,
+    bool applyToMemory) {
+    std::map<PoolIdType, int64_t> expected;
+    if (AllocStatisticHelper::GetSegmentAllocWithLog(
+            revision, client_, &expected) != 0) {
+        LOG(ERROR) << "get segment alloc with change log at revision "
+                   << revision << " fail";
+        return false;
+    }
+
+    std::map<PoolIdType, int64_t> diffs;
+    for (const auto &item : scanned) {
+        diffs[item.first] += item.second;
+    }
+    for (const auto &item : expected) {
+        diffs[item.first] -= item.second;
+    }
+
+    // a correction is logged as an ordinary change, keys with term 0 never
+    // conflict with the ones of NameServerStorageImp
+    std::vector<std::pair<std::string, std::string>> kvs;
+    uint64_t seq = static_cast<uint64_t>(revision) << 16;
+    for (const auto &item : diffs) {
+        if (item.second == 0) {
+            continue;
+        }
+        if (exact_.load()) {
+            LOG(WARNING) << "segment alloc of logicalPool " << item.first
+                         << " differs from the segments at revision "
+                         << revision << " by " << item.second
+                         << ", correct it";
+        }
+        kvs.emplace_back(
+            NameSpaceStorageCodec::EncodeSegmentAllocLogKey(0, seq++),
+            NameSpaceStorageCodec::EncodeSegmentAllocLogValue(item.first,
+                                                              item.second));
+    }
+    if (!exact_.load()) {
+        kvs.emplace_back(SEGMENTALLOCEXACTKEY, std::to_string(revision));
+    }
+    if (kvs.empty()) {
+        LOG(INFO) << "verify segment alloc at revision " << revision << " ok";
+        return true;
+    }
+
+    std::vector<Operation> ops;
+    for (const auto &kv : kvs) {
+        ops.push_back(Operation{OpType::OpPut,
+                                const_cast<char *>(kv.first.c_str()),
+                                const_cast<char *>(kv.second.c_str()),
+                                static_cast<int>(kv.first.size()),
+                                static_cast<int>(kv.second.size())});
+    }
+    int64_t txnRevision;
+    int res = client_->TxnNWithRevision(ops, &txnRevision);
+    if (EtcdErrCode::EtcdOK != res) {
+        LOG(ERROR) << "correct segment alloc at revision " << revision
+                   << " fail, errCode: " << res;
+        return false;
+    }
+
+    if (applyToMemory) {
+        WriteLockGuard guard(segmentAllocLock_);
+        for (const auto &item : diffs) {
+            segmentAlloc_[item.first] += item.second;
+        }
+    }
+    exact_.store(true);
+    LOG(INFO) << "correct segment alloc at revision " << revision << " ok";
+    return true;
 }
 
 bool AllocStatistic::HandleResult(int res) {
@@ -184,6 +358,14 @@ void AllocStatistic::PeriodicPersist() {
     std::map<PoolIdType, int64_t> lastPersist;
     while (sleeper_.wait_for(
         std::chrono::milliseconds(periodicPersistInterMs_))) {
+        // the value in memory may be not exact, only fold the change log
+        if (changeLog_) {
+            if (exact_.load()) {
+                FoldSegmentAllocLog();
+            }
+            continue;
+        }
+
         std::map<PoolIdType, int64_t> curPersist = GetLatestSegmentAllocInfo();
         if (true == curPersist.empty()) {
             continue;
@@ -220,6 +402,69 @@ void AllocStatistic::PeriodicPersist() {
     lastPersist.clear();
 }
 
+void AllocStatistic::FoldSegmentAllocLog() {
+    std::vector<std::pair<std::string, std::string>> logs;
+    int res = client_->List(SEGMENTALLOCLOGKEYPREFIX, SEGMENTALLOCLOGKEYEND,
+                            &logs);
+    if (EtcdErrCode::EtcdOK != res) {
+        LOG(ERROR) << "list segment alloc change log fail, errCode: " << res;
+        return;
+    }
+
+    for (size_t start = 0; start < logs.size(); start += FOLDBUNDLE) {
+        size_t end = std::min(logs.size(), start + FOLDBUNDLE);
+        std::map<PoolIdType, int64_t> folded;
+        for (size_t i = start; i < end; i++) {
+            PoolIdType lid;
+            int64_t change;
+            if (!NameSpaceStorageCodec::DecodeSegmentAllocLogValue(
+                    logs[i].second, &lid, &change)) {
+                return;
+            }
+            auto iter = folded.emplace(lid, persisted_[lid]).first;
+            iter->second += change;
+        }
+
+        std::vector<std::pair<std::string, std::string>> kvs;
+        for (const auto &item : folded) {
+            kvs.emplace_back(
+                NameSpaceStorageCodec::EncodeSegmentAllocKey(item.first),
+                NameSpaceStorageCodec::EncodeSegmentAllocValue(
+                    item.first, item.second));
+        }
+        std::vector<Operation> ops;
+        for (const auto &kv : kvs) {
+            ops.push_back(Operation{OpType::OpPut,
+                                    const_cast<char *>(kv.first.c_str()),
+                                    const_cast<char *>(kv.second.c_str()),
+                                    static_cast<int>(kv.first.size()),
+                                    static_cast<int>(kv.second.size())});
+        }
+        for (size_t i = start; i < end; i++) {
+            ops.push_back(Operation{OpType::OpDelete,
+                                    const_cast<char *>(logs[i].first.c_str()),
+                                    const_cast<char *>(""),
+                                    static_cast<int>(logs[i].first.size()),
+                                    0});
+        }
+
+        int64_t revision;
+        res = client_->TxnNWithRevision(ops, &revision);
+        if (EtcdErrCode::EtcdOK != res) {
+            LOG(ERROR) << "fold segment alloc change log fail, errCode: "
+                       << res;
+            return;
+        }
+        for (const auto &item : folded) {
+            persisted_[item.first] = item.second;
+        }
+    }
+
+    if (!logs.empty()) {
+        LOG(INFO) << "fold " << logs.size() << " segment alloc change log";
+    }
+}
+
 void AllocStatistic::DoMerge() {
     // combine the alloc data before and after the revision
     std::set<PoolIdType> logicalPools = GetCurrentLogicalPools();
@@ -62,6 +62,14 @@ using ::curve::kvstorage::EtcdClientImp;
  * provide segment allocation data according to current statistical status:
  * 1. If all of part1 are completed, get data from mergeMap_
  * 2. If part1 is not completed, get data from existSegmentAllocValues_
+ *
+ * If the change log is enabled, every segment alloc and dealloc puts a log
+ * entry in the same etcd txn as the segment (see NameServerStorageImp), and
+ * part2 folds the log into the persisted value of each logicalPool instead of
+ * persisting the value in memory. The persisted value plus the log is then
+ * exact, so mds gets the allocation from them at startup without scanning
+ * all segments. The full scan only runs once to initialize the persisted
+ * value, and then periodically to verify and correct it.
  */
 
 class AllocStatistic {
@@ -75,12 +83,19 @@ class AllocStatistic {
      * @param[in] retryInterMs Retry time interval after the failure of getting
      *                         segment of the specified revision from Etcd
      * @param[in] client Etcd client
+     * @param[in] changeLog Whether segment alloc is recorded in the change
+     *                      log, must be the same as NameServerStorageImp
+     * @param[in] verifyInterSec Time interval for verifying the persisted
+     *                           value with a full scan, 0 means never
      */
     AllocStatistic(uint64_t periodicPersistInterMs, uint64_t retryInterMs,
-                   std::shared_ptr<EtcdClientImp> client)
+                   std::shared_ptr<EtcdClientImp> client,
+                   bool changeLog = false, uint64_t verifyInterSec = 0)
         : client_(client), segmentAllocFromEtcdOK_(false),
           currentValueAvalible_(false), retryInterMs_(retryInterMs),
-          periodicPersistInterMs_(periodicPersistInterMs), stop_(true) {}
+          periodicPersistInterMs_(periodicPersistInterMs),
+          changeLog_(changeLog), verifyInterSec_(verifyInterSec),
+          exact_(false), stop_(true) {}
 
     ~AllocStatistic() { Stop(); }
 
@@ -143,12 +158,47 @@ class AllocStatistic {
      */
     void CalculateSegmentAlloc();
 
+    /**
+     * @brief CalculateSegmentAllocOnce Get all the segment records of the
+     *                                  specified revision from Etcd, include
+     *                                  the discarded ones if log is enabled
+     */
+    int CalculateSegmentAllocOnce(int64_t revision,
+                                  std::map<PoolIdType, int64_t> *out);
+
     /**
      * @brief PeriodicPersist Periodically persist the allocated segment size
      *                        data under each logicalPool in memory
      */
     void PeriodicPersist();
 
+    /**
+     * @brief FoldSegmentAllocLog Add the change log to the persisted value
+     *                            and remove it in the same txn
+     */
+    void FoldSegmentAllocLog();
+
+    /**
+     * @brief VerifySegmentAlloc Periodically compare the persisted value plus
+     *                           change log with a full scan of segments
+     */
+    void VerifySegmentAlloc();
+
+    /**
+     * @brief CorrectSegmentAlloc Put the difference between the scanned
+     *                            allocation and persisted value plus change
+     *                            log at revision into the change log
+     *
+     * @param[in] revision Revision of the scan
+     * @param[in] scanned Allocation of each logicalPool at revision
+     * @param[in] applyToMemory Whether the value in memory needs correction
+     *
+     * @return true if succeeded
+     */
+    bool CorrectSegmentAlloc(int64_t revision,
+                             const std::map<PoolIdType, int64_t> &scanned,
+                             bool applyToMemory);
+
     /**
      * @brief HandleResult Dealing with the situation that error occur when
      *                     obtaining all segment records of specified revision
@@ -221,6 +271,18 @@ class AllocStatistic {
     // Persistence interval in ms
     uint64_t periodicPersistInterMs_;
 
+    // whether the change log of segment alloc is enabled
+    const bool changeLog_;
+
+    // verification interval in s
+    const uint64_t verifyInterSec_;
+
+    // persisted value plus change log is exact, the log can be folded
+    Atomic<bool> exact_;
+
+    // persisted value of each logicalPool, only accessed by folding
+    std::map<PoolIdType, int64_t> persisted_;
+
     // When stop_ is true, stop the persistent thread and the statistical
     // thread that counts the segment allocation in Etcd
     Atomic<bool> stop_;
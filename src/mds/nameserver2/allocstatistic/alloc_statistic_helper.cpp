@@ -36,6 +36,10 @@ using ::curve::common::SEGMENTALLOCSIZEKEY;
 using ::curve::common::SEGMENTALLOCSIZEKEYEND;
 using ::curve::common::SEGMENTINFOKEYEND;
 using ::curve::common::SEGMENTINFOKEYPREFIX;
+using ::curve::common::SEGMENTALLOCLOGKEYPREFIX;
+using ::curve::common::SEGMENTALLOCLOGKEYEND;
+using ::curve::common::DISCARDSEGMENTKEYPREFIX;
+using ::curve::common::DISCARDSEGMENTKEYEND;
 const int GETBUNDLE = 1000;
 int AllocStatisticHelper::GetExistSegmentAllocValues(
     std::map<PoolIdType, int64_t> *out,
@@ -72,7 +76,82 @@ int AllocStatisticHelper::CalculateSegmentAlloc(
               << ", bundle size: " << GETBUNDLE;
     uint64_t startTime = ::curve::common::TimeUtility::GetTimeofDayMs();
 
-    std::string startKey = SEGMENTINFOKEYPREFIX;
+    int res = ListWithRevision(
+        SEGMENTINFOKEYPREFIX, SEGMENTINFOKEYEND, revision, client,
+        [out](const std::string &value) {
+            PageFileSegment segment;
+            if (!NameSpaceStorageCodec::DecodeSegment(value, &segment)) {
+                LOG(ERROR) << "decode segment item{" << value << "} fail";
+                return false;
+            }
+            (*out)[segment.logicalpoolid()] += segment.segmentsize();
+            return true;
+        });
+    if (res != 0) {
+        return res;
+    }
+
+    LOG(INFO) << "calculate segment alloc ok, time spend: "
+              << (::curve::common::TimeUtility::GetTimeofDayMs() - startTime)
+              << " ms";
+    return 0;
+}
+
+int AllocStatisticHelper::CalculateDiscardSegmentAlloc(
+    int64_t revision, const std::shared_ptr<EtcdClientImp> &client,
+    std::map<PoolIdType, int64_t> *out) {
+    return ListWithRevision(
+        DISCARDSEGMENTKEYPREFIX, DISCARDSEGMENTKEYEND, revision, client,
+        [out](const std::string &value) {
+            DiscardSegmentInfo info;
+            if (!NameSpaceStorageCodec::DecodeDiscardSegment(value, &info)) {
+                LOG(ERROR) << "decode discard segment fail";
+                return false;
+            }
+            (*out)[info.pagefilesegment().logicalpoolid()] +=
+                info.pagefilesegment().segmentsize();
+            return true;
+        });
+}
+
+int AllocStatisticHelper::GetSegmentAllocWithLog(
+    int64_t revision, const std::shared_ptr<EtcdClientImp> &client,
+    std::map<PoolIdType, int64_t> *out) {
+    int res = ListWithRevision(
+        SEGMENTALLOCSIZEKEY, SEGMENTALLOCSIZEKEYEND, revision, client,
+        [out](const std::string &value) {
+            PoolIdType lid;
+            uint64_t alloc;
+            if (!NameSpaceStorageCodec::DecodeSegmentAllocValue(value, &lid,
+                                                                &alloc)) {
+                return false;
+            }
+            (*out)[lid] += alloc;
+            return true;
+        });
+    if (res != 0) {
+        return res;
+    }
+
+    return ListWithRevision(
+        SEGMENTALLOCLOGKEYPREFIX, SEGMENTALLOCLOGKEYEND, revision, client,
+        [out](const std::string &value) {
+            PoolIdType lid;
+            int64_t change;
+            if (!NameSpaceStorageCodec::DecodeSegmentAllocLogValue(
+                    value, &lid, &change)) {
+                return false;
+            }
+            (*out)[lid] += change;
+            return true;
+        });
+}
+
+int AllocStatisticHelper::ListWithRevision(
+    const std::string &startKey, const std::string &endKey, int64_t revision,
+    const std::shared_ptr<EtcdClientImp> &client,
+    const std::function<bool(const std::string &)> &visitor) {
+    std::string start = startKey;
     std::vector<std::string> values;
     std::string lastKey;
     do {
@@ -80,43 +159,33 @@ int AllocStatisticHelper::CalculateSegmentAlloc(
         values.clear();
         lastKey.clear();
 
-        // get segments in bundles from Etcd, GETBUNDLE is the number of items
+        // get values in bundles from Etcd, GETBUNDLE is the number of items
         // to fetch
-        int res = client->ListWithLimitAndRevision(startKey, SEGMENTINFOKEYEND,
-                                                   GETBUNDLE, revision, &values,
+        int res = client->ListWithLimitAndRevision(start, endKey, GETBUNDLE,
+                                                   revision, &values,
                                                    &lastKey);
         if (res != EtcdErrCode::EtcdOK) {
-            LOG(ERROR) << "list [" << startKey << "," << SEGMENTINFOKEYEND
+            LOG(ERROR) << "list [" << start << "," << endKey
                        << ") at revision: " << revision
                        << " with bundle: " << GETBUNDLE
                        << " fail, errCode: " << res;
             return -1;
         }
 
-        // decode the obtained value
+        // the first value is the last one of previous bundle
         size_t startPos = 1;
-        if (startKey == SEGMENTINFOKEYPREFIX) {
+        if (start == startKey) {
             startPos = 0;
         }
         for (; startPos < values.size(); startPos++) {
-            PageFileSegment segment;
-            bool res = NameSpaceStorageCodec::DecodeSegment(values[startPos],
-                                                            &segment);
-            if (false == res) {
-                LOG(ERROR) << "decode segment item{" << values[startPos]
-                           << "} fail";
+            if (!visitor(values[startPos])) {
                 return -1;
-            } else {
-                (*out)[segment.logicalpoolid()] += segment.segmentsize();
             }
         }
 
-        startKey = lastKey;
+        start = lastKey;
     } while (values.size() >= GETBUNDLE);
 
-    LOG(INFO) << "calculate segment alloc ok, time spend: "
-              << (::curve::common::TimeUtility::GetTimeofDayMs() - startTime)
-              << " ms";
     return 0;
 }
 }  // namespace mds
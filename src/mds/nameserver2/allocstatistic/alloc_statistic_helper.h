@@ -23,8 +23,10 @@
 #ifndef SRC_MDS_NAMESERVER2_ALLOCSTATISTIC_ALLOC_STATISTIC_HELPER_H_
 #define SRC_MDS_NAMESERVER2_ALLOCSTATISTIC_ALLOC_STATISTIC_HELPER_H_
 
+#include <functional>
 #include <map>
 #include <memory>
+#include <string>
 #include "src/mds/common/mds_define.h"
 #include "src/kvstorageclient/etcd_client.h"
 
@@ -45,6 +47,24 @@ class AllocStatisticHelper {
     static int CalculateSegmentAlloc(
         int64_t revision, const std::shared_ptr<EtcdClientImp> &client,
         std::map<PoolIdType, int64_t> *out);
+
+    // segments in DiscardSegmentTable are allocated until they are cleaned
+    static int CalculateDiscardSegmentAlloc(
+        int64_t revision, const std::shared_ptr<EtcdClientImp> &client,
+        std::map<PoolIdType, int64_t> *out);
+
+    // persisted value of each logicalPool plus its change log at revision
+    static int GetSegmentAllocWithLog(
+        int64_t revision, const std::shared_ptr<EtcdClientImp> &client,
+        std::map<PoolIdType, int64_t> *out);
+
+ private:
+    // visit the values of [startKey, endKey) at revision in bundles,
+    // stop and return -1 if the visitor returns false
+    static int ListWithRevision(
+        const std::string &startKey, const std::string &endKey,
+        int64_t revision, const std::shared_ptr<EtcdClientImp> &client,
+        const std::function<bool(const std::string &)> &visitor);
 };
 }  // namespace mds
 }  // namespace curve
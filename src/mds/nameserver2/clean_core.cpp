@@ -22,6 +22,11 @@
 
 #include "src/mds/nameserver2/clean_core.h"
 
+#include <algorithm>
+#include <map>
+
+#include "src/common/concurrent/concurrent.h"
+
 namespace curve {
 namespace mds {
 StatusCode CleanCore::CleanSnapShotFile(const FileInfo & fileInfo,
@@ -32,49 +37,59 @@ StatusCode CleanCore::CleanSnapShotFile(const FileInfo & fileInfo,
     }
     uint32_t  segmentNum = fileInfo.length() / fileInfo.segmentsize();
     uint64_t segmentSize = fileInfo.segmentsize();
-    for (uint32_t i = 0; i < segmentNum; i++) {
-        // load  segment
-        PageFileSegment segment;
-        StoreStatus storeRet = storage_->GetSegment(fileInfo.parentid(),
-                                                    i * segmentSize,
-                                                    &segment);
-        if (storeRet == StoreStatus::KeyNotExist) {
-            continue;
-        } else if (storeRet !=  StoreStatus::OK) {
-            LOG(ERROR) << "cleanSnapShot File Error: "
-            << "GetSegment Error, inodeid = " << fileInfo.id()
-            << ", filename = " << fileInfo.filename()
-            << ", offset = " << i * segmentSize
-            << ", sequenceNum = " << fileInfo.seqnum();
-            progress->SetStatus(TaskStatus::FAILED);
-            return StatusCode::kSnapshotFileDeleteError;
-        }
 
-        // delete chunks in chunkserver
-        LogicalPoolID logicalPoolID = segment.logicalpoolid();
-        uint32_t chunkNum = segment.chunks_size();
-        for (uint32_t j = 0; j != chunkNum; j++) {
-            // 删除快照时如果chunk不存在快照，则需要修改chunk的correctedSn
-            // 防止删除快照后，后续的写触发chunk的快照
-            // correctSn为创建快照后文件的版本号，也就是快照版本号+1
-            SeqNum correctSn = fileInfo.seqnum() + 1;
+    // 快照文件共享源文件的segment，所以需要使用ParentID进行查找
+    std::vector<PageFileSegment> segments;
+    StoreStatus storeRet = storage_->ListSegment(fileInfo.parentid(),
+                                                 &segments);
+    if (storeRet != StoreStatus::OK) {
+        LOG(ERROR) << "cleanSnapShot File Error: "
+        << "ListSegment Error, inodeid = " << fileInfo.id()
+        << ", filename = " << fileInfo.filename()
+        << ", sequenceNum = " << fileInfo.seqnum();
+        progress->SetStatus(TaskStatus::FAILED);
+        return StatusCode::kSnapshotFileDeleteError;
+    }
+    // 源文件扩容后的segment不属于快照
+    segments.erase(std::remove_if(segments.begin(), segments.end(),
+        [&](const PageFileSegment& segment) {
+            return segment.startoffset() >= segmentNum * segmentSize;
+        }), segments.end());
+
+    // 删除快照时如果chunk不存在快照，则需要修改chunk的correctedSn
+    // 防止删除快照后，后续的写触发chunk的快照
+    // correctSn为创建快照后文件的版本号，也就是快照版本号+1
+    SeqNum correctSn = fileInfo.seqnum() + 1;
+    auto op = [&](const CopysetChunks& copysetChunks) {
+        for (ChunkID chunkId : copysetChunks.chunkIds) {
             int ret = copysetClient_->DeleteChunkSnapshotOrCorrectSn(
-                logicalPoolID,
-                segment.chunks()[j].copysetid(),
-                segment.chunks()[j].chunkid(),
-                correctSn);
+                copysetChunks.logicalPoolId, copysetChunks.copysetId,
+                chunkId, correctSn);
             if (ret != 0) {
-                LOG(ERROR) << "CleanSnapShotFile Error: "
-                    << "DeleteChunkSnapshotOrCorrectSn Error"
-                    << ", ret = " << ret
-                    << ", inodeid = " << fileInfo.id()
-                    << ", filename = " << fileInfo.filename()
-                    << ", correctSn = " << correctSn;
-                progress->SetStatus(TaskStatus::FAILED);
-                return StatusCode::kSnapshotFileDeleteError;
+                return ret;
             }
         }
-        progress->SetProgress(100 * (i+1) / segmentNum);
+        return 0;
+    };
+
+    // 快照的segment不会被删除，任务重新执行时仍需处理所有segment，
+    // DeleteChunkSnapshotOrCorrectSn是幂等的
+    size_t batchSize = std::max<uint32_t>(option_.segmentBatchSize, 1);
+    for (size_t i = 0; i < segments.size(); i += batchSize) {
+        size_t end = std::min(i + batchSize, segments.size());
+        std::set<CopysetKey> failed;
+        int ret = ProcessChunksInSegments(segments, i, end, op, &failed);
+        if (ret != 0) {
+            LOG(ERROR) << "CleanSnapShotFile Error: "
+                << "DeleteChunkSnapshotOrCorrectSn Error"
+                << ", ret = " << ret
+                << ", inodeid = " << fileInfo.id()
+                << ", filename = " << fileInfo.filename()
+                << ", correctSn = " << correctSn;
+            progress->SetStatus(TaskStatus::FAILED);
+            return StatusCode::kSnapshotFileDeleteError;
+        }
+        progress->SetProgress(100 * end / segments.size());
     }
 
     // delete the storage
@@ -102,25 +117,53 @@ StatusCode CleanCore::CleanFile(const FileInfo & commonFile,
         return StatusCode::KInternalError;
     }
 
-    int  segmentNum = commonFile.length() / commonFile.segmentsize();
-    uint64_t segmentSize = commonFile.segmentsize();
-    for (int i = 0; i != segmentNum; i++) {
-        // load  segment
-        PageFileSegment segment;
-        StoreStatus storeRet = storage_->GetSegment(commonFile.id(),
-                                    i * segmentSize, &segment);
-        if (storeRet == StoreStatus::KeyNotExist) {
-            continue;
-        } else if (storeRet !=  StoreStatus::OK) {
-            LOG(ERROR) << "Clean common File Error: "
-                << "GetSegment Error, inodeid = " << commonFile.id()
+    // segment在其chunk删除后即被删除，任务重新执行时只需处理剩余的segment
+    std::vector<PageFileSegment> segments;
+    StoreStatus storeRet = storage_->ListSegment(commonFile.id(), &segments);
+    if (storeRet != StoreStatus::OK) {
+        LOG(ERROR) << "Clean common File Error: "
+            << "ListSegment Error, inodeid = " << commonFile.id()
+            << ", filename = " << commonFile.filename();
+        progress->SetStatus(TaskStatus::FAILED);
+        return StatusCode::kCommonFileDeleteError;
+    }
+
+    auto op = [&](const CopysetChunks& copysetChunks) {
+        return copysetClient_->DeleteChunks(copysetChunks.logicalPoolId,
+            copysetChunks.copysetId, copysetChunks.chunkIds,
+            commonFile.seqnum());
+    };
+
+    size_t batchSize = std::max<uint32_t>(option_.segmentBatchSize, 1);
+    for (size_t i = 0; i < segments.size(); i += batchSize) {
+        size_t end = std::min(i + batchSize, segments.size());
+        std::set<CopysetKey> failed;
+        int ret = ProcessChunksInSegments(segments, i, end, op, &failed);
+
+        // delete the segments whose chunks are all deleted, even if some
+        // others failed, so that a retried task skips them
+        for (size_t j = i; j < end; j++) {
+            const PageFileSegment& segment = segments[j];
+            if (!SegmentDone(segment, failed)) {
+                continue;
+            }
+
+            int64_t revision;
+            storeRet = storage_->DeleteSegment(
+                commonFile.id(), segment.startoffset(), &revision);
+            if (storeRet != StoreStatus::OK) {
+                LOG(ERROR) << "Clean common File Error: "
+                << "DeleteSegment Error, inodeid = " << commonFile.id()
                 << ", filename = " << commonFile.filename()
-                << ", offset = " << i * segmentSize;
-            progress->SetStatus(TaskStatus::FAILED);
-            return StatusCode::kCommonFileDeleteError;
+                << ", offset = " << segment.startoffset()
+                << ", sequenceNum = " << commonFile.seqnum();
+                progress->SetStatus(TaskStatus::FAILED);
+                return StatusCode::kCommonFileDeleteError;
+            }
+            allocStatistic_->DeAllocSpace(segment.logicalpoolid(),
+                segment.segmentsize(), revision);
         }
 
-        int ret = DeleteChunksInSegment(segment, commonFile.seqnum());
         if (ret != 0) {
             LOG(ERROR) << "Clean common File Error: "
                        << ", ret = " << ret
@@ -130,23 +173,7 @@ StatusCode CleanCore::CleanFile(const FileInfo & commonFile,
             progress->SetStatus(TaskStatus::FAILED);
             return StatusCode::kCommonFileDeleteError;
         }
-
-        // delete segment
-        int64_t revision;
-        storeRet = storage_->DeleteSegment(
-            commonFile.id(), i * segmentSize, &revision);
-        if (storeRet != StoreStatus::OK) {
-            LOG(ERROR) << "Clean common File Error: "
-            << "DeleteSegment Error, inodeid = " << commonFile.id()
-            << ", filename = " << commonFile.filename()
-            << ", offset = " << i * segmentSize
-            << ", sequenceNum = " << commonFile.seqnum();
-            progress->SetStatus(TaskStatus::FAILED);
-            return StatusCode::kCommonFileDeleteError;
-        }
-        allocStatistic_->DeAllocSpace(segment.logicalpoolid(),
-            segment.segmentsize(), revision);
-        progress->SetProgress(100 * (i + 1) / segmentNum);
+        progress->SetProgress(100 * end / segments.size());
     }
 
     // delete the storage
@@ -220,25 +247,138 @@ StatusCode CleanCore::CleanDiscardSegment(
 
 int CleanCore::DeleteChunksInSegment(const PageFileSegment& segment,
                                      const SeqNum& seq) {
-    const LogicalPoolID logicalPoolId = segment.logicalpoolid();
-    for (int i = 0; i < segment.chunks_size(); ++i) {
-        int ret = copysetClient_->DeleteChunk(
-            logicalPoolId,
-            segment.chunks()[i].copysetid(),
-            segment.chunks()[i].chunkid(),
-            seq);
+    auto op = [&](const CopysetChunks& copysetChunks) {
+        return copysetClient_->DeleteChunks(copysetChunks.logicalPoolId,
+            copysetChunks.copysetId, copysetChunks.chunkIds, seq);
+    };
 
-        if (ret != 0) {
-            LOG(ERROR) << "DeleteChunk failed, ret = " << ret
-                       << ", logicalpoolid = " << logicalPoolId
-                       << ", copysetid = " << segment.chunks()[i].copysetid()
-                       << ", chunkid = " << segment.chunks()[i].chunkid()
-                       << ", seq = " << seq;
-            return ret;
+    std::set<CopysetKey> failed;
+    return ProcessChunksInSegments({segment}, 0, 1, op, &failed);
+}
+
+int CleanCore::ProcessChunksInSegments(
+    const std::vector<PageFileSegment>& segments, size_t begin, size_t end,
+    const CopysetChunksOp& op, std::set<CopysetKey>* failed) {
+    // the leaders are only needed to limit the concurrency per chunkserver
+    bool concurrent = option_.deleteConcurrency > 1;
+    std::map<CopysetKey, size_t> index;
+    std::vector<CopysetChunks> tasks;
+    for (size_t i = begin; i < end; i++) {
+        const PageFileSegment& segment = segments[i];
+        for (const auto& chunk : segment.chunks()) {
+            CopysetKey key(segment.logicalpoolid(), chunk.copysetid());
+            auto it = index.find(key);
+            if (it == index.end()) {
+                it = index.emplace(key, tasks.size()).first;
+                CopysetChunks task;
+                task.logicalPoolId = key.first;
+                task.copysetId = key.second;
+                task.leader = concurrent ?
+                    copysetClient_->GetLeader(key.first, key.second) :
+                    ::curve::mds::topology::UNINTIALIZE_ID;
+                task.ret = kMdsFail;
+                tasks.emplace_back(std::move(task));
+            }
+            tasks[it->second].chunkIds.push_back(chunk.chunkid());
+        }
+    }
+
+    RunCopysetTasks(&tasks, op);
+
+    int ret = 0;
+    for (const auto& task : tasks) {
+        if (task.ret != 0) {
+            LOG(ERROR) << "process chunks failed, ret = " << task.ret
+                       << ", logicalpoolid = " << task.logicalPoolId
+                       << ", copysetid = " << task.copysetId
+                       << ", chunk num = " << task.chunkIds.size();
+            failed->emplace(task.logicalPoolId, task.copysetId);
+            if (ret == 0) {
+                ret = task.ret;
+            }
+        }
+    }
+    return ret;
+}
+
+void CleanCore::RunCopysetTasks(std::vector<CopysetChunks>* tasks,
+                                const CopysetChunksOp& op) {
+    size_t workerNum = std::min<size_t>(option_.deleteConcurrency,
+                                        tasks->size());
+    if (workerNum <= 1) {
+        for (auto& task : *tasks) {
+            task.ret = op(task);
+            if (task.ret != 0) {
+                return;
+            }
         }
+        return;
     }
 
-    return 0;
+    const uint32_t perChunkserver =
+        std::max<uint32_t>(option_.chunkserverConcurrency, 1);
+    ::curve::common::Mutex mtx;
+    ::curve::common::ConditionVariable cond;
+    std::map<ChunkServerIdType, uint32_t> inflight;
+    std::vector<bool> taken(tasks->size(), false);
+    size_t left = tasks->size();
+    bool stop = false;
+
+    auto work = [&]() {
+        ::curve::common::UniqueLock lk(mtx);
+        while (!stop && left > 0) {
+            // the first task whose leader is not busy
+            size_t i = 0;
+            for (; i < tasks->size(); i++) {
+                if (!taken[i] &&
+                    inflight[(*tasks)[i].leader] < perChunkserver) {
+                    break;
+                }
+            }
+            if (i == tasks->size()) {
+                cond.wait(lk);
+                continue;
+            }
+
+            CopysetChunks& task = (*tasks)[i];
+            taken[i] = true;
+            left--;
+            inflight[task.leader]++;
+            lk.unlock();
+
+            int ret = op(task);
+
+            lk.lock();
+            task.ret = ret;
+            inflight[task.leader]--;
+            if (ret != 0) {
+                stop = true;
+            }
+            cond.notify_all();
+        }
+    };
+
+    std::vector<::curve::common::Thread> workers;
+    for (size_t i = 0; i < workerNum; i++) {
+        workers.emplace_back(work);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+bool CleanCore::SegmentDone(const PageFileSegment& segment,
+                            const std::set<CopysetKey>& failed) {
+    if (failed.empty()) {
+        return true;
+    }
+    for (const auto& chunk : segment.chunks()) {
+        if (failed.count(CopysetKey(segment.logicalpoolid(),
+                                    chunk.copysetid())) > 0) {
+            return false;
+        }
+    }
+    return true;
 }
 
 }  // namespace mds
@@ -23,8 +23,12 @@
 #ifndef SRC_MDS_NAMESERVER2_CLEAN_CORE_H_
 #define SRC_MDS_NAMESERVER2_CLEAN_CORE_H_
 
+#include <functional>
 #include <memory>
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 #include "src/mds/nameserver2/namespace_storage.h"
 #include "src/mds/common/mds_define.h"
 #include "src/mds/nameserver2/task_progress.h"
@@ -38,14 +42,25 @@ using ::curve::mds::topology::Topology;
 namespace curve {
 namespace mds {
 
+struct CleanCoreOption {
+    // 并发删除chunk的copyset数，为1时串行删除
+    uint32_t deleteConcurrency = 1;
+    // 每个chunkserver上并发删除chunk的copyset数
+    uint32_t chunkserverConcurrency = 1;
+    // 一起删除chunk的segment数，这批segment的chunk删除后才删除segment及更新进度
+    uint32_t segmentBatchSize = 1;
+};
+
 class CleanCore {
  public:
     CleanCore(std::shared_ptr<NameServerStorage> storage,
         std::shared_ptr<CopysetClient> copysetClient,
-        std::shared_ptr<AllocStatistic> allocStatistic)
+        std::shared_ptr<AllocStatistic> allocStatistic,
+        const CleanCoreOption &option = CleanCoreOption())
         : storage_(storage),
           copysetClient_(copysetClient),
-          allocStatistic_(allocStatistic) {}
+          allocStatistic_(allocStatistic),
+          option_(option) {}
 
     /**
      * @brief 删除快照文件，更新task状态
@@ -74,12 +89,45 @@ class CleanCore {
                                    TaskProgress* progress);
 
  private:
+    using CopysetKey = std::pair<LogicalPoolID, CopysetID>;
+
+    // 同一个copyset上待处理的chunk
+    struct CopysetChunks {
+        LogicalPoolID logicalPoolId;
+        CopysetID copysetId;
+        ChunkServerIdType leader;
+        std::vector<ChunkID> chunkIds;
+        int ret;
+    };
+
+    using CopysetChunksOp = std::function<int(const CopysetChunks&)>;
+
     int DeleteChunksInSegment(const PageFileSegment& segment,
                               const SeqNum& seq);
 
+    /**
+     * @brief 将segments[begin, end)中的chunk按copyset分组，并发执行op
+     * @param failed: 执行失败或未执行的copyset
+     * @return 第一个失败的错误码，全部成功返回0
+     */
+    int ProcessChunksInSegments(const std::vector<PageFileSegment>& segments,
+                                size_t begin, size_t end,
+                                const CopysetChunksOp& op,
+                                std::set<CopysetKey>* failed);
+
+    // 最多deleteConcurrency个线程执行tasks，每个leader上最多
+    // chunkserverConcurrency个，有失败后不再执行新的task
+    void RunCopysetTasks(std::vector<CopysetChunks>* tasks,
+                         const CopysetChunksOp& op);
+
+    // segment的chunk是否都处理成功
+    static bool SegmentDone(const PageFileSegment& segment,
+                            const std::set<CopysetKey>& failed);
+
     std::shared_ptr<NameServerStorage> storage_;
     std::shared_ptr<CopysetClient> copysetClient_;
     std::shared_ptr<AllocStatistic> allocStatistic_;
+    const CleanCoreOption option_;
 };
 
 }  // namespace mds
@@ -968,6 +968,34 @@ StatusCode CurveFS::ReadDir(const std::string & dirname,
     return StatusCode::kOK;
 }
 
+StatusCode CurveFS::ReadDir(const std::string & dirname,
+                            const std::string & startAfter,
+                            uint32_t limit,
+                            std::vector<FileInfo> * files,
+                            bool * hasMore) const {
+    assert(files != nullptr);
+    assert(hasMore != nullptr);
+
+    FileInfo fileInfo;
+    auto ret = GetFileInfo(dirname, &fileInfo);
+    if (ret != StatusCode::kOK) {
+        if ( ret == StatusCode::kFileNotExists ) {
+            return StatusCode::kDirNotExist;
+        }
+        return ret;
+    }
+
+    if (fileInfo.filetype() != FileType::INODE_DIRECTORY) {
+        return StatusCode::kNotDirectory;
+    }
+
+    if (storage_->ListFilePage(fileInfo.id(), startAfter, limit, files,
+                               hasMore) != StoreStatus::OK) {
+        return StatusCode::kStorageError;
+    }
+    return StatusCode::kOK;
+}
+
 StatusCode CurveFS::CheckFileCanChange(const std::string &fileName,
     const FileInfo &fileInfo) {
     // Check if the file has a snapshot
@@ -1393,6 +1421,33 @@ StatusCode CurveFS::DeAllocateSegment(const std::string& fileName,
     return StatusCode::kOK;
 }
 
+StatusCode CurveFS::ListSegment(const std::string& fileName,
+                                std::vector<PageFileSegment>* segments) {
+    FileInfo fileInfo;
+    auto ret = GetFileInfo(fileName, &fileInfo);
+    if (ret != StatusCode::kOK) {
+        LOG(ERROR) << "ListSegment get file info error, fileName = "
+                   << fileName << ", errCode = " << ret;
+        return ret;
+    }
+
+    if (fileInfo.filetype() != FileType::INODE_PAGEFILE) {
+        LOG(ERROR) << "ListSegment only support PAGEFILE, fileName = "
+                   << fileName;
+        return StatusCode::kParaError;
+    }
+
+    // segments of a file are stored in adjacent keys in order of offset,
+    // so they are got in one range request
+    auto storeRet = storage_->ListSegment(fileInfo.id(), segments);
+    if (storeRet != StoreStatus::OK) {
+        LOG(ERROR) << "ListSegment list segment error, fileName = "
+                   << fileName << ", error = " << storeRet;
+        return StatusCode::kStorageError;
+    }
+    return StatusCode::kOK;
+}
+
 StatusCode CurveFS::CreateSnapShotFile(const std::string &fileName,
                                     FileInfo *snapshotFileInfo) {
     FileInfo  parentFileInfo;
@@ -2600,11 +2655,16 @@ StatusCode CheckStripeParam(uint64_t segmentSize,
         return StatusCode::kParaError;
     }
 
-    if ((chunkSize % stripeUnit != 0) || (chunkSize % stripeCount != 0)) {
-        LOG(WARNING) << "stripe unit/count is not divisible by chunksize. "
+    // the chunks of a stripe set are in one segment, so the stripe sets
+    // of a file fill its segments exactly
+    if ((chunkSize % stripeUnit != 0) ||
+        ((segmentSize / chunkSize) % stripeCount != 0)) {
+        LOG(WARNING) << "stripe unit is not divisible by chunksize or stripe "
+                        "count is not divisible by chunks of segment. "
                         "stripe unit: "
                      << stripeUnit << ", stripe count: " << stripeCount
-                     << ", chunk size: " << chunkSize;
+                     << ", chunk size: " << chunkSize
+                     << ", segment size: " << segmentSize;
         return StatusCode::kParaError;
     }
 
@@ -247,6 +247,22 @@ class CurveFS {
     StatusCode ReadDir(const std::string & dirname,
                        std::vector<FileInfo> * files) const;
 
+    /**
+     *  @brief get information of files in the directory page by page
+     *  @param dirname
+     *  @param startAfter: get files after this filename, empty means from
+     *                     the first file
+     *  @param limit: max number of files, must be greater than 0
+     *  @param files: results found, in order of filename
+     *  @param hasMore: whether there are files after the last one
+     *  @return StatusCode::kOK if succeeded
+     */
+    StatusCode ReadDir(const std::string & dirname,
+                       const std::string & startAfter,
+                       uint32_t limit,
+                       std::vector<FileInfo> * files,
+                       bool * hasMore) const;
+
     /**
      *  @brief rename file
      *  @param sourceFileName
@@ -308,6 +324,15 @@ class CurveFS {
      */
     StatusCode DeAllocateSegment(const std::string& filename, uint64_t offset);
 
+    /**
+     * @brief list all the allocated segments of a file
+     * @param filename
+     * @param[out] segments: the segments in order of offset
+     * @return On success, return StatusCode::kOK
+     */
+    StatusCode ListSegment(const std::string& filename,
+                           std::vector<PageFileSegment>* segments);
+
     /**
      *  @brief get the root file info
      *  @param
@@ -0,0 +1,123 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/mds/nameserver2/file_info_cache.h"
+
+#include <utility>
+
+namespace curve {
+namespace mds {
+
+using ::curve::common::CacheMetrics;
+using ::curve::common::LockGuard;
+
+FileInfoCache::FileInfoCache(const FileInfoCacheOption &option)
+    : option_(option),
+      files_(option.fileCount,
+             std::make_shared<CacheMetrics>("mds_nameserver_fileinfo_cache")),
+      dirs_(option.dirCount,
+            std::make_shared<CacheMetrics>("mds_nameserver_dir_cache")),
+      nextToken_(0) {}
+
+bool FileInfoCache::GetFile(const std::string &storeKey, FileInfo *fileInfo) {
+    std::shared_ptr<const FileInfo> cached;
+    if (!files_.Get(storeKey, &cached)) {
+        return false;
+    }
+
+    fileInfo->CopyFrom(*cached);
+    return true;
+}
+
+void FileInfoCache::PutFile(const std::string &storeKey,
+                            const FileInfo &fileInfo) {
+    files_.Put(storeKey, std::make_shared<const FileInfo>(fileInfo));
+}
+
+void FileInfoCache::RemoveFile(const std::string &storeKey) {
+    files_.Remove(storeKey);
+}
+
+bool FileInfoCache::ListDir(InodeID dirId, std::vector<FileInfo> *files) {
+    if (option_.dirCount == 0) {
+        return false;
+    }
+
+    std::shared_ptr<const std::vector<FileInfo>> children;
+    {
+        LockGuard lk(dirMtx_);
+        std::shared_ptr<DirEntry> entry;
+        if (!dirs_.Get(dirId, &entry) || entry->files == nullptr) {
+            return false;
+        }
+        children = entry->files;
+    }
+
+    files->insert(files->end(), children->begin(), children->end());
+    return true;
+}
+
+uint64_t FileInfoCache::BeginListDir(InodeID dirId) {
+    if (option_.dirCount == 0) {
+        return 0;
+    }
+
+    auto entry = std::make_shared<DirEntry>();
+    LockGuard lk(dirMtx_);
+    entry->token = ++nextToken_;
+    dirs_.Put(dirId, entry);
+    return entry->token;
+}
+
+void FileInfoCache::FinishListDir(InodeID dirId, uint64_t token,
+                                  const std::vector<FileInfo> &files) {
+    if (token == 0) {
+        return;
+    }
+
+    // large directories would evict lots of small ones and are listed rarely
+    if (files.size() > option_.maxDirEntries) {
+        InvalidateDir(dirId);
+        return;
+    }
+
+    auto children = std::make_shared<const std::vector<FileInfo>>(files);
+    LockGuard lk(dirMtx_);
+    std::shared_ptr<DirEntry> entry;
+    if (!dirs_.Get(dirId, &entry) || entry->token != token) {
+        // the directory was changed or listed again while loading
+        return;
+    }
+    entry->files = std::move(children);
+}
+
+void FileInfoCache::InvalidateDir(InodeID dirId) {
+    if (option_.dirCount == 0) {
+        return;
+    }
+
+    LockGuard lk(dirMtx_);
+    dirs_.Remove(dirId);
+}
+
+void FileInfoCache::Clear() {
+    files_.Clear();
+    LockGuard lk(dirMtx_);
+    dirs_.Clear();
+}
+
+}  // namespace mds
+}  // namespace curve
@@ -0,0 +1,107 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_MDS_NAMESERVER2_FILE_INFO_CACHE_H_
+#define SRC_MDS_NAMESERVER2_FILE_INFO_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "proto/nameserver2.pb.h"
+#include "src/common/concurrent/concurrent.h"
+#include "src/common/lru_cache.h"
+#include "src/mds/common/mds_define.h"
+
+namespace curve {
+namespace mds {
+
+struct FileInfoCacheOption {
+    // max number of parsed FileInfo, 0 means the cache is disabled
+    uint64_t fileCount = 0;
+    // max number of cached directory listings
+    uint64_t dirCount = 0;
+    // directories with more children than this are never cached
+    uint64_t maxDirEntries = 1024;
+};
+
+/**
+ * Parsed FileInfo keyed by store key, and the children of a directory keyed
+ * by its inode id. Only NameServerStorageImp writes the namespace, so it
+ * keeps this cache coherent by invalidating it around every write.
+ *
+ * A listing read from etcd may race with a write to the same directory, so
+ * it is filled in two steps: BeginListDir() registers a token, the write
+ * invalidates it, and FinishListDir() only keeps the listing if the token
+ * is still there.
+ */
+class FileInfoCache {
+ public:
+    explicit FileInfoCache(const FileInfoCacheOption &option);
+
+    bool GetFile(const std::string &storeKey, FileInfo *fileInfo);
+
+    void PutFile(const std::string &storeKey, const FileInfo &fileInfo);
+
+    void RemoveFile(const std::string &storeKey);
+
+    /**
+     * @brief Get the cached children of a directory
+     * @return false if the listing is not cached
+     */
+    bool ListDir(InodeID dirId, std::vector<FileInfo> *files);
+
+    /**
+     * @brief Start loading the children of a directory from etcd
+     * @return token passed to FinishListDir
+     */
+    uint64_t BeginListDir(InodeID dirId);
+
+    void FinishListDir(InodeID dirId, uint64_t token,
+                       const std::vector<FileInfo> &files);
+
+    // drop the listing of a directory whose children changed
+    void InvalidateDir(InodeID dirId);
+
+    // drop all files and listings
+    void Clear();
+
+ private:
+    struct DirEntry {
+        uint64_t token = 0;
+        // nullptr while the listing is being loaded
+        std::shared_ptr<const std::vector<FileInfo>> files;
+    };
+
+    using FileLRU = ::curve::common::LRUCache<std::string,
+                                              std::shared_ptr<const FileInfo>>;
+    using DirLRU =
+        ::curve::common::LRUCache<InodeID, std::shared_ptr<DirEntry>>;
+
+    const FileInfoCacheOption option_;
+    FileLRU files_;
+
+    // serializes the check-and-set of directory tokens
+    ::curve::common::Mutex dirMtx_;
+    DirLRU dirs_;
+    uint64_t nextToken_;
+};
+
+}  // namespace mds
+}  // namespace curve
+
+#endif  // SRC_MDS_NAMESERVER2_FILE_INFO_CACHE_H_
@@ -24,6 +24,7 @@
 
 #include <algorithm>
 #include <map>
+#include <utility>
 #include <vector>
 
 #include "src/common/timeutility.h"
@@ -34,9 +35,26 @@ namespace mds {
 
 void FileRecordManager::Init(const FileRecordOptions& fileRecordOptions) {
     fileRecordOptions_ = fileRecordOptions;
+    tickUs_ = std::max<uint64_t>(fileRecordOptions_.scanIntervalTimeUs, 1);
+    // a record is put at most this ticks ahead, see FileRecord::IsTimeout
+    uint64_t slots =
+        10ull * fileRecordOptions_.fileRecordExpiredTimeUs / tickUs_ + 3;
+    for (auto& shard : shards_) {
+        shard.wheel.resize(slots);
+    }
+}
+
+uint64_t FileRecordManager::GetOpenFileNum() const {
+    uint64_t num = 0;
+    for (const auto& shard : shards_) {
+        ReadLockGuard lk(shard.rwlock);
+        num += shard.fileRecords.size();
+    }
+    return num;
 }
 
 void FileRecordManager::Start() {
+    lastTick_ = curve::common::TimeUtility::GetTimeofDayUs() / tickUs_;
     scanThread_ = curve::common::Thread(&FileRecordManager::Scan, this);
     running_ = true;
 }
@@ -53,10 +71,11 @@ void FileRecordManager::Stop() {
 
 bool FileRecordManager::GetMinimumFileClientVersion(
     const std::string& fileName, std::string *clientVersion) const {
-    ReadLockGuard lk(rwlock_);
+    const Shard& shard = GetShard(fileName);
+    ReadLockGuard lk(shard.rwlock);
 
-    auto it = fileRecords_.find(fileName);
-    if (it == fileRecords_.end()) {
+    auto it = shard.fileRecords.find(fileName);
+    if (it == shard.fileRecords.end()) {
         return false;
     }
 
@@ -87,11 +106,12 @@ void FileRecordManager::UpdateFileRecord(const std::string& fileName,
         return;
     }
 
+    Shard& shard = GetShard(fileName);
     do {
-        ReadLockGuard lk(rwlock_);
+        ReadLockGuard lk(shard.rwlock);
 
-        auto it = fileRecords_.find(fileName);
-        if (it == fileRecords_.end()) {
+        auto it = shard.fileRecords.find(fileName);
+        if (it == shard.fileRecords.end()) {
             break;
         }
 
@@ -111,12 +131,18 @@ void FileRecordManager::UpdateFileRecord(const std::string& fileName,
               << ", clientVersion = " << clientVersion << ", client endpoint = "
               << butil::endpoint2str(clientEp).c_str();
 
-    WriteLockGuard lk(rwlock_);
-    if (fileRecords_.count(fileName) == 0) {
-        fileRecords_.emplace(fileName, std::map<butil::EndPoint, FileRecord>{});
+    WriteLockGuard lk(shard.rwlock);
+    auto ret = shard.fileRecords[fileName].emplace(clientEp, record);
+    if (!ret.second) {
+        // added by others in the meantime, it's in the wheel already
+        ret.first->second.Update(clientVersion, clientEp);
+        return;
     }
 
-    fileRecords_[fileName].emplace(clientEp, record);
+    uint64_t tick = ExpireTick(record);
+    ret.first->second.SetExpireTick(tick);
+    shard.wheel[tick % shard.wheel.size()].push_back(
+        WheelEntry{fileName, clientEp, tick});
 }
 
 void FileRecordManager::RemoveFileRecord(const std::string& filename,
@@ -131,45 +157,85 @@ void FileRecordManager::RemoveFileRecord(const std::string& filename,
         return;
     }
 
-    WriteLockGuard lk(rwlock_);
-    auto it = fileRecords_.find(filename);
-    if (it == fileRecords_.end()) {
+    Shard& shard = GetShard(filename);
+    WriteLockGuard lk(shard.rwlock);
+    auto it = shard.fileRecords.find(filename);
+    if (it == shard.fileRecords.end()) {
         return;
     }
 
+    // its entry in the wheel is dropped when scanned
     it->second.erase(ep);
+    if (it->second.empty()) {
+        shard.fileRecords.erase(it);
+    }
 }
 
 void FileRecordManager::Scan() {
     while (sleeper_.wait_for(
         std::chrono::microseconds(fileRecordOptions_.scanIntervalTimeUs))) {
-        WriteLockGuard lk(rwlock_);
-
-        auto iter = fileRecords_.begin();
-        while (iter != fileRecords_.end()) {
-            auto recordIter = iter->second.begin();
-            while (recordIter != iter->second.end()) {
-                if (recordIter->second.IsTimeout()) {
-                    LOG(INFO)
-                        << "Remove timeout file record, filename = "
-                        << iter->first << ", last update time = "
-                        << curve::common::TimeUtility::TimeStampToStandard(
-                               recordIter->second.GetUpdateTime() / 1000000)
-                        << ", endpoint = "
-                        << butil::endpoint2str(
-                               recordIter->second.GetClientEndPoint())
-                               .c_str();
-                    recordIter = iter->second.erase(recordIter);
-                } else {
-                    ++recordIter;
-                }
+        uint64_t nowUs = curve::common::TimeUtility::GetTimeofDayUs();
+        uint64_t nowTick = nowUs / tickUs_;
+        if (nowTick <= lastTick_) {
+            continue;
+        }
+
+        // lock the shards one by one, only the slots due are scanned
+        for (auto& shard : shards_) {
+            ScanShard(&shard, nowTick, nowUs);
+        }
+        lastTick_ = nowTick;
+    }
+}
+
+void FileRecordManager::ScanShard(Shard* shard, uint64_t nowTick,
+                                  uint64_t nowUs) {
+    WriteLockGuard lk(shard->rwlock);
+    const uint64_t slots = shard->wheel.size();
+    // all the slots are due if the scan is delayed for a round
+    uint64_t from = nowTick - std::min(nowTick - lastTick_, slots) + 1;
+    for (uint64_t t = from; t <= nowTick; ++t) {
+        std::vector<WheelEntry> entries;
+        entries.swap(shard->wheel[t % slots]);
+        for (auto& entry : entries) {
+            if (entry.tick > nowTick) {
+                // a later round of the wheel
+                shard->wheel[t % slots].push_back(std::move(entry));
+                continue;
             }
 
-            if (iter->second.empty()) {
-                iter = fileRecords_.erase(iter);
-            } else {
-                ++iter;
+            auto iter = shard->fileRecords.find(entry.fileName);
+            if (iter == shard->fileRecords.end()) {
+                continue;
+            }
+            auto recordIter = iter->second.find(entry.endPoint);
+            if (recordIter == iter->second.end() ||
+                recordIter->second.GetExpireTick() != entry.tick) {
+                // removed, or it's a stale entry of a record added again
+                continue;
             }
+
+            FileRecord& record = recordIter->second;
+            if (record.GetExpireTimeUs() < nowUs) {
+                LOG(INFO) << "Remove timeout file record, filename = "
+                          << iter->first << ", last update time = "
+                          << curve::common::TimeUtility::TimeStampToStandard(
+                                 record.GetUpdateTime() / 1000000)
+                          << ", endpoint = "
+                          << butil::endpoint2str(record.GetClientEndPoint())
+                                 .c_str();
+                iter->second.erase(recordIter);
+                if (iter->second.empty()) {
+                    shard->fileRecords.erase(iter);
+                }
+                continue;
+            }
+
+            // refreshed since put into the slot, move it forward
+            uint64_t tick = std::max(ExpireTick(record), nowTick + 1);
+            record.SetExpireTick(tick);
+            entry.tick = tick;
+            shard->wheel[tick % slots].push_back(std::move(entry));
         }
     }
 }
@@ -185,9 +251,9 @@ void FileRecordManager::GetRecordParam(ProtoSession* protoSession) const {
 std::set<butil::EndPoint> FileRecordManager::ListAllClient() const {
     std::set<butil::EndPoint> res;
 
-    {
-        ReadLockGuard lk(rwlock_);
-        for (const auto& files : fileRecords_) {
+    for (const auto& shard : shards_) {
+        ReadLockGuard lk(shard.rwlock);
+        for (const auto& files : shard.fileRecords) {
             for (const auto& r : files.second) {
                 const auto& ep = r.second.GetClientEndPoint();
                 if (ep.port != kInvalidPort) {
@@ -202,9 +268,10 @@ std::set<butil::EndPoint> FileRecordManager::ListAllClient() const {
 
 bool FileRecordManager::FindFileMountPoint(
     const std::string& fileName, std::vector<butil::EndPoint>* eps) const {
-    ReadLockGuard lk(rwlock_);
-    auto iter = fileRecords_.find(fileName);
-    if (iter == fileRecords_.end()) {
+    const Shard& shard = GetShard(fileName);
+    ReadLockGuard lk(shard.rwlock);
+    auto iter = shard.fileRecords.find(fileName);
+    if (iter == shard.fileRecords.end()) {
         return false;
     }
 
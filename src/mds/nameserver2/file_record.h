@@ -25,6 +25,8 @@
 
 #include <butil/endpoint.h>
 
+#include <array>
+#include <functional>
 #include <map>
 #include <set>
 #include <string>
@@ -63,13 +65,15 @@ class FileRecord {
         : updateTimeUs_(fileRecord.updateTimeUs_),
           timeoutUs_(fileRecord.timeoutUs_),
           clientVersion_(fileRecord.clientVersion_),
-          endPoint_(fileRecord.endPoint_) {}
+          endPoint_(fileRecord.endPoint_),
+          expireTick_(fileRecord.expireTick_) {}
 
     FileRecord& operator=(const FileRecord& fileRecord) {
         updateTimeUs_ = fileRecord.updateTimeUs_;
         timeoutUs_ = fileRecord.timeoutUs_;
         clientVersion_ = fileRecord.clientVersion_;
         endPoint_ = fileRecord.endPoint_;
+        expireTick_ = fileRecord.expireTick_;
         return *this;
     }
 
@@ -78,9 +82,28 @@ class FileRecord {
      * @return true if timeout, false if not
      */
     bool IsTimeout() const {
-        curve::common::LockGuard lk(mtx_);
         uint64_t currentTimeUs = curve::common::TimeUtility::GetTimeofDayUs();
-        return currentTimeUs > updateTimeUs_ + 10 * timeoutUs_;
+        return currentTimeUs > GetExpireTimeUs();
+    }
+
+    /**
+     * @brief Get the time after which the record is timeout
+     */
+    uint64_t GetExpireTimeUs() const {
+        curve::common::LockGuard lk(mtx_);
+        return updateTimeUs_ + 10 * timeoutUs_;
+    }
+
+    /**
+     * @brief the tick of the timer wheel slot that holds the record,
+     *        only accessed with the write lock of its shard
+     */
+    uint64_t GetExpireTick() const {
+        return expireTick_;
+    }
+
+    void SetExpireTick(uint64_t tick) {
+        expireTick_ = tick;
     }
 
     /**
@@ -131,6 +154,8 @@ class FileRecord {
     std::string clientVersion_;
     // client endpoint
     butil::EndPoint endPoint_;
+    // tick of the timer wheel slot the record is waiting in
+    uint64_t expireTick_ = 0;
     // mutex for updating the time
     mutable curve::common::Mutex mtx_;
 };
@@ -149,10 +174,7 @@ class FileRecordManager {
      * @brief Get the opened file number
      * @return the number of the opened files
      */
-    uint64_t GetOpenFileNum() const {
-        ReadLockGuard lk(rwlock_);
-        return fileRecords_.size();
-    }
+    uint64_t GetOpenFileNum() const;
 
     /**
      * @brief Get the expired time of the file
@@ -207,20 +229,60 @@ class FileRecordManager {
                                     std::vector<butil::EndPoint>* eps) const;
 
  private:
+    // a record waiting in a slot of the timer wheel
+    struct WheelEntry {
+        std::string fileName;
+        butil::EndPoint endPoint;
+        uint64_t tick;
+    };
+
+    // the records are sharded by file name, so that refreshing the sessions
+    // of different files doesn't contend on one lock
+    struct Shard {
+        // file records
+        // There are two scenarios for endpoints of map's key
+        // 1. if client enables register to mds, endpoint is corresponding to
+        //    client host ip and dummy server port
+        // 2. otherwise, ip is equal to rpc's remote_side and port is
+        //    `kInvalidPort'
+        std::unordered_map<std::string, std::map<butil::EndPoint, FileRecord>>
+            fileRecords;
+        // timer wheel, a record waits in the slot of its expire tick, a
+        // refresh only updates the record's time and leaves the wheel alone,
+        // the record is moved forward when its slot is scanned
+        std::vector<std::vector<WheelEntry>> wheel;
+        // rwlock for fileRecords and wheel
+        mutable curve::common::RWLock rwlock;
+    };
+
+    static constexpr uint32_t kShardNum = 64;
+
+    Shard& GetShard(const std::string& fileName) {
+        return shards_[std::hash<std::string>()(fileName) % kShardNum];
+    }
+
+    const Shard& GetShard(const std::string& fileName) const {
+        return shards_[std::hash<std::string>()(fileName) % kShardNum];
+    }
+
+    // the tick of the slot to check the record, it's after the expire time
+    uint64_t ExpireTick(const FileRecord& record) const {
+        return record.GetExpireTimeUs() / tickUs_ + 1;
+    }
+
     /**
      * @brief Function for periodic scanning, it deletes timed-out file records
      */
     void Scan();
 
-    // file records
-    // There are two scenarios for endpoints of map's key
-    // 1. if client enables register to mds, endpoint is corresponding to client
-    //    host ip and dummy server port
-    // 2. otherwise, ip is equal to rpc's remote_side and port is `kInvalidPort'
-    std::unordered_map<std::string, std::map<butil::EndPoint, FileRecord>>
-        fileRecords_;
-    // rwlock for fileRecords_
-    mutable curve::common::RWLock rwlock_;
+    // scan the slots of ticks in (lastTick_, nowTick]
+    void ScanShard(Shard* shard, uint64_t nowTick, uint64_t nowUs);
+
+    std::array<Shard, kShardNum> shards_;
+    // time of a tick of the timer wheel
+    uint64_t tickUs_ = 1;
+    // the last tick scanned
+    uint64_t lastTick_ = 0;
     // the thread for scanning in backend
     curve::common::Thread scanThread_;
 
@@ -32,6 +32,7 @@ using ::curve::common::SNAPSHOTFILEINFOKEYPREFIX;
 using ::curve::common::SEGMENTKEYLEN;
 using ::curve::common::SEGMENTINFOKEYPREFIX;
 using ::curve::common::SEGMENTALLOCSIZEKEY;
+using ::curve::common::SEGMENTALLOCLOGKEYPREFIX;
 using ::curve::common::DISCARDSEGMENTKEYLEN;
 using ::curve::common::DISCARDSEGMENTKEYPREFIX;
 using ::curve::common::DISCARDSEGMENTKEYEND;
@@ -149,6 +150,50 @@ bool NameSpaceStorageCodec::DecodeSegmentAllocValue(
     return true;
 }
 
+std::string NameSpaceStorageCodec::EncodeSegmentAllocLogKey(uint64_t term,
+                                                            uint64_t seq) {
+    std::string storeKey;
+    storeKey.resize(SEGMENTKEYLEN);
+    memcpy(&(storeKey[0]), SEGMENTALLOCLOGKEYPREFIX, COMMON_PREFIX_LENGTH);
+    ::curve::common::EncodeBigEndian(&(storeKey[2]), term);
+    ::curve::common::EncodeBigEndian(&(storeKey[10]), seq);
+    return storeKey;
+}
+
+std::string NameSpaceStorageCodec::EncodeSegmentAllocLogValue(
+    uint16_t lid, int64_t change) {
+    return std::to_string(lid) + "_" + std::to_string(change);
+}
+
+bool NameSpaceStorageCodec::DecodeSegmentAllocLogValue(
+        const std::string &value, uint16_t *lid, int64_t *change) {
+    std::vector<std::string> res;
+    ::curve::common::SplitString(value, "_", &res);
+    if (res.size() != 2 || res[1].empty()) {
+        LOG(ERROR) << "segment alloc log value: "
+                   << value << " is in unknown format";
+        return false;
+    }
+
+    uint64_t tmplid;
+    if (!::curve::common::StringToUll(res[0], &tmplid)) {
+        LOG(ERROR) << "get logicalPoolId from " << res[0] << " fail";
+        return false;
+    }
+    *lid = tmplid;
+
+    bool negative = res[1][0] == '-';
+    uint64_t abs;
+    if (!::curve::common::StringToUll(res[1].substr(negative ? 1 : 0),
+                                      &abs)) {
+        LOG(ERROR) << "get alloc change from " << res[1] << " fail";
+        return false;
+    }
+    *change = negative ? -static_cast<int64_t>(abs)
+                       : static_cast<int64_t>(abs);
+    return true;
+}
+
 bool NameSpaceStorageCodec::EncodeDiscardSegment(const DiscardSegmentInfo& info,
                                                  std::string* out) {
     return info.SerializeToString(out);
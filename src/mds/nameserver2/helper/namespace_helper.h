@@ -57,6 +57,12 @@ class NameSpaceStorageCodec {
     static std::string EncodeSegmentAllocValue(uint16_t lid, uint64_t alloc);
     static bool DecodeSegmentAllocValue(
         const std::string &value, uint16_t *lid, uint64_t *alloc);
+
+    static std::string EncodeSegmentAllocLogKey(uint64_t term, uint64_t seq);
+    static std::string EncodeSegmentAllocLogValue(uint16_t lid,
+                                                  int64_t change);
+    static bool DecodeSegmentAllocLogValue(
+        const std::string &value, uint16_t *lid, int64_t *change);
 };
 
 inline bool isPathValid(const std::string path) {
@@ -36,6 +36,10 @@ namespace mds {
 
 using curve::common::ExpiredTime;
 
+// max segments got, allocated or deallocated by one GetOrAllocateSegment or
+// DeAllocateSegment request, it bounds the time the file lock is held
+static const uint32_t kMaxSegmentNumPerRequest = 64;
+
 void NameSpaceService::CreateFile(::google::protobuf::RpcController* controller,
                        const ::curve::mds::CreateFileRequest* request,
                        ::curve::mds::CreateFileResponse* response,
@@ -496,10 +500,29 @@ void NameSpaceService::GetOrAllocateSegment(
         response->clear_pagefilesegment();
     } else {
         response->set_statuscode(StatusCode::kOK);
+
+        // segments after the first one are best effort, the client asks for
+        // them again if they are not returned
+        uint32_t segmentNum = std::min(request->segmentnum(),
+                                       kMaxSegmentNumPerRequest);
+        uint64_t segmentSize = response->pagefilesegment().segmentsize();
+        for (uint32_t i = 1; i < segmentNum; ++i) {
+            PageFileSegment segment;
+            retCode = kCurveFS.GetOrAllocateSegment(request->filename(),
+                        request->offset() + i * segmentSize,
+                        request->allocateifnotexist(), &segment);
+            if (retCode == StatusCode::kOK) {
+                response->add_extrasegments()->Swap(&segment);
+            } else if (retCode != StatusCode::kSegmentNotAllocated) {
+                break;
+            }
+        }
+
         LOG(INFO) << "logid = " << cntl->log_id()
                   << ", GetOrAllocateSegment ok, filename = "
                   << request->filename() << ", offset = " << request->offset()
                   << ", allocateTag = " << request->allocateifnotexist()
+                  << ", extra segments = " << response->extrasegments_size()
                   << ", cost " << expiredTime.ExpiredMs() << " ms";
     }
     return;
@@ -553,8 +576,33 @@ void NameSpaceService::DeAllocateSegment(
         return;
     }
 
-    retCode =
-        kCurveFS.DeAllocateSegment(request->filename(), request->offset());
+    // segments are deallocated in order and it stops at the first failure,
+    // segments not allocated are skipped if more than one is requested
+    uint32_t segmentNum = std::max<uint32_t>(
+        1, std::min(request->segmentnum(), kMaxSegmentNumPerRequest));
+    uint64_t segmentSize = 0;
+    if (segmentNum > 1) {
+        FileInfo fileInfo;
+        retCode = kCurveFS.GetFileInfo(request->filename(), &fileInfo);
+        if (retCode == StatusCode::kOK) {
+            segmentSize = fileInfo.segmentsize();
+        } else {
+            segmentNum = 1;
+        }
+    }
+
+    uint32_t deallocated = 0;
+    for (; deallocated < segmentNum; ++deallocated) {
+        retCode = kCurveFS.DeAllocateSegment(
+            request->filename(), request->offset() + deallocated * segmentSize);
+        if (retCode == StatusCode::kSegmentNotAllocated && segmentNum > 1) {
+            retCode = StatusCode::kOK;
+        }
+        if (retCode != StatusCode::kOK) {
+            break;
+        }
+    }
+    response->set_deallocatednum(deallocated);
 
     timer.stop();
     if (retCode != StatusCode::kOK) {
@@ -584,6 +632,86 @@ void NameSpaceService::DeAllocateSegment(
     return;
 }
 
+void NameSpaceService::ListSegment(
+    ::google::protobuf::RpcController* controller,
+    const ::curve::mds::ListSegmentRequest* request,
+    ::curve::mds::ListSegmentResponse* response,
+    ::google::protobuf::Closure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    ExpiredTime expiredTime;
+
+    if (!isPathValid(request->filename())) {
+        response->set_statuscode(StatusCode::kParaError);
+        LOG(WARNING) << "logid = " << cntl->log_id()
+                     << ", ListSegment request path is invalid, filename = "
+                     << request->filename();
+        return;
+    }
+
+    LOG(INFO) << "logid = " << cntl->log_id()
+        << ", ListSegment request, filename = " << request->filename();
+
+    FileReadLockGuard guard(fileLockManager_, request->filename());
+
+    std::string signature;
+    if (request->has_signature()) {
+        signature = request->signature();
+    }
+
+    StatusCode retCode;
+    retCode = kCurveFS.CheckFileOwner(request->filename(), request->owner(),
+                                      signature, request->date());
+    if (retCode != StatusCode::kOK) {
+        response->set_statuscode(retCode);
+        if (google::ERROR != GetMdsLogLevel(retCode)) {
+            LOG(WARNING) << "logid = " << cntl->log_id()
+                << ", CheckFileOwner fail, filename = " <<  request->filename()
+                << ", owner = " << request->owner()
+                << ", statusCode = " << retCode;
+        } else {
+            LOG(ERROR) << "logid = " << cntl->log_id()
+                << ", CheckFileOwner fail, filename = " <<  request->filename()
+                << ", owner = " << request->owner()
+                << ", statusCode = " << retCode;
+        }
+        return;
+    }
+
+    std::vector<PageFileSegment> segments;
+    retCode = kCurveFS.ListSegment(request->filename(), &segments);
+    if (retCode != StatusCode::kOK) {
+        response->set_statuscode(retCode);
+        if (google::ERROR != GetMdsLogLevel(retCode)) {
+            LOG(WARNING) << "logid = " << cntl->log_id()
+                << ", ListSegment fail, filename = " <<  request->filename()
+                << ", statusCode = " << retCode
+                << ", StatusCode_Name = " << StatusCode_Name(retCode)
+                << ", cost " << expiredTime.ExpiredMs() << " ms";
+        } else {
+            LOG(ERROR) << "logid = " << cntl->log_id()
+                << ", ListSegment fail, filename = " <<  request->filename()
+                << ", statusCode = " << retCode
+                << ", StatusCode_Name = " << StatusCode_Name(retCode)
+                << ", cost " << expiredTime.ExpiredMs() << " ms";
+        }
+        return;
+    }
+
+    response->set_statuscode(StatusCode::kOK);
+    for (auto& segment : segments) {
+        response->add_segments()->Swap(&segment);
+    }
+    // chunk ids and copyset ids of a segment compress well, and a large file
+    // has thousands of segments
+    cntl->set_response_compress_type(brpc::COMPRESS_TYPE_SNAPPY);
+    LOG(INFO) << "logid = " << cntl->log_id()
+              << ", ListSegment ok, filename = " << request->filename()
+              << ", segment num = " << response->segments_size()
+              << ", cost " << expiredTime.ExpiredMs() << " ms";
+    return;
+}
+
 void NameSpaceService::RenameFile(::google::protobuf::RpcController* controller,
                          const ::curve::mds::RenameFileRequest* request,
                          ::curve::mds::RenameFileResponse* response,
@@ -900,7 +1028,14 @@ void NameSpaceService::ListDir(::google::protobuf::RpcController* controller,
     }
 
     std::vector<FileInfo> fileInfoList;
-    retCode = kCurveFS.ReadDir(request->filename(), &fileInfoList);
+    bool hasMore = false;
+    if (request->pagesize() > 0) {
+        retCode = kCurveFS.ReadDir(request->filename(), request->pagetoken(),
+                                   request->pagesize(), &fileInfoList,
+                                   &hasMore);
+    } else {
+        retCode = kCurveFS.ReadDir(request->filename(), &fileInfoList);
+    }
     if (retCode != StatusCode::kOK)  {
         response->set_statuscode(retCode);
         if (google::ERROR != GetMdsLogLevel(retCode)) {
@@ -919,13 +1054,18 @@ void NameSpaceService::ListDir(::google::protobuf::RpcController* controller,
         return;
     } else {
         response->set_statuscode(StatusCode::kOK);
+        // the filename of the last file is where the next page starts
+        if (hasMore) {
+            response->set_nextpagetoken(fileInfoList.back().filename());
+        }
         for (auto iter = fileInfoList.begin();
                                 iter != fileInfoList.end(); ++iter) {
             FileInfo *fileinfo = response->add_fileinfo();
-            fileinfo->CopyFrom(*iter);
+            fileinfo->Swap(&(*iter));
         }
         LOG(INFO) << "logid = " << cntl->log_id()
                   << ", ListDir ok, filename = " << request->filename()
+                  << ", file num = " << response->fileinfo_size()
                   << ", cost " << expiredTime.ExpiredMs() << " ms";
     }
     return;
@@ -1636,62 +1776,97 @@ void NameSpaceService::RefreshSession(
                     ::google::protobuf::Closure* done) {
     brpc::ClosureGuard doneGuard(done);
     brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    DoRefreshSession(cntl, *request, response);
+}
+
+void NameSpaceService::BatchRefreshSession(
+                    ::google::protobuf::RpcController* controller,
+                    const ::curve::mds::BatchRefreshSessionRequest* request,
+                    ::curve::mds::BatchRefreshSessionResponse* response,
+                    ::google::protobuf::Closure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    ExpiredTime expiredTime;
+
+    if (request->requests_size() == 0) {
+        response->set_statuscode(StatusCode::kParaError);
+        LOG(WARNING) << "logid = " << cntl->log_id()
+                     << ", BatchRefreshSession request is empty"
+                     << ", remote side = " << cntl->remote_side();
+        return;
+    }
+
+    for (const auto& req : request->requests()) {
+        DoRefreshSession(cntl, req, response->add_responses());
+    }
+    response->set_statuscode(StatusCode::kOK);
+    DVLOG(6) << "logid = " << cntl->log_id()
+             << ", BatchRefreshSession ok, sessions = "
+             << request->requests_size()
+             << ", remote side = " << cntl->remote_side()
+             << ", cost = " << expiredTime.ExpiredMs() << " ms";
+}
+
+void NameSpaceService::DoRefreshSession(
+                    brpc::Controller* cntl,
+                    const ::curve::mds::ReFreshSessionRequest& request,
+                    ::curve::mds::ReFreshSessionResponse* response) {
     ExpiredTime expiredTime;
 
     std::string clientIP = butil::ip2str(cntl->remote_side().ip).c_str();
     std::string clientVersion;
-    if (request->has_clientversion()) {
-        clientVersion = request->clientversion();
+    if (request.has_clientversion()) {
+        clientVersion = request.clientversion();
     }
     uint32_t clientPort = cntl->remote_side().port;
 
-    if (!isPathValid(request->filename())) {
+    if (!isPathValid(request.filename())) {
         response->set_statuscode(StatusCode::kParaError);
-        response->set_sessionid(request->sessionid());
+        response->set_sessionid(request.sessionid());
         LOG(WARNING) << "logid = " << cntl->log_id()
                      << ", RefreshSession request path is invalid, filename = "
-                     << request->filename()
-                     << ", sessionid = " << request->sessionid()
-                     << ", date = " << request->date()
-                     << ", signature = " << request->signature()
+                     << request.filename()
+                     << ", sessionid = " << request.sessionid()
+                     << ", date = " << request.date()
+                     << ", signature = " << request.signature()
                      << ", clientip = " << clientIP
                      << ", clientport = " << clientPort;
         return;
     }
 
     DVLOG(6) << "logid = " << cntl->log_id()
-        << ", RefreshSession request, filename = " << request->filename()
-        << ", sessionid = " << request->sessionid()
-        << ", date = " << request->date()
-        << ", signature = " << request->signature()
+        << ", RefreshSession request, filename = " << request.filename()
+        << ", sessionid = " << request.sessionid()
+        << ", date = " << request.date()
+        << ", signature = " << request.signature()
         << ", clientip = " << clientIP
         << ", clientport = " << clientPort;
 
-    FileReadLockGuard guard(fileLockManager_, request->filename());
+    FileReadLockGuard guard(fileLockManager_, request.filename());
 
     std::string signature;
-    if (request->has_signature()) {
-        signature = request->signature();
+    if (request.has_signature()) {
+        signature = request.signature();
     }
 
     StatusCode retCode;
-    retCode = kCurveFS.CheckFileOwner(request->filename(), request->owner(),
-                                      signature, request->date());
+    retCode = kCurveFS.CheckFileOwner(request.filename(), request.owner(),
+                                      signature, request.date());
     if (retCode != StatusCode::kOK) {
         response->set_statuscode(retCode);
-        response->set_sessionid(request->sessionid());
+        response->set_sessionid(request.sessionid());
         if (google::ERROR != GetMdsLogLevel(retCode)) {
             LOG(WARNING) << "logid = " << cntl->log_id()
                          << ", CheckFileOwner fail, filename = "
-                         << request->filename()
-                         << ", owner = " << request->owner()
+                         << request.filename()
+                         << ", owner = " << request.owner()
                          << ", statusCode = " << retCode
                          << ", remote side = " << cntl->remote_side();
         } else {
             LOG(ERROR) << "logid = " << cntl->log_id()
                        << ", CheckFileOwner fail, filename = "
-                       << request->filename()
-                       << ", owner = " << request->owner()
+                       << request.filename()
+                       << ", owner = " << request.owner()
                        << ", statusCode = " << retCode
                        << ", remote side = " << cntl->remote_side();
         }
@@ -1700,23 +1875,23 @@ void NameSpaceService::RefreshSession(
 
     FileInfo *fileInfo = new FileInfo();
     retCode = kCurveFS.RefreshSession(
-        request->filename(),
-        request->sessionid(),
-        request->date(),
-        request->signature(),
-        request->has_clientip() ? request->clientip() : clientIP,
-        request->has_clientport() ? request->clientport() : kInvalidPort,
+        request.filename(),
+        request.sessionid(),
+        request.date(),
+        request.signature(),
+        request.has_clientip() ? request.clientip() : clientIP,
+        request.has_clientport() ? request.clientport() : kInvalidPort,
         clientVersion,
         fileInfo);
     if (retCode != StatusCode::kOK)  {
         response->set_statuscode(retCode);
-        response->set_sessionid(request->sessionid());
+        response->set_sessionid(request.sessionid());
         if (google::ERROR != GetMdsLogLevel(retCode)) {
             LOG(WARNING) << "logid = " << cntl->log_id()
-                << ", RefreshSession fail, filename = " <<  request->filename()
-                << ", sessionid = " << request->sessionid()
-                << ", date = " << request->date()
-                << ", signature = " << request->signature()
+                << ", RefreshSession fail, filename = " <<  request.filename()
+                << ", sessionid = " << request.sessionid()
+                << ", date = " << request.date()
+                << ", signature = " << request.signature()
                 << ", clientip = " << clientIP
                 << ", clientport = " << clientPort
                 << ", statusCode = " << retCode
@@ -1724,10 +1899,10 @@ void NameSpaceService::RefreshSession(
                 << ", cost = " << expiredTime.ExpiredMs() << " ms";
         } else {
             LOG(ERROR) << "logid = " << cntl->log_id()
-                << ", RefreshSession fail, filename = " <<  request->filename()
-                << ", sessionid = " << request->sessionid()
-                << ", date = " << request->date()
-                << ", signature = " << request->signature()
+                << ", RefreshSession fail, filename = " <<  request.filename()
+                << ", sessionid = " << request.sessionid()
+                << ", date = " << request.date()
+                << ", signature = " << request.signature()
                 << ", clientip = " << clientIP
                 << ", clientport = " << clientPort
                 << ", statusCode = " << retCode
@@ -1737,14 +1912,14 @@ void NameSpaceService::RefreshSession(
         delete fileInfo;
         return;
     } else {
-        response->set_sessionid(request->sessionid());
+        response->set_sessionid(request.sessionid());
         response->set_allocated_fileinfo(fileInfo);
         response->set_statuscode(StatusCode::kOK);
         DVLOG(6) << "logid = " << cntl->log_id()
-            << ", RefreshSession ok, filename = " << request->filename()
-            << ", sessionid = " << request->sessionid()
-            << ", date = " << request->date()
-            << ", signature = " << request->signature()
+            << ", RefreshSession ok, filename = " << request.filename()
+            << ", sessionid = " << request.sessionid()
+            << ", date = " << request.date()
+            << ", signature = " << request.signature()
             << ", clientip = " << clientIP
             << ", clientport = " << clientPort
             << ", cost = " << expiredTime.ExpiredMs() << " ms";
@@ -102,6 +102,11 @@ class NameSpaceService: public CurveFSService {
         ::curve::mds::DeAllocateSegmentResponse* response,
         ::google::protobuf::Closure* done) override;
 
+    void ListSegment(::google::protobuf::RpcController* controller,
+                       const ::curve::mds::ListSegmentRequest* request,
+                       ::curve::mds::ListSegmentResponse* response,
+                       ::google::protobuf::Closure* done) override;
+
     void RenameFile(::google::protobuf::RpcController* controller,
                        const ::curve::mds::RenameFileRequest* request,
                        ::curve::mds::RenameFileResponse* response,
@@ -160,6 +165,10 @@ class NameSpaceService: public CurveFSService {
                         const ::curve::mds::ReFreshSessionRequest* request,
                         ::curve::mds::ReFreshSessionResponse* response,
                         ::google::protobuf::Closure* done) override;
+    void BatchRefreshSession(::google::protobuf::RpcController* controller,
+                const ::curve::mds::BatchRefreshSessionRequest* request,
+                ::curve::mds::BatchRefreshSessionResponse* response,
+                ::google::protobuf::Closure* done) override;
     void CreateCloneFile(::google::protobuf::RpcController* controller,
                        const ::curve::mds::CreateCloneFileRequest* request,
                        ::curve::mds::CreateCloneFileResponse* response,
@@ -197,6 +206,13 @@ class NameSpaceService: public CurveFSService {
         ::curve::mds::UpdateFileThrottleParamsResponse* response,
         ::google::protobuf::Closure* done) override;
 
+ private:
+    // handle a refresh session request of RefreshSession or
+    // BatchRefreshSession
+    void DoRefreshSession(brpc::Controller* cntl,
+                          const ::curve::mds::ReFreshSessionRequest& request,
+                          ::curve::mds::ReFreshSessionResponse* response);
+
  private:
     FileLockManager *fileLockManager_;
 };
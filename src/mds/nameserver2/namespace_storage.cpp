@@ -21,10 +21,12 @@
  */
 
 #include <glog/logging.h>
+#include <iterator>
 #include <utility>
 #include "src/mds/nameserver2/namespace_storage.h"
 #include "src/mds/nameserver2/helper/namespace_helper.h"
 #include "src/common/namespace_define.h"
+#include "src/common/timeutility.h"
 
 using ::curve::common::DISCARDSEGMENTKEYEND;
 using ::curve::common::DISCARDSEGMENTKEYPREFIX;
@@ -40,8 +42,13 @@ std::ostream &operator<<(std::ostream &os, StoreStatus &s) {
 }
 
 NameServerStorageImp::NameServerStorageImp(
-    std::shared_ptr<KVStorageClient> client, std::shared_ptr<Cache> cache)
-    : cache_(cache), client_(client), discardMetric_() {}
+    std::shared_ptr<KVStorageClient> client, std::shared_ptr<Cache> cache,
+    std::shared_ptr<FileInfoCache> fileInfoCache,
+    std::shared_ptr<SegmentPutBatcher> segmentBatcher, bool segmentAllocLog)
+    : cache_(cache), fileInfoCache_(fileInfoCache),
+      segmentBatcher_(segmentBatcher), segmentAllocLog_(segmentAllocLog),
+      segmentAllocLogTerm_(::curve::common::TimeUtility::GetTimeofDayUs()),
+      segmentAllocLogSeq_(0), client_(client), discardMetric_() {}
 
 StoreStatus NameServerStorageImp::PutFile(const FileInfo &fileInfo) {
     std::string storeKey;
@@ -62,8 +69,9 @@ StoreStatus NameServerStorageImp::PutFile(const FileInfo &fileInfo) {
                    << "] err: " << errCode;
     } else {
         // update to cache
-        cache_->Put(storeKey, encodeFileInfo);
+        PutCachedFile(storeKey, fileInfo, encodeFileInfo);
     }
+    InvalidateDir(fileInfo.parentid());
 
     return getErrorCode(errCode);
 }
@@ -78,19 +86,16 @@ StoreStatus NameServerStorageImp::GetFile(InodeID parentid,
         return StoreStatus::InternalError;
     }
 
-    int errCode = EtcdErrCode::EtcdOK;
-    std::string out;
-    if (!cache_->Get(storeKey, &out)) {
-        errCode = client_->Get(storeKey, &out);
-
-        if (errCode == EtcdErrCode::EtcdOK) {
-            cache_->Put(storeKey, out);
-        }
+    if (GetCachedFile(storeKey, fileInfo)) {
+        return StoreStatus::OK;
     }
 
+    std::string out;
+    int errCode = client_->Get(storeKey, &out);
     if (errCode == EtcdErrCode::EtcdOK) {
         bool decodeOK = NameSpaceStorageCodec::DecodeFileInfo(out, fileInfo);
         if (decodeOK) {
+            PutCachedFile(storeKey, *fileInfo, out);
             return StoreStatus::OK;
         } else {
             LOG(ERROR) << "decode info error. parentid: " << parentid
@@ -118,8 +123,9 @@ StoreStatus NameServerStorageImp::DeleteFile(InodeID id,
     }
 
     // delete cache first, then Etcd
-    cache_->Remove(storeKey);
+    RemoveCachedFile(storeKey);
     int resCode = client_->Delete(storeKey);
+    InvalidateDir(id);
 
     if (resCode != EtcdErrCode::EtcdOK) {
         LOG(ERROR) << "delete file err: " << resCode << ","
@@ -139,7 +145,7 @@ NameServerStorageImp::DeleteSnapshotFile(InodeID id,
     }
 
     // delete cache first, then Etcd
-    cache_->Remove(storeKey);
+    RemoveCachedFile(storeKey);
     int resCode = client_->Delete(storeKey);
 
     if (resCode != EtcdErrCode::EtcdOK) {
@@ -181,7 +187,7 @@ StoreStatus NameServerStorageImp::RenameFile(const FileInfo &oldFInfo,
     }
 
     // delete the data in the cache first
-    cache_->Remove(oldStoreKey);
+    RemoveCachedFile(oldStoreKey);
 
     // update Etcd
     Operation op1{OpType::OpDelete, const_cast<char *>(oldStoreKey.c_str()), "",
@@ -198,8 +204,10 @@ StoreStatus NameServerStorageImp::RenameFile(const FileInfo &oldFInfo,
                    << newFInfo.filename() << "] err: " << errCode;
     } else {
         // update to cache at last
-        cache_->Put(newStoreKey, encodeNewFileInfo);
+        PutCachedFile(newStoreKey, newFInfo, encodeNewFileInfo);
     }
+    InvalidateDir(oldFInfo.parentid());
+    InvalidateDir(newFInfo.parentid());
     return getErrorCode(errCode);
 }
 
@@ -259,8 +267,8 @@ StoreStatus NameServerStorageImp::ReplaceFileAndRecycleOldFile(
     }
 
     // delete data in cache
-    cache_->Remove(conflictStoreKey);
-    cache_->Remove(oldStoreKey);
+    RemoveCachedFile(conflictStoreKey);
+    RemoveCachedFile(oldStoreKey);
 
     // put recycleFInfo; delete oldFInfo; put newFInfo
     Operation op1{OpType::OpPut, const_cast<char *>(recycleStoreKey.c_str()),
@@ -281,9 +289,12 @@ StoreStatus NameServerStorageImp::ReplaceFileAndRecycleOldFile(
                    << newFInfo.filename() << "] err: " << errCode;
     } else {
         // update to cache
-        cache_->Put(recycleStoreKey, encodeRecycleFInfo);
-        cache_->Put(newStoreKey, encodeNewFInfo);
+        PutCachedFile(recycleStoreKey, recycleFInfo, encodeRecycleFInfo);
+        PutCachedFile(newStoreKey, newFInfo, encodeNewFInfo);
     }
+    InvalidateDir(oldFInfo.parentid());
+    InvalidateDir(newFInfo.parentid());
+    InvalidateDir(recycleFInfo.parentid());
     return getErrorCode(errCode);
 }
 
@@ -317,7 +328,7 @@ NameServerStorageImp::MoveFileToRecycle(const FileInfo &originFileInfo,
     }
 
     // delete data in cache
-    cache_->Remove(originFileInfoKey);
+    RemoveCachedFile(originFileInfoKey);
 
     // remove originFileInfo from Etcd, and put recycleFileInfo
     Operation op1{OpType::OpDelete,
@@ -336,8 +347,10 @@ NameServerStorageImp::MoveFileToRecycle(const FileInfo &originFileInfo,
                    << "] err: " << errCode;
     } else {
         // update to cache
-        cache_->Put(recycleFileInfoKey, encodeRecycleFInfo);
+        PutCachedFile(recycleFileInfoKey, recycleFileInfo, encodeRecycleFInfo);
     }
+    InvalidateDir(originFileInfo.parentid());
+    InvalidateDir(recycleFileInfo.parentid());
     return getErrorCode(errCode);
 }
 
@@ -358,7 +371,70 @@ StoreStatus NameServerStorageImp::ListFile(InodeID startid, InodeID endid,
         return StoreStatus::InternalError;
     }
 
-    return ListFileInternal(startStoreKey, endStoreKey, files);
+    // only the listing of a single directory is cached
+    if (fileInfoCache_ == nullptr || endid != startid + 1) {
+        return ListFileInternal(startStoreKey, endStoreKey, files);
+    }
+
+    if (fileInfoCache_->ListDir(startid, files)) {
+        return StoreStatus::OK;
+    }
+
+    uint64_t token = fileInfoCache_->BeginListDir(startid);
+    std::vector<FileInfo> children;
+    res = ListFileInternal(startStoreKey, endStoreKey, &children);
+    if (res != StoreStatus::OK) {
+        return res;
+    }
+
+    fileInfoCache_->FinishListDir(startid, token, children);
+    files->insert(files->end(), std::make_move_iterator(children.begin()),
+                  std::make_move_iterator(children.end()));
+    return StoreStatus::OK;
+}
+
+StoreStatus NameServerStorageImp::ListFilePage(InodeID id,
+                                               const std::string &startAfter,
+                                               uint32_t limit,
+                                               std::vector<FileInfo> *files,
+                                               bool *hasMore) {
+    assert(limit > 0);
+    // keys of a directory are ordered by filename, the smallest key after
+    // startAfter is itself followed by '\0'
+    std::string startStoreKey =
+        NameSpaceStorageCodec::EncodeFileStoreKey(id, startAfter);
+    if (!startAfter.empty()) {
+        startStoreKey.push_back('\0');
+    }
+    std::string endStoreKey =
+        NameSpaceStorageCodec::EncodeFileStoreKey(id + 1, "");
+
+    // one more file to tell whether there are more
+    std::vector<std::string> out;
+    std::string lastKey;
+    int errCode = client_->ListWithLimitAndRevision(
+        startStoreKey, endStoreKey, static_cast<int64_t>(limit) + 1, 0, &out,
+        &lastKey);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "list file page err: " << errCode << ", inodeid: " << id
+                   << ", startAfter: " << startAfter;
+        return getErrorCode(errCode);
+    }
+
+    *hasMore = out.size() > limit;
+    if (*hasMore) {
+        out.resize(limit);
+    }
+
+    for (const auto &value : out) {
+        FileInfo fileInfo;
+        if (!NameSpaceStorageCodec::DecodeFileInfo(value, &fileInfo)) {
+            LOG(ERROR) << "decode one fileInfo err";
+            return StoreStatus::InternalError;
+        }
+        files->emplace_back(std::move(fileInfo));
+    }
+    return StoreStatus::OK;
 }
 
 StoreStatus
@@ -448,7 +524,31 @@ StoreStatus NameServerStorageImp::PutSegment(InodeID id, uint64_t off,
         return StoreStatus::InternalError;
     }
 
-    int errCode = client_->PutRewithRevision(storeKey, encodeSegment, revision);
+    int errCode;
+    if (!segmentAllocLog_) {
+        errCode = segmentBatcher_ != nullptr
+            ? segmentBatcher_->Put(storeKey, encodeSegment, revision)
+            : client_->PutRewithRevision(storeKey, encodeSegment, revision);
+    } else {
+        std::string logKey;
+        std::string logValue;
+        NewSegmentAllocLog(segment->logicalpoolid(), segment->segmentsize(),
+                           &logKey, &logValue);
+        if (segmentBatcher_ != nullptr) {
+            errCode = segmentBatcher_->Put(storeKey, encodeSegment, logKey,
+                                           logValue, revision);
+        } else {
+            Operation op1{OpType::OpPut, const_cast<char *>(storeKey.c_str()),
+                          const_cast<char *>(encodeSegment.c_str()),
+                          static_cast<int>(storeKey.size()),
+                          static_cast<int>(encodeSegment.size())};
+            Operation op2{OpType::OpPut, const_cast<char *>(logKey.c_str()),
+                          const_cast<char *>(logValue.c_str()),
+                          static_cast<int>(logKey.size()),
+                          static_cast<int>(logValue.size())};
+            errCode = client_->TxnNWithRevision({op1, op2}, revision);
+        }
+    }
     if (errCode != EtcdErrCode::EtcdOK) {
         LOG(ERROR) << "put segment of logicalPoolId:"
                    << segment->logicalpoolid() << "err:" << errCode;
@@ -490,7 +590,18 @@ StoreStatus NameServerStorageImp::DeleteSegment(InodeID id, uint64_t off,
                                                 int64_t *revision) {
     std::string storeKey =
         NameSpaceStorageCodec::EncodeSegmentStoreKey(id, off);
-    int errCode = client_->DeleteRewithRevision(storeKey, revision);
+    int errCode = EtcdErrCode::EtcdOK;
+    PageFileSegment segment;
+    if (!segmentAllocLog_) {
+        errCode = client_->DeleteRewithRevision(storeKey, revision);
+    } else if (GetSegment(id, off, &segment) == StoreStatus::OK) {
+        errCode = DeleteWithSegmentAllocLog(
+            storeKey, segment.logicalpoolid(),
+            -static_cast<int64_t>(segment.segmentsize()), revision);
+    } else {
+        // not exist or unreadable, nothing to log
+        errCode = client_->DeleteRewithRevision(storeKey, revision);
+    }
 
     // update the cache first, then update Etcd
     cache_->Remove(storeKey);
@@ -576,7 +687,18 @@ NameServerStorageImp::DiscardSegment(const FileInfo &fileInfo,
 StoreStatus NameServerStorageImp::CleanDiscardSegment(uint64_t segmentSize,
                                                       const std::string &key,
                                                       int64_t *revision) {
-    int errCode = client_->DeleteRewithRevision(key, revision);
+    int errCode = EtcdErrCode::EtcdOK;
+    std::string value;
+    DiscardSegmentInfo info;
+    if (segmentAllocLog_ && client_->Get(key, &value) == EtcdErrCode::EtcdOK &&
+        NameSpaceStorageCodec::DecodeDiscardSegment(value, &info)) {
+        errCode = DeleteWithSegmentAllocLog(
+            key, info.pagefilesegment().logicalpoolid(),
+            -static_cast<int64_t>(info.pagefilesegment().segmentsize()),
+            revision);
+    } else {
+        errCode = client_->DeleteRewithRevision(key, revision);
+    }
     if (errCode != EtcdErrCode::EtcdOK) {
         LOG(ERROR) << "CleanDiscardSegment failed, key = " << key
                    << ", err = " << errCode;
@@ -587,6 +709,30 @@ StoreStatus NameServerStorageImp::CleanDiscardSegment(uint64_t segmentSize,
     return getErrorCode(errCode);
 }
 
+void NameServerStorageImp::NewSegmentAllocLog(uint16_t lid, int64_t change,
+                                              std::string *key,
+                                              std::string *value) {
+    *key = NameSpaceStorageCodec::EncodeSegmentAllocLogKey(
+        segmentAllocLogTerm_, segmentAllocLogSeq_.fetch_add(1));
+    *value = NameSpaceStorageCodec::EncodeSegmentAllocLogValue(lid, change);
+}
+
+int NameServerStorageImp::DeleteWithSegmentAllocLog(const std::string &key,
+                                                    uint16_t lid,
+                                                    int64_t change,
+                                                    int64_t *revision) {
+    std::string logKey;
+    std::string logValue;
+    NewSegmentAllocLog(lid, change, &logKey, &logValue);
+    Operation op1{OpType::OpDelete, const_cast<char *>(key.c_str()), "",
+                  static_cast<int>(key.size()), 0};
+    Operation op2{OpType::OpPut, const_cast<char *>(logKey.c_str()),
+                  const_cast<char *>(logValue.c_str()),
+                  static_cast<int>(logKey.size()),
+                  static_cast<int>(logValue.size())};
+    return client_->TxnNWithRevision({op1, op2}, revision);
+}
+
 StoreStatus NameServerStorageImp::SnapShotFile(const FileInfo *originFInfo,
                                                const FileInfo *snapshotFInfo) {
     std::string originFileKey;
@@ -620,7 +766,7 @@ StoreStatus NameServerStorageImp::SnapShotFile(const FileInfo *originFInfo,
     }
 
     // delete the information in cache first
-    cache_->Remove(originFileKey);
+    RemoveCachedFile(originFileKey);
 
     // then update Etcd
     Operation op1{OpType::OpPut, const_cast<char *>(originFileKey.c_str()),
@@ -641,9 +787,10 @@ StoreStatus NameServerStorageImp::SnapShotFile(const FileInfo *originFInfo,
                    << ", fileinfo: " << originFInfo->filename() << "err";
     } else {
         // update cache at last
-        cache_->Put(originFileKey, encodeFileInfo);
-        cache_->Put(snapshotFileKey, encodeSnapshot);
+        PutCachedFile(originFileKey, *originFInfo, encodeFileInfo);
+        PutCachedFile(snapshotFileKey, *snapshotFInfo, encodeSnapshot);
     }
+    InvalidateDir(originFInfo->parentid());
     return getErrorCode(errCode);
 }
 
@@ -653,6 +800,43 @@ NameServerStorageImp::LoadSnapShotFile(std::vector<FileInfo> *snapshotFiles) {
                             snapshotFiles);
 }
 
+bool NameServerStorageImp::GetCachedFile(const std::string &storeKey,
+                                         FileInfo *fileInfo) {
+    if (fileInfoCache_ != nullptr) {
+        return fileInfoCache_->GetFile(storeKey, fileInfo);
+    }
+
+    std::string out;
+    return cache_->Get(storeKey, &out) &&
+           NameSpaceStorageCodec::DecodeFileInfo(out, fileInfo);
+}
+
+void NameServerStorageImp::PutCachedFile(const std::string &storeKey,
+                                         const FileInfo &fileInfo,
+                                         const std::string &encodeFileInfo) {
+    if (fileInfoCache_ != nullptr) {
+        fileInfoCache_->PutFile(storeKey, fileInfo);
+    } else {
+        cache_->Put(storeKey, encodeFileInfo);
+    }
+}
+
+void NameServerStorageImp::RemoveCachedFile(const std::string &storeKey) {
+    if (fileInfoCache_ != nullptr) {
+        fileInfoCache_->RemoveFile(storeKey);
+    } else {
+        cache_->Remove(storeKey);
+    }
+}
+
+void NameServerStorageImp::InvalidateDir(InodeID dirId) {
+    // invalidated after the write, a listing started before it may have
+    // read the old children
+    if (fileInfoCache_ != nullptr) {
+        fileInfoCache_->InvalidateDir(dirId);
+    }
+}
+
 StoreStatus NameServerStorageImp::getErrorCode(int errCode) {
     switch (errCode) {
     case EtcdErrCode::EtcdOK:
@@ -22,6 +22,7 @@
 #ifndef SRC_MDS_NAMESERVER2_NAMESPACE_STORAGE_H_
 #define SRC_MDS_NAMESERVER2_NAMESPACE_STORAGE_H_
 
+#include <atomic>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -35,6 +36,8 @@
 #include "src/kvstorageclient/etcd_client.h"
 #include "src/mds/nameserver2/metric.h"
 #include "src/common/lru_cache.h"
+#include "src/mds/nameserver2/file_info_cache.h"
+#include "src/mds/nameserver2/segment_put_batcher.h"
 
 namespace curve {
 namespace mds {
@@ -159,6 +162,25 @@ class NameServerStorage {
                                 InodeID endid,
                                 std::vector<FileInfo> * files) = 0;
 
+    /**
+     * @brief ListFilePage: Get files of a directory in order of filename,
+     *                      at most limit files after startAfter
+     *
+     * @param[in] id: Inode ID of the directory
+     * @param[in] startAfter: list files after this filename, empty means
+     *                        from the first file
+     * @param[in] limit: max number of files
+     * @param[out] files
+     * @param[out] hasMore: whether there are files after the last one
+     *
+     * @return StoreStatus: error code
+     */
+    virtual StoreStatus ListFilePage(InodeID id,
+                                     const std::string &startAfter,
+                                     uint32_t limit,
+                                     std::vector<FileInfo> *files,
+                                     bool *hasMore) = 0;
+
     /**
      * @brief ListSegment: Get all the segments between [startid, endid)
      *
@@ -279,8 +301,22 @@ class NameServerStorage {
 
 class NameServerStorageImp : public NameServerStorage {
  public:
-    explicit NameServerStorageImp(
-        std::shared_ptr<KVStorageClient> client, std::shared_ptr<Cache> cache);
+    /**
+     * @param[in] client: underlying kv storage
+     * @param[in] cache: cache of encoded segments, and of encoded FileInfo
+     *                   if fileInfoCache is nullptr
+     * @param[in] fileInfoCache: cache of parsed FileInfo and directory
+     *                           listings, nullptr means disabled
+     * @param[in] segmentBatcher: group commit of PutSegment, nullptr means
+     *                            every segment is put by its own
+     * @param[in] segmentAllocLog: whether to write the change log of segment
+     *                             alloc in the same txn as the segment
+     */
+    NameServerStorageImp(
+        std::shared_ptr<KVStorageClient> client, std::shared_ptr<Cache> cache,
+        std::shared_ptr<FileInfoCache> fileInfoCache = nullptr,
+        std::shared_ptr<SegmentPutBatcher> segmentBatcher = nullptr,
+        bool segmentAllocLog = false);
     ~NameServerStorageImp() {}
 
     StoreStatus PutFile(const FileInfo & fileInfo) override;
@@ -310,6 +346,12 @@ class NameServerStorageImp : public NameServerStorage {
                         InodeID endid,
                         std::vector<FileInfo> * files) override;
 
+    StoreStatus ListFilePage(InodeID id,
+                             const std::string &startAfter,
+                             uint32_t limit,
+                             std::vector<FileInfo> *files,
+                             bool *hasMore) override;
+
     StoreStatus ListSegment(InodeID id,
                             std::vector<PageFileSegment> *segments) override;
 
@@ -354,10 +396,35 @@ class NameServerStorageImp : public NameServerStorage {
                             std::string* storekey);
     StoreStatus getErrorCode(int errCode);
 
+    bool GetCachedFile(const std::string& storeKey, FileInfo* fileInfo);
+    void PutCachedFile(const std::string& storeKey, const FileInfo& fileInfo,
+                       const std::string& encodeFileInfo);
+    void RemoveCachedFile(const std::string& storeKey);
+    // children of the directory changed
+    void InvalidateDir(InodeID dirId);
+
+    // change log of segment alloc, see AllocStatistic
+    void NewSegmentAllocLog(uint16_t lid, int64_t change, std::string* key,
+                            std::string* value);
+    // delete the key together with its segment alloc change log
+    int DeleteWithSegmentAllocLog(const std::string& key, uint16_t lid,
+                                  int64_t change, int64_t* revision);
+
  private:
     // namespace-meta cache
     std::shared_ptr<Cache> cache_;
 
+    // parsed FileInfo and directory listings
+    std::shared_ptr<FileInfoCache> fileInfoCache_;
+
+    // batches concurrent PutSegment into etcd txns
+    std::shared_ptr<SegmentPutBatcher> segmentBatcher_;
+
+    const bool segmentAllocLog_;
+    // change log keys are unique among mds processes and in one process
+    const uint64_t segmentAllocLogTerm_;
+    std::atomic<uint64_t> segmentAllocLogSeq_;
+
     // underlying storage
     std::shared_ptr<KVStorageClient> client_;
 
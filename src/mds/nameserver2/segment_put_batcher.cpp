@@ -0,0 +1,158 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/mds/nameserver2/segment_put_batcher.h"
+
+#include <glog/logging.h>
+
+#include <set>
+#include <utility>
+
+namespace curve {
+namespace mds {
+
+using ::curve::common::UniqueLock;
+
+SegmentPutBatcher::SegmentPutBatcher(std::shared_ptr<KVStorageClient> client,
+                                     uint32_t maxBatch)
+    : client_(std::move(client)),
+      maxBatch_(maxBatch),
+      committing_(false),
+      batchSize_("mds_nameserver_segment_put_batch_size") {}
+
+int SegmentPutBatcher::Put(const std::string &key, const std::string &value,
+                           int64_t *revision) {
+    Request request;
+    request.key = &key;
+    request.value = &value;
+    return Put(&request, revision);
+}
+
+int SegmentPutBatcher::Put(const std::string &key, const std::string &value,
+                           const std::string &extraKey,
+                           const std::string &extraValue, int64_t *revision) {
+    Request request;
+    request.key = &key;
+    request.value = &value;
+    request.extraKey = &extraKey;
+    request.extraValue = &extraValue;
+    return Put(&request, revision);
+}
+
+int SegmentPutBatcher::Put(Request *request, int64_t *revision) {
+    UniqueLock lk(mtx_);
+    queue_.push_back(request);
+    while (!request->done) {
+        if (committing_) {
+            cond_.wait(lk);
+            continue;
+        }
+
+        // no txn in flight, commit the queued puts on behalf of their callers
+        std::vector<Request *> batch;
+        TakeBatch(&batch);
+        committing_ = true;
+        lk.unlock();
+
+        Commit(batch);
+
+        lk.lock();
+        for (auto *r : batch) {
+            r->done = true;
+        }
+        committing_ = false;
+        cond_.notify_all();
+    }
+
+    if (request->errCode == EtcdErrCode::EtcdOK) {
+        *revision = request->revision;
+    }
+    return request->errCode;
+}
+
+void SegmentPutBatcher::TakeBatch(std::vector<Request *> *batch) {
+    // etcd rejects a txn which puts the same key twice
+    std::set<std::string> keys;
+    uint32_t opNum = 0;
+    while (!queue_.empty()) {
+        Request *r = queue_.front();
+        uint32_t n = r->extraKey == nullptr ? 1 : 2;
+        if (!batch->empty() && opNum + n > maxBatch_) {
+            break;
+        }
+        if (!keys.insert(*r->key).second ||
+            (r->extraKey != nullptr && !keys.insert(*r->extraKey).second)) {
+            break;
+        }
+        batch->push_back(r);
+        queue_.pop_front();
+        opNum += n;
+    }
+}
+
+void SegmentPutBatcher::Commit(const std::vector<Request *> &batch) {
+    batchSize_ << batch.size();
+
+    auto appendOps = [](const Request *r, std::vector<Operation> *ops) {
+        ops->push_back(Operation{
+            OpType::OpPut, const_cast<char *>(r->key->c_str()),
+            const_cast<char *>(r->value->c_str()),
+            static_cast<int>(r->key->size()),
+            static_cast<int>(r->value->size())});
+        if (r->extraKey != nullptr) {
+            ops->push_back(Operation{
+                OpType::OpPut, const_cast<char *>(r->extraKey->c_str()),
+                const_cast<char *>(r->extraValue->c_str()),
+                static_cast<int>(r->extraKey->size()),
+                static_cast<int>(r->extraValue->size())});
+        }
+    };
+
+    if (batch.size() > 1) {
+        std::vector<Operation> ops;
+        ops.reserve(2 * batch.size());
+        for (auto *r : batch) {
+            appendOps(r, &ops);
+        }
+
+        int64_t revision = 0;
+        int errCode = client_->TxnNWithRevision(ops, &revision);
+        if (errCode == EtcdErrCode::EtcdOK) {
+            for (auto *r : batch) {
+                r->errCode = errCode;
+                r->revision = revision;
+            }
+            return;
+        }
+
+        LOG(WARNING) << "put " << batch.size() << " segments in one txn "
+                     << "failed, err: " << errCode << ", put one by one";
+    }
+
+    for (auto *r : batch) {
+        if (r->extraKey == nullptr) {
+            r->errCode =
+                client_->PutRewithRevision(*r->key, *r->value, &r->revision);
+        } else {
+            std::vector<Operation> ops;
+            appendOps(r, &ops);
+            r->errCode = client_->TxnNWithRevision(ops, &r->revision);
+        }
+    }
+}
+
+}  // namespace mds
+}  // namespace curve
@@ -0,0 +1,113 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_MDS_NAMESERVER2_SEGMENT_PUT_BATCHER_H_
+#define SRC_MDS_NAMESERVER2_SEGMENT_PUT_BATCHER_H_
+
+#include <bvar/bvar.h>
+
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/concurrent/concurrent.h"
+#include "src/kvstorageclient/etcd_client.h"
+
+namespace curve {
+namespace mds {
+
+using ::curve::kvstorage::KVStorageClient;
+
+/**
+ * Group commit of segment puts. Concurrent callers queue their key-value,
+ * one of them commits up to maxBatch queued puts in a single etcd txn while
+ * the others wait, then the next waiting caller commits the puts queued in
+ * the meantime. All puts of a txn get the revision of the txn.
+ *
+ * If a txn fails, its puts are retried one by one, so every caller gets the
+ * result of its own put.
+ *
+ * A put may carry a second key-value, e.g. the change log of segment alloc,
+ * which is always committed in the same txn as the first one.
+ */
+class SegmentPutBatcher {
+ public:
+    /**
+     * @param[in] client: underlying kv storage
+     * @param[in] maxBatch: max number of ops in one txn, must not exceed
+     *                      the --max-txn-ops of etcd
+     */
+    SegmentPutBatcher(std::shared_ptr<KVStorageClient> client,
+                      uint32_t maxBatch);
+
+    /**
+     * @brief Put a key-value, blocks until it is committed
+     *
+     * @param[out] revision: the version number of this operation
+     *
+     * @return error code of etcd
+     */
+    int Put(const std::string &key, const std::string &value,
+            int64_t *revision);
+
+    /**
+     * @brief Put two key-values atomically, blocks until they are committed
+     */
+    int Put(const std::string &key, const std::string &value,
+            const std::string &extraKey, const std::string &extraValue,
+            int64_t *revision);
+
+ private:
+    struct Request {
+        const std::string *key;
+        const std::string *value;
+        // nullptr if there is only one key-value
+        const std::string *extraKey = nullptr;
+        const std::string *extraValue = nullptr;
+        int errCode = 0;
+        int64_t revision = 0;
+        bool done = false;
+    };
+
+    int Put(Request *request, int64_t *revision);
+
+    // take the puts of next txn from the queue, called with the lock held
+    void TakeBatch(std::vector<Request *> *batch);
+
+    // commit the puts, called without the lock
+    void Commit(const std::vector<Request *> &batch);
+
+ private:
+    std::shared_ptr<KVStorageClient> client_;
+    const uint32_t maxBatch_;
+
+    ::curve::common::Mutex mtx_;
+    std::condition_variable cond_;
+    std::deque<Request *> queue_;
+    // whether some caller is committing a txn
+    bool committing_;
+
+    // number of puts in each txn
+    bvar::IntRecorder batchSize_;
+};
+
+}  // namespace mds
+}  // namespace curve
+
+#endif  // SRC_MDS_NAMESERVER2_SEGMENT_PUT_BATCHER_H_
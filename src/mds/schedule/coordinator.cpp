@@ -48,6 +48,9 @@ DEFINE_bool(enableRecoverScheduler, true, "switch of recover scheduler");
 DEFINE_validator(enableRecoverScheduler, &pass_bool);
 DEFINE_bool(enableScanScheduler, true, "switch of scan scheduler");
 DEFINE_validator(enableScanScheduler, &pass_bool);
+DEFINE_bool(enableLeaderLoadScheduler, true,
+            "switch of leader load scheduler");
+DEFINE_validator(enableLeaderLoadScheduler, &pass_bool);
 
 Coordinator::Coordinator(const std::shared_ptr<TopoAdapter> &topo) {
     this->topo_ = topo;
@@ -93,6 +96,12 @@ void Coordinator::InitScheduler(
             std::make_shared<ScanScheduler>(conf, topo_, opController_);
         LOG(INFO) << "init scan scheduler ok!";
     }
+
+    if (conf.enableLeaderLoadScheduler) {
+        schedulerController_[SchedulerType::LeaderLoadSchedulerType] =
+            std::make_shared<LeaderLoadScheduler>(conf, topo_, opController_);
+        LOG(INFO) << "init leader load scheduler ok!";
+    }
 }
 
 void Coordinator::Run() {
@@ -339,6 +348,9 @@ bool Coordinator::ScheduleNeedRun(SchedulerType type) {
         case SchedulerType::ScanSchedulerType:
             return FLAGS_enableScanScheduler;
 
+        case SchedulerType::LeaderLoadSchedulerType:
+            return FLAGS_enableLeaderLoadScheduler;
+
         default:
             return false;
     }
@@ -361,6 +373,9 @@ std::string Coordinator::ScheduleName(SchedulerType type) {
         case SchedulerType::ScanSchedulerType:
             return "ScanScheduler";
 
+        case SchedulerType::LeaderLoadSchedulerType:
+            return "LeaderLoadScheduler";
+
         default:
             return "Unknown";
     }
@@ -0,0 +1,264 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <glog/logging.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include "src/common/timeutility.h"
+#include "src/mds/schedule/scheduler.h"
+#include "src/mds/schedule/operatorFactory.h"
+
+namespace curve {
+namespace mds {
+namespace schedule {
+
+namespace {
+
+struct LeaderTransfer {
+    const CopySetInfo *copyset;
+    ChunkServerIdType target;
+    // the higher leader load of the source and the target after transfer
+    double peak;
+};
+
+}  // namespace
+
+int LeaderLoadScheduler::Schedule() {
+    LOG(INFO) << "schedule: leaderLoadScheduler begin.";
+    int oneRoundGenOp = 0;
+    for (auto lid : topo_->GetLogicalpools()) {
+        oneRoundGenOp += DoLeaderLoadSchedule(lid);
+    }
+
+    LOG(INFO) << "schedule: leaderLoadScheduler end, generate operator num "
+              << oneRoundGenOp;
+    return oneRoundGenOp;
+}
+
+double LeaderLoadScheduler::CopySetLoad(const CopysetStatistics &stats,
+                                        double avgIops, double avgBandwidth) {
+    double load = 0;
+    if (avgIops > 0) {
+        load += (static_cast<double>(stats.readiops()) + stats.writeiops()) /
+                avgIops;
+    }
+    if (avgBandwidth > 0) {
+        load += (static_cast<double>(stats.readrate()) + stats.writerate()) /
+                avgBandwidth;
+    }
+    return load;
+}
+
+int LeaderLoadScheduler::DoLeaderLoadSchedule(PoolIdType lid) {
+    std::map<CopySetKey, CopysetStatistics> stats =
+        topo_->GetCopySetStatsInLogicalPool(lid);
+    if (stats.empty()) {
+        return 0;
+    }
+
+    // chunkservers that can serve leaders
+    std::map<ChunkServerIdType, ChunkServerInfo> chunkservers;
+    for (auto &csInfo : topo_->GetChunkServersInLogicalPool(lid)) {
+        if (csInfo.IsOffline() || csInfo.IsPendding()) {
+            continue;
+        }
+        chunkservers.emplace(csInfo.info.id, csInfo);
+    }
+    if (chunkservers.size() < 2) {
+        return 0;
+    }
+
+    double iopsSum = 0;
+    double bandwidthSum = 0;
+    for (auto &item : stats) {
+        iopsSum += static_cast<double>(item.second.readiops()) +
+                   item.second.writeiops();
+        bandwidthSum += static_cast<double>(item.second.readrate()) +
+                        item.second.writerate();
+    }
+    double avgIops = iopsSum / chunkservers.size();
+    double avgBandwidth = bandwidthSum / chunkservers.size();
+
+    // leader load of chunkservers, which is the sum of their leaders' load
+    std::vector<CopySetInfo> copysets =
+        topo_->GetCopySetInfosInLogicalPool(lid);
+    std::map<CopySetKey, double> copysetLoads;
+    std::map<ChunkServerIdType, double> leaderLoads;
+    for (auto &item : chunkservers) {
+        leaderLoads.emplace(item.first, 0);
+    }
+    double loadSum = 0;
+    for (auto &info : copysets) {
+        auto statIt = stats.find(info.id);
+        auto leaderIt = leaderLoads.find(info.leader);
+        if (statIt == stats.end() || leaderIt == leaderLoads.end()) {
+            continue;
+        }
+        double load = CopySetLoad(statIt->second, avgIops, avgBandwidth);
+        copysetLoads.emplace(info.id, load);
+        leaderIt->second += load;
+        loadSum += load;
+    }
+    if (loadSum <= 0) {
+        return 0;
+    }
+
+    // a chunkserver is hot only if its leader load exceeds the limit, and
+    // after a transfer the target should be colder than the source before by
+    // the margin, so a leader is never transferred back by the same rule
+    double avgLoad = loadSum / chunkservers.size();
+    double limit = avgLoad * (1 + loadRangePercent_);
+    double margin = avgLoad * loadRangePercent_;
+    uint64_t now = ::curve::common::TimeUtility::GetTimeofDaySec();
+    ChunkServerIdType source = UNINTIALIZE_ID;
+    double sourceLoad = 0;
+    for (auto &item : leaderLoads) {
+        if (item.second > sourceLoad && !loadCooling(item.first, now)) {
+            source = item.first;
+            sourceLoad = item.second;
+        }
+    }
+
+    LOG(INFO) << "leaderLoadScheduler select chunkserver " << source
+              << " with leader load " << sourceLoad << ", limit " << limit
+              << " in logical pool " << lid;
+    if (source == UNINTIALIZE_ID || sourceLoad <= limit) {
+        LOG(INFO) << "leaderLoadScheduler no need to generate "
+                  << "transferLeader op";
+        return 0;
+    }
+
+    auto canBeTarget = [&](ChunkServerIdType id) {
+        auto it = chunkservers.find(id);
+        return it != chunkservers.end() && !loadCooling(id, now) &&
+               coolingTimeExpired(it->second.startUpTime);
+    };
+    auto canTransfer = [&](const CopySetInfo &info) {
+        Operator op;
+        return !info.HasCandidate() &&
+               !opController_->GetOperatorById(info.id, &op) &&
+               CopysetAllPeersOnline(info);
+    };
+
+    // candidate transfers of the leaders on the source
+    std::vector<LeaderTransfer> transfers;
+    for (auto &info : copysets) {
+        auto loadIt = copysetLoads.find(info.id);
+        if (info.leader != source || loadIt == copysetLoads.end() ||
+            loadIt->second <= 0 || !canTransfer(info)) {
+            continue;
+        }
+        for (auto &peer : info.peers) {
+            if (peer.id == source || !canBeTarget(peer.id)) {
+                continue;
+            }
+            double targetLoad = leaderLoads[peer.id] + loadIt->second;
+            if (targetLoad > sourceLoad - margin) {
+                continue;
+            }
+            transfers.push_back(LeaderTransfer{&info, peer.id,
+                std::max(sourceLoad - loadIt->second, targetLoad)});
+        }
+    }
+    std::sort(transfers.begin(), transfers.end(),
+              [](const LeaderTransfer &a, const LeaderTransfer &b) {
+                  return a.peak < b.peak;
+              });
+
+    for (auto &transfer : transfers) {
+        ChunkServerIdType target = transfer.target;
+        double load = copysetLoads[transfer.copyset->id];
+
+        // to keep the leader number balanced, swap with the coldest leader on
+        // the target which can be transferred to the source
+        const CopySetInfo *swap = nullptr;
+        if (coolingTimeExpired(chunkservers[source].startUpTime)) {
+            for (auto &info : copysets) {
+                auto loadIt = copysetLoads.find(info.id);
+                double swapLoad =
+                    loadIt == copysetLoads.end() ? 0 : loadIt->second;
+                if (info.leader != target || !info.ContainPeer(source) ||
+                    swapLoad >= load || !canTransfer(info)) {
+                    continue;
+                }
+                if (swap == nullptr || swapLoad < copysetLoads[swap->id]) {
+                    swap = &info;
+                }
+            }
+        }
+
+        // or the leader number of the target should not exceed the source,
+        // otherwise LeaderScheduler transfers other leaders back
+        if (swap == nullptr && chunkservers[target].leaderCount >=
+                               chunkservers[source].leaderCount) {
+            continue;
+        }
+
+        Operator op = operatorFactory.CreateTransferLeaderOperator(
+            *transfer.copyset, target, OperatorPriority::NormalPriority);
+        op.timeLimit = std::chrono::seconds(transTimeSec_);
+        if (!opController_->AddOperator(op)) {
+            continue;
+        }
+        int oneRoundGenOp = 1;
+        LOG(INFO) << "leaderLoadScheduler generate operator "
+                  << op.OpToString() << " for "
+                  << transfer.copyset->CopySetInfoStr() << " with load "
+                  << load;
+
+        if (swap != nullptr) {
+            Operator swapOp = operatorFactory.CreateTransferLeaderOperator(
+                *swap, source, OperatorPriority::NormalPriority);
+            swapOp.timeLimit = std::chrono::seconds(transTimeSec_);
+            if (opController_->AddOperator(swapOp)) {
+                oneRoundGenOp++;
+                LOG(INFO) << "leaderLoadScheduler generate operator "
+                          << swapOp.OpToString() << " for "
+                          << swap->CopySetInfoStr() << " with load "
+                          << copysetLoads[swap->id];
+            }
+        }
+
+        lastTransferSec_[source] = now;
+        lastTransferSec_[target] = now;
+        return oneRoundGenOp;
+    }
+
+    LOG(INFO) << "leaderLoadScheduler can not find leader to transfer out of "
+              << "chunkserver " << source;
+    return 0;
+}
+
+bool LeaderLoadScheduler::coolingTimeExpired(uint64_t startUpTime) {
+    if (startUpTime == 0) {
+        return false;
+    }
+
+    uint64_t now = ::curve::common::TimeUtility::GetTimeofDaySec();
+    return now - startUpTime > chunkserverCoolingTimeSec_;
+}
+
+bool LeaderLoadScheduler::loadCooling(ChunkServerIdType id, uint64_t nowSec) {
+    auto it = lastTransferSec_.find(id);
+    return it != lastTransferSec_.end() &&
+           nowSec < it->second + loadCoolingTimeSec_;
+}
+
+int64_t LeaderLoadScheduler::GetRunningInterval() { return runInterval_; }
+}  // namespace schedule
+}  // namespace mds
+}  // namespace curve
@@ -21,28 +21,60 @@
  */
 
 #include <glog/logging.h>
+#include <algorithm>
 #include "src/mds/common/mds_define.h"
 #include "src/mds/schedule/scheduler.h"
 #include "src/mds/schedule/operatorFactory.h"
+#include "src/mds/schedule/operatorStep.h"
 
 using ::curve::mds::topology::UNINTIALIZE_ID;
 
 namespace curve {
 namespace mds {
 namespace schedule {
+namespace {
+
+// a copyset with offline replicas to recover
+struct RecoverTask {
+    CopySetInfo info;
+    std::set<ChunkServerIdType> offlinelists;
+    // the number of online replicas, the fewer the higher risk of data loss
+    int liveNum;
+    // the leader copying data to the new replica, if it is online
+    ChunkServerIdType source;
+};
+
+}  // namespace
+
 int RecoverScheduler::Schedule() {
     LOG(INFO) << "recoverScheduler begin.";
     int oneRoundGenOp = 0;
 
+    std::vector<ChunkServerInfo> chunkServers = topo_->GetChunkServerInfos();
+    peers_.clear();
+    chunkServerRecovering_.clear();
+    serverRecovering_.clear();
+    zoneRecovering_.clear();
+    for (auto &cs : chunkServers) {
+        peers_.emplace(cs.info.id, cs.info);
+    }
+
     // if over certain amount of chunkserver are downed on a server, these
     // chunkservers will be collected to the set excludes.
     std::set<ChunkServerIdType> excludes;
-    CalculateExcludesChunkServer(&excludes);
+    CalculateExcludesChunkServer(chunkServers, &excludes);
 
+    std::vector<RecoverTask> tasks;
     for (auto copysetInfo : topo_->GetCopySetInfos()) {
         // skip the copyset under configuration change
         Operator op;
         if (opController_->GetOperatorById(copysetInfo.id, &op)) {
+            // data copying in progress is counted in the budgets
+            if (dynamic_cast<ChangePeer *>(op.step.get()) != nullptr ||
+                dynamic_cast<AddPeer *>(op.step.get()) != nullptr) {
+                CountRecovering(
+                    {copysetInfo.leader, op.step->GetTargetPeer()});
+            }
             continue;
         }
 
@@ -54,6 +86,8 @@ int RecoverScheduler::Schedule() {
         }
 
         std::set<ChunkServerIdType> offlinelists;
+        int liveNum = 0;
+        ChunkServerIdType source = UNINTIALIZE_ID;
         // check if there's any offline replica
         for (auto peer : copysetInfo.peers) {
             ChunkServerInfo csInfo;
@@ -63,6 +97,12 @@ int RecoverScheduler::Schedule() {
                 continue;
             }
 
+            if (csInfo.IsOnline()) {
+                liveNum++;
+                if (peer.id == copysetInfo.leader) {
+                    source = peer.id;
+                }
+            }
             if (!csInfo.IsOffline()) {
                 continue;
             } else {
@@ -104,12 +144,33 @@ int RecoverScheduler::Schedule() {
             continue;
         }
 
+        tasks.emplace_back(
+            RecoverTask{copysetInfo, offlinelists, liveNum, source});
+    }
+
+    // the copysets with fewer live replicas are recovered first, before the
+    // concurrency and the budgets are used up by the others
+    std::stable_sort(tasks.begin(), tasks.end(),
+                     [](const RecoverTask &a, const RecoverTask &b) {
+                         return a.liveNum < b.liveNum;
+                     });
+
+    for (auto &task : tasks) {
+        const CopySetInfo &copysetInfo = task.info;
+        ChunkServerIdType offlinePeer = *task.offlinelists.begin();
         // recover one of the offline replica
         Operator fixRes;
         ChunkServerIdType target;
         // failed to recover the replica
-        if (!FixOfflinePeer(copysetInfo, *offlinelists.begin(), &fixRes,
-                            &target)) {
+        if (!FixOfflinePeer(copysetInfo, offlinePeer, &fixRes, &target)) {
+            continue;
+            // the leader is busy copying data for the other copysets
+        } else if (target != UNINTIALIZE_ID &&
+                   task.source != UNINTIALIZE_ID &&
+                   ExceedRecoverBudget(task.source)) {
+            LOG(INFO) << "recoverScheduler delay recovering "
+                      << copysetInfo.CopySetInfoStr() << ", leader "
+                      << task.source << " exceeds recover budget";
             continue;
             // succeeded but failed to add the operator to the controller
         } else if (!opController_->AddOperator(fixRes)) {
@@ -122,7 +183,8 @@ int RecoverScheduler::Schedule() {
             LOG(INFO) << "recoverScheduler generate operator:"
                       << fixRes.OpToString() << " for "
                       << copysetInfo.CopySetInfoStr()
-                      << ", remove offlinePeer: " << *offlinelists.begin();
+                      << " with " << task.liveNum << " live replicas"
+                      << ", remove offlinePeer: " << offlinePeer;
             // if the target returned has the initial value, that means offline
             // replicas are removed directly.
             if (target == UNINTIALIZE_ID) {
@@ -142,6 +204,7 @@ int RecoverScheduler::Schedule() {
                 opController_->RemoveOperator(copysetInfo.id);
                 continue;
             }
+            CountRecovering({task.source, target});
             oneRoundGenOp++;
         }
     }
@@ -190,12 +253,58 @@ bool RecoverScheduler::FixOfflinePeer(const CopySetInfo &info,
     }
 }
 
+bool RecoverScheduler::ExceedConcurrency(ChunkServerIdType id) {
+    return Scheduler::ExceedConcurrency(id) || ExceedRecoverBudget(id);
+}
+
+bool RecoverScheduler::ExceedRecoverBudget(ChunkServerIdType id) {
+    auto exceed = [](uint32_t recovering, uint32_t limit) {
+        return limit > 0 && recovering >= limit;
+    };
+    if (exceed(chunkServerRecovering_[id], concurrentPerChunkServer_)) {
+        return true;
+    }
+
+    auto it = peers_.find(id);
+    if (it == peers_.end()) {
+        return false;
+    }
+    return exceed(serverRecovering_[it->second.serverId],
+                  concurrentPerServer_) ||
+           exceed(zoneRecovering_[it->second.zoneId], concurrentPerZone_);
+}
+
+void RecoverScheduler::CountRecovering(
+    const std::vector<ChunkServerIdType> &ids) {
+    // a recovery is counted once for a server or zone it involves
+    std::set<ServerIdType> servers;
+    std::set<ZoneIdType> zones;
+    for (auto id : ids) {
+        if (id == UNINTIALIZE_ID) {
+            continue;
+        }
+        chunkServerRecovering_[id]++;
+        auto it = peers_.find(id);
+        if (it != peers_.end()) {
+            servers.emplace(it->second.serverId);
+            zones.emplace(it->second.zoneId);
+        }
+    }
+    for (auto server : servers) {
+        serverRecovering_[server]++;
+    }
+    for (auto zone : zones) {
+        zoneRecovering_[zone]++;
+    }
+}
+
 void RecoverScheduler::CalculateExcludesChunkServer(
+    const std::vector<ChunkServerInfo> &chunkServers,
     std::set<ChunkServerIdType> *excludes) {
     // calculate the number of offline or pending chunkserver on a server
     std::map<ServerIdType, std::vector<ChunkServerIdType>> unhealthyStateCS;
     std::set<ChunkServerIdType> pendingCS;
-    for (auto cs : topo_->GetChunkServerInfos()) {
+    for (auto &cs : chunkServers) {
         // calculate number of pending chunkservers
         if (cs.IsPendding()) {
             LOG(INFO) << "chunkserver " << cs.info.id << " is set pendding";
@@ -34,6 +34,7 @@ enum SchedulerType {
   ReplicaSchedulerType,
   RapidLeaderSchedulerType,
   ScanSchedulerType,
+  LeaderLoadSchedulerType,
 };
 
 struct ScheduleOption {
@@ -101,6 +102,27 @@ struct ScheduleOption {
     // ScanScheduler: maximum number of scan copysets at the same time
     // for every chunkserver
     uint32_t scanConcurrentPerChunkserver;
+
+    // LeaderLoadScheduler: balancing the io load of leaders, which is
+    // measured by the iops and bandwidth in heartbeats
+    bool enableLeaderLoadScheduler = false;
+    uint32_t leaderLoadSchedulerIntervalSec = 60;
+    // LeaderLoadScheduler: leaders are transferred out of a chunkserver only
+    // if its leader load exceeds avg * (1 + leaderLoadRangePercent), and the
+    // leader load of the target after the transfer should be lower than the
+    // source before by avg * leaderLoadRangePercent
+    float leaderLoadRangePercent = 0.2;
+    // LeaderLoadScheduler: the chunkservers of a transfer are neither source
+    // nor target within leaderLoadCoolingTimeSec, until the heartbeats report
+    // the load after the transfer
+    uint32_t leaderLoadCoolingTimeSec = 300;
+
+    // RecoverScheduler: maximum number of recoveries at the same time on a
+    // chunkserver, a server and a zone, both the leader copying the data and
+    // the new replica are counted, 0 means no limit
+    uint32_t recoverConcurrentPerChunkServer = 0;
+    uint32_t recoverConcurrentPerServer = 0;
+    uint32_t recoverConcurrentPerZone = 0;
 };
 
 }  // namespace schedule
@@ -141,7 +141,7 @@ ChunkServerIdType Scheduler::SelectBestPlacementChunkServer(
         }
 
         // exclude the chunkserver exceeding the concurrent limit
-        if (opController_->Exceed(cs.info.id)) {
+        if (ExceedConcurrency(cs.info.id)) {
             continue;
         }
 
@@ -346,6 +346,10 @@ int Scheduler::GetMinScatterWidth(PoolIdType lpid) {
         (1 - scatterWidthRangePerent_ / 2);
 }
 
+bool Scheduler::ExceedConcurrency(ChunkServerIdType id) {
+    return opController_->Exceed(id);
+}
+
 bool Scheduler::CopysetAllPeersOnline(const CopySetInfo &copySetInfo) {
     for (auto peer : copySetInfo.peers) {
         ChunkServerInfo out;
@@ -128,6 +128,16 @@ class Scheduler {
      */
     int GetMinScatterWidth(PoolIdType lpid);
 
+    /**
+     * @brief whether the chunkserver can not be the target of one more
+     *        configuration change, on selecting placement
+     *
+     * @param[in] id chunkserver id
+     *
+     * @return true if the concurrency limit is reached
+     */
+    virtual bool ExceedConcurrency(ChunkServerIdType id);
+
     /**
      * @brief CopysetAllPeersOnline Check whether all replicas of a copyset are online //NOLINT
      *
@@ -390,6 +400,91 @@ class LeaderScheduler : public Scheduler {
     const int maxRetryTransferLeader = 10;
 };
 
+// Scheduler for balancing the io load of leaders. LeaderScheduler balances
+// the leader number, but a chunkserver with a few hot leaders is still
+// overloaded, as only the leader serves the io of a copyset.
+class LeaderLoadScheduler : public Scheduler {
+ public:
+    LeaderLoadScheduler(
+        const ScheduleOption &opt,
+        const std::shared_ptr<TopoAdapter> &topo,
+        const std::shared_ptr<OperatorController> &opController)
+        : Scheduler(opt, topo, opController) {
+        runInterval_ = opt.leaderLoadSchedulerIntervalSec;
+        loadRangePercent_ = opt.leaderLoadRangePercent;
+        loadCoolingTimeSec_ = opt.leaderLoadCoolingTimeSec;
+        chunkserverCoolingTimeSec_ = opt.chunkserverCoolingTimeSec;
+    }
+
+    /**
+     * @brief Schedule Generate operators according to the status of the cluster
+     *
+     * @return number of operators generated
+     */
+    int Schedule() override;
+
+    /**
+     * @brief Get running interval of LeaderLoadScheduler
+     *
+     * @return time interval
+     */
+    int64_t GetRunningInterval() override;
+
+ private:
+    /**
+     * @brief DoLeaderLoadSchedule Transfer hot leaders out of the chunkserver
+     *        with the highest leader load in the specified logical pool
+     *
+     * @param[in] lid The ID of the logical pool specified
+     *
+     * @return The number of the effective operator generated
+     */
+    int DoLeaderLoadSchedule(PoolIdType lid);
+
+    /**
+     * @brief CopySetLoad The load of a copyset, the iops and the bandwidth are
+     *        normalized by their average on chunkservers, so the load of the
+     *        chunkservers is 1 for each of them on average
+     *
+     * @param[in] stats The io statistics of the copyset
+     * @param[in] avgIops Average iops on chunkservers
+     * @param[in] avgBandwidth Average bandwidth on chunkservers
+     *
+     * @return load of the copyset
+     */
+    static double CopySetLoad(const CopysetStatistics &stats, double avgIops,
+                              double avgBandwidth);
+
+    /**
+     * @brief coolingTimeExpired Check whether current-time - aliveTime is
+     *                           larger than chunkserverCoolingTimeSec_
+     */
+    bool coolingTimeExpired(uint64_t startUpTime);
+
+    /**
+     * @brief loadCooling Check whether the chunkserver is in a transfer
+     *                    within loadCoolingTimeSec_
+     */
+    bool loadCooling(ChunkServerIdType id, uint64_t nowSec);
+
+ private:
+    int64_t runInterval_;
+
+    // threshold of the leader load above average
+    float loadRangePercent_;
+
+    // time that the chunkservers of a transfer are excluded
+    uint32_t loadCoolingTimeSec_;
+
+    // the minimum time that a chunkserver can become a target
+    // leader after it started
+    uint32_t chunkserverCoolingTimeSec_;
+
+    // last transfer time of chunkservers, only accessed by the thread
+    // running the scheduler
+    std::map<ChunkServerIdType, uint64_t> lastTransferSec_;
+};
+
 // recovering the offline replicas
 class RecoverScheduler : public Scheduler {
  public:
@@ -400,6 +495,9 @@ class RecoverScheduler : public Scheduler {
         : Scheduler(opt, topo, opController) {
         runInterval_ = opt.recoverSchedulerIntervalSec;
         chunkserverFailureTolerance_ = opt.chunkserverFailureTolerance;
+        concurrentPerChunkServer_ = opt.recoverConcurrentPerChunkServer;
+        concurrentPerServer_ = opt.recoverConcurrentPerServer;
+        concurrentPerZone_ = opt.recoverConcurrentPerZone;
     }
 
     /**
@@ -435,16 +533,48 @@ class RecoverScheduler : public Scheduler {
      *        replicas more than a specific number on a server. for those
      *        server, the chunkserver on it will not be recovered.
      *
+     * @param[in] chunkServers All chunkservers in the cluster
      * @param[out] excludes Chunkservers on the server that has offline
      *                      Chunkserver more than a specified number
      */
-    void CalculateExcludesChunkServer(std::set<ChunkServerIdType> *excludes);
+    void CalculateExcludesChunkServer(
+        const std::vector<ChunkServerInfo> &chunkServers,
+        std::set<ChunkServerIdType> *excludes);
+
+    /**
+     * @brief targets exceeding the recovery budgets are not selected
+     */
+    bool ExceedConcurrency(ChunkServerIdType id) override;
+
+    /**
+     * @brief whether the chunkserver, its server or its zone has used up
+     *        the recovery budget
+     */
+    bool ExceedRecoverBudget(ChunkServerIdType id);
+
+    /**
+     * @brief count a recovery which copies data between the chunkservers
+     *        in the budgets of them, their servers and zones
+     */
+    void CountRecovering(const std::vector<ChunkServerIdType> &ids);
 
  private:
     // running interval of RecoverScheduler
     int64_t runInterval_;
     // the threshold of the failing chunkserver that the server will not be recovered //NOLINT
     int32_t chunkserverFailureTolerance_;
+    // max recoveries at the same time on a chunkserver, a server and a zone,
+    // both the leader copying the data and the target are counted, 0 means
+    // no limit
+    uint32_t concurrentPerChunkServer_;
+    uint32_t concurrentPerServer_;
+    uint32_t concurrentPerZone_;
+
+    // recoveries on the chunkservers, servers and zones, counted every round
+    std::map<ChunkServerIdType, PeerInfo> peers_;
+    std::map<ChunkServerIdType, uint32_t> chunkServerRecovering_;
+    std::map<ServerIdType, uint32_t> serverRecovering_;
+    std::map<ZoneIdType, uint32_t> zoneRecovering_;
 };
 
 // Check replica numbers of the copyset according to the configuration, and
@@ -172,7 +172,10 @@ bool TopoAdapterImpl::GetCopySetInfo(const CopySetKey &id, CopySetInfo *info) {
         return false;
     }
 
-    info->logicalPoolWork = lpool.GetLogicalPoolAvaliableFlag();
+    // the stripe groups of the erasure coded pool are not raft groups,
+    // they are not scheduled
+    info->logicalPoolWork = lpool.GetLogicalPoolAvaliableFlag() &&
+        lpool.GetLogicalPoolType() != LogicalPoolType::APPENDECFILE;
     return true;
 }
 
@@ -432,6 +435,31 @@ void TopoAdapterImpl::GetChunkServerScatterMap(
         }
     }
 }
+
+std::map<CopySetKey, CopysetStatistics>
+TopoAdapterImpl::GetCopySetStatsInLogicalPool(PoolIdType lid) {
+    std::map<CopySetKey, CopysetStatistics> out;
+    for (auto csId : topo_->GetChunkServerInLogicalPool(lid)) {
+        ChunkServerStat stat;
+        if (!topoStat_->GetChunkServerStat(csId, &stat)) {
+            continue;
+        }
+
+        // every replica reports the copyset, only the leader serves the io
+        for (const auto &cstat : stat.copysetStats) {
+            if (cstat.leader != csId || cstat.logicalPoolId != lid) {
+                continue;
+            }
+            CopysetStatistics &statistics =
+                out[CopySetKey{cstat.logicalPoolId, cstat.copysetId}];
+            statistics.set_readrate(cstat.readRate);
+            statistics.set_writerate(cstat.writeRate);
+            statistics.set_readiops(cstat.readIOPS);
+            statistics.set_writeiops(cstat.writeIOPS);
+        }
+    }
+    return out;
+}
 }  // namespace schedule
 }  // namespace mds
 }  // namespace curve
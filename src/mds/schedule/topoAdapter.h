@@ -338,6 +338,19 @@ class TopoAdapter {
      */
     virtual void GetChunkServerScatterMap(const ChunkServerIdType &cs,
         std::map<ChunkServerIdType, int> *out) = 0;
+
+    /**
+     * @brief GetCopySetStatsInLogicalPool Get the io statistics of copysets
+     *                                     in the logical pool, which are
+     *                                     reported by their leaders
+     *
+     * @param[in] lid ID of the logical pool
+     *
+     * @return statistics of copysets, the copysets whose leader has not
+     *         reported them are not included
+     */
+    virtual std::map<CopySetKey, CopysetStatistics>
+        GetCopySetStatsInLogicalPool(PoolIdType lid) = 0;
 };
 
 // implementation of virtual class TopoAdapter
@@ -393,6 +406,9 @@ class TopoAdapterImpl : public TopoAdapter {
     void GetChunkServerScatterMap(const ChunkServerIdType &cs,
         std::map<ChunkServerIdType, int> *out) override;
 
+    std::map<CopySetKey, CopysetStatistics>
+        GetCopySetStatsInLogicalPool(PoolIdType lid) override;
+
  private:
     bool GetPeerInfo(ChunkServerIdType id, PeerInfo *peerInfo);
 
@@ -39,7 +39,6 @@ using ::curve::mds::topology::ChunkServerRegistInfoBuilder;
 namespace curve {
 namespace mds {
 
-using LRUCache = ::curve::common::LRUCache<std::string, std::string>;
 using CacheMetrics = ::curve::common::CacheMetrics;
 using ::curve::common::BLOCKSIZEKEY;
 using ::curve::common::CHUNKSIZEKEY;
@@ -67,9 +66,37 @@ void MDS::InitMdsOptions(std::shared_ptr<Configuration> conf) {
     conf_->GetValueFatalIfFail(
         "mds.segment.alloc.periodic.persistInterMs",
         &options_.periodicPersistInterMs);
+    options_.segmentAllocMaxBatch = 1;
+    if (!conf_->GetValue("mds.segment.alloc.maxBatch",
+                         &options_.segmentAllocMaxBatch)) {
+        LOG(WARNING) << "mds.segment.alloc.maxBatch not found, using default: "
+                     << options_.segmentAllocMaxBatch;
+    }
+    options_.segmentAllocChangeLog = false;
+    if (!conf_->GetValue("mds.segment.alloc.changeLog.enable",
+                         &options_.segmentAllocChangeLog)) {
+        LOG(WARNING) << "mds.segment.alloc.changeLog.enable not found, "
+                     << "using default: " << options_.segmentAllocChangeLog;
+    }
+    options_.segmentAllocVerifyInterSec = 0;
+    if (!conf_->GetValue("mds.segment.alloc.verifyInterSec",
+                         &options_.segmentAllocVerifyInterSec)) {
+        LOG(WARNING) << "mds.segment.alloc.verifyInterSec not found, "
+                     << "using default: "
+                     << options_.segmentAllocVerifyInterSec;
+    }
 
     // cache size of namestorage
     conf_->GetValueFatalIfFail("mds.cache.count", &options_.mdsCacheCount);
+    InitFileInfoCacheOption(&options_.fileInfoCacheOption);
+
+    options_.standbyWarmup = false;
+    if (!conf_->GetValue("mds.standby.warmup.enable",
+                         &options_.standbyWarmup)) {
+        LOG(WARNING) << "mds.standby.warmup.enable not found, "
+                     << "using default: " << options_.standbyWarmup;
+    }
+    InitStandbyWarmerOption(&options_.standbyWarmerOption);
 
     conf_->GetValueFatalIfFail("mds.listen.addr", &options_.mdsListenAddr);
 
@@ -108,6 +135,10 @@ void MDS::StartCompaginLeader() {
     InitEtcdConf(&etcdConf);
     InitEtcdClient(etcdConf, etcdTimeout, etcdRetryTimes);
 
+    if (options_.standbyWarmup) {
+        StartStandbyWarmer(options_.standbyWarmerOption);
+    }
+
     // leader election
     LeaderElectionOptions leaderElectionOp;
     InitMdsLeaderElectionOption(&leaderElectionOp);
@@ -119,6 +150,10 @@ void MDS::StartCompaginLeader() {
                   << " campaign for leader again";
     }
     LOG(INFO) << "Campain leader ok, I am the leader now";
+    if (standbyWarmer_ != nullptr) {
+        topologyMirror_ = standbyWarmer_->TakeOver();
+        standbyWarmer_.reset();
+    }
     status_.set_value("leader");
     leaderElection_->StartObserverLeader();
 }
@@ -130,8 +165,13 @@ void MDS::Init() {
         << "Check or insert chunk size failed";
 
     InitSegmentAllocStatistic(options_.retryInterTimes,
-                              options_.periodicPersistInterMs);
-    InitNameServerStorage(options_.mdsCacheCount);
+                              options_.periodicPersistInterMs,
+                              options_.segmentAllocChangeLog,
+                              options_.segmentAllocVerifyInterSec);
+    InitNameServerStorage(options_.mdsCacheCount,
+                          options_.fileInfoCacheOption,
+                          options_.segmentAllocMaxBatch,
+                          options_.segmentAllocChangeLog);
     InitTopology(options_.topologyOption);
     InitTopologyStat();
     InitTopologyChunkAllocator(options_.topologyOption);
@@ -300,9 +340,12 @@ void MDS::InitMdsLeaderElectionOption(LeaderElectionOptions *electionOp) {
 }
 
 void MDS::InitSegmentAllocStatistic(uint64_t retryInterTimes,
-                                    uint64_t periodicPersistInterMs) {
+                                    uint64_t periodicPersistInterMs,
+                                    bool changeLog,
+                                    uint64_t verifyInterSec) {
     segmentAllocStatistic_ = std::make_shared<AllocStatistic>(
-        periodicPersistInterMs, retryInterTimes, etcdClient_);
+        periodicPersistInterMs, retryInterTimes, etcdClient_, changeLog,
+        verifyInterSec);
     int res = segmentAllocStatistic_->Init();
     LOG_IF(FATAL, res != 0) << "int segment alloc statistic fail";
     LOG(INFO) << "init segmentAllocStatistic success.";
@@ -333,6 +376,30 @@ void MDS::InitTopologyOption(TopologyOption *topologyOption) {
     conf_->GetValueFatalIfFail(
         "mds.topology.enableLogicalPoolStatus",
         &topologyOption->enableLogicalPoolStatus);
+    if (!conf_->GetValue("mds.topology.CopySetFlushBatchSize",
+                         &topologyOption->CopySetFlushBatchSize)) {
+        LOG(WARNING) << "mds.topology.CopySetFlushBatchSize not found, "
+                     << "using default: "
+                     << topologyOption->CopySetFlushBatchSize;
+    }
+    if (!conf_->GetValue("mds.topology.CopySetFlushDirtyThreshold",
+                         &topologyOption->CopySetFlushDirtyThreshold)) {
+        LOG(WARNING) << "mds.topology.CopySetFlushDirtyThreshold not found, "
+                     << "using default: "
+                     << topologyOption->CopySetFlushDirtyThreshold;
+    }
+    if (!conf_->GetValue("mds.topology.chooseCopySetPolicy",
+                         &topologyOption->chooseCopySetPolicy)) {
+        LOG(WARNING) << "mds.topology.chooseCopySetPolicy not found, "
+                     << "using default: "
+                     << topologyOption->chooseCopySetPolicy;
+    }
+    if (!conf_->GetValue("mds.topology.CopySetLoadUpdateIntervalMs",
+                         &topologyOption->CopySetLoadUpdateIntervalMs)) {
+        LOG(WARNING) << "mds.topology.CopySetLoadUpdateIntervalMs not found, "
+                     << "using default: "
+                     << topologyOption->CopySetLoadUpdateIntervalMs;
+    }
 }
 
 void MDS::InitTopology(const TopologyOption& option) {
@@ -342,8 +409,13 @@ void MDS::InitTopology(const TopologyOption& option) {
         std::make_shared<DefaultTokenGenerator>();
 
     auto codec = std::make_shared<TopologyStorageCodec>();
+    std::shared_ptr<KVStorageClient> topologyClient = etcdClient_;
+    if (topologyMirror_ != nullptr) {
+        LOG(INFO) << "load topology from the mirror of standby warmer.";
+        topologyClient = topologyMirror_;
+    }
     auto topologyStorage =
-        std::make_shared<TopologyStorageEtcd>(etcdClient_, codec);
+        std::make_shared<TopologyStorageEtcd>(topologyClient, codec);
 
     LOG(INFO) << "init topologyStorage success.";
 
@@ -352,6 +424,10 @@ void MDS::InitTopology(const TopologyOption& option) {
                                            topologyTokenGenerator,
                                            topologyStorage);
     LOG_IF(FATAL, topology_->Init(option) < 0) << "init topology fail.";
+    if (topologyMirror_ != nullptr) {
+        topologyMirror_->Release();
+        topologyMirror_.reset();
+    }
 
     LOG(INFO) << "init topology success.";
 }
@@ -422,16 +498,88 @@ void MDS::InitTopologyChunkAllocator(const TopologyOption& option) {
     LOG(INFO) << "init topologyChunkAllocator success.";
 }
 
-void MDS::InitNameServerStorage(int mdsCacheCount) {
-    // init LRUCache
+void MDS::InitFileInfoCacheOption(FileInfoCacheOption *option) {
+    if (!conf_->GetValue("mds.cache.fileinfo.count", &option->fileCount)) {
+        LOG(WARNING) << "mds.cache.fileinfo.count not found, using default: "
+                     << option->fileCount;
+    }
+    if (!conf_->GetValue("mds.cache.dir.count", &option->dirCount)) {
+        LOG(WARNING) << "mds.cache.dir.count not found, using default: "
+                     << option->dirCount;
+    }
+    if (!conf_->GetValue("mds.cache.dir.maxEntries",
+                         &option->maxDirEntries)) {
+        LOG(WARNING) << "mds.cache.dir.maxEntries not found, using default: "
+                     << option->maxDirEntries;
+    }
+}
+
+void MDS::InitStandbyWarmerOption(StandbyWarmerOption *option) {
+    if (!conf_->GetValue("mds.standby.warmup.watchTimeoutMs",
+                         &option->watchTimeoutMs)) {
+        LOG(WARNING) << "mds.standby.warmup.watchTimeoutMs not found, "
+                     << "using default: " << option->watchTimeoutMs;
+    }
+}
+
+void MDS::InitCleanCoreOption(CleanCoreOption *option) {
+    if (!conf_->GetValue("mds.clean.deleteConcurrency",
+                         &option->deleteConcurrency)) {
+        LOG(WARNING) << "mds.clean.deleteConcurrency not found, "
+                     << "using default: " << option->deleteConcurrency;
+    }
+    if (!conf_->GetValue("mds.clean.chunkserverConcurrency",
+                         &option->chunkserverConcurrency)) {
+        LOG(WARNING) << "mds.clean.chunkserverConcurrency not found, "
+                     << "using default: " << option->chunkserverConcurrency;
+    }
+    if (!conf_->GetValue("mds.clean.segmentBatchSize",
+                         &option->segmentBatchSize)) {
+        LOG(WARNING) << "mds.clean.segmentBatchSize not found, "
+                     << "using default: " << option->segmentBatchSize;
+    }
+}
 
-    auto cache = std::make_shared<LRUCache>(mdsCacheCount,
+void MDS::InitNameServerCache(int mdsCacheCount,
+                              const FileInfoCacheOption& fileInfoCacheOption) {
+    // init LRUCache
+    nameServerCache_ = std::make_shared<LRUCache>(mdsCacheCount,
         std::make_shared<CacheMetrics>("mds_nameserver_cache_metric"));
     LOG(INFO) << "init LRUCache success.";
 
+    if (fileInfoCacheOption.fileCount > 0) {
+        fileInfoCache_ = std::make_shared<FileInfoCache>(fileInfoCacheOption);
+        LOG(INFO) << "init FileInfoCache success.";
+    }
+}
+
+void MDS::StartStandbyWarmer(const StandbyWarmerOption& option) {
+    // the caches are warmed before being passed to NameServerStorage
+    InitNameServerCache(options_.mdsCacheCount, options_.fileInfoCacheOption);
+    standbyWarmer_ = std::make_shared<StandbyWarmer>(
+        etcdClient_, nameServerCache_, fileInfoCache_, option);
+    standbyWarmer_->Start();
+    LOG(INFO) << "start standby warmer success.";
+}
+
+void MDS::InitNameServerStorage(
+    int mdsCacheCount, const FileInfoCacheOption& fileInfoCacheOption,
+    uint32_t segmentAllocMaxBatch, bool segmentAllocLog) {
+    if (nameServerCache_ == nullptr) {
+        InitNameServerCache(mdsCacheCount, fileInfoCacheOption);
+    }
+
+    std::shared_ptr<SegmentPutBatcher> segmentBatcher;
+    if (segmentAllocMaxBatch > 1) {
+        segmentBatcher = std::make_shared<SegmentPutBatcher>(
+            etcdClient_, segmentAllocMaxBatch);
+        LOG(INFO) << "init SegmentPutBatcher success.";
+    }
+
     // init NameServerStorage
     nameServerStorage_ = std::make_shared<NameServerStorageImp>(etcdClient_,
-                                                                cache);
+                                nameServerCache_, fileInfoCache_,
+                                segmentBatcher, segmentAllocLog);
     LOG(INFO) << "init NameServerStorage success.";
 }
 
@@ -561,7 +709,13 @@ void MDS::InitDLockOption(std::shared_ptr<DLockOpts> dlockOpts) {
 
 void MDS::InitCleanManager() {
     // TODO(hzsunjianliang): should add threadpoolsize & checktime from config
-    auto channelPool = std::make_shared<ChannelPool>();
+    int connectionNum = 1;
+    if (!conf_->GetValue("mds.chunkserverclient.connectionNum",
+                         &connectionNum)) {
+        LOG(WARNING) << "mds.chunkserverclient.connectionNum not found, "
+                     << "using default: " << connectionNum;
+    }
+    auto channelPool = std::make_shared<ChannelPool>(connectionNum);
     auto taskManager = std::make_shared<CleanTaskManager>(channelPool);
     // init copysetClient
     ChunkServerClientOption chunkServerClientOption;
@@ -570,9 +724,12 @@ void MDS::InitCleanManager() {
         std::make_shared<CopysetClient>(topology_, chunkServerClientOption,
                                                         channelPool);
 
+    CleanCoreOption cleanCoreOption;
+    InitCleanCoreOption(&cleanCoreOption);
     auto cleanCore = std::make_shared<CleanCore>(nameServerStorage_,
                                                  copysetClient,
-                                                 segmentAllocStatistic_);
+                                                 segmentAllocStatistic_,
+                                                 cleanCoreOption);
 
     // init dlock options
     auto dlockOpts = std::make_shared<DLockOpts>();
@@ -664,6 +821,49 @@ void MDS::InitScheduleOption(ScheduleOption *scheduleOption) {
         &scheduleOption->scanConcurrentPerPool);
     conf_->GetValueFatalIfFail("mds.scheduler.scan.concurrent.per.chunkserver",
         &scheduleOption->scanConcurrentPerChunkserver);
+
+    if (!conf_->GetValue("mds.enable.leader.load.scheduler",
+                         &scheduleOption->enableLeaderLoadScheduler)) {
+        LOG(WARNING) << "mds.enable.leader.load.scheduler not found, "
+                     << "using default: "
+                     << scheduleOption->enableLeaderLoadScheduler;
+    }
+    if (!conf_->GetValue("mds.leader.load.scheduler.intervalSec",
+                         &scheduleOption->leaderLoadSchedulerIntervalSec)) {
+        LOG(WARNING) << "mds.leader.load.scheduler.intervalSec not found, "
+                     << "using default: "
+                     << scheduleOption->leaderLoadSchedulerIntervalSec;
+    }
+    if (!conf_->GetValue("mds.scheduler.leaderLoadRangePercent",
+                         &scheduleOption->leaderLoadRangePercent)) {
+        LOG(WARNING) << "mds.scheduler.leaderLoadRangePercent not found, "
+                     << "using default: "
+                     << scheduleOption->leaderLoadRangePercent;
+    }
+    if (!conf_->GetValue("mds.scheduler.leaderLoad.cooling.timeSec",
+                         &scheduleOption->leaderLoadCoolingTimeSec)) {
+        LOG(WARNING) << "mds.scheduler.leaderLoad.cooling.timeSec not found, "
+                     << "using default: "
+                     << scheduleOption->leaderLoadCoolingTimeSec;
+    }
+    if (!conf_->GetValue("mds.recover.concurrent.per.chunkserver",
+                         &scheduleOption->recoverConcurrentPerChunkServer)) {
+        LOG(WARNING) << "mds.recover.concurrent.per.chunkserver not found, "
+                     << "using default: "
+                     << scheduleOption->recoverConcurrentPerChunkServer;
+    }
+    if (!conf_->GetValue("mds.recover.concurrent.per.server",
+                         &scheduleOption->recoverConcurrentPerServer)) {
+        LOG(WARNING) << "mds.recover.concurrent.per.server not found, "
+                     << "using default: "
+                     << scheduleOption->recoverConcurrentPerServer;
+    }
+    if (!conf_->GetValue("mds.recover.concurrent.per.zone",
+                         &scheduleOption->recoverConcurrentPerZone)) {
+        LOG(WARNING) << "mds.recover.concurrent.per.zone not found, "
+                     << "using default: "
+                     << scheduleOption->recoverConcurrentPerZone;
+    }
 }
 
 void MDS::InitHeartbeatManager() {
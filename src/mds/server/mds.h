@@ -54,6 +54,7 @@
 #include "proto/heartbeat.pb.h"
 #include "src/mds/chunkserverclient/chunkserverclient_config.h"
 #include "src/mds/nameserver2/allocstatistic/alloc_statistic.h"
+#include "src/mds/server/standby_warmer.h"
 #include "src/common/curve_version.h"
 #include "src/common/channel_pool.h"
 #include "src/mds/schedule/scheduleService/scheduleService.h"
@@ -96,9 +97,19 @@ struct MDSOptions {
     // configuration of segmentAlloc
     uint64_t retryInterTimes;
     uint64_t periodicPersistInterMs;
+    // max number of segments put in one etcd txn
+    uint32_t segmentAllocMaxBatch;
+    // record segment alloc in change log instead of full scans
+    bool segmentAllocChangeLog;
+    uint64_t segmentAllocVerifyInterSec;
     // cache size of namestorage
     int mdsCacheCount;
+    // parsed fileinfo and directory cache of namestorage
+    FileInfoCacheOption fileInfoCacheOption;
     int mdsFilelockBucketNum;
+    // tail etcd while campaigning for leader
+    bool standbyWarmup;
+    StandbyWarmerOption standbyWarmerOption;
 
     FileRecordOptions fileRecordOptions;
     RootAuthOption authOptions;
@@ -172,6 +183,12 @@ class MDS {
 
     void InitSnapshotCloneClientOption(SnapshotCloneClientOption *option);
 
+    void InitFileInfoCacheOption(FileInfoCacheOption *option);
+
+    void InitStandbyWarmerOption(StandbyWarmerOption *option);
+
+    void InitCleanCoreOption(CleanCoreOption *option);
+
     void InitEtcdClient(const EtcdConf& etcdConf,
                         int etcdTimeout,
                         int retryTimes);
@@ -179,9 +196,19 @@ class MDS {
     void InitLeaderElection(const LeaderElectionOptions& leaderElectionOp);
 
     void InitSegmentAllocStatistic(uint64_t retryInterTimes,
-                                   uint64_t periodicPersistInterMs);
+                                   uint64_t periodicPersistInterMs,
+                                   bool changeLog,
+                                   uint64_t verifyInterSec);
+
+    void InitNameServerCache(int mdsCacheCount,
+                             const FileInfoCacheOption& fileInfoCacheOption);
+
+    void StartStandbyWarmer(const StandbyWarmerOption& option);
 
-    void InitNameServerStorage(int mdsCacheCount);
+    void InitNameServerStorage(int mdsCacheCount,
+                               const FileInfoCacheOption& fileInfoCacheOption,
+                               uint32_t segmentAllocMaxBatch,
+                               bool segmentAllocLog);
 
     void StartServer();
 
@@ -224,6 +251,12 @@ class MDS {
 
     std::shared_ptr<EtcdClientImp> etcdClient_;
     std::shared_ptr<LeaderElection> leaderElection_;
+    // only exists while campaigning for leader
+    std::shared_ptr<StandbyWarmer> standbyWarmer_;
+    // topology mirrored by standbyWarmer_ till topology is loaded
+    std::shared_ptr<MirrorKVStorageClient> topologyMirror_;
+    std::shared_ptr<LRUCache> nameServerCache_;
+    std::shared_ptr<FileInfoCache> fileInfoCache_;
     std::shared_ptr<AllocStatistic> segmentAllocStatistic_;
     std::shared_ptr<NameServerStorage> nameServerStorage_;
     std::shared_ptr<TopologyImpl> topology_;
@@ -0,0 +1,344 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/mds/server/standby_warmer.h"
+
+#include <glog/logging.h>
+
+#include <chrono>  // NOLINT
+
+#include "src/common/namespace_define.h"
+#include "src/mds/nameserver2/helper/namespace_helper.h"
+
+namespace curve {
+namespace mds {
+
+using ::curve::common::COMMON_PREFIX_LENGTH;
+using ::curve::common::FILEINFOKEYPREFIX;
+using ::curve::common::LOGICALPOOLKEYPREFIX;
+using ::curve::common::POOLSETKEYEND;
+using ::curve::common::ReadLockGuard;
+using ::curve::common::SEGMENTINFOKEYPREFIX;
+using ::curve::common::SNAPSHOTFILEINFOKEYPREFIX;
+using ::curve::common::STANDBYFENCEKEY;
+using ::curve::common::WriteLockGuard;
+
+// the namespace, the fence and the topology are consecutive in etcd
+const char* const kWatchStart = FILEINFOKEYPREFIX;
+const char* const kWatchEnd = POOLSETKEYEND;
+const char* const kMirrorStart = LOGICALPOOLKEYPREFIX;
+const char* const kMirrorEnd = POOLSETKEYEND;
+
+MirrorKVStorageClient::MirrorKVStorageClient(
+    std::shared_ptr<KVStorageClient> client, const std::string &start,
+    const std::string &end, std::map<std::string, std::string> mirror)
+    : client_(std::move(client)),
+      start_(start),
+      end_(end),
+      released_(false),
+      mirror_(std::move(mirror)) {}
+
+void MirrorKVStorageClient::Release() {
+    WriteLockGuard guard(lock_);
+    released_ = true;
+    mirror_.clear();
+}
+
+bool MirrorKVStorageClient::InMirror(const std::string &startKey,
+                                     const std::string &endKey) const {
+    return !released_ && startKey >= start_ && endKey <= end_ &&
+           startKey <= endKey;
+}
+
+int MirrorKVStorageClient::Put(const std::string &key,
+                               const std::string &value) {
+    return client_->Put(key, value);
+}
+
+int MirrorKVStorageClient::PutRewithRevision(const std::string &key,
+    const std::string &value, int64_t *revision) {
+    return client_->PutRewithRevision(key, value, revision);
+}
+
+int MirrorKVStorageClient::Get(const std::string &key, std::string *out) {
+    {
+        ReadLockGuard guard(lock_);
+        if (InMirror(key, key)) {
+            auto it = mirror_.find(key);
+            if (it == mirror_.end()) {
+                return EtcdErrCode::EtcdKeyNotExist;
+            }
+            *out = it->second;
+            return EtcdErrCode::EtcdOK;
+        }
+    }
+    return client_->Get(key, out);
+}
+
+int MirrorKVStorageClient::List(const std::string &startKey,
+    const std::string &endKey, std::vector<std::string> *values) {
+    {
+        ReadLockGuard guard(lock_);
+        if (InMirror(startKey, endKey)) {
+            values->clear();
+            for (auto it = mirror_.lower_bound(startKey);
+                 it != mirror_.end() && it->first < endKey; ++it) {
+                values->push_back(it->second);
+            }
+            return EtcdErrCode::EtcdOK;
+        }
+    }
+    return client_->List(startKey, endKey, values);
+}
+
+int MirrorKVStorageClient::List(const std::string &startKey,
+    const std::string &endKey,
+    std::vector<std::pair<std::string, std::string>> *out) {
+    {
+        ReadLockGuard guard(lock_);
+        if (InMirror(startKey, endKey)) {
+            out->clear();
+            for (auto it = mirror_.lower_bound(startKey);
+                 it != mirror_.end() && it->first < endKey; ++it) {
+                out->emplace_back(it->first, it->second);
+            }
+            return EtcdErrCode::EtcdOK;
+        }
+    }
+    return client_->List(startKey, endKey, out);
+}
+
+int MirrorKVStorageClient::Delete(const std::string &key) {
+    return client_->Delete(key);
+}
+
+int MirrorKVStorageClient::DeleteRewithRevision(const std::string &key,
+                                                int64_t *revision) {
+    return client_->DeleteRewithRevision(key, revision);
+}
+
+int MirrorKVStorageClient::TxnN(const std::vector<Operation> &ops) {
+    return client_->TxnN(ops);
+}
+
+int MirrorKVStorageClient::TxnNWithRevision(const std::vector<Operation> &ops,
+                                            int64_t *revision) {
+    return client_->TxnNWithRevision(ops, revision);
+}
+
+int MirrorKVStorageClient::ListWithLimitAndRevision(
+    const std::string &startKey, const std::string &endKey, int64_t limit,
+    int64_t revision, std::vector<std::string> *values,
+    std::string *lastKey) {
+    return client_->ListWithLimitAndRevision(startKey, endKey, limit,
+                                             revision, values, lastKey);
+}
+
+int MirrorKVStorageClient::CompareAndSwap(const std::string &key,
+    const std::string &preV, const std::string &target) {
+    return client_->CompareAndSwap(key, preV, target);
+}
+
+StandbyWarmer::StandbyWarmer(std::shared_ptr<EtcdClientImp> client,
+                             std::shared_ptr<LRUCache> cache,
+                             std::shared_ptr<FileInfoCache> fileInfoCache,
+                             const StandbyWarmerOption &option)
+    : client_(std::move(client)),
+      cache_(std::move(cache)),
+      fileInfoCache_(std::move(fileInfoCache)),
+      option_(option),
+      synced_(false),
+      revision_(0),
+      isStop_(true) {}
+
+StandbyWarmer::~StandbyWarmer() {
+    Stop();
+}
+
+void StandbyWarmer::Start() {
+    if (isStop_.exchange(false)) {
+        tailThread_ = ::curve::common::Thread(&StandbyWarmer::Tail, this);
+        LOG(INFO) << "standby warmer started";
+    }
+}
+
+void StandbyWarmer::Stop() {
+    if (!isStop_.exchange(true)) {
+        sleeper_.interrupt();
+        tailThread_.join();
+        LOG(INFO) << "standby warmer stopped at revision " << revision_;
+    }
+}
+
+std::shared_ptr<MirrorKVStorageClient> StandbyWarmer::TakeOver() {
+    // the fence is put by the leader, so nothing is written before it
+    // by the previous leader. The tailing watch returns with it soon.
+    int64_t fence = 0;
+    int errCode = client_->PutRewithRevision(STANDBYFENCEKEY, "", &fence);
+    Stop();
+
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(WARNING) << "standby warmer put fence err: " << errCode;
+        ClearCache();
+        return nullptr;
+    }
+
+    // e.g. elected before the first sync
+    if (!synced_ && !Sync()) {
+        ClearCache();
+        return nullptr;
+    }
+
+    while (revision_ < fence) {
+        errCode = WatchOnce();
+        if (errCode != EtcdErrCode::EtcdOK) {
+            LOG(WARNING) << "standby warmer catch up with revision " << fence
+                         << " err: " << errCode;
+            ClearCache();
+            return nullptr;
+        }
+    }
+
+    LOG(INFO) << "standby warmer caught up with revision " << revision_
+              << ", " << mirror_.size() << " topology key-values mirrored";
+    return std::make_shared<MirrorKVStorageClient>(
+        client_, kMirrorStart, kMirrorEnd, std::move(mirror_));
+}
+
+void StandbyWarmer::Tail() {
+    while (!isStop_.load()) {
+        if (!synced_ && !Sync()) {
+            sleeper_.wait_for(
+                std::chrono::milliseconds(option_.watchTimeoutMs));
+            continue;
+        }
+
+        int errCode = WatchOnce();
+        if (errCode != EtcdErrCode::EtcdOK &&
+            errCode != EtcdErrCode::EtcdDeadlineExceeded &&
+            errCode != EtcdErrCode::EtcdOutOfRange) {
+            LOG(WARNING) << "standby warmer watch since revision "
+                         << revision_ + 1 << " err: " << errCode;
+            sleeper_.wait_for(
+                std::chrono::milliseconds(option_.watchTimeoutMs));
+        }
+    }
+}
+
+bool StandbyWarmer::Sync() {
+    // the changes after the revision are watched, some of them may have been
+    // listed, applying them again is harmless as they are applied in order
+    int64_t revision = 0;
+    int errCode = client_->GetCurrentRevision(&revision);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(WARNING) << "standby warmer get current revision err: "
+                     << errCode;
+        return false;
+    }
+
+    std::vector<std::pair<std::string, std::string>> kvs;
+    errCode = client_->List(kMirrorStart, kMirrorEnd, &kvs);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(WARNING) << "standby warmer list topology err: " << errCode;
+        return false;
+    }
+
+    mirror_.clear();
+    mirror_.insert(kvs.begin(), kvs.end());
+    revision_ = revision;
+    synced_ = true;
+    LOG(INFO) << "standby warmer synced at revision " << revision_ << ", "
+              << mirror_.size() << " topology key-values mirrored";
+    return true;
+}
+
+int StandbyWarmer::WatchOnce() {
+    std::vector<WatchEvent> events;
+    int64_t revision = 0;
+    int errCode = client_->Watch(kWatchStart, kWatchEnd, revision_ + 1,
+                                 option_.watchTimeoutMs, &events, &revision);
+    if (errCode == EtcdErrCode::EtcdOK) {
+        for (const auto &event : events) {
+            Apply(event);
+        }
+        revision_ = revision;
+    } else if (errCode == EtcdErrCode::EtcdOutOfRange) {
+        // the changes in between are lost, so are the caches
+        LOG(WARNING) << "standby warmer changes since revision "
+                     << revision_ + 1 << " are compacted at " << revision
+                     << ", sync again";
+        ClearCache();
+        synced_ = false;
+    }
+    return errCode;
+}
+
+void StandbyWarmer::Apply(const WatchEvent &event) {
+    const std::string &key = event.key;
+    if (key >= kMirrorStart && key < kMirrorEnd) {
+        if (event.deleted) {
+            mirror_.erase(key);
+        } else {
+            mirror_[key] = event.value;
+        }
+        return;
+    }
+
+    std::string prefix = key.substr(0, COMMON_PREFIX_LENGTH);
+    if (prefix == FILEINFOKEYPREFIX || prefix == SNAPSHOTFILEINFOKEYPREFIX) {
+        ApplyFile(event);
+    } else if (prefix == SEGMENTINFOKEYPREFIX) {
+        ApplyRaw(event);
+    }
+}
+
+void StandbyWarmer::ApplyFile(const WatchEvent &event) {
+    // the same as PutCachedFile and RemoveCachedFile of NameServerStorageImp
+    if (fileInfoCache_ == nullptr) {
+        ApplyRaw(event);
+        return;
+    }
+
+    FileInfo fileInfo;
+    bool decoded = NameSpaceStorageCodec::DecodeFileInfo(event.value,
+                                                         &fileInfo);
+    if (event.deleted || !decoded) {
+        fileInfoCache_->RemoveFile(event.key);
+    } else {
+        fileInfoCache_->PutFile(event.key, fileInfo);
+    }
+    if (decoded) {
+        fileInfoCache_->InvalidateDir(fileInfo.parentid());
+    }
+}
+
+void StandbyWarmer::ApplyRaw(const WatchEvent &event) {
+    if (event.deleted) {
+        cache_->Remove(event.key);
+    } else {
+        cache_->Put(event.key, event.value);
+    }
+}
+
+void StandbyWarmer::ClearCache() {
+    cache_->Clear();
+    if (fileInfoCache_ != nullptr) {
+        fileInfoCache_->Clear();
+    }
+}
+
+}  // namespace mds
+}  // namespace curve
@@ -0,0 +1,186 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_MDS_SERVER_STANDBY_WARMER_H_
+#define SRC_MDS_SERVER_STANDBY_WARMER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/common/concurrent/concurrent.h"
+#include "src/common/interruptible_sleeper.h"
+#include "src/common/lru_cache.h"
+#include "src/kvstorageclient/etcd_client.h"
+#include "src/mds/nameserver2/file_info_cache.h"
+
+namespace curve {
+namespace mds {
+
+using ::curve::kvstorage::EtcdClientImp;
+using ::curve::kvstorage::KVStorageClient;
+using ::curve::kvstorage::WatchEvent;
+using LRUCache = ::curve::common::LRUCache<std::string, std::string>;
+
+struct StandbyWarmerOption {
+    // max time of a watch, also the retry interval on error
+    uint32_t watchTimeoutMs = 500;
+};
+
+/**
+ * Serves reads in range [start, end) from the key-values mirrored by
+ * StandbyWarmer, the other reads and all writes go to etcd.
+ */
+class MirrorKVStorageClient : public KVStorageClient {
+ public:
+    MirrorKVStorageClient(std::shared_ptr<KVStorageClient> client,
+                          const std::string &start, const std::string &end,
+                          std::map<std::string, std::string> mirror);
+
+    // drop the mirror, then all reads go to etcd
+    void Release();
+
+    int Put(const std::string &key, const std::string &value) override;
+
+    int PutRewithRevision(const std::string &key, const std::string &value,
+        int64_t *revision) override;
+
+    int Get(const std::string &key, std::string *out) override;
+
+    int List(const std::string &startKey, const std::string &endKey,
+        std::vector<std::string> *values) override;
+
+    int List(const std::string &startKey, const std::string &endKey,
+        std::vector<std::pair<std::string, std::string>> *out) override;
+
+    int Delete(const std::string &key) override;
+
+    int DeleteRewithRevision(
+        const std::string &key, int64_t *revision) override;
+
+    int TxnN(const std::vector<Operation> &ops) override;
+
+    int TxnNWithRevision(const std::vector<Operation> &ops,
+        int64_t *revision) override;
+
+    int ListWithLimitAndRevision(const std::string &startKey,
+        const std::string &endKey, int64_t limit, int64_t revision,
+        std::vector<std::string> *values, std::string *lastKey) override;
+
+    int CompareAndSwap(const std::string &key, const std::string &preV,
+        const std::string &target) override;
+
+ private:
+    // whether [startKey, endKey) is served by the mirror, called with lock
+    bool InMirror(const std::string &startKey,
+                  const std::string &endKey) const;
+
+ private:
+    std::shared_ptr<KVStorageClient> client_;
+    const std::string start_;
+    const std::string end_;
+
+    ::curve::common::RWLock lock_;
+    bool released_;
+    std::map<std::string, std::string> mirror_;
+};
+
+/**
+ * A standby mds tails the revisions of etcd while campaigning for leader, so
+ * it takes over without loading everything from etcd:
+ *
+ * 1. the key-values of topology are mirrored, and served to TopologyImpl::Init
+ *    by the client returned from TakeOver()
+ * 2. the changes of files and segments are applied to the namespace caches,
+ *    which are passed to NameServerStorageImp at takeover, so the recently
+ *    changed and likely hot ones are cached
+ *
+ * If the watched revisions are compacted, the mirror is reloaded and the
+ * caches are cleared.
+ */
+class StandbyWarmer {
+ public:
+    /**
+     * @param[in] client: etcd client
+     * @param[in] cache: raw cache of NameServerStorageImp
+     * @param[in] fileInfoCache: parsed cache of NameServerStorageImp,
+     *                           nullptr if disabled
+     */
+    StandbyWarmer(std::shared_ptr<EtcdClientImp> client,
+                  std::shared_ptr<LRUCache> cache,
+                  std::shared_ptr<FileInfoCache> fileInfoCache,
+                  const StandbyWarmerOption &option);
+
+    ~StandbyWarmer();
+
+    // start tailing in background
+    void Start();
+
+    // stop tailing, e.g. on exit before becoming leader
+    void Stop();
+
+    /**
+     * @brief Stop tailing and catch up with the current revision, called
+     *        after this mds becomes the leader
+     *
+     * @return client serving topology from the mirror, or nullptr if the
+     *         warmer failed to catch up, then the caches are cleared and
+     *         everything should be loaded from etcd
+     */
+    std::shared_ptr<MirrorKVStorageClient> TakeOver();
+
+ private:
+    void Tail();
+
+    // list the mirrored range and start tailing since then
+    bool Sync();
+
+    // watch once and apply the changes, return error code of etcd
+    int WatchOnce();
+
+    void Apply(const WatchEvent &event);
+
+    void ApplyFile(const WatchEvent &event);
+
+    // raw values are cached for segments, and files if no FileInfoCache
+    void ApplyRaw(const WatchEvent &event);
+
+    void ClearCache();
+
+ private:
+    std::shared_ptr<EtcdClientImp> client_;
+    std::shared_ptr<LRUCache> cache_;
+    std::shared_ptr<FileInfoCache> fileInfoCache_;
+    const StandbyWarmerOption option_;
+
+    // only accessed by the tailing thread before takeover
+    bool synced_;
+    int64_t revision_;
+    std::map<std::string, std::string> mirror_;
+
+    std::atomic<bool> isStop_;
+    ::curve::common::Thread tailThread_;
+    ::curve::common::InterruptibleSleeper sleeper_;
+};
+
+}  // namespace mds
+}  // namespace curve
+
+#endif  // SRC_MDS_SERVER_STANDBY_WARMER_H_
@@ -23,6 +23,8 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <set>
 #include <utility>
 
 #include "src/common/namespace_define.h"
@@ -1034,7 +1036,6 @@ int TopologyImpl::Init(const TopologyOption &option) {
     WriteLockGuard wlockZone(zoneMutex_);
     WriteLockGuard wlockServer(serverMutex_);
     WriteLockGuard wlockChunkServer(chunkServerMutex_);
-    WriteLockGuard wlockCopySet(copySetMutex_);
 
     PoolsetIdType maxPoolsetId;
     if (!storage_->LoadPoolset(&poolsetMap_, &maxPoolsetId)) {
@@ -1135,14 +1136,15 @@ int TopologyImpl::Init(const TopologyOption &option) {
     }
     LOG(INFO) << "Calc physicalPool capacity success.";
 
+    std::map<CopySetKey, CopySetInfo> copySetMap;
     std::map<PoolIdType, CopySetIdType> copySetIdMaxMap;
-    if (!storage_->LoadCopySet(&copySetMap_, &copySetIdMaxMap)) {
+    if (!storage_->LoadCopySet(&copySetMap, &copySetIdMaxMap)) {
         LOG(ERROR) << "[TopologyImpl::init], LoadCopySet fail.";
         return kTopoErrCodeStorgeFail;
     }
     idGenerator_->initCopySetIdGenerator(copySetIdMaxMap);
     LOG(INFO) << "[TopologyImpl::init], LoadCopySet success, "
-              << "copyset num = " << copySetMap_.size();
+              << "copyset num = " << copySetMap.size();
 
     for (auto& phy : physicalPoolMap_) {
         auto pid = phy.second.GetPoolsetId();
@@ -1173,7 +1175,7 @@ int TopologyImpl::Init(const TopologyOption &option) {
     }
 
     // remove invalid copyset and logicalPool
-    ret = CleanInvalidLogicalPoolAndCopyset();
+    ret = CleanInvalidLogicalPoolAndCopyset(&copySetMap);
 
     if (kTopoErrCodeSuccess != ret) {
         LOG(ERROR) << "CleanInvalidLogicalPoolAndCopyset error, ret = " << ret;
@@ -1181,6 +1183,12 @@ int TopologyImpl::Init(const TopologyOption &option) {
     }
     LOG(INFO) << "Clean Invalid LogicalPool and copyset success.";
 
+    for (auto &c : copySetMap) {
+        CopySetShard &shard = GetCopySetShard(c.first);
+        WriteLockGuard wlockCopySetMap(shard.mutex);
+        shard.copySetMap[c.first] = c.second;
+    }
+
     return kTopoErrCodeSuccess;
 }
 
@@ -1191,15 +1199,16 @@ void TopologyImpl::SetChunkServerExternalIp() {
     }
 }
 
-int TopologyImpl::CleanInvalidLogicalPoolAndCopyset() {
+int TopologyImpl::CleanInvalidLogicalPoolAndCopyset(
+    std::map<CopySetKey, CopySetInfo> *copySetMap) {
     for (auto ix = logicalPoolMap_.begin(); ix != logicalPoolMap_.end();) {
         if (false == ix->second.GetLogicalPoolAvaliableFlag()) {
-            for (auto it = copySetMap_.begin(); it != copySetMap_.end();) {
+            for (auto it = copySetMap->begin(); it != copySetMap->end();) {
                 if (it->second.GetLogicalPoolId() == ix->first) {
                     if (!storage_->DeleteCopySet(it->first)) {
                         return kTopoErrCodeStorgeFail;
                     }
-                    it = copySetMap_.erase(it);
+                    it = copySetMap->erase(it);
                 } else {
                     it++;
                 }
@@ -1222,15 +1231,16 @@ CopySetIdType TopologyImpl::AllocateCopySetId(PoolIdType logicalPoolId) {
 
 int TopologyImpl::AddCopySet(const CopySetInfo &data) {
     ReadLockGuard rlockLogicalPool(logicalPoolMutex_);
-    WriteLockGuard wlockCopySetMap(copySetMutex_);
+    CopySetKey key(data.GetLogicalPoolId(), data.GetId());
+    CopySetShard &shard = GetCopySetShard(key);
+    WriteLockGuard wlockCopySetMap(shard.mutex);
     auto it = logicalPoolMap_.find(data.GetLogicalPoolId());
     if (it != logicalPoolMap_.end()) {
-        CopySetKey key(data.GetLogicalPoolId(), data.GetId());
-        if (copySetMap_.find(key) == copySetMap_.end()) {
+        if (shard.copySetMap.find(key) == shard.copySetMap.end()) {
             if (!storage_->StorageCopySet(data)) {
                 return kTopoErrCodeStorgeFail;
             }
-            copySetMap_[key] = data;
+            shard.copySetMap[key] = data;
             return kTopoErrCodeSuccess;
         } else {
             return kTopoErrCodeIdDuplicated;
@@ -1241,13 +1251,15 @@ int TopologyImpl::AddCopySet(const CopySetInfo &data) {
 }
 
 int TopologyImpl::RemoveCopySet(CopySetKey key) {
-    WriteLockGuard wlockCopySetMap(copySetMutex_);
-    auto it = copySetMap_.find(key);
-    if (it != copySetMap_.end()) {
+    ::curve::common::LockGuard lockFlush(copySetFlushMutex_);
+    CopySetShard &shard = GetCopySetShard(key);
+    WriteLockGuard wlockCopySetMap(shard.mutex);
+    auto it = shard.copySetMap.find(key);
+    if (it != shard.copySetMap.end()) {
         if (!storage_->DeleteCopySet(key)) {
             return kTopoErrCodeStorgeFail;
         }
-        copySetMap_.erase(key);
+        shard.copySetMap.erase(key);
         return kTopoErrCodeSuccess;
     } else {
         return kTopoErrCodeCopySetNotFound;
@@ -1255,10 +1267,11 @@ int TopologyImpl::RemoveCopySet(CopySetKey key) {
 }
 
 int TopologyImpl::UpdateCopySetTopo(const CopySetInfo &data) {
-    ReadLockGuard rlockCopySetMap(copySetMutex_);
     CopySetKey key(data.GetLogicalPoolId(), data.GetId());
-    auto it = copySetMap_.find(key);
-    if (it != copySetMap_.end()) {
+    CopySetShard &shard = GetCopySetShard(key);
+    ReadLockGuard rlockCopySetMap(shard.mutex);
+    auto it = shard.copySetMap.find(key);
+    if (it != shard.copySetMap.end()) {
         WriteLockGuard wlockCopySet(it->second.GetRWLockRef());
         it->second.SetLeader(data.GetLeader());
         it->second.SetEpoch(data.GetEpoch());
@@ -1278,7 +1291,10 @@ int TopologyImpl::UpdateCopySetTopo(const CopySetInfo &data) {
             it->second.SetLastScanConsistent(data.GetLastScanConsistent());
         }
 
-        it->second.SetDirtyFlag(true);
+        if (!it->second.GetDirtyFlag()) {
+            it->second.SetDirtyFlag(true);
+            OnCopySetDirty();
+        }
         return kTopoErrCodeSuccess;
     } else {
         LOG(WARNING) << "UpdateCopySetTopo can not find copyset, "
@@ -1289,9 +1305,11 @@ int TopologyImpl::UpdateCopySetTopo(const CopySetInfo &data) {
 }
 
 int TopologyImpl::SetCopySetAvalFlag(const CopySetKey &key, bool aval) {
-    ReadLockGuard rlockCopySetMap(copySetMutex_);
-    auto it = copySetMap_.find(key);
-    if (it != copySetMap_.end()) {
+    ::curve::common::LockGuard lockFlush(copySetFlushMutex_);
+    CopySetShard &shard = GetCopySetShard(key);
+    ReadLockGuard rlockCopySetMap(shard.mutex);
+    auto it = shard.copySetMap.find(key);
+    if (it != shard.copySetMap.end()) {
         WriteLockGuard wlockCopySet(it->second.GetRWLockRef());
         auto copysetInfo = it->second;
         copysetInfo.SetAvailableFlag(aval);
@@ -1311,9 +1329,10 @@ int TopologyImpl::SetCopySetAvalFlag(const CopySetKey &key, bool aval) {
 }
 
 bool TopologyImpl::GetCopySet(CopySetKey key, CopySetInfo *out) const {
-    ReadLockGuard rlockCopySetMap(copySetMutex_);
-    auto it = copySetMap_.find(key);
-    if (it != copySetMap_.end()) {
+    CopySetShard &shard = GetCopySetShard(key);
+    ReadLockGuard rlockCopySetMap(shard.mutex);
+    auto it = shard.copySetMap.find(key);
+    if (it != shard.copySetMap.end()) {
         ReadLockGuard rlockCopySet(it->second.GetRWLockRef());
         *out = it->second;
         return true;
@@ -1326,12 +1345,15 @@ std::vector<CopySetIdType> TopologyImpl::GetCopySetsInLogicalPool(
     PoolIdType logicalPoolId,
     CopySetFilter filter) const {
     std::vector<CopySetIdType> ret;
-    ReadLockGuard rlockCopySet(copySetMutex_);
-    for (auto it : copySetMap_) {
-        if (filter(it.second) && it.first.first == logicalPoolId) {
-            ret.push_back(it.first.second);
+    for (const auto &shard : copySetShards_) {
+        ReadLockGuard rlockCopySet(shard.mutex);
+        for (const auto &it : shard.copySetMap) {
+            if (filter(it.second) && it.first.first == logicalPoolId) {
+                ret.push_back(it.first.second);
+            }
         }
     }
+    std::sort(ret.begin(), ret.end());
     return ret;
 }
 
@@ -1339,24 +1361,33 @@ std::vector<CopySetInfo> TopologyImpl::GetCopySetInfosInLogicalPool(
     PoolIdType logicalPoolId,
     CopySetFilter filter) const {
     std::vector<CopySetInfo> ret;
-    ReadLockGuard rlockCopySet(copySetMutex_);
-    for (auto it : copySetMap_) {
-        if (filter(it.second) && it.first.first == logicalPoolId) {
-            ret.push_back(it.second);
+    for (const auto &shard : copySetShards_) {
+        ReadLockGuard rlockCopySet(shard.mutex);
+        for (const auto &it : shard.copySetMap) {
+            if (filter(it.second) && it.first.first == logicalPoolId) {
+                ret.push_back(it.second);
+            }
         }
     }
+    std::sort(ret.begin(), ret.end(),
+        [](const CopySetInfo &a, const CopySetInfo &b) {
+            return a.GetId() < b.GetId();
+        });
     return ret;
 }
 
 std::vector<CopySetKey> TopologyImpl::GetCopySetsInCluster(
     CopySetFilter filter) const {
     std::vector<CopySetKey> ret;
-    ReadLockGuard rlockCopySet(copySetMutex_);
-    for (auto it : copySetMap_) {
-        if (filter(it.second)) {
-            ret.push_back(it.first);
+    for (const auto &shard : copySetShards_) {
+        ReadLockGuard rlockCopySet(shard.mutex);
+        for (const auto &it : shard.copySetMap) {
+            if (filter(it.second)) {
+                ret.push_back(it.first);
+            }
         }
     }
+    std::sort(ret.begin(), ret.end());
     return ret;
 }
 
@@ -1364,12 +1395,16 @@ std::vector<CopySetKey> TopologyImpl::GetCopySetsInChunkServer(
     ChunkServerIdType id,
     CopySetFilter filter) const {
     std::vector<CopySetKey> ret;
-    ReadLockGuard rlockCopySet(copySetMutex_);
-    for (auto it : copySetMap_) {
-        if (filter(it.second) && it.second.GetCopySetMembers().count(id) > 0) {
-            ret.push_back(it.first);
+    for (const auto &shard : copySetShards_) {
+        ReadLockGuard rlockCopySet(shard.mutex);
+        for (const auto &it : shard.copySetMap) {
+            if (filter(it.second) &&
+                it.second.GetCopySetMembers().count(id) > 0) {
+                ret.push_back(it.first);
+            }
         }
     }
+    std::sort(ret.begin(), ret.end());
     return ret;
 }
 
@@ -1384,35 +1419,94 @@ int TopologyImpl::Run() {
 int TopologyImpl::Stop() {
     if (!isStop_.exchange(true)) {
         LOG(INFO) << "stop TopologyImpl...";
-        sleeper_.interrupt();
+        {
+            ::curve::common::LockGuard lk(flushWaitMutex_);
+            flushCond_.notify_all();
+        }
         backEndThread_.join();
+        // the next leader loads the flushed ones
+        FlushCopySetToStorage();
+        FlushChunkServerToStorage();
         LOG(INFO) << "stop TopologyImpl ok.";
     }
     return 0;
 }
 
 void TopologyImpl::BackEndFunc() {
-     while (sleeper_.wait_for(
-         std::chrono::seconds(option_.TopologyUpdateToRepoSec))) {
+    while (WaitForFlush()) {
         FlushCopySetToStorage();
         FlushChunkServerToStorage();
     }
 }
 
+bool TopologyImpl::WaitForFlush() {
+    ::curve::common::UniqueLock lk(flushWaitMutex_);
+    flushCond_.wait_for(lk,
+        std::chrono::seconds(option_.TopologyUpdateToRepoSec),
+        [this] { return isStop_.load() || flushRequested_; });
+    flushRequested_ = false;
+    return !isStop_.load();
+}
+
+void TopologyImpl::OnCopySetDirty() {
+    uint32_t threshold = option_.CopySetFlushDirtyThreshold;
+    if (threshold > 0 && dirtyCopySetNum_.fetch_add(1) + 1 == threshold) {
+        ::curve::common::LockGuard lk(flushWaitMutex_);
+        flushRequested_ = true;
+        flushCond_.notify_all();
+    }
+}
+
 void TopologyImpl::FlushCopySetToStorage() {
     std::vector<PoolIdType> pools = GetLogicalPoolInCluster();
-    for (const auto poolId : pools) {
-        ReadLockGuard rlockCopySetMap(copySetMutex_);
-        for (auto &c : copySetMap_) {
+    std::set<PoolIdType> poolSet(pools.begin(), pools.end());
+    ::curve::common::LockGuard lockFlush(copySetFlushMutex_);
+    dirtyCopySetNum_.store(0);
+    // the dirty copysets are copied with the locks of their shards, and
+    // updated to storage without any lock, so that heartbeats are not
+    // blocked by storage
+    std::vector<CopySetInfo> toUpdate;
+    for (auto &shard : copySetShards_) {
+        ReadLockGuard rlockCopySetMap(shard.mutex);
+        for (auto &c : shard.copySetMap) {
             WriteLockGuard wlockCopySet(c.second.GetRWLockRef());
             if (c.second.GetDirtyFlag() &&
-                        c.second.GetLogicalPoolId() == poolId) {
+                        poolSet.count(c.second.GetLogicalPoolId()) > 0) {
                 c.second.SetDirtyFlag(false);
-                if (!storage_->UpdateCopySet(c.second)) {
-                    LOG(WARNING) << "update copyset("
-                                 << c.second.GetLogicalPoolId()
-                                 << "," << c.second.GetId() << ") to repo fail";
-                }
+                toUpdate.push_back(c.second);
+            }
+        }
+    }
+    UpdateCopySetsToStorage(toUpdate);
+}
+
+void TopologyImpl::UpdateCopySetsToStorage(
+    const std::vector<CopySetInfo> &copysets) {
+    size_t batchSize = std::max(option_.CopySetFlushBatchSize, 1u);
+    for (size_t begin = 0; begin < copysets.size(); begin += batchSize) {
+        size_t end = std::min(begin + batchSize, copysets.size());
+        bool ok;
+        if (batchSize == 1) {
+            ok = storage_->UpdateCopySet(copysets[begin]);
+        } else {
+            ok = storage_->UpdateCopySets(std::vector<CopySetInfo>(
+                copysets.begin() + begin, copysets.begin() + end));
+        }
+        if (ok) {
+            continue;
+        }
+
+        for (size_t i = begin; i < end; i++) {
+            CopySetKey key(copysets[i].GetLogicalPoolId(),
+                           copysets[i].GetId());
+            LOG(WARNING) << "update copyset(" << key.first << ","
+                         << key.second << ") to repo fail";
+            CopySetShard &shard = GetCopySetShard(key);
+            ReadLockGuard rlockCopySetMap(shard.mutex);
+            auto it = shard.copySetMap.find(key);
+            if (it != shard.copySetMap.end()) {
+                WriteLockGuard wlockCopySet(it->second.GetRWLockRef());
+                it->second.SetDirtyFlag(true);
             }
         }
     }
@@ -22,6 +22,7 @@
 #ifndef SRC_MDS_TOPOLOGY_TOPOLOGY_H_
 #define SRC_MDS_TOPOLOGY_TOPOLOGY_H_
 
+#include <atomic>
 #include <unordered_map>
 #include <string>
 #include <list>
@@ -393,7 +394,9 @@ class TopologyImpl : public Topology {
         : idGenerator_(idGenerator),
           tokenGenerator_(tokenGenerator),
           storage_(storage),
-          isStop_(true) {
+          isStop_(true),
+          flushRequested_(false),
+          dirtyCopySetNum_(0) {
     }
 
     ~TopologyImpl() {
@@ -678,18 +681,43 @@ class TopologyImpl : public Topology {
  private:
     int LoadClusterInfo();
 
-    int CleanInvalidLogicalPoolAndCopyset();
+    int CleanInvalidLogicalPoolAndCopyset(
+        std::map<CopySetKey, CopySetInfo> *copySetMap);
 
     void BackEndFunc();
 
+    // wait for the next flush, return false if stopped
+    bool WaitForFlush();
+
+    // called after a copyset becomes dirty
+    void OnCopySetDirty();
+
     void FlushCopySetToStorage();
 
+    // update the copysets to storage in batches, the failed ones are marked
+    // dirty again to be retried by the next flush
+    void UpdateCopySetsToStorage(const std::vector<CopySetInfo> &copysets);
+
     void FlushChunkServerToStorage();
 
     void SetChunkServerExternalIp();
 
     bool CreateDefaultPoolset();
 
+    // copysets are sharded by copyset id, so that heartbeats, schedulers and
+    // clients accessing copysets in different shards do not contend on one
+    // lock, and a shard is only blocked by writes to its own copysets
+    struct CopySetShard {
+        mutable curve::common::RWLock mutex;
+        std::map<CopySetKey, CopySetInfo> copySetMap;
+    };
+
+    static const uint32_t kCopySetShardNum = 64;
+
+    CopySetShard &GetCopySetShard(const CopySetKey &key) const {
+        return copySetShards_[key.second % kCopySetShardNum];
+    }
+
  private:
     std::unordered_map<PoolsetIdType, Poolset> poolsetMap_;
     std::unordered_map<PoolIdType, LogicalPool> logicalPoolMap_;
@@ -698,7 +726,7 @@ class TopologyImpl : public Topology {
     std::unordered_map<ServerIdType, Server> serverMap_;
     std::unordered_map<ChunkServerIdType, ChunkServer> chunkServerMap_;
 
-    std::map<CopySetKey, CopySetInfo> copySetMap_;
+    mutable CopySetShard copySetShards_[kCopySetShardNum];
 
     // cluster info
     ClusterInformation clusterInfo;
@@ -714,12 +742,23 @@ class TopologyImpl : public Topology {
     mutable curve::common::RWLock zoneMutex_;
     mutable curve::common::RWLock serverMutex_;
     mutable curve::common::RWLock chunkServerMutex_;
-    mutable curve::common::RWLock copySetMutex_;
+    // the locks of copyset shards, hold at most one of them at a time
 
     TopologyOption option_;
     curve::common::Thread backEndThread_;
     curve::common::Atomic<bool> isStop_;
-    InterruptibleSleeper sleeper_;
+
+    // dirty copysets are updated to storage without their locks, so the
+    // other updates of copysets to storage hold it as well, otherwise they
+    // may be overwritten by the stale ones being flushed.
+    // fetched before the locks of copyset shards
+    curve::common::Mutex copySetFlushMutex_;
+    // wake up the background flush before TopologyUpdateToRepoSec
+    curve::common::Mutex flushWaitMutex_;
+    curve::common::ConditionVariable flushCond_;
+    bool flushRequested_;
+    // number of copysets became dirty since the last flush
+    std::atomic<uint32_t> dirtyCopySetNum_;
 };
 
 }  // namespace topology
@@ -30,6 +30,8 @@
 #include <list>
 #include <random>
 
+#include "src/common/timeutility.h"
+
 
 namespace curve {
 namespace mds {
@@ -65,6 +67,10 @@ bool TopologyChunkAllocatorImpl::AllocateChunkRandomInSingleLogicalPool(
                    << " logicalPoolId = " << logicalPoolChosenId;
         return false;
     }
+    if (ChooseCopySetPolicy::kLoad == copySetPolicy_) {
+        return AllocateChunkByLoad(logicalPoolChosenId, copySetIds,
+                                   chunkNumber, infos);
+    }
     ret = AllocateChunkPolicy::AllocateChunkRandomInSingleLogicalPool(
         copySetIds, logicalPoolChosenId, chunkNumber, infos);
     return ret;
@@ -98,6 +104,10 @@ bool TopologyChunkAllocatorImpl::AllocateChunkRoundRobinInSingleLogicalPool(
                    << " logicalPoolId = " << logicalPoolChosenId;
         return false;
     }
+    if (ChooseCopySetPolicy::kLoad == copySetPolicy_) {
+        return AllocateChunkByLoad(logicalPoolChosenId, copySetIds,
+                                   chunkNumber, infos);
+    }
 
     uint32_t nextIndex = 0;
 
@@ -122,6 +132,100 @@ bool TopologyChunkAllocatorImpl::AllocateChunkRoundRobinInSingleLogicalPool(
     return ret;
 }
 
+bool TopologyChunkAllocatorImpl::AllocateChunkByLoad(
+    PoolIdType logicalPoolId, const std::vector<CopySetIdType> &copySetIds,
+    uint32_t chunkNumber, std::vector<CopysetIdInfo> *infos) {
+    std::vector<double> weights;
+    weights.reserve(copySetIds.size());
+    {
+        ::curve::common::LockGuard guard(loadWeightMapLock_);
+        CopySetLoadWeight &load = loadWeightMap_[logicalPoolId];
+        uint64_t now = ::curve::common::TimeUtility::GetTimeofDayMs();
+        if (load.updateTimeMs == 0 ||
+            now >= load.updateTimeMs + loadUpdateIntervalMs_) {
+            load.weights.clear();
+            ComputeCopySetLoadWeight(logicalPoolId, &load.weights);
+            load.updateTimeMs = now;
+        }
+        for (auto id : copySetIds) {
+            // e.g. copysets created after the weights were computed
+            auto it = load.weights.find(id);
+            weights.push_back(it == load.weights.end() ? 1 : it->second);
+        }
+    }
+
+    if (AllocateChunkPolicy::AllocateChunkByWeightInSingleLogicalPool(
+            copySetIds, weights, logicalPoolId, chunkNumber, infos)) {
+        return true;
+    }
+    // all chunkservers are full by the statistics, the space is checked
+    // again when chunks are written, so do not fail the allocation here
+    LOG(WARNING) << "AllocateChunkByLoad, all copysets of logicalPool "
+                 << logicalPoolId << " have no weight, choose randomly.";
+    return AllocateChunkPolicy::AllocateChunkRandomInSingleLogicalPool(
+        copySetIds, logicalPoolId, chunkNumber, infos);
+}
+
+void TopologyChunkAllocatorImpl::ComputeCopySetLoadWeight(
+    PoolIdType logicalPoolId, std::map<CopySetIdType, double> *weights) {
+    struct ChunkServerLoad {
+        uint64_t iops;
+        uint64_t spaceLeft;
+    };
+    bool useChunkFilePool = chunkFilePoolAllocHelp_->GetUseChunkFilepool();
+    std::map<ChunkServerIdType, ChunkServerLoad> loads;
+    uint64_t iopsSum = 0;
+    uint64_t spaceSum = 0;
+    for (auto csId : topology_->GetChunkServerInLogicalPool(logicalPoolId)) {
+        ChunkServerStat stat;
+        // not reported yet
+        if (!topoStat_->GetChunkServerStat(csId, &stat)) {
+            continue;
+        }
+        ChunkServerLoad load;
+        load.iops = static_cast<uint64_t>(stat.readIOPS) + stat.writeIOPS;
+        load.spaceLeft = useChunkFilePool ? stat.chunkFilepoolSize
+                                          : stat.chunkSizeLeftBytes;
+        iopsSum += load.iops;
+        spaceSum += load.spaceLeft;
+        loads.emplace(csId, load);
+    }
+    if (loads.empty()) {
+        return;
+    }
+    double avgIops = static_cast<double>(iopsSum) / loads.size();
+    double avgSpace = static_cast<double>(spaceSum) / loads.size();
+
+    // the weight of a chunkserver is 1 if its iops and remaining space are
+    // both on average. It is halved when the iops is 3 times the average and
+    // doubled when idle, and is proportional to the remaining space.
+    std::map<ChunkServerIdType, double> csWeights;
+    for (const auto &load : loads) {
+        double weight = 1;
+        if (avgIops > 0) {
+            weight *= 2 * avgIops / (avgIops + load.second.iops);
+        }
+        if (avgSpace > 0) {
+            weight *= load.second.spaceLeft / avgSpace;
+        }
+        csWeights.emplace(load.first, weight);
+    }
+
+    // a copyset is as slow as its hottest replica and as full as its
+    // fullest replica, since every write goes to all of them
+    for (const auto &info :
+         topology_->GetCopySetInfosInLogicalPool(logicalPoolId)) {
+        double weight = -1;
+        for (auto csId : info.GetCopySetMembers()) {
+            auto it = csWeights.find(csId);
+            if (it != csWeights.end() && (weight < 0 || it->second < weight)) {
+                weight = it->second;
+            }
+        }
+        weights->emplace(info.GetId(), weight < 0 ? 1 : weight);
+    }
+}
+
 bool TopologyChunkAllocatorImpl::ChooseSingleLogicalPool(
     curve::mds::FileType fileType, const std::string& pstName,
     PoolIdType *poolOut) {
@@ -133,8 +237,11 @@ bool TopologyChunkAllocatorImpl::ChooseSingleLogicalPool(
         poolType = LogicalPoolType::PAGEFILE;
         break;
     }
+    case INODE_APPENDECFILE: {
+        poolType = LogicalPoolType::APPENDECFILE;
+        break;
+    }
     case INODE_APPENDFILE:
-    case INODE_APPENDECFILE:
     default:
         return false;
         break;
@@ -219,8 +326,9 @@ void TopologyChunkAllocatorImpl::GetRemainingSpaceInLogicalPool(
         int64_t alloc = 0;
         allocStatistic_->GetAllocByLogicalPool(pid, &alloc);
 
-        // multipled by replica number
-        alloc *= lPool.GetReplicaNum();
+        // multipled by replica number, or the ratio of the stripe size to
+        // the data size for the erasure coded pool
+        alloc = static_cast<int64_t>(alloc * lPool.GetSpaceAmplification());
 
         // calculate remaining capacity
         uint64_t diskRemainning = (static_cast<int64_t>(diskCapacity) > alloc)
@@ -275,6 +383,37 @@ bool AllocateChunkPolicy::AllocateChunkRoundRobinInSingleLogicalPool(
     return true;
 }
 
+bool AllocateChunkPolicy::AllocateChunkByWeightInSingleLogicalPool(
+    const std::vector<CopySetIdType> &copySetIds,
+    const std::vector<double> &weights, PoolIdType logicalPoolId,
+    uint32_t chunkNumber, std::vector<CopysetIdInfo> *infos) {
+    if (copySetIds.empty() || copySetIds.size() != weights.size()) {
+        return false;
+    }
+    double sum = 0;
+    for (double w : weights) {
+        sum += w;
+    }
+    if (sum <= 0) {
+        return false;
+    }
+    infos->clear();
+
+    // every chunk is placed independently, so the chunks allocated before
+    // the next heartbeat are spread over the cold copysets instead of all
+    // going to the coldest one
+    static std::random_device rd;
+    static std::mt19937 gen(rd());
+    std::discrete_distribution<size_t> dis(weights.begin(), weights.end());
+    for (uint32_t i = 0; i < chunkNumber; i++) {
+        CopysetIdInfo idInfo;
+        idInfo.logicalPoolId = logicalPoolId;
+        idInfo.copySetId = copySetIds[dis(gen)];
+        infos->push_back(idInfo);
+    }
+    return true;
+}
+
 bool AllocateChunkPolicy::ChooseSingleLogicalPoolByWeight(
     const std::map<PoolIdType, double> &poolWeightMap, PoolIdType *poolIdOut) {
     if (poolWeightMap.empty()) {
@@ -47,6 +47,14 @@ enum class ChoosePoolPolicy {
     kWeight,
 };
 
+enum class ChooseCopySetPolicy {
+    // choose copysets randomly or by round robin as the caller requested
+    kDefault = 0,
+    // choose copysets randomly, weighted by the remaining space and the
+    // io load of their chunkservers, so hot chunkservers get fewer chunks
+    kLoad,
+};
+
 class ChunkFilePoolAllocHelp {
  public:
     ChunkFilePoolAllocHelp()
@@ -123,7 +131,10 @@ class TopologyChunkAllocatorImpl : public TopologyChunkAllocator {
           topoStat_(topologyStat),
           chunkFilePoolAllocHelp_(ChunkFilePoolAllocHelp),
           policy_(static_cast<ChoosePoolPolicy>(option.choosePoolPolicy)),
-          enableLogicalPoolStatus_(option.enableLogicalPoolStatus) {
+          enableLogicalPoolStatus_(option.enableLogicalPoolStatus),
+          copySetPolicy_(
+              static_cast<ChooseCopySetPolicy>(option.chooseCopySetPolicy)),
+          loadUpdateIntervalMs_(option.CopySetLoadUpdateIntervalMs) {
         std::srand(std::time(nullptr));
     }
     ~TopologyChunkAllocatorImpl() {}
@@ -191,6 +202,38 @@ class TopologyChunkAllocatorImpl : public TopologyChunkAllocator {
         const std::string& pstName,
         PoolIdType *poolOut);
 
+    /**
+     * @brief allocate chunks in copysets weighted by their load
+     *
+     * @param logicalPoolId logical pool id
+     * @param copySetIds available copysets in the logical pool
+     * @param chunkNumber number of chunks to allocate
+     * @param infos copyset list that chunks allocated to
+     *
+     * @retval true if succeeded
+     * @retval false if failed
+     */
+    bool AllocateChunkByLoad(PoolIdType logicalPoolId,
+        const std::vector<CopySetIdType> &copySetIds,
+        uint32_t chunkNumber,
+        std::vector<CopysetIdInfo> *infos);
+
+    /**
+     * @brief compute the load weight of every copyset in a logical pool
+     *        from the statistics of its chunkservers
+     *
+     * @param logicalPoolId logical pool id
+     * @param[out] weights weight of every copyset, 1 on average
+     */
+    void ComputeCopySetLoadWeight(PoolIdType logicalPoolId,
+        std::map<CopySetIdType, double> *weights);
+
+ private:
+    struct CopySetLoadWeight {
+        uint64_t updateTimeMs = 0;
+        std::map<CopySetIdType, double> weights;
+    };
+
  private:
     std::shared_ptr<Topology> topology_;
 
@@ -220,6 +263,20 @@ class TopologyChunkAllocatorImpl : public TopologyChunkAllocator {
     ChoosePoolPolicy policy_;
     // enableLogicalPoolStatus
     bool enableLogicalPoolStatus_;
+    // policy for choosing copyset
+    ChooseCopySetPolicy copySetPolicy_;
+    // time interval of recomputing the load weight of copysets
+    uint32_t loadUpdateIntervalMs_;
+    /**
+     * @brief load weight of copysets of every logical pool, recomputed
+     *        every loadUpdateIntervalMs_ as heartbeats update the statistics
+     *        at a much lower rate than chunks are allocated
+     */
+    std::map<PoolIdType, CopySetLoadWeight> loadWeightMap_;
+    /**
+     * @brief mutex for loadWeightMap_
+     */
+    ::curve::common::Mutex loadWeightMapLock_;
 };
 
 /**
@@ -265,6 +322,24 @@ class AllocateChunkPolicy {
         uint32_t *nextIndex, uint32_t chunkNumber,
         std::vector<CopysetIdInfo> *infos);
 
+    /**
+     * @brief allocate chunks randomly in a single logical pool, the chance
+     *        of a copyset to be chosen is proportional to its weight
+     *
+     * @param copySetIds copyset id list in designated logical pool
+     * @param weights weight of every copyset in copySetIds
+     * @param logicalPoolId logical pool id
+     * @param chunkNumber number of chunks to allocate
+     * @param infos copyset list that chunks allocated to
+     *
+     * @retval true if succeeded
+     * @retval false if failed, e.g. all weights are 0
+     */
+    static bool AllocateChunkByWeightInSingleLogicalPool(
+        const std::vector<CopySetIdType> &copySetIds,
+        const std::vector<double> &weights, PoolIdType logicalPoolId,
+        uint32_t chunkNumber, std::vector<CopysetIdInfo> *infos);
+
     /**
      * @brief choose a logical pool according to their weight
      *
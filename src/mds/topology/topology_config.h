@@ -46,6 +46,17 @@ struct TopologyOption {
     int choosePoolPolicy;
     // enable LogicalPool ALLOW/DENY status
     bool enableLogicalPoolStatus;
+    // max number of copysets updated to storage in one txn,
+    // updated one by one if not greater than 1
+    uint32_t CopySetFlushBatchSize;
+    // flush before TopologyUpdateToRepoSec when so many copysets are dirty,
+    // 0 means only flush periodically
+    uint32_t CopySetFlushDirtyThreshold;
+    // policy of copyset choosing when allocating chunks
+    int chooseCopySetPolicy;
+    // time interval that the load weight of copysets are recomputed
+    // from the heartbeat statistics (in ms)
+    uint32_t CopySetLoadUpdateIntervalMs;
 
     TopologyOption()
         : TopologyUpdateToRepoSec(0),
@@ -54,7 +65,11 @@ struct TopologyOption {
           CreateCopysetRpcRetrySleepTimeMs(500),
           UpdateMetricIntervalSec(0),
           choosePoolPolicy(0),
-          enableLogicalPoolStatus(false) {}
+          enableLogicalPoolStatus(false),
+          CopySetFlushBatchSize(1),
+          CopySetFlushDirtyThreshold(0),
+          chooseCopySetPolicy(0),
+          CopySetLoadUpdateIntervalMs(1000) {}
 };
 
 }  // namespace topology
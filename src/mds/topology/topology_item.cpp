@@ -83,8 +83,22 @@ bool LogicalPool::TransRedundanceAndPlaceMentPolicyFromJsonStr(
         return false;
     }
     case LogicalPoolType::APPENDECFILE: {
-        // TODO(xuchaojie): it is not done.
-        return false;
+        if (!rapJson["dSegmentNum"].isUInt() ||
+            !rapJson["cSegmentNum"].isUInt() ||
+            !rapJson["copysetNum"].isUInt() ||
+            !rapJson["zoneNum"].isUInt()) {
+            return false;
+        }
+        rap->appendECFileRAP.dSegmentNum = rapJson["dSegmentNum"].asUInt();
+        rap->appendECFileRAP.cSegmentNum = rapJson["cSegmentNum"].asUInt();
+        rap->appendECFileRAP.copysetNum = rapJson["copysetNum"].asUInt();
+        rap->appendECFileRAP.zoneNum = rapJson["zoneNum"].asUInt();
+        // a stripe survives the loss of cSegmentNum chunkservers
+        if (rap->appendECFileRAP.dSegmentNum == 0 ||
+            rap->appendECFileRAP.cSegmentNum == 0) {
+            return false;
+        }
+        break;
     }
     default: {
         return false;
@@ -125,7 +139,11 @@ std::string LogicalPool::GetRedundanceAndPlaceMentPolicyJsonStr() const {
         break;
     }
     case LogicalPoolType::APPENDECFILE: {
-        // TODO(xuchaojie): fix it
+        rapJson["dSegmentNum"] = rap_.appendECFileRAP.dSegmentNum;
+        rapJson["cSegmentNum"] = rap_.appendECFileRAP.cSegmentNum;
+        rapJson["copysetNum"] = rap_.appendECFileRAP.copysetNum;
+        rapJson["zoneNum"] = rap_.appendECFileRAP.zoneNum;
+        rapStr = rapJson.toStyledString();
         break;
     }
     default:
@@ -157,7 +175,9 @@ uint16_t LogicalPool::GetReplicaNum() const {
         break;
     }
     case LogicalPoolType::APPENDECFILE: {
-        // TODO(xuchaojie): fix it
+        // chunkservers of a stripe group
+        ret = rap_.appendECFileRAP.dSegmentNum +
+              rap_.appendECFileRAP.cSegmentNum;
         break;
     }
     default:
@@ -166,6 +186,17 @@ uint16_t LogicalPool::GetReplicaNum() const {
     return ret;
 }
 
+double LogicalPool::GetSpaceAmplification() const {
+    if (GetLogicalPoolType() == LogicalPoolType::APPENDECFILE) {
+        if (rap_.appendECFileRAP.dSegmentNum == 0) {
+            return 0;
+        }
+        return static_cast<double>(GetReplicaNum()) /
+               rap_.appendECFileRAP.dSegmentNum;
+    }
+    return GetReplicaNum();
+}
+
 bool LogicalPool::SerializeToString(std::string *value) const {
     LogicalPoolData data;
     data.set_logicalpoolid(id_);
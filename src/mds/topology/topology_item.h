@@ -67,10 +67,13 @@ class LogicalPool {
             uint16_t zoneNum;
         } appendFileRAP;
 
+        // a copyset of the pool is a stripe group of dSegmentNum data
+        // and cSegmentNum parity chunkservers, each in a different zone
         struct ECRAP {
             uint16_t dSegmentNum;
             uint32_t cSegmentNum;
             uint16_t zoneNum;
+            uint32_t copysetNum;
         } appendECFileRAP;
     };
 
@@ -155,8 +158,14 @@ class LogicalPool {
         return rap_;
     }
 
+    // chunkservers of a copyset
     uint16_t GetReplicaNum() const;
 
+    // bytes stored on the chunkservers for one byte allocated, it's the
+    // replica number, or (dSegmentNum + cSegmentNum) / dSegmentNum for the
+    // erasure coded pool
+    double GetSpaceAmplification() const;
+
     std::string GetRedundanceAndPlaceMentPolicyJsonStr() const;
 
     uint64_t GetCreateTime() const {
@@ -209,15 +209,17 @@ void TopologyMetricService::UpdateTopologyMetrics() {
         allocStatistic_->GetAllocByLogicalPool(pid, &diskAlloc);
         it->second->logicalAlloc.set_value(diskAlloc);
         // replica number should be considered
-        it->second->diskAlloc.set_value(diskAlloc * pool.GetReplicaNum());
+        const double amplification = pool.GetSpaceAmplification();
+        it->second->diskAlloc.set_value(
+            static_cast<uint64_t>(diskAlloc * amplification));
 
         it->second->chunkSizeUsedBytes.set_value(totalChunkSizeUsedBytes);
         it->second->chunkSizeLeftBytes.set_value(totalChunkSizeLeftBytes);
         it->second->chunkSizeTrashedBytes.set_value(totalChunkSizeTrashedBytes);
         it->second->chunkSizeTotalBytes.set_value(totalChunkSizeBytes);
-        if (pool.GetReplicaNum() != 0) {
+        if (amplification != 0) {
             it->second->logicalCapacity.set_value(
-                totalChunkSizeBytes / pool.GetReplicaNum());
+                static_cast<uint64_t>(totalChunkSizeBytes / amplification));
         }
 
         uint64_t readRate = 0, writeRate = 0,
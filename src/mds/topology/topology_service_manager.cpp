@@ -1059,12 +1059,17 @@ int TopologyServiceManager::CreateCopysetForLogicalPool(
     std::vector<CopySetInfo> *copysetInfos) {
     switch (lPool.GetLogicalPoolType()) {
         case LogicalPoolType::PAGEFILE: {
-            int errcode = GenCopysetForPageFilePool(lPool,
+            const LogicalPool::RedundanceAndPlaceMentPolicy rap =
+                lPool.GetRedundanceAndPlaceMentPolicy();
+            int errcode = GenCopysetForLogicalPool(lPool,
+                rap.pageFileRAP.replicaNum,
+                rap.pageFileRAP.copysetNum,
+                rap.pageFileRAP.zoneNum,
                 scatterWidth,
                 copysetInfos);
             if (kTopoErrCodeSuccess != errcode) {
                 LOG(ERROR) << "CreateCopysetForLogicalPool fail in : "
-                           << "GenCopysetForPageFilePool.";
+                           << "GenCopysetForLogicalPool.";
                 return errcode;
             }
             errcode = CreateCopysetNodeOnChunkServer(*copysetInfos);
@@ -1082,10 +1087,22 @@ int TopologyServiceManager::CreateCopysetForLogicalPool(
             return kTopoErrCodeInvalidParam;
         }
         case LogicalPoolType::APPENDECFILE: {
-            // TODO(xuchaojie): it is not done.
-            LOG(ERROR) << "CreateCopysetForLogicalPool invalid logicalPoolType:"
-                       << lPool.GetLogicalPoolType();
-            return kTopoErrCodeInvalidParam;
+            // the copysets are the stripe groups, they are not raft groups,
+            // so no copyset node is created on the chunkservers
+            const LogicalPool::RedundanceAndPlaceMentPolicy rap =
+                lPool.GetRedundanceAndPlaceMentPolicy();
+            int errcode = GenCopysetForLogicalPool(lPool,
+                lPool.GetReplicaNum(),
+                rap.appendECFileRAP.copysetNum,
+                rap.appendECFileRAP.zoneNum,
+                scatterWidth,
+                copysetInfos);
+            if (kTopoErrCodeSuccess != errcode) {
+                LOG(ERROR) << "CreateCopysetForLogicalPool fail in : "
+                           << "GenCopysetForLogicalPool.";
+                return errcode;
+            }
+            break;
         }
         default: {
             LOG(ERROR) << "CreateCopysetForLogicalPool invalid logicalPoolType:"
@@ -1096,8 +1113,11 @@ int TopologyServiceManager::CreateCopysetForLogicalPool(
     return kTopoErrCodeSuccess;
 }
 
-int TopologyServiceManager::GenCopysetForPageFilePool(
+int TopologyServiceManager::GenCopysetForLogicalPool(
     const LogicalPool &lPool,
+    uint16_t replicaNum,
+    uint32_t copysetNum,
+    uint16_t zoneNum,
     uint32_t *scatterWidth,
     std::vector<CopySetInfo> *copysetInfos) {
     ClusterInfo cluster;
@@ -1129,24 +1149,22 @@ int TopologyServiceManager::GenCopysetForPageFilePool(
     }
 
     std::vector<Copyset> copysets;
-    LogicalPool::RedundanceAndPlaceMentPolicy rap =
-        lPool.GetRedundanceAndPlaceMentPolicy();
     PoolIdType logicalPoolId = lPool.GetId();
 
     CopysetConstrait constrait;
     constrait.zoneNum = CopysetConstrait::NUM_ANY;
-    constrait.zoneChoseNum = rap.pageFileRAP.zoneNum;
-    constrait.replicaNum = rap.pageFileRAP.replicaNum;
+    constrait.zoneChoseNum = zoneNum;
+    constrait.replicaNum = replicaNum;
     if (copysetManager_->Init(constrait)) {
         if (!copysetManager_->GenCopyset(cluster,
-            rap.pageFileRAP.copysetNum,
+            copysetNum,
             scatterWidth,
             &copysets)) {
-            LOG(ERROR) << "GenCopysetForPageFilePool failed"
+            LOG(ERROR) << "GenCopysetForLogicalPool failed"
                        << ", Cluster size = "
                        << cluster.GetClusterSize()
                        << ", copysetNum = "
-                       << rap.pageFileRAP.copysetNum
+                       << copysetNum
                        << ", scatterWidth = "
                        << *scatterWidth
                        << ", logicalPoolid = "
@@ -1154,11 +1172,11 @@ int TopologyServiceManager::GenCopysetForPageFilePool(
             return kTopoErrCodeGenCopysetErr;
         }
     } else {
-        LOG(ERROR) << "GenCopysetForPageFilePool invalid param :"
+        LOG(ERROR) << "GenCopysetForLogicalPool invalid param :"
                    << " zoneNum = "
-                   << rap.pageFileRAP.zoneNum
+                   << zoneNum
                    << " replicaNum = "
-                   << rap.pageFileRAP.replicaNum
+                   << replicaNum
                    << ", logicalPoolid = "
                    << lPool.GetId();
         return kTopoErrCodeInvalidParam;
@@ -1442,6 +1460,11 @@ void TopologyServiceManager::CreateLogicalPool(
                     lPool.SetRedundanceAndPlaceMentPolicy(rap);
                     break;
                 }
+                case LogicalPoolType::APPENDECFILE: {
+                    rap.appendECFileRAP.copysetNum = copysetInfos.size();
+                    lPool.SetRedundanceAndPlaceMentPolicy(rap);
+                    break;
+                }
                 default: {
                     LOG(ERROR) << "invalid logicalPoolType:"
                                << lPool.GetLogicalPoolType();
@@ -219,17 +219,24 @@ class TopologyServiceManager {
         std::vector<CopySetInfo> *copysetInfos);
 
     /**
-    * @brief create copyset for PageFilePool
+    * @brief create copyset for a logical pool, the replicas of every
+    *        copyset are in different zones
     *
     * @param lPool target logical pool
+    * @param replicaNum replica number of every copyset
+    * @param copysetNum number of copysets to create
+    * @param zoneNum number of zones chosen for every copyset
     * @param[in][out] scatterWidth target scatterWidth as input,
     *                              actual scatterWidth as output
     * @param[out] copysetInfos Info of copyset to be created
     *
     * @return error code
     */
-    int GenCopysetForPageFilePool(
+    int GenCopysetForLogicalPool(
         const LogicalPool &lPool,
+        uint16_t replicaNum,
+        uint32_t copysetNum,
+        uint16_t zoneNum,
         uint32_t *scatterWidth,
         std::vector<CopySetInfo> *copysetInfos);
 
@@ -86,6 +86,8 @@ class TopologyStorage {
     virtual bool UpdateServer(const Server &data) = 0;
     virtual bool UpdateChunkServer(const ChunkServer &data) = 0;
     virtual bool UpdateCopySet(const CopySetInfo &data) = 0;
+    // update the copysets atomically
+    virtual bool UpdateCopySets(const std::vector<CopySetInfo> &datas) = 0;
 
     virtual bool LoadClusterInfo(std::vector<ClusterInformation> *info) = 0;
     virtual bool StorageClusterInfo(const ClusterInformation &info) = 0;
@@ -535,6 +535,36 @@ bool TopologyStorageEtcd::UpdateCopySet(const CopySetInfo &data) {
     return StorageCopySet(data);
 }
 
+bool TopologyStorageEtcd::UpdateCopySets(
+    const std::vector<CopySetInfo> &datas) {
+    std::vector<std::string> keys(datas.size());
+    std::vector<std::string> values(datas.size());
+    std::vector<Operation> ops;
+    ops.reserve(datas.size());
+    for (size_t i = 0; i < datas.size(); i++) {
+        CopySetKey id(datas[i].GetLogicalPoolId(), datas[i].GetId());
+        keys[i] = codec_->EncodeCopySetKey(id);
+        if (!codec_->EncodeCopySetData(datas[i], &values[i])) {
+            LOG(ERROR) << "EncodeCopySetData err"
+                       << ", logicalPoolId = " << id.first
+                       << ", copysetId = " << id.second;
+            return false;
+        }
+        ops.push_back(Operation{
+            OpType::OpPut, const_cast<char *>(keys[i].c_str()),
+            const_cast<char *>(values[i].c_str()),
+            static_cast<int>(keys[i].size()),
+            static_cast<int>(values[i].size())});
+    }
+    int errCode = client_->TxnN(ops);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "Put " << datas.size() << " copysets into etcd err"
+                   << ", errcode = " << errCode;
+        return false;
+    }
+    return true;
+}
+
 bool TopologyStorageEtcd::LoadClusterInfo(
     std::vector<ClusterInformation> *info) {
     std::string value;
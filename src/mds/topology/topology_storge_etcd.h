@@ -91,6 +91,7 @@ class TopologyStorageEtcd : public TopologyStorage {
     bool UpdateServer(const Server &data) override;
     bool UpdateChunkServer(const ChunkServer &data) override;
     bool UpdateCopySet(const CopySetInfo &data) override;
+    bool UpdateCopySets(const std::vector<CopySetInfo> &datas) override;
 
     bool LoadClusterInfo(std::vector<ClusterInformation> *info) override;
     bool StorageClusterInfo(const ClusterInformation &info) override;
@@ -538,6 +538,8 @@ int CloneCoreImpl::BuildFileInfoFromSnapshot(
         CloneChunkInfo info;
         info.location = chunkDataName.ToDataChunkKey();
         info.needRecover = true;
+        info.compressed =
+            chunkDataName.compressType_ != CompressType::NONE;
         if (IsRecover(task)) {
             info.seqNum = chunkDataName.chunkSeqNum_;
         } else {
@@ -752,7 +754,10 @@ int CloneCoreImpl::CreateCloneChunk(
     for (auto & cloneSegmentInfo : *segInfos) {
         for (auto & cloneChunkInfo : cloneSegmentInfo.second) {
             std::string location;
-            if (IsSnapshot(task)) {
+            if (IsSnapshot(task) && cloneChunkInfo.second.compressed) {
+                location = LocationOperator::GenerateS3CompressedLocation(
+                    cloneChunkInfo.second.location);
+            } else if (IsSnapshot(task)) {
                 location = LocationOperator::GenerateS3Location(
                     cloneChunkInfo.second.location);
             } else {
@@ -1028,6 +1033,10 @@ int CloneCoreImpl::StartAsyncRecoverChunkPart(
     std::shared_ptr<CloneTaskInfo> task,
     std::shared_ptr<RecoverChunkTaskTracker> tracker,
     std::shared_ptr<RecoverChunkContext> context) {
+    // 限制后台recover的带宽，lazy克隆的卷在此期间仍按需读取源数据
+    if (recoverChunkThrottle_ != nullptr) {
+        recoverChunkThrottle_->Add(false, context->partSize);
+    }
     RecoverChunkClosure *cb = new RecoverChunkClosure(tracker, context);
     tracker->AddOneTrace();
     uint64_t offset = context->partIndex * context->partSize;
@@ -37,8 +37,10 @@
 #include "src/snapshotcloneserver/clone/clone_reference.h"
 #include "src/snapshotcloneserver/common/thread_pool.h"
 #include "src/common/concurrent/name_lock.h"
+#include "src/common/throttle.h"
 
 using ::curve::common::NameLock;
+using ::curve::common::Throttle;
 
 namespace curve {
 namespace snapshotcloneserver {
@@ -208,6 +210,8 @@ struct CloneChunkInfo {
     uint64_t seqNum;
     // chunk是否需要recover
     bool needRecover;
+    // s3上的chunk数据是否按块压缩
+    bool compressed = false;
 };
 
 // 克隆/恢复所需segment信息，key是ChunkIndex In Segment, value是chunk信息
@@ -239,7 +243,15 @@ class CloneCoreImpl : public CloneCore {
         recoverChunkConcurrency_(option.recoverChunkConcurrency),
         clientAsyncMethodRetryTimeSec_(option.clientAsyncMethodRetryTimeSec),
         clientAsyncMethodRetryIntervalMs_(
-            option.clientAsyncMethodRetryIntervalMs) {}
+            option.clientAsyncMethodRetryIntervalMs) {
+        if (option.recoverChunkBpsLimitMB > 0) {
+            ::curve::common::ReadWriteThrottleParams params;
+            params.bpsTotal.limit =
+                option.recoverChunkBpsLimitMB * 1024 * 1024;
+            recoverChunkThrottle_ = std::make_shared<Throttle>();
+            recoverChunkThrottle_->UpdateThrottleParams(params);
+        }
+    }
 
     ~CloneCoreImpl() {
     }
@@ -597,6 +609,8 @@ class CloneCoreImpl : public CloneCore {
     uint32_t createCloneChunkConcurrency_;
     // RecoverChunk同时进行的异步请求数量
     uint32_t recoverChunkConcurrency_;
+    // 所有任务共享的RecoverChunk带宽限制，为空时不限制
+    std::shared_ptr<Throttle> recoverChunkThrottle_;
     // client异步请求重试时间
     uint64_t clientAsyncMethodRetryTimeSec_;
     // 调用client异步方法重试时间间隔
@@ -318,7 +318,20 @@ int CloneServiceManager::GetCloneTaskInfoByFilter(
         const CloneFilterCondition &filter,
         std::vector<TaskCloneInfo> *info) {
     std::vector<CloneInfo> cloneInfos;
-    int ret = cloneCore_->GetCloneInfoList(&cloneInfos);
+    int ret = kErrCodeSuccess;
+    // 指定了任务id或目标文件时只取出对应的克隆信息，避免复制全部克隆信息，
+    // 与列出全部克隆信息时一样，没有记录时返回空列表
+    if (filter.GetUuid() != nullptr) {
+        CloneInfo cloneInfo;
+        if (cloneCore_->GetCloneInfo(*filter.GetUuid(), &cloneInfo) >= 0) {
+            cloneInfos.push_back(cloneInfo);
+        }
+    } else if (filter.GetDestination() != nullptr) {
+        cloneCore_->GetCloneInfoByFileName(
+            *filter.GetDestination(), &cloneInfos);
+    } else {
+        ret = cloneCore_->GetCloneInfoList(&cloneInfos);
+    }
     if (ret < 0) {
         LOG(ERROR) << "GetCloneInfoList fail"
                    << ", ret = " << ret;
@@ -147,6 +147,14 @@ class CloneFilterCondition {
         type_ = type;
     }
 
+    const std::string *GetUuid() const {
+        return uuid_;
+    }
+
+    const std::string *GetDestination() const {
+        return destination_;
+    }
+
  private:
     const std::string *uuid_;
     const std::string *source_;
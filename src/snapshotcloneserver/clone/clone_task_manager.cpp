@@ -69,6 +69,7 @@ int CloneTaskManager::PushCommonTask(std::shared_ptr<CloneTaskBase> task) {
     int ret =  PushTaskInternal(task,
         &commonTaskMap_,
         &commonTasksLock_,
+        &commonWaitingTasks_,
         commonPool_);
     if (ret >= 0) {
         cloneMetric_->UpdateBeforeTaskBegin(
@@ -83,6 +84,7 @@ int CloneTaskManager::PushStage1Task(std::shared_ptr<CloneTaskBase> task) {
     int ret = PushTaskInternal(task,
         &stage1TaskMap_,
         &stage1TasksLock_,
+        &stage1WaitingTasks_,
         stage1Pool_);
     if (ret >= 0) {
         cloneMetric_->UpdateBeforeTaskBegin(
@@ -98,6 +100,7 @@ int CloneTaskManager::PushStage2Task(
     int ret = PushTaskInternal(task,
         &stage2TaskMap_,
         &stage2TasksLock_,
+        &stage2WaitingTasks_,
         stage2Pool_);
     if (ret >= 0) {
         cloneMetric_->UpdateFlattenTaskBegin();
@@ -110,6 +113,7 @@ int CloneTaskManager::PushStage2Task(
 int CloneTaskManager::PushTaskInternal(std::shared_ptr<CloneTaskBase> task,
     std::map<std::string, std::shared_ptr<CloneTaskBase> > *taskMap,
     Mutex *taskMapMutex,
+    FairTaskQueue<CloneTaskBase> *waitingTasks,
     std::shared_ptr<ThreadPool> taskPool) {
     // 同一个clone的Stage1的Task和Stage2的Task的任务ID是一样的，
     // clean task的ID也是一样的,
@@ -138,7 +142,8 @@ int CloneTaskManager::PushTaskInternal(std::shared_ptr<CloneTaskBase> task,
                    << *(ret.first->second->GetTaskInfo());
         return kErrCodeTaskExist;
     }
-    taskPool->PushTask(task);
+    waitingTasks->Push(task->GetTaskInfo()->GetCloneInfo().GetUser(), task);
+    DispatchTasks(waitingTasks, taskPool);
     auto ret2 = cloneTaskMap_.emplace(task->GetTaskId(), task);
     if (!ret2.second) {
         LOG(ERROR) << "CloneTaskManager::PushTaskInternal fail, "
@@ -151,6 +156,15 @@ int CloneTaskManager::PushTaskInternal(std::shared_ptr<CloneTaskBase> task,
     return kErrCodeSuccess;
 }
 
+void CloneTaskManager::DispatchTasks(
+    FairTaskQueue<CloneTaskBase> *waitingTasks,
+    std::shared_ptr<ThreadPool> taskPool) {
+    std::shared_ptr<CloneTaskBase> task;
+    while ((task = waitingTasks->Pop()) != nullptr) {
+        taskPool->PushTask(task);
+    }
+}
+
 std::shared_ptr<CloneTaskBase> CloneTaskManager::GetTask(
     const TaskIdType &taskId) const {
     ReadLockGuard taskMapRlock(cloneTaskMapLock_);
@@ -188,12 +202,14 @@ void CloneTaskManager::ScanCommonTasks() {
             LOG(INFO) << "common task {"
                       << " TaskInfo : " << *taskInfo
                       << "} finish, going to remove.";
+            commonWaitingTasks_.Finish(taskInfo->GetCloneInfo().GetUser());
             cloneTaskMap_.erase(it->second->GetTaskId());
             it = commonTaskMap_.erase(it);
         } else {
             it++;
         }
     }
+    DispatchTasks(&commonWaitingTasks_, commonPool_);
 }
 
 void CloneTaskManager::ScanStage1Tasks() {
@@ -213,12 +229,14 @@ void CloneTaskManager::ScanStage1Tasks() {
             LOG(INFO) << "stage1 task {"
                       << " TaskInfo : " << *taskInfo
                       << "} finish, going to remove.";
+            stage1WaitingTasks_.Finish(taskInfo->GetCloneInfo().GetUser());
             cloneTaskMap_.erase(it->second->GetTaskId());
             it = stage1TaskMap_.erase(it);
         } else {
             it++;
         }
     }
+    DispatchTasks(&stage1WaitingTasks_, stage1Pool_);
 }
 
 void CloneTaskManager::ScanStage2Tasks() {
@@ -250,6 +268,8 @@ void CloneTaskManager::ScanStage2Tasks() {
                 LOG(INFO) << "stage2 task {"
                           << " TaskInfo : " << *taskInfo
                           << "} finish, going to remove.";
+                stage2WaitingTasks_.Finish(
+                    taskInfo->GetCloneInfo().GetUser());
                 cloneTaskMap_.erase(it->second->GetTaskId());
                 it = stage2TaskMap_.erase(it);
             }
@@ -257,6 +277,7 @@ void CloneTaskManager::ScanStage2Tasks() {
             it++;
         }
     }
+    DispatchTasks(&stage2WaitingTasks_, stage2Pool_);
 }
 
 }  // namespace snapshotcloneserver
@@ -27,11 +27,13 @@
 #include <map>
 #include <atomic>
 #include <string>
+#include <algorithm>
 #include <list>
 #include <thread>  // NOLINT
 
 #include "src/snapshotcloneserver/clone/clone_task.h"
 #include "src/snapshotcloneserver/common/thread_pool.h"
+#include "src/snapshotcloneserver/common/fair_task_queue.h"
 #include "src/common/concurrent/rw_lock.h"
 #include "src/common/snapshotclone/snapshotclone_define.h"
 #include "src/snapshotcloneserver/common/config.h"
@@ -70,6 +72,13 @@ class CloneTaskManager {
         stage1Pool_ = stage1Pool;
         stage2Pool_ = stage2Pool;
         commonPool_ = commonPool;
+        // 同时执行的任务不超过线程数，其余的在等待队列中按用户公平调度
+        stage1WaitingTasks_.SetMaxRunningNum(
+            std::max(option.stage1PoolThreadNum, 0));
+        stage2WaitingTasks_.SetMaxRunningNum(
+            std::max(option.stage2PoolThreadNum, 0));
+        commonWaitingTasks_.SetMaxRunningNum(
+            std::max(option.commonPoolThreadNum, 0));
         return kErrCodeSuccess;
     }
 
@@ -124,7 +133,8 @@ class CloneTaskManager {
      *
      * @param task 任务
      * @param taskMap 任务表
-     * @param taskMapMutex 任务表和线程池的锁
+     * @param taskMapMutex 任务表、等待队列和线程池的锁
+     * @param waitingTasks 等待队列
      * @param taskPool 线程池
      *
      * @return 错误码
@@ -133,6 +143,17 @@ class CloneTaskManager {
         std::shared_ptr<CloneTaskBase> task,
         std::map<std::string, std::shared_ptr<CloneTaskBase> > *taskMap,
         Mutex *taskMapMutex,
+        FairTaskQueue<CloneTaskBase> *waitingTasks,
+        std::shared_ptr<ThreadPool> taskPool);
+
+    /**
+     * @brief 执行中的任务未达到线程数时，从等待队列中选出任务放入线程池，
+     *        调用者持有等待队列的锁
+     *
+     * @param waitingTasks 等待队列
+     * @param taskPool 线程池
+     */
+    void DispatchTasks(FairTaskQueue<CloneTaskBase> *waitingTasks,
         std::shared_ptr<ThreadPool> taskPool);
 
  private:
@@ -155,6 +176,11 @@ class CloneTaskManager {
     std::map<std::string, std::shared_ptr<CloneTaskBase> > commonTaskMap_;
     mutable Mutex commonTasksLock_;
 
+    // 各线程池等待执行的任务，由对应任务表的锁保护
+    FairTaskQueue<CloneTaskBase> stage1WaitingTasks_;
+    FairTaskQueue<CloneTaskBase> stage2WaitingTasks_;
+    FairTaskQueue<CloneTaskBase> commonWaitingTasks_;
+
     // 用于Lazy克隆元数据部分的线程池
     std::shared_ptr<ThreadPool> stage1Pool_;
 
@@ -71,6 +71,19 @@ struct SnapshotCloneServerOptions {
     uint32_t mdsSessionTimeUs;
     // ReadChunkSnapshot同时进行的异步请求数量
     uint32_t readChunkSnapshotConcurrency;
+    // 转储时是否按chunk内容去重存储
+    bool snapshotChunkDedup = false;
+    // 转储时全局上传分片的线程数，为0时在读取chunk的线程内同步上传
+    uint32_t snapshotUploadThreadNum = 0;
+    // 每个chunk同时上传的分片数量
+    uint32_t uploadChunkPartConcurrency = 4;
+    // 单个快照同时转储的chunk数量，为0时不超过snapshotCoreThreadNum
+    uint32_t transferChunkConcurrency = 0;
+    // 转储时chunk数据的压缩类型，none或snappy
+    std::string snapshotCompressType = "none";
+    // 去重或压缩转储时每转储多少个chunk将已完成chunk的hash和压缩类型
+    // 写入索引块，重启后据此跳过已转储的chunk，为0时只在转储结束时写入
+    uint32_t snapshotCheckpointChunkNum = 0;
 
     // 用于Lazy克隆元数据部分的线程池线程数
     int stage1PoolThreadNum;
@@ -90,6 +103,8 @@ struct SnapshotCloneServerOptions {
     uint32_t createCloneChunkConcurrency;
     // RecoverChunk同时进行的异步请求数量
     uint32_t recoverChunkConcurrency;
+    // 所有任务RecoverChunk的总带宽上限(MB/s)，为0时不限制
+    uint64_t recoverChunkBpsLimitMB = 0;
     // 引用计数后台扫描每条记录间隔
     uint32_t backEndReferenceRecordScanIntervalMs;
     // 引用计数后台扫描每轮间隔
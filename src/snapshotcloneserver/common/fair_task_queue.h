@@ -0,0 +1,153 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_SNAPSHOTCLONESERVER_COMMON_FAIR_TASK_QUEUE_H_
+#define SRC_SNAPSHOTCLONESERVER_COMMON_FAIR_TASK_QUEUE_H_
+
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "src/common/snapshotclone/snapshotclone_define.h"
+
+namespace curve {
+namespace snapshotcloneserver {
+
+/**
+ * @brief 按用户公平调度的任务等待队列
+ *
+ * 执行中的任务数量达到上限后任务在队列中等待，有空闲时从执行中任务最少的用户
+ * 中选出最早提交的任务执行，一个用户提交大量任务不会让其他用户的任务一直等待。
+ * 非线程安全，由调用者加锁
+ */
+template <typename T>
+class FairTaskQueue {
+ public:
+    /**
+     * @param maxRunningNum 执行中的任务数量上限，0表示不限制
+     */
+    explicit FairTaskQueue(uint32_t maxRunningNum = 0)
+        : maxRunningNum_(maxRunningNum),
+          runningNum_(0) {}
+
+    void SetMaxRunningNum(uint32_t maxRunningNum) {
+        maxRunningNum_ = maxRunningNum;
+    }
+
+    void Push(const std::string &user, std::shared_ptr<T> task) {
+        waiting_.emplace_back(user, std::move(task));
+    }
+
+    /**
+     * @brief 选出下一个执行的任务，移出等待队列并计为执行中
+     *
+     * @param runnable 任务当前是否可以执行，为空表示都可以执行
+     *
+     * @return 选出的任务，执行中的任务数量达到上限或没有可以执行的任务时
+     *         返回nullptr
+     */
+    std::shared_ptr<T> Pop(
+        const std::function<bool(const T &)> &runnable = nullptr) {
+        if (maxRunningNum_ > 0 && runningNum_ >= maxRunningNum_) {
+            return nullptr;
+        }
+        auto picked = waiting_.end();
+        uint32_t pickedRunning = 0;
+        for (auto it = waiting_.begin(); it != waiting_.end(); ++it) {
+            uint32_t running = RunningNumOfUser(it->first);
+            if (picked != waiting_.end() && running >= pickedRunning) {
+                continue;
+            }
+            if (runnable && !runnable(*it->second)) {
+                continue;
+            }
+            picked = it;
+            pickedRunning = running;
+            if (0 == running) {
+                break;
+            }
+        }
+        if (picked == waiting_.end()) {
+            return nullptr;
+        }
+        std::shared_ptr<T> task = std::move(picked->second);
+        runningOfUser_[picked->first]++;
+        runningNum_++;
+        waiting_.erase(picked);
+        return task;
+    }
+
+    /**
+     * @brief 用户的一个执行中的任务结束
+     */
+    void Finish(const std::string &user) {
+        auto it = runningOfUser_.find(user);
+        if (it == runningOfUser_.end()) {
+            return;
+        }
+        if (--it->second == 0) {
+            runningOfUser_.erase(it);
+        }
+        runningNum_--;
+    }
+
+    std::shared_ptr<T> Get(const TaskIdType &taskId) const {
+        for (auto &item : waiting_) {
+            if (item.second->GetTaskId() == taskId) {
+                return item.second;
+            }
+        }
+        return nullptr;
+    }
+
+    void Remove(const TaskIdType &taskId) {
+        for (auto it = waiting_.begin(); it != waiting_.end(); ++it) {
+            if (it->second->GetTaskId() == taskId) {
+                waiting_.erase(it);
+                return;
+            }
+        }
+    }
+
+    size_t WaitingNum() const {
+        return waiting_.size();
+    }
+
+    uint32_t RunningNum() const {
+        return runningNum_;
+    }
+
+    uint32_t RunningNumOfUser(const std::string &user) const {
+        auto it = runningOfUser_.find(user);
+        return it == runningOfUser_.end() ? 0 : it->second;
+    }
+
+ private:
+    uint32_t maxRunningNum_;
+    uint32_t runningNum_;
+    // 等待的任务及其用户，按提交顺序排列
+    std::list<std::pair<std::string, std::shared_ptr<T>>> waiting_;
+    // 各用户执行中的任务数量
+    std::map<std::string, uint32_t> runningOfUser_;
+};
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
+
+#endif  // SRC_SNAPSHOTCLONESERVER_COMMON_FAIR_TASK_QUEUE_H_
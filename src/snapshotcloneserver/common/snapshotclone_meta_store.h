@@ -145,6 +145,26 @@ class SnapshotCloneMetaStore {
      * @return: 0 获取成功/ -1 获取失败
      */
     virtual int GetCloneInfoList(std::vector<CloneInfo> *list) = 0;
+
+    /**
+     * @brief 添加chunk对去重存储的数据对象的引用，重复添加同一引用不增加引用数
+     * @param hash 数据对象的内容hash
+     * @param ref 引用该数据对象的chunk名称
+     * @return: 0 添加成功/ -1 添加失败
+     */
+    virtual int AddChunkDataRef(const std::string &hash,
+                                const std::string &ref) = 0;
+
+    /**
+     * @brief 删除chunk对去重存储的数据对象的引用
+     * @param hash 数据对象的内容hash
+     * @param ref 引用该数据对象的chunk名称
+     * @param[out] refNum 删除后数据对象剩余的引用数，为0时数据对象可以删除
+     * @return: 0 删除成功/ -1 删除失败
+     */
+    virtual int RemoveChunkDataRef(const std::string &hash,
+                                   const std::string &ref,
+                                   uint32_t *refNum) = 0;
 };
 
 }  // namespace snapshotcloneserver
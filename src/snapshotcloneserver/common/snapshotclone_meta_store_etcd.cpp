@@ -59,7 +59,7 @@ int SnapshotCloneMetaStoreEtcd::AddSnapshot(const SnapshotInfo &info) {
         return -1;
     }
 
-    snapInfos_.emplace(info.GetUuid(), info);
+    PutSnapshotCache(info);
     return 0;
 }
 
@@ -73,10 +73,7 @@ int SnapshotCloneMetaStoreEtcd::DeleteSnapshot(const UUID &uuid) {
                    << ", uuid = " << uuid;
         return -1;
     }
-    auto search = snapInfos_.find(uuid);
-    if (search != snapInfos_.end()) {
-        snapInfos_.erase(search);
-    }
+    EraseSnapshotCache(uuid);
     return 0;
 }
 
@@ -97,12 +94,7 @@ int SnapshotCloneMetaStoreEtcd::UpdateSnapshot(const SnapshotInfo &info) {
                    << ", snapInfo : " << info;
         return -1;
     }
-    auto search = snapInfos_.find(info.GetUuid());
-    if (search != snapInfos_.end()) {
-        search->second = info;
-    } else {
-        snapInfos_.emplace(info.GetUuid(), info);
-    }
+    PutSnapshotCache(info);
     return 0;
 }
 
@@ -126,12 +118,7 @@ int SnapshotCloneMetaStoreEtcd::CASSnapshot(const UUID& uuid, CASFunc cas) {
         return -1;
     }
 
-    if (iter != snapInfos_.end()) {
-        iter->second = *info;
-    } else {
-        snapInfos_.emplace(uuid, *info);
-    }
-
+    PutSnapshotCache(*info);
     return 0;
 }
 
@@ -149,17 +136,14 @@ int SnapshotCloneMetaStoreEtcd::GetSnapshotInfo(
 int SnapshotCloneMetaStoreEtcd::GetSnapshotList(const std::string &filename,
     std::vector<SnapshotInfo> *v) {
     ReadLockGuard guard(snapInfos_mutex);
-    for (auto it = snapInfos_.begin();
-         it != snapInfos_.end();
-         it++) {
-        if (filename == it->second.GetFileName()) {
-            v->push_back(it->second);
-        }
+    auto search = snapshotsOfFile_.find(filename);
+    if (search == snapshotsOfFile_.end()) {
+        return -1;
     }
-    if (v->size() != 0) {
-        return 0;
+    for (const auto &uuid : search->second) {
+        v->push_back(snapInfos_.at(uuid));
     }
-    return -1;
+    return 0;
 }
 
 int SnapshotCloneMetaStoreEtcd::GetSnapshotList(
@@ -198,7 +182,7 @@ int SnapshotCloneMetaStoreEtcd::AddCloneInfo(const CloneInfo &info) {
                    << ", cloneInfo : " << info;
         return -1;
     }
-    cloneInfos_.emplace(info.GetTaskId(), info);
+    PutCloneInfoCache(info);
     return 0;
 }
 
@@ -212,10 +196,7 @@ int SnapshotCloneMetaStoreEtcd::DeleteCloneInfo(const std::string &uuid) {
                    << ", uuid = " << uuid;
         return -1;
     }
-    auto search = cloneInfos_.find(uuid);
-    if (search != cloneInfos_.end()) {
-        cloneInfos_.erase(search);
-    }
+    EraseCloneInfoCache(uuid);
     return 0;
 }
 
@@ -229,30 +210,23 @@ int SnapshotCloneMetaStoreEtcd::UpdateCloneInfo(const CloneInfo &info) {
         return -1;
     }
     WriteLockGuard guard(cloneInfos_lock_);
-    // if old record not exist, return failed
-    std::string oldValue;
-    int errCode = client_->Get(key, &oldValue);
-    if (errCode != EtcdErrCode::EtcdOK) {
-        LOG(ERROR) << "Get old cloneInfo from etcd err"
-                   << ", errcode = " << errCode
+    // if old record not exist, return failed.
+    // 缓存在Init时从etcd加载，之后的修改都经过本类，leader期间与etcd一致，
+    // 无需再从etcd中读取旧记录
+    if (cloneInfos_.find(info.GetTaskId()) == cloneInfos_.end()) {
+        LOG(ERROR) << "UpdateCloneInfo old record not exist"
                    << ", cloneInfo : " << info;
         return -1;
     }
 
-    errCode = client_->Put(key, value);
+    int errCode = client_->Put(key, value);
     if (errCode != EtcdErrCode::EtcdOK) {
         LOG(ERROR) << "Put cloneInfo into etcd err"
                    << ", errcode = " << errCode
                    << ", cloneInfo : " << info;
         return -1;
     }
-    auto search = cloneInfos_.find(info.GetTaskId());
-    if (search != cloneInfos_.end()) {
-        search->second = info;
-    } else {
-        LOG(ERROR) << "UpdateCloneInfo old record not exist";
-        return -1;
-    }
+    PutCloneInfoCache(info);
     return 0;
 }
 
@@ -270,15 +244,14 @@ int SnapshotCloneMetaStoreEtcd::GetCloneInfo(
 int SnapshotCloneMetaStoreEtcd::GetCloneInfoByFileName(
     const std::string &fileName, std::vector<CloneInfo> *list) {
     ReadLockGuard guard(cloneInfos_lock_);
-    for (auto it = cloneInfos_.begin(); it != cloneInfos_.end(); it++) {
-        if (it->second.GetDest() == fileName) {
-            list->push_back(it->second);
-        }
+    auto search = cloneInfosOfDest_.find(fileName);
+    if (search == cloneInfosOfDest_.end()) {
+        return -1;
     }
-    if (list->size() != 0) {
-        return 0;
+    for (const auto &taskId : search->second) {
+        list->push_back(cloneInfos_.at(taskId));
     }
-    return -1;
+    return 0;
 }
 
 int SnapshotCloneMetaStoreEtcd::GetCloneInfoList(std::vector<CloneInfo> *list) {
@@ -294,6 +267,46 @@ int SnapshotCloneMetaStoreEtcd::GetCloneInfoList(std::vector<CloneInfo> *list) {
     return -1;
 }
 
+int SnapshotCloneMetaStoreEtcd::AddChunkDataRef(const std::string &hash,
+    const std::string &ref) {
+    std::string key = codec_->EncodeChunkDataRefKey(hash, ref);
+    int errCode = client_->Put(key, ref);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "Put chunk data ref into etcd err"
+                   << ", errcode = " << errCode
+                   << ", hash = " << hash
+                   << ", ref = " << ref;
+        return -1;
+    }
+    return 0;
+}
+
+int SnapshotCloneMetaStoreEtcd::RemoveChunkDataRef(const std::string &hash,
+    const std::string &ref, uint32_t *refNum) {
+    std::string key = codec_->EncodeChunkDataRefKey(hash, ref);
+    int errCode = client_->Delete(key);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "delete chunk data ref from etcd err"
+                   << ", errcode = " << errCode
+                   << ", hash = " << hash
+                   << ", ref = " << ref;
+        return -1;
+    }
+
+    std::vector<std::string> refs;
+    errCode = client_->List(codec_->EncodeChunkDataRefKeyPrefix(hash),
+                            codec_->EncodeChunkDataRefKeyEnd(hash), &refs);
+    if (errCode != EtcdErrCode::EtcdOK &&
+        errCode != EtcdErrCode::EtcdKeyNotExist) {
+        LOG(ERROR) << "list chunk data ref from etcd err"
+                   << ", errcode = " << errCode
+                   << ", hash = " << hash;
+        return -1;
+    }
+    *refNum = refs.size();
+    return 0;
+}
+
 int SnapshotCloneMetaStoreEtcd::LoadSnapshotInfos() {
     std::string startKey = SnapshotCloneCodec::GetSnapshotInfoKeyPrefix();
     std::string endKey = SnapshotCloneCodec::GetSnapshotInfoKeyEnd();
@@ -311,7 +324,7 @@ int SnapshotCloneMetaStoreEtcd::LoadSnapshotInfos() {
             LOG(ERROR) << "DecodeSnapshotData err";
             return -1;
         }
-        snapInfos_.emplace(data.GetUuid(), data);
+        PutSnapshotCache(data);
     }
     LOG(INFO) << "LoadSnapshotInfos size = " << snapInfos_.size();
     return 0;
@@ -334,12 +347,71 @@ int SnapshotCloneMetaStoreEtcd::LoadCloneInfos() {
             LOG(ERROR) << "DecodeCloneInfoData err";
             return -1;
         }
-        cloneInfos_.emplace(data.GetTaskId(), data);
+        PutCloneInfoCache(data);
     }
     LOG(INFO) << "LoadCloneInfos size = " << cloneInfos_.size();
     return 0;
 }
 
+void SnapshotCloneMetaStoreEtcd::PutSnapshotCache(const SnapshotInfo &info) {
+    auto search = snapInfos_.find(info.GetUuid());
+    if (search != snapInfos_.end()) {
+        if (search->second.GetFileName() != info.GetFileName()) {
+            EraseSnapshotCache(info.GetUuid());
+        } else {
+            search->second = info;
+            return;
+        }
+    }
+    snapInfos_.emplace(info.GetUuid(), info);
+    snapshotsOfFile_[info.GetFileName()].insert(info.GetUuid());
+}
+
+void SnapshotCloneMetaStoreEtcd::EraseSnapshotCache(const UUID &uuid) {
+    auto search = snapInfos_.find(uuid);
+    if (search == snapInfos_.end()) {
+        return;
+    }
+    auto file = snapshotsOfFile_.find(search->second.GetFileName());
+    if (file != snapshotsOfFile_.end()) {
+        file->second.erase(uuid);
+        if (file->second.empty()) {
+            snapshotsOfFile_.erase(file);
+        }
+    }
+    snapInfos_.erase(search);
+}
+
+void SnapshotCloneMetaStoreEtcd::PutCloneInfoCache(const CloneInfo &info) {
+    auto search = cloneInfos_.find(info.GetTaskId());
+    if (search != cloneInfos_.end()) {
+        if (search->second.GetDest() != info.GetDest()) {
+            EraseCloneInfoCache(info.GetTaskId());
+        } else {
+            search->second = info;
+            return;
+        }
+    }
+    cloneInfos_.emplace(info.GetTaskId(), info);
+    cloneInfosOfDest_[info.GetDest()].insert(info.GetTaskId());
+}
+
+void SnapshotCloneMetaStoreEtcd::EraseCloneInfoCache(
+    const std::string &taskId) {
+    auto search = cloneInfos_.find(taskId);
+    if (search == cloneInfos_.end()) {
+        return;
+    }
+    auto dest = cloneInfosOfDest_.find(search->second.GetDest());
+    if (dest != cloneInfosOfDest_.end()) {
+        dest->second.erase(taskId);
+        if (dest->second.empty()) {
+            cloneInfosOfDest_.erase(dest);
+        }
+    }
+    cloneInfos_.erase(search);
+}
+
 }  // namespace snapshotcloneserver
 }  // namespace curve
 
@@ -26,6 +26,7 @@
 #include <vector>
 #include <memory>
 #include <map>
+#include <set>
 #include <string>
 
 #include "src/snapshotcloneserver/common/snapshotclone_meta_store.h"
@@ -81,6 +82,13 @@ class SnapshotCloneMetaStoreEtcd : public SnapshotCloneMetaStore {
 
     int GetCloneInfoList(std::vector<CloneInfo> *list) override;
 
+    int AddChunkDataRef(const std::string &hash,
+                        const std::string &ref) override;
+
+    int RemoveChunkDataRef(const std::string &hash,
+                           const std::string &ref,
+                           uint32_t *refNum) override;
+
  private:
     /**
      * @brief 加载快照信息
@@ -96,16 +104,34 @@ class SnapshotCloneMetaStoreEtcd : public SnapshotCloneMetaStore {
      */
     int LoadCloneInfos();
 
+    /**
+     * @brief 更新快照信息缓存及文件名索引，调用者需持有snapInfos_mutex写锁
+     */
+    void PutSnapshotCache(const SnapshotInfo &info);
+
+    void EraseSnapshotCache(const UUID &uuid);
+
+    /**
+     * @brief 更新克隆信息缓存及目标文件索引，调用者需持有cloneInfos_lock_写锁
+     */
+    void PutCloneInfoCache(const CloneInfo &info);
+
+    void EraseCloneInfoCache(const std::string &taskId);
+
  private:
     std::shared_ptr<KVStorageClient> client_;
     std::shared_ptr<SnapshotCloneCodec> codec_;
 
     // key is UUID, map 需要考虑并发保护
     std::map<UUID, SnapshotInfo> snapInfos_;
+    // 文件名到快照uuid的索引，与snapInfos_一起由snapInfos_mutex保护
+    std::map<std::string, std::set<UUID>> snapshotsOfFile_;
     // snap info lock
     RWLock snapInfos_mutex;
     // key is TaskIdType, map 需要考虑并发保护
     std::map<std::string, CloneInfo> cloneInfos_;
+    // 目标文件名到克隆任务id的索引，与cloneInfos_一起由cloneInfos_lock_保护
+    std::map<std::string, std::set<std::string>> cloneInfosOfDest_;
     // clone info map lock
     RWLock cloneInfos_lock_;
 };
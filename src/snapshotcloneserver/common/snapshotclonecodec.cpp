@@ -59,6 +59,28 @@ bool SnapshotCloneCodec::DecodeCloneInfoData(
     return data->ParseFromString(value);
 }
 
+std::string SnapshotCloneCodec::EncodeChunkDataRefKey(
+    const std::string &hash, const std::string &ref) {
+    return EncodeChunkDataRefKeyPrefix(hash) + ref;
+}
+
+std::string SnapshotCloneCodec::EncodeChunkDataRefKeyPrefix(
+    const std::string &hash) {
+    std::string key = CHUNKDATAREFKEYPREFIX;
+    key += hash;
+    key += "/";
+    return key;
+}
+
+std::string SnapshotCloneCodec::EncodeChunkDataRefKeyEnd(
+    const std::string &hash) {
+    // '0' is next to '/'
+    std::string key = CHUNKDATAREFKEYPREFIX;
+    key += hash;
+    key += "0";
+    return key;
+}
+
 }  // namespace snapshotcloneserver
 }  // namespace curve
 
@@ -32,6 +32,7 @@ using ::curve::common::SNAPINFOKEYPREFIX;
 using ::curve::common::SNAPINFOKEYEND;
 using ::curve::common::CLONEINFOKEYPREFIX;
 using ::curve::common::CLONEINFOKEYEND;
+using ::curve::common::CHUNKDATAREFKEYPREFIX;
 
 namespace curve {
 namespace snapshotcloneserver {
@@ -46,6 +47,14 @@ class SnapshotCloneCodec {
     bool EncodeCloneInfoData(const CloneInfo &data, std::string *value);
     bool DecodeCloneInfoData(const std::string &value, CloneInfo *data);
 
+    // key of a reference to the deduplicated chunk data is the prefix of
+    // the hash followed by the reference, so that the references of a chunk
+    // data are listed by the prefix
+    std::string EncodeChunkDataRefKey(const std::string &hash,
+                                      const std::string &ref);
+    std::string EncodeChunkDataRefKeyPrefix(const std::string &hash);
+    std::string EncodeChunkDataRefKeyEnd(const std::string &hash);
+
     static std::string GetSnapshotInfoKeyPrefix() {
         return std::string(SNAPINFOKEYPREFIX);
     }
@@ -44,6 +44,14 @@ int SnapshotCoreImpl::Init() {
         LOG(ERROR) << "SnapshotCoreImpl, thread start fail, ret = " << ret;
         return ret;
     }
+    if (uploadThreadPool_ != nullptr) {
+        ret = uploadThreadPool_->Start();
+        if (ret < 0) {
+            LOG(ERROR) << "SnapshotCoreImpl, upload thread start fail"
+                       << ", ret = " << ret;
+            return ret;
+        }
+    }
     return kErrCodeSuccess;
 }
 
@@ -285,8 +293,20 @@ void SnapshotCoreImpl::HandleCreateSnapshotTask(
     task->SetProgress(kProgressBuildSnapshotMapComplete);
     task->UpdateMetric();
 
+    // 与之前的快照共享的chunk沿用其数据对象的内容hash和压缩类型
+    for (auto &chunkIndex : indexData.GetAllChunkIndex()) {
+        ChunkDataName chunkDataName;
+        ChunkDataName sharedName;
+        indexData.GetChunkDataName(chunkIndex, &chunkDataName);
+        if (fileSnapshotMap.GetChunkDataName(chunkDataName, &sharedName)) {
+            indexData.SetChunkDataHash(chunkIndex, sharedName.hash_);
+            indexData.SetChunkDataCompressType(chunkIndex,
+                sharedName.compressType_);
+        }
+    }
+
     if (existIndexData) {
-        ret = TransferSnapshotData(indexData,
+        ret = TransferSnapshotData(&indexData,
             *info,
             segInfos,
             [this] (const ChunkDataName &chunkDataName) {
@@ -294,7 +314,7 @@ void SnapshotCoreImpl::HandleCreateSnapshotTask(
             },
             task);
     } else {
-        ret = TransferSnapshotData(indexData,
+        ret = TransferSnapshotData(&indexData,
             *info,
             segInfos,
             [&fileSnapshotMap] (const ChunkDataName &chunkDataName) {
@@ -302,6 +322,17 @@ void SnapshotCoreImpl::HandleCreateSnapshotTask(
             },
             task);
     }
+    if (snapshotChunkDedup_ || compressType_ != CompressType::NONE) {
+        // 记录chunk内容hash和压缩类型，删除快照时据此释放数据对象的引用，
+        // 克隆时据此读取压缩的数据对象
+        int ret2 = dataStore_->PutChunkIndexData(name, indexData);
+        if (ret2 < 0) {
+            LOG(ERROR) << "PutChunkIndexData error, "
+                       << " ret = " << ret2
+                       << ", uuid = " << task->GetUuid();
+            ret = (ret < 0) ? ret : ret2;
+        }
+    }
     if (ret < 0) {
         LOG(ERROR) << "TransferSnapshotData error, "
                    << " ret = " << ret
@@ -387,9 +418,8 @@ void SnapshotCoreImpl::CancelAfterTransferSnapshotData(
     for (auto &chunkIndex : chunkIndexVec) {
         ChunkDataName chunkDataName;
         indexData.GetChunkDataName(chunkIndex, &chunkDataName);
-        if ((!fileSnapshotMap.IsExistChunk(chunkDataName)) &&
-            (dataStore_->ChunkDataExist(chunkDataName))) {
-            int ret =  dataStore_->DeleteChunkData(chunkDataName);
+        if (!fileSnapshotMap.IsExistChunk(chunkDataName)) {
+            int ret = DeleteChunkData(chunkDataName);
             if (ret < 0) {
                 LOG(ERROR) << "DeleteChunkData error"
                            << "while canceling CreateSnapshot, "
@@ -775,7 +805,7 @@ int SnapshotCoreImpl::BuildSegmentInfo(
 }
 
 int SnapshotCoreImpl::TransferSnapshotData(
-    const ChunkIndexData indexData,
+    ChunkIndexData *indexData,
     const SnapshotInfo &info,
     const std::map<uint64_t, SegmentInfo> &segInfos,
     const ChunkDataExistFilter &filter,
@@ -791,7 +821,7 @@ int SnapshotCoreImpl::TransferSnapshotData(
         return kErrCodeChunkSizeNotAligned;
     }
 
-    std::vector<ChunkIndexType> chunkIndexVec = indexData.GetAllChunkIndex();
+    std::vector<ChunkIndexType> chunkIndexVec = indexData->GetAllChunkIndex();
 
     uint32_t totalProgress = kProgressTransferSnapshotDataComplete -
         kProgressTransferSnapshotDataStart;
@@ -827,10 +857,21 @@ int SnapshotCoreImpl::TransferSnapshotData(
         }
     }
 
+    uint32_t chunkConcurrency = snapshotCoreThreadNum_;
+    if (transferChunkConcurrency_ > 0 &&
+        transferChunkConcurrency_ < snapshotCoreThreadNum_) {
+        chunkConcurrency = transferChunkConcurrency_;
+    }
     auto tracker = std::make_shared<TaskTracker>();
+    std::vector<std::shared_ptr<TransferSnapshotDataChunkTaskInfo>> taskInfos;
+    // taskInfos中此前的chunk都已记录到索引块
+    size_t uncheckpointed = 0;
+    // 上一次记录索引块时taskInfos的数量
+    size_t lastCheckpointNum = 0;
+    ChunkIndexDataName indexName(info.GetFileName(), info.GetSeqNum());
     for (auto &chunkIndex : chunkIndexVec) {
         ChunkDataName chunkDataName;
-        indexData.GetChunkDataName(chunkIndex, &chunkDataName);
+        indexData->GetChunkDataName(chunkIndex, &chunkDataName);
         uint64_t segNum = chunkIndex / chunkPerSegment;
         uint64_t chunkIndexInSegment = chunkIndex % chunkPerSegment;
 
@@ -838,7 +879,8 @@ int SnapshotCoreImpl::TransferSnapshotData(
         if (it != segInfos.end()) {
             ChunkIDInfo cidInfo =
                 it->second.chunkvec[chunkIndexInSegment];
-            if (!filter(chunkDataName)) {
+            // 已有内容hash的chunk数据已去重存储
+            if (chunkDataName.hash_.empty() && !filter(chunkDataName)) {
                 auto taskInfo =
                     std::make_shared<TransferSnapshotDataChunkTaskInfo>(
                         chunkDataName, chunkSize, cidInfo, chunkSplitSize_,
@@ -851,6 +893,20 @@ int SnapshotCoreImpl::TransferSnapshotData(
                     taskInfo,
                     client_,
                     dataStore_);
+                if (uploadThreadPool_ != nullptr) {
+                    task->SetUploadThreadPool(uploadThreadPool_,
+                        uploadChunkPartConcurrency_);
+                }
+                if (snapshotChunkDedup_) {
+                    task->EnableDedup(metaStore_, &chunkDataLock_);
+                }
+                if (compressType_ != CompressType::NONE) {
+                    task->SetCompressType(compressType_);
+                }
+                if (snapshotChunkDedup_ ||
+                    compressType_ != CompressType::NONE) {
+                    taskInfos.push_back(taskInfo);
+                }
                 task->SetTracker(tracker);
                 tracker->AddOneTrace();
                 threadPool_->PushTask(task);
@@ -859,15 +915,18 @@ int SnapshotCoreImpl::TransferSnapshotData(
                            << chunkDataName.ToDataChunkKey();
             }
         }
-        if (tracker->GetTaskNum() >= snapshotCoreThreadNum_) {
+        if (tracker->GetTaskNum() >= chunkConcurrency) {
             tracker->WaitSome(1);
         }
         ret = tracker->GetResult();
         if (ret < 0) {
-            LOG(ERROR) << "TransferSnapshotDataChunk tracker GetResult fail"
-                       << ", ret = " << ret
-                       << ", uuid = " << task->GetUuid();
-            return ret;
+            break;
+        }
+        if (checkpointChunkNum_ > 0 &&
+            taskInfos.size() - lastCheckpointNum >= checkpointChunkNum_) {
+            CheckpointTransferredChunks(indexName, taskInfos,
+                &uncheckpointed, indexData);
+            lastCheckpointNum = taskInfos.size();
         }
 
         task->SetProgress(static_cast<uint32_t>(
@@ -875,12 +934,24 @@ int SnapshotCoreImpl::TransferSnapshotData(
         task->UpdateMetric();
         index++;
         if (task->IsCanceled()) {
-            return kErrCodeSuccess;
+            break;
         }
     }
-    // 最后剩余数量不足的任务
+    // 最后剩余数量不足的任务，以及失败或取消时已提交的任务
     tracker->Wait();
-    ret = tracker->GetResult();
+    if (ret >= 0) {
+        ret = tracker->GetResult();
+    }
+    // 已计算出hash的chunk即使转储失败也可能已记录引用，都需要记录到索引块
+    for (auto &taskInfo : taskInfos) {
+        indexData->SetChunkDataHash(taskInfo->name_.chunkIndex_,
+            taskInfo->name_.hash_);
+        indexData->SetChunkDataCompressType(taskInfo->name_.chunkIndex_,
+            taskInfo->name_.compressType_);
+    }
+    if (task->IsCanceled()) {
+        return kErrCodeSuccess;
+    }
     if (ret < 0) {
         LOG(ERROR) << "TransferSnapshotDataChunk tracker GetResult fail"
                    << ", ret = " << ret
@@ -891,6 +962,59 @@ int SnapshotCoreImpl::TransferSnapshotData(
     return kErrCodeSuccess;
 }
 
+void SnapshotCoreImpl::CheckpointTransferredChunks(
+    const ChunkIndexDataName &name,
+    const std::vector<std::shared_ptr<TransferSnapshotDataChunkTaskInfo>>
+        &taskInfos,
+    size_t *uncheckpointed,
+    ChunkIndexData *indexData) {
+    bool prefixDone = true;
+    for (size_t i = *uncheckpointed; i < taskInfos.size(); i++) {
+        auto &taskInfo = taskInfos[i];
+        if (!taskInfo->IsFinish()) {
+            prefixDone = false;
+            continue;
+        }
+        indexData->SetChunkDataHash(taskInfo->name_.chunkIndex_,
+            taskInfo->name_.hash_);
+        indexData->SetChunkDataCompressType(taskInfo->name_.chunkIndex_,
+            taskInfo->name_.compressType_);
+        if (prefixDone) {
+            *uncheckpointed = i + 1;
+        }
+    }
+    // 写入失败不影响本次转储，只是重启后需要重新转储更多的chunk
+    int ret = dataStore_->PutChunkIndexData(name, *indexData);
+    LOG_IF(WARNING, ret < 0) << "Checkpoint chunk index data fail"
+                             << ", ret = " << ret
+                             << ", fileName = " << name.fileName_
+                             << ", seqNum = " << name.fileSeqNum_;
+}
+
+int SnapshotCoreImpl::DeleteChunkData(const ChunkDataName &name) {
+    if (name.hash_.empty()) {
+        if (dataStore_->ChunkDataExist(name)) {
+            return dataStore_->DeleteChunkData(name);
+        }
+        return kErrCodeSuccess;
+    }
+
+    NameLockGuard lockGuard(chunkDataLock_, name.hash_);
+    uint32_t refNum = 0;
+    int ret = metaStore_->RemoveChunkDataRef(
+        name.hash_, name.ToChunkRefKey(), &refNum);
+    if (ret < 0) {
+        LOG(ERROR) << "RemoveChunkDataRef fail"
+                   << ", ret = " << ret
+                   << ", chunkDataName = " << name.ToDataChunkKey()
+                   << ", ref = " << name.ToChunkRefKey();
+        return kErrCodeInternalError;
+    }
+    if (0 == refNum && dataStore_->ChunkDataExist(name)) {
+        return dataStore_->DeleteChunkData(name);
+    }
+    return kErrCodeSuccess;
+}
 
 int SnapshotCoreImpl::DeleteSnapshotPre(
     UUID uuid,
@@ -1008,9 +1132,8 @@ void SnapshotCoreImpl::HandleDeleteSnapshotTask(
         for (auto &chunkIndex : chunkIndexVec) {
             ChunkDataName chunkDataName;
             indexData.GetChunkDataName(chunkIndex, &chunkDataName);
-            if ((!fileSnapshotMap.IsExistChunk(chunkDataName)) &&
-                (dataStore_->ChunkDataExist(chunkDataName))) {
-                ret =  dataStore_->DeleteChunkData(chunkDataName);
+            if (!fileSnapshotMap.IsExistChunk(chunkDataName)) {
+                ret = DeleteChunkData(chunkDataName);
                 if (ret < 0) {
                     LOG(ERROR) << "DeleteChunkData error, "
                                << " ret = " << ret
@@ -1144,6 +1267,68 @@ int SnapshotCoreImpl::GetSnapshotList(std::vector<SnapshotInfo> *list) {
     return kErrCodeSuccess;
 }
 
+int SnapshotCoreImpl::GetSnapshotDiff(const SnapshotInfo *base,
+    const SnapshotInfo &target,
+    std::vector<SnapshotDiffRange> *ranges) {
+    ChunkIndexData targetIndex;
+    ChunkIndexDataName targetName(target.GetFileName(), target.GetSeqNum());
+    int ret = dataStore_->GetChunkIndexData(targetName, &targetIndex);
+    if (ret < 0) {
+        LOG(ERROR) << "GetChunkIndexData error, "
+                   << " ret = " << ret
+                   << ", fileName = " << target.GetFileName()
+                   << ", seqNum = " << target.GetSeqNum();
+        return kErrCodeInternalError;
+    }
+    ChunkIndexData baseIndex;
+    if (base != nullptr) {
+        ChunkIndexDataName baseName(base->GetFileName(), base->GetSeqNum());
+        ret = dataStore_->GetChunkIndexData(baseName, &baseIndex);
+        if (ret < 0) {
+            LOG(ERROR) << "GetChunkIndexData error, "
+                       << " ret = " << ret
+                       << ", fileName = " << base->GetFileName()
+                       << ", seqNum = " << base->GetSeqNum();
+            return kErrCodeInternalError;
+        }
+    }
+
+    // target中新写的chunk，以及base中有而target中没有的chunk
+    std::vector<ChunkIndexType> changed;
+    for (ChunkIndexType index : targetIndex.GetAllChunkIndex()) {
+        ChunkDataName targetChunk;
+        ChunkDataName baseChunk;
+        targetIndex.GetChunkDataName(index, &targetChunk);
+        if (!baseIndex.GetChunkDataName(index, &baseChunk)) {
+            changed.push_back(index);
+        } else if (targetChunk.chunkSeqNum_ != baseChunk.chunkSeqNum_ &&
+                   (targetChunk.hash_.empty() ||
+                    targetChunk.hash_ != baseChunk.hash_)) {
+            changed.push_back(index);
+        }
+    }
+    for (ChunkIndexType index : baseIndex.GetAllChunkIndex()) {
+        ChunkDataName targetChunk;
+        if (!targetIndex.GetChunkDataName(index, &targetChunk)) {
+            changed.push_back(index);
+        }
+    }
+    std::sort(changed.begin(), changed.end());
+
+    uint64_t chunkSize = target.GetChunkSize();
+    ranges->clear();
+    for (ChunkIndexType index : changed) {
+        uint64_t offset = index * chunkSize;
+        if (!ranges->empty() &&
+            ranges->back().offset + ranges->back().length == offset) {
+            ranges->back().length += chunkSize;
+        } else {
+            ranges->push_back(SnapshotDiffRange{offset, chunkSize});
+        }
+    }
+    return kErrCodeSuccess;
+}
+
 int SnapshotCoreImpl::HandleCancelUnSchduledSnapshotTask(
     std::shared_ptr<SnapshotTaskInfo> task) {
     auto &snapInfo = task->GetSnapshotInfo();
@@ -43,6 +43,7 @@ namespace curve {
 namespace snapshotcloneserver {
 
 class SnapshotTaskInfo;
+struct TransferSnapshotDataChunkTaskInfo;
 
 /**
  * @brief 文件的快照索引块映射表
@@ -68,6 +69,34 @@ struct FileSnapMap {
         }
         return find;
     }
+
+    /**
+     * @brief 获取当前映射表中相同的chunk数据，包括其内容hash和压缩类型
+     *
+     * @param name chunk数据对象
+     * @param[out] found 映射表中记录的chunk数据对象
+     *
+     * @retval true 存在
+     * @retval false 不存在
+     */
+    bool GetChunkDataName(const ChunkDataName &name,
+        ChunkDataName *found) const {
+        for (auto &v : maps) {
+            if (v.IsExistChunkDataName(name) &&
+                v.GetChunkDataName(name.chunkIndex_, found)) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+/**
+ * @brief 两个快照之间数据有变化的文件区间，按chunk对齐
+ */
+struct SnapshotDiffRange {
+    uint64_t offset;
+    uint64_t length;
 };
 
 /**
@@ -166,6 +195,21 @@ class SnapshotCore {
      */
     virtual int HandleCancelScheduledSnapshotTask(
         std::shared_ptr<SnapshotTaskInfo> task) = 0;
+
+    /**
+     * @brief 比较同一文件的两个快照的索引，获取数据有变化的区间
+     * 快照索引中记录了每个chunk的数据版本，版本相同（或去重存储的内容hash
+     * 相同）的chunk在两个快照之间没有变化
+     *
+     * @param base 较早的快照，为nullptr时返回target中所有有数据的区间
+     * @param target 较新的快照
+     * @param[out] ranges 有变化的区间，按offset排序，相邻的chunk合并
+     *
+     * @return 错误码
+     */
+    virtual int GetSnapshotDiff(const SnapshotInfo *base,
+        const SnapshotInfo &target,
+        std::vector<SnapshotDiffRange> *ranges) = 0;
 };
 
 class SnapshotCoreImpl : public SnapshotCore {
@@ -195,15 +239,34 @@ class SnapshotCoreImpl : public SnapshotCore {
       clientAsyncMethodRetryTimeSec_(option.clientAsyncMethodRetryTimeSec),
       clientAsyncMethodRetryIntervalMs_(
                 option.clientAsyncMethodRetryIntervalMs),
-      readChunkSnapshotConcurrency_(option.readChunkSnapshotConcurrency) {
+      readChunkSnapshotConcurrency_(option.readChunkSnapshotConcurrency),
+      snapshotChunkDedup_(option.snapshotChunkDedup),
+      compressType_(CompressType::NONE),
+      uploadChunkPartConcurrency_(option.uploadChunkPartConcurrency),
+      transferChunkConcurrency_(option.transferChunkConcurrency),
+      checkpointChunkNum_(option.snapshotCheckpointChunkNum) {
         threadPool_ = std::make_shared<ThreadPool>(
             option.snapshotCoreThreadNum);
+        if (!::curve::common::StringToCompressType(
+                option.snapshotCompressType,
+                &compressType_)) {
+            LOG(ERROR) << "Unknown snapshotCompressType "
+                       << option.snapshotCompressType
+                       << ", snapshot data will not be compressed";
+        }
+        if (option.snapshotUploadThreadNum > 0) {
+            uploadThreadPool_ = std::make_shared<ThreadPool>(
+                option.snapshotUploadThreadNum);
+        }
     }
 
     int Init();
 
     ~SnapshotCoreImpl() {
         threadPool_->Stop();
+        if (uploadThreadPool_ != nullptr) {
+            uploadThreadPool_->Stop();
+        }
     }
 
     // 公有接口定义见SnapshotCore接口注释
@@ -237,6 +300,10 @@ class SnapshotCoreImpl : public SnapshotCore {
     int HandleCancelScheduledSnapshotTask(
         std::shared_ptr<SnapshotTaskInfo> task) override;
 
+    int GetSnapshotDiff(const SnapshotInfo *base,
+        const SnapshotInfo &target,
+        std::vector<SnapshotDiffRange> *ranges) override;
+
  private:
     /**
      * @brief 构建快照文件映射
@@ -308,7 +375,10 @@ class SnapshotCoreImpl : public SnapshotCore {
     /**
      * @brief 转储快照过程
      *
-     * @param indexData 索引块
+     * @param[in,out] indexData 索引块，去重转储时记录转储得到的chunk内容hash
+     *                          去重或压缩转储时，每转储checkpointChunkNum_个
+     *                          chunk将已完成chunk的hash和压缩类型写入索引块，
+     *                          重启后重新转储时跳过这些chunk
      * @param info 快照信息
      * @param segInfos Segment信息
      * @param filter 转储数据块过滤器
@@ -317,12 +387,36 @@ class SnapshotCoreImpl : public SnapshotCore {
      * @return  错误码
      */
     int TransferSnapshotData(
-        const ChunkIndexData indexData,
+        ChunkIndexData *indexData,
         const SnapshotInfo &info,
         const std::map<uint64_t, SegmentInfo> &segInfos,
         const ChunkDataExistFilter &filter,
         std::shared_ptr<SnapshotTaskInfo> task);
 
+    /**
+     * @brief 将已转储完成的chunk的hash和压缩类型记录到索引块并写入存储
+     *
+     * @param name 索引块名称
+     * @param taskInfos 已提交的chunk转储任务
+     * @param[in,out] uncheckpointed taskInfos中此前的任务都已记录
+     * @param[in,out] indexData 索引块
+     */
+    void CheckpointTransferredChunks(const ChunkIndexDataName &name,
+        const std::vector<std::shared_ptr<TransferSnapshotDataChunkTaskInfo>>
+            &taskInfos,
+        size_t *uncheckpointed,
+        ChunkIndexData *indexData);
+
+    /**
+     * @brief 删除快照不再引用的chunk数据，去重存储的chunk先释放引用，
+     *        没有引用时才删除数据对象
+     *
+     * @param name chunk数据对象
+     *
+     * @return 错误码
+     */
+    int DeleteChunkData(const ChunkDataName &name);
+
     /**
      * @brief 开始cancel，更新任务状态，更新数据库状态
      *
@@ -415,9 +509,13 @@ class SnapshotCoreImpl : public SnapshotCore {
 
     // 执行并发步骤的线程池
     std::shared_ptr<ThreadPool> threadPool_;
+    // 所有快照共享的上传分片线程池，为空时在转储chunk的线程内同步上传
+    std::shared_ptr<ThreadPool> uploadThreadPool_;
 
     // 锁住打快照的文件名，防止并发同时对其打快照，同一文件的快照需排队
     NameLock snapshotNameLock_;
+    // 锁住chunk内容hash，去重存储的数据对象的引用增减与上传、删除互斥
+    NameLock chunkDataLock_;
 
     // 转储chunk分片大小
     uint64_t chunkSplitSize_;
@@ -435,6 +533,16 @@ class SnapshotCoreImpl : public SnapshotCore {
     uint64_t clientAsyncMethodRetryIntervalMs_;
     // 异步ReadChunkSnapshot的并发数
     uint32_t readChunkSnapshotConcurrency_;
+    // 转储时是否按chunk内容去重存储
+    bool snapshotChunkDedup_;
+    // 转储时chunk数据的压缩类型
+    CompressType compressType_;
+    // 每个chunk同时上传的分片数量
+    uint32_t uploadChunkPartConcurrency_;
+    // 单个快照同时转储的chunk数量
+    uint32_t transferChunkConcurrency_;
+    // 每转储多少个chunk将已完成的chunk记录到索引块
+    uint32_t checkpointChunkNum_;
 };
 
 }  // namespace snapshotcloneserver
@@ -63,7 +63,14 @@ bool ChunkIndexData::Serialize(std::string *data) const {
         map.mutable_indexmap()->
             insert({m.first,
                 ChunkDataName(fileName_, m.second, m.first).
-                ToDataChunkKey()});
+                ToChunkRefKey()});
+    }
+    for (const auto &m : this->hashMap_) {
+        map.mutable_hashmap()->insert({m.first, m.second});
+    }
+    for (const auto &m : this->compressMap_) {
+        map.mutable_compressmap()->insert(
+            {m.first, static_cast<uint32_t>(m.second)});
     }
     // Todo：可以转化为stream给adpater接口使用SerializeToOstream
     return map.SerializeToString(data);
@@ -82,6 +89,13 @@ bool ChunkIndexData::Unserialize(const std::string &data) {
                 return false;
             }
         }
+        for (const auto &m : map.hashmap()) {
+            this->hashMap_.emplace(m.first, m.second);
+        }
+        for (const auto &m : map.compressmap()) {
+            this->compressMap_.emplace(m.first,
+                static_cast<CompressType>(m.second));
+        }
         return true;
     } else {
         return false;
@@ -93,6 +107,14 @@ bool ChunkIndexData::GetChunkDataName(ChunkIndexType index,
     auto it = chunkMap_.find(index);
     if (it != chunkMap_.end()) {
         *nameOut = ChunkDataName(fileName_, it->second, index);
+        auto hashIt = hashMap_.find(index);
+        if (hashIt != hashMap_.end()) {
+            nameOut->hash_ = hashIt->second;
+        }
+        auto compressIt = compressMap_.find(index);
+        if (compressIt != compressMap_.end()) {
+            nameOut->compressType_ = compressIt->second;
+        }
         return true;
     } else {
         return false;
@@ -33,9 +33,11 @@
 #include <memory>
 
 #include "src/common/concurrent/concurrent.h"
+#include "src/common/block_compressor.h"
 
 using ::curve::common::SpinLock;
 using ::curve::common::LockGuard;
+using ::curve::common::CompressType;
 
 namespace curve {
 namespace snapshotcloneserver {
@@ -44,6 +46,10 @@ using ChunkIndexType = uint32_t;
 using SnapshotSeqType = uint64_t;
 
 const char kChunkDataNameSeprator[] = "-";
+// 去重存储的数据对象名称前缀，对象名为前缀+chunk内容hash
+const char kDedupChunkDataPrefix[] = "dedup-";
+// 按块压缩存储的数据对象名称后缀，对象名为chunk名称+后缀
+const char kCompressedChunkDataSuffix[] = ".z";
 
 class ChunkDataName {
  public:
@@ -57,10 +63,27 @@ class ChunkDataName {
           chunkSeqNum_(seq),
           chunkIndex_(chunkIndex) {}
     /**
-     * 构建datachunk对象的名称 文件名-chunk索引-版本号
+     * 构建datachunk对象的名称 文件名-chunk索引-版本号，
+     * 去重存储的chunk为 前缀+内容hash，hash已区分是否压缩，
+     * 未去重的压缩chunk为 文件名-chunk索引-版本号+后缀
      * @return: 对象名称字符串
      */
     std::string ToDataChunkKey() const {
+        if (!hash_.empty()) {
+            return kDedupChunkDataPrefix + hash_;
+        }
+        if (compressType_ != CompressType::NONE) {
+            return ToChunkRefKey() + kCompressedChunkDataSuffix;
+        }
+        return ToChunkRefKey();
+    }
+
+    /**
+     * 构建chunk的名称 文件名-chunk索引-版本号，
+     * 去重存储时作为该chunk对数据对象的引用
+     * @return: chunk名称字符串
+     */
+    std::string ToChunkRefKey() const {
         return fileName_
             + kChunkDataNameSeprator
             + std::to_string(this->chunkIndex_)
@@ -71,6 +94,10 @@ class ChunkDataName {
     std::string fileName_;
     SnapshotSeqType chunkSeqNum_;
     ChunkIndexType chunkIndex_;
+    // chunk内容hash，为空表示未去重存储
+    std::string hash_;
+    // 数据对象的压缩类型，压缩的对象格式见BlockCompressor
+    CompressType compressType_ = CompressType::NONE;
 };
 
 inline bool operator==(const ChunkDataName &lhs, const ChunkDataName &rhs) {
@@ -134,6 +161,34 @@ class ChunkIndexData {
 
     void PutChunkDataName(const ChunkDataName &name) {
         chunkMap_.emplace(name.chunkIndex_, name.chunkSeqNum_);
+        if (!name.hash_.empty()) {
+            hashMap_.emplace(name.chunkIndex_, name.hash_);
+        }
+        if (name.compressType_ != CompressType::NONE) {
+            compressMap_.emplace(name.chunkIndex_, name.compressType_);
+        }
+    }
+
+    /**
+     * 设置chunk的内容hash，表示该chunk已去重存储
+     * @param index chunk索引
+     * @param hash chunk内容hash
+     */
+    void SetChunkDataHash(ChunkIndexType index, const std::string &hash) {
+        if (chunkMap_.count(index) > 0 && !hash.empty()) {
+            hashMap_[index] = hash;
+        }
+    }
+
+    /**
+     * 设置chunk数据对象的压缩类型
+     * @param index chunk索引
+     * @param type 压缩类型
+     */
+    void SetChunkDataCompressType(ChunkIndexType index, CompressType type) {
+        if (chunkMap_.count(index) > 0 && type != CompressType::NONE) {
+            compressMap_[index] = type;
+        }
     }
 
     bool GetChunkDataName(ChunkIndexType index, ChunkDataName* nameOut) const;
@@ -155,6 +210,10 @@ class ChunkIndexData {
     std::string fileName_;
     // 快照文件索引信息map
     std::map<ChunkIndexType, SnapshotSeqType> chunkMap_;
+    // 去重存储的chunk的内容hash
+    std::map<ChunkIndexType, std::string> hashMap_;
+    // 压缩存储的chunk的压缩类型
+    std::map<ChunkIndexType, CompressType> compressMap_;
 };
 
 
@@ -200,6 +200,62 @@ int SnapshotServiceManager::GetFileSnapshotInfoById(const std::string &file,
     return GetFileSnapshotInfoInner(snapInfos, user, info);
 }
 
+int SnapshotServiceManager::GetSnapshotDiff(const std::string &file,
+    const std::string &user,
+    const UUID &baseUuid,
+    const UUID &uuid,
+    SnapshotInfo *snapInfo,
+    std::vector<SnapshotDiffRange> *ranges) {
+    int ret = GetDoneSnapshotInfo(file, user, uuid, snapInfo);
+    if (ret < 0) {
+        return ret;
+    }
+    if (baseUuid.empty()) {
+        return core_->GetSnapshotDiff(nullptr, *snapInfo, ranges);
+    }
+
+    SnapshotInfo baseInfo;
+    ret = GetDoneSnapshotInfo(snapInfo->GetFileName(), user, baseUuid,
+        &baseInfo);
+    if (ret < 0) {
+        return ret;
+    }
+    if (baseInfo.GetSeqNum() >= snapInfo->GetSeqNum() ||
+        baseInfo.GetChunkSize() != snapInfo->GetChunkSize()) {
+        LOG(ERROR) << "GetSnapshotDiff base snapshot is not older, "
+                   << "baseUuid = " << baseUuid
+                   << ", baseSeqNum = " << baseInfo.GetSeqNum()
+                   << ", uuid = " << uuid
+                   << ", seqNum = " << snapInfo->GetSeqNum();
+        return kErrCodeInvalidRequest;
+    }
+    return core_->GetSnapshotDiff(&baseInfo, *snapInfo, ranges);
+}
+
+int SnapshotServiceManager::GetDoneSnapshotInfo(const std::string &file,
+    const std::string &user,
+    const UUID &uuid,
+    SnapshotInfo *snapInfo) {
+    int ret = core_->GetSnapshotInfo(uuid, snapInfo);
+    if (ret < 0) {
+        LOG(ERROR) << "GetSnapshotInfo error, "
+                   << " ret = " << ret
+                   << ", file = " << file
+                   << ", uuid = " << uuid;
+        return kErrCodeFileNotExist;
+    }
+    if (snapInfo->GetUser() != user) {
+        return kErrCodeInvalidUser;
+    }
+    if ((!file.empty()) && (snapInfo->GetFileName() != file)) {
+        return kErrCodeFileNameNotMatch;
+    }
+    if (snapInfo->GetStatus() != Status::done) {
+        return kErrCodeInvalidSnapshot;
+    }
+    return kErrCodeSuccess;
+}
+
 int SnapshotServiceManager::GetFileSnapshotInfoInner(
     std::vector<SnapshotInfo> snapInfos,
     const std::string &user,
@@ -358,7 +414,19 @@ int SnapshotServiceManager::GetSnapshotListByFilter(
                     const SnapshotFilterCondition &filter,
                     std::vector<FileSnapshotInfo> *info) {
     std::vector<SnapshotInfo> snapInfos;
-    int ret = core_->GetSnapshotList(&snapInfos);
+    int ret = kErrCodeSuccess;
+    // 指定了uuid或文件名时只取出对应的快照，避免复制全部快照信息，
+    // 与列出全部快照时一样，没有快照时返回空列表
+    if (filter.GetUuid() != nullptr) {
+        SnapshotInfo snapInfo;
+        if (core_->GetSnapshotInfo(*filter.GetUuid(), &snapInfo) >= 0) {
+            snapInfos.push_back(snapInfo);
+        }
+    } else if (filter.GetFile() != nullptr) {
+        ret = core_->GetFileSnapshotInfo(*filter.GetFile(), &snapInfos);
+    } else {
+        ret = core_->GetSnapshotList(&snapInfos);
+    }
     if (ret < 0) {
         LOG(ERROR) << "GetFileSnapshotInfo error, "
                    << " ret = " << ret;
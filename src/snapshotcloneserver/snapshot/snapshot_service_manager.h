@@ -140,6 +140,13 @@ class SnapshotFilterCondition {
         status_ = status;
     }
 
+    const std::string *GetUuid() const {
+        return uuid_;
+    }
+
+    const std::string *GetFile() const {
+        return file_;
+    }
 
  private:
     const std::string *uuid_;
@@ -264,6 +271,25 @@ class SnapshotServiceManager {
     virtual int GetSnapshotListByFilter(const SnapshotFilterCondition &filter,
                     std::vector<FileSnapshotInfo> *info);
 
+    /**
+     * @brief 获取同一文件的两个快照之间数据有变化的区间，用于增量备份
+     *
+     * @param file 文件名，为空时不检查
+     * @param user 用户名
+     * @param baseUuid 较早的快照Id，为空时返回uuid快照中所有有数据的区间
+     * @param uuid 较新的快照Id
+     * @param[out] snapInfo uuid快照的信息
+     * @param[out] ranges 有变化的区间
+     *
+     * @return 错误码
+     */
+    virtual int GetSnapshotDiff(const std::string &file,
+        const std::string &user,
+        const UUID &baseUuid,
+        const UUID &uuid,
+        SnapshotInfo *snapInfo,
+        std::vector<SnapshotDiffRange> *ranges);
+
     /**
      * @brief 恢复快照任务接口
      *
@@ -300,6 +326,21 @@ class SnapshotServiceManager {
         SnapshotFilterCondition filter,
         std::vector<FileSnapshotInfo> *info);
 
+    /**
+     * @brief 获取已完成的快照的信息，并检查用户和文件名
+     *
+     * @param file 文件名，为空时不检查
+     * @param user 用户名
+     * @param uuid 快照Id
+     * @param[out] snapInfo 快照信息
+     *
+     * @return 错误码
+     */
+    int GetDoneSnapshotInfo(const std::string &file,
+        const std::string &user,
+        const UUID &uuid,
+        SnapshotInfo *snapInfo);
+
  private:
     // 快照任务管理类对象
     std::shared_ptr<SnapshotTaskManager> taskMgr_;
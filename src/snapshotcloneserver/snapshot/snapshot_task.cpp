@@ -20,6 +20,11 @@
  * Author: xuchaojie
  */
 
+#include <butil/sha1.h>
+#include <butil/strings/string_number_conversions.h>
+
+#include <algorithm>
+#include <cstring>
 #include <list>
 
 #include "src/common/timeutility.h"
@@ -28,6 +33,10 @@
 namespace curve {
 namespace snapshotcloneserver {
 
+using ::curve::common::NameLockGuard;
+using ::curve::common::BlockCompressor;
+using ::curve::common::CompressTypeToString;
+
 void ReadChunkSnapshotClosure::Run() {
     std::unique_ptr<ReadChunkSnapshotClosure> self_guard(this);
     context_->retCode = GetRetCode();
@@ -60,10 +69,11 @@ void ReadChunkSnapshotClosure::Run() {
  * @return 错误码
  */
 int TransferSnapshotDataChunkTask::TransferSnapshotDataChunk() {
+    if (metaStore_ != nullptr || compressType_ != CompressType::NONE) {
+        return TransferWholeSnapshotDataChunk();
+    }
     ChunkDataName name = taskInfo_->name_;
-    uint64_t chunkSize = taskInfo_->chunkSize_;
     ChunkIDInfo cidInfo = taskInfo_->cidInfo_;
-    uint64_t chunkSplitSize = taskInfo_->chunkSplitSize_;
 
     std::shared_ptr<TransferTask> transferTask =
         std::make_shared<TransferTask>();
@@ -79,6 +89,175 @@ int TransferSnapshotDataChunkTask::TransferSnapshotDataChunk() {
         return ret;
     }
 
+    ret = ReadChunkSnapshotParts(transferTask);
+    if (ret >= 0) {
+        ret =
+            dataStore_->DataChunkTranferComplete(name, transferTask);
+        if (ret < 0) {
+            LOG(ERROR) << "DataChunkTranferComplete fail"
+                       << ", ret = " << ret
+                       << ", chunkDataName = " << name.ToDataChunkKey()
+                       << ", logicalPool = " << cidInfo.lpid_
+                       << ", copysetId = " << cidInfo.cpid_
+                       << ", chunkId = " << cidInfo.cid_;
+        }
+    }
+    if (ret < 0) {
+            int ret2 =
+                dataStore_->DataChunkTranferAbort(
+                name,
+                transferTask);
+            if (ret2 < 0) {
+                LOG(ERROR) << "DataChunkTranferAbort fail"
+                           << ", ret = " << ret2
+                           << ", chunkDataName = " << name.ToDataChunkKey()
+                           << ", logicalPool = " << cidInfo.lpid_
+                           << ", copysetId = " << cidInfo.cpid_
+                           << ", chunkId = " << cidInfo.cid_;
+            }
+        return ret;
+    }
+    return kErrCodeSuccess;
+}
+
+/**
+ * @brief 读取整个chunk后转储快照的单个chunk，用于去重或压缩存储
+ * @detail
+ *  1. 读取整个chunk，开启压缩时按块压缩，压缩后不小于原数据时不压缩
+ *  2. 开启去重时计算内容的hash，数据对象以hash命名，hash区分是否压缩，
+ *  在hash锁内先记录本chunk对数据对象的引用，再检查对象是否存在，
+ *  不存在时才上传，先记录引用保证上传过程中失败也不会残留无引用对象，
+ *  且对象不会被并发的删除流程删掉
+ *  3. 分片上传数据对象
+ *  4. taskInfo_->name_记录数据对象的压缩类型和内容hash
+ *
+ * @return 错误码
+ */
+int TransferSnapshotDataChunkTask::TransferWholeSnapshotDataChunk() {
+    ChunkDataName name = taskInfo_->name_;
+    uint64_t chunkSize = taskInfo_->chunkSize_;
+
+    chunkData_ = std::unique_ptr<char[]>(new char[chunkSize]);
+    int ret = ReadChunkSnapshotParts(nullptr);
+    if (ret < 0) {
+        return ret;
+    }
+
+    const char *data = chunkData_.get();
+    uint64_t len = chunkSize;
+    std::string compressed;
+    if (compressType_ != CompressType::NONE &&
+        BlockCompressor::Compress(compressType_, chunkData_.get(),
+            chunkSize, &compressed) &&
+        compressed.size() < chunkSize) {
+        name.compressType_ = compressType_;
+        data = compressed.data();
+        len = compressed.size();
+    }
+    taskInfo_->name_.compressType_ = name.compressType_;
+
+    if (nullptr == metaStore_) {
+        return UploadChunkData(name, data, len);
+    }
+
+    unsigned char digest[butil::kSHA1Length];
+    butil::SHA1HashBytes(
+        reinterpret_cast<const unsigned char *>(chunkData_.get()),
+        chunkSize, digest);
+    name.hash_ = butil::HexEncode(digest, sizeof(digest)) +
+                 "-" + std::to_string(chunkSize);
+    if (name.compressType_ != CompressType::NONE) {
+        name.hash_ = name.hash_ + "-" +
+                     CompressTypeToString(name.compressType_);
+    }
+    // 记录引用前即设置hash，转储失败时也能据此释放可能已记录的引用
+    taskInfo_->name_.hash_ = name.hash_;
+
+    NameLockGuard lockGuard(*dedupLock_, name.hash_);
+    ret = metaStore_->AddChunkDataRef(name.hash_, name.ToChunkRefKey());
+    if (ret < 0) {
+        LOG(ERROR) << "AddChunkDataRef fail"
+                   << ", ret = " << ret
+                   << ", chunkDataName = " << name.ToDataChunkKey()
+                   << ", ref = " << name.ToChunkRefKey();
+        return kErrCodeInternalError;
+    }
+    if (dataStore_->ChunkDataExist(name)) {
+        DLOG(INFO) << "chunk data already exist, skip upload"
+                   << ", chunkDataName = " << name.ToDataChunkKey()
+                   << ", ref = " << name.ToChunkRefKey();
+        return kErrCodeSuccess;
+    }
+    return UploadChunkData(name, data, len);
+}
+
+int TransferSnapshotDataChunkTask::UploadChunkData(const ChunkDataName &name,
+    const char *data, uint64_t len) {
+    ChunkIDInfo cidInfo = taskInfo_->cidInfo_;
+    uint64_t chunkSplitSize = taskInfo_->chunkSplitSize_;
+
+    std::shared_ptr<TransferTask> transferTask =
+        std::make_shared<TransferTask>();
+    int ret = dataStore_->DataChunkTranferInit(name, transferTask);
+    if (ret < 0) {
+        LOG(ERROR) << "DataChunkTranferInit error, "
+                   << " ret = " << ret
+                   << ", chunkDataName = " << name.ToDataChunkKey()
+                   << ", logicalPool = " << cidInfo.lpid_
+                   << ", copysetId = " << cidInfo.cpid_
+                   << ", chunkId = " << cidInfo.cid_;
+        return ret;
+    }
+    // 压缩后的数据长度不再对齐，最后一个分片可能较短
+    for (uint64_t off = 0, i = 0; off < len; off += chunkSplitSize, i++) {
+        ret = dataStore_->DataChunkTranferAddPart(name,
+            transferTask,
+            i,
+            std::min(chunkSplitSize, len - off),
+            data + off);
+        if (ret < 0) {
+            LOG(ERROR) << "DataChunkTranferAddPart fail"
+                       << ", ret = " << ret
+                       << ", chunkDataName = " << name.ToDataChunkKey()
+                       << ", index = " << i;
+            break;
+        }
+    }
+    if (ret >= 0) {
+        ret = dataStore_->DataChunkTranferComplete(name, transferTask);
+        if (ret < 0) {
+            LOG(ERROR) << "DataChunkTranferComplete fail"
+                       << ", ret = " << ret
+                       << ", chunkDataName = " << name.ToDataChunkKey()
+                       << ", logicalPool = " << cidInfo.lpid_
+                       << ", copysetId = " << cidInfo.cpid_
+                       << ", chunkId = " << cidInfo.cid_;
+        }
+    }
+    if (ret < 0) {
+        int ret2 = dataStore_->DataChunkTranferAbort(name, transferTask);
+        if (ret2 < 0) {
+            LOG(ERROR) << "DataChunkTranferAbort fail"
+                       << ", ret = " << ret2
+                       << ", chunkDataName = " << name.ToDataChunkKey()
+                       << ", logicalPool = " << cidInfo.lpid_
+                       << ", copysetId = " << cidInfo.cpid_
+                       << ", chunkId = " << cidInfo.cid_;
+        }
+        return ret;
+    }
+    return kErrCodeSuccess;
+}
+
+int TransferSnapshotDataChunkTask::ReadChunkSnapshotParts(
+    std::shared_ptr<TransferTask> transferTask) {
+    uint64_t chunkSize = taskInfo_->chunkSize_;
+    uint64_t chunkSplitSize = taskInfo_->chunkSplitSize_;
+
+    int ret = kErrCodeSuccess;
+    if (transferTask != nullptr && uploadThreadPool_ != nullptr) {
+        uploadTracker_ = std::make_shared<TaskTracker>();
+    }
     auto tracker = std::make_shared<ReadChunkSnapshotTaskTracker>();
     for (uint64_t i = 0;
         i < chunkSize / chunkSplitSize;
@@ -122,35 +301,16 @@ int TransferSnapshotDataChunkTask::TransferSnapshotDataChunk() {
                 break;
             }
         } while (true);
+    }
+    if (uploadTracker_ != nullptr) {
+        // 失败时也需等待上传结束，之后才能放弃转储
+        uploadTracker_->Wait();
         if (ret >= 0) {
-            ret =
-                dataStore_->DataChunkTranferComplete(name, transferTask);
-            if (ret < 0) {
-                LOG(ERROR) << "DataChunkTranferComplete fail"
-                           << ", ret = " << ret
-                           << ", chunkDataName = " << name.ToDataChunkKey()
-                           << ", logicalPool = " << cidInfo.lpid_
-                           << ", copysetId = " << cidInfo.cpid_
-                           << ", chunkId = " << cidInfo.cid_;
-            }
+            ret = uploadTracker_->GetResult();
         }
+        uploadTracker_ = nullptr;
     }
-    if (ret < 0) {
-            int ret2 =
-                dataStore_->DataChunkTranferAbort(
-                name,
-                transferTask);
-            if (ret2 < 0) {
-                LOG(ERROR) << "DataChunkTranferAbort fail"
-                           << ", ret = " << ret2
-                           << ", chunkDataName = " << name.ToDataChunkKey()
-                           << ", logicalPool = " << cidInfo.lpid_
-                           << ", copysetId = " << cidInfo.cpid_
-                           << ", chunkId = " << cidInfo.cid_;
-            }
-        return ret;
-    }
-    return kErrCodeSuccess;
+    return ret;
 }
 
 int TransferSnapshotDataChunkTask::StartAsyncReadChunkSnapshot(
@@ -210,6 +370,14 @@ int TransferSnapshotDataChunkTask::HandleReadChunkSnapshotResultsAndRetry(
                            << ", ret = " << ret;
                 return ret;
             }
+        } else if (nullptr == transferTask) {
+            memcpy(chunkData_.get() + context->partIndex * context->len,
+                context->buf.get(), context->len);
+        } else if (uploadTracker_ != nullptr) {
+            ret = StartAsyncUploadChunkPart(transferTask, context);
+            if (ret < 0) {
+                return ret;
+            }
         } else {
             ret = dataStore_->DataChunkTranferAddPart(
                 taskInfo_->name_,
@@ -230,5 +398,38 @@ int TransferSnapshotDataChunkTask::HandleReadChunkSnapshotResultsAndRetry(
     return ret;
 }
 
+int TransferSnapshotDataChunkTask::StartAsyncUploadChunkPart(
+    std::shared_ptr<TransferTask> transferTask,
+    ReadChunkSnapshotContextPtr context) {
+    auto task = new UploadChunkPartTask(GetTaskId(),
+        taskInfo_->name_,
+        transferTask,
+        context,
+        dataStore_);
+    task->SetTracker(uploadTracker_);
+    uploadTracker_->AddOneTrace();
+    uploadThreadPool_->PushTask(task);
+    if (uploadTracker_->GetTaskNum() >= uploadPartConcurrency_) {
+        uploadTracker_->WaitSome(1);
+    }
+    return uploadTracker_->GetResult();
+}
+
+void UploadChunkPartTask::Run() {
+    std::unique_ptr<UploadChunkPartTask> self_guard(this);
+    int ret = dataStore_->DataChunkTranferAddPart(name_,
+        transferTask_,
+        context_->partIndex,
+        context_->len,
+        context_->buf.get());
+    if (ret < 0) {
+        LOG(ERROR) << "DataChunkTranferAddPart fail"
+                   << ", ret = " << ret
+                   << ", chunkDataName = " << name_.ToDataChunkKey()
+                   << ", index = " << context_->partIndex;
+    }
+    GetTracker()->HandleResponse(ret);
+}
+
 }  // namespace snapshotcloneserver
 }  // namespace curve
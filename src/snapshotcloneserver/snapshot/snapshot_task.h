@@ -33,6 +33,7 @@
 #include "src/snapshotcloneserver/common/task_info.h"
 #include "src/snapshotcloneserver/common/snapshotclone_metric.h"
 #include "src/snapshotcloneserver/common/task_tracker.h"
+#include "src/snapshotcloneserver/common/thread_pool.h"
 
 namespace curve {
 namespace snapshotcloneserver {
@@ -232,6 +233,32 @@ struct TransferSnapshotDataChunkTaskInfo : public TaskInfo {
           readChunkSnapshotConcurrency_(readChunkSnapshotConcurrency) {}
 };
 
+/**
+ * @brief 上传chunk的一个分片的任务，在所有快照共享的上传线程池中执行
+ */
+class UploadChunkPartTask : public TrackerTask {
+ public:
+    UploadChunkPartTask(const TaskIdType &taskId,
+        const ChunkDataName &name,
+        std::shared_ptr<TransferTask> transferTask,
+        ReadChunkSnapshotContextPtr context,
+        std::shared_ptr<SnapshotDataStore> dataStore)
+        : TrackerTask(taskId),
+          name_(name),
+          transferTask_(transferTask),
+          context_(context),
+          dataStore_(dataStore) {}
+
+    void Run() override;
+
+ private:
+    ChunkDataName name_;
+    std::shared_ptr<TransferTask> transferTask_;
+    // 持有分片的buffer直到上传完成
+    ReadChunkSnapshotContextPtr context_;
+    std::shared_ptr<SnapshotDataStore> dataStore_;
+};
+
 class TransferSnapshotDataChunkTask : public TrackerTask {
  public:
     TransferSnapshotDataChunkTask(const TaskIdType &taskId,
@@ -247,9 +274,49 @@ class TransferSnapshotDataChunkTask : public TrackerTask {
         return taskInfo_;
     }
 
+    /**
+     * @brief 开启按chunk内容去重转储，读取完chunk后taskInfo的name_.hash_
+     *        为chunk内容的hash
+     *
+     * @param metaStore 记录chunk数据对象引用的元数据存储
+     * @param lock 按hash加锁，保证引用的增减与对象的上传、删除互斥
+     */
+    void EnableDedup(std::shared_ptr<SnapshotCloneMetaStore> metaStore,
+        NameLock *lock) {
+        metaStore_ = metaStore;
+        dedupLock_ = lock;
+    }
+
+    /**
+     * @brief 开启按块压缩转储，转储完成后taskInfo的name_.compressType_
+     *        为数据对象的压缩类型
+     *
+     * @param type 压缩类型
+     */
+    void SetCompressType(CompressType type) {
+        compressType_ = type;
+    }
+
+    /**
+     * @brief 设置上传分片的线程池，读取到的分片交给线程池上传，
+     *        读取与上传流水线进行
+     *
+     * @param pool 所有快照共享的上传线程池
+     * @param concurrency 本chunk同时上传的分片数量
+     */
+    void SetUploadThreadPool(std::shared_ptr<ThreadPool> pool,
+        uint32_t concurrency) {
+        uploadThreadPool_ = pool;
+        uploadPartConcurrency_ = concurrency;
+    }
+
     void Run() override {
         std::unique_ptr<TransferSnapshotDataChunkTask> self_guard(this);
         int ret = TransferSnapshotDataChunk();
+        if (ret >= 0) {
+            // 转储完成后taskInfo的name_不再变化，可以记录到索引块
+            taskInfo_->Finish();
+        }
         GetTracker()->HandleResponse(ret);
     }
 
@@ -261,6 +328,34 @@ class TransferSnapshotDataChunkTask : public TrackerTask {
      */
     int TransferSnapshotDataChunk();
 
+    /**
+     * @brief 读取整个chunk后去重或压缩转储快照单个chunk
+     *
+     * @return 错误码
+     */
+    int TransferWholeSnapshotDataChunk();
+
+    /**
+     * @brief 分片上传整个数据对象
+     *
+     * @param name 数据对象
+     * @param data 数据
+     * @param len 数据长度
+     *
+     * @return 错误码
+     */
+    int UploadChunkData(const ChunkDataName &name,
+        const char *data, uint64_t len);
+
+    /**
+     * @brief 读取chunk的所有分片
+     *
+     * @param transferTask 转储任务，为空时分片拷贝到chunkData_中
+     *
+     * @return 错误码
+     */
+    int ReadChunkSnapshotParts(std::shared_ptr<TransferTask> transferTask);
+
     /**
      * @brief 开始异步ReadSnapshotChunk
      *
@@ -277,7 +372,7 @@ class TransferSnapshotDataChunkTask : public TrackerTask {
      * @brief 处理ReadChunkSnapshot的结果并重试
      *
      * @param tracker 异步ReadSnapshotChunk追踪器
-     * @param transferTask 转储任务
+     * @param transferTask 转储任务，为空时分片拷贝到chunkData_中
      * @param results ReadChunkSnapshot结果列表
      *
      * @return 错误码
@@ -287,10 +382,35 @@ class TransferSnapshotDataChunkTask : public TrackerTask {
         std::shared_ptr<TransferTask> transferTask,
         const std::list<ReadChunkSnapshotContextPtr> &results);
 
+    /**
+     * @brief 将读取到的分片交给上传线程池上传，同时上传的分片数量达到
+     *        上限时等待
+     *
+     * @param transferTask 转储任务
+     * @param context 读取到的分片
+     *
+     * @return 错误码，已完成的上传有失败时返回失败
+     */
+    int StartAsyncUploadChunkPart(
+        std::shared_ptr<TransferTask> transferTask,
+        ReadChunkSnapshotContextPtr context);
+
  protected:
     std::shared_ptr<TransferSnapshotDataChunkTaskInfo> taskInfo_;
     std::shared_ptr<CurveFsClient> client_;
     std::shared_ptr<SnapshotDataStore> dataStore_;
+    // 去重转储时使用，为空表示不去重
+    std::shared_ptr<SnapshotCloneMetaStore> metaStore_;
+    NameLock *dedupLock_ = nullptr;
+    // 压缩类型，NONE表示不压缩
+    CompressType compressType_ = CompressType::NONE;
+    // 去重或压缩转储时读取的整个chunk的数据
+    std::unique_ptr<char[]> chunkData_;
+    // 上传分片的线程池，为空时同步上传
+    std::shared_ptr<ThreadPool> uploadThreadPool_;
+    uint32_t uploadPartConcurrency_ = 1;
+    // 本chunk正在上传的分片
+    std::shared_ptr<TaskTracker> uploadTracker_;
 };
 
 
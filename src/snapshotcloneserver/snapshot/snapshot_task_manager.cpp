@@ -21,6 +21,9 @@
  */
 
 #include "src/snapshotcloneserver/snapshot/snapshot_task_manager.h"
+
+#include <vector>
+
 #include "src/common/snapshotclone/snapshotclone_define.h"
 #include "src/common/concurrent/concurrent.h"
 
@@ -69,7 +72,8 @@ int SnapshotTaskManager::PushTask(std::shared_ptr<SnapshotTask> task) {
             LOG(ERROR) << "SnapshotTaskManager::PushTask, uuid duplicated.";
             return kErrCodeInternalError;
         }
-        waitingTasks_.push_back(task);
+        waitingTasks_.Push(task->GetTaskInfo()->GetSnapshotInfo().GetUser(),
+            task);
     }
     snapshotMetric_->snapshotWaiting << 1;
 
@@ -93,19 +97,16 @@ int SnapshotTaskManager::CancelTask(const TaskIdType &taskId) {
         // 还在等待队列的Cancel直接移除
         WriteLockGuard taskMapWlock(taskMapLock_);
         LockGuard waitingTasksLock(waitingTasksLock_);
-        for (auto it = waitingTasks_.begin();
-            it != waitingTasks_.end();
-            it++) {
-            if ((*it)->GetTaskId() == taskId) {
-                int ret = core_->HandleCancelUnSchduledSnapshotTask(
-                    (*it)->GetTaskInfo());
-                if (kErrCodeSuccess == ret) {
-                    waitingTasks_.erase(it);
-                    taskMap_.erase(taskId);
-                    return kErrCodeSuccess;
-                } else {
-                    return kErrCodeInternalError;
-                }
+        auto task = waitingTasks_.Get(taskId);
+        if (task != nullptr) {
+            int ret = core_->HandleCancelUnSchduledSnapshotTask(
+                task->GetTaskInfo());
+            if (kErrCodeSuccess == ret) {
+                waitingTasks_.Remove(taskId);
+                taskMap_.erase(taskId);
+                return kErrCodeSuccess;
+            } else {
+                return kErrCodeInternalError;
             }
         }
     }
@@ -131,42 +132,51 @@ void SnapshotTaskManager::BackEndThreadFunc() {
 void SnapshotTaskManager::ScanWaitingTask() {
     LockGuard waitingTasksLock(waitingTasksLock_);
     LockGuard workingTasksLock(workingTasksLock_);
-    for (auto it = waitingTasks_.begin();
-        it != waitingTasks_.end();) {
-        if (workingTasks_.find((*it)->GetTaskInfo()->GetFileName())
-            == workingTasks_.end()) {
-            workingTasks_.emplace((*it)->GetTaskInfo()->GetFileName(),
-                *it);
-            threadpool_->PushTask(*it);
-            snapshotMetric_->snapshotDoing << 1;
-            snapshotMetric_->snapshotWaiting << -1;
-            it = waitingTasks_.erase(it);
-        } else {
-            it++;
-        }
+    // 同一个文件同时只执行一个快照任务
+    auto runnable = [this](const SnapshotTask &task) {
+        return workingTasks_.find(task.GetTaskInfo()->GetFileName())
+            == workingTasks_.end();
+    };
+    std::shared_ptr<SnapshotTask> task;
+    while ((task = waitingTasks_.Pop(runnable)) != nullptr) {
+        workingTasks_.emplace(task->GetTaskInfo()->GetFileName(), task);
+        threadpool_->PushTask(task);
+        snapshotMetric_->snapshotDoing << 1;
+        snapshotMetric_->snapshotWaiting << -1;
     }
 }
 
 void SnapshotTaskManager::ScanWorkingTask() {
-    WriteLockGuard taskMapWlock(taskMapLock_);
-    LockGuard workingTasksLock(workingTasksLock_);
-    for (auto it = workingTasks_.begin();
-            it != workingTasks_.end();) {
-        auto taskInfo = it->second->GetTaskInfo();
-        if (taskInfo->IsFinish()) {
-            snapshotMetric_->snapshotDoing << -1;
-            if (taskInfo->GetSnapshotInfo().GetStatus()
-                != Status::done) {
-                snapshotMetric_->snapshotFailed << 1;
+    std::vector<std::string> finishedUsers;
+    {
+        WriteLockGuard taskMapWlock(taskMapLock_);
+        LockGuard workingTasksLock(workingTasksLock_);
+        for (auto it = workingTasks_.begin();
+                it != workingTasks_.end();) {
+            auto taskInfo = it->second->GetTaskInfo();
+            if (taskInfo->IsFinish()) {
+                snapshotMetric_->snapshotDoing << -1;
+                if (taskInfo->GetSnapshotInfo().GetStatus()
+                    != Status::done) {
+                    snapshotMetric_->snapshotFailed << 1;
+                } else {
+                    snapshotMetric_->snapshotSucceed << 1;
+                }
+                finishedUsers.push_back(
+                    taskInfo->GetSnapshotInfo().GetUser());
+                taskMap_.erase(it->second->GetTaskId());
+                it = workingTasks_.erase(it);
             } else {
-                snapshotMetric_->snapshotSucceed << 1;
+                it++;
             }
-            taskMap_.erase(it->second->GetTaskId());
-            it = workingTasks_.erase(it);
-        } else {
-            it++;
         }
     }
+
+    // 等待队列的锁在工作队列的锁之前获取，这里在释放工作队列的锁之后更新
+    LockGuard waitingTasksLock(waitingTasksLock_);
+    for (auto &user : finishedUsers) {
+        waitingTasks_.Finish(user);
+    }
 }
 
 }  // namespace snapshotcloneserver
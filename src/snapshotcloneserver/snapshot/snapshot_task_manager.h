@@ -32,6 +32,7 @@
 
 #include "src/snapshotcloneserver/snapshot/snapshot_task.h"
 #include "src/snapshotcloneserver/common/thread_pool.h"
+#include "src/snapshotcloneserver/common/fair_task_queue.h"
 #include "src/common/concurrent/rw_lock.h"
 #include "src/common/snapshotclone/snapshotclone_define.h"
 #include "src/snapshotcloneserver/common/config.h"
@@ -73,6 +74,9 @@ class SnapshotTaskManager {
         const SnapshotCloneServerOptions &option) {
         snapshotTaskManagerScanIntervalMs_ =
             option.snapshotTaskManagerScanIntervalMs;
+        // 同时执行的任务不超过线程数，其余的在等待队列中按用户公平调度
+        waitingTasks_.SetMaxRunningNum(option.snapshotPoolThreadNum > 0 ?
+            option.snapshotPoolThreadNum : 0);
         threadpool_ = pool;
         return kErrCodeSuccess;
     }
@@ -128,7 +132,8 @@ class SnapshotTaskManager {
      * @brief 扫描等待任务队列函数
      *
      * 扫描等待队列，判断工作队列中当前文件
-     * 是否有正在执行的快照，若没有则放入工作队列
+     * 是否有正在执行的快照，若没有则放入工作队列，
+     * 执行中的任务达到线程数时，优先执行执行中任务最少的用户的任务
      *
      */
     void ScanWaitingTask();
@@ -150,7 +155,7 @@ class SnapshotTaskManager {
     mutable RWLock taskMapLock_;
 
     // 快照等待队列
-    std::list<std::shared_ptr<SnapshotTask> > waitingTasks_;
+    FairTaskQueue<SnapshotTask> waitingTasks_;
     mutable Mutex waitingTasksLock_;
 
     // 快照工作队列,实际是个map，其中key是文件名，以便于查询
@@ -81,6 +81,30 @@ void InitSnapshotCloneServerOptions(std::shared_ptr<Configuration> conf,
                                         &serverOption->mdsSessionTimeUs);
     conf->GetValueFatalIfFail("server.readChunkSnapshotConcurrency",
             &serverOption->readChunkSnapshotConcurrency);
+    LOG_IF(WARNING, !conf->GetBoolValue("server.snapshotChunkDedup",
+                                        &serverOption->snapshotChunkDedup))
+        << "config no server.snapshotChunkDedup info, using default value "
+        << serverOption->snapshotChunkDedup;
+    LOG_IF(WARNING, !conf->GetUInt32Value("server.snapshotUploadThreadNum",
+                                        &serverOption->snapshotUploadThreadNum))
+        << "config no server.snapshotUploadThreadNum info, "
+        << "using default value " << serverOption->snapshotUploadThreadNum;
+    LOG_IF(WARNING, !conf->GetUInt32Value("server.uploadChunkPartConcurrency",
+                                &serverOption->uploadChunkPartConcurrency))
+        << "config no server.uploadChunkPartConcurrency info, "
+        << "using default value " << serverOption->uploadChunkPartConcurrency;
+    LOG_IF(WARNING, !conf->GetUInt32Value("server.transferChunkConcurrency",
+                                &serverOption->transferChunkConcurrency))
+        << "config no server.transferChunkConcurrency info, "
+        << "using default value " << serverOption->transferChunkConcurrency;
+    LOG_IF(WARNING, !conf->GetStringValue("server.snapshotCompressType",
+                                &serverOption->snapshotCompressType))
+        << "config no server.snapshotCompressType info, "
+        << "using default value " << serverOption->snapshotCompressType;
+    LOG_IF(WARNING, !conf->GetUInt32Value("server.snapshotCheckpointChunkNum",
+                                &serverOption->snapshotCheckpointChunkNum))
+        << "config no server.snapshotCheckpointChunkNum info, "
+        << "using default value " << serverOption->snapshotCheckpointChunkNum;
 
     conf->GetValueFatalIfFail("server.stage1PoolThreadNum",
                                      &serverOption->stage1PoolThreadNum);
@@ -102,6 +126,10 @@ void InitSnapshotCloneServerOptions(std::shared_ptr<Configuration> conf,
                             &serverOption->createCloneChunkConcurrency);
     conf->GetValueFatalIfFail("server.recoverChunkConcurrency",
                             &serverOption->recoverChunkConcurrency);
+    LOG_IF(WARNING, !conf->GetUInt64Value("server.recoverChunkBpsLimitMB",
+                                &serverOption->recoverChunkBpsLimitMB))
+        << "config no server.recoverChunkBpsLimitMB info, "
+        << "using default value " << serverOption->recoverChunkBpsLimitMB;
     conf->GetValueFatalIfFail("server.backEndReferenceRecordScanIntervalMs",
                         &serverOption->backEndReferenceRecordScanIntervalMs);
     conf->GetValueFatalIfFail("server.backEndReferenceFuncScanIntervalMs",
@@ -86,6 +86,8 @@ void SnapshotCloneServiceImpl::default_method(RpcController* cntl,
         HandleGetCloneTaskListAction(bcntl, requestId);
     } else if (*action == kGetCloneRefStatusAction) {
         HandleGetCloneRefStatusAction(bcntl, requestId);
+    } else if (*action == kGetSnapshotDiffAction) {
+        HandleGetSnapshotDiffAction(bcntl, requestId);
     } else {
         HandleBadRequestError(bcntl, requestId);
     }
@@ -942,6 +944,100 @@ void SnapshotCloneServiceImpl::HandleGetCloneRefStatusAction(
     return;
 }
 
+void SnapshotCloneServiceImpl::HandleGetSnapshotDiffAction(
+    brpc::Controller* bcntl, const std::string &requestId) {
+    const std::string *version =
+        bcntl->http_request().uri().GetQuery(kVersionStr);
+    const std::string *user =
+        bcntl->http_request().uri().GetQuery(kUserStr);
+    const std::string *file =
+        bcntl->http_request().uri().GetQuery(kFileStr);
+    const std::string *uuid =
+        bcntl->http_request().uri().GetQuery(kUUIDStr);
+    const std::string *baseUuid =
+        bcntl->http_request().uri().GetQuery(kBaseUUIDStr);
+    const std::string *limit =
+        bcntl->http_request().uri().GetQuery(kLimitStr);
+    const std::string *offset =
+        bcntl->http_request().uri().GetQuery(kOffsetStr);
+    if ((version == nullptr) ||
+        (user == nullptr) ||
+        (uuid == nullptr) ||
+        (version->empty()) ||
+        (user->empty()) ||
+        (uuid->empty())) {
+        HandleBadRequestError(bcntl, requestId);
+        return;
+    }
+    // 变化的区间可能很多，默认一次返回1000个
+    uint64_t limitNum = 1000;
+    if ((limit != nullptr) && !limit->empty()) {
+        if (!curve::common::StringToUll(*limit, &limitNum)) {
+            HandleBadRequestError(bcntl, requestId);
+            return;
+        }
+    }
+    uint64_t offsetNum = 0;
+    if ((offset != nullptr) && !offset->empty()) {
+        if (!curve::common::StringToUll(*offset, &offsetNum)) {
+            HandleBadRequestError(bcntl, requestId);
+            return;
+        }
+    }
+    std::string fileName = "";
+    if (file != nullptr) {
+        fileName = *file;
+    }
+    std::string baseUuidStr = "";
+    if (baseUuid != nullptr) {
+        baseUuidStr = *baseUuid;
+    }
+
+    LOG(INFO) << "GetSnapshotDiff:"
+              << " Version = " << *version
+              << ", User = " << *user
+              << ", File = " << fileName
+              << ", BaseUUID = " << baseUuidStr
+              << ", UUID = " << *uuid
+              << ", Limit = " << limitNum
+              << ", Offset = " << offsetNum
+              << ", requestId = " << requestId;
+
+    SnapshotInfo snapInfo;
+    std::vector<SnapshotDiffRange> ranges;
+    int ret = snapshotManager_->GetSnapshotDiff(fileName, *user,
+        baseUuidStr, *uuid, &snapInfo, &ranges);
+    if (ret < 0) {
+        bcntl->http_response().set_status_code(
+            brpc::HTTP_STATUS_INTERNAL_SERVER_ERROR);
+        SetErrorMessage(bcntl, ret, requestId, *uuid);
+        return;
+    }
+
+    bcntl->http_response().set_status_code(brpc::HTTP_STATUS_OK);
+    butil::IOBufBuilder os;
+    Json::Value mainObj;
+    mainObj[kCodeStr] = std::to_string(kErrCodeSuccess);
+    mainObj[kMessageStr] = code2Msg[kErrCodeSuccess];
+    mainObj[kRequestIdStr] = requestId;
+    mainObj[kChunkSizeStr] = snapInfo.GetChunkSize();
+    mainObj[kFileLengthStr] = snapInfo.GetFileLength();
+    mainObj[kTotalCountStr] = ranges.size();
+    Json::Value listObj(Json::arrayValue);
+    for (std::vector<SnapshotDiffRange>::size_type i = offsetNum;
+        i < ranges.size() && i < limitNum + offsetNum;
+        i++) {
+        Json::Value rangeObj;
+        rangeObj[kOffsetStr] = ranges[i].offset;
+        rangeObj[kLengthStr] = ranges[i].length;
+        listObj.append(rangeObj);
+    }
+    mainObj[kChangedRangesStr] = listObj;
+    os << mainObj.toStyledString();
+    os.move_to(bcntl->response_attachment());
+    return;
+}
+
 void SnapshotCloneServiceImpl::SetErrorMessage(brpc::Controller* bcntl,
                         int errCode,
                         const std::string &requestId,
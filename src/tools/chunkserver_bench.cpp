@@ -0,0 +1,425 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/tools/chunkserver_bench.h"
+
+#include <braft/configuration.h>
+#include <bthread/bthread.h>
+#include <butil/time.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#include "proto/copyset.pb.h"
+#include "src/tools/metric_name.h"
+
+namespace curve {
+namespace tool {
+
+using curve::chunkserver::CHUNK_OP_READ;
+using curve::chunkserver::CHUNK_OP_STATUS;
+using curve::chunkserver::CHUNK_OP_WRITE;
+using curve::chunkserver::ChunkRequest;
+using curve::chunkserver::ChunkResponse;
+using curve::chunkserver::ChunkService_Stub;
+using curve::chunkserver::COPYSET_OP_STATUS;
+using curve::chunkserver::CopysetRequest;
+using curve::chunkserver::CopysetResponse;
+using curve::chunkserver::CopysetService_Stub;
+
+namespace {
+
+// 没有leader时重试的间隔
+const uint32_t kNoLeaderRetryIntervalUs = 100 * 1000;
+const char* const kStages[] = {"queue", "commit", "apply_queue", "store"};
+
+}  // namespace
+
+void BenchOpStat::Merge(const BenchOpStat& other) {
+    ops += other.ops;
+    errors += other.errors;
+    bytes += other.bytes;
+    latUs.insert(latUs.end(), other.latUs.begin(), other.latUs.end());
+}
+
+struct ChunkServerBench::Worker {
+    ChunkServerBench* bench;
+    uint32_t index;
+    bthread_t tid;
+    std::mt19937_64 rng;
+    // 顺序读写时的下一个offset
+    uint64_t offset;
+    BenchOpStat readStat;
+    BenchOpStat writeStat;
+};
+
+ChunkServerBench::ChunkServerBench(const ChunkServerBenchOption& option)
+    : option_(option),
+      leaders_(new std::atomic<int>[option.copysetNum]),
+      stop_(false),
+      readOps_(0),
+      writeOps_(0),
+      errors_(0),
+      nextSendNs_(0),
+      lastReadOps_(0),
+      lastWriteOps_(0),
+      intervalNs_(option.iops == 0 ? 0 : 1000000000LL / option.iops) {
+    for (uint32_t i = 0; i < option_.copysetNum; i++) {
+        leaders_[i].store(0);
+    }
+}
+
+int ChunkServerBench::Init() {
+    if (option_.peers.empty() || option_.copysetNum == 0 ||
+        option_.chunksPerCopyset == 0 || option_.iodepth == 0 ||
+        option_.ioSize == 0 || option_.chunkSize % option_.ioSize != 0 ||
+        option_.readPercent > 100) {
+        std::cout << "Invalid bench option" << std::endl;
+        return -1;
+    }
+
+    brpc::ChannelOptions opt;
+    opt.timeout_ms = option_.rpcTimeoutMs;
+    opt.max_retry = 0;
+    for (const auto& peer : option_.peers) {
+        std::unique_ptr<brpc::Channel> channel(new brpc::Channel());
+        if (channel->Init(peer.c_str(), &opt) != 0) {
+            std::cout << "Init channel to chunkserver: " << peer
+                      << " failed!" << std::endl;
+            return -1;
+        }
+        channels_.push_back(std::move(channel));
+    }
+
+    if (option_.createCopyset && CreateCopysets() != 0) {
+        return -1;
+    }
+    return PrepareChunks();
+}
+
+int ChunkServerBench::CreateCopysets() {
+    for (size_t i = 0; i < channels_.size(); i++) {
+        CopysetService_Stub stub(channels_[i].get());
+        for (uint32_t j = 0; j < option_.copysetNum; j++) {
+            CopysetRequest request;
+            CopysetResponse response;
+            request.set_logicpoolid(option_.logicPoolId);
+            request.set_copysetid(option_.copysetIdStart + j);
+            for (const auto& peer : option_.peers) {
+                request.add_peerid(peer + ":0");
+            }
+            brpc::Controller cntl;
+            stub.CreateCopysetNode(&cntl, &request, &response, nullptr);
+            if (cntl.Failed()) {
+                std::cout << "Create copyset on " << option_.peers[i]
+                          << " failed, error: " << cntl.ErrorText()
+                          << std::endl;
+                return -1;
+            }
+            if (response.status() !=
+                    COPYSET_OP_STATUS::COPYSET_OP_STATUS_SUCCESS &&
+                response.status() !=
+                    COPYSET_OP_STATUS::COPYSET_OP_STATUS_EXIST) {
+                std::cout << "Create copyset on " << option_.peers[i]
+                          << " failed, request: " << request.ShortDebugString()
+                          << ", status: " << response.status() << std::endl;
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int ChunkServerBench::PrepareChunks() {
+    // 刚创建的copyset要等待选举, 按重试间隔折算成重试次数
+    const uint32_t retryTimes = std::max<uint32_t>(
+        option_.rpcRetryTimes,
+        option_.leaderWaitMs * 1000 / kNoLeaderRetryIntervalUs);
+    std::string buf(option_.ioSize, 'a');
+    butil::IOBuf data;
+    data.append(buf);
+    for (uint32_t i = 0; i < option_.copysetNum; i++) {
+        for (uint32_t j = 0; j < option_.chunksPerCopyset; j++) {
+            ChunkRequest request;
+            request.set_optype(CHUNK_OP_WRITE);
+            request.set_logicpoolid(option_.logicPoolId);
+            request.set_copysetid(option_.copysetIdStart + i);
+            request.set_chunkid(j + 1);
+            request.set_sn(1);
+            request.set_offset(0);
+            request.set_size(option_.ioSize);
+            if (SendRequest(i, request, data, retryTimes) != 0) {
+                std::cout << "Prepare chunk failed, request: "
+                          << request.ShortDebugString() << std::endl;
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int ChunkServerBench::FindPeer(const std::string& addr) const {
+    for (size_t i = 0; i < option_.peers.size(); i++) {
+        if (option_.peers[i] == addr) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int ChunkServerBench::SendRequest(uint32_t index, const ChunkRequest& request,
+                                  const butil::IOBuf& data,
+                                  uint32_t retryTimes) {
+    for (uint32_t retry = 0; retry < retryTimes; retry++) {
+        int leader = leaders_[index].load(std::memory_order_relaxed);
+        brpc::Controller cntl;
+        ChunkResponse response;
+        if (request.optype() == CHUNK_OP_WRITE) {
+            cntl.request_attachment().append(data);
+        }
+        ChunkService_Stub stub(channels_[leader].get());
+        if (request.optype() == CHUNK_OP_WRITE) {
+            stub.WriteChunk(&cntl, &request, &response, nullptr);
+        } else {
+            stub.ReadChunk(&cntl, &request, &response, nullptr);
+        }
+
+        int next = -1;
+        if (cntl.Failed()) {
+            next = (leader + 1) % channels_.size();
+        } else if (response.status() ==
+                   CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS) {
+            return 0;
+        } else if (response.status() ==
+                   CHUNK_OP_STATUS::CHUNK_OP_STATUS_REDIRECTED) {
+            braft::PeerId peer;
+            if (response.has_redirect() &&
+                peer.parse(response.redirect()) == 0) {
+                next = FindPeer(butil::endpoint2str(peer.addr));
+            }
+            if (next < 0) {
+                // 还没有leader或者leader不在peers中
+                bthread_usleep(kNoLeaderRetryIntervalUs);
+                next = (leader + 1) % channels_.size();
+            }
+        } else {
+            return -1;
+        }
+        leaders_[index].compare_exchange_strong(leader, next);
+    }
+    return -1;
+}
+
+void ChunkServerBench::Pace() {
+    if (intervalNs_ == 0) {
+        return;
+    }
+    int64_t nowNs = butil::monotonic_time_ns();
+    int64_t sendNs = nextSendNs_.fetch_add(intervalNs_);
+    if (sendNs < nowNs - 1000000000LL) {
+        // 落后太多时不补发, 避免请求突发
+        nextSendNs_.store(nowNs + intervalNs_);
+        return;
+    }
+    if (sendNs > nowNs) {
+        bthread_usleep((sendNs - nowNs) / 1000);
+    }
+}
+
+void* ChunkServerBench::RunWorker(void* arg) {
+    Worker* worker = static_cast<Worker*>(arg);
+    worker->bench->DoWork(worker);
+    return nullptr;
+}
+
+void ChunkServerBench::DoWork(Worker* worker) {
+    const uint64_t blocks = option_.chunkSize / option_.ioSize;
+    std::string buf(option_.ioSize, 'b');
+    butil::IOBuf data;
+    data.append(buf);
+
+    // 顺序读写时每个并发固定在一个chunk上
+    uint32_t seqCopyset = worker->index % option_.copysetNum;
+    uint64_t seqChunk =
+        worker->index / option_.copysetNum % option_.chunksPerCopyset + 1;
+
+    ChunkRequest request;
+    request.set_logicpoolid(option_.logicPoolId);
+    request.set_sn(1);
+    request.set_size(option_.ioSize);
+    while (!stop_.load(std::memory_order_relaxed)) {
+        Pace();
+
+        uint32_t index = seqCopyset;
+        uint64_t chunkId = seqChunk;
+        uint64_t block = worker->offset;
+        if (option_.randomOffset) {
+            index = worker->rng() % option_.copysetNum;
+            chunkId = worker->rng() % option_.chunksPerCopyset + 1;
+            block = worker->rng() % blocks;
+        } else {
+            worker->offset = (worker->offset + 1) % blocks;
+        }
+        bool isRead = worker->rng() % 100 < option_.readPercent;
+        request.set_optype(isRead ? CHUNK_OP_READ : CHUNK_OP_WRITE);
+        request.set_copysetid(option_.copysetIdStart + index);
+        request.set_chunkid(chunkId);
+        request.set_offset(block * option_.ioSize);
+
+        int64_t startUs = butil::monotonic_time_us();
+        int ret = SendRequest(index, request, data, option_.rpcRetryTimes);
+        int64_t latUs = butil::monotonic_time_us() - startUs;
+
+        BenchOpStat* stat = isRead ? &worker->readStat : &worker->writeStat;
+        if (ret != 0) {
+            stat->errors++;
+            errors_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        stat->ops++;
+        stat->bytes += option_.ioSize;
+        stat->latUs.push_back(latUs);
+        (isRead ? readOps_ : writeOps_).fetch_add(1,
+                                                  std::memory_order_relaxed);
+    }
+}
+
+int ChunkServerBench::Run() {
+    std::vector<std::unique_ptr<Worker>> workers;
+    nextSendNs_.store(butil::monotonic_time_ns());
+    for (uint32_t i = 0; i < option_.iodepth; i++) {
+        std::unique_ptr<Worker> worker(new Worker());
+        worker->bench = this;
+        worker->index = i;
+        worker->rng.seed(i + 1);
+        worker->offset = 0;
+        if (bthread_start_background(&worker->tid, nullptr, RunWorker,
+                                     worker.get()) != 0) {
+            std::cout << "Start bench worker failed" << std::endl;
+            stop_.store(true);
+            break;
+        }
+        workers.push_back(std::move(worker));
+    }
+
+    const int64_t startUs = butil::monotonic_time_us();
+    const int64_t endUs = startUs + option_.runtimeSec * 1000000LL;
+    const int64_t intervalUs = option_.reportIntervalSec == 0
+                                   ? endUs - startUs
+                                   : option_.reportIntervalSec * 1000000LL;
+    int64_t lastUs = startUs;
+    while (!stop_.load() && lastUs < endUs) {
+        int64_t nextUs = std::min(lastUs + intervalUs, endUs);
+        int64_t nowUs = butil::monotonic_time_us();
+        if (nextUs > nowUs) {
+            bthread_usleep(nextUs - nowUs);
+        }
+        if (option_.reportIntervalSec != 0) {
+            Report(butil::monotonic_time_us() - lastUs);
+        }
+        lastUs = nextUs;
+    }
+    stop_.store(true);
+
+    for (auto& worker : workers) {
+        bthread_join(worker->tid, nullptr);
+        readStat_.Merge(worker->readStat);
+        writeStat_.Merge(worker->writeStat);
+    }
+
+    const double seconds = (butil::monotonic_time_us() - startUs) / 1e6;
+    std::cout << "runtime: " << std::fixed << std::setprecision(1)
+              << seconds << "s, iodepth: " << option_.iodepth
+              << ", io size: " << option_.ioSize
+              << ", copysets: " << option_.copysetNum << std::endl;
+    PrintLatency("read", &readStat_);
+    PrintLatency("write", &writeStat_);
+    PrintStageLatency();
+    return readStat_.errors + writeStat_.errors == 0 ? 0 : -1;
+}
+
+void ChunkServerBench::Report(uint64_t intervalUs) {
+    const uint64_t read = readOps_.load();
+    const uint64_t write = writeOps_.load();
+    const double seconds = std::max<uint64_t>(intervalUs, 1) / 1e6;
+    std::cout << "read iops: " << static_cast<uint64_t>(
+                     (read - lastReadOps_) / seconds)
+              << ", write iops: " << static_cast<uint64_t>(
+                     (write - lastWriteOps_) / seconds)
+              << ", errors: " << errors_.load() << std::endl;
+    lastReadOps_ = read;
+    lastWriteOps_ = write;
+}
+
+void ChunkServerBench::PrintLatency(const char* name, BenchOpStat* stat) {
+    if (stat->ops == 0 && stat->errors == 0) {
+        return;
+    }
+    std::cout << name << ": ops: " << stat->ops
+              << ", errors: " << stat->errors
+              << ", bytes: " << stat->bytes;
+    std::vector<uint32_t>& lat = stat->latUs;
+    if (lat.empty()) {
+        std::cout << std::endl;
+        return;
+    }
+    std::sort(lat.begin(), lat.end());
+    uint64_t sum = 0;
+    for (uint32_t l : lat) {
+        sum += l;
+    }
+    auto percentile = [&lat](double p) {
+        return lat[std::min<size_t>(lat.size() * p, lat.size() - 1)];
+    };
+    std::cout << ", lat(us) avg: " << sum / lat.size()
+              << ", p50: " << percentile(0.5)
+              << ", p90: " << percentile(0.9)
+              << ", p99: " << percentile(0.99)
+              << ", p99.9: " << percentile(0.999)
+              << ", max: " << lat.back() << std::endl;
+}
+
+void ChunkServerBench::PrintStageLatency() {
+    // chunkserver的bvar是最近一个窗口的值, 压测刚结束时即为压测期间的延时
+    for (const auto& peer : option_.peers) {
+        for (const char* op : {"read", "write"}) {
+            std::string line;
+            for (const char* stage : kStages) {
+                std::string avg;
+                std::string p99;
+                if (metricClient_.GetMetric(
+                        peer, GetCSStageLatencyName(peer, op, stage,
+                                                    "latency"),
+                        &avg) != MetricRet::kOK ||
+                    metricClient_.GetMetric(
+                        peer, GetCSStageLatencyName(peer, op, stage,
+                                                    "latency_99"),
+                        &p99) != MetricRet::kOK) {
+                    continue;
+                }
+                line += std::string(", ") + stage + ": " + avg + "/" + p99;
+            }
+            if (!line.empty()) {
+                std::cout << peer << " " << op
+                          << " stage lat(us) avg/p99" << line << std::endl;
+            }
+        }
+    }
+}
+
+}  // namespace tool
+}  // namespace curve
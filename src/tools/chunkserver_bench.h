@@ -0,0 +1,153 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_TOOLS_CHUNKSERVER_BENCH_H_
+#define SRC_TOOLS_CHUNKSERVER_BENCH_H_
+
+#include <brpc/channel.h>
+
+#include <atomic>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "proto/chunk.pb.h"
+#include "src/tools/metric_client.h"
+
+namespace curve {
+namespace tool {
+
+struct ChunkServerBenchOption {
+    // 复制组的成员, ip:port, 压测的copyset都由这些chunkserver组成
+    std::vector<std::string> peers;
+    // 是否先在所有peer上创建copyset, 已存在的copyset直接使用
+    bool createCopyset = true;
+    uint32_t logicPoolId = 10000;
+    uint32_t copysetIdStart = 1;
+    uint32_t copysetNum = 16;
+    // 每个copyset中读写的chunk数, chunk id从1开始
+    uint32_t chunksPerCopyset = 4;
+    uint32_t chunkSize = 16 * 1024 * 1024;
+    uint32_t ioSize = 4096;
+    // 读请求的比例, 0-100
+    uint32_t readPercent = 0;
+    // false时每个并发在chunk内顺序读写
+    bool randomOffset = true;
+    // 同时在途的请求数
+    uint32_t iodepth = 32;
+    // 总的iops上限, 0表示不限制
+    uint64_t iops = 0;
+    uint32_t runtimeSec = 60;
+    // 运行时打印进度的间隔, 0表示不打印
+    uint32_t reportIntervalSec = 1;
+    uint32_t rpcTimeoutMs = 3000;
+    // 单个请求的最大重试次数, 包括重定向到leader
+    uint32_t rpcRetryTimes = 5;
+    // 等待copyset选出leader的时间
+    uint32_t leaderWaitMs = 10000;
+};
+
+// 一类请求的统计
+struct BenchOpStat {
+    uint64_t ops = 0;
+    uint64_t errors = 0;
+    uint64_t bytes = 0;
+    // 每个请求的延时, 单位us, 包括重试
+    std::vector<uint32_t> latUs;
+
+    void Merge(const BenchOpStat& other);
+};
+
+/**
+ * 不经过mds和client, 直接通过ChunkService的rpc压测chunkserver,
+ * 用于评估单个节点的能力和定位raft/apply的性能问题.
+ * 压测会覆盖写目标copyset中的chunk, 不要在有用户数据的copyset上运行
+ */
+class ChunkServerBench {
+ public:
+    explicit ChunkServerBench(const ChunkServerBenchOption& option);
+    virtual ~ChunkServerBench() = default;
+
+    /**
+     *  @brief 初始化channel, 创建copyset, 写入每个chunk以便读请求能读到
+     *  @return 成功返回0，失败返回-1
+     */
+    int Init();
+
+    /**
+     *  @brief 按照配置的读写比例和并发运行runtimeSec, 结束后打印延时分位数
+     *         和chunkserver统计的各阶段延时
+     *  @return 成功返回0, 有请求失败返回-1
+     */
+    int Run();
+
+    const BenchOpStat& ReadStat() const { return readStat_; }
+    const BenchOpStat& WriteStat() const { return writeStat_; }
+
+ private:
+    struct Worker;
+
+    int CreateCopysets();
+    int PrepareChunks();
+
+    /**
+     *  @brief 发送请求给copyset的leader, 根据重定向更新leader
+     *  @param index copyset的下标
+     *  @param retryTimes 最大的发送次数
+     *  @return 成功返回0，失败返回-1
+     */
+    int SendRequest(uint32_t index,
+                    const curve::chunkserver::ChunkRequest& request,
+                    const butil::IOBuf& data, uint32_t retryTimes);
+
+    static void* RunWorker(void* arg);
+    void DoWork(Worker* worker);
+    // 按照iops限制等待到下一个请求的发送时间
+    void Pace();
+
+    void Report(uint64_t intervalUs);
+    void PrintLatency(const char* name, BenchOpStat* stat);
+    void PrintStageLatency();
+
+    int FindPeer(const std::string& addr) const;
+
+ private:
+    const ChunkServerBenchOption option_;
+    std::vector<std::unique_ptr<brpc::Channel>> channels_;
+    // 每个copyset的leader在peers中的下标
+    std::unique_ptr<std::atomic<int>[]> leaders_;
+
+    std::atomic<bool> stop_;
+    std::atomic<uint64_t> readOps_;
+    std::atomic<uint64_t> writeOps_;
+    std::atomic<uint64_t> errors_;
+    std::atomic<int64_t> nextSendNs_;
+    // 上次打印进度时的请求数
+    uint64_t lastReadOps_;
+    uint64_t lastWriteOps_;
+    int64_t intervalNs_;
+
+    BenchOpStat readStat_;
+    BenchOpStat writeStat_;
+
+    MetricClient metricClient_;
+};
+
+}  // namespace tool
+}  // namespace curve
+
+#endif  // SRC_TOOLS_CHUNKSERVER_BENCH_H_
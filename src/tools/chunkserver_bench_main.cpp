@@ -0,0 +1,83 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gflags/gflags.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "src/common/string_util.h"
+#include "src/tools/chunkserver_bench.h"
+#include "src/tools/curve_tool_define.h"
+
+DEFINE_string(peers, "",
+              "chunkservers of the copysets, ip:port separated by comma");
+DEFINE_bool(createCopyset, true, "create the copysets on all peers first");
+DEFINE_uint32(logicPoolId, 10000, "logical pool id of the copysets");
+DEFINE_uint32(copysetIdStart, 1, "id of the first copyset");
+DEFINE_uint32(copysetNum, 16, "number of the copysets");
+DEFINE_uint32(chunksPerCopyset, 4, "number of the chunks in every copyset");
+DEFINE_uint32(benchChunkSize, 16 * 1024 * 1024, "size of the chunks");
+DEFINE_uint32(ioSize, 4096, "size of every request");
+DEFINE_uint32(readPercent, 0, "percent of the read requests, 0-100");
+DEFINE_bool(randomOffset, true, "random or sequential offset in chunks");
+DEFINE_uint32(iodepth, 32, "number of the requests in flight");
+DEFINE_uint64(iops, 0, "limit of the total iops, 0 means no limit");
+DEFINE_uint32(runtime, 60, "seconds to run");
+DEFINE_uint32(reportInterval, 1, "seconds between the progress reports");
+DEFINE_uint32(leaderWaitMs, 10000, "time to wait for copyset leaders");
+
+const char* kHelpStr =
+    "Usage: curve_chunkserver_bench --peers=ip:port[,ip:port...] "
+    "[OPTIONS...]\n"
+    "Send ChunkService requests to chunkservers directly, without mds and "
+    "client.\n"
+    "WARNING: the chunks of the copysets are overwritten.\n";
+
+int main(int argc, char** argv) {
+    gflags::SetUsageMessage(kHelpStr);
+    google::ParseCommandLineFlags(&argc, &argv, true);
+
+    curve::tool::ChunkServerBenchOption option;
+    curve::common::SplitString(FLAGS_peers, ",", &option.peers);
+    if (option.peers.empty()) {
+        std::cout << kHelpStr << std::endl;
+        return -1;
+    }
+    option.createCopyset = FLAGS_createCopyset;
+    option.logicPoolId = FLAGS_logicPoolId;
+    option.copysetIdStart = FLAGS_copysetIdStart;
+    option.copysetNum = FLAGS_copysetNum;
+    option.chunksPerCopyset = FLAGS_chunksPerCopyset;
+    option.chunkSize = FLAGS_benchChunkSize;
+    option.ioSize = FLAGS_ioSize;
+    option.readPercent = FLAGS_readPercent;
+    option.randomOffset = FLAGS_randomOffset;
+    option.iodepth = FLAGS_iodepth;
+    option.iops = FLAGS_iops;
+    option.runtimeSec = FLAGS_runtime;
+    option.reportIntervalSec = FLAGS_reportInterval;
+    option.rpcTimeoutMs = FLAGS_rpcTimeout;
+    option.rpcRetryTimes = FLAGS_rpcRetryTimes;
+    option.leaderWaitMs = FLAGS_leaderWaitMs;
+
+    curve::tool::ChunkServerBench bench(option);
+    if (bench.Init() != 0) {
+        return -1;
+    }
+    return bench.Run();
+}
@@ -44,7 +44,7 @@ std::shared_ptr<CurveMetaTool> ChunkServerToolFactory::GenerateCurveMetaTool() {
 std::shared_ptr<RaftLogTool> ChunkServerToolFactory::GenerateRaftLogTool() {
     auto localFs = Ext4FileSystemImpl::getInstance();
     auto parser = std::make_shared<SegmentParser>(localFs);
-    return std::make_shared<RaftLogTool>(parser);
+    return std::make_shared<RaftLogTool>(parser, localFs);
 }
 
 }  // namespace tool
@@ -31,7 +31,8 @@ const char* kHelpStr = "Usage: chunkserver_tool [Command] [OPTIONS...]\n"
         "COMMANDS:\n"
         "chunk-meta : print chunk meta page info\n"
         "snapshot-meta : print snapshot meta page info\n"
-        "raft-log-meta : print raft log header\n";
+        "raft-log-meta : print raft log header\n"
+        "raft-log-stat : print statistics of raft log segments\n";
 
 using curve::tool::ChunkServerToolFactory;
 
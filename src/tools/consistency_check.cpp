@@ -21,6 +21,10 @@
  */
 
 #include <gflags/gflags.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <sstream>
 
 #include "src/tools/consistency_check.h"
 
@@ -31,6 +35,12 @@ DEFINE_bool(check_hash, true, R"(用户需要先确认copyset的applyindex一致
                         如果一致了再设置check_hash = true，
                         检查copyset内容是不是一致)");
 DEFINE_uint32(chunkServerBasePort, 8200, "base port of chunkserver");
+DEFINE_uint32(check_concurrency, 1, "number of copysets checked concurrently,"
+              " 1 means checking one by one and stopping at the first error");
+DEFINE_uint32(check_cs_concurrency, 2, "max number of copysets checked "
+              "concurrently on one chunkserver, 0 means no limit");
+DEFINE_string(check_checkpoint, "", "file recording the consistent copysets,"
+              " they are skipped when checking the same file again");
 DECLARE_string(mdsAddr);
 
 namespace curve {
@@ -76,10 +86,19 @@ std::ostream& operator<<(std::ostream& os, const CsAddrsType& csAddrs) {
 
 ConsistencyCheck::ConsistencyCheck(
                     std::shared_ptr<NameSpaceToolCore> nameSpaceToolCore,
-                    std::shared_ptr<ChunkServerClient> csClient) :
+                    std::shared_ptr<ChunkServerClient> csClient,
+                    ChunkServerClientFactory csClientFactory) :
                         nameSpaceToolCore_(nameSpaceToolCore),
                         csClient_(csClient),
-                        inited_(false) {
+                        inited_(false),
+                        csClientFactory_(csClientFactory),
+                        totalTasks_(0),
+                        finishedTasks_(0) {
+    if (!csClientFactory_) {
+        csClientFactory_ = []() {
+            return std::make_shared<ChunkServerClient>();
+        };
+    }
 }
 
 bool ConsistencyCheck::SupportCommand(const std::string& command) {
@@ -120,17 +139,190 @@ int ConsistencyCheck::CheckFileConsistency(const std::string& fileName,
                   << std::endl;
         return -1;
     }
-    for (auto copyset : copysets) {
-        res = CheckCopysetConsistency(copyset, checkHash);
-        if (res != 0) {
-            std::cout << "CheckCopysetConsistency fail!" << std::endl;
-            return -1;
+    std::set<CopySet> checked;
+    if (!FLAGS_check_checkpoint.empty() &&
+        LoadCheckpoint(fileName, checkHash, &checked) != 0) {
+        return -1;
+    }
+    std::vector<CopySet> toCheck;
+    for (const auto& copyset : copysets) {
+        if (checked.count(copyset) == 0) {
+            toCheck.emplace_back(copyset);
+        }
+    }
+    if (!checked.empty()) {
+        std::cout << "Skip " << copysets.size() - toCheck.size()
+                  << " copysets checked according to "
+                  << FLAGS_check_checkpoint << std::endl;
+    }
+
+    if (FLAGS_check_concurrency > 1) {
+        res = CheckCopysetsInParallel(toCheck, checkHash);
+    } else {
+        for (const auto& copyset : toCheck) {
+            res = CheckCopysetConsistency(copyset, checkHash);
+            if (res != 0) {
+                std::cout << "CheckCopysetConsistency fail!" << std::endl;
+                break;
+            }
+            RecordCheckpoint(copyset);
         }
     }
+    if (checkpoint_.is_open()) {
+        checkpoint_.close();
+    }
+    if (res != 0) {
+        return -1;
+    }
+    // 全部一致，下次检查要重新开始
+    if (!FLAGS_check_checkpoint.empty()) {
+        ::remove(FLAGS_check_checkpoint.c_str());
+    }
     std::cout << "consistency check success!" << std::endl;
     return 0;
 }
 
+int ConsistencyCheck::LoadCheckpoint(const std::string& fileName,
+                                     bool checkHash,
+                                     std::set<CopySet>* checked) {
+    // 第一行记录文件名和检查方式，之后每行一个检查通过的copyset
+    std::ostringstream header;
+    header << "# " << fileName << " check_hash=" << checkHash;
+    std::ifstream in(FLAGS_check_checkpoint);
+    std::string line;
+    if (in && std::getline(in, line) && line == header.str()) {
+        PoolIdType lpid;
+        CopySetIdType copysetId;
+        while (in >> lpid >> copysetId) {
+            checked->emplace(lpid, copysetId);
+        }
+        in.close();
+        checkpoint_.open(FLAGS_check_checkpoint, std::ios::app);
+    } else {
+        if (in) {
+            std::cout << "Checkpoint " << FLAGS_check_checkpoint
+                      << " is not of this check, start over" << std::endl;
+        }
+        in.close();
+        checkpoint_.open(FLAGS_check_checkpoint, std::ios::trunc);
+        checkpoint_ << header.str() << std::endl;
+    }
+    if (!checkpoint_) {
+        checkpoint_.close();
+        std::cout << "Open checkpoint " << FLAGS_check_checkpoint
+                  << " fail!" << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+void ConsistencyCheck::RecordCheckpoint(const CopySet& copyset) {
+    if (checkpoint_.is_open()) {
+        // 每个copyset都flush，工具被中断时不丢失检查进度
+        checkpoint_ << copyset.first << " " << copyset.second << std::endl;
+    }
+}
+
+int ConsistencyCheck::CheckCopysetsInParallel(
+                                const std::vector<CopySet>& copysets,
+                                bool checkHash) {
+    // 先从mds拿到所有copyset的chunkserver，以便按chunkserver限制并发
+    tasks_.clear();
+    for (const auto& copyset : copysets) {
+        CopysetTask task;
+        task.copyset = copyset;
+        if (GetCopysetCsAddrs(copyset, &task.csAddrs) != 0) {
+            return -1;
+        }
+        tasks_.emplace_back(std::move(task));
+    }
+    csInflight_.clear();
+    failedCopysets_.clear();
+    totalTasks_ = tasks_.size();
+    finishedTasks_ = 0;
+
+    uint32_t threadNum = std::min<uint64_t>(FLAGS_check_concurrency,
+                                            totalTasks_);
+    std::vector<curve::common::Thread> threads;
+    for (uint32_t i = 0; i < threadNum; ++i) {
+        threads.emplace_back(&ConsistencyCheck::CheckCopysetWorker,
+                             this, checkHash);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (!failedCopysets_.empty()) {
+        std::cout << failedCopysets_.size() << " of " << totalTasks_
+                  << " copysets check fail:" << std::endl;
+        for (const auto& copyset : failedCopysets_) {
+            std::cout << copyset << std::endl;
+        }
+        return -1;
+    }
+    return 0;
+}
+
+bool ConsistencyCheck::PickTaskLocked(CopysetTask* task) {
+    for (auto it = tasks_.begin(); it != tasks_.end(); ++it) {
+        bool idle = true;
+        if (FLAGS_check_cs_concurrency > 0) {
+            for (const auto& csAddr : it->csAddrs) {
+                if (csInflight_[csAddr] >= FLAGS_check_cs_concurrency) {
+                    idle = false;
+                    break;
+                }
+            }
+        }
+        if (idle) {
+            // 一次占用所有副本的并发数，不会互相等待
+            for (const auto& csAddr : it->csAddrs) {
+                ++csInflight_[csAddr];
+            }
+            *task = std::move(*it);
+            tasks_.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ConsistencyCheck::CheckCopysetWorker(bool checkHash) {
+    std::shared_ptr<ChunkServerClient> csClient = csClientFactory_();
+    while (true) {
+        CopysetTask task;
+        {
+            curve::common::UniqueLock lk(taskMutex_);
+            while (!PickTaskLocked(&task)) {
+                if (tasks_.empty()) {
+                    return;
+                }
+                taskCond_.wait(lk);
+            }
+        }
+
+        std::ostringstream os;
+        int res = DoCheckCopyset(task.copyset, task.csAddrs, checkHash,
+                                 csClient.get(), os);
+
+        curve::common::LockGuard lk(taskMutex_);
+        for (const auto& csAddr : task.csAddrs) {
+            --csInflight_[csAddr];
+        }
+        taskCond_.notify_all();
+        ++finishedTasks_;
+        // 一个copyset的输出放在一起，不与其他线程的交错
+        std::cout << os.str() << "[" << finishedTasks_ << "/" << totalTasks_
+                  << "] " << task.copyset
+                  << (res == 0 ? " consistent" : " check fail") << std::endl;
+        if (res == 0) {
+            RecordCheckpoint(task.copyset);
+        } else {
+            failedCopysets_.emplace_back(task.copyset);
+        }
+    }
+}
+
 void ConsistencyCheck::PrintHelp(const std::string &cmd) {
     if (!SupportCommand(cmd)) {
         std::cout << "Command not supported!" << std::endl;
@@ -138,6 +330,7 @@ void ConsistencyCheck::PrintHelp(const std::string &cmd) {
     }
     std::cout << "Example: " << std::endl;
     std::cout << "curve_ops_tool check-consistency -filename=/test [-check_hash=false]"  << std::endl;  // NOLINT
+    std::cout << "curve_ops_tool check-consistency -filename=/test [-check_concurrency=16] [-check_cs_concurrency=2] [-check_checkpoint=/tmp/test.ckpt]"  << std::endl;  // NOLINT
 }
 
 int ConsistencyCheck::FetchFileCopyset(const std::string& fileName,
@@ -163,6 +356,16 @@ int ConsistencyCheck::FetchFileCopyset(const std::string& fileName,
 int ConsistencyCheck::CheckCopysetConsistency(
                                 const CopySet copyset,
                                 bool checkHash) {
+    CsAddrsType csAddrs;
+    if (GetCopysetCsAddrs(copyset, &csAddrs) != 0) {
+        return -1;
+    }
+    return DoCheckCopyset(copyset, csAddrs, checkHash,
+                          csClient_.get(), std::cout);
+}
+
+int ConsistencyCheck::GetCopysetCsAddrs(const CopySet& copyset,
+                                        CsAddrsType* csAddrs) {
     std::vector<ChunkServerLocation> csLocs;
     int res = nameSpaceToolCore_->GetChunkServerListInCopySet(
                                                 copyset.first,
@@ -173,34 +376,43 @@ int ConsistencyCheck::CheckCopysetConsistency(
                   << std::endl;
         return -1;
     }
-    std::vector<std::string> csAddrs;
     for (const auto& csLoc : csLocs) {
         std::string hostIp = csLoc.hostip();
         uint64_t port = csLoc.port();
         std::string csAddr = hostIp + ":" + std::to_string(port);
-        csAddrs.emplace_back(csAddr);
+        csAddrs->emplace_back(csAddr);
     }
+    return 0;
+}
+
+int ConsistencyCheck::DoCheckCopyset(const CopySet& copyset,
+                                     const CsAddrsType& csAddrs,
+                                     bool checkHash,
+                                     ChunkServerClient* csClient,
+                                     std::ostream& os) {
     // 检查当前copyset的chunkserver内容是否一致
     if (checkHash) {
         // 先检查apply index是否一致
-        res = CheckApplyIndex(copyset, csAddrs);
+        int res = CheckApplyIndex(copyset, csAddrs, csClient, os);
         if (res != 0) {
-            std::cout << "Apply index not match when check hash!" << std::endl;
+            os << "Apply index not match when check hash!" << std::endl;
             return -1;
         }
-        return CheckCopysetHash(copyset, csAddrs);
+        return CheckCopysetHash(copyset, csAddrs, csClient, os);
     } else {
-        return CheckApplyIndex(copyset, csAddrs);
+        return CheckApplyIndex(copyset, csAddrs, csClient, os);
     }
 }
 
 int ConsistencyCheck::GetCopysetStatusResponse(
                         const std::string& csAddr,
                         const CopySet copyset,
-                        CopysetStatusResponse* response) {
-    int res = csClient_->Init(csAddr);
+                        ChunkServerClient* csClient,
+                        CopysetStatusResponse* response,
+                        std::ostream& os) {
+    int res = csClient->Init(csAddr);
     if (res != 0) {
-        std::cout << "Init chunkserverClient to " << csAddr
+        os << "Init chunkserverClient to " << csAddr
                   << " fail!" << std::endl;
         return -1;
     }
@@ -211,9 +423,9 @@ int ConsistencyCheck::GetCopysetStatusResponse(
     request.set_copysetid(copyset.second);
     request.set_allocated_peer(peer);
     request.set_queryhash(false);
-    res = csClient_->GetCopysetStatus(request, response);
+    res = csClient->GetCopysetStatus(request, response);
     if (res != 0) {
-        std::cout << "GetCopysetStatus from " << csAddr
+        os << "GetCopysetStatus from " << csAddr
                   << " fail!" << std::endl;
         return -1;
     }
@@ -221,12 +433,19 @@ int ConsistencyCheck::GetCopysetStatusResponse(
 }
 
 int ConsistencyCheck::CheckCopysetHash(const CopySet& copyset,
-                                       const CsAddrsType& csAddrs) {
-    for (const auto& chunkId : chunksInCopyset_[copyset]) {
+                                       const CsAddrsType& csAddrs,
+                                       ChunkServerClient* csClient,
+                                       std::ostream& os) {
+    // 并发检查时不能修改chunksInCopyset_
+    auto iter = chunksInCopyset_.find(copyset);
+    if (iter == chunksInCopyset_.end()) {
+        return 0;
+    }
+    for (const auto& chunkId : iter->second) {
         Chunk chunk(copyset.first, copyset.second, chunkId);
-        int res = CheckChunkHash(chunk, csAddrs);
+        int res = CheckChunkHash(chunk, csAddrs, csClient, os);
         if (res != 0) {
-            std::cout << "{" << chunk
+            os << "{" << chunk
                       << "," << csAddrs << "}" << std::endl;
             return -1;
         }
@@ -235,20 +454,22 @@ int ConsistencyCheck::CheckCopysetHash(const CopySet& copyset,
 }
 
 int ConsistencyCheck::CheckChunkHash(const Chunk& chunk,
-                                     const CsAddrsType& csAddrs) {
+                                     const CsAddrsType& csAddrs,
+                                     ChunkServerClient* csClient,
+                                     std::ostream& os) {
     std::string preHash;
     std::string curHash;
     bool first = true;
     for (const auto& csAddr : csAddrs) {
-        int res = csClient_->Init(csAddr);
+        int res = csClient->Init(csAddr);
         if (res != 0) {
-            std::cout << "Init chunkserverClient to " << csAddr
+            os << "Init chunkserverClient to " << csAddr
                       << " fail!" << std::endl;
             return -1;
         }
-        res = csClient_->GetChunkHash(chunk, &curHash);
+        res = csClient->GetChunkHash(chunk, &curHash);
         if (res != 0) {
-            std::cout << "GetChunkHash from " << csAddr << " fail" << std::endl;
+            os << "GetChunkHash from " << csAddr << " fail" << std::endl;
             return -1;
         }
         if (first) {
@@ -257,8 +478,8 @@ int ConsistencyCheck::CheckChunkHash(const Chunk& chunk,
             continue;
         }
         if (curHash != preHash) {
-            std::cout << "Chunk hash not equal!" << std::endl;
-            std::cout << "previous chunk hash = " << preHash
+            os << "Chunk hash not equal!" << std::endl;
+            os << "previous chunk hash = " << preHash
                       << ", current hash = " << curHash << std::endl;
             return -1;
         }
@@ -267,16 +488,19 @@ int ConsistencyCheck::CheckChunkHash(const Chunk& chunk,
 }
 
 int ConsistencyCheck::CheckApplyIndex(const CopySet copyset,
-                                      const CsAddrsType& csAddrs) {
+                                      const CsAddrsType& csAddrs,
+                                      ChunkServerClient* csClient,
+                                      std::ostream& os) {
     uint64_t preIndex;
     uint64_t curIndex;
     bool first = true;
     int ret = 0;
     for (const auto& csAddr : csAddrs) {
         CopysetStatusResponse response;
-        int res = GetCopysetStatusResponse(csAddr, copyset, &response);
+        int res = GetCopysetStatusResponse(csAddr, copyset, csClient,
+                                           &response, os);
         if (res != 0) {
-            std::cout << "GetCopysetStatusResponse from " << csAddr
+            os << "GetCopysetStatusResponse from " << csAddr
                       << " fail" << std::endl;
             ret = -1;
             break;
@@ -288,15 +512,15 @@ int ConsistencyCheck::CheckApplyIndex(const CopySet copyset,
             continue;
         }
         if (curIndex != preIndex) {
-            std::cout << "Apply index not equal!" << std::endl;
-            std::cout << "previous apply index " << preIndex
+            os << "Apply index not equal!" << std::endl;
+            os << "previous apply index " << preIndex
                       << ", current index = " << curIndex << std::endl;
             ret = -1;
             break;
         }
     }
     if (ret != 0) {
-        std::cout << copyset << "," << csAddrs << std::endl;
+        os << copyset << "," << csAddrs << std::endl;
     }
     return ret;
 }
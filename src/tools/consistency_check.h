@@ -31,6 +31,9 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <fstream>
+#include <functional>
+#include <list>
 #include <memory>
 #include <set>
 #include <utility>
@@ -38,6 +41,7 @@
 
 #include "proto/copyset.pb.h"
 #include "src/common/net_common.h"
+#include "src/common/concurrent/concurrent.h"
 #include "src/tools/namespace_tool_core.h"
 #include "src/tools/chunkserver_client.h"
 #include "src/tools/curve_tool.h"
@@ -45,19 +49,30 @@
 
 DECLARE_string(filename);
 DECLARE_bool(check_hash);
+DECLARE_uint32(check_concurrency);
+DECLARE_uint32(check_cs_concurrency);
+DECLARE_string(check_checkpoint);
 
 namespace curve {
 namespace tool {
 using CopySet = std::pair<PoolIdType, CopySetIdType>;
 using CsAddrsType = std::vector<std::string>;
+// 并发检查时为每个线程创建一个client，ChunkServerClient不能多线程共用
+using ChunkServerClientFactory =
+    std::function<std::shared_ptr<ChunkServerClient>()>;
 
 std::ostream& operator<<(std::ostream& os, const CopySet& copyset);
 std::ostream& operator<<(std::ostream& os, const CsAddrsType& csAddrs);
 
 class ConsistencyCheck : public CurveTool {
  public:
+    /**
+     *  @param csClientFactory 并发检查时创建client，为空则创建
+     *         ChunkServerClient
+     */
     ConsistencyCheck(std::shared_ptr<NameSpaceToolCore> nameSpaceToolCore,
-                         std::shared_ptr<ChunkServerClient> csClient);
+                     std::shared_ptr<ChunkServerClient> csClient,
+                     ChunkServerClientFactory csClientFactory = nullptr);
     ~ConsistencyCheck() = default;
 
     /**
@@ -76,6 +91,10 @@ class ConsistencyCheck : public CurveTool {
 
     /**
      *  @brief 检查三副本一致性
+     *         check_concurrency大于1时并发检查多个copyset，每个chunkserver上
+     *         同时检查的copyset不超过check_cs_concurrency个，并且检查完所有
+     *         copyset之后才返回；指定了check_checkpoint时跳过上次已检查通过的
+     *         copyset，全部一致之后删除checkpoint文件
      *  @param fileName 要检查一致性的文件名
      *  @param checkHash 是否检查hash，如果为false，检查apply index而不是hash
      *  @return 一致返回0，否则返回-1
@@ -104,11 +123,69 @@ class ConsistencyCheck : public CurveTool {
     static bool SupportCommand(const std::string& command);
 
  private:
+    // 并发检查时待检查的copyset
+    struct CopysetTask {
+        CopySet copyset;
+        CsAddrsType csAddrs;
+    };
+
    /**
      *  @brief 初始化
      */
     int Init();
 
+    /**
+     *  @brief 从mds获取copyset所在的chunkserver的地址
+     *  @param copyset 要获取的copyset
+     *  @param[out] csAddrs chunkserver的地址，返回值为0时有效
+     *  @return 成功返回0，失败返回-1
+     */
+    int GetCopysetCsAddrs(const CopySet& copyset, CsAddrsType* csAddrs);
+
+    /**
+     *  @brief 用指定的client检查copyset的三副本一致性
+     *  @param csClient 向chunkserver发送RPC的client
+     *  @param os 检查过程的输出
+     *  @return 一致返回0，否则返回-1
+     */
+    int DoCheckCopyset(const CopySet& copyset,
+                       const CsAddrsType& csAddrs,
+                       bool checkHash,
+                       ChunkServerClient* csClient,
+                       std::ostream& os);
+
+    /**
+     *  @brief 并发检查copyset的一致性，每个copyset检查完即输出结果
+     *  @return 全部一致返回0，否则返回-1
+     */
+    int CheckCopysetsInParallel(const std::vector<CopySet>& copysets,
+                                bool checkHash);
+
+    /**
+     *  @brief 并发检查的线程，不断取出chunkserver未达到并发上限的copyset检查
+     */
+    void CheckCopysetWorker(bool checkHash);
+
+    /**
+     *  @brief 取出一个所有副本所在chunkserver都未达到并发上限的copyset，
+     *         调用时需持有taskMutex_
+     *  @return 取到返回true
+     */
+    bool PickTaskLocked(CopysetTask* task);
+
+    /**
+     *  @brief 加载checkpoint，文件名或检查方式与上次不同时重新开始
+     *  @param[out] checked 上次已检查通过的copyset
+     *  @return 成功返回0，失败返回-1
+     */
+    int LoadCheckpoint(const std::string& fileName, bool checkHash,
+                       std::set<CopySet>* checked);
+
+    /**
+     *  @brief 记录检查通过的copyset到checkpoint
+     */
+    void RecordCheckpoint(const CopySet& copyset);
+
     /**
      *  @brief 从mds获取文件所在的copyset列表
      *  @param fileName 文件名
@@ -127,7 +204,9 @@ class ConsistencyCheck : public CurveTool {
      */
     int GetCopysetStatusResponse(const std::string& csAddr,
                                  const CopySet copyset,
-                                 CopysetStatusResponse* response);
+                                 ChunkServerClient* csClient,
+                                 CopysetStatusResponse* response,
+                                 std::ostream& os);
 
     /**
      *  @brief 检查copyset中指定chunk的hash的一致性
@@ -136,7 +215,9 @@ class ConsistencyCheck : public CurveTool {
      *  @return 一致返回0，否则返回-1
      */
     int CheckCopysetHash(const CopySet& copyset,
-                         const CsAddrsType& csAddrs);
+                         const CsAddrsType& csAddrs,
+                         ChunkServerClient* csClient,
+                         std::ostream& os);
 
     /**
      *  @brief chunk在三个副本的hash的一致性
@@ -145,7 +226,9 @@ class ConsistencyCheck : public CurveTool {
      *  @return 一致返回0，否则返回-1
      */
     int CheckChunkHash(const Chunk& chunk,
-                       const CsAddrsType& csAddrs);
+                       const CsAddrsType& csAddrs,
+                       ChunkServerClient* csClient,
+                       std::ostream& os);
 
     /**
      *  @brief 检查副本间applyindex的一致性
@@ -154,7 +237,9 @@ class ConsistencyCheck : public CurveTool {
      *  @return 一致返回0，否则返回-1
      */
     int CheckApplyIndex(const CopySet copyset,
-                        const CsAddrsType& csAddrs);
+                        const CsAddrsType& csAddrs,
+                        ChunkServerClient* csClient,
+                        std::ostream& os);
 
  private:
     // 文件所在的逻辑池id
@@ -167,6 +252,23 @@ class ConsistencyCheck : public CurveTool {
     std::map<CopySet, std::set<uint64_t>> chunksInCopyset_;
     // 是否初始化成功过
     bool inited_;
+    // 并发检查时创建client
+    ChunkServerClientFactory csClientFactory_;
+
+    // 保护并发检查的任务、chunkserver并发数、输出和checkpoint
+    curve::common::Mutex taskMutex_;
+    curve::common::ConditionVariable taskCond_;
+    // 待检查的copyset
+    std::list<CopysetTask> tasks_;
+    // 每个chunkserver上正在检查的copyset数
+    std::map<std::string, uint32_t> csInflight_;
+    // copyset总数和已检查完的copyset数，用于输出进度
+    uint64_t totalTasks_;
+    uint64_t finishedTasks_;
+    // 不一致或检查失败的copyset
+    std::vector<CopySet> failedCopysets_;
+    // 记录检查通过的copyset，未指定check_checkpoint时不打开
+    std::ofstream checkpoint_;
 };
 }  // namespace tool
 }  // namespace curve
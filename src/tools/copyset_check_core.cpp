@@ -386,6 +386,23 @@ void CopysetCheckCore::ConcurrentCheckCopysetsOnServer(
     }
 }
 
+void CopysetCheckCore::QueryChunkServersConcurrently(
+                const std::vector<ChunkServerInfo> &chunkservers,
+                std::map<std::string, std::pair<int, butil::IOBuf>> *result) {
+    std::vector<Thread> threadpool;
+    uint32_t index = 0;
+    uint64_t threadNum = std::min<uint64_t>(FLAGS_rpcConcurrentNum,
+                                            chunkservers.size());
+    for (uint64_t i = 0; i < threadNum; i++) {
+        threadpool.emplace_back(Thread(
+                        &CopysetCheckCore::ConcurrentCheckCopysetsOnServer,
+                        this, std::ref(chunkservers), &index, result));
+    }
+    for (auto &thread : threadpool) {
+        thread.join();
+    }
+}
+
 int CopysetCheckCore::CheckCopysetsOnServer(const ServerIdType& serverId,
                             const std::string& serverIp, bool queryLeader,
                             std::vector<std::string>* unhealthyChunkServers) {
@@ -402,18 +419,8 @@ int CopysetCheckCore::CheckCopysetsOnServer(const ServerIdType& serverId,
         std::cout << "ListChunkServersOnServer fail!" << std::endl;
         return -1;
     }
-    std::vector<Thread> threadpool;
     std::map<std::string, std::pair<int, butil::IOBuf>> queryCsResult;
-    uint32_t index = 0;
-    for (uint64_t i = 0; i < FLAGS_rpcConcurrentNum; i++) {
-        threadpool.emplace_back(Thread(
-                        &CopysetCheckCore::ConcurrentCheckCopysetsOnServer,
-                        this, std::ref(chunkservers), &index,
-                        &queryCsResult));
-    }
-    for (auto &thread : threadpool) {
-        thread.join();
-    }
+    QueryChunkServersConcurrently(chunkservers, &queryCsResult);
 
     for (auto &record : queryCsResult) {
         std::string chunkserverAddr = record.first;
@@ -443,10 +450,39 @@ int CopysetCheckCore::CheckCopysetsInCluster() {
         std::cout << "ListServersInCluster fail!" << std::endl;
         return -1;
     }
+    std::vector<ChunkServerInfo> chunkservers;
     for (const auto& serverInfo : servers) {
-        const auto& serverId = serverInfo.serverid();
-        int res = CheckCopysetsOnServer(serverId, "", false);
-        if (res != 0) {
+        std::vector<ChunkServerInfo> chunkserversOnServer;
+        res = mdsClient_->ListChunkServersOnServer(serverInfo.serverid(),
+                                                   &chunkserversOnServer);
+        if (res < 0) {
+            std::cout << "ListChunkServersOnServer fail!" << std::endl;
+            isHealthy = false;
+            continue;
+        }
+        chunkservers.insert(chunkservers.end(), chunkserversOnServer.begin(),
+                            chunkserversOnServer.end());
+    }
+    // 一次并发查询集群中所有的chunkserver，而不是逐个server查询
+    std::map<std::string, std::pair<int, butil::IOBuf>> queryCsResult;
+    QueryChunkServersConcurrently(chunkservers, &queryCsResult);
+    // 先记录所有chunkserver上的copyset，检查peer是否在线时直接使用，
+    // 不用再向chunkserver查询，查询失败的也不用再等一次超时
+    for (const auto& record : queryCsResult) {
+        if (record.second.first != 0) {
+            serviceExceptionChunkServers_.emplace(record.first);
+            chunkserverCopysets_[record.first] = {};
+            continue;
+        }
+        butil::IOBuf iobuf = record.second.second;
+        CopySetInfosType copysetInfos;
+        ParseResponseAttachment({}, &iobuf, &copysetInfos);
+        UpdateChunkServerCopysets(record.first, copysetInfos);
+    }
+    for (auto& record : queryCsResult) {
+        auto status = CheckCopysetsOnChunkServer(record.first, {}, false,
+                                                 &record.second, false);
+        if (status != ChunkServerHealthStatus::kHealthy) {
             isHealthy = false;
         }
     }
@@ -690,16 +726,49 @@ bool CopysetCheckCore::CheckChunkServerOnline(
     int res = csClient->Init(chunkserverAddr);
     if (res != 0) {
         std::cout << "Init chunkserverClient fail!" << std::endl;
+        curve::common::LockGuard lk(onlineMutex);
         chunkserverCopysets_[chunkserverAddr] = {};
         return false;
     }
     bool online = csClient->CheckChunkServerOnline();
     if (!online) {
+        curve::common::LockGuard lk(onlineMutex);
         chunkserverCopysets_[chunkserverAddr] = {};
     }
     return online;
 }
 
+void CopysetCheckCore::CheckChunkServersOnline(
+                    const std::vector<std::string>& chunkserverAddrs,
+                    std::map<std::string, bool>* onlineStatus) {
+    uint64_t index = 0;
+    Mutex mtx;
+    auto worker = [&]() {
+        while (true) {
+            std::string csAddr;
+            {
+                curve::common::LockGuard lk(mtx);
+                if (index >= chunkserverAddrs.size()) {
+                    return;
+                }
+                csAddr = chunkserverAddrs[index++];
+            }
+            bool online = CheckChunkServerOnline(csAddr);
+            curve::common::LockGuard lk(mtx);
+            (*onlineStatus)[csAddr] = online;
+        }
+    };
+    std::vector<Thread> threadpool;
+    uint64_t threadNum = std::min<uint64_t>(FLAGS_rpcConcurrentNum,
+                                            chunkserverAddrs.size());
+    for (uint64_t i = 0; i < threadNum; i++) {
+        threadpool.emplace_back(worker);
+    }
+    for (auto &thread : threadpool) {
+        thread.join();
+    }
+}
+
 bool CopysetCheckCore::CheckCopySetOnline(const std::string& csAddr,
                                           const std::string& groupId) {
     if (chunkserverCopysets_.count(csAddr) != 0) {
@@ -249,6 +249,16 @@ class CopysetCheckCore {
     */
     virtual bool CheckChunkServerOnline(const std::string& chunkserverAddr);
 
+    /**
+    * @brief 并发检查多个chunkserver是否在线，并发数为rpcConcurrentNum
+    *
+    * @param chunkserverAddrs chunkserver的地址
+    * @param[out] onlineStatus 每个chunkserver是否在线
+    */
+    virtual void CheckChunkServersOnline(
+                    const std::vector<std::string>& chunkserverAddrs,
+                    std::map<std::string, bool>* onlineStatus);
+
     /**
     * @brief List volumes on majority peers offline copysets
     *
@@ -330,6 +340,15 @@ class CopysetCheckCore {
                 uint32_t *index,
                 std::map<std::string, std::pair<int, butil::IOBuf>> *result);
 
+    /**
+     * @brief query chunkservers with rpcConcurrentNum threads
+     * @param[in] chunkservers: chunkservers to query
+     * @param[out] result: rpc response from chunkserver
+     */
+    void QueryChunkServersConcurrently(
+                const std::vector<ChunkServerInfo> &chunkservers,
+                std::map<std::string, std::pair<int, butil::IOBuf>> *result);
+
     /**
     * @brief 根据leader的map里面的copyset信息分析出copyset是否健康，健康返回0，否则
     *        否则返回错误码
@@ -454,6 +473,8 @@ class CopysetCheckCore {
     Mutex indexMutex;
     Mutex vectorMutex;
     Mutex mapMutex;
+    // protect chunkserverCopysets_ when checking chunkservers online
+    Mutex onlineMutex;
 };
 
 }  // namespace tool
@@ -29,8 +29,13 @@
 #include <set>
 #include <mutex>    // NOLINT
 #include <thread>   // NOLINT
+#include <chrono>   // NOLINT
 #include <atomic>
 #include <vector>
+#include <memory>
+#include <string>
+#include <iomanip>
+#include <iostream>
 
 #include "src/fs/fs_common.h"
 #include "src/fs/local_filesystem.h"
@@ -39,6 +44,7 @@
 #include "src/common/curve_define.h"
 #include "src/chunkserver/datastore/file_pool.h"
 #include "src/common/fast_align.h"
+#include "src/common/string_util.h"
 
 #include "include/chunkserver/chunkserver_common.h"
 
@@ -69,17 +75,19 @@ static bool ValidateBlockSize(const char* /*name*/, uint32_t blockSize) {
 
 DEFINE_validator(blockSize, &ValidateBlockSize);
 
+// 同时格式化多块盘时，以下三个路径都用逗号分隔，按顺序一一对应
 DEFINE_string(fileSystemPath,
               "./",
-              "chunkserver disk path");
+              "chunkserver disk path, separated by comma for multiple disks");
 
 DEFINE_string(filePoolDir,
               "./filePool/",
-              "chunkfile pool dir");
+              "chunkfile pool dir, separated by comma for multiple disks");
 
 DEFINE_string(filePoolMetaPath,
               "./filePool.meta",
-              "chunkfile pool meta info file path.");
+              "chunkfile pool meta info file path, "
+              "separated by comma for multiple disks");
 
 // preallocateNum仅在测试的时候使用，测试提前预分配固定数量的chunk
 // 当设置这个值的时候可以不用设置allocatepercent
@@ -98,6 +106,26 @@ DEFINE_bool(needWriteZero,
         true,
         "not write zero for test.");
 
+// 写零时用O_DIRECT绕过page cache，要求文件系统支持O_DIRECT
+DEFINE_bool(writeZeroByDirectIO,
+            false,
+            "write zero with O_DIRECT");
+
+// 每块盘的分配线程数，NVMe盘需要更多的并发才能打满带宽
+DEFINE_uint32(formatThreadNum,
+              2,
+              "number of threads allocating chunks on one disk");
+
+static bool ValidateFormatThreadNum(const char* /*name*/, uint32_t num) {
+    return num > 0;
+}
+
+DEFINE_validator(formatThreadNum, &ValidateFormatThreadNum);
+
+DEFINE_uint32(progressIntervalSec,
+              10,
+              "interval in seconds to print the progress, 0 to disable");
+
 using curve::fs::FileSystemType;
 using curve::fs::LocalFsFactory;
 using curve::fs::FileSystemInfo;
@@ -114,13 +142,30 @@ class CompareInternal {
     }
 };
 
+// 一块盘的格式化任务
+struct FormatTask {
+    std::string fileSystemPath;
+    std::string filePoolDir;
+    std::string filePoolMetaPath;
+
+    // 需要分配的chunk数和已分配的chunk数，用于输出进度
+    uint64_t totalChunks = 0;
+    std::atomic<uint64_t> allocatedChunks{0};
+    // 格式化结束，进度输出线程不再输出该盘
+    std::atomic<bool> finished{false};
+    int result = 0;
+};
+
 struct AllocateStruct {
     std::shared_ptr<LocalFileSystem> fsptr;
     std::atomic<uint64_t>* allocateChunknum;
-    bool* checkwrong;
+    std::atomic<bool>* checkwrong;
     std::mutex* mtx;
     uint64_t chunknum;
     std::string cleanChunkSuffix;
+    std::string filePoolDir;
+    // 已经分配完成的chunk数
+    std::atomic<uint64_t>* allocatedChunks;
 
     // file size + meta page size
     size_t actualFileSize = 0;
@@ -128,11 +173,25 @@ struct AllocateStruct {
 
 static int AllocateFiles(AllocateStruct* allocatestruct) {
     const size_t actualFileSize = allocatestruct->actualFileSize;
-    char* data = new(std::nothrow)char[actualFileSize];
+    const bool directIO = FLAGS_needWriteZero && FLAGS_writeZeroByDirectIO;
+    // O_DIRECT要求buffer按块大小对齐，用4096对齐同时满足512和4096
+    char* data = nullptr;
+    if (posix_memalign(reinterpret_cast<void**>(&data), 4096,
+                       actualFileSize) != 0) {
+        *allocatestruct->checkwrong = true;
+        LOG(ERROR) << "allocate buffer failed, size " << actualFileSize;
+        return -1;
+    }
     memset(data, 0, actualFileSize);
 
+    int flags = O_RDWR | O_CREAT;
+    if (directIO) {
+        // 跳过page cache，避免大量脏页在fsync时集中下刷
+        flags |= O_DIRECT;
+    }
+
     uint64_t count = 0;
-    while (count < allocatestruct->chunknum) {
+    while (count < allocatestruct->chunknum && !*allocatestruct->checkwrong) {
         std::string filename;
         {
             std::unique_lock<std::mutex> lk(*allocatestruct->mtx);
@@ -140,11 +199,10 @@ static int AllocateFiles(AllocateStruct* allocatestruct) {
             filename = std::to_string(
                             allocatestruct->allocateChunknum->load());
         }
-        std::string tmpchunkfilepath = FLAGS_filePoolDir + "/"
+        std::string tmpchunkfilepath = allocatestruct->filePoolDir + "/"
             + filename + allocatestruct->cleanChunkSuffix;
 
-        int ret = allocatestruct->fsptr->Open(tmpchunkfilepath,
-                                             O_RDWR | O_CREAT);
+        int ret = allocatestruct->fsptr->Open(tmpchunkfilepath, flags);
         if (ret < 0) {
             *allocatestruct->checkwrong = true;
             LOG(ERROR) << "file open failed, " << tmpchunkfilepath;
@@ -185,8 +243,9 @@ static int AllocateFiles(AllocateStruct* allocatestruct) {
             break;
         }
         count++;
+        allocatestruct->allocatedChunks->fetch_add(1);
     }
-    delete[] data;
+    free(data);
     return *allocatestruct->checkwrong == true ? 0 : -1;
 }
 
@@ -210,24 +269,7 @@ static bool CanBitmapFitInMetaPage() {
     return bitmapBytes <= kMaximumBitmapBytes;
 }
 
-// TODO(tongguangxun) :添加单元测试
-int main(int argc, char** argv) {
-    google::ParseCommandLineFlags(&argc, &argv, false);
-    google::InitGoogleLogging(argv[0]);
-
-    if (!is_aligned(FLAGS_fileSize, FLAGS_blockSize)) {
-        LOG(ERROR) << "chunk file size doesn't align to block size";
-        return -1;
-    }
-
-    if (!CanBitmapFitInMetaPage()) {
-        LOG(ERROR) << "bitmap can't fit into meta page, chunk size: "
-                   << FLAGS_fileSize << ", block size: " << FLAGS_blockSize
-                   << ", meta page size: "
-                   << curve::chunkserver::kChunkfileMetaPageSize;
-        return -1;
-    }
-
+static int FormatDisk(FormatTask* task) {
     // load current chunkfile pool
     std::mutex mtx;
     auto fsptr = LocalFsFactory::CreateFs(FileSystemType::EXT4, "");
@@ -237,12 +279,12 @@ int main(int argc, char** argv) {
 
     constexpr size_t metaPageSize = curve::chunkserver::kChunkfileMetaPageSize;
 
-    if (fsptr->Mkdir(FLAGS_filePoolDir) < 0) {
-        LOG(ERROR) << "mkdir failed!, " << FLAGS_filePoolDir;
+    if (fsptr->Mkdir(task->filePoolDir) < 0) {
+        LOG(ERROR) << "mkdir failed!, " << task->filePoolDir;
         return -1;
     }
-    if (fsptr->List(FLAGS_filePoolDir, &tmpvec) < 0) {
-        LOG(ERROR) << "list dir failed!, " << FLAGS_filePoolDir;
+    if (fsptr->List(task->filePoolDir, &tmpvec) < 0) {
+        LOG(ERROR) << "list dir failed!, " << task->filePoolDir;
         return -1;
     }
 
@@ -251,19 +293,20 @@ int main(int argc, char** argv) {
     allocateChunknum_.store(size + 1);
 
     FileSystemInfo finfo;
-    int r = fsptr->Statfs(FLAGS_fileSystemPath, &finfo);
+    int r = fsptr->Statfs(task->fileSystemPath, &finfo);
     if (r != 0) {
-        LOG(ERROR) << "get disk usage info failed!";
+        LOG(ERROR) << "get disk usage info failed!, " << task->fileSystemPath;
         return -1;
     }
 
     uint64_t freepercent = finfo.available * 100 / finfo.total;
-    LOG(INFO) << "free space = " << finfo.available
+    LOG(INFO) << task->fileSystemPath
+              << " free space = " << finfo.available
               << ", total space = " << finfo.total
               << ", freepercent = " << freepercent;
 
     if (freepercent < FLAGS_allocatePercent && FLAGS_allocateByPercent) {
-        LOG(ERROR) << "disk free space not enough.";
+        LOG(ERROR) << "disk free space not enough, " << task->fileSystemPath;
         return 0;
     }
 
@@ -275,30 +318,40 @@ int main(int argc, char** argv) {
     } else {
         preAllocateChunkNum = FLAGS_preAllocateNum;
     }
+    task->totalChunks = preAllocateChunkNum;
 
-    bool checkwrong = false;
-    // two threads concurrent, can reach the bandwidth of disk.
-    uint64_t threadAllocateNum = preAllocateChunkNum/2;
-    std::vector<std::thread> thvec;
+    std::atomic<bool> checkwrong(false);
     AllocateStruct allocateStruct;
     allocateStruct.fsptr = fsptr;
     allocateStruct.allocateChunknum = &allocateChunknum_;
     allocateStruct.checkwrong = &checkwrong;
     allocateStruct.mtx = &mtx;
-    allocateStruct.chunknum = threadAllocateNum;
     allocateStruct.cleanChunkSuffix =
         curve::chunkserver::FilePool::GetCleanChunkSuffix();
+    allocateStruct.filePoolDir = task->filePoolDir;
+    allocateStruct.allocatedChunks = &task->allocatedChunks;
     allocateStruct.actualFileSize = FLAGS_fileSize + metaPageSize;
 
-    thvec.push_back(std::thread(AllocateFiles, &allocateStruct));
-    thvec.push_back(std::thread(AllocateFiles, &allocateStruct));
+    // 每个线程分配一部分chunk，余下的分给前面的线程
+    const uint32_t threadNum = FLAGS_formatThreadNum;
+    std::vector<AllocateStruct> allocateStructs(threadNum, allocateStruct);
+    for (uint32_t i = 0; i < threadNum; ++i) {
+        allocateStructs[i].chunknum = preAllocateChunkNum / threadNum +
+                                      (i < preAllocateChunkNum % threadNum ?
+                                       1 : 0);
+    }
+    std::vector<std::thread> thvec;
+    for (auto& as : allocateStructs) {
+        thvec.push_back(std::thread(AllocateFiles, &as));
+    }
 
     for (auto& iter : thvec) {
         iter.join();
     }
 
     if (checkwrong) {
-        LOG(ERROR) << "allocate got something wrong, please check.";
+        LOG(ERROR) << "allocate got something wrong, please check, "
+                   << task->fileSystemPath;
         return -1;
     }
 
@@ -307,9 +360,9 @@ int main(int argc, char** argv) {
     meta.metaPageSize = metaPageSize;
     meta.hasBlockSize = true;
     meta.blockSize = FLAGS_blockSize;
-    meta.filePoolPath = FLAGS_filePoolDir;
+    meta.filePoolPath = task->filePoolDir;
     int ret = curve::chunkserver::FilePoolHelper::PersistEnCodeMetaInfo(
-        fsptr, meta, FLAGS_filePoolMetaPath);
+        fsptr, meta, task->filePoolMetaPath);
 
     if (ret == -1) {
         LOG(ERROR) << "persist chunkfile pool meta info failed!";
@@ -319,10 +372,10 @@ int main(int argc, char** argv) {
     // 读取meta文件，检查是否写入正确
     FilePoolMeta recordMeta;
     ret = curve::chunkserver::FilePoolHelper::DecodeMetaInfoFromMetaFile(
-        fsptr, FLAGS_filePoolMetaPath, 4096, &recordMeta);
+        fsptr, task->filePoolMetaPath, 4096, &recordMeta);
     if (ret == -1) {
         LOG(ERROR) << "chunkfile pool meta info file got something wrong!";
-        fsptr->Delete(FLAGS_filePoolMetaPath);
+        fsptr->Delete(task->filePoolMetaPath);
         return -1;
     }
 
@@ -343,10 +396,10 @@ int main(int argc, char** argv) {
             break;
         }
 
-        if (recordMeta.filePoolPath != FLAGS_filePoolDir) {
+        if (recordMeta.filePoolPath != task->filePoolDir) {
             LOG(ERROR) << "meta info persistency failed!"
                     << ", read chunkpath = " << recordMeta.filePoolPath
-                    << ", real chunkpath = " << FLAGS_filePoolDir;
+                    << ", real chunkpath = " << task->filePoolDir;
             break;
         }
 
@@ -360,3 +413,111 @@ int main(int argc, char** argv) {
 
     return 0;
 }
+
+static void ReportProgress(
+    const std::vector<std::unique_ptr<FormatTask>>& tasks,
+    std::vector<uint64_t>* lastAllocated, double intervalSec) {
+    const uint64_t chunkBytes =
+        FLAGS_fileSize + curve::chunkserver::kChunkfileMetaPageSize;
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        const FormatTask& task = *tasks[i];
+        uint64_t allocated = task.allocatedChunks.load();
+        if (task.totalChunks == 0 ||
+            (task.finished && allocated == (*lastAllocated)[i])) {
+            continue;
+        }
+        double mbps = (allocated - (*lastAllocated)[i]) * chunkBytes /
+                      intervalSec / 1024 / 1024;
+        (*lastAllocated)[i] = allocated;
+        std::cout << task.fileSystemPath << ": " << allocated << "/"
+                  << task.totalChunks << " chunks ("
+                  << allocated * 100 / task.totalChunks << "%), "
+                  << std::fixed << std::setprecision(1) << mbps << " MB/s"
+                  << std::endl;
+    }
+}
+
+// TODO(tongguangxun) :添加单元测试
+int main(int argc, char** argv) {
+    google::ParseCommandLineFlags(&argc, &argv, false);
+    google::InitGoogleLogging(argv[0]);
+
+    if (!is_aligned(FLAGS_fileSize, FLAGS_blockSize)) {
+        LOG(ERROR) << "chunk file size doesn't align to block size";
+        return -1;
+    }
+
+    if (!CanBitmapFitInMetaPage()) {
+        LOG(ERROR) << "bitmap can't fit into meta page, chunk size: "
+                   << FLAGS_fileSize << ", block size: " << FLAGS_blockSize
+                   << ", meta page size: "
+                   << curve::chunkserver::kChunkfileMetaPageSize;
+        return -1;
+    }
+
+    // 多块盘用逗号分隔，每块盘的三个路径一一对应
+    std::vector<std::string> fsPaths;
+    std::vector<std::string> poolDirs;
+    std::vector<std::string> metaPaths;
+    curve::common::SplitString(FLAGS_fileSystemPath, ",", &fsPaths);
+    curve::common::SplitString(FLAGS_filePoolDir, ",", &poolDirs);
+    curve::common::SplitString(FLAGS_filePoolMetaPath, ",", &metaPaths);
+    if (fsPaths.empty() || fsPaths.size() != poolDirs.size() ||
+        fsPaths.size() != metaPaths.size()) {
+        LOG(ERROR) << "fileSystemPath, filePoolDir and filePoolMetaPath "
+                   << "must have the same number of paths";
+        return -1;
+    }
+
+    std::vector<std::unique_ptr<FormatTask>> tasks;
+    for (size_t i = 0; i < fsPaths.size(); ++i) {
+        tasks.emplace_back(new FormatTask());
+        tasks.back()->fileSystemPath = fsPaths[i];
+        tasks.back()->filePoolDir = poolDirs[i];
+        tasks.back()->filePoolMetaPath = metaPaths[i];
+    }
+
+    // 各盘并发格式化
+    std::atomic<uint32_t> running(tasks.size());
+    std::vector<std::thread> diskThreads;
+    for (auto& task : tasks) {
+        FormatTask* t = task.get();
+        diskThreads.push_back(std::thread([t, &running]() {
+            t->result = FormatDisk(t);
+            t->finished = true;
+            --running;
+        }));
+    }
+
+    // 定期输出每块盘的进度和吞吐
+    std::vector<uint64_t> lastAllocated(tasks.size(), 0);
+    auto lastReport = std::chrono::steady_clock::now();
+    while (running > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        auto now = std::chrono::steady_clock::now();
+        double elapsed =
+            std::chrono::duration<double>(now - lastReport).count();
+        if (FLAGS_progressIntervalSec > 0 &&
+            elapsed >= FLAGS_progressIntervalSec) {
+            ReportProgress(tasks, &lastAllocated, elapsed);
+            lastReport = now;
+        }
+    }
+    for (auto& iter : diskThreads) {
+        iter.join();
+    }
+    if (FLAGS_progressIntervalSec > 0) {
+        double elapsed = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - lastReport).count();
+        ReportProgress(tasks, &lastAllocated, elapsed);
+    }
+
+    int ret = 0;
+    for (const auto& task : tasks) {
+        if (task->result != 0) {
+            LOG(ERROR) << "format " << task->fileSystemPath << " failed";
+            ret = -1;
+        }
+    }
+    return ret;
+}
@@ -32,6 +32,8 @@ DEFINE_string(etcdAddr, "127.0.0.1:2379", "etcd addr");
 DEFINE_uint64(rpcTimeout, 3000, "millisecond for rpc timeout");
 DEFINE_uint64(rpcRetryTimes, 5, "rpc retry times");
 DEFINE_uint64(rpcConcurrentNum, 10, "rpc concurrent number to chunkserver");
+DEFINE_uint32(listDirPageSize, 1000, "max number of files listed by one rpc, "
+                                     "0 means list all files at once");
 DEFINE_string(snapshotCloneAddr, "", "snapshot clone addr");
 DEFINE_string(snapshotCloneDummyPort, "", "dummy port of snapshot clone, "
                                     "can specify one or several. "
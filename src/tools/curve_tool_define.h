@@ -102,6 +102,7 @@ const char kSnapshotMeta[] = "snapshot-meta";
 
 // raft log相关命令
 const char kRaftLogMeta[] = "raft-log-meta";
+const char kRaftLogStat[] = "raft-log-stat";
 
 const char kOffline[] = "offline";
 const char kVars[] = "/vars/";
@@ -0,0 +1,236 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * fio的外部ioengine, 直接通过libcurve的AioRead/AioWrite读写卷, 例如:
+ *
+ *   [global]
+ *   ioengine=external:/path/to/libfio_curve.so
+ *   curve_conf=/etc/curve/client.conf
+ *   thread=1
+ *   direct=1
+ *   bs=4k
+ *   iodepth=128
+ *   rw=randwrite
+ *
+ *   [volume]
+ *   filename=/test_userinfo_
+ *
+ * filename是Open4Qemu格式的带用户信息的文件名, 其中的':'需要写成'\:'
+ */
+
+#include <errno.h>
+
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "include/client/libcurve.h"
+#include "src/tools/fio/fio_engine_common.h"
+
+namespace curve {
+namespace tool {
+namespace fio {
+
+namespace {
+
+std::mutex initMutex;
+// 同一进程中的fio线程共享一个libcurve实例
+int initCount = 0;
+
+struct CurveIoCtx {
+    // 必须是第一个成员, 回调中由aioctx得到CurveIoCtx
+    CurveAioContext aioctx;
+    struct io_u* io;
+    Completions* completions;
+};
+
+int InitLibCurve(const char* conf) {
+    std::lock_guard<std::mutex> lk(initMutex);
+    if (initCount == 0 && Init(conf) != 0) {
+        log_err("fio_curve: init libcurve with %s failed\n", conf);
+        return -1;
+    }
+    initCount++;
+    return 0;
+}
+
+void UnInitLibCurve() {
+    std::lock_guard<std::mutex> lk(initMutex);
+    if (--initCount == 0) {
+        UnInit();
+    }
+}
+
+void CurveCallback(CurveAioContext* aioctx) {
+    auto* ctx = reinterpret_cast<CurveIoCtx*>(aioctx);
+    struct io_u* io = ctx->io;
+    Completions* completions = ctx->completions;
+    io->error = aioctx->ret < 0 ? EIO : 0;
+    delete ctx;
+    completions->Push(io);
+}
+
+int CurveSetup(struct thread_data* td) {
+    // libcurve的bthread等后台线程不能跨fork使用
+    if (!td->o.use_thread) {
+        log_err("fio_curve: thread=1 is required\n");
+        return 1;
+    }
+
+    auto* options = static_cast<EngineOptions*>(td->eo);
+    if (InitLibCurve(options->conf) != 0) {
+        return 1;
+    }
+
+    struct fio_file* f;
+    unsigned int i;
+    for_each_file(td, f, i) {
+        FileStatInfo info;
+        if (StatFile4Qemu(f->file_name, &info) != 0) {
+            log_err("fio_curve: stat %s failed\n", f->file_name);
+            UnInitLibCurve();
+            return 1;
+        }
+        f->real_file_size = info.length;
+        fio_file_set_size_known(f);
+    }
+    return 0;
+}
+
+int CurveInit(struct thread_data* td) {
+    td->io_ops_data = new Completions();
+    return 0;
+}
+
+void CurveCleanup(struct thread_data* td) {
+    auto* completions = static_cast<Completions*>(td->io_ops_data);
+    if (completions != nullptr) {
+        delete completions;
+        td->io_ops_data = nullptr;
+        UnInitLibCurve();
+    }
+}
+
+int CurveOpenFile(struct thread_data* td, struct fio_file* f) {
+    int fd = Open4Qemu(f->file_name);
+    if (fd < 0) {
+        log_err("fio_curve: open %s failed, ret %d\n", f->file_name, fd);
+        td_verror(td, EIO, "open");
+        return 1;
+    }
+    f->fd = fd;
+    return 0;
+}
+
+int CurveCloseFile(struct thread_data* td, struct fio_file* f) {
+    int ret = Close(f->fd);
+    f->fd = -1;
+    return ret == 0 ? 0 : 1;
+}
+
+enum fio_q_status CurveQueue(struct thread_data* td, struct io_u* io) {
+    fio_ro_check(td, io);
+
+    int (*submit)(int, CurveAioContext*) = nullptr;
+    LIBCURVE_OP op = LIBCURVE_OP_MAX;
+    switch (io->ddir) {
+        case DDIR_READ:
+            submit = AioRead;
+            op = LIBCURVE_OP_READ;
+            break;
+        case DDIR_WRITE:
+            submit = AioWrite;
+            op = LIBCURVE_OP_WRITE;
+            break;
+        case DDIR_TRIM:
+            submit = AioDiscard;
+            op = LIBCURVE_OP_DISCARD;
+            break;
+        case DDIR_SYNC:
+        case DDIR_DATASYNC:
+            // libcurve没有写缓存, 写请求返回时已经持久化
+            io->error = 0;
+            return FIO_Q_COMPLETED;
+        default:
+            io->error = EINVAL;
+            return FIO_Q_COMPLETED;
+    }
+
+    auto* ctx = new CurveIoCtx();
+    ctx->aioctx.offset = io->offset;
+    ctx->aioctx.length = io->xfer_buflen;
+    ctx->aioctx.op = op;
+    ctx->aioctx.cb = CurveCallback;
+    ctx->aioctx.buf = io->xfer_buf;
+    ctx->io = io;
+    ctx->completions = static_cast<Completions*>(td->io_ops_data);
+
+    int ret = submit(io->file->fd, &ctx->aioctx);
+    if (ret != LIBCURVE_ERROR::OK) {
+        delete ctx;
+        io->error = EIO;
+        return FIO_Q_COMPLETED;
+    }
+    return FIO_Q_QUEUED;
+}
+
+int CurveGetEvents(struct thread_data* td, unsigned int min,
+                   unsigned int max, const struct timespec* t) {
+    return static_cast<Completions*>(td->io_ops_data)->Reap(min, max, t);
+}
+
+struct io_u* CurveEvent(struct thread_data* td, int event) {
+    return static_cast<Completions*>(td->io_ops_data)->Event(event);
+}
+
+struct ioengine_ops* MakeCurveEngine() {
+    static std::vector<struct fio_option> options = MakeEngineOptions(
+        "curve_conf", "Path of the libcurve client config",
+        "/etc/curve/client.conf");
+
+    static struct ioengine_ops engine;
+    engine.name = "curve";
+    engine.version = FIO_IOOPS_VERSION;
+    engine.flags = FIO_DISKLESSIO | FIO_NODISKUTIL | FIO_NOEXTEND;
+    engine.setup = CurveSetup;
+    engine.init = CurveInit;
+    engine.cleanup = CurveCleanup;
+    engine.open_file = CurveOpenFile;
+    engine.close_file = CurveCloseFile;
+    engine.queue = CurveQueue;
+    engine.getevents = CurveGetEvents;
+    engine.event = CurveEvent;
+    engine.options = options.data();
+    engine.option_struct_size = sizeof(EngineOptions);
+    return &engine;
+}
+
+}  // namespace
+
+}  // namespace fio
+}  // namespace tool
+}  // namespace curve
+
+extern "C" {
+
+// fio加载外部ioengine时查找的符号
+void get_ioengine(struct ioengine_ops** ops) {
+    static struct ioengine_ops* engine =
+        curve::tool::fio::MakeCurveEngine();
+    *ops = engine;
+}
+
+}  // extern "C"
@@ -0,0 +1,115 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_TOOLS_FIO_FIO_ENGINE_COMMON_H_
+#define SRC_TOOLS_FIO_FIO_ENGINE_COMMON_H_
+
+extern "C" {
+#include "fio.h"        // NOLINT
+#include "optgroup.h"   // NOLINT
+}
+
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <mutex>               // NOLINT
+#include <vector>
+
+namespace curve {
+namespace tool {
+namespace fio {
+
+// ioengine的选项, fio要求第一个成员是指针
+struct EngineOptions {
+    void* pad;
+    char* conf;
+};
+
+/**
+ * 异步完成的请求队列, 回调线程放入完成的io_u, fio线程在getevents中取出
+ */
+class Completions {
+ public:
+    void Push(struct io_u* io) {
+        std::lock_guard<std::mutex> lk(mtx_);
+        done_.push_back(io);
+        cond_.notify_one();
+    }
+
+    /**
+     * @brief 等待至少min个请求完成, 最多取出max个
+     * @param t 最长的等待时间, nullptr表示一直等待
+     * @return 取出的请求数, 通过Event获取
+     */
+    int Reap(unsigned int min, unsigned int max, const struct timespec* t) {
+        std::unique_lock<std::mutex> lk(mtx_);
+        auto ready = [this, min]() { return done_.size() >= min; };
+        if (t == nullptr) {
+            cond_.wait(lk, ready);
+        } else {
+            cond_.wait_for(lk, std::chrono::seconds(t->tv_sec) +
+                                   std::chrono::nanoseconds(t->tv_nsec),
+                           ready);
+        }
+
+        events_.clear();
+        while (!done_.empty() && events_.size() < max) {
+            events_.push_back(done_.front());
+            done_.pop_front();
+        }
+        return static_cast<int>(events_.size());
+    }
+
+    struct io_u* Event(int index) const {
+        return events_[index];
+    }
+
+ private:
+    std::mutex mtx_;
+    std::condition_variable cond_;
+    std::deque<struct io_u*> done_;
+    // 只在fio线程中访问
+    std::vector<struct io_u*> events_;
+};
+
+/**
+ * @brief 生成ioengine的选项定义, 以NULL name结尾
+ * @param confName 配置文件选项的名字
+ * @param confHelp 配置文件选项的说明
+ * @param defaultConf 默认的配置文件路径
+ */
+inline std::vector<struct fio_option> MakeEngineOptions(
+    const char* confName, const char* confHelp, const char* defaultConf) {
+    std::vector<struct fio_option> options(2);
+    memset(options.data(), 0, sizeof(struct fio_option) * options.size());
+    options[0].name = confName;
+    options[0].lname = confName;
+    options[0].type = FIO_OPT_STR_STORE;
+    options[0].off1 = offsetof(struct EngineOptions, conf);
+    options[0].def = defaultConf;
+    options[0].help = confHelp;
+    options[0].category = FIO_OPT_C_ENGINE;
+    options[0].group = FIO_OPT_G_INVALID;
+    return options;
+}
+
+}  // namespace fio
+}  // namespace tool
+}  // namespace curve
+
+#endif  // SRC_TOOLS_FIO_FIO_ENGINE_COMMON_H_
@@ -0,0 +1,242 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * fio的外部ioengine, 通过libnebd读写nebd-server打开的卷, 和qemu的路径相同,
+ * 例如:
+ *
+ *   [global]
+ *   ioengine=external:/path/to/libfio_nebd.so
+ *   nebd_conf=/etc/nebd/nebd-client.conf
+ *   thread=1
+ *   direct=1
+ *   bs=4k
+ *   iodepth=128
+ *   rw=randwrite
+ *
+ *   [volume]
+ *   filename=cbd\:pool//test_userinfo_
+ */
+
+#include <errno.h>
+
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "nebd/src/part1/libnebd.h"
+#include "src/tools/fio/fio_engine_common.h"
+
+namespace curve {
+namespace tool {
+namespace fio {
+
+namespace {
+
+std::mutex initMutex;
+// 同一进程中的fio线程共享一个libnebd实例
+int initCount = 0;
+
+struct NebdIoCtx {
+    // 必须是第一个成员, 回调中由aioctx得到NebdIoCtx
+    NebdClientAioContext aioctx;
+    struct io_u* io;
+    Completions* completions;
+};
+
+int InitLibNebd(const char* conf) {
+    std::lock_guard<std::mutex> lk(initMutex);
+    if (initCount == 0 && nebd_lib_init_with_conf(conf) != 0) {
+        log_err("fio_nebd: init libnebd with %s failed\n", conf);
+        return -1;
+    }
+    initCount++;
+    return 0;
+}
+
+void UnInitLibNebd() {
+    std::lock_guard<std::mutex> lk(initMutex);
+    if (--initCount == 0) {
+        nebd_lib_uninit();
+    }
+}
+
+void NebdCallback(NebdClientAioContext* aioctx) {
+    auto* ctx = reinterpret_cast<NebdIoCtx*>(aioctx);
+    struct io_u* io = ctx->io;
+    Completions* completions = ctx->completions;
+    io->error = aioctx->ret < 0 ? EIO : 0;
+    delete ctx;
+    completions->Push(io);
+}
+
+int NebdSetup(struct thread_data* td) {
+    // libnebd的后台线程不能跨fork使用
+    if (!td->o.use_thread) {
+        log_err("fio_nebd: thread=1 is required\n");
+        return 1;
+    }
+
+    auto* options = static_cast<EngineOptions*>(td->eo);
+    return InitLibNebd(options->conf) == 0 ? 0 : 1;
+}
+
+int NebdInit(struct thread_data* td) {
+    td->io_ops_data = new Completions();
+    return 0;
+}
+
+void NebdCleanup(struct thread_data* td) {
+    auto* completions = static_cast<Completions*>(td->io_ops_data);
+    if (completions != nullptr) {
+        delete completions;
+        td->io_ops_data = nullptr;
+        UnInitLibNebd();
+    }
+}
+
+int NebdOpenFile(struct thread_data* td, struct fio_file* f) {
+    int fd = nebd_lib_open(f->file_name);
+    if (fd < 0) {
+        log_err("fio_nebd: open %s failed, ret %d\n", f->file_name, fd);
+        td_verror(td, EIO, "open");
+        return 1;
+    }
+    f->fd = fd;
+    return 0;
+}
+
+int NebdCloseFile(struct thread_data* td, struct fio_file* f) {
+    int ret = nebd_lib_close(f->fd);
+    f->fd = -1;
+    return ret == 0 ? 0 : 1;
+}
+
+// 卷的大小要打开之后才能获取
+int NebdGetFileSize(struct thread_data* td, struct fio_file* f) {
+    if (fio_file_size_known(f)) {
+        return 0;
+    }
+    int fd = nebd_lib_open(f->file_name);
+    if (fd < 0) {
+        log_err("fio_nebd: open %s failed, ret %d\n", f->file_name, fd);
+        return 1;
+    }
+    int64_t size = nebd_lib_filesize(fd);
+    nebd_lib_close(fd);
+    if (size < 0) {
+        log_err("fio_nebd: get size of %s failed\n", f->file_name);
+        return 1;
+    }
+    f->real_file_size = size;
+    fio_file_set_size_known(f);
+    return 0;
+}
+
+enum fio_q_status NebdQueue(struct thread_data* td, struct io_u* io) {
+    fio_ro_check(td, io);
+
+    int (*submit)(int, NebdClientAioContext*) = nullptr;
+    LIBAIO_OP op = LIBAIO_OP_READ;
+    switch (io->ddir) {
+        case DDIR_READ:
+            submit = nebd_lib_aio_pread;
+            op = LIBAIO_OP_READ;
+            break;
+        case DDIR_WRITE:
+            submit = nebd_lib_aio_pwrite;
+            op = LIBAIO_OP_WRITE;
+            break;
+        case DDIR_TRIM:
+            submit = nebd_lib_discard;
+            op = LIBAIO_OP_DISCARD;
+            break;
+        case DDIR_SYNC:
+        case DDIR_DATASYNC:
+            submit = nebd_lib_flush;
+            op = LIBAIO_OP_FLUSH;
+            break;
+        default:
+            io->error = EINVAL;
+            return FIO_Q_COMPLETED;
+    }
+
+    auto* ctx = new NebdIoCtx();
+    ctx->aioctx.offset = io->offset;
+    ctx->aioctx.length = io->xfer_buflen;
+    ctx->aioctx.op = op;
+    ctx->aioctx.cb = NebdCallback;
+    ctx->aioctx.buf = io->xfer_buf;
+    ctx->aioctx.retryCount = 0;
+    ctx->io = io;
+    ctx->completions = static_cast<Completions*>(td->io_ops_data);
+
+    int ret = submit(io->file->fd, &ctx->aioctx);
+    if (ret != 0) {
+        delete ctx;
+        io->error = EIO;
+        return FIO_Q_COMPLETED;
+    }
+    return FIO_Q_QUEUED;
+}
+
+int NebdGetEvents(struct thread_data* td, unsigned int min,
+                  unsigned int max, const struct timespec* t) {
+    return static_cast<Completions*>(td->io_ops_data)->Reap(min, max, t);
+}
+
+struct io_u* NebdEvent(struct thread_data* td, int event) {
+    return static_cast<Completions*>(td->io_ops_data)->Event(event);
+}
+
+struct ioengine_ops* MakeNebdEngine() {
+    static std::vector<struct fio_option> options = MakeEngineOptions(
+        "nebd_conf", "Path of the libnebd client config",
+        "/etc/nebd/nebd-client.conf");
+
+    static struct ioengine_ops engine;
+    engine.name = "nebd";
+    engine.version = FIO_IOOPS_VERSION;
+    engine.flags = FIO_DISKLESSIO | FIO_NODISKUTIL | FIO_NOEXTEND;
+    engine.setup = NebdSetup;
+    engine.init = NebdInit;
+    engine.cleanup = NebdCleanup;
+    engine.open_file = NebdOpenFile;
+    engine.close_file = NebdCloseFile;
+    engine.get_file_size = NebdGetFileSize;
+    engine.queue = NebdQueue;
+    engine.getevents = NebdGetEvents;
+    engine.event = NebdEvent;
+    engine.options = options.data();
+    engine.option_struct_size = sizeof(EngineOptions);
+    return &engine;
+}
+
+}  // namespace
+
+}  // namespace fio
+}  // namespace tool
+}  // namespace curve
+
+extern "C" {
+
+// fio加载外部ioengine时查找的符号
+void get_ioengine(struct ioengine_ops** ops) {
+    static struct ioengine_ops* engine =
+        curve::tool::fio::MakeNebdEngine();
+    *ops = engine;
+}
+
+}  // extern "C"
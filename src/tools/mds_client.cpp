@@ -23,6 +23,7 @@
 
 DECLARE_uint64(rpcTimeout);
 DECLARE_uint64(rpcRetryTimes);
+DECLARE_uint32(listDirPageSize);
 
 namespace curve {
 namespace tool {
@@ -189,27 +190,36 @@ int MDSClient::ListDir(const std::string& dirName,
         std::cout << "The argument is a null pointer!" << std::endl;
         return -1;
     }
-    curve::mds::ListDirRequest request;
-    curve::mds::ListDirResponse response;
-    request.set_filename(dirName);
-    FillUserInfo(&request);
     curve::mds::CurveFSService_Stub stub(&channel_);
-
     auto fp = &curve::mds::CurveFSService_Stub::ListDir;
-    if (SendRpcToMds(&request, &response, &stub, fp) != 0) {
-        std::cout << "ListDir from all mds fail!" << std::endl;
-        return -1;
-    }
-    if (response.has_statuscode() &&
-                response.statuscode() == StatusCode::kOK) {
+    std::string pageToken;
+    do {
+        curve::mds::ListDirRequest request;
+        curve::mds::ListDirResponse response;
+        request.set_filename(dirName);
+        if (FLAGS_listDirPageSize > 0) {
+            request.set_pagesize(FLAGS_listDirPageSize);
+            request.set_pagetoken(pageToken);
+        }
+        FillUserInfo(&request);
+
+        if (SendRpcToMds(&request, &response, &stub, fp) != 0) {
+            std::cout << "ListDir from all mds fail!" << std::endl;
+            return -1;
+        }
+        if (!response.has_statuscode() ||
+                response.statuscode() != StatusCode::kOK) {
+            std::cout << "ListDir fail with errCode: "
+                      << response.statuscode() << std::endl;
+            return -1;
+        }
         for (int i = 0; i < response.fileinfo_size(); ++i) {
             files->emplace_back(response.fileinfo(i));
         }
-        return 0;
-    }
-    std::cout << "ListDir fail with errCode: " << response.statuscode()
-              << std::endl;
-    return -1;
+        // mds which does not support paging returns all files at once
+        pageToken = response.nextpagetoken();
+    } while (!pageToken.empty());
+    return 0;
 }
 
 GetSegmentRes MDSClient::GetSegmentInfo(const std::string& fileName,
@@ -126,6 +126,19 @@ inline std::string GetUseChunkFilePoolAsWalPoolName(const std::string& csAddr) {
     return metricName;
 }
 
+// 请求各阶段的延时, opName为read或write, stage为queue, commit,
+// apply_queue或store, 见chunkserver的StageMetric
+inline std::string GetCSStageLatencyName(const std::string& csAddr,
+                                         const std::string& opName,
+                                         const std::string& stage,
+                                         const std::string& suffix) {
+    std::string tmpName = kChunkServerMetricPrefix + csAddr + "_" +
+                        opName + "_stage_" + stage + "_lat_" + suffix;
+    std::string metricName;
+    bvar::to_underscored_name(&metricName, tmpName);
+    return metricName;
+}
+
 inline std::string GetOpNumMetricName(const std::string& opName) {
     std::string tmpName = kSechduleOpMetricpPrefix +
                                 opName + "_num";
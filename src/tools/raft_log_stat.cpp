@@ -0,0 +1,417 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/tools/raft_log_stat.h"
+
+#include <braft/enum.pb.h>
+#include <butil/raw_pack.h>
+#include <butil/sys_byteorder.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <tuple>
+#include <utility>
+
+#include "proto/chunk.pb.h"
+#include "src/chunkserver/raftlog/define.h"
+#include "src/common/concurrent/concurrent.h"
+#include "src/tools/raft_log_tool.h"
+
+namespace curve {
+namespace tool {
+
+using curve::chunkserver::ChunkRequest;
+using curve::chunkserver::CHUNK_OP_TYPE;
+using curve::common::Thread;
+
+namespace {
+
+uint64_t RoundUpPowerOf2(uint64_t n) {
+    uint64_t v = 1;
+    while (v < n) {
+        v <<= 1;
+    }
+    return v;
+}
+
+std::string FormatTime(time_t t) {
+    struct tm tm;
+    char buf[32];
+    localtime_r(&t, &tm);
+    strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+    return buf;
+}
+
+std::string EntryTypeName(int type) {
+    if (braft::EntryType_IsValid(type)) {
+        return braft::EntryType_Name(static_cast<braft::EntryType>(type));
+    }
+    return "UNKNOWN(" + std::to_string(type) + ")";
+}
+
+std::string OpTypeName(int type) {
+    if (curve::chunkserver::CHUNK_OP_TYPE_IsValid(type)) {
+        return curve::chunkserver::CHUNK_OP_TYPE_Name(
+            static_cast<CHUNK_OP_TYPE>(type));
+    }
+    return "UNKNOWN(" + std::to_string(type) + ")";
+}
+
+std::string Percent(uint64_t n, uint64_t total) {
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(2)
+       << (total == 0 ? 0.0 : 100.0 * n / total) << "%";
+    return os.str();
+}
+
+}  // namespace
+
+bool ChunkKey::operator<(const ChunkKey& rhs) const {
+    return std::tie(logicPoolId, copysetId, chunkId) <
+           std::tie(rhs.logicPoolId, rhs.copysetId, rhs.chunkId);
+}
+
+void RaftLogStatistics::Merge(const RaftLogStatistics& other) {
+    entryCount += other.entryCount;
+    bytes += other.bytes;
+    dataBytes += other.dataBytes;
+    badDataCount += other.badDataCount;
+    for (const auto& item : other.entryTypes) {
+        entryTypes[item.first] += item.second;
+    }
+    for (const auto& item : other.opTypes) {
+        opTypes[item.first] += item.second;
+    }
+    for (const auto& item : other.opBytes) {
+        opBytes[item.first] += item.second;
+    }
+    for (const auto& item : other.sizeHistogram) {
+        sizeHistogram[item.first] += item.second;
+    }
+    for (const auto& item : other.chunkHeat) {
+        ChunkHeat& heat = chunkHeat[item.first];
+        heat.writeCount += item.second.writeCount;
+        heat.writeBytes += item.second.writeBytes;
+    }
+    segments.insert(segments.end(), other.segments.begin(),
+                    other.segments.end());
+}
+
+bool RaftLogStat::ParseSegmentName(const std::string& fileName,
+                                   int64_t* firstIndex, bool* curveFormat) {
+    std::string name = fileName;
+    auto pos = fileName.find_last_of("/");
+    if (pos != std::string::npos) {
+        name = fileName.substr(pos + 1);
+    }
+    int64_t lastIndex = 0;
+    const char* str = name.c_str();
+    if (sscanf(str, CURVE_SEGMENT_CLOSED_PATTERN,
+               firstIndex, &lastIndex) == 2 ||
+        sscanf(str, CURVE_SEGMENT_OPEN_PATTERN, firstIndex) == 1) {
+        *curveFormat = true;
+        return true;
+    }
+    if (sscanf(str, BRAFT_SEGMENT_CLOSED_PATTERN,
+               firstIndex, &lastIndex) == 2 ||
+        sscanf(str, BRAFT_SEGMENT_OPEN_PATTERN, firstIndex) == 1) {
+        *curveFormat = false;
+        return true;
+    }
+    return false;
+}
+
+int RaftLogStat::Stat(const std::string& path, RaftLogStatistics* stat) {
+    std::vector<std::string> files;
+    int64_t firstIndex;
+    bool curveFormat;
+    if (localFS_->DirExists(path)) {
+        std::vector<std::string> names;
+        if (localFS_->List(path, &names) != 0) {
+            std::cout << "List dir " << path << " fail" << std::endl;
+            return -1;
+        }
+        for (const auto& name : names) {
+            if (ParseSegmentName(name, &firstIndex, &curveFormat)) {
+                files.emplace_back(path + "/" + name);
+            }
+        }
+    } else if (ParseSegmentName(path, &firstIndex, &curveFormat)) {
+        files.emplace_back(path);
+    } else {
+        std::cout << path << " is neither a raft log dir"
+                  << " nor a raft segment!" << std::endl;
+        return -1;
+    }
+
+    // 每个线程统计到自己的结果中，最后再合并
+    const uint32_t threadNum = std::max<uint32_t>(
+        1, std::min<uint32_t>(threadNum_, files.size()));
+    std::vector<RaftLogStatistics> results(threadNum);
+    std::atomic<size_t> next(0);
+    std::atomic<bool> failed(false);
+    std::vector<Thread> threads;
+    for (uint32_t i = 0; i < threadNum; ++i) {
+        RaftLogStatistics* result = &results[i];
+        threads.emplace_back([&, result]() {
+            size_t n;
+            while ((n = next.fetch_add(1)) < files.size()) {
+                if (StatSegment(files[n], result) != 0) {
+                    failed = true;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (const auto& result : results) {
+        stat->Merge(result);
+    }
+    std::sort(stat->segments.begin(), stat->segments.end(),
+              [](const SegmentStat& a, const SegmentStat& b) {
+                  return a.firstIndex < b.firstIndex;
+              });
+    return failed ? -1 : 0;
+}
+
+int RaftLogStat::StatSegment(const std::string& fileName,
+                             RaftLogStatistics* stat) {
+    SegmentStat segment;
+    bool curveFormat = false;
+    segment.fileName = fileName;
+    ParseSegmentName(fileName, &segment.firstIndex, &curveFormat);
+
+    int fd = localFS_->Open(fileName, O_RDONLY);
+    if (fd < 0) {
+        std::cout << "Fail to open " << fileName << std::endl;
+        return -1;
+    }
+    struct stat st;
+    if (localFS_->Fstat(fd, &st) != 0) {
+        std::cout << "Fail to get the stat of " << fileName << std::endl;
+        localFS_->Close(fd);
+        return -1;
+    }
+    segment.mtime = st.st_mtime;
+    const size_t fileLen = st.st_size;
+    if (fileLen == 0) {
+        localFS_->Close(fd);
+        stat->segments.push_back(segment);
+        return 0;
+    }
+
+    void* addr = mmap(nullptr, fileLen, PROT_READ, MAP_PRIVATE, fd, 0);
+    localFS_->Close(fd);
+    if (addr == MAP_FAILED) {
+        std::cout << "Fail to mmap " << fileName << ", "
+                  << strerror(errno) << std::endl;
+        return -1;
+    }
+    madvise(addr, fileLen, MADV_SEQUENTIAL);
+    const char* base = static_cast<const char*>(addr);
+
+    size_t off = 0;
+    size_t end = fileLen;
+    if (curveFormat) {
+        // curve segment由walfilepool预分配，meta page中记录了写入的字节数
+        int64_t bytes = 0;
+        if (fileLen >= metaPageSize_) {
+            memcpy(&bytes, base, sizeof(bytes));
+        }
+        off = metaPageSize_;
+        end = std::min<size_t>(std::max<int64_t>(bytes, 0), fileLen);
+    }
+    bool ok = ParseEntries(base, off, end, curveFormat, &segment, stat);
+    munmap(addr, fileLen);
+    stat->segments.push_back(segment);
+    return ok ? 0 : -1;
+}
+
+bool RaftLogStat::ParseEntries(const char* base, size_t off, size_t end,
+                               bool curveFormat, SegmentStat* segment,
+                               RaftLogStatistics* stat) {
+    const size_t headerSize =
+        curveFormat ? curve::chunkserver::kEntryHeaderSize : ENTRY_HEADER_SIZE;
+    while (off < end) {
+        if (end - off < headerSize) {
+            segment->truncated = true;
+            break;
+        }
+        const char* p = base + off;
+        int64_t term = 0;
+        uint32_t metaField = 0;
+        uint32_t dataLen = 0;
+        uint32_t dataRealLen = 0;
+        uint32_t dataChecksum = 0;
+        uint32_t headerChecksum = 0;
+        butil::RawUnpacker unpacker(p);
+        unpacker.unpack64((uint64_t&)term)
+                .unpack32(metaField)
+                .unpack32(dataLen);
+        if (curveFormat) {
+            unpacker.unpack32(dataRealLen);
+        } else {
+            dataRealLen = dataLen;
+        }
+        unpacker.unpack32(dataChecksum)
+                .unpack32(headerChecksum);
+        const int type = metaField >> 24;
+        const int checksumType = (metaField << 8) >> 24;
+        if (!VerifyCheckSum(checksumType, p, headerSize - 4,
+                            headerChecksum)) {
+            std::cout << "Found corrupted header in " << segment->fileName
+                      << " at offset=" << off << std::endl;
+            segment->corrupted = true;
+            return false;
+        }
+        if (dataRealLen > dataLen || end - off - headerSize < dataLen) {
+            segment->truncated = true;
+            break;
+        }
+
+        const uint64_t entrySize = headerSize + dataLen;
+        segment->entryCount++;
+        segment->bytes += entrySize;
+        stat->entryCount++;
+        stat->bytes += entrySize;
+        stat->dataBytes += dataRealLen;
+        stat->entryTypes[type]++;
+        stat->sizeHistogram[RoundUpPowerOf2(entrySize)]++;
+        if (type == braft::ENTRY_TYPE_DATA) {
+            StatEntryData(p + headerSize, dataRealLen, stat);
+        }
+        off += entrySize;
+    }
+    return true;
+}
+
+void RaftLogStat::StatEntryData(const char* data, uint32_t len,
+                                RaftLogStatistics* stat) {
+    // 格式与ChunkOpRequest::Encode一致：request长度 + request + 数据
+    uint32_t metaSize = 0;
+    if (len < sizeof(metaSize)) {
+        stat->badDataCount++;
+        return;
+    }
+    memcpy(&metaSize, data, sizeof(metaSize));
+    metaSize = butil::NetToHost32(metaSize);
+    if (metaSize > len - sizeof(metaSize)) {
+        stat->badDataCount++;
+        return;
+    }
+    ChunkRequest request;
+    if (!request.ParseFromArray(data + sizeof(metaSize), metaSize)) {
+        stat->badDataCount++;
+        return;
+    }
+    const uint64_t payload = len - sizeof(metaSize) - metaSize;
+    stat->opTypes[request.optype()]++;
+    stat->opBytes[request.optype()] += payload;
+    if (request.optype() == CHUNK_OP_TYPE::CHUNK_OP_WRITE) {
+        ChunkKey key{request.logicpoolid(), request.copysetid(),
+                     request.chunkid()};
+        ChunkHeat& heat = stat->chunkHeat[key];
+        heat.writeCount++;
+        heat.writeBytes += payload;
+    }
+}
+
+void RaftLogStat::Print(const RaftLogStatistics& stat, uint32_t topN,
+                        std::ostream& os) {
+    os << "segments: " << stat.segments.size()
+       << ", entries: " << stat.entryCount
+       << ", bytes: " << stat.bytes
+       << ", data bytes: " << stat.dataBytes
+       << ", avg entry bytes: "
+       << (stat.entryCount == 0 ? 0 : stat.bytes / stat.entryCount)
+       << std::endl;
+    if (stat.badDataCount > 0) {
+        os << "entries fail to decode: " << stat.badDataCount << std::endl;
+    }
+
+    os << std::endl << "entry types:" << std::endl;
+    for (const auto& item : stat.entryTypes) {
+        os << "  " << EntryTypeName(item.first) << ": " << item.second
+           << " (" << Percent(item.second, stat.entryCount) << ")"
+           << std::endl;
+    }
+
+    os << std::endl << "op types:" << std::endl;
+    for (const auto& item : stat.opTypes) {
+        auto iter = stat.opBytes.find(item.first);
+        os << "  " << OpTypeName(item.first) << ": " << item.second
+           << ", data bytes: "
+           << (iter == stat.opBytes.end() ? 0 : iter->second) << std::endl;
+    }
+
+    os << std::endl << "entry size distribution:" << std::endl;
+    for (const auto& item : stat.sizeHistogram) {
+        os << "  <= " << item.first << ": " << item.second
+           << " (" << Percent(item.second, stat.entryCount) << ")"
+           << std::endl;
+    }
+
+    std::vector<std::pair<ChunkKey, ChunkHeat>> heats(
+        stat.chunkHeat.begin(), stat.chunkHeat.end());
+    const size_t n = std::min<size_t>(topN, heats.size());
+    std::partial_sort(heats.begin(), heats.begin() + n, heats.end(),
+        [](const std::pair<ChunkKey, ChunkHeat>& a,
+           const std::pair<ChunkKey, ChunkHeat>& b) {
+            return a.second.writeBytes > b.second.writeBytes;
+        });
+    os << std::endl << "top " << n << " of " << heats.size()
+       << " written chunks:" << std::endl;
+    for (size_t i = 0; i < n; ++i) {
+        const ChunkKey& key = heats[i].first;
+        os << "  (" << key.logicPoolId << ", " << key.copysetId << ", "
+           << key.chunkId << "): writes: " << heats[i].second.writeCount
+           << ", bytes: " << heats[i].second.writeBytes << std::endl;
+    }
+
+    // 相邻segment修改时间之间写入的字节数，即这段时间的写入速率
+    os << std::endl << "segments:" << std::endl;
+    for (size_t i = 0; i < stat.segments.size(); ++i) {
+        const SegmentStat& seg = stat.segments[i];
+        os << "  " << seg.fileName << ": first index: " << seg.firstIndex
+           << ", entries: " << seg.entryCount << ", bytes: " << seg.bytes
+           << ", mtime: " << FormatTime(seg.mtime);
+        if (i > 0 && seg.mtime > stat.segments[i - 1].mtime) {
+            os << ", bytes/s: "
+               << seg.bytes / (seg.mtime - stat.segments[i - 1].mtime);
+        }
+        if (seg.truncated) {
+            os << ", truncated";
+        }
+        if (seg.corrupted) {
+            os << ", corrupted";
+        }
+        os << std::endl;
+    }
+}
+
+}  // namespace tool
+}  // namespace curve
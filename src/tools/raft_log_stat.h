@@ -0,0 +1,152 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SRC_TOOLS_RAFT_LOG_STAT_H_
+#define SRC_TOOLS_RAFT_LOG_STAT_H_
+
+#include <sys/types.h>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "src/fs/local_filesystem.h"
+
+namespace curve {
+namespace tool {
+
+using curve::fs::LocalFileSystem;
+
+// 单个segment文件的统计
+struct SegmentStat {
+    std::string fileName;
+    // segment第一个entry的index，由文件名解析
+    int64_t firstIndex = 0;
+    uint64_t entryCount = 0;
+    // entry在磁盘上占用的字节数，包括header
+    uint64_t bytes = 0;
+    // 文件最后修改的时间
+    time_t mtime = 0;
+    // 文件末尾有未写完整的entry，正在写的segment可能会出现
+    bool truncated = false;
+    // 有header校验失败的entry
+    bool corrupted = false;
+};
+
+struct ChunkKey {
+    uint32_t logicPoolId;
+    uint32_t copysetId;
+    uint64_t chunkId;
+
+    bool operator<(const ChunkKey& rhs) const;
+};
+
+struct ChunkHeat {
+    uint64_t writeCount = 0;
+    uint64_t writeBytes = 0;
+};
+
+// raft log的统计结果
+struct RaftLogStatistics {
+    uint64_t entryCount = 0;
+    // entry在磁盘上占用的字节数，包括header和对齐的填充
+    uint64_t bytes = 0;
+    // entry中的实际数据的字节数
+    uint64_t dataBytes = 0;
+    // entry数据解析失败的数量
+    uint64_t badDataCount = 0;
+    // braft entry type -> entry数量
+    std::map<int, uint64_t> entryTypes;
+    // chunk op type -> entry数量
+    std::map<int, uint64_t> opTypes;
+    // chunk op type -> 写入数据的字节数
+    std::map<int, uint64_t> opBytes;
+    // entry大小向上取整到2的幂 -> entry数量
+    std::map<uint64_t, uint64_t> sizeHistogram;
+    std::map<ChunkKey, ChunkHeat> chunkHeat;
+    std::vector<SegmentStat> segments;
+
+    void Merge(const RaftLogStatistics& other);
+};
+
+/**
+ * 统计raft log的entry大小分布、op类型、chunk的写入热度和写入速率，
+ * 用于调整wal的group commit和segment大小等参数。
+ * 多个segment并发解析，每个segment通过mmap读取。
+ * entry中没有时间信息，写入速率按segment的修改时间估算，
+ * 即相邻两个segment修改时间之间写入的字节数。
+ */
+class RaftLogStat {
+ public:
+    /**
+     *  @param localFS 本地文件系统
+     *  @param threadNum 并发解析segment的线程数
+     *  @param metaPageSize curve segment的meta page大小，
+     *         与chunkserver的walfilepool.metapage_size一致
+     */
+    RaftLogStat(std::shared_ptr<LocalFileSystem> localFS,
+                uint32_t threadNum, uint32_t metaPageSize)
+        : localFS_(localFS), threadNum_(threadNum),
+          metaPageSize_(metaPageSize) {}
+
+    /**
+     *  @brief 统计raft log
+     *  @param path segment文件名，或者copyset的raft log目录
+     *  @param[out] stat 统计结果
+     *  @return 成功返回0，有segment打开或解析失败返回-1，stat同样有效
+     */
+    int Stat(const std::string& path, RaftLogStatistics* stat);
+
+    /**
+     *  @brief 打印统计结果
+     *  @param stat 统计结果
+     *  @param topN 打印写入最多的chunk的数量
+     *  @param os 输出流
+     */
+    static void Print(const RaftLogStatistics& stat, uint32_t topN,
+                      std::ostream& os);
+
+    /**
+     *  @brief 解析segment的文件名
+     *  @param fileName segment文件名，可以带路径
+     *  @param[out] firstIndex segment第一个entry的index
+     *  @param[out] curveFormat 是否是curve segment格式
+     *  @return 是segment文件返回true，否则返回false
+     */
+    static bool ParseSegmentName(const std::string& fileName,
+                                 int64_t* firstIndex, bool* curveFormat);
+
+ private:
+    int StatSegment(const std::string& fileName, RaftLogStatistics* stat);
+
+    // 解析segment中[off, end)范围内的entry，返回false表示有header校验失败
+    static bool ParseEntries(const char* base, size_t off, size_t end,
+                             bool curveFormat, SegmentStat* segment,
+                             RaftLogStatistics* stat);
+
+    static void StatEntryData(const char* data, uint32_t len,
+                              RaftLogStatistics* stat);
+
+    std::shared_ptr<LocalFileSystem> localFS_;
+    uint32_t threadNum_;
+    uint32_t metaPageSize_;
+};
+
+}  // namespace tool
+}  // namespace curve
+
+#endif  // SRC_TOOLS_RAFT_LOG_STAT_H_
@@ -23,6 +23,13 @@
 #include "src/tools/raft_log_tool.h"
 
 DECLARE_string(fileName);
+DEFINE_uint32(raftLogStatThreadNum, 4,
+              "thread number to parse the segments for raft-log-stat");
+DEFINE_uint32(raftLogStatTopN, 10,
+              "number of the most written chunks to print for raft-log-stat");
+DEFINE_uint32(walMetaPageSize, 4096,
+              "meta page size of curve segment, "
+              "same as walfilepool.metapage_size of chunkserver");
 
 namespace curve {
 namespace tool {
@@ -35,8 +42,7 @@ enum class CheckSumType {
     CHECKSUM_CRC32 = 1,
 };
 
-inline bool VerifyCheckSum(int type,
-                            const char* data, size_t len, uint32_t value) {
+bool VerifyCheckSum(int type, const char* data, size_t len, uint32_t value) {
     CheckSumType checkSunType = static_cast<CheckSumType>(type);
     switch (checkSunType) {
     case CheckSumType::CHECKSUM_MURMURHASH32:
@@ -69,6 +75,15 @@ void RaftLogTool::PrintHelp(const std::string& cmd) {
         std::cout << "command not supported!" << std::endl;
         return;
     }
+    if (cmd == kRaftLogStat) {
+        std::cout << "curve_chunkserver_tool " << cmd
+                  << " -fileName=./0/copysets/4294967297/log"
+                  << " [-raftLogStatThreadNum=4] [-raftLogStatTopN=10]"
+                  << " [-walMetaPageSize=4096]" << std::endl;
+        std::cout << "fileName can be a segment or a raft log dir"
+                  << std::endl;
+        return;
+    }
     std::cout << "curve_chunkserver_tool " << cmd
               << " -fileName=log_inprogress_01" << std::endl;
 }
@@ -76,6 +91,8 @@ void RaftLogTool::PrintHelp(const std::string& cmd) {
 int RaftLogTool::RunCommand(const std::string& cmd) {
     if (cmd == kRaftLogMeta) {
         return PrintHeaders(FLAGS_fileName);
+    } else if (cmd == kRaftLogStat) {
+        return PrintStatistics(FLAGS_fileName);
     } else {
         std::cout << "command not supported!" << std::endl;
         return -1;
@@ -83,7 +100,7 @@ int RaftLogTool::RunCommand(const std::string& cmd) {
 }
 
 bool RaftLogTool::SupportCommand(const std::string& cmd) {
-    return cmd == kRaftLogMeta;
+    return cmd == kRaftLogMeta || cmd == kRaftLogStat;
 }
 
 int RaftLogTool::PrintHeaders(const std::string& fileName) {
@@ -114,6 +131,26 @@ int RaftLogTool::PrintHeaders(const std::string& fileName) {
     return 0;
 }
 
+int RaftLogTool::PrintStatistics(const std::string& path) {
+    if (localFS_ == nullptr) {
+        std::cout << "local filesystem is not set!" << std::endl;
+        return -1;
+    }
+    RaftLogStat raftLogStat(localFS_, FLAGS_raftLogStatThreadNum,
+                            FLAGS_walMetaPageSize);
+    RaftLogStatistics stat;
+    int res = raftLogStat.Stat(path, &stat);
+    if (!stat.segments.empty()) {
+        RaftLogStat::Print(stat, FLAGS_raftLogStatTopN, std::cout);
+    }
+    if (res != 0) {
+        std::cout << "Some segments of " << path << " fail to parse"
+                  << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
 int SegmentParser::Init(const std::string& fileName) {
     fd_ = localFS_->Open(fileName.c_str(), O_RDONLY);
     if (fd_ < 0) {
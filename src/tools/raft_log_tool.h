@@ -34,6 +34,7 @@
 #include "src/fs/local_filesystem.h"
 #include "src/tools/curve_tool.h"
 #include "src/tools/curve_tool_define.h"
+#include "src/tools/raft_log_stat.h"
 
 namespace curve {
 namespace tool {
@@ -54,6 +55,13 @@ struct EntryHeader {
 
 std::ostream& operator<<(std::ostream& os, const EntryHeader& h);
 
+/**
+ *  @brief 校验entry header或数据的checksum
+ *  @param type entry header中的checksum_type
+ *  @return 校验通过返回true，否则返回false
+ */
+bool VerifyCheckSum(int type, const char* data, size_t len, uint32_t value);
+
 class SegmentParser {
  public:
     explicit SegmentParser(std::shared_ptr<LocalFileSystem> localFS) :
@@ -98,8 +106,9 @@ class SegmentParser {
 
 class RaftLogTool : public CurveTool {
  public:
-    explicit RaftLogTool(std::shared_ptr<SegmentParser> parser) :
-                                    parser_(parser) {}
+    explicit RaftLogTool(std::shared_ptr<SegmentParser> parser,
+                         std::shared_ptr<LocalFileSystem> localFS = nullptr)
+        : parser_(parser), localFS_(localFS) {}
 
     /**
      *  @brief 执行命令
@@ -128,6 +137,13 @@ class RaftLogTool : public CurveTool {
      */
     int PrintHeaders(const std::string& fileName);
 
+    /**
+     *  @brief 并发统计segment文件或目录中所有segment的entry并打印报告
+     *  @param path segment文件名或者copyset的raft log目录
+     *  @return 成功返回0，否则返回-1
+     */
+    int PrintStatistics(const std::string& path);
+
     /**
      *  @brief 从文件解析出entry header
      *  @param fd 文件描述符
@@ -147,6 +163,7 @@ class RaftLogTool : public CurveTool {
                                     int64_t* firstIndex);
 
     std::shared_ptr<SegmentParser> parser_;
+    std::shared_ptr<LocalFileSystem> localFS_;
 };
 }  // namespace tool
 }  // namespace curve
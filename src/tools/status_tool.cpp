@@ -252,6 +252,15 @@ int StatusTool::ChunkServerListCmd() {
     uint64_t pendding = 0;
     uint64_t retired = 0;
     uint64_t penddingCopyset = 0;
+    std::map<std::string, bool> onlineStatus;
+    if (FLAGS_checkCSAlive) {
+        std::vector<std::string> csAddrs;
+        for (const auto& chunkserver : chunkservers) {
+            csAddrs.emplace_back(chunkserver.hostip()
+                        + ":" + std::to_string(chunkserver.port()));
+        }
+        copysetCheckCore_->CheckChunkServersOnline(csAddrs, &onlineStatus);
+    }
     for (auto& chunkserver : chunkservers) {
         auto csId = chunkserver.chunkserverid();
         std::vector<CopysetInfo> copysets;
@@ -267,7 +276,7 @@ int StatusTool::ChunkServerListCmd() {
             // 发RPC重置online状态
             std::string csAddr = chunkserver.hostip()
                         + ":" + std::to_string(chunkserver.port());
-            bool isOnline = copysetCheckCore_->CheckChunkServerOnline(csAddr);
+            bool isOnline = onlineStatus[csAddr];
             if (isOnline) {
                 chunkserver.set_onlinestate(OnlineState::ONLINE);
             } else {
@@ -827,12 +836,22 @@ int PrintChunkserverOnlineStatus(
     uint64_t online = 0;
     uint64_t offline = 0;
     std::vector<ChunkServerIdType> offlineCs;
+    // 并发检查所有chunkserver，不在线的chunkserver不用逐个等待超时
+    std::vector<std::string> csAddrs;
+    for (const auto& poolChunkserver : poolChunkservers) {
+        for (const auto& chunkserver : poolChunkserver.second) {
+            csAddrs.emplace_back(chunkserver.hostip()
+                            + ":" + std::to_string(chunkserver.port()));
+        }
+    }
+    std::map<std::string, bool> onlineStatus;
+    copysetCheckCore->CheckChunkServersOnline(csAddrs, &onlineStatus);
     for (const auto& poolChunkserver : poolChunkservers) {
         for (const auto& chunkserver : poolChunkserver.second) {
             total++;
             std::string csAddr = chunkserver.hostip()
                             + ":" + std::to_string(chunkserver.port());
-            if (copysetCheckCore->CheckChunkServerOnline(csAddr)) {
+            if (onlineStatus[csAddr]) {
                 online++;
             } else {
                 offline++;
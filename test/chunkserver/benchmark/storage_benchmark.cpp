@@ -0,0 +1,415 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * Microbenchmarks of the chunkserver storage engine on a real
+ * LocalFileSystem, without raft and rpc. Point --benchDir to a tmpfs
+ * mount to measure the CPU cost, or to a disk to get the device bound
+ * numbers, e.g.
+ *
+ *   chunkserver_storage_benchmark --benchDir=/dev/shm/curve_bench \
+ *       --benchmark_filter=BM_WriteChunk --enableWalDirectWrite=false
+ *
+ * Every thread works on its own chunk, like the requests of different
+ * copysets. The chunks are deleted after every run, so they go back to
+ * the file pool and the pool only needs to be allocated once.
+ */
+
+#include <benchmark/benchmark.h>
+#include <braft/log_entry.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/chunkserver/datastore/chunkserver_datastore.h"
+#include "src/chunkserver/datastore/file_pool.h"
+#include "src/chunkserver/raftlog/curve_segment.h"
+#include "src/chunkserver/raftlog/define.h"
+#include "src/fs/local_filesystem.h"
+#include "test/chunkserver/datastore/filepool_helper.h"
+
+DEFINE_string(benchDir, "./curve_storage_bench",
+              "directory of the datastore and the file pools");
+DEFINE_uint32(benchChunkSize, 16 * 1024 * 1024, "size of the chunks");
+DEFINE_uint32(benchPoolChunks, 32,
+              "number of the files allocated in the chunk file pool");
+DEFINE_uint32(benchSegmentSize, 8 * 1024 * 1024, "size of the wal segments");
+DEFINE_uint32(benchPoolSegments, 4,
+              "number of the files allocated in the wal file pool");
+
+namespace curve {
+namespace chunkserver {
+
+namespace {
+
+const uint32_t kMetaPageSize = 4096;
+const uint32_t kBlockSize = 4096;
+const int kMaxThreads = 8;
+const SequenceNum kMaxSn = std::numeric_limits<SequenceNum>::max();
+
+// the chunk id of every thread is |base + thread index|
+const ChunkID kWriteChunkBase = 1000;
+const ChunkID kReadChunkBase = 2000;
+const ChunkID kCowChunkBase = 3000;
+const ChunkID kCloneChunkBase = 4000;
+
+const char kCloneLocation[] = "bench@cs";
+
+class StorageEnv {
+ public:
+    static StorageEnv* Get() {
+        static StorageEnv* env = new StorageEnv();
+        return env;
+    }
+
+    std::shared_ptr<LocalFileSystem> lfs;
+    std::shared_ptr<FilePool> chunkPool;
+    std::shared_ptr<FilePool> walPool;
+    std::shared_ptr<CSDataStore> dataStore;
+
+    std::string walDir;
+    std::string poolBenchDir;
+
+ private:
+    StorageEnv() {
+        lfs = LocalFsFactory::CreateFs(FileSystemType::EXT4, "");
+        const std::string& dir = FLAGS_benchDir;
+        if (lfs->DirExists(dir)) {
+            lfs->Delete(dir);
+        }
+        CHECK_EQ(0, lfs->Mkdir(dir)) << "mkdir " << dir << " failed";
+
+        chunkPool = InitPool(dir + "/chunkfilepool", FLAGS_benchChunkSize,
+                             FLAGS_benchPoolChunks);
+        walPool = InitPool(dir + "/walfilepool", FLAGS_benchSegmentSize,
+                           FLAGS_benchPoolSegments);
+
+        walDir = dir + "/raftlog";
+        poolBenchDir = dir + "/filepool";
+        CHECK_EQ(0, lfs->Mkdir(walDir));
+        CHECK_EQ(0, lfs->Mkdir(poolBenchDir));
+
+        DataStoreOptions options;
+        options.baseDir = dir + "/data";
+        options.chunkSize = FLAGS_benchChunkSize;
+        options.blockSize = kBlockSize;
+        options.metaPageSize = kMetaPageSize;
+        options.locationLimit = 3000;
+        options.enableOdsyncWhenOpenChunkFile = false;
+        dataStore = std::make_shared<CSDataStore>(lfs, chunkPool, options);
+        CHECK(dataStore->Initialize()) << "init datastore failed";
+    }
+
+    std::shared_ptr<FilePool> InitPool(const std::string& poolDir,
+                                       uint32_t fileSize, uint32_t num) {
+        const std::string metaPath = poolDir + ".meta";
+        FilePoolMeta meta;
+        meta.chunkSize = fileSize;
+        meta.metaPageSize = kMetaPageSize;
+        meta.filePoolPath = poolDir;
+        CHECK_EQ(0, FilePoolHelper::PersistEnCodeMetaInfo(lfs, meta,
+                                                          metaPath));
+        allocateChunk(lfs, num, poolDir, fileSize);
+
+        FilePoolOptions poolOpt;
+        poolOpt.fileSize = fileSize;
+        poolOpt.metaPageSize = kMetaPageSize;
+        memcpy(poolOpt.metaPath, metaPath.c_str(), metaPath.size());
+        auto pool = std::make_shared<FilePool>(lfs);
+        CHECK(pool->Initialize(poolOpt)) << "init file pool failed";
+        CHECK_EQ(num, pool->Size()) << "allocate " << poolDir << " failed";
+        return pool;
+    }
+};
+
+CSDataStore* DataStore() {
+    return StorageEnv::Get()->dataStore.get();
+}
+
+void WriteWholeChunk(ChunkID id, SequenceNum sn) {
+    std::string data(FLAGS_benchChunkSize, 'a');
+    CHECK(CSErrorCode::Success ==
+          DataStore()->WriteChunk(id, sn, data.data(), 0, data.size(),
+                                  nullptr))
+        << "write chunk " << id << " failed";
+}
+
+void DeleteChunks(ChunkID base, int num) {
+    for (int i = 0; i < num; i++) {
+        DataStore()->DeleteChunk(base + i, kMaxSn);
+    }
+}
+
+// the next offset of a sequential stream of |blockSize| in a chunk
+off_t NextOffset(off_t* offset, size_t blockSize, bool* wrapped) {
+    off_t current = *offset;
+    *offset += blockSize;
+    *wrapped = *offset + blockSize > FLAGS_benchChunkSize;
+    if (*wrapped) {
+        *offset = 0;
+    }
+    return current;
+}
+
+void SetThroughput(benchmark::State* state, size_t blockSize) {
+    state->SetItemsProcessed(state->iterations());
+    state->SetBytesProcessed(state->iterations() * blockSize);
+}
+
+// overwrite of the written chunks, the common write path
+void SetupWriteChunk(const benchmark::State& state) {
+    for (int i = 0; i < state.threads(); i++) {
+        WriteWholeChunk(kWriteChunkBase + i, 1);
+    }
+}
+
+void TeardownWriteChunk(const benchmark::State& state) {
+    DeleteChunks(kWriteChunkBase, state.threads());
+}
+
+void BM_WriteChunk(benchmark::State& state) {
+    const size_t blockSize = state.range(0);
+    const ChunkID id = kWriteChunkBase + state.thread_index();
+    std::string data(blockSize, 'b');
+    off_t offset = 0;
+    bool wrapped;
+    for (auto _ : state) {
+        off_t off = NextOffset(&offset, blockSize, &wrapped);
+        if (DataStore()->WriteChunk(id, 1, data.data(), off, blockSize,
+                                    nullptr) != CSErrorCode::Success) {
+            state.SkipWithError("write chunk failed");
+            break;
+        }
+    }
+    SetThroughput(&state, blockSize);
+}
+
+void SetupReadChunk(const benchmark::State& state) {
+    for (int i = 0; i < state.threads(); i++) {
+        WriteWholeChunk(kReadChunkBase + i, 1);
+    }
+}
+
+void TeardownReadChunk(const benchmark::State& state) {
+    DeleteChunks(kReadChunkBase, state.threads());
+}
+
+void BM_ReadChunk(benchmark::State& state) {
+    const size_t blockSize = state.range(0);
+    const ChunkID id = kReadChunkBase + state.thread_index();
+    std::vector<char> buf(blockSize);
+    off_t offset = 0;
+    bool wrapped;
+    for (auto _ : state) {
+        off_t off = NextOffset(&offset, blockSize, &wrapped);
+        if (DataStore()->ReadChunk(id, 1, buf.data(), off, blockSize) !=
+            CSErrorCode::Success) {
+            state.SkipWithError("read chunk failed");
+            break;
+        }
+    }
+    SetThroughput(&state, blockSize);
+}
+
+// every write of a new sequence copies the old data to the snapshot file
+// first, the snapshot is deleted and the sequence is increased when the
+// whole chunk has been copied, so all the writes measured are COW writes
+void SetupCowWrite(const benchmark::State& state) {
+    for (int i = 0; i < state.threads(); i++) {
+        WriteWholeChunk(kCowChunkBase + i, 1);
+    }
+}
+
+void TeardownCowWrite(const benchmark::State& state) {
+    DeleteChunks(kCowChunkBase, state.threads());
+}
+
+void BM_CowWrite(benchmark::State& state) {
+    const size_t blockSize = state.range(0);
+    const ChunkID id = kCowChunkBase + state.thread_index();
+    std::string data(blockSize, 'c');
+    SequenceNum sn = 2;
+    off_t offset = 0;
+    bool wrapped;
+    for (auto _ : state) {
+        off_t off = NextOffset(&offset, blockSize, &wrapped);
+        if (DataStore()->WriteChunk(id, sn, data.data(), off, blockSize,
+                                    nullptr) != CSErrorCode::Success) {
+            state.SkipWithError("cow write failed");
+            break;
+        }
+        if (wrapped) {
+            state.PauseTiming();
+            DataStore()->DeleteSnapshotChunkOrCorrectSn(id, sn);
+            sn++;
+            state.ResumeTiming();
+        }
+    }
+    SetThroughput(&state, blockSize);
+}
+
+// paste the data from the clone source to a clone chunk, the chunk is
+// recreated when the whole chunk has been pasted, since the pasted areas
+// are skipped
+void CreateCloneChunk(ChunkID id) {
+    CHECK(CSErrorCode::Success ==
+          DataStore()->CreateCloneChunk(id, 1, 0, FLAGS_benchChunkSize,
+                                        kCloneLocation))
+        << "create clone chunk " << id << " failed";
+}
+
+void SetupPasteChunk(const benchmark::State& state) {
+    for (int i = 0; i < state.threads(); i++) {
+        CreateCloneChunk(kCloneChunkBase + i);
+    }
+}
+
+void TeardownPasteChunk(const benchmark::State& state) {
+    DeleteChunks(kCloneChunkBase, state.threads());
+}
+
+void BM_PasteChunk(benchmark::State& state) {
+    const size_t blockSize = state.range(0);
+    const ChunkID id = kCloneChunkBase + state.thread_index();
+    std::string data(blockSize, 'd');
+    off_t offset = 0;
+    bool wrapped;
+    for (auto _ : state) {
+        off_t off = NextOffset(&offset, blockSize, &wrapped);
+        if (DataStore()->PasteChunk(id, data.data(), off, blockSize) !=
+            CSErrorCode::Success) {
+            state.SkipWithError("paste chunk failed");
+            break;
+        }
+        if (wrapped) {
+            state.PauseTiming();
+            DataStore()->DeleteChunk(id, kMaxSn);
+            CreateCloneChunk(id);
+            state.ResumeTiming();
+        }
+    }
+    SetThroughput(&state, blockSize);
+}
+
+// take a file from the chunk file pool and give it back, which is what
+// creating and deleting a chunk cost the file pool
+void BM_FilePoolGetRecycle(benchmark::State& state) {
+    FilePool* pool = StorageEnv::Get()->chunkPool.get();
+    const std::string path = StorageEnv::Get()->poolBenchDir + "/" +
+                             std::to_string(state.thread_index());
+    std::vector<char> metaPage(kMetaPageSize, 0);
+    for (auto _ : state) {
+        if (pool->GetFile(path, metaPage.data()) != 0) {
+            state.SkipWithError("get file from pool failed");
+            break;
+        }
+        if (pool->RecycleFile(path) != 0) {
+            state.SkipWithError("recycle file failed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// append the entries to an open wal segment, a new segment is created
+// when the current one is full, the segment is not shared by threads
+// like in braft
+void BM_SegmentAppend(benchmark::State& state) {
+    const size_t entrySize = state.range(0);
+    const std::string data(entrySize, 'e');
+    const int64_t capacity = FLAGS_benchSegmentSize + kMetaPageSize;
+    const int64_t align = FLAGS_walAlignSize;
+    const int64_t entryBytes =
+        (kEntryHeaderSize + entrySize + align - 1) / align * align;
+    auto walPool = StorageEnv::Get()->walPool;
+
+    int64_t index = 1;
+    scoped_refptr<CurveSegment> segment =
+        new CurveSegment(StorageEnv::Get()->walDir, index, 0, walPool);
+    if (segment->create() != 0) {
+        state.SkipWithError("create segment failed");
+        return;
+    }
+    for (auto _ : state) {
+        if (segment->bytes() + entryBytes > capacity) {
+            state.PauseTiming();
+            segment->unlink();
+            segment =
+                new CurveSegment(StorageEnv::Get()->walDir, index, 0, walPool);
+            bool created = segment->create() == 0;
+            state.ResumeTiming();
+            if (!created) {
+                state.SkipWithError("create segment failed");
+                return;
+            }
+        }
+
+        braft::LogEntry* entry = new braft::LogEntry();
+        entry->AddRef();
+        entry->type = braft::ENTRY_TYPE_DATA;
+        entry->id.term = 1;
+        entry->id.index = index++;
+        entry->data.append(data);
+        int ret = segment->append(entry);
+        entry->Release();
+        if (ret != 0) {
+            state.SkipWithError("append entry failed");
+            break;
+        }
+    }
+    segment->unlink();
+    SetThroughput(&state, entrySize);
+}
+
+}  // namespace
+
+BENCHMARK(BM_WriteChunk)
+    ->RangeMultiplier(4)->Range(4 << 10, 1 << 20)
+    ->ThreadRange(1, kMaxThreads)->UseRealTime()
+    ->Setup(SetupWriteChunk)->Teardown(TeardownWriteChunk);
+BENCHMARK(BM_ReadChunk)
+    ->RangeMultiplier(4)->Range(4 << 10, 1 << 20)
+    ->ThreadRange(1, kMaxThreads)->UseRealTime()
+    ->Setup(SetupReadChunk)->Teardown(TeardownReadChunk);
+BENCHMARK(BM_CowWrite)
+    ->RangeMultiplier(4)->Range(4 << 10, 1 << 20)
+    ->ThreadRange(1, kMaxThreads)->UseRealTime()
+    ->Setup(SetupCowWrite)->Teardown(TeardownCowWrite);
+BENCHMARK(BM_PasteChunk)
+    ->RangeMultiplier(4)->Range(4 << 10, 1 << 20)
+    ->ThreadRange(1, kMaxThreads)->UseRealTime()
+    ->Setup(SetupPasteChunk)->Teardown(TeardownPasteChunk);
+BENCHMARK(BM_FilePoolGetRecycle)
+    ->ThreadRange(1, kMaxThreads)->UseRealTime();
+BENCHMARK(BM_SegmentAppend)
+    ->RangeMultiplier(4)->Range(256, 256 << 10)->UseRealTime();
+
+}  // namespace chunkserver
+}  // namespace curve
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    google::ParseCommandLineFlags(&argc, &argv, false);
+    google::InitGoogleLogging(argv[0]);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
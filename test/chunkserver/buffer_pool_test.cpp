@@ -0,0 +1,162 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <butil/iobuf.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "src/chunkserver/datastore/buffer_pool.h"
+
+namespace curve {
+namespace chunkserver {
+
+TEST(BufferPoolTest, AlignedTest) {
+    std::vector<size_t> sizes = {1, 4096, 4097, 128 * 1024, 4 * 1024 * 1024,
+                                 4 * 1024 * 1024 + 1};
+    for (auto size : sizes) {
+        char* buf = BufferPool::Get(size);
+        ASSERT_NE(nullptr, buf);
+        ASSERT_EQ(0, reinterpret_cast<uintptr_t>(buf) %
+                     BufferPool::kAlignment);
+        memset(buf, 'a', size);
+        BufferPool::Release(buf, size);
+    }
+}
+
+TEST(BufferPoolTest, ReuseTest) {
+    const size_t size = 64 * 1024;
+    size_t cached = BufferPool::CachedNum(size);
+
+    char* buf = BufferPool::Get(size);
+    memset(buf, 'b', size);
+    {
+        butil::IOBuf iobuf;
+        BufferPool::AppendToIOBuf(buf, size, &iobuf);
+        ASSERT_EQ(size, iobuf.size());
+        ASSERT_EQ(std::string(size, 'b'), iobuf.to_string());
+    }
+    // buffer is put back when iobuf releases it
+    ASSERT_EQ(cached + 1, BufferPool::CachedNum(size));
+
+    // buffers of the same size class are reused
+    char* buf2 = BufferPool::Get(size - 1);
+    ASSERT_EQ(buf, buf2);
+    ASSERT_EQ(cached, BufferPool::CachedNum(size));
+    BufferPool::Release(buf2, size - 1);
+    ASSERT_EQ(cached + 1, BufferPool::CachedNum(size));
+
+    // buffers larger than the biggest class are not cached
+    const size_t large = 8 * 1024 * 1024;
+    char* buf3 = BufferPool::Get(large);
+    BufferPool::Release(buf3, large);
+    ASSERT_EQ(0, BufferPool::CachedNum(large));
+}
+
+TEST(BufferPoolTest, CacheLimitTest) {
+    const size_t size = 4 * 1024 * 1024;
+    const size_t maxNum = BufferPool::kMaxCachedBytesPerClass / size;
+    std::vector<char*> bufs;
+    for (size_t i = 0; i < maxNum + 2; ++i) {
+        bufs.push_back(BufferPool::Get(size));
+    }
+    for (auto buf : bufs) {
+        BufferPool::Release(buf, size);
+    }
+    ASSERT_EQ(maxNum, BufferPool::CachedNum(size));
+}
+
+TEST(BufferPoolTest, ConcurrentTest) {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([i]() {
+            for (int j = 0; j < 1000; ++j) {
+                size_t size = 4096 << ((i + j) % 6);
+                char* buf = BufferPool::Get(size);
+                buf[0] = 'c';
+                buf[size - 1] = 'c';
+                butil::IOBuf iobuf;
+                BufferPool::AppendToIOBuf(buf, size, &iobuf);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+// the arena stays once reserved, so this test goes last
+TEST(BufferPoolTest, HugePageArenaTest) {
+    BufferPoolOptions options;
+    options.hugePageBytes = 3 * BufferPool::kHugePageSize;
+    ASSERT_EQ(0, BufferPool::Init(options));
+    ASSERT_EQ(0, BufferPool::Init(options));
+
+    // drain the buffers cached by the former tests
+    const size_t size = 64 * 1024;
+    std::vector<char*> bufs;
+    while (BufferPool::CachedNum(size) > 0) {
+        bufs.push_back(BufferPool::Get(size));
+    }
+
+    // a class under a huge page takes a whole one and caches the rest
+    char* buf = BufferPool::Get(size);
+    ASSERT_TRUE(BufferPool::InArena(buf));
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(buf) %
+                 BufferPool::kHugePageSize);
+    ASSERT_EQ(BufferPool::kHugePageSize / size - 1,
+              BufferPool::CachedNum(size));
+    memset(buf, 'd', size);
+    bufs.push_back(buf);
+    for (auto b : bufs) {
+        BufferPool::Release(b, size);
+    }
+
+    // a class over a huge page is carved as it is, the buffers of the
+    // arena are cached beyond the cache limit
+    const size_t large = 4 * 1024 * 1024;
+    bufs.clear();
+    while (BufferPool::CachedNum(large) > 0) {
+        bufs.push_back(BufferPool::Get(large));
+    }
+    char* largeBuf = BufferPool::Get(large);
+    ASSERT_TRUE(BufferPool::InArena(largeBuf));
+    for (auto b : bufs) {
+        BufferPool::Release(b, large);
+    }
+    size_t cached = BufferPool::CachedNum(large);
+    BufferPool::Release(largeBuf, large);
+    ASSERT_EQ(cached + 1, BufferPool::CachedNum(large));
+
+    // the arena is used up, buffers come from the system
+    bufs.clear();
+    while (BufferPool::CachedNum(large) > 0) {
+        bufs.push_back(BufferPool::Get(large));
+    }
+    char* sysBuf = BufferPool::Get(large);
+    ASSERT_FALSE(BufferPool::InArena(sysBuf));
+    BufferPool::Release(sysBuf, large);
+    for (auto b : bufs) {
+        BufferPool::Release(b, large);
+    }
+}
+
+}  // namespace chunkserver
+}  // namespace curve
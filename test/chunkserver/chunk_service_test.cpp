@@ -255,6 +255,45 @@ TEST_F(ChunkserverTest, normal_read_write_test) {
                              cntl.response_attachment().to_string().c_str());
             }
         }
+        /* ReadChunks */
+        {
+            brpc::Controller cntl;
+            cntl.set_timeout_ms(rpcTimeoutMs);
+            ReadChunksRequest request;
+            ReadChunksResponse response;
+            for (int i = 0; i < 4; ++i) {
+                ChunkRequest *chunkRequest = request.add_requests();
+                chunkRequest->set_optype(CHUNK_OP_TYPE::CHUNK_OP_READ);
+                chunkRequest->set_logicpoolid(logicPoolId);
+                chunkRequest->set_copysetid(copysetId);
+                // 第三个请求读不存在的chunk
+                chunkRequest->set_chunkid(i == 2 ? chunkId + 100 : chunkId);
+                chunkRequest->set_sn(sn);
+                chunkRequest->set_offset(kOpRequestAlignSize * i);
+                chunkRequest->set_size(kOpRequestAlignSize);
+            }
+            // 只接受读请求
+            request.mutable_requests(3)->set_optype(
+                CHUNK_OP_TYPE::CHUNK_OP_WRITE);
+            stub.ReadChunks(&cntl, &request, &response, nullptr);
+            ASSERT_FALSE(cntl.Failed());
+            ASSERT_EQ(4, response.responses_size());
+            ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                      response.responses(0).status());
+            ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                      response.responses(1).status());
+            ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_CHUNK_NOTEXIST,
+                      response.responses(2).status());
+            ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST,
+                      response.responses(3).status());
+            // 只有读成功的请求的数据
+            std::string data = cntl.response_attachment().to_string();
+            ASSERT_EQ(2 * kOpRequestAlignSize, data.size());
+            ASSERT_STREQ(expectData,
+                         data.substr(0, kOpRequestAlignSize).c_str());
+            ASSERT_STREQ(expectData,
+                         data.substr(kOpRequestAlignSize).c_str());
+        }
         LOG(INFO) << "begin read without applied index test \n";
         /* read without applied index */
         for (int i = 0; i < 10; ++i) {
@@ -713,6 +713,33 @@ TEST_F(ChunkService2Test, overload_test) {
         ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD, response.status());
     }
 
+    // create clone chunks
+    {
+        LogicPoolID logicPoolId = 1;
+        CopysetID copysetId = 10000;
+        brpc::Controller cntl;
+        CreateCloneChunksRequest request;
+        CreateCloneChunksResponse response;
+        ChunkServiceTestClosure done;
+        ChunkRequest *createRequest = request.add_requests();
+        createRequest->set_optype(CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE);
+        createRequest->set_logicpoolid(logicPoolId);
+        createRequest->set_copysetid(copysetId);
+        createRequest->set_chunkid(chunkId);
+        // 非create clone的请求不处理
+        ChunkRequest *readRequest = request.add_requests();
+        readRequest->set_optype(CHUNK_OP_TYPE::CHUNK_OP_READ);
+        readRequest->set_logicpoolid(logicPoolId);
+        readRequest->set_copysetid(copysetId);
+        readRequest->set_chunkid(chunkId);
+        chunkService.CreateCloneChunks(&cntl, &request, &response, &done);
+        ASSERT_EQ(2, response.responses_size());
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD,
+                  response.responses(0).status());
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST,
+                  response.responses(1).status());
+    }
+
     // recover chunk
     {
         LogicPoolID logicPoolId = 1;
@@ -729,6 +756,33 @@ TEST_F(ChunkService2Test, overload_test) {
         ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD, response.status());
     }
 
+    // recover chunks
+    {
+        LogicPoolID logicPoolId = 1;
+        CopysetID copysetId = 10000;
+        brpc::Controller cntl;
+        RecoverChunksRequest request;
+        RecoverChunksResponse response;
+        ChunkServiceTestClosure done;
+        ChunkRequest *recoverRequest = request.add_requests();
+        recoverRequest->set_optype(CHUNK_OP_TYPE::CHUNK_OP_RECOVER);
+        recoverRequest->set_logicpoolid(logicPoolId);
+        recoverRequest->set_copysetid(copysetId);
+        recoverRequest->set_chunkid(chunkId);
+        // 非recover的请求不处理
+        ChunkRequest *createRequest = request.add_requests();
+        createRequest->set_optype(CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE);
+        createRequest->set_logicpoolid(logicPoolId);
+        createRequest->set_copysetid(copysetId);
+        createRequest->set_chunkid(chunkId);
+        chunkService.RecoverChunks(&cntl, &request, &response, &done);
+        ASSERT_EQ(2, response.responses_size());
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD,
+                  response.responses(0).status());
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST,
+                  response.responses(1).status());
+    }
+
     // get chunk info
     {
         brpc::Controller cntl;
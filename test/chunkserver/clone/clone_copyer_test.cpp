@@ -364,5 +364,165 @@ TEST_F(CloneCopyerTest, ExpiredTest) {
     ASSERT_EQ(0, copyer.Fini());
 }
 
+TEST_F(CloneCopyerTest, CacheTest) {
+    OriginCopyer copyer;
+    CopyerOptions options;
+    options.curveConf = CURVE_CONF;
+    options.s3Conf = S3_CONF;
+    options.curveUser.owner = ROOT_OWNER;
+    options.curveUser.password = ROOT_PWD;
+    options.curveClient = nullptr;
+    options.s3Client = s3Client_;
+    options.curveFileTimeoutSec = EXPIRED_USE;
+    options.cacheMaxCount = 16;
+    options.cacheMaxDataSize = 4096;
+    ASSERT_EQ(0, copyer.Init(options));
+
+    char buf1[4096];
+    char buf2[4096];
+    AsyncDownloadContext context1{"test@s3", 0, 4096, buf1};
+    AsyncDownloadContext context2{"test@s3", 0, 4096, buf2};
+    MockDownloadClosure closure1(&context1);
+    MockDownloadClosure closure2(&context2);
+
+    /* 用例:两个请求下载相同的区域
+     * 预期:只从源端下载一次，下载完成后两个请求都拿到数据
+     */
+    std::shared_ptr<GetObjectAsyncContext> inflight;
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .WillOnce(SaveArg<0>(&inflight));
+    copyer.DownloadAsync(&closure1);
+    copyer.DownloadAsync(&closure2);
+    ASSERT_FALSE(closure1.IsRun());
+    ASSERT_FALSE(closure2.IsRun());
+    ASSERT_NE(nullptr, inflight);
+    memset(inflight->buf, 'a', inflight->len);
+    inflight->retCode = 0;
+    inflight->cb(s3Client_.get(), inflight);
+    ASSERT_TRUE(closure1.IsRun());
+    ASSERT_FALSE(closure1.IsFailed());
+    ASSERT_TRUE(closure2.IsRun());
+    ASSERT_FALSE(closure2.IsFailed());
+    char expect[4096];
+    memset(expect, 'a', sizeof(expect));
+    ASSERT_EQ(0, memcmp(expect, buf1, sizeof(expect)));
+    ASSERT_EQ(0, memcmp(expect, buf2, sizeof(expect)));
+    closure1.Reset();
+    closure2.Reset();
+
+    /* 用例:再次下载相同的区域
+     * 预期:从缓存中读取，不访问源端
+     */
+    memset(buf2, 0, sizeof(buf2));
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_)).Times(0);
+    copyer.DownloadAsync(&closure2);
+    ASSERT_TRUE(closure2.IsRun());
+    ASSERT_FALSE(closure2.IsFailed());
+    ASSERT_EQ(0, memcmp(expect, buf2, sizeof(expect)));
+    closure2.Reset();
+
+    /* 用例:下载失败
+     * 预期:等待的请求都返回失败，失败的结果不会被缓存
+     */
+    context1.offset = 4096;
+    context2.offset = 4096;
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .WillOnce(SaveArg<0>(&inflight))
+        .WillOnce(Invoke(
+            [&] (const std::shared_ptr<GetObjectAsyncContext>& context) {
+                context->retCode = 0;
+                context->cb(s3Client_.get(), context);
+            }));
+    copyer.DownloadAsync(&closure1);
+    copyer.DownloadAsync(&closure2);
+    inflight->retCode = -1;
+    inflight->cb(s3Client_.get(), inflight);
+    ASSERT_TRUE(closure1.IsRun());
+    ASSERT_TRUE(closure1.IsFailed());
+    ASSERT_TRUE(closure2.IsRun());
+    ASSERT_TRUE(closure2.IsFailed());
+    closure2.Reset();
+    copyer.DownloadAsync(&closure2);
+    ASSERT_TRUE(closure2.IsRun());
+    ASSERT_FALSE(closure2.IsFailed());
+
+    /* 用例:下载的长度超过可缓存的长度
+     * 预期:不经过缓存，直接从源端下载
+     */
+    char* bigBuf = new char[8192];
+    AsyncDownloadContext context3{"test@s3", 0, 8192, bigBuf};
+    MockDownloadClosure closure3(&context3);
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .WillOnce(Invoke(
+            [&] (const std::shared_ptr<GetObjectAsyncContext>& context) {
+                context->retCode = 0;
+                context->cb(s3Client_.get(), context);
+            }));
+    copyer.DownloadAsync(&closure3);
+    ASSERT_TRUE(closure3.IsRun());
+    ASSERT_FALSE(closure3.IsFailed());
+    delete[] bigBuf;
+
+    EXPECT_CALL(*s3Client_, Deinit()).Times(1);
+    ASSERT_EQ(0, copyer.Fini());
+}
+
+TEST_F(CloneCopyerTest, CompressedS3Test) {
+    OriginCopyer copyer;
+    CopyerOptions options;
+    options.curveConf = CURVE_CONF;
+    options.s3Conf = S3_CONF;
+    options.curveUser.owner = ROOT_OWNER;
+    options.curveUser.password = ROOT_PWD;
+    options.curveClient = nullptr;
+    options.s3Client = s3Client_;
+    options.curveFileTimeoutSec = EXPIRED_USE;
+    ASSERT_EQ(0, copyer.Init(options));
+
+    std::string data(4 * BlockCompressor::kDefaultBlockSize, '\0');
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = 'a' + (i / 4096) % 26;
+    }
+    std::string object;
+    ASSERT_TRUE(BlockCompressor::Compress(curve::common::CompressType::SNAPPY,
+                                          data.data(), data.size(), &object));
+    auto getObject = [&] (const std::shared_ptr<GetObjectAsyncContext>& ctx) {
+        ASSERT_LE(ctx->offset + ctx->len, object.size());
+        memcpy(ctx->buf, object.data() + ctx->offset, ctx->len);
+        ctx->retCode = 0;
+        ctx->cb(s3Client_.get(), ctx);
+    };
+
+    /* 用例:读s3上压缩对象跨块的区域
+     * 预期:先读对象头，再读覆盖该区域的块，解压得到原始数据
+     */
+    const size_t size = 8192;
+    char buf[size];
+    off_t offset = BlockCompressor::kDefaultBlockSize - 4096;
+    AsyncDownloadContext context{"test@s3z", offset, size, buf};
+    MockDownloadClosure closure(&context);
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .Times(2)
+        .WillRepeatedly(Invoke(getObject));
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_FALSE(closure.IsFailed());
+    ASSERT_EQ(0, memcmp(data.data() + offset, buf, size));
+    closure.Reset();
+
+    /* 用例:对象头损坏
+     * 预期:返回失败，不再读取数据
+     */
+    object[0] = 0;
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .WillOnce(Invoke(getObject));
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_TRUE(closure.IsFailed());
+
+    EXPECT_CALL(*s3Client_, Deinit()).Times(1);
+    ASSERT_EQ(0, copyer.Fini());
+}
+
 }  // namespace chunkserver
 }  // namespace curve
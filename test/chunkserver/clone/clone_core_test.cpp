@@ -26,6 +26,7 @@
 #include <google/protobuf/stubs/callback.h>
 
 #include <tuple>
+#include <vector>
 
 #include "src/chunkserver/clone_core.h"
 #include "src/chunkserver/copyset_node.h"
@@ -298,7 +299,8 @@ TEST_P(CloneCoreTest, ReadChunkTest2) {
             .WillOnce(Invoke([&](DownloadClosure *closure) {
                 brpc::ClosureGuard guard(closure);
                 AsyncDownloadContext *context = closure->GetDownloadContext();
-                memcpy(context->buf, cloneData, length);
+                memcpy(context->buf, cloneData + context->offset - offset,
+                       context->size);
             }));
         EXPECT_CALL(*datastore_, GetChunkInfo(_, _))
             .Times(2)
@@ -330,7 +332,9 @@ TEST_P(CloneCoreTest, ReadChunkTest2) {
         ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
                   closure->resContent_.status);
 
-        CheckTask(task, offset, length, cloneData);
+        // 只下载并paste未写过的区域
+        CheckTask(task, offset + 3 * blocksize_, 2 * blocksize_,
+                  cloneData + 3 * blocksize_);
         // 正常propose后，会将closure交给并发层处理，
         // 由于这里node是mock的，因此需要主动来执行task.done.Run来释放资源
         ASSERT_NE(nullptr, task.done);
@@ -528,7 +532,8 @@ TEST_P(CloneCoreTest, ReadChunkErrorTest) {
             .WillOnce(Invoke([&](DownloadClosure *closure) {
                 brpc::ClosureGuard guard(closure);
                 AsyncDownloadContext *context = closure->GetDownloadContext();
-                memcpy(context->buf, cloneData, length);
+                memcpy(context->buf, cloneData + context->offset - offset,
+                       context->size);
             }));
         EXPECT_CALL(*datastore_, ReadChunk(_, _, _, _, _))
             .WillOnce(Return(CSErrorCode::InternalError));
@@ -547,7 +552,9 @@ TEST_P(CloneCoreTest, ReadChunkErrorTest) {
         ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_FAILURE_UNKNOWN,
                   closure->resContent_.status);
 
-        CheckTask(task, offset, length, cloneData);
+        // 只下载并paste未写过的区域
+        CheckTask(task, offset + 3 * blocksize_, 2 * blocksize_,
+                  cloneData + 3 * blocksize_);
         // 正常propose后，会将closure交给并发层处理，
         // 由于这里node是mock的，因此需要主动来执行task.done.Run来释放资源
         ASSERT_NE(nullptr, task.done);
@@ -597,6 +604,8 @@ TEST_P(CloneCoreTest, RecoverChunkTest1) {
  * result1:不会拷贝数据，直接返回成功
  * case2:请求恢复的区域全部或部分未被写过
  * result2:从远端拷贝数据，并产生paste请求
+ * case3:请求恢复的区域中有多段不连续的区域未被写过
+ * result3:每段区域分别从远端拷贝数据，产生一个paste请求
  */
 TEST_P(CloneCoreTest, RecoverChunkTest2) {
     off_t offset = 0;
@@ -676,6 +685,58 @@ TEST_P(CloneCoreTest, RecoverChunkTest2) {
         ASSERT_EQ(0, closure->resContent_.status);
         delete[] cloneData;
     }
+
+    // case3
+    {
+        info.bitmap->Clear();
+        info.bitmap->Set(1, 1);
+        info.bitmap->Set(3, 3);
+        // 每次调HandleReadRequest后会被closure释放
+        std::shared_ptr<ReadChunkRequest> readRequest = GenerateReadRequest(
+            CHUNK_OP_TYPE::CHUNK_OP_RECOVER, offset, length);  // NOLINT
+        // 已经写过的区域不会下载，paste时填0
+        char *cloneData = new char[length];
+        memset(cloneData, 'b', length);
+        memset(cloneData + blocksize_, 0, blocksize_);
+        memset(cloneData + 3 * blocksize_, 0, blocksize_);
+        std::vector<off_t> downloadOffsets;
+        EXPECT_CALL(*copyer_, DownloadAsync(_))
+            .Times(3)
+            .WillRepeatedly(Invoke([&](DownloadClosure *closure) {
+                brpc::ClosureGuard guard(closure);
+                AsyncDownloadContext *context = closure->GetDownloadContext();
+                ASSERT_EQ(blocksize_, context->size);
+                downloadOffsets.push_back(context->offset);
+                memcpy(context->buf, cloneData + context->offset - offset,
+                       context->size);
+            }));
+        EXPECT_CALL(*datastore_, GetChunkInfo(_, _))
+            .WillOnce(
+                DoAll(SetArgPointee<1>(info), Return(CSErrorCode::Success)));
+        // 不会读chunk文件
+        EXPECT_CALL(*datastore_, ReadChunk(_, _, _, _, _)).Times(0);
+        // 产生PasteChunkRequest
+        braft::Task task;
+        butil::IOBuf iobuf;
+        task.data = &iobuf;
+        EXPECT_CALL(*node_, Propose(_)).WillOnce(SaveBraftTask<0>(&task));
+
+        ASSERT_EQ(0,
+                  core->HandleReadRequest(readRequest, readRequest->Closure()));
+        FakeChunkClosure *closure =
+            reinterpret_cast<FakeChunkClosure *>(readRequest->Closure());
+        ASSERT_FALSE(closure->isDone_);
+        std::vector<off_t> expectOffsets = {
+            0, 2 * blocksize_, 4 * blocksize_};
+        ASSERT_EQ(expectOffsets, downloadOffsets);
+
+        CheckTask(task, offset, length, cloneData);
+        ASSERT_NE(nullptr, task.done);
+        task.done->Run();
+        ASSERT_TRUE(closure->isDone_);
+        ASSERT_EQ(0, closure->resContent_.status);
+        delete[] cloneData;
+    }
 }
 
 // case1: read chunk时，从远端拷贝数据，但是不会产生paste请求
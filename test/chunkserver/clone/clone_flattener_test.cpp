@@ -0,0 +1,105 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "src/chunkserver/clone_flattener.h"
+#include "src/chunkserver/clone_manager.h"
+#include "src/chunkserver/copyset_node_manager.h"
+
+namespace curve {
+namespace chunkserver {
+
+class CloneFlattenerTest : public testing::Test {
+ public:
+    void SetUp() {
+        options_.enable = true;
+        options_.copysetNodeManager = &CopysetNodeManager::GetInstance();
+        options_.cloneManager = &cloneManager_;
+    }
+
+ protected:
+    CloneFlattenerOptions options_;
+    CloneManager cloneManager_;
+};
+
+TEST_F(CloneFlattenerTest, InitTest) {
+    CloneFlattener flattener;
+    CloneFlattenerOptions options;
+    // 未开启时不检查参数
+    ASSERT_EQ(0, flattener.Init(options));
+    ASSERT_EQ(0, flattener.Run());
+    ASSERT_EQ(0, flattener.Fini());
+
+    options.enable = true;
+    ASSERT_EQ(-1, flattener.Init(options));
+    options_.concurrency = 0;
+    ASSERT_EQ(-1, flattener.Init(options_));
+    options_.concurrency = 4;
+    ASSERT_EQ(0, flattener.Init(options_));
+}
+
+TEST_F(CloneFlattenerTest, PickTargetsTest) {
+    CloneFlattener flattener;
+    ASSERT_EQ(0, flattener.Init(options_));
+
+    std::vector<FlattenTarget> targets;
+    flattener.PickTargets(4, &targets);
+    ASSERT_TRUE(targets.empty());
+
+    // 读得越多的chunk越先被选中
+    flattener.OnCloneRead(1, 1, 1);
+    for (int i = 0; i < 3; ++i) {
+        flattener.OnCloneRead(1, 1, 2);
+    }
+    flattener.OnCloneRead(1, 2, 3);
+    flattener.OnCloneRead(1, 2, 3);
+    flattener.PickTargets(2, &targets);
+    ASSERT_EQ(2, targets.size());
+    ASSERT_EQ((FlattenTarget{1, 1, 2}), targets[0]);
+    ASSERT_EQ((FlattenTarget{1, 2, 3}), targets[1]);
+
+    // 拷贝完的chunk不再被选中
+    flattener.RemoveTarget({1, 1, 2});
+    flattener.PickTargets(4, &targets);
+    ASSERT_EQ(2, targets.size());
+    ASSERT_EQ((FlattenTarget{1, 2, 3}), targets[0]);
+    ASSERT_EQ((FlattenTarget{1, 1, 1}), targets[1]);
+
+    // 热度衰减为0后，chunk仍然是待拷贝的chunk
+    flattener.DecayHeat();
+    flattener.OnCloneRead(1, 1, 1);
+    flattener.OnCloneRead(1, 1, 1);
+    flattener.PickTargets(4, &targets);
+    ASSERT_EQ(2, targets.size());
+    ASSERT_EQ((FlattenTarget{1, 1, 1}), targets[0]);
+    ASSERT_EQ((FlattenTarget{1, 2, 3}), targets[1]);
+}
+
+TEST_F(CloneFlattenerTest, DisableTest) {
+    CloneFlattener flattener;
+    options_.enable = false;
+    ASSERT_EQ(0, flattener.Init(options_));
+    flattener.OnCloneRead(1, 1, 1);
+    std::vector<FlattenTarget> targets;
+    flattener.PickTargets(4, &targets);
+    ASSERT_TRUE(targets.empty());
+}
+
+}  // namespace chunkserver
+}  // namespace curve
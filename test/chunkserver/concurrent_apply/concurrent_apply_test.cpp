@@ -24,6 +24,7 @@
 
 #include <atomic>
 #include <functional>
+#include <vector>
 
 #include "proto/chunk.pb.h"
 #include "src/common/timeutility.h"
@@ -166,3 +167,94 @@ TEST(ConcurrentApplyModule, ConcurrentTest) {
     concurrentapply.Stop();
 }
 
+
+TEST(ConcurrentApplyModule, SlotInitTest) {
+    ConcurrentApplyModule concurrentapply;
+    // init with invalid write-slotnum
+    ConcurrentApplyOption opt{1, 1, 1, 1, -1};
+    ASSERT_FALSE(concurrentapply.Init(opt));
+}
+
+TEST(ConcurrentApplyModule, SlotRunTest) {
+    ConcurrentApplyModule concurrentapply;
+    ConcurrentApplyOption opt{2, 1, 1, 1, 16};
+    ASSERT_TRUE(concurrentapply.Init(opt));
+
+    // a slow write should not block writes in other slots
+    std::atomic<bool> slowDone(false);
+    auto slowtask = [&slowDone]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        slowDone.store(true);
+    };
+    std::atomic<int> fastnum(0);
+    auto fasttask = [&fastnum]() {
+        fastnum.fetch_add(1);
+    };
+
+    ASSERT_TRUE(concurrentapply.Push(0, ApplyTaskType::WRITE, slowtask));
+    for (int i = 1; i < 16; i++) {
+        ASSERT_TRUE(concurrentapply.Push(i, ApplyTaskType::WRITE, fasttask));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    ASSERT_EQ(15, fastnum.load());
+    ASSERT_FALSE(slowDone.load());
+
+    concurrentapply.Flush();
+    ASSERT_TRUE(slowDone.load());
+
+    concurrentapply.Stop();
+}
+
+TEST(ConcurrentApplyModule, SlotOrderTest) {
+    ConcurrentApplyModule concurrentapply;
+    ConcurrentApplyOption opt{4, 2, 1, 1, 8};
+    ASSERT_TRUE(concurrentapply.Init(opt));
+
+    // tasks with the same key are executed in push order
+    const int keynum = 32;
+    const int tasknum = 1000;
+    std::vector<std::vector<int>> sequences(keynum);
+    for (int i = 0; i < tasknum; i++) {
+        for (int key = 0; key < keynum; key++) {
+            concurrentapply.Push(key, ApplyTaskType::WRITE,
+                                 [&sequences, key, i]() {
+                                     sequences[key].push_back(i);
+                                 });
+        }
+    }
+    concurrentapply.FlushAll();
+
+    for (int key = 0; key < keynum; key++) {
+        ASSERT_EQ(tasknum, sequences[key].size());
+        for (int i = 0; i < tasknum; i++) {
+            ASSERT_EQ(i, sequences[key][i]);
+        }
+    }
+
+    concurrentapply.Stop();
+}
+
+TEST(ConcurrentApplyModule, WorkStealingTest) {
+    ConcurrentApplyModule concurrentapply;
+    ConcurrentApplyOption opt{1, 1, 4, 16, 0, true};
+    ASSERT_TRUE(concurrentapply.Init(opt));
+
+    // all the reads are hashed into one queue, but they are executed
+    // by all the read threads
+    std::atomic<int> testr(0);
+    auto rtask = [&testr]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        testr.fetch_add(1);
+    };
+
+    uint64_t start = curve::common::TimeUtility::GetTimeofDayMs();
+    for (int i = 0; i < 16; i++) {
+        ASSERT_TRUE(concurrentapply.Push(0, ApplyTaskType::READ, rtask));
+    }
+    concurrentapply.FlushAll();
+    uint64_t cost = curve::common::TimeUtility::GetTimeofDayMs() - start;
+    ASSERT_EQ(16, testr.load());
+    ASSERT_LT(cost, 1000);
+
+    concurrentapply.Stop();
+}
@@ -148,6 +148,7 @@ class CopysetNodeTest : public ::testing::Test {
 
     void TearDown() {
         ::system("rm -rf copyset_node_test");
+        ::system((std::string("rm -f ") + kCurveDirtyChunkFilename).c_str());
     }
 
  protected:
@@ -344,7 +345,8 @@ TEST_F(CopysetNodeTest, error_test) {
         copysetNode.SetCSDateStore(dataStore);
 
         EXPECT_CALL(*mockfs, DirExists(_)).Times(1).WillOnce(Return(false));
-        EXPECT_CALL(*mockfs, FileExists(_)).Times(1).WillOnce(Return(false));
+        EXPECT_CALL(*mockfs, FileExists(_)).Times(2)
+            .WillRepeatedly(Return(false));
 
         ASSERT_EQ(0, copysetNode.on_snapshot_load(&reader));
         LOG(INFO) << "OK";
@@ -374,7 +376,8 @@ TEST_F(CopysetNodeTest, error_test) {
         dataStore->InjectError();
 
         EXPECT_CALL(*mockfs, DirExists(_)).Times(1).WillOnce(Return(false));
-        EXPECT_CALL(*mockfs, FileExists(_)).Times(1).WillOnce(Return(false));
+        EXPECT_CALL(*mockfs, FileExists(_)).Times(2)
+            .WillRepeatedly(Return(false));
 
         ASSERT_EQ(-1, copysetNode.on_snapshot_load(&reader));
         LOG(INFO) << "OK";
@@ -483,7 +486,9 @@ TEST_F(CopysetNodeTest, error_test) {
                     delete_file(_, _)).Times(1).WillOnce(Return(true));
         EXPECT_CALL(*cfa,
                     rename(_, _)).Times(1).WillOnce(Return(true));
-        EXPECT_CALL(*mockfs, FileExists(_)).Times(1)
+        // the first one checks incremental snapshot flag
+        EXPECT_CALL(*mockfs, FileExists(_)).Times(2)
+            .WillOnce(Return(false))
             .WillOnce(Return(true));
         EXPECT_CALL(*mockfs, Open(_, _)).Times(1)
             .WillOnce(Return(-1));
@@ -491,6 +496,38 @@ TEST_F(CopysetNodeTest, error_test) {
         ASSERT_EQ(-1, copysetNode.on_snapshot_load(&reader));
         LOG(INFO) << "OK";
     }
+
+    // on_snapshot_load: Dir exist, incremental snapshot,
+    // load dirty chunks failed
+    {
+        LogicPoolID logicPoolID = 1;
+        CopysetID copysetID = 1;
+        Configuration conf;
+
+        CopysetNode copysetNode(logicPoolID, copysetID, conf);
+        FakeSnapshotReader reader;
+        std::shared_ptr<MockLocalFileSystem>
+            mockfs = std::make_shared<MockLocalFileSystem>();
+        std::unique_ptr<DirtyChunkFile>
+            dirtyChunkFile(new DirtyChunkFile(mockfs));
+        MockCurveFilesystemAdaptor* cfa =
+            new MockCurveFilesystemAdaptor();
+        auto sfs = new scoped_refptr<braft::FileSystemAdaptor>(cfa);
+        copysetNode.SetSnapshotFileSystem(sfs);
+        copysetNode.SetLocalFileSystem(mockfs);
+        copysetNode.SetDirtyChunkFile(std::move(dirtyChunkFile));
+        EXPECT_CALL(*mockfs, DirExists(_)).Times(1)
+            .WillOnce(Return(true));
+        EXPECT_CALL(*mockfs, FileExists(_)).Times(1)
+            .WillOnce(Return(true));
+        EXPECT_CALL(*mockfs, Open(_, _)).Times(1)
+            .WillOnce(Return(-1));
+        // local chunk files are kept
+        EXPECT_CALL(*cfa, delete_file(_, _)).Times(0);
+        EXPECT_CALL(*cfa, rename(_, _)).Times(0);
+
+        ASSERT_EQ(-1, copysetNode.on_snapshot_load(&reader));
+    }
     /* on_error */
     {
         LogicPoolID logicPoolID = 123;
@@ -1082,6 +1119,55 @@ TEST_F(CopysetNodeTest, get_leader_status) {
     }
 }
 
+TEST_F(CopysetNodeTest, is_follower_readable) {
+    LogicPoolID logicPoolID = 1;
+    CopysetID copysetID = 1;
+    Configuration conf;
+    std::shared_ptr<MockNode> mockNode
+            = std::make_shared<MockNode>(logicPoolID,
+                                         copysetID);
+
+    // 未开启时不去获取leader的状态
+    {
+        CopysetNode copysetNode(logicPoolID, copysetID, conf);
+        copysetNode.Init(defaultOptions_);
+        copysetNode.SetCopysetNode(mockNode);
+        EXPECT_CALL(*mockNode, get_status(_)).Times(0);
+        ASSERT_FALSE(copysetNode.IsFollowerReadable());
+    }
+
+    CopysetNodeOptions options = defaultOptions_;
+    options.enableFollowerRead = true;
+    options.followerReadIndexCacheMs = 60 * 1000;
+    NodeStatus status;
+    status.leader_id.parse("127.0.0.1:3200:0");
+    status.peer_id = status.leader_id;
+
+    // 本地还没有apply到leader的committed index
+    {
+        CopysetNode copysetNode(logicPoolID, copysetID, conf);
+        copysetNode.Init(options);
+        copysetNode.SetCopysetNode(mockNode);
+        status.committed_index = 10;
+        EXPECT_CALL(*mockNode, get_status(_))
+        .WillOnce(SetArgPointee<0>(status));
+        ASSERT_FALSE(copysetNode.IsFollowerReadable());
+        // 缓存有效期内不再获取leader的状态
+        ASSERT_FALSE(copysetNode.IsFollowerReadable());
+    }
+
+    // 本地已经apply到leader的committed index
+    {
+        CopysetNode copysetNode(logicPoolID, copysetID, conf);
+        copysetNode.Init(options);
+        copysetNode.SetCopysetNode(mockNode);
+        status.committed_index = 0;
+        EXPECT_CALL(*mockNode, get_status(_))
+        .WillOnce(SetArgPointee<0>(status));
+        ASSERT_TRUE(copysetNode.IsFollowerReadable());
+    }
+}
+
 TEST_F(CopysetNodeTest, is_lease_leader) {
     LogicPoolID logicPoolID = 1;
     CopysetID copysetID = 1;
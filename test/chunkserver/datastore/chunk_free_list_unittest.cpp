@@ -0,0 +1,94 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "src/chunkserver/datastore/chunk_free_list.h"
+
+namespace curve {
+namespace chunkserver {
+
+TEST(ChunkFreeListTest, PushAndPop) {
+    ChunkFreeList freeList(4);
+    uint64_t chunkid = 0;
+    ASSERT_FALSE(freeList.Pop(false, &chunkid));
+    ASSERT_FALSE(freeList.Pop(true, &chunkid));
+
+    // clean and dirty chunks are kept apart
+    freeList.Push(1, false);
+    freeList.Push(2, true);
+    ASSERT_EQ(1, freeList.Size(false));
+    ASSERT_EQ(1, freeList.Size(true));
+    ASSERT_TRUE(freeList.Pop(true, &chunkid));
+    ASSERT_EQ(2, chunkid);
+    ASSERT_FALSE(freeList.Pop(true, &chunkid));
+    ASSERT_TRUE(freeList.Pop(false, &chunkid));
+    ASSERT_EQ(1, chunkid);
+
+    freeList.Push(3, false);
+    freeList.Push(4, true);
+    freeList.Clear();
+    ASSERT_EQ(0, freeList.Size(false));
+    ASSERT_EQ(0, freeList.Size(true));
+    ASSERT_FALSE(freeList.Pop(false, &chunkid));
+}
+
+TEST(ChunkFreeListTest, ConcurrentPop) {
+    const int threadNum = 8;
+    const int chunkNum = 10000;
+    ChunkFreeList freeList(threadNum);
+
+    // chunks pushed by one thread can be taken by the others
+    for (int i = 1; i <= chunkNum; ++i) {
+        freeList.Push(i, i % 2 == 0);
+    }
+
+    std::vector<std::vector<uint64_t>> taken(threadNum);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadNum; ++i) {
+        threads.emplace_back([&, i]() {
+            uint64_t chunkid;
+            while (freeList.Pop(i % 2 == 0, &chunkid) ||
+                   freeList.Pop(i % 2 != 0, &chunkid)) {
+                taken[i].push_back(chunkid);
+                // recycle some of them from another shard
+                if (chunkid % 3 == 0) {
+                    freeList.Push(chunkid + chunkNum, false);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::set<uint64_t> chunks;
+    for (auto& ids : taken) {
+        for (auto id : ids) {
+            ASSERT_TRUE(chunks.insert(id).second);
+        }
+    }
+    ASSERT_EQ(chunkNum + chunkNum / 3, chunks.size());
+    ASSERT_EQ(0, freeList.Size(false));
+    ASSERT_EQ(0, freeList.Size(true));
+}
+
+}  // namespace chunkserver
+}  // namespace curve
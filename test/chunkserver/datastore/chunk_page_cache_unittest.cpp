@@ -0,0 +1,109 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+#include "src/chunkserver/datastore/chunk_page_cache.h"
+
+namespace curve {
+namespace chunkserver {
+
+class ChunkPageCacheTest : public testing::Test {
+ public:
+    void SetUp() {
+        options_.capacity = 16 * 4096;
+        options_.pageSize = 4096;
+        options_.maxReadSize = 8 * 4096;
+    }
+
+ protected:
+    ChunkPageCacheOptions options_;
+};
+
+TEST_F(ChunkPageCacheTest, ReadAndFill) {
+    ChunkPageCache cache(options_);
+    std::string data(3 * 4096, 'a');
+    data[4096] = 'b';
+    char buf[3 * 4096];
+    ASSERT_FALSE(cache.Read(1, buf, 0, 4096));
+
+    // only the pages fully covered by the read are cached
+    uint64_t version = cache.GetVersion(1);
+    cache.Fill(1, version, data.c_str() + 512, 512, 2 * 4096);
+    ASSERT_FALSE(cache.Read(1, buf, 0, 4096));
+    ASSERT_TRUE(cache.Read(1, buf, 4096, 4096));
+    ASSERT_EQ('b', buf[0]);
+    ASSERT_FALSE(cache.Read(1, buf, 2 * 4096, 4096));
+
+    // unaligned reads inside cached pages
+    ASSERT_TRUE(cache.Read(1, buf, 4096, 512));
+    ASSERT_EQ(0, memcmp(buf, data.c_str() + 4096, 512));
+
+    // pages of other chunks are not mixed up
+    ASSERT_FALSE(cache.Read(2, buf, 4096, 4096));
+
+    ASSERT_FALSE(cache.Cacheable(0));
+    ASSERT_TRUE(cache.Cacheable(8 * 4096));
+    ASSERT_FALSE(cache.Cacheable(8 * 4096 + 1));
+}
+
+TEST_F(ChunkPageCacheTest, Invalidate) {
+    ChunkPageCache cache(options_);
+    std::string data(4 * 4096, 'a');
+    char buf[4096];
+    cache.Fill(1, cache.GetVersion(1), data.c_str(), 0, 4 * 4096);
+    ASSERT_TRUE(cache.Read(1, buf, 0, 4096));
+
+    // written pages are dropped
+    cache.Invalidate(1, 4096 + 512, 4096);
+    ASSERT_TRUE(cache.Read(1, buf, 0, 4096));
+    ASSERT_FALSE(cache.Read(1, buf, 4096, 4096));
+    ASSERT_FALSE(cache.Read(1, buf, 2 * 4096, 4096));
+    ASSERT_TRUE(cache.Read(1, buf, 3 * 4096, 4096));
+
+    // data read before a write is not cached
+    uint64_t version = cache.GetVersion(1);
+    cache.Invalidate(1, 4096, 4096);
+    cache.Fill(1, version, data.c_str(), 4096, 4096);
+    ASSERT_FALSE(cache.Read(1, buf, 4096, 4096));
+
+    cache.InvalidateChunk(1, 16 * 1024 * 1024);
+    ASSERT_FALSE(cache.Read(1, buf, 0, 4096));
+    ASSERT_FALSE(cache.Read(1, buf, 3 * 4096, 4096));
+}
+
+TEST_F(ChunkPageCacheTest, ScanResistant) {
+    ChunkPageCache cache(options_);
+    std::string data(4096, 'a');
+    char buf[4096];
+    // pages read twice are kept when a scan reads many pages once
+    for (int i = 0; i < 4; ++i) {
+        cache.Fill(1, cache.GetVersion(1), data.c_str(), i * 4096, 4096);
+        ASSERT_TRUE(cache.Read(1, buf, i * 4096, 4096));
+    }
+    for (int i = 0; i < 64; ++i) {
+        cache.Fill(2, cache.GetVersion(2), data.c_str(), i * 4096, 4096);
+    }
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(cache.Read(1, buf, i * 4096, 4096));
+    }
+}
+
+}  // namespace chunkserver
+}  // namespace curve
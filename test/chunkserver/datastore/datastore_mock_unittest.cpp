@@ -24,7 +24,9 @@
 #include <gmock/gmock.h>
 #include <string>
 #include <memory>
+#include <set>
 #include <tuple>
+#include <vector>
 
 #include "include/chunkserver/chunkserver_common.h"
 #include "src/common/bitmap.h"
@@ -674,6 +676,105 @@ TEST_P(CSDataStore_test, InitializeErrorTest5) {
     EXPECT_FALSE(dataStore->Initialize());
 }
 
+/**
+ * ForEachChunkTest
+ * case:遍历chunk的过程中删除chunk
+ * 预期结果:每个chunk都被访问一次，删除的chunk不再出现在chunk map中
+ */
+TEST_P(CSDataStore_test, ForEachChunkTest) {
+    // initialize
+    FakeEnv();
+    EXPECT_TRUE(dataStore->Initialize());
+
+    // chunk2 will be closed and recycled
+    EXPECT_CALL(*lfs_, Close(3))
+        .Times(1);
+    EXPECT_CALL(*fpool_, RecycleFile(chunk2Path))
+        .WillOnce(Return(0));
+
+    std::set<ChunkID> visited;
+    dataStore->ForEachChunk(
+        [&](ChunkID id, const CSChunkFilePtr& chunkFile) {
+            ASSERT_NE(nullptr, chunkFile);
+            ASSERT_TRUE(visited.insert(id).second);
+            // 遍历时不持有锁，可以删除chunk
+            if (id == 2) {
+                ASSERT_EQ(CSErrorCode::Success, dataStore->DeleteChunk(id, 3));
+            }
+        });
+    ASSERT_EQ(std::set<ChunkID>({1, 2}), visited);
+
+    ChunkMap chunkMap = dataStore->GetChunkMap();
+    ASSERT_EQ(1, chunkMap.size());
+    ASSERT_EQ(1, chunkMap.count(1));
+
+    EXPECT_CALL(*lfs_, Close(1))
+        .Times(1);
+    EXPECT_CALL(*lfs_, Close(2))
+        .Times(1);
+}
+
+/**
+ * SyncChunksTest
+ * case:未配置syncfs组时逐个sync chunk，配置后先回写所有chunk再syncfs一次
+ * 预期结果:不存在的chunk被跳过，回写失败时返回错误
+ */
+TEST_P(CSDataStore_test, SyncChunksTest) {
+    // initialize
+    FakeEnv();
+    EXPECT_TRUE(dataStore->Initialize());
+
+    // chunk1的fd为1，chunk2的fd为3，chunk 5不存在
+    std::vector<ChunkID> ids = {1, 2, 5};
+    EXPECT_CALL(*lfs_, Sync(1))
+        .WillOnce(Return(0));
+    EXPECT_CALL(*lfs_, Sync(3))
+        .WillOnce(Return(0));
+    EXPECT_CALL(*lfs_, SyncFs(_))
+        .Times(0);
+    ASSERT_EQ(CSErrorCode::Success, dataStore->SyncChunks(ids));
+
+    EXPECT_CALL(*lfs_, Close(1))
+        .Times(1);
+    EXPECT_CALL(*lfs_, Close(2))
+        .Times(1);
+    EXPECT_CALL(*lfs_, Close(3))
+        .Times(1);
+
+    DataStoreOptions options;
+    options.baseDir = baseDir;
+    options.chunkSize = chunksize_;
+    options.blockSize = blocksize_;
+    options.metaPageSize = metapagesize_;
+    options.locationLimit = kLocationLimit;
+    options.enableOdsyncWhenOpenChunkFile = true;
+    options.syncFsGroup = std::make_shared<SyncFsGroup>(lfs_);
+    dataStore = std::make_shared<CSDataStore>(lfs_, fpool_, options);
+    FakeEnv();
+    EXPECT_TRUE(dataStore->Initialize());
+
+    EXPECT_CALL(*lfs_, Sync(_))
+        .Times(0);
+    EXPECT_CALL(*lfs_, SyncFileRange(1, 0, 0))
+        .WillOnce(Return(0))
+        .WillOnce(Return(-1));
+    EXPECT_CALL(*lfs_, SyncFileRange(3, 0, 0))
+        .WillOnce(Return(0));
+    EXPECT_CALL(*lfs_, SyncFs(_))
+        .WillOnce(Return(0));
+    ASSERT_EQ(CSErrorCode::Success, dataStore->SyncChunks(ids));
+
+    // write back failed
+    ASSERT_EQ(CSErrorCode::InternalError, dataStore->SyncChunks(ids));
+
+    EXPECT_CALL(*lfs_, Close(1))
+        .Times(1);
+    EXPECT_CALL(*lfs_, Close(2))
+        .Times(1);
+    EXPECT_CALL(*lfs_, Close(3))
+        .Times(1);
+}
+
 /**
  * Test
  * case:chunk 不存在
@@ -2599,6 +2700,75 @@ TEST_P(CSDataStore_test, ReadChunkTest4) {
         .Times(1);
 }
 
+/**
+ * ReadChunkCrcTest
+ * case1:区域未被写过，缓存的crc最多被复用crcCacheMaxHits次
+ * 预期结果:复用次数用完后重新读盘计算crc
+ * case2:区域被写过
+ * 预期结果:缓存的crc失效，重新读盘计算crc
+ */
+TEST_P(CSDataStore_test, ReadChunkCrcTest) {
+    DataStoreOptions options;
+    options.baseDir = baseDir;
+    options.chunkSize = chunksize_;
+    options.blockSize = blocksize_;
+    options.metaPageSize = metapagesize_;
+    options.locationLimit = kLocationLimit;
+    options.crcCacheMaxHits = 2;
+    dataStore = std::make_shared<CSDataStore>(lfs_, fpool_, options);
+    // initialize
+    FakeEnv();
+    EXPECT_TRUE(dataStore->Initialize());
+
+    // chunk2没有快照，写入时不会cow
+    ChunkID id = 2;
+    SequenceNum sn = 2;
+    off_t offset = blocksize_;
+    size_t length = blocksize_;
+    std::unique_ptr<char[]> data(new char[length]);
+    memset(data.get(), 'a', length);
+    uint32_t crc = 0;
+
+    // case1
+    EXPECT_CALL(*lfs_, Read(3, NotNull(), offset + metapagesize_, length))
+        .Times(2)
+        .WillRepeatedly(DoAll(SetArrayArgument<1>(data.get(),
+                                                  data.get() + length),
+                              Return(length)));
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_EQ(CSErrorCode::Success,
+                  dataStore->ReadChunkCrc(id, sn, offset, length, &crc));
+        ASSERT_EQ(::curve::common::CRC32(data.get(), length), crc);
+    }
+
+    // case2
+    memset(data.get(), 'b', length);
+    EXPECT_CALL(*lfs_, Write(3, Matcher<butil::IOBuf>(_),
+                             metapagesize_ + offset, length))
+        .Times(1);
+    ASSERT_EQ(CSErrorCode::Success,
+              dataStore->WriteChunk(id, sn, data.get(), offset, length,
+                                    nullptr));
+    EXPECT_CALL(*lfs_, Read(3, NotNull(), offset + metapagesize_, length))
+        .WillOnce(DoAll(SetArrayArgument<1>(data.get(),
+                                            data.get() + length),
+                        Return(length)));
+    ASSERT_EQ(CSErrorCode::Success,
+              dataStore->ReadChunkCrc(id, sn, offset, length, &crc));
+    ASSERT_EQ(::curve::common::CRC32(data.get(), length), crc);
+
+    // chunk不存在
+    ASSERT_EQ(CSErrorCode::ChunkNotExistError,
+              dataStore->ReadChunkCrc(3, sn, offset, length, &crc));
+
+    EXPECT_CALL(*lfs_, Close(1))
+        .Times(1);
+    EXPECT_CALL(*lfs_, Close(2))
+        .Times(1);
+    EXPECT_CALL(*lfs_, Close(3))
+        .Times(1);
+}
+
 /**
  * ReadChunkErrorTest
  * case:读chunk文件时出错
@@ -3955,7 +4125,7 @@ TEST_P(CSDataStore_test, PasteChunkTest1) {
 
     // case3:chunk存在，但不是clone chunk
     {
-        EXPECT_CALL(*lfs_, Write(_, Matcher<const char*>(NotNull()), _, _))
+        EXPECT_CALL(*lfs_, Write(_, Matcher<butil::IOBuf>(_), _, _))
             .Times(0);
 
         // 快照不存在
@@ -3983,7 +4153,7 @@ TEST_P(CSDataStore_test, PasteChunkTest1) {
         id = 3;  // not exist
         offset = blocksize_;
         length = 2 * blocksize_;
-        EXPECT_CALL(*lfs_, Write(4, Matcher<const char*>(NotNull()),
+        EXPECT_CALL(*lfs_, Write(4, Matcher<butil::IOBuf>(_),
                                  metapagesize_ + offset, length))
             .Times(1);
         // update metapage
@@ -4008,7 +4178,7 @@ TEST_P(CSDataStore_test, PasteChunkTest1) {
         id = 3;  // not exist
         offset = blocksize_;
         length = 2 * blocksize_;
-        EXPECT_CALL(*lfs_, Write(4, Matcher<const char*>(NotNull()),
+        EXPECT_CALL(*lfs_, Write(4, Matcher<butil::IOBuf>(_),
                                  metapagesize_ + offset, length))
             .Times(0);
         EXPECT_CALL(*lfs_,
@@ -4032,10 +4202,10 @@ TEST_P(CSDataStore_test, PasteChunkTest1) {
         offset = 0;
         length = 4 * blocksize_;
         // [2 * blocksize_, 4 * blocksize_)区域已写过，[0, blocksize_)为metapage
-        EXPECT_CALL(*lfs_, Write(4, Matcher<const char*>(NotNull()),
+        EXPECT_CALL(*lfs_, Write(4, Matcher<butil::IOBuf>(_),
                                  metapagesize_, blocksize_))
             .Times(1);
-        EXPECT_CALL(*lfs_, Write(4, Matcher<const char*>(NotNull()),
+        EXPECT_CALL(*lfs_, Write(4, Matcher<butil::IOBuf>(_),
                                  metapagesize_ + 3 * blocksize_, blocksize_))
             .Times(1);
         EXPECT_CALL(*lfs_,
@@ -4057,7 +4227,7 @@ TEST_P(CSDataStore_test, PasteChunkTest1) {
         length = chunksize_;
         // [blocksize_, 4 * blocksize_)区域已写过，[0, blocksize_)为metapage
         EXPECT_CALL(*lfs_, Write(4,
-                                 Matcher<const char*>(NotNull()),
+                                 Matcher<butil::IOBuf>(_),
                                  metapagesize_ + 4 * blocksize_,
                                  chunksize_ - 4 * blocksize_))
             .Times(1);
@@ -4141,7 +4311,7 @@ TEST_P(CSDataStore_test, PasteChunkErrorTest1) {
         id = 3;  // not exist
         offset = blocksize_;
         length = 2 * blocksize_;
-        EXPECT_CALL(*lfs_, Write(4, Matcher<const char*>(NotNull()),
+        EXPECT_CALL(*lfs_, Write(4, Matcher<butil::IOBuf>(_),
                                  metapagesize_ + offset, length))
             .WillOnce(Return(-UT_ERRNO));
         // update metapage
@@ -4163,7 +4333,7 @@ TEST_P(CSDataStore_test, PasteChunkErrorTest1) {
         id = 3;  // not exist
         offset = blocksize_;
         length = 2 * blocksize_;
-        EXPECT_CALL(*lfs_, Write(4, Matcher<const char*>(NotNull()),
+        EXPECT_CALL(*lfs_, Write(4, Matcher<butil::IOBuf>(_),
                                  metapagesize_ + offset, length))
             .Times(1);
         // update metapage
@@ -631,6 +631,43 @@ TEST_P(CSFilePool_test, CleanChunkTest) {
     }
 }
 
+TEST_P(CSFilePool_test, CleanWatermarkTest) {
+    std::string filePool = "./cspooltest/filePool.meta";
+
+    FilePoolOptions cfop;
+    cfop.fileSize = 4096;
+    cfop.metaPageSize = 4096;
+    cfop.blockSize = 4096;
+    memcpy(cfop.metaPath, filePool.c_str(), filePool.size());
+    strncpy(cfop.filePoolDir, FILEPOOL_DIR, strlen(FILEPOOL_DIR) + 1);
+
+    // CASE 1: cleaning stops when clean chunks reach the watermark
+    cfop.needClean = true;
+    cfop.cleanWatermark = 55;
+    cfop.cleanLatencyThresholdUs = 1000 * 1000;
+    ASSERT_TRUE(chunkFilePoolPtr_->Initialize(cfop));
+    ASSERT_TRUE(chunkFilePoolPtr_->StartCleaning());
+    sleep(3);
+    auto currentStat = chunkFilePoolPtr_->GetState();
+    ASSERT_EQ(45, currentStat.dirtyChunksLeft);
+    ASSERT_EQ(55, currentStat.cleanChunksLeft);
+
+    // CASE 2: cleaning goes on after clean chunks are taken
+    char metapage[4096];
+    memset(metapage, '2', sizeof(metapage));
+    for (int i = 1; i <= 5; i++) {
+        std::string filename = "test" + std::to_string(i);
+        ASSERT_EQ(0, chunkFilePoolPtr_->GetFile(filename, metapage, true));
+        ASSERT_EQ(0, fsptr->Delete(filename));
+    }
+    sleep(3);
+    ASSERT_TRUE(chunkFilePoolPtr_->StopCleaning());
+    currentStat = chunkFilePoolPtr_->GetState();
+    ASSERT_EQ(40, currentStat.dirtyChunksLeft);
+    ASSERT_EQ(55, currentStat.cleanChunksLeft);
+    ASSERT_EQ(95, chunkFilePoolPtr_->Size());
+}
+
 INSTANTIATE_TEST_CASE_P(CSFilePoolTest,
                         CSFilePool_test,
                         ::testing::Values(false, true));
@@ -44,6 +44,11 @@ class MockDataStore : public CSDataStore {
                                         char*,
                                         off_t,
                                         size_t));
+    MOCK_METHOD5(ReadChunkCrc, CSErrorCode(ChunkID,
+                                           SequenceNum,
+                                           off_t,
+                                           size_t,
+                                           uint32_t*));
     MOCK_METHOD5(ReadSnapshotChunk, CSErrorCode(ChunkID,
                                                 SequenceNum,
                                                 char*,
@@ -62,7 +67,7 @@ class MockDataStore : public CSDataStore {
                                                ChunkSizeType,
                                                const string&));
     MOCK_METHOD4(PasteChunk, CSErrorCode(ChunkID,
-                                         const char*,
+                                         const butil::IOBuf&,
                                          off_t,
                                          size_t));
     MOCK_METHOD2(GetChunkInfo, CSErrorCode(ChunkID, CSChunkInfo*));
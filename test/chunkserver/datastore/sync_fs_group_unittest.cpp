@@ -0,0 +1,85 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "src/chunkserver/datastore/sync_fs_group.h"
+#include "test/fs/mock_local_filesystem.h"
+
+namespace curve {
+namespace chunkserver {
+
+using curve::fs::MockLocalFileSystem;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+
+TEST(SyncFsGroupTest, ShareSyncFs) {
+    auto lfs = std::make_shared<MockLocalFileSystem>();
+    SyncFsGroup group(lfs);
+
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<int> calls(0);
+    EXPECT_CALL(*lfs, SyncFs(_))
+        .WillRepeatedly(Invoke([&](int) {
+            if (calls++ == 0) {
+                started.set_value();
+                released.wait();
+            }
+            return 0;
+        }));
+
+    std::thread first([&]() { ASSERT_EQ(0, group.Sync(1)); });
+    started.get_future().wait();
+
+    // all arrive while the first syncfs is running, share the next one
+    std::vector<std::thread> others;
+    for (int i = 0; i < 4; ++i) {
+        others.emplace_back([&]() { ASSERT_EQ(0, group.Sync(1)); });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    release.set_value();
+    first.join();
+    for (auto& t : others) {
+        t.join();
+    }
+    ASSERT_EQ(2, calls.load());
+}
+
+TEST(SyncFsGroupTest, SyncFsFailed) {
+    auto lfs = std::make_shared<MockLocalFileSystem>();
+    SyncFsGroup group(lfs);
+
+    EXPECT_CALL(*lfs, SyncFs(3))
+        .WillOnce(Return(-5))
+        .WillOnce(Return(0));
+    ASSERT_EQ(-5, group.Sync(3));
+    // a later call issues a new syncfs
+    ASSERT_EQ(0, group.Sync(3));
+}
+
+}  // namespace chunkserver
+}  // namespace curve
@@ -112,6 +112,22 @@ class FakeCSDataStore : public CSDataStore {
         return CSErrorCode::Success;
     }
 
+    CSErrorCode ReadChunkCrc(ChunkID id,
+                             SequenceNum sn,
+                             off_t offset,
+                             size_t length,
+                             uint32_t* crc) override {
+        CSErrorCode errorCode = HasInjectError();
+        if (errorCode != CSErrorCode::Success) {
+            return errorCode;
+        }
+        if (chunkIds_.find(id) == chunkIds_.end()) {
+            return CSErrorCode::ChunkNotExistError;
+        }
+        *crc = ::curve::common::CRC32(chunk_ + offset, length);
+        return CSErrorCode::Success;
+    }
+
     CSErrorCode ReadSnapshotChunk(ChunkID id,
                                   SequenceNum sn,
                                   char *buf,
@@ -161,9 +177,9 @@ class FakeCSDataStore : public CSDataStore {
     }
 
     CSErrorCode PasteChunk(ChunkID id,
-                           const char * buf,
+                           const butil::IOBuf& buf,
                            off_t offset,
-                           size_t length) {
+                           size_t length) override {
         CSErrorCode errorCode = HasInjectError();
         if (errorCode != CSErrorCode::Success) {
             return errorCode;
@@ -171,7 +187,7 @@ class FakeCSDataStore : public CSDataStore {
         if (chunkIds_.find(id) == chunkIds_.end()) {
             return CSErrorCode::ChunkNotExistError;
         }
-        ::memcpy(chunk_+offset, buf, length);
+        buf.copy_to(chunk_+offset, length);
         return CSErrorCode::Success;
     }
 
@@ -467,6 +467,79 @@ TEST_F(CSMetricTest, OnResponseTest) {
     ASSERT_EQ(1, cpDownloadMetric->errorNum_.get_value());
 }
 
+TEST_F(CSMetricTest, OnStagesTest) {
+    CopysetID copysetId = 1;
+    ASSERT_EQ(0, metric_->CreateCopysetMetric(logicId, copysetId));
+    CopysetMetricPtr copysetMetric = metric_->GetCopysetMetric(logicId, copysetId);  // NOLINT
+    ASSERT_NE(copysetMetric, nullptr);
+
+    const StageMetricPtr serverWriteMetric =
+        metric_->GetStageMetric(CSIOMetricType::WRITE_CHUNK);
+    const StageMetricPtr serverReadMetric =
+        metric_->GetStageMetric(CSIOMetricType::READ_CHUNK);
+    const StageMetricPtr cpWriteMetric =
+        copysetMetric->GetStageMetric(CSIOMetricType::WRITE_CHUNK);
+    ASSERT_NE(serverWriteMetric, nullptr);
+    ASSERT_NE(serverReadMetric, nullptr);
+    ASSERT_NE(cpWriteMetric, nullptr);
+    // 只统计读写请求
+    ASSERT_EQ(nullptr, metric_->GetStageMetric(CSIOMetricType::PASTE_CHUNK));
+
+    // 经过raft的写请求统计所有阶段
+    OpStageTrace trace;
+    trace.receivedUs = 100;
+    trace.proposedUs = 110;
+    trace.committedUs = 200;
+    trace.applyStartUs = 250;
+    trace.storeDoneUs = 300;
+    metric_->OnStages(logicId, copysetId, CSIOMetricType::WRITE_CHUNK, trace);
+    ASSERT_EQ(1, serverWriteMetric->queueLatency_.count());
+    ASSERT_EQ(1, serverWriteMetric->commitLatency_.count());
+    ASSERT_EQ(1, serverWriteMetric->applyQueueLatency_.count());
+    ASSERT_EQ(1, serverWriteMetric->storeLatency_.count());
+    ASSERT_EQ(1, cpWriteMetric->storeLatency_.count());
+
+    // lease read的读请求没有commit阶段
+    trace.proposedUs = 0;
+    metric_->OnStages(logicId, copysetId, CSIOMetricType::READ_CHUNK, trace);
+    ASSERT_EQ(1, serverReadMetric->queueLatency_.count());
+    ASSERT_EQ(0, serverReadMetric->commitLatency_.count());
+    ASSERT_EQ(1, serverReadMetric->storeLatency_.count());
+
+    // 没有执行完的请求不统计
+    trace.storeDoneUs = 0;
+    metric_->OnStages(logicId, copysetId, CSIOMetricType::READ_CHUNK, trace);
+    ASSERT_EQ(1, serverReadMetric->queueLatency_.count());
+}
+
+TEST_F(CSMetricTest, SlowRequestTest) {
+    OpStageTrace trace;
+    trace.receivedUs = 1000;
+    trace.storeDoneUs = 1000 + 5000;
+    // 默认不打印慢请求
+    ASSERT_FALSE(metric_->SampleSlowRequest(trace));
+
+    ASSERT_EQ(0, metric_->Fini());
+    ChunkServerMetricOptions metricOptions;
+    metricOptions.port = PORT;
+    metricOptions.ip = IP;
+    metricOptions.collectMetric = true;
+    metricOptions.slowRequestThresholdMs = 5;
+    metricOptions.slowRequestSampleRate = 2;
+    ASSERT_EQ(0, metric_->Init(metricOptions));
+
+    // 每两个慢请求打印一次
+    int sampled = 0;
+    for (int i = 0; i < 4; ++i) {
+        sampled += metric_->SampleSlowRequest(trace) ? 1 : 0;
+    }
+    ASSERT_EQ(2, sampled);
+
+    // 没有超过阈值的请求不打印
+    trace.storeDoneUs = 1000 + 4999;
+    ASSERT_FALSE(metric_->SampleSlowRequest(trace));
+}
+
 TEST_F(CSMetricTest, CountTest) {
     // 初始状态下，没有copyset，FilePool中有chunkNum个chunk
     ASSERT_EQ(0, metric_->GetCopysetCount());
@@ -53,6 +53,7 @@ class MockCopysetNode : public CopysetNode {
     MOCK_METHOD1(GetHash, int(std::string*));
     MOCK_METHOD1(GetStatus, void(NodeStatus*));
     MOCK_METHOD1(GetLeaderStatus, bool(NodeStatus*));
+    MOCK_METHOD0(IsFollowerReadable, bool());
     MOCK_METHOD(void, GetLeaderLeaseStatus, (braft::LeaderLeaseStatus*), (override));  // NOLINT
     MOCK_CONST_METHOD0(GetDataStore, std::shared_ptr<CSDataStore>());
     MOCK_CONST_METHOD0(GetConcurrentApplyModule, ConcurrentApplyModule*());
@@ -0,0 +1,106 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "src/chunkserver/numa_affinity.h"
+
+namespace curve {
+namespace chunkserver {
+
+class NumaAffinityTest : public testing::Test {
+ public:
+    void SetUp() {
+        root_ = "./numa_affinity_test_sysfs";
+        ::system(("rm -rf " + root_).c_str());
+        ::system(("mkdir -p " + root_ + "/devices/system/node/node0 " +
+                  root_ + "/devices/system/node/node1 " +
+                  root_ + "/devices/system/node/node2").c_str());
+        WriteFile("/devices/system/node/node0/cpulist", "0-3,8-11\n");
+        WriteFile("/devices/system/node/node1/cpulist", "4-7,12\n");
+        // node without cpu
+        WriteFile("/devices/system/node/node2/cpulist", "\n");
+    }
+
+    void TearDown() {
+        ::system(("rm -rf " + root_).c_str());
+    }
+
+    void WriteFile(const std::string& path, const std::string& content) {
+        std::ofstream out(root_ + path);
+        out << content;
+    }
+
+ protected:
+    std::string root_;
+};
+
+TEST_F(NumaAffinityTest, ParseCpuList) {
+    std::vector<int> cpus;
+    ASSERT_TRUE(NumaAffinity::ParseCpuList("0-2,5,7-8\n", &cpus));
+    ASSERT_EQ(std::vector<int>({0, 1, 2, 5, 7, 8}), cpus);
+    ASSERT_TRUE(NumaAffinity::ParseCpuList("3", &cpus));
+    ASSERT_EQ(std::vector<int>({3}), cpus);
+    ASSERT_TRUE(NumaAffinity::ParseCpuList("", &cpus));
+    ASSERT_TRUE(cpus.empty());
+
+    ASSERT_FALSE(NumaAffinity::ParseCpuList("a-b", &cpus));
+    ASSERT_FALSE(NumaAffinity::ParseCpuList("3-1", &cpus));
+    ASSERT_FALSE(NumaAffinity::ParseCpuList("1,,2", &cpus));
+}
+
+TEST_F(NumaAffinityTest, LoadCpuNodes) {
+    std::vector<int> cpuNodes;
+    ASSERT_TRUE(NumaAffinity::LoadCpuNodes(root_, &cpuNodes));
+    ASSERT_EQ(13, cpuNodes.size());
+    for (int cpu : {0, 1, 2, 3, 8, 9, 10, 11}) {
+        ASSERT_EQ(0, cpuNodes[cpu]);
+    }
+    for (int cpu : {4, 5, 6, 7, 12}) {
+        ASSERT_EQ(1, cpuNodes[cpu]);
+    }
+
+    ASSERT_FALSE(NumaAffinity::LoadCpuNodes(root_ + "/none", &cpuNodes));
+}
+
+TEST_F(NumaAffinityTest, InitFail) {
+    NumaAffinityOptions options;
+    options.sysfsRoot = root_;
+    // disabled
+    ASSERT_EQ(0, NumaAffinity::GetInstance()->Init(options));
+    ASSERT_EQ(-1, NumaAffinity::GetInstance()->GetNode());
+
+    options.enable = true;
+    // node without cpu
+    options.node = 2;
+    ASSERT_EQ(-1, NumaAffinity::GetInstance()->Init(options));
+    // the disk is not in the fake sysfs
+    options.node = -1;
+    options.dataDir = root_ + "/not_exist/copysets";
+    ASSERT_EQ(-1, NumaAffinity::GetInstance()->Init(options));
+    ASSERT_EQ(-1, NumaAffinity::GetInstance()->GetNode());
+
+    // nothing is recorded when not bound
+    NumaAffinity::GetInstance()->RecordCpu();
+}
+
+}  // namespace chunkserver
+}  // namespace curve
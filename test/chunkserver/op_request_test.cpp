@@ -834,5 +834,148 @@ TEST(ChunkOpRequestTest, OnApplyFromLogTest) {
     }
 }
 
+TEST(ChunkOpRequestTest, WriteChunkBatchTest) {
+    LogicPoolID logicPoolId = 1;
+    CopysetID copysetId = 10001;
+    uint64_t chunkId = 12345;
+    uint32_t blockSize = 4 * 1024;
+    uint32_t chunkSize = 16 * 1024 * 1024;
+    uint64_t sn = 1;
+
+    Configuration conf;
+    std::shared_ptr<CopysetNode> nodePtr =
+        std::make_shared<CopysetNode>(logicPoolId, copysetId, conf);
+    std::shared_ptr<LocalFileSystem> fs(LocalFsFactory::CreateFs(FileSystemType::EXT4, ""));    //NOLINT
+    DataStoreOptions options;
+    options.baseDir = "./test-temp";
+    options.chunkSize = chunkSize;
+    options.metaPageSize = 4 * 1024;
+    options.blockSize = blockSize;
+    std::shared_ptr<FakeCSDataStore> dataStore =
+        std::make_shared<FakeCSDataStore>(options, fs);
+    nodePtr->SetCSDateStore(dataStore);
+
+    auto makeRequest = [&](off_t offset, uint32_t size, ChunkRequest *req) {
+        req->set_optype(CHUNK_OP_TYPE::CHUNK_OP_WRITE);
+        req->set_logicpoolid(logicPoolId);
+        req->set_copysetid(copysetId);
+        req->set_chunkid(chunkId);
+        req->set_offset(offset);
+        req->set_size(size);
+        req->set_sn(sn);
+    };
+
+    ChunkRequest request1;
+    ChunkRequest request3;
+    ChunkResponse response1;
+    ChunkResponse response3;
+    makeRequest(0, blockSize, &request1);
+    makeRequest(2 * blockSize, blockSize, &request3);
+    brpc::Controller cntl1;
+    brpc::Controller cntl3;
+    cntl1.request_attachment().append(std::string(blockSize, 'a'));
+    cntl3.request_attachment().append(std::string(blockSize, 'c'));
+    std::shared_ptr<ChunkOpRequest> opReq1 =
+        std::make_shared<WriteChunkRequest>(nodePtr, &cntl1, &request1,
+                                            &response1, nullptr);
+    std::shared_ptr<ChunkOpRequest> opReq3 =
+        std::make_shared<WriteChunkRequest>(nodePtr, &cntl3, &request3,
+                                            &response3, nullptr);
+    OpFakeClosure done1;
+    OpFakeClosure done3;
+
+    // 1. requests which can't be merged
+    {
+        WriteChunkBatch batch(blockSize, chunkSize, 3 * blockSize);
+        butil::IOBuf data;
+        data.append(std::string(blockSize, 'x'));
+        ChunkRequest request;
+        // unaligned
+        makeRequest(1, blockSize, &request);
+        ASSERT_FALSE(batch.Add(&request, data));
+        // out of chunk
+        makeRequest(chunkSize, blockSize, &request);
+        ASSERT_FALSE(batch.Add(&request, data));
+        // size mismatch
+        makeRequest(0, 2 * blockSize, &request);
+        ASSERT_FALSE(batch.Add(&request, data));
+        // clone
+        makeRequest(0, blockSize, &request);
+        request.set_clonefilesource("/test");
+        request.set_clonefileoffset(0);
+        ASSERT_FALSE(batch.Add(&request, data));
+        // read
+        makeRequest(0, blockSize, &request);
+        request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_READ);
+        ASSERT_FALSE(batch.Add(&request, data));
+        ASSERT_TRUE(batch.Empty());
+    }
+    // 2. adjacent writes are merged into one write
+    {
+        WriteChunkBatch batch(blockSize, chunkSize, 3 * blockSize);
+        ASSERT_TRUE(batch.Add(opReq1, 10, &done1));
+        ChunkRequest request2;
+        makeRequest(blockSize, blockSize, &request2);
+        butil::IOBuf data2;
+        data2.append(std::string(blockSize, 'b'));
+        ASSERT_TRUE(batch.Add(&request2, data2));
+        ASSERT_TRUE(batch.Add(opReq3, 12, &done3));
+
+        ChunkRequest request;
+        butil::IOBuf data;
+        data.append(std::string(blockSize, 'x'));
+        // exceed max size
+        makeRequest(3 * blockSize, blockSize, &request);
+        ASSERT_FALSE(batch.Add(&request, data));
+        // not adjacent
+        makeRequest(4 * blockSize, blockSize, &request);
+        ASSERT_FALSE(batch.Add(&request, data));
+        // different sn
+        makeRequest(3 * blockSize, blockSize, &request);
+        request.set_sn(sn + 1);
+        ASSERT_FALSE(batch.Add(&request, data));
+        // different chunk
+        makeRequest(3 * blockSize, blockSize, &request);
+        request.set_chunkid(chunkId + 1);
+        ASSERT_FALSE(batch.Add(&request, data));
+        ASSERT_EQ(3, batch.Size());
+        ASSERT_EQ(chunkId, batch.ChunkId());
+
+        batch.Apply(dataStore);
+        ASSERT_TRUE(batch.Empty());
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                  response1.status());
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                  response3.status());
+        ASSERT_EQ(12, nodePtr->GetAppliedIndex());
+
+        std::string expect = std::string(blockSize, 'a') +
+                             std::string(blockSize, 'b') +
+                             std::string(blockSize, 'c');
+        std::string buf(3 * blockSize, 0);
+        ASSERT_EQ(CSErrorCode::Success,
+                  dataStore->ReadChunk(chunkId, sn, &buf[0],
+                                       0, 3 * blockSize));
+        ASSERT_EQ(expect, buf);
+    }
+    // 3. every request gets the result of the merged write
+    {
+        response1.Clear();
+        response3.Clear();
+        WriteChunkBatch batch(blockSize, chunkSize, 3 * blockSize);
+        ASSERT_TRUE(batch.Add(opReq1, 13, &done1));
+        request3.set_offset(blockSize);
+        ASSERT_TRUE(batch.Add(opReq3, 14, &done3));
+        // injected error only takes effect once
+        dataStore->InjectError(CSErrorCode::BackwardRequestError);
+        batch.Apply(dataStore);
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_BACKWARD,
+                  response1.status());
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_BACKWARD,
+                  response3.status());
+        ASSERT_EQ(12, nodePtr->GetAppliedIndex());
+    }
+}
+
 }  // namespace chunkserver
 }  // namespace curve
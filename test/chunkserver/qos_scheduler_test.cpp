@@ -0,0 +1,223 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>  // NOLINT
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "src/chunkserver/qos_scheduler.h"
+#include "src/common/timeutility.h"
+
+namespace curve {
+namespace chunkserver {
+
+using curve::common::TimeUtility;
+
+// 记录被调度执行的请求，由测试决定请求何时完成
+class QosSchedulerTest : public testing::Test {
+ public:
+    QosScheduler::Task MakeTask(CopysetID copysetId) {
+        return [this, copysetId](google::protobuf::Closure* done) {
+            std::lock_guard<std::mutex> lk(mtx_);
+            executed_.push_back(copysetId);
+            dones_.push_back(done);
+        };
+    }
+
+    size_t ExecutedNum() {
+        std::lock_guard<std::mutex> lk(mtx_);
+        return executed_.size();
+    }
+
+    // 等待至少num个请求被执行
+    bool WaitExecuted(size_t num, uint64_t timeoutMs = 1000) {
+        uint64_t start = TimeUtility::GetTimeofDayMs();
+        while (ExecutedNum() < num) {
+            if (TimeUtility::GetTimeofDayMs() - start > timeoutMs) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    // 完成最早执行的未完成请求
+    void CompleteOne() {
+        google::protobuf::Closure* done = nullptr;
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            ASSERT_LT(completed_, dones_.size());
+            done = dones_[completed_++];
+        }
+        done->Run();
+    }
+
+    // 逐个完成所有请求，每次等下一个请求被调度执行
+    void CompleteAll(size_t total) {
+        while (completed_ < total) {
+            ASSERT_TRUE(WaitExecuted(completed_ + 1));
+            CompleteOne();
+        }
+    }
+
+    std::vector<CopysetID> Executed() {
+        std::lock_guard<std::mutex> lk(mtx_);
+        return executed_;
+    }
+
+ protected:
+    std::mutex mtx_;
+    std::vector<CopysetID> executed_;
+    std::vector<google::protobuf::Closure*> dones_;
+    size_t completed_ = 0;
+};
+
+TEST_F(QosSchedulerTest, InitTest) {
+    QosScheduler scheduler;
+    QosSchedulerOptions options;
+    options.maxInflight = 0;
+    ASSERT_EQ(-1, scheduler.Init(options));
+    options.maxInflight = 1;
+    options.maxQueueDepth = 0;
+    ASSERT_EQ(-1, scheduler.Init(options));
+    options.maxQueueDepth = 1;
+    ASSERT_EQ(0, scheduler.Init(options));
+}
+
+TEST_F(QosSchedulerTest, QueueTest) {
+    QosScheduler scheduler;
+    QosSchedulerOptions options;
+    options.maxInflight = 2;
+    options.maxQueueDepth = 2;
+    ASSERT_EQ(0, scheduler.Init(options));
+
+    // 未超过inflight上限时直接执行
+    ASSERT_TRUE(scheduler.Submit(1, 1, nullptr, MakeTask(1)));
+    ASSERT_TRUE(scheduler.Submit(1, 2, nullptr, MakeTask(2)));
+    ASSERT_EQ(2, ExecutedNum());
+    ASSERT_EQ(2, scheduler.GetInflight());
+
+    // 超过后排队，一个copyset的队列满了不影响其他copyset
+    ASSERT_TRUE(scheduler.Submit(1, 1, nullptr, MakeTask(1)));
+    ASSERT_TRUE(scheduler.Submit(1, 1, nullptr, MakeTask(1)));
+    ASSERT_FALSE(scheduler.Submit(1, 1, nullptr, MakeTask(1)));
+    ASSERT_TRUE(scheduler.Submit(1, 2, nullptr, MakeTask(2)));
+    ASSERT_EQ(2, scheduler.GetQueued(1, 1));
+    ASSERT_EQ(1, scheduler.GetQueued(1, 2));
+    ASSERT_EQ(2, ExecutedNum());
+
+    // 请求完成后调度排队的请求
+    CompleteOne();
+    ASSERT_TRUE(WaitExecuted(3));
+    ASSERT_EQ(2, scheduler.GetInflight());
+
+    // 停止后排队的请求全部执行
+    scheduler.Fini();
+    ASSERT_TRUE(WaitExecuted(5));
+    ASSERT_EQ(0, scheduler.GetQueued(1, 1));
+    ASSERT_EQ(0, scheduler.GetQueued(1, 2));
+    CompleteAll(5);
+    ASSERT_EQ(0, scheduler.GetInflight());
+}
+
+TEST_F(QosSchedulerTest, WeightTest) {
+    QosScheduler scheduler;
+    QosSchedulerOptions options;
+    options.maxInflight = 1;
+    ASSERT_EQ(0, scheduler.Init(options));
+    QosParams params;
+    params.weight = 4;
+    scheduler.UpdateParams(1, 2, params);
+
+    // 占住处理能力，让请求都排队
+    ASSERT_TRUE(scheduler.Submit(1, 0, nullptr, MakeTask(0)));
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(scheduler.Submit(1, 1, nullptr, MakeTask(1)));
+        ASSERT_TRUE(scheduler.Submit(1, 2, nullptr, MakeTask(2)));
+    }
+
+    // 权重为4的copyset分到的处理能力是权重为1的4倍
+    for (size_t i = 1; i <= 5; ++i) {
+        CompleteOne();
+        ASSERT_TRUE(WaitExecuted(i + 1));
+    }
+    std::vector<CopysetID> executed = Executed();
+    int weighted = 0;
+    for (size_t i = 1; i <= 5; ++i) {
+        if (executed[i] == 2) {
+            ++weighted;
+        }
+    }
+    ASSERT_EQ(4, weighted);
+
+    CompleteAll(9);
+    ASSERT_EQ(0, scheduler.GetInflight());
+}
+
+TEST_F(QosSchedulerTest, ReservationTest) {
+    QosScheduler scheduler;
+    QosSchedulerOptions options;
+    options.maxInflight = 1;
+    ASSERT_EQ(0, scheduler.Init(options));
+    QosParams params;
+    params.weight = 100;
+    scheduler.UpdateParams(1, 1, params);
+    params.weight = 1;
+    params.reservation = 1000;
+    scheduler.UpdateParams(1, 2, params);
+
+    ASSERT_TRUE(scheduler.Submit(1, 0, nullptr, MakeTask(0)));
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(scheduler.Submit(1, 1, nullptr, MakeTask(1)));
+    }
+    ASSERT_TRUE(scheduler.Submit(1, 2, nullptr, MakeTask(2)));
+
+    // 有保证的copyset权重低也会先被处理
+    CompleteOne();
+    ASSERT_TRUE(WaitExecuted(2));
+    ASSERT_EQ(2, Executed()[1]);
+
+    CompleteAll(6);
+    ASSERT_EQ(0, scheduler.GetInflight());
+}
+
+TEST_F(QosSchedulerTest, LimitTest) {
+    QosScheduler scheduler;
+    QosSchedulerOptions options;
+    ASSERT_EQ(0, scheduler.Init(options));
+    QosParams params;
+    params.limit = 10;
+    scheduler.UpdateParams(1, 1, params);
+
+    uint64_t start = TimeUtility::GetTimeofDayMs();
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(scheduler.Submit(1, 1, nullptr, MakeTask(1)));
+    }
+    // 其他copyset不受影响
+    ASSERT_TRUE(scheduler.Submit(1, 2, nullptr, MakeTask(2)));
+    ASSERT_EQ(2, ExecutedNum());
+
+    // 每秒最多处理10个请求，剩下的两个请求在200ms后处理完
+    ASSERT_TRUE(WaitExecuted(4, 2000));
+    ASSERT_GE(TimeUtility::GetTimeofDayMs() - start, 150);
+    CompleteAll(4);
+}
+
+}  // namespace chunkserver
+}  // namespace curve
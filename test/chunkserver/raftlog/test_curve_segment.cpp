@@ -27,6 +27,7 @@
 // Date: 2015/10/08 17:00:05
 
 #include <fcntl.h>
+#include <unistd.h>
 #include <gtest/gtest.h>
 #include <braft/log.h>
 #include <memory>
@@ -234,5 +235,117 @@ TEST_F(CurveSegmentTest, closed_segment) {
     delete configuration_manager;
 }
 
+TEST_F(CurveSegmentTest, append_entries_batch) {
+    EXPECT_CALL(*file_pool, GetFilePoolOpt())
+        .WillRepeatedly(Return(fp_option));
+    EXPECT_CALL(*file_pool, GetFileImpl(_, _))
+        .WillOnce(Return(0));
+    EXPECT_CALL(*file_pool, RecycleFile(_))
+        .WillOnce(Return(0));
+    scoped_refptr<CurveSegment> seg1 =
+                new CurveSegment(kRaftLogDataDir, 1, 0, file_pool);
+
+    std::string path = kRaftLogDataDir;
+    butil::string_appendf(&path, "/" CURVE_SEGMENT_OPEN_PATTERN, 1L);
+    ASSERT_EQ(0, prepare_segment(path));
+    ASSERT_EQ(0, seg1->create());
+
+    // append 10 entries with one write
+    std::vector<braft::LogEntry*> entries;
+    for (int i = 0; i < 10; i++) {
+        braft::LogEntry* entry = new braft::LogEntry();
+        entry->AddRef();
+        entry->type = braft::ENTRY_TYPE_DATA;
+        entry->id.term = 1;
+        entry->id.index = i + 1;
+
+        char data_buf[128];
+        snprintf(data_buf, sizeof(data_buf), "hello, world: %d", i + 1);
+        entry->data.append(data_buf);
+        entries.push_back(entry);
+    }
+    ASSERT_EQ(0, seg1->append_entries(entries.data(), entries.size()));
+    ASSERT_EQ(10, seg1->last_index());
+    size_t entry_size =
+        CurveSegment::aligned_entry_size(entries[0]->data.size());
+    ASSERT_EQ(static_cast<int64_t>(kPageSize + 10 * entry_size),
+              seg1->bytes());
+
+    for (auto entry : entries) {
+        entry->Release();
+    }
+    read_entries_curve_segment(seg1);
+
+    // entries are loaded as they are appended one by one
+    braft::ConfigurationManager* configuration_manager =
+                                new braft::ConfigurationManager;
+    scoped_refptr<CurveSegment> seg2 =
+                        new CurveSegment(kRaftLogDataDir, 1, 0, file_pool);
+    ASSERT_EQ(0, seg2->load(configuration_manager));
+    read_entries_curve_segment(seg2);
+    append_entries_curve_segment(seg1, "hello, world: %d", 10, 12);
+    read_entries_curve_segment(seg1, "hello, world: %d", 0, 12);
+    ASSERT_EQ(0, seg1->close());
+    ASSERT_EQ(0, seg1->unlink());
+
+    delete configuration_manager;
+}
+
+TEST_F(CurveSegmentTest, closed_segment_index) {
+    EXPECT_CALL(*file_pool, GetFilePoolOpt())
+        .WillRepeatedly(Return(fp_option));
+    EXPECT_CALL(*file_pool, GetFileImpl(_, _))
+        .WillOnce(Return(0));
+    EXPECT_CALL(*file_pool, RecycleFile(_))
+        .WillOnce(Return(0));
+    scoped_refptr<CurveSegment> seg1 =
+                new CurveSegment(kRaftLogDataDir, 1, 0, file_pool);
+
+    std::string path = kRaftLogDataDir;
+    butil::string_appendf(&path, "/" CURVE_SEGMENT_OPEN_PATTERN, 1L);
+    ASSERT_EQ(0, prepare_segment(path));
+    ASSERT_EQ(0, seg1->create());
+    append_entries_curve_segment(seg1);
+    const int64_t bytes = seg1->bytes();
+    ASSERT_EQ(0, seg1->close());
+    seg1 = nullptr;
+
+    // load closed segment from the index
+    braft::ConfigurationManager* configuration_manager =
+                                new braft::ConfigurationManager;
+    scoped_refptr<CurveSegment> seg2 =
+                        new CurveSegment(kRaftLogDataDir, 1, 10, 0, file_pool);
+    ASSERT_EQ(0, seg2->load(configuration_manager));
+    ASSERT_EQ(bytes, seg2->bytes());
+    read_entries_curve_segment(seg2);
+    ASSERT_TRUE(seg2->get(11) == NULL);
+    seg2 = nullptr;
+
+    // load closed segment by scanning entries if the index is corrupted
+    std::string closed_path = kRaftLogDataDir;
+    butil::string_appendf(&closed_path, "/" CURVE_SEGMENT_CLOSED_PATTERN,
+                          1L, 10L);
+    int fd = ::open(closed_path.c_str(), O_RDWR);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(4, ::pwrite(fd, "xxxx", 4, bytes));
+    ::close(fd);
+    seg2 = new CurveSegment(kRaftLogDataDir, 1, 10, 0, file_pool);
+    ASSERT_EQ(0, seg2->load(configuration_manager));
+    read_entries_curve_segment(seg2);
+
+    // truncate a closed segment, the segment is open again
+    seg2 = nullptr;
+    seg2 = new CurveSegment(kRaftLogDataDir, 1, 10, 0, file_pool);
+    ASSERT_EQ(0, seg2->load(configuration_manager));
+    ASSERT_EQ(0, seg2->truncate(5));
+    ASSERT_TRUE(seg2->is_open());
+    append_entries_curve_segment(seg2, "HELLO, WORLD: %d", 5, 10);
+    read_entries_curve_segment(seg2, "hello, world: %d", 0, 5);
+    read_entries_curve_segment(seg2, "HELLO, WORLD: %d", 5, 10);
+    ASSERT_EQ(0, seg2->unlink());
+
+    delete configuration_manager;
+}
+
 }  // namespace chunkserver
 }  // namespace curve
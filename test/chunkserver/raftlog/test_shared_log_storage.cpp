@@ -0,0 +1,248 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <braft/configuration_manager.h>
+#include <butil/strings/stringprintf.h>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/chunkserver/raftlog/shared_log_storage.h"
+
+namespace curve {
+namespace chunkserver {
+
+const char kSharedLogDataDir[] = "./shared-log-data";
+const char kSharedWalDir[] = "./shared-log-data/wal";
+
+class SharedLogStorageTest : public testing::Test {
+ protected:
+    void SetUp() {
+        std::string cmd = std::string("mkdir -p ") + kSharedLogDataDir;
+        ::system(cmd.c_str());
+        stream_ = NewStream();
+    }
+    void TearDown() {
+        std::string cmd = std::string("rm -rf ") + kSharedLogDataDir;
+        ::system(cmd.c_str());
+    }
+    std::shared_ptr<SharedLogStream> NewStream(
+        uint64_t maxFileSize = 1024 * 1024) {
+        auto stream =
+            std::make_shared<SharedLogStream>(kSharedWalDir, maxFileSize);
+        EXPECT_EQ(0, stream->Init());
+        return stream;
+    }
+    std::shared_ptr<SharedLogStorage> NewStorage(
+        uint64_t groupId, std::shared_ptr<SharedLogStream> stream) {
+        std::string path = std::string(kSharedLogDataDir) + "/copysets/" +
+                           std::to_string(groupId) + "/log";
+        auto storage = std::make_shared<SharedLogStorage>(path, stream);
+        braft::ConfigurationManager configurationManager;
+        EXPECT_EQ(0, storage->init(&configurationManager));
+        return storage;
+    }
+    void AppendEntries(std::shared_ptr<SharedLogStorage> storage,
+                       int64_t start, int count, int64_t term = 1,
+                       const char* pattern = "hello, world: %ld") {
+        std::vector<braft::LogEntry*> entries;
+        for (int i = 0; i < count; ++i) {
+            braft::LogEntry* entry = new braft::LogEntry();
+            entry->AddRef();
+            entry->type = braft::ENTRY_TYPE_DATA;
+            entry->id.term = term;
+            entry->id.index = start + i;
+            char dataBuf[128];
+            snprintf(dataBuf, sizeof(dataBuf), pattern, start + i);
+            entry->data.append(dataBuf);
+            entries.push_back(entry);
+        }
+        ASSERT_EQ(count, storage->append_entries(entries, nullptr));
+        for (auto entry : entries) {
+            entry->Release();
+        }
+    }
+    void CheckEntries(std::shared_ptr<SharedLogStorage> storage,
+                      int64_t start, int64_t end, int64_t term = 1,
+                      const char* pattern = "hello, world: %ld") {
+        for (int64_t i = start; i <= end; ++i) {
+            ASSERT_EQ(term, storage->get_term(i));
+            braft::LogEntry* entry = storage->get_entry(i);
+            ASSERT_NE(nullptr, entry);
+            ASSERT_EQ(i, entry->id.index);
+            ASSERT_EQ(term, entry->id.term);
+            char dataBuf[128];
+            snprintf(dataBuf, sizeof(dataBuf), pattern, i);
+            ASSERT_EQ(dataBuf, entry->data.to_string());
+            entry->Release();
+        }
+    }
+
+    std::shared_ptr<SharedLogStream> stream_;
+};
+
+TEST_F(SharedLogStorageTest, append_and_load) {
+    auto storage1 = NewStorage(1, stream_);
+    auto storage2 = NewStorage(2, stream_);
+    ASSERT_EQ(1, storage1->first_log_index());
+    ASSERT_EQ(0, storage1->last_log_index());
+
+    // entries of two copysets are interleaved in the stream
+    for (int i = 0; i < 10; ++i) {
+        AppendEntries(storage1, 1 + i * 10, 10);
+        AppendEntries(storage2, 1 + i * 5, 5, 1, "HELLO, WORLD: %ld");
+    }
+    ASSERT_EQ(100, storage1->last_log_index());
+    ASSERT_EQ(50, storage2->last_log_index());
+    CheckEntries(storage1, 1, 100);
+    CheckEntries(storage2, 1, 50, 1, "HELLO, WORLD: %ld");
+    ASSERT_EQ(nullptr, storage1->get_entry(101));
+    ASSERT_EQ(0, storage1->get_term(0));
+
+    // load again
+    storage1.reset();
+    storage2.reset();
+    stream_.reset();
+    stream_ = NewStream();
+    storage1 = NewStorage(1, stream_);
+    storage2 = NewStorage(2, stream_);
+    ASSERT_EQ(1, storage1->first_log_index());
+    ASSERT_EQ(100, storage1->last_log_index());
+    ASSERT_EQ(50, storage2->last_log_index());
+    CheckEntries(storage1, 1, 100);
+    CheckEntries(storage2, 1, 50, 1, "HELLO, WORLD: %ld");
+}
+
+TEST_F(SharedLogStorageTest, truncate_and_reset) {
+    auto storage1 = NewStorage(1, stream_);
+    auto storage2 = NewStorage(2, stream_);
+    AppendEntries(storage1, 1, 100);
+    AppendEntries(storage2, 1, 100);
+
+    // truncate suffix and append entries of a new term
+    ASSERT_EQ(0, storage1->truncate_suffix(50));
+    ASSERT_EQ(50, storage1->last_log_index());
+    ASSERT_EQ(nullptr, storage1->get_entry(51));
+    AppendEntries(storage1, 51, 10, 2);
+    // truncate suffix without appending
+    ASSERT_EQ(0, storage2->truncate_suffix(80));
+
+    // truncate prefix
+    ASSERT_EQ(0, storage1->truncate_prefix(21));
+    ASSERT_EQ(21, storage1->first_log_index());
+    ASSERT_EQ(nullptr, storage1->get_entry(20));
+    ASSERT_EQ(0, storage1->get_term(20));
+
+    // reset
+    ASSERT_EQ(0, storage2->reset(200));
+    ASSERT_EQ(200, storage2->first_log_index());
+    ASSERT_EQ(199, storage2->last_log_index());
+
+    CheckEntries(storage1, 21, 50);
+    CheckEntries(storage1, 51, 60, 2);
+
+    // truncation is kept after load
+    storage1.reset();
+    storage2.reset();
+    stream_.reset();
+    stream_ = NewStream();
+    storage1 = NewStorage(1, stream_);
+    storage2 = NewStorage(2, stream_);
+    ASSERT_EQ(21, storage1->first_log_index());
+    ASSERT_EQ(60, storage1->last_log_index());
+    CheckEntries(storage1, 21, 50);
+    CheckEntries(storage1, 51, 60, 2);
+    ASSERT_EQ(200, storage2->first_log_index());
+    ASSERT_EQ(199, storage2->last_log_index());
+    AppendEntries(storage2, 200, 10);
+    CheckEntries(storage2, 200, 209);
+}
+
+TEST_F(SharedLogStorageTest, recycle_files) {
+    // every file holds entries of both logs
+    stream_.reset();
+    stream_ = NewStream(1024);
+    auto storage1 = NewStorage(1, stream_);
+    auto storage2 = NewStorage(2, stream_);
+    for (int i = 0; i < 10; ++i) {
+        AppendEntries(storage1, 1 + i * 5, 5);
+        AppendEntries(storage2, 1 + i * 5, 5);
+    }
+    size_t fileCount = stream_->FileCount();
+    ASSERT_LT(1u, fileCount);
+
+    // files are still held by storage2
+    ASSERT_EQ(0, storage1->truncate_prefix(51));
+    ASSERT_EQ(fileCount, stream_->FileCount());
+
+    // files are recycled when no log holds them
+    ASSERT_EQ(0, storage2->truncate_prefix(41));
+    ASSERT_GT(fileCount, stream_->FileCount());
+    CheckEntries(storage2, 41, 50);
+
+    // nothing is done before the stream is stored
+    RemoveSharedLog(2);
+    ASSERT_GT(fileCount, stream_->FileCount());
+    CheckEntries(storage2, 41, 50);
+
+    // the removed log holds no file
+    StoreSharedLogStream(stream_);
+    RemoveSharedLog(2);
+    ASSERT_EQ(1u, stream_->FileCount());
+
+    // the removed log isn't loaded again
+    storage1.reset();
+    storage2.reset();
+    stream_.reset();
+    stream_ = NewStream(1024);
+    SharedLogRecovered log;
+    stream_->TakeRecovered(2, &log);
+    ASSERT_TRUE(log.entries.empty());
+}
+
+TEST_F(SharedLogStorageTest, torn_write) {
+    auto storage = NewStorage(1, stream_);
+    AppendEntries(storage, 1, 10);
+    storage.reset();
+    stream_.reset();
+
+    // append garbage to the last file as a torn write
+    std::string path(kSharedWalDir);
+    butil::string_appendf(&path, "/" SHARED_LOG_FILE_PATTERN,
+                          static_cast<uint64_t>(1));
+    FILE* fp = fopen(path.c_str(), "a");
+    ASSERT_NE(nullptr, fp);
+    fwrite("garbage", 1, 7, fp);
+    fclose(fp);
+
+    stream_ = NewStream();
+    storage = NewStorage(1, stream_);
+    ASSERT_EQ(10, storage->last_log_index());
+    CheckEntries(storage, 1, 10);
+    AppendEntries(storage, 11, 10);
+
+    storage.reset();
+    stream_.reset();
+    stream_ = NewStream();
+    storage = NewStorage(1, stream_);
+    CheckEntries(storage, 1, 20);
+}
+
+}  // namespace chunkserver
+}  // namespace curve
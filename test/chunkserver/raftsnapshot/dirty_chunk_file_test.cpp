@@ -0,0 +1,172 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <gtest/gtest.h>
+#include <fcntl.h>
+
+#include <memory>
+#include <set>
+#include <string>
+
+#include "src/chunkserver/raftsnapshot/dirty_chunk_file.h"
+#include "src/fs/local_filesystem.h"
+#include "test/fs/mock_local_filesystem.h"
+
+namespace curve {
+namespace chunkserver {
+
+using ::testing::_;
+using ::testing::Matcher;
+using ::testing::Return;
+
+using curve::fs::FileSystemType;
+using curve::fs::LocalFsFactory;
+using curve::fs::MockLocalFileSystem;
+
+TEST(DirtyChunkFileTest, load_save) {
+    std::string path = "dirty_chunk_file_test.chunks";
+    std::string rmCmd = "rm -f " + path;
+
+    // normal load/save
+    {
+        auto fs = LocalFsFactory::CreateFs(FileSystemType::EXT4, "");
+        DirtyChunkFile dirtyChunkFile(fs);
+        std::set<ChunkID> chunkIds = {1, 100, 12345678901};
+        ASSERT_EQ(0, dirtyChunkFile.Save(path, 1024, chunkIds));
+
+        uint64_t baseIndex = 0;
+        std::set<ChunkID> loadChunkIds = {7};
+        ASSERT_EQ(0, dirtyChunkFile.Load(path, &baseIndex, &loadChunkIds));
+        ASSERT_EQ(1024, baseIndex);
+        ASSERT_EQ(chunkIds, loadChunkIds);
+
+        // empty set
+        ASSERT_EQ(0, dirtyChunkFile.Save(path, 0, std::set<ChunkID>()));
+        ASSERT_EQ(0, dirtyChunkFile.Load(path, &baseIndex, &loadChunkIds));
+        ASSERT_EQ(0, baseIndex);
+        ASSERT_TRUE(loadChunkIds.empty());
+
+        ::system(rmCmd.c_str());
+    }
+
+    // load: data corrupted
+    {
+        auto fs = LocalFsFactory::CreateFs(FileSystemType::EXT4, "");
+        DirtyChunkFile dirtyChunkFile(fs);
+        std::set<ChunkID> chunkIds = {1, 2, 3};
+        ASSERT_EQ(0, dirtyChunkFile.Save(path, 10, chunkIds));
+
+        int fd = fs->Open(path.c_str(), O_RDWR);
+        ASSERT_LE(0, fd);
+        char c = 0x7f;
+        ASSERT_EQ(1, fs->Write(fd, &c, 32, 1));
+        fs->Close(fd);
+
+        uint64_t baseIndex;
+        std::set<ChunkID> loadChunkIds;
+        ASSERT_EQ(-1, dirtyChunkFile.Load(path, &baseIndex, &loadChunkIds));
+
+        // truncated
+        ASSERT_EQ(0, ::truncate(path.c_str(), 40));
+        ASSERT_EQ(-1, dirtyChunkFile.Load(path, &baseIndex, &loadChunkIds));
+
+        ::system(rmCmd.c_str());
+    }
+
+    // load: open failed
+    {
+        std::shared_ptr<MockLocalFileSystem> fs =
+            std::make_shared<MockLocalFileSystem>();
+        DirtyChunkFile dirtyChunkFile(fs);
+        uint64_t baseIndex;
+        std::set<ChunkID> chunkIds;
+        EXPECT_CALL(*fs, Open(_, _)).Times(1).WillOnce(Return(-1));
+        ASSERT_EQ(-1, dirtyChunkFile.Load(path, &baseIndex, &chunkIds));
+    }
+
+    // load: read head failed
+    {
+        std::shared_ptr<MockLocalFileSystem> fs =
+            std::make_shared<MockLocalFileSystem>();
+        DirtyChunkFile dirtyChunkFile(fs);
+        uint64_t baseIndex;
+        std::set<ChunkID> chunkIds;
+        EXPECT_CALL(*fs, Open(_, _)).Times(1).WillOnce(Return(10));
+        EXPECT_CALL(*fs, Read(_, _, _, _)).Times(1).WillOnce(Return(-1));
+        EXPECT_CALL(*fs, Close(_)).Times(1).WillOnce(Return(0));
+        ASSERT_EQ(-1, dirtyChunkFile.Load(path, &baseIndex, &chunkIds));
+    }
+
+    // save: open failed
+    {
+        std::shared_ptr<MockLocalFileSystem> fs =
+            std::make_shared<MockLocalFileSystem>();
+        DirtyChunkFile dirtyChunkFile(fs);
+        EXPECT_CALL(*fs, Open(_, _)).Times(1).WillOnce(Return(-1));
+        ASSERT_EQ(-1, dirtyChunkFile.Save(path, 1, {1, 2}));
+    }
+
+    // save: write failed
+    {
+        std::shared_ptr<MockLocalFileSystem> fs =
+            std::make_shared<MockLocalFileSystem>();
+        DirtyChunkFile dirtyChunkFile(fs);
+        EXPECT_CALL(*fs, Open(_, _)).Times(1).WillOnce(Return(10));
+        EXPECT_CALL(*fs, Write(_, Matcher<const char*>(_), _, _)).Times(1)
+            .WillOnce(Return(-1));
+        EXPECT_CALL(*fs, Close(_)).Times(1).WillOnce(Return(0));
+        ASSERT_EQ(-1, dirtyChunkFile.Save(path, 1, {1, 2}));
+    }
+
+    // save: sync failed
+    {
+        std::shared_ptr<MockLocalFileSystem> fs =
+            std::make_shared<MockLocalFileSystem>();
+        DirtyChunkFile dirtyChunkFile(fs);
+        EXPECT_CALL(*fs, Open(_, _)).Times(1).WillOnce(Return(10));
+        EXPECT_CALL(*fs, Write(_, Matcher<const char*>(_), _, _)).Times(1)
+            .WillOnce(Return(44));
+        EXPECT_CALL(*fs, Fsync(_)).Times(1).WillOnce(Return(-1));
+        EXPECT_CALL(*fs, Close(_)).Times(1).WillOnce(Return(0));
+        ASSERT_EQ(-1, dirtyChunkFile.Save(path, 1, {1, 2}));
+    }
+}
+
+TEST(DirtyChunkFileTest, encode_decode) {
+    std::set<ChunkID> chunkIds = {3, 5, 8};
+    std::string data = DirtyChunkFile::Encode(99, chunkIds);
+
+    uint64_t baseIndex = 0;
+    std::set<ChunkID> decodeChunkIds;
+    ASSERT_EQ(0, DirtyChunkFile::Decode(data, &baseIndex, &decodeChunkIds));
+    ASSERT_EQ(99, baseIndex);
+    ASSERT_EQ(chunkIds, decodeChunkIds);
+
+    // base index is covered by crc
+    std::string bad = data;
+    bad[8] ^= 0x1;
+    ASSERT_EQ(-1, DirtyChunkFile::Decode(bad, &baseIndex, &decodeChunkIds));
+    // size mismatch
+    ASSERT_EQ(-1, DirtyChunkFile::Decode(data.substr(0, data.size() - 1),
+                                         &baseIndex, &decodeChunkIds));
+    ASSERT_EQ(-1, DirtyChunkFile::Decode(data + "x", &baseIndex,
+                                         &decodeChunkIds));
+    ASSERT_EQ(-1, DirtyChunkFile::Decode("", &baseIndex, &decodeChunkIds));
+}
+
+}  // namespace chunkserver
+}  // namespace curve
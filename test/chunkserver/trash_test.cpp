@@ -35,6 +35,8 @@ using ::testing::DoAll;
 using ::testing::ElementsAre;
 using ::testing::Ge;
 using ::testing::Gt;
+using ::testing::Invoke;
+using ::testing::Matcher;
 using ::testing::Mock;
 using ::testing::NotNull;
 using ::testing::Return;
@@ -760,5 +762,121 @@ TEST_F(TrashTest, test_chunk_num_statistic) {
     ASSERT_EQ(7, trash->GetChunkNum());
 }
 
+TEST_F(TrashTest, recycle_in_batch) {
+    ops.recycleBatchSize = 2;
+    EXPECT_CALL(*lfs, List("./runlog/trash_test0/trash", _))
+        .WillOnce(Return(0));
+    ASSERT_EQ(0, trash->Init(ops));
+
+    std::string trashPath = "./runlog/trash_test0/trash";
+    std::string copysetDir = trashPath + "/4294967493.55555";
+    std::string index = copysetDir + "/recycle_pending";
+    std::vector<std::string> copysets{"4294967493.55555"};
+    std::vector<std::string> raftfiles{"data", "log", "raft_meta"};
+    std::vector<std::string> chunks{"chunk_100", "chunk_101"};
+    std::vector<std::string> logfiles{"curve_log_inprogress_10088"};
+    EXPECT_CALL(*lfs, DirExists(trashPath)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*lfs, List(trashPath, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(copysets), Return(0)));
+    // 只在copyset第一次过期时判断一次
+    SetCopysetNeedDelete(copysetDir, true);
+
+    // 遍历copyset目录一次，并持久化待回收文件的索引
+    EXPECT_CALL(*lfs, FileExists(index)).WillOnce(Return(false));
+    EXPECT_CALL(*lfs, List(copysetDir, _))
+        .WillOnce(DoAll(SetArgPointee<1>(raftfiles), Return(0)));
+    EXPECT_CALL(*lfs, DirExists(copysetDir + "/data")).WillOnce(Return(true));
+    EXPECT_CALL(*lfs, DirExists(copysetDir + "/log")).WillOnce(Return(true));
+    EXPECT_CALL(*lfs, DirExists(copysetDir + "/raft_meta"))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*lfs, List(copysetDir + "/data", _))
+        .WillOnce(DoAll(SetArgPointee<1>(chunks), Return(0)));
+    EXPECT_CALL(*lfs, List(copysetDir + "/log", _))
+        .WillOnce(DoAll(SetArgPointee<1>(logfiles), Return(0)));
+    EXPECT_CALL(*lfs, List(copysetDir + "/raft_meta", _))
+        .WillOnce(Return(0));
+    EXPECT_CALL(*lfs, DirExists(copysetDir + "/data/chunk_100"))
+        .WillOnce(Return(false));
+    EXPECT_CALL(*lfs, DirExists(copysetDir + "/data/chunk_101"))
+        .WillOnce(Return(false));
+    EXPECT_CALL(*lfs, DirExists(copysetDir + "/log/curve_log_inprogress_10088"))
+        .WillOnce(Return(false));
+    std::string content;
+    EXPECT_CALL(*lfs, Open(index + ".tmp", _)).WillOnce(Return(20));
+    EXPECT_CALL(*lfs, Write(20, Matcher<const char*>(_), 0, _))
+        .WillOnce(Invoke([&](int, const char* buf, uint64_t, int length) {
+            content.assign(buf, length);
+            return length;
+        }));
+    EXPECT_CALL(*lfs, Fsync(20)).WillOnce(Return(0));
+    EXPECT_CALL(*lfs, Close(20)).WillOnce(Return(0));
+    EXPECT_CALL(*lfs, Rename(index + ".tmp", index, 0)).WillOnce(Return(0));
+
+    // 每次只回收一批文件
+    EXPECT_CALL(*pool, RecycleFile(copysetDir + "/data/chunk_100"))
+        .WillOnce(Return(0));
+    EXPECT_CALL(*pool, RecycleFile(copysetDir + "/data/chunk_101"))
+        .WillOnce(Return(0));
+    EXPECT_CALL(*lfs, Delete(copysetDir)).Times(0);
+    trash->DeleteEligibleFileInTrash();
+    ASSERT_EQ("data/chunk_100\ndata/chunk_101\n"
+              "log/curve_log_inprogress_10088\n", content);
+    Mock::VerifyAndClearExpectations(pool.get());
+    Mock::VerifyAndClearExpectations(lfs.get());
+
+    // 文件都回收后删除copyset目录
+    EXPECT_CALL(*lfs, DirExists(trashPath)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*lfs, List(trashPath, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(copysets), Return(0)));
+    EXPECT_CALL(*walPool,
+                RecycleFile(copysetDir + "/log/curve_log_inprogress_10088"))
+        .WillOnce(Return(0));
+    EXPECT_CALL(*lfs, Delete(copysetDir)).WillOnce(Return(0));
+    trash->DeleteEligibleFileInTrash();
+}
+
+TEST_F(TrashTest, recycle_in_batch_from_index) {
+    ops.recycleBatchSize = 10;
+    EXPECT_CALL(*lfs, List("./runlog/trash_test0/trash", _))
+        .WillOnce(Return(0));
+    ASSERT_EQ(0, trash->Init(ops));
+
+    std::string trashPath = "./runlog/trash_test0/trash";
+    std::string copysetDir = trashPath + "/4294967493.55555";
+    std::string index = copysetDir + "/recycle_pending";
+    std::vector<std::string> copysets{"4294967493.55555"};
+    EXPECT_CALL(*lfs, DirExists(trashPath)).WillOnce(Return(true));
+    EXPECT_CALL(*lfs, List(trashPath, _))
+        .WillOnce(DoAll(SetArgPointee<1>(copysets), Return(0)));
+    SetCopysetNeedDelete(copysetDir, true);
+
+    // 重启前生成的索引，不再遍历copyset目录
+    std::string content = "data/chunk_100\ndata/chunk_101\n";
+    EXPECT_CALL(*lfs, FileExists(index)).WillOnce(Return(true));
+    EXPECT_CALL(*lfs, Open(index, _)).WillOnce(Return(30));
+    struct stat info;
+    info.st_size = content.size();
+    EXPECT_CALL(*lfs, Fstat(30, _))
+        .WillOnce(DoAll(SetArgPointee<1>(info), Return(0)));
+    EXPECT_CALL(*lfs, Read(30, _, 0, static_cast<int>(content.size())))
+        .WillOnce(Invoke([&](int, char* buf, uint64_t, int length) {
+            memcpy(buf, content.c_str(), length);
+            return length;
+        }));
+    EXPECT_CALL(*lfs, Close(30)).WillOnce(Return(0));
+    EXPECT_CALL(*lfs, List(copysetDir, _)).Times(0);
+
+    // 重启前已经回收的文件跳过
+    EXPECT_CALL(*lfs, FileExists(copysetDir + "/data/chunk_100"))
+        .WillOnce(Return(false));
+    EXPECT_CALL(*lfs, FileExists(copysetDir + "/data/chunk_101"))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*pool, RecycleFile(copysetDir + "/data/chunk_100")).Times(0);
+    EXPECT_CALL(*pool, RecycleFile(copysetDir + "/data/chunk_101"))
+        .WillOnce(Return(0));
+    EXPECT_CALL(*lfs, Delete(copysetDir)).WillOnce(Return(0));
+    trash->DeleteEligibleFileInTrash();
+}
+
 }  // namespace chunkserver
 }  // namespace curve
@@ -29,6 +29,7 @@
 #include <brpc/channel.h>
 #include <brpc/errno.pb.h>
 
+#include <memory>
 #include <string>
 #include <thread>  //NOLINT
 #include <chrono>  //NOLINT
@@ -1090,6 +1091,61 @@ TEST_F(MDSClientTest, GetOrAllocateSegment) {
     delete faktopologyeret;
 }
 
+TEST_F(MDSClientTest, GetOrAllocateSegmentBatch) {
+    curve::client::FInfo_t fi;
+    fi.userinfo = userinfo;
+    fi.fullPathName = "/1_userinfo_";
+    fi.chunksize = 4 * 1024 * 1024;
+    fi.segmentsize = 1 * 1024 * 1024 * 1024ul;
+
+    auto fillSegment = [&fi](curve::mds::PageFileSegment* pfs,
+                             uint64_t offset, int chunks) {
+        pfs->set_logicalpoolid(1234);
+        pfs->set_segmentsize(fi.segmentsize);
+        pfs->set_chunksize(fi.chunksize);
+        pfs->set_startoffset(offset);
+        for (int i = 0; i < chunks; i++) {
+            auto chunk = pfs->add_chunks();
+            chunk->set_copysetid(i);
+            chunk->set_chunkid(offset / fi.chunksize + i);
+        }
+    };
+
+    curve::mds::GetOrAllocateSegmentResponse response;
+    response.set_statuscode(::curve::mds::StatusCode::kOK);
+    fillSegment(response.mutable_pagefilesegment(), 0, 256);
+    fillSegment(response.add_extrasegments(), fi.segmentsize, 256);
+    // segment without chunks is skipped
+    fillSegment(response.add_extrasegments(), 2 * fi.segmentsize, 0);
+    fillSegment(response.add_extrasegments(), 3 * fi.segmentsize, 256);
+    std::unique_ptr<FakeReturn> fakeret(
+        new FakeReturn(nullptr, static_cast<void *>(&response)));
+    curvefsservice.SetGetOrAllocateSegmentFakeReturn(fakeret.get());
+
+    std::vector<SegmentInfo> segInfos;
+    ASSERT_EQ(LIBCURVE_ERROR::OK,
+              mdsclient_.GetOrAllocateSegment(true, 0, 4, &fi, nullptr,
+                                              &segInfos));
+    ASSERT_EQ(3, segInfos.size());
+    ASSERT_EQ(0, segInfos[0].startoffset);
+    ASSERT_EQ(fi.segmentsize, segInfos[1].startoffset);
+    ASSERT_EQ(3 * fi.segmentsize, segInfos[2].startoffset);
+    for (const auto& segInfo : segInfos) {
+        ASSERT_EQ(256, segInfo.chunkvec.size());
+        ASSERT_EQ(1234, segInfo.lpcpIDInfo.lpid);
+        ASSERT_EQ(segInfo.startoffset / fi.chunksize,
+                  segInfo.chunkvec[0].cid_);
+    }
+
+    // the single segment interface only returns the first one
+    SegmentInfo segInfo;
+    ASSERT_EQ(LIBCURVE_ERROR::OK,
+              mdsclient_.GetOrAllocateSegment(true, 0, &fi, nullptr,
+                                              &segInfo));
+    ASSERT_EQ(0, segInfo.startoffset);
+    ASSERT_EQ(256, segInfo.chunkvec.size());
+}
+
 TEST_F(MDSClientTest, GetServerList) {
     brpc::Server server;
 
@@ -2260,6 +2316,66 @@ TEST_F(MDSClientTest, DeAllocateSegmentTest) {
     }
 }
 
+TEST_F(MDSClientTest, ListSegmentTest) {
+    FInfo fi;
+    fi.userinfo = userinfo;
+    fi.fullPathName = "/ListSegmentTest";
+    fi.chunksize = 4 * 1024 * 1024;
+    fi.segmentsize = 1 * 1024 * 1024 * 1024ul;
+
+    // mds of old version, not retry
+    {
+        curvefsservice.SetListSegmentFakeReturn(nullptr);
+        std::vector<SegmentInfo> segInfos;
+        uint64_t startMs = curve::common::TimeUtility::GetTimeofDayMs();
+        ASSERT_EQ(LIBCURVE_ERROR::NOT_SUPPORT,
+                  mdsclient_.ListSegment(&fi, &segInfos));
+        uint64_t endMs = curve::common::TimeUtility::GetTimeofDayMs();
+        ASSERT_LT(endMs - startMs, metaopt.mdsMaxRetryMS);
+    }
+
+    // mds return error
+    {
+        curve::mds::ListSegmentResponse response;
+        response.set_statuscode(curve::mds::StatusCode::kOwnerAuthFail);
+        std::unique_ptr<FakeReturn> fakeret(new FakeReturn(nullptr, &response));
+        curvefsservice.SetListSegmentFakeReturn(fakeret.get());
+
+        std::vector<SegmentInfo> segInfos;
+        ASSERT_EQ(LIBCURVE_ERROR::AUTHFAIL,
+                  mdsclient_.ListSegment(&fi, &segInfos));
+    }
+
+    // segments without chunks are skipped
+    {
+        curve::mds::ListSegmentResponse response;
+        response.set_statuscode(curve::mds::StatusCode::kOK);
+        for (uint64_t index : {0, 2, 5}) {
+            auto pfs = response.add_segments();
+            pfs->set_logicalpoolid(1234);
+            pfs->set_segmentsize(fi.segmentsize);
+            pfs->set_chunksize(fi.chunksize);
+            pfs->set_startoffset(index * fi.segmentsize);
+            for (int i = 0; index != 2 && i < 256; i++) {
+                auto chunk = pfs->add_chunks();
+                chunk->set_copysetid(i);
+                chunk->set_chunkid(index * 256 + i);
+            }
+        }
+        std::unique_ptr<FakeReturn> fakeret(new FakeReturn(nullptr, &response));
+        curvefsservice.SetListSegmentFakeReturn(fakeret.get());
+
+        std::vector<SegmentInfo> segInfos;
+        ASSERT_EQ(LIBCURVE_ERROR::OK, mdsclient_.ListSegment(&fi, &segInfos));
+        ASSERT_EQ(2, segInfos.size());
+        ASSERT_EQ(0, segInfos[0].startoffset);
+        ASSERT_EQ(5 * fi.segmentsize, segInfos[1].startoffset);
+        ASSERT_EQ(256, segInfos[1].chunkvec.size());
+        ASSERT_EQ(5 * 256, segInfos[1].chunkvec[0].cid_);
+        curvefsservice.SetListSegmentFakeReturn(nullptr);
+    }
+}
+
 using ::testing::_;
 using ::testing::DoAll;
 using ::testing::ElementsAre;
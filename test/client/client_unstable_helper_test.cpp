@@ -117,5 +117,54 @@ TEST(UnstableHelperTest, normal_test) {
                       chunkserver5.first, chunkserver5.second));
 }
 
+TEST(UnstableHelperTest, slow_chunkserver_test) {
+    UnstableHelper helper;
+
+    ChunkServerUnstableOption opt;
+    opt.slowLatencyRatio = 3.0;
+    opt.slowMinLatencyUs = 10 * 1000;
+    opt.slowErrorRatio = 0.3;
+    opt.slowMinSamples = 10;
+    helper.Init(opt);
+
+    // 样本不足时不判断
+    for (uint32_t i = 0; i + 1 < opt.slowMinSamples; ++i) {
+        helper.RecordResult(1, 100 * 1000, false);
+    }
+    ASSERT_FALSE(helper.IsSlow(1));
+    ASSERT_FALSE(helper.IsSlow(2));
+
+    // chunkserver 1的延时明显高于其他chunkserver
+    for (int i = 0; i < 200; ++i) {
+        helper.RecordResult(1, 100 * 1000, false);
+        for (ChunkServerID id = 2; id <= 10; ++id) {
+            helper.RecordResult(id, 1000, false);
+        }
+    }
+    ASSERT_TRUE(helper.IsSlow(1));
+    ASSERT_FALSE(helper.IsSlow(2));
+
+    // 延时恢复之后不再认为变慢
+    for (int i = 0; i < 200; ++i) {
+        helper.RecordResult(1, 1000, false);
+    }
+    ASSERT_FALSE(helper.IsSlow(1));
+
+    // 所有chunkserver都慢，但是没有明显高于其他
+    for (int i = 0; i < 200; ++i) {
+        for (ChunkServerID id = 1; id <= 10; ++id) {
+            helper.RecordResult(id, 50 * 1000, false);
+        }
+    }
+    ASSERT_FALSE(helper.IsSlow(1));
+
+    // 失败比例过高
+    for (int i = 0; i < 20; ++i) {
+        helper.RecordResult(2, 0, true);
+    }
+    ASSERT_TRUE(helper.IsSlow(2));
+    ASSERT_FALSE(helper.IsSlow(3));
+}
+
 }  // namespace client
 }  // namespace curve
@@ -24,7 +24,11 @@
 #include <gflags/gflags.h>
 #include <gtest/gtest.h>
 
+#include <butil/time.h>
+
+#include <chrono>  // NOLINT
 #include <memory>
+#include <thread>  // NOLINT
 
 #include "test/client/mock/mock_mdsclient.h"
 #include "test/client/mock/mock_meta_cache.h"
@@ -32,7 +36,10 @@
 namespace curve {
 namespace client {
 
+using ::testing::_;
+using ::testing::DoAll;
 using ::testing::Return;
+using ::testing::SetArgPointee;
 
 class DiscardTaskTest : public ::testing::Test {
  public:
@@ -126,5 +133,87 @@ TEST_F(DiscardTaskTest, TestAllDiscard) {
     }
 }
 
+TEST_F(DiscardTaskTest, TestBatchDiscard) {
+    DiscardOption option;
+    option.maxBatchSegments = 4;
+    option.batchWindowMs = 1000;
+    DiscardTaskManager taskManager(metric.get(), option);
+
+    // segment 12 is written after it's discarded
+    for (SegmentIndex index = 10; index < 14; ++index) {
+        if (index != 12) {
+            mockMetaCache_->GetFileSegment(index)->GetBitmap().Set();
+        }
+    }
+
+    EXPECT_CALL(*mockMDSClient_, DeAllocateSegments(_, 10 * GiB, 2, _))
+        .WillOnce(DoAll(SetArgPointee<3>(2), Return(LIBCURVE_ERROR::OK)));
+    EXPECT_CALL(*mockMDSClient_, DeAllocateSegment(_, 13 * GiB))
+        .WillOnce(Return(LIBCURVE_ERROR::OK));
+    EXPECT_CALL(*mockMetaCache_, CleanChunksInSegment(10)).Times(1);
+    EXPECT_CALL(*mockMetaCache_, CleanChunksInSegment(11)).Times(1);
+    EXPECT_CALL(*mockMetaCache_, CleanChunksInSegment(12)).Times(0);
+    EXPECT_CALL(*mockMetaCache_, CleanChunksInSegment(13)).Times(1);
+
+    // the following tasks are due within the window of the first one
+    ASSERT_TRUE(taskManager.ScheduleTask(10, mockMetaCache_.get(),
+                                         mockMDSClient_.get(),
+                                         butil::milliseconds_from_now(100)));
+    for (SegmentIndex index = 11; index < 14; ++index) {
+        ASSERT_TRUE(taskManager.ScheduleTask(
+            index, mockMetaCache_.get(), mockMDSClient_.get(),
+            butil::milliseconds_from_now(300)));
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    for (SegmentIndex index = 10; index < 14; ++index) {
+        ASSERT_FALSE(mockMetaCache_->GetFileSegment(index)->IsAllBitSet());
+    }
+    ASSERT_EQ(1, metric->totalCanceled.get_value());
+    ASSERT_EQ(3, metric->totalSuccess.get_value());
+    ASSERT_EQ(0, metric->pending.get_value());
+    taskManager.Stop();
+}
+
+TEST_F(DiscardTaskTest, TestAdaptiveInterval) {
+    DiscardOption option;
+    option.targetLatencyMs = 100;
+    option.maxIntervalMs = 100;
+    DiscardTaskManager taskManager(metric.get(), option);
+    ASSERT_EQ(0, taskManager.IntervalUs());
+
+    // slow or failed requests double the interval
+    taskManager.OnRequestFinish(200 * 1000, false);
+    ASSERT_EQ(10 * 1000, taskManager.IntervalUs());
+    taskManager.OnRequestFinish(1000, true);
+    ASSERT_EQ(20 * 1000, taskManager.IntervalUs());
+    for (int i = 0; i < 10; ++i) {
+        taskManager.OnRequestFinish(200 * 1000, false);
+    }
+    ASSERT_EQ(100 * 1000, taskManager.IntervalUs());
+
+    // a task is delayed if it comes within the interval of the last one
+    SegmentIndex segmentIndex = 100;
+    DiscardTask task1(&taskManager, segmentIndex, mockMetaCache_.get(),
+                      mockMDSClient_.get(), metric.get());
+    DiscardTask task2(&taskManager, segmentIndex + 1, mockMetaCache_.get(),
+                      mockMDSClient_.get(), metric.get());
+    ASSERT_FALSE(taskManager.DelayTask(&task1));
+    ASSERT_TRUE(taskManager.DelayTask(&task2));
+    ASSERT_NE(0, task2.SlotUs());
+    // wait for the delayed task to run
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    ASSERT_EQ(0, task2.SlotUs());
+
+    // fast requests halve the interval
+    taskManager.OnRequestFinish(1000, false);
+    ASSERT_EQ(50 * 1000, taskManager.IntervalUs());
+    taskManager.OnRequestFinish(1000, false);
+    taskManager.OnRequestFinish(1000, false);
+    taskManager.OnRequestFinish(1000, false);
+    ASSERT_EQ(0, taskManager.IntervalUs());
+    taskManager.Stop();
+}
+
 }  // namespace client
 }  // namespace curve
@@ -25,6 +25,7 @@
 #include <gtest/gtest.h>
 #include <brpc/server.h>
 #include <brpc/controller.h>
+#include <brpc/errno.pb.h>
 #include <braft/raft.h>
 
 #include <string>
@@ -235,6 +236,27 @@ class FakeMDSCurveFSService : public curve::mds::CurveFSService {
         response->CopyFrom(*fakeResponse);
     }
 
+    void ListSegment(google::protobuf::RpcController* cntl_base,
+                     const curve::mds::ListSegmentRequest* request,
+                     curve::mds::ListSegmentResponse* response,
+                     google::protobuf::Closure* done) {
+        brpc::ClosureGuard doneGuard(done);
+        // act as mds of old version if not set
+        if (fakeListSegment_ == nullptr) {
+            cntl_base->SetFailed(brpc::ENOMETHOD, "no method");
+            return;
+        }
+        if (fakeListSegment_->controller_ != nullptr &&
+            fakeListSegment_->controller_->Failed()) {
+            cntl_base->SetFailed("failed");
+            return;
+        }
+
+        auto fakeResponse =
+            static_cast<decltype(response)>(fakeListSegment_->response_);
+        response->CopyFrom(*fakeResponse);
+    }
+
     void OpenFile(::google::protobuf::RpcController* controller,
                 const ::curve::mds::OpenFileRequest* request,
                 ::curve::mds::OpenFileResponse* response,
@@ -652,6 +674,10 @@ class FakeMDSCurveFSService : public curve::mds::CurveFSService {
         fakeDeAllocateSegment_ = fakeret;
     }
 
+    void SetListSegmentFakeReturn(FakeReturn* fakeret) {
+        fakeListSegment_ = fakeret;
+    }
+
     void SetOpenFile(FakeReturn* fakeret) {
         fakeopenfile_ = fakeret;
     }
@@ -761,6 +787,7 @@ class FakeMDSCurveFSService : public curve::mds::CurveFSService {
     FakeReturn* fakeGetOrAllocateSegmentret_;
     FakeReturn* fakeGetOrAllocateSegmentretForClone_;
     FakeReturn* fakeDeAllocateSegment_;
+    FakeReturn* fakeListSegment_ = nullptr;
     FakeReturn* fakeopenfile_;
     FakeReturn* fakeclosefile_;
     FakeReturn* fakerenamefile_;
@@ -0,0 +1,112 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "src/client/file_latency_stats.h"
+
+namespace curve {
+namespace client {
+
+TEST(LatencyHistogramTest, Bucket) {
+    // every value is in the bucket whose upper bound is not less than it
+    for (uint64_t value = 0; value < 100000; ++value) {
+        int bucket = LatencyHistogram::BucketOf(value);
+        ASSERT_LE(value, LatencyHistogram::BucketUpperBound(bucket));
+        if (bucket > 0) {
+            ASSERT_GT(value, LatencyHistogram::BucketUpperBound(bucket - 1));
+        }
+    }
+    ASSERT_EQ(LatencyHistogram::kBucketNum - 1,
+              LatencyHistogram::BucketOf(UINT64_MAX));
+}
+
+TEST(LatencyHistogramTest, Percentile) {
+    LatencyHistogram histogram;
+    std::vector<uint64_t> buckets;
+    histogram.Snapshot(&buckets);
+    ASSERT_EQ(0, LatencyHistogram::Percentile(buckets, 0.99));
+
+    for (int i = 0; i < 990; ++i) {
+        histogram.Record(100);
+    }
+    for (int i = 0; i < 10; ++i) {
+        histogram.Record(10000);
+    }
+    histogram.Snapshot(&buckets);
+
+    uint64_t p50 = LatencyHistogram::Percentile(buckets, 0.5);
+    ASSERT_GE(p50, 100);
+    ASSERT_LE(p50, 125);
+    ASSERT_EQ(p50, LatencyHistogram::Percentile(buckets, 0.99));
+    uint64_t p999 = LatencyHistogram::Percentile(buckets, 0.999);
+    ASSERT_GE(p999, 10000);
+    ASSERT_LE(p999, 12500);
+}
+
+TEST(FileLatencyStatsTest, SampleSpan) {
+    FileMetricOption option;
+    FileLatencyStats disabled("/file", option);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_FALSE(disabled.SampleSpan());
+    }
+
+    option.spanSampleRate = 4;
+    FileLatencyStats stats("/file", option);
+    int sampled = 0;
+    for (int i = 0; i < 40; ++i) {
+        sampled += stats.SampleSpan();
+    }
+    ASSERT_EQ(10, sampled);
+}
+
+TEST(FileLatencyCollectorTest, Collect) {
+    FileMetricOption option;
+    FileLatencyStats file1("/file1", option);
+    FileLatencyStats file2("/file2", option);
+    FileLatencyCollector& collector = FileLatencyCollector::GetInstance();
+    collector.Register(&file1);
+    collector.Register(&file2);
+
+    file1.Record(OpType::READ, 100);
+    file1.Record(OpType::WRITE, 1000);
+    file1.Record(OpType::DISCARD, 1000);
+    collector.Collect();
+    std::string report = collector.Report();
+    ASSERT_NE(std::string::npos, report.find("/file1 read_count=1"));
+    ASSERT_NE(std::string::npos, report.find("write_count=1"));
+    // files without ios in the interval are not reported
+    ASSERT_EQ(std::string::npos, report.find("/file2"));
+
+    // only the ios since the last collection are counted
+    file1.Record(OpType::READ, 100);
+    file2.Record(OpType::WRITE, 100);
+    collector.Collect();
+    report = collector.Report();
+    ASSERT_NE(std::string::npos, report.find("/file1 read_count=1 read_p50="));
+    ASSERT_NE(std::string::npos, report.find("/file2 read_count=0"));
+
+    collector.Unregister(&file1);
+    collector.Unregister(&file2);
+    collector.Collect();
+    ASSERT_TRUE(collector.Report().empty());
+}
+
+}  // namespace client
+}  // namespace curve
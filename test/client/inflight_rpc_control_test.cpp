@@ -37,6 +37,7 @@
 #include "src/client/iomanager4file.h"
 #include "src/client/lease_executor.h"
 #include "src/client/mds_client.h"
+#include "src/client/request_context.h"
 
 namespace curve {
 namespace client {
@@ -68,6 +69,60 @@ TEST(InflightRPCTest, TestMetric) {
     ASSERT_EQ(0, fileMetric->inflightRPCNum.get_value());
 }
 
+TEST(InflightRPCTest, TestLowPriorityInflightRPC) {
+    IOOption ioOption;
+    ioOption.ioSenderOpt.inflightOpt.fileMaxInFlightRPCNum = 1024;
+    ioOption.ioSenderOpt.inflightOpt.lowPriorityMaxInFlightRPCNum = 2;
+
+    IOManager4File backup1;
+    IOManager4File backup2;
+    ASSERT_TRUE(backup1.Initialize("/test_low_priority1", ioOption, nullptr));
+    ASSERT_TRUE(backup2.Initialize("/test_low_priority2", ioOption, nullptr));
+
+    RequestContext lowCtx;
+    lowCtx.priority_ = LIBCURVE_IO_PRIORITY_LOW;
+    RequestContext normalCtx;
+
+    RequestClosure low1(&lowCtx);
+    low1.SetIOManager(&backup1);
+    low1.SetFileMetric(backup1.GetMetric());
+    RequestClosure low2(&lowCtx);
+    low2.SetIOManager(&backup1);
+    low2.SetFileMetric(backup1.GetMetric());
+    low1.GetInflightRPCToken();
+    low2.GetInflightRPCToken();
+
+    // 正常优先级的rpc不受低优先级配额的限制
+    RequestClosure normal(&normalCtx);
+    normal.SetIOManager(&backup2);
+    normal.SetFileMetric(backup2.GetMetric());
+    normal.GetInflightRPCToken();
+    normal.ReleaseInflightRPCToken();
+
+    // 低优先级配额由所有文件共享，其他文件的低优先级rpc也需要等待
+    volatile bool flag = false;
+    auto getTask = [&]() {
+        RequestClosure low3(&lowCtx);
+        low3.SetIOManager(&backup2);
+        low3.SetFileMetric(backup2.GetMetric());
+        low3.GetInflightRPCToken();
+        ASSERT_TRUE(flag);
+        low3.ReleaseInflightRPCToken();
+    };
+    std::thread t(getTask);
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    flag = true;
+    low1.ReleaseInflightRPCToken();
+    t.join();
+
+    low2.ReleaseInflightRPCToken();
+    ASSERT_EQ(0, backup1.GetMetric()->inflightRPCNum.get_value());
+    ASSERT_EQ(0, backup2.GetMetric()->inflightRPCNum.get_value());
+
+    backup1.UnInitialize();
+    backup2.UnInitialize();
+}
+
 TEST(InflightRPCTest, TestInflightRPC) {
     int maxInflightNum = 8;
 
@@ -1134,6 +1134,73 @@ TEST_F(IOTrackerSplitorTest, stripeTest) {
     delete[] buf;
 }
 
+TEST_F(IOTrackerSplitorTest, StripeMergeUnitsInSameChunk) {
+    MockRequestScheduler mockschuler;
+    mockschuler.DelegateToFake();
+
+    FInfo_t fi;
+    fi.seqnum = 0;
+    fi.chunksize = 4 * 1024 * 1024;
+    fi.segmentsize = 1 * 1024 * 1024 * 1024ul;
+    fi.stripeUnit = 16 * 1024;
+    fi.stripeCount = 4;
+
+    // 4个完整条带，每个chunk上4个连续的单元
+    const uint64_t unit = fi.stripeUnit;
+    const uint64_t length = 16 * unit;
+    butil::IOBuf dataCopy;
+    for (int i = 0; i < 16; i++) {
+        std::string block(unit, 'a' + i);
+        dataCopy.append(block);
+    }
+
+    curve::client::IOManager4File* iomana = fileinstance_->GetIOManager4File();
+    MetaCache* mc = iomana->GetMetaCache();
+    for (int i = 0; i < 4; i++) {
+        curve::client::ChunkIDInfo chinfo(i + 1, 2, 3);
+        mc->UpdateChunkInfoByIndex(i, chinfo);
+    }
+
+    IOTracker writeTracker(iomana, mc, &mockschuler);
+    writeTracker.SetOpType(OpType::WRITE);
+    std::vector<RequestContext*> reqlist;
+    ASSERT_EQ(0, curve::client::Splitor::IO2ChunkRequests(
+                     &writeTracker, mc, &reqlist, &dataCopy, 0, length,
+                     mdsclient_.get(), &fi, nullptr));
+    ASSERT_EQ(4, reqlist.size());
+    for (int i = 0; i < 4; i++) {
+        RequestContext* req = reqlist[i];
+        ASSERT_EQ(i + 1, req->idinfo_.cid_);
+        ASSERT_EQ(0, req->offset_);
+        ASSERT_EQ(4 * unit, req->rawlength_);
+        std::string expected;
+        for (int j = 0; j < 4; j++) {
+            expected.append(unit, 'a' + i + j * 4);
+        }
+        ASSERT_EQ(expected, req->writeData_.to_string());
+        req->UnInit();
+        delete req;
+    }
+
+    IOTracker readTracker(iomana, mc, &mockschuler);
+    readTracker.SetOpType(OpType::READ);
+    reqlist.clear();
+    ASSERT_EQ(0, curve::client::Splitor::IO2ChunkRequests(
+                     &readTracker, mc, &reqlist, nullptr, 0, length,
+                     mdsclient_.get(), &fi, nullptr));
+    ASSERT_EQ(4, reqlist.size());
+    for (int i = 0; i < 4; i++) {
+        RequestContext* req = reqlist[i];
+        ASSERT_EQ(4, req->stripeUnits_.size());
+        for (int j = 0; j < 4; j++) {
+            ASSERT_EQ(i + j * 4, req->stripeUnits_[j].subIoIndex);
+            ASSERT_EQ(unit, req->stripeUnits_[j].length);
+        }
+        req->UnInit();
+        delete req;
+    }
+}
+
 TEST_F(IOTrackerSplitorTest, TestDisableStripeForStripeFile) {
     MockRequestScheduler scheduler;
     scheduler.DelegateToFake();
@@ -25,6 +25,8 @@
 #include <gtest/gtest.h>
 #include <brpc/server.h>
 
+#include <atomic>
+
 #include "src/client/iomanager4file.h"
 #include "src/client/lease_executor.h"
 #include "src/client/mds_client.h"
@@ -52,6 +54,23 @@ static void MockRefreshSession(::google::protobuf::RpcController* controller,
     response->set_sessionid("");
 }
 
+static void MockBatchRefreshSession(
+    ::google::protobuf::RpcController* controller,
+    const curve::mds::BatchRefreshSessionRequest* request,
+    curve::mds::BatchRefreshSessionResponse* response,
+    ::google::protobuf::Closure* done) {
+    brpc::ClosureGuard guard(done);
+
+    response->set_statuscode(curve::mds::StatusCode::kOK);
+    for (const auto& req : request->requests()) {
+        auto* resp = response->add_responses();
+        resp->set_statuscode(curve::mds::StatusCode::kOK);
+        resp->set_sessionid(req.sessionid());
+        resp->mutable_fileinfo()->set_filestatus(
+            curve::mds::FileStatus::kFileCreated);
+    }
+}
+
 class LeaseExecutorTest : public ::testing::Test {
  protected:
     void SetUp() override {
@@ -177,5 +196,55 @@ TEST_F(LeaseExecutorTest, TestNoStop) {
     // ASSERT_NO_FATAL_FAILURE(exec.Stop());
 }
 
+TEST_F(LeaseExecutorTest, TestBatchRefresh) {
+    std::atomic<int> batchs(0);
+    std::atomic<int> sessions(0);
+    EXPECT_CALL(curveFsService_, RefreshSession(_, _, _, _)).Times(0);
+    EXPECT_CALL(curveFsService_, BatchRefreshSession(_, _, _, _))
+        .WillRepeatedly(Invoke(
+            [&](::google::protobuf::RpcController* controller,
+                const curve::mds::BatchRefreshSessionRequest* request,
+                curve::mds::BatchRefreshSessionResponse* response,
+                ::google::protobuf::Closure* done) {
+                batchs.fetch_add(1);
+                sessions.fetch_add(request->requests_size());
+                MockBatchRefreshSession(controller, request, response, done);
+            }));
+
+    fi_.filestatus = FileStatus::Created;
+    leaseOpt_.mdsRefreshTimesPerLease = 1;
+    leaseOpt_.enableBatchRefresh = true;
+    lease_.leaseTime = 1000000;
+
+    LeaseRefresher refresher(leaseOpt_, &mdsClient_);
+    LeaseExecutor exec1(leaseOpt_, userInfo_, &mdsClient_, &io4File_,
+                        &refresher);
+    LeaseExecutor exec2(leaseOpt_, userInfo_, &mdsClient_, &io4File_,
+                        &refresher);
+    fi_.fullPathName = "/TestBatchRefresh1";
+    ASSERT_TRUE(exec1.Start(fi_, lease_));
+    fi_.fullPathName = "/TestBatchRefresh2";
+    ASSERT_TRUE(exec2.Start(fi_, lease_));
+
+    // 续约间隔不同的文件单独续约
+    LeaseSession lease = lease_;
+    lease.leaseTime = 2 * lease_.leaseTime;
+    LeaseExecutor exec3(leaseOpt_, userInfo_, &mdsClient_, &io4File_,
+                        &refresher);
+    fi_.fullPathName = "/TestBatchRefresh3";
+    ASSERT_TRUE(exec3.Start(fi_, lease));
+    ASSERT_NO_FATAL_FAILURE(exec3.Stop());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(3500));
+    ASSERT_TRUE(exec1.LeaseValid());
+    ASSERT_TRUE(exec2.LeaseValid());
+    ASSERT_NO_FATAL_FAILURE(exec1.Stop());
+    ASSERT_NO_FATAL_FAILURE(exec2.Stop());
+
+    // 每个周期一个rpc续约两个文件
+    ASSERT_GE(batchs.load(), 3);
+    ASSERT_EQ(2 * batchs.load(), sessions.load());
+}
+
 }  // namespace client
 }  // namespace curve
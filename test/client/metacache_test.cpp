@@ -25,6 +25,8 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <thread>
 #include <tuple>
 #include <vector>
 
@@ -161,5 +163,63 @@ TEST(MetaCacheCommonTest, TestAddCopysetsInfo) {
     }
 }
 
+TEST(MetaCacheCommonTest, TestGetLeaderWhileUpdating) {
+    MetaCache metaCache;
+
+    std::vector<CopysetPeerInfo<ChunkServerID>> peers;
+    std::vector<butil::EndPoint> endpoints;
+    for (int i = 0; i < 3; ++i) {
+        PeerAddr addr;
+        ASSERT_EQ(0, addr.Parse("127.0.0.1:" + std::to_string(8200 + i) +
+                                ":0"));
+        peers.emplace_back(i + 1, addr, addr);
+        endpoints.push_back(addr.addr_);
+    }
+
+    const int copysetNum = 100;
+    std::vector<CopysetInfo<ChunkServerID>> copysets;
+    for (int i = 1; i <= copysetNum; ++i) {
+        CopysetInfo<ChunkServerID> info;
+        info.lpid_ = 1;
+        info.cpid_ = i;
+        info.leaderindex_ = 0;
+        info.csinfos_ = peers;
+        copysets.emplace_back(info);
+    }
+    metaCache.AddCopysetsInfo(1, std::move(copysets));
+
+    std::atomic<bool> stop(false);
+    std::thread updater([&]() {
+        int i = 0;
+        while (!stop.load()) {
+            CopysetID cpid = i % copysetNum + 1;
+            const butil::EndPoint& leader = endpoints[i % endpoints.size()];
+            ASSERT_EQ(0, metaCache.UpdateLeader(1, cpid, leader));
+            ++i;
+        }
+    });
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&]() {
+            for (int i = 0; i < 100000; ++i) {
+                ChunkServerID id = 0;
+                butil::EndPoint ep;
+                ASSERT_EQ(0, metaCache.GetLeader(1, i % copysetNum + 1, &id,
+                                                 &ep));
+                ASSERT_GE(id, 1);
+                ASSERT_LE(id, 3);
+                ASSERT_EQ(endpoints[id - 1], ep);
+            }
+        });
+    }
+
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    stop.store(true);
+    updater.join();
+}
+
 }  // namespace client
 }  // namespace curve
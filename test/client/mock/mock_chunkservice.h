@@ -28,6 +28,7 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <atomic>
 #include <set>
 
 #include "proto/chunk.pb.h"
@@ -53,6 +54,7 @@ class FakeChunkServiceImpl : public ChunkService {
                     google::protobuf::Closure *done) {
         brpc::ClosureGuard doneGuard(done);
 
+        writeCount_.fetch_add(1);
         chunkIds_.insert(request->chunkid());
         brpc::Controller *cntl = dynamic_cast<brpc::Controller *>(controller);
         ::memcpy(chunk_ + request->offset(),
@@ -130,7 +132,12 @@ class FakeChunkServiceImpl : public ChunkService {
         response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
     }
 
+    uint64_t GetWriteCount() const {
+        return writeCount_.load();
+    }
+
  private:
+    std::atomic<uint64_t> writeCount_{0};
     std::set<ChunkID> chunkIds_;
     /* 由于 bthread 栈空间的限制，这里不会开很大的空间，如果测试需要更大的空间
      * 请在堆上申请 */
@@ -149,6 +156,11 @@ class MockChunkServiceImpl : public ChunkService {
         const ::curve::chunkserver::ChunkRequest *request,
         ::curve::chunkserver::ChunkResponse *response,
         google::protobuf::Closure *done));
+    MOCK_METHOD4(ReadChunks, void(::google::protobuf::RpcController
+        *controller,
+        const ::curve::chunkserver::ReadChunksRequest *request,
+        ::curve::chunkserver::ReadChunksResponse *response,
+        google::protobuf::Closure *done));
     MOCK_METHOD4(ReadChunkSnapshot, void(::google::protobuf::RpcController
         *controller,
         const ::curve::chunkserver::ChunkRequest *request,
@@ -170,6 +182,16 @@ class MockChunkServiceImpl : public ChunkService {
                       const ::curve::chunkserver::ChunkRequest* request,
                       ::curve::chunkserver::ChunkResponse* response,
                       google::protobuf::Closure* done));
+    MOCK_METHOD4(CreateCloneChunks,
+        void(::google::protobuf::RpcController* controller,
+             const ::curve::chunkserver::CreateCloneChunksRequest* request,
+             ::curve::chunkserver::CreateCloneChunksResponse* response,
+             google::protobuf::Closure* done));
+    MOCK_METHOD4(RecoverChunks,
+        void(::google::protobuf::RpcController* controller,
+             const ::curve::chunkserver::RecoverChunksRequest* request,
+             ::curve::chunkserver::RecoverChunksResponse* response,
+             google::protobuf::Closure* done));
     MOCK_METHOD4(RecoverChunk, void(::google::protobuf::RpcController
         *controller,
         const ::curve::chunkserver::ChunkRequest *request,
@@ -32,6 +32,8 @@ namespace client {
 class MockMDSClient : public MDSClient {
  public:
     MOCK_METHOD2(DeAllocateSegment, LIBCURVE_ERROR(const FInfo*, uint64_t));
+    MOCK_METHOD4(DeAllocateSegments,
+                 LIBCURVE_ERROR(const FInfo*, uint64_t, uint32_t, uint32_t*));
 };
 
 }  // namespace client
@@ -79,6 +79,12 @@ class MockNameService : public CurveFSService {
                       curve::mds::ReFreshSessionResponse* response,
                       ::google::protobuf::Closure* done));
 
+    MOCK_METHOD4(BatchRefreshSession,
+                 void(::google::protobuf::RpcController* controller,
+                      const curve::mds::BatchRefreshSessionRequest* request,
+                      curve::mds::BatchRefreshSessionResponse* response,
+                      ::google::protobuf::Closure* done));
+
     MOCK_METHOD4(IncreaseFileEpoch,
                  void(::google::protobuf::RpcController* controller,
                       const curve::mds::IncreaseFileEpochRequest* request,
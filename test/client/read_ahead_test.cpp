@@ -0,0 +1,199 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "src/client/read_ahead.h"
+
+namespace curve {
+namespace client {
+
+namespace {
+
+const uint64_t kUnit = 4096;
+const uint64_t kFileLength = 1024 * kUnit;
+
+char ByteAt(off_t offset) {
+    return 'a' + offset % 26;
+}
+
+std::string Content(off_t offset, size_t length) {
+    std::string data;
+    for (size_t i = 0; i < length; ++i) {
+        data.push_back(ByteAt(offset + i));
+    }
+    return data;
+}
+
+}  // namespace
+
+class ReadAheadTest : public ::testing::Test {
+ protected:
+    struct Prefetch {
+        off_t offset;
+        size_t length;
+        butil::IOBuf* data;
+        ReadAhead::PrefetchDone done;
+    };
+
+    void SetUp() override {
+        option_.enable = true;
+        option_.sequentialThreshold = 2;
+        option_.minWindowBytes = 4 * kUnit;
+        option_.maxWindowBytes = 16 * kUnit;
+        option_.maxCacheBytes = 32 * kUnit;
+        readAhead_.reset(new ReadAhead(
+            option_, [this](off_t offset, size_t length, butil::IOBuf* data,
+                            ReadAhead::PrefetchDone done) {
+                prefetches_.push_back({offset, length, data, done});
+            }));
+    }
+
+    // complete the prefetches issued, in order
+    void CompleteAll(bool fail = false) {
+        std::vector<Prefetch> prefetches;
+        prefetches.swap(prefetches_);
+        for (auto& prefetch : prefetches) {
+            if (fail) {
+                prefetch.done(-1);
+                continue;
+            }
+            prefetch.data->append(Content(prefetch.offset, prefetch.length));
+            prefetch.done(prefetch.length);
+        }
+        // the prefetches take almost no time, keep the observed throughput
+        // low so that the window only grows when the reader has to wait
+        usleep(10 * 1000);
+    }
+
+    // read and record the result, returns whether it is served
+    bool Read(off_t offset, size_t length) {
+        return readAhead_->Read(offset, length, kFileLength,
+                                [this](const butil::IOBuf* data) {
+                                    served_.push_back(
+                                        data ? data->to_string() : "");
+                                });
+    }
+
+    ReadAheadOption option_;
+    std::unique_ptr<ReadAhead> readAhead_;
+    std::vector<Prefetch> prefetches_;
+    std::vector<std::string> served_;
+};
+
+TEST_F(ReadAheadTest, SequentialRead) {
+    // the first read is not sequential yet
+    ASSERT_FALSE(Read(0, kUnit));
+    ASSERT_TRUE(prefetches_.empty());
+
+    // prefetch the window after the second read
+    ASSERT_FALSE(Read(kUnit, kUnit));
+    ASSERT_EQ(1, prefetches_.size());
+    ASSERT_EQ(2 * kUnit, prefetches_[0].offset);
+    ASSERT_EQ(option_.minWindowBytes, prefetches_[0].length);
+
+    // waits for the prefetch in flight, the window grows since the reader
+    // catches up with the prefetching
+    ASSERT_TRUE(Read(2 * kUnit, kUnit));
+    ASSERT_TRUE(served_.empty());
+    ASSERT_EQ(2 * option_.minWindowBytes, readAhead_->Window());
+    ASSERT_EQ(3, prefetches_.size());
+    CompleteAll();
+    ASSERT_EQ(1, served_.size());
+    ASSERT_EQ(Content(2 * kUnit, kUnit), served_[0]);
+
+    // served from the cache immediately, across segments
+    ASSERT_TRUE(Read(3 * kUnit, 2 * kUnit));
+    ASSERT_EQ(2, served_.size());
+    ASSERT_EQ(Content(3 * kUnit, 2 * kUnit), served_[1]);
+    CompleteAll();
+
+    // consumed segments are evicted
+    uint64_t cached = readAhead_->CachedBytes();
+    ASSERT_TRUE(Read(5 * kUnit, kUnit));
+    ASSERT_TRUE(Read(6 * kUnit, kUnit));
+    ASSERT_EQ(cached - option_.minWindowBytes +
+                  prefetches_.size() * option_.minWindowBytes,
+              readAhead_->CachedBytes());
+    ASSERT_LE(readAhead_->CachedBytes(), option_.maxCacheBytes);
+    ASSERT_LE(readAhead_->Window(), option_.maxWindowBytes);
+
+    // random read drops the cache and resets the window
+    ASSERT_FALSE(Read(100 * kUnit, kUnit));
+    ASSERT_EQ(0, readAhead_->CachedBytes());
+    ASSERT_EQ(option_.minWindowBytes, readAhead_->Window());
+    CompleteAll();
+    ASSERT_FALSE(Read(13 * kUnit, kUnit));
+}
+
+TEST_F(ReadAheadTest, NotBeyondFileEnd) {
+    ASSERT_FALSE(Read(kFileLength - 3 * kUnit, kUnit));
+    ASSERT_FALSE(Read(kFileLength - 2 * kUnit, kUnit));
+    ASSERT_EQ(1, prefetches_.size());
+    ASSERT_EQ(kFileLength - kUnit, prefetches_[0].offset);
+    ASSERT_EQ(kUnit, prefetches_[0].length);
+    CompleteAll();
+    ASSERT_TRUE(Read(kFileLength - kUnit, kUnit));
+    ASSERT_TRUE(prefetches_.empty());
+}
+
+TEST_F(ReadAheadTest, PrefetchFailed) {
+    ASSERT_FALSE(Read(0, kUnit));
+    ASSERT_FALSE(Read(kUnit, kUnit));
+    ASSERT_TRUE(Read(2 * kUnit, kUnit));
+    CompleteAll(true);
+    // the reader waiting reads by itself
+    ASSERT_EQ(1, served_.size());
+    ASSERT_EQ("", served_[0]);
+    ASSERT_FALSE(Read(3 * kUnit, kUnit));
+}
+
+TEST_F(ReadAheadTest, OverlappedByWrite) {
+    ASSERT_FALSE(Read(0, kUnit));
+    ASSERT_FALSE(Read(kUnit, kUnit));
+    CompleteAll();
+
+    // cached data overlapped by a write is dropped
+    readAhead_->BeginWrite(2 * kUnit, kUnit);
+    ASSERT_FALSE(Read(2 * kUnit, kUnit));
+    readAhead_->EndWrite(2 * kUnit, kUnit);
+    ASSERT_FALSE(Read(3 * kUnit, kUnit));
+
+    // nothing overlapping a write in flight is prefetched
+    readAhead_->BeginWrite(6 * kUnit, 1);
+    ASSERT_FALSE(Read(4 * kUnit, kUnit));
+    ASSERT_TRUE(prefetches_.empty());
+    readAhead_->EndWrite(6 * kUnit, 1);
+    ASSERT_FALSE(Read(5 * kUnit, kUnit));
+    ASSERT_FALSE(prefetches_.empty());
+    ASSERT_EQ(6 * kUnit, prefetches_[0].offset);
+
+    // a prefetch in flight overlapped by a write is not used
+    ASSERT_TRUE(Read(6 * kUnit, kUnit));
+    readAhead_->BeginWrite(7 * kUnit, 1);
+    CompleteAll();
+    readAhead_->EndWrite(7 * kUnit, 1);
+    ASSERT_EQ(1, served_.size());
+    ASSERT_EQ("", served_[0]);
+    ASSERT_FALSE(Read(7 * kUnit, kUnit));
+}
+
+}  // namespace client
+}  // namespace curve
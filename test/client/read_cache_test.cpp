@@ -0,0 +1,141 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "src/client/read_cache.h"
+
+namespace curve {
+namespace client {
+
+namespace {
+
+const uint32_t kBlockSize = 4096;
+const char* kDiskPath = "./read_cache_test.data";
+
+butil::IOBuf Block(char c) {
+    butil::IOBuf data;
+    data.append(std::string(kBlockSize, c));
+    return data;
+}
+
+}  // namespace
+
+class ReadCacheTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        option_.enable = true;
+        option_.blockSize = kBlockSize;
+        option_.memoryBytes = 2 * kBlockSize;
+    }
+
+    void TearDown() override {
+        ReadCache::GetInstance().Reset();
+        ::unlink(kDiskPath);
+    }
+
+    ReadCacheOption option_;
+};
+
+TEST_F(ReadCacheTest, InvalidOption) {
+    option_.blockSize = 0;
+    ASSERT_EQ(-1, ReadCache::GetInstance().Init(option_));
+
+    option_.blockSize = kBlockSize;
+    option_.diskPath = kDiskPath;
+    option_.diskBytes = kBlockSize - 1;
+    ASSERT_EQ(-1, ReadCache::GetInstance().Init(option_));
+}
+
+TEST_F(ReadCacheTest, MemoryOnly) {
+    ReadCache& cache = ReadCache::GetInstance();
+    ASSERT_EQ(0, cache.Init(option_));
+    ASSERT_EQ(kBlockSize, cache.BlockSize());
+
+    butil::IOBuf data;
+    ASSERT_FALSE(cache.Get(1, 0, 1, 0, &data));
+
+    // blocks of other sizes are not cached
+    butil::IOBuf partial;
+    partial.append(std::string(kBlockSize / 2, 'x'));
+    cache.Put(1, 0, 1, 0, partial);
+    ASSERT_FALSE(cache.Get(1, 0, 1, 0, &data));
+
+    cache.Put(1, 0, 1, 0, Block('a'));
+    ASSERT_TRUE(cache.Get(1, 0, 1, 0, &data));
+    ASSERT_EQ(Block('a').to_string(), data.to_string());
+
+    // the block is replaced when the tag changes
+    data.clear();
+    ASSERT_FALSE(cache.Get(1, 0, 2, 0, &data));
+    ASSERT_FALSE(cache.Get(1, 0, 1, 0, &data));
+    ASSERT_EQ(0, cache.MemoryBytes());
+
+    // least recently used block is dropped without the disk
+    cache.Put(1, 0, 1, 0, Block('a'));
+    cache.Put(1, 1, 1, 0, Block('b'));
+    ASSERT_TRUE(cache.Get(1, 0, 1, 0, &data));
+    cache.Put(1, 2, 1, 0, Block('c'));
+    ASSERT_EQ(2 * kBlockSize, cache.MemoryBytes());
+    ASSERT_EQ(0, cache.DiskBlocks());
+    data.clear();
+    ASSERT_FALSE(cache.Get(1, 1, 1, 0, &data));
+    ASSERT_TRUE(cache.Get(1, 0, 1, 0, &data));
+    ASSERT_TRUE(cache.Get(1, 2, 1, 0, &data));
+}
+
+TEST_F(ReadCacheTest, EvictToDisk) {
+    option_.diskPath = kDiskPath;
+    option_.diskBytes = 2 * kBlockSize;
+    ReadCache& cache = ReadCache::GetInstance();
+    ASSERT_EQ(0, cache.Init(option_));
+
+    for (int i = 0; i < 4; ++i) {
+        cache.Put(1, i, 1, 0, Block('a' + i));
+    }
+    ASSERT_EQ(2 * kBlockSize, cache.MemoryBytes());
+    ASSERT_EQ(2, cache.DiskBlocks());
+
+    // read back from the disk, and promoted to the memory
+    butil::IOBuf data;
+    ASSERT_TRUE(cache.Get(1, 0, 1, 0, &data));
+    ASSERT_EQ(Block('a').to_string(), data.to_string());
+    ASSERT_EQ(2, cache.DiskBlocks());
+    data.clear();
+    ASSERT_TRUE(cache.Get(1, 1, 1, 0, &data));
+    ASSERT_EQ(Block('b').to_string(), data.to_string());
+
+    // the disk is full, the oldest block on it is dropped
+    cache.Put(1, 4, 1, 0, Block('e'));
+    ASSERT_EQ(2, cache.DiskBlocks());
+    data.clear();
+    ASSERT_FALSE(cache.Get(1, 2, 1, 0, &data));
+    ASSERT_TRUE(cache.Get(1, 3, 1, 0, &data));
+    ASSERT_EQ(Block('d').to_string(), data.to_string());
+
+    // block on the disk with another tag is a miss
+    cache.Put(1, 5, 1, 0, Block('f'));
+    cache.Put(1, 6, 1, 0, Block('g'));
+    data.clear();
+    ASSERT_FALSE(cache.Get(1, 3, 1, 1, &data));
+    ASSERT_FALSE(cache.Get(1, 3, 1, 0, &data));
+}
+
+}  // namespace client
+}  // namespace curve
@@ -566,6 +566,181 @@ TEST(RequestSchedulerTest, fake_server_test) {
     ASSERT_EQ(0, server.Join());
 }
 
+TEST(RequestSchedulerTest, RunToCompletionTest) {
+    RequestScheduleOption opt;
+    opt.scheduleQueueCapacity = 4096;
+    opt.scheduleThreadpoolSize = 2;
+    opt.scheduleBusyPollUs = 100;
+    opt.scheduleRunToCompletion = true;
+    opt.ioSenderOpt.failRequestOpt.chunkserverRPCTimeoutMS = 200;
+    opt.ioSenderOpt.failRequestOpt.chunkserverOPMaxRetry = 5;
+    opt.ioSenderOpt.failRequestOpt.chunkserverOPRetryIntervalUS = 5000;
+
+    brpc::Server server;
+    std::string listenAddr = "127.0.0.1:9109";
+    FakeChunkServiceImpl fakeChunkService;
+    ASSERT_EQ(server.AddService(&fakeChunkService,
+                                brpc::SERVER_DOESNT_OWN_SERVICE), 0);
+    brpc::ServerOptions option;
+    option.idle_timeout_sec = -1;
+    ASSERT_EQ(server.Start(listenAddr.c_str(), &option), 0);
+
+    RequestScheduler requestScheduler;
+    MockMetaCache mockMetaCache;
+    mockMetaCache.DelegateToFake();
+    EXPECT_CALL(mockMetaCache, GetLeader(_, _, _, _, _, _)).Times(AnyNumber());
+    ASSERT_EQ(0, requestScheduler.Init(opt, &mockMetaCache));
+    ASSERT_EQ(0, requestScheduler.Run());
+
+    FileMetric fm("test");
+    IOTracker iot(nullptr, nullptr, nullptr, &fm);
+    ChunkIDInfo idinfo(1, 1, 100001);
+    const uint64_t len = 16;
+    butil::IOBuf expectReadData;
+    expectReadData.append(std::string(len, 'b'));
+
+    // 队列为空时在当前线程下发，没有被跳过的请求
+    for (int i = 0; i < 10; ++i) {
+        RequestContext *writeCtx = new FakeRequestContext();
+        writeCtx->optype_ = OpType::WRITE;
+        writeCtx->idinfo_ = idinfo;
+        writeCtx->writeData_ = expectReadData;
+        writeCtx->offset_ = 0;
+        writeCtx->rawlength_ = len;
+
+        curve::common::CountDownEvent writeCond(1);
+        RequestClosure *writeDone =
+            new FakeRequestClosure(&writeCond, writeCtx);
+        writeDone->SetFileMetric(&fm);
+        writeDone->SetIOTracker(&iot);
+        writeCtx->done_ = writeDone;
+        ASSERT_EQ(0, requestScheduler.ScheduleRequest(writeCtx));
+        writeCond.Wait();
+        ASSERT_EQ(0, writeDone->GetErrorCode());
+
+        RequestContext *readCtx = new FakeRequestContext();
+        readCtx->optype_ = OpType::READ;
+        readCtx->idinfo_ = idinfo;
+        readCtx->offset_ = 0;
+        readCtx->rawlength_ = len;
+
+        curve::common::CountDownEvent readCond(1);
+        RequestClosure *readDone = new FakeRequestClosure(&readCond, readCtx);
+        readDone->SetFileMetric(&fm);
+        readDone->SetIOTracker(&iot);
+        readCtx->done_ = readDone;
+
+        std::vector<RequestContext *> reqCtxs;
+        reqCtxs.push_back(readCtx);
+        ASSERT_EQ(0, requestScheduler.ScheduleRequest(reqCtxs));
+        readCond.Wait();
+        ASSERT_EQ(0, readDone->GetErrorCode());
+        ASSERT_EQ(expectReadData, readCtx->readData_);
+    }
+
+    requestScheduler.Fini();
+    ASSERT_EQ(0, server.Stop(0));
+    ASSERT_EQ(0, server.Join());
+}
+
+TEST(RequestSchedulerTest, WriteMergeTest) {
+    RequestScheduleOption opt;
+    opt.scheduleQueueCapacity = 4096;
+    opt.scheduleThreadpoolSize = 1;
+    opt.writeMergeWindowUs = 10000;
+    opt.writeMergeMaxSize = 64;
+    opt.ioSenderOpt.failRequestOpt.chunkserverRPCTimeoutMS = 200;
+    opt.ioSenderOpt.failRequestOpt.chunkserverOPMaxRetry = 5;
+    opt.ioSenderOpt.failRequestOpt.chunkserverOPRetryIntervalUS = 5000;
+
+    brpc::Server server;
+    std::string listenAddr = "127.0.0.1:9109";
+    FakeChunkServiceImpl fakeChunkService;
+    ASSERT_EQ(server.AddService(&fakeChunkService,
+                                brpc::SERVER_DOESNT_OWN_SERVICE), 0);
+    brpc::ServerOptions option;
+    option.idle_timeout_sec = -1;
+    ASSERT_EQ(server.Start(listenAddr.c_str(), &option), 0);
+
+    RequestScheduler requestScheduler;
+    MockMetaCache mockMetaCache;
+    mockMetaCache.DelegateToFake();
+    EXPECT_CALL(mockMetaCache, GetLeader(_, _, _, _, _, _)).Times(AnyNumber());
+    ASSERT_EQ(0, requestScheduler.Init(opt, &mockMetaCache));
+    ASSERT_EQ(0, requestScheduler.Run());
+
+    FileMetric fm("test");
+    IOTracker iot(nullptr, nullptr, nullptr, &fm);
+    ChunkIDInfo idinfo(1, 1, 100001);
+    const uint64_t len = 16;
+    const int reqNum = 8;
+
+    // 紧挨着的写请求合并发送，每个请求单独返回
+    std::string expectData;
+    std::vector<RequestContext *> reqCtxs;
+    std::vector<RequestClosure *> dones;
+    curve::common::CountDownEvent writeCond(reqNum + 1);
+    for (int i = 0; i < reqNum; ++i) {
+        RequestContext *writeCtx = new FakeRequestContext();
+        writeCtx->optype_ = OpType::WRITE;
+        writeCtx->idinfo_ = idinfo;
+        writeCtx->writeData_.append(std::string(len, 'a' + i));
+        writeCtx->offset_ = i * len;
+        writeCtx->rawlength_ = len;
+        expectData.append(std::string(len, 'a' + i));
+
+        RequestClosure *writeDone =
+            new FakeRequestClosure(&writeCond, writeCtx);
+        writeDone->SetFileMetric(&fm);
+        writeDone->SetIOTracker(&iot);
+        writeCtx->done_ = writeDone;
+        reqCtxs.push_back(writeCtx);
+        dones.push_back(writeDone);
+    }
+    // 不相邻的请求单独发送
+    RequestContext *otherCtx = new FakeRequestContext();
+    otherCtx->optype_ = OpType::WRITE;
+    otherCtx->idinfo_ = idinfo;
+    otherCtx->writeData_.append(std::string(len, 'z'));
+    otherCtx->offset_ = 2 * reqNum * len;
+    otherCtx->rawlength_ = len;
+    RequestClosure *otherDone = new FakeRequestClosure(&writeCond, otherCtx);
+    otherDone->SetFileMetric(&fm);
+    otherDone->SetIOTracker(&iot);
+    otherCtx->done_ = otherDone;
+    reqCtxs.push_back(otherCtx);
+    dones.push_back(otherDone);
+
+    ASSERT_EQ(0, requestScheduler.ScheduleRequest(reqCtxs));
+    writeCond.Wait();
+    for (auto done : dones) {
+        ASSERT_EQ(0, done->GetErrorCode());
+    }
+    // 合并后的请求不超过writeMergeMaxSize
+    ASSERT_GE(fakeChunkService.GetWriteCount(), 3u);
+    ASSERT_LT(fakeChunkService.GetWriteCount(),
+              static_cast<uint64_t>(reqNum + 1));
+
+    RequestContext *readCtx = new FakeRequestContext();
+    readCtx->optype_ = OpType::READ;
+    readCtx->idinfo_ = idinfo;
+    readCtx->offset_ = 0;
+    readCtx->rawlength_ = expectData.size();
+    curve::common::CountDownEvent readCond(1);
+    RequestClosure *readDone = new FakeRequestClosure(&readCond, readCtx);
+    readDone->SetFileMetric(&fm);
+    readDone->SetIOTracker(&iot);
+    readCtx->done_ = readDone;
+    ASSERT_EQ(0, requestScheduler.ScheduleRequest(readCtx));
+    readCond.Wait();
+    ASSERT_EQ(0, readDone->GetErrorCode());
+    ASSERT_EQ(expectData, readCtx->readData_.to_string());
+
+    requestScheduler.Fini();
+    ASSERT_EQ(0, server.Stop(0));
+    ASSERT_EQ(0, server.Join());
+}
+
 TEST(RequestSchedulerTest, CommonTest) {
     RequestScheduleOption opt;
     opt.scheduleQueueCapacity = 4096;
@@ -23,7 +23,12 @@
 #include <brpc/server.h>
 #include <gtest/gtest.h>
 
+#include <chrono>  // NOLINT
+#include <memory>
+#include <thread>  // NOLINT
+
 #include "src/client/client_common.h"
+#include "src/client/request_context.h"
 #include "src/client/request_sender.h"
 #include "src/common/concurrent/count_down_event.h"
 #include "test/client/mock/mock_chunkservice.h"
@@ -47,9 +52,10 @@ using curve::common::CountDownEvent;
 
 class FakeChunkClosure : public ClientClosure {
  public:
-    explicit FakeChunkClosure(CountDownEvent* event)
+    explicit FakeChunkClosure(CountDownEvent* event,
+                              RequestContext* ctx = nullptr)
         : ClientClosure(nullptr, nullptr),
-          reqeustClosure(nullptr),
+          reqeustClosure(ctx),
           event(event) {
         SetClosure(&reqeustClosure);
     }
@@ -60,6 +66,14 @@ class FakeChunkClosure : public ClientClosure {
 
     void SendRetryRequest() override {}
 
+    brpc::Controller* GetCntl() {
+        return cntl_;
+    }
+
+    ChunkResponse* GetResponse() {
+        return response_.get();
+    }
+
  private:
     RequestClosure reqeustClosure;
     CountDownEvent* event;
@@ -157,6 +171,53 @@ TEST_F(RequestSenderTest, TestWriteChunkSourceInfo) {
     }
 }
 
+TEST_F(RequestSenderTest, TestChunkRequestPriority) {
+    butil::EndPoint serverEndpoint;
+    butil::str2endpoint(serverAddr_.c_str(), &serverEndpoint);
+
+    RequestSender requestSender(0, serverEndpoint);
+    ASSERT_EQ(0, requestSender.Init(ioSenderOption_));
+
+    RequestSourceInfo sourceInfo;
+
+    {
+        // 正常优先级不携带priority
+        curve::chunkserver::ChunkRequest chunkRequest;
+        EXPECT_CALL(mockChunkService_, ReadChunk(_, _, _, _))
+            .Times(1)
+            .WillOnce(DoAll(SaveArgPointee<1>(&chunkRequest),
+                            Invoke(MockChunkRequestService)));
+
+        RequestContext ctx;
+        CountDownEvent event(1);
+        FakeChunkClosure closure(&event, &ctx);
+
+        requestSender.ReadChunk(ChunkIDInfo(), 0, 0, 0, sourceInfo, &closure);
+
+        event.Wait();
+        ASSERT_FALSE(chunkRequest.has_priority());
+    }
+
+    {
+        curve::chunkserver::ChunkRequest chunkRequest;
+        EXPECT_CALL(mockChunkService_, WriteChunk(_, _, _, _))
+            .Times(1)
+            .WillOnce(DoAll(SaveArgPointee<1>(&chunkRequest),
+                            Invoke(MockChunkRequestService)));
+
+        RequestContext ctx;
+        ctx.priority_ = LIBCURVE_IO_PRIORITY_LOW;
+        CountDownEvent event(1);
+        FakeChunkClosure closure(&event, &ctx);
+
+        requestSender.WriteChunk(ChunkIDInfo(), 1, 1, 0, {}, 0, 0,
+                                 sourceInfo, &closure);
+
+        event.Wait();
+        ASSERT_EQ(LIBCURVE_IO_PRIORITY_LOW, chunkRequest.priority());
+    }
+}
+
 TEST_F(RequestSenderTest, TestReadChunkSourceInfo) {
     butil::EndPoint serverEndpoint;
     butil::str2endpoint(serverAddr_.c_str(), &serverEndpoint);
@@ -206,5 +267,342 @@ TEST_F(RequestSenderTest, TestReadChunkSourceInfo) {
     }
 }
 
+TEST_F(RequestSenderTest, TestReadBatch) {
+    butil::EndPoint serverEndpoint;
+    butil::str2endpoint(serverAddr_.c_str(), &serverEndpoint);
+
+    RequestSender requestSender(0, serverEndpoint);
+    ASSERT_EQ(0, requestSender.Init(ioSenderOption_));
+
+    RequestSourceInfo sourceInfo;
+    ChunkIDInfo idinfo(1, 1, 1);
+
+    // 作用域内的读请求合并成一个rpc，结果按顺序拆分给各个请求
+    {
+        curve::chunkserver::ReadChunksRequest readChunksRequest;
+        auto readChunks = [](::google::protobuf::RpcController* controller,
+                             const curve::chunkserver::ReadChunksRequest*,
+                             curve::chunkserver::ReadChunksResponse* response,
+                             google::protobuf::Closure* done) {
+            brpc::ClosureGuard doneGuard(done);
+            brpc::Controller* cntl =
+                static_cast<brpc::Controller*>(controller);
+            response->add_responses()->set_status(
+                CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+            response->add_responses()->set_status(
+                CHUNK_OP_STATUS::CHUNK_OP_STATUS_CHUNK_NOTEXIST);
+            response->add_responses()->set_status(
+                CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+            cntl->response_attachment().append(std::string(4096, 'a'));
+            cntl->response_attachment().append(std::string(8192, 'c'));
+        };
+        EXPECT_CALL(mockChunkService_, ReadChunks(_, _, _, _))
+            .WillOnce(DoAll(SaveArgPointee<1>(&readChunksRequest),
+                            Invoke(readChunks)));
+        EXPECT_CALL(mockChunkService_, ReadChunk(_, _, _, _))
+            .Times(0);
+
+        CountDownEvent event(3);
+        FakeChunkClosure closure1(&event);
+        FakeChunkClosure closure2(&event);
+        FakeChunkClosure closure3(&event);
+        {
+            ReadBatchScope scope(8);
+            requestSender.ReadChunk(idinfo, 0, 0, 4096, sourceInfo,
+                                    &closure1);
+            requestSender.ReadChunk(idinfo, 0, 4096, 4096, sourceInfo,
+                                    &closure2);
+            requestSender.ReadChunk(idinfo, 0, 8192, 8192, sourceInfo,
+                                    &closure3);
+        }
+        event.Wait();
+
+        ASSERT_EQ(3, readChunksRequest.requests_size());
+        ASSERT_EQ(4096, readChunksRequest.requests(1).offset());
+        ASSERT_EQ(8192, readChunksRequest.requests(2).size());
+        ASSERT_FALSE(closure1.GetCntl()->Failed());
+        ASSERT_EQ(std::string(4096, 'a'),
+                  closure1.GetCntl()->response_attachment().to_string());
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_CHUNK_NOTEXIST,
+                  closure2.GetResponse()->status());
+        ASSERT_EQ(0, closure2.GetCntl()->response_attachment().size());
+        ASSERT_EQ(std::string(8192, 'c'),
+                  closure3.GetCntl()->response_attachment().to_string());
+    }
+
+    // 只有一个请求时用ReadChunk发送
+    {
+        EXPECT_CALL(mockChunkService_, ReadChunks(_, _, _, _))
+            .Times(0);
+        EXPECT_CALL(mockChunkService_, ReadChunk(_, _, _, _))
+            .WillOnce(Invoke(MockChunkRequestService));
+
+        CountDownEvent event(1);
+        FakeChunkClosure closure(&event);
+        {
+            ReadBatchScope scope(8);
+            requestSender.ReadChunk(idinfo, 0, 0, 4096, sourceInfo, &closure);
+        }
+        event.Wait();
+    }
+
+    // rpc失败时每个请求都失败
+    {
+        auto readChunksFail = [](::google::protobuf::RpcController* controller,
+                                 const curve::chunkserver::ReadChunksRequest*,
+                                 curve::chunkserver::ReadChunksResponse*,
+                                 google::protobuf::Closure* done) {
+            brpc::ClosureGuard doneGuard(done);
+            controller->SetFailed("read chunks failed");
+        };
+        EXPECT_CALL(mockChunkService_, ReadChunks(_, _, _, _))
+            .WillOnce(Invoke(readChunksFail));
+
+        CountDownEvent event(2);
+        FakeChunkClosure closure1(&event);
+        FakeChunkClosure closure2(&event);
+        {
+            ReadBatchScope scope(8);
+            requestSender.ReadChunk(idinfo, 0, 0, 4096, sourceInfo,
+                                    &closure1);
+            requestSender.ReadChunk(idinfo, 0, 4096, 4096, sourceInfo,
+                                    &closure2);
+        }
+        event.Wait();
+        ASSERT_TRUE(closure1.GetCntl()->Failed());
+        ASSERT_TRUE(closure2.GetCntl()->Failed());
+    }
+}
+
+TEST_F(RequestSenderTest, TestCreateCloneBatch) {
+    butil::EndPoint serverEndpoint;
+    butil::str2endpoint(serverAddr_.c_str(), &serverEndpoint);
+
+    RequestSender requestSender(0, serverEndpoint);
+    ASSERT_EQ(0, requestSender.Init(ioSenderOption_));
+
+    // 作用域内的请求合并成一个rpc，结果按顺序拆分给各个请求
+    {
+        curve::chunkserver::CreateCloneChunksRequest createRequest;
+        auto createChunks =
+            [](::google::protobuf::RpcController*,
+               const curve::chunkserver::CreateCloneChunksRequest*,
+               curve::chunkserver::CreateCloneChunksResponse* response,
+               google::protobuf::Closure* done) {
+                brpc::ClosureGuard doneGuard(done);
+                response->add_responses()->set_status(
+                    CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+                response->add_responses()->set_status(
+                    CHUNK_OP_STATUS::CHUNK_OP_STATUS_CHUNK_EXIST);
+            };
+        EXPECT_CALL(mockChunkService_, CreateCloneChunks(_, _, _, _))
+            .WillOnce(DoAll(SaveArgPointee<1>(&createRequest),
+                            Invoke(createChunks)));
+        EXPECT_CALL(mockChunkService_, CreateCloneChunk(_, _, _, _))
+            .Times(0);
+
+        CountDownEvent event(2);
+        FakeChunkClosure closure1(&event);
+        FakeChunkClosure closure2(&event);
+        {
+            CloneBatchScope scope(OpType::CREATE_CLONE, 8);
+            requestSender.CreateCloneChunk(ChunkIDInfo(1, 1, 1), &closure1,
+                                           "loc1@cs", 1, 2, 4096);
+            requestSender.CreateCloneChunk(ChunkIDInfo(2, 2, 1), &closure2,
+                                           "loc2@cs", 1, 2, 4096);
+        }
+        event.Wait();
+
+        ASSERT_EQ(2, createRequest.requests_size());
+        ASSERT_EQ(2, createRequest.requests(1).chunkid());
+        ASSERT_EQ("loc2@cs", createRequest.requests(1).location());
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                  closure1.GetResponse()->status());
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_CHUNK_EXIST,
+                  closure2.GetResponse()->status());
+    }
+
+    // 只有一个请求时用CreateCloneChunk发送
+    {
+        EXPECT_CALL(mockChunkService_, CreateCloneChunks(_, _, _, _))
+            .Times(0);
+        EXPECT_CALL(mockChunkService_, CreateCloneChunk(_, _, _, _))
+            .WillOnce(Invoke(MockChunkRequestService));
+
+        CountDownEvent event(1);
+        FakeChunkClosure closure(&event);
+        {
+            CloneBatchScope scope(OpType::CREATE_CLONE, 8);
+            requestSender.CreateCloneChunk(ChunkIDInfo(1, 1, 1), &closure,
+                                           "loc1@cs", 1, 2, 4096);
+        }
+        event.Wait();
+        ASSERT_FALSE(closure.GetCntl()->Failed());
+    }
+
+    // rpc失败（例如chunkserver不支持）时每个请求都失败，由各自的closure重试
+    {
+        auto createChunksFail =
+            [](::google::protobuf::RpcController* controller,
+               const curve::chunkserver::CreateCloneChunksRequest*,
+               curve::chunkserver::CreateCloneChunksResponse*,
+               google::protobuf::Closure* done) {
+                brpc::ClosureGuard doneGuard(done);
+                controller->SetFailed("create clone chunks failed");
+            };
+        EXPECT_CALL(mockChunkService_, CreateCloneChunks(_, _, _, _))
+            .WillOnce(Invoke(createChunksFail));
+
+        CountDownEvent event(2);
+        FakeChunkClosure closure1(&event);
+        FakeChunkClosure closure2(&event);
+        {
+            CloneBatchScope scope(OpType::CREATE_CLONE, 8);
+            requestSender.CreateCloneChunk(ChunkIDInfo(1, 1, 1), &closure1,
+                                           "loc1@cs", 1, 2, 4096);
+            requestSender.CreateCloneChunk(ChunkIDInfo(2, 2, 1), &closure2,
+                                           "loc2@cs", 1, 2, 4096);
+        }
+        event.Wait();
+        ASSERT_TRUE(closure1.GetCntl()->Failed());
+        ASSERT_TRUE(closure2.GetCntl()->Failed());
+    }
+}
+
+TEST_F(RequestSenderTest, TestRecoverBatch) {
+    butil::EndPoint serverEndpoint;
+    butil::str2endpoint(serverAddr_.c_str(), &serverEndpoint);
+
+    RequestSender requestSender(0, serverEndpoint);
+    ASSERT_EQ(0, requestSender.Init(ioSenderOption_));
+
+    // 作用域内的recover请求合并成一个rpc，创建clone chunk的请求不合并
+    curve::chunkserver::RecoverChunksRequest recoverRequest;
+    auto recoverChunks =
+        [](::google::protobuf::RpcController*,
+           const curve::chunkserver::RecoverChunksRequest* request,
+           curve::chunkserver::RecoverChunksResponse* response,
+           google::protobuf::Closure* done) {
+            brpc::ClosureGuard doneGuard(done);
+            for (int i = 0; i < request->requests_size(); ++i) {
+                response->add_responses()->set_status(
+                    CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+            }
+        };
+    EXPECT_CALL(mockChunkService_, RecoverChunks(_, _, _, _))
+        .WillOnce(DoAll(SaveArgPointee<1>(&recoverRequest),
+                        Invoke(recoverChunks)));
+    EXPECT_CALL(mockChunkService_, RecoverChunk(_, _, _, _))
+        .Times(0);
+    EXPECT_CALL(mockChunkService_, CreateCloneChunk(_, _, _, _))
+        .WillOnce(Invoke(MockChunkRequestService));
+
+    CountDownEvent event(4);
+    FakeChunkClosure closure1(&event);
+    FakeChunkClosure closure2(&event);
+    FakeChunkClosure closure3(&event);
+    FakeChunkClosure closure4(&event);
+    {
+        CloneBatchScope scope(OpType::RECOVER_CHUNK, 8);
+        requestSender.RecoverChunk(ChunkIDInfo(1, 1, 1), &closure1,
+                                   0, 4096);
+        requestSender.RecoverChunk(ChunkIDInfo(1, 1, 1), &closure2,
+                                   4096, 4096);
+        requestSender.RecoverChunk(ChunkIDInfo(2, 2, 1), &closure3,
+                                   0, 4096);
+        requestSender.CreateCloneChunk(ChunkIDInfo(3, 3, 1), &closure4,
+                                       "loc3@cs", 1, 2, 4096);
+    }
+    event.Wait();
+
+    ASSERT_EQ(3, recoverRequest.requests_size());
+    ASSERT_EQ(4096, recoverRequest.requests(1).offset());
+    ASSERT_EQ(2, recoverRequest.requests(2).chunkid());
+    ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+              closure3.GetResponse()->status());
+    ASSERT_FALSE(closure4.GetCntl()->Failed());
+}
+
+TEST_F(RequestSenderTest, TestHedgedReadChunk) {
+    brpc::Server hedgeServer;
+    MockChunkServiceImpl hedgeService;
+    std::string hedgeAddr = "127.0.0.1:19501";
+    ASSERT_EQ(0, hedgeServer.AddService(&hedgeService,
+                                        brpc::SERVER_DOESNT_OWN_SERVICE));
+    ASSERT_EQ(0, hedgeServer.Start(hedgeAddr.c_str(), nullptr));
+
+    butil::EndPoint primaryEndpoint;
+    butil::EndPoint hedgeEndpoint;
+    butil::str2endpoint(serverAddr_.c_str(), &primaryEndpoint);
+    butil::str2endpoint(hedgeAddr.c_str(), &hedgeEndpoint);
+
+    ioSenderOption_.hedgedReadOpt.enable = true;
+    ioSenderOption_.hedgedReadOpt.minDelayUs = 100 * 1000;
+    auto primary = std::make_shared<RequestSender>(1, primaryEndpoint);
+    auto hedge = std::make_shared<RequestSender>(2, hedgeEndpoint);
+    ASSERT_EQ(0, primary->Init(ioSenderOption_));
+    ASSERT_EQ(0, hedge->Init(ioSenderOption_));
+
+    auto readSuccess = [](::google::protobuf::RpcController* controller,
+                          const curve::chunkserver::ChunkRequest* request,
+                          curve::chunkserver::ChunkResponse* response,
+                          google::protobuf::Closure* done) {
+        brpc::ClosureGuard doneGuard(done);
+        ASSERT_TRUE(request->readfromfollower());
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+        static_cast<brpc::Controller*>(controller)
+            ->response_attachment()
+            .append(std::string(request->size(), 'a'));
+    };
+    auto slowReadSuccess = [&](::google::protobuf::RpcController* controller,
+                               const curve::chunkserver::ChunkRequest* request,
+                               curve::chunkserver::ChunkResponse* response,
+                               google::protobuf::Closure* done) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        readSuccess(controller, request, response, done);
+    };
+
+    // 原请求在等待时间内返回，不发送对冲请求
+    {
+        EXPECT_CALL(mockChunkService_, ReadChunk(_, _, _, _))
+            .WillOnce(Invoke(readSuccess));
+        EXPECT_CALL(hedgeService, ReadChunk(_, _, _, _))
+            .Times(0);
+
+        CountDownEvent event(1);
+        FakeChunkClosure closure(&event);
+        primary->HedgedReadChunk(ChunkIDInfo(), 0, 4096, hedge, &closure);
+        event.Wait();
+        ASSERT_FALSE(closure.GetCntl()->Failed());
+        ASSERT_EQ(1, closure.GetChunkServerID());
+
+        // 定时器已经取消
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    // 原请求卡住，先返回的对冲请求生效
+    {
+        EXPECT_CALL(mockChunkService_, ReadChunk(_, _, _, _))
+            .WillOnce(Invoke(slowReadSuccess));
+        EXPECT_CALL(hedgeService, ReadChunk(_, _, _, _))
+            .WillOnce(Invoke(readSuccess));
+
+        CountDownEvent event(1);
+        FakeChunkClosure closure(&event);
+        primary->HedgedReadChunk(ChunkIDInfo(), 0, 4096, hedge, &closure);
+        event.Wait();
+        ASSERT_FALSE(closure.GetCntl()->Failed());
+        ASSERT_EQ(2, closure.GetChunkServerID());
+        ASSERT_EQ(std::string(4096, 'a'),
+                  closure.GetCntl()->response_attachment().to_string());
+
+        // 等待原请求返回
+        std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    }
+
+    hedgeServer.Stop(0);
+    hedgeServer.Join();
+}
+
 }  // namespace client
 }  // namespace curve
@@ -0,0 +1,386 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <condition_variable>  // NOLINT
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/client/write_back_log.h"
+
+namespace curve {
+namespace client {
+
+namespace {
+
+const char kLogPath[] = "./write_back_log_test.log";
+const char kFileName[] = "/test_write_back_log";
+const uint64_t kUnit = 4096;
+const uint64_t kVolumeLength = 64 * kUnit;
+
+}  // namespace
+
+class WriteBackLogTest : public ::testing::Test {
+ protected:
+    struct Flush {
+        off_t offset;
+        std::string data;
+        WriteBackLog::Done done;
+    };
+
+    void SetUp() override {
+        ::unlink(kLogPath);
+        option_.enable = true;
+        option_.capacityBytes = 64 * kUnit;
+        option_.flushConcurrency = 4;
+        volume_.assign(kVolumeLength, '0');
+        autoFlush_ = true;
+    }
+
+    void TearDown() override {
+        log_.reset();
+        ::unlink(kLogPath);
+    }
+
+    int Open(std::vector<std::pair<off_t, size_t>>* replayed = nullptr) {
+        log_.reset(new WriteBackLog(
+            option_, [this](off_t offset, const butil::IOBuf& data,
+                            WriteBackLog::Done done) {
+                OnFlush(offset, data.to_string(), std::move(done));
+            }));
+        std::vector<std::pair<off_t, size_t>> ranges;
+        int ret = log_->Open(kLogPath, kFileName,
+                             replayed ? replayed : &ranges);
+        if (ret == 0) {
+            log_->Start();
+        }
+        return ret;
+    }
+
+    void OnFlush(off_t offset, const std::string& data,
+                 WriteBackLog::Done done) {
+        std::unique_lock<std::mutex> lk(mtx_);
+        if (autoFlush_) {
+            volume_.replace(offset, data.size(), data);
+            lk.unlock();
+            done(0);
+            return;
+        }
+        flushes_.push_back({offset, data, std::move(done)});
+        cond_.notify_all();
+    }
+
+    // wait for count flushes issued and not completed
+    void WaitFlushes(size_t count) {
+        std::unique_lock<std::mutex> lk(mtx_);
+        ASSERT_TRUE(cond_.wait_for(lk, std::chrono::seconds(5), [&]() {
+            return flushes_.size() >= count;
+        }));
+    }
+
+    // complete the first flush issued
+    void CompleteFlush(int ret = 0) {
+        Flush flush;
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            ASSERT_FALSE(flushes_.empty());
+            flush = std::move(flushes_.front());
+            flushes_.erase(flushes_.begin());
+            if (ret == 0) {
+                volume_.replace(flush.offset, flush.data.size(), flush.data);
+            }
+        }
+        flush.done(ret);
+    }
+
+    void SetAutoFlush(bool autoFlush) {
+        std::lock_guard<std::mutex> lk(mtx_);
+        autoFlush_ = autoFlush;
+    }
+
+    size_t FlushCount() {
+        std::lock_guard<std::mutex> lk(mtx_);
+        return flushes_.size();
+    }
+
+    int Wait(const std::function<void(WriteBackLog::Done)>& start) {
+        std::mutex mtx;
+        std::condition_variable cond;
+        bool finished = false;
+        int result = 0;
+        start([&](int ret) {
+            std::lock_guard<std::mutex> lk(mtx);
+            result = ret;
+            finished = true;
+            cond.notify_one();
+        });
+        std::unique_lock<std::mutex> lk(mtx);
+        cond.wait(lk, [&finished]() { return finished; });
+        return result;
+    }
+
+    int Append(off_t offset, size_t length, char c) {
+        butil::IOBuf data;
+        data.append(std::string(length, c));
+        return Wait([&](WriteBackLog::Done done) {
+            ASSERT_TRUE(log_->Append(offset, data, std::move(done)));
+        });
+    }
+
+    int Barrier() {
+        return Wait([this](WriteBackLog::Done done) {
+            log_->Barrier(std::move(done));
+        });
+    }
+
+    // the volume seen by a reader, the log overlaid on the chunkservers
+    std::string Read(off_t offset, size_t length) {
+        std::string data;
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            data = volume_.substr(offset, length);
+        }
+        std::vector<WriteBackLog::Extent> extents;
+        log_->Lookup(offset, length, &extents);
+        for (const auto& extent : extents) {
+            std::string part = extent.data.to_string();
+            data.replace(extent.offset - offset, part.size(), part);
+        }
+        return data;
+    }
+
+    std::string Volume() {
+        std::lock_guard<std::mutex> lk(mtx_);
+        return volume_;
+    }
+
+    WriteBackLogOption option_;
+    std::unique_ptr<WriteBackLog> log_;
+
+    std::mutex mtx_;
+    std::condition_variable cond_;
+    bool autoFlush_;
+    std::string volume_;
+    std::vector<Flush> flushes_;
+};
+
+TEST_F(WriteBackLogTest, AppendAndFlush) {
+    ASSERT_EQ(0, Open());
+    SetAutoFlush(false);
+    ASSERT_EQ(0, Append(0, 2 * kUnit, 'a'));
+    ASSERT_EQ(0, Append(kUnit, 2 * kUnit, 'b'));
+    ASSERT_EQ(4 * kUnit, log_->PendingBytes());
+
+    // the newer record overlays the older one before they are flushed
+    ASSERT_EQ(std::string(kUnit, 'a') + std::string(2 * kUnit, 'b') +
+                  std::string(kUnit, '0'),
+              Read(0, 4 * kUnit));
+    std::vector<WriteBackLog::Extent> extents;
+    log_->Lookup(0, 4 * kUnit, &extents);
+    ASSERT_EQ(2, extents.size());
+    ASSERT_EQ(0, extents[0].offset);
+    ASSERT_EQ(kUnit, extents[0].data.size());
+    ASSERT_EQ(kUnit, extents[1].offset);
+    ASSERT_EQ(2 * kUnit, extents[1].data.size());
+
+    // the second one overlaps the first one in flight
+    WaitFlushes(1);
+    usleep(100 * 1000);
+    ASSERT_EQ(1, FlushCount());
+    CompleteFlush();
+    ASSERT_EQ(std::string(kUnit, 'a') + std::string(2 * kUnit, 'b'),
+              Read(0, 3 * kUnit));
+    WaitFlushes(1);
+    CompleteFlush();
+
+    SetAutoFlush(true);
+    ASSERT_EQ(0, Barrier());
+    ASSERT_EQ(0, log_->PendingBytes());
+    log_->Lookup(0, kVolumeLength, &extents);
+    ASSERT_TRUE(extents.empty());
+    ASSERT_EQ(std::string(kUnit, 'a') + std::string(2 * kUnit, 'b'),
+              Volume().substr(0, 3 * kUnit));
+    ASSERT_EQ(0, log_->Close());
+}
+
+TEST_F(WriteBackLogTest, FlushDisjointRecordsConcurrently) {
+    ASSERT_EQ(0, Open());
+    SetAutoFlush(false);
+    for (int i = 0; i < 6; ++i) {
+        ASSERT_EQ(0, Append(i * kUnit, kUnit, 'a' + i));
+    }
+    WaitFlushes(option_.flushConcurrency);
+    usleep(100 * 1000);
+    ASSERT_EQ(option_.flushConcurrency, FlushCount());
+
+    // a failed flush is retried
+    CompleteFlush(-1);
+    WaitFlushes(option_.flushConcurrency);
+    SetAutoFlush(true);
+    while (FlushCount() > 0) {
+        CompleteFlush();
+    }
+    ASSERT_EQ(0, Barrier());
+    ASSERT_EQ("abcdef", [this]() {
+        std::string chars;
+        for (int i = 0; i < 6; ++i) {
+            chars.push_back(Volume()[i * kUnit]);
+        }
+        return chars;
+    }());
+}
+
+TEST_F(WriteBackLogTest, ReplayAfterCrash) {
+    ASSERT_EQ(0, Open());
+    SetAutoFlush(false);
+    ASSERT_EQ(0, Append(0, kUnit, 'a'));
+    ASSERT_EQ(0, Append(0, kUnit, 'b'));
+    ASSERT_EQ(0, Append(2 * kUnit, kUnit, 'c'));
+    WaitFlushes(1);
+    // exits without flushing
+    log_.reset();
+    flushes_.clear();
+
+    std::vector<std::pair<off_t, size_t>> replayed;
+    SetAutoFlush(false);
+    ASSERT_EQ(0, Open(&replayed));
+    ASSERT_EQ(3, replayed.size());
+    ASSERT_EQ(2 * kUnit, replayed[2].first);
+    ASSERT_EQ(kUnit, replayed[2].second);
+    ASSERT_EQ(std::string(kUnit, 'b') + std::string(kUnit, '0') +
+                  std::string(kUnit, 'c'),
+              Read(0, 3 * kUnit));
+
+    // flushed again in order
+    SetAutoFlush(true);
+    while (FlushCount() > 0) {
+        CompleteFlush();
+    }
+    ASSERT_EQ(0, Barrier());
+    ASSERT_EQ(std::string(kUnit, 'b') + std::string(kUnit, '0') +
+                  std::string(kUnit, 'c'),
+              Volume().substr(0, 3 * kUnit));
+    ASSERT_EQ(0, log_->Close());
+
+    // nothing left after closed
+    ASSERT_EQ(0, Open(&replayed));
+    ASSERT_TRUE(replayed.empty());
+}
+
+TEST_F(WriteBackLogTest, TornRecord) {
+    ASSERT_EQ(0, Open());
+    SetAutoFlush(false);
+    ASSERT_EQ(0, Append(0, kUnit, 'a'));
+    ASSERT_EQ(0, Append(kUnit, kUnit, 'b'));
+    ASSERT_EQ(0, Append(2 * kUnit, kUnit, 'c'));
+    WaitFlushes(1);
+    log_.reset();
+    flushes_.clear();
+
+    // the data of the second record is torn, the ones after are dropped
+    int fd = ::open(kLogPath, O_RDWR);
+    ASSERT_GE(fd, 0);
+    const uint64_t recordBytes = 9 * WriteBackLog::kAlignment;
+    ASSERT_EQ(1, ::pwrite(fd, "x", 1,
+                          WriteBackLog::kBlockSize + 3 * recordBytes / 2));
+    ::close(fd);
+
+    std::vector<std::pair<off_t, size_t>> replayed;
+    ASSERT_EQ(0, Open(&replayed));
+    ASSERT_EQ(1, replayed.size());
+    ASSERT_EQ(0, replayed[0].first);
+
+    // the log of another file is not opened
+    log_.reset();
+    WriteBackLog other(option_, nullptr);
+    ASSERT_EQ(-1, other.Open(kLogPath, "/other", &replayed));
+}
+
+TEST_F(WriteBackLogTest, WrapAround) {
+    ASSERT_EQ(0, Open());
+    // larger than a quarter of the log
+    butil::IOBuf large;
+    large.append(std::string(16 * kUnit, 'x'));
+    ASSERT_FALSE(log_->Append(0, large, [](int) {}));
+
+    // the log is reused many times
+    for (int i = 0; i < 200; ++i) {
+        ASSERT_EQ(0, Append((i % 16) * 2 * kUnit, 2 * kUnit, 'a' + i % 26));
+    }
+    ASSERT_EQ(0, Barrier());
+    for (int i = 184; i < 200; ++i) {
+        ASSERT_EQ(std::string(2 * kUnit, 'a' + i % 26),
+                  Volume().substr((i % 16) * 2 * kUnit, 2 * kUnit));
+    }
+
+    // records left after wrapping around are replayed
+    SetAutoFlush(false);
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_EQ(0, Append(i * 2 * kUnit, 2 * kUnit, 'A' + i));
+    }
+    WaitFlushes(1);
+    log_.reset();
+    flushes_.clear();
+    std::vector<std::pair<off_t, size_t>> replayed;
+    ASSERT_EQ(0, Open(&replayed));
+    ASSERT_EQ(5, replayed.size());
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_EQ(std::string(2 * kUnit, 'A' + i),
+                  Read(i * 2 * kUnit, 2 * kUnit));
+    }
+}
+
+TEST_F(WriteBackLogTest, StaleRecordsAfterCrash) {
+    ASSERT_EQ(0, Open());
+    SetAutoFlush(false);
+    ASSERT_EQ(0, Append(0, kUnit, 'a'));
+    ASSERT_EQ(0, Append(kUnit, kUnit, 'b'));
+    ASSERT_EQ(0, Append(2 * kUnit, kUnit, 'c'));
+    WaitFlushes(1);
+    log_.reset();
+    flushes_.clear();
+
+    // the second record is torn
+    int fd = ::open(kLogPath, O_RDWR);
+    ASSERT_GE(fd, 0);
+    const uint64_t recordBytes = 9 * WriteBackLog::kAlignment;
+    ASSERT_EQ(1, ::pwrite(fd, "x", 1,
+                          WriteBackLog::kBlockSize + 3 * recordBytes / 2));
+    ::close(fd);
+
+    // the record written in its place after restart has the same seq and
+    // size, the stale third one doesn't follow it
+    ASSERT_EQ(0, Open());
+    ASSERT_EQ(0, Append(3 * kUnit, kUnit, 'd'));
+    WaitFlushes(1);
+    log_.reset();
+    flushes_.clear();
+
+    std::vector<std::pair<off_t, size_t>> replayed;
+    ASSERT_EQ(0, Open(&replayed));
+    ASSERT_EQ(2, replayed.size());
+    ASSERT_EQ(std::string(kUnit, 'a') + std::string(2 * kUnit, '0') +
+                  std::string(kUnit, 'd'),
+              Read(0, 4 * kUnit));
+}
+
+}  // namespace client
+}  // namespace curve
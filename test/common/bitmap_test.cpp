@@ -22,6 +22,9 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdlib>
+#include <vector>
+
 #include "src/common/bitmap.h"
 
 namespace curve {
@@ -415,5 +418,54 @@ TEST(BitmapTEST, divide_test) {
     }
 }
 
+TEST(BitmapTEST, word_scan_test) {
+    // 按位查找的结果作为对照
+    auto nextBit = [](const Bitmap& bitmap, uint32_t start, uint32_t end,
+                      bool set) {
+        for (uint32_t i = start; i <= end && i < bitmap.Size(); ++i) {
+            if (bitmap.Test(i) == set) {
+                return i;
+            }
+        }
+        return Bitmap::NO_POS;
+    };
+
+    unsigned int seed = 1;
+    for (uint32_t bits : {1, 7, 63, 64, 65, 200, 1031}) {
+        Bitmap bitmap(bits);
+        std::vector<bool> expect(bits, false);
+        for (int round = 0; round < 20; ++round) {
+            uint32_t start = rand_r(&seed) % bits;
+            uint32_t end = start + rand_r(&seed) % (bits - start + 8);
+            bool set = round % 2 == 0;
+            if (set) {
+                bitmap.Set(start, end);
+            } else {
+                bitmap.Clear(start, end);
+            }
+            for (uint32_t i = start; i <= end && i < bits; ++i) {
+                expect[i] = set;
+            }
+            for (uint32_t i = 0; i < bits; ++i) {
+                ASSERT_EQ(expect[i], bitmap.Test(i));
+            }
+
+            for (uint32_t i = 0; i < bits; ++i) {
+                uint32_t last = i + rand_r(&seed) % (bits - i + 8);
+                ASSERT_EQ(nextBit(bitmap, i, bits - 1, true),
+                          bitmap.NextSetBit(i));
+                ASSERT_EQ(nextBit(bitmap, i, bits - 1, false),
+                          bitmap.NextClearBit(i));
+                ASSERT_EQ(nextBit(bitmap, i, last, true),
+                          bitmap.NextSetBit(i, last));
+                ASSERT_EQ(nextBit(bitmap, i, last, false),
+                          bitmap.NextClearBit(i, last));
+            }
+            ASSERT_EQ(Bitmap::NO_POS, bitmap.NextSetBit(bits));
+            ASSERT_EQ(Bitmap::NO_POS, bitmap.NextClearBit(bits));
+        }
+    }
+}
+
 }  // namespace common
 }  // namespace curve
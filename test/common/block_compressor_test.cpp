@@ -0,0 +1,133 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "src/common/block_compressor.h"
+
+namespace curve {
+namespace common {
+
+class BlockCompressorTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        // compressible blocks mixed with random ones
+        data_.resize(4 * BlockCompressor::kDefaultBlockSize + 100);
+        uint32_t seed = 1;
+        for (size_t i = 0; i < data_.size(); i++) {
+            if ((i / BlockCompressor::kDefaultBlockSize) % 2 == 0) {
+                data_[i] = 'a' + (i / 1024) % 26;
+            } else {
+                seed = seed * 1103515245 + 12345;
+                data_[i] = static_cast<char>(seed >> 16);
+            }
+        }
+        ASSERT_TRUE(BlockCompressor::Compress(CompressType::SNAPPY,
+                                              data_.data(), data_.size(),
+                                              &compressed_));
+        ASSERT_TRUE(BlockCompressor::ParseHeader(
+            compressed_.data(), BlockCompressor::kHeaderSize, &header_));
+    }
+
+    // read [off, off + len) like a reader holding the object
+    std::string Read(uint64_t off, uint64_t len) {
+        uint64_t cOff = 0;
+        uint64_t cLen = 0;
+        EXPECT_TRUE(BlockCompressor::GetCompressedRange(header_, off, len,
+                                                        &cOff, &cLen));
+        EXPECT_LE(cOff + cLen, compressed_.size());
+        std::string out(len, '\0');
+        EXPECT_TRUE(BlockCompressor::Decompress(header_,
+                                                compressed_.data() + cOff,
+                                                cLen, off, len, &out[0]));
+        return out;
+    }
+
+    std::string data_;
+    std::string compressed_;
+    CompressedDataHeader header_;
+};
+
+TEST_F(BlockCompressorTest, TestHeader) {
+    ASSERT_EQ(CompressType::SNAPPY, header_.type);
+    ASSERT_EQ(data_.size(), header_.rawLen);
+    ASSERT_EQ(BlockCompressor::kDefaultBlockSize, header_.blockSize);
+    ASSERT_EQ(5, header_.blockLens.size());
+    ASSERT_LT(compressed_.size(), data_.size());
+
+    ASSERT_FALSE(BlockCompressor::ParseHeader(compressed_.data(), 10,
+                                              &header_));
+    std::string corrupted = compressed_;
+    corrupted[0] = 0;
+    ASSERT_FALSE(BlockCompressor::ParseHeader(
+        corrupted.data(), BlockCompressor::kHeaderSize, &header_));
+}
+
+TEST_F(BlockCompressorTest, TestReadRange) {
+    ASSERT_EQ(data_, Read(0, data_.size()));
+    // inside one block, across blocks and the short last block
+    ASSERT_EQ(data_.substr(100, 4096), Read(100, 4096));
+    ASSERT_EQ(data_.substr(BlockCompressor::kDefaultBlockSize - 10, 100),
+              Read(BlockCompressor::kDefaultBlockSize - 10, 100));
+    ASSERT_EQ(data_.substr(data_.size() - 150), Read(data_.size() - 150, 150));
+
+    uint64_t cOff = 0;
+    uint64_t cLen = 0;
+    ASSERT_FALSE(BlockCompressor::GetCompressedRange(header_, data_.size(), 1,
+                                                     &cOff, &cLen));
+    ASSERT_FALSE(BlockCompressor::GetCompressedRange(header_, 0, 0,
+                                                     &cOff, &cLen));
+
+    // truncated compressed data
+    std::string out(data_.size(), '\0');
+    ASSERT_FALSE(BlockCompressor::Decompress(
+        header_, compressed_.data() + BlockCompressor::kHeaderSize, 10, 0,
+        data_.size(), &out[0]));
+}
+
+TEST_F(BlockCompressorTest, TestLargeData) {
+    // the blocks are enlarged to fit in the header
+    std::string data(128 * 1024 * 1024, 'x');
+    std::string compressed;
+    CompressedDataHeader header;
+    ASSERT_TRUE(BlockCompressor::Compress(CompressType::SNAPPY, data.data(),
+                                          data.size(), &compressed));
+    ASSERT_TRUE(BlockCompressor::ParseHeader(
+        compressed.data(), BlockCompressor::kHeaderSize, &header));
+    ASSERT_GT(header.blockSize, BlockCompressor::kDefaultBlockSize);
+    ASSERT_EQ(0, header.blockSize % 4096);
+    ASSERT_LE(header.blockLens.size() * header.blockSize - data.size(),
+              header.blockSize);
+}
+
+TEST(CompressTypeTest, TestString) {
+    CompressType type;
+    ASSERT_TRUE(StringToCompressType("snappy", &type));
+    ASSERT_EQ(CompressType::SNAPPY, type);
+    ASSERT_STREQ("snappy", CompressTypeToString(type));
+    ASSERT_TRUE(StringToCompressType("none", &type));
+    ASSERT_EQ(CompressType::NONE, type);
+    ASSERT_FALSE(StringToCompressType("lz4", &type));
+
+    std::string compressed;
+    ASSERT_FALSE(BlockCompressor::Compress(CompressType::NONE, "a", 1,
+                                           &compressed));
+}
+
+}  // namespace common
+}  // namespace curve
@@ -22,6 +22,8 @@
 
 #include <gtest/gtest.h>
 
+#include <set>
+
 #include "src/common/channel_pool.h"
 
 namespace curve {
@@ -47,5 +49,23 @@ TEST(Common, ChannelPool) {
     channelPool.Clear();
 }
 
+TEST(Common, ChannelPoolWithMultiConnections) {
+    ChannelPool channelPool(3);
+    std::string addr = "127.0.0.1:80000";
+    ChannelPtr channelPtr;
+    ASSERT_EQ(-1, channelPool.GetOrInitChannel(addr, &channelPtr));
+
+    // 同一个地址轮流返回不同连接的channel
+    addr = "127.0.0.1:8000";
+    std::set<ChannelPtr> channels;
+    for (int i = 0; i < 6; ++i) {
+        ASSERT_EQ(0, channelPool.GetOrInitChannel(addr, &channelPtr));
+        ASSERT_TRUE(channelPtr);
+        channels.insert(channelPtr);
+    }
+    ASSERT_EQ(3, channels.size());
+    channelPool.Clear();
+}
+
 }  // namespace common
 }  // namespace curve
@@ -22,6 +22,10 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdlib>
+#include <string>
+#include <vector>
+
 #include "src/common/crc32.h"
 
 namespace curve {
@@ -92,5 +96,53 @@ TEST(Crc32TEST, Extend) {
             CRC32(CRC32("hello ", 6), "world", 5));
 }
 
+TEST(Crc32TEST, SameAsButil) {
+  // 覆盖3路交织计算的长短两种分段, 以及不对齐的起始地址
+  std::vector<char> buf(3 * 8192 * 2 + 3 * 256 + 100);
+  for (auto &c : buf) {
+    c = static_cast<char>(rand());  // NOLINT
+  }
+  std::vector<size_t> lens = {0, 1, 7, 8, 255, 768, 769, 3 * 8192,
+                              3 * 8192 + 3 * 256 + 9, buf.size() - 3};
+  for (size_t off = 0; off < 3; off++) {
+    for (size_t len : lens) {
+      ASSERT_EQ(butil::crc32c::Value(buf.data() + off, len),
+                CRC32(buf.data() + off, len)) << off << ", " << len;
+      ASSERT_EQ(butil::crc32c::Extend(0x12345678, buf.data() + off, len),
+                CRC32(0x12345678, buf.data() + off, len))
+          << off << ", " << len;
+    }
+  }
+}
+
+TEST(Crc32TEST, Combine) {
+  ASSERT_EQ(CRC32("hello world", 11),
+            CRC32Combine(CRC32("hello ", 6), CRC32("world", 5), 5));
+  ASSERT_EQ(CRC32("hello", 5), CRC32Combine(CRC32("hello", 5), 0, 0));
+
+  std::string data(1 << 20, 'a');
+  for (size_t i = 0; i < data.size(); i += 97) {
+    data[i] = static_cast<char>(i);
+  }
+  size_t half = data.size() / 3;
+  ASSERT_EQ(CRC32(data.data(), data.size()),
+            CRC32Combine(CRC32(data.data(), half),
+                         CRC32(data.data() + half, data.size() - half),
+                         data.size() - half));
+}
+
+TEST(Crc32TEST, IOBuf) {
+  std::string a(5000, 'a');
+  std::string b(3000, 'b');
+  butil::IOBuf buf;
+  buf.append(a);
+  butil::IOBuf other;
+  other.append(b);
+  buf.append(other);
+  std::string all = a + b;
+  ASSERT_EQ(CRC32(all.data(), all.size()), CRC32(buf));
+  ASSERT_EQ(CRC32(1, all.data(), all.size()), CRC32(1, buf));
+}
+
 }  // namespace common
 }  // namespace curve
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <vector>
+
+#include "src/common/erasure_code.h"
+
+namespace curve {
+namespace common {
+
+namespace {
+
+struct Stripe {
+    Stripe(uint32_t shardNum, size_t length)
+        : buffers(shardNum, std::vector<uint8_t>(length)) {
+        for (auto& buffer : buffers) {
+            ptrs.push_back(buffer.data());
+        }
+    }
+
+    std::vector<std::vector<uint8_t>> buffers;
+    std::vector<uint8_t*> ptrs;
+};
+
+Stripe EncodeRandom(const ErasureCode& code, size_t length) {
+    Stripe stripe(code.DataNum() + code.ParityNum(), length);
+    for (uint32_t i = 0; i < code.DataNum(); ++i) {
+        for (auto& byte : stripe.buffers[i]) {
+            byte = static_cast<uint8_t>(rand());  // NOLINT
+        }
+    }
+    code.Encode(stripe.ptrs.data(), stripe.ptrs.data() + code.DataNum(),
+                length);
+    return stripe;
+}
+
+}  // namespace
+
+TEST(ErasureCodeTest, InvalidNum) {
+    ErasureCode code;
+    ASSERT_FALSE(code.Init(0, 2));
+    ASSERT_FALSE(code.Init(4, 0));
+    ASSERT_FALSE(code.Init(200, 57));
+    ASSERT_TRUE(code.Init(200, 56));
+}
+
+TEST(ErasureCodeTest, RecoverAnyLostShards) {
+    const size_t length = 4096;
+    ErasureCode code;
+    ASSERT_TRUE(code.Init(4, 2));
+    const Stripe origin = EncodeRandom(code, length);
+
+    // every combination of at most 2 lost shards out of 6
+    for (uint32_t lost = 0; lost < (1u << 6); ++lost) {
+        if (__builtin_popcount(lost) > 2) {
+            continue;
+        }
+        Stripe stripe = origin;
+        stripe.ptrs.clear();
+        std::vector<bool> present(6);
+        for (uint32_t i = 0; i < 6; ++i) {
+            stripe.ptrs.push_back(stripe.buffers[i].data());
+            present[i] = !(lost & (1u << i));
+            if (!present[i]) {
+                stripe.buffers[i].assign(length, 0xff);
+            }
+        }
+        ASSERT_TRUE(code.Decode(stripe.ptrs.data(), present, length));
+        ASSERT_EQ(origin.buffers, stripe.buffers) << "lost " << lost;
+    }
+}
+
+TEST(ErasureCodeTest, TooManyLost) {
+    const size_t length = 512;
+    ErasureCode code;
+    ASSERT_TRUE(code.Init(8, 3));
+    Stripe stripe = EncodeRandom(code, length);
+
+    std::vector<bool> present(11, true);
+    present[0] = present[5] = present[9] = false;
+    ASSERT_TRUE(code.Decode(stripe.ptrs.data(), present, length));
+    present[10] = false;
+    ASSERT_FALSE(code.Decode(stripe.ptrs.data(), present, length));
+}
+
+}  // namespace common
+}  // namespace curve
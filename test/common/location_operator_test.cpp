@@ -33,6 +33,9 @@ TEST(LocationOperatorTest, GenerateTest) {
     std::string location = LocationOperator::GenerateS3Location("test");
     ASSERT_STREQ("test@s3", location.c_str());
 
+    location = LocationOperator::GenerateS3CompressedLocation("test");
+    ASSERT_STREQ("test@s3z", location.c_str());
+
     location = LocationOperator::GenerateCurveLocation("test", 0);
     ASSERT_STREQ("test:0@cs", location.c_str());
 }
@@ -58,6 +61,11 @@ TEST(LocationOperatorTest, GenerateCurveLocationTest) {
               LocationOperator::ParseLocation(location, &originPath));
     ASSERT_STREQ(originPath.c_str(), "test");
 
+    location = "test@s3z";
+    ASSERT_EQ(OriginType::S3CompressedOrigin,
+              LocationOperator::ParseLocation(location, &originPath));
+    ASSERT_STREQ(originPath.c_str(), "test");
+
     location = "test@cs";
     ASSERT_EQ(OriginType::CurveOrigin,
               LocationOperator::ParseLocation(location, &originPath));
@@ -23,6 +23,8 @@
 #include <gtest/gtest.h>
 #include <glog/logging.h>
 #include <cstdint>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "src/common/lru_cache.h"
 #include "src/common/timeutility.h"
@@ -128,6 +130,13 @@ TEST(CaCheTest, test_cache_with_capacity_no_limit) {
     // 2. 测试元素删除
     cache->Remove("1");
     ASSERT_FALSE(cache->Get("1", &res));
+
+    // 3. 测试清空
+    cache->Clear();
+    ASSERT_EQ(0, cache->Size());
+    ASSERT_FALSE(cache->Get("2", &res));
+    ASSERT_EQ(0, cache->GetCacheMetrics()->cacheCount.get_value());
+    ASSERT_EQ(0, cache->GetCacheMetrics()->cacheBytes.get_value());
 }
 
 TEST(CaCheTest, TestCacheHitAndMissMetric) {
@@ -353,6 +362,173 @@ TEST(TimedCaCheTest, test_timeout) {
     ASSERT_EQ(0, cache->Size());
 }
 
+TEST(ClockCacheTest, test_cache_with_capacity_limit) {
+    int maxCount = 5;
+    auto cache = std::make_shared<ClockCache<std::string, std::string>>(
+        maxCount, 1 /* shardNum */, std::make_shared<CacheMetrics>("Clock"));
+
+    // 1. put and get
+    for (int i = 1; i <= maxCount; i++) {
+        cache->Put(std::to_string(i), std::to_string(i));
+        ASSERT_EQ(i, cache->Size());
+    }
+    std::string res;
+    for (int i = 1; i <= maxCount; i++) {
+        ASSERT_TRUE(cache->Get(std::to_string(i), &res));
+        ASSERT_EQ(std::to_string(i), res);
+    }
+
+    // 2. the hand clears all reference bits and evicts the first one
+    std::string eliminated;
+    ASSERT_TRUE(cache->Put("6", "6", &eliminated));
+    ASSERT_EQ("1", eliminated);
+    ASSERT_EQ(maxCount, cache->Size());
+    ASSERT_FALSE(cache->Get("1", &res));
+
+    // 3. the referenced item gets a second chance
+    ASSERT_TRUE(cache->Get("2", &res));
+    ASSERT_TRUE(cache->Put("7", "7", &eliminated));
+    ASSERT_EQ("3", eliminated);
+    ASSERT_TRUE(cache->Get("2", &res));
+
+    // 4. overwrite doesn't evict
+    ASSERT_FALSE(cache->Put("7", "77", &eliminated));
+    ASSERT_TRUE(cache->Get("7", &res));
+    ASSERT_EQ("77", res);
+    ASSERT_EQ(maxCount, cache->Size());
+
+    // 5. remove and reuse the slot
+    cache->Remove("7");
+    ASSERT_FALSE(cache->Get("7", &res));
+    ASSERT_EQ(maxCount - 1, cache->Size());
+    ASSERT_FALSE(cache->Put("8", "8", &eliminated));
+    ASSERT_EQ(maxCount, cache->Size());
+    ASSERT_EQ(maxCount, cache->GetCacheMetrics()->cacheCount.get_value());
+}
+
+TEST(ClockCacheTest, test_cache_with_shards) {
+    int maxCount = 100;
+    auto cache = std::make_shared<ClockCache<int, int>>(maxCount, 4);
+    for (int i = 0; i < 1000; i++) {
+        cache->Put(i, i);
+    }
+    ASSERT_EQ(maxCount, cache->Size());
+
+    int res;
+    for (int i = 900; i < 1000; i++) {
+        ASSERT_TRUE(cache->Get(i, &res));
+        ASSERT_EQ(i, res);
+    }
+}
+
+TEST(ClockCacheTest, test_concurrent_get_and_put) {
+    int maxCount = 1024;
+    auto cache = std::make_shared<ClockCache<int, int>>(maxCount);
+    for (int i = 0; i < maxCount; i++) {
+        cache->Put(i, i);
+    }
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&, t]() {
+            int res;
+            for (int i = 0; i < 10000; i++) {
+                int key = (i * 7 + t) % (2 * maxCount);
+                if (cache->Get(key, &res)) {
+                    ASSERT_EQ(key, res);
+                } else {
+                    cache->Put(key, key);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(maxCount, cache->Size());
+}
+
+TEST(CaCheTest, test_cache_with_bytes_limit) {
+    // every item takes 2 bytes
+    auto cache = std::make_shared<LRUCache<std::string, std::string>>(
+        0 /* maxCount */, 6 /* maxBytes */,
+        std::make_shared<CacheMetrics>("LruBytes"));
+    std::string eliminated;
+    for (int i = 1; i <= 3; i++) {
+        ASSERT_FALSE(cache->Put(std::to_string(i), std::to_string(i),
+                                &eliminated));
+    }
+    ASSERT_EQ(3, cache->Size());
+    ASSERT_EQ(6, cache->GetCacheMetrics()->cacheBytes.get_value());
+
+    ASSERT_TRUE(cache->Put("4", "4", &eliminated));
+    ASSERT_EQ("1", eliminated);
+    ASSERT_EQ(3, cache->Size());
+
+    // evict several items for a big one
+    ASSERT_TRUE(cache->Put("5", "555", &eliminated));
+    ASSERT_EQ("3", eliminated);
+    ASSERT_EQ(2, cache->Size());
+    ASSERT_EQ(6, cache->GetCacheMetrics()->cacheBytes.get_value());
+
+    // the newest item is kept even if it exceeds the limit
+    ASSERT_TRUE(cache->Put("6", "6666666", &eliminated));
+    ASSERT_EQ(1, cache->Size());
+    std::string res;
+    ASSERT_TRUE(cache->Get("6", &res));
+    ASSERT_EQ("6666666", res);
+}
+
+TEST(ShardedCacheTest, test_lru_shards) {
+    int maxCount = 100;
+    auto metrics = std::make_shared<CacheMetrics>("ShardedLru");
+    ShardedCache<int, int> cache(maxCount, 4, metrics);
+    ASSERT_EQ(4, cache.GetShardNum());
+    for (int i = 0; i < 1000; i++) {
+        cache.Put(i, i);
+    }
+    ASSERT_EQ(maxCount, cache.Size());
+    ASSERT_EQ(maxCount, metrics->cacheCount.get_value());
+
+    int res;
+    for (int i = 900; i < 1000; i++) {
+        ASSERT_TRUE(cache.Get(i, &res));
+        ASSERT_EQ(i, res);
+    }
+    ASSERT_FALSE(cache.Get(0, &res));
+    cache.Remove(999);
+    ASSERT_FALSE(cache.Get(999, &res));
+    ASSERT_EQ(maxCount - 1, cache.Size());
+}
+
+TEST(ShardedCacheTest, test_arc_shards_and_shard_metrics) {
+    // ARCCache keeps half of |maxCount| items resident
+    ShardedCache<int, int, ARCCache<int, int>> cache(
+        128, 4, 0 /* maxBytes */, "ShardedArc");
+    for (int i = 0; i < 64; i++) {
+        cache.Put(i, i);
+    }
+    int res;
+    for (int i = 0; i < 64; i++) {
+        ASSERT_TRUE(cache.Get(i, &res));
+    }
+    ASSERT_EQ(nullptr, cache.GetCacheMetrics());
+    uint64_t hits = 0;
+    for (uint32_t i = 0; i < cache.GetShardNum(); i++) {
+        hits += cache.GetShardCacheMetrics(i)->cacheHit.get_value();
+    }
+    ASSERT_EQ(64, hits);
+}
+
+TEST(ShardedCacheTest, test_bytes_limit) {
+    // 4 shards and 8 bytes per shard, every item takes 8 bytes
+    ShardedCache<uint32_t, uint32_t> cache(0, 4, nullptr, 32);
+    for (uint32_t i = 0; i < 100; i++) {
+        cache.Put(i, i);
+    }
+    ASSERT_EQ(4, cache.Size());
+}
+
 }  // namespace common
 }  // namespace curve
 
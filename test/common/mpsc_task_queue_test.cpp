@@ -0,0 +1,131 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <thread>              // NOLINT
+#include <vector>
+
+#include "src/common/concurrent/mpsc_task_queue.h"
+
+namespace curve {
+namespace common {
+
+using TestQueue = MPSCTaskQueue<std::mutex, std::condition_variable>;
+
+TEST(MPSCTaskQueueTest, CapacityTest) {
+    ASSERT_EQ(2, TestQueue(1).Capacity());
+    ASSERT_EQ(4, TestQueue(3).Capacity());
+    ASSERT_EQ(64, TestQueue(64).Capacity());
+}
+
+TEST(MPSCTaskQueueTest, PushPopTest) {
+    TestQueue queue(4);
+    int value = 0;
+    for (int i = 1; i <= 4; ++i) {
+        queue.Push([&value](int v) { value = v; }, i);
+    }
+    ASSERT_EQ(4, queue.Size());
+
+    for (int i = 1; i <= 4; ++i) {
+        queue.Pop()();
+        ASSERT_EQ(i, value);
+    }
+    ASSERT_EQ(0, queue.Size());
+}
+
+TEST(MPSCTaskQueueTest, PopBatchTest) {
+    TestQueue queue(8);
+    std::vector<int> values;
+    for (int i = 0; i < 6; ++i) {
+        queue.Push([&values, i]() { values.push_back(i); });
+    }
+
+    std::vector<TestQueue::Task> tasks;
+    ASSERT_EQ(4, queue.PopBatch(&tasks, 4));
+    ASSERT_EQ(2, queue.PopBatch(&tasks, 4));
+    for (auto& task : tasks) {
+        task();
+    }
+    ASSERT_EQ(std::vector<int>({0, 1, 2, 3, 4, 5}), values);
+}
+
+TEST(MPSCTaskQueueTest, BlockingTest) {
+    TestQueue queue(1);
+    std::atomic<int> count(0);
+    auto task = [&count]() { count.fetch_add(1); };
+
+    // consumer is blocked until a task is pushed
+    std::thread consumer([&queue]() {
+        for (int i = 0; i < 3; ++i) {
+            queue.Pop()();
+        }
+    });
+
+    // producer is blocked when the queue is full
+    for (int i = 0; i < 3; ++i) {
+        queue.Push(task);
+    }
+    consumer.join();
+    ASSERT_EQ(3, count.load());
+}
+
+TEST(MPSCTaskQueueTest, MultiProducerTest) {
+    const int producerNum = 8;
+    const int taskNum = 100000;
+    TestQueue queue(16);
+    std::vector<int> lastSeen(producerNum, -1);
+    bool ordered = true;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < producerNum; ++p) {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < taskNum; ++i) {
+                queue.Push([&, p, i]() {
+                    // tasks from one producer keep their order
+                    if (lastSeen[p] + 1 != i) {
+                        ordered = false;
+                    }
+                    lastSeen[p] = i;
+                });
+            }
+        });
+    }
+
+    std::vector<TestQueue::Task> tasks;
+    int64_t popped = 0;
+    while (popped < producerNum * taskNum) {
+        popped += queue.PopBatch(&tasks, queue.Capacity());
+        for (auto& task : tasks) {
+            task();
+        }
+        tasks.clear();
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    ASSERT_TRUE(ordered);
+    for (int p = 0; p < producerNum; ++p) {
+        ASSERT_EQ(taskNum - 1, lastSeen[p]);
+    }
+}
+
+}  // namespace common
+}  // namespace curve
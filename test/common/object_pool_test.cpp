@@ -0,0 +1,110 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "src/common/object_pool.h"
+
+namespace curve {
+namespace common {
+
+namespace {
+
+struct alignas(64) PooledObject : public PoolAllocated<PooledObject> {
+    PooledObject() = default;
+    explicit PooledObject(int v) : value(v) {}
+    virtual ~PooledObject() = default;
+
+    int value = 0;
+    std::string name;
+};
+
+struct LargerObject : public PooledObject {
+    char payload[256];
+};
+
+bool IsAligned(const void* ptr, size_t align) {
+    return reinterpret_cast<uintptr_t>(ptr) % align == 0;
+}
+
+}  // namespace
+
+TEST(ObjectPoolTest, ReuseInOneThread) {
+    void* ptr = ObjectPool<PooledObject>::Allocate();
+    ASSERT_NE(nullptr, ptr);
+    ASSERT_TRUE(IsAligned(ptr, 64));
+    ObjectPool<PooledObject>::Deallocate(ptr);
+    ASSERT_EQ(ptr, ObjectPool<PooledObject>::Allocate());
+    ObjectPool<PooledObject>::Deallocate(ptr);
+}
+
+TEST(ObjectPoolTest, ReuseAcrossThreads) {
+    const size_t count = 4 * ObjectPool<PooledObject>::kBatchSize;
+    std::vector<void*> ptrs;
+    for (size_t i = 0; i < count; ++i) {
+        ptrs.push_back(ObjectPool<PooledObject>::Allocate());
+    }
+    std::set<void*> allocated(ptrs.begin(), ptrs.end());
+
+    // the blocks freed by another thread come back in batches
+    std::thread freeThread([&ptrs]() {
+        for (auto ptr : ptrs) {
+            ObjectPool<PooledObject>::Deallocate(ptr);
+        }
+    });
+    freeThread.join();
+
+    size_t reused = 0;
+    ptrs.clear();
+    for (size_t i = 0; i < count; ++i) {
+        void* ptr = ObjectPool<PooledObject>::Allocate();
+        reused += allocated.count(ptr);
+        ptrs.push_back(ptr);
+    }
+    ASSERT_GE(reused, 2 * ObjectPool<PooledObject>::kBatchSize);
+    for (auto ptr : ptrs) {
+        ObjectPool<PooledObject>::Deallocate(ptr);
+    }
+}
+
+TEST(ObjectPoolTest, PoolAllocated) {
+    PooledObject* obj = new PooledObject(1);
+    obj->name = "used";
+    ASSERT_TRUE(IsAligned(obj, 64));
+    delete obj;
+
+    // constructed from scratch when the block is reused
+    PooledObject* reused = new (std::nothrow) PooledObject();
+    ASSERT_EQ(obj, reused);
+    ASSERT_EQ(0, reused->value);
+    ASSERT_TRUE(reused->name.empty());
+
+    // the derived class of a different size is not pooled
+    PooledObject* larger = new LargerObject();
+    ASSERT_NE(obj, larger);
+    ASSERT_TRUE(IsAligned(larger, 64));
+    delete larger;
+    delete reused;
+}
+
+}  // namespace common
+}  // namespace curve
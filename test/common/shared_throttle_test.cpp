@@ -0,0 +1,100 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/common/shared_throttle.h"
+
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <string>
+
+namespace curve {
+namespace common {
+
+class SharedThrottleTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        name_ = "test_" + std::to_string(getpid());
+    }
+
+    void TearDown() override {
+        shm_unlink(("/curve_throttle_" + name_).c_str());
+    }
+
+ protected:
+    std::string name_;
+};
+
+TEST_F(SharedThrottleTest, TestNoLimit) {
+    auto throttle = SharedThrottle::Open(name_);
+    ASSERT_NE(nullptr, throttle);
+    ASSERT_EQ(throttle, SharedThrottle::Open(name_));
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(0, throttle->Acquire(i % 2 == 0, 4096));
+    }
+}
+
+TEST_F(SharedThrottleTest, TestLimitAndBurstCredits) {
+    auto throttle = SharedThrottle::Open(name_);
+    ASSERT_NE(nullptr, throttle);
+
+    // 10 iops, and the credits of 10 requests
+    ReadWriteThrottleParams params;
+    params.iopsWrite = ThrottleParams(10, 20, 1);
+    throttle->UpdateThrottleParams(params);
+
+    // reads are not limited
+    ASSERT_EQ(0, throttle->Acquire(true, 4096));
+    // the credits and the current slot
+    for (int i = 0; i < 11; i++) {
+        ASSERT_EQ(0, throttle->Acquire(false, 4096));
+    }
+    uint64_t waitUs = throttle->Acquire(false, 4096);
+    ASSERT_GT(waitUs, 50 * 1000);
+    ASSERT_LE(waitUs, 100 * 1000);
+    waitUs = throttle->Acquire(false, 4096);
+    ASSERT_GT(waitUs, 150 * 1000);
+    ASSERT_LE(waitUs, 200 * 1000);
+}
+
+TEST_F(SharedThrottleTest, TestShareAmongProcesses) {
+    auto throttle = SharedThrottle::Open(name_);
+    ASSERT_NE(nullptr, throttle);
+    ReadWriteThrottleParams params;
+    params.bpsTotal = ThrottleParams(1024 * 1024, 0, 0);
+    throttle->UpdateThrottleParams(params);
+
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        // the child process takes 1 second of the limit
+        auto child = SharedThrottle::Open(name_);
+        _exit(child != nullptr && child->Acquire(true, 1024 * 1024) == 0
+                  ? 0 : 1);
+    }
+    int status = 0;
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    ASSERT_EQ(0, WEXITSTATUS(status));
+
+    uint64_t waitUs = throttle->Acquire(false, 4096);
+    ASSERT_GT(waitUs, 500 * 1000);
+    ASSERT_LE(waitUs, 1000 * 1000);
+}
+
+}  // namespace common
+}  // namespace curve
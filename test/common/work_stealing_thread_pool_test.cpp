@@ -0,0 +1,91 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/common/concurrent/work_stealing_thread_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+
+#include "src/common/concurrent/count_down_event.h"
+
+namespace curve {
+namespace common {
+
+TEST(WorkStealingThreadPoolTest, StartAndStop) {
+    WorkStealingThreadPool pool;
+    ASSERT_EQ(-1, pool.Start(0));
+    ASSERT_EQ(0, pool.Start(4));
+    ASSERT_EQ(0, pool.Start(4));
+    ASSERT_EQ(4, pool.ThreadOfNums());
+    pool.Stop();
+    pool.Stop();
+}
+
+class WorkStealingThreadPoolRunTest : public ::testing::TestWithParam<bool> {};
+
+TEST_P(WorkStealingThreadPoolRunTest, RunAllTasks) {
+    WorkStealingThreadPool pool("work_stealing_test");
+    ASSERT_EQ(0, pool.Start(4, GetParam()));
+
+    const int kTaskNum = 10000;
+    std::atomic<int> sum(0);
+    CountDownEvent done(kTaskNum);
+    for (int i = 0; i < kTaskNum; i++) {
+        pool.Enqueue([&sum, &done](int v) {
+            sum.fetch_add(v);
+            done.Signal();
+        }, 1);
+    }
+    done.Wait();
+    ASSERT_EQ(kTaskNum, sum.load());
+    ASSERT_EQ(0, pool.QueueSize());
+    pool.Stop();
+}
+
+TEST_P(WorkStealingThreadPoolRunTest, TasksSubmittedByTaskAreStolen) {
+    WorkStealingThreadPool pool;
+    ASSERT_EQ(0, pool.Start(4, GetParam()));
+
+    // all the subtasks go to one deque if submitted by a pthread worker,
+    // the other workers steal them, so they run in parallel anyway
+    const int kSubTaskNum = 8;
+    CountDownEvent done(kSubTaskNum);
+    pool.Enqueue([&]() {
+        for (int i = 0; i < kSubTaskNum; i++) {
+            pool.Enqueue([&done]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                done.Signal();
+            });
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    done.Wait();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    ASSERT_LT(elapsed.count(), 8 * 100);
+    pool.Stop();
+}
+
+INSTANTIATE_TEST_CASE_P(WorkStealingThreadPoolTest,
+                        WorkStealingThreadPoolRunTest,
+                        ::testing::Values(false, true));
+
+}  // namespace common
+}  // namespace curve
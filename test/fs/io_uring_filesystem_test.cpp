@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include "src/fs/io_uring_filesystem_impl.h"
+
+namespace curve {
+namespace fs {
+
+class IoUringFileSystemTest : public testing::Test {
+ public:
+    void SetUp() {
+        lfs_ = IoUringFileSystemImpl::getInstance();
+        LocalFileSystemOption option;
+        option.ioUringQueueDepth = 16;
+        supported_ = (lfs_->Init(option) == 0);
+        path_ = "./io_uring_filesystem_test.data";
+    }
+
+    void TearDown() {
+        lfs_->Delete(path_);
+    }
+
+ protected:
+    std::shared_ptr<IoUringFileSystemImpl> lfs_;
+    std::string path_;
+    bool supported_;
+};
+
+TEST_F(IoUringFileSystemTest, FactoryTest) {
+    auto lfs = LocalFsFactory::CreateFs(FileSystemType::EXT4_IO_URING, "");
+    ASSERT_EQ(lfs.get(), lfs_.get());
+}
+
+TEST_F(IoUringFileSystemTest, ReadWriteTest) {
+    if (!supported_) {
+        LOG(INFO) << "io_uring is not supported, skip";
+        return;
+    }
+
+    int fd = lfs_->Open(path_, O_RDWR | O_CREAT);
+    ASSERT_GE(fd, 0);
+
+    const int length = 8192;
+    std::string data(length, 'a');
+    data[4096] = 'b';
+    ASSERT_EQ(length, lfs_->Write(fd, data.c_str(), 4096, length));
+
+    std::string buf(length, '\0');
+    ASSERT_EQ(length, lfs_->Read(fd, &buf[0], 4096, length));
+    ASSERT_EQ(data, buf);
+
+    // read beyond the end of file
+    ASSERT_EQ(4096, lfs_->Read(fd, &buf[0], 8192, length));
+    ASSERT_EQ(0, lfs_->Read(fd, &buf[0], 12288, length));
+
+    // invalid fd
+    ASSERT_EQ(-EBADF, lfs_->Read(-1, &buf[0], 0, length));
+    ASSERT_EQ(-EBADF, lfs_->Write(-1, data.c_str(), 0, length));
+
+    ASSERT_EQ(0, lfs_->Close(fd));
+}
+
+TEST_F(IoUringFileSystemTest, IOBufWriteTest) {
+    if (!supported_) {
+        LOG(INFO) << "io_uring is not supported, skip";
+        return;
+    }
+
+    int fd = lfs_->Open(path_, O_RDWR | O_CREAT);
+    ASSERT_GE(fd, 0);
+
+    // build an IOBuf with plenty of blocks, so it is split into
+    // several writev requests
+    butil::IOBuf iobuf;
+    std::string expected;
+    for (int i = 0; i < 4096; ++i) {
+        std::string piece(512, 'a' + i % 26);
+        butil::IOBuf block;
+        block.append(piece);
+        iobuf.append(block);
+        expected.append(piece);
+    }
+    ASSERT_EQ(expected.size(), iobuf.size());
+
+    int length = iobuf.size();
+    ASSERT_EQ(-EINVAL, lfs_->Write(fd, iobuf, 0, length + 1));
+    ASSERT_EQ(length, lfs_->Write(fd, iobuf, 0, length));
+
+    std::string buf(length, '\0');
+    ASSERT_EQ(length, lfs_->Read(fd, &buf[0], 0, length));
+    ASSERT_EQ(expected, buf);
+
+    ASSERT_EQ(0, lfs_->Close(fd));
+}
+
+TEST(IoUringQueueTest, QueueFullTest) {
+    IoUringQueue queue;
+    if (queue.Init(4) != 0) {
+        LOG(INFO) << "io_uring is not supported, skip";
+        return;
+    }
+
+    char buf[16];
+    uint32_t prepared = 0;
+    while (queue.PrepRead(-1, buf, sizeof(buf), 0, prepared)) {
+        ++prepared;
+    }
+    ASSERT_EQ(queue.Capacity(), prepared);
+
+    ASSERT_EQ(prepared, queue.Submit(prepared));
+    uint64_t userData;
+    int res;
+    uint32_t completed = 0;
+    while (queue.PopCompletion(&userData, &res)) {
+        ASSERT_EQ(-EBADF, res);
+        ++completed;
+    }
+    ASSERT_EQ(prepared, completed);
+}
+
+}  // namespace fs
+}  // namespace curve
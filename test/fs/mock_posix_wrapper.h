@@ -49,6 +49,9 @@ class MockPosixWrapper : public PosixWrapper {
     MOCK_METHOD4(fallocate, int(int, int, off_t, off_t));
     MOCK_METHOD2(fstat, int(int, struct stat*));
     MOCK_METHOD1(fsync, int(int));
+    MOCK_METHOD4(sync_file_range,
+                 int(int, off_t, off_t, unsigned int));
+    MOCK_METHOD1(syncfs, int(int));
     MOCK_METHOD2(statfs, int(const char*, struct statfs*));
     MOCK_METHOD1(uname, int(struct utsname *));
 };
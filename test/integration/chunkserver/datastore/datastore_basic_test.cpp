@@ -193,5 +193,49 @@ TEST_F(BasicTestSuit, BasicTest) {
     ASSERT_FALSE(lfs_->FileExists(chunkPath));
 }
 
+/**
+ * 多线程并发加载chunk文件
+ */
+TEST_F(BasicTestSuit, ParallelLoadTest) {
+    const ChunkID chunkNum = 8;
+    SequenceNum sn = 1;
+    size_t length = PAGE_SIZE;
+    char writebuf[PAGE_SIZE];
+    for (ChunkID id = 1; id <= chunkNum; ++id) {
+        memset(writebuf, 'a' + id, length);
+        CSErrorCode errorCode = dataStore_->WriteChunk(id,
+                                                       sn,
+                                                       writebuf,
+                                                       0,
+                                                       length,
+                                                       nullptr);
+        ASSERT_EQ(errorCode, CSErrorCode::Success);
+    }
+
+    // 模拟重启，用多个线程加载chunk文件
+    DataStoreOptions options;
+    options.baseDir = baseDir;
+    options.chunkSize = CHUNK_SIZE;
+    options.metaPageSize = PAGE_SIZE;
+    options.blockSize = BLOCK_SIZE;
+    options.loadConcurrency = 4;
+    dataStore_ = std::make_shared<CSDataStore>(lfs_,
+                                               filePool_,
+                                               options);
+    ASSERT_TRUE(dataStore_->Initialize());
+    ASSERT_EQ(chunkNum, dataStore_->GetChunkMap().size());
+
+    char readbuf[PAGE_SIZE];
+    for (ChunkID id = 1; id <= chunkNum; ++id) {
+        CSChunkInfo info;
+        ASSERT_EQ(CSErrorCode::Success, dataStore_->GetChunkInfo(id, &info));
+        ASSERT_EQ(sn, info.curSn);
+        memset(writebuf, 'a' + id, length);
+        ASSERT_EQ(CSErrorCode::Success,
+                  dataStore_->ReadChunk(id, sn, readbuf, 0, length));
+        ASSERT_EQ(0, memcmp(writebuf, readbuf, length));
+    }
+}
+
 }  // namespace chunkserver
 }  // namespace curve
@@ -0,0 +1,148 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <fcntl.h>
+
+#include <string>
+
+#include "test/integration/chunkserver/datastore/datastore_integration_base.h"
+
+namespace curve {
+namespace chunkserver {
+
+const string baseDir = "./data_int_checksum";    // NOLINT
+const string poolDir = "./chunkfilepool_int_checksum";  // NOLINT
+const string poolMetaPath = "./chunkfilepool_int_checksum.meta";  // NOLINT
+
+const uint32_t kChecksumBlockSize = 128 * 1024;
+
+class ChecksumTestSuit : public DatastoreIntegrationBase {
+ public:
+    void SetUp() override {
+        DatastoreIntegrationBase::SetUp();
+        dataStore_ = CreateDataStore(kChecksumBlockSize);
+        ASSERT_TRUE(dataStore_->Initialize());
+    }
+
+    std::shared_ptr<CSDataStore> CreateDataStore(uint32_t checksumBlockSize) {
+        DataStoreOptions options;
+        options.baseDir = baseDir;
+        options.chunkSize = CHUNK_SIZE;
+        options.metaPageSize = PAGE_SIZE;
+        options.blockSize = BLOCK_SIZE;
+        options.locationLimit = 3000;
+        options.checksumBlockSize = checksumBlockSize;
+        return std::make_shared<CSDataStore>(lfs_, filePool_, options);
+    }
+
+    // 绕过datastore修改chunk文件中的数据
+    void CorruptChunk(ChunkID id, off_t offset) {
+        std::string path = baseDir + "/" +
+                           FileNameOperator::GenerateChunkFileName(id);
+        int fd = lfs_->Open(path, O_RDWR);
+        ASSERT_GE(fd, 0);
+        char c = 'x';
+        ASSERT_EQ(1, lfs_->Write(fd, &c, PAGE_SIZE + offset, 1));
+        lfs_->Close(fd);
+    }
+};
+
+TEST_F(ChecksumTestSuit, InvalidOptions) {
+    // 不是block size的整数倍
+    ASSERT_FALSE(CreateDataStore(BLOCK_SIZE + 512)->Initialize());
+    // metapage放不下
+    ASSERT_FALSE(CreateDataStore(BLOCK_SIZE)->Initialize());
+}
+
+TEST_F(ChecksumTestSuit, ReadVerified) {
+    ChunkID id = 1;
+    SequenceNum sn = 1;
+    std::string data(2 * kChecksumBlockSize, 'a');
+    ASSERT_EQ(CSErrorCode::Success,
+              dataStore_->WriteChunk(id, sn, data.c_str(), 0,
+                                     data.size(), nullptr));
+    // 只写了一部分的区域用盘上的数据补齐后计算校验和
+    std::string part(BLOCK_SIZE, 'b');
+    off_t partOffset = 2 * kChecksumBlockSize + BLOCK_SIZE;
+    ASSERT_EQ(CSErrorCode::Success,
+              dataStore_->WriteChunk(id, sn, part.c_str(), partOffset,
+                                     part.size(), nullptr));
+    ASSERT_EQ(FORMAT_VERSION_V3,
+              dataStore_->GetChunkMap()[id]->GetChunkFileMetaPage().version);
+
+    char buf[BLOCK_SIZE];
+    ASSERT_EQ(CSErrorCode::Success,
+              dataStore_->ReadChunk(id, sn, buf, BLOCK_SIZE, BLOCK_SIZE));
+    ASSERT_EQ(0, memcmp(buf, data.c_str(), BLOCK_SIZE));
+    ASSERT_EQ(CSErrorCode::Success,
+              dataStore_->ReadChunk(id, sn, buf, partOffset, BLOCK_SIZE));
+    ASSERT_EQ(0, memcmp(buf, part.c_str(), BLOCK_SIZE));
+    // 没写过的区域不校验
+    ASSERT_EQ(CSErrorCode::Success,
+              dataStore_->ReadChunk(id, sn, buf, CHUNK_SIZE - BLOCK_SIZE,
+                                    BLOCK_SIZE));
+
+    // 重启后校验和仍然有效
+    dataStore_ = CreateDataStore(0);
+    ASSERT_TRUE(dataStore_->Initialize());
+    ASSERT_EQ(CSErrorCode::Success,
+              dataStore_->ReadChunk(id, sn, buf, partOffset, BLOCK_SIZE));
+    ASSERT_EQ(0, memcmp(buf, part.c_str(), BLOCK_SIZE));
+
+    // 读同一区域中没有被改坏的部分也能发现错误
+    CorruptChunk(id, kChecksumBlockSize + 100);
+    ASSERT_EQ(CSErrorCode::Success,
+              dataStore_->ReadChunk(id, sn, buf, 0, BLOCK_SIZE));
+    ASSERT_EQ(CSErrorCode::CrcCheckError,
+              dataStore_->ReadChunk(id, sn, buf, kChecksumBlockSize,
+                                    BLOCK_SIZE));
+    ASSERT_EQ(CSErrorCode::CrcCheckError,
+              dataStore_->ReadChunk(id, sn, buf,
+                                    2 * kChecksumBlockSize - BLOCK_SIZE,
+                                    BLOCK_SIZE));
+
+    // 重新写整个区域后恢复
+    ASSERT_EQ(CSErrorCode::Success,
+              dataStore_->WriteChunk(id, sn, data.c_str(), kChecksumBlockSize,
+                                     kChecksumBlockSize, nullptr));
+    ASSERT_EQ(CSErrorCode::Success,
+              dataStore_->ReadChunk(id, sn, buf, kChecksumBlockSize,
+                                    BLOCK_SIZE));
+}
+
+TEST_F(ChecksumTestSuit, ExistingChunkKeepsFormat) {
+    ChunkID id = 1;
+    SequenceNum sn = 1;
+    std::string data(kChecksumBlockSize, 'a');
+    dataStore_ = CreateDataStore(0);
+    ASSERT_TRUE(dataStore_->Initialize());
+    ASSERT_EQ(CSErrorCode::Success,
+              dataStore_->WriteChunk(id, sn, data.c_str(), 0,
+                                     data.size(), nullptr));
+
+    // 开启后已有的chunk不保存校验和
+    dataStore_ = CreateDataStore(kChecksumBlockSize);
+    ASSERT_TRUE(dataStore_->Initialize());
+    ASSERT_EQ(FORMAT_VERSION_V2,
+              dataStore_->GetChunkMap()[id]->GetChunkFileMetaPage().version);
+    CorruptChunk(id, 100);
+    char buf[BLOCK_SIZE];
+    ASSERT_EQ(CSErrorCode::Success,
+              dataStore_->ReadChunk(id, sn, buf, 0, BLOCK_SIZE));
+}
+
+}  // namespace chunkserver
+}  // namespace curve
@@ -0,0 +1,169 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <fcntl.h>
+
+#include <string>
+
+#include "src/common/crc32.h"
+#include "test/integration/chunkserver/datastore/datastore_integration_base.h"
+
+namespace curve {
+namespace chunkserver {
+
+const string baseDir = "./data_int_row";    // NOLINT
+const string poolDir = "./chunkfilepool_int_row";  // NOLINT
+const string poolMetaPath = "./chunkfilepool_int_row.meta";  // NOLINT
+
+class RowSnapshotTestSuit : public DatastoreIntegrationBase {
+ public:
+    void SetUp() override {
+        DatastoreIntegrationBase::SetUp();
+        dataStore_ = CreateDataStore(true);
+        ASSERT_TRUE(dataStore_->Initialize());
+    }
+
+    std::shared_ptr<CSDataStore> CreateDataStore(bool enableRedirectOnWrite) {
+        DataStoreOptions options;
+        options.baseDir = baseDir;
+        options.chunkSize = CHUNK_SIZE;
+        options.metaPageSize = PAGE_SIZE;
+        options.blockSize = BLOCK_SIZE;
+        options.locationLimit = 3000;
+        options.enableRedirectOnWrite = enableRedirectOnWrite;
+        return std::make_shared<CSDataStore>(lfs_, filePool_, options);
+    }
+
+    void Write(ChunkID id, SequenceNum sn, char c, off_t offset,
+               size_t length) {
+        std::string data(length, c);
+        ASSERT_EQ(CSErrorCode::Success,
+                  dataStore_->WriteChunk(id, sn, data.c_str(), offset,
+                                         length, nullptr));
+    }
+
+    // 绕过datastore读取chunk文件中的数据
+    std::string ReadChunkFile(ChunkID id, off_t offset, size_t length) {
+        std::string path = baseDir + "/" +
+                           FileNameOperator::GenerateChunkFileName(id);
+        std::string data(length, '\0');
+        int fd = lfs_->Open(path, O_RDONLY);
+        EXPECT_GE(fd, 0);
+        EXPECT_EQ(length, lfs_->Read(fd, &data[0], PAGE_SIZE + offset,
+                                     length));
+        lfs_->Close(fd);
+        return data;
+    }
+
+    std::string ReadChunk(ChunkID id, SequenceNum sn) {
+        std::string data(3 * BLOCK_SIZE, '\0');
+        EXPECT_EQ(CSErrorCode::Success,
+                  dataStore_->ReadChunk(id, sn, &data[0], 0, data.size()));
+        return data;
+    }
+
+    std::string ReadSnapshotChunk(ChunkID id, SequenceNum sn) {
+        std::string data(3 * BLOCK_SIZE, '\0');
+        EXPECT_EQ(CSErrorCode::Success,
+                  dataStore_->ReadSnapshotChunk(id, sn, &data[0], 0,
+                                                data.size()));
+        return data;
+    }
+
+    static std::string Blocks(const std::string& chars) {
+        std::string data;
+        for (char c : chars) {
+            data.append(BLOCK_SIZE, c);
+        }
+        return data;
+    }
+};
+
+TEST_F(RowSnapshotTestSuit, RedirectOnWrite) {
+    ChunkID id = 1;
+    Write(id, 1, 'a', 0, 3 * BLOCK_SIZE);
+
+    // 打快照后的写入重定向到快照文件，快照数据留在chunk文件中
+    Write(id, 2, 'b', BLOCK_SIZE, BLOCK_SIZE);
+    CSChunkInfo info;
+    ASSERT_EQ(CSErrorCode::Success, dataStore_->GetChunkInfo(id, &info));
+    ASSERT_EQ(2, info.curSn);
+    ASSERT_EQ(1, info.snapSn);
+    ASSERT_EQ(Blocks("aba"), ReadChunk(id, 2));
+    ASSERT_EQ(Blocks("aaa"), ReadSnapshotChunk(id, 1));
+    ASSERT_EQ(Blocks("aba"), ReadSnapshotChunk(id, 2));
+    ASSERT_EQ(Blocks("aaa"), ReadChunkFile(id, 0, 3 * BLOCK_SIZE));
+
+    // 重复写已重定向的page
+    Write(id, 2, 'c', BLOCK_SIZE, 2 * BLOCK_SIZE);
+    ASSERT_EQ(Blocks("acc"), ReadChunk(id, 2));
+    ASSERT_EQ(Blocks("aaa"), ReadSnapshotChunk(id, 1));
+    uint32_t crc = 0;
+    ASSERT_EQ(CSErrorCode::Success,
+              dataStore_->ReadChunkCrc(id, 2, 0, 3 * BLOCK_SIZE, &crc));
+    std::string latest = Blocks("acc");
+    ASSERT_EQ(::curve::common::CRC32(latest.c_str(), latest.size()), crc);
+
+    // 重启后仍按redirect-on-write读写
+    dataStore_ = CreateDataStore(false);
+    ASSERT_TRUE(dataStore_->Initialize());
+    ASSERT_EQ(Blocks("acc"), ReadChunk(id, 2));
+    ASSERT_EQ(Blocks("aaa"), ReadSnapshotChunk(id, 1));
+    Write(id, 2, 'd', 0, BLOCK_SIZE);
+    ASSERT_EQ(Blocks("dcc"), ReadChunk(id, 2));
+    ASSERT_EQ(Blocks("aaa"), ReadSnapshotChunk(id, 1));
+
+    // 删除快照时合并回chunk文件
+    ASSERT_EQ(CSErrorCode::Success,
+              dataStore_->DeleteSnapshotChunkOrCorrectSn(id, 2));
+    ASSERT_EQ(CSErrorCode::Success, dataStore_->GetChunkInfo(id, &info));
+    ASSERT_EQ(0, info.snapSn);
+    ASSERT_EQ(Blocks("dcc"), ReadChunk(id, 2));
+    ASSERT_EQ(Blocks("dcc"), ReadChunkFile(id, 0, 3 * BLOCK_SIZE));
+    ASSERT_FALSE(lfs_->FileExists(
+        baseDir + "/" + FileNameOperator::GenerateSnapshotName(id, 1)));
+
+    // 重放删除快照的日志
+    ASSERT_EQ(CSErrorCode::Success,
+              dataStore_->DeleteSnapshotChunkOrCorrectSn(id, 2));
+    ASSERT_EQ(Blocks("dcc"), ReadChunk(id, 2));
+}
+
+TEST_F(RowSnapshotTestSuit, ExistingSnapshotKeepsWay) {
+    ChunkID id = 1;
+    dataStore_ = CreateDataStore(false);
+    ASSERT_TRUE(dataStore_->Initialize());
+    Write(id, 1, 'a', 0, 3 * BLOCK_SIZE);
+    Write(id, 2, 'b', 0, BLOCK_SIZE);
+
+    // 开启后已有的快照仍然是copy-on-write
+    dataStore_ = CreateDataStore(true);
+    ASSERT_TRUE(dataStore_->Initialize());
+    Write(id, 2, 'c', BLOCK_SIZE, BLOCK_SIZE);
+    ASSERT_EQ(Blocks("bca"), ReadChunkFile(id, 0, 3 * BLOCK_SIZE));
+    ASSERT_EQ(Blocks("aaa"), ReadSnapshotChunk(id, 1));
+    ASSERT_EQ(CSErrorCode::Success,
+              dataStore_->DeleteSnapshotChunkOrCorrectSn(id, 2));
+
+    // 之后新建的快照是redirect-on-write
+    Write(id, 3, 'd', 2 * BLOCK_SIZE, BLOCK_SIZE);
+    ASSERT_EQ(Blocks("bca"), ReadChunkFile(id, 0, 3 * BLOCK_SIZE));
+    ASSERT_EQ(Blocks("bca"), ReadSnapshotChunk(id, 2));
+    ASSERT_EQ(Blocks("bcd"), ReadChunk(id, 3));
+}
+
+}  // namespace chunkserver
+}  // namespace curve
@@ -215,6 +215,9 @@ class FakeTopologyStorage : public TopologyStorage {
     bool UpdateCopySet(const CopySetInfo &data) {
         return true;
     }
+    bool UpdateCopySets(const std::vector<CopySetInfo> &datas) {
+        return true;
+    }
 
     bool LoadClusterInfo(std::vector<ClusterInformation> *info) {
         return true;
@@ -181,6 +181,29 @@ int FakeSnapshotCloneMetaStore::GetCloneInfoList(
     return -1;
 }
 
+int FakeSnapshotCloneMetaStore::AddChunkDataRef(const std::string &hash,
+    const std::string &ref) {
+    std::lock_guard<std::mutex> guard(chunkDataRefs_mutex_);
+    chunkDataRefs_[hash].insert(ref);
+    return 0;
+}
+
+int FakeSnapshotCloneMetaStore::RemoveChunkDataRef(const std::string &hash,
+    const std::string &ref, uint32_t *refNum) {
+    std::lock_guard<std::mutex> guard(chunkDataRefs_mutex_);
+    auto it = chunkDataRefs_.find(hash);
+    if (it == chunkDataRefs_.end()) {
+        *refNum = 0;
+        return 0;
+    }
+    it->second.erase(ref);
+    *refNum = it->second.size();
+    if (it->second.empty()) {
+        chunkDataRefs_.erase(it);
+    }
+    return 0;
+}
+
 
 
 }  // namespace snapshotcloneserver
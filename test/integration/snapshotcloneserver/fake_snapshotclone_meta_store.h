@@ -26,6 +26,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <set>
 
 #include "src/snapshotcloneserver/common/snapshotclone_meta_store.h"
 
@@ -57,12 +58,22 @@ class FakeSnapshotCloneMetaStore : public SnapshotCloneMetaStore {
 
     int GetCloneInfoList(std::vector<CloneInfo> *list) override;
 
+    int AddChunkDataRef(const std::string &hash,
+                        const std::string &ref) override;
+
+    int RemoveChunkDataRef(const std::string &hash,
+                           const std::string &ref,
+                           uint32_t *refNum) override;
+
  private:
     std::map<UUID, SnapshotInfo> snapInfos_;
     std::mutex snapInfos_mutex;
 
     std::map<std::string, CloneInfo> cloneInfos_;
     curve::common::RWLock cloneInfos_lock_;
+
+    std::map<std::string, std::set<std::string>> chunkDataRefs_;
+    std::mutex chunkDataRefs_mutex_;
 };
 
 
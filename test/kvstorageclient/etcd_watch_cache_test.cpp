@@ -0,0 +1,138 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "src/kvstorageclient/etcd_watch_cache.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>  // NOLINT
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "test/mds/mock/mock_etcdclient.h"
+
+namespace curve {
+namespace kvstorage {
+
+using ::curve::mds::MockEtcdClient;
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::Invoke;
+using ::testing::Return;
+using ::testing::SetArgPointee;
+
+namespace {
+
+using KVs = std::vector<std::pair<std::string, std::string>>;
+
+// a watch without changes returns after the timeout
+int WatchTimeout(const std::string &, const std::string &, int64_t,
+                 int timeoutMs, std::vector<WatchEvent> *, int64_t *) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+    return EtcdErrCode::EtcdDeadlineExceeded;
+}
+
+}  // namespace
+
+class EtcdWatchCacheTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        client_ = std::make_shared<MockEtcdClient>();
+        EtcdWatchCacheOption option;
+        option.watchTimeoutMs = 10;
+        cache_ = std::make_shared<EtcdWatchCache>(client_, "a", "z", option);
+    }
+
+    void TearDown() override {
+        cache_->Stop();
+    }
+
+ protected:
+    std::shared_ptr<MockEtcdClient> client_;
+    std::shared_ptr<EtcdWatchCache> cache_;
+};
+
+TEST_F(EtcdWatchCacheTest, GetFromEtcdBeforeReady) {
+    EXPECT_CALL(*client_, Get("b", _))
+        .WillOnce(DoAll(SetArgPointee<1>("1"), Return(EtcdErrCode::EtcdOK)));
+    std::string value;
+    ASSERT_EQ(EtcdErrCode::EtcdOK, cache_->Get("b", &value));
+    ASSERT_EQ("1", value);
+    ASSERT_FALSE(cache_->Ready());
+}
+
+TEST_F(EtcdWatchCacheTest, LoadAndWatch) {
+    EXPECT_CALL(*client_, GetCurrentRevision(_))
+        .WillOnce(DoAll(SetArgPointee<0>(10), Return(EtcdErrCode::EtcdOK)))
+        .WillOnce(DoAll(SetArgPointee<0>(11), Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*client_, List("a", "z", testing::An<KVs *>()))
+        .WillOnce(DoAll(SetArgPointee<2>(KVs{{"b", "1"}, {"c", "1"}}),
+                        Return(EtcdErrCode::EtcdOK)));
+    std::vector<WatchEvent> events(2);
+    events[0].key = "c";
+    events[0].deleted = true;
+    events[1].key = "d";
+    events[1].value = "2";
+    EXPECT_CALL(*client_, Watch("a", "z", 11, _, _, _))
+        .WillOnce(DoAll(SetArgPointee<4>(events), SetArgPointee<5>(11),
+                        Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*client_, Watch("a", "z", 12, _, _, _))
+        .WillRepeatedly(Invoke(WatchTimeout));
+    EXPECT_CALL(*client_, Get(_, _)).Times(0);
+
+    cache_->Start();
+    ASSERT_TRUE(cache_->WaitRevision(11, 1000));
+    ASSERT_TRUE(cache_->Ready());
+    ASSERT_EQ(11, cache_->Revision());
+
+    std::string value;
+    ASSERT_EQ(EtcdErrCode::EtcdOK, cache_->Get("b", &value));
+    ASSERT_EQ("1", value);
+    ASSERT_EQ(EtcdErrCode::EtcdKeyNotExist, cache_->Get("c", &value));
+    ASSERT_EQ(EtcdErrCode::EtcdOK, cache_->Get("d", &value));
+    ASSERT_EQ("2", value);
+    ASSERT_FALSE(cache_->WaitRevision(12, 10));
+}
+
+TEST_F(EtcdWatchCacheTest, SyncAgainIfCompacted) {
+    EXPECT_CALL(*client_, GetCurrentRevision(_))
+        .WillOnce(DoAll(SetArgPointee<0>(10), Return(EtcdErrCode::EtcdOK)))
+        .WillOnce(DoAll(SetArgPointee<0>(10), Return(EtcdErrCode::EtcdOK)))
+        .WillOnce(DoAll(SetArgPointee<0>(20), Return(EtcdErrCode::EtcdOK)))
+        .WillOnce(DoAll(SetArgPointee<0>(20), Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*client_, List("a", "z", testing::An<KVs *>()))
+        .WillOnce(DoAll(SetArgPointee<2>(KVs{{"b", "1"}}),
+                        Return(EtcdErrCode::EtcdOK)))
+        .WillOnce(DoAll(SetArgPointee<2>(KVs{{"b", "2"}}),
+                        Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*client_, Watch("a", "z", 11, _, _, _))
+        .WillOnce(Return(EtcdErrCode::EtcdOutOfRange));
+    EXPECT_CALL(*client_, Watch("a", "z", 21, _, _, _))
+        .WillRepeatedly(Invoke(WatchTimeout));
+
+    cache_->Start();
+    ASSERT_TRUE(cache_->WaitRevision(20, 1000));
+    std::string value;
+    ASSERT_EQ(EtcdErrCode::EtcdOK, cache_->Get("b", &value));
+    ASSERT_EQ("2", value);
+}
+
+}  // namespace kvstorage
+}  // namespace curve
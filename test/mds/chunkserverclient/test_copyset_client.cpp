@@ -403,6 +403,70 @@ TEST_F(TestCopysetClient, TestDeleteChunkRedirectFail) {
         logicalPoolId, copysetId, chunkId, sn);
     ASSERT_EQ(kMdsFail, ret);
 }
+
+TEST_F(TestCopysetClient, TestDeleteChunksReuseLeader) {
+    ChunkServerIdType leader = 0x01;
+    LogicalPoolID logicalPoolId = 0x11;
+    CopysetID copysetId = 0x21;
+    std::vector<ChunkID> chunkIds = {0x31, 0x32, 0x33};
+    uint64_t sn = 100;
+
+    CopySetInfo copyset(logicalPoolId, copysetId);
+    copyset.SetLeader(leader);
+    copyset.SetCopySetMembers({0x01, 0x02, 0x03});
+    EXPECT_CALL(*topo_, GetCopySet(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(copyset),
+            Return(true)));
+
+    // the new leader is used by the following chunks
+    ChunkServerIdType newLeader = 0x02;
+    EXPECT_CALL(*mockCsClient_, DeleteChunk(
+            leader, logicalPoolId, copysetId, 0x31, sn))
+        .WillOnce(Return(kCsClientNotLeader));
+    EXPECT_CALL(*mockCsClient_, GetLeader(
+        _, logicalPoolId, copysetId, _))
+        .WillOnce(DoAll(SetArgPointee<3>(newLeader),
+                Return(kMdsSuccess)));
+    EXPECT_CALL(*mockCsClient_, DeleteChunk(
+            newLeader, logicalPoolId, copysetId, _, sn))
+        .Times(3)
+        .WillRepeatedly(Return(kMdsSuccess));
+
+    int ret = client_->DeleteChunks(
+        logicalPoolId, copysetId, chunkIds, sn);
+    ASSERT_EQ(kMdsSuccess, ret);
+}
+
+TEST_F(TestCopysetClient, TestDeleteChunksFail) {
+    ChunkServerIdType leader = 0x01;
+    LogicalPoolID logicalPoolId = 0x11;
+    CopysetID copysetId = 0x21;
+    std::vector<ChunkID> chunkIds = {0x31, 0x32, 0x33};
+    uint64_t sn = 100;
+
+    CopySetInfo copyset(logicalPoolId, copysetId);
+    copyset.SetLeader(leader);
+    copyset.SetCopySetMembers({0x01, 0x02, 0x03});
+    EXPECT_CALL(*topo_, GetCopySet(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(copyset),
+            Return(true)));
+
+    // stop at the first chunk failed
+    EXPECT_CALL(*mockCsClient_, DeleteChunk(
+            leader, logicalPoolId, copysetId, 0x31, sn))
+        .WillOnce(Return(kMdsSuccess));
+    EXPECT_CALL(*mockCsClient_, DeleteChunk(
+            leader, logicalPoolId, copysetId, 0x32, sn))
+        .WillOnce(Return(kMdsFail));
+    EXPECT_CALL(*mockCsClient_, DeleteChunk(
+            leader, logicalPoolId, copysetId, 0x33, sn))
+        .Times(0);
+
+    int ret = client_->DeleteChunks(
+        logicalPoolId, copysetId, chunkIds, sn);
+    ASSERT_EQ(kMdsFail, ret);
+}
+
 }  // namespace chunkserverclient
 }  // namespace mds
 }  // namespace curve
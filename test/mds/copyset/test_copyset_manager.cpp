@@ -194,6 +194,35 @@ TEST(TestCopysetManager, GenCopysetByCopysetNumAndValidSuccess) {
     }
 }
 
+TEST(TestCopysetManager, GenCopysetByScatterWidthOnMassiveCluster) {
+    CopysetOption option;
+    CopysetManager manager(option);
+
+    CopysetConstrait constrait;
+    constrait.zoneNum = 3;
+    constrait.zoneChoseNum = 3;
+    constrait.replicaNum = 3;
+
+    ASSERT_TRUE(manager.Init(constrait));
+
+    // 1200 chunkservers, 3 zones, scatter width 100
+    TestCluster cluster;
+    cluster.SetMassiveCluster(1200, 3);
+
+    std::vector<Copyset> out;
+    uint32_t scatterWidth = 100;
+    ASSERT_TRUE(manager.GenCopyset(cluster,
+        0, &scatterWidth, &out));
+    ASSERT_GE(scatterWidth, 100);
+
+    // stopped at the first copyset reaching the target
+    CopysetValidation validator(option);
+    uint32_t actual = 0;
+    ASSERT_TRUE(validator.ValidateScatterWidth(100, &actual, out));
+    out.pop_back();
+    ASSERT_FALSE(validator.ValidateScatterWidth(100, &actual, out));
+}
+
 }  // namespace copyset
 }  // namespace mds
 }  // namespace curve
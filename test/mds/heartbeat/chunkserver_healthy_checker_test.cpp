@@ -22,6 +22,8 @@
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <chrono>  //NOLINT
+#include <thread>  //NOLINT
 #include "src/mds/heartbeat/chunkserver_healthy_checker.h"
 #include "src/mds/topology/topology_item.h"
 #include "test/mds/mock/mock_topology.h"
@@ -182,6 +184,51 @@ TEST(ChunkserverHealthyChecker, test_checkHeartBeat_interval) {
         ASSERT_EQ(OnlineState::ONLINE, info.state);
     }
 }
+
+TEST(ChunkserverHealthyChecker, test_check_only_due_chunkservers) {
+    HeartbeatOption option;
+    option.heartbeatIntervalMs = 10;
+    option.heartbeatMissTimeOutMs = 100;
+    option.offLineTimeOutMs = 1000;
+    std::shared_ptr<MockTopology> topology = std::make_shared<MockTopology>();
+    std::shared_ptr<ChunkserverHealthyChecker> checker =
+        std::make_shared<ChunkserverHealthyChecker>(option, topology);
+
+    // chunkserver-1和chunkserver-2更新为online
+    checker->UpdateLastReceivedHeartbeatTime(1, steady_clock::now());
+    checker->UpdateLastReceivedHeartbeatTime(2, steady_clock::now());
+    EXPECT_CALL(*topology, UpdateChunkServerOnlineState(
+        OnlineState::ONLINE, _))
+        .Times(2).WillRepeatedly(Return(kTopoErrCodeSuccess));
+    checker->CheckHeartBeatInterval();
+
+    // 心跳未超时的online chunkserver不需要检查
+    checker->UpdateLastReceivedHeartbeatTime(1, steady_clock::now());
+    checker->CheckHeartBeatInterval();
+
+    // chunkserver-2心跳超时更新为unstable, chunkserver-1保持online
+    ChunkServer cs(2, "", "", 1, "", 0, "",
+        ChunkServerStatus::READWRITE, OnlineState::UNSTABLE);
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    checker->UpdateLastReceivedHeartbeatTime(1, steady_clock::now());
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    EXPECT_CALL(*topology, UpdateChunkServerOnlineState(
+        OnlineState::UNSTABLE, 2))
+        .WillOnce(Return(kTopoErrCodeSuccess));
+    EXPECT_CALL(*topology, GetChunkServer(2, _))
+        .WillOnce(DoAll(SetArgPointee<1>(cs), Return(true)));
+    checker->CheckHeartBeatInterval();
+    HeartbeatInfo info;
+    ASSERT_TRUE(checker->GetHeartBeatInfo(1, &info));
+    ASSERT_EQ(OnlineState::ONLINE, info.state);
+    ASSERT_TRUE(checker->GetHeartBeatInfo(2, &info));
+    ASSERT_EQ(OnlineState::UNSTABLE, info.state);
+
+    // unstable的chunkserver每次都检查
+    EXPECT_CALL(*topology, GetChunkServer(2, _))
+        .WillOnce(DoAll(SetArgPointee<1>(cs), Return(true)));
+    checker->CheckHeartBeatInterval();
+}
 }  // namespace heartbeat
 }  // namespace mds
 }  // namespace curve
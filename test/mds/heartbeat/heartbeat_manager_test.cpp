@@ -934,8 +934,95 @@ TEST_F(TestHeartbeatManager, test_patrol_copySetInfo_return_order) {
     ASSERT_EQ(TRANSFER_LEADER, response.needupdatecopysets(0).type());
     ASSERT_EQ(3, response.needupdatecopysets(0).peers_size());
 }
+TEST_F(TestHeartbeatManager, test_delta_heartbeat) {
+    auto request = GetChunkServerHeartbeatRequestForTest();
+    ChunkServerHeartbeatResponse response;
+    ::curve::mds::topology::ChunkServer chunkServer1(
+        1, "hello", "", 1, "192.168.10.1", 9000, "",
+        ::curve::mds::topology::ChunkServerStatus::READWRITE);
+    ::curve::mds::topology::ChunkServer chunkServer2(
+        2, "hello", "", 1, "192.168.10.2", 9000, "",
+        ::curve::mds::topology::ChunkServerStatus::READWRITE);
+    ::curve::mds::topology::ChunkServer chunkServer3(
+        3, "hello", "", 1, "192.168.10.3", 9000, "",
+        ::curve::mds::topology::ChunkServerStatus::READWRITE);
+    ::curve::mds::topology::CopySetInfo copySetInfo;
+    copySetInfo.SetEpoch(10);
+    copySetInfo.SetLeader(1);
+    copySetInfo.SetCopySetMembers(std::set<ChunkServerIdType>{1, 2, 3});
+    EXPECT_CALL(*topology_, GetChunkServer(1, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(chunkServer1), Return(true)));
+
+    // 1. full heartbeat, the copysets are kept
+    request.set_seq(1);
+    EXPECT_CALL(*topology_, GetChunkServerNotRetired(_, _, _))
+        .WillOnce(DoAll(SetArgPointee<2>(chunkServer1), Return(true)))
+        .WillOnce(DoAll(SetArgPointee<2>(chunkServer2), Return(true)))
+        .WillOnce(DoAll(SetArgPointee<2>(chunkServer3), Return(true)));
+    EXPECT_CALL(*topology_, GetCopySet(_, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(SetArgPointee<1>(copySetInfo), Return(true)));
+    EXPECT_CALL(*coordinator_, CopySetHeartbeat(_, _, _))
+        .WillOnce(Return(false));
+    heartbeatManager_->ChunkServerHeartbeat(request, &response);
+    ASSERT_EQ(HeartbeatStatusCode::hbOK, response.statuscode());
+    ASSERT_EQ(1, response.baseseq());
+
+    // 2. delta heartbeat without changes, the kept copyset is still passed
+    //    to the coordinator, but not converted or updated to topology
+    request.clear_copysetinfos();
+    request.set_seq(2);
+    request.set_baseseq(1);
+    response.Clear();
+    EXPECT_CALL(*topology_, GetChunkServerNotRetired(_, _, _)).Times(0);
+    EXPECT_CALL(*topology_, GetCopySet(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(copySetInfo), Return(true)));
+    EXPECT_CALL(*coordinator_, CopySetHeartbeat(_, _, _))
+        .WillOnce(Return(false));
+    heartbeatManager_->ChunkServerHeartbeat(request, &response);
+    ASSERT_EQ(HeartbeatStatusCode::hbOK, response.statuscode());
+    ASSERT_EQ(2, response.baseseq());
+
+    // 3. delta heartbeat based on an unknown seq, ask for a full one
+    request.set_seq(3);
+    request.set_baseseq(1);
+    response.Clear();
+    EXPECT_CALL(*topology_, GetCopySet(_, _)).Times(0);
+    EXPECT_CALL(*coordinator_, CopySetHeartbeat(_, _, _)).Times(0);
+    heartbeatManager_->ChunkServerHeartbeat(request, &response);
+    ASSERT_EQ(HeartbeatStatusCode::hbOK, response.statuscode());
+    ASSERT_FALSE(response.has_baseseq());
+
+    // 4. the copyset is removed by a delta heartbeat
+    request = GetChunkServerHeartbeatRequestForTest();
+    request.set_seq(4);
+    response.Clear();
+    EXPECT_CALL(*topology_, GetChunkServerNotRetired(_, _, _))
+        .WillOnce(DoAll(SetArgPointee<2>(chunkServer1), Return(true)))
+        .WillOnce(DoAll(SetArgPointee<2>(chunkServer2), Return(true)))
+        .WillOnce(DoAll(SetArgPointee<2>(chunkServer3), Return(true)));
+    EXPECT_CALL(*topology_, GetCopySet(_, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(SetArgPointee<1>(copySetInfo), Return(true)));
+    EXPECT_CALL(*coordinator_, CopySetHeartbeat(_, _, _))
+        .WillOnce(Return(false));
+    heartbeatManager_->ChunkServerHeartbeat(request, &response);
+    ASSERT_EQ(4, response.baseseq());
+
+    request.clear_copysetinfos();
+    request.set_seq(5);
+    request.set_baseseq(4);
+    auto key = request.add_removedcopysets();
+    key->set_logicalpoolid(1);
+    key->set_copysetid(1);
+    response.Clear();
+    EXPECT_CALL(*topology_, GetCopySet(_, _)).Times(0);
+    EXPECT_CALL(*coordinator_, CopySetHeartbeat(_, _, _)).Times(0);
+    heartbeatManager_->ChunkServerHeartbeat(request, &response);
+    ASSERT_EQ(HeartbeatStatusCode::hbRequestNoCopyset, response.statuscode());
+    ASSERT_EQ(5, response.baseseq());
+}
+
 }  // namespace heartbeat
 }  // namespace mds
 }  // namespace curve
-
-
@@ -32,11 +32,17 @@ using ::testing::Return;
 using ::testing::SetArgPointee;
 using ::testing::DoAll;
 using ::testing::Matcher;
+using ::testing::Invoke;
 
 using ::curve::common::SEGMENTALLOCSIZEKEYEND;
 using ::curve::common::SEGMENTALLOCSIZEKEY;
 using ::curve::common::SEGMENTINFOKEYEND;
 using ::curve::common::SEGMENTINFOKEYPREFIX;
+using ::curve::common::SEGMENTALLOCLOGKEYPREFIX;
+using ::curve::common::SEGMENTALLOCLOGKEYEND;
+using ::curve::common::SEGMENTALLOCEXACTKEY;
+using ::curve::common::DISCARDSEGMENTKEYPREFIX;
+using ::curve::common::DISCARDSEGMENTKEYEND;
 
 namespace curve {
 namespace mds {
@@ -91,6 +97,8 @@ TEST_F(AllocStatisticTest, test_Init) {
                          Matcher<std::vector<std::string>*>(_)))
             .WillOnce(
                 DoAll(SetArgPointee<2>(values), Return(EtcdErrCode::EtcdOK)));
+        EXPECT_CALL(*mockEtcdClient_, Delete(SEGMENTALLOCEXACTKEY))
+            .WillOnce(Return(EtcdErrCode::EtcdKeyNotExist));
         ASSERT_EQ(0, allocStatistic_->Init());
         int64_t alloc;
         ASSERT_TRUE(allocStatistic_->GetAllocByLogicalPool(1, &alloc));
@@ -109,6 +117,8 @@ TEST_F(AllocStatisticTest, test_PeriodicPersist_CalculateSegmentAlloc) {
                 List(SEGMENTALLOCSIZEKEY, SEGMENTALLOCSIZEKEYEND,
                      Matcher<std::vector<std::string>*>(_)))
         .WillOnce(DoAll(SetArgPointee<2>(values), Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*mockEtcdClient_, Delete(SEGMENTALLOCEXACTKEY))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
     ASSERT_EQ(0, allocStatistic_->Init());
 
     PageFileSegment segment;
@@ -228,5 +238,165 @@ TEST_F(AllocStatisticTest, test_PeriodicPersist_CalculateSegmentAlloc) {
     allocStatistic_->Stop();
 }
 
+static std::string OpKey(const Operation &op) {
+    return std::string(op.key, op.keyLen);
+}
+
+static std::string OpValue(const Operation &op) {
+    return std::string(op.value, op.valueLen);
+}
+
+TEST_F(AllocStatisticTest, test_ChangeLog_InitAndFold) {
+    allocStatistic_ = std::make_shared<AllocStatistic>(
+        periodicPersistInterMs_, retryInterMs_, mockEtcdClient_, true, 0);
+
+    // 持久化的值加上变更日志即为准确值，不需要扫描segment
+    std::vector<std::string> values{
+        NameSpaceStorageCodec::EncodeSegmentAllocValue(1, 1024)};
+    EXPECT_CALL(*mockEtcdClient_, GetCurrentRevision(_))
+        .WillOnce(DoAll(SetArgPointee<0>(2), Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*mockEtcdClient_,
+                List(SEGMENTALLOCSIZEKEY, SEGMENTALLOCSIZEKEYEND,
+                     Matcher<std::vector<std::string>*>(_)))
+        .WillOnce(DoAll(SetArgPointee<2>(values), Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*mockEtcdClient_, Get(SEGMENTALLOCEXACTKEY, _))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
+    EXPECT_CALL(*mockEtcdClient_, ListWithLimitAndRevision(
+        SEGMENTALLOCSIZEKEY, SEGMENTALLOCSIZEKEYEND, GETBUNDLE, 2, _, _))
+        .WillOnce(DoAll(SetArgPointee<4>(values),
+                        Return(EtcdErrCode::EtcdOK)));
+    std::vector<std::string> logs{
+        NameSpaceStorageCodec::EncodeSegmentAllocLogValue(1, 512),
+        NameSpaceStorageCodec::EncodeSegmentAllocLogValue(1, -128)};
+    EXPECT_CALL(*mockEtcdClient_, ListWithLimitAndRevision(
+        SEGMENTALLOCLOGKEYPREFIX, SEGMENTALLOCLOGKEYEND, GETBUNDLE, 2, _, _))
+        .WillOnce(DoAll(SetArgPointee<4>(logs),
+                        Return(EtcdErrCode::EtcdOK)));
+    ASSERT_EQ(0, allocStatistic_->Init());
+
+    int64_t alloc;
+    ASSERT_TRUE(allocStatistic_->GetAllocByLogicalPool(1, &alloc));
+    ASSERT_EQ(1024 + 512 - 128, alloc);
+    allocStatistic_->AllocSpace(1, 64, 3);
+    ASSERT_TRUE(allocStatistic_->GetAllocByLogicalPool(1, &alloc));
+    ASSERT_EQ(1024 + 512 - 128 + 64, alloc);
+
+    // 变更日志和持久化的值在同一个事务中更新
+    std::string logKey = NameSpaceStorageCodec::EncodeSegmentAllocLogKey(1, 1);
+    std::vector<std::pair<std::string, std::string>> logKvs{
+        {logKey, NameSpaceStorageCodec::EncodeSegmentAllocLogValue(1, 64)}};
+    EXPECT_CALL(*mockEtcdClient_,
+                List(SEGMENTALLOCLOGKEYPREFIX, SEGMENTALLOCLOGKEYEND,
+                     Matcher<std::vector<std::pair<std::string, std::string>>*>(
+                         _)))
+        .WillOnce(DoAll(SetArgPointee<2>(logKvs),
+                        Return(EtcdErrCode::EtcdOK)))
+        .WillRepeatedly(Return(EtcdErrCode::EtcdOK));
+    std::vector<Operation> folded;
+    std::vector<std::string> foldedKeys;
+    std::vector<std::string> foldedValues;
+    EXPECT_CALL(*mockEtcdClient_, TxnNWithRevision(_, _))
+        .WillOnce(Invoke([&](const std::vector<Operation> &ops, int64_t *) {
+            folded = ops;
+            for (const auto &op : ops) {
+                foldedKeys.emplace_back(OpKey(op));
+                foldedValues.emplace_back(OpValue(op));
+            }
+            return EtcdErrCode::EtcdOK;
+        }));
+
+    allocStatistic_->Run();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    allocStatistic_->Stop();
+
+    ASSERT_EQ(2, folded.size());
+    ASSERT_EQ(OpType::OpPut, folded[0].opType);
+    ASSERT_EQ(NameSpaceStorageCodec::EncodeSegmentAllocKey(1), foldedKeys[0]);
+    ASSERT_EQ(NameSpaceStorageCodec::EncodeSegmentAllocValue(1, 1024 + 64),
+              foldedValues[0]);
+    ASSERT_EQ(OpType::OpDelete, folded[1].opType);
+    ASSERT_EQ(logKey, foldedKeys[1]);
+}
+
+TEST_F(AllocStatisticTest, test_ChangeLog_InitByScan) {
+    allocStatistic_ = std::make_shared<AllocStatistic>(
+        periodicPersistInterMs_, retryInterMs_, mockEtcdClient_, true, 0);
+
+    // 持久化的值不准确，需要扫描一次segment
+    std::vector<std::string> values{
+        NameSpaceStorageCodec::EncodeSegmentAllocValue(1, 1024)};
+    EXPECT_CALL(*mockEtcdClient_, GetCurrentRevision(_))
+        .WillOnce(DoAll(SetArgPointee<0>(2), Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*mockEtcdClient_,
+                List(SEGMENTALLOCSIZEKEY, SEGMENTALLOCSIZEKEYEND,
+                     Matcher<std::vector<std::string>*>(_)))
+        .WillOnce(DoAll(SetArgPointee<2>(values), Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*mockEtcdClient_, Get(SEGMENTALLOCEXACTKEY, _))
+        .WillOnce(Return(EtcdErrCode::EtcdKeyNotExist));
+    ASSERT_EQ(0, allocStatistic_->Init());
+    int64_t alloc;
+    ASSERT_TRUE(allocStatistic_->GetAllocByLogicalPool(1, &alloc));
+    ASSERT_EQ(1024, alloc);
+
+    PageFileSegment segment;
+    segment.set_segmentsize(1 << 30);
+    segment.set_logicalpoolid(1);
+    segment.set_chunksize(16 * 1024 * 1024);
+    segment.set_startoffset(0);
+    std::string encodeSegment;
+    ASSERT_TRUE(NameSpaceStorageCodec::EncodeSegment(segment, &encodeSegment));
+    DiscardSegmentInfo discardInfo;
+    discardInfo.mutable_pagefilesegment()->CopyFrom(segment);
+    discardInfo.mutable_fileinfo()->set_id(1);
+    std::string encodeDiscard;
+    ASSERT_TRUE(NameSpaceStorageCodec::EncodeDiscardSegment(discardInfo,
+                                                            &encodeDiscard));
+    EXPECT_CALL(*mockEtcdClient_, ListWithLimitAndRevision(
+        SEGMENTINFOKEYPREFIX, SEGMENTINFOKEYEND, GETBUNDLE, 2, _, _))
+        .WillOnce(DoAll(SetArgPointee<4>(std::vector<std::string>{
+                            encodeSegment, encodeSegment}),
+                        Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*mockEtcdClient_, ListWithLimitAndRevision(
+        DISCARDSEGMENTKEYPREFIX, DISCARDSEGMENTKEYEND, GETBUNDLE, 2, _, _))
+        .WillOnce(DoAll(SetArgPointee<4>(
+                            std::vector<std::string>{encodeDiscard}),
+                        Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*mockEtcdClient_, ListWithLimitAndRevision(
+        SEGMENTALLOCSIZEKEY, SEGMENTALLOCSIZEKEYEND, GETBUNDLE, 2, _, _))
+        .WillOnce(DoAll(SetArgPointee<4>(values),
+                        Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*mockEtcdClient_, ListWithLimitAndRevision(
+        SEGMENTALLOCLOGKEYPREFIX, SEGMENTALLOCLOGKEYEND, GETBUNDLE, 2, _, _))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
+
+    // 差值写入变更日志，同时标记持久化的值已经准确
+    std::vector<std::string> keys;
+    std::vector<std::string> vals;
+    EXPECT_CALL(*mockEtcdClient_, TxnNWithRevision(_, _))
+        .WillOnce(Invoke([&](const std::vector<Operation> &ops, int64_t *) {
+            for (const auto &op : ops) {
+                keys.emplace_back(OpKey(op));
+                vals.emplace_back(OpValue(op));
+            }
+            return EtcdErrCode::EtcdOK;
+        }));
+    EXPECT_CALL(*mockEtcdClient_,
+                List(SEGMENTALLOCLOGKEYPREFIX, SEGMENTALLOCLOGKEYEND,
+                     Matcher<std::vector<std::pair<std::string, std::string>>*>(
+                         _)))
+        .WillRepeatedly(Return(EtcdErrCode::EtcdOK));
+
+    allocStatistic_->Run();
+    std::this_thread::sleep_for(std::chrono::seconds(6));
+    allocStatistic_->Stop();
+
+    ASSERT_TRUE(allocStatistic_->GetAllocByLogicalPool(1, &alloc));
+    ASSERT_EQ(3L << 30, alloc);
+    ASSERT_EQ(2, keys.size());
+    ASSERT_EQ(NameSpaceStorageCodec::EncodeSegmentAllocLogValue(
+                  1, (3L << 30) - 1024), vals[0]);
+    ASSERT_EQ(SEGMENTALLOCEXACTKEY, keys[1]);
+}
+
 }  // namespace mds
 }  // namespace curve
@@ -23,6 +23,15 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <glog/logging.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <map>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
 #include "src/mds/nameserver2/clean_core.h"
 #include "test/mds/nameserver2/mock/mock_namespace_storage.h"
 #include "test/mds/mock/mock_topology.h"
@@ -34,7 +43,9 @@ using ::testing::_;
 using ::testing::Return;
 using ::testing::SetArgPointee;
 using ::testing::DoAll;
+using ::testing::Invoke;
 using curve::mds::topology::MockTopology;
+using curve::mds::topology::CopySetKey;
 using ::curve::mds::chunkserverclient::ChunkServerClientOption;
 using ::curve::mds::chunkserverclient::MockChunkServerClient;
 
@@ -86,11 +97,8 @@ TEST_F(CleanCoreTest, testcleansnapshotfile) {
 
     {
         // delete ok (no, segment)
-        uint32_t segmentNum = kMiniFileLength / DefaultSegmentSize;
-        for (uint32_t i = 0; i < segmentNum; i++) {
-            EXPECT_CALL(*storage_, GetSegment(_, i * DefaultSegmentSize, _))
-            .WillOnce(Return(StoreStatus::KeyNotExist));
-        }
+        EXPECT_CALL(*storage_, ListSegment(_, _))
+        .WillOnce(Return(StoreStatus::OK));
 
         EXPECT_CALL(*storage_, DeleteSnapshotFile(_, _))
         .Times(1)
@@ -108,11 +116,8 @@ TEST_F(CleanCoreTest, testcleansnapshotfile) {
     }
     {
         // all ok , but do DeleteFile namespace meta error
-        uint32_t segmentNum = kMiniFileLength / DefaultSegmentSize;
-        for (uint32_t i = 0; i < segmentNum; i++) {
-            EXPECT_CALL(*storage_, GetSegment(_, i * DefaultSegmentSize, _))
-            .WillOnce(Return(StoreStatus::KeyNotExist));
-        }
+        EXPECT_CALL(*storage_, ListSegment(_, _))
+        .WillOnce(Return(StoreStatus::OK));
 
         EXPECT_CALL(*storage_, DeleteSnapshotFile(_, _))
         .WillOnce(Return(StoreStatus::InternalError));
@@ -126,8 +131,8 @@ TEST_F(CleanCoreTest, testcleansnapshotfile) {
     }
 
     {
-        // get segment error
-        EXPECT_CALL(*storage_, GetSegment(_, 0, _))
+        // list segment error
+        EXPECT_CALL(*storage_, ListSegment(_, _))
         .Times(1)
         .WillOnce(Return(StoreStatus::InternalError));
 
@@ -141,13 +146,9 @@ TEST_F(CleanCoreTest, testcleansnapshotfile) {
     {
         // 联调Bug修复：快照文件共享源文件的segment，所以在查询segment的时候需要使用
         // ParentID 进行查找
-        uint32_t segmentNum = kMiniFileLength / DefaultSegmentSize;
         uint64_t expectParentID = 101;
-        for (uint32_t i = 0; i < segmentNum; i++) {
-            EXPECT_CALL(*storage_,
-                        GetSegment(expectParentID, i * DefaultSegmentSize, _))
-            .WillOnce(Return(StoreStatus::KeyNotExist));
-        }
+        EXPECT_CALL(*storage_, ListSegment(expectParentID, _))
+        .WillOnce(Return(StoreStatus::OK));
 
         EXPECT_CALL(*storage_, DeleteSnapshotFile(_, _))
         .Times(1)
@@ -165,16 +166,49 @@ TEST_F(CleanCoreTest, testcleansnapshotfile) {
         ASSERT_EQ(progress.GetProgress(), 100);
     }
     {
-        // get segment ok, DeleteSnapShotChunk Error
+        // list segment ok, DeleteSnapShotChunk Error
+        client_->SetChunkServerClient(csClient_);
+        std::vector<PageFileSegment> segments(1);
+        segments[0].set_logicalpoolid(1);
+        segments[0].set_startoffset(0);
+        segments[0].add_chunks()->set_copysetid(1);
+        EXPECT_CALL(*storage_, ListSegment(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(segments),
+                        Return(StoreStatus::OK)));
+        EXPECT_CALL(*topology_, GetCopySet(_, _))
+        .WillOnce(Return(false));
+        EXPECT_CALL(*storage_, DeleteSnapshotFile(_, _))
+        .Times(0);
+
+        FileInfo cleanFile;
+        cleanFile.set_length(kMiniFileLength);
+        cleanFile.set_segmentsize(DefaultSegmentSize);
+        TaskProgress progress;
+        ASSERT_EQ(cleanCore_->CleanSnapShotFile(cleanFile, &progress),
+            StatusCode::kSnapshotFileDeleteError);
+        ASSERT_EQ(progress.GetStatus(), TaskStatus::FAILED);
     }
 
     {
-        // get segment ok, DeleteSnapShotChunk OK
-        uint32_t segmentNum = kMiniFileLength / DefaultSegmentSize;
-        for (uint32_t i = 0; i < segmentNum; i++) {
-            EXPECT_CALL(*storage_, GetSegment(_, i * DefaultSegmentSize, _))
-            .WillOnce(Return(StoreStatus::OK));
-        }
+        // list segment ok, DeleteSnapShotChunk OK, the segments beyond the
+        // length of snapshot are skipped
+        client_->SetChunkServerClient(csClient_);
+        std::vector<PageFileSegment> segments(2);
+        segments[0].set_logicalpoolid(1);
+        segments[0].set_startoffset(0);
+        segments[0].add_chunks()->set_copysetid(1);
+        segments[1].set_logicalpoolid(1);
+        segments[1].set_startoffset(kMiniFileLength);
+        segments[1].add_chunks()->set_copysetid(2);
+        EXPECT_CALL(*storage_, ListSegment(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(segments),
+                        Return(StoreStatus::OK)));
+        CopySetInfo copyset;
+        copyset.SetLeader(1);
+        EXPECT_CALL(*topology_, GetCopySet(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(copyset), Return(true)));
+        EXPECT_CALL(*csClient_, DeleteChunkSnapshotOrCorrectSn(_, 1, 1, _, _))
+        .WillOnce(Return(kMdsSuccess));
 
         EXPECT_CALL(*storage_, DeleteSnapshotFile(_, _))
         .Times(1)
@@ -205,11 +239,8 @@ TEST_F(CleanCoreTest, testcleanfile) {
 
     {
         // delete ok (no, segment)
-        uint32_t segmentNum = kMiniFileLength / DefaultSegmentSize;
-        for (uint32_t i = 0; i < segmentNum; i++) {
-            EXPECT_CALL(*storage_, GetSegment(_, i * DefaultSegmentSize, _))
-            .WillOnce(Return(StoreStatus::KeyNotExist));
-        }
+        EXPECT_CALL(*storage_, ListSegment(_, _))
+        .WillOnce(Return(StoreStatus::OK));
 
         EXPECT_CALL(*storage_, DeleteFile(_, _))
         .Times(1)
@@ -228,11 +259,8 @@ TEST_F(CleanCoreTest, testcleanfile) {
 
     {
         // all ok , but do DeleteFile namespace meta error
-        uint32_t segmentNum = kMiniFileLength / DefaultSegmentSize;
-        for (uint32_t i = 0; i < segmentNum; i++) {
-            EXPECT_CALL(*storage_, GetSegment(_, i * DefaultSegmentSize, _))
-            .WillOnce(Return(StoreStatus::KeyNotExist));
-        }
+        EXPECT_CALL(*storage_, ListSegment(_, _))
+        .WillOnce(Return(StoreStatus::OK));
 
         EXPECT_CALL(*storage_, DeleteFile(_, _))
         .WillOnce(Return(StoreStatus::InternalError));
@@ -247,8 +275,8 @@ TEST_F(CleanCoreTest, testcleanfile) {
     }
 
     {
-        // get segment error
-        EXPECT_CALL(*storage_, GetSegment(_, 0, _))
+        // list segment error
+        EXPECT_CALL(*storage_, ListSegment(_, _))
         .Times(1)
         .WillOnce(Return(StoreStatus::InternalError));
 
@@ -261,12 +289,11 @@ TEST_F(CleanCoreTest, testcleanfile) {
         ASSERT_EQ(progress.GetStatus(), TaskStatus::FAILED);
     }
     {
-        // get segment ok, DeleteSnapShotChunk Error
-    }
-    {
-        // get segment ok, DeleteSnapShotChunk ok, DeleteSegment error
-        EXPECT_CALL(*storage_, GetSegment(_, 0, _))
-                .WillOnce(Return(StoreStatus::OK));
+        // list segment ok, DeleteChunk ok, DeleteSegment error
+        std::vector<PageFileSegment> segments(1);
+        EXPECT_CALL(*storage_, ListSegment(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(segments),
+                        Return(StoreStatus::OK)));
 
         EXPECT_CALL(*storage_, DeleteSegment(_, _, _))
         .WillOnce(Return(StoreStatus::InternalError));
@@ -281,6 +308,109 @@ TEST_F(CleanCoreTest, testcleanfile) {
     }
 }
 
+TEST_F(CleanCoreTest, TestCleanFileConcurrently) {
+    CleanCoreOption option;
+    option.deleteConcurrency = 8;
+    option.chunkserverConcurrency = 2;
+    option.segmentBatchSize = 2;
+    cleanCore_ = std::make_shared<CleanCore>(storage_, client_,
+                                             allocStatistic_, option);
+    client_->SetChunkServerClient(csClient_);
+
+    // 4 segments, the chunks of segment i are in copyset i and i + 1,
+    // the leader of copyset c is chunkserver c % 2 + 1
+    const int segmentNum = 4;
+    std::vector<PageFileSegment> segments(segmentNum);
+    for (int i = 0; i < segmentNum; i++) {
+        segments[i].set_logicalpoolid(1);
+        segments[i].set_segmentsize(DefaultSegmentSize);
+        segments[i].set_startoffset(i * DefaultSegmentSize);
+        for (int j = 0; j < 4; j++) {
+            auto* chunk = segments[i].add_chunks();
+            chunk->set_copysetid(i + j % 2);
+            chunk->set_chunkid(i * 4 + j);
+        }
+    }
+    EXPECT_CALL(*topology_, GetCopySet(_, _))
+        .WillRepeatedly(Invoke([](CopySetKey key, CopySetInfo* info) {
+            info->SetLeader(key.second % 2 + 1);
+            return true;
+        }));
+
+    FileInfo cleanFile;
+    cleanFile.set_id(1);
+    cleanFile.set_length(kMiniFileLength);
+    cleanFile.set_segmentsize(DefaultSegmentSize);
+
+    // the concurrency on each chunkserver is limited
+    {
+        std::mutex mtx;
+        std::map<ChunkServerIdType, int> inflight;
+        int maxInflight = 0;
+        std::atomic<int> deleted{0};
+        EXPECT_CALL(*storage_, ListSegment(1, _))
+            .WillOnce(DoAll(SetArgPointee<1>(segments),
+                            Return(StoreStatus::OK)));
+        EXPECT_CALL(*csClient_, DeleteChunk(_, 1, _, _, _))
+            .Times(segmentNum * 4)
+            .WillRepeatedly(Invoke([&](ChunkServerIdType leader,
+                                       LogicalPoolID, CopysetID, ChunkID,
+                                       uint64_t) {
+                {
+                    std::lock_guard<std::mutex> lk(mtx);
+                    maxInflight = std::max(maxInflight, ++inflight[leader]);
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                {
+                    std::lock_guard<std::mutex> lk(mtx);
+                    --inflight[leader];
+                }
+                deleted++;
+                return kMdsSuccess;
+            }));
+        EXPECT_CALL(*storage_, DeleteSegment(1, _, _))
+            .Times(segmentNum)
+            .WillRepeatedly(Return(StoreStatus::OK));
+        EXPECT_CALL(*allocStatistic_, DeAllocSpace(_, _, _))
+            .Times(segmentNum);
+        EXPECT_CALL(*storage_, DeleteFile(_, _))
+            .WillOnce(Return(StoreStatus::OK));
+
+        TaskProgress progress;
+        ASSERT_EQ(StatusCode::kOK, cleanCore_->CleanFile(cleanFile, &progress));
+        ASSERT_EQ(TaskStatus::SUCCESS, progress.GetStatus());
+        ASSERT_EQ(segmentNum * 4, deleted.load());
+        ASSERT_LE(maxInflight, 2);
+    }
+
+    // a copyset fails, the segments not in it are still deleted
+    {
+        EXPECT_CALL(*storage_, ListSegment(1, _))
+            .WillOnce(DoAll(SetArgPointee<1>(segments),
+                            Return(StoreStatus::OK)));
+        EXPECT_CALL(*csClient_, DeleteChunk(_, 1, _, _, _))
+            .WillRepeatedly(Invoke([](ChunkServerIdType, LogicalPoolID,
+                                      CopysetID copysetId, ChunkID,
+                                      uint64_t) {
+                return copysetId == 2 ? kMdsFail : kMdsSuccess;
+            }));
+        // copyset 2 is in segment 1 and 2, the second batch is not started
+        EXPECT_CALL(*storage_, DeleteSegment(1, 0, _))
+            .WillOnce(Return(StoreStatus::OK));
+        EXPECT_CALL(*storage_, DeleteSegment(1, DefaultSegmentSize, _))
+            .Times(0);
+        EXPECT_CALL(*allocStatistic_, DeAllocSpace(_, _, _))
+            .Times(1);
+        EXPECT_CALL(*storage_, DeleteFile(_, _))
+            .Times(0);
+
+        TaskProgress progress;
+        ASSERT_EQ(StatusCode::kCommonFileDeleteError,
+                  cleanCore_->CleanFile(cleanFile, &progress));
+        ASSERT_EQ(TaskStatus::FAILED, progress.GetStatus());
+    }
+}
+
 TEST_F(CleanCoreTest, TestCleanDiscardSegment) {
     const std::string fakeKey = "fakekey";
     const int kDefaultChunkSize = 16 * 1024 * 1024;
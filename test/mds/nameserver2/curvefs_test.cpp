@@ -2723,6 +2723,69 @@ TEST_F(CurveFSTest, TestDeAllocateSegment) {
     }
 }
 
+TEST_F(CurveFSTest, TestListSegment) {
+    const std::string filename = "/TestListSegment";
+
+    // GetFileInfo failed
+    {
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .WillOnce(Return(StoreStatus::InternalError));
+
+        std::vector<PageFileSegment> segments;
+        ASSERT_EQ(StatusCode::kStorageError,
+                  curvefs_->ListSegment(filename, &segments));
+    }
+
+    // file type not support
+    {
+        FileInfo fileInfo;
+        fileInfo.set_filetype(FileType::INODE_DIRECTORY);
+
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(fileInfo), Return(StoreStatus::OK)));
+
+        std::vector<PageFileSegment> segments;
+        ASSERT_EQ(StatusCode::kParaError,
+                  curvefs_->ListSegment(filename, &segments));
+    }
+
+    FileInfo fileInfo;
+    fileInfo.set_id(100);
+    fileInfo.set_filetype(FileType::INODE_PAGEFILE);
+
+    // list segment failed
+    {
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(fileInfo), Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, ListSegment(100, _))
+            .WillOnce(Return(StoreStatus::InternalError));
+
+        std::vector<PageFileSegment> segments;
+        ASSERT_EQ(StatusCode::kStorageError,
+                  curvefs_->ListSegment(filename, &segments));
+    }
+
+    // list segment success
+    {
+        std::vector<PageFileSegment> stored(2);
+        stored[0].set_startoffset(0);
+        stored[1].set_startoffset(1 * kGB);
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(fileInfo), Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, ListSegment(100, _))
+            .WillOnce(
+                DoAll(SetArgPointee<1>(stored), Return(StoreStatus::OK)));
+
+        std::vector<PageFileSegment> segments;
+        ASSERT_EQ(StatusCode::kOK, curvefs_->ListSegment(filename, &segments));
+        ASSERT_EQ(2, segments.size());
+        ASSERT_EQ(1 * kGB, segments[1].startoffset());
+    }
+}
+
 TEST_F(CurveFSTest, testCreateSnapshotFile) {
     {
         // test client time not expired
@@ -4638,6 +4701,14 @@ TEST(StripeParamTest, Test) {
     rc = CheckStripeParam(segmentSize, chunkSize, 4096,
                           segmentSize / chunkSize);
     EXPECT_EQ(StatusCode::kOK, rc);
+
+    // stripe count divides the chunks of segment, not the chunk size
+    constexpr uint64_t segmentSize48 = 48 * chunkSize;
+    rc = CheckStripeParam(segmentSize48, chunkSize, 4096, 3);
+    EXPECT_EQ(StatusCode::kOK, rc);
+
+    rc = CheckStripeParam(segmentSize48, chunkSize, 4096, 32);
+    EXPECT_EQ(StatusCode::kParaError, rc);
 }
 
 }  // namespace mds
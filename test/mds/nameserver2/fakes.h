@@ -321,6 +321,33 @@ class FakeNameServerStorage : public NameServerStorage {
         return StoreStatus::OK;
     }
 
+    StoreStatus ListFilePage(InodeID id,
+                             const std::string &startAfter,
+                             uint32_t limit,
+                             std::vector<FileInfo> *files,
+                             bool *hasMore) override {
+        std::lock_guard<std::mutex> guard(lock_);
+        std::string startStoreKey =
+                NameSpaceStorageCodec::EncodeFileStoreKey(id, startAfter);
+        std::string endStoreKey =
+                NameSpaceStorageCodec::EncodeFileStoreKey(id + 1, "");
+
+        *hasMore = false;
+        uint32_t count = 0;
+        for (auto iter = memKvMap_.upper_bound(startStoreKey);
+             iter != memKvMap_.end() && iter->first < endStoreKey; iter++) {
+            if (count++ == limit) {
+                *hasMore = true;
+                break;
+            }
+            FileInfo  validFile;
+            validFile.ParseFromString(iter->second);
+            files->push_back(validFile);
+        }
+
+        return StoreStatus::OK;
+    }
+
     StoreStatus ListSegment(InodeID id,
                             std::vector<PageFileSegment> *segments) {
         std::lock_guard<std::mutex> guard(lock_);
@@ -0,0 +1,148 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "src/mds/nameserver2/file_info_cache.h"
+
+namespace curve {
+namespace mds {
+
+namespace {
+
+FileInfo MakeFileInfo(InodeID id, InodeID parentid, const std::string &name) {
+    FileInfo info;
+    info.set_id(id);
+    info.set_parentid(parentid);
+    info.set_filename(name);
+    info.set_filetype(FileType::INODE_PAGEFILE);
+    return info;
+}
+
+}  // namespace
+
+TEST(FileInfoCacheTest, GetPutRemoveFile) {
+    FileInfoCacheOption option;
+    option.fileCount = 2;
+    FileInfoCache cache(option);
+
+    FileInfo out;
+    ASSERT_FALSE(cache.GetFile("a", &out));
+
+    cache.PutFile("a", MakeFileInfo(1, 0, "a"));
+    cache.PutFile("b", MakeFileInfo(2, 0, "b"));
+    ASSERT_TRUE(cache.GetFile("a", &out));
+    ASSERT_EQ(1, out.id());
+
+    // "b" is the least recently used one
+    cache.PutFile("c", MakeFileInfo(3, 0, "c"));
+    ASSERT_FALSE(cache.GetFile("b", &out));
+    ASSERT_TRUE(cache.GetFile("c", &out));
+
+    cache.RemoveFile("a");
+    ASSERT_FALSE(cache.GetFile("a", &out));
+}
+
+TEST(FileInfoCacheTest, ListDir) {
+    FileInfoCacheOption option;
+    option.fileCount = 16;
+    option.dirCount = 16;
+    option.maxDirEntries = 2;
+    FileInfoCache cache(option);
+
+    std::vector<FileInfo> children{MakeFileInfo(2, 1, "a"),
+                                   MakeFileInfo(3, 1, "b")};
+    std::vector<FileInfo> out;
+    ASSERT_FALSE(cache.ListDir(1, &out));
+
+    uint64_t token = cache.BeginListDir(1);
+    // not listed until loading finished
+    ASSERT_FALSE(cache.ListDir(1, &out));
+    cache.FinishListDir(1, token, children);
+    ASSERT_TRUE(cache.ListDir(1, &out));
+    ASSERT_EQ(2, out.size());
+    ASSERT_EQ("b", out[1].filename());
+
+    cache.InvalidateDir(1);
+    out.clear();
+    ASSERT_FALSE(cache.ListDir(1, &out));
+
+    // too many children
+    children.push_back(MakeFileInfo(4, 1, "c"));
+    token = cache.BeginListDir(1);
+    cache.FinishListDir(1, token, children);
+    ASSERT_FALSE(cache.ListDir(1, &out));
+}
+
+TEST(FileInfoCacheTest, InvalidateWhileListing) {
+    FileInfoCacheOption option;
+    option.fileCount = 16;
+    option.dirCount = 16;
+    FileInfoCache cache(option);
+
+    std::vector<FileInfo> children{MakeFileInfo(2, 1, "a")};
+    std::vector<FileInfo> out;
+
+    // a write during loading drops the loaded listing
+    uint64_t token = cache.BeginListDir(1);
+    cache.InvalidateDir(1);
+    cache.FinishListDir(1, token, children);
+    ASSERT_FALSE(cache.ListDir(1, &out));
+
+    // only the latest loading is kept
+    uint64_t first = cache.BeginListDir(1);
+    uint64_t second = cache.BeginListDir(1);
+    cache.FinishListDir(1, first, children);
+    ASSERT_FALSE(cache.ListDir(1, &out));
+    cache.FinishListDir(1, second, children);
+    ASSERT_TRUE(cache.ListDir(1, &out));
+    ASSERT_EQ(1, out.size());
+}
+
+TEST(FileInfoCacheTest, DirCacheDisabled) {
+    FileInfoCacheOption option;
+    option.fileCount = 16;
+    FileInfoCache cache(option);
+
+    std::vector<FileInfo> out;
+    uint64_t token = cache.BeginListDir(1);
+    cache.FinishListDir(1, token, {MakeFileInfo(2, 1, "a")});
+    ASSERT_FALSE(cache.ListDir(1, &out));
+}
+
+TEST(FileInfoCacheTest, Clear) {
+    FileInfoCacheOption option;
+    option.fileCount = 16;
+    option.dirCount = 16;
+    FileInfoCache cache(option);
+
+    cache.PutFile("a", MakeFileInfo(2, 1, "a"));
+    std::vector<FileInfo> out;
+    uint64_t token = cache.BeginListDir(1);
+    cache.FinishListDir(1, token, {MakeFileInfo(2, 1, "a")});
+    ASSERT_TRUE(cache.ListDir(1, &out));
+
+    cache.Clear();
+    FileInfo info;
+    ASSERT_FALSE(cache.GetFile("a", &info));
+    ASSERT_FALSE(cache.ListDir(1, &out));
+}
+
+}  // namespace mds
+}  // namespace curve
@@ -24,7 +24,9 @@
 #include <gtest/gtest.h>
 
 #include <chrono>    //NOLINT
+#include <string>
 #include <thread>    // NOLINT
+#include <vector>
 
 #include "src/common/timeutility.h"
 #include "src/mds/common/mds_define.h"
@@ -156,5 +158,37 @@ TEST(FileRecordManagerTest, open_file_num_test) {
     fileRecordManager.Stop();
 }
 
+TEST(FileRecordManagerTest, remove_and_readd_test) {
+    FileRecordOptions fileRecordOptions;
+    fileRecordOptions.scanIntervalTimeUs = 1 * 1000;
+    fileRecordOptions.fileRecordExpiredTimeUs = 2 * 1000;
+
+    FileRecordManager fileRecordManager;
+    fileRecordManager.Init(fileRecordOptions);
+    fileRecordManager.Start();
+
+    // 文件分布在不同的分片上
+    for (int i = 0; i < 200; ++i) {
+        fileRecordManager.UpdateFileRecord("file" + std::to_string(i), "",
+                                           "127.0.0.1", 1234);
+    }
+    ASSERT_EQ(200, fileRecordManager.GetOpenFileNum());
+
+    // 关闭后重新打开，时间轮中旧的记录不影响新的记录
+    fileRecordManager.RemoveFileRecord("file0", "127.0.0.1", 1234);
+    ASSERT_EQ(199, fileRecordManager.GetOpenFileNum());
+    std::vector<butil::EndPoint> clients;
+    ASSERT_FALSE(fileRecordManager.FindFileMountPoint("file0", &clients));
+    fileRecordManager.UpdateFileRecord("file0", "", "127.0.0.1", 1234);
+    ASSERT_EQ(200, fileRecordManager.GetOpenFileNum());
+
+    // 超时时间为20ms，sleep 100ms后全部超时
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(0, fileRecordManager.GetOpenFileNum());
+    ASSERT_EQ(0, fileRecordManager.ListAllClient().size());
+
+    fileRecordManager.Stop();
+}
+
 }  // namespace mds
 }  // namespace curve
@@ -31,6 +31,8 @@ using ::curve::common::FILEINFOKEYPREFIX;
 using ::curve::common::SNAPSHOTFILEINFOKEYPREFIX;
 using ::curve::common::SEGMENTALLOCSIZEKEY;
 using ::curve::common::SEGMENTINFOKEYPREFIX;
+using ::curve::common::SEGMENTALLOCLOGKEYPREFIX;
+using ::curve::common::SEGMENTKEYLEN;
 
 namespace curve {
 namespace mds {
@@ -208,5 +210,31 @@ TEST(NameSpaceHelperTest, test_Encode_Decode_SegmentAllocValue) {
         NameSpaceStorageCodec::DecodeSegmentAllocValue("world", &lid, &alloc));
 }
 
+TEST(NameSpaceHelperTest, test_Encode_Decode_SegmentAllocLog) {
+    std::string key1 = NameSpaceStorageCodec::EncodeSegmentAllocLogKey(1, 2);
+    std::string key2 = NameSpaceStorageCodec::EncodeSegmentAllocLogKey(1, 256);
+    ASSERT_EQ(SEGMENTKEYLEN, key1.size());
+    ASSERT_EQ(SEGMENTALLOCLOGKEYPREFIX, key1.substr(0, 2));
+    ASSERT_LT(key1, key2);
+
+    ASSERT_EQ("1_-1024",
+        NameSpaceStorageCodec::EncodeSegmentAllocLogValue(1, -1024));
+    uint16_t lid;
+    int64_t change;
+    ASSERT_TRUE(NameSpaceStorageCodec::DecodeSegmentAllocLogValue(
+        "1_-1024", &lid, &change));
+    ASSERT_EQ(1, lid);
+    ASSERT_EQ(-1024, change);
+    ASSERT_TRUE(NameSpaceStorageCodec::DecodeSegmentAllocLogValue(
+        "2_1024", &lid, &change));
+    ASSERT_EQ(2, lid);
+    ASSERT_EQ(1024, change);
+
+    ASSERT_FALSE(NameSpaceStorageCodec::DecodeSegmentAllocLogValue(
+        "1_", &lid, &change));
+    ASSERT_FALSE(NameSpaceStorageCodec::DecodeSegmentAllocLogValue(
+        "1_-", &lid, &change));
+}
+
 }  // namespace mds
 }  // namespace curve
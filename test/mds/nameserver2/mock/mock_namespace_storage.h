@@ -64,6 +64,12 @@ class MockNameServerStorage : public NameServerStorage {
                                        InodeID,
                                        std::vector<FileInfo> * files));
 
+    MOCK_METHOD5(ListFilePage, StoreStatus(InodeID,
+                                           const std::string &,
+                                           uint32_t,
+                                           std::vector<FileInfo> *,
+                                           bool *));
+
     MOCK_METHOD3(ListSnapshotFile, StoreStatus(InodeID,
                                        InodeID,
                                        std::vector<FileInfo> * files));
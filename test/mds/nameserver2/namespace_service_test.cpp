@@ -636,6 +636,20 @@ TEST_F(NameSpaceServiceTest, test1) {
         ASSERT_TRUE(false);
     }
 
+    // segments not allocated are skipped when getting more than one segment
+    cntl.Reset();
+    response3.Clear();
+    request3.set_segmentnum(3);
+    stub.GetOrAllocateSegment(&cntl, &request3, &response3, NULL);
+    if (!cntl.Failed()) {
+        ASSERT_EQ(response3.statuscode(), StatusCode::kOK);
+        ASSERT_EQ(response3.pagefilesegment().SerializeAsString(),
+            response2.pagefilesegment().SerializeAsString());
+        ASSERT_EQ(0, response3.extrasegments_size());
+    } else {
+        ASSERT_TRUE(false);
+    }
+
     // test get allocated size
     {
         cntl.Reset();
@@ -2850,6 +2864,159 @@ TEST_F(NameSpaceServiceTest, TestDeAllocateSegment) {
         ASSERT_FALSE(cntl.Failed());
         ASSERT_EQ(StatusCode::kSegmentNotAllocated, response.statuscode());
     }
+
+    // 5. deallocate consecutive segments, segments not allocated are skipped
+    {
+        for (uint64_t index : {60, 62}) {
+            cntl.Reset();
+            GetOrAllocateSegmentRequest allocateRequest;
+            GetOrAllocateSegmentResponse allocateResponse;
+            allocateRequest.set_filename(filename);
+            allocateRequest.set_offset(index * kGB);
+            allocateRequest.set_allocateifnotexist(true);
+            allocateRequest.set_owner(owner);
+            allocateRequest.set_date(TimeUtility::GetTimeofDayUs());
+            stub.GetOrAllocateSegment(&cntl, &allocateRequest,
+                                      &allocateResponse, nullptr);
+            ASSERT_FALSE(cntl.Failed());
+            ASSERT_EQ(StatusCode::kOK, allocateResponse.statuscode());
+        }
+
+        cntl.Reset();
+        DeAllocateSegmentRequest request;
+        DeAllocateSegmentResponse response;
+
+        request.set_filename(filename);
+        request.set_offset(60ull * kGB);
+        request.set_owner(owner);
+        request.set_date(TimeUtility::GetTimeofDayUs());
+        request.set_segmentnum(4);
+
+        stub.DeAllocateSegment(&cntl, &request, &response, nullptr);
+        ASSERT_FALSE(cntl.Failed());
+        ASSERT_EQ(StatusCode::kOK, response.statuscode());
+        ASSERT_EQ(4, response.deallocatednum());
+
+        cntl.Reset();
+        response.Clear();
+        request.set_offset(62ull * kGB);
+        request.clear_segmentnum();
+        stub.DeAllocateSegment(&cntl, &request, &response, nullptr);
+        ASSERT_FALSE(cntl.Failed());
+        ASSERT_EQ(StatusCode::kSegmentNotAllocated, response.statuscode());
+        ASSERT_EQ(0, response.deallocatednum());
+    }
+}
+
+TEST_F(NameSpaceServiceTest, TestListSegment) {
+    brpc::Server server;
+
+    NameSpaceService nameSpaceSerivce(new FileLockManager(13));
+
+    ASSERT_EQ(0, server.AddService(&nameSpaceSerivce,
+                                   brpc::SERVER_DOESNT_OWN_SERVICE));
+
+    brpc::ServerOptions opt;
+    opt.idle_timeout_sec = -1;
+    ASSERT_EQ(0, server.Start("127.0.0.1", {8900, 8999}, &opt));
+
+    // init channel
+    brpc::Channel channel;
+    ASSERT_EQ(channel.Init(server.listen_address(), nullptr), 0);
+
+    CurveFSService_Stub stub(&channel);
+    brpc::Controller cntl;
+    uint64_t fileLength = 100 * kGB;
+    std::string filename = "/TestListSegment";
+    std::string owner = "curve";
+
+    // create file
+    {
+        std::vector<PoolIdType> logicalPools{1, 2, 3};
+        EXPECT_CALL(*topology_, GetLogicalPoolInCluster(_))
+            .Times(AtLeast(1))
+            .WillRepeatedly(Return(logicalPools));
+        CreateFileRequest createRequest;
+        CreateFileResponse createResponse;
+        createRequest.set_filename(filename);
+        createRequest.set_owner(owner);
+        createRequest.set_date(TimeUtility::GetTimeofDayUs());
+        createRequest.set_filetype(INODE_PAGEFILE);
+        createRequest.set_filelength(fileLength);
+
+        stub.CreateFile(&cntl, &createRequest, &createResponse, nullptr);
+        ASSERT_FALSE(cntl.Failed());
+        ASSERT_EQ(StatusCode::kOK, createResponse.statuscode());
+    }
+
+    ListSegmentRequest request;
+    ListSegmentResponse response;
+    request.set_filename(filename);
+    request.set_owner(owner);
+    request.set_date(TimeUtility::GetTimeofDayUs());
+
+    // 1. no segment allocated
+    {
+        cntl.Reset();
+        stub.ListSegment(&cntl, &request, &response, nullptr);
+        ASSERT_FALSE(cntl.Failed());
+        ASSERT_EQ(StatusCode::kOK, response.statuscode());
+        ASSERT_EQ(0, response.segments_size());
+    }
+
+    // 2. list the allocated segments in order of offset
+    {
+        for (uint64_t index : {50, 10, 30}) {
+            cntl.Reset();
+            GetOrAllocateSegmentRequest allocateRequest;
+            GetOrAllocateSegmentResponse allocateResponse;
+            allocateRequest.set_filename(filename);
+            allocateRequest.set_offset(index * kGB);
+            allocateRequest.set_allocateifnotexist(true);
+            allocateRequest.set_owner(owner);
+            allocateRequest.set_date(TimeUtility::GetTimeofDayUs());
+            stub.GetOrAllocateSegment(&cntl, &allocateRequest,
+                                      &allocateResponse, nullptr);
+            ASSERT_FALSE(cntl.Failed());
+            ASSERT_EQ(StatusCode::kOK, allocateResponse.statuscode());
+        }
+
+        cntl.Reset();
+        response.Clear();
+        request.set_date(TimeUtility::GetTimeofDayUs());
+        stub.ListSegment(&cntl, &request, &response, nullptr);
+        ASSERT_FALSE(cntl.Failed());
+        ASSERT_EQ(StatusCode::kOK, response.statuscode());
+        ASSERT_EQ(3, response.segments_size());
+        ASSERT_EQ(10ull * kGB, response.segments(0).startoffset());
+        ASSERT_EQ(30ull * kGB, response.segments(1).startoffset());
+        ASSERT_EQ(50ull * kGB, response.segments(2).startoffset());
+        ASSERT_LT(0, response.segments(0).chunks_size());
+    }
+
+    // 3. owner not match
+    {
+        cntl.Reset();
+        response.Clear();
+        request.set_owner("not-owner");
+        request.set_date(TimeUtility::GetTimeofDayUs());
+        stub.ListSegment(&cntl, &request, &response, nullptr);
+        ASSERT_FALSE(cntl.Failed());
+        ASSERT_EQ(StatusCode::kOwnerAuthFail, response.statuscode());
+        request.set_owner(owner);
+    }
+
+    // 4. not a pagefile
+    {
+        cntl.Reset();
+        response.Clear();
+        request.set_filename("/");
+        request.set_owner(owner);
+        request.set_date(TimeUtility::GetTimeofDayUs());
+        stub.ListSegment(&cntl, &request, &response, nullptr);
+        ASSERT_FALSE(cntl.Failed());
+        ASSERT_NE(StatusCode::kOK, response.statuscode());
+    }
 }
 
 }  // namespace mds
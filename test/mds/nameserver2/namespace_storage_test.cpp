@@ -31,6 +31,7 @@
 
 using ::testing::_;
 using ::testing::Return;
+using ::testing::Invoke;
 using ::testing::AtLeast;
 using ::testing::SetArgPointee;
 using ::testing::DoAll;
@@ -320,6 +321,54 @@ TEST_F(TestNameServerStorageImp, test_ListFile) {
     ASSERT_EQ(fileinfo.seqnum(), listRes[0].seqnum());
 }
 
+TEST_F(TestNameServerStorageImp, test_ListFilePage) {
+    std::vector<FileInfo> listRes;
+    bool hasMore = false;
+
+    // 1. list err
+    EXPECT_CALL(*client_, ListWithLimitAndRevision(_, _, _, _, _, _))
+        .WillOnce(Return(EtcdErrCode::EtcdCanceled));
+    ASSERT_EQ(StoreStatus::InternalError,
+              storage_->ListFilePage(1, "", 2, &listRes, &hasMore));
+
+    // 2. more files than the limit
+    std::vector<std::string> encoded;
+    for (int i = 0; i < 3; i++) {
+        FileInfo fileinfo;
+        GetFileInfoForTest(&fileinfo);
+        fileinfo.set_filename("file" + std::to_string(i));
+        std::string value;
+        ASSERT_TRUE(NameSpaceStorageCodec::EncodeFileInfo(fileinfo, &value));
+        encoded.push_back(value);
+    }
+    std::string startKey = NameSpaceStorageCodec::EncodeFileStoreKey(1, "");
+    std::string endKey = NameSpaceStorageCodec::EncodeFileStoreKey(2, "");
+    EXPECT_CALL(*client_,
+                ListWithLimitAndRevision(startKey, endKey, 3, 0, _, _))
+        .WillOnce(DoAll(SetArgPointee<4>(encoded),
+                        Return(EtcdErrCode::EtcdOK)));
+    ASSERT_EQ(StoreStatus::OK,
+              storage_->ListFilePage(1, "", 2, &listRes, &hasMore));
+    ASSERT_TRUE(hasMore);
+    ASSERT_EQ(2, listRes.size());
+    ASSERT_EQ("file1", listRes[1].filename());
+
+    // 3. the last page, starts after the last file of previous page
+    listRes.clear();
+    startKey = NameSpaceStorageCodec::EncodeFileStoreKey(1, "file1");
+    startKey.push_back('\0');
+    EXPECT_CALL(*client_,
+                ListWithLimitAndRevision(startKey, endKey, 3, 0, _, _))
+        .WillOnce(DoAll(
+            SetArgPointee<4>(std::vector<std::string>{encoded[2]}),
+            Return(EtcdErrCode::EtcdOK)));
+    ASSERT_EQ(StoreStatus::OK,
+              storage_->ListFilePage(1, "file1", 2, &listRes, &hasMore));
+    ASSERT_FALSE(hasMore);
+    ASSERT_EQ(1, listRes.size());
+    ASSERT_EQ("file2", listRes[0].filename());
+}
+
 TEST_F(TestNameServerStorageImp, test_ListSnapshotFile) {
     // 1. list err
     std::vector<FileInfo> listRes;
@@ -366,6 +415,59 @@ TEST_F(TestNameServerStorageImp, test_putsegment) {
         storage_->PutSegment(0, 0, &segment, &revision));
 }
 
+TEST_F(TestNameServerStorageImp, test_SegmentAllocLog) {
+    storage_ = std::make_shared<NameServerStorageImp>(client_, cache_,
+                                                      nullptr, nullptr, true);
+    PageFileSegment segment;
+    segment.set_segmentsize(1024*1024*1024);
+    segment.set_chunksize(16*1024*1024);
+    segment.set_startoffset(0);
+    segment.set_logicalpoolid(1);
+    std::string encodeSegment;
+    ASSERT_TRUE(NameSpaceStorageCodec::EncodeSegment(segment, &encodeSegment));
+
+    // 1. put segment和变更日志在同一个事务中
+    std::vector<Operation> txnOps;
+    std::vector<std::string> logValues;
+    auto saveOps = [&](const std::vector<Operation> &ops, int64_t *revision) {
+        txnOps = ops;
+        logValues.emplace_back(ops[1].value, ops[1].valueLen);
+        *revision = 10;
+        return EtcdErrCode::EtcdOK;
+    };
+    EXPECT_CALL(*client_, TxnNWithRevision(_, _))
+        .WillOnce(Invoke(saveOps))
+        .WillOnce(Invoke(saveOps));
+    EXPECT_CALL(*cache_, Put(_, _)).Times(1);
+    int64_t revision;
+    ASSERT_EQ(StoreStatus::OK,
+              storage_->PutSegment(1, 0, &segment, &revision));
+    ASSERT_EQ(10, revision);
+    ASSERT_EQ(2, txnOps.size());
+    ASSERT_EQ(OpType::OpPut, txnOps[0].opType);
+    ASSERT_EQ(OpType::OpPut, txnOps[1].opType);
+    ASSERT_EQ(NameSpaceStorageCodec::EncodeSegmentAllocLogValue(1, 1 << 30),
+              logValues[0]);
+
+    // 2. delete segment同时记录回收
+    EXPECT_CALL(*cache_, Get(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(encodeSegment), Return(true)));
+    EXPECT_CALL(*cache_, Remove(_)).Times(1);
+    ASSERT_EQ(StoreStatus::OK, storage_->DeleteSegment(1, 0, &revision));
+    ASSERT_EQ(OpType::OpDelete, txnOps[0].opType);
+    ASSERT_EQ(NameSpaceStorageCodec::EncodeSegmentAllocLogValue(
+                  1, -(1 << 30)), logValues[1]);
+
+    // 3. segment不存在时不记录
+    EXPECT_CALL(*cache_, Get(_, _)).WillOnce(Return(false));
+    EXPECT_CALL(*client_, Get(_, _))
+        .WillOnce(Return(EtcdErrCode::EtcdKeyNotExist));
+    EXPECT_CALL(*client_, DeleteRewithRevision(_, _))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
+    EXPECT_CALL(*cache_, Remove(_)).Times(1);
+    ASSERT_EQ(StoreStatus::OK, storage_->DeleteSegment(1, 0, &revision));
+}
+
 TEST_F(TestNameServerStorageImp, test_getSegment) {
     // 1. get err
     PageFileSegment segment;
@@ -573,5 +675,74 @@ TEST_F(TestNameServerStorageImp, test_ListDiscardSegment) {
     }
 }
 
+TEST_F(TestNameServerStorageImp, test_FileInfoCache) {
+    FileInfoCacheOption option;
+    option.fileCount = 16;
+    option.dirCount = 16;
+    storage_ = std::make_shared<NameServerStorageImp>(
+        client_, cache_, std::make_shared<FileInfoCache>(option));
+    EXPECT_CALL(*cache_, Get(_, _)).Times(0);
+    EXPECT_CALL(*cache_, Put(_, _)).Times(0);
+
+    FileInfo fileinfo;
+    GetFileInfoForTest(&fileinfo);
+    std::string encodeFileinfo;
+    ASSERT_TRUE(NameSpaceStorageCodec::EncodeFileInfo(fileinfo,
+                                                      &encodeFileinfo));
+
+    // 1. second get is served from the cache
+    EXPECT_CALL(*client_, Get(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(encodeFileinfo),
+                        Return(EtcdErrCode::EtcdOK)));
+    FileInfo getInfo;
+    for (int i = 0; i < 2; ++i) {
+        ASSERT_EQ(StoreStatus::OK, storage_->GetFile(fileinfo.parentid(),
+                                                     fileinfo.filename(),
+                                                     &getInfo));
+        ASSERT_EQ(fileinfo.id(), getInfo.id());
+    }
+
+    // 2. listing of a directory is served from the cache
+    EXPECT_CALL(*client_, List(_, _, Matcher<std::vector<std::string>*>(_)))
+        .WillOnce(DoAll(
+            SetArgPointee<2>(std::vector<std::string>{encodeFileinfo}),
+            Return(EtcdErrCode::EtcdOK)));
+    for (int i = 0; i < 2; ++i) {
+        std::vector<FileInfo> listRes;
+        ASSERT_EQ(StoreStatus::OK,
+                  storage_->ListFile(fileinfo.parentid(),
+                                     fileinfo.parentid() + 1, &listRes));
+        ASSERT_EQ(1, listRes.size());
+        ASSERT_EQ(fileinfo.filename(), listRes[0].filename());
+    }
+
+    // 3. put file updates the cached file and drops the listing
+    fileinfo.set_seqnum(2);
+    EXPECT_CALL(*client_, Put(_, _)).WillOnce(Return(EtcdErrCode::EtcdOK));
+    ASSERT_EQ(StoreStatus::OK, storage_->PutFile(fileinfo));
+    ASSERT_EQ(StoreStatus::OK, storage_->GetFile(fileinfo.parentid(),
+                                                 fileinfo.filename(),
+                                                 &getInfo));
+    ASSERT_EQ(2, getInfo.seqnum());
+
+    EXPECT_CALL(*client_, List(_, _, Matcher<std::vector<std::string>*>(_)))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
+    std::vector<FileInfo> listRes;
+    ASSERT_EQ(StoreStatus::OK,
+              storage_->ListFile(fileinfo.parentid(), fileinfo.parentid() + 1,
+                                 &listRes));
+    ASSERT_TRUE(listRes.empty());
+
+    // 4. delete file removes it from the cache
+    EXPECT_CALL(*client_, Delete(_)).WillOnce(Return(EtcdErrCode::EtcdOK));
+    ASSERT_EQ(StoreStatus::OK,
+              storage_->DeleteFile(fileinfo.parentid(), fileinfo.filename()));
+    EXPECT_CALL(*client_, Get(_, _))
+        .WillOnce(Return(EtcdErrCode::EtcdKeyNotExist));
+    ASSERT_EQ(StoreStatus::KeyNotExist,
+              storage_->GetFile(fileinfo.parentid(), fileinfo.filename(),
+                                &getInfo));
+}
+
 }  // namespace mds
 }  // namespace curve
@@ -0,0 +1,238 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>  // NOLINT
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "src/mds/nameserver2/segment_put_batcher.h"
+#include "test/mds/mock/mock_etcdclient.h"
+
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::Invoke;
+using ::testing::Return;
+using ::testing::SetArgPointee;
+
+namespace curve {
+namespace mds {
+
+class SegmentPutBatcherTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        client_ = std::make_shared<MockEtcdClient>();
+        batcher_ = std::make_shared<SegmentPutBatcher>(client_, 4);
+    }
+
+    // the first put blocks in etcd until the others are queued, then the
+    // queued puts are committed together
+    void PutConcurrently(const std::vector<std::string> &keys,
+                         std::vector<int> *errCodes,
+                         std::vector<int64_t> *revisions) {
+        EXPECT_CALL(*client_, PutRewithRevision("first", _, _))
+            .WillOnce(Invoke([](const std::string &, const std::string &,
+                                int64_t *revision) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                *revision = 1;
+                return EtcdErrCode::EtcdOK;
+            }));
+
+        std::thread first([this]() {
+            int64_t revision = 0;
+            ASSERT_EQ(EtcdErrCode::EtcdOK,
+                      batcher_->Put("first", "value", &revision));
+            ASSERT_EQ(1, revision);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        errCodes->assign(keys.size(), -1);
+        revisions->assign(keys.size(), 0);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            threads.emplace_back([&, i]() {
+                (*errCodes)[i] =
+                    batcher_->Put(keys[i], "value", &(*revisions)[i]);
+            });
+        }
+
+        first.join();
+        for (auto &t : threads) {
+            t.join();
+        }
+    }
+
+ protected:
+    std::shared_ptr<MockEtcdClient> client_;
+    std::shared_ptr<SegmentPutBatcher> batcher_;
+};
+
+TEST_F(SegmentPutBatcherTest, SinglePut) {
+    EXPECT_CALL(*client_, TxnNWithRevision(_, _)).Times(0);
+    EXPECT_CALL(*client_, PutRewithRevision("key", "value", _))
+        .WillOnce(DoAll(SetArgPointee<2>(10), Return(EtcdErrCode::EtcdOK)))
+        .WillOnce(Return(EtcdErrCode::EtcdDeadlineExceeded));
+
+    int64_t revision = 0;
+    ASSERT_EQ(EtcdErrCode::EtcdOK, batcher_->Put("key", "value", &revision));
+    ASSERT_EQ(10, revision);
+    ASSERT_EQ(EtcdErrCode::EtcdDeadlineExceeded,
+              batcher_->Put("key", "value", &revision));
+}
+
+TEST_F(SegmentPutBatcherTest, ConcurrentPutsInOneTxn) {
+    EXPECT_CALL(*client_, TxnNWithRevision(_, _))
+        .WillOnce(Invoke([](const std::vector<Operation> &ops,
+                            int64_t *revision) {
+            EXPECT_EQ(3, ops.size());
+            *revision = 2;
+            return EtcdErrCode::EtcdOK;
+        }));
+
+    std::vector<int> errCodes;
+    std::vector<int64_t> revisions;
+    PutConcurrently({"a", "b", "c"}, &errCodes, &revisions);
+    for (size_t i = 0; i < errCodes.size(); ++i) {
+        ASSERT_EQ(EtcdErrCode::EtcdOK, errCodes[i]);
+        ASSERT_EQ(2, revisions[i]);
+    }
+}
+
+TEST_F(SegmentPutBatcherTest, BatchIsLimited) {
+    // 4 puts in the first txn, the last 2 in the next one
+    EXPECT_CALL(*client_, TxnNWithRevision(_, _))
+        .WillOnce(Invoke([](const std::vector<Operation> &ops,
+                            int64_t *revision) {
+            EXPECT_EQ(4, ops.size());
+            *revision = 2;
+            return EtcdErrCode::EtcdOK;
+        }))
+        .WillOnce(Invoke([](const std::vector<Operation> &ops,
+                            int64_t *revision) {
+            EXPECT_EQ(2, ops.size());
+            *revision = 3;
+            return EtcdErrCode::EtcdOK;
+        }));
+
+    std::vector<int> errCodes;
+    std::vector<int64_t> revisions;
+    PutConcurrently({"a", "b", "c", "d", "e", "f"}, &errCodes, &revisions);
+    int inFirstTxn = 0;
+    for (size_t i = 0; i < errCodes.size(); ++i) {
+        ASSERT_EQ(EtcdErrCode::EtcdOK, errCodes[i]);
+        inFirstTxn += revisions[i] == 2;
+    }
+    ASSERT_EQ(4, inFirstTxn);
+}
+
+TEST_F(SegmentPutBatcherTest, TxnFailedPutOneByOne) {
+    EXPECT_CALL(*client_, TxnNWithRevision(_, _))
+        .WillOnce(Return(EtcdErrCode::EtcdDeadlineExceeded));
+    EXPECT_CALL(*client_, PutRewithRevision("a", _, _))
+        .WillOnce(DoAll(SetArgPointee<2>(3), Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*client_, PutRewithRevision("b", _, _))
+        .WillOnce(Return(EtcdErrCode::EtcdUnavailable));
+
+    std::vector<int> errCodes;
+    std::vector<int64_t> revisions;
+    PutConcurrently({"a", "b"}, &errCodes, &revisions);
+    ASSERT_EQ(EtcdErrCode::EtcdOK, errCodes[0]);
+    ASSERT_EQ(3, revisions[0]);
+    ASSERT_EQ(EtcdErrCode::EtcdUnavailable, errCodes[1]);
+}
+
+TEST_F(SegmentPutBatcherTest, DuplicateKeyInNextTxn) {
+    EXPECT_CALL(*client_, TxnNWithRevision(_, _)).Times(0);
+    EXPECT_CALL(*client_, PutRewithRevision("a", _, _))
+        .Times(2)
+        .WillRepeatedly(
+            DoAll(SetArgPointee<2>(2), Return(EtcdErrCode::EtcdOK)));
+
+    std::vector<int> errCodes;
+    std::vector<int64_t> revisions;
+    PutConcurrently({"a", "a"}, &errCodes, &revisions);
+    ASSERT_EQ(EtcdErrCode::EtcdOK, errCodes[0]);
+    ASSERT_EQ(EtcdErrCode::EtcdOK, errCodes[1]);
+}
+
+TEST_F(SegmentPutBatcherTest, PutWithExtraKeyValue) {
+    // a single put with extra key-value is still one txn
+    EXPECT_CALL(*client_, PutRewithRevision(_, _, _)).Times(0);
+    EXPECT_CALL(*client_, TxnNWithRevision(_, _))
+        .WillOnce(Invoke([](const std::vector<Operation> &ops,
+                            int64_t *revision) {
+            EXPECT_EQ(2, ops.size());
+            EXPECT_EQ("key", std::string(ops[0].key, ops[0].keyLen));
+            EXPECT_EQ("log", std::string(ops[1].key, ops[1].keyLen));
+            *revision = 5;
+            return EtcdErrCode::EtcdOK;
+        }));
+
+    int64_t revision = 0;
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              batcher_->Put("key", "value", "log", "change", &revision));
+    ASSERT_EQ(5, revision);
+}
+
+TEST_F(SegmentPutBatcherTest, ExtraKeyValueCountedInBatch) {
+    // every put has two ops, so at most 2 puts in one txn of 4 ops
+    EXPECT_CALL(*client_, PutRewithRevision("first", _, _))
+        .WillOnce(Invoke([](const std::string &, const std::string &,
+                            int64_t *revision) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            *revision = 1;
+            return EtcdErrCode::EtcdOK;
+        }));
+    EXPECT_CALL(*client_, TxnNWithRevision(_, _))
+        .Times(2)
+        .WillRepeatedly(Invoke([](const std::vector<Operation> &ops,
+                                  int64_t *revision) {
+            EXPECT_EQ(4, ops.size());
+            *revision = 2;
+            return EtcdErrCode::EtcdOK;
+        }));
+
+    std::thread first([this]() {
+        int64_t revision = 0;
+        ASSERT_EQ(EtcdErrCode::EtcdOK,
+                  batcher_->Put("first", "value", &revision));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([this, i]() {
+            int64_t revision = 0;
+            ASSERT_EQ(EtcdErrCode::EtcdOK,
+                      batcher_->Put("key" + std::to_string(i), "value",
+                                    "log" + std::to_string(i), "change",
+                                    &revision));
+            ASSERT_EQ(2, revision);
+        });
+    }
+
+    first.join();
+    for (auto &t : threads) {
+        t.join();
+    }
+}
+
+}  // namespace mds
+}  // namespace curve
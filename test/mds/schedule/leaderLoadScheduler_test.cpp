@@ -0,0 +1,229 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <map>
+#include <vector>
+#include "src/mds/schedule/scheduler.h"
+#include "src/mds/schedule/scheduleMetrics.h"
+#include "src/mds/schedule/operatorStep.h"
+#include "test/mds/schedule/mock_topoAdapter.h"
+#include "test/mds/mock/mock_topology.h"
+#include "src/common/timeutility.h"
+
+using ::curve::mds::topology::MockTopology;
+
+using ::testing::_;
+using ::testing::Return;
+using ::testing::SetArgPointee;
+using ::testing::DoAll;
+
+namespace curve {
+namespace mds {
+namespace schedule {
+class TestLeaderLoadSchedule : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        auto topo = std::make_shared<MockTopology>();
+        auto metric = std::make_shared<ScheduleMetrics>(topo);
+        opController_ = std::make_shared<OperatorController>(2, metric);
+        topoAdapter_ = std::make_shared<MockTopoAdapter>();
+
+        ScheduleOption opt;
+        opt.transferLeaderTimeLimitSec = 10;
+        opt.removePeerTimeLimitSec = 100;
+        opt.addPeerTimeLimitSec = 1000;
+        opt.changePeerTimeLimitSec = 1000;
+        opt.scatterWithRangePerent = 0.2;
+        opt.chunkserverCoolingTimeSec = 0;
+        opt.leaderLoadSchedulerIntervalSec = 1;
+        opt.leaderLoadRangePercent = 0.2;
+        opt.leaderLoadCoolingTimeSec = 300;
+        scheduler_ = std::make_shared<LeaderLoadScheduler>(
+            opt, topoAdapter_, opController_);
+
+        for (ChunkServerIdType id = 1; id <= 3; id++) {
+            peers_.emplace_back(id, id, id, "192.168.10." + std::to_string(id),
+                                9000);
+        }
+    }
+
+    ChunkServerInfo ChunkServer(ChunkServerIdType id, uint32_t leaderCount) {
+        ChunkServerInfo info(
+            peers_[id - 1], ::curve::mds::topology::OnlineState::ONLINE,
+            ::curve::mds::topology::DiskState::DISKNORMAL,
+            ChunkServerStatus::READWRITE, leaderCount, 100, 10,
+            ::curve::mds::heartbeat::ChunkServerStatisticInfo());
+        info.startUpTime =
+            ::curve::common::TimeUtility::GetTimeofDaySec() - 10;
+        return info;
+    }
+
+    // add a copyset on all chunkservers with the leader and the write iops
+    void AddCopySet(CopySetIdType id, ChunkServerIdType leader,
+                    uint32_t iops) {
+        CopysetStatistics stat;
+        stat.set_readrate(0);
+        stat.set_writerate(0);
+        stat.set_readiops(0);
+        stat.set_writeiops(iops);
+        CopySetKey key{1, id};
+        copysets_.emplace_back(key, 1, leader, peers_, ConfigChangeInfo{},
+                               stat);
+        stats_[key] = stat;
+    }
+
+    void ExpectTopo(const std::vector<ChunkServerInfo> &csInfos) {
+        EXPECT_CALL(*topoAdapter_, GetLogicalpools())
+            .WillRepeatedly(Return(std::vector<PoolIdType>({1})));
+        EXPECT_CALL(*topoAdapter_, GetCopySetStatsInLogicalPool(1))
+            .WillRepeatedly(Return(stats_));
+        EXPECT_CALL(*topoAdapter_, GetChunkServersInLogicalPool(1))
+            .WillRepeatedly(Return(csInfos));
+        EXPECT_CALL(*topoAdapter_, GetCopySetInfosInLogicalPool(1))
+            .WillRepeatedly(Return(copysets_));
+        for (auto &csInfo : csInfos) {
+            EXPECT_CALL(*topoAdapter_, GetChunkServerInfo(csInfo.info.id, _))
+                .WillRepeatedly(DoAll(SetArgPointee<1>(csInfo), Return(true)));
+        }
+    }
+
+    ChunkServerIdType TargetOf(CopySetIdType id) {
+        Operator op;
+        if (!opController_->GetOperatorById(CopySetKey{1, id}, &op)) {
+            return UNINTIALIZE_ID;
+        }
+        auto step = dynamic_cast<TransferLeader *>(op.step.get());
+        return step == nullptr ? UNINTIALIZE_ID : step->GetTargetPeer();
+    }
+
+ protected:
+    std::shared_ptr<MockTopoAdapter> topoAdapter_;
+    std::shared_ptr<OperatorController> opController_;
+    std::shared_ptr<LeaderLoadScheduler> scheduler_;
+    std::vector<PeerInfo> peers_;
+    std::vector<CopySetInfo> copysets_;
+    std::map<CopySetKey, CopysetStatistics> stats_;
+};
+
+TEST_F(TestLeaderLoadSchedule, test_no_stats) {
+    EXPECT_CALL(*topoAdapter_, GetLogicalpools())
+        .WillOnce(Return(std::vector<PoolIdType>({1})));
+    EXPECT_CALL(*topoAdapter_, GetCopySetStatsInLogicalPool(1))
+        .WillOnce(Return(std::map<CopySetKey, CopysetStatistics>()));
+    ASSERT_EQ(0, scheduler_->Schedule());
+    ASSERT_EQ(0, opController_->GetOperators().size());
+}
+
+TEST_F(TestLeaderLoadSchedule, test_load_balanced) {
+    // the leader number is unbalanced, but the load is balanced
+    AddCopySet(1, 1, 300);
+    AddCopySet(2, 2, 100);
+    AddCopySet(3, 2, 100);
+    AddCopySet(4, 2, 100);
+    AddCopySet(5, 3, 300);
+    ExpectTopo({ChunkServer(1, 1), ChunkServer(2, 3), ChunkServer(3, 1)});
+    ASSERT_EQ(0, scheduler_->Schedule());
+    ASSERT_EQ(0, opController_->GetOperators().size());
+}
+
+TEST_F(TestLeaderLoadSchedule, test_transfer_hot_leader_out) {
+    // chunkserver1 has few but hot leaders
+    AddCopySet(1, 1, 400);
+    AddCopySet(2, 1, 400);
+    AddCopySet(3, 2, 50);
+    AddCopySet(4, 2, 50);
+    AddCopySet(5, 2, 50);
+    AddCopySet(6, 3, 50);
+    AddCopySet(7, 3, 50);
+    AddCopySet(8, 3, 50);
+    ExpectTopo({ChunkServer(1, 2), ChunkServer(2, 3), ChunkServer(3, 3)});
+    ASSERT_EQ(2, scheduler_->Schedule());
+
+    // a hot leader is swapped with the coldest leader on the target
+    ASSERT_EQ(2, opController_->GetOperators().size());
+    ChunkServerIdType target = TargetOf(1);
+    CopySetIdType hot = 1;
+    if (target == UNINTIALIZE_ID) {
+        target = TargetOf(2);
+        hot = 2;
+    }
+    ASSERT_TRUE(target == 2 || target == 3);
+    for (auto &info : copysets_) {
+        if (info.id.second == hot) {
+            continue;
+        }
+        ChunkServerIdType swapTarget = TargetOf(info.id.second);
+        if (info.leader == target) {
+            if (swapTarget != UNINTIALIZE_ID) {
+                ASSERT_EQ(1, swapTarget);
+            }
+        } else {
+            ASSERT_EQ(UNINTIALIZE_ID, swapTarget);
+        }
+    }
+
+    // the chunkservers are cooling until the load is reported
+    for (auto &op : opController_->GetOperators()) {
+        opController_->RemoveOperator(op.copysetID);
+    }
+    ASSERT_EQ(0, scheduler_->Schedule());
+    ASSERT_EQ(0, opController_->GetOperators().size());
+}
+
+TEST_F(TestLeaderLoadSchedule, test_transfer_without_swap) {
+    AddCopySet(1, 1, 400);
+    AddCopySet(2, 1, 400);
+    AddCopySet(3, 1, 10);
+    AddCopySet(4, 2, 50);
+    AddCopySet(5, 3, 50);
+    // no leader to swap, the targets have less leaders
+    copysets_[3].peers = {peers_[1], peers_[2]};
+    copysets_[4].peers = {peers_[1], peers_[2]};
+    ExpectTopo({ChunkServer(1, 3), ChunkServer(2, 1), ChunkServer(3, 1)});
+    ASSERT_EQ(1, scheduler_->Schedule());
+    ASSERT_EQ(1, opController_->GetOperators().size());
+    ChunkServerIdType target = TargetOf(1);
+    if (target == UNINTIALIZE_ID) {
+        target = TargetOf(2);
+    }
+    ASSERT_TRUE(target == 2 || target == 3);
+}
+
+TEST_F(TestLeaderLoadSchedule, test_not_move_hotspot) {
+    // transferring the only hot leader just moves the hotspot
+    AddCopySet(1, 1, 1000);
+    AddCopySet(2, 2, 50);
+    AddCopySet(3, 3, 50);
+    ExpectTopo({ChunkServer(1, 1), ChunkServer(2, 1), ChunkServer(3, 1)});
+    ASSERT_EQ(0, scheduler_->Schedule());
+    ASSERT_EQ(0, opController_->GetOperators().size());
+}
+
+TEST_F(TestLeaderLoadSchedule, test_copyset_unhealthy) {
+    AddCopySet(1, 1, 400);
+    AddCopySet(2, 1, 400);
+    AddCopySet(3, 2, 50);
+    AddCopySet(4, 3, 50);
+    auto offline = ChunkServer(3, 1);
+    offline.state = ::curve::mds::topology::OnlineState::OFFLINE;
+    ExpectTopo({ChunkServer(1, 2), ChunkServer(2, 1), offline});
+    ASSERT_EQ(0, scheduler_->Schedule());
+    ASSERT_EQ(0, opController_->GetOperators().size());
+}
+}  // namespace schedule
+}  // namespace mds
+}  // namespace curve
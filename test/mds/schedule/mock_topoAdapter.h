@@ -76,6 +76,9 @@ class MockTopoAdapter : public TopoAdapter {
     MOCK_METHOD1(GetCopySetInfosInLogicalPool,
         std::vector<CopySetInfo>(PoolIdType));
 
+    MOCK_METHOD1(GetCopySetStatsInLogicalPool,
+        std::map<CopySetKey, CopysetStatistics>(PoolIdType));
+
     MOCK_METHOD1(GetChunkServersInLogicalPool,
         std::vector<ChunkServerInfo>(PoolIdType));
 };
@@ -28,6 +28,7 @@
 #include "src/mds/common/mds_define.h"
 #include "test/mds/schedule/mock_topoAdapter.h"
 #include "test/mds/mock/mock_topology.h"
+#include "src/mds/schedule/operatorFactory.h"
 #include "test/mds/schedule/common.h"
 
 using ::testing::_;
@@ -332,6 +333,117 @@ TEST_F(TestRecoverSheduler, test_all_chunkServer_online_offline) {
         ASSERT_EQ(0, opController_->GetOperators().size());
     }
 }
+
+class TestRecoverShedulerWithBudget : public TestRecoverSheduler {
+ protected:
+    void SetUp() override {
+        TestRecoverSheduler::SetUp();
+        ScheduleOption opt;
+        opt.transferLeaderTimeLimitSec = 10;
+        opt.removePeerTimeLimitSec = 100;
+        opt.addPeerTimeLimitSec = 1000;
+        opt.changePeerTimeLimitSec = 1000;
+        opt.recoverSchedulerIntervalSec = 1;
+        opt.scatterWithRangePerent = 0.2;
+        opt.chunkserverFailureTolerance = 3;
+        opt.recoverConcurrentPerChunkServer = 1;
+        opt.recoverConcurrentPerServer = 1;
+        recoverScheduler_ = std::make_shared<RecoverScheduler>(
+                opt, topoAdapter_, opController_);
+    }
+
+    // chunkserver1 is offline, and chunkserver4 and chunkserver5 on server4
+    // are the candidates to recover the copysets
+    void ExpectTopo(const std::vector<CopySetInfo> &copysets,
+                    OnlineState cs2State) {
+        auto copyset = GetCopySetInfoForTest();
+        std::vector<ChunkServerInfo> csInfos;
+        for (auto &peer : copyset.peers) {
+            csInfos.emplace_back(peer, OnlineState::ONLINE,
+                                 DiskState::DISKNORMAL,
+                                 ChunkServerStatus::READWRITE, 2, 100, 100,
+                                 ChunkServerStatisticInfo{});
+        }
+        csInfos[0].state = OnlineState::OFFLINE;
+        csInfos[1].state = cs2State;
+        for (ChunkServerIdType id = 4; id <= 5; id++) {
+            PeerInfo peer(id, 4, 4, "192.168.10.4", 9000 + id);
+            csInfos.emplace_back(peer, OnlineState::ONLINE,
+                                 DiskState::DISKNORMAL,
+                                 ChunkServerStatus::READWRITE, 2, 100, 100,
+                                 ChunkServerStatisticInfo{});
+        }
+
+        EXPECT_CALL(*topoAdapter_, GetCopySetInfos())
+            .WillRepeatedly(Return(copysets));
+        EXPECT_CALL(*topoAdapter_, GetChunkServerInfos())
+            .WillRepeatedly(Return(csInfos));
+        EXPECT_CALL(*topoAdapter_, GetChunkServersInLogicalPool(_))
+            .WillRepeatedly(Return(csInfos));
+        for (auto &csInfo : csInfos) {
+            EXPECT_CALL(*topoAdapter_, GetChunkServerInfo(csInfo.info.id, _))
+                .WillRepeatedly(DoAll(SetArgPointee<1>(csInfo),
+                                      Return(true)));
+        }
+        EXPECT_CALL(*topoAdapter_, GetStandardReplicaNumInLogicalPool(_))
+            .WillRepeatedly(Return(3));
+        EXPECT_CALL(*topoAdapter_, GetStandardZoneNumInLogicalPool(_))
+            .WillRepeatedly(Return(3));
+        EXPECT_CALL(*topoAdapter_, GetAvgScatterWidthInLogicalPool(_))
+            .WillRepeatedly(Return(90));
+        EXPECT_CALL(*topoAdapter_, GetChunkServerScatterMap(_, _))
+            .WillRepeatedly(SetArgPointee<1>(
+                std::map<ChunkServerIdType, int>{}));
+        EXPECT_CALL(*topoAdapter_, CreateCopySetAtChunkServer(_, _))
+            .WillRepeatedly(Return(true));
+    }
+};
+
+TEST_F(TestRecoverShedulerWithBudget, test_recover_high_risk_first) {
+    // copyset2 has only one replica online
+    auto copyset1 = GetCopySetInfoForTest();
+    auto copyset2 = GetCopySetInfoForTest();
+    copyset2.id.second = 2;
+    copyset2.peers[1] = PeerInfo(6, 2, 2, "192.168.10.2", 9001);
+    ExpectTopo({copyset1, copyset2}, OnlineState::ONLINE);
+    ChunkServerInfo unstable(copyset2.peers[1], OnlineState::UNSTABLE,
+                             DiskState::DISKNORMAL,
+                             ChunkServerStatus::READWRITE, 2, 100, 100,
+                             ChunkServerStatisticInfo{});
+    EXPECT_CALL(*topoAdapter_, GetChunkServerInfo(6, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(unstable), Return(true)));
+
+    // the budget of server4 is for copyset2
+    recoverScheduler_->Schedule();
+    ASSERT_EQ(1, opController_->GetOperators().size());
+    Operator op;
+    ASSERT_TRUE(opController_->GetOperatorById(copyset2.id, &op));
+    ASSERT_TRUE(dynamic_cast<ChangePeer *>(op.step.get()) != nullptr);
+}
+
+TEST_F(TestRecoverShedulerWithBudget, test_recover_budget_of_server) {
+    auto copyset1 = GetCopySetInfoForTest();
+    auto copyset2 = GetCopySetInfoForTest();
+    copyset2.id.second = 2;
+    copyset2.leader = 2;
+    ExpectTopo({copyset1, copyset2}, OnlineState::ONLINE);
+
+    // copyset2 is copying data to chunkserver5 on server4
+    Operator copying = operatorFactory.CreateChangePeerOperator(
+        copyset2, 1, 5, OperatorPriority::HighPriority);
+    ASSERT_TRUE(opController_->AddOperator(copying));
+    recoverScheduler_->Schedule();
+    ASSERT_EQ(1, opController_->GetOperators().size());
+    Operator op;
+    ASSERT_FALSE(opController_->GetOperatorById(copyset1.id, &op));
+
+    // server4 is free after the recovery finished
+    opController_->RemoveOperator(copyset2.id);
+    recoverScheduler_->Schedule();
+    ASSERT_EQ(1, opController_->GetOperators().size());
+    ASSERT_TRUE(opController_->GetOperatorById(copyset1.id, &op));
+    ASSERT_TRUE(dynamic_cast<ChangePeer *>(op.step.get()) != nullptr);
+}
 }  // namespace schedule
 }  // namespace mds
 }  // namespace curve
@@ -0,0 +1,411 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "test/mds/schedule/scheduleSimulator/fake_cluster.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <string>
+
+#include "src/mds/topology/topology_item.h"
+
+namespace curve {
+namespace mds {
+namespace schedule {
+
+using ::curve::mds::topology::LogicalPoolType;
+
+FakeCluster::FakeCluster(const ClusterShape &shape)
+    : shape_(shape), scatterWidth_(0) {
+    std::mt19937 gen(shape_.seed);
+
+    // servers are assigned to zones in turn, the empty ones are the last
+    uint32_t serverNum =
+        shape_.zoneNum * shape_.serverNumPerZone + shape_.emptyServerNum;
+    std::map<ZoneIdType, std::vector<ChunkServerIdType>> placeable;
+    for (uint32_t s = 1; s <= serverNum; s++) {
+        ZoneIdType zone = (s - 1) % shape_.zoneNum + 1;
+        std::string ip = "10.0." + std::to_string(s / 256) + "." +
+                         std::to_string(s % 256);
+        for (uint32_t j = 1; j <= shape_.chunkServerNumPerServer; j++) {
+            ChunkServerIdType id = (s - 1) * shape_.chunkServerNumPerServer + j;
+            PeerInfo peer(id, zone, s, ip, 8200 + j);
+            ChunkServerInfo info(peer, OnlineState::ONLINE,
+                                 DiskState::DISKNORMAL,
+                                 ChunkServerStatus::READWRITE, 0,
+                                 shape_.diskCapacityMB, 0,
+                                 ChunkServerStatisticInfo());
+            info.startUpTime = 1;
+            chunkServers_.emplace(id, info);
+            if (s <= serverNum - shape_.emptyServerNum) {
+                placeable[zone].emplace_back(id);
+            }
+        }
+    }
+
+    // replicas are placed on random chunkservers of different zones
+    std::vector<ZoneIdType> zones;
+    for (auto &item : placeable) {
+        zones.emplace_back(item.first);
+    }
+    std::exponential_distribution<double> iops(
+        1.0 / std::max<uint32_t>(shape_.avgCopysetIops, 1));
+    for (uint32_t i = 1; i <= shape_.copysetNum; i++) {
+        std::shuffle(zones.begin(), zones.end(), gen);
+        std::vector<PeerInfo> peers;
+        for (uint32_t r = 0; r < shape_.replicaNum && r < zones.size(); r++) {
+            auto &candidates = placeable[zones[r]];
+            ChunkServerIdType id = candidates[gen() % candidates.size()];
+            peers.emplace_back(chunkServers_[id].info);
+        }
+
+        CopysetStatistics stat;
+        stat.set_readrate(0);
+        stat.set_writerate(0);
+        stat.set_readiops(0);
+        stat.set_writeiops(static_cast<uint32_t>(iops(gen)));
+        CopySetKey key(poolId_, i);
+        CopySetInfo info(key, 1, peers[0].id, peers, ConfigChangeInfo(), stat);
+        info.logicalPoolWork = true;
+        copysets_.emplace(key, info);
+        for (auto &peer : peers) {
+            copysetsInChunkServer_[peer.id].emplace(key);
+        }
+    }
+
+    // the standard scatter-width of the pool is the initial average
+    uint64_t sum = 0;
+    uint32_t count = 0;
+    for (auto &item : copysetsInChunkServer_) {
+        std::map<ChunkServerIdType, int> scatterMap;
+        GetChunkServerScatterMap(item.first, &scatterMap);
+        sum += scatterMap.size();
+        count++;
+    }
+    scatterWidth_ = count == 0 ? 0 : sum / count;
+    UpdateChunkServerStat();
+}
+
+void FakeCluster::SetOffline(const std::vector<ChunkServerIdType> &ids) {
+    for (auto id : ids) {
+        auto it = chunkServers_.find(id);
+        if (it != chunkServers_.end()) {
+            it->second.state = OnlineState::OFFLINE;
+        }
+    }
+    for (auto &item : copysets_) {
+        ElectLeader(&item.second);
+    }
+    UpdateChunkServerStat();
+}
+
+std::vector<ChunkServerIdType> FakeCluster::GetChunkServersInServer(
+    ServerIdType id) const {
+    std::vector<ChunkServerIdType> ids;
+    for (auto &item : chunkServers_) {
+        if (item.second.info.serverId == id) {
+            ids.emplace_back(item.first);
+        }
+    }
+    return ids;
+}
+
+int FakeCluster::Heartbeat(
+    uint64_t nowSec, uint64_t bandwidthMBps,
+    const std::shared_ptr<OperatorController> &opController) {
+    int inProgress = 0;
+    for (auto &item : copysets_) {
+        CopySetInfo &info = item.second;
+        // no heartbeat without leader
+        if (!ElectLeader(&info)) {
+            continue;
+        }
+
+        auto change = changes_.find(item.first);
+        if (change != changes_.end() && change->second.finishSec <= nowSec) {
+            FinishChange(change->second, &info);
+            changes_.erase(change);
+        }
+
+        CopySetConf conf;
+        if (opController->ApplyOperator(Report(info), &conf) &&
+            changes_.count(item.first) == 0) {
+            StartChange(conf, nowSec, bandwidthMBps);
+        }
+        if (changes_.count(item.first) > 0) {
+            inProgress++;
+        }
+    }
+    UpdateChunkServerStat();
+    return inProgress;
+}
+
+CopySetInfo FakeCluster::Report(const CopySetInfo &info) const {
+    CopySetInfo report = info;
+    auto it = changes_.find(info.id);
+    if (it == changes_.end()) {
+        return report;
+    }
+
+    const CopySetConf &conf = it->second.conf;
+    auto cs = chunkServers_.find(conf.configChangeItem);
+    if (cs != chunkServers_.end()) {
+        report.candidatePeerInfo = cs->second.info;
+    }
+    auto *peer = new ::curve::common::Peer();
+    peer->set_id(conf.configChangeItem);
+    peer->set_address(report.candidatePeerInfo.ip + ":" +
+                      std::to_string(report.candidatePeerInfo.port) + ":0");
+    report.configChangeInfo.set_allocated_peer(peer);
+    report.configChangeInfo.set_type(conf.type);
+    report.configChangeInfo.set_finished(false);
+    return report;
+}
+
+void FakeCluster::StartChange(const CopySetConf &conf, uint64_t nowSec,
+                              uint64_t bandwidthMBps) {
+    uint64_t costSec = 0;
+    if (conf.type == ConfigChangeType::ADD_PEER ||
+        conf.type == ConfigChangeType::CHANGE_PEER) {
+        uint64_t bandwidth = std::max<uint64_t>(bandwidthMBps, 1);
+        costSec = (shape_.copysetSizeMB + bandwidth - 1) / bandwidth;
+    }
+    changes_[conf.id] = Change{conf, nowSec + costSec};
+}
+
+void FakeCluster::FinishChange(const Change &change, CopySetInfo *info) {
+    const CopySetConf &conf = change.conf;
+    ChunkServerIdType item = conf.configChangeItem;
+    auto removePeer = [&](ChunkServerIdType id) {
+        info->peers.erase(
+            std::remove_if(info->peers.begin(), info->peers.end(),
+                           [id](const PeerInfo &p) { return p.id == id; }),
+            info->peers.end());
+        copysetsInChunkServer_[id].erase(info->id);
+    };
+    auto addPeer = [&](ChunkServerIdType id) {
+        info->peers.emplace_back(chunkServers_[id].info);
+        copysetsInChunkServer_[id].emplace(info->id);
+    };
+
+    switch (conf.type) {
+        case ConfigChangeType::TRANSFER_LEADER:
+            info->leader = item;
+            stat_.transferLeaderNum++;
+            break;
+        case ConfigChangeType::ADD_PEER:
+            addPeer(item);
+            stat_.addPeerNum++;
+            stat_.movedMB += shape_.copysetSizeMB;
+            break;
+        case ConfigChangeType::REMOVE_PEER:
+            removePeer(item);
+            stat_.removePeerNum++;
+            break;
+        case ConfigChangeType::CHANGE_PEER:
+            removePeer(conf.oldOne);
+            addPeer(item);
+            stat_.changePeerNum++;
+            stat_.movedMB += shape_.copysetSizeMB;
+            break;
+        default:
+            return;
+    }
+    info->epoch++;
+    ElectLeader(info);
+}
+
+bool FakeCluster::ElectLeader(CopySetInfo *info) const {
+    auto online = [this](ChunkServerIdType id) {
+        auto it = chunkServers_.find(id);
+        return it != chunkServers_.end() && it->second.IsOnline();
+    };
+    int onlineNum = 0;
+    for (auto &peer : info->peers) {
+        onlineNum += online(peer.id) ? 1 : 0;
+    }
+    if (onlineNum < static_cast<int>(info->peers.size() / 2 + 1)) {
+        return false;
+    }
+    if (info->ContainPeer(info->leader) && online(info->leader)) {
+        return true;
+    }
+    for (auto &peer : info->peers) {
+        if (online(peer.id)) {
+            info->leader = peer.id;
+            return true;
+        }
+    }
+    return false;
+}
+
+void FakeCluster::UpdateChunkServerStat() {
+    for (auto &item : chunkServers_) {
+        item.second.leaderCount = 0;
+        item.second.diskUsed = 0;
+    }
+    for (auto &item : copysets_) {
+        for (auto &peer : item.second.peers) {
+            chunkServers_[peer.id].diskUsed += shape_.copysetSizeMB;
+        }
+        auto leader = chunkServers_.find(item.second.leader);
+        if (leader != chunkServers_.end() && leader->second.IsOnline()) {
+            leader->second.leaderCount++;
+        }
+    }
+}
+
+std::vector<PoolIdType> FakeCluster::GetLogicalpools() {
+    return std::vector<PoolIdType>{poolId_};
+}
+
+bool FakeCluster::GetLogicalPool(PoolIdType id,
+                                 ::curve::mds::topology::LogicalPool *lpool) {
+    if (id != poolId_) {
+        return false;
+    }
+    LogicalPool::RedundanceAndPlaceMentPolicy rap;
+    rap.pageFileRAP.copysetNum = copysets_.size();
+    rap.pageFileRAP.replicaNum = shape_.replicaNum;
+    rap.pageFileRAP.zoneNum = shape_.replicaNum;
+    LogicalPool pool(poolId_, "pool", 1, LogicalPoolType::PAGEFILE, rap,
+                     LogicalPool::UserPolicy{}, 0, true, true);
+    pool.SetScatterWidth(scatterWidth_);
+    *lpool = pool;
+    return true;
+}
+
+bool FakeCluster::GetCopySetInfo(const CopySetKey &id, CopySetInfo *info) {
+    auto it = copysets_.find(id);
+    if (it == copysets_.end()) {
+        return false;
+    }
+    *info = Report(it->second);
+    return true;
+}
+
+std::vector<CopySetInfo> FakeCluster::GetCopySetInfos() {
+    std::vector<CopySetInfo> infos;
+    infos.reserve(copysets_.size());
+    for (auto &item : copysets_) {
+        infos.emplace_back(Report(item.second));
+    }
+    return infos;
+}
+
+std::vector<CopySetInfo> FakeCluster::GetCopySetInfosInChunkServer(
+    ChunkServerIdType id) {
+    std::vector<CopySetInfo> infos;
+    auto it = copysetsInChunkServer_.find(id);
+    if (it == copysetsInChunkServer_.end()) {
+        return infos;
+    }
+    for (auto &key : it->second) {
+        infos.emplace_back(Report(copysets_[key]));
+    }
+    return infos;
+}
+
+std::vector<CopySetInfo> FakeCluster::GetCopySetInfosInLogicalPool(
+    PoolIdType lid) {
+    return lid == poolId_ ? GetCopySetInfos() : std::vector<CopySetInfo>{};
+}
+
+bool FakeCluster::GetChunkServerInfo(ChunkServerIdType id,
+                                     ChunkServerInfo *info) {
+    auto it = chunkServers_.find(id);
+    if (it == chunkServers_.end()) {
+        return false;
+    }
+    *info = it->second;
+    return true;
+}
+
+std::vector<ChunkServerInfo> FakeCluster::GetChunkServerInfos() {
+    std::vector<ChunkServerInfo> infos;
+    infos.reserve(chunkServers_.size());
+    for (auto &item : chunkServers_) {
+        infos.emplace_back(item.second);
+    }
+    return infos;
+}
+
+std::vector<ChunkServerInfo> FakeCluster::GetChunkServersInLogicalPool(
+    PoolIdType lid) {
+    return lid == poolId_ ? GetChunkServerInfos()
+                          : std::vector<ChunkServerInfo>{};
+}
+
+int FakeCluster::GetStandardZoneNumInLogicalPool(PoolIdType id) {
+    return shape_.replicaNum;
+}
+
+int FakeCluster::GetStandardReplicaNumInLogicalPool(PoolIdType id) {
+    return shape_.replicaNum;
+}
+
+int FakeCluster::GetAvgScatterWidthInLogicalPool(PoolIdType id) {
+    return scatterWidth_;
+}
+
+bool FakeCluster::CreateCopySetAtChunkServer(CopySetKey id,
+                                             ChunkServerIdType csID) {
+    return true;
+}
+
+bool FakeCluster::CopySetFromTopoToSchedule(
+    const ::curve::mds::topology::CopySetInfo &origin,
+    ::curve::mds::schedule::CopySetInfo *out) {
+    return GetCopySetInfo(origin.GetCopySetKey(), out);
+}
+
+bool FakeCluster::ChunkServerFromTopoToSchedule(
+    const ::curve::mds::topology::ChunkServer &origin,
+    ::curve::mds::schedule::ChunkServerInfo *out) {
+    return GetChunkServerInfo(origin.GetId(), out);
+}
+
+void FakeCluster::GetChunkServerScatterMap(
+    const ChunkServerIdType &cs, std::map<ChunkServerIdType, int> *out) {
+    auto it = copysetsInChunkServer_.find(cs);
+    if (it == copysetsInChunkServer_.end()) {
+        return;
+    }
+    for (auto &key : it->second) {
+        for (auto &peer : copysets_[key].peers) {
+            if (peer.id == cs || chunkServers_[peer.id].IsOffline()) {
+                continue;
+            }
+            (*out)[peer.id]++;
+        }
+    }
+}
+
+std::map<CopySetKey, CopysetStatistics>
+FakeCluster::GetCopySetStatsInLogicalPool(PoolIdType lid) {
+    std::map<CopySetKey, CopysetStatistics> stats;
+    for (auto &item : copysets_) {
+        if (chunkServers_[item.second.leader].IsOnline()) {
+            stats.emplace(item.first, item.second.statisticsInfo);
+        }
+    }
+    return stats;
+}
+
+}  // namespace schedule
+}  // namespace mds
+}  // namespace curve
@@ -0,0 +1,174 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef TEST_MDS_SCHEDULE_SCHEDULESIMULATOR_FAKE_CLUSTER_H_
+#define TEST_MDS_SCHEDULE_SCHEDULESIMULATOR_FAKE_CLUSTER_H_
+
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "src/mds/schedule/operatorController.h"
+#include "src/mds/schedule/topoAdapter.h"
+
+namespace curve {
+namespace mds {
+namespace schedule {
+
+struct ClusterShape {
+    uint32_t zoneNum = 3;
+    uint32_t serverNumPerZone = 3;
+    uint32_t chunkServerNumPerServer = 20;
+    uint32_t copysetNum = 6000;
+    uint32_t replicaNum = 3;
+    // the servers without copysets at the beginning, e.g. just added
+    uint32_t emptyServerNum = 0;
+    // capacity of a chunkserver and size of a copyset
+    uint64_t diskCapacityMB = 4 * 1024 * 1024;
+    uint64_t copysetSizeMB = 1024;
+    // average iops of a copyset, exponentially distributed
+    uint32_t avgCopysetIops = 100;
+    uint32_t seed = 1;
+};
+
+struct ClusterStat {
+    // config changes started by the schedulers and finished by chunkservers
+    uint64_t transferLeaderNum = 0;
+    uint64_t addPeerNum = 0;
+    uint64_t removePeerNum = 0;
+    uint64_t changePeerNum = 0;
+    // data copied to the new replicas
+    uint64_t movedMB = 0;
+};
+
+/**
+ * An in-memory cluster serving the schedulers through TopoAdapter, and
+ * executing the configuration changes they order through heartbeats like
+ * chunkservers do: a change is reported as the candidate until it is done,
+ * data copying takes copysetSizeMB / bandwidth, the others take one round.
+ */
+class FakeCluster : public TopoAdapter {
+ public:
+    explicit FakeCluster(const ClusterShape &shape);
+
+    // mark chunkservers offline, the leaders move to the online peers
+    void SetOffline(const std::vector<ChunkServerIdType> &ids);
+
+    /**
+     * @brief one round of heartbeats of all copysets, which drives the
+     *        operators in opController
+     *
+     * @param[in] nowSec virtual time of the round
+     * @param[in] bandwidthMBps bandwidth of copying data to a new replica
+     * @param[in] opController the operators to apply
+     *
+     * @return number of config changes in progress after this round
+     */
+    int Heartbeat(uint64_t nowSec, uint64_t bandwidthMBps,
+                  const std::shared_ptr<OperatorController> &opController);
+
+    const ClusterStat &GetStat() const { return stat_; }
+
+    std::vector<ChunkServerIdType> GetChunkServersInServer(
+        ServerIdType id) const;
+
+    std::vector<PoolIdType> GetLogicalpools() override;
+
+    bool GetLogicalPool(PoolIdType id,
+                        ::curve::mds::topology::LogicalPool *lpool) override;
+
+    bool GetCopySetInfo(const CopySetKey &id, CopySetInfo *info) override;
+
+    std::vector<CopySetInfo> GetCopySetInfos() override;
+
+    std::vector<CopySetInfo> GetCopySetInfosInChunkServer(
+        ChunkServerIdType id) override;
+
+    std::vector<CopySetInfo> GetCopySetInfosInLogicalPool(
+        PoolIdType lid) override;
+
+    bool GetChunkServerInfo(ChunkServerIdType id,
+                            ChunkServerInfo *info) override;
+
+    std::vector<ChunkServerInfo> GetChunkServerInfos() override;
+
+    std::vector<ChunkServerInfo> GetChunkServersInLogicalPool(
+        PoolIdType lid) override;
+
+    int GetStandardZoneNumInLogicalPool(PoolIdType id) override;
+
+    int GetStandardReplicaNumInLogicalPool(PoolIdType id) override;
+
+    int GetAvgScatterWidthInLogicalPool(PoolIdType id) override;
+
+    bool CreateCopySetAtChunkServer(CopySetKey id,
+                                    ChunkServerIdType csID) override;
+
+    bool CopySetFromTopoToSchedule(
+        const ::curve::mds::topology::CopySetInfo &origin,
+        ::curve::mds::schedule::CopySetInfo *out) override;
+
+    bool ChunkServerFromTopoToSchedule(
+        const ::curve::mds::topology::ChunkServer &origin,
+        ::curve::mds::schedule::ChunkServerInfo *out) override;
+
+    void GetChunkServerScatterMap(
+        const ChunkServerIdType &cs,
+        std::map<ChunkServerIdType, int> *out) override;
+
+    std::map<CopySetKey, CopysetStatistics> GetCopySetStatsInLogicalPool(
+        PoolIdType lid) override;
+
+ private:
+    // a config change ordered by mds and executed by the copyset
+    struct Change {
+        CopySetConf conf;
+        uint64_t finishSec;
+    };
+
+    // the copyset info reported in heartbeat
+    CopySetInfo Report(const CopySetInfo &info) const;
+
+    void StartChange(const CopySetConf &conf, uint64_t nowSec,
+                     uint64_t bandwidthMBps);
+
+    void FinishChange(const Change &change, CopySetInfo *info);
+
+    // elect a new leader if the leader is offline, false if no quorum
+    bool ElectLeader(CopySetInfo *info) const;
+
+    // leader number and disk used of chunkservers
+    void UpdateChunkServerStat();
+
+ private:
+    const ClusterShape shape_;
+    const PoolIdType poolId_ = 1;
+    int scatterWidth_;
+
+    std::map<ChunkServerIdType, ChunkServerInfo> chunkServers_;
+    std::map<CopySetKey, CopySetInfo> copysets_;
+    std::map<ChunkServerIdType, std::set<CopySetKey>> copysetsInChunkServer_;
+    std::map<CopySetKey, Change> changes_;
+    ClusterStat stat_;
+};
+
+}  // namespace schedule
+}  // namespace mds
+}  // namespace curve
+
+#endif  // TEST_MDS_SCHEDULE_SCHEDULESIMULATOR_FAKE_CLUSTER_H_
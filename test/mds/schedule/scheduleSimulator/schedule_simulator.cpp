@@ -0,0 +1,343 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Offline simulator of the mds schedulers. The schedulers run against
+ * FakeCluster in virtual rounds, e.g. to see how a host failure is recovered
+ * (more offline chunkservers on a server than the failure tolerance are not
+ * recovered, as mds does):
+ *
+ *   schedule_simulator --offline_server_num=1 --rounds=2000 \
+ *       --chunkserver_failure_tolerance=20
+ *
+ * or how the copysets are balanced after expansion:
+ *
+ *   schedule_simulator --empty_server_num=3 --rounds=5000
+ */
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/mds/schedule/scheduleMetrics.h"
+#include "src/mds/schedule/scheduler.h"
+#include "test/mds/mock/mock_topology.h"
+#include "test/mds/schedule/scheduleSimulator/fake_cluster.h"
+
+DEFINE_uint32(zone_num, 3, "zone number of the cluster");
+DEFINE_uint32(server_num_per_zone, 3, "server number in each zone");
+DEFINE_uint32(chunkserver_num_per_server, 20,
+              "chunkserver number on each server");
+DEFINE_uint32(copyset_num, 6000, "copyset number of the logical pool");
+DEFINE_uint32(replica_num, 3, "replica number of copysets");
+DEFINE_uint32(empty_server_num, 0,
+              "servers without copysets at the beginning, as expanded");
+DEFINE_uint32(offline_server_num, 0,
+              "servers offline at the beginning, as failed hosts");
+DEFINE_uint32(offline_chunkserver_num, 0,
+              "chunkservers offline at the beginning, on the first server "
+              "after the offline servers");
+DEFINE_uint64(copyset_size_mb, 1024, "data size of a copyset");
+DEFINE_uint32(avg_copyset_iops, 100, "average write iops of copysets");
+DEFINE_uint32(seed, 1, "seed of the random placement and load");
+
+DEFINE_uint64(rounds, 1000, "virtual rounds to run");
+DEFINE_uint64(round_sec, 10, "virtual seconds of a round");
+DEFINE_uint64(bandwidth_mbps, 50, "bandwidth of copying a copyset");
+
+DEFINE_uint32(operator_concurrent, 1, "same as mds.schedule.operatorConcurrent");
+DEFINE_bool(enable_copyset_scheduler, true, "enable copyset scheduler");
+DEFINE_bool(enable_leader_scheduler, true, "enable leader scheduler");
+DEFINE_bool(enable_replica_scheduler, true, "enable replica scheduler");
+DEFINE_bool(enable_recover_scheduler, true, "enable recover scheduler");
+DEFINE_bool(enable_leader_load_scheduler, false,
+            "enable leader load scheduler");
+DEFINE_uint32(copyset_interval_sec, 5, "interval of copyset scheduler");
+DEFINE_uint32(leader_interval_sec, 30, "interval of leader scheduler");
+DEFINE_uint32(replica_interval_sec, 5, "interval of replica scheduler");
+DEFINE_uint32(recover_interval_sec, 5, "interval of recover scheduler");
+DEFINE_uint32(leader_load_interval_sec, 60,
+              "interval of leader load scheduler");
+DEFINE_double(copyset_num_range_percent, 0.05,
+              "same as mds.copyset.scheduler.balanceRatioPercent");
+DEFINE_double(scatter_width_range_percent, 0.2,
+              "same as mds.schedule.scatterWidthRangePerent");
+DEFINE_double(leader_load_range_percent, 0.2,
+              "same as mds.leaderload.scheduler.rangePercent");
+// the cooling of leader load scheduler is in wall time, which is not
+// virtualized, so it is disabled by default
+DEFINE_uint32(leader_load_cooling_sec, 0,
+              "same as mds.leaderload.scheduler.coolingTimeSec");
+DEFINE_uint32(chunkserver_failure_tolerance, 3,
+              "same as mds.chunkserver.failure.tolerance");
+DEFINE_uint32(recover_concurrent_per_chunkserver, 4,
+              "same as mds.recover.concurrent.per.chunkserver");
+DEFINE_uint32(recover_concurrent_per_server, 16,
+              "same as mds.recover.concurrent.per.server");
+DEFINE_uint32(recover_concurrent_per_zone, 0,
+              "same as mds.recover.concurrent.per.zone");
+
+using ::curve::mds::schedule::ChunkServerIdType;
+using ::curve::mds::schedule::ClusterShape;
+using ::curve::mds::schedule::ClusterStat;
+using ::curve::mds::schedule::FakeCluster;
+using ::curve::mds::schedule::OperatorController;
+using ::curve::mds::schedule::ScheduleMetrics;
+using ::curve::mds::schedule::ScheduleOption;
+using ::curve::mds::schedule::Scheduler;
+using ::curve::mds::topology::MockTopology;
+
+namespace {
+
+struct Distribution {
+    double avg = 0;
+    double stddev = 0;
+    double min = 0;
+    double max = 0;
+};
+
+Distribution Distribute(const std::vector<double> &values) {
+    Distribution dist;
+    if (values.empty()) {
+        return dist;
+    }
+    dist.min = *std::min_element(values.begin(), values.end());
+    dist.max = *std::max_element(values.begin(), values.end());
+    for (double v : values) {
+        dist.avg += v;
+    }
+    dist.avg /= values.size();
+    for (double v : values) {
+        dist.stddev += (v - dist.avg) * (v - dist.avg);
+    }
+    dist.stddev = std::sqrt(dist.stddev / values.size());
+    return dist;
+}
+
+void PrintDistribution(const std::string &name, const Distribution &dist) {
+    std::cout << std::left << std::setw(16) << name << std::fixed
+              << std::setprecision(2) << "avg " << std::setw(10) << dist.avg
+              << "stddev " << std::setw(10) << dist.stddev << "min "
+              << std::setw(10) << dist.min << "max " << dist.max << std::endl;
+}
+
+// balance of the online chunkservers
+void PrintBalance(const std::string &title, FakeCluster *cluster) {
+    std::map<ChunkServerIdType, double> copysetNum;
+    std::map<ChunkServerIdType, double> leaderNum;
+    std::map<ChunkServerIdType, double> leaderIops;
+    for (auto &csInfo : cluster->GetChunkServerInfos()) {
+        if (csInfo.IsOffline()) {
+            continue;
+        }
+        copysetNum[csInfo.info.id] = 0;
+        leaderNum[csInfo.info.id] = 0;
+        leaderIops[csInfo.info.id] = 0;
+    }
+
+    int unhealthy = 0;
+    for (auto &info : cluster->GetCopySetInfos()) {
+        bool healthy = info.peers.size() == FLAGS_replica_num;
+        for (auto &peer : info.peers) {
+            auto it = copysetNum.find(peer.id);
+            if (it == copysetNum.end()) {
+                healthy = false;
+                continue;
+            }
+            it->second++;
+        }
+        unhealthy += healthy ? 0 : 1;
+        if (leaderNum.count(info.leader) > 0) {
+            leaderNum[info.leader]++;
+            leaderIops[info.leader] += info.statisticsInfo.writeiops();
+        }
+    }
+
+    std::vector<double> copysets, leaders, iops, scatterWidths;
+    for (auto &item : copysetNum) {
+        copysets.emplace_back(item.second);
+        leaders.emplace_back(leaderNum[item.first]);
+        iops.emplace_back(leaderIops[item.first]);
+        std::map<ChunkServerIdType, int> scatterMap;
+        cluster->GetChunkServerScatterMap(item.first, &scatterMap);
+        scatterWidths.emplace_back(scatterMap.size());
+    }
+
+    std::cout << "==== " << title << ": " << copysetNum.size()
+              << " online chunkservers, " << unhealthy
+              << " unhealthy copysets" << std::endl;
+    PrintDistribution("copyset num", Distribute(copysets));
+    PrintDistribution("leader num", Distribute(leaders));
+    PrintDistribution("scatter width", Distribute(scatterWidths));
+    PrintDistribution("leader iops", Distribute(iops));
+}
+
+ScheduleOption GetScheduleOption() {
+    ScheduleOption opt;
+    opt.enableCopysetScheduler = FLAGS_enable_copyset_scheduler;
+    opt.enableLeaderScheduler = FLAGS_enable_leader_scheduler;
+    opt.enableRecoverScheduler = FLAGS_enable_recover_scheduler;
+    opt.enableReplicaScheduler = FLAGS_enable_replica_scheduler;
+    opt.enableScanScheduler = false;
+    opt.enableLeaderLoadScheduler = FLAGS_enable_leader_load_scheduler;
+    opt.copysetSchedulerIntervalSec = FLAGS_copyset_interval_sec;
+    opt.leaderSchedulerIntervalSec = FLAGS_leader_interval_sec;
+    opt.recoverSchedulerIntervalSec = FLAGS_recover_interval_sec;
+    opt.replicaSchedulerIntervalSec = FLAGS_replica_interval_sec;
+    opt.scanSchedulerIntervalSec = 60;
+    opt.leaderLoadSchedulerIntervalSec = FLAGS_leader_load_interval_sec;
+    opt.operatorConcurrent = FLAGS_operator_concurrent;
+    // the operators timeout in wall time, long enough for a simulation
+    opt.transferLeaderTimeLimitSec = 3600;
+    opt.addPeerTimeLimitSec = 3600;
+    opt.removePeerTimeLimitSec = 3600;
+    opt.changePeerTimeLimitSec = 3600;
+    opt.scanPeerTimeLimitSec = 3600;
+    opt.copysetNumRangePercent = FLAGS_copyset_num_range_percent;
+    opt.scatterWithRangePerent = FLAGS_scatter_width_range_percent;
+    opt.leaderLoadRangePercent = FLAGS_leader_load_range_percent;
+    opt.leaderLoadCoolingTimeSec = FLAGS_leader_load_cooling_sec;
+    opt.chunkserverFailureTolerance = FLAGS_chunkserver_failure_tolerance;
+    opt.chunkserverCoolingTimeSec = 0;
+    opt.scanStartHour = 0;
+    opt.scanEndHour = 0;
+    opt.scanIntervalSec = 0;
+    opt.scanConcurrentPerPool = 0;
+    opt.scanConcurrentPerChunkserver = 0;
+    opt.recoverConcurrentPerChunkServer =
+        FLAGS_recover_concurrent_per_chunkserver;
+    opt.recoverConcurrentPerServer = FLAGS_recover_concurrent_per_server;
+    opt.recoverConcurrentPerZone = FLAGS_recover_concurrent_per_zone;
+    return opt;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    google::ParseCommandLineFlags(&argc, &argv, false);
+    google::InitGoogleLogging(argv[0]);
+
+    ClusterShape shape;
+    shape.zoneNum = FLAGS_zone_num;
+    shape.serverNumPerZone = FLAGS_server_num_per_zone;
+    shape.chunkServerNumPerServer = FLAGS_chunkserver_num_per_server;
+    shape.copysetNum = FLAGS_copyset_num;
+    shape.replicaNum = FLAGS_replica_num;
+    shape.emptyServerNum = FLAGS_empty_server_num;
+    shape.copysetSizeMB = FLAGS_copyset_size_mb;
+    shape.avgCopysetIops = FLAGS_avg_copyset_iops;
+    shape.seed = FLAGS_seed;
+    if (shape.zoneNum < shape.replicaNum) {
+        std::cerr << "zone_num should not be less than replica_num"
+                  << std::endl;
+        return -1;
+    }
+    auto cluster = std::make_shared<FakeCluster>(shape);
+
+    std::vector<ChunkServerIdType> offlines;
+    for (uint32_t s = 1; s <= FLAGS_offline_server_num + 1; s++) {
+        auto ids = cluster->GetChunkServersInServer(s);
+        if (s == FLAGS_offline_server_num + 1) {
+            ids.resize(std::min<size_t>(ids.size(),
+                                        FLAGS_offline_chunkserver_num));
+        }
+        offlines.insert(offlines.end(), ids.begin(), ids.end());
+    }
+    cluster->SetOffline(offlines);
+    PrintBalance("initial", cluster.get());
+
+    // the metrics calls topology, which the fake cluster does not provide
+    auto topo = std::make_shared<::testing::NiceMock<MockTopology>>();
+    auto metrics = std::make_shared<ScheduleMetrics>(topo);
+    ScheduleOption opt = GetScheduleOption();
+    auto opController =
+        std::make_shared<OperatorController>(opt.operatorConcurrent, metrics);
+
+    std::map<std::string, std::shared_ptr<Scheduler>> schedulers;
+    if (opt.enableRecoverScheduler) {
+        schedulers["recover"] = std::make_shared<
+            ::curve::mds::schedule::RecoverScheduler>(opt, cluster,
+                                                      opController);
+    }
+    if (opt.enableReplicaScheduler) {
+        schedulers["replica"] = std::make_shared<
+            ::curve::mds::schedule::ReplicaScheduler>(opt, cluster,
+                                                      opController);
+    }
+    if (opt.enableCopysetScheduler) {
+        schedulers["copyset"] = std::make_shared<
+            ::curve::mds::schedule::CopySetScheduler>(opt, cluster,
+                                                      opController);
+    }
+    if (opt.enableLeaderScheduler) {
+        schedulers["leader"] = std::make_shared<
+            ::curve::mds::schedule::LeaderScheduler>(opt, cluster,
+                                                     opController);
+    }
+    if (opt.enableLeaderLoadScheduler) {
+        schedulers["leaderload"] = std::make_shared<
+            ::curve::mds::schedule::LeaderLoadScheduler>(opt, cluster,
+                                                         opController);
+    }
+    uint64_t maxInterval = FLAGS_round_sec;
+    for (auto &item : schedulers) {
+        maxInterval = std::max<uint64_t>(maxInterval,
+                                         item.second->GetRunningInterval());
+    }
+
+    // the cluster converges when there is no operator for the longest
+    // interval of the schedulers
+    uint64_t lastBusySec = 0;
+    uint64_t nowSec = 0;
+    for (uint64_t round = 1; round <= FLAGS_rounds; round++) {
+        nowSec = round * FLAGS_round_sec;
+        for (auto &item : schedulers) {
+            uint64_t interval = item.second->GetRunningInterval();
+            if (interval == 0 || nowSec % interval < FLAGS_round_sec) {
+                item.second->Schedule();
+            }
+        }
+        int inProgress =
+            cluster->Heartbeat(nowSec, FLAGS_bandwidth_mbps, opController);
+        if (inProgress > 0 || !opController->GetOperators().empty()) {
+            lastBusySec = nowSec;
+        }
+    }
+
+    PrintBalance("final", cluster.get());
+    const ClusterStat &stat = cluster->GetStat();
+    std::cout << "==== operators: transferleader " << stat.transferLeaderNum
+              << ", addpeer " << stat.addPeerNum << ", removepeer "
+              << stat.removePeerNum << ", changepeer " << stat.changePeerNum
+              << ", moved " << stat.movedMB << " MB" << std::endl;
+    if (nowSec - lastBusySec >= maxInterval) {
+        std::cout << "==== converged in " << lastBusySec << " seconds"
+                  << std::endl;
+    } else {
+        std::cout << "==== not converged in " << nowSec << " seconds"
+                  << std::endl;
+    }
+    return 0;
+}
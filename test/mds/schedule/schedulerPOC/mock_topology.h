@@ -177,6 +177,8 @@ class MockStorage : public TopologyStorage {
         const ChunkServer &data));
     MOCK_METHOD1(UpdateCopySet, bool(
         const ::curve::mds::topology::CopySetInfo &data));
+    MOCK_METHOD1(UpdateCopySets, bool(
+        const std::vector<::curve::mds::topology::CopySetInfo> &datas));
 
     MOCK_METHOD1(LoadClusterInfo,
         bool(std::vector<ClusterInformation> *info));
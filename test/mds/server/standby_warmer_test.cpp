@@ -0,0 +1,305 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <map>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "src/common/namespace_define.h"
+#include "src/mds/nameserver2/helper/namespace_helper.h"
+#include "src/mds/server/standby_warmer.h"
+#include "test/mds/mock/mock_etcdclient.h"
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Matcher;
+using ::testing::Return;
+using ::testing::SetArgPointee;
+using ::testing::DoAll;
+
+namespace curve {
+namespace mds {
+
+namespace {
+
+using KVs = std::vector<std::pair<std::string, std::string>>;
+
+// the revisions of etcd, the watch returns all the changes since a revision
+class FakeEtcdLog {
+ public:
+    explicit FakeEtcdLog(int64_t revision)
+        : revision_(revision), compacted_(0) {}
+
+    int64_t Put(const std::string &key, const std::string &value) {
+        std::lock_guard<std::mutex> lk(mtx_);
+        WatchEvent event;
+        event.key = key;
+        event.value = value;
+        events_.emplace(++revision_, event);
+        return revision_;
+    }
+
+    int64_t Delete(const std::string &key, const std::string &prev) {
+        std::lock_guard<std::mutex> lk(mtx_);
+        WatchEvent event;
+        event.deleted = true;
+        event.key = key;
+        event.value = prev;
+        events_.emplace(++revision_, event);
+        return revision_;
+    }
+
+    void Compact() {
+        std::lock_guard<std::mutex> lk(mtx_);
+        compacted_ = revision_;
+    }
+
+    int64_t Revision() {
+        std::lock_guard<std::mutex> lk(mtx_);
+        return revision_;
+    }
+
+    int Watch(const std::string &start, const std::string &end,
+              int64_t startRevision, int timeoutMs,
+              std::vector<WatchEvent> *events, int64_t *revision) {
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            if (startRevision <= compacted_) {
+                *revision = compacted_;
+                return EtcdErrCode::EtcdOutOfRange;
+            }
+            for (auto it = events_.lower_bound(startRevision);
+                 it != events_.end(); ++it) {
+                if (it->second.key >= start && it->second.key < end) {
+                    events->push_back(it->second);
+                    *revision = it->first;
+                }
+            }
+        }
+        if (!events->empty()) {
+            return EtcdErrCode::EtcdOK;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        return EtcdErrCode::EtcdDeadlineExceeded;
+    }
+
+ private:
+    std::mutex mtx_;
+    int64_t revision_;
+    int64_t compacted_;
+    std::map<int64_t, WatchEvent> events_;
+};
+
+std::string EncodeFile(InodeID id, InodeID parentid, const std::string &name) {
+    FileInfo info;
+    info.set_id(id);
+    info.set_parentid(parentid);
+    info.set_filename(name);
+    info.set_filetype(FileType::INODE_PAGEFILE);
+    std::string out;
+    NameSpaceStorageCodec::EncodeFileInfo(info, &out);
+    return out;
+}
+
+}  // namespace
+
+class TestStandbyWarmer : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        client_ = std::make_shared<MockEtcdClient>();
+        cache_ = std::make_shared<LRUCache>(16);
+        FileInfoCacheOption cacheOption;
+        cacheOption.fileCount = 16;
+        cacheOption.dirCount = 16;
+        fileInfoCache_ = std::make_shared<FileInfoCache>(cacheOption);
+        log_ = std::make_shared<FakeEtcdLog>(10);
+
+        StandbyWarmerOption option;
+        option.watchTimeoutMs = 10;
+        warmer_ = std::make_shared<StandbyWarmer>(client_, cache_,
+                                                  fileInfoCache_, option);
+
+        ON_CALL(*client_, GetCurrentRevision(_))
+            .WillByDefault(Invoke([this](int64_t *revision) {
+                *revision = log_->Revision();
+                return EtcdErrCode::EtcdOK;
+            }));
+        ON_CALL(*client_, Watch(_, _, _, _, _, _))
+            .WillByDefault(Invoke(log_.get(), &FakeEtcdLog::Watch));
+        ON_CALL(*client_, PutRewithRevision(_, _, _))
+            .WillByDefault(Invoke([this](const std::string &key,
+                                         const std::string &value,
+                                         int64_t *revision) {
+                *revision = log_->Put(key, value);
+                return EtcdErrCode::EtcdOK;
+            }));
+    }
+
+    void TearDown() override {
+        warmer_->Stop();
+    }
+
+ protected:
+    std::shared_ptr<MockEtcdClient> client_;
+    std::shared_ptr<LRUCache> cache_;
+    std::shared_ptr<FileInfoCache> fileInfoCache_;
+    std::shared_ptr<FakeEtcdLog> log_;
+    std::shared_ptr<StandbyWarmer> warmer_;
+};
+
+TEST_F(TestStandbyWarmer, WarmupAndTakeOver) {
+    std::atomic<bool> listed{false};
+    EXPECT_CALL(*client_, GetCurrentRevision(_)).Times(1);
+    EXPECT_CALL(*client_, List(::curve::common::LOGICALPOOLKEYPREFIX,
+                               ::curve::common::POOLSETKEYEND,
+                               Matcher<KVs *>(_)))
+        .WillOnce(Invoke([&](const std::string &, const std::string &,
+                             KVs *out) {
+            *out = KVs{{"1001a", "pool"}, {"1008b", "copyset-b"}};
+            listed = true;
+            return EtcdErrCode::EtcdOK;
+        }));
+    EXPECT_CALL(*client_, Watch(_, _, _, _, _, _)).Times(testing::AtLeast(1));
+    EXPECT_CALL(*client_, PutRewithRevision(
+                              ::curve::common::STANDBYFENCEKEY, _, _))
+        .Times(1);
+    warmer_->Start();
+    while (!listed.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::string fileKey = NameSpaceStorageCodec::EncodeFileStoreKey(1, "f");
+    std::string segmentKey =
+        NameSpaceStorageCodec::EncodeSegmentStoreKey(2, 0);
+    std::string staleKey = NameSpaceStorageCodec::EncodeFileStoreKey(1, "g");
+    log_->Put(fileKey, EncodeFile(2, 1, "f"));
+    log_->Put("1008c", "copyset-c");
+    log_->Delete("1001a", "pool");
+    log_->Put(segmentKey, "segment");
+    log_->Put(staleKey, EncodeFile(3, 1, "g"));
+    log_->Delete(staleKey, EncodeFile(3, 1, "g"));
+    // out of the watched range
+    log_->Put(::curve::common::SNAPINFOKEYPREFIX, "snap");
+
+    auto mirror = warmer_->TakeOver();
+    ASSERT_NE(nullptr, mirror);
+
+    // the namespace caches have the changes
+    FileInfo fileInfo;
+    ASSERT_TRUE(fileInfoCache_->GetFile(fileKey, &fileInfo));
+    ASSERT_EQ(2, fileInfo.id());
+    ASSERT_EQ("f", fileInfo.filename());
+    ASSERT_FALSE(fileInfoCache_->GetFile(staleKey, &fileInfo));
+    std::string value;
+    ASSERT_TRUE(cache_->Get(segmentKey, &value));
+    ASSERT_EQ("segment", value);
+
+    // topology is served from the mirror
+    std::vector<std::string> values;
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              mirror->List(::curve::common::COPYSETKEYPREFIX,
+                           ::curve::common::COPYSETKEYEND, &values));
+    ASSERT_EQ((std::vector<std::string>{"copyset-b", "copyset-c"}), values);
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              mirror->List(::curve::common::LOGICALPOOLKEYPREFIX,
+                           ::curve::common::LOGICALPOOLKEYEND, &values));
+    ASSERT_TRUE(values.empty());
+    ASSERT_EQ(EtcdErrCode::EtcdKeyNotExist, mirror->Get("1001a", &value));
+
+    // reads go to etcd after released
+    mirror->Release();
+    EXPECT_CALL(*client_, List(::curve::common::COPYSETKEYPREFIX,
+                               ::curve::common::COPYSETKEYEND,
+                               Matcher<std::vector<std::string> *>(_)))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              mirror->List(::curve::common::COPYSETKEYPREFIX,
+                           ::curve::common::COPYSETKEYEND, &values));
+}
+
+TEST_F(TestStandbyWarmer, SyncAgainAfterCompacted) {
+    std::atomic<int> listed{0};
+    EXPECT_CALL(*client_, GetCurrentRevision(_)).Times(2);
+    EXPECT_CALL(*client_, List(_, _, Matcher<KVs *>(_)))
+        .Times(2)
+        .WillRepeatedly(Invoke([&](const std::string &, const std::string &,
+                                   KVs *out) {
+            if (listed++ == 0) {
+                // the changes since then are compacted before watched
+                log_->Put("1008a", "copyset-a");
+                log_->Compact();
+                *out = KVs{{"1008old", "copyset-old"}};
+            } else {
+                *out = KVs{{"1008a", "copyset-a"}};
+            }
+            return EtcdErrCode::EtcdOK;
+        }));
+    EXPECT_CALL(*client_, Watch(_, _, _, _, _, _)).Times(testing::AtLeast(2));
+    EXPECT_CALL(*client_, PutRewithRevision(_, _, _)).Times(1);
+
+    // the caches are cleared when changes are lost
+    cache_->Put("stale", "value");
+    warmer_->Start();
+    while (listed.load() < 2) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    auto mirror = warmer_->TakeOver();
+    ASSERT_NE(nullptr, mirror);
+    std::string value;
+    ASSERT_FALSE(cache_->Get("stale", &value));
+    std::vector<std::string> values;
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              mirror->List(::curve::common::COPYSETKEYPREFIX,
+                           ::curve::common::COPYSETKEYEND, &values));
+    ASSERT_EQ(std::vector<std::string>{"copyset-a"}, values);
+}
+
+TEST_F(TestStandbyWarmer, TakeOverFail) {
+    // fail to put the fence
+    EXPECT_CALL(*client_, List(_, _, Matcher<KVs *>(_)))
+        .WillRepeatedly(Return(EtcdErrCode::EtcdOK));
+    EXPECT_CALL(*client_, Watch(_, _, _, _, _, _)).Times(testing::AnyNumber());
+    EXPECT_CALL(*client_, PutRewithRevision(_, _, _))
+        .WillOnce(Return(EtcdErrCode::EtcdUnavailable));
+    cache_->Put("key", "value");
+    warmer_->Start();
+    ASSERT_EQ(nullptr, warmer_->TakeOver());
+    std::string value;
+    ASSERT_FALSE(cache_->Get("key", &value));
+
+    // can not sync with etcd
+    auto warmer = std::make_shared<StandbyWarmer>(
+        client_, cache_, fileInfoCache_, StandbyWarmerOption());
+    EXPECT_CALL(*client_, GetCurrentRevision(_))
+        .WillRepeatedly(Return(EtcdErrCode::EtcdUnavailable));
+    EXPECT_CALL(*client_, PutRewithRevision(_, _, _))
+        .WillOnce(DoAll(SetArgPointee<2>(1), Return(EtcdErrCode::EtcdOK)));
+    warmer->Start();
+    ASSERT_EQ(nullptr, warmer->TakeOver());
+}
+
+}  // namespace mds
+}  // namespace curve
@@ -157,6 +157,8 @@ class MockStorage : public TopologyStorage {
                      const ChunkServer &data));
     MOCK_METHOD1(UpdateCopySet, bool(
                 const CopySetInfo &data));
+    MOCK_METHOD1(UpdateCopySets, bool(
+                const std::vector<CopySetInfo> &datas));
 
     MOCK_METHOD1(LoadClusterInfo,
                  bool(std::vector<ClusterInformation> *info));
@@ -386,6 +388,8 @@ class MockKVStorageClient : public KVStorageClient {
                            std::vector<std::pair<std::string, std::string>>*));
     MOCK_METHOD1(Delete, int(const std::string&));
     MOCK_METHOD1(TxnN, int(const std::vector<Operation>&));
+    MOCK_METHOD2(TxnNWithRevision, int(const std::vector<Operation>&,
+        int64_t*));
     MOCK_METHOD3(CompareAndSwap, int(const std::string&, const std::string&,
         const std::string&));
     MOCK_METHOD5(CampaignLeader, int(const std::string&, const std::string&,
@@ -22,6 +22,10 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+
 #include "test/mds/topology/mock_topology.h"
 #include "src/mds/topology/topology.h"
 #include "src/mds/topology/topology_item.h"
@@ -38,6 +42,7 @@ using ::testing::Contains;
 using ::testing::SetArgPointee;
 using ::testing::SaveArg;
 using ::testing::DoAll;
+using ::testing::Invoke;
 using ::curve::common::Configuration;
 using ::curve::common::kDefaultPoolsetId;
 using ::curve::common::kDefaultPoolsetName;
@@ -2926,6 +2931,149 @@ TEST_F(TestTopology, GetCopySetsInChunkServer_success) {
     ASSERT_EQ(1, csList.size());
 }
 
+TEST_F(TestTopology, CopySetsInShards_success) {
+    PrepareAddPoolset();
+    PoolIdType physicalPoolId = 0x11;
+    PrepareAddPhysicalPool(physicalPoolId);
+    PrepareAddZone(0x21, "zone1", physicalPoolId);
+    PrepareAddServer(
+        0x31, "server1", "127.0.0.1" , 0, "127.0.0.1" , 0, 0x21, 0x11);
+    PrepareAddChunkServer(0x41, "token1", "nvme", 0x31, "127.0.0.1", 8200);
+    PrepareAddChunkServer(0x42, "token2", "nvme", 0x31, "127.0.0.1", 8201);
+    PrepareAddLogicalPool(0x01, "logicalPool1", physicalPoolId);
+    PrepareAddLogicalPool(0x02, "logicalPool2", physicalPoolId);
+
+    // the copysets are spread over the shards
+    const CopySetIdType copysetNum = 200;
+    for (CopySetIdType id = copysetNum; id > 0; id--) {
+        PrepareAddCopySet(id, 0x01, {0x41});
+        PrepareAddCopySet(id, 0x02, {id % 2 == 0 ? 0x41u : 0x42u});
+    }
+
+    // the results are ordered by key
+    std::vector<CopySetKey> csList = topology_->GetCopySetsInCluster();
+    ASSERT_EQ(2 * copysetNum, csList.size());
+    ASSERT_TRUE(std::is_sorted(csList.begin(), csList.end()));
+    ASSERT_EQ(CopySetKey(0x01, 1), csList.front());
+    ASSERT_EQ(CopySetKey(0x02, copysetNum), csList.back());
+
+    std::vector<CopySetIdType> ids =
+        topology_->GetCopySetsInLogicalPool(0x02);
+    ASSERT_EQ(copysetNum, ids.size());
+    ASSERT_TRUE(std::is_sorted(ids.begin(), ids.end()));
+
+    std::vector<CopySetInfo> infos =
+        topology_->GetCopySetInfosInLogicalPool(0x02);
+    ASSERT_EQ(copysetNum, infos.size());
+    for (CopySetIdType i = 0; i < copysetNum; i++) {
+        ASSERT_EQ(i + 1, infos[i].GetId());
+    }
+
+    csList = topology_->GetCopySetsInChunkServer(0x42);
+    ASSERT_EQ(copysetNum / 2, csList.size());
+    ASSERT_TRUE(std::is_sorted(csList.begin(), csList.end()));
+
+    // update and read the copysets of the pools concurrently
+    std::vector<std::thread> threads;
+    for (PoolIdType pool = 0x01; pool <= 0x02; pool++) {
+        threads.emplace_back([this, pool, copysetNum]() {
+            for (CopySetIdType id = 1; id <= copysetNum; id++) {
+                CopySetInfo info(pool, id);
+                info.SetEpoch(id);
+                info.SetLeader(0x41);
+                info.SetCopySetMembers({0x41});
+                ASSERT_EQ(kTopoErrCodeSuccess,
+                          topology_->UpdateCopySetTopo(info));
+                CopySetInfo out;
+                ASSERT_TRUE(topology_->GetCopySet(CopySetKey(pool, id),
+                                                  &out));
+                ASSERT_EQ(id, out.GetEpoch());
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    ASSERT_EQ(2 * copysetNum,
+              topology_->GetCopySetsInChunkServer(0x41).size());
+}
+
+TEST_F(TestTopology, FlushCopySetInBatches_success) {
+    EXPECT_CALL(*storage_, LoadClusterInfo(_))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*storage_, StorageClusterInfo(_))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*storage_, LoadLogicalPool(_, _))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*storage_, LoadPhysicalPool(_, _))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*storage_, LoadZone(_, _))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*storage_, LoadServer(_, _))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*storage_, LoadChunkServer(_, _))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*storage_, LoadCopySet(_, _))
+        .WillOnce(Return(true));
+    TopologyOption option;
+    option.TopologyUpdateToRepoSec = 3600;
+    option.CopySetFlushBatchSize = 2;
+    option.CopySetFlushDirtyThreshold = 3;
+    ASSERT_EQ(kTopoErrCodeSuccess, topology_->Init(option));
+
+    PrepareAddPoolset();
+    PoolIdType physicalPoolId = 0x11;
+    PrepareAddPhysicalPool(physicalPoolId);
+    PrepareAddZone(0x21, "zone1", physicalPoolId);
+    PrepareAddServer(
+        0x31, "server1", "127.0.0.1" , 0, "127.0.0.1" , 0, 0x21, 0x11);
+    PrepareAddChunkServer(0x41, "token1", "nvme", 0x31, "127.0.0.1", 8200);
+    PrepareAddLogicalPool(0x01, "logicalPool1", physicalPoolId);
+    for (CopySetIdType id = 1; id <= 3; id++) {
+        PrepareAddCopySet(id, 0x01, {0x41});
+    }
+
+    // the first batch fails and is retried by the flush on stop
+    std::vector<std::vector<CopySetIdType>> batches;
+    std::mutex mtx;
+    EXPECT_CALL(*storage_, UpdateCopySet(_)).Times(0);
+    EXPECT_CALL(*storage_, UpdateCopySets(_))
+        .Times(3)
+        .WillRepeatedly(Invoke([&](const std::vector<CopySetInfo> &datas) {
+            std::lock_guard<std::mutex> lk(mtx);
+            std::vector<CopySetIdType> ids;
+            for (const auto &data : datas) {
+                ids.push_back(data.GetId());
+                EXPECT_EQ(10, data.GetEpoch());
+            }
+            batches.push_back(ids);
+            return batches.size() != 1;
+        }));
+    topology_->Run();
+
+    // flushed when 3 copysets are dirty instead of after an hour
+    for (CopySetIdType id = 1; id <= 3; id++) {
+        CopySetInfo info(0x01, id);
+        info.SetEpoch(10);
+        info.SetLeader(0x41);
+        info.SetCopySetMembers({0x41});
+        ASSERT_EQ(kTopoErrCodeSuccess, topology_->UpdateCopySetTopo(info));
+    }
+    for (int i = 0; i < 500; i++) {
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            if (batches.size() == 2) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    topology_->Stop();
+
+    std::vector<std::vector<CopySetIdType>> expected{{1, 2}, {3}, {1, 2}};
+    ASSERT_EQ(expected, batches);
+}
+
 TEST_F(TestTopology, test_create_default_poolset) {
     EXPECT_CALL(*storage_, LoadClusterInfo(_))
         .WillOnce(Return(true));
@@ -572,6 +572,101 @@ TEST_F(TestTopologyChunkAllocator,
     ASSERT_FALSE(ret);
 }
 
+TEST_F(TestTopologyChunkAllocator,
+    Test_AllocateChunkByLoad_avoidHotAndFullChunkServer) {
+    TopologyOption option;
+    option.PoolUsagePercentLimit = 85;
+    option.enableLogicalPoolStatus = true;
+    option.chooseCopySetPolicy =
+        static_cast<int>(ChooseCopySetPolicy::kLoad);
+    option.CopySetLoadUpdateIntervalMs = 0;
+    testObj_ = std::make_shared<TopologyChunkAllocatorImpl>(topology_,
+        allocStatistic_,
+        topoStat_,
+        chunkFilePoolAllocHelp_,
+        option);
+
+    PrepareAddPoolset();
+    PoolIdType logicalPoolId = 0x01;
+    PoolIdType physicalPoolId = 0x11;
+
+    PrepareAddPhysicalPool(physicalPoolId);
+    PrepareAddZone(0x21, "zone1", physicalPoolId);
+    PrepareAddZone(0x22, "zone2", physicalPoolId);
+    PrepareAddZone(0x23, "zone3", physicalPoolId);
+    PrepareAddServer(0x31, "server1", "127.0.0.1", "127.0.0.1", 0x21, 0x11);
+    PrepareAddServer(0x32, "server2", "127.0.0.1", "127.0.0.1", 0x22, 0x11);
+    PrepareAddServer(0x33, "server3", "127.0.0.1", "127.0.0.1", 0x23, 0x11);
+    PrepareAddChunkServer(0x41, "token1", "nvme", 0x31, "127.0.0.1", 8200);
+    PrepareAddChunkServer(0x42, "token2", "nvme", 0x32, "127.0.0.1", 8200);
+    PrepareAddChunkServer(0x43, "token3", "nvme", 0x33, "127.0.0.1", 8200);
+    PrepareAddChunkServer(0x44, "token4", "nvme", 0x31, "127.0.0.1", 8201);
+    PrepareAddChunkServer(0x45, "token5", "nvme", 0x32, "127.0.0.1", 8201);
+    PrepareAddChunkServer(0x46, "token6", "nvme", 0x33, "127.0.0.1", 8201);
+    PrepareAddLogicalPool(logicalPoolId, "logicalPool1", physicalPoolId,
+        PAGEFILE);
+    PrepareAddCopySet(0x51, logicalPoolId, {0x41, 0x42, 0x43});
+    PrepareAddCopySet(0x52, logicalPoolId, {0x44, 0x45, 0x46});
+
+    EXPECT_CALL(*allocStatistic_, GetAllocByLogicalPool(_, _))
+        .WillRepeatedly(Return(true));
+
+    // 0x41 is hot
+    ChunkServerStat stat;
+    stat.chunkFilepoolSize = 512;
+    stat.writeIOPS = 10000;
+    topoStat_->UpdateChunkServerStat(0x41, stat);
+
+    std::map<CopySetIdType, int> counts;
+    for (int i = 0; i < 10; i++) {
+        std::vector<CopysetIdInfo> infos;
+        ASSERT_TRUE(testObj_->AllocateChunkRoundRobinInSingleLogicalPool(
+            INODE_PAGEFILE, "testPoolset", 100, 1024, &infos));
+        ASSERT_EQ(100, infos.size());
+        for (const auto &info : infos) {
+            ASSERT_EQ(logicalPoolId, info.logicalPoolId);
+            counts[info.copySetId]++;
+        }
+    }
+    ASSERT_GT(counts[0x52], 3 * counts[0x51]);
+
+    // 0x44 is full
+    stat.chunkFilepoolSize = 0;
+    stat.writeIOPS = 0;
+    topoStat_->UpdateChunkServerStat(0x44, stat);
+    std::vector<CopysetIdInfo> infos;
+    ASSERT_TRUE(testObj_->AllocateChunkRandomInSingleLogicalPool(
+        INODE_PAGEFILE, "testPoolset", 100, 1024, &infos));
+    ASSERT_EQ(100, infos.size());
+    for (const auto &info : infos) {
+        ASSERT_EQ(0x51, info.copySetId);
+    }
+}
+
+TEST(TestAllocateChunkPolicy, TestAllocateChunkByWeightInSingleLogicalPool) {
+    std::vector<CopySetIdType> copySetIds = {1, 2, 3};
+    std::vector<CopysetIdInfo> infos;
+    std::map<CopySetIdType, int> counts;
+    ASSERT_TRUE(AllocateChunkPolicy::AllocateChunkByWeightInSingleLogicalPool(
+        copySetIds, {0, 1, 3}, 1, 40000, &infos));
+    ASSERT_EQ(40000, infos.size());
+    for (const auto &info : infos) {
+        ASSERT_EQ(1, info.logicalPoolId);
+        counts[info.copySetId]++;
+    }
+    ASSERT_EQ(0, counts[1]);
+    ASSERT_NEAR(10000, counts[2], 1000);
+    ASSERT_NEAR(30000, counts[3], 1000);
+
+    // no weight
+    ASSERT_FALSE(AllocateChunkPolicy::AllocateChunkByWeightInSingleLogicalPool(
+        copySetIds, {0, 0, 0}, 1, 1, &infos));
+    ASSERT_FALSE(AllocateChunkPolicy::AllocateChunkByWeightInSingleLogicalPool(
+        copySetIds, {1, 1}, 1, 1, &infos));
+    ASSERT_FALSE(AllocateChunkPolicy::AllocateChunkByWeightInSingleLogicalPool(
+        {}, {}, 1, 1, &infos));
+}
+
 TEST(TestAllocateChunkPolicy, TestAllocateChunkRandomInSingleLogicalPoolPoc) {
     // 2000个copyset分配100000次，每次分配64个chunk
     std::vector<CopySetIdType> copySetIds;
@@ -84,6 +84,36 @@ TEST_F(TestTopologyItem,
     ASSERT_STREQ(jsonStr.c_str(), retStr.c_str());
 }
 
+TEST_F(TestTopologyItem, Test_AppendECFilePolicy) {
+    LogicalPool::RedundanceAndPlaceMentPolicy rap;
+    ASSERT_FALSE(LogicalPool::TransRedundanceAndPlaceMentPolicyFromJsonStr(
+        "{\"dSegmentNum\":0,\"cSegmentNum\":2,\"copysetNum\":10,"
+        "\"zoneNum\":6}", APPENDECFILE, &rap));
+    ASSERT_FALSE(LogicalPool::TransRedundanceAndPlaceMentPolicyFromJsonStr(
+        "{\"replicaNum\":3,\"copysetNum\":10,\"zoneNum\":3}",
+        APPENDECFILE, &rap));
+    ASSERT_TRUE(LogicalPool::TransRedundanceAndPlaceMentPolicyFromJsonStr(
+        "{\"dSegmentNum\":4,\"cSegmentNum\":2,\"copysetNum\":10,"
+        "\"zoneNum\":6}", APPENDECFILE, &rap));
+    ASSERT_EQ(4, rap.appendECFileRAP.dSegmentNum);
+    ASSERT_EQ(2, rap.appendECFileRAP.cSegmentNum);
+    ASSERT_EQ(10, rap.appendECFileRAP.copysetNum);
+    ASSERT_EQ(6, rap.appendECFileRAP.zoneNum);
+
+    LogicalPool lpool(0x01, "pool1", 0x11, APPENDECFILE, rap,
+                      LogicalPool::UserPolicy(), 0, true, true);
+    ASSERT_EQ(6, lpool.GetReplicaNum());
+    ASSERT_DOUBLE_EQ(1.5, lpool.GetSpaceAmplification());
+
+    LogicalPool::RedundanceAndPlaceMentPolicy parsed;
+    ASSERT_TRUE(LogicalPool::TransRedundanceAndPlaceMentPolicyFromJsonStr(
+        lpool.GetRedundanceAndPlaceMentPolicyJsonStr(), APPENDECFILE,
+        &parsed));
+    ASSERT_EQ(4, parsed.appendECFileRAP.dSegmentNum);
+    ASSERT_EQ(2, parsed.appendECFileRAP.cSegmentNum);
+    ASSERT_EQ(10, parsed.appendECFileRAP.copysetNum);
+    ASSERT_EQ(6, parsed.appendECFileRAP.zoneNum);
+}
 
 TEST_F(TestTopologyItem, Test_GetCopySetMembersStr_success) {
     CopySetInfo cInfo(0x01, 0x11);
@@ -759,6 +759,37 @@ TEST_F(TestTopologyStorageEtcd, test_StotageCopyset_putInfoEtcdFail) {
     ASSERT_FALSE(ret);
 }
 
+TEST_F(TestTopologyStorageEtcd, test_UpdateCopysets_success) {
+    CopySetInfo data1(0x11, 0x61);
+    data1.SetEpoch(100);
+    data1.SetCopySetMembers({0x51, 0x52, 0x53});
+    CopySetInfo data2(0x11, 0x62);
+    data2.SetEpoch(200);
+    data2.SetCopySetMembers({0x51, 0x52, 0x54});
+
+    std::vector<Operation> ops;
+    EXPECT_CALL(*kvStorageClient_, TxnN(_))
+        .WillOnce(DoAll(testing::SaveArg<0>(&ops),
+                        Return(EtcdErrCode::EtcdOK)));
+
+    bool ret = storage_->UpdateCopySets({data1, data2});
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(2, ops.size());
+    ASSERT_EQ(OpType::OpPut, ops[0].opType);
+}
+
+TEST_F(TestTopologyStorageEtcd, test_UpdateCopysets_txnFail) {
+    CopySetInfo data(0x11, 0x61);
+    data.SetEpoch(100);
+    data.SetCopySetMembers({0x51, 0x52, 0x53});
+
+    EXPECT_CALL(*kvStorageClient_, TxnN(_))
+        .WillOnce(Return(EtcdErrCode::EtcdUnknown));
+
+    bool ret = storage_->UpdateCopySets({data});
+    ASSERT_FALSE(ret);
+}
+
 TEST_F(TestTopologyStorageEtcd, test_DeleteLogicalPool_success) {
     EXPECT_CALL(*kvStorageClient_, Delete(_))
         .WillOnce(Return(EtcdErrCode::EtcdOK));
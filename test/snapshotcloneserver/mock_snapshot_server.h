@@ -82,6 +82,11 @@ class MockSnapshotCore : public SnapshotCore {
 
     MOCK_METHOD1(HandleCancelScheduledSnapshotTask,
                  int(std::shared_ptr<SnapshotTaskInfo> task));
+
+    MOCK_METHOD3(GetSnapshotDiff,
+        int(const SnapshotInfo *base,
+        const SnapshotInfo &target,
+        std::vector<SnapshotDiffRange> *ranges));
 };
 
 class MockSnapshotCloneMetaStore : public SnapshotCloneMetaStore {
@@ -108,6 +113,11 @@ class MockSnapshotCloneMetaStore : public SnapshotCloneMetaStore {
         int(const std::string &fileName, std::vector<CloneInfo> *list));
     MOCK_METHOD1(GetCloneInfoList,
         int(std::vector<CloneInfo> *list));
+    MOCK_METHOD2(AddChunkDataRef,
+        int(const std::string &hash, const std::string &ref));
+    MOCK_METHOD3(RemoveChunkDataRef,
+        int(const std::string &hash, const std::string &ref,
+            uint32_t *refNum));
 };
 
 class MockSnapshotDataStore : public SnapshotDataStore {
@@ -298,6 +308,14 @@ class MockSnapshotServiceManager : public SnapshotServiceManager {
         int(const SnapshotFilterCondition &filter,
         std::vector<FileSnapshotInfo> *info));
 
+    MOCK_METHOD6(GetSnapshotDiff,
+        int(const std::string &file,
+        const std::string &user,
+        const UUID &baseUuid,
+        const UUID &uuid,
+        SnapshotInfo *snapInfo,
+        std::vector<SnapshotDiffRange> *ranges));
+
     MOCK_METHOD3(CancelSnapshot,
         int(const UUID &uuid,
         const std::string &user,
@@ -433,6 +451,8 @@ class MockKVStorageClient : public KVStorageClient {
                            std::vector<std::pair<std::string, std::string>>*));
     MOCK_METHOD1(Delete, int(const std::string&));
     MOCK_METHOD1(TxnN, int(const std::vector<Operation>&));
+    MOCK_METHOD2(TxnNWithRevision, int(const std::vector<Operation>&,
+        int64_t*));
     MOCK_METHOD3(CompareAndSwap, int(const std::string&, const std::string&,
         const std::string&));
     MOCK_METHOD5(CampaignLeader, int(const std::string&, const std::string&,
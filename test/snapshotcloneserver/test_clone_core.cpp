@@ -27,10 +27,12 @@
 #include "src/snapshotcloneserver/clone/clone_task.h"
 #include "src/common/snapshotclone/snapshotclone_define.h"
 #include "src/common/location_operator.h"
+#include "src/common/timeutility.h"
 
 #include "test/snapshotcloneserver/mock_snapshot_server.h"
 
 using ::curve::common::LocationOperator;
+using ::curve::common::TimeUtility;
 
 using ::testing::Return;
 using ::testing::_;
@@ -725,6 +727,41 @@ TEST_F(TestCloneCoreImpl,
     core_->HandleCloneOrRecoverTask(task);
 }
 
+TEST_F(TestCloneCoreImpl,
+    HandleCloneOrRecoverTaskStage2WithRecoverChunkBpsLimit) {
+    option.recoverChunkBpsLimitMB = 1;
+    core_ = std::make_shared<CloneCoreImpl>(client_,
+        metaStore_,
+        dataStore_,
+        snapshotRef_,
+        cloneRef_,
+        option);
+    EXPECT_CALL(*client_, Mkdir(_, _))
+        .WillOnce(Return(LIBCURVE_ERROR::OK));
+    ASSERT_EQ(core_->Init(), 0);
+
+    CloneInfo info("id1", "user1", CloneTaskType::kClone, "snapid1", "file1",
+                   kDefaultPoolset, 1, 2, 100, CloneFileType::kSnapshot, true,
+                   CloneStep::kRecoverChunk, CloneStatus::cloning);
+    auto cloneMetric = std::make_shared<CloneInfoMetric>("id1");
+    auto cloneClosure = std::make_shared<CloneClosure>();
+    std::shared_ptr<CloneTaskInfo> task =
+        std::make_shared<CloneTaskInfo>(info, cloneMetric, cloneClosure);
+
+    EXPECT_CALL(*metaStore_, UpdateCloneInfo(_))
+        .WillRepeatedly(Return(kErrCodeSuccess));
+
+    MockBuildFileInfoFromSnapshotSuccess(task);
+    MockCloneMetaSuccess(task);
+    MockRecoverChunkSuccess(task);
+    MockCompleteCloneFileSuccess(task);
+    // 2个1MB的chunk按1MB/s限速recover
+    uint64_t startMs = TimeUtility::GetTimeofDayMs();
+    core_->HandleCloneOrRecoverTask(task);
+    ASSERT_GE(TimeUtility::GetTimeofDayMs() - startMs, 500);
+    ASSERT_EQ(CloneStatus::done, task->GetCloneInfo().GetStatus());
+}
+
 TEST_F(TestCloneCoreImpl,
     HandleCloneOrRecoverTaskSuccessForCloneBySnapshotNotLazy) {
     CloneInfo info("id1", "user1", CloneTaskType::kClone, "snapid1", "file1",
@@ -619,6 +619,54 @@ TEST_F(TestCloneServiceManager, GetCloneTaskInfoByFilterFail) {
     ASSERT_EQ(1, infos.size());
 }
 
+TEST_F(TestCloneServiceManager, GetCloneTaskInfoByFilterUuidAndDestination) {
+    const std::string user = "user1";
+    CloneInfo cloneInfo("uuid1", user, CloneTaskType::kClone,
+        "src1", "file1", kDefaultPoolset,
+        CloneFileType::kSnapshot, true);
+    cloneInfo.SetStatus(CloneStatus::done);
+    std::vector<CloneInfo> cloneInfos;
+    cloneInfos.push_back(cloneInfo);
+
+    // 按任务id和目标文件过滤时不再列出全部克隆信息
+    EXPECT_CALL(*cloneCore_, GetCloneInfoList(_))
+        .Times(0);
+    EXPECT_CALL(*cloneCore_, GetCloneInfo("uuid1", _))
+        .WillOnce(DoAll(SetArgPointee<1>(cloneInfo),
+            Return(kErrCodeSuccess)));
+    EXPECT_CALL(*cloneCore_, GetCloneInfo("uuid2", _))
+        .WillOnce(Return(kErrCodeInternalError));
+    EXPECT_CALL(*cloneCore_, GetCloneInfoByFileName("file1", _))
+        .WillOnce(DoAll(SetArgPointee<1>(cloneInfos),
+            Return(kErrCodeSuccess)));
+
+    std::string uuid = "uuid1";
+    CloneFilterCondition filter;
+    filter.SetUuid(&uuid);
+    std::vector<TaskCloneInfo> infos;
+    ASSERT_EQ(kErrCodeSuccess,
+        manager_->GetCloneTaskInfoByFilter(filter, &infos));
+    ASSERT_EQ(1, infos.size());
+    ASSERT_EQ("uuid1", infos[0].GetCloneInfo().GetTaskId());
+
+    std::string uuid2 = "uuid2";
+    filter.SetUuid(&uuid2);
+    infos.clear();
+    ASSERT_EQ(kErrCodeSuccess,
+        manager_->GetCloneTaskInfoByFilter(filter, &infos));
+    ASSERT_EQ(0, infos.size());
+
+    std::string destination = "file1";
+    std::string otherUser = "user2";
+    CloneFilterCondition filter2;
+    filter2.SetDestination(&destination);
+    filter2.SetUser(&otherUser);
+    infos.clear();
+    ASSERT_EQ(kErrCodeSuccess,
+        manager_->GetCloneTaskInfoByFilter(filter2, &infos));
+    ASSERT_EQ(0, infos.size());
+}
+
 TEST_F(TestCloneServiceManager, TestGetCloneTaskInfoByUUIDSuccess) {
     const UUID uuid = "uuid1";
     const UUID source = "src";
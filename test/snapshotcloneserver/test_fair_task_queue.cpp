@@ -0,0 +1,111 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "src/snapshotcloneserver/common/fair_task_queue.h"
+
+namespace curve {
+namespace snapshotcloneserver {
+
+namespace {
+
+class FakeTask {
+ public:
+    FakeTask(const TaskIdType &taskId, const std::string &file)
+        : taskId_(taskId), file_(file) {}
+
+    TaskIdType GetTaskId() const {
+        return taskId_;
+    }
+
+    const std::string &GetFile() const {
+        return file_;
+    }
+
+ private:
+    TaskIdType taskId_;
+    std::string file_;
+};
+
+std::shared_ptr<FakeTask> NewTask(const TaskIdType &taskId,
+                                  const std::string &file = "") {
+    return std::make_shared<FakeTask>(taskId, file);
+}
+
+}  // namespace
+
+TEST(TestFairTaskQueue, TestPopByRunningNumOfUser) {
+    FairTaskQueue<FakeTask> queue(3);
+    // user1先提交了多个任务
+    queue.Push("user1", NewTask("a1"));
+    queue.Push("user1", NewTask("a2"));
+    queue.Push("user1", NewTask("a3"));
+    queue.Push("user2", NewTask("b1"));
+    queue.Push("user3", NewTask("c1"));
+
+    ASSERT_EQ("a1", queue.Pop()->GetTaskId());
+    ASSERT_EQ("b1", queue.Pop()->GetTaskId());
+    ASSERT_EQ("c1", queue.Pop()->GetTaskId());
+    // 达到执行中的任务上限
+    ASSERT_EQ(nullptr, queue.Pop());
+    ASSERT_EQ(3, queue.RunningNum());
+    ASSERT_EQ(2, queue.WaitingNum());
+
+    queue.Finish("user2");
+    ASSERT_EQ("a2", queue.Pop()->GetTaskId());
+    ASSERT_EQ(2, queue.RunningNumOfUser("user1"));
+    ASSERT_EQ(0, queue.RunningNumOfUser("user2"));
+
+    // 执行中任务少的用户优先
+    queue.Push("user1", NewTask("a4"));
+    queue.Push("user2", NewTask("b2"));
+    queue.Finish("user1");
+    ASSERT_EQ("b2", queue.Pop()->GetTaskId());
+    queue.Finish("user3");
+    ASSERT_EQ("a3", queue.Pop()->GetTaskId());
+    ASSERT_EQ(nullptr, queue.Pop());
+}
+
+TEST(TestFairTaskQueue, TestRunnableAndRemove) {
+    FairTaskQueue<FakeTask> queue;
+    queue.Push("user1", NewTask("a1", "file1"));
+    queue.Push("user1", NewTask("a2", "file2"));
+    queue.Push("user2", NewTask("b1", "file1"));
+
+    auto notFile1 = [](const FakeTask &task) {
+        return task.GetFile() != "file1";
+    };
+    ASSERT_EQ("a2", queue.Pop(notFile1)->GetTaskId());
+    ASSERT_EQ(nullptr, queue.Pop(notFile1));
+
+    ASSERT_NE(nullptr, queue.Get("b1"));
+    ASSERT_EQ(nullptr, queue.Get("a2"));
+    queue.Remove("b1");
+    ASSERT_EQ(nullptr, queue.Get("b1"));
+    ASSERT_EQ(1, queue.WaitingNum());
+
+    // 不限制执行中的任务数量
+    ASSERT_EQ("a1", queue.Pop()->GetTaskId());
+    ASSERT_EQ(2, queue.RunningNum());
+    ASSERT_EQ(nullptr, queue.Pop());
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
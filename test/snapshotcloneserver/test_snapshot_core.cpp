@@ -23,6 +23,11 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <atomic>
+#include <cstring>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+
 #include "src/snapshotcloneserver/snapshot/snapshot_core.h"
 #include "src/common/snapshotclone/snapshotclone_define.h"
 #include "src/snapshotcloneserver/snapshot/snapshot_task.h"
@@ -40,6 +45,7 @@ using ::testing::AllOf;
 using ::testing::SetArgPointee;
 using ::testing::Invoke;
 using ::testing::DoAll;
+using ::testing::SaveArg;
 
 class TestSnapshotCoreImpl : public ::testing::Test {
  public:
@@ -518,6 +524,133 @@ TEST_F(TestSnapshotCoreImpl,
     ASSERT_EQ(Status::done, task->GetSnapshotInfo().GetStatus());
 }
 
+
+TEST_F(TestSnapshotCoreImpl,
+    TestHandleCreateSnapshotTaskUploadPartsInThreadPool) {
+    option.snapshotUploadThreadNum = 2;
+    option.uploadChunkPartConcurrency = 1;
+    core_ = std::make_shared<SnapshotCoreImpl>(client_,
+            metaStore_,
+            dataStore_,
+            snapshotRef_,
+            option);
+    ASSERT_EQ(core_->Init(), 0);
+
+    UUID uuid = "uuid1";
+    std::string user = "user1";
+    std::string fileName = "file1";
+    std::string desc = "snap1";
+    uint64_t seqNum = 100;
+
+    SnapshotInfo info(uuid, user, fileName, desc);
+    info.SetStatus(Status::pending);
+
+    auto snapshotInfoMetric = std::make_shared<SnapshotInfoMetric>(uuid);
+    std::shared_ptr<SnapshotTaskInfo> task =
+        std::make_shared<SnapshotTaskInfo>(info, snapshotInfoMetric);
+
+    EXPECT_CALL(*client_, CreateSnapshot(fileName, user, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<2>(seqNum),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    FInfo snapInfo;
+    snapInfo.seqnum = 100;
+    snapInfo.chunksize = 2 * option.chunkSplitSize;
+    snapInfo.segmentsize = 2 * snapInfo.chunksize;
+    snapInfo.length = snapInfo.segmentsize;
+    snapInfo.ctime = 10;
+    EXPECT_CALL(*client_, GetSnapshot(fileName, user, seqNum, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<3>(snapInfo),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    EXPECT_CALL(*metaStore_, CASSnapshot(_, _))
+        .WillOnce(Return(kErrCodeSuccess));
+    EXPECT_CALL(*metaStore_, UpdateSnapshot(_))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    SegmentInfo segInfo;
+    segInfo.chunkvec.push_back(ChunkIDInfo(1, 1, 1));
+    segInfo.chunkvec.push_back(ChunkIDInfo(2, 2, 2));
+    EXPECT_CALL(*client_, GetSnapshotSegmentInfo(fileName,
+          user,
+          seqNum,
+            _,
+            _))
+        .WillOnce(DoAll(SetArgPointee<4>(segInfo),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    ChunkInfoDetail chunkInfo;
+    chunkInfo.chunkSn.push_back(100);
+    EXPECT_CALL(*client_, GetChunkInfo(_, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(SetArgPointee<1>(chunkInfo),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    EXPECT_CALL(*dataStore_, PutChunkIndexData(_, _))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    std::vector<SnapshotInfo> snapInfos;
+    info.SetSeqNum(seqNum);
+    snapInfos.push_back(info);
+    EXPECT_CALL(*metaStore_, GetSnapshotList(fileName, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(
+                    SetArgPointee<1>(snapInfos),
+                    Return(kErrCodeSuccess)));
+
+    EXPECT_CALL(*dataStore_, DataChunkTranferInit(_, _))
+        .Times(2)
+        .WillRepeatedly(Return(kErrCodeSuccess));
+
+    EXPECT_CALL(*client_, ReadChunkSnapshot(_, _, _, _, _, _))
+        .Times(4)
+        .WillRepeatedly(DoAll(
+                    Invoke([](ChunkIDInfo cidinfo,
+                        uint64_t seq,
+                        uint64_t offset,
+                        uint64_t len,
+                        char *buf,
+                        SnapCloneClosure* scc){
+                        scc->SetRetCode(LIBCURVE_ERROR::OK);
+                        scc->Run();
+                        }),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    // 分片在上传线程池中上传，全部完成后才结束转储
+    std::atomic<int> uploadedParts(0);
+    EXPECT_CALL(*dataStore_, DataChunkTranferAddPart(_, _, _, _, _))
+        .Times(4)
+        .WillRepeatedly(Invoke([&uploadedParts](const ChunkDataName &,
+                    std::shared_ptr<TransferTask>, int, int, const char *) {
+                    std::this_thread::sleep_for(
+                        std::chrono::milliseconds(10));
+                    uploadedParts++;
+                    return kErrCodeSuccess;
+                    }));
+
+    EXPECT_CALL(*dataStore_, DataChunkTranferComplete(_, _))
+        .Times(2)
+        .WillRepeatedly(Invoke([&uploadedParts](const ChunkDataName &,
+                    std::shared_ptr<TransferTask>) {
+                    EXPECT_EQ(0, uploadedParts % 2);
+                    return kErrCodeSuccess;
+                    }));
+
+    EXPECT_CALL(*client_, DeleteSnapshot(fileName, user, seqNum))
+        .WillOnce(Return(LIBCURVE_ERROR::OK));
+
+    EXPECT_CALL(*client_, CheckSnapShotStatus(_, _, _, _))
+        .WillOnce(Return(-LIBCURVE_ERROR::NOTEXIST));
+
+    core_->HandleCreateSnapshotTask(task);
+
+    ASSERT_TRUE(task->IsFinish());
+    ASSERT_EQ(Status::done, task->GetSnapshotInfo().GetStatus());
+    ASSERT_EQ(4, uploadedParts);
+}
+
 TEST_F(TestSnapshotCoreImpl,
     TestHandleCreateSnapshotTask_CreateSnapshotFail) {
     UUID uuid = "uuid1";
@@ -3418,6 +3551,193 @@ TEST_F(TestSnapshotCoreImpl,
     ASSERT_EQ(Status::error, task->GetSnapshotInfo().GetStatus());
 }
 
+TEST_F(TestSnapshotCoreImpl,
+    TestHandleCreateSnapshotTaskResumeFromCheckpoint) {
+    option.snapshotCompressType = "snappy";
+    option.snapshotCheckpointChunkNum = 1;
+    core_ = std::make_shared<SnapshotCoreImpl>(client_,
+            metaStore_,
+            dataStore_,
+            snapshotRef_,
+            option);
+    ASSERT_EQ(core_->Init(), 0);
+
+    UUID uuid = "uuid1";
+    std::string user = "user1";
+    std::string fileName = "file1";
+    std::string desc = "snap1";
+    uint64_t seqNum = 100;
+
+    SnapshotInfo info(uuid, user, fileName, desc);
+    info.SetSeqNum(seqNum);
+    info.SetChunkSize(2 * option.chunkSplitSize);
+    info.SetSegmentSize(4 * option.chunkSplitSize);
+    info.SetFileLength(8 * option.chunkSplitSize);
+    info.SetStatus(Status::pending);
+
+    auto snapshotInfoMetric = std::make_shared<SnapshotInfoMetric>(uuid);
+    std::shared_ptr<SnapshotTaskInfo> task =
+        std::make_shared<SnapshotTaskInfo>(info, snapshotInfoMetric);
+
+    EXPECT_CALL(*dataStore_, ChunkIndexDataExist(_))
+        .WillOnce(Return(true));
+
+    // 重启前chunk 0和1已转储完成并记录到了索引块
+    ChunkIndexData indexData;
+    for (ChunkIndexType i = 0; i < 4; i++) {
+        indexData.PutChunkDataName(ChunkDataName(fileName, seqNum, i));
+    }
+    indexData.SetChunkDataCompressType(0, CompressType::SNAPPY);
+    indexData.SetChunkDataCompressType(1, CompressType::SNAPPY);
+    EXPECT_CALL(*dataStore_, GetChunkIndexData(_, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<1>(indexData),
+                    Return(kErrCodeSuccess)));
+
+    SegmentInfo segInfo1;
+    segInfo1.chunkvec.push_back(ChunkIDInfo(1, 1, 1));
+    segInfo1.chunkvec.push_back(ChunkIDInfo(2, 2, 2));
+    SegmentInfo segInfo2;
+    segInfo2.chunkvec.push_back(ChunkIDInfo(3, 3, 3));
+    segInfo2.chunkvec.push_back(ChunkIDInfo(4, 4, 4));
+    EXPECT_CALL(*client_, GetSnapshotSegmentInfo(fileName,
+            user,
+            seqNum,
+            _,
+            _))
+        .Times(2)
+        .WillOnce(DoAll(SetArgPointee<4>(segInfo1),
+                    Return(LIBCURVE_ERROR::OK)))
+        .WillOnce(DoAll(SetArgPointee<4>(segInfo2),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    std::vector<SnapshotInfo> snapInfos;
+    snapInfos.push_back(info);
+    EXPECT_CALL(*metaStore_, GetSnapshotList(fileName, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(
+                    SetArgPointee<1>(snapInfos),
+                    Return(kErrCodeSuccess)));
+
+    EXPECT_CALL(*dataStore_, ChunkDataExist(_))
+        .WillRepeatedly(Invoke([](const ChunkDataName &name) {
+            return name.compressType_ == CompressType::SNAPPY;
+        }));
+
+    // 只读取和上传chunk 2和3
+    EXPECT_CALL(*client_, ReadChunkSnapshot(_, _, _, _, _, _))
+        .Times(4)
+        .WillRepeatedly(DoAll(
+                    Invoke([](ChunkIDInfo cidinfo,
+                        uint64_t seq,
+                        uint64_t offset,
+                        uint64_t len,
+                        char *buf,
+                        SnapCloneClosure* scc){
+                        memset(buf, 0, len);
+                        scc->SetRetCode(LIBCURVE_ERROR::OK);
+                        scc->Run();
+                        }),
+                    Return(LIBCURVE_ERROR::OK)));
+    EXPECT_CALL(*dataStore_, DataChunkTranferInit(_, _))
+        .Times(2)
+        .WillRepeatedly(Return(kErrCodeSuccess));
+    EXPECT_CALL(*dataStore_, DataChunkTranferAddPart(_, _, _, _, _))
+        .Times(2)
+        .WillRepeatedly(Return(kErrCodeSuccess));
+    EXPECT_CALL(*dataStore_, DataChunkTranferComplete(_, _))
+        .Times(2)
+        .WillRepeatedly(Return(kErrCodeSuccess));
+
+    // 每转储一个chunk记录一次，转储结束时再记录一次
+    ChunkIndexData lastIndexData;
+    EXPECT_CALL(*dataStore_, PutChunkIndexData(_, _))
+        .Times(3)
+        .WillRepeatedly(DoAll(SaveArg<1>(&lastIndexData),
+                    Return(kErrCodeSuccess)));
+
+    EXPECT_CALL(*client_, DeleteSnapshot(fileName, user, seqNum))
+        .WillOnce(Return(LIBCURVE_ERROR::OK));
+    EXPECT_CALL(*client_, CheckSnapShotStatus(_, _, _, _))
+        .WillOnce(Return(-LIBCURVE_ERROR::NOTEXIST));
+    EXPECT_CALL(*metaStore_, UpdateSnapshot(_))
+        .WillRepeatedly(Return(kErrCodeSuccess));
+
+    core_->HandleCreateSnapshotTask(task);
+
+    ASSERT_TRUE(task->IsFinish());
+    ASSERT_EQ(Status::done, task->GetSnapshotInfo().GetStatus());
+    for (ChunkIndexType i = 0; i < 4; i++) {
+        ChunkDataName name;
+        ASSERT_TRUE(lastIndexData.GetChunkDataName(i, &name));
+        ASSERT_EQ(CompressType::SNAPPY, name.compressType_);
+    }
+}
+
+TEST_F(TestSnapshotCoreImpl, TestGetSnapshotDiff) {
+    const std::string fileName = "file1";
+    const uint64_t chunkSize = 16 * 1024 * 1024;
+    SnapshotInfo base("uuid1", "user1", fileName, "snap1",
+        2, chunkSize, 1024 * chunkSize, 8 * chunkSize, 0, 0,
+        "default", 100, Status::done);
+    SnapshotInfo target("uuid2", "user1", fileName, "snap2",
+        4, chunkSize, 1024 * chunkSize, 8 * chunkSize, 0, 0,
+        "default", 200, Status::done);
+
+    ChunkIndexData baseIndex;
+    baseIndex.PutChunkDataName(ChunkDataName(fileName, 1, 0));
+    baseIndex.PutChunkDataName(ChunkDataName(fileName, 1, 1));
+    baseIndex.PutChunkDataName(ChunkDataName(fileName, 1, 2));
+    ChunkDataName dedupChunk(fileName, 1, 5);
+    dedupChunk.hash_ = "hash5";
+    baseIndex.PutChunkDataName(dedupChunk);
+    baseIndex.PutChunkDataName(ChunkDataName(fileName, 1, 6));
+
+    // chunk0未变化，chunk1、2、3、7快照之后写过，chunk5写入的内容相同，
+    // chunk6不在新快照中
+    ChunkIndexData targetIndex;
+    targetIndex.PutChunkDataName(ChunkDataName(fileName, 1, 0));
+    targetIndex.PutChunkDataName(ChunkDataName(fileName, 3, 1));
+    targetIndex.PutChunkDataName(ChunkDataName(fileName, 3, 2));
+    targetIndex.PutChunkDataName(ChunkDataName(fileName, 3, 3));
+    dedupChunk.chunkSeqNum_ = 3;
+    targetIndex.PutChunkDataName(dedupChunk);
+    targetIndex.PutChunkDataName(ChunkDataName(fileName, 3, 7));
+
+    auto getIndex = [&](const ChunkIndexDataName &name,
+                        ChunkIndexData *indexData) {
+        *indexData = name.fileSeqNum_ == 2 ? baseIndex : targetIndex;
+        return kErrCodeSuccess;
+    };
+    EXPECT_CALL(*dataStore_, GetChunkIndexData(_, _))
+        .WillRepeatedly(Invoke(getIndex));
+
+    std::vector<SnapshotDiffRange> ranges;
+    ASSERT_EQ(kErrCodeSuccess,
+        core_->GetSnapshotDiff(&base, target, &ranges));
+    ASSERT_EQ(2, ranges.size());
+    ASSERT_EQ(1 * chunkSize, ranges[0].offset);
+    ASSERT_EQ(3 * chunkSize, ranges[0].length);
+    ASSERT_EQ(6 * chunkSize, ranges[1].offset);
+    ASSERT_EQ(2 * chunkSize, ranges[1].length);
+
+    // 没有base时返回所有有数据的chunk
+    ASSERT_EQ(kErrCodeSuccess,
+        core_->GetSnapshotDiff(nullptr, target, &ranges));
+    ASSERT_EQ(3, ranges.size());
+    ASSERT_EQ(0, ranges[0].offset);
+    ASSERT_EQ(4 * chunkSize, ranges[0].length);
+    ASSERT_EQ(5 * chunkSize, ranges[1].offset);
+    ASSERT_EQ(chunkSize, ranges[1].length);
+    ASSERT_EQ(7 * chunkSize, ranges[2].offset);
+
+    // 索引读取失败
+    EXPECT_CALL(*dataStore_, GetChunkIndexData(_, _))
+        .WillOnce(Return(kErrCodeInternalError));
+    ASSERT_EQ(kErrCodeInternalError,
+        core_->GetSnapshotDiff(&base, target, &ranges));
+}
+
 }  // namespace snapshotcloneserver
 }  // namespace curve
 
@@ -241,6 +241,58 @@ TEST(TestChunkIndexData, TestUnSerialize) {
     ASSERT_TRUE(ret);
 }
 
+TEST(TestChunkIndexData, TestChunkDataHash) {
+    std::string data;
+    ChunkIndexData indexData;
+    indexData.SetFileName("file1");
+    indexData.PutChunkDataName(ChunkDataName("file1", 10, 100));
+    indexData.PutChunkDataName(ChunkDataName("file1", 10, 101));
+    indexData.SetChunkDataHash(100, "abc");
+    // 不存在的chunk不记录hash
+    indexData.SetChunkDataHash(102, "def");
+    ASSERT_TRUE(indexData.Serialize(&data));
+
+    ChunkIndexData indexData2;
+    ASSERT_TRUE(indexData2.Unserialize(data));
+    ChunkDataName out1, out2;
+    ASSERT_TRUE(indexData2.GetChunkDataName(100, &out1));
+    ASSERT_EQ("abc", out1.hash_);
+    ASSERT_EQ("dedup-abc", out1.ToDataChunkKey());
+    ASSERT_EQ("file1-100-10", out1.ToChunkRefKey());
+    ASSERT_TRUE(indexData2.GetChunkDataName(101, &out2));
+    ASSERT_TRUE(out2.hash_.empty());
+    ASSERT_EQ("file1-101-10", out2.ToDataChunkKey());
+    ASSERT_FALSE(indexData2.GetChunkDataName(102, &out2));
+}
+
+TEST(TestChunkIndexData, TestChunkDataCompressType) {
+    std::string data;
+    ChunkIndexData indexData;
+    indexData.SetFileName("file1");
+    indexData.PutChunkDataName(ChunkDataName("file1", 10, 100));
+    indexData.PutChunkDataName(ChunkDataName("file1", 10, 101));
+    indexData.PutChunkDataName(ChunkDataName("file1", 10, 102));
+    indexData.SetChunkDataCompressType(100, CompressType::SNAPPY);
+    indexData.SetChunkDataCompressType(101, CompressType::SNAPPY);
+    indexData.SetChunkDataHash(101, "abc");
+    ASSERT_TRUE(indexData.Serialize(&data));
+
+    ChunkIndexData indexData2;
+    ASSERT_TRUE(indexData2.Unserialize(data));
+    ChunkDataName out1, out2, out3;
+    ASSERT_TRUE(indexData2.GetChunkDataName(100, &out1));
+    ASSERT_EQ(CompressType::SNAPPY, out1.compressType_);
+    ASSERT_EQ("file1-100-10.z", out1.ToDataChunkKey());
+    ASSERT_EQ("file1-100-10", out1.ToChunkRefKey());
+    // 去重的数据对象以hash命名
+    ASSERT_TRUE(indexData2.GetChunkDataName(101, &out2));
+    ASSERT_EQ(CompressType::SNAPPY, out2.compressType_);
+    ASSERT_EQ("dedup-abc", out2.ToDataChunkKey());
+    ASSERT_TRUE(indexData2.GetChunkDataName(102, &out3));
+    ASSERT_EQ(CompressType::NONE, out3.compressType_);
+    ASSERT_EQ("file1-102-10", out3.ToDataChunkKey());
+}
+
 TEST(TestChunkIndexData, TestGetChunkDataName) {
     std::string data;
     ChunkIndexData indexData;
@@ -831,8 +831,9 @@ TEST_F(TestSnapshotServiceManager, TestGetSnapshotListByFilterSuccess) {
         }
     }
 
-    EXPECT_CALL(*core_, GetSnapshotList(_))
-        .WillOnce(DoAll(SetArgPointee<0>(snapInfo),
+    // 按uuid和文件名过滤时不再列出全部快照
+    EXPECT_CALL(*core_, GetSnapshotInfo(uuidOut, _))
+        .WillOnce(DoAll(SetArgPointee<1>(snap1),
                 Return(kErrCodeSuccess)));
 
     // filter uuid
@@ -857,8 +858,9 @@ TEST_F(TestSnapshotServiceManager, TestGetSnapshotListByFilterSuccess) {
         }
     }
 
-    EXPECT_CALL(*core_, GetSnapshotList(_))
-        .WillOnce(DoAll(SetArgPointee<0>(snapInfo),
+    std::vector<SnapshotInfo> snapInfoOfFile{snap1, snap3, snap4};
+    EXPECT_CALL(*core_, GetFileSnapshotInfo(file, _))
+        .WillOnce(DoAll(SetArgPointee<1>(snapInfoOfFile),
                 Return(kErrCodeSuccess)));
 
     // filter by filename
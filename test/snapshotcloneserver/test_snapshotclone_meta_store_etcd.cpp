@@ -399,6 +399,52 @@ TEST_F(TestSnapshotCloneMetaStoreEtcd,
     ASSERT_TRUE(JudgeSnapshotInfoEqual(snapInfo, list[0]));
 }
 
+TEST_F(TestSnapshotCloneMetaStoreEtcd,
+    TestGetSnapshotList1AfterUpdateAndDelete) {
+    SnapshotInfo snap1("snapuuid1", "snapuser", "file1", "snap1", 100,
+                        1024, 2048, 4096, 0, 0, kDefaultPoolset, 0,
+                        Status::pending);
+    SnapshotInfo snap2("snapuuid2", "snapuser", "file1", "snap2", 100,
+                        1024, 2048, 4096, 0, 0, kDefaultPoolset, 0,
+                        Status::pending);
+    SnapshotInfo snap3("snapuuid3", "snapuser", "file2", "snap3", 100,
+                        1024, 2048, 4096, 0, 0, kDefaultPoolset, 0,
+                        Status::pending);
+
+    EXPECT_CALL(*kvStorageClient_, Put(_, _))
+        .Times(4)
+        .WillRepeatedly(Return(EtcdErrCode::EtcdOK));
+    EXPECT_CALL(*kvStorageClient_, Delete(_))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
+
+    ASSERT_EQ(0, metaStore_->AddSnapshot(snap1));
+    ASSERT_EQ(0, metaStore_->AddSnapshot(snap2));
+    ASSERT_EQ(0, metaStore_->AddSnapshot(snap3));
+
+    std::vector<SnapshotInfo> list;
+    ASSERT_EQ(0, metaStore_->GetSnapshotList("file1", &list));
+    ASSERT_EQ(2, list.size());
+    ASSERT_EQ("snapuuid1", list[0].GetUuid());
+    ASSERT_EQ("snapuuid2", list[1].GetUuid());
+
+    // 文件名变化后索引跟随变化
+    snap2.SetFileName("file2");
+    snap2.SetStatus(Status::done);
+    ASSERT_EQ(0, metaStore_->UpdateSnapshot(snap2));
+    list.clear();
+    ASSERT_EQ(0, metaStore_->GetSnapshotList("file1", &list));
+    ASSERT_EQ(1, list.size());
+    list.clear();
+    ASSERT_EQ(0, metaStore_->GetSnapshotList("file2", &list));
+    ASSERT_EQ(2, list.size());
+    ASSERT_EQ(Status::done, list[0].GetStatus());
+
+    ASSERT_EQ(0, metaStore_->DeleteSnapshot("snapuuid1"));
+    list.clear();
+    ASSERT_EQ(-1, metaStore_->GetSnapshotList("file1", &list));
+    ASSERT_EQ(2, metaStore_->GetSnapshotCount());
+}
+
 TEST_F(TestSnapshotCloneMetaStoreEtcd,
     TestGetSnapshotList1Fail) {
     std::vector<SnapshotInfo> list;
@@ -532,9 +578,6 @@ TEST_F(TestSnapshotCloneMetaStoreEtcd,
     int ret = metaStore_->AddCloneInfo(cloneInfo);
     ASSERT_EQ(0, ret);
 
-    EXPECT_CALL(*kvStorageClient_, Get(_, _))
-        .WillOnce(Return(EtcdErrCode::EtcdOK));
-
     EXPECT_CALL(*kvStorageClient_, Put(_, _))
         .WillOnce(Return(EtcdErrCode::EtcdOK));
 
@@ -570,9 +613,6 @@ TEST_F(TestSnapshotCloneMetaStoreEtcd,
     int ret = metaStore_->AddCloneInfo(cloneInfo);
     ASSERT_EQ(0, ret);
 
-    EXPECT_CALL(*kvStorageClient_, Get(_, _))
-        .WillOnce(Return(EtcdErrCode::EtcdOK));
-
     EXPECT_CALL(*kvStorageClient_, Put(_, _))
         .WillOnce(Return(EtcdErrCode::EtcdUnknown));
 
@@ -590,7 +630,9 @@ TEST_F(TestSnapshotCloneMetaStoreEtcd,
                      CloneStatus::cloning);
 
     EXPECT_CALL(*kvStorageClient_, Get(_, _))
-        .WillOnce(Return(EtcdErrCode::EtcdKeyNotExist));
+        .Times(0);
+    EXPECT_CALL(*kvStorageClient_, Put(_, _))
+        .Times(0);
 
     int ret = metaStore_->UpdateCloneInfo(cloneInfo);
     ASSERT_EQ(-1, ret);
@@ -626,6 +668,51 @@ TEST_F(TestSnapshotCloneMetaStoreEtcd,
     ASSERT_TRUE(JudgeCloneInfoEqual(cloneInfo, list[0]));
 }
 
+TEST_F(TestSnapshotCloneMetaStoreEtcd,
+    TestGetCloneInfoByFileNameAfterUpdateAndDelete) {
+    CloneInfo cloneInfo1("uuid1", "user1",
+                     CloneTaskType::kClone, "src1",
+                     "dst1", kDefaultPoolset,  1, 2, 3,
+                     CloneFileType::kFile, false,
+                     CloneStep::kCompleteCloneFile,
+                     CloneStatus::cloning);
+    CloneInfo cloneInfo2("uuid2", "user1",
+                     CloneTaskType::kClone, "src1",
+                     "dst1", kDefaultPoolset,  1, 2, 3,
+                     CloneFileType::kFile, false,
+                     CloneStep::kCompleteCloneFile,
+                     CloneStatus::cloning);
+
+    EXPECT_CALL(*kvStorageClient_, Put(_, _))
+        .Times(3)
+        .WillRepeatedly(Return(EtcdErrCode::EtcdOK));
+    EXPECT_CALL(*kvStorageClient_, Delete(_))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
+
+    ASSERT_EQ(0, metaStore_->AddCloneInfo(cloneInfo1));
+    ASSERT_EQ(0, metaStore_->AddCloneInfo(cloneInfo2));
+
+    std::vector<CloneInfo> list;
+    ASSERT_EQ(0, metaStore_->GetCloneInfoByFileName("dst1", &list));
+    ASSERT_EQ(2, list.size());
+
+    // 目标文件变化后索引跟随变化
+    cloneInfo2.SetDest("dst2");
+    ASSERT_EQ(0, metaStore_->UpdateCloneInfo(cloneInfo2));
+    list.clear();
+    ASSERT_EQ(0, metaStore_->GetCloneInfoByFileName("dst1", &list));
+    ASSERT_EQ(1, list.size());
+    ASSERT_EQ("uuid1", list[0].GetTaskId());
+    list.clear();
+    ASSERT_EQ(0, metaStore_->GetCloneInfoByFileName("dst2", &list));
+    ASSERT_EQ(1, list.size());
+    ASSERT_EQ("uuid2", list[0].GetTaskId());
+
+    ASSERT_EQ(0, metaStore_->DeleteCloneInfo("uuid1"));
+    list.clear();
+    ASSERT_EQ(-1, metaStore_->GetCloneInfoByFileName("dst1", &list));
+}
+
 TEST_F(TestSnapshotCloneMetaStoreEtcd,
     TestGetCloneInfoByFileNameFail) {
     std::vector<CloneInfo> list;
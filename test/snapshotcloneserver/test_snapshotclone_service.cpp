@@ -2051,5 +2051,95 @@ TEST_F(TestSnapshotCloneServiceImpl, TestGetCloneRefStatusFail) {
     ASSERT_EQ(brpc::HTTP_STATUS_INTERNAL_SERVER_ERROR,
                     cntl.http_response().status_code());
 }
+
+TEST_F(TestSnapshotCloneServiceImpl, TestGetSnapshotDiffSuccess) {
+    std::string user = "user1";
+    std::string baseUuid = "uuid1";
+    std::string uuid = "uuid2";
+    SnapshotInfo sinfo(uuid, user, "file1", "snap2",
+         100, 1024, 4096, 8192, 0, 0, "default", 100, Status::done);
+    std::vector<SnapshotDiffRange> ranges;
+    ranges.push_back(SnapshotDiffRange{0, 1024});
+    ranges.push_back(SnapshotDiffRange{4096, 2048});
+    EXPECT_CALL(*snapshotManager_,
+        GetSnapshotDiff("", user, baseUuid, uuid, _, _))
+        .WillOnce(DoAll(SetArgPointee<4>(sinfo),
+                        SetArgPointee<5>(ranges),
+                        Return(kErrCodeSuccess)));
+
+    brpc::Channel channel;
+    brpc::ChannelOptions option;
+    option.protocol = "http";
+
+    std::string url = std::string("http://127.0.0.1:")
+                    + std::to_string(listenAddr_.port)
+                    + "/" + kServiceName + "?"
+                    + kActionStr + "=" + kGetSnapshotDiffAction + "&"
+                    + kVersionStr + "=1&"
+                    + kUserStr + "=" + user + "&"
+                    + kBaseUUIDStr + "=" + baseUuid + "&"
+                    + kUUIDStr + "=" + uuid + "&"
+                    + kOffsetStr + "=1";
+
+    if (channel.Init(url.c_str(), "", &option) != 0) {
+        FAIL() << "Fail to init channel"
+               << std::endl;
+    }
+
+    brpc::Controller cntl;
+    cntl.http_request().uri() = url.c_str();
+
+    channel.CallMethod(NULL, &cntl, NULL, NULL, NULL);
+    ASSERT_FALSE(cntl.Failed()) << cntl.ErrorText();
+
+    std::stringstream ss;
+    ss << cntl.response_attachment();
+    std::string data = ss.str();
+    Json::Reader jsonReader;
+    Json::Value jsonObj;
+    if (!jsonReader.parse(data, jsonObj)) {
+        FAIL() << "parse json fail, data = " << data;
+    }
+    ASSERT_STREQ("0", jsonObj["Code"].asCString());
+    ASSERT_EQ(1024, jsonObj["ChunkSize"].asUInt64());
+    ASSERT_EQ(8192, jsonObj["FileLength"].asUInt64());
+    ASSERT_EQ(2, jsonObj["TotalCount"].asInt());
+    ASSERT_EQ(1, jsonObj["ChangedRanges"].size());
+    ASSERT_EQ(4096, jsonObj["ChangedRanges"][0]["Offset"].asUInt64());
+    ASSERT_EQ(2048, jsonObj["ChangedRanges"][0]["Length"].asUInt64());
+}
+
+TEST_F(TestSnapshotCloneServiceImpl, TestGetSnapshotDiffFail) {
+    std::string user = "user1";
+    std::string uuid = "uuid2";
+    EXPECT_CALL(*snapshotManager_,
+        GetSnapshotDiff("", user, "", uuid, _, _))
+        .WillOnce(Return(kErrCodeInvalidSnapshot));
+
+    brpc::Channel channel;
+    brpc::ChannelOptions option;
+    option.protocol = "http";
+
+    std::string url = std::string("http://127.0.0.1:")
+                    + std::to_string(listenAddr_.port)
+                    + "/" + kServiceName + "?"
+                    + kActionStr + "=" + kGetSnapshotDiffAction + "&"
+                    + kVersionStr + "=1&"
+                    + kUserStr + "=" + user + "&"
+                    + kUUIDStr + "=" + uuid;
+
+    if (channel.Init(url.c_str(), "", &option) != 0) {
+        FAIL() << "Fail to init channel"
+               << std::endl;
+    }
+
+    brpc::Controller cntl;
+    cntl.http_request().uri() = url.c_str();
+
+    channel.CallMethod(NULL, &cntl, NULL, NULL, NULL);
+    ASSERT_TRUE(cntl.Failed());
+    ASSERT_EQ(brpc::HTTP_STATUS_INTERNAL_SERVER_ERROR,
+                    cntl.http_response().status_code());
+}
 }  // namespace snapshotcloneserver
 }  // namespace curve
@@ -0,0 +1,170 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <brpc/server.h>
+
+#include <atomic>
+#include <string>
+
+#include "proto/chunk.pb.h"
+#include "proto/copyset.pb.h"
+#include "src/tools/chunkserver_bench.h"
+
+namespace curve {
+namespace tool {
+
+using curve::chunkserver::CHUNK_OP_STATUS;
+using curve::chunkserver::ChunkRequest;
+using curve::chunkserver::ChunkResponse;
+using curve::chunkserver::COPYSET_OP_STATUS;
+using curve::chunkserver::CopysetRequest;
+using curve::chunkserver::CopysetResponse;
+
+namespace {
+
+const char kBenchServerAddr[] = "127.0.0.1:9397";
+
+class FakeChunkService : public curve::chunkserver::ChunkService {
+ public:
+    void WriteChunk(::google::protobuf::RpcController* controller,
+                    const ChunkRequest* request, ChunkResponse* response,
+                    google::protobuf::Closure* done) override {
+        brpc::ClosureGuard doneGuard(done);
+        writes++;
+        Reply(writeStatus.load(), response);
+    }
+
+    void ReadChunk(::google::protobuf::RpcController* controller,
+                   const ChunkRequest* request, ChunkResponse* response,
+                   google::protobuf::Closure* done) override {
+        brpc::ClosureGuard doneGuard(done);
+        reads++;
+        Reply(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS, response);
+    }
+
+    // 先返回若干次没有leader的重定向
+    std::atomic<int> redirects{0};
+    std::atomic<int> writes{0};
+    std::atomic<int> reads{0};
+    std::atomic<CHUNK_OP_STATUS> writeStatus{
+        CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS};
+
+ private:
+    void Reply(CHUNK_OP_STATUS status, ChunkResponse* response) {
+        if (redirects.load() > 0 && redirects.fetch_sub(1) > 0) {
+            response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_REDIRECTED);
+            return;
+        }
+        response->set_status(status);
+    }
+};
+
+class FakeCopysetService : public curve::chunkserver::CopysetService {
+ public:
+    void CreateCopysetNode(::google::protobuf::RpcController* controller,
+                           const CopysetRequest* request,
+                           CopysetResponse* response,
+                           google::protobuf::Closure* done) override {
+        brpc::ClosureGuard doneGuard(done);
+        creates++;
+        response->set_status(COPYSET_OP_STATUS::COPYSET_OP_STATUS_SUCCESS);
+    }
+
+    std::atomic<int> creates{0};
+};
+
+}  // namespace
+
+class ChunkServerBenchTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        ASSERT_EQ(0, server_.AddService(&chunkService_,
+                                        brpc::SERVER_DOESNT_OWN_SERVICE));
+        ASSERT_EQ(0, server_.AddService(&copysetService_,
+                                        brpc::SERVER_DOESNT_OWN_SERVICE));
+        ASSERT_EQ(0, server_.Start(kBenchServerAddr, nullptr));
+
+        option_.peers = {kBenchServerAddr};
+        option_.copysetNum = 2;
+        option_.chunksPerCopyset = 2;
+        option_.chunkSize = 64 * 1024;
+        option_.ioSize = 4096;
+        option_.iodepth = 4;
+        option_.runtimeSec = 1;
+        option_.reportIntervalSec = 0;
+        option_.rpcTimeoutMs = 1000;
+    }
+
+    void TearDown() override {
+        server_.Stop(0);
+        server_.Join();
+    }
+
+    brpc::Server server_;
+    FakeChunkService chunkService_;
+    FakeCopysetService copysetService_;
+    ChunkServerBenchOption option_;
+};
+
+TEST_F(ChunkServerBenchTest, InvalidOption) {
+    option_.ioSize = 3000;
+    ChunkServerBench bench(option_);
+    ASSERT_EQ(-1, bench.Init());
+}
+
+TEST_F(ChunkServerBenchTest, ReadWriteMix) {
+    chunkService_.redirects = 2;
+    option_.readPercent = 50;
+    ChunkServerBench bench(option_);
+    ASSERT_EQ(0, bench.Init());
+    // 每个peer上创建所有copyset, 每个chunk写一次
+    ASSERT_EQ(2, copysetService_.creates.load());
+    ASSERT_EQ(2 + 4, chunkService_.writes.load());
+
+    ASSERT_EQ(0, bench.Run());
+    ASSERT_GT(bench.ReadStat().ops, 0);
+    ASSERT_GT(bench.WriteStat().ops, 0);
+    ASSERT_EQ(0, bench.ReadStat().errors);
+    ASSERT_EQ(0, bench.WriteStat().errors);
+    ASSERT_EQ(bench.ReadStat().ops, bench.ReadStat().latUs.size());
+    ASSERT_EQ(bench.WriteStat().ops * option_.ioSize,
+              bench.WriteStat().bytes);
+}
+
+TEST_F(ChunkServerBenchTest, RateLimit) {
+    option_.iops = 100;
+    option_.createCopyset = false;
+    ChunkServerBench bench(option_);
+    ASSERT_EQ(0, bench.Init());
+    ASSERT_EQ(0, copysetService_.creates.load());
+    ASSERT_EQ(0, bench.Run());
+    // 1秒内最多100个请求, 允许计时的误差
+    ASSERT_LE(bench.WriteStat().ops, 110);
+    ASSERT_GE(bench.WriteStat().ops, 50);
+}
+
+TEST_F(ChunkServerBenchTest, WriteFailed) {
+    ChunkServerBench bench(option_);
+    ASSERT_EQ(0, bench.Init());
+    chunkService_.writeStatus = CHUNK_OP_STATUS::CHUNK_OP_STATUS_DISK_FAIL;
+    ASSERT_EQ(-1, bench.Run());
+    ASSERT_EQ(0, bench.WriteStat().ops);
+    ASSERT_GT(bench.WriteStat().errors, 0);
+}
+
+}  // namespace tool
+}  // namespace curve
@@ -815,6 +815,79 @@ TEST_F(CopysetCheckCoreTest, CheckCopysetsInClusterNormal) {
     ASSERT_EQ(expectedRes, copysetCheck1.GetCopysetsRes());
 }
 
+// 集群中的每个chunkserver只查询一次
+TEST_F(CopysetCheckCoreTest, CheckCopysetsInClusterQueryOnce) {
+    butil::IOBuf iobuf;
+    GetIoBufForTest(&iobuf, "4294967396", "LEADER");
+    ServerInfo server1;
+    GetServerInfoForTest(&server1);
+    ServerInfo server2 = server1;
+    server2.set_serverid(2);
+    std::vector<ServerInfo> servers = {server1, server2};
+    std::vector<ChunkServerInfo> chunkservers1(2);
+    GetCsInfoForTest(&chunkservers1[0], 1);
+    GetCsInfoForTest(&chunkservers1[1], 2);
+    std::vector<ChunkServerInfo> chunkservers2(1);
+    GetCsInfoForTest(&chunkservers2[0], 3);
+
+    EXPECT_CALL(*mdsClient_, ListServersInCluster(_))
+        .Times(1)
+        .WillOnce(DoAll(SetArgPointee<0>(servers),
+                        Return(0)));
+    EXPECT_CALL(*mdsClient_, ListChunkServersOnServer(1, _))
+        .Times(1)
+        .WillOnce(DoAll(SetArgPointee<1>(chunkservers1),
+                        Return(0)));
+    EXPECT_CALL(*mdsClient_, ListChunkServersOnServer(2, _))
+        .Times(1)
+        .WillOnce(DoAll(SetArgPointee<1>(chunkservers2),
+                        Return(0)));
+    EXPECT_CALL(*csClient_, Init(_))
+        .Times(3)
+        .WillRepeatedly(Return(0));
+    EXPECT_CALL(*csClient_, GetRaftStatus(_))
+        .Times(3)
+        .WillRepeatedly(DoAll(SetArgPointee<0>(iobuf),
+                        Return(0)));
+    EXPECT_CALL(*mdsClient_, GetMetric(_, _))
+        .Times(3)
+        .WillRepeatedly(DoAll(SetArgPointee<1>(0),
+                        Return(0)));
+    std::vector<CopysetInfo> copysetsInMds;
+    CopysetInfo copyset;
+    copyset.set_logicalpoolid(1);
+    copyset.set_copysetid(100);
+    copysetsInMds.emplace_back(copyset);
+    EXPECT_CALL(*mdsClient_, GetCopySetsInCluster(_, _))
+        .Times(1)
+        .WillRepeatedly(DoAll(SetArgPointee<0>(copysetsInMds),
+                        Return(0)));
+    CopysetCheckCore copysetCheck(mdsClient_, csClient_);
+    ASSERT_EQ(0, copysetCheck.CheckCopysetsInCluster());
+    ASSERT_EQ(0, copysetCheck.GetCopysetStatistics().unhealthyRatio);
+}
+
+TEST_F(CopysetCheckCoreTest, CheckChunkServersOnline) {
+    std::vector<std::string> csAddrs = {"127.0.0.1:9191", "127.0.0.1:9192",
+                                        "127.0.0.1:9193"};
+    EXPECT_CALL(*csClient_, Init(_))
+        .Times(3)
+        .WillRepeatedly(Return(0));
+    EXPECT_CALL(*csClient_, CheckChunkServerOnline())
+        .Times(3)
+        .WillOnce(Return(false))
+        .WillRepeatedly(Return(true));
+    CopysetCheckCore copysetCheck(mdsClient_, csClient_);
+    std::map<std::string, bool> onlineStatus;
+    copysetCheck.CheckChunkServersOnline(csAddrs, &onlineStatus);
+    ASSERT_EQ(3, onlineStatus.size());
+    int onlineNum = 0;
+    for (const auto& item : onlineStatus) {
+        onlineNum += item.second ? 1 : 0;
+    }
+    ASSERT_EQ(2, onlineNum);
+}
+
 TEST_F(CopysetCheckCoreTest, CheckCopysetsInClusterError) {
     butil::IOBuf iobuf;
     GetIoBufForTest(&iobuf, "4294967396", "LEADER");
@@ -24,6 +24,12 @@
 #include <gflags/gflags.h>
 #include <fiu-control.h>
 
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
 #include "src/tools/consistency_check.h"
 #include "test/tools/mock/mock_namespace_tool_core.h"
 #include "test/tools/mock/mock_chunkserver_client.h"
@@ -313,3 +319,139 @@ TEST_F(ConsistencyCheckTest, CheckError) {
         .WillOnce(Return(-1));
     ASSERT_EQ(-1, cfc.RunCommand("check-consistency"));
 }
+
+TEST_F(ConsistencyCheckTest, CheckInParallel) {
+    std::vector<PageFileSegment> segments;
+    for (int i = 0; i < 3; ++i) {
+        PageFileSegment segment;
+        GetSegmentForTest(&segment);
+        segments.emplace_back(segment);
+    }
+    std::vector<ChunkServerLocation> csLocs;
+    for (uint64_t i = 1; i <= 3; ++i) {
+        ChunkServerLocation csLoc;
+        GetCsLocForTest(&csLoc, i);
+        csLocs.emplace_back(csLoc);
+    }
+    CopysetStatusResponse response1;
+    GetCopysetStatusForTest(&response1);
+    CopysetStatusResponse response2;
+    GetCopysetStatusForTest(&response2, 2222);
+
+    std::atomic<int> clientNum(0);
+    auto factory = [&]() -> std::shared_ptr<curve::tool::ChunkServerClient> {
+        ++clientNum;
+        return csClient_;
+    };
+    FLAGS_check_concurrency = 4;
+    FLAGS_check_cs_concurrency = 2;
+
+    // 1、全部一致
+    EXPECT_CALL(*nameSpaceTool_, Init(_))
+        .Times(1)
+        .WillOnce(Return(0));
+    EXPECT_CALL(*nameSpaceTool_, GetFileSegments(_, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(SetArgPointee<1>(segments),
+                        Return(0)));
+    EXPECT_CALL(*nameSpaceTool_, GetChunkServerListInCopySet(_, _, _))
+        .Times(20)
+        .WillRepeatedly(DoAll(SetArgPointee<2>(csLocs),
+                        Return(0)));
+    EXPECT_CALL(*csClient_, Init(_))
+        .Times(60)
+        .WillRepeatedly(Return(0));
+    EXPECT_CALL(*csClient_, GetCopysetStatus(_, _))
+        .Times(30)
+        .WillRepeatedly(DoAll(SetArgPointee<1>(response1),
+                        Return(0)));
+    EXPECT_CALL(*csClient_, GetChunkHash(_, _))
+        .Times(30)
+        .WillRepeatedly(DoAll(SetArgPointee<1>("1111"),
+                        Return(0)));
+    FLAGS_check_hash = true;
+    curve::tool::ConsistencyCheck cfc(nameSpaceTool_, csClient_, factory);
+    ASSERT_EQ(0, cfc.RunCommand("check-consistency"));
+    ASSERT_EQ(4, clientNum.load());
+
+    // 2、有一个copyset不一致，其他copyset仍然检查完
+    FLAGS_check_hash = false;
+    EXPECT_CALL(*csClient_, Init(_))
+        .Times(::testing::AtLeast(29))
+        .WillRepeatedly(Return(0));
+    EXPECT_CALL(*csClient_, GetCopysetStatus(_, _))
+        .Times(::testing::AtLeast(29))
+        .WillOnce(DoAll(SetArgPointee<1>(response2),
+                        Return(0)))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(response1),
+                        Return(0)));
+    ASSERT_EQ(-1, cfc.RunCommand("check-consistency"));
+    FLAGS_check_concurrency = 1;
+}
+
+TEST_F(ConsistencyCheckTest, ResumeFromCheckpoint) {
+    const std::string checkpoint = "./consistency_check_test.ckpt";
+    std::vector<PageFileSegment> segments;
+    PageFileSegment segment;
+    GetSegmentForTest(&segment);
+    segments.emplace_back(segment);
+    std::vector<ChunkServerLocation> csLocs;
+    for (uint64_t i = 1; i <= 3; ++i) {
+        ChunkServerLocation csLoc;
+        GetCsLocForTest(&csLoc, i);
+        csLocs.emplace_back(csLoc);
+    }
+    CopysetStatusResponse response;
+    GetCopysetStatusForTest(&response);
+    FLAGS_check_hash = false;
+    FLAGS_check_checkpoint = checkpoint;
+    ::remove(checkpoint.c_str());
+
+    EXPECT_CALL(*nameSpaceTool_, Init(_))
+        .Times(2)
+        .WillRepeatedly(Return(0));
+    EXPECT_CALL(*nameSpaceTool_, GetFileSegments(_, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(SetArgPointee<1>(segments),
+                        Return(0)));
+    EXPECT_CALL(*nameSpaceTool_, GetChunkServerListInCopySet(_, _, _))
+        .Times(11)
+        .WillRepeatedly(DoAll(SetArgPointee<2>(csLocs),
+                        Return(0)));
+
+    // 1、检查完两个copyset之后失败
+    EXPECT_CALL(*csClient_, Init(_))
+        .Times(7)
+        .WillRepeatedly(Return(0));
+    auto& expectation = EXPECT_CALL(*csClient_, GetCopysetStatus(_, _))
+        .Times(7);
+    for (int i = 0; i < 6; ++i) {
+        expectation.WillOnce(DoAll(SetArgPointee<1>(response), Return(0)));
+    }
+    expectation.WillOnce(Return(-1));
+    curve::tool::ConsistencyCheck cfc1(nameSpaceTool_, csClient_);
+    ASSERT_EQ(-1, cfc1.RunCommand("check-consistency"));
+    std::ifstream in(checkpoint);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(in, line)) {
+        lines.emplace_back(line);
+    }
+    in.close();
+    ASSERT_EQ(3, lines.size());
+    ASSERT_EQ("1 1000", lines[1]);
+    ASSERT_EQ("1 1001", lines[2]);
+
+    // 2、从checkpoint继续，全部一致之后删除checkpoint
+    EXPECT_CALL(*csClient_, Init(_))
+        .Times(24)
+        .WillRepeatedly(Return(0));
+    EXPECT_CALL(*csClient_, GetCopysetStatus(_, _))
+        .Times(24)
+        .WillRepeatedly(DoAll(SetArgPointee<1>(response),
+                        Return(0)));
+    curve::tool::ConsistencyCheck cfc2(nameSpaceTool_, csClient_);
+    ASSERT_EQ(0, cfc2.RunCommand("check-consistency"));
+    ASSERT_FALSE(std::ifstream(checkpoint).good());
+    FLAGS_check_checkpoint = "";
+}
@@ -374,6 +374,31 @@ TEST_F(ToolMDSClientTest, ListDir) {
         GetFileInfoForTest(i, &expected);
         ASSERT_EQ(expected.DebugString(), fileInfoVec[i].DebugString());
     }
+
+    // 分页获取，直到没有nextPageToken
+    fileInfoVec.clear();
+    curve::mds::ListDirResponse firstPage = response;
+    firstPage.set_nextpagetoken("next");
+    EXPECT_CALL(*nameService, ListDir(_, _, _, _))
+        .WillOnce(DoAll(
+            SetArgPointee<2>(firstPage),
+            Invoke([](RpcController *controller,
+                      const curve::mds::ListDirRequest *request,
+                      curve::mds::ListDirResponse *response, Closure *done) {
+                brpc::ClosureGuard doneGuard(done);
+                ASSERT_EQ(1000, request->pagesize());
+                ASSERT_EQ("", request->pagetoken());
+            })))
+        .WillOnce(DoAll(
+            SetArgPointee<2>(response),
+            Invoke([](RpcController *controller,
+                      const curve::mds::ListDirRequest *request,
+                      curve::mds::ListDirResponse *response, Closure *done) {
+                brpc::ClosureGuard doneGuard(done);
+                ASSERT_EQ("next", request->pagetoken());
+            })));
+    ASSERT_EQ(0, mdsClient.ListDir(fileName, &fileInfoVec));
+    ASSERT_EQ(10, fileInfoVec.size());
 }
 
 TEST_F(ToolMDSClientTest, GetSegmentInfo) {
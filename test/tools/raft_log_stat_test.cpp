@@ -0,0 +1,231 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <braft/enum.pb.h>
+#include <braft/util.h>
+#include <butil/raw_pack.h>
+#include <butil/sys_byteorder.h>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include "proto/chunk.pb.h"
+#include "src/fs/local_filesystem.h"
+#include "src/tools/raft_log_stat.h"
+#include "src/tools/raft_log_tool.h"
+
+DECLARE_string(fileName);
+
+namespace curve {
+namespace tool {
+
+using curve::chunkserver::ChunkRequest;
+using curve::chunkserver::CHUNK_OP_TYPE;
+using curve::fs::FileSystemType;
+using curve::fs::LocalFsFactory;
+
+const char kLogDir[] = "./raft_log_stat_test";
+const uint32_t kMetaPageSize = 4096;
+const uint32_t kAlignSize = 512;
+
+class RaftLogStatTest : public ::testing::Test {
+ protected:
+    void SetUp() {
+        localFS_ = LocalFsFactory::CreateFs(FileSystemType::EXT4, "");
+        ASSERT_EQ(0, system((std::string("rm -rf ") + kLogDir).c_str()));
+        ASSERT_EQ(0, localFS_->Mkdir(kLogDir));
+    }
+    void TearDown() {
+        ASSERT_EQ(0, system((std::string("rm -rf ") + kLogDir).c_str()));
+    }
+
+    // 与ChunkOpRequest::Encode的格式一致
+    static std::string EncodeRequest(CHUNK_OP_TYPE type, uint64_t chunkId,
+                                     uint32_t size) {
+        ChunkRequest request;
+        request.set_optype(type);
+        request.set_logicpoolid(1);
+        request.set_copysetid(100);
+        request.set_chunkid(chunkId);
+        request.set_offset(0);
+        request.set_size(size);
+        std::string meta;
+        request.SerializeToString(&meta);
+        uint32_t metaSize = butil::HostToNet32(meta.size());
+        std::string data(reinterpret_cast<char*>(&metaSize),
+                         sizeof(metaSize));
+        return data + meta + std::string(size, 'a');
+    }
+
+    static std::string PackEntry(int type, const std::string& data,
+                                 bool curveFormat) {
+        const size_t headerSize = curveFormat ? 28 : ENTRY_HEADER_SIZE;
+        uint32_t dataLen = data.size();
+        if (curveFormat) {
+            dataLen = (headerSize + data.size() + kAlignSize - 1) /
+                      kAlignSize * kAlignSize - headerSize;
+        }
+        std::string entry(headerSize + dataLen, '\0');
+        char* header = &entry[0];
+        const uint32_t metaField = (type << 24) | (1 << 16);
+        butil::RawPacker packer(header);
+        packer.pack64(2).pack32(metaField).pack32(dataLen);
+        if (curveFormat) {
+            packer.pack32(data.size());
+        }
+        packer.pack32(braft::crc32(data.data(), data.size()));
+        packer.pack32(braft::crc32(header, headerSize - 4));
+        memcpy(header + headerSize, data.data(), data.size());
+        return entry;
+    }
+
+    static void WriteFile(const std::string& name, const std::string& data) {
+        std::ofstream ofs(std::string(kLogDir) + "/" + name,
+                          std::ios::binary);
+        ofs.write(data.data(), data.size());
+    }
+
+    std::shared_ptr<LocalFileSystem> localFS_;
+};
+
+TEST_F(RaftLogStatTest, ParseSegmentName) {
+    int64_t firstIndex;
+    bool curveFormat;
+    ASSERT_TRUE(RaftLogStat::ParseSegmentName(
+        "/data/log_00000000000000000001_00000000000000000003",
+        &firstIndex, &curveFormat));
+    ASSERT_EQ(1, firstIndex);
+    ASSERT_FALSE(curveFormat);
+    ASSERT_TRUE(RaftLogStat::ParseSegmentName(
+        "curve_log_inprogress_00000000000000000004",
+        &firstIndex, &curveFormat));
+    ASSERT_EQ(4, firstIndex);
+    ASSERT_TRUE(curveFormat);
+    ASSERT_FALSE(RaftLogStat::ParseSegmentName(
+        "log_meta", &firstIndex, &curveFormat));
+}
+
+TEST_F(RaftLogStatTest, StatDir) {
+    // braft格式的segment，2个写请求和1个noop
+    std::string braftSegment =
+        PackEntry(braft::ENTRY_TYPE_DATA,
+                  EncodeRequest(CHUNK_OP_TYPE::CHUNK_OP_WRITE, 1, 4096),
+                  false) +
+        PackEntry(braft::ENTRY_TYPE_DATA,
+                  EncodeRequest(CHUNK_OP_TYPE::CHUNK_OP_WRITE, 2, 100),
+                  false) +
+        PackEntry(braft::ENTRY_TYPE_NO_OP, "", false);
+    WriteFile("log_00000000000000000001_00000000000000000003", braftSegment);
+
+    // curve格式的segment，meta page之后是对齐的entry，末尾是未写完的entry
+    std::string entries =
+        PackEntry(braft::ENTRY_TYPE_DATA,
+                  EncodeRequest(CHUNK_OP_TYPE::CHUNK_OP_WRITE, 1, 4096),
+                  true) +
+        PackEntry(braft::ENTRY_TYPE_DATA,
+                  EncodeRequest(CHUNK_OP_TYPE::CHUNK_OP_DELETE, 3, 0),
+                  true);
+    std::string partial = PackEntry(braft::ENTRY_TYPE_DATA,
+        EncodeRequest(CHUNK_OP_TYPE::CHUNK_OP_WRITE, 1, 4096), true);
+    partial.resize(kAlignSize);
+    std::string metaPage(kMetaPageSize, '\0');
+    int64_t bytes = kMetaPageSize + entries.size() + partial.size();
+    memcpy(&metaPage[0], &bytes, sizeof(bytes));
+    // walfilepool预分配的部分
+    std::string prealloc(2 * kAlignSize, '\0');
+    WriteFile("curve_log_inprogress_00000000000000000004",
+              metaPage + entries + partial + prealloc);
+    WriteFile("log_meta", "not a segment");
+
+    RaftLogStat raftLogStat(localFS_, 4, kMetaPageSize);
+    RaftLogStatistics stat;
+    ASSERT_EQ(0, raftLogStat.Stat(kLogDir, &stat));
+    ASSERT_EQ(5, stat.entryCount);
+    ASSERT_EQ(braftSegment.size() + entries.size(), stat.bytes);
+    ASSERT_EQ(4, stat.entryTypes[braft::ENTRY_TYPE_DATA]);
+    ASSERT_EQ(1, stat.entryTypes[braft::ENTRY_TYPE_NO_OP]);
+    ASSERT_EQ(3, stat.opTypes[CHUNK_OP_TYPE::CHUNK_OP_WRITE]);
+    ASSERT_EQ(1, stat.opTypes[CHUNK_OP_TYPE::CHUNK_OP_DELETE]);
+    ASSERT_EQ(4096 * 2 + 100, stat.opBytes[CHUNK_OP_TYPE::CHUNK_OP_WRITE]);
+    ASSERT_EQ(0, stat.badDataCount);
+
+    ASSERT_EQ(2, stat.chunkHeat.size());
+    ChunkKey key{1, 100, 1};
+    ASSERT_EQ(2, stat.chunkHeat[key].writeCount);
+    ASSERT_EQ(8192, stat.chunkHeat[key].writeBytes);
+
+    ASSERT_EQ(2, stat.segments.size());
+    ASSERT_EQ(1, stat.segments[0].firstIndex);
+    ASSERT_EQ(3, stat.segments[0].entryCount);
+    ASSERT_FALSE(stat.segments[0].truncated);
+    ASSERT_EQ(4, stat.segments[1].firstIndex);
+    ASSERT_EQ(2, stat.segments[1].entryCount);
+    ASSERT_TRUE(stat.segments[1].truncated);
+
+    uint64_t histogramCount = 0;
+    for (const auto& item : stat.sizeHistogram) {
+        histogramCount += item.second;
+    }
+    ASSERT_EQ(stat.entryCount, histogramCount);
+
+    std::ostringstream os;
+    RaftLogStat::Print(stat, 1, os);
+    ASSERT_NE(std::string::npos, os.str().find("top 1 of 2 written chunks"));
+    ASSERT_NE(std::string::npos, os.str().find("CHUNK_OP_WRITE: 3"));
+}
+
+TEST_F(RaftLogStatTest, CorruptedSegment) {
+    std::string segment =
+        PackEntry(braft::ENTRY_TYPE_DATA,
+                  EncodeRequest(CHUNK_OP_TYPE::CHUNK_OP_WRITE, 1, 100),
+                  false) +
+        PackEntry(braft::ENTRY_TYPE_NO_OP, "", false);
+    // 破坏第二个entry的header
+    segment[segment.size() - 10] ^= 0xff;
+    WriteFile("log_inprogress_00000000000000000001", segment);
+
+    RaftLogStat raftLogStat(localFS_, 1, kMetaPageSize);
+    RaftLogStatistics stat;
+    ASSERT_EQ(-1, raftLogStat.Stat(
+        std::string(kLogDir) + "/log_inprogress_00000000000000000001",
+        &stat));
+    ASSERT_EQ(1, stat.entryCount);
+    ASSERT_EQ(1, stat.segments.size());
+    ASSERT_TRUE(stat.segments[0].corrupted);
+
+    // 既不是目录也不是segment
+    ASSERT_EQ(-1, raftLogStat.Stat("./not_a_segment", &stat));
+}
+
+TEST_F(RaftLogStatTest, RunCommand) {
+    WriteFile("log_inprogress_00000000000000000001",
+              PackEntry(braft::ENTRY_TYPE_NO_OP, "", false));
+    RaftLogTool raftLogTool(nullptr, localFS_);
+    ASSERT_TRUE(RaftLogTool::SupportCommand("raft-log-stat"));
+    raftLogTool.PrintHelp("raft-log-stat");
+    FLAGS_fileName = kLogDir;
+    ASSERT_EQ(0, raftLogTool.RunCommand("raft-log-stat"));
+    FLAGS_fileName = "./not_a_segment";
+    ASSERT_EQ(-1, raftLogTool.RunCommand("raft-log-stat"));
+
+    RaftLogTool noFsTool(nullptr);
+    FLAGS_fileName = kLogDir;
+    ASSERT_EQ(-1, noFsTool.RunCommand("raft-log-stat"));
+}
+
+}  // namespace tool
+}  // namespace curve
@@ -98,6 +98,7 @@ import (
 	"strings"
 	"sync"
 	"time"
+	"unsafe"
 )
 
 const (
@@ -108,12 +109,15 @@ const (
 	EtcdDelete     = "Delete"
 	EtcdTxn2       = "Txn2"
 	EtcdTxn3       = "Txn3"
+	EtcdTxnN       = "TxnN"
 	EtcdCmpAndSwp  = "CmpAndSwp"
 	EtcdNewMutex   = "NewMutex"
 	EtcdNewSession = "NewSession"
 	EtcdLock       = "Lock"
 	EtcdTryLock    = "TryLock"
 	EtcdUnlock     = "Unlock"
+	EtcdWatch      = "Watch"
+	EtcdMultiGet   = "MultiGet"
 )
 
 var globalClient *clientv3.Client
@@ -406,6 +410,68 @@ func EtcdClientTxn3(
 	return GetErrCode(EtcdTxn3, err)
 }
 
+// EtcdClientTxnN一次最多支持的操作数，实际还受etcd的--max-txn-ops限制
+const maxTxnOps = 1 << 16
+
+//export EtcdClientTxnN
+func EtcdClientTxnN(timeout C.int, ops *C.struct_Operation,
+	opNum C.int) (C.enum_EtcdErrCode, int64) {
+	if opNum <= 0 || opNum > maxTxnOps {
+		log.Printf("unsupported txn op num: %v", opNum)
+		return C.EtcdInvalidArgument, 0
+	}
+	cops := (*[maxTxnOps]C.struct_Operation)(unsafe.Pointer(ops))[:opNum:opNum]
+	etcdOps, err := GenOpList(cops)
+	if err != nil {
+		log.Printf("unknown op types, err: %v", err)
+		return C.EtcdTxnUnkownOp, 0
+	}
+
+	ctx, cancel := context.WithTimeout(context.Background(),
+		time.Duration(int(timeout))*time.Millisecond)
+	defer cancel()
+
+	resp, err := globalClient.Txn(ctx).Then(etcdOps...).Commit()
+	if err == nil {
+		return GetErrCode(EtcdTxnN, err), resp.Header.Revision
+	}
+	return GetErrCode(EtcdTxnN, err), 0
+}
+
+// EtcdClientMultiGet gets the keys of ops by one txn, only the key of an op
+// is used. The existing key-values are returned as a managed object in the
+// order of ops, the missing keys are skipped.
+//
+//export EtcdClientMultiGet
+func EtcdClientMultiGet(timeout C.int, ops *C.struct_Operation,
+	opNum C.int) (C.enum_EtcdErrCode, uint64, int, int64) {
+	if opNum <= 0 || opNum > maxTxnOps {
+		log.Printf("unsupported multi get key num: %v", opNum)
+		return C.EtcdInvalidArgument, 0, 0, 0
+	}
+	cops := (*[maxTxnOps]C.struct_Operation)(unsafe.Pointer(ops))[:opNum:opNum]
+	etcdOps := make([]clientv3.Op, 0, len(cops))
+	for _, op := range cops {
+		goKey := C.GoStringN(op.key, op.keyLen)
+		etcdOps = append(etcdOps, clientv3.OpGet(goKey))
+	}
+
+	ctx, cancel := context.WithTimeout(context.Background(),
+		time.Duration(int(timeout))*time.Millisecond)
+	defer cancel()
+
+	resp, err := globalClient.Txn(ctx).Then(etcdOps...).Commit()
+	errCode := GetErrCode(EtcdMultiGet, err)
+	if errCode != C.EtcdOK {
+		return errCode, 0, 0, 0
+	}
+	kvs := make([]*mvccpb.KeyValue, 0, len(cops))
+	for _, r := range resp.Responses {
+		kvs = append(kvs, r.GetResponseRange().Kvs...)
+	}
+	return errCode, AddManagedObject(kvs), len(kvs), resp.Header.Revision
+}
+
 //export EtcdClientCompareAndSwap
 func EtcdClientCompareAndSwap(timeout C.int, key, prev, target *C.char,
 	keyLen, preLen, targetLen C.int) C.enum_EtcdErrCode {
@@ -430,6 +496,77 @@ func EtcdClientCompareAndSwap(timeout C.int, key, prev, target *C.char,
 	return GetErrCode(EtcdCmpAndSwp, err)
 }
 
+// EtcdClientWatch returns the first batch of events in range [start, end)
+// since startRevision. All events of a revision are in the same batch, the
+// returned revision is that of the last event.
+//
+//export EtcdClientWatch
+func EtcdClientWatch(timeout C.int, startKey, endKey *C.char,
+	startLen, endLen C.int, startRevision int64) (
+	C.enum_EtcdErrCode, uint64, int, int64) {
+	goStartKey := C.GoStringN(startKey, startLen)
+	goEndKey := C.GoStringN(endKey, endLen)
+	ctx, cancel := context.WithTimeout(context.Background(),
+		time.Duration(int(timeout))*time.Millisecond)
+	// the watcher is closed when ctx is cancelled
+	defer cancel()
+
+	wch := globalClient.Watch(clientv3.WithRequireLeader(ctx), goStartKey,
+		clientv3.WithRange(goEndKey), clientv3.WithRev(startRevision),
+		clientv3.WithPrevKV())
+	for resp := range wch {
+		if resp.CompactRevision != 0 {
+			log.Printf("watch from revision %v, compacted at %v",
+				startRevision, resp.CompactRevision)
+			return C.EtcdOutOfRange, 0, 0, resp.CompactRevision
+		}
+		if err := resp.Err(); err != nil {
+			return GetErrCode(EtcdWatch, err), 0, 0, 0
+		}
+		if len(resp.Events) == 0 {
+			continue
+		}
+		last := resp.Events[len(resp.Events)-1].Kv.ModRevision
+		return C.EtcdOK, AddManagedObject(resp.Events), len(resp.Events), last
+	}
+
+	// no event till timeout, which is normal and not logged
+	return C.EtcdDeadlineExceeded, 0, 0, 0
+}
+
+// EtcdClientGetWatchEvent returns the type, key and value of an event, the
+// value of a delete event is the value before deleted
+//
+//export EtcdClientGetWatchEvent
+func EtcdClientGetWatchEvent(oid uint64, serial int) (
+	C.enum_EtcdErrCode, C.enum_OpType, *C.char, int, *C.char, int) {
+	value, exist := GetManagedObject(oid)
+	if !exist {
+		return C.EtcdObjectNotExist, 0, nil, 0, nil, 0
+	}
+	events, ok := value.([]*clientv3.Event)
+	if !ok {
+		return C.EtcdErrObjectType, 0, nil, 0, nil, 0
+	}
+	if serial >= len(events) {
+		return C.EtcdObjectLenNotEnough, 0, nil, 0, nil, 0
+	}
+
+	ev := events[serial]
+	opType := C.enum_OpType(C.OpPut)
+	goValue := ev.Kv.Value
+	if ev.Type == mvccpb.DELETE {
+		opType = C.OpDelete
+		goValue = nil
+		if ev.PrevKv != nil {
+			goValue = ev.PrevKv.Value
+		}
+	}
+	return C.EtcdOK, opType,
+		C.CString(string(ev.Kv.Key)), len(ev.Kv.Key),
+		C.CString(string(goValue)), len(goValue)
+}
+
 //export EtcdElectionCampaign
 func EtcdElectionCampaign(pfx *C.char, pfxLen C.int,
 	leaderName *C.char, nameLen C.int, sessionInterSec uint32,
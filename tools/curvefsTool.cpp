@@ -64,6 +64,8 @@ const char kZone[] = "zone";
 const char kPhysicalPool[] = "physicalpool";
 const char kType[] = "type";
 const char kReplicasNum[] = "replicasnum";
+const char kDataNum[] = "datanum";
+const char kParityNum[] = "paritynum";
 const char kCopysetNum[] = "copysetnum";
 const char kZoneNum[] = "zonenum";
 const char kScatterWidth[] = "scatterwidth";
@@ -170,6 +172,14 @@ int CurvefsTools::HandleCreateLogicalPool() {
                              + ", \"copysetNum\":" + copysetNumStr
                              + ", \"zoneNum\":" + zoneNumStr
                              + "}";
+        if (lgPool.type == LogicalPoolType::APPENDECFILE) {
+            rapString = "{\"dSegmentNum\":" + std::to_string(lgPool.dataNum)
+                      + ", \"cSegmentNum\":"
+                      + std::to_string(lgPool.parityNum)
+                      + ", \"copysetNum\":" + copysetNumStr
+                      + ", \"zoneNum\":" + zoneNumStr
+                      + "}";
+        }
 
         request.set_redundanceandplacementpolicy(rapString);
         request.set_userpolicy("{\"aaa\":1}");
@@ -440,11 +450,22 @@ int CurvefsTools::InitLogicalPoolData() {
             return -1;
         }
         lgPoolData.type = static_cast<LogicalPoolType>(lgPool[kType].asInt());
-        if (!lgPool[kReplicasNum].isUInt()) {
+        if (lgPoolData.type == LogicalPoolType::APPENDECFILE) {
+            if (!lgPool[kDataNum].isUInt() || !lgPool[kParityNum].isUInt()) {
+                LOG(ERROR) << "erasure coded logicalpool datanum and "
+                           << "paritynum must be uint";
+                return -1;
+            }
+            lgPoolData.dataNum = lgPool[kDataNum].asUInt();
+            lgPoolData.parityNum = lgPool[kParityNum].asUInt();
+            lgPoolData.replicasNum =
+                lgPoolData.dataNum + lgPoolData.parityNum;
+        } else if (!lgPool[kReplicasNum].isUInt()) {
             LOG(ERROR) << "logicalpool replicasnum must be uint";
             return -1;
+        } else {
+            lgPoolData.replicasNum = lgPool[kReplicasNum].asUInt();
         }
-        lgPoolData.replicasNum = lgPool[kReplicasNum].asUInt();
         if (!lgPool[kCopysetNum].isUInt64()) {
             LOG(ERROR) << "logicalpool copysetnum must be uint64";
             return -1;
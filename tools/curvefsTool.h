@@ -64,6 +64,9 @@ struct CurveLogicalPoolData {
     curve::mds::topology::LogicalPoolType type;
     AllocateStatus status;
     uint32_t replicasNum;
+    // data and parity chunkservers of a stripe, for the erasure coded pool
+    uint32_t dataNum;
+    uint32_t parityNum;
     uint64_t copysetNum;
     uint32_t zoneNum;
     uint32_t scatterwidth;
@@ -0,0 +1,392 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Copyright (C) 2023 NetEase Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Run the performance suite against a deployed test cluster, record the
+results with the git revision and compare them with a baseline.
+
+The suite (util/bench.json by default) lists cases of these types:
+    fio:     fio with the libcurve ioengine (//src/tools/fio:libfio_curve.so)
+    gbench:  a google benchmark binary, e.g. the chunkserver storage
+             microbenchmarks (//test/chunkserver/benchmark)
+    mdbench: the curvefs metadata benchmark
+             (//curvefs/test/client/benchmark:curvefs_vfs_md_bench)
+
+Every metric is either "higher is better" (iops, bandwidth, ops/s) or
+"lower is better" (latency). A metric which is worse than the baseline by
+more than the threshold is a regression, and the run exits with 1.
+
+Examples:
+    util/bench.py run --only=fio --var volume=/perf_test_
+    util/bench.py run --baseline=.bench/baseline.json --threshold=0.05
+    util/bench.py run --update-baseline
+    util/bench.py compare .bench/baseline.json .bench/<result>.json
+"""
+
+import argparse
+import datetime
+import json
+import os
+import re
+import shlex
+import socket
+import statistics
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+HIGHER = "higher"
+LOWER = "lower"
+
+
+def log(msg):
+    sys.stderr.write(msg + "\n")
+    sys.stderr.flush()
+
+
+def git_revision():
+    def git(*args):
+        return subprocess.check_output(("git",) + args, cwd=ROOT,
+                                       universal_newlines=True).strip()
+    try:
+        return {
+            "commit": git("rev-parse", "HEAD"),
+            "describe": git("describe", "--always", "--dirty", "--tags"),
+        }
+    except (OSError, subprocess.CalledProcessError):
+        return {"commit": "unknown", "describe": "unknown"}
+
+
+def expand(value, variables):
+    def replace(match):
+        name = match.group(1)
+        if name not in variables:
+            raise KeyError("undefined variable ${%s}" % name)
+        return str(variables[name])
+    return re.sub(r"\$\{(\w+)\}", replace, str(value))
+
+
+def run_command(cmd, case_name, output_dir):
+    log("[%s] %s" % (case_name, cmd))
+    proc = subprocess.run(cmd, shell=True, stdout=subprocess.PIPE,
+                          stderr=subprocess.STDOUT, universal_newlines=True)
+    with open(os.path.join(output_dir, case_name + ".log"), "a") as f:
+        f.write("$ %s\n%s\n" % (cmd, proc.stdout))
+    if proc.returncode != 0:
+        raise RuntimeError("[%s] exit with %d, see %s" %
+                           (case_name, proc.returncode, output_dir))
+    return proc.stdout
+
+
+############################ CASES
+# Each case returns {metric: (value, direction)}
+
+def fio_command(case, variables):
+    args = {
+        "name": case["name"],
+        "thread": 1,
+        "ioengine": "external:${bazel_bin}/src/tools/fio/libfio_curve.so",
+        "curve_conf": "${curve_conf}",
+        "filename": "${volume}",
+        "size": "${volume_size}",
+        "direct": 1,
+        "time_based": 1,
+        "runtime": "${runtime}",
+        "ramp_time": "${ramp_time}",
+        "group_reporting": 1,
+        "output-format": "json",
+    }
+    args.update(case.get("args", {}))
+    # the options of the external ioengine must follow --ioengine
+    order = ["name", "thread", "ioengine"]
+    keys = order + sorted(k for k in args if k not in order)
+    cmd = [expand(variables.get("fio", "fio"), variables)]
+    for key in keys:
+        cmd.append("--%s=%s" % (key, expand(args[key], variables)))
+    return " ".join(shlex.quote(c) for c in cmd)
+
+
+def parse_fio(output):
+    # fio may print messages before the json
+    report = json.loads(output[output.index("{"):])
+    job = report["jobs"][0]
+    metrics = {}
+    for op in ("read", "write", "trim"):
+        stat = job.get(op)
+        if not stat or stat.get("io_bytes", 0) == 0:
+            continue
+        metrics[op + ".iops"] = (stat["iops"], HIGHER)
+        metrics[op + ".bw_bytes"] = (stat["bw_bytes"], HIGHER)
+        metrics[op + ".lat_mean_us"] = (stat["lat_ns"]["mean"] / 1000, LOWER)
+        percentile = stat["clat_ns"].get("percentile", {})
+        for key, name in (("99.000000", "clat_p99_us"),
+                          ("99.900000", "clat_p999_us")):
+            if key in percentile:
+                metrics[op + "." + name] = (percentile[key] / 1000, LOWER)
+    if job.get("error", 0) != 0:
+        raise RuntimeError("fio job error %d" % job["error"])
+    return metrics
+
+
+def run_fio(case, variables, output_dir):
+    return parse_fio(run_command(fio_command(case, variables),
+                                 case["name"], output_dir))
+
+
+TIME_UNIT_NS = {"ns": 1, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def parse_gbench(output):
+    report = json.loads(output[output.index("{"):])
+    metrics = {}
+    for bench in report["benchmarks"]:
+        if bench.get("run_type") == "aggregate" or \
+                bench.get("error_occurred"):
+            continue
+        name = bench["name"]
+        unit = TIME_UNIT_NS[bench.get("time_unit", "ns")]
+        metrics[name + ".real_time_ns"] = (bench["real_time"] * unit, LOWER)
+        for key in ("bytes_per_second", "items_per_second"):
+            if key in bench:
+                metrics[name + "." + key] = (bench[key], HIGHER)
+    return metrics
+
+
+def run_gbench(case, variables, output_dir):
+    cmd = expand(case["cmd"], variables)
+    cmd += " --benchmark_format=json"
+    if "filter" in case:
+        cmd += " --benchmark_filter=%s" % shlex.quote(case["filter"])
+    return parse_gbench(run_command(cmd, case["name"], output_dir))
+
+
+MD_PHASE = re.compile(r"^== (\w+): (\d+) ops, (\d+) errors, (\d+) ops/s")
+MD_LAT = re.compile(r"^\s+lat\(us\) p50: (\d+), p90: (\d+), p99: (\d+)")
+
+
+def parse_mdbench(output):
+    metrics = {}
+    phase = None
+    for line in output.splitlines():
+        match = MD_PHASE.match(line)
+        if match:
+            phase = match.group(1)
+            if int(match.group(3)) != 0:
+                raise RuntimeError("phase %s has %s errors" %
+                                   (phase, match.group(3)))
+            metrics[phase + ".ops_per_sec"] = (int(match.group(4)), HIGHER)
+            continue
+        match = MD_LAT.match(line)
+        if match and phase:
+            metrics[phase + ".p50_us"] = (int(match.group(1)), LOWER)
+            metrics[phase + ".p99_us"] = (int(match.group(3)), LOWER)
+    if not metrics:
+        raise RuntimeError("no phase is reported")
+    return metrics
+
+
+def run_mdbench(case, variables, output_dir):
+    cmd = expand(case["cmd"], variables)
+    return parse_mdbench(run_command(cmd, case["name"], output_dir))
+
+
+RUNNERS = {
+    "fio": run_fio,
+    "gbench": run_gbench,
+    "mdbench": run_mdbench,
+}
+
+
+def run_case(case, variables, output_dir, repeat):
+    """Run a case |repeat| times and take the median of every metric"""
+    samples = {}
+    for _ in range(repeat):
+        for name, (value, direction) in \
+                RUNNERS[case["type"]](case, variables, output_dir).items():
+            samples.setdefault(name, (direction, []))[1].append(value)
+    return {
+        name: {"value": statistics.median(values), "direction": direction}
+        for name, (direction, values) in samples.items()
+    }
+
+
+############################ COMPARE
+def compare(baseline, current, default_threshold):
+    """
+    Return the rows of (case, metric, base, value, change, status), status is
+    one of "ok", "better" and "REGRESSION"
+    """
+    rows = []
+    for case_name, case in sorted(current["cases"].items()):
+        base_case = baseline["cases"].get(case_name)
+        if base_case is None:
+            continue
+        threshold = case.get("threshold", default_threshold)
+        for metric, stat in sorted(case["metrics"].items()):
+            base = base_case["metrics"].get(metric)
+            if base is None or base["value"] == 0:
+                continue
+            change = (stat["value"] - base["value"]) / base["value"]
+            if stat["direction"] == LOWER and change != 0:
+                change = -change
+            if change < -threshold:
+                status = "REGRESSION"
+            elif change > threshold:
+                status = "better"
+            else:
+                status = "ok"
+            rows.append((case_name, metric, base["value"], stat["value"],
+                         change, status))
+    return rows
+
+
+def print_compare(baseline, current, threshold):
+    log("baseline: %s (%s), current: %s (%s)" % (
+        baseline["revision"]["describe"], baseline["time"],
+        current["revision"]["describe"], current["time"]))
+    rows = compare(baseline, current, threshold)
+    fmt = "%-24s %-48s %14s %14s %8s  %s"
+    print(fmt % ("case", "metric", "baseline", "current", "change", ""))
+    for case_name, metric, base, value, change, status in rows:
+        # the change is signed so that positive is better, also for latency
+        print(fmt % (case_name, metric, "%.2f" % base, "%.2f" % value,
+                     "%+.1f%%" % (change * 100), status))
+    regressions = [r for r in rows if r[5] == "REGRESSION"]
+    missing = sorted(set(baseline["cases"]) - set(current["cases"]))
+    if missing:
+        print("cases missing in the current run: %s" % ", ".join(missing))
+    print("%d metrics compared, %d regressions" %
+          (len(rows), len(regressions)))
+    return len(regressions) == 0
+
+
+############################ COMMANDS
+def load_json(path):
+    with open(path) as f:
+        return json.load(f)
+
+
+def save_json(path, data):
+    tmp = path + ".tmp"
+    with open(tmp, "w") as f:
+        json.dump(data, f, indent=2, sort_keys=True)
+    os.rename(tmp, path)
+
+
+def cmd_run(args):
+    suite = load_json(args.suite)
+    # the suite defaults < BENCH_<KEY> environment variables < --var
+    variables = dict(suite.get("vars", {}))
+    for key, value in list(variables.items()):
+        variables[key] = os.environ.get("BENCH_" + key.upper(), value)
+    for item in args.var:
+        key, _, value = item.partition("=")
+        variables[key] = value
+
+    revision = git_revision()
+    now = datetime.datetime.now()
+    name = "%s_%s" % (now.strftime("%Y-%m-%d_%H:%M:%S"),
+                      revision["describe"])
+    output_dir = os.path.join(args.results, name)
+    seq = 0
+    while os.path.exists(output_dir):
+        seq += 1
+        output_dir = os.path.join(args.results, "%s_%d" % (name, seq))
+    os.makedirs(output_dir)
+
+    result = {
+        "revision": revision,
+        "time": now.isoformat(timespec="seconds"),
+        "host": socket.gethostname(),
+        "suite": os.path.basename(args.suite),
+        "vars": variables,
+        "cases": {},
+    }
+    failed = []
+    for case in suite["cases"]:
+        if args.only and not re.search(args.only, case["name"]):
+            continue
+        try:
+            metrics = run_case(case, variables, output_dir, args.repeat)
+        except (RuntimeError, KeyError, ValueError) as e:
+            log("[%s] failed: %s" % (case["name"], e))
+            failed.append(case["name"])
+            continue
+        result["cases"][case["name"]] = {"metrics": metrics}
+        if "threshold" in case:
+            result["cases"][case["name"]]["threshold"] = case["threshold"]
+
+    result_path = output_dir + ".json"
+    save_json(result_path, result)
+    log("results saved to %s" % result_path)
+
+    ok = not failed
+    if failed:
+        print("failed cases: %s" % ", ".join(failed))
+    if args.baseline and os.path.exists(args.baseline):
+        ok = print_compare(load_json(args.baseline), result,
+                           args.threshold) and ok
+    elif args.baseline:
+        log("baseline %s does not exist, skip comparing" % args.baseline)
+    if args.update_baseline and not failed:
+        os.makedirs(os.path.dirname(os.path.abspath(args.baseline)),
+                    exist_ok=True)
+        save_json(args.baseline, result)
+        log("baseline %s updated" % args.baseline)
+    return 0 if ok else 1
+
+
+def cmd_compare(args):
+    ok = print_compare(load_json(args.baseline), load_json(args.current),
+                       args.threshold)
+    return 0 if ok else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+    sub = parser.add_subparsers(dest="command")
+    sub.required = True
+
+    run = sub.add_parser("run", help="run the suite")
+    run.add_argument("--suite", default=os.path.join(ROOT, "util/bench.json"))
+    run.add_argument("--only", default="", help="regex of the case names")
+    run.add_argument("--var", action="append", default=[],
+                     help="override a suite variable, KEY=VALUE")
+    run.add_argument("--repeat", type=int, default=1,
+                     help="run every case N times and take the median")
+    run.add_argument("--results", default=os.path.join(ROOT, ".bench"))
+    run.add_argument("--baseline",
+                     default=os.path.join(ROOT, ".bench/baseline.json"))
+    run.add_argument("--update-baseline", action="store_true",
+                     help="save the results as the baseline")
+    run.add_argument("--threshold", type=float, default=0.05,
+                     help="relative change treated as a regression")
+    run.set_defaults(func=cmd_run)
+
+    cmp = sub.add_parser("compare", help="compare two recorded results")
+    cmp.add_argument("baseline")
+    cmp.add_argument("current")
+    cmp.add_argument("--threshold", type=float, default=0.05)
+    cmp.set_defaults(func=cmd_compare)
+
+    args = parser.parse_args()
+    sys.exit(args.func(args))
+
+
+if __name__ == "__main__":
+    main()